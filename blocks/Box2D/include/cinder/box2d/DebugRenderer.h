@@ -0,0 +1,139 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/Color.h"
+#include "cinder/Exception.h"
+
+#include <Box2D/Box2D.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace box2d {
+
+typedef std::shared_ptr<class DebugBatch>		DebugBatchRef;
+typedef std::shared_ptr<class DebugRenderer>	DebugRendererRef;
+
+/** \brief A b2Draw which records a world's debug geometry into arrays of instances rather than drawing it.
+ *
+ * Register it with b2World::SetDebugDraw() and call b2World::DrawDebugData() to fill it, then hand it to DebugRenderer::draw(). It doesn't use OpenGL,
+ * so it can be filled on the thread which steps the world. Solid shapes are recorded as a translucent fill plus an opaque outline, as in the Box2D testbed. **/
+class DebugBatch : public b2Draw {
+  public:
+	//! A convex polygon of up to eight vertices. Vertices past mNumVertices repeat the last one.
+	struct Polygon {
+		Vec2f	mVertices[b2_maxPolygonVertices];
+		ColorA	mColor;
+		float	mNumVertices;
+	};
+	//! A circle, stored as its center and radius
+	struct Circle {
+		Vec2f	mCenter;
+		float	mRadius, mUnused;
+		ColorA	mColor;
+	};
+	//! A line segment from mStart to mEnd
+	struct Segment {
+		Vec2f	mStart, mEnd;
+		ColorA	mColor;
+	};
+
+	//! Creates an empty DebugBatch which records the parts of a world selected by \a flags, a combination of the b2Draw::e_*Bit values
+	static DebugBatchRef	create( uint32 flags = e_shapeBit | e_jointBit ) { return DebugBatchRef( new DebugBatch( flags ) ); }
+
+	//! Removes everything recorded, keeping the storage
+	void	clear();
+	//! Returns whether nothing is recorded
+	bool	isEmpty() const { return mPolygonFills.empty() && mPolygonOutlines.empty() && mCircleFills.empty() && mCircleOutlines.empty() && mSegments.empty(); }
+	//! Clears the batch and records the debug geometry of \a world. The world is left without a b2Draw registered.
+	void	record( b2World *world );
+
+	virtual void	DrawPolygon( const b2Vec2 *vertices, int32 vertexCount, const b2Color &color );
+	virtual void	DrawSolidPolygon( const b2Vec2 *vertices, int32 vertexCount, const b2Color &color );
+	virtual void	DrawCircle( const b2Vec2 &center, float32 radius, const b2Color &color );
+	virtual void	DrawSolidCircle( const b2Vec2 &center, float32 radius, const b2Vec2 &axis, const b2Color &color );
+	virtual void	DrawSegment( const b2Vec2 &p1, const b2Vec2 &p2, const b2Color &color );
+	virtual void	DrawTransform( const b2Transform &xf );
+
+	const std::vector<Polygon>&	getPolygonFills() const { return mPolygonFills; }
+	const std::vector<Polygon>&	getPolygonOutlines() const { return mPolygonOutlines; }
+	const std::vector<Circle>&	getCircleFills() const { return mCircleFills; }
+	const std::vector<Circle>&	getCircleOutlines() const { return mCircleOutlines; }
+	const std::vector<Segment>&	getSegments() const { return mSegments; }
+
+	//! Sets the length of the axes drawn by DrawTransform(), in world units. Default is \c 0.4.
+	void	setAxisLength( float length ) { mAxisLength = length; }
+	float	getAxisLength() const { return mAxisLength; }
+
+  protected:
+	DebugBatch( uint32 flags );
+
+	void	addPolygon( std::vector<Polygon> *polygons, const b2Vec2 *vertices, int32 vertexCount, const ColorA &color );
+
+	std::vector<Polygon>	mPolygonFills, mPolygonOutlines;
+	std::vector<Circle>		mCircleFills, mCircleOutlines;
+	std::vector<Segment>	mSegments;
+	float					mAxisLength;
+};
+
+/** \brief Draws DebugBatches with one instanced draw call per kind of primitive, rather than one per fixture.
+ *
+ * Each of polygon fills, polygon outlines, circle fills, circle outlines and segments is a VboMesh of a single unit primitive, drawn with
+ * gl::drawInstanced() once per recorded instance, whose parameters are uploaded to the mesh's instance buffer each draw. Geometry is drawn in
+ * world units through the current \c MODELVIEW and \c PROJECTION matrices. Fills are translucent, so enable alpha blending with
+ * gl::enableAlphaBlending() beforehand. Requires VboMesh::isInstancingSupported(). **/
+class DebugRenderer : private boost::noncopyable {
+  public:
+	//! Creates a DebugRenderer whose circles have \a circleSegments segments. Throws DebugRendererExc if instancing isn't supported.
+	static DebugRendererRef		create( int circleSegments = 32 ) { return DebugRendererRef( new DebugRenderer( circleSegments ) ); }
+
+	//! Draws everything recorded in \a batch
+	void	draw( const DebugBatch &batch );
+
+	//! Returns the number of instances drawn by the last draw()
+	size_t	getNumInstancesDrawn() const { return mNumInstancesDrawn; }
+
+  protected:
+	DebugRenderer( int circleSegments );
+
+	template<typename InstanceT>
+	void	drawInstances( gl::VboMesh &mesh, const std::vector<InstanceT> &instances );
+
+	gl::GlslProg	mPolygonShader, mCircleShader, mSegmentShader;
+	gl::VboMeshRef	mPolygonFillMesh, mPolygonOutlineMesh, mCircleFillMesh, mCircleOutlineMesh, mSegmentMesh;
+	size_t			mNumInstancesDrawn;
+};
+
+class DebugRendererExc : public Exception {
+  public:
+	virtual const char* what() const throw() { return "box2d::DebugRenderer requires instanced arrays"; }
+};
+
+} } // namespace cinder::box2d
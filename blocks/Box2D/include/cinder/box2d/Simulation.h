@@ -0,0 +1,136 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/box2d/DebugRenderer.h"
+#include "cinder/FixedStepThread.h"
+#include "cinder/Vector.h"
+
+#include <Box2D/Box2D.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace box2d {
+
+typedef std::shared_ptr<class Simulation>	SimulationRef;
+
+/** \brief Steps a b2World at a fixed timestep on its own thread, publishing double-buffered body transforms for the main thread to draw.
+ *
+ * Once started, the world is stepped by a FixedStepThread and must only be modified through post(), whose functions run on the stepping thread
+ * between steps; contact listeners and other Box2D callbacks run there as well. After each step the transform of every body is published, and
+ * update() interpolates between the two latest steps, so getBodies() moves smoothly at the App's frame rate while stepping stays deterministic.
+ * When setDebugFlags() enables it, each step's debug geometry is also recorded on the stepping thread, ready for drawDebug() to draw with a DebugRenderer.
+ *
+ * \code
+ * mSim = box2d::Simulation::create( b2Vec2( 0, 10 ) );
+ * mSim->post( []( b2World *world ) { world->CreateBody( &bodyDef )->CreateFixture( &fixtureDef ); } );
+ * mSim->start();
+ * ...
+ * void update() { mSim->update(); }
+ * void draw() { for( auto &body : mSim->getBodies() ) drawBox( body.mPosition, body.mAngle ); }
+ * \endcode **/
+class Simulation : private boost::noncopyable {
+  public:
+	//! A body's transform as published after a step
+	struct Body {
+		//! Identifies the body. It must not be accessed from the main thread while the Simulation is running.
+		b2Body*		mBody;
+		//! The body's user data, as set with b2BodyDef::userData or b2Body::SetUserData()
+		void*		mUserData;
+		Vec2f		mPosition;
+		float		mAngle;
+		bool		mAwake;
+	};
+
+	//! Creates a Simulation of a new world with \a gravity, stepped every \a timestep seconds with \a velocityIterations and \a positionIterations
+	static SimulationRef	create( const b2Vec2 &gravity, double timestep = 1 / 60.0, int32 velocityIterations = 8, int32 positionIterations = 3 )
+		{ return SimulationRef( new Simulation( gravity, timestep, velocityIterations, positionIterations ) ); }
+	~Simulation();
+
+	//! Starts stepping on a new thread
+	void	start();
+	//! Stops stepping and joins the thread, after which the world may be accessed directly again
+	void	stop();
+	//! Returns whether the stepping thread is running
+	bool	isRunning() const { return mThread && mThread->isRunning(); }
+	//! Sets whether stepping is paused
+	void	setPaused( bool paused = true );
+	bool	isPaused() const { return mThread && mThread->isPaused(); }
+
+	//! Queues \a fn to be called with the world on the stepping thread ahead of the next step. When not running \a fn is called immediately.
+	void		post( const std::function<void ( b2World *world )> &fn );
+	//! Returns the world, which may only be accessed directly while the Simulation isn't running
+	b2World*	getWorld() const { return mWorld.get(); }
+
+	//! Reads the two latest steps and interpolates the bodies between them for the current time. Call once per frame. Rethrows any exception thrown while stepping.
+	void	update();
+	//! Returns the bodies as of the last update(), in the order they were created
+	const std::vector<Body>&	getBodies() const { return mBodies; }
+
+	//! Sets the parts of the world recorded after each step for drawDebug(), a combination of the b2Draw::e_*Bit values. Default is \c 0, which records nothing.
+	void		setDebugFlags( uint32 flags ) { mDebugFlags = flags; }
+	uint32		getDebugFlags() const { return mDebugFlags; }
+	//! Returns the debug geometry of the latest step as of the last update(), which is null unless setDebugFlags() enabled recording
+	const DebugBatchRef&	getDebugBatch() const { return mDebugBatch; }
+	//! Draws getDebugBatch() with a DebugRenderer, which is created on first use
+	void		drawDebug();
+
+	double		getTimestep() const { return mTimestep; }
+	//! Returns the number of steps taken
+	uint64_t	getNumSteps() const { return mThread ? mThread->getNumSteps() : 0; }
+	//! Returns the number of steps dropped because stepping fell too far behind
+	uint64_t	getNumDroppedSteps() const { return mThread ? mThread->getNumDroppedSteps() : 0; }
+
+  private:
+	Simulation( const b2Vec2 &gravity, double timestep, int32 velocityIterations, int32 positionIterations );
+
+	struct State {
+		State() : mWorld( 0 ) {}
+
+		b2World*			mWorld;
+		std::vector<Body>	mBodies;
+		DebugBatchRef		mDebugBatch;
+	};
+
+	void	step( State *state, double timestep );
+	void	publish( State *state );
+
+	std::unique_ptr<b2World>					mWorld;
+	double										mTimestep;
+	int32										mVelocityIterations, mPositionIterations;
+	std::atomic<uint32>							mDebugFlags;
+	std::unique_ptr<FixedStepThread<State> >	mThread;
+
+	State				mPrevious, mCurrent;	// the snapshots read by the last update(), kept to reuse their storage
+	std::vector<Body>	mBodies;
+	DebugBatchRef		mDebugBatch;
+	DebugRendererRef	mDebugRenderer;
+};
+
+} } // namespace cinder::box2d
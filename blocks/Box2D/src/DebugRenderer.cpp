@@ -0,0 +1,289 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/box2d/DebugRenderer.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace box2d {
+
+namespace {
+
+// gl_Vertex.x holds the index of the polygon vertex, which is clamped to the last one so that unused vertices collapse
+const char *sPolygonVertexShader =
+	"attribute vec4 vertices01;\n"
+	"attribute vec4 vertices23;\n"
+	"attribute vec4 vertices45;\n"
+	"attribute vec4 vertices67;\n"
+	"attribute vec4 color;\n"
+	"attribute float numVertices;\n"
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	float i = min( gl_Vertex.x, numVertices - 1.0 );\n"
+	"	vec4 pair = ( i < 2.0 ) ? vertices01 : ( ( i < 4.0 ) ? vertices23 : ( ( i < 6.0 ) ? vertices45 : vertices67 ) );\n"
+	"	vec2 position = ( mod( i, 2.0 ) < 0.5 ) ? pair.xy : pair.zw;\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4( position, 0.0, 1.0 );\n"
+	"	vColor = color;\n"
+	"}\n";
+
+// gl_Vertex holds a point on the unit circle, or its center
+const char *sCircleVertexShader =
+	"attribute vec4 centerRadius;\n"
+	"attribute vec4 color;\n"
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	vec2 position = centerRadius.xy + gl_Vertex.xy * centerRadius.z;\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4( position, 0.0, 1.0 );\n"
+	"	vColor = color;\n"
+	"}\n";
+
+// gl_Vertex.x is 0 at the start of the segment and 1 at its end
+const char *sSegmentVertexShader =
+	"attribute vec4 points;\n"
+	"attribute vec4 color;\n"
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	vec2 position = mix( points.xy, points.zw, gl_Vertex.x );\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4( position, 0.0, 1.0 );\n"
+	"	vColor = color;\n"
+	"}\n";
+
+const char *sFragmentShader =
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	gl_FragColor = vColor;\n"
+	"}\n";
+
+ColorA toFillColor( const b2Color &color )
+{
+	return ColorA( 0.5f * color.r, 0.5f * color.g, 0.5f * color.b, 0.5f );
+}
+
+ColorA toOutlineColor( const b2Color &color )
+{
+	return ColorA( color.r, color.g, color.b, 1 );
+}
+
+gl::VboMeshRef createMesh( const vector<Vec3f> &positions, GLenum primitiveType, const gl::VboMesh::Layout &instanceLayout )
+{
+	gl::VboMesh::Layout layout = instanceLayout;
+	layout.setStaticPositions();
+	gl::VboMeshRef result = gl::VboMesh::create( positions.size(), 0, layout, primitiveType );
+	result->bufferPositions( positions );
+	return result;
+}
+
+void bindInstanceLocations( gl::VboMesh &mesh, gl::GlslProg &shader, const char **names, size_t numNames )
+{
+	for( size_t n = 0; n < numNames; ++n )
+		mesh.setCustomInstanceLocation( n, shader.getAttribLocation( names[n] ) );
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////
+// DebugBatch
+DebugBatch::DebugBatch( uint32 flags )
+	: mAxisLength( 0.4f )
+{
+	SetFlags( flags );
+}
+
+void DebugBatch::clear()
+{
+	mPolygonFills.clear();
+	mPolygonOutlines.clear();
+	mCircleFills.clear();
+	mCircleOutlines.clear();
+	mSegments.clear();
+}
+
+void DebugBatch::record( b2World *world )
+{
+	clear();
+	world->SetDebugDraw( this );
+	world->DrawDebugData();
+	world->SetDebugDraw( NULL );
+}
+
+void DebugBatch::addPolygon( std::vector<Polygon> *polygons, const b2Vec2 *vertices, int32 vertexCount, const ColorA &color )
+{
+	if( vertexCount <= 0 )
+		return;
+
+	// a Polygon holds at most b2_maxPolygonVertices, so larger ones are split into fans sharing their first vertex; each chunk overlaps the next by an edge
+	for( int32 first = 1; ; first += b2_maxPolygonVertices - 2 ) {
+		int32 count = std::min<int32>( vertexCount - first, b2_maxPolygonVertices - 1 );
+		polygons->push_back( Polygon() );
+		Polygon &polygon = polygons->back();
+		polygon.mVertices[0] = Vec2f( vertices[0].x, vertices[0].y );
+		for( int32 v = 0; v < b2_maxPolygonVertices - 1; ++v ) {
+			const b2Vec2 &vertex = vertices[first + std::min( v, count - 1 )];
+			polygon.mVertices[v + 1] = Vec2f( vertex.x, vertex.y );
+		}
+		polygon.mColor = color;
+		polygon.mNumVertices = (float)( count + 1 );
+		if( first + count >= vertexCount )
+			break;
+	}
+}
+
+void DebugBatch::DrawPolygon( const b2Vec2 *vertices, int32 vertexCount, const b2Color &color )
+{
+	if( vertexCount <= b2_maxPolygonVertices )
+		addPolygon( &mPolygonOutlines, vertices, vertexCount, toOutlineColor( color ) );
+	else {
+		for( int32 v = 0; v < vertexCount; ++v )
+			DrawSegment( vertices[v], vertices[( v + 1 ) % vertexCount], color );
+	}
+}
+
+void DebugBatch::DrawSolidPolygon( const b2Vec2 *vertices, int32 vertexCount, const b2Color &color )
+{
+	addPolygon( &mPolygonFills, vertices, vertexCount, toFillColor( color ) );
+	DrawPolygon( vertices, vertexCount, color );
+}
+
+void DebugBatch::DrawCircle( const b2Vec2 &center, float32 radius, const b2Color &color )
+{
+	Circle circle;
+	circle.mCenter = Vec2f( center.x, center.y );
+	circle.mRadius = radius;
+	circle.mUnused = 0;
+	circle.mColor = toOutlineColor( color );
+	mCircleOutlines.push_back( circle );
+}
+
+void DebugBatch::DrawSolidCircle( const b2Vec2 &center, float32 radius, const b2Vec2 &axis, const b2Color &color )
+{
+	DrawCircle( center, radius, color );
+	mCircleFills.push_back( mCircleOutlines.back() );
+	mCircleFills.back().mColor = toFillColor( color );
+	DrawSegment( center, center + radius * axis, color );
+}
+
+void DebugBatch::DrawSegment( const b2Vec2 &p1, const b2Vec2 &p2, const b2Color &color )
+{
+	Segment segment;
+	segment.mStart = Vec2f( p1.x, p1.y );
+	segment.mEnd = Vec2f( p2.x, p2.y );
+	segment.mColor = toOutlineColor( color );
+	mSegments.push_back( segment );
+}
+
+void DebugBatch::DrawTransform( const b2Transform &xf )
+{
+	DrawSegment( xf.p, xf.p + mAxisLength * xf.q.GetXAxis(), b2Color( 1, 0, 0 ) );
+	DrawSegment( xf.p, xf.p + mAxisLength * xf.q.GetYAxis(), b2Color( 0, 1, 0 ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DebugRenderer
+DebugRenderer::DebugRenderer( int circleSegments )
+	: mNumInstancesDrawn( 0 )
+{
+	if( ! gl::VboMesh::isInstancingSupported() )
+		throw DebugRendererExc();
+
+	mPolygonShader = gl::GlslProg( sPolygonVertexShader, sFragmentShader );
+	mCircleShader = gl::GlslProg( sCircleVertexShader, sFragmentShader );
+	mSegmentShader = gl::GlslProg( sSegmentVertexShader, sFragmentShader );
+
+	// the instance attributes of each mesh match the layout of the corresponding DebugBatch struct
+	gl::VboMesh::Layout polygonLayout;
+	for( int v = 0; v < b2_maxPolygonVertices / 2; ++v )
+		polygonLayout.addInstanceCustomVec4f();
+	polygonLayout.addInstanceCustomVec4f();
+	polygonLayout.addInstanceCustomFloat();
+	gl::VboMesh::Layout vec4PairLayout;
+	vec4PairLayout.addInstanceCustomVec4f();
+	vec4PairLayout.addInstanceCustomVec4f();
+
+	vector<Vec3f> polygonPositions;
+	for( int v = 0; v < b2_maxPolygonVertices; ++v )
+		polygonPositions.push_back( Vec3f( (float)v, 0, 0 ) );
+	mPolygonFillMesh = createMesh( polygonPositions, GL_TRIANGLE_FAN, polygonLayout );
+	mPolygonOutlineMesh = createMesh( polygonPositions, GL_LINE_LOOP, polygonLayout );
+
+	circleSegments = std::max( circleSegments, 3 );
+	vector<Vec3f> circlePositions;
+	for( int s = 0; s < circleSegments; ++s ) {
+		float angle = s / (float)circleSegments * 2 * (float)M_PI;
+		circlePositions.push_back( Vec3f( math<float>::cos( angle ), math<float>::sin( angle ), 0 ) );
+	}
+	mCircleOutlineMesh = createMesh( circlePositions, GL_LINE_LOOP, vec4PairLayout );
+	circlePositions.insert( circlePositions.begin(), Vec3f::zero() );
+	circlePositions.push_back( circlePositions[1] );
+	mCircleFillMesh = createMesh( circlePositions, GL_TRIANGLE_FAN, vec4PairLayout );
+
+	vector<Vec3f> segmentPositions;
+	segmentPositions.push_back( Vec3f::zero() );
+	segmentPositions.push_back( Vec3f::xAxis() );
+	mSegmentMesh = createMesh( segmentPositions, GL_LINES, vec4PairLayout );
+
+	const char *polygonAttribs[] = { "vertices01", "vertices23", "vertices45", "vertices67", "color", "numVertices" };
+	bindInstanceLocations( *mPolygonFillMesh, mPolygonShader, polygonAttribs, 6 );
+	bindInstanceLocations( *mPolygonOutlineMesh, mPolygonShader, polygonAttribs, 6 );
+	const char *circleAttribs[] = { "centerRadius", "color" };
+	bindInstanceLocations( *mCircleFillMesh, mCircleShader, circleAttribs, 2 );
+	bindInstanceLocations( *mCircleOutlineMesh, mCircleShader, circleAttribs, 2 );
+	const char *segmentAttribs[] = { "points", "color" };
+	bindInstanceLocations( *mSegmentMesh, mSegmentShader, segmentAttribs, 2 );
+}
+
+template<typename InstanceT>
+void DebugRenderer::drawInstances( gl::VboMesh &mesh, const std::vector<InstanceT> &instances )
+{
+	if( instances.empty() )
+		return;
+
+	mesh.bufferInstanceData( &instances[0], instances.size() );
+	gl::drawInstanced( mesh, instances.size() );
+	mNumInstancesDrawn += instances.size();
+}
+
+void DebugRenderer::draw( const DebugBatch &batch )
+{
+	mNumInstancesDrawn = 0;
+	if( batch.isEmpty() )
+		return;
+
+	// fills first, so that outlines and segments draw over them
+	mPolygonShader.bind();
+	drawInstances( *mPolygonFillMesh, batch.getPolygonFills() );
+	mCircleShader.bind();
+	drawInstances( *mCircleFillMesh, batch.getCircleFills() );
+	mPolygonShader.bind();
+	drawInstances( *mPolygonOutlineMesh, batch.getPolygonOutlines() );
+	mCircleShader.bind();
+	drawInstances( *mCircleOutlineMesh, batch.getCircleOutlines() );
+	mSegmentShader.bind();
+	drawInstances( *mSegmentMesh, batch.getSegments() );
+	gl::GlslProg::unbind();
+}
+
+} } // namespace cinder::box2d
@@ -0,0 +1,152 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/box2d/Simulation.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace box2d {
+
+Simulation::Simulation( const b2Vec2 &gravity, double timestep, int32 velocityIterations, int32 positionIterations )
+	: mWorld( new b2World( gravity ) ), mTimestep( timestep ), mVelocityIterations( velocityIterations ), mPositionIterations( positionIterations ),
+	mDebugFlags( 0 )
+{
+}
+
+Simulation::~Simulation()
+{
+	// the thread must be joined before the world it steps is destroyed
+	stop();
+}
+
+void Simulation::start()
+{
+	if( isRunning() )
+		return;
+
+	// the world may have been modified directly while stopped, so stepping restarts from a fresh snapshot of it
+	State initial;
+	initial.mWorld = mWorld.get();
+	publish( &initial );
+	mThread.reset( new FixedStepThread<State>( initial, mTimestep, std::bind( &Simulation::step, this, std::placeholders::_1, std::placeholders::_2 ) ) );
+	mThread->start();
+}
+
+void Simulation::stop()
+{
+	if( mThread )
+		mThread->stop();
+}
+
+void Simulation::setPaused( bool paused )
+{
+	if( mThread )
+		mThread->setPaused( paused );
+}
+
+void Simulation::post( const std::function<void ( b2World *world )> &fn )
+{
+	if( isRunning() )
+		mThread->post( [fn]( State *state ) { fn( state->mWorld ); } );
+	else
+		fn( mWorld.get() );
+}
+
+void Simulation::step( State *state, double timestep )
+{
+	state->mWorld->Step( (float32)timestep, mVelocityIterations, mPositionIterations );
+	publish( state );
+}
+
+// Called on the stepping thread, or on the main thread while it isn't running
+void Simulation::publish( State *state )
+{
+	state->mBodies.clear();
+	for( b2Body *body = state->mWorld->GetBodyList(); body; body = body->GetNext() ) {
+		Body published;
+		published.mBody = body;
+		published.mUserData = body->GetUserData();
+		published.mPosition = Vec2f( body->GetPosition().x, body->GetPosition().y );
+		published.mAngle = body->GetAngle();
+		published.mAwake = body->IsAwake();
+		state->mBodies.push_back( published );
+	}
+	// b2World prepends new bodies to its list
+	std::reverse( state->mBodies.begin(), state->mBodies.end() );
+
+	// the previous batch may still be read by the main thread, so each step records into a new one
+	const uint32 debugFlags = mDebugFlags;
+	if( debugFlags ) {
+		DebugBatchRef batch = DebugBatch::create( debugFlags );
+		batch->record( state->mWorld );
+		state->mDebugBatch = batch;
+	}
+	else
+		state->mDebugBatch.reset();
+}
+
+void Simulation::update()
+{
+	if( ! mThread ) {
+		State current;
+		current.mWorld = mWorld.get();
+		publish( &current );
+		mBodies.swap( current.mBodies );
+		mDebugBatch = current.mDebugBatch;
+		return;
+	}
+
+	const float t = mThread->getSnapshots( &mPrevious, &mCurrent );
+
+	// both snapshots list bodies in creation order, so a body of the current one is either found further along the previous one or was just created
+	mBodies = mCurrent.mBodies;
+	vector<Body>::const_iterator previousIt = mPrevious.mBodies.begin();
+	for( vector<Body>::iterator bodyIt = mBodies.begin(); bodyIt != mBodies.end(); ++bodyIt ) {
+		vector<Body>::const_iterator matchIt = previousIt;
+		while( ( matchIt != mPrevious.mBodies.end() ) && ( matchIt->mBody != bodyIt->mBody ) )
+			++matchIt;
+		if( matchIt == mPrevious.mBodies.end() )
+			continue;
+
+		bodyIt->mPosition = matchIt->mPosition.lerp( t, bodyIt->mPosition );
+		bodyIt->mAngle = lerp( matchIt->mAngle, bodyIt->mAngle, t );
+		previousIt = matchIt + 1;
+	}
+
+	mDebugBatch = mCurrent.mDebugBatch;
+}
+
+void Simulation::drawDebug()
+{
+	if( ! mDebugBatch )
+		return;
+
+	if( ! mDebugRenderer )
+		mDebugRenderer = DebugRenderer::create();
+	mDebugRenderer->draw( *mDebugBatch );
+}
+
+} } // namespace cinder::box2d
@@ -0,0 +1,81 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/cairo/Cairo.h"
+#include "cinder/gl/Texture.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace cairo {
+
+typedef std::shared_ptr<class SurfaceTexture>	SurfaceTextureRef;
+
+/** \brief A persistent cairo::SurfaceImage paired with a gl::Texture it is streamed into.
+ *
+ * The SurfaceImage is allocated once and drawn into each frame, then copied into the Texture's ring of pixel buffer objects, which upload
+ * asynchronously. Its premultiplied BGRA pixels are uploaded as they are, so no conversion to a cinder::Surface or new Texture is needed.
+ * renderTiled() rasterizes horizontal bands of the canvas on the TaskPool, each through its own Context, and copies each band into the
+ * mapped pixel buffer as soon as it is finished. Draw the Texture with gl::enableAlphaBlending( true ), since its alpha is premultiplied. **/
+class SurfaceTexture : private boost::noncopyable {
+  public:
+	//! Creates a \a width x \a height canvas, with an alpha channel if \a hasAlpha, streamed through \a numStreamBuffers pixel buffer objects
+	static SurfaceTextureRef	create( int32_t width, int32_t height, bool hasAlpha = true, int numStreamBuffers = 3 );
+
+	//! Draws into the whole canvas with \a drawFn on the calling thread, then uploads it. Clears the canvas to transparent black first if \a clear.
+	void	render( const std::function<void ( Context & )> &drawFn, bool clear = true );
+	/** \brief Draws the canvas in parallel bands of \a bandHeight rows on the TaskPool, then uploads it. Clears each band to transparent black first if \a clear.
+		\a drawFn is called concurrently, once per band, with a Context clipped to the band and translated so that it draws in canvas coordinates, along with the band's Area.
+		It must only touch state it owns or that is safe to share between threads, and can skip geometry outside of the Area. If \a bandHeight is 0 a height is chosen that gives each thread a few bands. **/
+	void	renderTiled( const std::function<void ( Context &, const Area & )> &drawFn, int32_t bandHeight = 0, bool clear = true );
+	//! Uploads the canvas after it has been modified through getSurface() directly
+	void	upload();
+
+	//! Returns the canvas, which keeps its pixels between frames
+	SurfaceImage&		getSurface() { return mSurface; }
+	//! Returns the Texture the canvas is uploaded into, whose alpha is premultiplied
+	const gl::Texture&	getTexture() const { return mTexture; }
+
+	int32_t	getWidth() const { return mSurface.getWidth(); }
+	int32_t	getHeight() const { return mSurface.getHeight(); }
+	Area	getBounds() const { return mSurface.getBounds(); }
+
+  private:
+	SurfaceTexture( int32_t width, int32_t height, bool hasAlpha, int numStreamBuffers );
+
+	void	updateBands( int32_t bandHeight );
+	void	unmapStreamBuffer( uint8_t *streamBuffer );
+
+	SurfaceImage				mSurface;
+	gl::Texture					mTexture;
+	bool						mHasAlpha;
+	int32_t						mBandHeight;
+	std::vector<SurfaceImage>	mBands;		// views of mSurface's rows, reused while mBandHeight is unchanged
+};
+
+} } // namespace cinder::cairo
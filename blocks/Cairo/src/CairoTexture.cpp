@@ -0,0 +1,156 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/cairo/CairoTexture.h"
+#include "cinder/gl/gl.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinder { namespace cairo {
+
+namespace {
+
+// Cairo's ARGB32 pixels are native-endian 32-bit words, which GL_BGRA with GL_UNSIGNED_INT_8_8_8_8_REV describes on any byte order
+const GLenum	PIXEL_DATA_FORMAT	= GL_BGRA;
+const GLenum	PIXEL_TYPE			= GL_UNSIGNED_INT_8_8_8_8_REV;
+
+void copyRows( const uint8_t *src, int32_t srcStride, uint8_t *dst, size_t dstRowBytes, int32_t numRows )
+{
+	if( srcStride == (int32_t)dstRowBytes )
+		memcpy( dst, src, dstRowBytes * numRows );
+	else {
+		for( int32_t y = 0; y < numRows; ++y, src += srcStride, dst += dstRowBytes )
+			memcpy( dst, src, dstRowBytes );
+	}
+}
+
+} // anonymous namespace
+
+SurfaceTextureRef SurfaceTexture::create( int32_t width, int32_t height, bool hasAlpha, int numStreamBuffers )
+{
+	return SurfaceTextureRef( new SurfaceTexture( width, height, hasAlpha, numStreamBuffers ) );
+}
+
+SurfaceTexture::SurfaceTexture( int32_t width, int32_t height, bool hasAlpha, int numStreamBuffers )
+	: mSurface( width, height, hasAlpha ), mHasAlpha( hasAlpha ), mBandHeight( 0 )
+{
+	gl::Texture::Format format;
+	format.setInternalFormat( hasAlpha ? GL_RGBA8 : GL_RGB8 );
+	format.enableStreaming( numStreamBuffers );
+	mTexture = gl::Texture( width, height, format );
+}
+
+void SurfaceTexture::render( const std::function<void ( Context & )> &drawFn, bool clear )
+{
+	if( clear ) {
+		memset( mSurface.getData(), 0, mSurface.getStride() * getHeight() );
+		mSurface.markDirty();
+	}
+
+	{
+		Context ctx( mSurface );
+		drawFn( ctx );
+	}
+
+	upload();
+}
+
+void SurfaceTexture::renderTiled( const std::function<void ( Context &, const Area & )> &drawFn, int32_t bandHeight, bool clear )
+{
+	if( bandHeight <= 0 ) {
+		const int32_t numBands = (int32_t)( TaskPool::get()->getNumThreads() + 1 ) * 3;
+		bandHeight = std::max<int32_t>( ( getHeight() + numBands - 1 ) / numBands, 16 );
+	}
+	updateBands( bandHeight );
+
+	// mapped up front so that each band is copied by the thread which drew it, while its pixels are still in cache
+	const size_t rowBytes = getWidth() * 4;
+	uint8_t *streamBuffer = reinterpret_cast<uint8_t*>( mTexture.mapStreamBuffer( rowBytes * getHeight() ) );
+
+	try {
+		TaskPool::get()->parallelFor( 0, mBands.size(), [&]( size_t first, size_t last ) {
+			for( size_t b = first; b < last; ++b ) {
+				SurfaceImage &band = mBands[b];
+				const int32_t y1 = (int32_t)b * mBandHeight;
+				if( clear ) {
+					memset( band.getData(), 0, band.getStride() * band.getHeight() );
+					band.markDirty();
+				}
+
+				{
+					Context ctx( band );
+					ctx.translate( 0, -y1 );
+					drawFn( ctx, Area( 0, y1, getWidth(), y1 + band.getHeight() ) );
+				}
+
+				band.flush();
+				if( streamBuffer )
+					copyRows( band.getData(), band.getStride(), streamBuffer + y1 * rowBytes, rowBytes, band.getHeight() );
+			}
+		}, 1 );
+	}
+	catch( ... ) {
+		unmapStreamBuffer( streamBuffer );
+		throw;
+	}
+
+	// the bands wrote to mSurface's pixels behind its back
+	mSurface.markDirty();
+	unmapStreamBuffer( streamBuffer );
+}
+
+void SurfaceTexture::upload()
+{
+	mSurface.flush();
+
+	const size_t rowBytes = getWidth() * 4;
+	uint8_t *streamBuffer = reinterpret_cast<uint8_t*>( mTexture.mapStreamBuffer( rowBytes * getHeight() ) );
+	if( streamBuffer )
+		copyRows( mSurface.getData(), mSurface.getStride(), streamBuffer, rowBytes, getHeight() );
+	unmapStreamBuffer( streamBuffer );
+}
+
+void SurfaceTexture::unmapStreamBuffer( uint8_t *streamBuffer )
+{
+	if( streamBuffer )
+		mTexture.unmapStreamBuffer( getBounds(), PIXEL_DATA_FORMAT, PIXEL_TYPE );
+	else // no pixel buffer objects, so upload synchronously
+		mTexture.update( mSurface.getSurface() );
+}
+
+void SurfaceTexture::updateBands( int32_t bandHeight )
+{
+	if( ( bandHeight == mBandHeight ) && ( ! mBands.empty() ) )
+		return;
+
+	mBandHeight = bandHeight;
+	mBands.clear();
+	uint8_t *data = mSurface.getData();
+	const int32_t stride = mSurface.getStride();
+	for( int32_t y = 0; y < getHeight(); y += mBandHeight )
+		mBands.push_back( SurfaceImage( data + y * stride, getWidth(), std::min( mBandHeight, getHeight() - y ), stride, mHasAlpha ) );
+}
+
+} } // namespace cinder::cairo
@@ -0,0 +1,224 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "OscDispatcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace osc {
+
+namespace {
+
+bool isWildcardPart( const string &part )
+{
+	return part.find_first_of( "?*[]{}" ) != string::npos;
+}
+
+const char* findPartEnd( const char *part )
+{
+	while( *part && *part != '/' )
+		++part;
+	return part;
+}
+
+} // anonymous namespace
+
+CallbackId Dispatcher::registerAddress( const string &addressPattern, const Callback &callback )
+{
+	Node *node = &mRoot;
+	for( const char *part = addressPattern.c_str(); *part; ) {
+		if( *part == '/' )
+			++part;
+		const char *partEnd = findPartEnd( part );
+		const string partStr( part, partEnd );
+		part = partEnd;
+
+		vector<Node::Child> &children = isWildcardPart( partStr ) ? node->mWildcardChildren : node->mLiteralChildren;
+		vector<Node::Child>::iterator childIt = children.begin();
+		while( childIt != children.end() && childIt->first < partStr )
+			++childIt;
+		if( childIt == children.end() || childIt->first != partStr )
+			childIt = children.insert( childIt, Node::Child( partStr, shared_ptr<Node>( new Node ) ) );
+		node = childIt->second.get();
+	}
+
+	CallbackId id = mNextId++;
+	node->mCallbacks.push_back( make_pair( id, callback ) );
+	mPatterns[id] = addressPattern;
+
+	return id;
+}
+
+void Dispatcher::unregisterAddress( CallbackId id )
+{
+	map<CallbackId, string>::iterator patternIt = mPatterns.find( id );
+	if( patternIt == mPatterns.end() )
+		return;
+
+	// walk down the pattern's literal path, which registerAddress() created, removing empty nodes on the way back up
+	vector<pair<vector<Node::Child>*, size_t> > path;
+	Node *node = &mRoot;
+	const string &addressPattern = patternIt->second;
+	for( const char *part = addressPattern.c_str(); *part; ) {
+		if( *part == '/' )
+			++part;
+		const char *partEnd = findPartEnd( part );
+		const string partStr( part, partEnd );
+		part = partEnd;
+
+		vector<Node::Child> &children = isWildcardPart( partStr ) ? node->mWildcardChildren : node->mLiteralChildren;
+		size_t c = 0;
+		while( children[c].first != partStr )
+			++c;
+		path.push_back( make_pair( &children, c ) );
+		node = children[c].second.get();
+	}
+
+	for( vector<pair<CallbackId, Callback> >::iterator cbIt = node->mCallbacks.begin(); cbIt != node->mCallbacks.end(); ++cbIt ) {
+		if( cbIt->first == id ) {
+			node->mCallbacks.erase( cbIt );
+			break;
+		}
+	}
+	mPatterns.erase( patternIt );
+
+	while( ! path.empty() ) {
+		vector<Node::Child> &children = *path.back().first;
+		const Node &child = *children[path.back().second].second;
+		if( ! child.mCallbacks.empty() || ! child.mLiteralChildren.empty() || ! child.mWildcardChildren.empty() )
+			break;
+		children.erase( children.begin() + path.back().second );
+		path.pop_back();
+	}
+}
+
+size_t Dispatcher::dispatch( const Message &message ) const
+{
+	const string &address = message.getAddress();
+	if( address.empty() || address[0] != '/' )
+		return 0;
+
+	return dispatch( mRoot, address.c_str(), message );
+}
+
+size_t Dispatcher::dispatch( const Node &node, const char *address, const Message &message ) const
+{
+	if( ! *address ) {
+		for( vector<pair<CallbackId, Callback> >::const_iterator cbIt = node.mCallbacks.begin(); cbIt != node.mCallbacks.end(); ++cbIt )
+			cbIt->second( &message );
+		return node.mCallbacks.size();
+	}
+
+	// address points at the '/' starting the next part
+	const char *part = address + 1;
+	const char *partEnd = findPartEnd( part );
+	const size_t partLength = partEnd - part;
+	size_t result = 0;
+
+	vector<Node::Child>::const_iterator literalIt = std::lower_bound( node.mLiteralChildren.begin(), node.mLiteralChildren.end(), make_pair( part, partLength ),
+		[] ( const Node::Child &lhs, const pair<const char*, size_t> &rhs ) { return lhs.first.compare( 0, string::npos, rhs.first, rhs.second ) < 0; } );
+	if( literalIt != node.mLiteralChildren.end() && literalIt->first.size() == partLength && memcmp( literalIt->first.data(), part, partLength ) == 0 )
+		result += dispatch( *literalIt->second, partEnd, message );
+
+	for( vector<Node::Child>::const_iterator wildIt = node.mWildcardChildren.begin(); wildIt != node.mWildcardChildren.end(); ++wildIt ) {
+		if( matchPart( wildIt->first.data(), wildIt->first.data() + wildIt->first.size(), part, partEnd ) )
+			result += dispatch( *wildIt->second, partEnd, message );
+	}
+
+	return result;
+}
+
+bool Dispatcher::matchPart( const char *pattern, const char *patternEnd, const char *str, const char *strEnd )
+{
+	while( pattern < patternEnd ) {
+		switch( *pattern ) {
+			case '*': {
+				while( pattern < patternEnd && *pattern == '*' )
+					++pattern;
+				if( pattern == patternEnd )
+					return true;
+				for( const char *s = str; s <= strEnd; ++s )
+					if( matchPart( pattern, patternEnd, s, strEnd ) )
+						return true;
+				return false;
+			}
+			case '?':
+				if( str == strEnd )
+					return false;
+				++pattern;
+				++str;
+			break;
+			case '[': {
+				if( str == strEnd )
+					return false;
+				++pattern;
+				const bool negate = ( pattern < patternEnd && *pattern == '!' );
+				if( negate )
+					++pattern;
+				bool matched = false;
+				while( pattern < patternEnd && *pattern != ']' ) {
+					if( pattern + 2 < patternEnd && pattern[1] == '-' && pattern[2] != ']' ) {
+						if( *str >= pattern[0] && *str <= pattern[2] )
+							matched = true;
+						pattern += 3;
+					}
+					else {
+						if( *str == *pattern )
+							matched = true;
+						++pattern;
+					}
+				}
+				if( pattern == patternEnd || matched == negate )
+					return false;
+				++pattern;
+				++str;
+			}
+			break;
+			case '{': {
+				const char *close = std::find( pattern, patternEnd, '}' );
+				if( close == patternEnd )
+					return false;
+				for( const char *alt = pattern + 1; alt <= close; ) {
+					const char *altEnd = std::find( alt, close, ',' );
+					const size_t altLength = altEnd - alt;
+					if( (size_t)( strEnd - str ) >= altLength && memcmp( alt, str, altLength ) == 0 && matchPart( close + 1, patternEnd, str + altLength, strEnd ) )
+						return true;
+					alt = altEnd + 1;
+				}
+				return false;
+			}
+			default:
+				if( str == strEnd || *str != *pattern )
+					return false;
+				++pattern;
+				++str;
+			break;
+		}
+	}
+
+	return str == strEnd;
+}
+
+} } // namespace cinder::osc
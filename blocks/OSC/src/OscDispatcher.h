@@ -0,0 +1,79 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Function.h"
+
+#include "OscMessage.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cinder { namespace osc {
+
+/** \brief Routes messages to the callbacks registered for the address patterns their addresses match.
+ *
+ * Patterns are split into their '/'-separated parts and compiled into a tree, so a message only visits the parts of the tree its address can match.
+ * Literal parts are found by binary search, and parts containing the OSC wildcards \c ?, \c *, <tt>[abc]</tt>, <tt>[a-z]</tt>, <tt>[!abc]</tt> and
+ * <tt>{foo,bar}</tt> are matched against the address's part at the same position. A Dispatcher isn't synchronized, and its callbacks must not register
+ * or unregister callbacks. **/
+class Dispatcher {
+  public:
+	typedef std::function<void (const osc::Message*)>	Callback;
+
+	Dispatcher() : mNextId( 0 ) {}
+
+	//! Registers \a callback for messages whose address matches \a addressPattern, such as \c "/sensor/*/accel"
+	CallbackId	registerAddress( const std::string &addressPattern, const Callback &callback );
+	//! Unregisters a callback previously registered with registerAddress()
+	void		unregisterAddress( CallbackId id );
+	//! Returns whether no callbacks are registered
+	bool		empty() const { return mPatterns.empty(); }
+
+	//! Calls every callback whose pattern matches \a message's address, in the order they were registered for the same pattern. Returns the number of callbacks called.
+	size_t		dispatch( const Message &message ) const;
+
+	//! Returns whether \a str, which contains no '/', matches the single pattern part \a pattern
+	static bool	matchPart( const char *pattern, const char *patternEnd, const char *str, const char *strEnd );
+
+  private:
+	struct Node {
+		typedef std::pair<std::string, std::shared_ptr<Node> >	Child;
+
+		std::vector<Child>								mLiteralChildren;	// sorted by part
+		std::vector<Child>								mWildcardChildren;
+		std::vector<std::pair<CallbackId, Callback> >	mCallbacks;
+	};
+
+	size_t	dispatch( const Node &node, const char *address, const Message &message ) const;
+
+	Node									mRoot;
+	std::map<CallbackId, std::string>		mPatterns;
+	CallbackId								mNextId;
+};
+
+} } // namespace cinder::osc
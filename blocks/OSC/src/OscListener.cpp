@@ -34,8 +34,9 @@
 
 #include <iostream>
 #include <assert.h>
-#include <deque>
+#include <atomic>
 #include <map>
+#include <vector>
 using namespace std;
 
 namespace cinder { namespace osc {
@@ -45,45 +46,75 @@ class OscListener : public ::osc::OscPacketListener {
 	OscListener();
 	~OscListener();
 	
-	void setup(int listen_port);
+	void setup( int listen_port, size_t queueCapacity );
 	
 	bool hasWaitingMessages() const;
 	bool getNextMessage( Message * );
+	size_t getNumDroppedMessages() const { return mNumDropped; }
 
 	CallbackId	registerMessageReceived( std::function<void (const osc::Message*)> callback );
 	void		unregisterMessageReceived( CallbackId id );
 	
+	CallbackId	registerAddress( const std::string &addressPattern, std::function<void (const osc::Message*)> callback );
+	void		unregisterAddress( CallbackId id );
+	void		setDispatchMode( Listener::DispatchMode mode ) { mDispatchMode = mode; }
+	Listener::DispatchMode	getDispatchMode() const { return static_cast<Listener::DispatchMode>( mDispatchMode.load() ); }
+	size_t		dispatchWaitingMessages();
+	
 	void shutdown();
 	
+	virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint );
+	
   protected:
 	virtual void ProcessMessage( const ::osc::ReceivedMessage &m, const IpEndpointName& remoteEndpoint );
 	
   private:
 	void threadSocket();
+	static void fillMessage( const ::osc::ReceivedMessage &m, const IpEndpointName& remoteEndpoint, Message *message );
 	
-	deque<Message*> mMessages;
+	// Single-producer single-consumer ring of Messages, filled in place by the socket thread and drained by getNextMessage() without locking.
+	// The indices count up indefinitely; a Message is reused once the ring wraps around, so its storage is only allocated while the ring first fills.
+	std::vector<Message>	mQueue;
+	std::atomic<size_t>		mReadIndex, mWriteIndex;
+	std::atomic<size_t>		mNumDropped;
 	
 	UdpListeningReceiveSocket* mListen_socket;
 	
 	mutable std::mutex mMutex;
 	std::shared_ptr<std::thread> mThread;
 	
-	CallbackMgr<void (const Message*)>	mMessageReceivedCbs;
+	CallbackMgr<void (const Message*)>	mMessageReceivedCbs;	// guarded by mMutex
+	std::atomic<bool>					mHasCallbacks;
+	Dispatcher							mDispatcher;			// guarded by mMutex
+	std::atomic<bool>					mHasAddressCallbacks;
+	std::atomic<int>					mDispatchMode;
+	Message								mCallbackMessage;		// reused by the socket thread for callbacks
+	
+	// state of the packet being processed, used only by the socket thread
+	size_t		mPacketWriteIndex;
+	bool		mPacketOverflowed, mPacketCallsCallbacks, mPacketDispatches;
 	bool mSocketHasShutdown;
 };
 
 OscListener::OscListener()
+	: mReadIndex( 0 ), mWriteIndex( 0 ), mNumDropped( 0 ), mHasCallbacks( false ), mHasAddressCallbacks( false ),
+	mDispatchMode( Listener::DISPATCH_MAIN_THREAD )
 {
 	mListen_socket = NULL;
 }
 
-void OscListener::setup(int listen_port)
+void OscListener::setup( int listen_port, size_t queueCapacity )
 {
 	if (mListen_socket) {
 		shutdown();
 	}
 	
 	mSocketHasShutdown = false;
+	mQueue.clear();
+	mQueue.resize( std::max<size_t>( 1, queueCapacity ) );
+	mReadIndex = 0;
+	mWriteIndex = 0;
+	mNumDropped = 0;
 	
 	mListen_socket = new UdpListeningReceiveSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, listen_port), this);
 
@@ -116,9 +147,55 @@ void OscListener::threadSocket() {
 	
 }
 
+// A packet, either a single message or a bundle, is handled as a unit: its callbacks are called under a single lock, and its queued messages are
+// published together once it has been processed, so getNextMessage() and dispatchWaitingMessages() never see part of a bundle.
+void OscListener::ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint ) {
+	unique_lock<mutex> lock( mMutex, defer_lock );
+	const bool receiveThreadDispatch = mHasAddressCallbacks && getDispatchMode() == Listener::DISPATCH_RECEIVE_THREAD;
+	if( mHasCallbacks || receiveThreadDispatch )
+		lock.lock();
+	mPacketCallsCallbacks = lock.owns_lock() && ! mMessageReceivedCbs.empty();
+	mPacketDispatches = lock.owns_lock() && receiveThreadDispatch && ! mDispatcher.empty();
+	
+	const size_t writeIndex = mWriteIndex.load( std::memory_order_relaxed );
+	mPacketWriteIndex = writeIndex;
+	mPacketOverflowed = false;
+	
+	::osc::OscPacketListener::ProcessPacket( data, size, remoteEndpoint );
+	
+	// a bundle which doesn't fit is dropped as a whole
+	if( mPacketOverflowed )
+		mNumDropped += mPacketWriteIndex - writeIndex;
+	else if( mPacketWriteIndex != writeIndex )
+		mWriteIndex.store( mPacketWriteIndex, std::memory_order_release );
+}
+
 void OscListener::ProcessMessage( const ::osc::ReceivedMessage &m, const IpEndpointName& remoteEndpoint ) {
-	Message* message = new Message();
+	if( mPacketCallsCallbacks ) {
+		fillMessage( m, remoteEndpoint, &mCallbackMessage );
+		mMessageReceivedCbs.call( &mCallbackMessage );
+		return;
+	}
+	
+	// messages matching no address pattern are queued for getNextMessage()
+	if( mPacketDispatches ) {
+		fillMessage( m, remoteEndpoint, &mCallbackMessage );
+		if( mDispatcher.dispatch( mCallbackMessage ) )
+			return;
+	}
 	
+	if( mPacketOverflowed || mPacketWriteIndex - mReadIndex.load( std::memory_order_acquire ) >= mQueue.size() ) {
+		mPacketOverflowed = true;
+		++mNumDropped;
+		return;
+	}
+	
+	fillMessage( m, remoteEndpoint, &mQueue[mPacketWriteIndex % mQueue.size()] );
+	++mPacketWriteIndex;
+}
+
+void OscListener::fillMessage( const ::osc::ReceivedMessage &m, const IpEndpointName& remoteEndpoint, Message *message ) {
+	message->clear();
 	message->setAddress(m.AddressPattern());
 	
 	char endpoint_host[IpEndpointName::ADDRESS_STRING_LENGTH];
@@ -136,35 +213,21 @@ void OscListener::ProcessMessage( const ::osc::ReceivedMessage &m, const IpEndpo
 			assert(false && "message argument type unknown");
 		}
 	}
-	
-	lock_guard<mutex> lock(mMutex);
-	
-	if( mMessageReceivedCbs.empty() ){
-		mMessages.push_back( message );
-	}else{
-		mMessageReceivedCbs.call( message );
-		delete message;
-	}
 }
 
 bool OscListener::hasWaitingMessages() const
 {
-	std::lock_guard<mutex> lock( mMutex );
-	return ! mMessages.empty();
+	return mReadIndex.load( std::memory_order_relaxed ) != mWriteIndex.load( std::memory_order_acquire );
 }
 
 bool OscListener::getNextMessage( Message* message )
 {
-	lock_guard<mutex> lock( mMutex );
-	
-	if( mMessages.empty() )
+	const size_t readIndex = mReadIndex.load( std::memory_order_relaxed );
+	if( readIndex == mWriteIndex.load( std::memory_order_acquire ) )
 		return false;
 	
-	Message* src_message = mMessages.front();
-	message->copy( *src_message );
-	
-	delete src_message;	
-	mMessages.pop_front();
+	message->copy( mQueue[readIndex % mQueue.size()] );
+	mReadIndex.store( readIndex + 1, std::memory_order_release );
 	
 	return true;
 }
@@ -172,13 +235,45 @@ bool OscListener::getNextMessage( Message* message )
 CallbackId OscListener::registerMessageReceived( std::function<void (const osc::Message*)> callback )
 {
 	lock_guard<mutex> lock( mMutex );
-	return mMessageReceivedCbs.registerCb( callback );
+	CallbackId result = mMessageReceivedCbs.registerCb( callback );
+	mHasCallbacks = true;
+	return result;
 }
 
 void OscListener::unregisterMessageReceived( CallbackId id )
 {
 	lock_guard<mutex> lock(mMutex);
-	return mMessageReceivedCbs.unregisterCb( id );
+	mMessageReceivedCbs.unregisterCb( id );
+	mHasCallbacks = ! mMessageReceivedCbs.empty();
+}
+
+CallbackId OscListener::registerAddress( const std::string &addressPattern, std::function<void (const osc::Message*)> callback )
+{
+	lock_guard<mutex> lock( mMutex );
+	CallbackId result = mDispatcher.registerAddress( addressPattern, callback );
+	mHasAddressCallbacks = true;
+	return result;
+}
+
+void OscListener::unregisterAddress( CallbackId id )
+{
+	lock_guard<mutex> lock( mMutex );
+	mDispatcher.unregisterAddress( id );
+	mHasAddressCallbacks = ! mDispatcher.empty();
+}
+
+size_t OscListener::dispatchWaitingMessages()
+{
+	lock_guard<mutex> lock( mMutex );
+	
+	// messages are dispatched straight from the queue, and everything published so far is consumed, including matching no pattern
+	const size_t readIndex = mReadIndex.load( std::memory_order_relaxed );
+	const size_t writeIndex = mWriteIndex.load( std::memory_order_acquire );
+	for( size_t i = readIndex; i != writeIndex; ++i )
+		mDispatcher.dispatch( mQueue[i % mQueue.size()] );
+	mReadIndex.store( writeIndex, std::memory_order_release );
+	
+	return writeIndex - readIndex;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -187,8 +282,8 @@ Listener::Listener() {
 	oscListener = std::shared_ptr<OscListener>( new OscListener );
 }
 
-void Listener::setup(int listen_port){
-	oscListener->setup(listen_port);
+void Listener::setup( int listen_port, size_t queueCapacity ){
+	oscListener->setup( listen_port, queueCapacity );
 }
 
 void Listener::shutdown(){
@@ -203,11 +298,40 @@ bool Listener::getNextMessage(Message* message) {
 	return oscListener->getNextMessage(message);
 }
 
+size_t Listener::getNumDroppedMessages() const {
+	return oscListener->getNumDroppedMessages();
+}
+
 CallbackId Listener::registerMessageReceived( std::function<void (const osc::Message*)> callback )
 {
 	return oscListener->registerMessageReceived( callback );
 }
 
+CallbackId Listener::registerAddress( const std::string &addressPattern, std::function<void (const osc::Message*)> callback )
+{
+	return oscListener->registerAddress( addressPattern, callback );
+}
+
+void Listener::unregisterAddress( CallbackId id )
+{
+	oscListener->unregisterAddress( id );
+}
+
+void Listener::setDispatchMode( DispatchMode mode )
+{
+	oscListener->setDispatchMode( mode );
+}
+
+Listener::DispatchMode Listener::getDispatchMode() const
+{
+	return oscListener->getDispatchMode();
+}
+
+size_t Listener::dispatchWaitingMessages()
+{
+	return oscListener->dispatchWaitingMessages();
+}
+
 void Listener::unregisterMessageReceived( CallbackId id )
 {
 	return oscListener->unregisterMessageReceived( id );
@@ -31,15 +31,28 @@
 
 #include "OscMessage.h"
 #include "OscArg.h"
+#include "OscDispatcher.h"
 
 
 namespace cinder { namespace osc {
 	
+//! Receives OSC messages on a background thread. Messages reach getNextMessage() through a lock-free queue, so hasWaitingMessages() and getNextMessage()
+//! must be called from a single thread. Passing the same Message to getNextMessage() each time reuses its storage, so that receiving doesn't allocate once
+//! message sizes have settled.
 class Listener {	
   public:
+	//! Where the callbacks registered with registerAddress() are called
+	enum DispatchMode {
+		//! Matching messages are queued, and their callbacks called by dispatchWaitingMessages()
+		DISPATCH_MAIN_THREAD,
+		//! Callbacks are called on the receiving thread as soon as a message arrives. Messages matching no pattern are queued for getNextMessage().
+		DISPATCH_RECEIVE_THREAD
+	};
+	
 	Listener();
 	
-	void setup(int listen_port);
+	//! Starts listening on \a listen_port. Up to \a queueCapacity messages wait for getNextMessage(), after which further messages are dropped until there is room again.
+	void setup( int listen_port, size_t queueCapacity = 4096 );
 	void shutdown();
 	
 	// Callback methods
@@ -50,11 +63,27 @@ class Listener {
 	CallbackId	registerMessageReceived( T *obj, void (T::*cb)(const osc::Message*) ) { return registerMessageReceived( std::bind1st( std::mem_fun( cb ), obj ) ); }
 	//! Unregisters an asynchronous callback previously registered with registerMessageReceived()
 	void		unregisterMessageReceived( CallbackId id );
+	
+	//! Registers \a callback for messages whose address matches \a addressPattern, which may contain the OSC wildcards <tt>? * [] {}</tt> within each of its parts.
+	//! Called according to the DispatchMode, and not at all while callbacks registered with registerMessageReceived() exist. Callbacks must not register or unregister callbacks.
+	CallbackId	registerAddress( const std::string &addressPattern, std::function<void (const osc::Message*)> callback );
+	template<typename T>
+	CallbackId	registerAddress( const std::string &addressPattern, T *obj, void (T::*cb)(const osc::Message*) ) { return registerAddress( addressPattern, std::bind1st( std::mem_fun( cb ), obj ) ); }
+	//! Unregisters a callback previously registered with registerAddress()
+	void		unregisterAddress( CallbackId id );
+	//! Sets where address callbacks are called. Defaults to DISPATCH_MAIN_THREAD.
+	void			setDispatchMode( DispatchMode mode );
+	DispatchMode	getDispatchMode() const;
+	//! Calls the address callbacks of all queued messages, consuming the queue, and returns the number of messages processed.
+	//! Messages of a bundle are always dispatched by the same call. Call once per frame, such as in update(), when using DISPATCH_MAIN_THREAD.
+	size_t		dispatchWaitingMessages();
 
 	//! Returns whether the are messages waiting to be processed via getNextMessage(). Always \c false if callbacks have been registered using registerMessageReceived().
 	bool hasWaitingMessages() const;
 	//! Gets the next message to be processed and puts it in \a resultMessage. Returns whether there was a message to process or not. Always \c false if callbacks have been registered using registerMessageReceived().
 	bool getNextMessage( Message *resultMessage );
+	//! Returns the number of messages dropped because the queue was full, since setup()
+	size_t getNumDroppedMessages() const;
 	
   private:
 	std::shared_ptr<class OscListener>   oscListener;
@@ -26,111 +26,135 @@
 
 #include "OscMessage.h"
 
-namespace cinder { namespace osc {
+#include <cstdio>
+#include <cstring>
 
-Message::~Message(){
-	clear();
-}
+namespace cinder { namespace osc {
 
 void Message::clear(){
-	for (unsigned int i=0; i < args.size(); ++i){
-		delete args[i];
-	}
-	args.clear();
-	address = "";
+	numArgs = 0;
+	extraArgs.clear();
+	stringData.clear();
+	address.clear();
 }
 
 int Message::getNumArgs() const{
-	return (int)args.size();
+	return numArgs;
 }
 
-ArgType Message::getArgType(int index) const{
-	if (index >= (int)args.size()){
+const Message::ArgValue& Message::getArgValue( int index ) const{
+	if ( index < 0 || index >= numArgs ){
 		throw OscExcOutOfBounds();
+	}
+	return ( index < INLINE_ARGS ) ? inlineArgs[index] : extraArgs[index - INLINE_ARGS];
+}
+
+Message::ArgValue& Message::appendArg( ArgType type ){
+	ArgValue *result;
+	if ( numArgs < INLINE_ARGS ){
+		result = &inlineArgs[numArgs];
 	}else {
-		return args[index]->getType();
+		extraArgs.push_back( ArgValue() );
+		result = &extraArgs.back();
 	}
+	++numArgs;
+	result->type = type;
+	return *result;
+}
+
+ArgType Message::getArgType(int index) const{
+	return getArgValue( index ).type;
 }
 
 std::string Message::getArgTypeName(int index) const{
-	if (index >= (int)args.size()){
-		throw OscExcOutOfBounds();
-	}else {
-		return args[index]->getTypeName();
+	switch ( getArgType( index ) ){
+		case TYPE_INT32: return "int32";
+		case TYPE_FLOAT: return "float";
+		case TYPE_STRING: return "string";
+		default: return "none";
 	}
 }
 
 int32_t Message::getArgAsInt32(int index, bool typeConvert) const{
-	if (getArgType(index) != TYPE_INT32){
-		if( typeConvert && (getArgType(index) == TYPE_FLOAT) )
-			return (int32_t)((ArgFloat*)args[index])->get();
+	const ArgValue &arg = getArgValue( index );
+	if (arg.type != TYPE_INT32){
+		if( typeConvert && (arg.type == TYPE_FLOAT) )
+			return (int32_t)arg.floatValue;
 		else
 			throw OscExcInvalidArgumentType();
 	}else 
-		return ((ArgInt32*)args[index])->get();
+		return arg.int32Value;
 }
 
 float Message::getArgAsFloat(int index, bool typeConvert) const{
-	if (getArgType(index) != TYPE_FLOAT){
-		if( typeConvert && (getArgType(index) == TYPE_INT32) )
-			return (float)((ArgInt32*)args[index])->get();
+	const ArgValue &arg = getArgValue( index );
+	if (arg.type != TYPE_FLOAT){
+		if( typeConvert && (arg.type == TYPE_INT32) )
+			return (float)arg.int32Value;
 		else
 			throw OscExcInvalidArgumentType();
 	}else
-        return ((ArgFloat*)args[index])->get();
+        return arg.floatValue;
 }
 
 std::string Message::getArgAsString( int index, bool typeConvert ) const{
-    if (getArgType(index) != TYPE_STRING ){
-	    if (typeConvert && (getArgType(index) == TYPE_FLOAT) ){
+	const ArgValue &arg = getArgValue( index );
+    if (arg.type != TYPE_STRING ){
+	    if (typeConvert && (arg.type == TYPE_FLOAT) ){
             char buf[1024];
-            sprintf(buf,"%f",((ArgFloat*)args[index])->get() );
+            sprintf(buf,"%f",arg.floatValue );
             return std::string( buf );
         }
-	    else if (typeConvert && (getArgType(index) == TYPE_INT32)){
+	    else if (typeConvert && (arg.type == TYPE_INT32)){
             char buf[1024];
-            sprintf(buf,"%i",((ArgInt32*)args[index])->get() );
+            sprintf(buf,"%i",arg.int32Value );
             return std::string( buf );
         }
         else
             throw OscExcInvalidArgumentType();
 	}
 	else
-        return ((ArgString*)args[index])->get();
+        return std::string( stringData.c_str() + arg.stringOffset );
+}
+
+const char* Message::getArgAsCString( int index ) const{
+	const ArgValue &arg = getArgValue( index );
+	if ( arg.type != TYPE_STRING )
+		throw OscExcInvalidArgumentType();
+	return stringData.c_str() + arg.stringOffset;
 }
 
 void Message::addIntArg( int32_t argument ){
-	args.push_back( new ArgInt32( argument ) );
+	appendArg( TYPE_INT32 ).int32Value = argument;
 }
 
 void Message::addFloatArg( float argument ){
-	args.push_back( new ArgFloat( argument ) );
+	appendArg( TYPE_FLOAT ).floatValue = argument;
 }
 
-void Message::addStringArg( std::string argument ){
-	args.push_back( new ArgString( argument ) );
+void Message::addStringArg( const std::string &argument ){
+	addStringArg( argument.c_str() );
+}
+
+void Message::addStringArg( const char *argument ){
+	appendArg( TYPE_STRING ).stringOffset = stringData.size();
+	stringData.append( argument, strlen( argument ) + 1 );
 }
 	
 Message& Message::copy( const Message& other ){
+	if ( this == &other )
+		return *this;
 
 	address = other.address;
 	
 	remote_host = other.remote_host;
 	remote_port = other.remote_port;
 	
-	for ( int i=0; i<(int)other.args.size(); ++i ){
-		ArgType argType = other.getArgType( i );
-		if ( argType == TYPE_INT32 )
-			args.push_back( new ArgInt32( other.getArgAsInt32( i ) ) );
-		else if ( argType == TYPE_FLOAT )
-			args.push_back( new ArgFloat( other.getArgAsFloat( i ) ) );
-		else if ( argType == TYPE_STRING )
-			args.push_back( new ArgString( other.getArgAsString( i ) ) );
-		else
-		{
-			throw OscExcInvalidArgumentType();
-		}
-	}
+	numArgs = other.numArgs;
+	for ( int i = 0; i < numArgs && i < INLINE_ARGS; ++i )
+		inlineArgs[i] = other.inlineArgs[i];
+	extraArgs = other.extraArgs;
+	stringData = other.stringData;
 	
 	return *this;
 }
@@ -35,21 +35,26 @@
 
 namespace cinder { namespace osc {
 	
+	//! An OSC message. Arguments are stored by value, the first few inside the Message itself and string arguments in a single buffer,
+	//! so a Message which is cleared and refilled, or assigned to, reuses its storage instead of allocating.
 	class Message {
 	public:
-		Message() {}
-		~Message();
-		Message( const Message& other ){ copy ( other ); }
+		Message() : remote_port( 0 ), numArgs( 0 ) {}
+		Message( const Message& other ) : remote_port( 0 ), numArgs( 0 ) { copy ( other ); }
 		Message& operator= ( const Message& other ) { return copy( other ); }
 
+		//! Replaces the contents of this Message with those of \a other
 		Message& copy( const Message& other );
+		//! Removes the address and all arguments, keeping the storage for reuse
 		void clear();
 		
-		std::string getAddress() const { return address; }
-		std::string getRemoteIp() const { return remote_host; }
+		const std::string& getAddress() const { return address; }
+		const std::string& getRemoteIp() const { return remote_host; }
 		int getRemotePort() const { return remote_port; }
-		void setAddress( std::string _address ) { address = _address; };
-		void setRemoteEndpoint( std::string host, int port ) { remote_host = host; remote_port = port; }
+		void setAddress( const std::string &_address ) { address = _address; }
+		void setAddress( const char *_address ) { address.assign( _address ); }
+		void setRemoteEndpoint( const std::string &host, int port ) { remote_host = host; remote_port = port; }
+		void setRemoteEndpoint( const char *host, int port ) { remote_host.assign( host ); remote_port = port; }
 		
 		int getNumArgs() const;
 		ArgType getArgType( int index ) const;
@@ -58,17 +63,38 @@ namespace cinder { namespace osc {
 		int32_t getArgAsInt32( int index, bool typeConvert = false ) const;
 		float getArgAsFloat( int index, bool typeConvert = false ) const;
 		std::string getArgAsString( int index, bool typeConvert = false ) const;
+		//! Returns the string argument at \a index without copying it. The pointer is valid until the Message is modified.
+		const char* getArgAsCString( int index ) const;
 		
 		void addIntArg( int32_t argument );
 		void addFloatArg( float argument );
-		void addStringArg( std::string argument );
+		void addStringArg( const std::string &argument );
+		void addStringArg( const char *argument );
 		
 	protected:
+		struct ArgValue {
+			ArgType		type;
+			union {
+				int32_t		int32Value;
+				float		floatValue;
+				size_t		stringOffset;	// into stringData
+			};
+		};
+
+		static const int INLINE_ARGS = 8;
+
+		const ArgValue&	getArgValue( int index ) const;
+		ArgValue&		appendArg( ArgType type );
+
 		std::string address;
-		std::vector<Arg*> args;
 		
 		std::string remote_host;
-		int remote_port;	
+		int remote_port;
+
+		int						numArgs;
+		ArgValue				inlineArgs[INLINE_ARGS];
+		std::vector<ArgValue>	extraArgs;		// arguments past INLINE_ARGS
+		std::string				stringData;		// string arguments, each followed by a '\0'
 	};
 	
 	class OscExc : public Exception {
@@ -32,6 +32,7 @@
 #include "ip/UdpSocket.h"
 
 #include <assert.h>
+#include <cstring>
 namespace cinder { namespace osc {
 	
 	class OscSender  {
@@ -43,12 +44,14 @@ namespace cinder { namespace osc {
 		
 		void sendMessage( const Message &message );
 		void sendBundle( const Bundle &bundle );
+		void sendEncoded( const EncodedMessage &message );
 		
 		void shutdown();
+		
+		static void appendMessage( const Message &message, ::osc::OutboundPacketStream &p );
 	private:
 		
 		void appendBundle( const Bundle &bundle, ::osc::OutboundPacketStream &p );
-		void appendMessage( const Message &message, ::osc::OutboundPacketStream &p );
 		
 		UdpTransmitSocket* socket;
 		
@@ -101,6 +104,12 @@ void OscSender::sendMessage( const Message &message )
 	socket->Send(p.Data(), p.Size());
 }
 
+void OscSender::sendEncoded( const EncodedMessage &message )
+{
+	if( message.getSize() )
+		socket->Send( message.getData(), (int)message.getSize() );
+}
+
 void OscSender::appendBundle( const Bundle &bundle, ::osc::OutboundPacketStream& p )
 {
 	p << ::osc::BeginBundleImmediate;
@@ -117,18 +126,73 @@ void OscSender::appendBundle( const Bundle &bundle, ::osc::OutboundPacketStream&
 void OscSender::appendMessage( const Message& message, ::osc::OutboundPacketStream& p ){
 	p << ::osc::BeginMessage( message.getAddress().c_str() );
 	for (int i = 0; i < message.getNumArgs(); ++i) {
-		if (message.getArgType(i) == TYPE_INT32){
+		const ArgType type = message.getArgType(i);
+		if (type == TYPE_INT32){
 			p << message.getArgAsInt32(i);
-		}else if (message.getArgType(i) == TYPE_FLOAT){
+		}else if (type == TYPE_FLOAT){
 			p << message.getArgAsFloat(i);
-		}else if (message.getArgType(i) == TYPE_STRING){
-			p << message.getArgAsString(i).c_str();
+		}else if (type == TYPE_STRING){
+			p << message.getArgAsCString(i);
 		}else {
 			throw OscExcInvalidArgumentType();
 		}
 	}
 	p << ::osc::EndMessage;
 }
+
+namespace {
+
+// OSC strings are null-terminated and padded to a multiple of 4 bytes
+size_t paddedStringSize( size_t length )
+{
+	return ( length + 4 ) & ~size_t( 3 );
+}
+
+} // anonymous namespace
+
+EncodedMessage::EncodedMessage( const Message &message )
+{
+	static const int OUTPUT_BUFFER_SIZE = 16384;
+	char buffer[OUTPUT_BUFFER_SIZE];
+	::osc::OutboundPacketStream p( buffer, OUTPUT_BUFFER_SIZE );
+	OscSender::appendMessage( message, p );
+	data.assign( p.Data(), p.Data() + p.Size() );
+	
+	// the arguments follow the address and the type tag string, which is a ',' and one tag per argument
+	size_t offset = paddedStringSize( message.getAddress().size() ) + paddedStringSize( 1 + message.getNumArgs() );
+	for( int i = 0; i < message.getNumArgs(); ++i ) {
+		const ArgType type = message.getArgType( i );
+		argTypes.push_back( type );
+		argOffsets.push_back( offset );
+		offset += ( type == TYPE_STRING ) ? paddedStringSize( strlen( message.getArgAsCString( i ) ) ) : 4;
+	}
+}
+
+void EncodedMessage::setInt32( int index, int32_t value )
+{
+	writeBigEndian( index, TYPE_INT32, (uint32_t)value );
+}
+
+void EncodedMessage::setFloat( int index, float value )
+{
+	uint32_t bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	writeBigEndian( index, TYPE_FLOAT, bits );
+}
+
+void EncodedMessage::writeBigEndian( int index, ArgType type, uint32_t bits )
+{
+	if( index < 0 || index >= (int)argTypes.size() )
+		throw OscExcOutOfBounds();
+	if( argTypes[index] != type )
+		throw OscExcInvalidArgumentType();
+	
+	char *dst = &data[argOffsets[index]];
+	dst[0] = (char)( bits >> 24 );
+	dst[1] = (char)( bits >> 16 );
+	dst[2] = (char)( bits >> 8 );
+	dst[3] = (char)bits;
+}
 	
 	
 Sender::Sender()
@@ -150,6 +214,11 @@ void Sender::sendBundle( const Bundle& bundle )
 {
 	oscSender->sendBundle( bundle );
 }
+
+void Sender::sendMessage( const EncodedMessage& message )
+{
+	oscSender->sendEncoded( message );
+}
 	
 }// namespace cinder
 }// namespace osc
\ No newline at end of file
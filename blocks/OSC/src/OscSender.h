@@ -28,11 +28,37 @@
 
 class UdpTransmitSocket;
 #include <string>
+#include <vector>
 #include "OscBundle.h"
 #include "OscMessage.h"
 
 namespace cinder { namespace osc {
 
+//! A Message encoded once into OSC packet bytes, for sending the same address and argument types repeatedly.
+//! Its int32 and float arguments can be rewritten in place before each send. Strings can't, as that would change the packet's layout.
+class EncodedMessage {
+  public:
+	EncodedMessage() {}
+	//! Encodes \a message. Throws OscExcInvalidArgumentType if it holds an argument type which can't be sent.
+	explicit EncodedMessage( const Message &message );
+	
+	int getNumArgs() const { return (int)argTypes.size(); }
+	//! Replaces the int32 argument at \a index. Throws OscExcOutOfBounds or OscExcInvalidArgumentType if there is no such argument.
+	void setInt32( int index, int32_t value );
+	//! Replaces the float argument at \a index. Throws OscExcOutOfBounds or OscExcInvalidArgumentType if there is no such argument.
+	void setFloat( int index, float value );
+	
+	const char* getData() const { return data.empty() ? 0 : &data[0]; }
+	size_t getSize() const { return data.size(); }
+	
+  private:
+	void writeBigEndian( int index, ArgType type, uint32_t bits );
+	
+	std::vector<char>		data;
+	std::vector<ArgType>	argTypes;
+	std::vector<size_t>		argOffsets;		// into data
+};
+
 class Sender  {
   public:
 	Sender();
@@ -41,6 +67,8 @@ class Sender  {
 	
 	void sendMessage( const Message& message );
 	void sendBundle( const Bundle& bundle );
+	//! Sends \a message without encoding it again
+	void sendMessage( const EncodedMessage& message );
 	
   private:
 	 std::shared_ptr<class OscSender>   oscSender;
@@ -31,6 +31,7 @@
 #include "cinder/Thread.h"
 #include "cinder/Function.h"
 #include "cinder/app/TouchEvent.h"
+#include "cinder/app/TouchCoalescer.h"
 #include "OscListener.h"
 #include "OscMessage.h"
 
@@ -150,6 +151,14 @@ class Client {
 	template<typename APP>
 	void	registerTouches( APP *app ) { registerTouchesBegan( app, &APP::touchesBegan ); registerTouchesMoved( app, &APP::touchesMoved ); registerTouchesEnded( app, &APP::touchesEnded ); }
 
+	//! Sets whether the touches callbacks are coalesced into at most one touchesBegan, touchesMoved and touchesEnded event per frame, called on the main thread
+	//! from the App's update signal instead of asynchronously. \a keepHistory retains every merged sample for app::TouchEvent::getHistory(). Disabled by default.
+	void	enableTouchCoalescing( bool enable = true, bool keepHistory = false );
+	//! Returns whether the touches callbacks are coalesced into at most one event of each kind per frame
+	bool	isTouchCoalescingEnabled() const { return mCoalesceTouches; }
+	//! Delivers the touches coalesced since the last call. Called automatically before each App::update() while coalescing is enabled.
+	void	flushTouches();
+
 	//! Returns a std::vector of all active touches, derived from \c 2Dcur (Cursor) messages
 	std::vector<app::TouchEvent::Touch>		getActiveTouches(std::string source = "") const;
 
@@ -175,6 +184,8 @@ class Client {
 
 	bool				mConnected;
 	int32_t				mPastFrameThreshold;
+	bool				mCoalesceTouches;
+	signals::scoped_connection	mUpdateConnection;
 	mutable std::mutex	mMutex;
 };
 	
@@ -37,10 +37,12 @@ namespace cinder { namespace tuio {
 // This class handles each of the profile types, currently Object: '2Dobj' and Cursor: '2Dcur'
 template<typename T>
 struct ProfileHandler {
-	ProfileHandler() {}
+	ProfileHandler() : mCoalesceTouches( false ), mReceivingCoalescer( 0 ) {}
 
 	void			handleMessage( const osc::Message &message, int32_t pastFrameThreshold );
 	std::vector<T>	getInstancesAsVector(std::string source = "") const;
+	void			setTouchCoalescing( bool enable, bool keepHistory );
+	void			flushTouches();
 
 	std::set<std::string>					mSources;
 
@@ -59,9 +61,42 @@ struct ProfileHandler {
 
 	CallbackMgr<void (T)>					mAddedCallbacks, mUpdatedCallbacks, mRemovedCallbacks;
 	CallbackMgr<void (app::TouchEvent)>		mTouchesBeganCb, mTouchesMovedCb, mTouchesEndedCb;
+	// reused by each 'fseq'
+	std::vector<app::TouchEvent::Touch>		mBeganTouches, mMovedTouches, mEndedTouches;
+
+	// the receiving thread fills one coalescer while flushTouches() delivers the other, so that callbacks run without mMutex held
+	bool						mCoalesceTouches;
+	app::TouchCoalescer			mCoalescers[2];
+	size_t						mReceivingCoalescer;
 	mutable std::mutex			mMutex;
 };
 
+template<typename T>
+void ProfileHandler<T>::setTouchCoalescing( bool enable, bool keepHistory )
+{
+	lock_guard<mutex> lock( mMutex );
+	mCoalesceTouches = enable;
+	mCoalescers[0].setHistoryEnabled( keepHistory );
+	mCoalescers[1].setHistoryEnabled( keepHistory );
+}
+
+template<typename T>
+void ProfileHandler<T>::flushTouches()
+{
+	app::TouchCoalescer *delivering;
+	{
+		lock_guard<mutex> lock( mMutex );
+		delivering = &mCoalescers[mReceivingCoalescer];
+		mReceivingCoalescer ^= 1;
+	}
+
+	if( delivering->hasPendingTouches() )
+		delivering->flush( app::WindowRef(),
+			[this]( app::TouchEvent *event ) { mTouchesBeganCb.call<const app::TouchEvent&>( *event ); },
+			[this]( app::TouchEvent *event ) { mTouchesMovedCb.call<const app::TouchEvent&>( *event ); },
+			[this]( app::TouchEvent *event ) { mTouchesEndedCb.call<const app::TouchEvent&>( *event ); } );
+}
+
 template<typename T>
 void ProfileHandler<T>::handleMessage( const osc::Message &message, int32_t pastFrameThreshold )
 {
@@ -110,44 +145,52 @@ void ProfileHandler<T>::handleMessage( const osc::Message &message, int32_t past
 		int32_t dframe = frame - prev_frame;
 
 		if( ( frame == -1 ) || ( dframe > 0 ) || ( dframe < -pastFrameThreshold ) ) {
+			app::TouchCoalescer &coalescer = mCoalescers[mReceivingCoalescer];
+
 			// propagate the newly added instances
-			vector<app::TouchEvent::Touch> beganTouches;
+			mBeganTouches.clear();
 			for( typename vector<T>::const_iterator addIt = mAdds[source].begin(); addIt != mAdds[source].end(); ++addIt ) {
 				mInstances[source][addIt->getSessionId()] = *addIt;
-				beganTouches.push_back( addIt->getTouch( currentTime, app::getWindowSize() ) );
+				mBeganTouches.push_back( addIt->getTouch( currentTime, app::getWindowSize() ) );
 				mAddedCallbacks.call( *addIt );
 			}
 		
-			// send a touchesBegan
-			if( ! beganTouches.empty() )
-				mTouchesBeganCb.call( app::TouchEvent( app::WindowRef(), beganTouches ) );
+			// send a touchesBegan, or hold it for flushTouches()
+			for( vector<app::TouchEvent::Touch>::const_iterator touchIt = mBeganTouches.begin(); mCoalesceTouches && touchIt != mBeganTouches.end(); ++touchIt )
+				coalescer.touchBegan( *touchIt );
+			if( ! mCoalesceTouches && ! mBeganTouches.empty() )
+				mTouchesBeganCb.call( app::TouchEvent( app::WindowRef(), mBeganTouches ) );
 
 			// propagate the updated instances
-			vector<app::TouchEvent::Touch> movedTouches;
+			mMovedTouches.clear();
 			for( typename vector<T>::const_iterator updateIt = mUpdates[source].begin(); updateIt != mUpdates[source].end(); ++updateIt ) {
 				mInstances[source][updateIt->getSessionId()] = *updateIt;
-				movedTouches.push_back( updateIt->getTouch( currentTime, app::getWindowSize() ) );
+				mMovedTouches.push_back( updateIt->getTouch( currentTime, app::getWindowSize() ) );
 				mUpdatedCallbacks.call( *updateIt );
 			}
 
-			// send a touchesMoved
-			if( ! movedTouches.empty() )
-				mTouchesMovedCb.call( app::TouchEvent( app::WindowRef(), movedTouches ) );
+			// send a touchesMoved, or hold it for flushTouches()
+			for( vector<app::TouchEvent::Touch>::const_iterator touchIt = mMovedTouches.begin(); mCoalesceTouches && touchIt != mMovedTouches.end(); ++touchIt )
+				coalescer.touchMoved( *touchIt );
+			if( ! mCoalesceTouches && ! mMovedTouches.empty() )
+				mTouchesMovedCb.call( app::TouchEvent( app::WindowRef(), mMovedTouches ) );
 
 			// propagate the deleted instances
-			vector<app::TouchEvent::Touch> endedTouches;
+			mEndedTouches.clear();
 			for( vector<int32_t>::const_iterator deleteIt = mDeletes[source].begin(); deleteIt != mDeletes[source].end(); ++deleteIt ) {
 				mRemovedCallbacks.call( mInstances[source][*deleteIt] );
 
-				endedTouches.push_back( mInstances[source][*deleteIt].getTouch( currentTime, app::getWindowSize() ) );
+				mEndedTouches.push_back( mInstances[source][*deleteIt].getTouch( currentTime, app::getWindowSize() ) );
 
 				// call this last - we're using it in the callbacks
 				mInstances[source].erase( *deleteIt );
 			}
 
-			// send a touchesEnded
-			if( ! endedTouches.empty() )
-				mTouchesEndedCb.call( app::TouchEvent( app::WindowRef(), endedTouches ) );
+			// send a touchesEnded, or hold it for flushTouches()
+			for( vector<app::TouchEvent::Touch>::const_iterator touchIt = mEndedTouches.begin(); mCoalesceTouches && touchIt != mEndedTouches.end(); ++touchIt )
+				coalescer.touchEnded( *touchIt );
+			if( ! mCoalesceTouches && ! mEndedTouches.empty() )
+				mTouchesEndedCb.call( app::TouchEvent( app::WindowRef(), mEndedTouches ) );
 
 			mPreviousFrame[source] = ( frame == -1 ) ? mPreviousFrame[source] : frame;
 		}
@@ -193,8 +236,27 @@ Client::Client()
 	: mHandlerObject( new ProfileHandler<Object>() ),
 	  mHandlerCursor( new ProfileHandler<Cursor>() ),
 	  mHandlerCursor25d( new ProfileHandler<Cursor25d>() ),
-	  mPastFrameThreshold( DEFAULT_PAST_FRAME_THRESHOLD )
+	  mPastFrameThreshold( DEFAULT_PAST_FRAME_THRESHOLD ),
+	  mCoalesceTouches( false )
+{
+}
+
+void Client::enableTouchCoalescing( bool enable, bool keepHistory )
+{
+	if( mCoalesceTouches && ! enable )
+		flushTouches();
+
+	mHandlerCursor->setTouchCoalescing( enable, keepHistory );
+	mCoalesceTouches = enable;
+	if( enable )
+		mUpdateConnection = app::App::get()->getSignalUpdate().connect( std::bind( &Client::flushTouches, this ) );
+	else
+		mUpdateConnection.disconnect();
+}
+
+void Client::flushTouches()
 {
+	mHandlerCursor->flushTouches();
 }
 
 void Client::connect( int port )
@@ -0,0 +1,114 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Exception.h"
+
+#include <vector>
+#include <utility>
+
+namespace cinder {
+
+typedef std::shared_ptr<class AssetArchive>	AssetArchiveRef;
+
+//! \brief A read-only, memory mapped archive of many assets packed into a single file.
+//!
+//! An archive is written once at build time with AssetArchive::write() and opened at runtime with AssetArchive::create(), which maps the file and reads its index.
+//! Entries are located by a binary search over the hashes of their names, and uncompressed entries are returned as a DataSourceBuffer that references the mapping
+//! directly, so loading an entry involves no file system access and no copy. Compressed entries are inflated into a new Buffer when they are loaded.
+//! Pass an archive to app::addAssetArchive() to have app::loadAsset() and app::loadResource() search it before the asset directories.
+class AssetArchive : private boost::noncopyable {
+  public:
+	class Format {
+	  public:
+		Format() : mCompressionLevel( 0 ), mMinCompressionRatio( 0.9f ), mAlignment( 16 ) {}
+
+		//! Sets the zlib compression level (1 - 9) entries are compressed with, or \c 0 to store all entries uncompressed. Default is \c 0.
+		Format&		compression( int level ) { mCompressionLevel = level; return *this; }
+		//! Sets the ratio of compressed to uncompressed size below which an entry is stored compressed. Entries which compress poorly, such as PNGs or JPEGs, are stored uncompressed so they can still be loaded without a copy. Default is \c 0.9.
+		Format&		minCompressionRatio( float ratio ) { mMinCompressionRatio = ratio; return *this; }
+		//! Sets the alignment in bytes of each entry's data within the archive, which must be a power of two. Default is \c 16.
+		Format&		alignment( size_t bytes ) { mAlignment = bytes; return *this; }
+
+		int			getCompressionLevel() const { return mCompressionLevel; }
+		float		getMinCompressionRatio() const { return mMinCompressionRatio; }
+		size_t		getAlignment() const { return mAlignment; }
+
+	  private:
+		int			mCompressionLevel;
+		float		mMinCompressionRatio;
+		size_t		mAlignment;
+	};
+
+	//! Maps the archive at \a path and reads its index. Throws AssetArchiveExc if the file can't be mapped or isn't a valid archive.
+	static AssetArchiveRef	create( const fs::path &path );
+
+	//! Writes an archive of every file beneath \a directory to \a target, each named by its path relative to \a directory. Hidden files are skipped. Throws AssetArchiveExc on failure.
+	static void		write( const DataTargetRef &target, const fs::path &directory, const Format &format = Format() );
+	//! Writes an archive of \a entries, each a relative name and the DataSource of its contents, to \a target. Throws AssetArchiveExc on failure or if two entries share a name.
+	static void		write( const DataTargetRef &target, const std::vector<std::pair<fs::path, DataSourceRef> > &entries, const Format &format = Format() );
+
+	//! Returns whether the archive contains an entry named \a relativePath.
+	bool			contains( const fs::path &relativePath ) const { return findEntry( relativePath ) != 0; }
+	//! Returns a DataSource for the entry named \a relativePath, with \a relativePath as its file path hint. The Buffer of an uncompressed entry references the mapping and shouldn't be modified. Throws AssetArchiveExc if there is no such entry.
+	DataSourceRef	load( const fs::path &relativePath ) const;
+
+	//! Returns the number of entries in the archive.
+	size_t			getNumEntries() const { return mEntries.size(); }
+	//! Returns the name of the entry at \a index. Entries are in hash order rather than alphabetical.
+	std::string		getEntryName( size_t index ) const { return std::string( mEntries[index].mName, mEntries[index].mNameLength ); }
+	//! Returns the path of the archive file.
+	const fs::path&	getFilePath() const { return mFilePath; }
+
+  protected:
+	AssetArchive( const fs::path &path );
+
+	struct Entry {
+		uint64_t		mHash;
+		uint64_t		mOffset, mStoredSize, mSize;
+		const char		*mName;
+		uint32_t		mNameLength;
+		uint32_t		mFlags;
+	};
+
+	const Entry*	findEntry( const fs::path &relativePath ) const;
+
+	fs::path				mFilePath;
+	MemoryMappedFileRef		mMappedFile;
+	std::vector<Entry>		mEntries;
+};
+
+class AssetArchiveExc : public cinder::Exception {
+  public:
+	AssetArchiveExc( const std::string &description ) throw();
+	virtual const char* what() const throw() { return mMessage; }
+
+  private:
+	char mMessage[1024];
+};
+
+} // namespace cinder
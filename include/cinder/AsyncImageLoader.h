@@ -0,0 +1,142 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataSource.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+#include "cinder/Thread.h"
+#include "cinder/gl/Texture.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace cinder {
+
+class TaskPool;
+
+typedef std::shared_ptr<class AsyncImageLoader>		AsyncImageLoaderRef;
+typedef std::shared_ptr<class AsyncImageRequest>	AsyncImageRequestRef;
+
+//! A request made to an AsyncImageLoader. Pending requests can be re-prioritized or canceled.
+class AsyncImageRequest : private boost::noncopyable {
+  public:
+	enum State { PENDING, LOADING, COMPLETE, FAILED, CANCELED };
+
+	//! Cancels the request. Returns true if it hadn't started loading yet, in which case it is removed from the queue. Otherwise the load is finished, but its callback won't be called.
+	bool	cancel();
+	//! Sets the priority of the request, which takes effect if it is still pending. Requests with higher priorities are loaded first.
+	void	setPriority( int32_t priority );
+	//! Returns the priority of the request.
+	int32_t	getPriority() const;
+	//! Returns the State of the request.
+	State	getState() const					{ return static_cast<State>( mState.load() ); }
+	//! Returns whether the request has been canceled.
+	bool	isCanceled() const					{ return getState() == CANCELED; }
+
+	//! Returns the DataSource being loaded.
+	const DataSourceRef&	getDataSource() const	{ return mDataSource; }
+	//! Returns the decoded Surface once the request is COMPLETE. Requests made with AsyncImageLoader::loadTexture() don't keep one.
+	const Surface&			getSurface() const		{ return mSurface; }
+	//! Returns the Texture of a request made with AsyncImageLoader::loadTexture() once it is COMPLETE.
+	const gl::Texture&		getTexture() const		{ return mTexture; }
+	//! Returns a description of the error if the request FAILED.
+	const std::string&		getErrorMessage() const	{ return mErrorMessage; }
+
+  private:
+	typedef std::multimap<int32_t, AsyncImageRequestRef, std::greater<int32_t> >	Queue;
+
+	AsyncImageRequest( const std::weak_ptr<AsyncImageLoader> &loader, const DataSourceRef &dataSource, int32_t priority );
+
+	std::weak_ptr<AsyncImageLoader>					mLoader;
+	DataSourceRef									mDataSource;
+	ImageSource::Options							mOptions;
+	std::function<void ( const AsyncImageRequestRef & )>	mCallback;
+	std::function<Surface ( const Surface & )>		mProcessFn;
+	bool											mUploadTexture;
+	gl::Texture::Format								mTextureFormat;
+
+	int32_t											mPriority;	// guarded by the AsyncImageLoader's mutex
+	Queue::iterator									mQueueIt;	// guarded by the AsyncImageLoader's mutex, valid while PENDING
+	std::atomic<int>								mState;
+
+	Surface											mSurface;
+	gl::Texture										mTexture;
+	gl::TextureImageTargetRef						mTextureTarget;	// mapped and released on the main thread, decoded into on a worker
+	std::string										mErrorMessage;
+
+	friend class AsyncImageLoader;
+};
+
+//! \brief Loads images in the background on a TaskPool, highest priority first.
+//!
+//! Callbacks are called on the App's main thread after the next update(), with App::dispatchAsync(). If there is no App, they're called on the loading thread.
+//! Requests that are no longer needed, for example images scrolled out of view, should be canceled so that they don't delay newer ones.
+class AsyncImageLoader : public std::enable_shared_from_this<AsyncImageLoader>, private boost::noncopyable {
+  public:
+	typedef std::function<void ( const AsyncImageRequestRef &request )>	Callback;
+	typedef std::function<Surface ( const Surface &surface )>			ProcessFn;
+
+	//! Creates an AsyncImageLoader that loads at most \a maxConcurrentLoads images at a time on \a taskPool. If \a maxConcurrentLoads is 0, the number of \a taskPool's threads is used. If \a taskPool is null, TaskPool::get() is used.
+	static AsyncImageLoaderRef	create( size_t maxConcurrentLoads = 0, TaskPool *taskPool = nullptr );
+
+	//! Queues \a dataSource to be decoded into a Surface with \a priority and \a options. \a callback is called with the request once it has COMPLETED or FAILED, unless it is canceled first.
+	AsyncImageRequestRef	load( const DataSourceRef &dataSource, const Callback &callback, int32_t priority = 0, const ImageSource::Options &options = ImageSource::Options() );
+	//! Queues \a dataSource to be decoded into a Surface, which is passed through \a processFn on the loading thread, for example to downsample it, before \a callback is called with the result.
+	AsyncImageRequestRef	loadAndProcess( const DataSourceRef &dataSource, const ProcessFn &processFn, const Callback &callback, int32_t priority = 0, const ImageSource::Options &options = ImageSource::Options() );
+	//! Queues \a dataSource to be uploaded into a gl::Texture with \a format before \a callback is called. With an App the image is decoded on a worker straight into texture memory mapped on the main thread, otherwise through a Surface.
+	AsyncImageRequestRef	loadTexture( const DataSourceRef &dataSource, const Callback &callback, int32_t priority = 0, const gl::Texture::Format &format = gl::Texture::Format(), const ImageSource::Options &options = ImageSource::Options() );
+
+	//! Cancels all requests.
+	void	cancelAll();
+	//! Returns the number of requests that haven't started loading yet.
+	size_t	getNumPending() const;
+	//! Returns the maximum number of images loaded at a time.
+	size_t	getMaxConcurrentLoads() const	{ return mMaxConcurrentLoads; }
+
+  private:
+	AsyncImageLoader( size_t maxConcurrentLoads, TaskPool *taskPool );
+
+	AsyncImageRequestRef	enqueue( const DataSourceRef &dataSource, const Callback &callback, int32_t priority, const ImageSource::Options &options, bool uploadTexture, const gl::Texture::Format &format, const ProcessFn &processFn = ProcessFn() );
+	void					processRequests();
+	void					mapTexture( const AsyncImageRequestRef &request, const ImageSourceRef &imageSource );
+	void					decodeTexture( const AsyncImageRequestRef &request, const ImageSourceRef &imageSource );
+	void					fail( const AsyncImageRequestRef &request, const std::exception &exc );
+	void					deliver( const AsyncImageRequestRef &request );
+
+	TaskPool*					mTaskPool;
+	size_t						mMaxConcurrentLoads;
+	mutable std::mutex			mMutex;
+	AsyncImageRequest::Queue	mQueue;		// guarded by mMutex
+	size_t						mNumActiveWorkers;	// guarded by mMutex
+
+	friend class AsyncImageRequest;
+};
+
+} // namespace cinder
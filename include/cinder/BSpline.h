@@ -75,6 +75,8 @@ class BSplineBasis
 
 	// evaluate basis functions and their derivatives
 	void compute( float fTime, unsigned int uiOrder, int &riMinIndex, int &riMaxIndex ) const;
+	//! Returns the index of the knot span containing \a time, after clamping or wrapping \a time to [0,1] as compute() does. The span's knots are returned in \a spanBegin and \a spanEnd.
+	int getSpan( float &time, float *spanBegin, float *spanEnd ) const;
 
  protected:
 	int initialize( int iNumCtrlPoints, int iDegree, bool bOpen );
@@ -174,6 +176,13 @@ class BSpline
 	//! Returns the time associated with an arc length in the range [0,getLength(0,1)]
 	float getTime( float length ) const;
 
+	//! Evaluates the spline at the \a count parameters of \a times, writing positions to \a positions and first derivatives to \a derivatives, either of which may be NULL. Each knot span's polynomial is computed once and reused while consecutive parameters fall within it, so sorted parameters are the fastest to evaluate. Splines of degree above 3 are evaluated one parameter at a time.
+	void sample( const float *times, size_t count, T *positions, T *derivatives = NULL ) const;
+	//! Evaluates the spline at \a count parameters spaced uniformly from \a t0 through \a t1, stepping through each knot span by forward differencing
+	void sampleUniform( float t0, float t1, size_t count, T *positions, T *derivatives = NULL ) const;
+	//! Evaluates the spline at \a count points spaced uniformly by arc length from its start through its end. The parameters of the points are written to \a times when it's non-NULL.
+	void sampleArcLengthUniform( size_t count, T *positions, T *derivatives = NULL, float *times = NULL ) const;
+
 	// Access the basis function to compute it without control points.  This
 	// is useful for least squares fitting of curves.
 	BSplineBasis& getBasis();
@@ -183,6 +192,9 @@ class BSpline
     // function has bLoop equal to true, in which case the spline curve must
     // be a closed curve.
     void createControl( const T *akCtrlPoint );
+    // Computes the coefficients of the polynomial in ( t - spanMid ), of degree up to 3, that the spline follows over the
+    // knot span centered on spanMid
+    void getSpanPolynomial( float spanMid, T coeffs[4] ) const;
 
     int mNumCtrlPoints;
     T *mCtrlPoints;  // ctrl[n+1]
@@ -29,7 +29,65 @@
 
 namespace cinder {
 
+//! Returns an open B-spline of \a degree with \a outputSamples control points, least-squares fit to \a samples and passing through the first and last of them
 template<typename T>
 BSpline<T> fitBSpline( const std::vector<T> &samples, int degree, int outputSamples );
 
+//! Fits B-splines to a fixed number of samples as fitBSpline() does. The least-squares system depends only on the number of samples, the degree and the number of control points, so it is factorized once at construction and each fit() only solves against it, in time linear in the number of samples.
+template<typename T>
+class BSplineFitter {
+  public:
+	//! Prepares fits of \a numSamples samples, which must be at least 2. \a numControlPoints and \a degree are adjusted as fitBSpline() adjusts them.
+	BSplineFitter( int numSamples, int degree, int numControlPoints );
+
+	int		getNumSamples() const { return mNumSamples; }
+	int		getDegree() const { return mDegree; }
+	int		getNumControlPoints() const { return mNumControlPoints; }
+
+	//! Returns the B-spline fit to \a samples, which must hold getNumSamples() points
+	BSpline<T>	fit( const std::vector<T> &samples ) const;
+	//! Returns the B-spline fit to the getNumSamples() points of \a samples
+	BSpline<T>	fit( const T *samples ) const;
+	//! Fits the getNumSamples() points of \a samples, writing getNumControlPoints() control points to \a controlPoints
+	void		fit( const T *samples, T *controlPoints ) const;
+
+  private:
+	int						mNumSamples, mDegree, mNumControlPoints;
+	//! For each sample, the first control point it weighs, followed by its degree + 1 weights in mBasisWeights
+	std::vector<int>		mBasisFirst;
+	std::vector<double>		mBasisWeights;
+	//! The banded Cholesky factor of the normal equations, degree + 1 entries per row ending at the diagonal, whose reciprocal is kept in mInvDiagonal
+	std::vector<double>		mFactor, mInvDiagonal;
+};
+
+//! Smooths a stream of points by fitting a B-spline to the most recent of them, such as the tip of a pen stroke. Once the window is full, each fit reuses one BSplineFitter, so its cost depends on the window size rather than on how many points have streamed by.
+template<typename T>
+class BSplineWindowFitter {
+  public:
+	//! Fits the most recent \a windowSize points with B-splines of \a degree with \a numControlPoints control points
+	BSplineWindowFitter( int windowSize, int degree, int numControlPoints );
+
+	//! Adds \a point, dropping the oldest point once the window is full
+	void	addPoint( const T &point );
+	//! Removes all points
+	void	clear() { mNumPoints = 0; mFirst = 0; }
+
+	int		getWindowSize() const { return mFitter.getNumSamples(); }
+	//! Returns the number of points in the window, which grows to getWindowSize()
+	int		getNumPoints() const { return mNumPoints; }
+	bool	isFull() const { return mNumPoints == getWindowSize(); }
+	//! Returns the points in the window, oldest first
+	const T*	getPoints() const { return &mPoints[mFirst]; }
+
+	//! Returns the B-spline fit to the points in the window, of which there must be at least 2
+	BSpline<T>	fit() const;
+
+  private:
+	BSplineFitter<T>	mFitter;
+	int					mDegree, mNumControlPoints;
+	//! Each point is stored twice, \a windowSize apart, so that the window is always contiguous
+	std::vector<T>		mPoints;
+	int					mFirst, mNumPoints;
+};
+
 } // namespace cinder
@@ -25,6 +25,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Buffer.h"
+#include "cinder/Stream.h"
 
 #include <string>
 
@@ -36,6 +37,8 @@ std::string toBase64( const std::string &input, int charsPerLine = 0 );
 std::string toBase64( const Buffer &input, int charsPerLine = 0 );
 //! Converts \a input of length \a inputSize into a Base64-encoded string. If \a charsPerLine > 0, carriage returns (\n) are inserted every \a charsPerLine characters, rounded down to the nearest multiple of 4.
 std::string toBase64( const void *input, size_t inputSize, int charsPerLine = 0 );
+//! Reads \a input until its end and writes its Base64 encoding to \a output, one chunk at a time rather than materializing the whole result. \a charsPerLine behaves as in the other variants.
+void toBase64( const IStreamRef &input, const OStreamRef &output, int charsPerLine = 0 );
 
 //! Converts Base64-encoded data \a input into unencoded data.
 Buffer fromBase64( const std::string &input );
@@ -43,5 +46,7 @@ Buffer fromBase64( const std::string &input );
 Buffer fromBase64( const Buffer &input );
 //! Converts Base64-encoded data \a input into unencoded data.
 Buffer fromBase64( const void *input, size_t inputSize );
+//! Reads Base64-encoded data from \a input until its end and writes the unencoded data to \a output, one chunk at a time.
+void fromBase64( const IStreamRef &input, const OStreamRef &output );
 
 } // namespace cinder
\ No newline at end of file
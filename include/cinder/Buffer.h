@@ -38,12 +38,15 @@ class Buffer {
 		size_t	mAllocatedSize;
 		size_t	mDataSize;
 		bool	mOwnsData;
+		std::shared_ptr<void>	mOwner;
 	};
 
  public:
 	Buffer() {}
 	Buffer( void * aBuffer, size_t aSize );
 	Buffer( size_t size );
+	//! Creates a Buffer that references \a aBuffer without copying it. \a owner is kept alive for as long as the Buffer (or a copy of it) exists, for example a memory mapping.
+	Buffer( void * aBuffer, size_t aSize, const std::shared_ptr<void> &owner );
 	//! Creates a Buffer from a DataSource
 	explicit Buffer( std::shared_ptr<class DataSource> dataSource );
 	
@@ -79,5 +82,7 @@ class Buffer {
 
 Buffer compressBuffer( const Buffer &aBuffer, int8_t compressionLevel = DEFAULT_COMPRESSION_LEVEL, bool resizeResult = true );
 Buffer decompressBuffer( const Buffer &aBuffer, bool resizeResult = true, bool useGZip = false );
+//! Compresses \a aBuffer like compressBuffer(), but in blocks which are compressed in parallel on \a taskPool, or TaskPool::get() if it is null. The result is a single zlib (or gzip if \a useGZip) stream, readable with decompressBuffer() or IStreamInflate.
+Buffer compressBufferParallel( const Buffer &aBuffer, int8_t compressionLevel = DEFAULT_COMPRESSION_LEVEL, bool useGZip = false, class TaskPool *taskPool = nullptr );
 
 } //namespace
\ No newline at end of file
@@ -82,8 +82,12 @@ class Camera {
 	virtual const Matrix44f&	getProjectionMatrix() const { if( ! mProjectionCached ) calcProjection(); return mProjectionMatrix; }
 	virtual const Matrix44f&	getModelViewMatrix() const { if( ! mModelViewCached ) calcModelView(); return mModelViewMatrix; }
 	virtual const Matrix44f&	getInverseModelViewMatrix() const { if( ! mInverseModelViewCached ) calcInverseModelView(); return mInverseModelViewMatrix; }
+	//! Returns the product of the projection and modelview matrices, which takes world-space coordinates to clip space
+	Matrix44f					getViewProjectionMatrix() const { return getProjectionMatrix() * getModelViewMatrix(); }
 
 	Ray		generateRay( float u, float v, float imagePlaneAspectRatio ) const;
+	//! Generates a Ray for each of the \a count image-plane coordinates in \a uv, writing them to \a result. Equivalent to calling generateRay() on each, but computes the camera's basis only once.
+	void	generateRays( const Vec2f *uv, size_t count, float imagePlaneAspectRatio, Ray *result ) const;
 	void	getBillboardVectors( Vec3f *right, Vec3f *up ) const;
 
 	//! Converts a world-space coordinate \a worldCoord to screen coordinates as viewed by the camera, based ona s screen which is \a screenWidth x \a screenHeight pixels.
@@ -94,6 +98,12 @@ class Camera {
  	float worldToEyeDepth( const Vec3f &worldCoord ) const { return getModelViewMatrix().m[2] * worldCoord.x + getModelViewMatrix().m[6] * worldCoord.y + getModelViewMatrix().m[10] * worldCoord.z + getModelViewMatrix().m[14]; }
  	//! Converts a world-space coordinate \a worldCoord to normalized device coordinates
  	Vec3f worldToNdc( const Vec3f &worldCoord ) { Vec3f eye = getModelViewMatrix().transformPointAffine( worldCoord ); return getProjectionMatrix().transformPoint( eye ); }
+	/** Converts the \a count world-space coordinates in \a worldCoords to screen coordinates in \a result, as worldToScreen() does for a single coordinate.
+		The view-projection matrix is computed once for the batch and the points are transformed 4 at a time with SIMD where available.
+		If \a visible is non-NULL, each of its \a count entries is set to whether the point lies beyond the near clip plane and on screen. The screen coordinates of points behind the camera are meaningless. **/
+	void worldToScreen( const Vec3f *worldCoords, size_t count, float screenWidth, float screenHeight, Vec2f *result, bool *visible = NULL ) const;
+	//! Converts the \a count world-space coordinates in \a worldCoords to normalized device coordinates in \a result, with the same batching as the worldToScreen() variant.
+	void worldToNdc( const Vec3f *worldCoords, size_t count, Vec3f *result ) const;
 
 
 	float	getScreenRadius( const class Sphere &sphere, float screenWidth, float screenHeight ) const;
@@ -25,6 +25,12 @@
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
 #include "cinder/Exception.h"
+#include "cinder/Function.h"
+#include "cinder/ConcurrentCircularBuffer.h"
+#include "cinder/gl/Texture.h"
+#if ! defined( CINDER_GLES )
+	#include "cinder/gl/GlslProg.h"
+#endif
 
 #if defined( CINDER_MAC )
 	#if defined( __OBJC__ )
@@ -53,6 +59,10 @@
 #endif
 
 #include <map>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <boost/noncopyable.hpp>
 
 namespace cinder {
 
@@ -63,11 +73,42 @@ class Capture {
 	class Device;
 	typedef std::shared_ptr<Device> DeviceRef;
 
-	static CaptureRef	create( int32_t width, int32_t height, const DeviceRef device = DeviceRef() ) { return CaptureRef( new Capture( width, height, device ) ); }
+	//! The pixel format frames are delivered in. PIXEL_FORMAT_YCBCR_422 delivers the camera's native 4:2:2 YCbCr (UYVY) frames unconverted, as Textures whose red, green and blue components hold Cr, Y and Cb. Convert them with createYCbCrShader(). Currently only supported on Mac OS X; check getPixelFormat().
+	enum PixelFormat { PIXEL_FORMAT_RGB, PIXEL_FORMAT_YCBCR_422 };
+	/** The encoding frames are sent from the device in. Compressed frames need a fraction of the USB bandwidth of uncompressed ones, which allows several
+		high resolution cameras on one controller, and are decoded before they are delivered in the requested PixelFormat. **/
+	enum Codec { CODEC_UNCOMPRESSED, CODEC_MJPEG, CODEC_H264 };
+
+	class Format {
+	  public:
+		Format() : mPixelFormat( PIXEL_FORMAT_RGB ), mCodec( CODEC_UNCOMPRESSED ), mFrameRate( 0 ) {}
+
+		//! Sets the pixel format frames are delivered in. Defaults to PIXEL_FORMAT_RGB.
+		Format&		pixelFormat( PixelFormat pixelFormat ) { mPixelFormat = pixelFormat; return *this; }
+		/** Requests that the device sends frames encoded with \a codec, falling back to uncompressed frames when the device has no such format at the requested size.
+			Defaults to CODEC_UNCOMPRESSED. Currently only supported on Windows, where frames are decoded by the system's DirectShow decoder on each device's own streaming thread; check getCodec(). **/
+		Format&		codec( Codec codec ) { mCodec = codec; return *this; }
+		//! Requests \a frameRate frames per second, or the device's default for \c 0, which is the default. Currently only supported on Windows.
+		Format&		frameRate( float frameRate ) { mFrameRate = frameRate; return *this; }
+
+		PixelFormat	getPixelFormat() const { return mPixelFormat; }
+		Codec		getCodec() const { return mCodec; }
+		float		getFrameRate() const { return mFrameRate; }
+
+	  private:
+		PixelFormat		mPixelFormat;
+		Codec			mCodec;
+		float			mFrameRate;
+	};
+
+	static CaptureRef	create( int32_t width, int32_t height, const DeviceRef device = DeviceRef(), PixelFormat pixelFormat = PIXEL_FORMAT_RGB ) { return CaptureRef( new Capture( width, height, device, pixelFormat ) ); }
+	//! Creates a Capture of \a device with \a format, such as a 1080p60 MJPEG stream with \code Capture::create( 1920, 1080, device, Capture::Format().codec( Capture::CODEC_MJPEG ).frameRate( 60 ) ) \endcode
+	static CaptureRef	create( int32_t width, int32_t height, const DeviceRef device, const Format &format ) { return CaptureRef( new Capture( width, height, device, format ) ); }
 
 	Capture() {}
 	//! \deprecated Call Capture::create() instead
-	Capture( int32_t width, int32_t height, const DeviceRef device = DeviceRef() );
+	Capture( int32_t width, int32_t height, const DeviceRef device = DeviceRef(), PixelFormat pixelFormat = PIXEL_FORMAT_RGB );
+	Capture( int32_t width, int32_t height, const DeviceRef device, const Format &format );
 	~Capture() {}
 
 	//! Begin capturing video
@@ -91,11 +132,38 @@ class Capture {
 	//! Returns the bounding rectangle of the capture imagee, which is Area( 0, 0, width, height )
 	Area		getBounds() const { return Area( 0, 0, getWidth(), getHeight() ); }
 	
-	//! Returns a Surface representing the current captured frame.
+	//! Returns the pixel format frames are delivered in, which is PIXEL_FORMAT_RGB where the requested format isn't supported.
+	PixelFormat	getPixelFormat() const;
+	//! Returns the encoding frames are sent from the device in, which is CODEC_UNCOMPRESSED where the requested codec isn't supported.
+	Codec		getCodec() const;
+
+	//! Returns a Surface representing the current captured frame. Returns a null Surface when the pixel format is PIXEL_FORMAT_YCBCR_422.
 	Surface8u	getSurface() const;
+	/** \brief Returns a gl::Texture representing the current captured frame, which requires a current GL context. Frames are claimed by either getSurface() or getTexture(), so use one of them per Capture.
+		On Mac OS X the Texture is a \c GL_TEXTURE_RECTANGLE_ARB wrapping the camera's IOSurface without any copies. On Windows frames are copied once into a pixel buffer object that is uploaded asynchronously.
+		Elsewhere the Texture is updated from getSurface(). **/
+	gl::Texture	getTexture() const;
+#if ! defined( CINDER_GLES )
+	//! Returns a shader which draws PIXEL_FORMAT_YCBCR_422 Textures returned by getTexture() as RGB, using the ITU-R BT.601 video range conversion. The Texture should be bound to unit 0 and is multiplied by the current color.
+	static gl::GlslProg	createYCbCrShader();
+#endif
 	//! Returns the associated Device for this instace of Capture
 	const Capture::DeviceRef getDevice() const;
 
+	/** \brief Returns the signal which fires with every frame as it is captured, along with its timestamp in seconds. It fires on the capture thread, so slots must be thread-safe and return quickly.
+		Frames are delivered as they arrive regardless of the App's frame rate, and are only delivered for PIXEL_FORMAT_RGB. While frames are being delivered, getSurface() and getTexture() may not see every one.
+		On Windows the first call starts a thread which polls the device for frames while capturing. **/
+	signals::signal<void( const Surface8u&, double )>&	getSignalNewFrame();
+	/** \brief Queues every captured frame for popFrame(), keeping up to \a depth frames. Frames arriving while the queue is full are dropped and counted by getNumDroppedFrames(). A \a depth of 0 disables the queue.
+		Capture is briefly stopped and restarted if it is running. **/
+	void		setFrameQueueDepth( size_t depth );
+	//! Returns the number of frames the queue keeps, or 0 if it is disabled.
+	size_t		getFrameQueueDepth() const;
+	//! Pops the oldest queued frame into \a surface, and its timestamp in seconds into \a timestamp if it is non-NULL. Returns false if the queue is empty. Must only be called from one thread at a time.
+	bool		popFrame( Surface8u *surface, double *timestamp = NULL );
+	//! Returns the number of frames dropped because the queue was full.
+	uint32_t	getNumDroppedFrames() const;
+
 	//! Returns a vector of all Devices connected to the system. If \a forceRefresh then the system will be polled for connected devices.
 	static const std::vector<DeviceRef>&	getDevices( bool forceRefresh = false );
 	//! Finds a particular device based on its name
@@ -133,12 +201,35 @@ class Capture {
 		Device() {}
 		std::string		mName;
 	};
+
+	//! \cond
+	// Hands frames from a platform implementation's capture thread to the new frame signal and the frame queue
+	class FrameSink : private boost::noncopyable {
+	  public:
+		FrameSink() : mNumDroppedFrames( 0 ) {}
+
+		//! Returns whether frames should be delivered, which is the case when the signal has slots or the queue is enabled
+		bool	isActive() const { return mQueue || ( ! mSignalNewFrame.empty() ); }
+		//! Called on the capture thread with each new frame
+		void	deliver( const Surface8u &surface, double timestamp );
+
+		signals::signal<void( const Surface8u&, double )>									mSignalNewFrame;
+		std::unique_ptr<ConcurrentCircularBufferSpsc<std::pair<Surface8u, double> > >	mQueue;
+		std::atomic<uint32_t>																mNumDroppedFrames;
+	};
+	//! \endcond
 		
  protected: 
 	struct Obj {
-		Obj( int32_t width, int32_t height, const Capture::DeviceRef device );
+		Obj( int32_t width, int32_t height, const Capture::DeviceRef device, const Format &format );
 		virtual ~Obj();
 
+		PixelFormat						mPixelFormat;
+		FrameSink						mFrameSink;
+#if defined( CINDER_COCOA_TOUCH )
+		gl::Texture						mTexture;
+#endif
+
 #if defined( CINDER_MAC ) 
 		CaptureImplQtKit				*mImpl;
 #elif defined( CINDER_COCOA_TOUCH_SIMULATOR )
@@ -60,11 +60,13 @@ class CaptureImplAvFoundationDevice : public Capture::Device {
 	int32_t							mExposedFrameBytesPerRow;
 	int32_t							mExposedFrameHeight;
 	int32_t							mExposedFrameWidth;
+	cinder::Capture::FrameSink		*mFrameSink;
 }
 
 + (const std::vector<cinder::Capture::DeviceRef>&)getDevices:(BOOL)forceRefresh;
 
 - (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height;
+- (void)setFrameSink:(cinder::Capture::FrameSink*)frameSink;
 - (bool)prepareStartCapture;
 - (void)startCapture;
 - (void)stopCapture;
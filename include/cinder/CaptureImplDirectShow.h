@@ -25,6 +25,10 @@
 #include "cinder/Cinder.h"
 #include "cinder/Capture.h"
 #include "cinder/Surface.h"
+#include "cinder/SurfacePool.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "cinder/gl/Texture.h"
 #include "msw/videoInput/videoInput.h"
 
 namespace cinder {
@@ -33,7 +37,7 @@ class CaptureImplDirectShow {
  public:
 	class Device;
 
-	CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device );
+	CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device, Capture::FrameSink *frameSink, Capture::Codec codec = Capture::CODEC_UNCOMPRESSED, float frameRate = 0 );
 	CaptureImplDirectShow( int32_t width, int32_t height );
 	~CaptureImplDirectShow();
 	
@@ -45,8 +49,14 @@ class CaptureImplDirectShow {
 
 	int32_t		getWidth() const { return mWidth; }
 	int32_t		getHeight() const { return mHeight; }
+	//! Returns the encoding the device is sending frames in, which DirectShow has decoded by the time they reach the sample grabber
+	Capture::Codec	getCodec() const { return mCodec; }
 	
 	Surface8u	getSurface() const;
+	gl::Texture	getTexture() const;
+
+	//! Starts a thread which polls videoInput for frames and hands them to the FrameSink while capturing, as videoInput doesn't expose its own callback
+	void		enableFrameDelivery();
 	
 	const Capture::DeviceRef getDevice() const { return mDevice; }
 	
@@ -64,18 +74,37 @@ class CaptureImplDirectShow {
 	};
  protected:
 	void	init( int32_t width, int32_t height, const Capture::Device &device );
+	// applies the requested codec and frame rate, which videoInput forgets whenever the device is stopped, and sets up the device
+	void	setupDevice();
+	void	startFrameDelivery();
+	void	stopFrameDelivery();
+	void	deliverFrames();
 
 	int								mDeviceID;
 	// this maintains a reference to the mgr so that we don't destroy it before
 	// the last Capture is destroyed
 	std::shared_ptr<class CaptureMgr>	mMgrPtr;
 	bool								mIsCapturing;
-	std::shared_ptr<class SurfaceCache>	mSurfaceCache;
+	mutable SurfacePool8u				mSurfacePool;
 
 	int32_t				mWidth, mHeight;
+	Capture::Codec		mRequestedCodec, mCodec;
+	float				mFrameRate;
 	mutable Surface8u	mCurrentFrame;
+	mutable gl::Texture	mTexture;
 	Capture::DeviceRef	mDevice;
 
+	// while frames are delivered, the delivery thread owns the device's frames and the latest one is kept in mDeliveredFrame
+	Capture::FrameSink				*mFrameSink;
+	bool							mFrameDeliveryEnabled;
+	std::shared_ptr<std::thread>	mFrameDeliveryThread;
+	std::atomic<bool>				mStopFrameDelivery;
+	Timer							mFrameTimer;
+	mutable std::mutex				mDeliveredFrameMutex;
+	Surface8u						mDeliveredFrame;
+	uint32_t						mDeliveredFrameCount;
+	mutable uint32_t				mTextureFrameCount;
+
 	static bool							sDevicesEnumerated;
 	static std::vector<Capture::DeviceRef>	sDevices;
 };
@@ -23,6 +23,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
 #include "cinder/Capture.h"
+#include "cinder/gl/Texture.h"
 #import <QTKit/QTKit.h>
 #include <vector>
 
@@ -52,7 +53,14 @@ class CaptureImplQtKitDevice : public Capture::Device {
 	QTCaptureDeviceInput				*mCaptureDeviceInput;
 	
 	CVPixelBufferRef				mWorkingPixelBuffer;
+	CVPixelBufferRef				mCurrentPixelBuffer;
 	cinder::Surface8u				mCurrentFrame;
+	bool							mCurrentFrameIsValid;
+	CVOpenGLTextureCacheRef			mTextureCache;
+	cinder::gl::Texture				mCurrentTexture;
+	bool							mCurrentTextureIsValid;
+	cinder::Capture::PixelFormat	mPixelFormat;
+	cinder::Capture::FrameSink		*mFrameSink;
 	int32_t							mWidth, mHeight;
 	cinder::SurfaceChannelOrder		mSurfaceChannelOrderCode;
 	NSString						* mDeviceUniqueId;
@@ -65,12 +73,15 @@ class CaptureImplQtKitDevice : public Capture::Device {
 
 + (const std::vector<cinder::Capture::DeviceRef>&)getDevices:(BOOL)forceRefresh;
 
-- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height;
+- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height pixelFormat:(cinder::Capture::PixelFormat)pixelFormat;
+- (void)setFrameSink:(cinder::Capture::FrameSink*)frameSink;
 - (void)prepareStartCapture;
 - (void)startCapture;
 - (void)stopCapture;
 - (bool)isCapturing;
+- (void)claimWorkingPixelBuffer;
 - (cinder::Surface8u)getCurrentFrame;
+- (cinder::gl::Texture)getCurrentTexture;
 - (bool)checkNewFrame;
 - (const cinder::Capture::DeviceRef)getDevice;
 - (int32_t)getWidth;
@@ -27,6 +27,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Area.h"
+#include "cinder/MemoryStats.h"
 
 namespace cinder {
 
@@ -49,9 +50,14 @@ class ChannelT {
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
+		std::shared_ptr<Obj>		mParent; // keeps the owner of mData alive for views
+		MemoryAllocation			mAllocation;
 	};
 	/// \endcond
 
+	//! Constructs a Channel referencing the pixels of \a parent inside \a area without copying. Used by ChannelViewT.
+	ChannelT( const ChannelT &parent, const Area &area );
+
  public:
 	/*! Constructs an empty Channel, which is the equivalent of NULL and should not be used directly. */
 	ChannelT() {}
@@ -268,6 +274,23 @@ class ChannelT {
  	std::shared_ptr<Obj>		mObj;
 };
 
+//! A Channel which references a sub-region of a parent Channel without allocating or copying. Keeps the parent Channel's pixels alive for its lifetime, and can be passed anywhere a ChannelT is expected.
+/** A Channel returned by SurfaceT::getChannel() does not own its Surface's pixels, so its views are only valid while the Surface is. **/
+template<typename T>
+class ChannelViewT : public ChannelT<T> {
+ public:
+	ChannelViewT() {}
+	//! Creates a view of \a area of \a parent, clipped to the parent's bounds. Writes through the view modify \a parent.
+	ChannelViewT( const ChannelT<T> &parent, const Area &area )
+		: ChannelT<T>( parent, area ), mParentArea( area.getClipBy( parent.getBounds() ) )
+	{}
+
+	//! Returns the Area of the parent Channel that the view references
+	const Area&		getParentArea() const { return mParentArea; }
+
+ private:
+	Area		mParentArea;
+};
 
 //! 8-bit image channel. Synonym for Channel8u.
 typedef ChannelT<uint8_t>	Channel;
@@ -278,4 +301,13 @@ typedef ChannelT<uint16_t>	Channel16u;
 //! 32-bit floating point image channel
 typedef ChannelT<float>		Channel32f;
 
+//! 8-bit view of a Channel. Synonym for ChannelView8u.
+typedef ChannelViewT<uint8_t>	ChannelView;
+//! 8-bit view of a Channel
+typedef ChannelViewT<uint8_t>	ChannelView8u;
+//! 16-bit view of a Channel
+typedef ChannelViewT<uint16_t>	ChannelView16u;
+//! 32-bit floating point view of a Channel
+typedef ChannelViewT<float>		ChannelView32f;
+
 } // namespace cinder
@@ -0,0 +1,44 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Included macros:
+// - CINDER_SSE2: defined when compiling for x86 / x86_64, along with the SSE2 intrinsics. On 32-bit x86 the
+//	 instructions are not guaranteed to be present, so confirm with System::hasSse2() before using them.
+// - CINDER_NEON: defined when compiling for ARM with NEON enabled, along with the NEON intrinsics.
+//
+// User-definable parameters:
+// - CINDER_DISABLE_SIMD: forces the scalar code paths, which can be useful when validating SIMD implementations.
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#if ! defined( CINDER_DISABLE_SIMD )
+	#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+		#define CINDER_SSE2
+		#include <emmintrin.h>
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON ) || defined( _M_ARM )
+		#define CINDER_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
@@ -394,6 +394,14 @@ template <typename T, typename Y> inline ColorAT<T> operator*( Y s, const ColorA
 // Free Functions
 extern ColorT<float> hsvToRGB( const Vec3f &hsv );
 extern Vec3f rgbToHSV( const ColorT<float> &c );
+//! Converts the sRGB encoded \a c to linear, applying the sRGB transfer curve exactly. Bulk conversions are provided by ip::convertColorSpace().
+extern float srgbToLinear( float c );
+//! Converts the linear \a c to sRGB encoded, applying the sRGB transfer curve exactly
+extern float linearToSrgb( float c );
+//! Converts the red, green and blue of the sRGB encoded \a c to linear
+extern ColorT<float> srgbToLinear( const ColorT<float> &c );
+//! Converts the red, green and blue of the linear \a c to sRGB encoded
+extern ColorT<float> linearToSrgb( const ColorT<float> &c );
 //! Converts the named colors of the SVG spec http://en.wikipedia.org/wiki/Web_colors#X11_color_names to sRGB Color8u. If \a found is non-NULL, it's set to whether the name was located. Returns black on failure.
 extern ColorT<uint8_t> svgNameToRgb( const char *svgName, bool *found = NULL );
 
@@ -29,6 +29,9 @@
 #include <boost/noncopyable.hpp>
 #include "cinder/Thread.h"
 
+#include <atomic>
+#include <memory>
+
 namespace cinder {
 
 template<typename T>
@@ -121,4 +124,245 @@ class ConcurrentCircularBuffer : public boost::noncopyable {
 	bool					mCanceled;
 };
 
+namespace detail {
+
+//! \brief Provides the blocking and cancel methods of ConcurrentCircularBuffer for the lock-free buffers, in terms of their tryPushFront() and tryPopBack().
+//!
+//! The fast path never locks. A thread only takes the mutex when it has to wait, and the opposite side only notifies when a waiter has registered itself.
+template<typename DerivedT, typename T>
+class ConcurrentRingBufferBlocking : public boost::noncopyable {
+  public:
+	typedef T value_type;
+	typedef typename boost::call_traits<value_type>::param_type param_type;
+
+	//! Pushes \a item to the front of the buffer, waiting until there is space or cancel() is called.
+	void pushFront( param_type item ) {
+		DerivedT *derived = static_cast<DerivedT *>( this );
+		while( ! mCanceled ) {
+			if( derived->tryPushFront( item ) )
+				return;
+
+			waitFor( &mNumWaitingProducers, mNotFullCond, [derived] { return derived->isNotFull(); } );
+		}
+	}
+
+	//! Pops an item from the back of the buffer into \a pItem, waiting until one is available or cancel() is called.
+	void popBack( value_type *pItem ) {
+		DerivedT *derived = static_cast<DerivedT *>( this );
+		while( ! mCanceled ) {
+			if( derived->tryPopBack( pItem ) )
+				return;
+
+			waitFor( &mNumWaitingConsumers, mNotEmptyCond, [derived] { return derived->isNotEmpty(); } );
+		}
+	}
+
+	//! Same as tryPushFront().
+	bool tryPush( param_type item )		{ return static_cast<DerivedT *>( this )->tryPushFront( item ); }
+	//! Same as tryPopBack().
+	bool tryPop( value_type *pItem )	{ return static_cast<DerivedT *>( this )->tryPopBack( pItem ); }
+
+	//! Causes any blocked pushFront() or popBack() calls to return, and any future calls to return immediately.
+	void cancel() {
+		std::lock_guard<std::mutex> lock( mMutex );
+		mCanceled = true;
+		mNotFullCond.notify_all();
+		mNotEmptyCond.notify_all();
+	}
+
+  protected:
+	ConcurrentRingBufferBlocking()
+		: mCanceled( false ), mNumWaitingProducers( 0 ), mNumWaitingConsumers( 0 )
+	{}
+
+	// Called by the derived class after a successful push or pop. The fence pairs with the one in waitFor(), so that either the waiter sees the change or this sees the waiter.
+	void notifyConsumers()	{ notify( mNumWaitingConsumers, mNotEmptyCond ); }
+	void notifyProducers()	{ notify( mNumWaitingProducers, mNotFullCond ); }
+
+  private:
+	template<typename PredicateT>
+	void waitFor( std::atomic<size_t> *numWaiting, std::condition_variable &cond, const PredicateT &ready ) {
+		std::unique_lock<std::mutex> lock( mMutex );
+		++(*numWaiting);
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		while( ! ready() && ! mCanceled )
+			cond.wait( lock );
+		--(*numWaiting);
+	}
+
+	void notify( std::atomic<size_t> &numWaiting, std::condition_variable &cond ) {
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( numWaiting.load( std::memory_order_relaxed ) ) {
+			std::lock_guard<std::mutex> lock( mMutex );
+			cond.notify_all();
+		}
+	}
+
+	std::atomic<bool>		mCanceled;
+	std::atomic<size_t>		mNumWaitingProducers, mNumWaitingConsumers;
+	std::mutex				mMutex;
+	std::condition_variable	mNotEmptyCond, mNotFullCond;
+};
+
+} // namespace detail
+
+//! \brief Lock-free, single-producer / single-consumer version of ConcurrentCircularBuffer.
+//!
+//! tryPushFront() and tryPopBack() are wait-free, as long as only one thread pushes and only one thread pops. The blocking
+//! pushFront() and popBack() only lock a mutex when they need to wait. Items are handed over in FIFO order, and a popped slot
+//! is reset to a default constructed value so that the buffer doesn't extend the lifetime of resources like Surface's.
+template<typename T>
+class ConcurrentCircularBufferSpsc : public detail::ConcurrentRingBufferBlocking<ConcurrentCircularBufferSpsc<T>, T> {
+  public:
+	typedef size_t size_type;
+	typedef T value_type;
+	typedef typename boost::call_traits<value_type>::param_type param_type;
+
+	explicit ConcurrentCircularBufferSpsc( size_type capacity )
+		: mCapacity( capacity + 1 ), mData( new T[capacity + 1] ), mReadIndex( 0 ), mWriteIndex( 0 )
+	{}
+
+	//! Attempts to push \a item to the front of the buffer, but does not wait for an availability. Returns success as true or false. Must only be called from the producer thread.
+	bool tryPushFront( param_type item ) {
+		const size_t writeIndex = mWriteIndex.load( std::memory_order_relaxed );
+		const size_t nextIndex = increment( writeIndex );
+		if( nextIndex == mReadIndex.load( std::memory_order_acquire ) )
+			return false;
+
+		mData[writeIndex] = item;
+		mWriteIndex.store( nextIndex, std::memory_order_release );
+		this->notifyConsumers();
+		return true;
+	}
+
+	//! Attempts to pop an item from the back of the buffer, but does not wait for an availability. Returns success as true or false. Must only be called from the consumer thread.
+	bool tryPopBack( value_type *pItem ) {
+		const size_t readIndex = mReadIndex.load( std::memory_order_relaxed );
+		if( readIndex == mWriteIndex.load( std::memory_order_acquire ) )
+			return false;
+
+		*pItem = mData[readIndex];
+		mData[readIndex] = T();
+		mReadIndex.store( increment( readIndex ), std::memory_order_release );
+		this->notifyProducers();
+		return true;
+	}
+
+	bool isNotEmpty() const	{ return mReadIndex.load( std::memory_order_acquire ) != mWriteIndex.load( std::memory_order_acquire ); }
+	bool isNotFull() const	{ return increment( mWriteIndex.load( std::memory_order_acquire ) ) != mReadIndex.load( std::memory_order_acquire ); }
+
+	//! Returns the number of items the buffer can hold
+	size_t size() const		{ return mCapacity - 1; }
+
+  private:
+	size_t increment( size_t index ) const	{ return index + 1 == mCapacity ? 0 : index + 1; }
+
+	// one slot is left empty to distinguish a full buffer from an empty one.
+	const size_t			mCapacity;
+	std::unique_ptr<T[]>	mData;
+
+	// the indices are padded onto separate cache lines so the producer and consumer don't contend.
+	char					mPad0[64];
+	std::atomic<size_t>		mReadIndex;
+	char					mPad1[64];
+	std::atomic<size_t>		mWriteIndex;
+	char					mPad2[64];
+};
+
+//! \brief Lock-free, multi-producer / multi-consumer version of ConcurrentCircularBuffer.
+//!
+//! Based on Dmitry Vyukov's bounded MPMC queue: every slot carries a sequence number, so that producers and consumers only
+//! contend on a single compare-and-swap each. Otherwise the interface and behavior matches ConcurrentCircularBufferSpsc.
+template<typename T>
+class ConcurrentCircularBufferMpmc : public detail::ConcurrentRingBufferBlocking<ConcurrentCircularBufferMpmc<T>, T> {
+  public:
+	typedef size_t size_type;
+	typedef T value_type;
+	typedef typename boost::call_traits<value_type>::param_type param_type;
+
+	explicit ConcurrentCircularBufferMpmc( size_type capacity )
+		: mCapacity( capacity ), mCells( new Cell[capacity] ), mReadPos( 0 ), mWritePos( 0 )
+	{
+		for( size_t i = 0; i < capacity; i++ )
+			mCells[i].mSequence.store( i, std::memory_order_relaxed );
+	}
+
+	//! Attempts to push \a item to the front of the buffer, but does not wait for an availability. Returns success as true or false.
+	bool tryPushFront( param_type item ) {
+		Cell *cell;
+		size_t pos = mWritePos.load( std::memory_order_relaxed );
+		while( true ) {
+			cell = &mCells[pos % mCapacity];
+			const size_t sequence = cell->mSequence.load( std::memory_order_acquire );
+			const std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+			if( diff == 0 ) {
+				if( mWritePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+					break;
+			}
+			else if( diff < 0 )
+				return false; // full
+			else
+				pos = mWritePos.load( std::memory_order_relaxed );
+		}
+
+		cell->mData = item;
+		cell->mSequence.store( pos + 1, std::memory_order_release );
+		this->notifyConsumers();
+		return true;
+	}
+
+	//! Attempts to pop an item from the back of the buffer, but does not wait for an availability. Returns success as true or false.
+	bool tryPopBack( value_type *pItem ) {
+		Cell *cell;
+		size_t pos = mReadPos.load( std::memory_order_relaxed );
+		while( true ) {
+			cell = &mCells[pos % mCapacity];
+			const size_t sequence = cell->mSequence.load( std::memory_order_acquire );
+			const std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)( pos + 1 );
+			if( diff == 0 ) {
+				if( mReadPos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+					break;
+			}
+			else if( diff < 0 )
+				return false; // empty
+			else
+				pos = mReadPos.load( std::memory_order_relaxed );
+		}
+
+		*pItem = cell->mData;
+		cell->mData = T();
+		cell->mSequence.store( pos + mCapacity, std::memory_order_release );
+		this->notifyProducers();
+		return true;
+	}
+
+	bool isNotEmpty() const {
+		const size_t pos = mReadPos.load( std::memory_order_acquire );
+		return mCells[pos % mCapacity].mSequence.load( std::memory_order_acquire ) == pos + 1;
+	}
+
+	bool isNotFull() const {
+		const size_t pos = mWritePos.load( std::memory_order_acquire );
+		return mCells[pos % mCapacity].mSequence.load( std::memory_order_acquire ) == pos;
+	}
+
+	//! Returns the number of items the buffer can hold
+	size_t size() const		{ return mCapacity; }
+
+  private:
+	struct Cell {
+		std::atomic<size_t>	mSequence;
+		T					mData;
+	};
+
+	const size_t				mCapacity;
+	std::unique_ptr<Cell[]>		mCells;
+
+	char						mPad0[64];
+	std::atomic<size_t>			mReadPos;
+	char						mPad1[64];
+	std::atomic<size_t>			mWritePos;
+	char						mPad2[64];
+};
+
 } // namespace cinder
\ No newline at end of file
@@ -30,8 +30,12 @@
 
 namespace cinder {
 
+//! Returns the convex hull of \a points as a closed PolyLine2f, clockwise with y pointing up, whose first point is repeated at its end. Large sets are divided among the TaskPool's threads.
 PolyLine2f	calcConvexHull( const std::vector<Vec2f> &points );
+//! Returns the convex hull of \a numPoints \a points as a closed PolyLine2f, clockwise with y pointing up, whose first point is repeated at its end. Large sets are divided among the TaskPool's threads.
 PolyLine2f	calcConvexHull( const Vec2f *points, size_t numPoints );
+//! Reorders \a points so that its first elements are the vertices of their convex hull, ordered as calcConvexHull() orders them but without repeating the first, and returns their count. Allocates nothing and runs on the calling thread.
+size_t		calcConvexHullInPlace( Vec2f *points, size_t numPoints );
 PolyLine2f	calcConvexHull( const Shape2d &shape );
 PolyLine2f	calcConvexHull( const Path2d &path );
 PolyLine2f	calcConvexHull( const PolyLine2f &polyLine );
@@ -72,14 +72,24 @@ class DataSourcePath : public DataSource {
 	virtual bool	isFilePath() { return true; }
 	virtual bool	isUrl() { return false; }
 
+	//! Returns a stream for the file. Files at least getMemoryMapThreshold() bytes in size are memory mapped and read with an IStreamMemoryMapped, others with an IStreamFile.
 	virtual IStreamRef	createStream();
 
+	//! Sets the file size in bytes at or above which files are memory mapped (default 1 MB). When mapped, getBuffer() references the mapping rather than copying the file. Pass \c std::numeric_limits<size_t>::max() to disable memory mapping.
+	static void		setMemoryMapThreshold( size_t numBytes );
+	//! Returns the file size in bytes at or above which files are memory mapped.
+	static size_t	getMemoryMapThreshold();
+
   protected:
 	explicit DataSourcePath( const fs::path &path );
 	
 	virtual	void	createBuffer();
+	//! Returns the mapping of the file, or an empty MemoryMappedFileRef if it is smaller than the threshold or couldn't be mapped. Mapping is only attempted once.
+	const MemoryMappedFileRef&	getMemoryMappedFile();
 	
-	IStreamFileRef	mStream;	
+	IStreamFileRef		mStream;
+	MemoryMappedFileRef	mMappedFile;
+	bool				mMappingAttempted;
 };
 
 DataSourceRef	loadFile( const fs::path &path );
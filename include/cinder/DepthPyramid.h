@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Channel.h"
+#include "cinder/Matrix.h"
+
+#include <vector>
+
+namespace cinder {
+
+/** \brief A hierarchical-Z pyramid of a depth buffer, for testing whether bounding boxes are hidden behind what was drawn into it.
+ *
+ * Each level halves the one before, keeping the farthest depth of the texels it covers, so a box can be tested against the farthest depth behind its
+ * screen bounds with at most four lookups. A box is hidden when its nearest point is farther than that depth. Boxes crossing the near plane or lying
+ * outside the depth buffer's view are always considered visible, so that the test is conservative and frustum culling remains a separate step.
+ * gl::OcclusionCuller builds a DepthPyramid from the previous frame's depth.
+ **/
+class DepthPyramid {
+  public:
+	DepthPyramid() {}
+	//! Builds the pyramid of \a depth, window depths in [0, 1] with the top row first as returned by gl::FboReadback::getChannel(), drawn with \a viewProjection
+	DepthPyramid( const Channel32f &depth, const Matrix44f &viewProjection ) { set( depth, viewProjection ); }
+
+	//! Rebuilds the pyramid of \a depth, window depths in [0, 1] with the top row first as returned by gl::FboReadback::getChannel(), drawn with \a viewProjection
+	void	set( const Channel32f &depth, const Matrix44f &viewProjection );
+
+	bool				isEmpty() const { return mLevels.empty(); }
+	size_t				getNumLevels() const { return mLevels.size(); }
+	int32_t				getLevelWidth( size_t level ) const { return mLevels[level].mWidth; }
+	int32_t				getLevelHeight( size_t level ) const { return mLevels[level].mHeight; }
+	//! Returns the farthest depths of level \a level, with the bottom row first as in OpenGL
+	const float*		getLevelData( size_t level ) const { return &mLevels[level].mDepth[0]; }
+	const Matrix44f&	getViewProjection() const { return mViewProjection; }
+
+	//! Returns \c false if \a box is certainly hidden, and \c true if it may be visible or the pyramid is empty
+	bool	isVisible( const AxisAlignedBox3f &box ) const;
+	//! Tests \a count boxes, setting bit <tt>i % 32</tt> of <tt>resultMask[i / 32]</tt> if box \c i may be visible, and returns the number that may be. \a resultMask must hold <tt>(count + 31) / 32</tt> words.
+	size_t	testBoxes( const AxisAlignedBox3f *boxes, size_t count, uint32_t *resultMask ) const;
+
+  protected:
+	struct Level {
+		int32_t				mWidth, mHeight;
+		std::vector<float>	mDepth;
+	};
+
+	std::vector<Level>	mLevels;
+	Matrix44f			mViewProjection;
+};
+
+} // namespace cinder
@@ -0,0 +1,271 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "cinder/CinderMath.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <vector>
+
+namespace cinder {
+
+/** \brief Steps a simulation state at a fixed timestep on its own thread, decoupled from the App's update() and draw().
+ *
+ * The step function is called on the FixedStepThread's thread with a fixed \a timestep, so the simulation advances deterministically regardless of
+ * how long the App takes to draw. If stepping falls behind it catches up with consecutive steps, up to getMaxCatchUpSteps() at a time, beyond which
+ * the time is dropped rather than the timestep changed. After each step the state is published as a snapshot, and the main thread reads the two latest
+ * snapshots together with the interpolation factor between them, so draw() can render the state smoothly at its own rate, one timestep behind.
+ * Input for the simulation is posted from the main thread and applied on the stepping thread ahead of the next step.
+ * The step function must not use OpenGL or other main-thread-only APIs, which remain the domain of update() and draw().
+ *
+ * \code
+ * mPhysics = std::unique_ptr<FixedStepThread<World>>( new FixedStepThread<World>( World(), 1 / 120.0, []( World *world, double dt ) { world->step( dt ); } ) );
+ * mPhysics->start();
+ * ...
+ * void draw() { World previous, current; float alpha = mPhysics->getSnapshots( &previous, &current ); ... }
+ * \endcode **/
+template<typename StateT>
+class FixedStepThread : private boost::noncopyable {
+  public:
+	typedef std::function<void ( StateT *state, double timestep )>					StepFn;
+	typedef std::function<void ( StateT *state )>									InputFn;
+	typedef std::function<StateT ( const StateT &a, const StateT &b, float t )>		LerpFn;
+
+	//! Constructs a FixedStepThread which steps \a initialState every \a timestep seconds with \a stepFn once started
+	FixedStepThread( const StateT &initialState, double timestep, const StepFn &stepFn );
+	//! Stops the thread
+	~FixedStepThread() { stop(); }
+
+	//! Starts stepping on a new thread. Stepping is scheduled from the time start() is called.
+	void	start();
+	//! Stops stepping and joins the thread. The last published state remains available.
+	void	stop();
+	//! Returns whether the thread is running
+	bool	isRunning() const { return mThread.joinable(); }
+
+	//! Sets whether stepping is paused. Time spent paused isn't caught up with.
+	void	setPaused( bool paused = true );
+	//! Returns whether stepping is paused
+	bool	isPaused() const { return mPaused; }
+
+	//! Returns the fixed timestep in seconds
+	double		getTimestep() const { return mTimestep; }
+	//! Returns the number of steps taken
+	uint64_t	getNumSteps() const { return mNumSteps; }
+	//! Returns the number of steps which were dropped because stepping fell further behind than getMaxCatchUpSteps()
+	uint64_t	getNumDroppedSteps() const { return mNumDroppedSteps; }
+	//! Sets the maximum number of consecutive steps taken to catch up. Default is \c 10.
+	void		setMaxCatchUpSteps( uint32_t steps ) { mMaxCatchUpSteps = std::max<uint32_t>( 1, steps ); }
+	//! Returns the maximum number of consecutive steps taken to catch up. Default is \c 10.
+	uint32_t	getMaxCatchUpSteps() const { return mMaxCatchUpSteps; }
+
+	//! Queues \a inputFn to be called with the state on the stepping thread ahead of the next step. Inputs are applied in the order they were posted.
+	void	post( const InputFn &inputFn );
+
+	//! Copies the two most recently published states to \a previous and \a current and returns the interpolation factor between them for the current
+	//! time (0 - 1). Rethrows any exception thrown by the step function, which stops stepping.
+	float	getSnapshots( StateT *previous, StateT *current ) const;
+	//! Returns the published state for the current time, interpolated between the two most recent snapshots with \a lerpFn, which is called with the snapshots locked
+	StateT	getInterpolated( const LerpFn &lerpFn ) const;
+	//! Returns the most recently published state
+	StateT	getCurrent() const;
+
+  private:
+	void	threadLoop();
+	float	getInterpolationFactor() const;	// called with mMutex locked
+	double	getStepsDue() const { return ( mTimer.getSeconds() - mTimeOrigin ) / mTimestep; }
+
+	const double			mTimestep;
+	StepFn					mStepFn;
+	StateT					mState;					// owned by the stepping thread while it runs
+	StateT					mPrevious, mCurrent;	// guarded by mMutex
+	uint64_t				mNumPublished;			// the step mCurrent was published after, guarded by mMutex
+	double					mTimeOrigin;			// the time at which step 0 was due, guarded by mMutex
+	std::exception_ptr		mException;				// guarded by mMutex
+	std::vector<InputFn>	mInputs;				// guarded by mMutex
+	bool					mShouldQuit;			// guarded by mMutex
+
+	std::atomic<uint64_t>	mNumSteps, mNumDroppedSteps;
+	std::atomic<uint32_t>	mMaxCatchUpSteps;
+	std::atomic<bool>		mPaused;
+	Timer					mTimer;
+	std::thread				mThread;
+	mutable std::mutex		mMutex;
+	std::condition_variable	mWakeCond;
+};
+
+template<typename StateT>
+FixedStepThread<StateT>::FixedStepThread( const StateT &initialState, double timestep, const StepFn &stepFn )
+	: mTimestep( timestep ), mStepFn( stepFn ), mState( initialState ), mPrevious( initialState ), mCurrent( initialState ), mNumPublished( 0 ),
+		mTimeOrigin( 0 ), mShouldQuit( false ), mNumSteps( 0 ), mNumDroppedSteps( 0 ), mMaxCatchUpSteps( 10 ), mPaused( false ), mTimer( true )
+{
+}
+
+template<typename StateT>
+void FixedStepThread<StateT>::start()
+{
+	if( isRunning() )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mShouldQuit = false;
+		// the current snapshot is treated as due now, so that interpolation starts from it
+		mTimeOrigin = mTimer.getSeconds() - mNumPublished * mTimestep;
+	}
+	mThread = std::thread( std::bind( &FixedStepThread<StateT>::threadLoop, this ) );
+}
+
+template<typename StateT>
+void FixedStepThread<StateT>::stop()
+{
+	if( ! isRunning() )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mShouldQuit = true;
+	}
+	mWakeCond.notify_all();
+	mThread.join();
+}
+
+template<typename StateT>
+void FixedStepThread<StateT>::setPaused( bool paused )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( mPaused == paused )
+		return;
+
+	mPaused = paused;
+	// resuming reschedules the steps from the last one published, so the time spent paused isn't caught up with
+	if( ! paused )
+		mTimeOrigin = mTimer.getSeconds() - mNumPublished * mTimestep;
+	mWakeCond.notify_all();
+}
+
+template<typename StateT>
+void FixedStepThread<StateT>::post( const InputFn &inputFn )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mInputs.push_back( inputFn );
+}
+
+template<typename StateT>
+float FixedStepThread<StateT>::getSnapshots( StateT *previous, StateT *current ) const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( mException )
+		std::rethrow_exception( mException );
+
+	*previous = mPrevious;
+	*current = mCurrent;
+	return getInterpolationFactor();
+}
+
+template<typename StateT>
+StateT FixedStepThread<StateT>::getInterpolated( const LerpFn &lerpFn ) const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( mException )
+		std::rethrow_exception( mException );
+
+	return lerpFn( mPrevious, mCurrent, getInterpolationFactor() );
+}
+
+template<typename StateT>
+StateT FixedStepThread<StateT>::getCurrent() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( mException )
+		std::rethrow_exception( mException );
+
+	return mCurrent;
+}
+
+template<typename StateT>
+float FixedStepThread<StateT>::getInterpolationFactor() const
+{
+	if( mPaused || ( mNumPublished == 0 ) )
+		return 1;
+
+	// rendering one timestep behind, the current time falls between the previous snapshot and the current one
+	double t = ( mTimer.getSeconds() - mTimeOrigin ) / mTimestep - mNumPublished;
+	return (float)constrain<double>( t, 0, 1 );
+}
+
+template<typename StateT>
+void FixedStepThread<StateT>::threadLoop()
+{
+	std::vector<InputFn> inputs;
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( ! mShouldQuit ) {
+		double due = getStepsDue();
+		if( mPaused || ( mNumPublished + 1 > due ) ) {
+			double wait = mPaused ? 0.1 : ( mNumPublished + 1 - due ) * mTimestep;
+			mWakeCond.wait_for( lock, std::chrono::microseconds( (long long)( wait * 1000000 ) + 1 ) );
+			continue;
+		}
+
+		// once further behind than the maximum catch-up, the schedule moves ahead and the steps in between are dropped
+		uint64_t behind = (uint64_t)due - mNumPublished;
+		if( behind > mMaxCatchUpSteps ) {
+			uint64_t dropped = behind - mMaxCatchUpSteps;
+			mTimeOrigin += dropped * mTimestep;
+			mNumDroppedSteps += dropped;
+		}
+
+		inputs.swap( mInputs );
+		lock.unlock();
+
+		try {
+			for( typename std::vector<InputFn>::iterator inputIt = inputs.begin(); inputIt != inputs.end(); ++inputIt )
+				(*inputIt)( &mState );
+			inputs.clear();
+			mStepFn( &mState, mTimestep );
+		}
+		catch( ... ) {
+			lock.lock();
+			mException = std::current_exception();
+			break;
+		}
+
+		lock.lock();
+		std::swap( mPrevious, mCurrent );
+		mCurrent = mState;
+		++mNumPublished;
+		++mNumSteps;
+	}
+}
+
+} // namespace cinder
@@ -39,6 +39,8 @@
 #include FT_GLYPH_H
 #endif
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -85,10 +87,12 @@ class Font {
 	Glyph					getGlyphIndex( size_t idx ) const;
 	Glyph					getGlyphChar( char utf8Char ) const;
 	std::vector<Glyph>		getGlyphs( const std::string &utf8String ) const;
-	//! Returns a cinder::Shape2d representing the shape of the glyph at \a glyphIndex
+	//! Returns a cinder::Shape2d representing the shape of the glyph at \a glyphIndex. Cached per Font after the first call.
 	Shape2d					getGlyphShape( Glyph glyphIndex ) const;
-	//! Returns the bounding box of a Glyph, relative to the baseline as the origin
+	//! Returns the bounding box of a Glyph, relative to the baseline as the origin. Cached per Font after the first call.
 	Rectf					getGlyphBoundingBox( Glyph glyph ) const;
+	//! Discards the glyph shapes, glyph bounding boxes and string measurements cached for this Font and all of its copies
+	void					clearCaches();
 
 #if defined( CINDER_WINRT )
 	FT_Face					getFace() const { return mObj->mFace; }
@@ -108,6 +112,38 @@ class Font {
 #endif
 
  private:
+	//! Identifies a string measured by TextBox or TextLayout, along with the layout parameters which affect it
+	struct MeasureKey {
+		MeasureKey( const std::string &text, const Vec2i &size, int alignment, bool ligate )
+			: mText( text ), mSize( size ), mAlignment( alignment ), mLigate( ligate )
+		{}
+
+		bool	operator<( const MeasureKey &rhs ) const;
+
+		std::string		mText;
+		Vec2i			mSize;
+		int				mAlignment;
+		bool			mLigate;
+	};
+
+	//! The cached results of measuring a string. Each part is filled in by the first call which needs it.
+	struct Measurement {
+		Measurement() : mHasSize( false ), mHasGlyphs( false ) {}
+
+		bool									mHasSize, mHasGlyphs;
+		Vec2f									mSize;
+		std::vector<std::pair<Glyph,Vec2f> >	mGlyphs;
+	};
+
+	//! Copies the cached parts of the measurement of \a key requested by the non-NULL \a size and \a glyphs. Returns whether all of them were cached.
+	bool	findMeasurement( const MeasureKey &key, Vec2f *size, std::vector<std::pair<Glyph,Vec2f> > *glyphs ) const;
+	//! Caches the parts of the measurement of \a key given by the non-NULL \a size and \a glyphs
+	void	cacheMeasurement( const MeasureKey &key, const Vec2f *size, const std::vector<std::pair<Glyph,Vec2f> > *glyphs ) const;
+
+	// the platform implementations behind getGlyphShape() and getGlyphBoundingBox()
+	Shape2d	loadGlyphShape( Glyph glyphIndex ) const;
+	Rectf	loadGlyphBoundingBox( Glyph glyph ) const;
+
 	class Obj {
 	 public:
 		Obj( const std::string &aName, float aSize );
@@ -135,8 +171,18 @@ class Font {
 		FT_Face mFace;
 #endif 		
 		size_t					mNumGlyphs;
+
+		// shared by every copy of the Font, which may be used from multiple threads
+		std::mutex							mCacheMutex;
+		std::map<Glyph,Shape2d>				mGlyphShapes;
+		std::map<Glyph,Rectf>				mGlyphBoundingBoxes;
+		std::map<MeasureKey,Measurement>	mMeasurements;
 	};
 
+	friend class TextBox;
+	friend class Line;
+	friend class TextManager;
+
 	std::shared_ptr<Obj>			mObj;
 	
   public:
@@ -0,0 +1,132 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Buffer.h"
+#include "cinder/Channel.h"
+#include "cinder/DataSource.h"
+#include "cinder/Exception.h"
+#include "cinder/Font.h"
+#include "cinder/Thread.h"
+#include "cinder/Vector.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+/** \brief Rasterizes a font with the bundled FreeType rather than the platform's text APIs. \ImplShared
+ *
+ * Every thread which uses a FreeTypeFont gets its own FT_Library and FT_Face, created on first use and shared by every copy of the FreeTypeFont,
+ * so a single FreeTypeFont can measure and rasterize from any number of threads at once with no locking beyond finding the calling thread's face.
+ * A thread's face is kept until the FreeTypeFont is destroyed, so use it from long lived threads such as those of TaskPool::get().
+ * The font file is loaded once and shared by all of them. Glyph indices are the font file's own, which are the same ones Font uses on Mac and MSW,
+ * so glyphs measured with a Font can be rasterized by a FreeTypeFont of the same file. TextBox::freeTypeFont() and gl::TextureFont::Format::freeType()
+ * render with a FreeTypeFont. Sizes are in pixels.
+ **/
+class FreeTypeFont {
+  public:
+	//! Constructs a null FreeTypeFont
+	FreeTypeFont() {}
+	//! Loads the face at \a faceIndex of the font file in \a dataSource, such as a .ttf, .otf or .ttc, at \a size pixels per em
+	FreeTypeFont( DataSourceRef dataSource, float size, size_t faceIndex = 0 );
+	/** Loads the font file behind the installed font \a font at the same size in pixels. Throws FreeTypeFontExc for a Font whose file can't be found,
+		such as one created from a DataSource on Mac, in which case construct the FreeTypeFont from the same DataSource instead. Call from the main thread. **/
+	explicit FreeTypeFont( const Font &font );
+
+	//! Returns the size in pixels per em
+	float		getSize() const { return mObj->mSize; }
+	//! Returns the PostScript name of the face
+	const std::string&	getName() const { return mObj->mName; }
+	float		getAscent() const { return mObj->mAscent; }
+	float		getDescent() const { return mObj->mDescent; }
+	//! Returns the gap between lines, in addition to the ascent and descent
+	float		getLeading() const { return mObj->mLeading; }
+	size_t		getNumGlyphs() const { return mObj->mNumGlyphs; }
+
+	//! Returns the glyph of the Unicode code point \a codePoint, or \c 0 if the font doesn't have one
+	Font::Glyph					getGlyphChar( uint32_t codePoint ) const;
+	//! Returns the glyphs of the characters of \a utf8String, one per code point
+	std::vector<Font::Glyph>	getGlyphs( const std::string &utf8String ) const;
+	//! Returns the horizontal advance of \a glyph in pixels
+	float		getAdvance( Font::Glyph glyph ) const;
+	//! Returns the horizontal kerning adjustment in pixels between \a left and \a right when \a right follows \a left
+	float		getKerning( Font::Glyph left, Font::Glyph right ) const;
+	//! Returns the glyphs of \a utf8String along with the positions of their left baselines, kerned, starting from the origin
+	std::vector<std::pair<Font::Glyph,Vec2f> >	getGlyphPlacements( const std::string &utf8String ) const;
+	//! Returns the width in pixels of \a utf8String as a single line
+	float		measureString( const std::string &utf8String ) const;
+
+	/** Renders the coverage of \a glyph into \a coverage, which is resized to fit it, and sets \a bearing to the offset of its upper-left
+		from the glyph's left baseline, with y increasing downwards. Returns \c false for glyphs without a bitmap, such as spaces. **/
+	bool		renderGlyph( Font::Glyph glyph, Channel8u *coverage, Vec2i *bearing ) const;
+	//! Renders the glyphs in \a placements, offset by \a baseline, into \a destination. Overlapping glyphs keep the greater coverage.
+	void		renderGlyphs( const std::vector<std::pair<Font::Glyph,Vec2f> > &placements, const Vec2f &baseline, Channel8u *destination ) const;
+
+  private:
+	struct ThreadFace;
+
+	class Obj {
+	  public:
+		Obj( const Buffer &fontData, float size, size_t faceIndex );
+		~Obj();
+
+		//! Returns the FT_Face of the calling thread, creating it along with an FT_Library the first time
+		ThreadFace*		getThreadFace();
+
+		Buffer			mFontData;
+		float			mSize;
+		size_t			mFaceIndex;
+		std::string		mName;
+		float			mAscent, mDescent, mLeading;
+		size_t			mNumGlyphs;
+		bool			mHasKerning;
+
+		std::mutex								mFacesMutex;
+		std::map<std::thread::id,ThreadFace*>	mFaces;
+	};
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> FreeTypeFont::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &FreeTypeFont::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+class FreeTypeFontExc : public cinder::Exception {
+  public:
+	FreeTypeFontExc( const std::string &description ) throw();
+	virtual const char* what() const throw() { return mMessage; }
+
+  private:
+	char mMessage[1024];
+};
+
+} // namespace cinder
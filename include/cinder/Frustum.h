@@ -44,6 +44,11 @@ class Frustum
 {	
   public:
 	enum { NEAR, FAR, LEFT, RIGHT, TOP, BOTTOM };
+	//! Plane mask selecting all six planes, for classify() and the batch tests
+	static const uint32_t ALL_PLANES = 0x3F;
+
+	//! Result of classify()
+	enum Classification { OUTSIDE, INTERSECTS, INSIDE };
 
   public:
 	Frustum() {}
@@ -82,6 +87,14 @@ class Frustum
 		return intersects(box); 
 	};
 
+	//! Classifies \a box against the planes set in \a planeMask (bit \c i for plane \c i), clearing the bits of planes the box lies entirely inside. For hierarchical culling of a BVH or octree, pass the parent's resulting mask to its children; a child whose mask reaches 0 and all of its descendants are visible without further tests.
+	Classification classify( const AxisAlignedBox3f &box, uint32_t *planeMask ) const;
+
+	//! Tests \a count spheres, given as separate arrays of center coordinates and radii, against the planes in \a planeMask. Sets bit <tt>i % 32</tt> of <tt>resultMask[i / 32]</tt> if sphere \c i intersects the frustum, as intersects() would, and returns the number that do. \a resultMask must hold <tt>(count + 31) / 32</tt> words. Evaluates four spheres at a time with SSE2 where available.
+	size_t intersectsSpheres( const T *centersX, const T *centersY, const T *centersZ, const T *radii, size_t count, uint32_t *resultMask, uint32_t planeMask = ALL_PLANES ) const;
+	//! Tests \a count boxes, given as separate arrays of minimum and maximum coordinates, against the planes in \a planeMask. Sets bit <tt>i % 32</tt> of <tt>resultMask[i / 32]</tt> if box \c i intersects the frustum, as intersects() would, and returns the number that do. \a resultMask must hold <tt>(count + 31) / 32</tt> words. Evaluates four boxes at a time with SSE2 where available.
+	size_t intersectsBoxes( const T *minX, const T *minY, const T *minZ, const T *maxX, const T *maxY, const T *maxZ, size_t count, uint32_t *resultMask, uint32_t planeMask = ALL_PLANES ) const;
+
   protected:
 	Plane<T>	mFrustumPlanes[6];
 };
@@ -91,21 +91,31 @@ class ImageSource : public ImageIo {
 	//! Optional parameters passed when creating an Image. \see loadImage()
 	class Options {
 	  public:
-		Options() : mIndex( 0 ), mThrowOnFirstException( false ) {}
+		Options() : mIndex( 0 ), mThrowOnFirstException( false ), mArea( Area::zero() ), mDecodeSize( Vec2i::zero() ) {}
 
 		//! Specifies an image index for multi-part images, like animated GIFs
 		Options& index( int32_t index )						{ mIndex = index; return *this; }
 		//! If an exception occurs, enabling this will prevent any attempts at using other handlers to load the image. Default = false, all handlers are tried and if none succeed, the last exception is rethrown. \see ImageIoException
 		Options& throwOnFirstException( bool b = true )		{ mThrowOnFirstException = b; return *this; }
+		//! Specifies the region of the image to decode, in source pixels, clipped to the image's bounds. Supported by the WIC, ImageIO and png decoders. Default is an empty Area, which decodes the whole image.
+		Options& area( const Area &area )					{ mArea = area; return *this; }
+		//! Specifies a size the image (or area()) should be scaled down to fit within while decoding, preserving its aspect ratio. Supported by the WIC, ImageIO and png decoders, where JPEG images are decoded at reduced resolution rather than at full size and then scaled. Images are never scaled up. Default is (0, 0), which decodes at full size.
+		Options& decodeSize( const Vec2i &size )			{ mDecodeSize = size; return *this; }
 
 		//! Returns image index. \see index()
 		int32_t				getIndex() const				{ return mIndex; }
 		//! Returns whether throwOnFirstException() is enabled or not.
 		bool				getThrowOnFirstException()		{ return mThrowOnFirstException; }
+		//! Returns the region of the image to decode. \see area()
+		const Area&			getArea() const					{ return mArea; }
+		//! Returns the size the image should be scaled down to fit within while decoding. \see decodeSize()
+		const Vec2i&		getDecodeSize() const			{ return mDecodeSize; }
 		
 	  protected:
 		int32_t			mIndex;
 		bool			mThrowOnFirstException;
+		Area			mArea;
+		Vec2i			mDecodeSize;
 	};
 
 	//! Returns the aspect ratio of individual pixels to accommodate non-square pixels
@@ -115,6 +125,11 @@ class ImageSource : public ImageIo {
 
 	virtual void	load( ImageTargetRef target ) = 0;
 
+	//! Returns the region of an image of size \a imageSize that \a options asks to decode, which is the whole image unless Options::area() was specified. Throws ImageIoException if the area doesn't overlap the image.
+	static Area		calcDecodeArea( const Options &options, const Vec2i &imageSize );
+	//! Returns the size that an area of \a areaSize should be decoded at according to Options::decodeSize()
+	static Vec2i	calcDecodeSize( const Options &options, const Vec2i &areaSize );
+
 	typedef void (ImageSource::*RowFunc)(ImageTargetRef, int32_t, const void*);
 
   protected:
@@ -0,0 +1,137 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+#include "cinder/Thread.h"
+#include "cinder/Filesystem.h"
+#include "cinder/gl/Fbo.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <exception>
+#include <string>
+
+namespace cinder {
+
+class TaskPool;
+
+typedef std::shared_ptr<class ImageSequenceWriter>	ImageSequenceWriterRef;
+
+/** \brief Writes numbered image files on the TaskPool, so that saving a frame doesn't block the caller.
+ *
+ * Frames are written to <tt>directory / ( baseName + index + "." + extension )</tt>, with the index zero-padded. At most Format::maxFramesInFlight() frames
+ * are held in memory, whether queued for encoding or waiting on an Fbo readback; once the limit is reached write() blocks until a frame finishes, applying
+ * back-pressure rather than growing without bound. write() and flush() must be called from a single thread, which must have the GL context current when
+ * writing FboReadbacks. If encoding a frame fails, the exception is rethrown by the next call to write() or flush(). **/
+class ImageSequenceWriter : private boost::noncopyable {
+  public:
+	struct Format {
+		Format() : mMaxFramesInFlight( 4 ), mReadbackLatency( 2 ), mNumDigits( 5 ), mStartIndex( 0 ), mTaskPool( 0 ) {}
+
+		//! Sets the maximum number of frames held in memory before write() blocks. Default is \c 4.
+		Format&	maxFramesInFlight( size_t frames )					{ mMaxFramesInFlight = std::max<size_t>( 1, frames ); return *this; }
+		//! Sets the number of subsequent write() calls an FboReadback is left in flight before it is collected. Default is \c 2, which lets the transfer complete without stalling.
+		Format&	readbackLatency( size_t frames )					{ mReadbackLatency = frames; return *this; }
+		//! Sets the number of digits the frame index is zero-padded to. Default is \c 5.
+		Format&	numDigits( int digits )								{ mNumDigits = digits; return *this; }
+		//! Sets the index of the first frame. Default is \c 0.
+		Format&	startIndex( int32_t index )							{ mStartIndex = index; return *this; }
+		//! Sets the ImageTarget::Options passed to writeImage() for each frame.
+		Format&	imageOptions( const ImageTarget::Options &options )	{ mImageOptions = options; return *this; }
+		//! Sets the TaskPool frames are encoded on. Default is TaskPool::get().
+		Format&	taskPool( TaskPool *taskPool )						{ mTaskPool = taskPool; return *this; }
+
+		size_t						getMaxFramesInFlight() const	{ return mMaxFramesInFlight; }
+		size_t						getReadbackLatency() const		{ return mReadbackLatency; }
+		int							getNumDigits() const			{ return mNumDigits; }
+		int32_t						getStartIndex() const			{ return mStartIndex; }
+		const ImageTarget::Options&	getImageOptions() const			{ return mImageOptions; }
+		TaskPool*					getTaskPool() const				{ return mTaskPool; }
+
+	  protected:
+		size_t					mMaxFramesInFlight, mReadbackLatency;
+		int						mNumDigits;
+		int32_t					mStartIndex;
+		ImageTarget::Options	mImageOptions;
+		TaskPool				*mTaskPool;
+	};
+
+	//! Creates a writer for frames in \a directory, which is created if necessary. \a extension selects the image format, for example \c "png".
+	static ImageSequenceWriterRef	create( const fs::path &directory, const std::string &baseName, const std::string &extension = "png", const Format &format = Format() );
+	//! Waits for all frames to be written. Errors are discarded; call flush() beforehand to observe them.
+	~ImageSequenceWriter();
+
+	/** \brief Queues \a surface to be written as the next frame. The Surface is retained and must not be modified afterwards; pass a clone when it is reused.
+		Setting \a channelOrder in Surface's constructor to match the file format, for example \c RGBA for PNG, avoids a conversion on the worker thread. **/
+	void	write( const Surface8u &surface );
+	//! Queues \a readback as the next frame. Its pixels are collected after Format::readbackLatency() further writes, or by flush(), so the GPU transfer doesn't stall the caller.
+	void	write( const gl::FboReadback &readback );
+	//! Collects any outstanding FboReadbacks and blocks until every queued frame has been written.
+	void	flush();
+
+	//! Returns the number of frames queued or being written, including FboReadbacks not yet collected.
+	size_t	getNumFramesInFlight() const;
+	//! Returns the number of frames written to disk so far.
+	size_t	getNumFramesWritten() const;
+	//! Returns the path the next frame passed to write() will be written to.
+	fs::path	getNextFramePath() const		{ return getFramePath( mNextIndex ); }
+	//! Returns the path of the frame with index \a index.
+	fs::path	getFramePath( int32_t index ) const;
+
+  private:
+	ImageSequenceWriter( const fs::path &directory, const std::string &baseName, const std::string &extension, const Format &format );
+
+	//! Ages the outstanding readbacks and makes room for one more frame, rethrowing any pending encoding error.
+	void	prepareFrame();
+	//! Blocks until fewer than \a maxFrames frames are in flight.
+	void	waitForFrames( size_t maxFrames );
+	void	encode( const Surface8u &surface, int32_t index );
+	void	collectReadback();
+	void	rethrowError();
+
+	struct PendingReadback {
+		gl::FboReadback		mReadback;
+		int32_t				mIndex;
+		size_t				mAge;
+	};
+
+	fs::path					mDirectory;
+	std::string					mBaseName, mExtension;
+	Format						mFormat;
+	TaskPool					*mTaskPool;
+	int32_t						mNextIndex;
+
+	std::deque<PendingReadback>	mReadbacks;
+
+	mutable std::mutex			mMutex;
+	std::condition_variable		mFrameFinishedCond;
+	size_t						mNumEncoding, mNumWritten;
+	std::exception_ptr			mError;
+};
+
+} // namespace cinder
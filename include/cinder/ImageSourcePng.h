@@ -43,15 +43,33 @@ class ImageSourcePng : public ImageSource {
 
 	virtual void	load( ImageTargetRef target );
 
+	//! \brief Decodes up to \a numRows of the next rows of the image into \a dest, whose rows are \a destRowBytes apart. Returns the number of rows decoded, which is less than \a numRows once the end of the image is reached.
+	//!
+	//! Rows are in the source's DataType and ChannelOrder, cropped and scaled according to the ImageSource::Options. This allows large images to be decoded in bands into a caller-supplied buffer, without a full-size ImageTarget. Can't be combined with load(), since the image is decoded as a stream.
+	int32_t			readRows( void *dest, size_t destRowBytes, int32_t numRows );
+	//! Returns the size in bytes of a row as written by readRows()
+	size_t			getRowBytes() const;
+
 	static void		registerSelf();
 
   protected:
 	ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options );
 	bool loadHeader();
+	void setupDecode( const ImageSource::Options &options );
+	void readRow( uint8_t *dest );
+	template<typename T>
+	void readRowScaled( T *dest );
 	
 	std::shared_ptr<ci_png_info>	mCiInfoPtr;
 	png_struct_def					*mPngPtr;
 	png_info						*mInfoPtr;
+
+	Area							mDecodeArea; // in source pixels
+	bool							mScaled;
+	int32_t							mNumSourceRowsRead, mNumRowsRead;
+	std::vector<uint8_t>			mSourceRow;
+	std::vector<double>				mRowSums;
+	std::vector<int32_t>			mColumnBounds; // when scaled, the first source column of each decoded column, followed by the end column
 };
 
 REGISTER_IMAGE_IO_FILE_HANDLER( ImageSourcePng )
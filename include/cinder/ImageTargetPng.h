@@ -0,0 +1,72 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class ImageTargetPng>	ImageTargetPngRef;
+
+/** \brief Writes PNG files directly through zlib, filtering and compressing the image in parallel on the TaskPool.
+ *
+ * The ImageTarget::Options quality selects the zlib compression level through qualityToCompressionLevel(): 0 stores the image uncompressed,
+ * low values use zlib's fastest levels and 1.0 its smallest output. Stored images are not filtered, levels 1 and 2 use PNG's Sub filter alone
+ * and higher levels pick whichever filter gives each row the smallest residual. 8 and 16 bit gray, gray + alpha, RGB and RGBA images are
+ * written; float images are written as 16 bit. **/
+class ImageTargetPng : public ImageTarget {
+  public:
+	static ImageTargetRef	createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+
+	virtual void*	getRowPointer( int32_t row );
+	virtual void	finalize();
+
+	//! Returns the zlib compression level (0-9) corresponding to \a quality
+	static int		qualityToCompressionLevel( float quality );
+
+	static void		registerSelf();
+
+  protected:
+	ImageTargetPng( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options );
+
+	enum FilterMode { FILTER_NONE, FILTER_SUB, FILTER_ADAPTIVE };
+
+	//! Writes the filter type byte followed by the filtered bytes of \a row to \a dest
+	void	filterRow( int32_t row, uint8_t *dest, FilterMode mode ) const;
+	void	writeChunk( const char *type, const uint8_t *data, size_t size );
+
+	DataTargetRef			mDataTarget;
+	OStreamRef				mStream;
+	int						mCompressionLevel;
+	uint8_t					mPngColorType;
+	size_t					mPixelBytes, mRowBytes;
+	std::vector<uint8_t>	mData;
+};
+
+REGISTER_IMAGE_IO_FILE_HANDLER( ImageTargetPng )
+
+} // namespace cinder
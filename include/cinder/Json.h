@@ -30,7 +30,9 @@
 #include "cinder/Utilities.h"
 
 #include <string>
+#include <vector>
 #include <boost/container/list.hpp>
+#include <boost/noncopyable.hpp>
 
 namespace Json {
 	class Value;
@@ -38,6 +40,8 @@ namespace Json {
 
 namespace cinder {
 
+class JsonWriter;
+
 class JsonTree {
   public:
 	
@@ -98,6 +102,7 @@ class JsonTree {
 	//! Parses the JSON contained in the string \a xmlString
 	JsonTree( const JsonTree &jsonTree );
 	/** \brief Parses JSON contained in \a dataSource. Commonly used with the results of loadUrl(), loadFile() or loadResource().
+		The source is read incrementally and the tree is built as it is parsed, so the whole document is never held in memory as text.
 		<br><tt>JsonTree myDoc( loadUrl( "http://search.twitter.com/search.json?q=libcinder&rpp=10&result_type=recent" ) );</tt> **/
 	explicit JsonTree( DataSourceRef dataSource, ParseOptions parseOptions = ParseOptions() );
 	//! Parses the JSON contained in the string \a jsonString .
@@ -209,7 +214,7 @@ class JsonTree {
 	 If \a writeOptions creates a document then an implicit parent object node is created when necessary and \a this is treated as the root element.
 	 If \a writeOptions indents then the JSON string will be indented.**/
 	void							write( const fs::path &path, WriteOptions writeOptions = WriteOptions() );
-	/**! Writes this JsonTree to \a target. 
+	/**! Writes this JsonTree to \a target. The JSON text is streamed to \a target as the tree is traversed.
 		If \a writeOptions creates a document then an implicit parent object node is created when necessary and \a this is treated as the root element.
 	    If \a writeOptions indents then the JSON string will be indented.**/
 	void							write( DataTargetRef target, WriteOptions writeOptions = WriteOptions() );
@@ -254,11 +259,14 @@ private:
 	//! \cond
 	enum ValueType	{ VALUE_BOOL, VALUE_DOUBLE, VALUE_INT, VALUE_STRING, VALUE_UINT	};
 
+	class Builder;
+	friend class BinaryTree;
+
 	explicit JsonTree( const std::string &key, const Json::Value &value );
 
 	Json::Value						createNativeDoc( WriteOptions writeOptions = WriteOptions() ) const;
-	static Json::Value				deserializeNative( const std::string &jsonString, ParseOptions parseOptions );
 	static std::string				serializeNative( const Json::Value &value );
+	void							writeNode( JsonWriter &writer ) const;
    
 	void							init( const std::string &key, const Json::Value &value, bool setType = false, 
 		NodeType nodeType = NODE_VALUE, ValueType valueType = VALUE_STRING );
@@ -326,4 +334,125 @@ private:
 
 std::ostream&						operator<<( std::ostream &out, const JsonTree &json );
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** \brief Incremental, SAX-style JSON parser.
+	Reads its input in fixed-size chunks and reports each value to a JsonReader::Handler as it is encountered, so memory use is independent of the size of the document.
+	<br><tt>JsonReader().parse( loadFile( "feed.json" ), myHandler );</tt> **/
+class JsonReader : private boost::noncopyable {
+  public:
+	//! Receives parsing events from a JsonReader. Each callback returns \c false to stop parsing.
+	class Handler {
+	  public:
+		virtual ~Handler() {}
+
+		virtual bool	nullValue()								{ return true; }
+		virtual bool	boolValue( bool value )					{ return true; }
+		virtual bool	intValue( int64_t value )				{ return true; }
+		//! Called for integers larger than the maximum \c int64_t.
+		virtual bool	uintValue( uint64_t value )				{ return true; }
+		virtual bool	doubleValue( double value )				{ return true; }
+		//! Called for every number with its literal text. The default implementation converts \a literal and calls intValue(), uintValue() or doubleValue().
+		virtual bool	numberValue( const std::string &literal, bool isInteger );
+		virtual bool	stringValue( const std::string &value )	{ return true; }
+
+		virtual bool	startObject()							{ return true; }
+		//! Called with the name of each object member, before its value.
+		virtual bool	key( const std::string &key )			{ return true; }
+		virtual bool	endObject()								{ return true; }
+		virtual bool	startArray()							{ return true; }
+		virtual bool	endArray()								{ return true; }
+	};
+
+	//! Creates a reader which applies \a parseOptions. Comments are skipped if allowed, and parse errors stop parsing silently if ignored.
+	explicit JsonReader( JsonTree::ParseOptions parseOptions = JsonTree::ParseOptions() );
+
+	/** Parses the JSON in \a dataSource, reporting its contents to \a handler. Returns \c false if parsing was stopped by \a handler or by an ignored error.
+		Throws JsonTree::ExcJsonParserError on malformed input unless errors are ignored. **/
+	bool	parse( DataSourceRef dataSource, Handler &handler );
+	//! Parses the JSON read from \a stream, reporting its contents to \a handler.
+	bool	parse( IStreamRef stream, Handler &handler );
+	//! Parses the JSON contained in \a jsonString, reporting its contents to \a handler.
+	bool	parse( const std::string &jsonString, Handler &handler );
+
+  private:
+	bool	parseDocument( Handler &handler );
+	bool	parseMemberName( Handler &handler );
+	void	parseString( std::string *result );
+	void	parseNumber( std::string *result, bool *isInteger );
+	void	parseLiteral( const char *literal );
+	void	parseUnicodeEscape( std::string *result );
+	uint32_t	parseHex4();
+	void	skipWhitespace();
+	void	expect( char c, const char *message );
+	void	error( const std::string &message ) const;
+
+	bool	fill();
+	int		peek()		{ return ( mPos != mEnd || fill() ) ? (unsigned char)*mPos : -1; }
+	int		get()		{ return ( mPos != mEnd || fill() ) ? (unsigned char)*mPos++ : -1; }
+
+	JsonTree::ParseOptions	mParseOptions;
+	IStreamRef				mStream;
+	std::vector<char>		mChunk;
+	const char				*mBegin, *mPos, *mEnd;
+	uint64_t				mBeginOffset, mLineOffset;
+	size_t					mLine;
+	std::string				mToken;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** \brief Writes JSON incrementally to a DataTarget or OStream, without building a document in memory first.
+	Output is buffered and flushed as it grows, when flush() is called, and on destruction.
+	<br><tt>JsonWriter writer( writeFile( "out.json" ) ); writer.startArray().value( 1 ).value( "two" ).endArray();</tt> **/
+class JsonWriter : private boost::noncopyable {
+  public:
+	//! Creates a writer which streams to \a target. If \a indented then members and elements are written one per line.
+	explicit JsonWriter( DataTargetRef target, bool indented = true );
+	//! Creates a writer which streams to \a stream. If \a indented then members and elements are written one per line.
+	explicit JsonWriter( OStreamRef stream, bool indented = true );
+	~JsonWriter();
+
+	JsonWriter&		startObject();
+	JsonWriter&		endObject();
+	JsonWriter&		startArray();
+	JsonWriter&		endArray();
+	//! Writes the name of the next member of the enclosing object. Must precede every value written inside an object.
+	JsonWriter&		key( const std::string &key );
+
+	JsonWriter&		nullValue();
+	JsonWriter&		value( bool value );
+	JsonWriter&		value( int value );
+	JsonWriter&		value( uint32_t value );
+	JsonWriter&		value( int64_t value );
+	JsonWriter&		value( uint64_t value );
+	JsonWriter&		value( float value );
+	//! Writes \a value with 17 significant digits. Non-finite values are written as \c null.
+	JsonWriter&		value( double value );
+	JsonWriter&		value( const std::string &value );
+	JsonWriter&		value( const char *value );
+	//! Writes \a literal verbatim as a number. \a literal must be a valid JSON number.
+	JsonWriter&		numberLiteral( const std::string &literal );
+
+	//! Writes all buffered output to the stream.
+	void			flush();
+
+  private:
+	struct Scope {
+		Scope( bool isObject ) : mIsObject( isObject ), mCount( 0 ) {}
+		bool	mIsObject;
+		size_t	mCount;
+	};
+
+	void	beginValue();
+	void	endValue();
+	void	newline();
+	void	writeString( const std::string &s );
+
+	OStreamRef			mStream;
+	bool				mIndented, mHasKey;
+	std::string			mBuffer;
+	std::vector<Scope>	mScopes;
+};
+
 } // namespace cinder
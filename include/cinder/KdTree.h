@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/TaskPool.h"
 
 #include <vector>
 #include <float.h>
@@ -62,13 +63,17 @@ struct NullLookupProc {
 template <typename NodeData, unsigned char K=3, class LookupProc = NullLookupProc> class KdTree {
 public:
 	typedef std::pair<const NodeData*, uint32_t> NodeDataIndex;
+	//! A query result: the squared distance to the point and its index in the data the tree was built from
+	typedef std::pair<float, uint32_t> Neighbor;
 	
 	// KdTree Public Methods
+	//! Builds the tree from \a data, which must outlive it. If \a taskPool is non-NULL, large subtrees are built in parallel on its threads.
 	template<typename NodeDataVector>
-	KdTree( const NodeDataVector &data );
-	KdTree() {}
+	KdTree( const NodeDataVector &data, TaskPool *taskPool = NULL );
+	KdTree() : nodes( NULL ), mNodeData( NULL ), nNodes( 0 ), nextFreeNode( 0 ) {}
+	//! (Re)builds the tree from \a d. Rebuilding with the same number of points, as when they move every frame, reuses the allocations and starts from the previous build's spatial order, which speeds up rebuilds for coherent motion.
 	template<typename NodeDataVector>
-	void initialize( const NodeDataVector &d );
+	void initialize( const NodeDataVector &d, TaskPool *taskPool = NULL );
 	~KdTree() {
 		free( nodes );
 		delete[] mNodeData;
@@ -76,15 +81,33 @@ public:
 	void recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
 	void lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
 	void findNearest( float p[K], float result[K], uint32_t *resultIndex ) const;
+
+	//! Returns the number of points in the tree
+	uint32_t	size() const { return nNodes; }
+
+	//! Stores into \a result the up to \a k nearest points to \a p lying within \a maxDist, sorted nearest first
+	void findKNearest( const NodeData &p, uint32_t k, std::vector<Neighbor> *result, float maxDist = FLT_MAX ) const;
+	//! Stores into \a result all points lying within \a radius of \a p, in no particular order
+	void findInRadius( const NodeData &p, float radius, std::vector<Neighbor> *result ) const;
+
+	//! Finds the \a k nearest points to each of \a numQueries \a queries. Each query's neighbors are stored nearest first at <tt>(*result)[q * k]</tt>; unused entries have an index of <tt>~0</tt> and a distance of \c FLT_MAX. If \a taskPool is non-NULL the queries are divided among its threads.
+	void findKNearest( const NodeData *queries, size_t numQueries, uint32_t k, std::vector<Neighbor> *result, float maxDist = FLT_MAX, TaskPool *taskPool = NULL ) const;
+	//! Finds the points within \a radius of each of \a numQueries \a queries, storing them into <tt>(*result)[q]</tt>. The inner vectors are reused, so passing the same \a result every frame avoids reallocation. If \a taskPool is non-NULL the queries are divided among its threads.
+	void findInRadius( const NodeData *queries, size_t numQueries, float radius, std::vector<std::vector<Neighbor> > *result, TaskPool *taskPool = NULL ) const;
 	
 private:
 	// KdTree Private Methods
+	void parallelBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes, TaskPool *taskPool );
+	uint32_t buildNode( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
 	void privateLookup(uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared) const;
 	void privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const;
+	void privateFindKNearest( uint32_t nodeNum, const float p[K], uint32_t k, std::vector<Neighbor> &heap, float &maxDistSquared ) const;
+	void privateFindInRadius( uint32_t nodeNum, const float p[K], float radiusSquared, std::vector<Neighbor> &result ) const;
 	// KdTree Private Data
 	KdNode<K> *nodes;
 	NodeDataIndex *mNodeData;
 	uint32_t nNodes, nextFreeNode;
+	std::vector<NodeDataIndex> mBuildNodes; // kept in partitioned order between builds
 };
 
 
@@ -145,42 +168,94 @@ template<typename NodeData> struct CompareNode {
 // KdTree Method Definitions
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
-KdTree<NodeData, K, LookupProc>::KdTree(const NodeDataVector &d)
+KdTree<NodeData, K, LookupProc>::KdTree( const NodeDataVector &d, TaskPool *taskPool )
+	: nodes( NULL ), mNodeData( NULL ), nNodes( 0 ), nextFreeNode( 0 )
 {
-	initialize( d );
+	initialize( d, taskPool );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
-void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d )
+void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d, TaskPool *taskPool )
 {
-	nNodes = NodeDataVectorTraits<NodeDataVector>::getSize( d );
-	nextFreeNode = 1;
-	nodes = (KdNode<K> *)malloc(nNodes * sizeof(KdNode<K>));
-	mNodeData = new NodeDataIndex[nNodes];
-	std::vector<NodeDataIndex> buildNodes;
-	buildNodes.reserve( nNodes );
-	for( uint32_t i = 0; i < nNodes; ++i )
-		buildNodes.push_back( std::make_pair( &d[i], i ) );
+	uint32_t numPoints = NodeDataVectorTraits<NodeDataVector>::getSize( d );
+	if( numPoints != nNodes || ! nodes ) {
+		free( nodes );
+		delete[] mNodeData;
+		nNodes = numPoints;
+		nodes = (KdNode<K> *)malloc(nNodes * sizeof(KdNode<K>));
+		mNodeData = new NodeDataIndex[nNodes];
+		mBuildNodes.clear();
+	}
+	nextFreeNode = nNodes;
+	if( nNodes == 0 )
+		return;
+
+	// When rebuilding, keep the previous build's order so that nth_element() finds its partitions mostly done
+	if( mBuildNodes.size() == nNodes ) {
+		for( uint32_t i = 0; i < nNodes; ++i )
+			mBuildNodes[i].first = &d[mBuildNodes[i].second];
+	}
+	else {
+		mBuildNodes.clear();
+		mBuildNodes.reserve( nNodes );
+		for( uint32_t i = 0; i < nNodes; ++i )
+			mBuildNodes.push_back( std::make_pair( &d[i], i ) );
+	}
 	// Begin the KdTree building process
-	recursiveBuild( 0, 0, nNodes, buildNodes );
+	if( taskPool )
+		parallelBuild( 0, 0, nNodes, mBuildNodes, taskPool );
+	else
+		recursiveBuild( 0, 0, nNodes, mBuildNodes );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
 void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
+{
+	uint32_t splitPos = buildNode( nodeNum, start, end, buildNodes );
+	if( start < splitPos )
+		recursiveBuild( nodeNum + 1, start, splitPos, buildNodes );
+	if( splitPos + 1 < end )
+		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::parallelBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes, TaskPool *taskPool )
+{
+	// below this many points a subtree isn't worth a task
+	const uint32_t minParallelPoints = 8192;
+	if( end - start < minParallelPoints ) {
+		recursiveBuild( nodeNum, start, end, buildNodes );
+		return;
+	}
+
+	// the two subtrees occupy disjoint ranges of both buildNodes and nodes, so they can be built concurrently
+	uint32_t splitPos = buildNode( nodeNum, start, end, buildNodes );
+	TaskRef leftTask;
+	if( start < splitPos )
+		leftTask = taskPool->submit( [=,&buildNodes] { parallelBuild( nodeNum + 1, start, splitPos, buildNodes, taskPool ); } );
+	if( splitPos + 1 < end )
+		parallelBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes, taskPool );
+	if( leftTask )
+		leftTask->wait();
+}
+
+// Initializes node \a nodeNum for the points [start,end) and returns the index of its split point. Nodes are laid out in depth-first order, so a node's left subtree begins at nodeNum + 1 and its right subtree after the left's splitPos - start nodes.
+template<typename NodeData, unsigned char K, typename LookupProc>
+uint32_t KdTree<NodeData, K, LookupProc>::buildNode( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
 {
 	// Create leaf node of kd-tree if we've reached the bottom
 	if( start + 1 == end) {
 		nodes[nodeNum].initLeaf();
 		mNodeData[nodeNum] = buildNodes[start];
-		return;
+		return start;
 	}
 	// Choose split direction and partition data
 	// Compute bounds of data from _start_ to _end_
 	float boundMin[K], boundMax[K];
 	for( unsigned char k = 0; k < K; ++k ) {
 		boundMin[k] = FLT_MAX;
-		boundMax[k] = FLT_MIN;
+		boundMax[k] = -FLT_MAX;
 	}
 	
 	for( uint32_t i = start; i < end; ++i ) {
@@ -203,15 +278,11 @@ void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t
 	// Allocate kd-tree node and continue recursively
 	nodes[nodeNum].init( NodeDataTraits<NodeData>::getAxis( *buildNodes[splitPos].first, splitAxis ), splitAxis );
 	mNodeData[nodeNum] = buildNodes[splitPos];
-	if( start < splitPos ) {
+	if( start < splitPos )
 		nodes[nodeNum].hasLeftChild = 1;
-		uint32_t childNum = nextFreeNode++;
-		recursiveBuild( childNum, start, splitPos, buildNodes );
-	}
-	if( splitPos + 1 < end ) {
-		nodes[nodeNum].rightChild = nextFreeNode++;
-		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
-	}
+	if( splitPos + 1 < end )
+		nodes[nodeNum].rightChild = nodeNum + 1 + ( splitPos - start );
+	return splitPos;
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
@@ -301,4 +372,135 @@ void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, floa
 	}
 }
 
+// K Nearest
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findKNearest( const NodeData &p, uint32_t k, std::vector<Neighbor> *result, float maxDist ) const
+{
+	result->clear();
+	if( nNodes == 0 || k == 0 )
+		return;
+
+	float pt[K];
+	for( unsigned char a = 0; a < K; ++a )
+		pt[a] = NodeDataTraits<NodeData>::getAxis( p, a );
+
+	// result is a max-heap on distance until it is sorted at the end
+	float maxDistSquared = ( maxDist == FLT_MAX ) ? FLT_MAX : maxDist * maxDist;
+	result->reserve( k );
+	privateFindKNearest( 0, pt, k, *result, maxDistSquared );
+	std::sort_heap( result->begin(), result->end() );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::privateFindKNearest( uint32_t nodeNum, const float p[K], uint32_t k, std::vector<Neighbor> &heap, float &maxDistSquared ) const
+{
+	const KdNode<K> *node = &nodes[nodeNum];
+	int axis = node->splitAxis;
+	if( axis != K ) {
+		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
+		if( p[axis] <= node->splitPos ) {
+			if( node->hasLeftChild )
+				privateFindKNearest( nodeNum + 1, p, k, heap, maxDistSquared );
+			if( ( dist2 < maxDistSquared ) && ( node->rightChild < nNodes ) )
+				privateFindKNearest( node->rightChild, p, k, heap, maxDistSquared );
+		}
+		else {
+			if( node->rightChild < nNodes )
+				privateFindKNearest( node->rightChild, p, k, heap, maxDistSquared );
+			if( ( dist2 < maxDistSquared ) && node->hasLeftChild )
+				privateFindKNearest( nodeNum + 1, p, k, heap, maxDistSquared );
+		}
+	}
+
+	float distSqr = 0.0f;
+	for( unsigned char a = 0; a < K; ++a ) {
+		float v = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, a ) - p[a];
+		distSqr += v * v;
+	}
+
+	if( distSqr < maxDistSquared ) {
+		if( heap.size() == k ) {
+			std::pop_heap( heap.begin(), heap.end() );
+			heap.pop_back();
+		}
+		heap.push_back( Neighbor( distSqr, mNodeData[nodeNum].second ) );
+		std::push_heap( heap.begin(), heap.end() );
+		// once full, only points nearer than the furthest kept can be accepted
+		if( heap.size() == k )
+			maxDistSquared = heap.front().first;
+	}
+}
+
+// In Radius
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findInRadius( const NodeData &p, float radius, std::vector<Neighbor> *result ) const
+{
+	result->clear();
+	if( nNodes == 0 )
+		return;
+
+	float pt[K];
+	for( unsigned char a = 0; a < K; ++a )
+		pt[a] = NodeDataTraits<NodeData>::getAxis( p, a );
+
+	privateFindInRadius( 0, pt, radius * radius, *result );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::privateFindInRadius( uint32_t nodeNum, const float p[K], float radiusSquared, std::vector<Neighbor> &result ) const
+{
+	const KdNode<K> *node = &nodes[nodeNum];
+	int axis = node->splitAxis;
+	if( axis != K ) {
+		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
+		if( node->hasLeftChild && ( p[axis] <= node->splitPos || dist2 < radiusSquared ) )
+			privateFindInRadius( nodeNum + 1, p, radiusSquared, result );
+		if( node->rightChild < nNodes && ( p[axis] > node->splitPos || dist2 < radiusSquared ) )
+			privateFindInRadius( node->rightChild, p, radiusSquared, result );
+	}
+
+	float distSqr = 0.0f;
+	for( unsigned char a = 0; a < K; ++a ) {
+		float v = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, a ) - p[a];
+		distSqr += v * v;
+	}
+
+	if( distSqr < radiusSquared )
+		result.push_back( Neighbor( distSqr, mNodeData[nodeNum].second ) );
+}
+
+// Batch queries
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findKNearest( const NodeData *queries, size_t numQueries, uint32_t k, std::vector<Neighbor> *result, float maxDist, TaskPool *taskPool ) const
+{
+	result->assign( numQueries * k, Neighbor( FLT_MAX, ~0u ) );
+	std::function<void ( size_t, size_t )> queryRange = [=]( size_t first, size_t last ) {
+		std::vector<Neighbor> neighbors;
+		for( size_t q = first; q < last; ++q ) {
+			findKNearest( queries[q], k, &neighbors, maxDist );
+			std::copy( neighbors.begin(), neighbors.end(), result->begin() + q * k );
+		}
+	};
+
+	if( taskPool )
+		taskPool->parallelFor( 0, numQueries, queryRange );
+	else
+		queryRange( 0, numQueries );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findInRadius( const NodeData *queries, size_t numQueries, float radius, std::vector<std::vector<Neighbor> > *result, TaskPool *taskPool ) const
+{
+	result->resize( numQueries );
+	std::function<void ( size_t, size_t )> queryRange = [=]( size_t first, size_t last ) {
+		for( size_t q = first; q < last; ++q )
+			findInRadius( queries[q], radius, &(*result)[q] );
+	};
+
+	if( taskPool )
+		taskPool->parallelFor( 0, numQueries, queryRange );
+	else
+		queryRange( 0, numQueries );
+}
+
 } // namespace ci
@@ -25,6 +25,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
 #include "cinder/Vector.h"
 
 #include "cinder/Matrix22.h"
@@ -211,6 +212,15 @@ public:
 	Vec3<T>				transformVec( const Vec3<T> &rhs ) const;
 	Vec4<T>				transformVec( const Vec4<T> &rhs ) const { return transformVec( rhs.xyz() ); }
 
+	//! Transforms \a count points from \a in into \a out, identical to calling transformPoint() on each one. \a in and \a out may be the same array.
+	void				transformPoints( const Vec3<T> *in, Vec3<T> *out, size_t count ) const;
+	//! Transforms \a count points from \a in into \a out, identical to calling transformPointAffine() on each one. \a in and \a out may be the same array.
+	void				transformPointsAffine( const Vec3<T> *in, Vec3<T> *out, size_t count ) const;
+	//! Transforms \a count vectors from \a in into \a out, identical to calling transformVec() on each one. \a in and \a out may be the same array.
+	void				transformVecs( const Vec3<T> *in, Vec3<T> *out, size_t count ) const;
+	//! Post-multiplies \a count column vectors from \a in into \a out, identical to operator*( const Vec4<T>& ). \a in and \a out may be the same array.
+	void				postMultiply( const Vec4<T> *in, Vec4<T> *out, size_t count ) const;
+
 	// returns the translation values from the last column
 	Vec4<T>				getTranslate() const { return Vec4<T>( m03, m13, m23, m33 ); }
 	// sets the translation values in the last column
@@ -1081,6 +1091,34 @@ Vec3<T> Matrix44<T>::transformVec( const Vec3<T> &rhs ) const
 	return Vec3<T>( x, y, z );
 }
 
+template< typename T >
+void Matrix44<T>::transformPoints( const Vec3<T> *in, Vec3<T> *out, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		out[i] = transformPoint( in[i] );
+}
+
+template< typename T >
+void Matrix44<T>::transformPointsAffine( const Vec3<T> *in, Vec3<T> *out, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		out[i] = transformPointAffine( in[i] );
+}
+
+template< typename T >
+void Matrix44<T>::transformVecs( const Vec3<T> *in, Vec3<T> *out, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		out[i] = transformVec( in[i] );
+}
+
+template< typename T >
+void Matrix44<T>::postMultiply( const Vec4<T> *in, Vec4<T> *out, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		out[i] = *this * in[i];
+}
+
 template< typename T > // thanks to @juj/MathGeoLib for fix
 void Matrix44<T>::orthonormalInvert()
 {
@@ -1309,6 +1347,219 @@ Matrix44<T> Matrix44<T>::alignZAxisWithTarget( Vec3<T> targetDir, Vec3<T> upDir
     return mat;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE specializations for Matrix44f. These only use SSE1 instructions, so unlike the SSE2 paths elsewhere they need
+// no System::hasSse2() check. Each one performs the same operations in the same order as the scalar code above,
+// so the results are bit-identical. Matrix44f and Vec3f/Vec4f carry no alignment guarantees, so all loads and stores are unaligned.
+#if defined( CINDER_SSE2 )
+
+namespace detail {
+
+inline __m128 mat44MulColumn( const __m128 c[4], const float *v )
+{
+	__m128 r = _mm_mul_ps( c[0], _mm_set1_ps( v[0] ) );
+	r = _mm_add_ps( r, _mm_mul_ps( c[1], _mm_set1_ps( v[1] ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( c[2], _mm_set1_ps( v[2] ) ) );
+	return _mm_add_ps( r, _mm_mul_ps( c[3], _mm_set1_ps( v[3] ) ) );
+}
+
+inline void mat44Multiply( const float *a, const float *b, float *result )
+{
+	__m128 c[4] = { _mm_loadu_ps( a ), _mm_loadu_ps( a + 4 ), _mm_loadu_ps( a + 8 ), _mm_loadu_ps( a + 12 ) };
+	// all columns are computed before storing, so result may alias a or b
+	__m128 r0 = mat44MulColumn( c, b );
+	__m128 r1 = mat44MulColumn( c, b + 4 );
+	__m128 r2 = mat44MulColumn( c, b + 8 );
+	__m128 r3 = mat44MulColumn( c, b + 12 );
+	_mm_storeu_ps( result, r0 );
+	_mm_storeu_ps( result + 4, r1 );
+	_mm_storeu_ps( result + 8, r2 );
+	_mm_storeu_ps( result + 12, r3 );
+}
+
+// Loads 4 packed Vec3f's as x, y and z vectors
+inline void loadVec3fx4( const float *src, __m128 &x, __m128 &y, __m128 &z )
+{
+	__m128 a = _mm_loadu_ps( src );		// x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps( src + 4 );	// y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps( src + 8 );	// z2 x3 y3 z3
+	__m128 p = _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 1, 3, 2 ) ); // x2 y2 x3 y3
+	__m128 q = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 0, 2, 1 ) ); // y0 z0 y1 z1
+	x = _mm_shuffle_ps( a, p, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	y = _mm_shuffle_ps( q, p, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	z = _mm_shuffle_ps( q, c, _MM_SHUFFLE( 3, 0, 3, 1 ) );
+}
+
+// Stores x, y and z vectors as 4 packed Vec3f's
+inline void storeVec3fx4( float *dst, __m128 x, __m128 y, __m128 z )
+{
+	__m128 xyLo = _mm_unpacklo_ps( x, y );	// x0 y0 x1 y1
+	__m128 xyHi = _mm_unpackhi_ps( x, y );	// x2 y2 x3 y3
+	__m128 t1 = _mm_shuffle_ps( z, x, _MM_SHUFFLE( 1, 1, 1, 0 ) ); // z0 z1 x1 x1
+	__m128 t2 = _mm_shuffle_ps( xyLo, t1, _MM_SHUFFLE( 1, 1, 3, 3 ) ); // y1 y1 z1 z1
+	__m128 t3 = _mm_shuffle_ps( xyHi, z, _MM_SHUFFLE( 3, 2, 3, 2 ) ); // x3 y3 z2 z3
+	_mm_storeu_ps( dst, _mm_shuffle_ps( xyLo, t1, _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+	_mm_storeu_ps( dst + 4, _mm_shuffle_ps( t2, xyHi, _MM_SHUFFLE( 1, 0, 2, 0 ) ) );
+	_mm_storeu_ps( dst + 8, _mm_shuffle_ps( t3, t3, _MM_SHUFFLE( 3, 1, 0, 2 ) ) );
+}
+
+// Transforms 4 points held as x, y and z vectors; the translation is added when withTranslate is true
+inline void mat44TransformVec3fx4( const float *m, __m128 &x, __m128 &y, __m128 &z, __m128 *w, bool withTranslate )
+{
+	__m128 rx = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( m[0] ), x ), _mm_mul_ps( _mm_set1_ps( m[4] ), y ) ), _mm_mul_ps( _mm_set1_ps( m[ 8] ), z ) );
+	__m128 ry = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( m[1] ), x ), _mm_mul_ps( _mm_set1_ps( m[5] ), y ) ), _mm_mul_ps( _mm_set1_ps( m[ 9] ), z ) );
+	__m128 rz = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( m[2] ), x ), _mm_mul_ps( _mm_set1_ps( m[6] ), y ) ), _mm_mul_ps( _mm_set1_ps( m[10] ), z ) );
+	if( w )
+		*w = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( m[3] ), x ), _mm_mul_ps( _mm_set1_ps( m[7] ), y ) ), _mm_mul_ps( _mm_set1_ps( m[11] ), z ) ), _mm_set1_ps( m[15] ) );
+	if( withTranslate ) {
+		rx = _mm_add_ps( rx, _mm_set1_ps( m[12] ) );
+		ry = _mm_add_ps( ry, _mm_set1_ps( m[13] ) );
+		rz = _mm_add_ps( rz, _mm_set1_ps( m[14] ) );
+	}
+	x = rx;
+	y = ry;
+	z = rz;
+}
+
+} // namespace detail
+
+template<>
+inline Matrix44<float>& Matrix44<float>::operator*=( const Matrix44<float> &rhs )
+{
+	detail::mat44Multiply( m, rhs.m, m );
+	return *this;
+}
+
+template<>
+inline const Matrix44<float> Matrix44<float>::operator*( const Matrix44<float> &rhs ) const
+{
+	Matrix44<float> ret( 0.0f );
+	detail::mat44Multiply( m, rhs.m, ret.m );
+	return ret;
+}
+
+template<>
+inline void Matrix44<float>::transpose()
+{
+	__m128 c0 = _mm_loadu_ps( m ), c1 = _mm_loadu_ps( m + 4 ), c2 = _mm_loadu_ps( m + 8 ), c3 = _mm_loadu_ps( m + 12 );
+	_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+	_mm_storeu_ps( m, c0 );
+	_mm_storeu_ps( m + 4, c1 );
+	_mm_storeu_ps( m + 8, c2 );
+	_mm_storeu_ps( m + 12, c3 );
+}
+
+template<>
+inline Matrix44<float> Matrix44<float>::transposed() const
+{
+	Matrix44<float> ret( *this );
+	ret.transpose();
+	return ret;
+}
+
+template<>
+inline Matrix44<float> Matrix44<float>::inverted( float epsilon ) const
+{
+	Matrix44<float> inv( 0.0f );
+
+	float a0 = m[ 0]*m[ 5] - m[ 1]*m[ 4];
+	float a1 = m[ 0]*m[ 6] - m[ 2]*m[ 4];
+	float a2 = m[ 0]*m[ 7] - m[ 3]*m[ 4];
+	float a3 = m[ 1]*m[ 6] - m[ 2]*m[ 5];
+	float a4 = m[ 1]*m[ 7] - m[ 3]*m[ 5];
+	float a5 = m[ 2]*m[ 7] - m[ 3]*m[ 6];
+	float b0 = m[ 8]*m[13] - m[ 9]*m[12];
+	float b1 = m[ 8]*m[14] - m[10]*m[12];
+	float b2 = m[ 8]*m[15] - m[11]*m[12];
+	float b3 = m[ 9]*m[14] - m[10]*m[13];
+	float b4 = m[ 9]*m[15] - m[11]*m[13];
+	float b5 = m[10]*m[15] - m[11]*m[14];
+
+	float det = a0*b5 - a1*b4 + a2*b3 + a3*b2 - a4*b1 + a5*b0;
+
+	if( fabs( det ) > epsilon ) {
+		// Each column of the adjugate is +/-( p*k0 - q*k1 + r*k2 ), with p, q and r drawn from
+		// v[k] = ( m[4+k], m[k], m[12+k], m[8+k] ) and the k's being ( b, b, a, a ) pairs.
+		__m128 c0 = _mm_loadu_ps( m ), c1 = _mm_loadu_ps( m + 4 ), c2 = _mm_loadu_ps( m + 8 ), c3 = _mm_loadu_ps( m + 12 );
+		__m128 lo10 = _mm_unpacklo_ps( c1, c0 ), lo32 = _mm_unpacklo_ps( c3, c2 );
+		__m128 hi10 = _mm_unpackhi_ps( c1, c0 ), hi32 = _mm_unpackhi_ps( c3, c2 );
+		__m128 v0 = _mm_movelh_ps( lo10, lo32 );
+		__m128 v1 = _mm_movehl_ps( lo32, lo10 );
+		__m128 v2 = _mm_movelh_ps( hi10, hi32 );
+		__m128 v3 = _mm_movehl_ps( hi32, hi10 );
+
+		__m128 k0 = _mm_setr_ps( b0, b0, a0, a0 ), k1 = _mm_setr_ps( b1, b1, a1, a1 ), k2 = _mm_setr_ps( b2, b2, a2, a2 );
+		__m128 k3 = _mm_setr_ps( b3, b3, a3, a3 ), k4 = _mm_setr_ps( b4, b4, a4, a4 ), k5 = _mm_setr_ps( b5, b5, a5, a5 );
+
+		// negating the lanes afterwards is exact, since -(p - q) + r == -( (p - q) - r ) in IEEE arithmetic
+		__m128 signOdd = _mm_setr_ps( 0.0f, -0.0f, 0.0f, -0.0f ), signEven = _mm_setr_ps( -0.0f, 0.0f, -0.0f, 0.0f );
+		__m128 r0 = _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v1, k5 ), _mm_mul_ps( v2, k4 ) ), _mm_mul_ps( v3, k3 ) ), signOdd );
+		__m128 r1 = _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v0, k5 ), _mm_mul_ps( v2, k2 ) ), _mm_mul_ps( v3, k1 ) ), signEven );
+		__m128 r2 = _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v0, k4 ), _mm_mul_ps( v1, k2 ) ), _mm_mul_ps( v3, k0 ) ), signOdd );
+		__m128 r3 = _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v0, k3 ), _mm_mul_ps( v1, k1 ) ), _mm_mul_ps( v2, k0 ) ), signEven );
+
+		__m128 invDet = _mm_set1_ps( 1.0f / det );
+		_mm_storeu_ps( inv.m, _mm_mul_ps( r0, invDet ) );
+		_mm_storeu_ps( inv.m + 4, _mm_mul_ps( r1, invDet ) );
+		_mm_storeu_ps( inv.m + 8, _mm_mul_ps( r2, invDet ) );
+		_mm_storeu_ps( inv.m + 12, _mm_mul_ps( r3, invDet ) );
+	}
+
+	return inv;
+}
+
+template<>
+inline void Matrix44<float>::transformPoints( const Vec3<float> *in, Vec3<float> *out, size_t count ) const
+{
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z, w;
+		detail::loadVec3fx4( &in[i].x, x, y, z );
+		detail::mat44TransformVec3fx4( m, x, y, z, &w, true );
+		detail::storeVec3fx4( &out[i].x, _mm_div_ps( x, w ), _mm_div_ps( y, w ), _mm_div_ps( z, w ) );
+	}
+	for( ; i < count; ++i )
+		out[i] = transformPoint( in[i] );
+}
+
+template<>
+inline void Matrix44<float>::transformPointsAffine( const Vec3<float> *in, Vec3<float> *out, size_t count ) const
+{
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		detail::loadVec3fx4( &in[i].x, x, y, z );
+		detail::mat44TransformVec3fx4( m, x, y, z, NULL, true );
+		detail::storeVec3fx4( &out[i].x, x, y, z );
+	}
+	for( ; i < count; ++i )
+		out[i] = transformPointAffine( in[i] );
+}
+
+template<>
+inline void Matrix44<float>::transformVecs( const Vec3<float> *in, Vec3<float> *out, size_t count ) const
+{
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		detail::loadVec3fx4( &in[i].x, x, y, z );
+		detail::mat44TransformVec3fx4( m, x, y, z, NULL, false );
+		detail::storeVec3fx4( &out[i].x, x, y, z );
+	}
+	for( ; i < count; ++i )
+		out[i] = transformVec( in[i] );
+}
+
+template<>
+inline void Matrix44<float>::postMultiply( const Vec4<float> *in, Vec4<float> *out, size_t count ) const
+{
+	__m128 c[4] = { _mm_loadu_ps( m ), _mm_loadu_ps( m + 4 ), _mm_loadu_ps( m + 8 ), _mm_loadu_ps( m + 12 ) };
+	for( size_t i = 0; i < count; ++i )
+		_mm_storeu_ps( &out[i].x, detail::mat44MulColumn( c, &in[i].x ) );
+}
+
+#endif // defined( CINDER_SSE2 )
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // Typedefs
 typedef Matrix44<float>	 Matrix44f;
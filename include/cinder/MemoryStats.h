@@ -0,0 +1,192 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+/** \brief Opt-in accounting of the memory held by Cinder's resources, by category.
+ *
+ * Resources attribute their bytes to a named Category, which counts the bytes currently held, their peak and the number of allocations.
+ * CPU categories count allocations exactly: Surfaces, Channels and audio Buffers. GPU categories hold estimates from the dimensions and internal format
+ * of gl::Textures, Fbo attachments and Vbos, as drivers don't report what they actually allocate. A ScopedMemoryCategory attributes the resources
+ * created on its thread to another category, which is how TextureFont atlases, Fbo attachments and VboMesh buffers are told apart from other Textures and Vbos.
+ *
+ * Accounting is disabled by default, in which case resources cost a single atomic load each. Resources created while disabled are never counted,
+ * so enable it before creating them. While a Profiler capture is in progress, the categories are sampled each frame and exported as counters with the trace.
+ *
+ * \code
+ * MemoryStats::setEnabled(); // in prepareSettings(), before any resources are created
+ * ...
+ * console() << "GPU: " << MemoryStats::getTotalBytes( true ) / ( 1024 * 1024 ) << " MB" << std::endl;
+ * \endcode **/
+class MemoryStats {
+  public:
+	//! A named counter of bytes, created on first use by getCategory() and never destroyed
+	class Category : private boost::noncopyable {
+	  public:
+		const std::string&	getName() const { return mName; }
+		//! Returns whether the bytes are estimates of GPU memory rather than CPU allocations
+		bool		isGpu() const { return mGpu; }
+		//! Returns the number of bytes currently held
+		int64_t		getBytes() const { return mBytes; }
+		//! Returns the largest number of bytes held since the Category was created or resetPeaks() was called
+		int64_t		getPeakBytes() const { return mPeakBytes; }
+		//! Returns the number of allocations currently held
+		int64_t		getNumAllocations() const { return mNumAllocations; }
+
+		//! Records an allocation of \a bytes. Thread safe.
+		void		add( int64_t bytes );
+		//! Records the release of an allocation of \a bytes. Thread safe.
+		void		remove( int64_t bytes );
+
+	  private:
+		Category( const std::string &name, bool gpu );
+
+		std::string				mName;
+		bool					mGpu;
+		std::atomic<int64_t>	mBytes, mPeakBytes, mNumAllocations;
+
+		friend class MemoryStats;
+	};
+
+	//! A copy of the counters of a Category, returned by getStats()
+	struct Stats {
+		std::string		mName;
+		bool			mGpu;
+		int64_t			mBytes, mPeakBytes, mNumAllocations;
+	};
+
+	//! Enables or disables (default) accounting. Resources created while disabled are never counted.
+	static void			setEnabled( bool enable = true );
+	//! Returns whether accounting is enabled
+	static bool			isEnabled();
+
+	//! Returns the category named \a name, creating it on first use. CPU and GPU categories of the same name are distinct. Thread safe.
+	static Category*	getCategory( const std::string &name, bool gpu = false );
+	//! Returns the name of the category that resources of the default category \a name are counted in on the calling thread, which is overridden by ScopedMemoryCategory
+	static const char*	resolveCategoryName( const char *name );
+	//! Returns the counters of all categories, sorted by descending bytes
+	static std::vector<Stats>	getStats();
+	//! Returns the summed bytes of all GPU categories if \a gpu is \c true, or of all CPU categories otherwise
+	static int64_t		getTotalBytes( bool gpu );
+	//! Resets the peak of every category to its current bytes
+	static void			resetPeaks();
+
+	//! Allocates \a bytes with operator new, counting them in the CPU category \a categoryName (see resolveCategoryName()) if enabled. Used by CountedAllocator.
+	static void*		allocate( const char *categoryName, size_t bytes );
+	//! Frees memory returned by allocate(), removing it from the category it was counted in, if any
+	static void			deallocate( void *ptr );
+};
+
+//! Counts the bytes of one resource, for the resource's lifetime. Resources own one and call set() whenever their storage is (re)allocated.
+class MemoryAllocation : private boost::noncopyable {
+  public:
+	//! Counts the resource in the category \a categoryName (see MemoryStats::resolveCategoryName()) if MemoryStats is enabled; otherwise nothing will be counted. \a categoryName must outlive the MemoryAllocation, which string literals do.
+	MemoryAllocation( const char *categoryName, bool gpu = false )
+		: mCategoryName( MemoryStats::isEnabled() ? MemoryStats::resolveCategoryName( categoryName ) : 0 ), mGpu( gpu ), mCategory( 0 ), mBytes( 0 )
+	{}
+	~MemoryAllocation() { release(); }
+
+	//! Replaces the bytes counted for the resource with \a bytes
+	void		set( int64_t bytes );
+	//! Stops counting the resource's bytes, as when its storage is freed before the resource is destroyed
+	void		release();
+	//! Returns the bytes counted for the resource, which is \c 0 if MemoryStats was disabled when it was created
+	int64_t		getBytes() const { return mBytes; }
+
+  private:
+	const char				*mCategoryName;
+	bool					mGpu;
+	MemoryStats::Category	*mCategory;		// looked up on the first set(), as many resources never own memory
+	int64_t					mBytes;
+};
+
+//! Attributes the resources created on the calling thread during its lifetime to the category \a name, overriding their default categories. Scopes nest.
+class ScopedMemoryCategory : private boost::noncopyable {
+  public:
+	//! \a name must outlive the resources created in the scope, which string literals do
+	ScopedMemoryCategory( const char *name );
+	~ScopedMemoryCategory();
+
+  private:
+	const char	*mPrevious;
+};
+
+/** \brief A standard allocator that counts its allocations in the MemoryStats category named by \a TagT::getName().
+ *
+ * \code
+ * struct MeshMemoryTag { static const char* getName() { return "Mesh"; } };
+ * std::vector<Vec3f, CountedAllocator<Vec3f, MeshMemoryTag> > positions;
+ * \endcode **/
+template<typename T, typename TagT>
+class CountedAllocator {
+  public:
+	typedef T				value_type;
+	typedef T*				pointer;
+	typedef const T*		const_pointer;
+	typedef T&				reference;
+	typedef const T&		const_reference;
+	typedef size_t			size_type;
+	typedef ptrdiff_t		difference_type;
+
+	template<typename U>
+	struct rebind { typedef CountedAllocator<U, TagT> other; };
+
+	CountedAllocator() {}
+	template<typename U>
+	CountedAllocator( const CountedAllocator<U, TagT> & ) {}
+
+	pointer			address( reference r ) const { return &r; }
+	const_pointer	address( const_reference r ) const { return &r; }
+
+	pointer			allocate( size_type n, const void * = 0 )
+	{
+		if( n > max_size() )
+			throw std::bad_alloc();
+		return static_cast<pointer>( MemoryStats::allocate( TagT::getName(), n * sizeof( T ) ) );
+	}
+	void			deallocate( pointer p, size_type ) { MemoryStats::deallocate( p ); }
+	size_type		max_size() const { return ( std::numeric_limits<size_type>::max )() / sizeof( T ) - 1; }
+
+	void			construct( pointer p, const T &value ) { new( p ) T( value ); }
+	void			destroy( pointer p ) { p->~T(); }
+};
+
+template<typename T, typename U, typename TagT>
+bool operator==( const CountedAllocator<T, TagT> &, const CountedAllocator<U, TagT> & ) { return true; }
+template<typename T, typename U, typename TagT>
+bool operator!=( const CountedAllocator<T, TagT> &, const CountedAllocator<U, TagT> & ) { return false; }
+
+} // namespace cinder
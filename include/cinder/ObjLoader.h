@@ -26,6 +26,7 @@
 
 #include "cinder/TriMesh.h"
 #include "cinder/Stream.h"
+#include "cinder/Buffer.h"
 
 #include <boost/logic/tribool.hpp>
 #include <boost/tuple/tuple_comparison.hpp>
@@ -35,7 +36,8 @@ namespace cinder {
 
 /** \brief Loads Alias|Wavefront .OBJ file format
  *
- * Currently does not support anything but polygonal data
+ * Currently does not support anything but polygonal data. The file is parsed from memory (memory mapped when loaded from a large file),
+ * in parallel chunks on the shared TaskPool when it is large enough to benefit.
  * \n Example usage:
  * \code
  * cinder::TriMesh myCube;
@@ -115,27 +117,35 @@ class ObjLoader {
     //! Returns the total number of groups.
 	size_t		getNumGroups() const { return mGroups.size(); }
 	
-	//! Returns a vector<> of the Groups in the OBJ.
-	const std::vector<Group>&		getGroups() const { return mGroups; }
+	//! Returns a vector<> of the Groups in the OBJ. The Faces of each Group are expanded from the loader's compact storage on the first call.
+	const std::vector<Group>&		getGroups() const;
 	
  private:
-	typedef boost::tuple<int,int> VertexPair;
-	typedef boost::tuple<int,int,int> VertexTriple;
+	//! Compact storage for the faces of a Group, which avoids allocating per face.
+	struct FaceList {
+		FaceList() : mOffsets( 1, 0 ) {}
 
-	void	parse( bool includeUVs );
+		size_t	getNumFaces() const	{ return mFlags.size(); }
 
- 	void	parseFace( Group *group, const Material *material, const std::string &s, bool includeUVs );
+		std::vector<uint32_t>			mOffsets; // offset of each face's first vertex in the index arrays, followed by the end offset
+		std::vector<int>				mVertexIndices, mTexCoordIndices, mNormalIndices;
+		std::vector<uint8_t>			mFlags;
+		std::vector<const Material*>	mMaterials;
+	};
+
+	struct ParseChunk;
+	class VertexTable;
+
+	void	parse( const Buffer &buffer, bool includeUVs );
     void    parseMaterial( std::shared_ptr<IStreamCinder> material );
-	void	loadInternalNoOptimize( const Group &group, TriMesh *destTriMesh, bool texCoords, bool normals );
-	void	loadInternalNormalsTextures( const Group &group, std::map<boost::tuple<int,int,int>,int> &uniqueVerts, TriMesh *destTriMesh );
-	void	loadInternalNormals( const Group &group, std::map<boost::tuple<int,int>,int> &uniqueVerts, TriMesh *destTriMesh );
-	void	loadInternalTextures( const Group &group, std::map<boost::tuple<int,int>,int> &uniqueVerts, TriMesh *destTriMesh );
-	void	loadInternal( const Group &group, std::map<int,int> &uniqueVerts, TriMesh *destTriMesh );	
+	void	loadInternalNoOptimize( const FaceList &faces, TriMesh *destTriMesh, bool texCoords, bool normals );
+	void	loadInternalOptimize( const FaceList &faces, VertexTable *uniqueVerts, TriMesh *destTriMesh, bool texCoords, bool normals );
  
-	std::shared_ptr<IStreamCinder>        mStream;
 	std::vector<Vec3f>			    mVertices, mNormals;
 	std::vector<Vec2f>			    mTexCoords;
-	std::vector<Group>			    mGroups;
+	mutable std::vector<Group>	    mGroups;
+	mutable bool					mGroupFacesExpanded;
+	std::vector<FaceList>			mFaceLists; // parallel to mGroups
 	std::map<std::string, Material> mMaterials;
 };
 
@@ -77,6 +77,8 @@ class Path2d {
 	void	getSegmentRelativeT( float t, size_t *segment, float *relativeT ) const;
 	
 	std::vector<Vec2f>	subdivide( float approximationScale = 1.0f ) const;
+	//! Returns a polyline approximating the path which deviates from the curves by no more than \a maxError, in the path's units. If \a resultTimes is non-NULL it receives the t-value of each returned point, suitable for getPosition() and getTangent().
+	std::vector<Vec2f>	flatten( float maxError, std::vector<float> *resultTimes = NULL ) const;
 	
 	//! Scales the Path2d by \a amount.x on X and \a amount.y on Y around the center \a scaleCenter
 	void		scale( const Vec2f &amount, Vec2f scaleCenter = Vec2f::zero() );
@@ -133,6 +135,7 @@ class Path2d {
 
 	friend class Shape2d;
 	friend class Path2dCalcCache;
+	friend class Path2dArcLengthTable;
 	
 	friend std::ostream& operator<<( std::ostream &out, const Path2d &p );
   private:
@@ -140,6 +143,8 @@ class Path2d {
 	void	arcSegmentAsCubicBezier( const Vec2f &center, float radius, float startRadians, float endRadians );
 	void	subdivideQuadratic( float distanceToleranceSqr, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, int level, std::vector<Vec2f> *result ) const;
 	void	subdivideCubic( float distanceToleranceSqr, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, const Vec2f &p4, int level, std::vector<Vec2f> *result ) const;
+	void	flattenQuadratic( float errorSqr16, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, float t1, float t3, int level, std::vector<Vec2f> *result, std::vector<float> *resultTimes ) const;
+	void	flattenCubic( float errorSqr16, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, const Vec2f &p4, float t1, float t4, int level, std::vector<Vec2f> *result, std::vector<float> *resultTimes ) const;
 
 	std::vector<Vec2f>			mPoints;
 	std::vector<SegmentType>	mSegments;
@@ -196,6 +201,43 @@ class Path2dCalcCache {
 	std::vector<float>	mSegmentLengths;
 };
 
+//! Stores a Path2d flattened to a polyline along with its cumulative arc lengths, so that positions and tangents at a given distance along the path are found with a binary search rather than by re-evaluating its curves. Useful for moving many objects along a path at constant speed.
+class Path2dArcLengthTable {
+  public:
+	Path2dArcLengthTable() : mLength( 0 ) {}
+	//! Flattens \a path into a polyline which deviates from its curves by no more than \a maxError, in the path's units. When the path is drawn at a scale of 1, a \a maxError of 0.25f keeps the error under a quarter pixel.
+	Path2dArcLengthTable( const Path2d &path, float maxError = 0.25f );
+
+	//! Returns the arc length of the flattened path
+	float			getLength() const { return mLength; }
+	//! Returns the number of points in the flattened polyline
+	size_t			getNumPoints() const { return mPoints.size(); }
+	//! Returns the points of the flattened polyline
+	const std::vector<Vec2f>&	getPoints() const { return mPoints; }
+	//! Returns the cumulative arc length at each point of the flattened polyline
+	const std::vector<float>&	getLengths() const { return mLengths; }
+	//! Returns the Path2d t-value of each point of the flattened polyline
+	const std::vector<float>&	getTimes() const { return mTimes; }
+
+	//! Returns the position at arc length \a distance. If \a wrap then \a distance loops as it exceeds the arc length, otherwise it is clamped to the ends of the path.
+	Vec2f			getPositionAtLength( float distance, bool wrap = true ) const;
+	//! Returns the unit tangent at arc length \a distance, which is the direction of the polyline edge containing it. If \a wrap then \a distance loops as it exceeds the arc length, otherwise it is clamped to the ends of the path.
+	Vec2f			getTangentAtLength( float distance, bool wrap = true ) const;
+	//! Returns both the position and unit tangent at arc length \a distance, sharing a single search.
+	void			getPositionAndTangentAtLength( float distance, Vec2f *resultPosition, Vec2f *resultTangent, bool wrap = true ) const;
+	//! Returns the approximate Path2d t-value corresponding to arc length \a distance. Consider Path2dCalcCache::calcTimeForDistance() when an exact solution is required.
+	float			getTimeAtLength( float distance, bool wrap = true ) const;
+
+  private:
+	//! Stores the index of the polyline edge containing \a distance and the fraction along it
+	void			findEdge( float distance, bool wrap, size_t *edge, float *fraction ) const;
+
+	std::vector<Vec2f>	mPoints;
+	std::vector<float>	mLengths;
+	std::vector<float>	mTimes;
+	float				mLength;
+};
+
 class Path2dExc : public Exception {
 };
 
@@ -24,9 +24,12 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/Surface.h"
 
 namespace cinder {
 
+class TaskPool;
+
 class Perlin
 {
  public:
@@ -51,6 +54,18 @@ class Perlin
 	Vec3f	dfBm( const Vec3f &v ) const;
 	Vec3f	dfBm( float x, float y, float z ) const { return dfBm( Vec3f( x, y, z ) ); }
 
+	/// Batch fBm. Each fills its result with exactly the values the single-point fBm() returns, evaluating four points at a time with SSE2 where available. If \a taskPool is non-NULL, rows or ranges of points are divided among its threads.
+	/// Fills \a channel with fBm( origin + Vec2f( x, y ) * scale ) for each pixel ( x, y )
+	void	fBm( Channel32f *channel, const Vec2f &origin, const Vec2f &scale, TaskPool *taskPool = NULL ) const;
+	/// Fills \a channel with fBm( origin + Vec3f( x * scale.x, y * scale.y, 0 ) ) for each pixel ( x, y ), a slice of 3D noise at depth \a origin.z, e.g. for animating over time
+	void	fBm( Channel32f *channel, const Vec3f &origin, const Vec2f &scale, TaskPool *taskPool = NULL ) const;
+	/// Fills the red, green and blue channels of \a surface with fBm( origin + Vec2f( x, y ) * scale ), leaving alpha untouched
+	void	fBm( Surface32f *surface, const Vec2f &origin, const Vec2f &scale, TaskPool *taskPool = NULL ) const;
+	/// Stores fBm( positions[i] ) into \a result[i] for each of \a count \a positions
+	void	fBm( const Vec2f *positions, size_t count, float *result, TaskPool *taskPool = NULL ) const;
+	/// Stores fBm( positions[i] ) into \a result[i] for each of \a count \a positions
+	void	fBm( const Vec3f *positions, size_t count, float *result, TaskPool *taskPool = NULL ) const;
+
 	/// Calculates a single octave of noise
 	float	noise( float x ) const;
 	float	noise( float x, float y ) const;
@@ -61,8 +76,24 @@ class Perlin
 	Vec2f	dnoise( float x, float y ) const;
 	Vec3f	dnoise( float x, float y, float z ) const;
 
+	/// Calculates a single octave of simplex noise, in the range [-1,1]. Cheaper than noise() in 3D and free of its axis-aligned artifacts.
+	float	simplex( float x, float y ) const;
+	float	simplex( float x, float y, float z ) const;
+	/// Calculates a single octave of simplex noise and stores its analytic derivative into \a resultDerivative
+	float	simplex( float x, float y, Vec2f *resultDerivative ) const;
+	float	simplex( float x, float y, float z, Vec3f *resultDerivative ) const;
+
+	/// Fractal Brownian motion summing 'mOctaves' worth of simplex noise
+	float	fBmSimplex( const Vec2f &v ) const;
+	float	fBmSimplex( const Vec3f &v ) const;
+	/// Derivative of fBmSimplex()
+	Vec2f	dfBmSimplex( const Vec2f &v ) const;
+	Vec3f	dfBmSimplex( const Vec3f &v ) const;
+
  private:
 	void	initPermutationTable();
+	//! Stores fBm at \a count points starting at ( x0, y, z ) and stepping \a stepX along x. Ignores \a z unless \a threeD.
+	void	fBmSpan( float x0, float stepX, float y, float z, bool threeD, size_t count, float *result ) const;
 
 	float grad( int32_t hash, float x ) const;
 	float grad( int32_t hash, float x, float y ) const;
@@ -68,6 +68,10 @@ class PolyLine {
 	static std::vector<PolyLine> 	calcXor( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );
 	//! Calculates the boolean difference of \a a and \a b. Assumes the first PolyLine in the vector is the outermost and the (optional) others are holes.
 	static std::vector<PolyLine> 	calcDifference( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );		
+	//! Calculates the boolean union of all of \a shapes, each laid out as for calcUnion(). Shapes are merged pairwise, with the pairs of each round spread across the TaskPool's threads.
+	static std::vector<PolyLine> 	calcUnion( const std::vector<std::vector<PolyLine> > &shapes );
+	//! Calculates the boolean intersection of all of \a shapes, each laid out as for calcIntersection(). Shapes are intersected pairwise, with the pairs of each round spread across the TaskPool's threads.
+	static std::vector<PolyLine> 	calcIntersection( const std::vector<std::vector<PolyLine> > &shapes );
 	
   private:
 	std::vector<T>			mPoints;
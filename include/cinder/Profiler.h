@@ -0,0 +1,195 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Filesystem.h"
+#include "cinder/CurrentFunction.h"
+#include "cinder/MemoryStats.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! \file
+//! Lightweight instrumentation macros. Define CI_DISABLE_PROFILING to compile them out entirely.
+//! - CI_PROFILE_ZONE( name ): records the enclosing scope as a zone named \a name, which must be a string literal (or otherwise outlive the Profiler's capture).
+//! - CI_PROFILE_ZONE_CATEGORY( name, category ): same as CI_PROFILE_ZONE(), with a \a category that traces can be filtered by (default is "cinder").
+//! - CI_PROFILE_FUNCTION(): records the enclosing function as a zone named after it.
+
+#if defined( CI_DISABLE_PROFILING )
+	#define CI_PROFILE_ZONE( name )						((void)0)
+	#define CI_PROFILE_ZONE_CATEGORY( name, category )	((void)0)
+	#define CI_PROFILE_FUNCTION()						((void)0)
+#else
+	#define CI_PROFILE_CONCAT_IMPL( a, b )				a##b
+	#define CI_PROFILE_CONCAT( a, b )					CI_PROFILE_CONCAT_IMPL( a, b )
+	#define CI_PROFILE_ZONE( name )						::cinder::ScopedProfileZone CI_PROFILE_CONCAT( ciProfileZone, __LINE__ )( name )
+	#define CI_PROFILE_ZONE_CATEGORY( name, category )	::cinder::ScopedProfileZone CI_PROFILE_CONCAT( ciProfileZone, __LINE__ )( name, category )
+	#define CI_PROFILE_FUNCTION()						CI_PROFILE_ZONE( CINDER_CURRENT_FUNCTION )
+#endif
+
+namespace cinder {
+
+//! \brief Records timed zones from any thread, aggregates them per frame and exports them as a Chrome trace (chrome://tracing).
+//!
+//! Zones are recorded into a buffer owned by the recording thread, so threads only contend with frameMark() and not with each other.
+//! While disabled (the default), a zone costs a single atomic load. The App calls frameMark() at the beginning of each update,
+//! and records its update and draw, as do gl::Texture uploads, image decoding and the audio::Context's processing blocks.
+//! While MemoryStats is enabled, a capture also samples its categories at each frameMark(), exported as counter tracks.
+class Profiler : private boost::noncopyable {
+  public:
+	//! The aggregate of all zones with the same name that were recorded during a frame, on any thread.
+	struct ZoneStats {
+		ZoneStats() : mCount( 0 ), mTotalSeconds( 0 ), mMaxSeconds( 0 ) {}
+
+		std::string	mName;
+		//! The number of times the zone was recorded
+		size_t		mCount;
+		//! The summed duration of the zone, including nested zones
+		double		mTotalSeconds;
+		//! The longest duration of the zone
+		double		mMaxSeconds;
+	};
+
+	//! Returns the process-wide Profiler, which is created on first use and never destroyed.
+	static Profiler* get();
+
+	//! Enables or disables (default) recording of zones.
+	void	setEnabled( bool enable = true )	{ mEnabled = enable; }
+	//! Returns whether zones are recorded.
+	bool	isEnabled() const					{ return mEnabled; }
+
+	//! Returns the number of seconds since the Profiler was created, which zones are measured against.
+	double	getSeconds() const					{ return mTimer.getSeconds(); }
+	//! Records a zone named \a name that began at \a beginSeconds and ended at \a endSeconds (see getSeconds()) on the calling thread. Useful when a zone doesn't fit in a scope. Ignored when disabled.
+	void	recordZone( const char *name, const char *category, double beginSeconds, double endSeconds );
+
+	//! Sets the name the calling thread is identified by in exported traces. Threads are named "thread N" by default.
+	void	setThreadName( const std::string &name );
+	//! Returns the id of the track named \a name, creating it on first use. Tracks appear alongside threads in exported traces and hold zones that weren't measured on a thread, such as GPU passes.
+	size_t	getTrack( const std::string &name );
+	//! Records a zone on the track \a trackId (see getTrack()) from any thread. Ignored when disabled.
+	void	recordTrackZone( size_t trackId, const char *name, const char *category, double beginSeconds, double endSeconds );
+	//! Sets the maximum number of zones (default = 65536) that each thread buffers between calls to frameMark(). Further zones are dropped.
+	void	setMaxThreadZones( size_t maxZones )	{ mMaxThreadZones = maxZones; }
+	//! Returns the maximum number of zones that each thread buffers between calls to frameMark().
+	size_t	getMaxThreadZones() const				{ return mMaxThreadZones; }
+
+	//! \brief Ends the current frame, collecting the zones that all threads have recorded since the previous call.
+	//!
+	//! The zones are aggregated by name into getFrameStats() and appended to the capture if one is in progress. Should be called from one thread only, which the App does from its update.
+	void	frameMark();
+	//! Returns the number of frames marked since the Profiler was created.
+	uint64_t	getFrameNumber() const;
+	//! Returns the duration in seconds of the most recently marked frame.
+	double		getFrameSeconds() const;
+	//! Returns the zones recorded during the most recently marked frame, aggregated by name and sorted by descending total duration.
+	std::vector<ZoneStats>	getFrameStats() const;
+
+	//! Starts capturing zones for export with writeChromeTrace(), discarding any previous capture. Up to \a maxZones zones are kept, further zones are dropped. Enables the Profiler.
+	void	beginCapture( size_t maxZones = 1000000 );
+	//! Stops capturing zones. The zones recorded since the last frameMark() are collected first.
+	void	endCapture();
+	//! Returns whether zones are being captured.
+	bool	isCapturing() const;
+	//! Returns the number of zones in the capture.
+	size_t	getNumCapturedZones() const;
+	//! Returns the number of zones that were dropped since the capture began, either because the capture or a thread's buffer was full.
+	size_t	getNumDroppedZones() const			{ return mNumDroppedZones; }
+
+	//! Writes the capture to \a dataTarget in the Chrome trace event format, which can be viewed with chrome://tracing.
+	void	writeChromeTrace( const DataTargetRef &dataTarget ) const;
+	//! Writes the capture to the file at \a path in the Chrome trace event format, which can be viewed with chrome://tracing.
+	void	writeChromeTrace( const fs::path &path ) const;
+
+  private:
+	Profiler();
+
+	struct Zone {
+		const char	*mName, *mCategory;
+		double		mBegin, mEnd;
+	};
+
+	struct CapturedZone : public Zone {
+		size_t		mThreadIndex;
+	};
+
+	struct ThreadBuffer {
+		ThreadBuffer( size_t index );
+
+		size_t				mIndex;
+		std::string			mName;		// guarded by Profiler::mMutex
+		std::vector<Zone>	mZones;		// guarded by mMutex
+		std::mutex			mMutex;
+	};
+
+	ThreadBuffer*	getThreadBuffer();
+	void			recordZone( ThreadBuffer *threadBuffer, const Zone &zone );
+	void			collectZones( std::vector<Zone> *zones, std::vector<size_t> *threadIndices );
+	void			captureCollectedZones();
+
+	Timer					mTimer;
+	std::atomic<bool>		mEnabled;
+	std::atomic<size_t>		mMaxThreadZones, mNumDroppedZones;
+
+	// ThreadBuffers are owned here rather than by their threads, so that the zones of exited threads can still be collected and exported.
+	// Tracks are ThreadBuffers that don't belong to a thread, their ids are indices into mThreadBuffers.
+	std::vector<std::unique_ptr<ThreadBuffer> >	mThreadBuffers;
+	std::vector<size_t>							mTracks;
+	mutable std::mutex							mMutex;		// guards mThreadBuffers and everything below
+
+	uint64_t					mFrameNumber;
+	double						mFrameBegin, mFrameSeconds;
+	std::vector<ZoneStats>		mFrameStats;
+	std::vector<Zone>			mCollectedZones;		// scratch storage used by frameMark()
+	std::vector<size_t>			mCollectedThreadIndices;
+
+	bool						mCapturing;
+	size_t						mMaxCapturedZones;
+	std::vector<CapturedZone>	mCapturedZones;
+	std::vector<double>			mCapturedFrameMarks;
+	std::vector<std::pair<double, std::vector<MemoryStats::Stats> > >	mCapturedMemoryStats;
+};
+
+//! Records the duration of its lifetime as a zone with the Profiler, if it is enabled when constructed. Usually created with the CI_PROFILE_ZONE() macros.
+class ScopedProfileZone : private boost::noncopyable {
+  public:
+	//! \a name and \a category must outlive the Profiler's capture, which string literals do.
+	ScopedProfileZone( const char *name, const char *category = "cinder" );
+	~ScopedProfileZone();
+
+  private:
+	const char	*mName, *mCategory;
+	double		mBegin;
+	bool		mActive;
+};
+
+} // namespace cinder
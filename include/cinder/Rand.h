@@ -27,18 +27,98 @@
 
 namespace cinder {	
 	
-class Rand {
+//! Small-state PCG32 (XSH-RR) engine: 16 bytes of state and considerably cheaper per draw than std::mt19937. Usable wherever a 32-bit engine is expected.
+class Pcg32 {
+  public:
+	typedef uint32_t	result_type;
+
+	Pcg32()
+	{
+		seed( 0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL );
+	}
+
+	//! Constructs a generator seeded with \a seedValue on stream \a stream. Distinct streams produce independent sequences for the same seed.
+	explicit Pcg32( uint64_t seedValue, uint64_t stream = 0xda3e39cb94b95bdbULL )
+	{
+		seed( seedValue, stream );
+	}
+
+	//! Re-seeds the generator to \a seedValue on stream \a stream
+	void seed( uint64_t seedValue, uint64_t stream = 0xda3e39cb94b95bdbULL )
+	{
+		mState = 0;
+		mInc = ( stream << 1 ) | 1;
+		(*this)();
+		mState += seedValue;
+		(*this)();
+	}
+
+	result_type operator()()
+	{
+		uint64_t old = mState;
+		mState = old * 6364136223846793005ULL + mInc;
+		uint32_t xorShifted = static_cast<uint32_t>( ( ( old >> 18 ) ^ old ) >> 27 );
+		uint32_t rot = static_cast<uint32_t>( old >> 59 );
+		return ( xorShifted >> rot ) | ( xorShifted << ( ( 32 - rot ) & 31 ) );
+	}
+
+	//! Advances the generator by \a count draws
+	void discard( uint64_t count )
+	{
+		while( count-- )
+			(*this)();
+	}
+
+	static result_type	min() { return 0; }
+	static result_type	max() { return 0xFFFFFFFFu; }
+
+  private:
+	uint64_t	mState, mInc;
+};
+
+namespace detail {
+//! Unit float from a 32-bit engine, using the top 24 bits
+template<typename EngineT>
+inline float randUnitFloat( EngineT &engine, std::uniform_real_distribution<float> & )
+{
+	return ( engine() >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+//! std::mt19937 keeps going through the distribution so seeded sequences stay stable
+inline float randUnitFloat( std::mt19937 &engine, std::uniform_real_distribution<float> &dist )
+{
+	return dist( engine );
+}
+} // namespace detail
+
+//! Random number generator built on the 32-bit engine \a EngineT. Use Rand for std::mt19937 or RandPcg for the smaller, faster Pcg32.
+template<typename EngineT>
+class RandGenerator {
  public:
-	Rand()
-		: mBase( 214u ), mHaveNextNextGaussian( false )
+	typedef EngineT		Engine;
+
+	RandGenerator()
+		: mHaveNextNextGaussian( false )
 	{}
 	
-	Rand( unsigned long seed )
+	RandGenerator( unsigned long seed )
 		: mBase( seed ), mHaveNextNextGaussian( false )
 	{}
 
+	explicit RandGenerator( const EngineT &engine )
+		: mBase( engine ), mHaveNextNextGaussian( false )
+	{}
+
 	//! Re-seeds the random generator
-	void seed( unsigned long seedValue );
+	void seed( unsigned long seedValue )
+	{
+		mBase = EngineT( seedValue );
+		mHaveNextNextGaussian = false;
+	}
+
+	//! Returns the underlying engine, for use with the standard library distributions
+	EngineT&		getEngine() { return mBase; }
+	const EngineT&	getEngine() const { return mBase; }
 	
 	//! returns a random boolean value
 	bool nextBool()
@@ -81,19 +161,19 @@ class Rand {
 	//! returns a random float in the range [0.0f,1.0f)
 	float nextFloat()
 	{
-		return mFloatGen(mBase);
+		return detail::randUnitFloat( mBase, mFloatGen );
 	}
 	
 	//! returns a random float in the range [0.0f,v)
 	float nextFloat( float v )
 	{
-		return mFloatGen(mBase) * v;
+		return nextFloat() * v;
 	}
 	
 	//! returns a random float in the range [a,b)
 	float nextFloat( float a, float b )
 	{
-		return mFloatGen(mBase) * ( b - a ) + a;
+		return nextFloat() * ( b - a ) + a;
 	}
 	
 	//! returns a random float in the range [a,b] or the range [-b,-a)
@@ -150,138 +230,188 @@ class Rand {
 
             return v1 * m;
         }
-    }    
+    }
+
+	//! Fills \a result with \a count random floats in the range [0.0f,1.0f). Produces the same values as \a count calls to nextFloat().
+	void nextFloats( float *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextFloat();
+	}
+
+	//! Fills \a result with \a count random floats in the range [a,b)
+	void nextFloats( float *result, size_t count, float a, float b )
+	{
+		const float range = b - a;
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextFloat() * range + a;
+	}
+
+	//! Fills \a result with \a count random points on the unit sphere
+	void nextVec3fs( Vec3f *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextVec3f();
+	}
+
+	//! Fills \a result with \a count random points on the unit circle
+	void nextVec2fs( Vec2f *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextVec2f();
+	}
+
+	//! Fills \a result with \a count random floats via Gaussian distribution
+	void nextGaussians( float *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextGaussian();
+	}
+	
+  private:
+	EngineT		mBase;
+	std::uniform_real_distribution<float>	mFloatGen;	
+    float	mNextNextGaussian;    
+    bool	mHaveNextNextGaussian;
+};
+
+//! RandGenerator using the small-state Pcg32 engine
+typedef RandGenerator<Pcg32>	RandPcg;
+
+class Rand : public RandGenerator<std::mt19937> {
+ public:
+	Rand()
+		: RandGenerator<std::mt19937>( 214u )
+	{}
+	
+	Rand( unsigned long seed )
+		: RandGenerator<std::mt19937>( seed )
+	{}
 	
 	// STATICS
-	//! Resets the static random generator to a random seed based on the clock
+	// The static generators are per-thread. Each thread's generator is seeded deterministically from the seed passed to randSeed()
+	// and the order in which threads first use it; the first thread uses the seed directly, matching earlier releases.
+
+	//! Resets the static random generators of all threads to a random seed based on the clock
 	static void randomize();
 	
-	//! Resets the static random generator to the specific seed \a seedValue
+	//! Resets the static random generators of all threads to the specific seed \a seedValue
 	static void	randSeed( unsigned long seedValue );
+
+	//! Resets only the calling thread's static random generator to \a seedValue, until the next randSeed() or randomize()
+	static void	randSeedThread( unsigned long seedValue );
 	
 	//! returns a random boolean value
 	static bool randBool()
 	{
-		return sBase() & 1;
+		return threadGenerator().nextBool();
 	}
 	
 	//! returns a random integer in the range [-2147483648,2147483647]
 	static int32_t randInt()
 	{
-		return sBase();
+		return threadGenerator().nextInt();
 	}
 
 	//! returns a random integer in the range [0,4294967296)
 	static uint32_t randUint()
 	{
-		return sBase();
+		return threadGenerator().nextUint();
 	}
 	
 	//! returns a random integer in the range [0,v)
 	static int32_t randInt( int32_t v )
 	{
-		if( v <= 0 ) return 0;
-		else return sBase() % v;
+		return threadGenerator().nextInt( v );
 	}
 
 	//! returns a random integer in the range [0,v)
 	static uint32_t randUint( uint32_t v )
 	{
-		if( v == 0 ) return 0;
-		else return sBase() % v;
+		return threadGenerator().nextUint( v );
 	}
 	
 	//! returns a random integer in the range [a,b)
 	static int32_t randInt( int32_t a, int32_t b )
 	{
-		return randInt( b - a ) + a;
+		return threadGenerator().nextInt( a, b );
 	}
 	
 	//! returns a random float in the range [0.0f,1.0f)
 	static float randFloat()
 	{
-		return sFloatGen(sBase);
+		return threadGenerator().nextFloat();
 	}
 	
 	//! returns a random float in the range [0.0f,v)
 	static float randFloat( float v )
 	{
-		return sFloatGen(sBase) * v;
+		return threadGenerator().nextFloat( v );
 	}
 	
 	//! returns a random float in the range [a,b)
 	static float randFloat( float a, float b )
 	{
-		return sFloatGen(sBase) * ( b - a ) + a;
+		return threadGenerator().nextFloat( a, b );
 	}
 	
 	//! returns a random float in the range [a,b) or the range [-b,-a)
 	static float randPosNegFloat( float a, float b )
 	{
-		if( randBool() )
-			return randFloat( a, b );
-		else
-			return -randFloat( a, b );
+		return threadGenerator().posNegFloat( a, b );
 	}
 	
 	//! returns a random Vec3f that represents a point on the unit sphere
 	static Vec3f randVec3f()
 	{
-		float phi = randFloat( (float)M_PI * 2.0f );
-		float costheta = randFloat( -1.0f, 1.0f );
-		
-		float rho = math<float>::sqrt( 1.0f - costheta * costheta ); 
-		float x = rho * math<float>::cos( phi );
-		float y = rho * math<float>::sin( phi );
-		float z = costheta;
-		
-		return Vec3f( x, y, z );
+		return threadGenerator().nextVec3f();
 	}
 
 	//! returns a random Vec2f that represents a point on the unit circle
 	static Vec2f randVec2f()
 	{
-		float theta = randFloat( (float)M_PI * 2.0f );
-		return Vec2f( math<float>::cos( theta ), math<float>::sin( theta ) );
+		return threadGenerator().nextVec2f();
 	}
     
-    //! returns a random float via Gaussian distribution; refactor later
+    //! returns a random float via Gaussian distribution
     static float randGaussian() 
     {
-		static bool  sHaveNextNextGaussian = false;
-		static float sNextNextGaussian;
+		return threadGenerator().nextGaussian();
+	}
 
-		if( sHaveNextNextGaussian ) {
-			sHaveNextNextGaussian = false;
-			return sNextNextGaussian;
-		}
-		else {
-			float v1, v2, s;
-			do {
-				v1 = 2.0f * sFloatGen(sBase) - 1.0f;
-				v2 = 2.0f * sFloatGen(sBase) - 1.0f;
+	//! Fills \a result with \a count random floats in the range [0.0f,1.0f). Looks up the thread's generator once for the whole batch.
+	static void randFloats( float *result, size_t count )
+	{
+		threadGenerator().nextFloats( result, count );
+	}
 
-				s = v1 * v1 + v2 * v2;
-			}
-			while( s >= 1.0f || s == 0.0f );
+	//! Fills \a result with \a count random floats in the range [a,b)
+	static void randFloats( float *result, size_t count, float a, float b )
+	{
+		threadGenerator().nextFloats( result, count, a, b );
+	}
 
-			float m = math<float>::sqrt(-2.0f * math<float>::log(s)/s);
+	//! Fills \a result with \a count random points on the unit sphere
+	static void randVec3fs( Vec3f *result, size_t count )
+	{
+		threadGenerator().nextVec3fs( result, count );
+	}
 
-			sNextNextGaussian       = v2 * m;
-			sHaveNextNextGaussian   = true;
-            
-			return v1 * m;
-		}
+	//! Fills \a result with \a count random points on the unit circle
+	static void randVec2fs( Vec2f *result, size_t count )
+	{
+		threadGenerator().nextVec2fs( result, count );
+	}
+
+	//! Fills \a result with \a count random floats via Gaussian distribution
+	static void randGaussians( float *result, size_t count )
+	{
+		threadGenerator().nextGaussians( result, count );
 	}
 	
   private:
-	std::mt19937 mBase;
-	std::uniform_real_distribution<float>	mFloatGen;	
-    float	mNextNextGaussian;    
-    bool	mHaveNextNextGaussian;
-    
-	static std::mt19937 sBase;
-	static std::uniform_real_distribution<float> sFloatGen;
+	//! Returns the calling thread's static generator, creating or re-seeding it as needed
+	static RandGenerator<std::mt19937>&	threadGenerator();
 };
 
 //! Resets the static random generator to the specific seed \a seedValue
@@ -320,4 +450,16 @@ inline Vec2f randVec2f() { return Rand::randVec2f(); }
 //! returns a random float via Gaussian distribution
 inline float randGaussian() { return Rand::randGaussian(); }    
 
+//! Fills \a result with \a count random floats in the range [0.0f,1.0f)
+inline void randFloats( float *result, size_t count ) { Rand::randFloats( result, count ); }
+
+//! Fills \a result with \a count random floats in the range [a,b)
+inline void randFloats( float *result, size_t count, float a, float b ) { Rand::randFloats( result, count, a, b ); }
+
+//! Fills \a result with \a count random points on the unit sphere
+inline void randVec3fs( Vec3f *result, size_t count ) { Rand::randVec3fs( result, count ); }
+
+//! Fills \a result with \a count random points on the unit circle
+inline void randVec2fs( Vec2f *result, size_t count ) { Rand::randVec2fs( result, count ); }
+
 } // namespace cinder
@@ -24,7 +24,11 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Exception.h"
+#include "cinder/Thread.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -38,6 +42,15 @@
 
 namespace cinder {
 
+namespace audio { namespace dsp {
+	template <typename T> class RingBufferT;
+} } // namespace audio::dsp
+
+//! \brief A serial port, read and written either synchronously or by a background I/O thread.
+//!
+//! By default every read and write is a system call on the calling thread. After startAsync(), a thread per port waits on the device
+//! (with poll() on OS X, overlapped I/O on Windows) and moves received bytes into a lock-free ring buffer, or hands them straight to
+//! callbacks, as soon as they arrive. Writes are then queued and return immediately.
 class Serial {
   public:
 	class Device {
@@ -60,6 +73,39 @@ class Serial {
 	static Serial::Device findDeviceByName( const std::string &name, bool forceRefresh = false );
 	//! Returns the first Serial::Device whose name contains the string \a searchString. Returns a null Serial::Device if none are found. Uses a cached list of the serial devices unless \a forceRefresh.
 	static Serial::Device findDeviceByNameContains( const std::string &searchString, bool forceRefresh = false );
+
+	//! Options for the background I/O thread started by startAsync()
+	class AsyncFormat {
+	  public:
+		typedef std::function<void( const uint8_t *data, size_t numBytes )>	ReceiveFn;
+		typedef std::function<void( const std::string &message )>				MessageFn;
+
+		AsyncFormat() : mReceiveBufferSize( 65536 ), mDelimiter( '\n' ), mMaxMessageLength( 4096 ) {}
+
+		//! Sets the size in bytes of the ring buffer that readBytes() and the other reads are served from. Default is 64k. Bytes received while it is full are dropped.
+		AsyncFormat&	receiveBufferSize( size_t size )		{ mReceiveBufferSize = size; return *this; }
+		//! Sets a function called on the I/O thread with each chunk of bytes as it is received. Received bytes bypass the receive buffer when a ReceiveFn or MessageFn is set.
+		AsyncFormat&	receiveFn( const ReceiveFn &fn )		{ mReceiveFn = fn; return *this; }
+		//! Sets a function called on the I/O thread with each received message, excluding its delimiter. Received bytes bypass the receive buffer when a ReceiveFn or MessageFn is set.
+		AsyncFormat&	messageFn( const MessageFn &fn )		{ mMessageFn = fn; return *this; }
+		//! Sets the character that terminates the messages passed to the MessageFn. Default is \c '\\n'.
+		AsyncFormat&	delimiter( char delimiter )				{ mDelimiter = delimiter; return *this; }
+		//! Sets the length at which an unterminated message is passed to the MessageFn regardless. Default is 4096.
+		AsyncFormat&	maxMessageLength( size_t length )		{ mMaxMessageLength = length; return *this; }
+
+		size_t				getReceiveBufferSize() const		{ return mReceiveBufferSize; }
+		const ReceiveFn&	getReceiveFn() const				{ return mReceiveFn; }
+		const MessageFn&	getMessageFn() const				{ return mMessageFn; }
+		char				getDelimiter() const				{ return mDelimiter; }
+		size_t				getMaxMessageLength() const			{ return mMaxMessageLength; }
+
+	  private:
+		size_t		mReceiveBufferSize;
+		ReceiveFn	mReceiveFn;
+		MessageFn	mMessageFn;
+		char		mDelimiter;
+		size_t		mMaxMessageLength;
+	};
 	
 	
 	Serial() {}
@@ -88,24 +134,60 @@ class Serial {
 
 	//! Forces the device to flush any buffered \a input and/or \a output bytes
 	void	flush( bool input = true, bool output = true );
-	//! Returns the number of bytes available for reading from the device
+	//! Returns the number of bytes available for reading from the device, or from the receive buffer while the I/O thread is running
 	size_t	getNumBytesAvailable() const;
+
+	//! \brief Starts a background thread that services the port until stopAsync(), configured by \a format.
+	//!
+	//! While it runs, the reads above are served from the receive buffer, unless \a format has a ReceiveFn or MessageFn, and writes are
+	//! queued and return immediately. Reads must all be made from one thread. The I/O thread stops if the device fails, after which
+	//! reads throw a SerialExcReadFailure once the receive buffer is empty and writes throw a SerialExcWriteFailure.
+	void	startAsync( const AsyncFormat &format = AsyncFormat() );
+	//! Stops the I/O thread. Bytes still queued for writing and bytes left in the receive buffer are discarded.
+	void	stopAsync();
+	//! Returns whether the I/O thread was started by startAsync()
+	bool	isAsync() const;
+	//! Returns the number of queued bytes that the I/O thread hasn't yet written
+	size_t	getNumBytesQueued() const;
+	//! Returns the number of received bytes dropped because the receive buffer was full, since startAsync()
+	size_t	getNumBytesDropped() const;
 	
   protected:
 	struct Obj {
 		Obj();
 		Obj( const Serial::Device &device, int baudRate );
 		~Obj();
+
+		void	startAsync( const AsyncFormat &format );
+		void	stopAsync();
+		void	wakeAsync();
+		void	asyncThreadFn();
+		//! Called on the I/O thread with newly received bytes
+		void	receive( const uint8_t *data, size_t numBytes );
+		//! Reads up to \a maximumBytes from the receive buffer
+		size_t	readReceived( void *data, size_t maximumBytes );
 	
 		Device			mDevice;
 		
 #ifdef CINDER_MSW
 		::HANDLE		mDeviceHandle;
 		::COMMTIMEOUTS 	mSavedTimeouts;
+		::HANDLE		mSyncEvent;		// completes the overlapped transfers made synchronously
+		::HANDLE		mWakeEvent;
 #else
 		int				mFd;
 		::termios		mSavedOptions;
+		int				mWakePipe[2];
 #endif	
+
+		AsyncFormat												mAsyncFormat;
+		std::unique_ptr<std::thread>							mAsyncThread;
+		std::atomic<bool>										mAsyncRunning, mAsyncFailed;
+		std::unique_ptr<audio::dsp::RingBufferT<uint8_t> >		mReceiveBuffer;
+		std::atomic<size_t>										mNumBytesDropped;
+		std::string												mMessage;		// partial message, only touched by the I/O thread
+		mutable std::mutex										mWriteMutex;
+		std::vector<uint8_t>									mWriteQueue;
 	};
 	
 	std::shared_ptr<Obj>		mObj;
@@ -0,0 +1,104 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Rect.h"
+#include "cinder/PolyLine.h"
+#include "cinder/Shape2d.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace cinder {
+
+//! Accelerates repeated contains() tests against a single Shape2d or set of PolyLines. The outline is flattened once and its edges are binned into vertical columns, so a test only visits the edges whose x-range covers the point rather than every segment of every contour. Results match Shape2d::contains() for the flattened outline, including holes.
+class ShapeHitTester {
+  public:
+	ShapeHitTester() : mNumColumns( 0 ), mColumnScale( 0 ) {}
+	//! Flattens \a shape with Path2d::subdivide() at \a approximationScale. Pass the scale the shape is drawn at for a test that agrees with what is on screen.
+	ShapeHitTester( const Shape2d &shape, float approximationScale = 1.0f );
+	//! Treats \a polyLine as a closed contour
+	ShapeHitTester( const PolyLine2f &polyLine );
+	//! Treats each of \a polyLines as a closed contour, with an even-odd rule for holes
+	ShapeHitTester( const std::vector<PolyLine2f> &polyLines );
+
+	//! Returns whether \a pt is contained within the outline
+	bool			contains( const Vec2f &pt ) const;
+	//! Returns the bounding box of the flattened outline
+	const Rectf&	getBounds() const { return mBounds; }
+	//! Returns the number of edges in the flattened outline
+	size_t			getNumEdges() const { return mEdges.size() / 2; }
+
+  private:
+	void	addContour( const std::vector<Vec2f> &points );
+	void	buildColumns();
+
+	std::vector<Vec2f>		mEdges; // pairs of endpoints
+	std::vector<uint32_t>	mColumnStarts;
+	std::vector<uint32_t>	mColumnEdges;
+	Rectf					mBounds;
+	int						mNumColumns;
+	float					mColumnScale;
+};
+
+//! Spatial hash of the bounding boxes of many shapes, for hit-testing many points against a scene. Shapes are identified by the order in which they were added, and later shapes are considered to be on top.
+class ShapeHitIndex {
+  public:
+	//! \a cellSize is the edge length of a square hash cell, ideally near the typical size of a shape
+	ShapeHitIndex( float cellSize = 64.0f );
+
+	//! Adds \a shape flattened at \a approximationScale and returns its index
+	size_t		add( const Shape2d &shape, float approximationScale = 1.0f );
+	//! Adds \a polyLine as a closed contour and returns its index
+	size_t		add( const PolyLine2f &polyLine );
+	//! Adds a prebuilt \a hitTester and returns its index
+	size_t		add( const ShapeHitTester &hitTester );
+	//! Removes all shapes
+	void		clear();
+
+	size_t					getNumShapes() const { return mShapes.size(); }
+	const ShapeHitTester&	getShape( size_t index ) const { return mShapes[index]; }
+	float					getCellSize() const { return mCellSize; }
+
+	//! Returns the index of the topmost (most recently added) shape containing \a pt, or -1 if there is none
+	int			hitTest( const Vec2f &pt ) const;
+	//! Stores into \a result the index of the topmost shape containing each of \a numPoints \a points, or -1
+	void		hitTest( const Vec2f *points, size_t numPoints, int *result ) const;
+	//! Appends to \a result the indices of all shapes containing \a pt, topmost first
+	void		hitTestAll( const Vec2f &pt, std::vector<size_t> *result ) const;
+	//! Appends to \a result the indices of all shapes whose bounding boxes contain \a pt, in no particular order
+	void		queryBounds( const Vec2f &pt, std::vector<size_t> *result ) const;
+
+  private:
+	uint64_t	calcCellKey( int cellX, int cellY ) const { return ( (uint64_t)(uint32_t)cellX << 32 ) | (uint32_t)cellY; }
+	int			calcCell( float v ) const;
+
+	float										mCellSize, mCellScale;
+	std::vector<ShapeHitTester>					mShapes;
+	std::unordered_map<uint64_t,std::vector<uint32_t> >	mCells;
+	//! Shapes covering too many cells to hash, which are tested against every point
+	std::vector<uint32_t>						mOversized;
+};
+
+} // namespace cinder
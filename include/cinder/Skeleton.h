@@ -0,0 +1,160 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/Quaternion.h"
+#include "cinder/Matrix.h"
+#include "cinder/Exception.h"
+
+#include <vector>
+#include <string>
+
+namespace cinder {
+
+//! A bone's transform relative to its parent, applied as scale, then rotation, then translation
+struct BoneTransform {
+	BoneTransform() : mTranslation( Vec3f::zero() ), mScale( 1, 1, 1 ) {}
+	BoneTransform( const Vec3f &translation, const Quatf &rotation, const Vec3f &scale = Vec3f( 1, 1, 1 ) )
+		: mTranslation( translation ), mRotation( rotation ), mScale( scale )
+	{}
+
+	Matrix44f	toMatrix44() const;
+
+	Vec3f	mTranslation;
+	Quatf	mRotation;
+	Vec3f	mScale;
+};
+
+/** \brief The local transforms of every bone of a Skeleton.
+ *
+ * Transforms are stored as a structure of arrays, padded to a multiple of four bones, so that blend() interpolates four bones per instruction. **/
+class SkeletonPose {
+  public:
+	SkeletonPose() : mNumBones( 0 ), mStride( 0 ) {}
+	//! Creates a pose of \a numBones identity transforms
+	explicit SkeletonPose( size_t numBones );
+
+	size_t			getNumBones() const { return mNumBones; }
+
+	BoneTransform	getTransform( size_t bone ) const;
+	void			setTransform( size_t bone, const BoneTransform &transform );
+
+	/** Interpolates every bone from \a a towards \a b by \a t, writing into \a result, which may be \a a or \a b. Translations and scales are interpolated
+		linearly. Rotations take the shortest path with a corrected normalized lerp, which stays within 0.0015 radians of slerp. **/
+	static void		blend( const SkeletonPose &a, const SkeletonPose &b, float t, SkeletonPose *result );
+
+  private:
+	enum { TRANSLATION_X, TRANSLATION_Y, TRANSLATION_Z, ROTATION_X, ROTATION_Y, ROTATION_Z, ROTATION_W, SCALE_X, SCALE_Y, SCALE_Z, NUM_CHANNELS };
+
+	float*			getChannel( int channel ) { return &mData[channel * mStride]; }
+	const float*	getChannel( int channel ) const { return &mData[channel * mStride]; }
+
+	size_t				mNumBones, mStride;
+	std::vector<float>	mData;
+};
+
+typedef std::shared_ptr<class Skeleton>	SkeletonRef;
+
+/** \brief A hierarchy of bones and their bind pose, for skinning meshes.
+ *
+ * Each bone's transform is relative to its parent's, and parents precede their children, so a pose is concatenated into object space in a single
+ * pass. calcSkinningMatrices() produces the matrices gl::SkinnedMesh expects, which take a vertex from the bind pose to the posed mesh. **/
+class Skeleton {
+  public:
+	static SkeletonRef	create() { return SkeletonRef( new Skeleton ); }
+
+	/** Adds a bone named \a name, whose \a bindTransform is relative to bone \a parent, or to object space when \a parent is \c -1, and returns its index.
+		Throws SkeletonExc if \a parent hasn't been added yet. **/
+	int						addBone( const std::string &name, int parent, const BoneTransform &bindTransform );
+
+	size_t					getNumBones() const { return mParents.size(); }
+	//! Returns the index of the first bone named \a name, or \c -1 if there isn't one
+	int						findBone( const std::string &name ) const;
+	const std::string&		getBoneName( size_t bone ) const { return mNames[bone]; }
+	//! Returns the index of \a bone's parent, or \c -1 for a root bone
+	int						getParent( size_t bone ) const { return mParents[bone]; }
+	const BoneTransform&	getBindTransform( size_t bone ) const { return mBindTransforms[bone]; }
+	//! Returns the inverse of \a bone's object space transform in the bind pose
+	const Matrix44f&		getInverseBindMatrix( size_t bone ) const { return mInverseBindMatrices[bone]; }
+	//! Returns a pose holding every bone's bind transform
+	SkeletonPose			getBindPose() const;
+
+	//! Concatenates the local transforms of \a pose into object space, writing getNumBones() matrices to \a result
+	void	calcGlobalMatrices( const SkeletonPose &pose, Matrix44f *result ) const;
+	/** Writes getNumBones() skinning matrices to \a result, each the bone's object space transform in \a pose times its inverse bind matrix, premultiplied
+		by \a transform. Writing several characters' palettes consecutively, each with its own model matrix as \a transform, prepares them for gl::SkinnedMesh::drawInstanced(). **/
+	void	calcSkinningMatrices( const SkeletonPose &pose, Matrix44f *result, const Matrix44f &transform = Matrix44f::identity() ) const;
+
+  protected:
+	Skeleton() {}
+
+	std::vector<std::string>	mNames;
+	std::vector<int>			mParents;
+	std::vector<BoneTransform>	mBindTransforms;
+	std::vector<Matrix44f>		mBindMatrices, mInverseBindMatrices;
+};
+
+typedef std::shared_ptr<class SkeletalAnimation>	SkeletalAnimationRef;
+
+//! An animation of a Skeleton as poses sampled at a fixed rate
+class SkeletalAnimation {
+  public:
+	//! Creates an animation of \a numFrames poses of \a numBones identity transforms, \a framesPerSecond apart
+	static SkeletalAnimationRef	create( size_t numBones, size_t numFrames, float framesPerSecond ) { return SkeletalAnimationRef( new SkeletalAnimation( numBones, numFrames, framesPerSecond ) ); }
+
+	size_t		getNumBones() const { return mNumBones; }
+	size_t		getNumFrames() const { return mFrames.size(); }
+	float		getFramesPerSecond() const { return mFramesPerSecond; }
+	//! Returns the time of the last frame in seconds
+	float		getDuration() const { return ( mFrames.size() - 1 ) / mFramesPerSecond; }
+
+	SkeletonPose&		getFrame( size_t frame ) { return mFrames[frame]; }
+	const SkeletonPose&	getFrame( size_t frame ) const { return mFrames[frame]; }
+	void				setTransform( size_t frame, size_t bone, const BoneTransform &transform ) { mFrames[frame].setTransform( bone, transform ); }
+
+	/** Samples the animation at \a seconds into \a result, blending the two nearest frames. When \a loop is \c true time wraps around every getDuration()
+		seconds, so the last frame should match the first; otherwise it holds the first and last frames beyond the ends. **/
+	void		sample( float seconds, SkeletonPose *result, bool loop = true ) const;
+
+  protected:
+	SkeletalAnimation( size_t numBones, size_t numFrames, float framesPerSecond );
+
+	size_t						mNumBones;
+	float						mFramesPerSecond;
+	std::vector<SkeletonPose>	mFrames;
+};
+
+class SkeletonExc : public Exception {
+  public:
+	SkeletonExc( const std::string &description ) : mDescription( description ) {}
+	virtual ~SkeletonExc() throw() {}
+	virtual const char* what() const throw() { return mDescription.c_str(); }
+
+  protected:
+	std::string	mDescription;
+};
+
+} // namespace cinder
@@ -0,0 +1,201 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/CinderMath.h"
+#include "cinder/TaskPool.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace cinder {
+
+//! \brief Uniform grid spatial hash for neighbor queries on points which move every frame, such as particles.
+//!
+//! \a T is a 2D or 3D vector type such as Vec2f or Vec3f. Each build() hashes every point's grid cell and counting-sorts the points so that each cell's points are contiguous.
+//! Radius queries then visit only the cells overlapping the query sphere. Build time is linear in the number of points, so rebuilding every frame is the intended use.
+//! Queries are fastest when the cell size is close to the typical query radius.
+template<typename T>
+class SpatialHashGrid {
+  public:
+	typedef typename T::value_type	value_type;
+	static const int DIM = T::DIM;
+
+	explicit SpatialHashGrid( value_type cellSize = 1 ) { setCellSize( cellSize ); }
+
+	//! Sets the edge length of a grid cell, which takes effect on the next build()
+	void		setCellSize( value_type cellSize ) { mCellSize = cellSize; mInvCellSize = 1 / cellSize; }
+	value_type	getCellSize() const { return mCellSize; }
+
+	//! Rebuilds the grid from \a numPoints \a points, which are copied. Storage is reused between builds. If \a taskPool is non-NULL, hashing and gathering the points are divided among its threads.
+	void	build( const T *points, size_t numPoints, TaskPool *taskPool = NULL );
+	//! Rebuilds the grid from \a points
+	void	build( const std::vector<T> &points, TaskPool *taskPool = NULL ) { build( points.empty() ? NULL : &points[0], points.size(), taskPool ); }
+
+	//! Returns the number of points in the grid
+	size_t							size() const { return mSortedPoints.size(); }
+	//! Returns the points sorted by cell. Iterating in this order gives neighboring queries good cache coherence.
+	const std::vector<T>&			getSortedPoints() const { return mSortedPoints; }
+	//! Returns the index in the built array of each of getSortedPoints()
+	const std::vector<uint32_t>&	getSortedIndices() const { return mSortedIndices; }
+
+	//! Calls \a fn( uint32_t index, value_type distanceSquared ) for each point within \a radius of \a p, where \a index is its position in the array passed to build()
+	template<typename FN>
+	void	forEachInRadius( const T &p, value_type radius, FN fn ) const;
+	//! Appends to \a result the indices of all points within \a radius of \a p, in no particular order
+	void	findInRadius( const T &p, value_type radius, std::vector<uint32_t> *result ) const
+	{
+		forEachInRadius( p, radius, [result]( uint32_t index, value_type ) { result->push_back( index ); } );
+	}
+
+  private:
+	int			calcCell( value_type v ) const { return (int)math<value_type>::floor( v * mInvCellSize ); }
+	uint32_t	calcBucket( const int cell[DIM] ) const
+	{
+		// large primes from Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+		static const uint32_t primes[3] = { 73856093u, 19349663u, 83492791u };
+		uint32_t hash = 0;
+		for( int d = 0; d < DIM; ++d )
+			hash ^= (uint32_t)cell[d] * primes[d];
+		return hash & ( mNumBuckets - 1 );
+	}
+
+	value_type				mCellSize, mInvCellSize;
+	uint32_t				mNumBuckets;
+	std::vector<uint32_t>	mBucketStarts;	// mNumBuckets + 1 offsets into mSortedPoints
+	std::vector<uint32_t>	mBuckets;		// bucket of each source point, during build()
+	std::vector<uint32_t>	mSortedIndices;
+	std::vector<T>			mSortedPoints;
+};
+
+typedef SpatialHashGrid<Vec2f>	SpatialHashGrid2f;
+typedef SpatialHashGrid<Vec3f>	SpatialHashGrid3f;
+
+template<typename T>
+void SpatialHashGrid<T>::build( const T *points, size_t numPoints, TaskPool *taskPool )
+{
+	// roughly two buckets per point keeps collisions between distinct cells rare
+	mNumBuckets = 64;
+	while( mNumBuckets < numPoints * 2 )
+		mNumBuckets *= 2;
+
+	mBuckets.resize( numPoints );
+	mSortedIndices.resize( numPoints );
+	mSortedPoints.resize( numPoints );
+
+	std::function<void ( size_t, size_t )> hashRange = [=]( size_t first, size_t last ) {
+		for( size_t i = first; i < last; ++i ) {
+			int cell[DIM];
+			for( int d = 0; d < DIM; ++d )
+				cell[d] = calcCell( points[i][d] );
+			mBuckets[i] = calcBucket( cell );
+		}
+	};
+	if( taskPool )
+		taskPool->parallelFor( 0, numPoints, hashRange );
+	else
+		hashRange( 0, numPoints );
+
+	// counting sort by bucket, stable so that each bucket stays in source order
+	mBucketStarts.assign( mNumBuckets + 1, 0 );
+	for( size_t i = 0; i < numPoints; ++i )
+		mBucketStarts[mBuckets[i] + 1]++;
+	for( uint32_t b = 0; b < mNumBuckets; ++b )
+		mBucketStarts[b + 1] += mBucketStarts[b];
+	std::vector<uint32_t> cursors( mBucketStarts.begin(), mBucketStarts.end() - 1 );
+	for( size_t i = 0; i < numPoints; ++i )
+		mSortedIndices[cursors[mBuckets[i]]++] = (uint32_t)i;
+
+	std::function<void ( size_t, size_t )> gatherRange = [=]( size_t first, size_t last ) {
+		for( size_t j = first; j < last; ++j )
+			mSortedPoints[j] = points[mSortedIndices[j]];
+	};
+	if( taskPool )
+		taskPool->parallelFor( 0, numPoints, gatherRange );
+	else
+		gatherRange( 0, numPoints );
+}
+
+template<typename T>
+template<typename FN>
+void SpatialHashGrid<T>::forEachInRadius( const T &p, value_type radius, FN fn ) const
+{
+	if( mSortedPoints.empty() )
+		return;
+
+	int cellMin[DIM], cellMax[DIM];
+	uint64_t numCells = 1;
+	for( int d = 0; d < DIM; ++d ) {
+		cellMin[d] = calcCell( p[d] - radius );
+		cellMax[d] = calcCell( p[d] + radius );
+		numCells *= (uint64_t)( cellMax[d] - cellMin[d] + 1 );
+	}
+
+	// distinct cells may share a bucket, so gather the buckets first and visit each once
+	const size_t maxLocalBuckets = 64; // covers a radius up to 1.5 cells in 3D without allocating
+	uint32_t localBuckets[maxLocalBuckets];
+	std::vector<uint32_t> allocatedBuckets;
+	uint32_t *buckets = localBuckets;
+	size_t numBuckets = 0;
+	if( numCells >= mNumBuckets ) {
+		allocatedBuckets.resize( mNumBuckets );
+		for( uint32_t b = 0; b < mNumBuckets; ++b )
+			allocatedBuckets[b] = b;
+		buckets = &allocatedBuckets[0];
+		numBuckets = mNumBuckets;
+	}
+	else {
+		if( numCells > maxLocalBuckets ) {
+			allocatedBuckets.resize( (size_t)numCells );
+			buckets = &allocatedBuckets[0];
+		}
+		int cell[DIM];
+		for( int d = 0; d < DIM; ++d )
+			cell[d] = cellMin[d];
+		while( true ) {
+			buckets[numBuckets++] = calcBucket( cell );
+			int d = 0;
+			while( d < DIM && ++cell[d] > cellMax[d] ) {
+				cell[d] = cellMin[d];
+				++d;
+			}
+			if( d == DIM )
+				break;
+		}
+		std::sort( buckets, buckets + numBuckets );
+		numBuckets = std::unique( buckets, buckets + numBuckets ) - buckets;
+	}
+
+	const value_type radiusSquared = radius * radius;
+	for( size_t b = 0; b < numBuckets; ++b ) {
+		for( uint32_t j = mBucketStarts[buckets[b]]; j < mBucketStarts[buckets[b] + 1]; ++j ) {
+			value_type distanceSquared = mSortedPoints[j].distanceSquared( p );
+			if( distanceSquared <= radiusSquared )
+				fn( mSortedIndices[j], distanceSquared );
+		}
+	}
+}
+
+} // namespace cinder
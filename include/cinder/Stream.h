@@ -30,11 +30,14 @@
 #include <boost/noncopyable.hpp>
 
 #include <string>
+#include <vector>
 #ifndef __OBJC__
 #	include <boost/iostreams/concepts.hpp>
 #	include <boost/iostreams/stream.hpp>
 #endif
 
+struct z_stream_s; // zlib
+
 namespace cinder {
 
 class StreamBase : private boost::noncopyable {
@@ -93,6 +96,12 @@ class OStream : public virtual StreamBase {
 	void		writeBig( T t );
 	template<typename T>
 	void		writeLittle( T t );
+	//! Writes \a count values from \a t as big endian, in a single write when no byte swapping is needed and in large swapped batches otherwise.
+	template<typename T>
+	void		writeBig( const T *t, size_t count );
+	//! Writes \a count values from \a t as little endian, in a single write when no byte swapping is needed and in large swapped batches otherwise.
+	template<typename T>
+	void		writeLittle( const T *t, size_t count );
 
 	void		write( const Buffer &buffer );
 	void		writeData( const void *src, size_t size );
@@ -101,6 +110,8 @@ class OStream : public virtual StreamBase {
 	OStream() : StreamBase() {}
  
 	virtual void		IOWrite( const void *t, size_t size ) = 0;
+	template<typename T>
+	void				writeSwapped( const T *t, size_t count );
 };
 
 
@@ -118,6 +129,12 @@ class IStreamCinder : public virtual StreamBase {
 	void		readBig( T *t );
 	template<typename T>
 	void		readLittle( T *t );
+	//! Reads \a count big endian values into \a t with a single underlying read, followed by one byte swap over the whole array if necessary.
+	template<typename T>
+	void		readBig( T *t, size_t count );
+	//! Reads \a count little endian values into \a t with a single underlying read, followed by one byte swap over the whole array if necessary.
+	template<typename T>
+	void		readLittle( T *t, size_t count );
 
 	//! Reads characters until a null terminator
 	void		read( std::string *s );
@@ -281,6 +298,51 @@ class IStreamMem : public IStreamCinder {
 };
 
 
+typedef std::shared_ptr<class MemoryMappedFile>	MemoryMappedFileRef;
+
+//! \brief Maps a file into memory for reading.
+//!
+//! The mapping is copy-on-write, so the data may be modified in memory without affecting the file. Uses mmap() on OS X / iOS and CreateFileMapping() on Windows.
+class MemoryMappedFile : private boost::noncopyable {
+ public:
+	//! Maps the file at \a path. Returns an empty MemoryMappedFileRef if the file can't be opened or mapped, is empty, or is smaller than \a minSize bytes.
+	static MemoryMappedFileRef	create( const fs::path &path, size_t minSize = 0 );
+	~MemoryMappedFile();
+
+	//! Returns a pointer to the mapped contents of the file.
+	void*		getData()			{ return mData; }
+	//! Returns a pointer to the mapped contents of the file.
+	const void*	getData() const		{ return mData; }
+	//! Returns the size of the mapping in bytes, which is the size of the file.
+	size_t		getSize() const		{ return mSize; }
+
+ protected:
+	MemoryMappedFile( void *data, size_t size, void *fileHandle, void *mappingHandle );
+
+	void			*mData;
+	size_t			mSize;
+	void			*mFileHandle, *mMappingHandle; // only used on MSW
+};
+
+
+typedef std::shared_ptr<class IStreamMemoryMapped>	IStreamMemoryMappedRef;
+
+//! An IStreamMem that reads from a MemoryMappedFile, keeping it alive for the lifetime of the stream.
+class IStreamMemoryMapped : public IStreamMem {
+ public:
+	//! Creates a new IStreamMemoryMappedRef that reads from \a mappedFile.
+	static IStreamMemoryMappedRef	create( const MemoryMappedFileRef &mappedFile );
+
+	//! Returns the MemoryMappedFile that this stream reads from.
+	const MemoryMappedFileRef&	getMemoryMappedFile() const	{ return mMappedFile; }
+
+ protected:
+	IStreamMemoryMapped( const MemoryMappedFileRef &mappedFile );
+
+	MemoryMappedFileRef		mMappedFile;
+};
+
+
 typedef std::shared_ptr<class OStreamMem>		OStreamMemRef;
 
 class OStreamMem : public OStream {
@@ -306,6 +368,91 @@ class OStreamMem : public OStream {
 };
 
 
+class TaskPool;
+
+//! Container formats for compressed streams: a zlib stream (RFC 1950), a gzip file (RFC 1952) or raw deflate data (RFC 1951)
+enum DeflateFormat { DEFLATE_FORMAT_ZLIB, DEFLATE_FORMAT_GZIP, DEFLATE_FORMAT_RAW };
+
+typedef std::shared_ptr<class OStreamDeflate>	OStreamDeflateRef;
+
+//! OStream adapter which compresses everything written to it and passes the result on to another OStream, using a fixed amount of memory regardless of how much is written.
+class OStreamDeflate : public OStream {
+ public:
+	//! Creates a stream which writes data compressed at \a compressionLevel (0-9) to \a output. If \a taskPool is non-null, data is split into blocks of \a blockSize bytes which are compressed in parallel on its threads (pigz-style). The output remains a single stream either way.
+	static OStreamDeflateRef	create( const OStreamRef &output, int8_t compressionLevel = DEFAULT_COMPRESSION_LEVEL, DeflateFormat format = DEFLATE_FORMAT_ZLIB, TaskPool *taskPool = nullptr, size_t blockSize = 1024 * 1024 );
+	//! Calls finish() if it hasn't been called already, swallowing any exception.
+	~OStreamDeflate();
+
+	//! Compresses everything written so far and writes it to the output stream, ending on a byte boundary so that a reader can decompress all of it. Compression suffers slightly when called often.
+	void		flush();
+	//! Compresses any remaining data and writes the stream's trailer. Nothing may be written afterwards.
+	void		finish();
+
+	//! Returns the number of uncompressed bytes written to the stream.
+	virtual off_t		tell() const { return mTotalIn; }
+	//! Unsupported; throws StreamExc.
+	virtual void		seekAbsolute( off_t absoluteOffset );
+	//! Unsupported; throws StreamExc.
+	virtual void		seekRelative( off_t relativeOffset );
+
+ protected:
+	OStreamDeflate( const OStreamRef &output, int8_t compressionLevel, DeflateFormat format, TaskPool *taskPool, size_t blockSize );
+
+	virtual void		IOWrite( const void *t, size_t size );
+	void		deflateSerial( const uint8_t *data, size_t size, int flush );
+	void		deflateParallel( const uint8_t *data, size_t size, int flush );
+
+	OStreamRef							mOutput;
+	int8_t								mCompressionLevel;
+	DeflateFormat						mFormat;
+	TaskPool							*mTaskPool;
+	size_t								mBlockSize;
+	off_t								mTotalIn;
+	bool								mFinished;
+	// serial path
+	std::shared_ptr<z_stream_s>	mZStream;
+	std::vector<uint8_t>				mOutBuffer;
+	// parallel path; input is gathered into mPending until there is a block for each thread
+	std::vector<uint8_t>				mPending;
+	size_t								mPendingSize;
+	std::vector<uint8_t>				mDictionary; // the last 32k of input, which primes the next block
+	unsigned long						mCheck; // adler32 or crc32 of the input so far
+};
+
+
+typedef std::shared_ptr<class IStreamInflate>	IStreamInflateRef;
+
+//! IStream adapter which decompresses data read from another IStream as it is consumed, using a fixed amount of memory. Seeking is limited to skipping forward.
+class IStreamInflate : public IStreamCinder {
+ public:
+	//! Creates a stream which decompresses \a input, which is expected to be in \a format.
+	static IStreamInflateRef	create( const IStreamRef &input, DeflateFormat format = DEFLATE_FORMAT_ZLIB );
+
+	virtual size_t		readDataAvailable( void *dest, size_t maxSize );
+
+	//! Only supports positions at or past tell(), which are reached by decompressing and discarding data. Throws StreamExc otherwise.
+	virtual void		seekAbsolute( off_t absoluteOffset );
+	//! Only supports positive offsets. Throws StreamExc otherwise.
+	virtual void		seekRelative( off_t relativeOffset );
+	//! Returns the number of decompressed bytes read so far.
+	virtual off_t		tell() const { return mTotalOut; }
+	//! The decompressed size isn't known in advance, so this returns 0.
+	virtual off_t		size() const { return 0; }
+	virtual bool		isEof() const { return mStreamEnd; }
+
+ protected:
+	IStreamInflate( const IStreamRef &input, DeflateFormat format );
+
+	virtual void		IORead( void *t, size_t size );
+
+	IStreamRef							mInput;
+	std::shared_ptr<z_stream_s>	mZStream;
+	std::vector<uint8_t>				mInBuffer;
+	off_t								mTotalOut;
+	bool								mStreamEnd;
+};
+
+
 // This class is a utility to save and restore a stream's state
 class IStreamStateRestore {
  public:
@@ -0,0 +1,85 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/PolyLine.h"
+#include "cinder/Vector.h"
+
+#include <vector>
+
+namespace cinder {
+
+/** \brief Generates the triangles which outline a thick PolyLine2f, with miter, bevel or round joins and butt, square or round caps.
+ *
+ * The output is a non-indexed triangle list: each segment is a quad of 6 vertices, and joins and caps add triangles on their outer side only, so a
+ * translucent stroke overlaps itself slightly on the inside of its turns. Each vertex has a texture coordinate whose x is the distance along the line
+ * and whose y runs from 0 on its left to 1 on its right, for dashes and antialiased edges in a shader. Closed PolyLines are joined at their first
+ * point and have no caps. Consecutive duplicate points are skipped. calcNumVertices() returns exactly the number of vertices generate() writes, so
+ * buffers can be sized up front, and nothing is allocated while generating.
+ **/
+class Stroke {
+  public:
+	enum Join { JOIN_MITER, JOIN_BEVEL, JOIN_ROUND };
+	enum Cap { CAP_BUTT, CAP_SQUARE, CAP_ROUND };
+
+	//! \a miterLimit is the longest miter allowed, as a multiple of \a width, beyond which a miter join is beveled. \a tolerance is the greatest distance between a round join or cap and its triangulation.
+	explicit Stroke( float width = 1.0f, Join join = JOIN_MITER, Cap cap = CAP_BUTT, float miterLimit = 4.0f, float tolerance = 0.25f )
+		: mWidth( width ), mJoin( join ), mCap( cap ), mMiterLimit( miterLimit ), mTolerance( tolerance )
+	{}
+
+	Stroke&		width( float width ) { mWidth = width; return *this; }
+	Stroke&		join( Join join ) { mJoin = join; return *this; }
+	Stroke&		cap( Cap cap ) { mCap = cap; return *this; }
+	Stroke&		miterLimit( float miterLimit ) { mMiterLimit = miterLimit; return *this; }
+	Stroke&		tolerance( float tolerance ) { mTolerance = tolerance; return *this; }
+
+	float		getWidth() const { return mWidth; }
+	void		setWidth( float width ) { mWidth = width; }
+	Join		getJoin() const { return mJoin; }
+	void		setJoin( Join join ) { mJoin = join; }
+	Cap			getCap() const { return mCap; }
+	void		setCap( Cap cap ) { mCap = cap; }
+	float		getMiterLimit() const { return mMiterLimit; }
+	void		setMiterLimit( float miterLimit ) { mMiterLimit = miterLimit; }
+	float		getTolerance() const { return mTolerance; }
+	void		setTolerance( float tolerance ) { mTolerance = tolerance; }
+
+	//! Returns the number of vertices generate() writes for \a polyLine, a multiple of 3
+	size_t		calcNumVertices( const PolyLine2f &polyLine ) const;
+
+	/** Writes the triangles of \a polyLine's stroke as positions with a z of 0, each \a positionStride bytes apart, and returns how many were written.
+		\a texCoords, each \a texCoordStride bytes apart, may be NULL. A stride of 0 means the elements are tightly packed. **/
+	size_t		generate( const PolyLine2f &polyLine, Vec3f *positions, size_t positionStride = 0, Vec2f *texCoords = NULL, size_t texCoordStride = 0 ) const;
+	//! Appends the triangles of \a polyLine's stroke to \a positions and, unless it is NULL, to \a texCoords
+	void		generate( const PolyLine2f &polyLine, std::vector<Vec3f> *positions, std::vector<Vec2f> *texCoords = NULL ) const;
+
+  protected:
+	float		mWidth;
+	Join		mJoin;
+	Cap			mCap;
+	float		mMiterLimit, mTolerance;
+};
+
+} // namespace cinder
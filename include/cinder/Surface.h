@@ -33,6 +33,7 @@
 #include "cinder/ChanTraits.h"
 #include "cinder/Color.h"
 #include "cinder/Filesystem.h"
+#include "cinder/MemoryStats.h"
 
 #include <boost/logic/tribool.hpp>
 
@@ -90,7 +91,7 @@ typedef std::shared_ptr<class ImageTarget> ImageTargetRef;
 template<typename T>
 //! An in-memory representation of an image. \ImplShared
 class SurfaceT {
- private:
+ protected:
 	/// \cond
 	struct Obj {
 		Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, T *aData, bool aOwnsData, int32_t aRowBytes );
@@ -109,9 +110,14 @@ class SurfaceT {
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
+		std::shared_ptr<Obj>		mParent; // keeps the owner of mData alive for views
+		MemoryAllocation			mAllocation;
 	};
 	/// \endcond
 
+	//! Constructs a Surface referencing the pixels of \a parent inside \a area without copying. Used by SurfaceViewT.
+	SurfaceT( const SurfaceT &parent, const Area &area );
+
  public:
 	/*! Constructs an empty Surface, which is the equivalent of NULL and should not be used directly. */
 	SurfaceT() {}
@@ -130,6 +136,12 @@ class SurfaceT {
 	 <tt>Surface mySurface = Surface( loadImage( loadResource( RES ) );</tt>
 	 */
 	SurfaceT( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
+	/*! \brief Creates a Surface by converting the pixels of \a rhs, whose channel type differs, directly rather than through an ImageSource. The channel order is chosen by \a constraints, as when loading.
+
+	 Values are rescaled to the range of \a T, so for example <tt>Surface32f floatSurface( surface8u );</tt> maps [0,255] to [0,1]. Floating point values are clamped to [0,1] when converting to an integer type.
+	*/
+	template<typename Y>
+	explicit SurfaceT( const SurfaceT<Y> &rhs, const SurfaceConstraints &constraints = SurfaceConstraintsDefault() );
 
 #if defined( CINDER_WINRT )
 	/** \brief Constructs asynchronously a Surface from an images located at \a path. The loaded Surface is returned in \a surface.
@@ -233,6 +245,9 @@ class SurfaceT {
 
 	//! Copies the Area \a srcArea of the Surface \a srcSurface to \a this Surface. The destination Area is \a srcArea offset by \a relativeOffset.
 	void	copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset = Vec2i::zero() );
+	//! Copies the Area \a srcArea of the Surface \a srcSurface, whose channel type differs, to \a this Surface, rescaling each value to the range of \a T. The destination Area is \a srcArea offset by \a relativeOffset.
+	template<typename Y>
+	void	copyFrom( const SurfaceT<Y> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset = Vec2i::zero() );
 
 	//! Returns an averaged color for the Area defined by \a area
 	ColorT<T>	areaAverage( const Area &area ) const;
@@ -243,9 +258,10 @@ class SurfaceT {
 	void reset() { mObj.reset(); }
 	/// \endcond
 
- private:
+ protected:
 	std::shared_ptr<Obj>		mObj;
 
+ private:
 	void init( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
 
 	void	copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset );
@@ -475,6 +491,23 @@ class SurfaceT {
 	ConstIter	getIter( const Area &area ) const { return ConstIter( *this, area ); }
 };
 
+//! A Surface which references a sub-region of a parent Surface without allocating or copying. Keeps the parent's pixels alive for its lifetime, and can be passed anywhere a SurfaceT is expected.
+template<typename T>
+class SurfaceViewT : public SurfaceT<T> {
+ public:
+	SurfaceViewT() {}
+	//! Creates a view of \a area of \a parent, clipped to the parent's bounds. Writes through the view modify \a parent.
+	SurfaceViewT( const SurfaceT<T> &parent, const Area &area )
+		: SurfaceT<T>( parent, area ), mParentArea( area.getClipBy( parent.getBounds() ) )
+	{}
+
+	//! Returns the Area of the parent Surface that the view references
+	const Area&		getParentArea() const { return mParentArea; }
+
+ private:
+	Area		mParentArea;
+};
+
 class SurfaceExc : public std::exception {
 	virtual const char* what() const throw() {
 		return "Surface exception";
@@ -496,4 +529,13 @@ typedef SurfaceT<uint16_t> Surface16u;
 //! 32-bit floating point image
 typedef SurfaceT<float> Surface32f;
 
+//! 8-bit view of a Surface. Synonym for SurfaceView8u.
+typedef SurfaceViewT<uint8_t> SurfaceView;
+//! 8-bit view of a Surface
+typedef SurfaceViewT<uint8_t> SurfaceView8u;
+//! 16-bit view of a Surface
+typedef SurfaceViewT<uint16_t> SurfaceView16u;
+//! 32-bit floating point view of a Surface
+typedef SurfaceViewT<float> SurfaceView32f;
+
 } // namespace cinder
@@ -0,0 +1,108 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Surface.h"
+#include "cinder/Thread.h"
+
+#include <map>
+#include <vector>
+
+namespace cinder {
+
+//! Recycles the pixel memory of Surfaces with matching dimensions, channel order and row bytes. \ImplShared
+/** A Surface returned by getSurface() hands its pixels back to the pool when its last reference is released rather than freeing them.
+	Surfaces may outlive the pool and may be released from any thread. Do not call setDeallocator() on a pooled Surface. **/
+template<typename T>
+class SurfacePoolT {
+ public:
+	//! Constructs an empty SurfacePool, which is the equivalent of NULL. getSurface() on a NULL pool allocates a regular Surface.
+	SurfacePoolT() {}
+	//! Constructs a pool which keeps at most \a maxFreePerFormat idle buffers for each combination of size, channel order and row bytes
+	explicit SurfacePoolT( size_t maxFreePerFormat );
+
+	//! Returns a Surface that is \a width x \a height with channel order \a channelOrder, reusing idle pool memory when available. Pixels are uninitialized.
+	SurfaceT<T>		getSurface( int32_t width, int32_t height, bool alpha, SurfaceChannelOrder channelOrder = SurfaceChannelOrder::UNSPECIFIED );
+	//! Returns a Surface that is \a width x \a height conforming to \a constraints, reusing idle pool memory when available. Pixels are uninitialized.
+	SurfaceT<T>		getSurface( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints );
+
+	//! Returns the number of idle buffers currently held by the pool
+	size_t			getNumFree() const;
+	//! Returns the maximum number of idle buffers kept for each format
+	size_t			getMaxFreePerFormat() const;
+	//! Sets the maximum number of idle buffers kept for each format. Excess idle buffers are freed immediately.
+	void			setMaxFreePerFormat( size_t maxFreePerFormat );
+	//! Frees all idle buffers. Surfaces still in use are unaffected and will return to the pool when released.
+	void			clear();
+
+ protected:
+	/// \cond
+	struct Key {
+		Key( int32_t width, int32_t height, int code, int32_t rowBytes ) : mWidth( width ), mHeight( height ), mCode( code ), mRowBytes( rowBytes ) {}
+		bool operator<( const Key &rhs ) const;
+
+		int32_t		mWidth, mHeight, mCode, mRowBytes;
+	};
+
+	struct Obj {
+		Obj( size_t maxFreePerFormat ) : mMaxFreePerFormat( maxFreePerFormat ) {}
+		~Obj();
+
+		void	trim();
+
+		mutable std::mutex				mMutex;
+		std::map<Key,std::vector<T*> >	mFree;
+		size_t							mMaxFreePerFormat;
+	};
+
+	struct Refcon {
+		Refcon( const std::shared_ptr<Obj> &pool, const Key &key ) : mPool( pool ), mKey( key ), mData( 0 ) {}
+
+		std::shared_ptr<Obj>	mPool;
+		Key						mKey;
+		T						*mData;
+	};
+	/// \endcond
+
+	SurfaceT<T>		getSurface( int32_t width, int32_t height, const SurfaceChannelOrder &channelOrder, int32_t rowBytes );
+	static void		surfaceDeallocator( void *refcon );
+
+	std::shared_ptr<Obj>		mObj;
+
+ public:
+	/// \cond
+	typedef std::shared_ptr<Obj> SurfacePoolT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &SurfacePoolT::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+};
+
+//! 8-bit Surface pool. Synonym for SurfacePool8u.
+typedef SurfacePoolT<uint8_t>	SurfacePool;
+//! 8-bit Surface pool
+typedef SurfacePoolT<uint8_t>	SurfacePool8u;
+//! 32-bit floating point Surface pool
+typedef SurfacePoolT<float>		SurfacePool32f;
+
+} // namespace cinder
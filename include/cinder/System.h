@@ -42,6 +42,8 @@ class System {
 	static bool			hasSse4_1();
 	//! Returns whether the system supports the SSE4.2 instruction set.	Inaccurate on MSW x64.		
 	static bool			hasSse4_2();
+	//! Returns whether the system supports the AVX instruction set, including operating system support for saving the AVX registers.
+	static bool			hasAvx();
 	//! Returns whether the system supports the x86-64 instruction set.	Inaccurate on MSW x64.
 	static bool			hasX86_64();
 	//! Returns whether the system supports the ARM instruction set.		
@@ -50,6 +52,10 @@ class System {
 	static int			getNumCpus();
 	//! Returns the number of cores (or logical processors) in the system. A single processor dual core machine returns 2. Inaccurate on MSW x64 and WinRT, where it returns the number of processors instead.
 	static int			getNumCores();
+	//! Returns the number of physical cores in the system, counting each core once regardless of how many logical processors (hyperthreads) it runs.
+	static int			getNumPhysicalCores();
+	//! Returns the indices of the logical processors of each physical core, as used by setThreadAffinity(). Where the mapping can't be queried, logical processors are assumed to be numbered consecutively within each core.
+	static const std::vector<std::vector<int> >&	getCoreTopology();
 	//! Returns the major version of the operating system.
 	//! For version \c 10.5.8, this is \c 10. For Windows Vista this is 6. Refer to the MSDN documentation for the \c OSVERSIONINFOEX struct for Windows meanings
 	static int			getOsMajorVersion();
@@ -72,6 +78,20 @@ class System {
 	static bool			isDeviceIpad();
 #endif
 	
+	//! Scheduling priorities for setThreadPriority()
+	enum ThreadPriority { PRIORITY_LOW, PRIORITY_NORMAL, PRIORITY_HIGH, PRIORITY_TIME_CRITICAL };
+
+	//! Sets the scheduling priority of the calling thread, reverting setThreadRealtime(). \c PRIORITY_TIME_CRITICAL should be reserved for threads that do little work on a deadline. Returns \c false if the OS refused the request. Not supported on WinRT.
+	static bool			setThreadPriority( ThreadPriority priority );
+	//! Schedules the calling thread for periodic real-time work, which wakes every \a periodSeconds and needs up to \a computationSeconds of CPU time each period.
+	//! Uses the time-constraint policy on OS X and iOS, and the Multimedia Class Scheduler Service's "Pro Audio" task on Windows (Vista and later), at critical priority if \a critical is \c true. Falls back to \c PRIORITY_TIME_CRITICAL where these are unavailable. Returns \c false if the OS refused the request.
+	static bool			setThreadRealtime( double periodSeconds, double computationSeconds, bool critical = false );
+	//! Restricts the calling thread to the logical processors \a logicalProcessors, as indexed by getCoreTopology(). An empty vector allows all of them.
+	//! OS X and iOS don't allow pinning threads, so there the set is only a hint that threads given the same set should share a cache. Returns \c false if unsupported or refused.
+	static bool			setThreadAffinity( const std::vector<int> &logicalProcessors );
+	//! Names the calling thread in debuggers and system profilers. Names longer than 63 characters are truncated on OS X and iOS.
+	static void			setThreadName( const std::string &name );
+
 	//! Represents a single Network Adapter of the system
 	class NetworkAdapter {
 	  public:
@@ -90,7 +110,7 @@ class System {
 	static std::string						getIpAddress();
 	
   private:
-	 enum {	HAS_SSE2, HAS_SSE3, HAS_SSE4_1, HAS_SSE4_2, HAS_X86_64, HAS_ARM, PHYSICAL_CPUS, LOGICAL_CPUS, OS_MAJOR, OS_MINOR, OS_BUGFIX, MULTI_TOUCH, MAX_MULTI_TOUCH_POINTS, 
+	 enum {	HAS_SSE2, HAS_SSE3, HAS_SSE4_1, HAS_SSE4_2, HAS_AVX, HAS_X86_64, HAS_ARM, PHYSICAL_CPUS, LOGICAL_CPUS, CORE_TOPOLOGY, OS_MAJOR, OS_MINOR, OS_BUGFIX, MULTI_TOUCH, MAX_MULTI_TOUCH_POINTS, 
 #if defined( CINDER_COCOA_TOUCH)	 
 			IS_IPHONE, IS_IPAD,
 #endif	 
@@ -101,8 +121,9 @@ class System {
 	static std::shared_ptr<System>		sInstance;
 
 	bool				mCachedValues[TOTAL_CACHE_TYPES];
-	bool				mHasSSE2, mHasSSE3, mHasSSE4_1, mHasSSE4_2, mHasX86_64, mHasArm;
+	bool				mHasSSE2, mHasSSE3, mHasSSE4_1, mHasSSE4_2, mHasAvx, mHasX86_64, mHasArm;
 	int					mPhysicalCPUs, mLogicalCPUs;
+	std::vector<std::vector<int> >	mCoreTopology;
 	int32_t				mOSMajorVersion, mOSMinorVersion, mOSBugFixVersion;
 	bool				mHasMultiTouch;
 	uint32_t			mMaxMultiTouchPoints;
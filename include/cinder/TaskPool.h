@@ -0,0 +1,151 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+#include "cinder/Area.h"
+#include "cinder/Vector.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class Task>		TaskRef;
+typedef std::shared_ptr<class TaskPool>	TaskPoolRef;
+
+//! \brief Represents a unit of work submitted to a TaskPool.
+//!
+//! A Task can be waited on and can have continuations, which are scheduled once it completes, either on the TaskPool or on the App's main thread.
+class Task : public std::enable_shared_from_this<Task>, private boost::noncopyable {
+  public:
+	//! Returns true if the Task's function has finished executing.
+	bool	isComplete() const	{ return mComplete; }
+	//! Blocks until the Task has completed. When called from one of the TaskPool's threads, other tasks are executed while waiting. Rethrows any exception thrown by the Task's function.
+	void	wait();
+
+	//! Schedules \a fn to be executed on the TaskPool once this Task completes (immediately if it already has). Returns the continuation Task.
+	TaskRef	then( const std::function<void ()> &fn );
+	//! Schedules \a fn to be executed on the App's main thread with App::dispatchAsync() once this Task completes, so that it is run after the next update(). If there is no App, \a fn is executed on the TaskPool.
+	void	thenOnMainThread( const std::function<void ()> &fn );
+
+  private:
+	Task( TaskPool *pool, const std::function<void ()> &fn );
+
+	void run();
+
+	TaskPool*							mPool;
+	std::function<void ()>				mFn;
+	std::atomic<bool>					mComplete;
+	std::exception_ptr					mException;
+	std::mutex							mMutex;
+	std::condition_variable				mCompleteCond;
+	std::vector<TaskRef>				mContinuations;		// guarded by mMutex
+	std::vector<std::function<void ()> >	mMainThreadContinuations;	// guarded by mMutex
+
+	friend class TaskPool;
+};
+
+//! \brief Work-stealing thread pool, meant to be shared by any subsystem that needs to do work in parallel.
+//!
+//! Each thread owns a queue of tasks. Tasks submitted from a TaskPool thread are pushed onto that thread's queue and popped in
+//! LIFO order, while idle threads steal the oldest tasks from the others. Tasks submitted from other threads are distributed from a shared queue.
+//! Use TaskPool::get() to access the process-wide pool rather than creating one per subsystem, so that cores aren't oversubscribed.
+class TaskPool : private boost::noncopyable {
+  public:
+	//! Creates a new TaskPool with \a numThreads threads. If \a numThreads is 0, one less than the number of hardware threads is used (minimum 1), since the calling thread participates in parallelFor().
+	static TaskPoolRef create( size_t numThreads = 0 );
+	//! Returns the process-wide TaskPool, which is created on first use with the default number of threads.
+	static TaskPool* get();
+
+	~TaskPool();
+
+	//! Returns the number of threads owned by this TaskPool.
+	size_t	getNumThreads() const		{ return mThreads.size(); }
+	//! Returns true if the current thread is one of this TaskPool's threads.
+	bool	isPoolThread() const;
+
+	//! Schedules \a fn to be executed on one of the pool's threads. Returns the Task, which can be used to wait on or add continuations.
+	TaskRef	submit( const std::function<void ()> &fn );
+
+	//! Schedules \a fn to be executed on one of the pool's threads and returns a std::future for its result.
+	template<typename R>
+	std::future<R>	async( const std::function<R ()> &fn );
+
+	//! \brief Executes \a fn over the range [\a begin, \a end) in parallel and returns once all of it has been processed.
+	//!
+	//! \a fn is called with sub-ranges [first, last) of at most \a grainSize elements. If \a grainSize is 0, a size is chosen that gives each thread several sub-ranges.
+	//! The calling thread processes sub-ranges as well. If \a fn throws, the first exception is rethrown once all other sub-ranges have finished.
+	void	parallelFor( size_t begin, size_t end, const std::function<void ( size_t, size_t )> &fn, size_t grainSize = 0 );
+	//! Executes \a fn in parallel over the tiles of \a area, which are of size \a tileSize (tiles at the right and bottom edges may be smaller). Returns once all tiles have been processed.
+	void	parallelFor( const Area &area, const Vec2i &tileSize, const std::function<void ( const Area & )> &fn );
+
+  private:
+	explicit TaskPool( size_t numThreads );
+
+	struct Worker {
+		std::deque<TaskRef>	mTasks;
+		std::mutex			mMutex;
+	};
+
+	static const size_t INVALID_WORKER;
+
+	void	schedule( const TaskRef &task );
+	void	dispatchToMainThread( const std::function<void ()> &fn );
+	bool	runNextTask( size_t workerIndex );
+	TaskRef	popTask( size_t workerIndex );
+	void	threadLoop( size_t workerIndex );
+	size_t	getCurrentWorkerIndex() const;
+
+	std::vector<std::thread>				mThreads;
+	std::vector<std::thread::id>			mThreadIds;
+	std::vector<std::unique_ptr<Worker> >	mWorkers;
+	std::deque<TaskRef>						mSharedTasks;		// tasks submitted from non-pool threads, guarded by mSharedMutex
+	std::mutex								mSharedMutex;
+
+	std::atomic<size_t>						mNumQueued, mNumSleeping;
+	std::mutex								mSleepMutex;
+	std::condition_variable					mSleepCond;
+	bool									mShouldQuit;	// guarded by mSleepMutex
+
+	friend class Task;
+};
+
+template<typename R>
+std::future<R> TaskPool::async( const std::function<R ()> &fn )
+{
+	auto task = std::make_shared<std::packaged_task<R ()> >( fn );
+	std::future<R> result = task->get_future();
+	submit( [task] { (*task)(); } );
+	return result;
+}
+
+} // namespace cinder
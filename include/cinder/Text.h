@@ -25,11 +25,14 @@
 #include "cinder/Cinder.h"
 
 #include "cinder/Surface.h"
+#include "cinder/SurfacePool.h"
 #include "cinder/Font.h"
+#include "cinder/FreeTypeFont.h"
 #include "cinder/Vector.h"
 
 #include <vector>
 #include <deque>
+#include <map>
 #include <string>
 
 // Core Text forward declarations
@@ -40,6 +43,8 @@ struct __CTLine;
 
 namespace cinder {
 
+class TaskPool;
+
 class TextLayout {
  public:
 	/*! \brief This is an abstract line
@@ -74,8 +79,8 @@ class TextLayout {
 	//! Adds a \a horizontal pixel border to the left and the right sides, and a \a vertical border to the top and bottom
 	void	setBorder( int horizontal, int vertical );
 
-	//! Returns a Surface into which the TextLayout is rendered. If \a useAlpha the Surface will contain an alpha channel. If \a premultiplied the alpha will be premulitplied.
-	Surface		render( bool useAlpha = false, bool premultiplied = false );
+	//! Returns a Surface into which the TextLayout is rendered. If \a useAlpha the Surface will contain an alpha channel. If \a premultiplied the alpha will be premulitplied. A non-NULL \a pool supplies the Surface's memory.
+	Surface		render( bool useAlpha = false, bool premultiplied = false, SurfacePool pool = SurfacePool() );
 	
  private:
 	ColorA	mBackgroundColor;
@@ -92,7 +97,8 @@ class TextBox {
 	typedef enum Alignment { LEFT, CENTER, RIGHT } Alignment;
 	enum { GROW = 0 };
 	
-	TextBox() : mAlign( LEFT ), mSize( GROW, GROW ), mFont( Font::getDefault() ), mInvalid( true ), mColor( 1, 1, 1, 1 ), mBackgroundColor( 0, 0, 0, 0 ), mPremultiplied( false ), mLigate( true ) {}
+	TextBox() : mAlign( LEFT ), mSize( GROW, GROW ), mFont( Font::getDefault() ), mInvalid( true ), mColor( 1, 1, 1, 1 ), mBackgroundColor( 0, 0, 0, 0 ), mPremultiplied( false ), mLigate( true ),
+		mRenderedAlign( LEFT ), mRenderedPremultiplied( false ), mRenderedLigate( true ), mLineBreakWidth( 0 ), mLineBreakLigate( true ) {}
 
 	TextBox&			size( Vec2i sz ) { setSize( sz ); return *this; }
 	TextBox&			size( int width, int height ) { setSize( Vec2i( width, height ) ); return *this; }
@@ -108,6 +114,13 @@ class TextBox {
 	const Font&			getFont() const { return mFont; }
 	void				setFont( const Font &f ) { mFont = f; mInvalid = true; }
 
+	/** Lays out and renders with \a font rather than getFont() in measure(), measureGlyphs() and render(), identically on every platform and without the platform's
+		text APIs. Lines are broken at newlines and, for a fixed width, at line break opportunities, but there are no ligatures or complex script shaping.
+		A null FreeTypeFont, the default, reverts to getFont(). renderIncremental() always uses getFont(). **/
+	TextBox&			freeTypeFont( const FreeTypeFont &font ) { setFreeTypeFont( font ); return *this; }
+	const FreeTypeFont&	getFreeTypeFont() const { return mFreeTypeFont; }
+	void				setFreeTypeFont( const FreeTypeFont &font ) { mFreeTypeFont = font; mInvalid = true; }
+
 	TextBox&			alignment( Alignment align ) { setAlignment( align ); return *this; }
 	Alignment			getAlignment() const { return mAlign; }
 	void				setAlignment( Alignment align ) { mAlign = align; mInvalid = true; }
@@ -134,18 +147,47 @@ class TextBox {
 	std::vector<std::pair<uint16_t,Vec2f> >	measureGlyphs() const;
 
 	Surface				render( Vec2f offset = Vec2f::zero() );
+	/** Renders into a Surface kept by the TextBox, re-rasterizing only the lines which changed since the previous call. Returns the Area of
+		getIncrementalSurface() which was redrawn, suitable for gl::Texture::update( surface, area ), or an empty Area when nothing changed.
+		Lines are wrapped to the box's width and stacked at the Font's line height. A GROW dimension only ever grows the Surface. Resizing the Surface
+		or changing the Font, colors, alignment or \a offset redraws it completely. **/
+	Area				renderIncremental( Vec2f offset = Vec2f::zero() );
+	//! Returns the Surface maintained by renderIncremental()
+	const Surface&		getIncrementalSurface() const { return mIncrementalSurface; }
 
   protected:
 	Alignment		mAlign;
 	Vec2i			mSize;
 	std::string		mText;
 	Font			mFont;
+	FreeTypeFont	mFreeTypeFont;
 	ColorA			mColor, mBackgroundColor;
 	bool			mPremultiplied;
 	bool			mLigate;
 	mutable bool	mInvalid;
 
 	mutable Vec2f	mCalculatedSize;
+
+	//! Returns the wrapped lines of \a paragraph, which contains no newlines, caching them for later calls
+	const std::vector<std::string>&	breakParagraph( const std::string &paragraph );
+	//! Returns the glyphs laid out with mFreeTypeFont and their left baselines, and sets \a size to the size of the text when it's non-NULL
+	std::vector<std::pair<uint16_t,Vec2f> >	layoutFreeType( Vec2f *size ) const;
+	Surface									renderFreeType( Vec2f offset ) const;
+
+	// the lines last drawn by renderIncremental(), along with the settings they were drawn with
+	Surface						mIncrementalSurface;
+	std::vector<std::string>	mRenderedLines;
+	Font						mRenderedFont;
+	ColorA						mRenderedColor, mRenderedBackgroundColor;
+	Alignment					mRenderedAlign;
+	Vec2i						mRenderedOffset;
+	bool						mRenderedPremultiplied, mRenderedLigate;
+	// wrapped lines per paragraph, valid for mLineBreakFont, mLineBreakWidth and mLineBreakLigate
+	std::map<std::string,std::vector<std::string> >	mLineBreaks;
+	Font						mLineBreakFont;
+	int							mLineBreakWidth;
+	bool						mLineBreakLigate;
+
 #if defined( CINDER_COCOA )
 	void			createLines() const;
 
@@ -170,4 +212,10 @@ Surface renderStringPow2( const std::string &str, const Font &font, const ColorA
 Surface renderString( const std::string &str, const Font &font, const ColorA &color, float *baselineOffset = 0 );
 #endif
 
+/** \brief Renders each of \a boxes into a Surface in parallel on the threads of \a taskPool, TaskPool::get() by default, and returns them in the same order.
+	More generally TextBox::render(), TextLayout::render() and renderString() may be called concurrently from any threads, provided that each TextBox
+	and TextLayout is used by a single thread at a time. On MSW every thread uses its own GDI device context and copies of the Fonts' GDI+ objects.
+	TextBoxes with a TextBox::freeTypeFont() don't use the platform's text APIs at all. **/
+std::vector<Surface> renderTextBoxes( const std::vector<TextBox> &boxes, TaskPool *taskPool = NULL );
+
 } // namespace cinder
@@ -0,0 +1,201 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Area.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+#include "cinder/ip/Resize.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace cinder {
+
+/** \brief An image of any size, stored as a grid of square tiles in a file which are mapped into memory on demand.
+ *
+ * The pixels live in the tile file rather than in one allocation, so the image is limited by disk space instead of memory or the
+ * \c int32_t row bytes of a Surface. A least-recently-used cache keeps up to Format::cacheSize() bytes of tiles mapped, and pixels written
+ * through a tile go straight to the file. Access regions with copyFrom() and copyTo(), or whole tiles with getTile(). All methods may be
+ * called from any thread, but writes to overlapping pixels must be synchronized by the caller. Not supported on WinRT.
+ * \code
+ * TiledSurfaceRef pano = TiledSurface::create( loadImage( "pano.tif" ) );
+ * Surface detail = pano->getSurface( Area( 40000, 12000, 41920, 13080 ) );
+ * writeDeepZoom( pano, getDocumentsDirectory() / "pano.dzi" );
+ * \endcode **/
+template<typename T>
+class TiledSurfaceT : private boost::noncopyable {
+  public:
+	class Format {
+	  public:
+		Format() : mTileSize( 512 ), mCacheSize( 256 * 1024 * 1024 ), mChannelOrder( SurfaceChannelOrder::UNSPECIFIED ) {}
+
+		//! Sets the width and height of the tiles in pixels. Default is \c 512.
+		Format&		tileSize( int32_t size ) { mTileSize = size; return *this; }
+		//! Sets how many bytes of tiles the cache keeps mapped. Default is 256MB.
+		Format&		cacheSize( size_t bytes ) { mCacheSize = bytes; return *this; }
+		//! Sets the channel order of the pixels. Default is \c UNSPECIFIED, which is RGBA or RGB.
+		Format&		channelOrder( const SurfaceChannelOrder &channelOrder ) { mChannelOrder = channelOrder; return *this; }
+		//! Sets the path of the tile file, which is kept so that it can be reopened with open(). By default tiles go to a temporary file, deleted along with the TiledSurface.
+		Format&		path( const fs::path &path ) { mPath = path; return *this; }
+
+		int32_t						getTileSize() const { return mTileSize; }
+		size_t						getCacheSize() const { return mCacheSize; }
+		const SurfaceChannelOrder&	getChannelOrder() const { return mChannelOrder; }
+		const fs::path&				getPath() const { return mPath; }
+
+	  private:
+		int32_t					mTileSize;
+		size_t					mCacheSize;
+		SurfaceChannelOrder		mChannelOrder;
+		fs::path				mPath;
+	};
+
+	//! Creates a TiledSurface that is \a width x \a height pixels, with its pixels initialized to zero. Throws TiledSurfaceExc if the tile file can't be created.
+	static std::shared_ptr<TiledSurfaceT>	create( int32_t width, int32_t height, bool alpha, const Format &format = Format() );
+	//! Creates a TiledSurface the size of \a imageSource and loads it one row at a time. Only the decoder's own buffers are held in memory. Throws TiledSurfaceExc if the tile file can't be created.
+	static std::shared_ptr<TiledSurfaceT>	create( ImageSourceRef imageSource, const Format &format = Format() );
+	//! Opens the tile file at \a path, written by a TiledSurface created with Format::path(). Throws TiledSurfaceExc if it can't be opened or holds a different pixel type.
+	static std::shared_ptr<TiledSurfaceT>	open( const fs::path &path, size_t cacheSize = 256 * 1024 * 1024 );
+
+	int32_t						getWidth() const { return mWidth; }
+	int32_t						getHeight() const { return mHeight; }
+	Vec2i						getSize() const { return Vec2i( mWidth, mHeight ); }
+	Area						getBounds() const { return Area( 0, 0, mWidth, mHeight ); }
+	bool						hasAlpha() const { return mChannelOrder.hasAlpha(); }
+	const SurfaceChannelOrder&	getChannelOrder() const { return mChannelOrder; }
+	//! Returns the path of the tile file
+	const fs::path&				getPath() const;
+
+	int32_t			getTileSize() const { return mTileSize; }
+	int32_t			getNumTilesX() const { return mNumTilesX; }
+	int32_t			getNumTilesY() const { return mNumTilesY; }
+	//! Returns the Area of the image covered by the tile at column \a tileX and row \a tileY. Tiles at the right and bottom edges may be smaller than getTileSize().
+	Area			getTileArea( int32_t tileX, int32_t tileY ) const;
+	//! Returns the tile at column \a tileX and row \a tileY as a Surface whose pixels are mapped from the tile file, so writes to it modify the TiledSurface. The tile stays mapped for as long as the Surface is alive, even once the cache has evicted it.
+	SurfaceT<T>		getTile( int32_t tileX, int32_t tileY ) const;
+
+	//! Copies the Area \a srcArea of \a srcSurface into the TiledSurface, offset by \a relativeOffset, converting the channel order as Surface::copyFrom() does. Tiles are copied in parallel.
+	void			copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset = Vec2i::zero() );
+	//! Copies the Area \a area of the TiledSurface into \a dstSurface, offset by \a relativeOffset. Tiles are copied in parallel.
+	void			copyTo( SurfaceT<T> *dstSurface, const Area &area, const Vec2i &relativeOffset = Vec2i::zero() ) const;
+	//! Returns a new Surface holding a copy of \a area, clipped to the bounds of the TiledSurface
+	SurfaceT<T>		getSurface( const Area &area ) const;
+	//! Returns an ImageTarget which ImageSource::load() can write an image the size of the TiledSurface into. Its rows are written out as they arrive.
+	ImageTargetRef	createImageTarget();
+
+	//! Writes modified pixels of the mapped tiles to the tile file
+	void			flush();
+
+	//! Returns the size in bytes of the tiles the cache keeps mapped
+	size_t			getCacheSize() const { return mCacheSize; }
+	//! Sets the size in bytes of the tiles the cache keeps mapped, evicting the least recently used tiles when it shrinks
+	void			setCacheSize( size_t bytes );
+
+  protected:
+	/// \cond
+	struct File;
+	struct Tile;
+	/// \endcond
+
+	TiledSurfaceT( const std::shared_ptr<File> &file, size_t cacheSize );
+
+	std::shared_ptr<Tile>	lockTile( int32_t tileX, int32_t tileY ) const;
+	void					evict() const;
+	static void				tileDeallocator( void *refcon );
+
+	std::shared_ptr<File>	mFile;
+	int32_t					mWidth, mHeight, mTileSize, mNumTilesX, mNumTilesY;
+	SurfaceChannelOrder		mChannelOrder;
+	size_t					mTileBytes, mCacheSize;
+
+	typedef std::list<std::pair<int64_t,std::shared_ptr<Tile> > >	TileList;
+	mutable std::mutex								mCacheMutex;
+	mutable TileList								mCachedTiles;	// most recently used first
+	mutable std::map<int64_t,typename TileList::iterator>	mCachedTileMap;
+};
+
+//! 8-bit tiled image. Synonym for TiledSurface8u.
+typedef TiledSurfaceT<uint8_t>				TiledSurface;
+typedef std::shared_ptr<TiledSurface>		TiledSurfaceRef;
+//! 8-bit tiled image
+typedef TiledSurfaceT<uint8_t>				TiledSurface8u;
+typedef std::shared_ptr<TiledSurface8u>		TiledSurface8uRef;
+//! 16-bit tiled image
+typedef TiledSurfaceT<uint16_t>				TiledSurface16u;
+typedef std::shared_ptr<TiledSurface16u>	TiledSurface16uRef;
+//! 32-bit floating point tiled image
+typedef TiledSurfaceT<float>				TiledSurface32f;
+typedef std::shared_ptr<TiledSurface32f>	TiledSurface32fRef;
+
+//! Returns the levels of an image pyramid for \a surface, halving its size from one level to the next until both sides are at most \a minSize. The first level is \a surface itself, the others are backed by temporary tile files.
+template<typename T>
+std::vector<std::shared_ptr<TiledSurfaceT<T> > >	buildPyramid( const std::shared_ptr<TiledSurfaceT<T> > &surface, int32_t minSize = 1, const FilterBase &filter = FilterTriangle() );
+
+//! Options for writeDeepZoom()
+class DeepZoomFormat {
+  public:
+	DeepZoomFormat() : mTileSize( 254 ), mOverlap( 1 ), mExtension( "jpg" ) {}
+
+	//! Sets the size of the tiles without their overlap. Default is \c 254.
+	DeepZoomFormat&		tileSize( int32_t size ) { mTileSize = size; return *this; }
+	//! Sets how many pixels each tile shares with its neighbors. Default is \c 1.
+	DeepZoomFormat&		overlap( int32_t overlap ) { mOverlap = overlap; return *this; }
+	//! Sets the file extension, and with it the image format, of the tiles. Default is \c "jpg".
+	DeepZoomFormat&		extension( const std::string &extension ) { mExtension = extension; return *this; }
+	//! Sets the ImageTarget::Options used to write the tiles
+	DeepZoomFormat&		options( const ImageTarget::Options &options ) { mOptions = options; return *this; }
+
+	int32_t							getTileSize() const { return mTileSize; }
+	int32_t							getOverlap() const { return mOverlap; }
+	const std::string&				getExtension() const { return mExtension; }
+	const ImageTarget::Options&		getOptions() const { return mOptions; }
+
+  private:
+	int32_t					mTileSize, mOverlap;
+	std::string				mExtension;
+	ImageTarget::Options	mOptions;
+};
+
+//! Writes \a surface as a Deep Zoom image for zoomable display, such as with OpenSeadragon: the descriptor at \a dziPath and the pyramid's tiles in a directory beside it, named after it with a \c _files suffix
+template<typename T>
+void writeDeepZoom( const std::shared_ptr<TiledSurfaceT<T> > &surface, const fs::path &dziPath, const DeepZoomFormat &format = DeepZoomFormat() );
+
+class TiledSurfaceExc : public Exception {
+  public:
+	TiledSurfaceExc( const std::string &message ) throw() : mMessage( message ) {}
+	virtual ~TiledSurfaceExc() throw() {}
+	virtual const char* what() const throw() { return mMessage.c_str(); }
+
+  private:
+	std::string		mMessage;
+};
+
+} // namespace cinder
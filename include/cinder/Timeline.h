@@ -182,6 +182,24 @@ class Timeline : public TimelineItem {
 	//! Returns the default \a autoRemove value for all future TimelineItems added to the Timeline
 	bool	getDefaultAutoRemove() const { return mDefaultAutoRemove; }
 
+	/** \brief Sets whether the Timeline steps only its active items rather than all of them. Default is \c false.
+	 *
+	 * Scheduled Timelines keep items that haven't started in a queue ordered by start time and the items in progress in contiguous storage, so that
+	 * advancing time costs in proportion to the number of active items. Auto-removed items are erased as soon as they complete. Unlike an unscheduled
+	 * Timeline, completed items that aren't auto-removed are no longer updated while time advances. Stepping backwards evaluates every item. **/
+	void	setScheduled( bool scheduled = true );
+	//! Returns whether the Timeline steps only its active items. Default is \c false.
+	bool	isScheduled() const { return mScheduled; }
+
+	/** \brief Sets whether a scheduled Timeline evaluates its tweens in progress together with a TweenBatch. Default is \c false.
+	 *
+	 * Once started, a tween of a float, Vec2f, Vec3f, Vec4f, Color or ColorA value that uses the default LerpFn, has no UpdateFn, neither loops nor ping-pongs
+	 * and is the only active item on its target is stepped by the batch until it reaches its end time, when it's completed as usual. Batched tweens are
+	 * updated after the items without a target, such as Cues. Has no effect unless the Timeline is scheduled (setScheduled()). **/
+	void	setBatched( bool batched = true );
+	//! Returns whether a scheduled Timeline evaluates its tweens in progress together with a TweenBatch. Default is \c false.
+	bool	isBatched() const { return mBatched; }
+
 	//! Call this to notify the Timeline if the \a item's start-time or duration has changed. Advanced use cases only.
 	void	itemTimeChanged( TimelineItem *item );
 
@@ -210,14 +228,63 @@ class Timeline : public TimelineItem {
 	void						eraseMarked();
 	virtual float				calcDuration() const;
 
+	//! Adds \a item to mItems, recording its position so it can be erased directly
+	void						insertItem( const TimelineItemRef &item );
+	void						eraseItem( TimelineItem *item );
+	//! Marks \a item for removal, erasing it immediately when the Timeline is scheduled and not iterating mItems
+	void						removeItem( TimelineItem *item );
+
+	//! Queues \a item with a scheduled Timeline, as pending or active depending on its start time
+	void						scheduleItem( const TimelineItemRef &item );
+	void						pushPending( const TimelineItemRef &item );
+	//! Adds \a item to the active items, in this step if it comes after the item currently being stepped and otherwise in the next
+	void						activateItem( const TimelineItemRef &item );
+	void						mergeActivated();
+	static bool					itemOrder( const TimelineItemRef &lhs, const TimelineItemRef &rhs );
+	static bool					itemBefore( const TimelineItem *lhs, const TimelineItem *rhs );
+	void						unscheduleAll();
+	void						rebuildSchedule();
+	void						stepScheduled();
+	//! Returns \a item from the TweenBatch to being stepped individually
+	void						unbatchItem( TimelineItem *item );
+	void						unbatchTarget( void *target );
+	//! Returns whether no item other than \a item is active on its target
+	bool						isSoleActiveItem( const TimelineItem *item ) const;
+
+	struct PendingItem {
+		PendingItem( float startTime, uint64_t sequence, const TimelineItemRef &item )
+			: mStartTime( startTime ), mSequence( sequence ), mItem( item )
+		{}
+
+		// orders the heap so that its front is the earliest start, ties going to the first scheduled
+		bool operator<( const PendingItem &rhs ) const { return ( mStartTime > rhs.mStartTime ) || ( ( mStartTime == rhs.mStartTime ) && ( mSequence > rhs.mSequence ) ); }
+
+		float				mStartTime;
+		uint64_t			mSequence;
+		TimelineItemRef		mItem;
+	};
+
 	bool						mDefaultAutoRemove;
 	float						mCurrentTime;
 	
 	std::multimap<void*,TimelineItemRef>		mItems;
+
+	bool						mScheduled, mScheduleDirty, mBatched;
+	bool						mSteppingItems;		// true while mItems is iterated, which defers erasing
+	bool						mNeedsEraseScan;	// items have been marked for removal without being erased
+	float						mScheduleTime;		// the time a scheduled Timeline was last stepped to
+	uint64_t					mScheduleSequence, mInsertSequence;
+	TimelineItem				*mSteppingItem;		// the active item being stepped
+	std::vector<TimelineItemRef>	mActive;			// ordered by itemOrder()
+	std::vector<TimelineItemRef>	mActivated;			// activated since the last step
+	std::vector<PendingItem>		mPending;		// a heap ordered by start time
+	TweenBatch					mTweenBatch;		// active items that are stepped together
 	
   private:
 	Timeline( const Timeline &rhs ); // private to prevent copying; use clone() method instead
 	Timeline& operator=( const Timeline &rhs ); // not defined to prevent copying
+
+	friend class TimelineItem;
 };
 
 class Cue : public TimelineItem {
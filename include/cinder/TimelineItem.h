@@ -26,10 +26,14 @@
 
 #include "cinder/Cinder.h"
 
+#include <map>
+
 namespace cinder
 {
 typedef std::shared_ptr<class TimelineItem>	TimelineItemRef;
 
+class TweenBatch;
+
 //! Base interface for anything that can go on a Timeline
 class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 {
@@ -54,17 +58,17 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	//! Returns whether the item starts over when it is complete
 	bool			getLoop() const { return mLoop; }
 	//! Sets whether the item starts over when it is complete
-	void			setLoop( bool doLoop = true ) { mLoop = doLoop; }
+	void			setLoop( bool doLoop = true ) { mLoop = doLoop; unbatch(); }
 
 	//! Returns whether the item alternates between forward and reverse. Overrides loop when true.
 	bool			getPingPong() const { return mPingPong; }
 	//! Sets whether the item alternates between forward and reverse. Overrides loop when true.
-	void			setPingPong( bool pingPong = true ) { mPingPong = pingPong; }
+	void			setPingPong( bool pingPong = true ) { mPingPong = pingPong; unbatch(); }
 
 	//! Returns whether the item ever is marked as complete
 	bool			getInfinite() const { return mLoop; }
 	//! Sets whether the item ever is marked as complete
-	void			setInfinite( bool infinite = true ) { mInfinite = infinite; }
+	void			setInfinite( bool infinite = true ) { mInfinite = infinite; unbatch(); }
 
 	//! Returns the time of the item's competion, equivalent to getStartTime() + getDuration().
 	float			getEndTime() const { return mStartTime + getDuration(); }
@@ -74,7 +78,7 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	//! Removes the item from its parent Timeline
 	void removeSelf();
 	//! Marks the item as not completed, and if \a unsetStarted, marks the item as not started
-	virtual void reset( bool unsetStarted = false ) { if( unsetStarted ) mHasStarted = false; mComplete = false; }
+	virtual void reset( bool unsetStarted = false ) { if( unsetStarted ) mHasStarted = false; mComplete = false; unbatch(); }
 	
 	//! Returns whether the item has started
 	bool hasStarted() const { return mHasStarted; }			
@@ -94,6 +98,10 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	virtual bool 	updateAtLoopStart() { return false; }
 	virtual float	calcDuration() const { return mDuration; }
 	virtual void	reverse() = 0;
+	//! Returns whether the item can be stepped by a TweenBatch until it reaches its end time, as some started tweens can
+	virtual bool	canBatch() const { return false; }
+	//! Adds the item to \a batch. Only called when canBatch() returns \c true.
+	virtual void	addToBatch( TweenBatch *batch ) {}
 	//! Creates a clone of the item
 	virtual TimelineItemRef		clone() const = 0;
 	//! Creates a cloned item which runs in reverse relative to a timeline of duration \a timelineDuration
@@ -108,7 +116,10 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	void	updateDuration() const;
 	//! Converts time from absolute to absolute based on item's looping attributes
 	float	loopTime( float absTime );
-	void	setTarget( void *target ) { mTarget = target; }
+	void	setTarget( void *target ) { mTarget = target; unbatch(); }
+	//! Returns the item to being stepped individually if it's held by its parent's TweenBatch, as required when it's modified
+	void	unbatch() { if( mSlot.mBatchGroup >= 0 ) unbatchFromParent(); }
+	void	unbatchFromParent();
 
 	class Timeline	*mParent;
 
@@ -122,8 +133,25 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	bool	mUseAbsoluteTime;
 	bool	mAutoRemove;
 	int32_t	mLastLoopIteration;
+
+	// The parent Timeline's bookkeeping for the item, which isn't carried over to copies
+	struct TimelineSlot {
+		TimelineSlot() : mInItems( false ), mIsScheduled( false ), mInsertSequence( 0 ), mPendingSequence( 0 ), mBatchGroup( -1 ), mBatchIndex( 0 ) {}
+		TimelineSlot( const TimelineSlot &rhs ) : mInItems( false ), mIsScheduled( false ), mInsertSequence( 0 ), mPendingSequence( 0 ), mBatchGroup( -1 ), mBatchIndex( 0 ) {}
+		TimelineSlot&	operator=( const TimelineSlot &rhs ) { return *this; }
+
+		std::multimap<void*,TimelineItemRef>::iterator	mItemsIt;			// valid while mInItems
+		bool											mInItems;
+		bool											mIsScheduled;		// held as pending or active by a scheduled Timeline
+		uint64_t										mInsertSequence;	// orders items with the same target as in the parent's items
+		uint64_t										mPendingSequence;	// identifies the item's current entry in the pending queue, 0 when active
+		int32_t											mBatchGroup;		// the item's group in the parent's TweenBatch, or -1 when it isn't batched
+		uint32_t										mBatchIndex;		// the item's index within mBatchGroup
+	};
+	TimelineSlot	mSlot;
 	
 	friend class Timeline;
+	friend class TweenBatch;
   private:
 	mutable float	mDuration, mInvDuration;
 	mutable bool	mDirtyDuration; // marked if the virtual calcDuration() needs to be calculated
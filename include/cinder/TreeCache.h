@@ -0,0 +1,236 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Buffer.h"
+#include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Exception.h"
+#include "cinder/Json.h"
+#include "cinder/Xml.h"
+
+#include <functional>
+#include <string>
+
+namespace cinder {
+
+namespace svg {
+	class Doc;
+}
+
+typedef std::shared_ptr<class BinaryTree>	BinaryTreeRef;
+
+/** \brief Read-only XmlTree or JsonTree stored in a compact binary file, which is memory mapped and queried in place.
+	Nodes are stored breadth-first in a table of fixed size records so that the children of each node are contiguous, and every tag, key,
+	value and attribute is an index into a table of unique strings. Opening a file only validates its header, and Node handles read
+	the mapping directly, so neither text parsing nor building a tree of objects is needed. Use TreeCache to maintain files automatically.
+	<br><tt>BinaryTreeRef tree = BinaryTree::create( "layout.citree" ); float w = tree->getRoot().getChild( "svg" ).getAttributeValue<float>( "width" );</tt> **/
+class BinaryTree : private boost::noncopyable {
+  public:
+	//! The kind of tree a BinaryTree was written from.
+	enum SourceType { SOURCE_XML, SOURCE_JSON };
+
+	/** \brief Handle to a node of a BinaryTree. Tags, values and attribute values point into the tree's storage and are null terminated.
+		A Node doesn't keep its tree alive. **/
+	class Node {
+	  public:
+		//! Constructs an invalid Node.
+		Node() : mTree( 0 ), mRecord( 0 ) {}
+
+		//! Returns whether the Node refers to a node of a tree.
+		bool			isValid() const { return mTree != 0; }
+
+		//! Returns the type of the node, which must be from a tree of SOURCE_XML.
+		XmlTree::NodeType	getXmlNodeType() const;
+		//! Returns the type of the node, which must be from a tree of SOURCE_JSON.
+		JsonTree::NodeType	getJsonNodeType() const;
+
+		//! Returns the tag of an XML node or the key of a JSON node.
+		const char*		getName() const;
+		//! Returns the length of getName().
+		size_t			getNameSize() const;
+		//! Returns the value of the node, as XmlTree::getValue() or JsonTree::getValue() would.
+		const char*		getValue() const;
+		//! Returns the length of getValue().
+		size_t			getValueSize() const;
+		//! Returns the value of the node parsed as a T using fromString(), without copying it first.
+		template<typename T>
+		T				getValue() const { return fromString<T>( getValue(), getValueSize() ); }
+		//! Returns the value of the node parsed as a T. If the value fails to parse \a defaultValue is returned.
+		template<typename T>
+		T				getValue( const T &defaultValue ) const { try { return getValue<T>(); } catch( ... ) { return defaultValue; } }
+
+		//! Returns whether this node has a parent node.
+		bool			hasParent() const;
+		//! Returns the parent of this node, which is invalid for the root.
+		Node			getParent() const;
+
+		//! Returns the number of children of this node.
+		size_t			getNumChildren() const;
+		//! Returns the child at \a index, which must be less than getNumChildren().
+		Node			getChild( size_t index ) const;
+		//! Returns whether a descendant matches \a relativePath. Components of the path which are numbers select the children of JSON arrays by index.
+		bool			hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const { return findChild( relativePath, caseSensitive, separator ).isValid(); }
+		//! Returns the first descendant that matches \a relativePath. Throws BinaryTreeExc if none matches.
+		Node			getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns the first child named \a childName. Throws BinaryTreeExc if none matches.
+		Node			operator/( const std::string &childName ) const { return getChild( childName ); }
+
+		//! Returns the number of attributes of this node. JSON nodes have none.
+		size_t			getNumAttributes() const;
+		//! Returns the name of the attribute at \a index, which must be less than getNumAttributes().
+		const char*		getAttributeName( size_t index ) const;
+		//! Returns the value of the attribute at \a index, which must be less than getNumAttributes().
+		const char*		getAttributeValue( size_t index ) const;
+		//! Returns whether the node has an attribute named \a attrName.
+		bool			hasAttribute( const std::string &attrName ) const { return findAttribute( attrName ) != 0; }
+		//! Returns the value of the attribute \a attrName parsed as a T. Throws BinaryTreeExc if no attribute exists with that name.
+		template<typename T>
+		T				getAttributeValue( const std::string &attrName ) const { const char *value = getAttributeValueChecked( attrName ); return fromString<T>( value, strlen( value ) ); }
+		//! Returns the value of the attribute \a attrName parsed as a T. Returns \a defaultValue if no attribute exists with that name or it fails to parse.
+		template<typename T>
+		T				getAttributeValue( const std::string &attrName, const T &defaultValue ) const {
+			const char *value = findAttribute( attrName );
+			if( ! value )
+				return defaultValue;
+			try {
+				return fromString<T>( value, strlen( value ) );
+			}
+			catch( ... ) {
+				return defaultValue;
+			}
+		}
+
+		//! Returns a path to this node, separated by the character \a separator.
+		std::string		getPath( char separator = '/' ) const;
+
+		//! Returns a mutable XmlTree copy of this node and its descendants. Throws BinaryTreeExc if the tree isn't SOURCE_XML.
+		XmlTree			toXmlTree() const;
+		//! Returns a mutable JsonTree copy of this node and its descendants. Throws BinaryTreeExc if the tree isn't SOURCE_JSON.
+		JsonTree		toJsonTree() const;
+
+		bool	operator==( const Node &rhs ) const { return mRecord == rhs.mRecord; }
+		bool	operator!=( const Node &rhs ) const { return mRecord != rhs.mRecord; }
+
+	  private:
+		//! \cond
+		Node( const BinaryTree *tree, const void *record ) : mTree( tree ), mRecord( record ) {}
+
+		Node			findChild( const std::string &relativePath, bool caseSensitive, char separator ) const;
+		const char*		findAttribute( const std::string &attrName ) const;
+		const char*		getAttributeValueChecked( const std::string &attrName ) const;
+
+		const BinaryTree	*mTree;
+		const void			*mRecord;
+
+		friend class BinaryTree;
+		//! \endcond
+	};
+
+	//! Maps the file at \a path and validates its header. Throws BinaryTreeExc if the file can't be mapped or isn't a valid BinaryTree.
+	static BinaryTreeRef	create( const fs::path &path );
+	//! Creates a BinaryTree which reads \a buffer in place, which must hold the contents of a BinaryTree file. Throws BinaryTreeExc if it isn't valid.
+	static BinaryTreeRef	create( const Buffer &buffer );
+
+	//! Writes \a xml and its descendants to \a target. \a sourceHash is stored for getSourceHash(). Throws BinaryTreeExc on failure.
+	static void		write( const DataTargetRef &target, const XmlTree &xml, uint64_t sourceHash = 0 );
+	//! Writes \a json and its descendants to \a target. \a sourceHash is stored for getSourceHash(). Throws BinaryTreeExc on failure.
+	static void		write( const DataTargetRef &target, const JsonTree &json, uint64_t sourceHash = 0 );
+	//! Returns the contents of a BinaryTree file of \a xml and its descendants.
+	static Buffer	encode( const XmlTree &xml, uint64_t sourceHash = 0 );
+	//! Returns the contents of a BinaryTree file of \a json and its descendants.
+	static Buffer	encode( const JsonTree &json, uint64_t sourceHash = 0 );
+
+	//! Returns the root node, which is the node the tree was written from.
+	Node			getRoot() const;
+	//! Returns the kind of tree this was written from.
+	SourceType		getSourceType() const { return mSourceType; }
+	//! Returns the hash passed to write() or encode(), which TreeCache uses to detect changes to the source.
+	uint64_t		getSourceHash() const { return mSourceHash; }
+	//! Returns the DOCTYPE of the XML document the tree was written from, if any.
+	const char*		getDocType() const;
+	//! Returns the number of nodes in the tree.
+	size_t			getNumNodes() const { return mNumNodes; }
+	//! Returns the number of unique strings in the tree's string table.
+	size_t			getNumStrings() const { return mNumStrings; }
+
+  protected:
+	BinaryTree( const Buffer &buffer );
+
+	const char*		getString( uint32_t index ) const;
+	size_t			getStringSize( uint32_t index ) const;
+	void			copyNode( const Node &node, XmlTree *result ) const;
+	void			copyNode( const Node &node, JsonTree *result ) const;
+
+	Buffer			mBuffer;
+	SourceType		mSourceType;
+	uint64_t		mSourceHash;
+	uint32_t		mDocType;
+	size_t			mNumNodes, mNumAttributes, mNumStrings;
+	const uint8_t	*mNodes, *mAttributes;
+	const uint32_t	*mStringOffsets;
+	const char		*mStrings;
+};
+
+/** \brief Loads XML, JSON and SVG documents through BinaryTree files kept in a cache directory.
+	Each source is read and hashed on every load, and only parsed when its cache file is missing or was written from different contents or
+	parse options, in which case the cache file is rewritten. Hashing is far cheaper than parsing, so repeated launches skip the text parsing entirely.
+	If the cache directory can't be written the tree is encoded in memory instead.
+	<br><tt>TreeCache cache( getDocumentsDirectory() / "cache" ); JsonTree settings = cache.loadJsonTree( loadAsset( "settings.json" ) );</tt> **/
+class TreeCache {
+  public:
+	//! Creates a cache storing its files in \a cacheDirectory, which is created if it doesn't exist.
+	explicit TreeCache( const fs::path &cacheDirectory );
+
+	//! Returns the BinaryTree of the XML in \a source parsed with \a parseOptions, rebuilding its cache file if needed. Throws on parse errors as XmlTree does.
+	BinaryTreeRef	loadXml( const DataSourceRef &source, const XmlTree::ParseOptions &parseOptions = XmlTree::ParseOptions() );
+	//! Returns the BinaryTree of the JSON in \a source parsed with \a parseOptions, rebuilding its cache file if needed. Throws on parse errors as JsonTree does.
+	BinaryTreeRef	loadJson( const DataSourceRef &source, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() );
+	//! Returns an XmlTree of the XML in \a source, built from its cache file.
+	XmlTree			loadXmlTree( const DataSourceRef &source, const XmlTree::ParseOptions &parseOptions = XmlTree::ParseOptions() ) { return loadXml( source, parseOptions )->getRoot().toXmlTree(); }
+	//! Returns a JsonTree of the JSON in \a source, built from its cache file.
+	JsonTree		loadJsonTree( const DataSourceRef &source, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() ) { return loadJson( source, parseOptions )->getRoot().toJsonTree(); }
+	//! Returns an svg::Doc of the SVG in \a source, built from its cache file.
+	std::shared_ptr<svg::Doc>	loadSvg( const DataSourceRef &source );
+
+	//! Returns the directory cache files are stored in.
+	const fs::path&	getCacheDirectory() const { return mCacheDirectory; }
+
+  private:
+	BinaryTreeRef	load( const DataSourceRef &source, BinaryTree::SourceType type, uint32_t options, const std::function<Buffer( const DataSourceRef &, uint64_t )> &encode );
+
+	fs::path		mCacheDirectory;
+};
+
+class BinaryTreeExc : public cinder::Exception {
+  public:
+	BinaryTreeExc( const std::string &description ) throw();
+	virtual const char* what() const throw() { return mMessage; }
+
+  private:
+	char mMessage[1024];
+};
+
+} // namespace cinder
@@ -32,6 +32,8 @@
 #include "cinder/Rect.h"
 
 namespace cinder {
+
+class TaskPool;
 	
 	/*! \brief The TriMesh allows you to create a series of vertices linked into a mesh.
 	 
@@ -72,6 +74,7 @@ class TriMesh {
 	bool		hasColorsRGB() const { return ! mColorsRGB.empty(); }
 	bool		hasColorsRGBA() const { return ! mColorsRGBA.empty(); }
 	bool		hasTexCoords() const { return ! mTexCoords.empty(); }
+	bool		hasTangents() const { return ! mTangents.empty(); }
 
 	/*! Creates a vertex which can be referred to with appendTriangle() or appendIndices() */
 	void		appendVertex( const Vec3f &v ) { mVertices.push_back( v ); }
@@ -125,6 +128,10 @@ class TriMesh {
 	std::vector<Vec3f>&				getNormals() { return mNormals; }
 	//! Returns all the normals for a mesh in a std::vector as Vec3f objects. There will be one of these for each triangle face in the mesh
 	const std::vector<Vec3f>&		getNormals() const { return mNormals; }
+	//! Returns the per-vertex tangents calculated by recalculateTangents(), which point along increasing texture coordinate u
+	std::vector<Vec3f>&				getTangents() { return mTangents; }
+	//! Returns the per-vertex tangents calculated by recalculateTangents(), which point along increasing texture coordinate u
+	const std::vector<Vec3f>&		getTangents() const { return mTangents; }
 	//! Returns a std::vector of RGB colors of the triangles faces. There will be one of these for each triangle face in the mesh
 	std::vector<Color>&				getColorsRGB() { return mColorsRGB; }
 	//! Returns a std::vector of RGB colors of the triangles faces. There will be one of these for each triangle face in the mesh
@@ -147,17 +154,36 @@ class TriMesh {
 	//! Calculates the bounding box of all vertices as transformed by \a transform
 	AxisAlignedBox3f	calcBoundingBox( const Matrix44f &transform ) const;
 
-	//! This reads a TriMesh in from a data file that was serialized using the write() function.
+	//! \brief Reorders triangles and vertices for faster rendering without changing the geometry.
+	//!
+	//! Triangles are ordered for a post-transform vertex cache of \a cacheSize entries with Tipsify (Sander et al., 2007). When \a reduceOverdraw
+	//! is \c true the resulting clusters are then sorted so that outward-facing parts of the surface tend to be drawn first. Finally vertices are
+	//! renumbered in order of first use, improving vertex fetch locality; unreferenced vertices move to the end.
+	void		optimize( size_t cacheSize = 16, bool reduceOverdraw = true );
+	//! Returns the average number of post-transform vertex cache misses per triangle (ACMR) for a FIFO cache of \a cacheSize entries. Ranges from 0.5 for ideal meshes to 3.
+	float		calcCacheMissRatio( size_t cacheSize = 16 ) const;
+
+	//! Transforms the vertices by the affine \a transform, and any normals by its inverse transpose, renormalizing them
+	void		transform( const Matrix44f &transform );
+
+	//! This reads a TriMesh in from a data file that was serialized using the write() function. Each attribute is copied in bulk, and large files are memory mapped by DataSourcePath. Throws StreamExc if the data is truncated or of an unknown version.
 	void		read( DataSourceRef in );
-	//! This writes a TriMesh to a proprietary file format to be read using the read() function.
-	void		write( DataTargetRef out ) const;
+	//! This writes a TriMesh to a proprietary file format to be read using the read() function. Attributes are written as 16-byte aligned arrays, zlib compressed when \a compressed is \c true.
+	void		write( DataTargetRef out, bool compressed = false ) const;
 
-	//! Adds or replaces normals by calculating them from the vertices and faces.
-	void		recalculateNormals();
+	//! Adds or replaces normals by calculating them from the vertices and faces. Large meshes are processed in parallel when \a taskPool is non-NULL.
+	void		recalculateNormals( TaskPool *taskPool = NULL );
+	//! Recalculates only the normals of the vertices of the \a numTriangles triangles listed in \a dirtyTriangles. Matches recalculateNormals() exactly when \a dirtyTriangles lists every triangle with a moved vertex.
+	void		recalculateNormals( const uint32_t *dirtyTriangles, size_t numTriangles );
+	//! Adds or replaces per-vertex tangents by calculating them from the vertices, texture coordinates and faces, orthogonalized against the normals if present. Large meshes are processed in parallel when \a taskPool is non-NULL.
+	void		recalculateTangents( TaskPool *taskPool = NULL );
+	//! Recalculates only the tangents of the vertices of the \a numTriangles triangles listed in \a dirtyTriangles
+	void		recalculateTangents( const uint32_t *dirtyTriangles, size_t numTriangles );
 	
  private:
 	std::vector<Vec3f>		mVertices;
 	std::vector<Vec3f>		mNormals;
+	std::vector<Vec3f>		mTangents;
 	std::vector<Color>		mColorsRGB;
 	std::vector<ColorA>		mColorsRGBA;
 	std::vector<Vec2f>		mTexCoords;
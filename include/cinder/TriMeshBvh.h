@@ -0,0 +1,105 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Ray.h"
+#include "cinder/AxisAlignedBox.h"
+
+#include <vector>
+#include <cfloat>
+#include <boost/noncopyable.hpp>
+
+namespace cinder {
+
+class TaskPool;
+
+typedef std::shared_ptr<class TriMeshBvh>	TriMeshBvhRef;
+
+//! Bounding volume hierarchy over the triangles of a TriMesh, for fast ray picking. Built with a binned surface area heuristic into a flat node array. The triangles are copied, so the TriMesh need not outlive the TriMeshBvh.
+class TriMeshBvh : private boost::noncopyable {
+  public:
+	//! Describes the nearest intersection found by a ray query
+	struct Hit {
+		Hit() : mTriangle( INVALID_TRIANGLE ), mDistance( 0 ), mU( 0 ), mV( 0 ) {}
+
+		//! Returns whether the query hit anything
+		bool		isValid() const { return mTriangle != INVALID_TRIANGLE; }
+		//! Index of the triangle in the source TriMesh, suitable for TriMesh::getTriangleVertices()
+		uint32_t	getTriangle() const { return mTriangle; }
+		//! Ray parameter of the intersection, so the point is Ray::calcPosition( getDistance() )
+		float		getDistance() const { return mDistance; }
+		//! Barycentric coordinates of the intersection, weighting the triangle's second and third vertices
+		Vec2f		getBarycentric() const { return Vec2f( mU, mV ); }
+
+		uint32_t	mTriangle;
+		float		mDistance, mU, mV;
+	};
+
+	//! Builds a TriMeshBvh from \a mesh. If \a taskPool is non-NULL the subtrees of large meshes are built in parallel on its threads.
+	static TriMeshBvhRef	create( const TriMesh &mesh, TaskPool *taskPool = NULL ) { return TriMeshBvhRef( new TriMeshBvh( mesh, taskPool ) ); }
+
+	//! Finds the nearest triangle intersected by \a ray with a distance in <tt>[minDistance, maxDistance]</tt>. Returns \c false if there is none.
+	bool		intersect( const Ray &ray, Hit *result, float minDistance = 0, float maxDistance = FLT_MAX ) const;
+	//! Returns whether \a ray intersects any triangle with a distance in <tt>[minDistance, maxDistance]</tt>, stopping at the first found. Faster than intersect() for occlusion tests.
+	bool		intersectsAny( const Ray &ray, float minDistance = 0, float maxDistance = FLT_MAX ) const;
+	//! Finds the nearest intersection for each of \a numRays \a rays, storing them in \a results. If \a taskPool is non-NULL the rays are divided among its threads.
+	void		intersect( const Ray *rays, size_t numRays, Hit *results, TaskPool *taskPool = NULL, float minDistance = 0, float maxDistance = FLT_MAX ) const;
+
+	//! Returns the bounding box of the whole mesh
+	AxisAlignedBox3f	getBounds() const;
+	size_t				getNumTriangles() const { return mTriangles.size(); }
+	size_t				getNumNodes() const { return mNodes.size(); }
+
+	static const uint32_t	INVALID_TRIANGLE = 0xFFFFFFFF;
+
+  protected:
+	TriMeshBvh( const TriMesh &mesh, TaskPool *taskPool );
+
+	//! 32 bytes. An interior node's children are adjacent at mFirst and mFirst + 1; a leaf holds mCount triangles starting at mFirst.
+	struct Node {
+		Vec3f		mMin;
+		uint32_t	mFirst;
+		Vec3f		mMax;
+		uint32_t	mCount;
+	};
+
+	//! Stored as a vertex and two edges for the intersection test
+	struct Triangle {
+		Vec3f		mVert0, mEdge1, mEdge2;
+	};
+
+	struct BuildTriangle;
+	struct PendingSubtree;
+
+	void		buildNode( std::vector<Node> *nodes, uint32_t nodeIndex, int depth, std::vector<BuildTriangle> &build, uint32_t first, uint32_t count, size_t deferThreshold, std::vector<PendingSubtree> *deferred ) const;
+	template<bool ANY_HIT>
+	bool		traverse( const Ray &ray, Hit *result, float minDistance, float maxDistance ) const;
+
+	std::vector<Node>		mNodes;
+	std::vector<Triangle>	mTriangles;			// in leaf order
+	std::vector<uint32_t>	mTriangleIndices;	// source TriMesh index of each of mTriangles
+};
+
+} // namespace cinder
@@ -0,0 +1,120 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/TriMesh.h"
+
+#include <vector>
+#include <cfloat>
+#include <boost/noncopyable.hpp>
+
+namespace cinder {
+
+//! \brief Reduces the triangle count of a TriMesh by quadric error metric edge collapses.
+//!
+//! Each collapse moves a vertex onto a neighboring vertex, so the surviving vertices keep their original positions and attributes.
+//! Vertices that share a position but differ in normal, texture coordinate or color form a seam; a seam vertex only collapses along
+//! the seam, together with all of its copies, so UV and normal seams stay intact. Open borders are preserved the same way, and both
+//! are weighted to resist moving. Successive calls to simplify() continue from the current state, which makes generating a chain of
+//! levels of detail from fine to coarse incremental.
+class TriMeshSimplifier : private boost::noncopyable {
+  public:
+	class Format {
+	  public:
+		Format()
+			: mMaxError( FLT_MAX ), mBoundaryWeight( 10.0f ), mLockBoundaries( false )
+		{}
+
+		//! Stops collapsing once the next collapse would move the surface further than \a error, in mesh units (RMS distance). Defaults to unlimited.
+		Format&		maxError( float error ) { mMaxError = error; return *this; }
+		//! Sets the weight of the constraint planes placed along borders and seams, relative to the surface quadrics. Defaults to \c 10.
+		Format&		boundaryWeight( float weight ) { mBoundaryWeight = weight; return *this; }
+		//! Prevents vertices on open borders from collapsing at all. Defaults to \c false.
+		Format&		lockBoundaries( bool lock = true ) { mLockBoundaries = lock; return *this; }
+
+		float		getMaxError() const { return mMaxError; }
+		float		getBoundaryWeight() const { return mBoundaryWeight; }
+		bool		getLockBoundaries() const { return mLockBoundaries; }
+
+	  private:
+		float		mMaxError, mBoundaryWeight;
+		bool		mLockBoundaries;
+	};
+
+	//! Prepares \a mesh for simplification. The mesh is copied, so it need not outlive the TriMeshSimplifier.
+	TriMeshSimplifier( const TriMesh &mesh, const Format &format = Format() );
+
+	//! Collapses edges until at most \a targetTriangles remain, no collapse stays within Format::maxError(), or no valid collapse is left. Returns the resulting number of triangles.
+	size_t		simplify( size_t targetTriangles );
+
+	//! Returns the current number of triangles
+	size_t		getNumTriangles() const { return mIndices.size() / 3; }
+	//! Returns the largest error of any collapse performed so far, as an RMS distance in mesh units. Suitable for screen-space LOD selection.
+	float		getError() const { return mError; }
+	//! Returns the current simplified mesh. Unused vertices are removed; every per-vertex attribute of the source mesh is carried over.
+	TriMesh		getMesh() const;
+
+	//! Generates up to \a maxLevels levels of detail, starting with \a mesh itself, each having roughly \a reduction times the triangles of the previous level. Stops early when no further reduction is possible. The error of each level is appended to \a errors when it is non-NULL.
+	static std::vector<TriMesh>	createLodChain( const TriMesh &mesh, size_t maxLevels, float reduction = 0.5f, const Format &format = Format(), std::vector<float> *errors = NULL );
+
+  private:
+	struct Quadric {
+		Quadric() : a00( 0 ), a01( 0 ), a02( 0 ), a11( 0 ), a12( 0 ), a22( 0 ), b0( 0 ), b1( 0 ), b2( 0 ), c( 0 ), w( 0 ) {}
+
+		void	addPlane( const Vec3f &n, float d, float weight );
+		void	operator+=( const Quadric &rhs );
+		double	eval( const Vec3f &p ) const;
+
+		double	a00, a01, a02, a11, a12, a22, b0, b1, b2, c, w;
+	};
+
+	struct Collapse {
+		Collapse() {}
+		Collapse( uint32_t from, uint32_t to, double cost ) : mFrom( from ), mTo( to ), mCost( cost ) {}
+		bool	operator<( const Collapse &rhs ) const { return mCost < rhs.mCost; }
+
+		uint32_t	mFrom, mTo;
+		double		mCost;
+	};
+
+	void		buildAdjacency();
+	void		gatherNeighbors( uint32_t group, std::vector<uint32_t> *result ) const;
+	bool		isValidCollapse( uint32_t from, uint32_t to, std::vector<std::pair<uint32_t,uint32_t> > *remap ) const;
+	float		collapseError( const Quadric &q, const Vec3f &p ) const;
+
+	TriMesh						mSource;
+	Format						mFormat;
+	// vertex -> welded position group
+	std::vector<uint32_t>		mGroups;
+	std::vector<Vec3f>			mGroupPositions;
+	std::vector<Quadric>		mQuadrics;
+	std::vector<uint8_t>		mGroupFlags;
+	std::vector<uint32_t>		mIndices;
+	// group -> triangles, in CSR form
+	std::vector<uint32_t>		mAdjacencyOffsets, mAdjacency;
+	float						mError;
+};
+
+} // namespace cinder
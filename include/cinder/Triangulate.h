@@ -27,11 +27,21 @@
 #include "cinder/PolyLine.h"
 #include "cinder/Shape2d.h"
 #include "cinder/Path2d.h"
+#include "cinder/Thread.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 struct TESStesselator;
 
 namespace cinder {
 
+class TaskPool;
+class TriangulatorCache;
+
 //! Converts an arbitrary Shape2d into a TriMesh2d
 class Triangulator {
   public:
@@ -53,8 +63,14 @@ class Triangulator {
 	//! Adds a PolyLine2f to the tesselation.
 	void		addPolyLine( const PolyLine2f &polyLine );
 
-	//! Performs the tesselation, returning a TriMesh2d
+	//! Performs the tesselation, returning a TriMesh2d. The Triangulator is empty afterwards, so it can be reused for further tesselations without reallocating.
 	TriMesh2d		calcMesh( Winding winding = WINDING_ODD );
+
+	/** \brief Tesselates each of \a shapes, returning their meshes in the same order.
+		The shapes are divided among the threads of \a taskPool, TaskPool::get() by default, each range reusing a single tessellator.
+		When \a cache is supplied, shapes found in it are not tesselated again, and newly tesselated shapes are added to it. **/
+	static std::vector<TriMesh2d>	calcMeshes( const std::vector<Shape2d> &shapes, Winding winding = WINDING_ODD, float approximationScale = 1.0f,
+												TriangulatorCache *cache = NULL, TaskPool *taskPool = NULL );
 	
 	class Exception : public cinder::Exception {
 	};
@@ -66,4 +82,60 @@ class Triangulator {
 	std::shared_ptr<TESStesselator>		mTess;
 };
 
+typedef std::shared_ptr<TriangulatorCache>	TriangulatorCacheRef;
+
+/** \brief Caches tesselated Shape2ds by their contents, so that identical shapes, such as repeated glyph outlines from Font::getGlyphShape(), are tesselated once.
+	Lookups hash the shape's segments and points together with the winding rule and approximation scale, then compare the shape exactly, so a hash collision
+	can't return the wrong mesh. The least recently used meshes are evicted beyond getMaxMeshes(). Safe to use from multiple threads. **/
+class TriangulatorCache : private boost::noncopyable {
+  public:
+	//! Creates a cache holding at most \a maxMeshes meshes
+	static TriangulatorCacheRef	create( size_t maxMeshes = 4096 ) { return TriangulatorCacheRef( new TriangulatorCache( maxMeshes ) ); }
+
+	//! Returns the tesselation of \a shape, tesselating and caching it on a miss
+	TriMesh2d	calcMesh( const Shape2d &shape, Triangulator::Winding winding = Triangulator::WINDING_ODD, float approximationScale = 1.0f );
+	//! Sets \a result to the cached tesselation of \a shape and returns \c true, or returns \c false if it isn't cached
+	bool		find( const Shape2d &shape, Triangulator::Winding winding, float approximationScale, TriMesh2d *result );
+	//! Adds \a mesh as the tesselation of \a shape, replacing any existing entry
+	void		insert( const Shape2d &shape, Triangulator::Winding winding, float approximationScale, const TriMesh2d &mesh );
+	//! Removes every mesh
+	void		clear();
+
+	//! Returns the number of meshes cached
+	size_t		getNumMeshes() const;
+	//! Returns the maximum number of meshes cached
+	size_t		getMaxMeshes() const { return mMaxMeshes; }
+	//! Sets the maximum number of meshes cached, evicting the least recently used meshes beyond it
+	void		setMaxMeshes( size_t maxMeshes );
+	//! Returns the number of lookups that found a cached mesh
+	size_t		getNumHits() const { return mNumHits; }
+	//! Returns the number of lookups that didn't find a cached mesh
+	size_t		getNumMisses() const { return mNumMisses; }
+
+	//! Returns the hash of \a shape's contents combined with \a winding and \a approximationScale, which is the cache's key
+	static uint64_t	calcHash( const Shape2d &shape, Triangulator::Winding winding, float approximationScale );
+
+  private:
+	TriangulatorCache( size_t maxMeshes );
+
+	struct Entry {
+		uint64_t				mHash;
+		Shape2d					mShape;
+		Triangulator::Winding	mWinding;
+		float					mApproximationScale;
+		TriMesh2d				mMesh;
+	};
+
+	typedef std::list<Entry>	EntryList;
+
+	// requires mMutex
+	void	evict();
+
+	EntryList											mEntries; // most recently used first
+	std::unordered_map<uint64_t,EntryList::iterator>	mIndex;
+	size_t												mMaxMeshes;
+	std::atomic<size_t>									mNumHits, mNumMisses;
+	mutable std::mutex									mMutex;
+};
+
 } // namespace cinder
\ No newline at end of file
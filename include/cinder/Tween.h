@@ -30,6 +30,7 @@
 #include "cinder/Easing.h"
 #include "cinder/Function.h"
 #include "cinder/Quaternion.h"
+#include "cinder/TweenBatch.h"
 
 #include <list>
 
@@ -83,7 +84,7 @@ class TweenBase : public TimelineItem {
 	virtual ~TweenBase() {}
 
 	//! change how the tween moves through time
-	void	setEaseFn( EaseFn easeFunction ) { mEaseFunction = easeFunction; }
+	void	setEaseFn( EaseFn easeFunction ) { mEaseFunction = easeFunction; mEaseType = TweenBatch::getEaseType( mEaseFunction ); unbatch(); }
 	EaseFn	getEaseFn() const { return mEaseFunction; }
 
 	void			setStartFn( StartFn startFunction ) { mStartFunction = startFunction; }
@@ -92,7 +93,7 @@ class TweenBase : public TimelineItem {
 	void			setReverseStartFn( StartFn reverseStartFunction ) { mReverseStartFunction = reverseStartFunction; }
 	StartFn			getReverseStartFn() const { return mReverseStartFunction; }
 	
-	void			setUpdateFn( UpdateFn updateFunction ) { mUpdateFunction = updateFunction; }									
+	void			setUpdateFn( UpdateFn updateFunction ) { mUpdateFunction = updateFunction; unbatch(); }									
 	UpdateFn		getUpdateFn() const { return mUpdateFunction; }
 																																					
 	void			setFinishFn( FinishFn finishFn ) { mFinishFunction = finishFn; }
@@ -132,7 +133,8 @@ class TweenBase : public TimelineItem {
 	UpdateFn		mUpdateFunction;	
 	FinishFn		mFinishFunction, mReverseFinishFunction;
   
-	EaseFn		mEaseFunction;
+	EaseFn					mEaseFunction;
+	TweenBatch::EaseType	mEaseType;
 	float		mDuration;
 	bool		mCopyStartValue;
 };
@@ -159,13 +161,15 @@ class Tween : public TweenBase {
 	// build a tween with a target, target value, duration, and optional ease function
 	Tween( T *target, T endValue, float startTime, float duration,
 			EaseFn easeFunction = easeNone, LerpFn lerpFunction = &tweenLerp<T> )
-		: TweenBase( target, true, startTime, duration, easeFunction ), mStartValue( *target ), mEndValue( endValue ), mLerpFunction( lerpFunction )
+		: TweenBase( target, true, startTime, duration, easeFunction ), mStartValue( *target ), mEndValue( endValue ), mLerpFunction( lerpFunction ),
+			mBatchable( isBatchableLerpFn( lerpFunction ) )
 	{
 	}
 	
 	Tween( T *target, T startValue, T endValue, float startTime, float duration,
 			EaseFn easeFunction = easeNone, LerpFn lerpFunction = &tweenLerp<T> )
-		: TweenBase( target, false, startTime, duration, easeFunction ), mStartValue( startValue ), mEndValue( endValue ), mLerpFunction( lerpFunction )
+		: TweenBase( target, false, startTime, duration, easeFunction ), mStartValue( startValue ), mEndValue( endValue ), mLerpFunction( lerpFunction ),
+			mBatchable( isBatchableLerpFn( lerpFunction ) )
 	{
 	}
 	
@@ -179,7 +183,10 @@ class Tween : public TweenBase {
 	//! Returns whether the tween will copy its target's value upon starting
 	bool	isCopyStartValue() { return mCopyStartValue; }
 
-	void	setLerpFn( const LerpFn &lerpFn ) { mLerpFunction = lerpFn; }
+	void	setLerpFn( const LerpFn &lerpFn ) { mLerpFunction = lerpFn; mBatchable = isBatchableLerpFn( lerpFn ); unbatch(); }
+
+	//! Returns whether a batched Timeline can evaluate the tween with its TweenBatch, which requires a value type described by TweenBatchTraits, the default LerpFn and no UpdateFn
+	bool	isBatchable() const { return mBatchable && ( ! mUpdateFunction ); }
 
 	//! Returns a TweenRef<T> to \a this
 	TweenRef<T>		getThisRef(){ return TweenRef<T>( std::static_pointer_cast<Tween<T> >( shared_from_this() ) ); }
@@ -255,11 +262,29 @@ class Tween : public TweenBase {
 		if( mUpdateFunction )
 			mUpdateFunction();
 	}
-	
+
+	// once started, a tween that neither loops nor ping-pongs only updates its target until it completes
+	virtual bool canBatch() const
+	{
+		return isBatchable() && mHasStarted && ( ! mComplete ) && ( ! mLoop ) && ( ! mPingPong ) && ( ! mUseAbsoluteTime ) && ( ! mMarkedForRemoval );
+	}
+
+	virtual void addToBatch( TweenBatch *batch )
+	{
+		batch->add( this, getTarget(), mStartValue, mEndValue, mEaseType, &mEaseFunction );
+	}
+
+	static bool isBatchableLerpFn( const LerpFn &lerpFn )
+	{
+		typedef T (*LerpFnPtr)( const T&, const T&, float );
+		const LerpFnPtr *fnPtr = lerpFn.template target<LerpFnPtr>();
+		return ( TweenBatchTraits<T>::NUM_COMPONENTS > 0 ) && fnPtr && ( *fnPtr == &tweenLerp<T> );
+	}
 
 	T	mStartValue, mEndValue;	
 	
 	LerpFn				mLerpFunction;
+	bool				mBatchable;
 };
 
 template<typename T>
@@ -275,7 +300,10 @@ class FnTween : public Tween<T> {
 		Tween<T>::update( relativeTime );
 		if( mFn )
 			mFn( mValue );
-	}	
+	}
+
+	// the value is passed to mFn with each update
+	virtual bool canBatch() const { return false; }
 	
 	std::function<void (T)>		mFn;
 	T							mValue;
@@ -0,0 +1,120 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/TimelineItem.h"
+#include "cinder/Vector.h"
+#include "cinder/Color.h"
+#include "cinder/Function.h"
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace cinder {
+
+//! Describes a value type TweenBatch can evaluate as its number of contiguous float components. Tweens of types with no components are always stepped individually.
+template<typename T>
+struct TweenBatchTraits { static const int NUM_COMPONENTS = 0; };
+
+template<> struct TweenBatchTraits<float> { static const int NUM_COMPONENTS = 1; };
+template<> struct TweenBatchTraits<Vec2f> { static const int NUM_COMPONENTS = 2; };
+template<> struct TweenBatchTraits<Vec3f> { static const int NUM_COMPONENTS = 3; };
+template<> struct TweenBatchTraits<Vec4f> { static const int NUM_COMPONENTS = 4; };
+template<> struct TweenBatchTraits<Color> { static const int NUM_COMPONENTS = 3; };
+template<> struct TweenBatchTraits<ColorA> { static const int NUM_COMPONENTS = 4; };
+
+/** \brief Evaluates many Tweens in progress together, on behalf of a batched Timeline (Timeline::setBatched()).
+ *
+ * Tweens are grouped by easing equation and number of components, and each group keeps its tweens' timing, values and targets in contiguous arrays.
+ * Stepping computes and eases each group's times as arrays and then interpolates each tween with its components as the lanes of a vector,
+ * using SSE where available, without visiting the Tweens themselves. Results are identical to stepping the Tweens individually with the default LerpFn.
+ * A tween leaves the batch once it reaches its end time, so that its completion is handled by TimelineItem::stepTo(). **/
+class TweenBatch : private boost::noncopyable {
+  public:
+	//! Easing equations that are evaluated as arrays. Any other EaseFn is EASE_CUSTOM, and is called for each tween.
+	enum EaseType { EASE_CUSTOM, EASE_NONE, EASE_IN_QUAD, EASE_OUT_QUAD, EASE_IN_OUT_QUAD, EASE_IN_CUBIC, EASE_OUT_CUBIC, EASE_IN_OUT_CUBIC,
+					EASE_IN_QUART, EASE_OUT_QUART, EASE_IN_OUT_QUART, NUM_EASE_TYPES };
+
+	TweenBatch();
+
+	//! Returns the EaseType of \a easeFn, which is recognized when it holds one of the functions of Easing.h or its functor edition
+	static EaseType		getEaseType( const std::function<float (float)> &easeFn );
+
+	/** Adds \a item, a started tween of \a target from \a startValue to \a endValue eased by \a easeFn of type \a easeType, which must remain valid while
+		the item is batched. The item's start time, duration and infinite setting are captured as they are now. **/
+	template<typename T>
+	void	add( TimelineItem *item, T *target, const T &startValue, const T &endValue, EaseType easeType, const std::function<float (float)> *easeFn )
+	{
+		const int numComponents = TweenBatchTraits<T>::NUM_COMPONENTS;
+		const float *start = reinterpret_cast<const float*>( &startValue );
+		const float *end = reinterpret_cast<const float*>( &endValue );
+
+		Update update;
+		update.mTarget = reinterpret_cast<float*>( target );
+		for( int c = 0; c < 4; ++c ) {
+			update.mStartValue[c] = ( c < numComponents ) ? start[c] : 0;
+			update.mEndValue[c] = ( c < numComponents ) ? end[c] : 0;
+		}
+		add( item, ( ( numComponents > 0 ) ? numComponents - 1 : 0 ) * NUM_EASE_TYPES + easeType, update, easeFn );
+	}
+	//! Removes \a item, which must be batched
+	void	remove( TimelineItem *item );
+	//! Removes all of the items, appending them to \a removed
+	void	clear( std::vector<TimelineItemRef> *removed );
+
+	//! Evaluates the items at \a time. Items that have reached their end time are then removed and appended to \a finished, to be stepped individually.
+	void	stepTo( float time, std::vector<TimelineItemRef> *finished );
+
+	//! Returns the number of items in the batch
+	size_t	getNumItems() const { return mNumItems; }
+	//! Returns whether the batch holds no items
+	bool	empty() const { return mNumItems == 0; }
+
+	//! Returns whether \a item is held by a TweenBatch
+	static bool	isBatched( const TimelineItem *item ) { return item->mSlot.mBatchGroup >= 0; }
+
+  protected:
+	struct Update {
+		float	*mTarget;
+		float	mStartValue[4], mEndValue[4];	// unused components are zero
+	};
+
+	// The tweens with the same number of components and EaseType, by index
+	struct Group {
+		std::vector<float>									mStartTimes, mInvDurations, mEndTimes;
+		std::vector<Update>									mUpdates;
+		std::vector<TimelineItem*>							mItems;
+		std::vector<const std::function<float (float)>*>	mEaseFns;		// only held by the EASE_CUSTOM groups
+	};
+
+	void	add( TimelineItem *item, int groupIndex, const Update &update, const std::function<float (float)> *easeFn );
+	void	removeAt( int groupIndex, size_t index );
+
+	Group				mGroups[4 * NUM_EASE_TYPES];	// by number of components and then EaseType
+	std::vector<float>	mTimes;
+	size_t				mNumItems;
+};
+
+} // namespace cinder
@@ -45,6 +45,15 @@ std::string		toUtf8( const std::u32string &utf32Str );
 std::u16string	toUtf16( const std::u32string &utf32str );
 std::u32string	toUtf32( const std::u16string &utf16str );
 
+//! Converts \a lengthInBytes bytes of the UTF-8 string \a utf8Str into \a result, which must have room for \a lengthInBytes code units. Returns the number of code units written. Runs of ASCII are converted with SIMD where available. Throws on invalid UTF-8.
+size_t		toUtf16( const char *utf8Str, size_t lengthInBytes, char16_t *result );
+//! Converts \a lengthInBytes bytes of the UTF-8 string \a utf8Str into \a result, which must have room for \a lengthInBytes code points. Returns the number of code points written. Runs of ASCII are converted with SIMD where available. Throws on invalid UTF-8.
+size_t		toUtf32( const char *utf8Str, size_t lengthInBytes, char32_t *result );
+//! Converts \a lengthInBytes bytes of the UTF-16 string \a utf16Str into \a result, which must have room for 3 bytes per UTF-16 code unit. Returns the number of bytes written. Runs of ASCII are converted with SIMD where available. Throws on invalid UTF-16.
+size_t		toUtf8( const char16_t *utf16Str, size_t lengthInBytes, char *result );
+//! Converts \a lengthInBytes bytes of the UTF-32 string \a utf32Str into \a result, which must have room for 4 bytes per code point. Returns the number of bytes written. Runs of ASCII are converted with SIMD where available. Throws on invalid code points.
+size_t		toUtf8( const char32_t *utf32Str, size_t lengthInBytes, char *result );
+
 //! Returns the number of characters (not bytes) in the the UTF-8 string \a str. Optimize operation by supplying a non-default \a lengthInBytes of \a str.
 size_t		stringLengthUtf8( const char *str, size_t lengthInBytes = 0 );
 //!  Returns the UTF-32 code point of the next character in \a str, relative to the byte \a inOutByte. Increments \a inOutByte to be the first byte of the next character. Optimize operation by supplying a non-default \a lengthInBytes of \a str.
@@ -53,6 +62,10 @@ uint32_t	nextCharUtf8( const char *str, size_t *inOutByte, size_t lengthInBytes
 size_t		advanceCharUtf8( const char *str, size_t numChars, size_t lengthInBytes = 0 );
 
 void		lineBreakUtf8( const char *str, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn );
+/** Breaks the UTF-8 string \a str into lines no wider than \a maxWidth, calling \a lineProcessFn with each line's start and length in bytes. Optimize operation by supplying a non-default \a lengthInBytes of \a str.
+	Widths are accumulated incrementally from \a advanceFn, which returns the advance of its second code point when it follows the first, including any kerning; the first is 0 at the start of a line.
+	Each character is measured once, except for the characters of a word which wraps, which are measured again on the next line. Prefer this to the \a measureFn variant whenever per-character metrics are available. **/
+void		lineBreakUtf8( const char *str, size_t lengthInBytes, float maxWidth, const std::function<float(uint32_t,uint32_t)> &advanceFn, const std::function<void(const char *,size_t)> &lineProcessFn );
 
 //! Values returned by calcBreaksUtf8 and calcBreaksUtf16
 enum UnicodeBreaks { UNICODE_MUST_BREAK, UNICODE_ALLOW_BREAK, UNICODE_NO_BREAK, UNICODE_INSIDE_CHAR };
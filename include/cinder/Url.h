@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Stream.h"
+#include "cinder/Buffer.h"
 #include <iostream>
 
 namespace cinder {
@@ -60,11 +61,11 @@ inline std::istream& operator>>( std::istream &is, Url &url )
 	return is;
 }
 
-//! Options for loadUrl() to dictate caching and timeout behavior
+//! Options for loadUrl() to dictate caching, timeout and seeking behavior
 class UrlOptions {
   public:
   	UrlOptions( bool ignoreCache = false, float timeoutSeconds = 30.0f )
-		: mIgnoreCache( ignoreCache ), mTimeout( timeoutSeconds )
+		: mIgnoreCache( ignoreCache ), mTimeout( timeoutSeconds ), mRangeRequests( true )
 	{}
 	
 	UrlOptions&		ignoreCache( bool ignore = true ) { mIgnoreCache = ignore; return *this; }
@@ -74,10 +75,16 @@ class UrlOptions {
 	UrlOptions&		timeout( float seconds ) { mTimeout = seconds; return *this; }
 	float			getTimeout() const { return mTimeout; }
 	void			setTimeout( float seconds ) { mTimeout = seconds; }
+
+	//! Enables reading HTTP(S) streams with Range requests, so that an IStreamUrl only downloads the blocks it reads and seeks anywhere. Servers that don't support ranges are streamed in full. Default is \c true. Currently supported on Windows desktop, OS X and iOS.
+	UrlOptions&		rangeRequests( bool enable = true ) { mRangeRequests = enable; return *this; }
+	bool			getRangeRequests() const { return mRangeRequests; }
+	void			setRangeRequests( bool enable = true ) { mRangeRequests = enable; }
 	
   private:
 	bool			mIgnoreCache;
 	float			mTimeout;
+	bool			mRangeRequests;
 	
 };
 
@@ -110,6 +117,23 @@ class IStreamUrlImpl {
 };
 //! \endcond
 
+//! \cond
+// This is an abstract base class for the connection-reusing sessions UrlFetcher performs its requests on
+class UrlFetchSessionImpl {
+  public:
+	virtual ~UrlFetchSessionImpl() {}
+
+	//! Creates the platform's session, allowing up to \a maxConnectionsPerServer simultaneous connections to a single server.
+	static std::shared_ptr<UrlFetchSessionImpl>	create( size_t maxConnectionsPerServer );
+
+	//! Downloads the complete body of \a url into \a data and returns the HTTP status code. Throws UrlLoadExc if no response is received. Called concurrently from several threads.
+	virtual int		fetch( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, Buffer *data ) = 0;
+	//! Requests at most \a size bytes of \a url starting at \a offset and returns the HTTP status code, which is 206 if the server honored the range.
+	//! \a totalSize receives the length of the whole resource, or -1 if it's unknown. A server ignoring the range answers 200, in which case \a totalSize equals the size of \a data only if the complete body was read.
+	virtual int		fetchRange( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, uint64_t offset, size_t size, Buffer *data, int64_t *totalSize ) = 0;
+};
+//! \endcond
+
 //! A pointer to an instance of an IStreamUrl. Can be created using IStreamUrl::createRef()
 typedef std::shared_ptr<class IStreamUrl>	IStreamUrlRef;
 
@@ -0,0 +1,156 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Buffer.h"
+#include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Thread.h"
+#include "cinder/Url.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace cinder {
+
+typedef std::shared_ptr<class UrlFetcher>		UrlFetcherRef;
+typedef std::shared_ptr<class UrlFetchRequest>	UrlFetchRequestRef;
+
+//! A request made to a UrlFetcher. Pending requests can be canceled.
+class UrlFetchRequest : private boost::noncopyable {
+  public:
+	enum State { PENDING, FETCHING, COMPLETE, FAILED, CANCELED };
+
+	//! Cancels the request. Returns true if it hadn't started fetching yet, in which case it is removed from the queue. Otherwise the download is finished, but its callback won't be called.
+	bool	cancel();
+	//! Returns the State of the request.
+	State	getState() const					{ return static_cast<State>( mState.load() ); }
+	//! Returns whether the request has been canceled.
+	bool	isCanceled() const					{ return getState() == CANCELED; }
+
+	//! Returns the Url being fetched.
+	const Url&			getUrl() const				{ return mUrl; }
+	//! Returns the HTTP status code of the response, or \c 0 if none was received.
+	int					getStatusCode() const		{ return mStatusCode; }
+	//! Returns the body of the response once the request is COMPLETE.
+	const Buffer&		getData() const				{ return mData; }
+	//! Returns a DataSource for the body of the response, with the Url's path as its file path hint so that loadImage() can select a decoder by extension.
+	DataSourceRef		getDataSource() const;
+	//! Returns whether the response was read from the UrlFetcher's disk cache.
+	bool				isFromCache() const			{ return mFromCache; }
+	//! Returns a description of the error if the request FAILED.
+	const std::string&	getErrorMessage() const		{ return mErrorMessage; }
+
+  private:
+	typedef std::deque<UrlFetchRequestRef>	Queue;
+
+	UrlFetchRequest( const std::weak_ptr<UrlFetcher> &fetcher, const Url &url, const UrlOptions &options, const std::string &user, const std::string &password );
+
+	std::weak_ptr<UrlFetcher>						mFetcher;
+	Url												mUrl;
+	UrlOptions										mOptions;
+	std::string										mUser, mPassword;
+	std::function<void ( const UrlFetchRequestRef & )>	mCallback;
+	std::atomic<int>								mState;
+
+	int												mStatusCode;
+	Buffer											mData;
+	bool											mFromCache;
+	std::string										mErrorMessage;
+
+	friend class UrlFetcher;
+};
+
+/** \brief Downloads URLs in the background on a bounded set of worker threads, reusing connections between requests.
+ *
+ * Requests are started in the order they're made, at most Format::maxConnections() at a time, on a single platform session which keeps connections
+ * to each server alive: a shared WinInet session on Windows and the system's NSURLConnection pool on OS X and iOS. Elsewhere each request opens an IStreamUrl.
+ * If Format::cacheDirectory() is set, successful responses are stored there and later requests for the same Url are answered from disk, unless their
+ * UrlOptions ignore the cache. Callbacks are called on the App's main thread after the next update(), with App::dispatchAsync(). If there is no App,
+ * they're called on the worker thread. **/
+class UrlFetcher : public std::enable_shared_from_this<UrlFetcher>, private boost::noncopyable {
+  public:
+	typedef std::function<void ( const UrlFetchRequestRef &request )>	Callback;
+
+	struct Format {
+		Format() : mMaxConnections( 4 ), mCacheMaxAge( 0 ) {}
+
+		//! Sets the maximum number of requests in flight at once, each on its own worker thread. Default is \c 4.
+		Format&	maxConnections( size_t connections )			{ mMaxConnections = std::max<size_t>( 1, connections ); return *this; }
+		//! Sets the directory responses are cached in, which is created if necessary. Default is empty, which disables the disk cache.
+		Format&	cacheDirectory( const fs::path &directory )		{ mCacheDirectory = directory; return *this; }
+		//! Sets the age in seconds after which cached responses are fetched again. Default is \c 0, which keeps them indefinitely.
+		Format&	cacheMaxAge( double seconds )					{ mCacheMaxAge = seconds; return *this; }
+
+		size_t			getMaxConnections() const		{ return mMaxConnections; }
+		const fs::path&	getCacheDirectory() const		{ return mCacheDirectory; }
+		double			getCacheMaxAge() const			{ return mCacheMaxAge; }
+
+	  protected:
+		size_t			mMaxConnections;
+		fs::path		mCacheDirectory;
+		double			mCacheMaxAge;
+	};
+
+	//! Creates a UrlFetcher with \a format. Throws UrlLoadExc if the platform's session can't be created.
+	static UrlFetcherRef	create( const Format &format = Format() );
+
+	//! Queues a GET of \a url with \a options and optional credentials. \a callback is called with the request once it has COMPLETED or FAILED, unless it is canceled first. Responses with an HTTP status of 400 or above FAIL.
+	UrlFetchRequestRef	fetch( const Url &url, const Callback &callback, const UrlOptions &options = UrlOptions(), const std::string &user = "", const std::string &password = "" );
+
+	//! Cancels all requests.
+	void	cancelAll();
+	//! Returns the number of requests that haven't started fetching yet.
+	size_t	getNumPending() const;
+	//! Removes every response from the disk cache.
+	void	clearCache();
+	//! Returns the path \a url's response is cached at, or an empty path if the disk cache is disabled.
+	fs::path	getCachePath( const Url &url ) const;
+
+	const Format&	getFormat() const	{ return mFormat; }
+
+  private:
+	UrlFetcher( const Format &format );
+
+	void	processRequests();
+	//! Reads \a url's response from the disk cache into \a data, returning false if there's no fresh entry.
+	bool	readCache( const Url &url, const UrlOptions &options, Buffer *data ) const;
+	void	writeCache( const Url &url, const Buffer &data ) const;
+	void	deliver( const UrlFetchRequestRef &request );
+
+	Format									mFormat;
+	std::shared_ptr<UrlFetchSessionImpl>	mSession;
+	mutable std::mutex						mMutex;
+	UrlFetchRequest::Queue					mQueue;				// guarded by mMutex
+	size_t									mNumActiveWorkers;	// guarded by mMutex
+
+	friend class UrlFetchRequest;
+};
+
+} // namespace cinder
@@ -57,4 +57,17 @@ class IStreamUrlImplCocoa : public IStreamUrlImpl {
 	IStreamUrlImplCocoaDelegate		*mDelegate;	
 };
 
+// Performs UrlFetcher's requests with synchronous NSURLConnections, which share and keep alive the system's pool of connections
+class UrlFetchSessionCocoa : public UrlFetchSessionImpl {
+  public:
+	UrlFetchSessionCocoa( size_t /*maxConnectionsPerServer*/ ) {}
+
+	virtual int		fetch( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, Buffer *data );
+	virtual int		fetchRange( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, uint64_t offset, size_t size, Buffer *data, int64_t *totalSize );
+
+  private:
+	//! Sends a GET with an optional \a range header, reading the complete response into \a data.
+	int				sendRequest( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, const std::string &range, Buffer *data, int64_t *totalSize );
+};
+
 } // namespace cinder
\ No newline at end of file
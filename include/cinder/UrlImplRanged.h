@@ -0,0 +1,78 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Url.h"
+
+#include <map>
+
+namespace cinder {
+
+// Reads an HTTP(S) resource in blocks fetched with Range requests, so that only the parts of it that are read are downloaded. Blocks are reused from
+// an LRU cache and read ahead in growing runs while the stream is read sequentially.
+class IStreamUrlImplRanged : public IStreamUrlImpl {
+  public:
+	//! Returns an implementation reading \a url with Range requests, or null if it isn't an HTTP(S) url or its server doesn't support them.
+	static std::shared_ptr<IStreamUrlImpl>	create( const std::string &url, const std::string &user, const std::string &password, const UrlOptions &options );
+
+	virtual size_t		readDataAvailable( void *dest, size_t maxSize );
+	virtual void		seekAbsolute( off_t absoluteOffset );
+	virtual void		seekRelative( off_t relativeOffset );
+	virtual off_t		tell() const;
+	virtual off_t		size() const;
+	
+	virtual bool		isEof() const;
+	virtual void		IORead( void *t, size_t size );
+
+  private:
+	IStreamUrlImplRanged( const std::string &url, const std::string &user, const std::string &password, const UrlOptions &options, const std::shared_ptr<UrlFetchSessionImpl> &session, uint64_t size );
+
+	struct Block {
+		Buffer		mData;
+		uint64_t	mLastUsed;
+	};
+
+	//! Returns the block \a index, fetching it and the blocks read ahead of it if necessary.
+	const Block&	getBlock( uint64_t index );
+	//! Splits \a data, which starts at block \a firstIndex, into blocks and adds them to the cache.
+	void			insertBlocks( uint64_t firstIndex, const Buffer &data );
+	void			evictBlocks();
+
+	Url										mUrl;
+	std::shared_ptr<UrlFetchSessionImpl>	mSession;
+	uint64_t								mSize, mPos;
+	bool									mEvictable;	// false once the whole resource is cached, because its server ignores ranges
+
+	std::map<uint64_t, Block>				mBlocks;
+	size_t									mCachedBytes;
+	uint64_t								mUseCount;
+	uint64_t								mLastBlockRead;
+	size_t									mReadAheadBlocks;
+
+	static const size_t		BLOCK_SIZE = 256 * 1024;
+	static const size_t		MAX_READ_AHEAD_BLOCKS = 32;
+	static const size_t		MAX_CACHED_BYTES = 32 * 1024 * 1024;
+};
+
+} // namespace cinder
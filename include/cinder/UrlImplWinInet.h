@@ -54,4 +54,19 @@ class IStreamUrlImplWinInet : public IStreamUrlImpl {
 	static const int		DEFAULT_BUFFER_SIZE = 4096;
 };
 
+// Performs UrlFetcher's requests on a single internet session, which keeps connections alive and reuses them across requests and threads
+class UrlFetchSessionWinInet : public UrlFetchSessionImpl {
+  public:
+	UrlFetchSessionWinInet( size_t maxConnectionsPerServer );
+
+	virtual int		fetch( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, Buffer *data );
+	virtual int		fetchRange( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, uint64_t offset, size_t size, Buffer *data, int64_t *totalSize );
+
+  private:
+	//! Sends a GET with the additional \a headers and reads at most \a maxSize bytes of the response into \a data.
+	int				sendRequest( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, const std::wstring &headers, size_t maxSize, Buffer *data, int64_t *totalSize );
+
+	std::shared_ptr<void>		mSession;
+};
+
 } // namespace cinder
\ No newline at end of file
@@ -81,14 +81,32 @@ template<typename T>
 inline std::string toString( const T &t ) { return boost::lexical_cast<std::string>( t ); }
 template<typename T>
 inline T fromString( const std::string &s ) { return boost::lexical_cast<T>( s ); }
+//! Parses the \a length characters at \a str as a T, without copying them into a std::string first
+template<typename T>
+inline T fromString( const char *str, size_t length ) { return boost::lexical_cast<T>( str, length ); }
 // This specialization seems to only be necessary with more recent versions of Boost
 template<>
 inline Url fromString( const std::string &s ) { return Url( s ); }
-#if defined(CINDER_COCOA_TOUCH)
-// Necessary because boost::lexical_cast crashes when trying to convert a string to a double on iOS
-template<>
-inline double fromString( const std::string &s ) { return atof( s.c_str() ); }
-#endif
+
+/* The integer and floating point specializations below don't go through boost::lexical_cast's stringstream, and don't depend on the current locale.
+	Integers convert exactly as lexical_cast converts them. Floating point values are formatted with Grisu2, which finds a short (almost always the
+	shortest) string of digits that reads back as the same value, so 0.1 becomes "0.1" rather than "0.10000000000000001". Like lexical_cast, fromString()
+	accepts only a number filling the whole string, and throws boost::bad_lexical_cast otherwise or when it's out of range. */
+#define CINDER_NUMBER_CONVERSIONS( T ) \
+	template<> std::string toString<T>( const T &t ); \
+	template<> T fromString<T>( const char *str, size_t length ); \
+	template<> inline T fromString<T>( const std::string &s ) { return fromString<T>( s.data(), s.size() ); }
+CINDER_NUMBER_CONVERSIONS( short )
+CINDER_NUMBER_CONVERSIONS( unsigned short )
+CINDER_NUMBER_CONVERSIONS( int )
+CINDER_NUMBER_CONVERSIONS( unsigned int )
+CINDER_NUMBER_CONVERSIONS( long )
+CINDER_NUMBER_CONVERSIONS( unsigned long )
+CINDER_NUMBER_CONVERSIONS( long long )
+CINDER_NUMBER_CONVERSIONS( unsigned long long )
+CINDER_NUMBER_CONVERSIONS( float )
+CINDER_NUMBER_CONVERSIONS( double )
+#undef CINDER_NUMBER_CONVERSIONS
 
 //! Returns a stack trace (aka backtrace) where \c stackTrace()[0] == caller, \c stackTrace()[1] == caller's parent, etc
 std::vector<std::string> stackTrace();
@@ -103,7 +121,10 @@ extern uint32_t swapEndian( uint32_t val );
 extern float	swapEndian( float val );
 extern double	swapEndian( double val );
 
+//! Swaps the byte order of each value in the block in place, using SIMD where available.
 extern void swapEndianBlock( uint16_t *blockPtr, size_t blockSizeInBytes );
+extern void swapEndianBlock( uint32_t *blockPtr, size_t blockSizeInBytes );
 extern void swapEndianBlock( float *blockPtr, size_t blockSizeInBytes );
+extern void swapEndianBlock( double *blockPtr, size_t blockSizeInBytes );
 
 } // namespace cinder
@@ -31,6 +31,7 @@
 #include "cinder/Exception.h"
 #include "cinder/Utilities.h"
 
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -38,6 +39,7 @@
 namespace rapidxml {
 	template<class Ch> class xml_document;
 	template<class Ch> class xml_node;
+	template<class Ch> class xml_attribute;
 };
 //! \endcond
 
@@ -173,7 +175,7 @@ class XmlTree {
 		void					setValue( const std::string &value ) { mValue = value; }
 		/** Sets the value of the attribute to \a value, which is cast to a string first. Requires T to support the ostream<< operator. **/
 		template<typename T>
-		void					setValue( const T &value ) { mValue = boost::lexical_cast<std::string>( value ); }
+		void					setValue( const T &value ) { mValue = toString( value ); }
 
 	  private:
 	  	XmlTree			*mXml;
@@ -222,7 +224,9 @@ class XmlTree {
 	
 	/** \brief Parses XML contained in \a dataSource using the options \a parseOptions. Commonly used with the results of loadUrl(), loadFile() or loadResource().
 		<br><tt>XmlTree myDoc( loadUrl( "http://rss.cnn.com/rss/cnn_topstories.rss" ) );</tt> **/
-	explicit XmlTree( DataSourceRef dataSource, ParseOptions parseOptions = ParseOptions() ) {
+	explicit XmlTree( DataSourceRef dataSource, ParseOptions parseOptions = ParseOptions() )
+		: mNodeType( NODE_DOCUMENT ), mParent( 0 )
+	{
 		loadFromDataSource( dataSource, this, parseOptions );
 	}
 
@@ -253,22 +257,22 @@ class XmlTree {
 	//! Returns the tag or name of the node as a string.
 	const std::string&			getTag() const { return mTag; }
 	//! Sets the tag or name of the node to the string \a tag.
-	void						setTag( const std::string &tag ) { mTag = tag; }
+	void						setTag( const std::string &tag ) { mTag = tag; if( mParent ) mParent->invalidateChildIndex(); }
 	
 	//! Returns the value of the node as a string.
 	std::string					getValue() const { return mValue; }
 	//! Returns the value of the node parsed as a T. Requires T to support the istream>> operator.
 	template<typename T>
-	T							getValue() const { return boost::lexical_cast<T>( mValue ); }
+	T							getValue() const { return fromString<T>( mValue ); }
 	//! Returns the value of the node parsed as a T. If the value is empty or fails to parse \a defaultValue is returned. Requires T to support the istream>> operator.
 	template<typename T>
-	T							getValue( const T &defaultValue ) const { try { return boost::lexical_cast<T>( mValue ); } catch( ... ) { return defaultValue; } }
+	T							getValue( const T &defaultValue ) const { try { return fromString<T>( mValue ); } catch( ... ) { return defaultValue; } }
 
 	//! Sets the value of the node to the string \a value.
 	void						setValue( const std::string &value ) { mValue = value; }
 	//! Sets the value of the node to \a value which is converted to a string first. Requires T to support the ostream<< operator.
 	template<typename T>
-	void						setValue( const T &value ) { mValue = boost::lexical_cast<std::string>( value ); }
+	void						setValue( const T &value ) { mValue = toString( value ); }
 
 	//! Returns whether this node has a parent node.
 	bool						hasParent() const { return mParent != NULL; }
@@ -280,16 +284,17 @@ class XmlTree {
 	//! Returns the first child that matches \a relativePath or end() if none matches
 	Iter						find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) { return Iter( *this, relativePath, caseSensitive, separator ); }
 	//! Returns the first child that matches \a relativePath or end() if none matches
-	ConstIter					find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const { return ConstIter( *this, relativePath, caseSensitive, separator ); }
+	ConstIter					find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
 	//! Returns whether at least one child matches \a relativePath
 	bool						hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
 
-	//! Returns the first child that matches \a relativePath. Throws ExcChildNotFound if none matches.
+	/** Returns the first child that matches \a relativePath. Throws ExcChildNotFound if none matches.
+		Nodes with many children index them by tag on the first lookup, so each step of the path is a hash lookup rather than a scan. Building the index is not thread safe. **/
 	XmlTree&					getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' );
 	//! Returns the first child that matches \a relativePath. Throws ExcChildNotFound if none matches.
 	const XmlTree&				getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
-	//! Returns a reference to the node's list of children nodes.
-	Container&			getChildren() { return mChildren; }
+	//! Returns a reference to the node's list of children nodes. Calling this discards the node's child index, so don't hold on to the result across lookups while modifying it.
+	Container&			getChildren() { invalidateChildIndex(); return mChildren; }
 	//! Returns a reference to the node's list of children nodes.
 	const Container&	getChildren() const { return mChildren; }
 
@@ -334,7 +339,7 @@ class XmlTree {
 	XmlTree&					setAttribute( const std::string &attrName, const std::string &value );
 	/** Sets the value of the attribute \a attrName to \a value, which is cast to a string first. Requires T to support the ostream<< operator. If the attribute does not exist it is appended. **/
 	template<typename T>
-	XmlTree&					setAttribute( const std::string &attrName, const T &value ) { return setAttribute( attrName, boost::lexical_cast<std::string>( value ) ); }
+	XmlTree&					setAttribute( const std::string &attrName, const T &value ) { return setAttribute( attrName, toString( value ) ); }
 	/** Returns whether the node has an attribute named \a attrName. **/
 	bool						hasAttribute( const std::string &attrName ) const;
 	/** Returns a path to this node, separated by the character \a separator. **/	
@@ -399,10 +404,14 @@ class XmlTree {
 	std::shared_ptr<rapidxml::xml_document<char> >	createRapidXmlDoc( bool createDocument = false ) const;	
 
   private:
+	struct ChildIndex;
+
 	XmlTree*	getNodePtr( const std::string &relativePath, bool caseSensitive, char separator ) const;
 	void		appendRapidXmlNode( rapidxml::xml_document<char> &doc, rapidxml::xml_node<char> *parent ) const;
 
 	static Container::const_iterator	findNextChildNamed( const Container &sequence, Container::const_iterator firstCandidate, const std::string &searchTag, bool caseSensitive );
+	Container::const_iterator			findFirstChildNamed( const std::string &searchTag, bool caseSensitive ) const;
+	void								invalidateChildIndex();
 
 	NodeType					mNodeType;
   	std::string					mTag;
@@ -411,12 +420,238 @@ class XmlTree {
 	XmlTree						*mParent;
 	Container					mChildren;
 	std::list<Attr>				mAttributes;
+	mutable std::shared_ptr<ChildIndex>	mChildIndex; // built lazily by findFirstChildNamed(); never shared, but unlike unique_ptr allows ChildIndex to be incomplete here
 	
 	static void		loadFromDataSource( DataSourceRef dataSource, XmlTree *result, const ParseOptions &parseOptions );
 };
 
 std::ostream& operator<<( std::ostream &out, const XmlTree &xml );
 
+/** \brief Read-only view of an XML document which queries the rapidxml parse directly.
+	Unlike XmlTree, nodes and attributes are never copied: the rapidxml document, its memory pool and the in-situ parsed text are kept alive
+	for as long as any XmlView into them exists, and tags, values and attribute values point into that text.
+	<br><tt>XmlView doc( loadFile( "layout.svg" ) ); float w = doc.getChild( "svg" ).getAttributeValue<float>( "width" );</tt> **/
+class XmlView {
+  public:
+	//! \cond
+	typedef rapidxml::xml_node<char>		Node;
+	typedef rapidxml::xml_attribute<char>	NodeAttr;
+	class Document;
+	//! \endcond
+
+	class ConstIter;
+
+	//! Read-only XML attribute. Its name and value point into the document's text.
+	class Attr {
+	  public:
+		//! Constructs an invalid Attr, which has an empty name and value.
+		Attr() : mAttr( 0 ) {}
+		//! \cond
+		explicit Attr( const NodeAttr *attr ) : mAttr( attr ) {}
+		//! \endcond
+
+		//! Returns whether the Attr refers to an attribute of the document.
+		bool			isValid() const { return mAttr != 0; }
+		//! Returns the next attribute of the same node, which is invalid if this is the last.
+		Attr			getNext() const;
+
+		//! Returns the name of the attribute. Empty for an invalid Attr.
+		const char*		getName() const;
+		//! Returns the value of the attribute. Empty for an invalid Attr.
+		const char*		getValue() const;
+		//! Returns the length of the value of the attribute.
+		size_t			getValueSize() const;
+		//! Returns the value of the attribute parsed as a T using fromString(), without copying it first.
+		template<typename T>
+		T				getValue() const { return fromString<T>( getValue(), getValueSize() ); }
+		//! Returns the value of the attribute parsed as a T using fromString(), without copying it first.
+		template<typename T>
+		T				as() const { return getValue<T>(); }
+		//! Returns true if the Attr value is empty
+		bool			empty() const { return getValueSize() == 0; }
+
+		bool	operator==( const char *rhs ) const { return strcmp( getValue(), rhs ) == 0; }
+		bool	operator==( const std::string &rhs ) const { return rhs == getValue(); }
+		bool	operator!=( const char *rhs ) const { return ! ( *this == rhs ); }
+		bool	operator!=( const std::string &rhs ) const { return ! ( *this == rhs ); }
+
+	  private:
+		const NodeAttr	*mAttr;
+	};
+
+	//! Constructs an empty view, which refers to no document.
+	XmlView() : mNode( 0 ) {}
+	/** \brief Parses XML contained in \a dataSource using the options \a parseOptions. The parse is done in place in a single copy of the source.
+		<br><tt>XmlView myDoc( loadFile( "layout.xml" ) );</tt> **/
+	explicit XmlView( DataSourceRef dataSource, XmlTree::ParseOptions parseOptions = XmlTree::ParseOptions() );
+	//! Parses the XML contained in the string \a xmlString using the options \a parseOptions.
+	explicit XmlView( const std::string &xmlString, XmlTree::ParseOptions parseOptions = XmlTree::ParseOptions() );
+
+	//! Returns the type of this node as a NodeType.
+	XmlTree::NodeType			getNodeType() const;
+	//! Returns whether this node is a document node, meaning it is a root node.
+	bool						isDocument() const { return getNodeType() == XmlTree::NODE_DOCUMENT; }
+	//! Returns whether this node is an element node.
+	bool						isElement() const { return getNodeType() == XmlTree::NODE_ELEMENT; }
+	//! Returns whether this node represents CDATA. Only possible when a document's ParseOptions disabled collapsing CDATA.
+	bool						isCData() const { return getNodeType() == XmlTree::NODE_CDATA; }
+	//! Returns whether this node represents a comment. Only possible when a document's ParseOptions enabled parsing commments.
+	bool						isComment() const { return getNodeType() == XmlTree::NODE_COMMENT; }
+
+	//! Returns the tag or name of the node.
+	const char*					getTag() const;
+	/** Returns the value of the node. When collapsing CDATA, an element without text of its own returns the value of its first CDATA child
+		rather than the concatenation of all of them, as that would require a copy. **/
+	const char*					getValue() const;
+	//! Returns the length of the value of the node.
+	size_t						getValueSize() const;
+	//! Returns the value of the node parsed as a T using fromString(), without copying it first.
+	template<typename T>
+	T							getValue() const { return fromString<T>( getValue(), getValueSize() ); }
+	//! Returns the value of the node parsed as a T. If the value is empty or fails to parse \a defaultValue is returned.
+	template<typename T>
+	T							getValue( const T &defaultValue ) const { try { return getValue<T>(); } catch( ... ) { return defaultValue; } }
+
+	//! Returns whether this node has a parent node.
+	bool						hasParent() const;
+	//! Returns a view of the node which is the parent of this node.
+	XmlView						getParent() const;
+
+	//! Returns the first child that matches \a relativePath or end() if none matches
+	ConstIter					find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+	//! Returns whether at least one child matches \a relativePath
+	bool						hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+	//! Returns the first child that matches \a relativePath. Throws ExcChildNotFound if none matches.
+	XmlView						getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+	//! Returns the first child that matches \a childName. Throws ExcChildNotFound if none matches.
+	XmlView						operator/( const std::string &childName ) const { return getChild( childName ); }
+
+	//! Returns the first attribute of the node. Iterate the rest with Attr::getNext().
+	Attr						getFirstAttribute() const;
+	//! Returns the node attribute named \a attrName. Throws ExcAttrNotFound if no attribute exists with that name.
+	Attr						getAttribute( const std::string &attrName ) const;
+	//! Returns an Attr accessor. If the attribute does not exist the Attr is invalid and its value is an empty string.
+	Attr						operator[]( const std::string &attrName ) const { return Attr( findAttribute( attrName ) ); }
+	/** Returns whether the node has an attribute named \a attrName. **/
+	bool						hasAttribute( const std::string &attrName ) const { return findAttribute( attrName ) != 0; }
+	/** \brief Returns the value of the attribute \a attrName parsed as a T. Throws ExcAttrNotFound if no attribute exists with that name.
+		<br><tt>float size = myNode.getAttributeValue<float>( "size" );</tt> **/
+	template<typename T>
+	T							getAttributeValue( const std::string &attrName ) const { return getAttribute( attrName ).getValue<T>(); }
+	/** \brief Returns the value of the attribute \a attrName parsed as a T. Returns \a defaultValue if no attribute exists with that name or the attribute fails to cast to T.
+		<br><tt>float size = myNode.getAttributeValue<float>( "size", 1.0f );</tt> **/
+	template<typename T>
+	T							getAttributeValue( const std::string &attrName, const T &defaultValue ) const {
+			Attr attr( findAttribute( attrName ) );
+			if( attr.isValid() ) {
+				try {
+					return attr.getValue<T>();
+				}
+				catch(...) {
+					return defaultValue;
+				}
+			}
+			else return defaultValue;
+	}
+
+	/** Returns a path to this node, separated by the character \a separator. **/
+	std::string					getPath( char separator = '/' ) const;
+	/** Returns the DOCTYPE string for this node. Only meaningful on a document's root node. **/
+	std::string					getDocType() const;
+
+	/** Returns a ConstIter to the first child node of this node. **/
+	ConstIter					begin() const;
+	/** Returns a ConstIter to the children node of this node which match the path \a filterPath. **/
+	ConstIter					begin( const std::string &filterPath, bool caseSensitive = false, char separator = '/' ) const;
+	/** Returns a ConstIter which marks the end of the children of this node. **/
+	ConstIter					end() const;
+
+	//! Returns a mutable XmlTree copy of this node and its descendants.
+	XmlTree						toXmlTree() const;
+
+	//! Exception expressing the absence of an expected child node.
+	class ExcChildNotFound : public XmlTree::Exception {
+	  public:
+		ExcChildNotFound( const XmlView &node, const std::string &childPath ) throw();
+
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Exception expressing the absence of an expected attribute.
+	class ExcAttrNotFound : public XmlTree::Exception {
+	  public:
+		ExcAttrNotFound( const XmlView &node, const std::string &attrName ) throw();
+
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+  private:
+	XmlView( const std::shared_ptr<const Document> &document, const Node *node )
+		: mDocument( document ), mNode( node )
+	{}
+
+	void			parse( const std::shared_ptr<Document> &document );
+	const Node*		findChild( const std::string &relativePath, bool caseSensitive, char separator ) const;
+	const NodeAttr*	findAttribute( const std::string &attrName ) const;
+	const Node*		getValueNode() const;
+
+	std::shared_ptr<const Document>		mDocument;
+	const Node							*mNode;
+};
+
+//! A const iterator over the children of an XmlView, optionally filtered by a path.
+class XmlView::ConstIter {
+  public:
+	//! \cond
+	ConstIter() : mCaseSensitive( false ) {}
+	ConstIter( const XmlView &parent );
+	ConstIter( const XmlView &root, const std::string &filterPath, bool caseSensitive = false, char separator = '/' );
+	//! \endcond
+
+	//! Returns a reference to the XmlView the iterator currently points to.
+	const XmlView&		operator*() const { return mCurrent; }
+	//! Returns a pointer to the XmlView the iterator currently points to.
+	const XmlView*		operator->() const { return &mCurrent; }
+
+	//! Increments the iterator to the next child. If using a non-empty filterPath increments to the next child which matches the filterPath.
+	ConstIter& operator++() {
+		increment();
+		return *this;
+	}
+
+	//! Increments the iterator to the next child. If using a non-empty filterPath increments to the next child which matches the filterPath.
+	const ConstIter operator++(int) {
+		ConstIter prev( *this );
+		++(*this);
+		return prev;
+	}
+
+	bool operator!=( const ConstIter &rhs ) const { return mCurrent.mNode != rhs.mCurrent.mNode; }
+	bool operator==( const ConstIter &rhs ) const { return mCurrent.mNode == rhs.mCurrent.mNode; }
+
+  private:
+	//! \cond
+	void	increment();
+	void	seek( size_t level, const Node *candidate );
+
+	XmlView						mCurrent;
+	std::vector<const Node*>	mStack;
+	std::vector<std::string>	mFilter;
+	bool						mCaseSensitive;
+	//! \endcond
+};
+
+inline XmlView::ConstIter XmlView::find( const std::string &relativePath, bool caseSensitive, char separator ) const	{ return ConstIter( *this, relativePath, caseSensitive, separator ); }
+inline XmlView::ConstIter XmlView::begin() const { return ConstIter( *this ); }
+inline XmlView::ConstIter XmlView::begin( const std::string &filterPath, bool caseSensitive, char separator ) const { return ConstIter( *this, filterPath, caseSensitive, separator ); }
+inline XmlView::ConstIter XmlView::end() const { return ConstIter(); }
+
 } // namespace cinder
 
 namespace std {
@@ -439,6 +674,15 @@ struct iterator_traits<cinder::XmlTree::ConstIter> {
 	typedef const cinder::XmlTree*	pointer;
 	typedef const cinder::XmlTree&	reference;
 };
+
+template<>
+struct iterator_traits<cinder::XmlView::ConstIter> {
+	typedef cinder::XmlView			value_type;
+	typedef ptrdiff_t				difference_type;
+	typedef forward_iterator_tag	iterator_category;
+	typedef const cinder::XmlView*	pointer;
+	typedef const cinder::XmlView&	reference;
+};
 //! \endcond
 
 } // namespace std
\ No newline at end of file
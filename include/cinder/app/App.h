@@ -31,9 +31,12 @@
 #include "cinder/app/MouseEvent.h"
 #include "cinder/app/KeyEvent.h"
 #include "cinder/app/FileDropEvent.h"
+#include "cinder/app/FrameTiming.h"
+#include "cinder/app/MainThreadQueue.h"
 
 #include "cinder/Display.h"
 #include "cinder/DataSource.h"
+#include "cinder/AssetArchive.h"
 #include "cinder/Timer.h"
 #include "cinder/Function.h"
 #include "cinder/Thread.h"
@@ -62,6 +65,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
 
 namespace cinder {
 class Timeline;
@@ -190,6 +194,14 @@ class App {
 		void		enableMultiTouch( bool enable = true ) { mEnableMultiTouch = enable; }
 		//! Returns whether the app is registered to receive multiTouch events from the operating system. Disabled by default on desktop platforms, enabled on mobile.
 		bool		isMultiTouchEnabled() const { return mEnableMultiTouch; }
+		//! Sets whether multiTouch events are coalesced into at most one touchesBegan, touchesMoved and touchesEnded event per frame, delivered before update(). Disabled by default. Currently MSW only.
+		void		enableTouchCoalescing( bool enable = true ) { mEnableTouchCoalescing = enable; }
+		//! Returns whether multiTouch events are coalesced into at most one touchesBegan, touchesMoved and touchesEnded event per frame. Disabled by default.
+		bool		isTouchCoalescingEnabled() const { return mEnableTouchCoalescing; }
+		//! Sets whether coalesced touch events retain every merged sample, available through TouchEvent::getHistory(). Disabled by default.
+		void		enableTouchHistory( bool enable = true ) { mEnableTouchHistory = enable; }
+		//! Returns whether coalesced touch events retain every merged sample, available through TouchEvent::getHistory(). Disabled by default.
+		bool		isTouchHistoryEnabled() const { return mEnableTouchHistory; }
 
 		//! a value of \c true allows screensavers or the system's power management to hide the app. Default value is \c false on desktop, and \c true on mobile
 		void	enablePowerManagement( bool enable = true );
@@ -209,6 +221,18 @@ class App {
 		bool	isFrameRateEnabled() const { return mFrameRateEnabled; }
 		//! maximum frameRate of the application specified in frames per second
 		float	getFrameRate() const { return mFrameRate; }
+		//! Sets whether the App waits for each frame by sleeping until shortly before its deadline and then spinning, which is more precise than sleeping and uses more CPU. Disabled by default. Currently only supported by AppBasic on Windows.
+		void	enableHighPrecisionFrameRate( bool enable = true ) { mHighPrecisionFrameRate = enable; }
+		//! Returns whether the App waits for each frame by sleeping until shortly before its deadline and then spinning. Disabled by default.
+		bool	isHighPrecisionFrameRateEnabled() const { return mHighPrecisionFrameRate; }
+		//! Sets whether all windows using RendererGl render with a single GL context, avoiding a context switch per window and swapping all windows together with only the last swap waiting on vertical sync. Each window's viewport and matrices are preserved. Disabled by default. Currently only supported on Windows; elsewhere windows keep their own contexts, which share resources.
+		void	enableSingleGlContext( bool enable = true ) { mSingleGlContext = enable; }
+		//! Returns whether all windows using RendererGl render with a single GL context. Disabled by default.
+		bool	isSingleGlContextEnabled() const { return mSingleGlContext; }
+		//! Sets whether update() and draw() only run after the App is invalidated, rather than every frame. Input and window events, an active Timeline, dispatchAsync() and App::invalidate() invalidate the App, and frames are still limited to the frame rate. Disabled by default. Currently only supported by AppBasic and AppScreenSaver on Mac OS X and Windows.
+		void	enableOnDemandRendering( bool enable = true ) { mOnDemandRendering = enable; }
+		//! Returns whether update() and draw() only run after the App is invalidated. Disabled by default.
+		bool	isOnDemandRenderingEnabled() const { return mOnDemandRendering; }
 		
 		Settings();
 		virtual ~Settings() {}	  
@@ -223,9 +247,13 @@ class App {
             
 		bool			mFrameRateEnabled;
 		float			mFrameRate;
+		bool			mHighPrecisionFrameRate;
+		bool			mSingleGlContext;
+		bool			mOnDemandRendering;
 		bool			mPowerManagement; // allow screensavers or power management to hide app. default: false
 		bool			mEnableHighDensityDisplay;
 		bool			mEnableMultiTouch;
+		bool			mEnableTouchCoalescing, mEnableTouchHistory;
 		std::string		mTitle;
 		
 		friend class App;
@@ -354,6 +382,16 @@ class App {
 	double				getFpsSampleInterval() const { return mFpsSampleInterval; }
 	//! Sets the sampling rate in seconds for measuring the average frame-per-second as returned by getAverageFps()
 	void				setFpsSampleInterval( double sampleInterval ) { mFpsSampleInterval = sampleInterval; }	
+	//! Returns the App's FrameTiming, which measures the duration of every frame and its update, draw and swap phases and counts late frames
+	FrameTiming&		getFrameTiming() { return mFrameTiming; }
+	//! Returns the App's FrameTiming, which measures the duration of every frame and its update, draw and swap phases and counts late frames
+	const FrameTiming&	getFrameTiming() const { return mFrameTiming; }
+	//! Returns the queue behind dispatchAsync(), which sets the time spent running dispatched functions each frame and reports its depth and latency
+	MainThreadQueue&		getMainThreadQueue() { return mMainThreadQueue; }
+	//! Returns the queue behind dispatchAsync(), which sets the time spent running dispatched functions each frame and reports its depth and latency
+	const MainThreadQueue&	getMainThreadQueue() const { return mMainThreadQueue; }
+	//! Requests that update() and draw() run for the next frame when on-demand rendering is enabled, for example when a Capture or Movie has a new frame. Has no effect otherwise. Safe to call from any thread. \sa Settings::enableOnDemandRendering()
+	void				invalidate();
 
 	//! Returns whether the App is in full-screen mode or not.
 	bool				isFullScreen() const { return getWindow()->isFullScreen(); }
@@ -393,6 +431,8 @@ class App {
 	fs::path				getAssetPath( const fs::path &relativePath );
 	//! Adds an absolute path 'dirPath' to the list of directories which are searched for assets.
 	void					addAssetDirectory( const fs::path &dirPath );
+	//! Adds \a archive to the list of archives which are searched for assets and resources before the asset directories, in the order they were added. Archived assets have no path on disk, so getAssetPath() doesn't find them.
+	void					addAssetArchive( const AssetArchiveRef &archive );
 	
 	//! Returns the path to the application on disk
 	virtual fs::path			getAppPath() const = 0;
@@ -459,8 +499,9 @@ class App {
 
 	
 	
-	//! Executes a std::function on the App's primary thread ahead of the next update()
-	void	dispatchAsync( const std::function<void()> &fn );
+	/** Executes a std::function on the App's primary thread after the next update() and ahead of draw(). Higher \a priority functions run first, and
+		functions beyond the MainThreadQueue's budget are carried over to later frames. \sa getMainThreadQueue() **/
+	void	dispatchAsync( const std::function<void()> &fn, MainThreadQueue::Priority priority = MainThreadQueue::PRIORITY_NORMAL );
 	
 	template<typename T>
 	typename std::result_of<T()>::type dispatchSync( T fn )
@@ -475,7 +516,8 @@ class App {
 			std::packaged_task<result_type()> task( std::move(fn) );
 #endif
 			auto fute = task.get_future();
-			dispatchAsync( [&task]() { task(); } );
+			// the calling thread is blocked, so it goes ahead of the rest of the queue
+			dispatchAsync( [&task]() { task(); }, MainThreadQueue::PRIORITY_HIGH );
 			return fute.get();
 		}
 	}
@@ -497,6 +539,8 @@ class App {
 	// Internal handlers - these are called into by AppImpl's. If you are calling one of these, you have likely strayed far off the path.
 	virtual void	privateSetup__();
 	virtual void	privateUpdate__();
+	// Returns whether the next frame should be updated and drawn, which is always unless on-demand rendering is enabled, and clears the App's invalidation
+	bool			privateShouldRenderFrame__();
 	//! \endcond
 
 #if defined( CINDER_MSW )
@@ -517,6 +561,8 @@ class App {
 	static void		cleanupLaunch();
 	
 	virtual void	launch( const char *title, int argc, char * const argv[] ) = 0;
+	// Called by invalidate() to wake the run loop if it is waiting for the App to be invalidated. Can be called from any thread.
+	virtual void	wakeUp() {}
 	
 	//! \endcond
 
@@ -531,6 +577,8 @@ class App {
   private:
 	  void 		prepareAssetLoading();
 	  fs::path	findAssetPath( const fs::path &relativePath );
+	  // returns the asset named relativePath from the first archive which contains it, or an empty DataSourceRef if none does.
+	  DataSourceRef	loadArchivedAsset( const fs::path &relativePath );
   
 #if defined( CINDER_COCOA )
 	static void				*sAutoReleasePool;
@@ -542,6 +590,9 @@ class App {
 	uint32_t				mFpsLastSampleFrame;
 	double					mFpsLastSampleTime;
 	double					mFpsSampleInterval;
+	FrameTiming				mFrameTiming;
+	MainThreadQueue			mMainThreadQueue;
+	std::atomic<bool>		mInvalidated;
 
 	std::shared_ptr<Timeline>	mTimeline;
 
@@ -556,6 +607,8 @@ class App {
 	bool						mAssetDirectoriesInitialized;
 	// Path to directories which contain assets
 	std::vector<fs::path>		mAssetDirectories;
+	// Archives which are searched for assets ahead of mAssetDirectories
+	std::vector<AssetArchiveRef>	mAssetArchives;
 	
   protected:
 	static App*					sInstance;
@@ -601,6 +654,10 @@ inline float	getWindowContentScale() { return App::get()->getWindowContentScale(
 inline float	getFrameRate() { return App::get()->getFrameRate(); }
 //! Sets the maximum frame-rate the active App will attempt to maintain.
 inline void		setFrameRate( float frameRate ) { App::get()->setFrameRate( frameRate ); }
+//! Returns the active App's FrameTiming
+inline FrameTiming&	getFrameTiming() { return App::get()->getFrameTiming(); }
+//! Returns the active App's MainThreadQueue, which runs the functions passed to dispatchAsync()
+inline MainThreadQueue&	getMainThreadQueue() { return App::get()->getMainThreadQueue(); }
 //! Returns whether the active App is in full-screen mode or not.
 inline bool		isFullScreen() { return App::get()->isFullScreen(); }
 //! Sets whether the active App is in full-screen mode based on \a fullScreen
@@ -651,6 +708,8 @@ inline DataSourceRef		loadAsset( const fs::path &relativePath ) { return App::ge
 inline fs::path				getAssetPath( const fs::path &relativePath ) { return App::get()->getAssetPath( relativePath ); }
 //! Adds an absolute path \a dirPath to the active App's list of directories which are searched for assets.
 inline void					addAssetDirectory( const fs::path &dirPath ) { App::get()->addAssetDirectory( dirPath ); }
+//! Adds \a archive to the active App's list of archives which are searched for assets and resources before the asset directories.
+inline void					addAssetArchive( const AssetArchiveRef &archive ) { App::get()->addAssetArchive( archive ); }
 
 //! Returns the path to the active App on disk
 inline fs::path		getAppPath() { return App::get()->getAppPath(); }
@@ -183,6 +183,10 @@ class AppBasic : public App {
 	//! \endcond
 
   protected:
+#if defined( CINDER_MSW )
+	virtual void		wakeUp() override;
+#endif
+
 	static AppBasic*	sInstance;
 
 	EventSignalShouldQuit	mSignalShouldQuit;
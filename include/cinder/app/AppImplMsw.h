@@ -28,6 +28,7 @@
 #include "cinder/app/MouseEvent.h"
 #include "cinder/app/KeyEvent.h"
 #include "cinder/app/TouchEvent.h"
+#include "cinder/app/TouchCoalescer.h"
 #include "cinder/app/Renderer.h"
 #include "cinder/Display.h"
 #include "cinder/app/Window.h"
@@ -124,6 +125,8 @@ class WindowImplMsw {
 	virtual void*		getNative() { return mWnd; }
 
 	void			enableMultiTouch();
+	//! Delivers the touches coalesced since the previous frame, when touch coalescing is enabled
+	void			flushTouches();
 	bool			isBorderless() const { return mBorderless; }
 	void			setBorderless( bool borderless );
 	bool			isAlwaysOnTop() const { return mAlwaysOnTop; }
@@ -159,6 +162,9 @@ class WindowImplMsw {
 	RendererRef				mRenderer;
 	std::map<DWORD,Vec2f>			mMultiTouchPrev;
 	std::vector<TouchEvent::Touch>	mActiveTouches;
+	std::vector<TOUCHINPUT>			mTouchInputs;
+	bool							mCoalesceTouches;
+	TouchCoalescer					mTouchCoalescer;
 	bool					mIsDragging;
 
 	friend AppImplMsw;
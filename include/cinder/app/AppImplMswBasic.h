@@ -43,7 +43,9 @@ class AppImplMswBasic : public AppImplMsw {
 
 	class AppBasic*		getApp() { return mApp; }
 	
-	void	quit() { mShouldQuit = true; }
+	void	quit();
+	//! Wakes the run loop if it is waiting for the App to be invalidated. Can be called from any thread.
+	void	wakeUp();
 
 	float	setFrameRate( float aFrameRate );
 	void	disableFrameRate();
@@ -59,18 +61,23 @@ class AppImplMswBasic : public AppImplMsw {
 
   private:
 	void		sleep( double seconds );
+	void		sleepUntil( double deadlineSeconds );
+	void		waitForInvalidation();
 
 	WindowRef		createWindow( Window::Format format );
 	virtual void	closeWindow( class WindowImplMsw *windowImpl ) override;
 	virtual void	setForegroundWindow( WindowRef window ) override;
 	
-	bool		mShouldQuit;
+	std::atomic<bool>	mShouldQuit;
 	class AppBasic	*mApp;
 	
 
 	HINSTANCE				mInstance;
 	double					mNextFrameTime;
 	bool					mFrameRateEnabled;
+	bool					mHighPrecisionFrameRate;
+	bool					mOnDemandRendering;
+	HANDLE					mWakeEvent;
 
 	std::list<class WindowImplMswBasic*>	mWindows;
 	std::list<BlankingWindowRef>			mBlankingWindows;
@@ -38,6 +38,7 @@
 #include <d3d11_1.h>
 #include <dxgi.h>
 #include <dxgi1_2.h>
+#include <unordered_map>
 
 namespace cinder { namespace dx {
 class Texture;
@@ -109,6 +110,44 @@ class AppImplMswRendererDx : public AppImplMswRenderer {
 	void setRenderFlag(RenderStateFlag flag) { mStateFlags |= flag; }
 	void clearRenderFlag(RenderStateFlag flag) { mStateFlags &= ~(flag); }
 
+	//! Appends \a count clip-space vertices in the list topology \a topology to the pending draw batch. The batch is flushed first if \a topology, \a vs, \a ps or \a srv differ from it.
+	void batchVertices( const FixedVertex *verts, size_t count, D3D_PRIMITIVE_TOPOLOGY topology, ID3D11VertexShader *vs, ID3D11PixelShader *ps, ID3D11ShaderResourceView *srv );
+	//! Draws and empties the pending draw batch. Must be called before any change to pipeline state and before any other draw.
+	void flushBatch();
+
+	//! Binds the cached state object matching \a desc, creating it on first use. Nothing is rebound if it is already current.
+	void setBlendState( const D3D11_BLEND_DESC &desc );
+	//! Binds the cached state object matching \a desc, creating it on first use. Nothing is rebound if it is already current.
+	void setDepthStencilState( const D3D11_DEPTH_STENCIL_DESC &desc );
+	//! Binds the cached state object matching \a desc, creating it on first use. Nothing is rebound if it is already current.
+	void setRasterizerState( const D3D11_RASTERIZER_DESC &desc );
+
+	//! Uploads \a projection and \a modelView to mCBMatrices unless it already holds them
+	void updateMatrices( const Matrix44f &projection, const Matrix44f &modelView );
+	//! Uploads the current normal, texture coordinate and color to mCBFixedParameters unless it already holds them
+	void updateFixedParameters();
+	//! Uploads mLights to mCBLights unless it already holds them
+	void updateLights();
+
+	//! Number of vertices held by the batching ring buffer
+	static const UINT BATCH_RING_VERTICES = 8 * 65532;
+	//! Maximum number of vertices submitted by a single batched Draw; a multiple of 6 so that point, line and triangle lists are never split mid-primitive
+	static const UINT BATCH_MAX_DRAW_VERTICES = 65532;
+
+	//! Geometry from consecutive begin()/end(), drawSolidRect() and drawLine() calls which share the same draw state
+	struct DrawBatch
+	{
+		DrawBatch() : mTopology( D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED ), mVertexShader( NULL ), mPixelShader( NULL ), mShaderResourceView( NULL ) {}
+		D3D_PRIMITIVE_TOPOLOGY		mTopology;
+		ID3D11VertexShader			*mVertexShader;
+		ID3D11PixelShader			*mPixelShader;
+		ID3D11ShaderResourceView	*mShaderResourceView;
+		std::vector<FixedVertex>	mVerts;
+	};
+	DrawBatch mBatch;
+	//! Scratch storage for converting immediate mode primitives to list topologies
+	std::vector<FixedVertex> mImmediateModeListVerts;
+
 	//used for texture batch drawing
 	const dx::Texture *mCurrentBatchTexture;
 	std::vector<std::pair<const dx::Texture*, std::vector<FixedVertex>>> mBatchedTextures;
@@ -142,6 +181,7 @@ class AppImplMswRendererDx : public AppImplMswRenderer {
 	ID3D11Buffer *mCBMatrices;
 	ID3D11Buffer *mCBLights;
 	ID3D11Buffer *mCBFixedParameters;
+	//! Currently bound blend state, owned by mBlendStateCache
 	ID3D11BlendState *mBlendState;
 	D3D11_BLEND_DESC mBlendDesc;
 
@@ -175,11 +215,16 @@ class AppImplMswRendererDx : public AppImplMswRenderer {
 	ID3D11InputLayout *mFixedLayout;
 	ID3D11Buffer *mVertexBuffer;
 	ID3D11Buffer *mIndexBuffer;
+	//! Dynamic ring buffer filled with D3D11_MAP_WRITE_NO_OVERWRITE by flushBatch()
+	ID3D11Buffer *mBatchVertexBuffer;
+	UINT mBatchVertexOffset;
 
 	// no culling, solid fill mode, forward-facing triangles are CCW, no depth bias, no depth bias clamp, anti-aliased lines
+	// owned by mRasterizerStateCache
 	ID3D11RasterizerState *mDefaultRenderState;
 
 	// no depth testing or stencil testing
+	// owned by mDepthStencilStateCache
 	ID3D11DepthStencilState *mDepthStencilState;
 	D3D11_DEPTH_STENCIL_DESC mDepthStencilDesc;
 
@@ -199,7 +244,22 @@ class AppImplMswRendererDx : public AppImplMswRenderer {
 	void	handleLostDevice();
 	void	getPlatformWindowDimensions(DX_WINDOW_TYPE wnd, float* width, float* height) const;
 	void	releaseNonDeviceResources();
-	
+	bool	updateConstantBuffer( ID3D11Buffer *buffer, void *shadow, const void *data, size_t size, bool *valid );
+
+	//! State objects are immutable, so each distinct description is created once and kept for the lifetime of the device, keyed by a hash of the description
+	typedef std::unordered_multimap<size_t, std::pair<D3D11_BLEND_DESC, ID3D11BlendState*> >				BlendStateCache;
+	typedef std::unordered_multimap<size_t, std::pair<D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState*> >	DepthStencilStateCache;
+	typedef std::unordered_multimap<size_t, std::pair<D3D11_RASTERIZER_DESC, ID3D11RasterizerState*> >		RasterizerStateCache;
+	BlendStateCache			mBlendStateCache;
+	DepthStencilStateCache	mDepthStencilStateCache;
+	RasterizerStateCache	mRasterizerStateCache;
+
+	// last contents uploaded to each fixed function constant buffer
+	Matrix44f	mCBMatricesData[2];
+	Vec4f		mCBFixedParametersData[3];
+	LightData	mCBLightsData[8];
+	bool		mCBMatricesValid, mCBFixedParametersValid, mCBLightsValid;
+
 	int mStateFlags;
 	bool mFullScreen;
 	bool mVsyncEnable;
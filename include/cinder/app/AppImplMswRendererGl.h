@@ -40,15 +40,32 @@ class AppImplMswRendererGl : public AppImplMswRenderer {
 	virtual void	swapBuffers() const;
 	virtual void	makeCurrentContext();
 
+	HGLRC	getRc() const { return mRC; }
+	HDC		getDc() const { return mDC; }
+
+	//! While a swap pass is active, the swaps of renderers using the App's single shared context are deferred until endSwapPass(), which performs them together
+	static void		beginSwapPass();
+	//! Returns whether any swaps were performed
+	static bool		endSwapPass();
+
  protected:
 	bool	initializeInternal( HWND wnd, HDC dc, HGLRC sharedRC );
+	bool	initializeWithSingleContext( HDC dc );
 	int		initMultisample( PIXELFORMATDESCRIPTOR pfd, int requestedLevelIdx, HDC dc );
+	void	saveDrawableState();
+	void	restoreDrawableState();
 	
 	RendererGl	*mRenderer;
 	bool		mWasFullScreen;
 	bool		mWasVerticalSynced;
 	HGLRC		mRC, mPrevRC;
 	HDC			mDC;
+
+	// with App::Settings::enableSingleGlContext() all windows render with one context, and the viewport and matrices of each window's drawable are kept here while another's is current
+	bool		mUsesSingleContext;
+	bool		mHasDrawableState;
+	GLint		mViewport[4];
+	GLfloat		mProjection[16], mModelView[16];
 };
 
 } } // namespace cinder::app
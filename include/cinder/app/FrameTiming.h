@@ -0,0 +1,156 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Function.h"
+#include "cinder/Vector.h"
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+#include <deque>
+
+namespace cinder { namespace app {
+
+/** \brief Measures the duration of each frame of an App and of its update, draw and swap phases.
+ *
+ * Every App owns a FrameTiming, returned by App::getFrameTiming(). A frame begins with the App's update and its interval lasts until the next frame begins.
+ * A frame is late when its interval exceeds the target frame period by more than the late tolerance, which means the App missed one or more refreshes.
+ * Totals and percentiles cover every frame since the last reset() in constant memory, so that they can be relied on in long-running installations,
+ * while the most recent frames and late frames are kept in bounded histories. **/
+class FrameTiming : private boost::noncopyable {
+  public:
+	//! The timing of a completed frame, with all durations measured in seconds
+	struct Frame {
+		Frame() : mFrameNumber( 0 ), mStartTime( 0 ), mInterval( 0 ), mUpdateDuration( 0 ), mDrawDuration( 0 ), mSwapDuration( 0 ), mMissedFrames( 0 ) {}
+
+		//! The App's frame count when the frame began, as returned by App::getElapsedFrames()
+		uint32_t	mFrameNumber;
+		//! The time the frame began, in seconds since the App launched
+		double		mStartTime;
+		//! The time from the frame's beginning to the next frame's beginning
+		float		mInterval;
+		//! The duration of the App's update, including the update signal, App::update() and stepping the App's Timeline
+		float		mUpdateDuration;
+		//! The duration of drawing, summed over all windows and excluding the swap
+		float		mDrawDuration;
+		//! The duration of the Renderer's finishDraw(), which swaps buffers and may block until vertical sync, summed over all windows
+		float		mSwapDuration;
+		//! The number of frame periods missed by a late frame, 0 if the frame wasn't late
+		uint32_t	mMissedFrames;
+
+		//! Returns whether the frame was late
+		bool		isLate() const { return mMissedFrames > 0; }
+	};
+
+	//! Identifies a measurement of a Frame
+	enum Measure { INTERVAL, UPDATE, DRAW, SWAP, NUM_MEASURES };
+
+	FrameTiming();
+
+	//! Sets the frame rate that intervals are compared against. A value of \c 0, the default, uses the App's frame rate (App::getFrameRate()).
+	void		setTargetFrameRate( float frameRate ) { mTargetFrameRate = frameRate; }
+	//! Returns the frame rate that intervals are compared against, or \c 0 when the App's frame rate is used.
+	float		getTargetFrameRate() const { return mTargetFrameRate; }
+	//! Sets the fraction of a frame period by which an interval may exceed the period before the frame counts as late. Default is \c 0.5.
+	void		setLateTolerance( float tolerance ) { mLateTolerance = tolerance; }
+	//! Returns the fraction of a frame period by which an interval may exceed the period before the frame counts as late. Default is \c 0.5.
+	float		getLateTolerance() const { return mLateTolerance; }
+
+	//! Returns the number of frames completed since the last reset()
+	uint64_t	getNumFrames() const { return mNumFrames; }
+	//! Returns the number of late frames since the last reset()
+	uint64_t	getNumLateFrames() const { return mNumLateFrames; }
+	//! Returns the number of frame periods missed since the last reset(), which is the number of vertical syncs missed when the App runs at the display's refresh rate
+	uint64_t	getNumMissedFrames() const { return mNumMissedFrames; }
+	//! Returns the longest duration of \a measure since the last reset(), in seconds
+	float		getMax( Measure measure ) const { return mMax[measure]; }
+	//! Returns the mean duration of \a measure since the last reset(), in seconds
+	float		getMean( Measure measure ) const;
+	//! Returns the duration of \a measure that \a percentile (0 - 100) of the frames since the last reset() didn't exceed, in seconds. Accurate to 0.1 ms below 200 ms.
+	float		getPercentile( Measure measure, float percentile ) const;
+
+	//! Returns the most recently completed frame
+	const Frame&		getLastFrame() const { return mLastFrame; }
+	//! Returns the most recently completed frames, oldest first
+	std::vector<Frame>	getRecentFrames() const;
+	//! Sets the number of recently completed frames which are kept. Default is \c 600.
+	void				setRecentFramesSize( size_t size );
+	//! Returns the number of recently completed frames which are kept. Default is \c 600.
+	size_t				getRecentFramesSize() const { return mRecentSize; }
+	//! Returns the most recent late frames, oldest first
+	const std::deque<Frame>&	getLateFrames() const { return mLateFrames; }
+	//! Sets the number of late frames which are kept. Default is \c 1000.
+	void				setLateFramesSize( size_t size );
+	//! Returns the number of late frames which are kept. Default is \c 1000.
+	size_t				getLateFramesSize() const { return mLateFramesSize; }
+
+	//! Returns the signal emitted when a late frame completes, which is the next frame's beginning. Useful for logging slipped frames to disk.
+	signals::signal<void( const Frame& )>&	getSignalLateFrame() { return mSignalLateFrame; }
+
+	//! Clears all measurements
+	void		reset();
+
+	//! Sets whether an overlay of the frame timing is drawn over every window with a RendererGl. Disabled by default.
+	void		enableOverlay( bool enable = true ) { mOverlayEnabled = enable; }
+	//! Returns whether an overlay of the frame timing is drawn over every window with a RendererGl. Disabled by default.
+	bool		isOverlayEnabled() const { return mOverlayEnabled; }
+#if ! defined( CINDER_WINRT )
+	//! Draws the overlay of the frame timing at \a pos (measured in points) in the current window, which must have a RendererGl. Called automatically when the overlay is enabled.
+	void		drawOverlay( const Vec2f &pos = Vec2f( 10, 10 ) );
+#endif
+
+	//! \cond
+	// called by the App and the Window implementations
+	void		beginFrame( uint32_t frameNumber, double time, float appFrameRate );
+	void		addUpdateDuration( double seconds ) { mCurrentFrame.mUpdateDuration += (float)seconds; }
+	void		addDrawDuration( double seconds ) { mCurrentFrame.mDrawDuration += (float)seconds; }
+	void		addSwapDuration( double seconds ) { mCurrentFrame.mSwapDuration += (float)seconds; }
+	//! \endcond
+
+  private:
+	void		completeFrame( const Frame &frame );
+
+	float		mTargetFrameRate, mLateTolerance;
+	bool		mInFrame;
+	Frame		mCurrentFrame, mLastFrame;
+
+	uint64_t	mNumFrames, mNumLateFrames, mNumMissedFrames;
+	double		mSum[NUM_MEASURES];
+	float		mMax[NUM_MEASURES];
+	std::vector<uint32_t>	mHistograms[NUM_MEASURES];	// counts of frames per 0.1 ms bin, the last bin collecting longer durations
+
+	std::vector<Frame>	mRecentFrames;	// a ring buffer of mRecentSize frames
+	size_t				mRecentSize, mRecentNext;
+	std::deque<Frame>	mLateFrames;
+	size_t				mLateFramesSize;
+
+	signals::signal<void( const Frame& )>	mSignalLateFrame;
+
+	bool					mOverlayEnabled;
+	struct Overlay;
+	std::shared_ptr<Overlay>	mOverlay;
+};
+
+} } // namespace cinder::app
@@ -0,0 +1,110 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+
+namespace cinder { namespace app {
+
+/** \brief A queue of jobs run on the App's primary thread, highest priority first, within a time budget per frame.
+ *
+ * Every App owns a MainThreadQueue, returned by App::getMainThreadQueue(), which App::dispatchAsync() pushes onto from any thread. The App drains
+ * it once per frame, after update() and before draw(). With a budget set, draining stops once the budget is spent, and the remaining jobs are
+ * carried into the following frames, so that a burst of completions from worker threads, such as texture uploads after many image loads, is spread
+ * over several frames rather than making one of them late. Jobs of equal priority run in the order they were pushed. **/
+class MainThreadQueue : private boost::noncopyable {
+  public:
+	enum Priority { PRIORITY_HIGH, PRIORITY_NORMAL, PRIORITY_LOW, NUM_PRIORITIES };
+
+	MainThreadQueue();
+
+	//! Pushes \a fn to run on the primary thread with \a priority. Can be called from any thread.
+	void		push( const std::function<void()> &fn, Priority priority = PRIORITY_NORMAL );
+	/** Runs queued jobs until none remain or the budget is spent, returning the number run. At least one job runs when any is queued, so that
+		the queue always progresses, and jobs pushed by the jobs being run wait for the next drain. Called by the App every frame. **/
+	size_t		drain();
+	//! Discards all queued jobs without running them.
+	void		clear();
+
+	//! Sets the time in seconds that draining may take each frame, such as \c 0.004 for 4 ms. A value of \c 0, the default, runs every queued job.
+	void		setBudget( double seconds ) { mBudget = seconds; }
+	//! Returns the time in seconds that draining may take each frame, or \c 0 when every queued job runs.
+	double		getBudget() const { return mBudget; }
+
+	//! Returns the number of jobs waiting to run.
+	size_t		getDepth() const;
+	//! Returns the number of jobs of \a priority waiting to run.
+	size_t		getDepth( Priority priority ) const;
+
+	//! Returns the largest number of jobs waiting at once since the last resetStats()
+	size_t		getMaxDepth() const;
+	//! Returns the number of jobs run since the last resetStats()
+	uint64_t	getNumExecuted() const { return mNumExecuted; }
+	//! Returns the number of drains since the last resetStats() which ran out of budget with jobs still waiting
+	uint64_t	getNumDeferrals() const { return mNumDeferrals; }
+	//! Returns the mean time in seconds from pushing a job to running it, over the jobs run since the last resetStats()
+	double		getMeanLatency() const { return mNumExecuted ? mLatencySum / mNumExecuted : 0; }
+	//! Returns the longest time in seconds from pushing a job to running it since the last resetStats()
+	double		getMaxLatency() const { return mMaxLatency; }
+	//! Returns the number of jobs run by the most recent drain()
+	size_t		getLastNumExecuted() const { return mLastNumExecuted; }
+	//! Returns the duration in seconds of the most recent drain()
+	double		getLastDuration() const { return mLastDuration; }
+	//! Clears the statistics, but not the queued jobs.
+	void		resetStats();
+
+  private:
+	typedef std::chrono::steady_clock	Clock;
+
+	struct Job {
+		Job( const std::function<void()> &fn, uint64_t sequence ) : mFn( fn ), mSequence( sequence ), mPushTime( Clock::now() ) {}
+
+		std::function<void()>	mFn;
+		uint64_t				mSequence;
+		Clock::time_point		mPushTime;
+	};
+
+	// removes the oldest job of the highest priority pushed before \a endSequence into *result, returning false if there is none
+	bool		pop( uint64_t endSequence, Job *result );
+
+	mutable std::mutex	mMutex;
+	std::deque<Job>		mJobs[NUM_PRIORITIES];
+	size_t				mDepth, mMaxDepth;
+	uint64_t			mNextSequence;
+	double				mBudget;
+
+	// only touched by the primary thread
+	uint64_t			mNumExecuted, mNumDeferrals;
+	double				mLatencySum, mMaxLatency;
+	size_t				mLastNumExecuted;
+	double				mLastDuration;
+};
+
+} } // namespace cinder::app
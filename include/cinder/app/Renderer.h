@@ -43,6 +43,13 @@
 #include "cinder/Surface.h"
 #include "cinder/Display.h"
 
+#if !defined( CINDER_WINRT )
+namespace cinder { namespace gl {
+	typedef std::shared_ptr<class SharedContext>	SharedContextRef;
+	typedef std::shared_ptr<class ContextWorker>	ContextWorkerRef;
+} } // namespace cinder::gl
+#endif
+
 
 #if defined( CINDER_MAC )
 	#include <ApplicationServices/ApplicationServices.h>
@@ -186,6 +193,17 @@ class RendererGl : public Renderer {
 	virtual void	defaultResize();
 	virtual void	makeCurrentContext();
 	virtual Surface	copyWindowSurface( const Area &area );
+
+#if defined( CINDER_MSW )
+	//! Returns the Renderer's rendering context
+	HGLRC			getHglrc();
+	//! Returns the device context of the Renderer's window
+	HDC				getDc();
+#endif
+	//! Returns a new context which shares textures, buffers and shaders with the Renderer's, for creating resources on another thread. Must be called on the main thread. Throws gl::SharedContextExc on failure.
+	gl::SharedContextRef	createSharedContext();
+	//! Returns a new gl::ContextWorker with \a numThreads threads, each with a shared context, which creates resources in the background and hands them over to the main thread. Must be called on the main thread.
+	gl::ContextWorkerRef	createContextWorker( size_t numThreads = 1 );
 	
  protected:
 	RendererGl( const RendererGl &renderer );
@@ -0,0 +1,89 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Function.h"
+#include "cinder/app/TouchEvent.h"
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace cinder { namespace app {
+
+/** Collects the touches reported between frames and delivers them as at most one touchesBegan, touchesMoved and touchesEnded event per flush(),
+	in which every touch ID appears once. All the moves of a touch are merged into a single Touch at its latest position, whose previous position
+	is the one it had at the preceding flush(). With history enabled, each merged sample remains available through TouchEvent::getHistory().
+	Event and history storage is reused between flushes so that coalescing doesn't allocate once warmed up. Not thread-safe. **/
+class TouchCoalescer : private boost::noncopyable {
+  public:
+	typedef std::function<void ( TouchEvent *event )>	EventFn;
+
+	TouchCoalescer();
+
+	//! Sets whether every sample merged into a Touch is retained for TouchEvent::getHistory(). Disabled by default.
+	void	setHistoryEnabled( bool enable = true ) { mHistoryEnabled = enable; }
+	//! Returns whether every sample merged into a Touch is retained for TouchEvent::getHistory()
+	bool	isHistoryEnabled() const { return mHistoryEnabled; }
+
+	//! Records that \a touch began. Its previous position and native pointer are ignored.
+	void	touchBegan( const TouchEvent::Touch &touch );
+	//! Records that \a touch moved, merging it with any earlier moves of its ID since the last flush(). Its native pointer is ignored.
+	void	touchMoved( const TouchEvent::Touch &touch );
+	//! Records that \a touch ended. Its native pointer is ignored.
+	void	touchEnded( const TouchEvent::Touch &touch );
+
+	//! Returns whether any touches are waiting to be delivered by flush()
+	bool	hasPendingTouches() const { return ! mEntries.empty(); }
+	//! Delivers the pending touches to \a began, \a moved and \a ended as TouchEvents for \a window, then clears them. An ID which ended and began
+	//! again since the last flush() causes additional rounds of events so that each of its lifetimes is reported in order. Must not be called reentrantly.
+	void	flush( const WindowRef &window, const EventFn &began, const EventFn &moved, const EventFn &ended );
+	//! Delivers the pending touches through \a window's touchesBegan, touchesMoved and touchesEnded signals, then clears them
+	void	flush( const WindowRef &window );
+	//! Discards the pending touches without delivering them
+	void	clear();
+
+  private:
+	struct Entry {
+		uint32_t			mId;
+		// incremented each time an ID is reused after ending within a single flush
+		uint32_t			mGeneration;
+		bool				mBegan, mMoved, mEnded;
+		TouchEvent::Touch	mBeganTouch, mMovedTouch, mEndedTouch;
+	};
+
+	//! Returns the index of the latest entry for \a id, or -1 if there is none
+	int		findEntry( uint32_t id ) const;
+	size_t	addEntry( uint32_t id, uint32_t generation );
+	void	addHistory( size_t entryIndex, const TouchEvent::Touch &touch );
+	void	fillEvent( TouchEvent *event, const WindowRef &window, uint32_t generation, bool Entry::*phase, TouchEvent::Touch Entry::*touch );
+
+	bool							mHistoryEnabled;
+	std::vector<Entry>				mEntries;
+	// parallel to mEntries but never shrunk, so that the histories keep their storage
+	std::vector<std::vector<TouchEvent::Touch> >	mHistories;
+	TouchEvent						mBeganEvent, mMovedEvent, mEndedEvent;
+};
+
+} } // namespace cinder::app
@@ -56,7 +56,7 @@ class TouchEvent : public Event {
 		uint32_t	getId() const { return mId; }
 		//! Returns the timestamp associated with the touch, measured in seconds
 		double		getTime() const { return mTime; }
-		//! Returns a pointer to the OS-native object. This is a UITouch* on Cocoa Touch and a TOUCHPOINT* on MSW.
+		//! Returns a pointer to the OS-native object. This is a UITouch* on Cocoa Touch and a TOUCHPOINT* on MSW, and \c NULL for coalesced touches.
 		const void*	getNative() const { return mNative; }
 		
 	  private:
@@ -67,10 +67,10 @@ class TouchEvent : public Event {
 	};
 
 	TouchEvent()
-		: Event()
+		: Event(), mHasHistory( false )
 	{}
 	TouchEvent( WindowRef win, const std::vector<Touch> &touches )
-		: Event( win ), mTouches( touches )
+		: Event( win ), mTouches( touches ), mHasHistory( false )
 	{}
 	
 	//! Returns a std::vector of Touch descriptors associated with this event
@@ -78,9 +78,18 @@ class TouchEvent : public Event {
 	//! Returns a std::vector of Touch descriptors associated with this event
 	std::vector<Touch>&			getTouches() { return mTouches; }
 
+	//! Returns whether the event was coalesced by a TouchCoalescer with history enabled, making getHistory() available
+	bool						hasHistory() const { return mHasHistory; }
+	//! Returns every sample merged into the Touch at \a index in getTouches(), oldest first. Requires hasHistory().
+	const std::vector<Touch>&	getHistory( size_t index ) const { return mHistory[index]; }
+
   private:
-	std::vector<Touch>		mTouches;
-	bool					mHandled;
+	std::vector<Touch>					mTouches;
+	// sized to at least mTouches.size() when mHasHistory; never shrunk so that the inner vectors keep their storage
+	std::vector<std::vector<Touch> >	mHistory;
+	bool								mHasHistory;
+
+	friend class TouchCoalescer;
 };
 
 inline std::ostream& operator<<( std::ostream &out, const TouchEvent::Touch &touch )
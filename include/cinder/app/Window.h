@@ -37,6 +37,10 @@
 #include "cinder/Exception.h"
 
 
+namespace cinder { namespace gl {
+	class Fbo;
+} } // namespace cinder::gl
+
 namespace cinder { namespace app {
 
 class Window;
@@ -309,6 +313,23 @@ class Window : public std::enable_shared_from_this<Window> {
 	Area	toPoints( const Area &a ) const { const float s = 1.0f / getContentScale(); return Area( (int32_t)(a.x1 * s), (int32_t)(a.y1 * s), (int32_t)(a.x2 * s), (int32_t)(a.y2 * s) ); }
 	//! Returns a Rectf mapped from pixels to points by dividing by getContentScale()
 	Rectf	toPoints( const Rectf &a ) const { return a / getContentScale(); }
+
+	//! Marks all of the Window as needing to be redrawn, and invalidates the App. \sa App::invalidate()
+	void	invalidate() { invalidate( getBounds() ); }
+	//! Marks \a area, measured in points, as needing to be redrawn, and invalidates the App. Must be called from the primary thread. \sa enablePartialRedraw()
+	void	invalidate( const Area &area );
+	//! Returns the areas in points invalidated before the current or most recent draw(), which is all that needs to be redrawn. Empty when nothing was invalidated.
+	const std::vector<Area>&	getDirtyAreas() const { return mDirtyAreas; }
+	//! Returns the bounds in points of getDirtyAreas(), which is what is redrawn with partial redraw enabled. Returns an empty Area when nothing was invalidated.
+	Area	getDirtyArea() const;
+	/** \brief Sets whether only the invalidated areas of the Window are redrawn. Disabled by default.
+		With RendererGl the Window is drawn into a persistent Fbo with the scissor set to getDirtyArea(), and draw() is skipped when nothing was invalidated,
+		so everything that changes must be passed to invalidate(). Fbo::unbindFramebuffer() returns to the persistent Fbo, but binding framebuffer \c 0 directly bypasses it,
+		and the scissor test also clips drawing into other Fbos unless it is disabled around it.
+		With RendererDx on Windows 8 and WinRT the whole Window is redrawn, and only the dirty areas are presented. Window resizes invalidate all of the Window. **/
+	void	enablePartialRedraw( bool enable = true );
+	//! Returns whether only the invalidated areas of the Window are redrawn. Disabled by default.
+	bool	isPartialRedrawEnabled() const { return mPartialRedraw; }
 	
 	//! Returns the Window's title as a UTF-8 string.
 	std::string		getTitle() const;
@@ -476,7 +497,7 @@ class Window : public std::enable_shared_from_this<Window> {
 	App*			getApp() const { return mApp; }
 	
   protected:
-	Window() : mValid( true ), mImpl( 0 ) {}
+	Window() : mValid( true ), mPartialRedraw( false ), mImpl( 0 ) {}
   
 	void	testValid() const {
 		if( ! mValid )
@@ -484,6 +505,8 @@ class Window : public std::enable_shared_from_this<Window> {
 	}
 
 	void		setApp( App *app ) { mApp = app; }	
+	// draws the dirty areas into mPartialRedrawFbo and copies it to the window
+	void		drawPartialGl();
 
 #if defined( CINDER_COCOA )
   #if defined( __OBJC__ )
@@ -500,6 +523,11 @@ class Window : public std::enable_shared_from_this<Window> {
 	App							*mApp;
 	bool						mValid;
 	std::shared_ptr<void>		mUserData;
+
+	// the areas being drawn, and those invalidated since for the next draw
+	std::vector<Area>			mDirtyAreas, mPendingDirtyAreas;
+	bool						mPartialRedraw;
+	std::shared_ptr<gl::Fbo>	mPartialRedrawFbo;
 	
 	EventSignalMouse		mSignalMouseDown, mSignalMouseDrag, mSignalMouseUp, mSignalMouseWheel, mSignalMouseMove;
 	EventSignalTouch		mSignalTouchesBegan, mSignalTouchesMoved, mSignalTouchesEnded;
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "cinder/CinderAssert.h"
+#include "cinder/MemoryStats.h"
 
 #include <vector>
 #include <memory>
@@ -37,6 +38,11 @@
 
 namespace cinder { namespace audio {
 
+//! Counts the samples of all Buffer classes in the MemoryStats category "audio::Buffer"
+struct BufferMemoryTag {
+	static const char* getName()	{ return "audio::Buffer"; }
+};
+
 //! Base class for the various Buffer classes.  The template parameter T defined the sample type (precision).
 template <typename T>
 class BufferBaseT {
@@ -80,7 +86,7 @@ class BufferBaseT {
 		: mNumFrames( numFrames ), mNumChannels( numChannels ), mData( numFrames * numChannels )
 	{}
 
-	std::vector<T> mData;
+	std::vector<T, CountedAllocator<T, BufferMemoryTag> > mData;
 	size_t mNumChannels, mNumFrames;
 };
 
@@ -238,6 +244,9 @@ class BufferDynamicT : public BufferTT {
 	{
 		mAllocatedSize = this->getSize();
 		this->mData.resize( mAllocatedSize );
+
+		// resize() alone keeps the capacity, so the data is swapped into a vector that is just large enough
+		decltype( this->mData )( this->mData ).swap( this->mData );
 	}
 
 	//! Returns the number of samples allocated in this buffer (may be larger than getSize()).
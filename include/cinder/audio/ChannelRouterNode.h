@@ -88,6 +88,7 @@ class ChannelRouterNode : public Node {
   protected:
 	virtual bool supportsInputNumChannels( size_t numChannels ) const	override;
 	virtual bool supportsProcessInPlace() const							override;
+	virtual bool supportsSharedInputBuffers() const						override;
 	virtual void sumInputs()											override;
 	virtual void disconnectInput( const NodeRef &input )				override;
 
@@ -26,8 +26,10 @@
 #include "cinder/audio/Node.h"
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/OutputNode.h"
+#include "cinder/audio/dsp/RingBuffer.h"
+#include "cinder/Timer.h"
 
-#include <list>
+#include <condition_variable>
 #include <mutex>
 #include <set>
 #include <thread>
@@ -108,12 +110,64 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! \note Callers on the non-audio thread must synchronize with getMutex().
 	void removeAutoPulledNode( const NodeRef &node );
 
-	//! Schedule \a node to be enabled or disabled with with \a func on the audio thread, to be called at \a when seconds measured against getNumProcessedSeconds(). \a node is owned until the scheduled event completes.
+	//! \brief Schedule \a node to be enabled or disabled with with \a func on the audio thread, to be called at \a when seconds measured against getNumProcessedSeconds(). \a node is owned until the scheduled event completes.
+	//!
+	//! Events are sample accurate regardless of getFramesPerBlock(): the block in which an event lands is split at its frame offset with Node::getProcessFramesRange().
+	//! Scheduling doesn't block on getMutex(), the event is handed to the audio thread with postCommand() and kept in a list sorted by frame.
+	//! If an event is enabling a Node in the same block as an earlier event disabled it, the disable is superseded.
 	void schedule( double when, const NodeRef &node, bool enable, const std::function<void ()> &func );
 
+	//! Queues \a command to be executed on the audio thread at the beginning of the next processing block, without blocking the audio thread on getMutex(). Commands are executed in the order they were posted. If the Context is not enabled, \a command is executed immediately.
+	//! \note \a command must not allocate or block, and any objects it references must remain valid until it has executed (capture a shared_ptr if necessary).
+	void postCommand( const std::function<void ()> &command );
+
+	//! \brief Sets the number of additional threads (default = 0) used to render independent input branches of summing Node's in parallel.
+	//!
+	//! Each processing block, the inputs of a summing Node that have no shared Node's and no cycles are pulled across the render threads and
+	//! the audio thread, which then joins them before summing. When \a numThreads is 0, the graph is rendered serially on the audio thread.
+	//! \note This should be set before making connections, since Node's allocate a Buffer per input for parallel rendering when they are configured.
+	void	setNumRenderThreads( size_t numThreads );
+	//! Returns the number of additional threads used to render independent input branches in parallel.
+	size_t	getNumRenderThreads() const		{ return mRenderThreads.size(); }
+
+	//! \brief Enables or disables (default) profiling of the audio graph.
+	//!
+	//! While enabled, the time spent in each processing block and in each Node's process() method is measured on the audio thread.
+	//! The results can be read from any thread without locking, with the getProfile*() methods here and on Node.
+	void	setProfilingEnabled( bool enable = true );
+	//! Returns whether profiling of the audio graph is enabled. \see setProfilingEnabled()
+	bool	isProfilingEnabled() const				{ return mProfilingEnabled; }
+	//! Returns the duration in seconds of the most recently profiled processing block.
+	double	getProfileBlockSeconds() const			{ return mProfileBlockSeconds; }
+	//! Returns the load of the most recently profiled processing block, as a fraction of the time available for it (getFramesPerBlock() / getSampleRate()). Values near or above 1 will result in drop-outs.
+	float	getProfileBlockLoad() const				{ return mProfileBlockLoad; }
+	//! Returns the maximum value getProfileBlockLoad() has reached since profiling was enabled or resetProfile() was called.
+	float	getProfileBlockLoadPeak() const			{ return mProfileBlockLoadPeak; }
+	//! Returns the number of xruns (buffer underruns or overruns) reported by the OutputDeviceNode since the Context was created or resetProfile() was called. Xruns are counted whether or not profiling is enabled.
+	uint64_t getNumXruns() const					{ return mNumXruns; }
+	//! Clears the profiling peaks of the Context and all Node's, along with the xrun count.
+	void	resetProfile();
+	//! Called by OutputDeviceNode implementations on the audio thread when the device reports that \a count xruns have occurred.
+	void	markXrun( uint64_t count = 1 )			{ mNumXruns += count; }
+
+	//! \brief Enables or disables (default) sharing the internal and summing buffers of summing Node's across the audio graph.
+	//!
+	//! A summing Node's buffers are only in use while it is being pulled, since its output reads the result right after. When enabled, compileGraph()
+	//! runs whenever connections change and gives Node's that are never being pulled at the same time the same pair of buffers from a pool,
+	//! which then grows with the deepest nesting of summing Node's rather than with their number. Node's that are pulled from more than one place
+	//! (several outputs, a cycle, the Context's auto-pulled list or a Param) keep their own buffers, as does every Node while getNumRenderThreads() is non-zero.
+	void	setBufferSharingEnabled( bool enable = true );
+	//! Returns whether buffer sharing is enabled. \see setBufferSharingEnabled()
+	bool	isBufferSharingEnabled() const			{ return mBufferSharingEnabled; }
+	//! Assigns shared buffers to the Node's of the graph, see setBufferSharingEnabled(). Called automatically when connections change. A Node that reconfigures
+	//! its buffers, for example when its channel count changes, uses its own until this is called again.
+	void	compileGraph();
+	//! Returns the number of buffers in the shared pool, which is two per level of nested summing Node's. \see setBufferSharingEnabled()
+	size_t	getNumSharedBuffers() const				{ return mSharedBuffers.size(); }
+
 	//! Returns the mutex used to synchronize the audio thread. This is also used internally by the Node class when making connections.
 	std::mutex& getMutex() const			{ return mMutex; }
-	//! Returns true if the current thread is the thread used for audio processing, false otherwise.
+	//! Returns true if the current thread is the thread used for audio processing (or one of its render threads), false otherwise.
 	bool isAudioThread() const;
 
 	//! OutputNode implementations should call this before each rendering block.
@@ -121,23 +175,24 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! OutputNode implementations should call this after each rendering block.
 	void postProcess();
 
-	//! Returns a string representation of the Node graph for debugging purposes.
-	std::string printGraphToString();
+	//! Returns a string representation of the Node graph for debugging purposes. If \a includeProfile is true, the last and peak process() times of each Node are included (requires setProfilingEnabled()).
+	std::string printGraphToString( bool includeProfile = false );
 
   protected:
 	Context();
 
   private:
 	struct ScheduledEvent {
-		ScheduledEvent( uint64_t eventFrameThreshold, const NodeRef &node, bool enable, const std::function<void ()> &fn )
-			: mEventFrameThreshold( eventFrameThreshold ), mNode( node ), mEnable( enable ), mFunc( fn ), mFinished( false )
+		ScheduledEvent( uint64_t eventFrame, const NodeRef &node, bool enable, const std::function<void ()> &fn )
+			: mEventFrame( eventFrame ), mNode( node ), mEnable( enable ), mCancelled( false ), mFunc( fn ), mNext( nullptr )
 		{}
 
-		uint64_t				mEventFrameThreshold;
+		uint64_t				mEventFrame;
 		NodeRef					mNode;
 		bool					mEnable;
-		bool					mFinished;
+		bool					mCancelled;
 		std::function<void ()>	mFunc;
+		ScheduledEvent*			mNext;
 	};
 
 	void	disconnectRecursive( const NodeRef &node, std::set<NodeRef> &traversedNodes );
@@ -145,16 +200,36 @@ class Context : public std::enable_shared_from_this<Context> {
 	void	uninitRecursisve( const NodeRef &node, std::set<NodeRef> &traversedNodes  );
 	const	std::vector<Node *>& getAutoPulledNodes(); // called if there are any nodes besides output that need to be pulled
 	void	processAutoPulledNodes();
+	void	insertScheduledEvent( ScheduledEvent *event );
 	void	preProcessScheduledEvents();
 	void	postProcessScheduledEvents();
+	void	deleteScheduledEvents();
 	void	incrementFrameCount();
+	void	processCommands();
+	void	collectFinishedCommands();
+
+	// parallel rendering, see setNumRenderThreads(). renderParallel() is called by Node::sumInputs() and returns false if unable to dispatch from this thread.
+	bool	renderParallel( Node *node, size_t numJobs );
+	void	runRenderJobs( uint32_t generation, Node *node, size_t numJobs );
+	void	renderThreadLoop( double blockSeconds );
+	void	stopRenderThreads();
+
+	// requires mMutex to be held, see compileGraph()
+	void	compileGraphImpl();
+
+	friend class Node;
 
 	static void registerClearStatics();
 
 	bool						mEnabled;
 	std::atomic<uint64_t>		mNumProcessedFrames;
 	OutputNodeRef				mOutput;
-	std::list<ScheduledEvent>	mScheduledEvents;
+
+	// scheduled events are inserted on the audio thread into mScheduledEvents, a singly-linked list sorted by frame. The events that land within the current
+	// block are moved to mActiveEvents in preProcess() and then handed back through mFinishedEvents in postProcess(), so that they are deallocated on a non-audio thread.
+	ScheduledEvent*						mScheduledEvents;
+	ScheduledEvent*						mActiveEvents;
+	dsp::RingBufferT<ScheduledEvent *>	mFinishedEvents;
 
 	// other nodes that don't have any outputs and need to be explictly pulled
 	std::set<NodeRef>		mAutoPulledNodes;
@@ -165,6 +240,39 @@ class Context : public std::enable_shared_from_this<Context> {
 	mutable std::mutex		mMutex;
 	std::thread::id			mAudioThreadId;
 
+	// commands posted with postCommand() are executed on the audio thread and then handed back through
+	// mFinishedCommands, so that they are deallocated on a non-audio thread.
+	typedef std::function<void ()>			Command;
+	dsp::RingBufferT<Command *>				mCommands, mFinishedCommands;
+	std::mutex								mCommandsWriteMutex;
+
+	std::vector<std::thread>		mRenderThreads;
+	std::vector<std::thread::id>	mRenderThreadIds;
+	std::mutex						mRenderMutex;
+	std::condition_variable			mRenderCondition;
+	uint32_t						mRenderGeneration;		// guarded by mRenderMutex, along with mRenderNode and mRenderNumJobs
+	Node*							mRenderNode;
+	size_t							mRenderNumJobs;
+	std::atomic<uint64_t>			mRenderJobCounter;		// generation in the upper 32 bits, next job index in the lower 32 bits
+	std::atomic<size_t>				mRenderJobsFinished;
+	bool							mRenderThreadsShouldQuit, mRenderDispatching;
+
+	// profiling, see setProfilingEnabled(). mProfileGeneration is incremented by resetProfile() to signal Node's to reset their peaks.
+	std::atomic<bool>				mProfilingEnabled;
+	std::atomic<double>				mProfileBlockSeconds;
+	std::atomic<float>				mProfileBlockLoad, mProfileBlockLoadPeak;
+	std::atomic<uint64_t>			mNumXruns;
+	std::atomic<uint32_t>			mProfileGeneration;
+	uint32_t						mProfileBlockGeneration;	// only accessed on the audio thread
+	bool							mProfilingBlock;			// only accessed on the audio thread
+	Timer							mProfileTimer;
+	double							mTraceBlockBegin;			// beginning of the block's cinder::Profiler zone, negative if it isn't recorded
+
+	// buffer sharing, see setBufferSharingEnabled(). mSharedBuffers holds an internal and summing buffer per level, used by the Node's in mSharedBufferNodes.
+	bool								mBufferSharingEnabled;
+	std::vector<BufferDynamic>			mSharedBuffers;
+	std::vector<std::weak_ptr<Node> >	mSharedBufferNodes;
+
 	// - Context is stored in Node classes as a weak_ptr, so it needs to (for now) be created as a shared_ptr
 	static std::shared_ptr<Context>			sMasterContext;
 	static std::unique_ptr<DeviceManager>	sDeviceManager; // TODO: consider turning DeviceManager into a HardwareContext class
@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Target.h"
+
+#include <atomic>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class ContextOffline>		ContextOfflineRef;
+typedef std::shared_ptr<class OutputOfflineNode>	OutputOfflineNodeRef;
+
+//! \brief OutputNode that isn't tied to any hardware device, which is rendered by a ContextOffline.
+//!
+//! The samplerate and frames per block are fixed at construction. If the number of channels hasn't been specified via Node::Format, defaults to 2.
+class OutputOfflineNode : public OutputNode {
+  public:
+	OutputOfflineNode( size_t sampleRate, size_t framesPerBlock, const Format &format = Format() );
+
+	size_t getOutputSampleRate() override			{ return mSampleRate; }
+	size_t getOutputFramesPerBlock() override		{ return mFramesPerBlock; }
+
+  private:
+	//! Pulls one block through the graph into the internal buffer, which is silenced if it clips.
+	void renderBlock();
+
+	size_t	mSampleRate, mFramesPerBlock;
+
+	friend class ContextOffline;
+};
+
+//! \brief Context that renders its audio graph as fast as the CPU allows, rather than at the pace of a hardware device.
+//!
+//! Processing happens synchronously within render(), on whichever thread calls it. The calling thread is treated as the audio thread
+//! for the duration, so Node's connected to the graph should only be modified from other threads with the usual locking (or postCommand()).
+//! Useful for bouncing to a TargetFile, testing DSP Node's deterministically, or pre-rendering audio on a background thread.
+//! \note Hardware Node's (OutputDeviceNode and InputDeviceNode) can not be created by a ContextOffline.
+class ContextOffline : public Context {
+  public:
+	//! Creates a new ContextOffline, whose output renders \a numChannels channels at \a sampleRate in blocks of \a framesPerBlock.
+	static ContextOfflineRef	create( size_t sampleRate = 44100, size_t framesPerBlock = 512, size_t numChannels = 2 );
+
+	//! Throws AudioContextExc, since a ContextOffline has no hardware.
+	OutputDeviceNodeRef		createOutputDeviceNode( const DeviceRef &device = Device::getDefaultOutput(), const Node::Format &format = Node::Format() ) override;
+	//! Throws AudioContextExc, since a ContextOffline has no hardware.
+	InputDeviceNodeRef		createInputDeviceNode( const DeviceRef &device = Device::getDefaultInput(), const Node::Format &format = Node::Format() ) override;
+
+	//! Throws AudioContextExc if \a output is not an OutputOfflineNode.
+	void setOutput( const OutputNodeRef &output ) override;
+	//! Returns the OutputOfflineNode that this Context renders.
+	const OutputOfflineNodeRef&	getOutputOffline() const	{ return mOutputOffline; }
+
+	//! Callback passed to render(), which receives the output of each block along with the number of valid frames in it (the last block may be partial).
+	typedef std::function<void ( const Buffer &buffer, size_t numFrames )>	BlockCallback;
+
+	//! \brief Renders \a numFrames frames of the graph on the calling thread and returns once finished or cancel() is called. Returns the number of frames rendered.
+	//!
+	//! Each block's output is written to \a target and passed to \a blockCallback, when they are non-null. Processing always happens in whole blocks,
+	//! so getNumProcessedFrames() is rounded up to a multiple of getFramesPerBlock(), but only \a numFrames frames are delivered.
+	uint64_t	render( uint64_t numFrames, TargetFile *target = nullptr, const BlockCallback &blockCallback = BlockCallback() );
+	//! Renders \a seconds of audio, \see render().
+	uint64_t	renderSeconds( double seconds, TargetFile *target = nullptr, const BlockCallback &blockCallback = BlockCallback() );
+	//! Requests that the render() currently in progress (on another thread) stop after the current block. Safe to call from any thread.
+	void		cancel()					{ mCancelRequested = true; }
+	//! Returns true while render() is in progress.
+	bool		isRendering() const			{ return mRendering; }
+
+  protected:
+	ContextOffline();
+
+  private:
+	OutputOfflineNodeRef	mOutputOffline;
+	std::atomic<bool>		mCancelRequested, mRendering;
+};
+
+} } // namespace cinder::audio
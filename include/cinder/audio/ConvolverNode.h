@@ -0,0 +1,80 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/dsp/Fft.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class ConvolverNode>		ConvolverNodeRef;
+
+//! \brief Convolves its input with an impulse response, for example to apply reverb.
+//!
+//! Uses uniformly partitioned overlap-save FFT convolution: the impulse response is split into partitions of one processing block,
+//! which are transformed once when the impulse response is set. Each processing block the input is transformed once per channel and
+//! multiplied against all partitions in the frequency domain, so there is no added latency and the cost grows with the number of
+//! partitions only by one complex multiply-add per frequency bin.
+//! \note If the impulse response has one channel it is applied to all channels, otherwise channel \a ch uses impulse response channel `ch % numChannels`.
+class ConvolverNode : public Node {
+  public:
+	//! Constructs a ConvolverNode with an optional \a format.
+	ConvolverNode( const Format &format = Format() );
+	//! Constructs a ConvolverNode that convolves with \a impulseResponse, with an optional \a format.
+	ConvolverNode( const BufferRef &impulseResponse, const Format &format = Format() );
+
+	//! Sets the impulse response to \a impulseResponse, which should be at the same samplerate as the Context. The partitions are transformed on the calling thread.
+	void	setImpulseResponse( const BufferRef &impulseResponse );
+	//! Loads the impulse response from \a sourceFile, which is converted to the Context's samplerate if necessary.
+	void	setImpulseResponse( const SourceFileRef &sourceFile );
+	//! Returns the impulse response, or an empty BufferRef if none is set.
+	const BufferRef&	getImpulseResponse() const	{ return mImpulseResponse; }
+	//! Returns the number of partitions the current impulse response is split into, or 0 if it has not yet been prepared.
+	size_t	getNumPartitions() const			{ return mNumPartitions; }
+
+  protected:
+	void initialize()				override;
+	void uninitialize()				override;
+	void process( Buffer *buffer )	override;
+
+	//! Splits \a impulseResponse into \a blockSize partitions and transforms each of them, filling \a partitions and returning the number of partitions per channel.
+	static size_t	preparePartitions( const Buffer *impulseResponse, size_t blockSize, std::vector<BufferSpectral> *partitions );
+	//! Sizes the input history and frequency-domain delay line to the current number of channels and partitions. Must be synchronized with the audio thread.
+	void			setupDelayLine();
+
+	BufferRef						mImpulseResponse;
+	size_t							mBlockSize, mNumPartitions, mNumImpulseChannels, mDelayLineIndex;
+	std::unique_ptr<dsp::Fft>		mFft;
+	std::vector<BufferSpectral>		mPartitions;		// impulse response spectra, [impulse channel * mNumPartitions + partition]
+	std::vector<BufferSpectral>		mDelayLine;			// input spectra of the last mNumPartitions blocks, [channel * mNumPartitions + slot]
+	std::vector<Buffer>				mInputHistory;		// last two blocks of input per channel
+	BufferSpectral					mAccumSpectral;
+	Buffer							mOutputTime;
+};
+
+} } // namespace cinder::audio
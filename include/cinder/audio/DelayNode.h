@@ -26,9 +26,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "cinder/audio/Node.h"
 #include "cinder/audio/Param.h"
 
+#include <memory>
+#include <vector>
+
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class DelayNode>		DelayNodeRef;
+typedef std::shared_ptr<class MultiTapDelayNode>	MultiTapDelayNodeRef;
 
 //! \brief General purpose delay line, supporting variable delay with linear interpolation.
 //!
@@ -65,4 +69,54 @@ class DelayNode : public Node {
 	BufferDynamic	mDelayBuffer;
 };
 
+//! \brief Delay line with any number of taps reading from one shared buffer, for multi-tap echoes, chorus, flanging and granular delays.
+//!
+//! The output is the sum of all taps, each delayed by its own delay Param and scaled by its own gain Param. Either Param can be
+//! automated or driven by another Node (for example an LFO for modulation) with Param::setProcessor(). Taps are read with linear interpolation,
+//! and taps whose delay is constant for a block are read as one contiguous span of the buffer rather than sample by sample.
+//! Each channel is delayed independently. Enables feedback if connected in a graph cycle, and unlike DelayNode, delays shorter than one processing block are supported.
+class MultiTapDelayNode : public Node {
+  public:
+	//! Constructs a MultiTapDelayNode with \a numTaps taps, which all have a delay of 0 and a gain of 1, and an optional \a format.
+	MultiTapDelayNode( size_t numTaps = 1, const Format &format = Format() );
+
+	//! Sets the maximimum delay in seconds. Tap delays are clipped to this value.
+	void	setMaxDelaySeconds( float seconds );
+	//! Returns the maximum delay in seconds.
+	float	getMaxDelaySeconds() const		{ return mMaxDelaySeconds; }
+
+	//! Returns the number of taps.
+	size_t	getNumTaps() const				{ return mTaps.size(); }
+	//! Sets the delay of \a tap to \a delaySeconds and its gain to \a gain. The max delay is increased to \a delaySeconds if needed.
+	void	setTap( size_t tap, float delaySeconds, float gain = 1 );
+	//! Returns the Param used to automate the delay seconds of \a tap.
+	Param*	getParamDelaySeconds( size_t tap )	{ return &mTaps.at( tap )->mDelaySeconds; }
+	//! Returns the Param used to automate the gain of \a tap.
+	Param*	getParamGain( size_t tap )			{ return &mTaps.at( tap )->mGain; }
+
+	//! Clears any samples in the delay buffer (sets them to zero).
+	void clearBuffer();
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+	bool supportsCycles() const		override	{ return true; }
+
+  private:
+	struct Tap {
+		Tap( Node *parent ) : mDelaySeconds( parent, 0 ), mGain( parent, 1 )	{}
+
+		Param	mDelaySeconds, mGain;
+	};
+
+	void	allocateDelayBuffer();
+	void	writeBlock( const Buffer *buffer );
+	void	readTap( Tap *tap, size_t writeIndex, Buffer *buffer );
+
+	std::vector<std::unique_ptr<Tap> >	mTaps;
+	float			mMaxDelaySeconds, mSampleRate;
+	size_t			mWriteIndex, mRingFrames, mMaxDelayFrames;
+	BufferDynamic	mDelayBuffer;	// mRingFrames of ring buffer followed by a copy of its start, so reads near the end don't wrap
+};
+
 } } // namespace cinder::audio
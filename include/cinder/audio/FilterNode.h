@@ -35,8 +35,9 @@ namespace cinder { namespace audio {
 typedef std::shared_ptr<class FilterLowPassNode>		FilterLowPassNodeRef;
 typedef std::shared_ptr<class FilterHighPassNode>		FilterHighPassNodeRef;
 typedef std::shared_ptr<class FilterBandPassNode>		FilterBandPassNodeRef;
+typedef std::shared_ptr<class FilterEqNode>			FilterEqNodeRef;
 
-//! General class for filtering nodes based on a biquad (two pole, two zero) filter.
+//! General class for filtering nodes based on a biquad (two pole, two zero) filter. All channels are processed together with a dsp::BiquadBank.
 class FilterBiquadNode : public Node {
   public:
 	//! The modes that are available as 'preset' coefficients, which set the frequency response to a common type of filter.
@@ -70,9 +71,9 @@ class FilterBiquadNode : public Node {
 
 	void updateBiquadParams();
 
-	std::vector<dsp::Biquad> mBiquads;
+	dsp::Biquad mBiquad;		// used to design the coefficients, which are copied to mBiquadBank
+	dsp::BiquadBank mBiquadBank;
 	std::atomic<bool> mCoeffsDirty;
-	BufferT<double> mBufferd;
 	size_t mNiquist;
 
 	Mode mMode;
@@ -130,4 +131,57 @@ class FilterBandPassNode : public FilterBiquadNode {
 	float	getWidth() const			{ return mQ; }
 };
 
+//! \brief Multi-band filtering Node, made up of a cascade of biquad bands that are processed across all channels with a dsp::BiquadBank.
+//!
+//! Each band uses one of the FilterBiquadNode::Mode's, so for example a parametric EQ can be built from LOWSHELF, PEAKING and HIGHSHELF bands
+//! within one Node, rather than chaining a FilterBiquadNode per band.
+class FilterEqNode : public Node {
+  public:
+	typedef FilterBiquadNode::Mode Mode;
+
+	//! Constructs a FilterEqNode with \a numBands bands, which are initialized as Mode::PEAKING at 1000 hertz with a q of 1 and 0 decibels gain (pass-thru).
+	FilterEqNode( size_t numBands, const Format &format = Format() );
+	virtual ~FilterEqNode() {}
+
+	//! Returns the number of bands.
+	size_t	getNumBands() const							{ return mBands.size(); }
+
+	//! Sets all of the parameters of band \a band. \a freq is in hertz and \a gain in decibels.
+	void	setBand( size_t band, Mode mode, float freq, float q, float gain = 0 );
+	//! Sets the mode of band \a band.
+	void	setBandMode( size_t band, Mode mode )		{ mBands.at( band ).mMode = mode; mCoeffsDirty = true; }
+	//! Sets the frequency of band \a band in hertz.
+	void	setBandFreq( size_t band, float freq )		{ mBands.at( band ).mFreq = freq; mCoeffsDirty = true; }
+	//! Sets the q, or 'quality', parameter of band \a band.
+	void	setBandQ( size_t band, float q )			{ mBands.at( band ).mQ = q; mCoeffsDirty = true; }
+	//! Sets the gain of band \a band in decibels. Not used in all Mode's.
+	void	setBandGain( size_t band, float gain )		{ mBands.at( band ).mGain = gain; mCoeffsDirty = true; }
+
+	//! Returns the mode of band \a band.
+	Mode	getBandMode( size_t band ) const			{ return mBands.at( band ).mMode; }
+	//! Returns the frequency of band \a band in hertz.
+	float	getBandFreq( size_t band ) const			{ return mBands.at( band ).mFreq; }
+	//! Returns the q of band \a band.
+	float	getBandQ( size_t band ) const				{ return mBands.at( band ).mQ; }
+	//! Returns the gain of band \a band in decibels.
+	float	getBandGain( size_t band ) const			{ return mBands.at( band ).mGain; }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+	void updateBiquadParams();
+
+	struct Band {
+		Mode	mMode;
+		float	mFreq, mQ, mGain;
+	};
+
+	std::vector<Band>	mBands;
+	dsp::Biquad			mBiquad;
+	dsp::BiquadBank		mBiquadBank;
+	std::atomic<bool>	mCoeffsDirty;
+	size_t				mNiquist;
+};
+
 } } // namespace cinder::audio
@@ -38,6 +38,7 @@ typedef std::shared_ptr<class GenTriangleNode>		GenTriangleNodeRef;
 typedef std::shared_ptr<class GenTableNode>			GenTableNodeRef;
 typedef std::shared_ptr<class GenOscNode>			GenOscNodeRef;
 typedef std::shared_ptr<class GenPulseNode>			GenPulseNodeRef;
+typedef std::shared_ptr<class GenOscBankNode>		GenOscBankNodeRef;
 
 //! Base class for InputNode's that generate audio samples. Gen's are always mono channel.
 class GenNode : public InputNode {
@@ -54,6 +55,7 @@ class GenNode : public InputNode {
 	GenNode( float freq, const Format &format = Format() );
 
 	void initialize() override;
+	bool supportsProcessFramesRange() const override	{ return true; }
 	void initImpl();
 
 	float mSamplePeriod;
@@ -179,4 +181,57 @@ class GenPulseNode : public GenNode {
 	Param					mWidth;
 };
 
+//! \brief Bank of band-limited wavetable oscillators that share one WaveTable2d and are summed into a single mono output.
+//!
+//! This is much cheaper than connecting many GenOscNode's to a common output, for example for additive synthesis, since all
+//! oscillators are rendered in one pass. Frequencies and amplitudes are stored in contiguous arrays and are constant over
+//! a processing block, with amplitude changes ramped across the block to avoid zipper noise.
+//! \note The setters synchronize with the Context's mutex, so prefer setFreqs() and setAmps() when updating many oscillators at once.
+class GenOscBankNode : public InputNode {
+  public:
+	GenOscBankNode( size_t numOscillators = 0, WaveformType waveformType = WaveformType::SINE, const Format &format = Format() );
+
+	//! Sets the number of oscillators. New oscillators start with a frequency and amplitude of 0.
+	void	setNumOscillators( size_t numOscillators );
+	//! Returns the number of oscillators.
+	size_t	getNumOscillators() const				{ return mFreqs.size(); }
+
+	//! Sets the frequency in hertz of the oscillator at \a index.
+	void	setFreq( size_t index, float freq );
+	//! Returns the frequency in hertz of the oscillator at \a index.
+	float	getFreq( size_t index ) const			{ return mFreqs.at( index ); }
+	//! Sets the amplitude of the oscillator at \a index.
+	void	setAmp( size_t index, float amp );
+	//! Returns the amplitude of the oscillator at \a index.
+	float	getAmp( size_t index ) const			{ return mAmps.at( index ); }
+	//! Sets the frequencies of the oscillators starting at \a offset from the \a count values in \a freqs.
+	void	setFreqs( const float *freqs, size_t count, size_t offset = 0 );
+	//! Sets the amplitudes of the oscillators starting at \a offset from the \a count values in \a amps.
+	void	setAmps( const float *amps, size_t count, size_t offset = 0 );
+	//! Returns the contiguous array of oscillator frequencies in hertz.
+	const std::vector<float>&	getFreqs() const	{ return mFreqs; }
+	//! Returns the contiguous array of oscillator amplitudes.
+	const std::vector<float>&	getAmps() const		{ return mAmps; }
+
+	//! Sets the WaveformType of the internal wavetable. This can be a heavy operation and requires thread synchronization, so be careful not to block the audio thread for too long.
+	void setWaveform( WaveformType waveformType );
+	//! Assigns \a waveTable as the internal wavetable. This allows one to share a WaveTable2d with other Node's.
+	void setWaveTable( const WaveTable2dRef &waveTable )	{ mWaveTable = waveTable; }
+	//! Returns a reference to the current wavetable.
+	const WaveTable2dRef getWaveTable() const				{ return mWaveTable; }
+	//! Returns the current WaveformType
+	WaveformType	getWaveForm() const						{ return mWaveformType; }
+
+  protected:
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+	bool supportsProcessFramesRange() const override	{ return true; }
+
+	WaveTable2dRef		mWaveTable;
+	WaveformType		mWaveformType;
+
+	std::vector<float>	mFreqs, mAmps;			// target values, guarded by the Context's mutex
+	std::vector<float>	mPhases, mAmpsCurrent;	// the amplitudes reached at the end of the last processed block
+};
+
 } } // namespace cinder::audio
@@ -63,6 +63,8 @@ class InputDeviceNode : public InputNode {
 	uint64_t getLastUnderrun() const;
 	//! Returns the frame of the last buffer overrun or 0 if none since the last time this method was called.
 	uint64_t getLastOverrun() const;
+	//! Returns the number of input frames consumed per output frame to compensate for drift between the input and output device clocks, or 1 when they share a clock. \see dsp::DriftCompensator
+	virtual double getDriftCompensationRatio() const	{ return 1; }
 
   protected:
 	InputDeviceNode( const DeviceRef &device, const Format &format );
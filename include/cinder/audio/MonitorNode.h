@@ -97,7 +97,7 @@ class MonitorNode : public NodeAutoPullable {
 class MonitorSpectralNode : public MonitorNode {
   public:
 	struct Format : public MonitorNode::Format {
-		Format() : MonitorNode::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ) {}
+		Format() : MonitorNode::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ), mSpectrogramFrames( 0 ), mHopSize( 0 ) {}
 
 		//! Sets the FFT size, rounded up to the nearest power of 2 greater or equal to \a windowSize. Setting this larger than \a windowSize causes the FFT transform to be 'zero-padded'. Default is the same as windowSize.
 		//! \note resulting number of output spectral bins is equal to (\a size / 2)
@@ -106,9 +106,15 @@ class MonitorSpectralNode : public MonitorNode {
 		Format&		windowType( dsp::WindowType type )	{ mWindowType = type; return *this; }
 		//! \see Scope::windowSize()
 		Format&		windowSize( size_t size )			{ MonitorNode::Format::windowSize( size ); return *this; }
+		//! Enables the spectrogram, which keeps a history of the last \a numFrames magnitude spectra computed on the audio thread. Default is 0 (disabled). \see getSpectrogram()
+		Format&		spectrogramFrames( size_t numFrames )	{ mSpectrogramFrames = numFrames; return *this; }
+		//! Sets the number of samples between sequential spectrogram frames. Default (0) is the window size, values smaller than that cause the analysis windows to overlap.
+		Format&		hopSize( size_t size )					{ mHopSize = size; return *this; }
 
 		size_t			getFftSize() const				{ return mFftSize; }
 		dsp::WindowType	getWindowType() const			{ return mWindowType; }
+		size_t			getSpectrogramFrames() const	{ return mSpectrogramFrames; }
+		size_t			getHopSize() const				{ return mHopSize; }
 
 		// reimpl Node::Format
 		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
@@ -118,6 +124,7 @@ class MonitorSpectralNode : public MonitorNode {
       protected:
 		size_t			mFftSize;
 		dsp::WindowType	mWindowType;
+		size_t			mSpectrogramFrames, mHopSize;
 	};
 
 	MonitorSpectralNode( const Format &format = Format() );
@@ -136,8 +143,28 @@ class MonitorSpectralNode : public MonitorNode {
 	//! Sets the factor (0 - 1, default = 0.5) used when smoothing the magnitude spectrum between sequential calls to getMagSpectrum()
 	void	setSmoothingFactor( float factor );
 
+	//! \brief Returns the spectrogram history: getSpectrogramFrames() rows of getNumBins() magnitudes each, ordered from oldest to newest.
+	//!
+	//! The magnitude spectra are computed on the audio thread every getHopSize() samples and handed over with a lock-free dsp::RingBufferT,
+	//! so this only copies frames that were computed since the previous call. Returns an empty vector if the spectrogram is not enabled with Format::spectrogramFrames().
+	const std::vector<float>&	getSpectrogram();
+	//! Returns a pointer to the getNumBins() magnitudes of spectrogram frame \a frame, where 0 is the oldest. \note Call getSpectrogram() first to update the history.
+	const float*	getSpectrogramFrame( size_t frame ) const	{ return &mSpectrogram[frame * getNumBins()]; }
+	//! Returns the number of frames kept in the spectrogram history, or 0 if it is disabled.
+	size_t	getSpectrogramFrames() const	{ return mSpectrogramFrames; }
+	//! Returns the number of samples between sequential spectrogram frames.
+	size_t	getHopSize() const				{ return mHopSize; }
+	//! Returns the number of new frames that were added to the spectrogram during the last call to getSpectrogram().
+	size_t	getNumNewSpectrogramFrames() const	{ return mNumNewSpectrogramFrames; }
+
   protected:
 	void initialize() override;
+	void process( Buffer *buffer ) override;
+
+	//! Called on the audio thread, collects samples and computes a magnitude frame every mHopSize samples.
+	void processSpectrogram( const Buffer *buffer );
+	//! Transforms the windowed samples in \a fftBuffer with \a fft and smooths the normalized magnitudes into \a magSpectrum by \a smoothingFactor.
+	void computeMagnitudes( dsp::Fft *fft, Buffer *fftBuffer, BufferSpectral *bufferSpectral, float *magSpectrum, float smoothingFactor );
 
   private:
 	std::unique_ptr<dsp::Fft>	mFft;
@@ -148,6 +175,16 @@ class MonitorSpectralNode : public MonitorNode {
 	size_t						mFftSize;
 	dsp::WindowType				mWindowType;
 	float						mSmoothingFactor;
+
+	// spectrogram, the members below up to mSpectrogramRing are only used on the audio thread
+	size_t						mSpectrogramFrames, mHopSize, mNumNewSpectrogramFrames;
+	std::unique_ptr<dsp::Fft>	mSpectrogramFft;
+	Buffer						mSpectrogramFftBuffer, mAnalysisBuffer;
+	BufferSpectral				mSpectrogramSpectral;
+	std::vector<float>			mSpectrogramFrame;
+	size_t						mAnalysisWriteIndex, mSamplesUntilHop;
+	dsp::RingBufferT<float>		mSpectrogramRing;	// magnitude frames written on the audio thread, read in getSpectrogram()
+	std::vector<float>			mSpectrogram;		// history, mSpectrogramFrames x getNumBins()
 };
 
 } } // namespace cinder::audio
@@ -25,6 +25,7 @@
 
 #include "cinder/audio/Buffer.h"
 #include "cinder/audio/Exception.h"
+#include "cinder/Timer.h"
 
 #include <boost/noncopyable.hpp>
 #include <boost/logic/tribool.hpp>
@@ -150,6 +151,8 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	bool		isInitialized() const				{ return mInitialized; }
 	//! Returns whether this Node will process audio with an in-place Buffer.
 	bool		getProcessesInPlace() const			{ return mProcessInPlace; }
+	//! Returns whether this Node's internal and summing buffers are shared with other Node's. \see Context::setBufferSharingEnabled()
+	bool		isSharingBuffers() const			{ return mSharesBuffers; }
 	//! Returns whether it is possible to connect to \a input, example reasons of failure would be this == Node, or Node is already an input.
 	bool		canConnectToInput( const NodeRef &input );
 	//! Returns true if there is an unmanageable cycle betweeen \a sourceNode and \a destNode. If any Node's in the traversal returns true for supportsCycles(), this method will return false.
@@ -166,12 +169,17 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	void				setName( const std::string &name )	{ mName = name; }
 
 	//! Usually used internally by a Node subclass, returns a pointer to the internal buffer storage.
-	Buffer*			getInternalBuffer()			{ return &mInternalBuffer; }
+	Buffer*			getInternalBuffer()			{ return mInternalBuffer; }
 	//! Usually used internally by a Node subclass, returns a pointer to the internal buffer storage.
-	const Buffer*	getInternalBuffer() const	{ return &mInternalBuffer; }
+	const Buffer*	getInternalBuffer() const	{ return mInternalBuffer; }
 	//! Usually called internally by the Node, in special cases sub-classes may need to call this on other Node's.
 	void			pullInputs( Buffer *inPlaceBuffer );
 
+	//! Returns the number of seconds spent in this Node's process() method during the most recently profiled processing block. \see Context::setProfilingEnabled()
+	double		getProfileProcessSeconds() const		{ return mProfileProcessSeconds; }
+	//! Returns the maximum value of getProfileProcessSeconds() since profiling was enabled or Context::resetProfile() was called.
+	double		getProfileProcessSecondsPeak() const	{ return mProfileProcessSecondsPeak; }
+
   protected:
 
 	//! Called before audio buffers need to be used. There is always a valid Context at this point.
@@ -193,6 +201,12 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	virtual bool supportsCycles() const									{ return false; }
 	//! Default implementation returns true, subclasses should return false if they must process out-of-place (summing).
 	virtual bool supportsProcessInPlace() const							{ return true; }
+	//! Default implementation returns false, in which case process() is called with a sub-block containing only the frames within getProcessFramesRange() when an event is scheduled mid-block.
+	//! Subclasses that handle getProcessFramesRange() themselves should return true.
+	virtual bool supportsProcessFramesRange() const						{ return false; }
+	//! Default implementation returns true. Subclasses that pull an input more than once per block, or read its internal buffer anywhere but right after pulling it,
+	//! should return false so that their inputs keep their own buffers. \see Context::setBufferSharingEnabled()
+	virtual bool supportsSharedInputBuffers() const						{ return true; }
 
 	//! \note Connection methods \must be called on a non-audio thread and synchronized with the Context's mutex.
 	virtual void connectInput( const NodeRef &input );
@@ -203,6 +217,8 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	void setupProcessWithSumming();
 	void notifyConnectionsDidChange();
 	bool inputChannelsAreUnequal() const;
+	//! Returns true if this Node and all of its inputs have no more than one output and do not support cycles, in which case it can be pulled on a separate thread. \see Context::setNumRenderThreads()
+	bool isIndependentBranch() const;
 
 	//! Only Node subclasses can specify num channels directly - users specify via Format at construction time.
 	void setNumChannels( size_t numChannels );
@@ -212,18 +228,27 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	//! \brief Returns a pair of frame indices for Nodes that wish to support sample accurate enable and disable.
 	//!
 	//! The first index is where processing should start, the second is where it should	end. Should only be called on the audio thread from within a Node's process() method.
-	//! Unless scheduled (with Context::schedule()), this will be [0, getFramesPerBlock()]
+	//! Unless scheduled (with Context::schedule()), this will be [0, getFramesPerBlock()]. Only relevant to subclasses that return true from supportsProcessFramesRange().
 	const std::pair<size_t, size_t>& getProcessFramesRange() const	{ return mProcessFramesRange; }
 
 	void initializeImpl();
 	void uninitializeImpl();
 
-	BufferDynamic*			getSummingBuffer()			{ return &mSummingBuffer; }
-	const BufferDynamic*	getSummingBuffer() const	{ return &mSummingBuffer; }
+	BufferDynamic*			getSummingBuffer()			{ return mSummingBuffer; }
+	const BufferDynamic*	getSummingBuffer() const	{ return mSummingBuffer; }
 
   private:
 	// The owning Context calls this.
 	void setContext( const ContextRef &context )	{ mContext = context; }
+	// Called by the Context's render threads, pulls mParallelInputs[index] into its own buffer.
+	void pullParallelInput( size_t index );
+	// Calls process( buffer ), measuring its duration if the Context is profiling.
+	void processImpl( Buffer *buffer );
+	// Calls process( buffer ), or on a sub-block of it if mProcessFramesRange doesn't cover the block and process() doesn't support that.
+	void processFramesRange( Buffer *buffer );
+	// Called by the Context when compiling the graph, see Context::setBufferSharingEnabled().
+	void useOwnedBuffers();
+	void useSharedBuffers( BufferDynamic *internalBuffer, BufferDynamic *summingBuffer );
 
 	std::weak_ptr<Context>	mContext;
 	std::atomic<bool>		mEnabled;
@@ -234,14 +259,27 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	size_t					mNumChannels;
 
 	std::pair<size_t, size_t>	mProcessFramesRange;
+	BufferDynamic				mSubBlockBuffer;		// allocated by Context::schedule(), see processFramesRange()
 
 	uint64_t				mLastProcessedFrame;
 	std::string				mName;
-	BufferDynamic			mInternalBuffer, mSummingBuffer;
+
+	std::atomic<double>		mProfileProcessSeconds, mProfileProcessSecondsPeak;
+	uint32_t				mProfileGeneration;
+	Timer					mProfileTimer;
+	BufferDynamic			mOwnedInternalBuffer, mOwnedSummingBuffer;
+	// point to the owned buffers, or to a pair shared with other Node's when the Context has buffer sharing enabled
+	BufferDynamic			*mInternalBuffer, *mSummingBuffer;
+	bool					mSharesBuffers;
+	bool					mIsParamProcessor;		// set by Param::setProcessor(), such Node's are also pulled outside of the graph
 
 	std::set<std::shared_ptr<Node> >	mInputs;
 	std::vector<std::weak_ptr<Node> >	mOutputs;
 
+	// storage used by sumInputs() when the Context has render threads, sized to mInputs in setupProcessWithSumming()
+	std::vector<Node *>					mParallelInputs;
+	std::vector<BufferDynamic>			mParallelBuffers;
+
 	friend class Context;
 	friend class Param;
 };
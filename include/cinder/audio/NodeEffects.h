@@ -30,3 +30,4 @@
 #include "cinder/audio/DelayNode.h"
 #include "cinder/audio/PanNode.h"
 #include "cinder/audio/FilterNode.h"
+#include "cinder/audio/ConvolverNode.h"
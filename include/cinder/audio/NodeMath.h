@@ -27,6 +27,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "cinder/audio/Param.h"
 #include "cinder/CinderMath.h"
 
+#include <vector>
+
 namespace cinder { namespace audio {
 
 //! Base class for an arithmetic based Node.
@@ -86,4 +88,106 @@ class DivideNode : public MathNode {
 	void process( Buffer *buffer ) override;
 };
 
+//! \brief Node that evaluates an arithmetic expression of its input, Param's and constants in a single process() call.
+//!
+//! A chain of MathNode's is pulled and processed one Node at a time. ExpressionNode instead compiles the whole expression when it is set,
+//! into a short program of vectorized operations over a few block-sized registers: constant terms are folded, terms that don't depend on
+//! the input are evaluated once per block rather than once per channel, and a product that is added to is fused into one operation.
+//! Other Node's take part through the Param's, with Param::setProcessor(). For example `( input * lfo + offset ) * gain`:
+//! \code
+//! auto node = ctx->makeNode( new audio::ExpressionNode( 3 ) );
+//! node->setExpression( ( node->input() * node->param( 0 ) + node->param( 1 ) ) * node->param( 2 ) );
+//! node->getParam( 0 )->setProcessor( lfo );
+//! \endcode
+class ExpressionNode : public Node {
+  public:
+	//! An arithmetic expression, built from input(), param(), constants and the operators +, -, * and /.
+	class Expr {
+	  public:
+		//! Constructs an Expr that evaluates to \a constant.
+		Expr( float constant = 0 );
+
+		friend Expr operator+( const Expr &lhs, const Expr &rhs )	{ return Expr( Op::ADD, lhs, rhs ); }
+		friend Expr operator-( const Expr &lhs, const Expr &rhs )	{ return Expr( Op::SUBTRACT, lhs, rhs ); }
+		friend Expr operator*( const Expr &lhs, const Expr &rhs )	{ return Expr( Op::MULTIPLY, lhs, rhs ); }
+		friend Expr operator/( const Expr &lhs, const Expr &rhs )	{ return Expr( Op::DIVIDE, lhs, rhs ); }
+		friend Expr operator-( const Expr &expr )					{ return Expr( Op::SUBTRACT, Expr( 0 ), expr ); }
+
+	  private:
+		enum class Op { CONSTANT, INPUT, PARAM, ADD, SUBTRACT, MULTIPLY, DIVIDE, MULTIPLY_ADD };
+		struct Term;
+
+		Expr( Op op, const Expr &lhs, const Expr &rhs );
+		Expr( Op op, size_t paramIndex );
+
+		std::shared_ptr<const Term>	mTerm;
+
+		friend class ExpressionNode;
+	};
+
+	//! Constructs an ExpressionNode with \a numParams Param's, which all have an initial value of 0. The expression defaults to input().
+	ExpressionNode( size_t numParams = 0, const Format &format = Format() );
+
+	//! Returns an Expr for the input of this Node, which is evaluated once per channel.
+	static Expr	input();
+	//! Returns an Expr for the Param at \a index. \see getParam()
+	static Expr	param( size_t index );
+
+	//! Compiles \a expr and replaces the current expression with it. Throws AudioExc if \a expr refers to a Param that doesn't exist.
+	void	setExpression( const Expr &expr );
+	//! Returns the Param at \a index, which can be set to a value, ramped or driven by another Node.
+	Param*	getParam( size_t index )		{ return mParams.at( index ).get(); }
+	//! Returns the number of Param's.
+	size_t	getNumParams() const			{ return mParams.size(); }
+	//! Returns the number of vectorized operations the current expression compiled to, per block and per channel.
+	size_t	getNumOperations() const		{ return mProgram.mBlockInstructions.size() + mProgram.mChannelInstructions.size(); }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	typedef Expr::Op	Op;
+	typedef Expr::Term	Term;
+	enum class Source { CONSTANT, INPUT, PARAM, REGISTER };
+
+	struct Operand {
+		Source	mSource;
+		float	mConstant;
+		size_t	mIndex;		// of the Param or register
+	};
+
+	struct Instruction {
+		Op		mOp;
+		Operand	mOperands[3];
+		size_t	mDest;
+	};
+
+	// instructions that don't depend on the input are executed once per block, the rest once per channel
+	struct Program {
+		std::vector<Instruction>	mBlockInstructions, mChannelInstructions;
+		Operand						mResult;
+		size_t						mNumRegisters;
+	};
+
+	// a value while processing, either an array of the block's frames or a scalar (when mArray is null)
+	struct Value {
+		const float*	mArray;
+		float			mScalar;
+	};
+
+	struct Compiler;
+
+	Value			resolve( const Operand &operand, const float *inputChannel );
+	void			execute( const Instruction &instruction, const float *inputChannel, size_t numFrames );
+	void			allocateRegisters();
+	static Value	apply( Op op, const Value &lhs, const Value &rhs, float *dest, size_t numFrames );
+
+	std::vector<std::unique_ptr<Param> >	mParams;
+	std::vector<char>						mParamsVarying;
+	Program									mProgram;
+	BufferDynamic							mRegisters;
+	std::vector<Value>						mRegisterValues;
+};
+
 } } // namespace cinder::audio
@@ -39,6 +39,8 @@ typedef std::shared_ptr<class Event>			EventRef;
 //! note: unless we want to add _VARIADIC_MAX=6 in preprocessor definitions to all projects, number of args here has to be 5 or less for vc11 support
 typedef std::function<void ( float *, size_t, float, float, const std::pair<float, float>& )>	RampFn;
 
+// The built-in ramping functions below are vectorized. When one of them is passed to Param::Options::rampFn(), Param calls it directly instead of through the RampFn.
+
 //! Array-based linear ramping function.
 void rampLinear( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
 //! Array-based quadradic (t^2) ease-in ramping function.
@@ -67,12 +69,19 @@ class Event {
   private:
 	Event( float timeBegin, float timeEnd, float valueBegin, float valueEnd, bool copyValueOnBegin, const RampFn &rampFn );
 
+	//! Evaluates the ramp into \a array, bypassing mRampFn for the built-in ramping functions.
+	void rampImpl( float *array, size_t count, float t, float tIncr ) const;
+
+	// identifies the built-in ramping functions, detected from mRampFn at construction
+	enum class RampType { CUSTOM, LINEAR, IN_QUAD, OUT_QUAD };
+
 	float				mTimeBegin, mTimeEnd, mDuration;
 	float				mValueBegin, mValueEnd;
 	std::atomic<bool>	mIsComplete, mIsCanceled;
 	bool				mCopyValueOnBegin;
 
-	RampFn	mRampFn;
+	RampFn		mRampFn;
+	RampType	mRampType;
 
 	friend class Param;
 };
@@ -118,7 +127,7 @@ class Param {
 	//! Constructs a Param with a pointer (weak reference) to the owning parent Node and an optional \a initialValue (default = 0).
 	Param( Node *parentNode, float initialValue = 0 );
 
-	//! Sets the value of the Param, blowing away any scheduled Event's or processing Node. \note Must be called from a non-audio thread.
+	//! Sets the value of the Param, blowing away any scheduled Event's or processing Node. The change is posted to the audio thread with Context::postCommand(), so this never blocks the audio thread.
 	void	setValue( float value );
 	//! Returns the current value of the Param.
 	float	getValue() const	{ return mValue; }
@@ -142,6 +151,13 @@ class Param {
 	//! Returns this Param's processing Node, or an empty NodeRef if none is set.
 	NodeRef	getProcessor() const	{ return mProcessor; }
 
+	//! Sets whether Event's are evaluated at control rate (default = false). If true, they are evaluated once per processing block and
+	//! linearly interpolated from the previous block's value, which is much cheaper than sample-accurate evaluation when there are many
+	//! Param's ramping simultaneously, at the cost of ramp shapes and Event boundaries only being honored at block resolution.
+	void	setControlRate( bool controlRate )		{ mIsControlRate = controlRate; }
+	//! Returns whether Event's are evaluated at control rate. \see setControlRate()
+	bool	isControlRate() const					{ return mIsControlRate; }
+
 	//! Resets Param, blowing away any Event's or processing Node. \note Must be called from a non-audio thread.
 	void reset();
 	//! Returns the number of Event's that are currently scheduled.
@@ -167,11 +183,16 @@ class Param {
 	void		initInternalBuffer();
 	void		resetImpl();
 	void		removeEventsAt( float time );
+	// queues \a event to replace any Event's ending after it begins on the audio thread, see Context::postCommand()
+	void		postApplyEvent( const EventRef &event );
+	// evaluates the Param once at the end of the block and fills \a array with a linear ramp from the previous block's value
+	bool		evalControlRate( float timeBegin, float *array, size_t arrayLength, size_t sampleRate );
 	ContextRef	getContext() const;
 
 	std::list<EventRef>	mEvents;
 	std::atomic<float>	mValue;
 	bool				mIsVaryingThisBlock;
+	std::atomic<bool>	mIsControlRate;
 	Node*				mParentNode;
 	NodeRef				mProcessor;
 	BufferDynamic		mInternalBuffer;
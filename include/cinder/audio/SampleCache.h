@@ -0,0 +1,234 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Source.h"
+#include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class MappedSample>		MappedSampleRef;
+typedef std::shared_ptr<class SampleCache>		SampleCacheRef;
+typedef std::shared_ptr<class BufferCache>		BufferCacheRef;
+typedef std::shared_ptr<class BufferPreload>	BufferPreloadRef;
+
+//! \brief Decoded audio samples backed by a memory-mapped cache file of planar, 32-bit float samples.
+//!
+//! MappedSample's are created by a SampleCache. The channel count, samplerate and number of frames are known right away, while the
+//! samples become available once the SampleCache has decoded the source file in the background, see isReady(). Reading from the
+//! mapping is performed by the OS's virtual memory system, so many players can read from the same (large) file with random access.
+class MappedSample {
+  public:
+	~MappedSample();
+
+	//! Returns true once the cache file has been decoded and mapped. Until then getChannel() returns nullptr. \note Safe to call on the audio thread.
+	bool			isReady() const				{ return mReady; }
+	//! Returns a pointer to the first sample of \a channel, or nullptr if the cache file is not ready.
+	const float*	getChannel( size_t channel ) const	{ return mReady ? mChannelData + channel * mNumFrames : nullptr; }
+	//! Returns the number of channels.
+	size_t			getNumChannels() const		{ return mNumChannels; }
+	//! Returns the number of frames per channel.
+	size_t			getNumFrames() const		{ return mNumFrames; }
+	//! Returns the samplerate of the decoded samples.
+	size_t			getSampleRate() const		{ return mSampleRate; }
+	//! Returns the length in seconds.
+	double			getNumSeconds() const		{ return (double)mNumFrames / (double)mSampleRate; }
+	//! Returns the path to the cache file.
+	const fs::path&	getCacheFilePath() const	{ return mCacheFilePath; }
+
+  private:
+	MappedSample( const fs::path &cacheFilePath, size_t numChannels, size_t numFrames, size_t sampleRate );
+
+	//! Maps the cache file, returns false if it doesn't exist or it doesn't match this sample's format.
+	bool	map();
+	void	unmap();
+	//! Decodes \a sourceFile into the planar cache file at \a cacheFilePath. Throws AudioFileExc on failure.
+	static void	writeCacheFile( SourceFile *sourceFile, size_t numFrames, const fs::path &cacheFilePath );
+
+	fs::path			mCacheFilePath;
+	size_t				mNumChannels, mNumFrames, mSampleRate;
+	std::atomic<bool>	mReady;
+	const float*		mChannelData;
+	void*				mMappedData;
+	size_t				mMappedSize;
+#if defined( CINDER_MSW )
+	void*				mFileHandle;
+	void*				mMappingHandle;
+#endif
+
+	friend class SampleCache;
+};
+
+//! \brief Shares decoded, memory-mapped samples between players.
+//!
+//! Each source file is decoded once, on a single background thread, into a planar float file within the cache directory. Cache files are
+//! keyed by the source's path, size, modification time and the requested samplerate, so they are reused across runs and invalidated when
+//! the source changes. Loading the same source again while its MappedSample is alive returns the same instance.
+//! \see MappedPlayerNode
+class SampleCache {
+  public:
+	//! Creates a SampleCache that stores its files in \a cacheDirectory, which is created if necessary.
+	static SampleCacheRef create( const fs::path &cacheDirectory );
+	~SampleCache();
+
+	//! Returns the MappedSample for \a dataSource at \a sampleRate (the file's native samplerate if 0), scheduling it to be decoded if it isn't cached yet.
+	//! Only the file's header is read on the calling thread. \note \a dataSource must be file-based. Throws AudioFileExc if it isn't.
+	MappedSampleRef		load( const DataSourceRef &dataSource, size_t sampleRate = 0 );
+	//! Returns the number of sources that are waiting to be decoded or are currently being decoded.
+	size_t				getNumPendingDecodes() const;
+	//! Returns the directory where cache files are stored.
+	const fs::path&		getCacheDirectory() const	{ return mCacheDirectory; }
+
+  private:
+	SampleCache( const fs::path &cacheDirectory );
+
+	void	decodeThreadLoop();
+
+	struct DecodeJob {
+		SourceFileRef		mSourceFile;
+		MappedSampleRef		mSample;
+	};
+
+	fs::path									mCacheDirectory;
+	std::map<fs::path, std::weak_ptr<MappedSample> >	mSamples;
+	std::list<DecodeJob>						mDecodeJobs;
+	size_t										mNumDecoding;
+	std::unique_ptr<std::thread>				mDecodeThread;
+	mutable std::mutex							mMutex;
+	std::condition_variable						mDecodeCondition;
+	bool										mShouldQuit;
+};
+
+//! \brief Tracks the progress of a batch of decodes started with BufferCache::preload().
+class BufferPreload {
+  public:
+	//! Returns the number of DataSources in the batch.
+	size_t	getNumSources() const		{ return mBuffers.size(); }
+	//! Returns the number of DataSources that have finished decoding, successfully or not.
+	size_t	getNumCompleted() const		{ return mNumCompleted; }
+	//! Returns the fraction of the batch that has finished decoding, in the range [0:1].
+	float	getProgress() const			{ return mBuffers.empty() ? 1.0f : (float)mNumCompleted / (float)mBuffers.size(); }
+	//! Returns true once all DataSources in the batch have finished decoding.
+	bool	isComplete() const			{ return mNumCompleted == mBuffers.size(); }
+
+	//! Blocks until the batch has finished decoding and returns the Buffers, in the same order as the DataSources passed to BufferCache::preload(). Rethrows the first decoding error.
+	std::vector<BufferRef>	getBuffers() const;
+	//! Returns the future for the Buffer decoded from the DataSource at \a index.
+	const std::shared_future<BufferRef>&	getFuture( size_t index ) const	{ return mBuffers.at( index ); }
+
+  private:
+	BufferPreload() : mNumCompleted( 0 )	{}
+
+	std::vector<std::shared_future<BufferRef> >	mBuffers;
+	std::atomic<size_t>							mNumCompleted;
+
+	friend class BufferCache;
+};
+
+//! \brief Shares fully decoded, in-memory Buffers between players.
+//!
+//! Buffers are keyed by the source's path and the requested samplerate, so that a sound which is triggered many times is only decoded once.
+//! Decoding is done in the background on the TaskPool with loadAsync(), or on the calling thread with load(). Once the cached Buffers exceed
+//! the memory budget, the least recently used ones that aren't referenced outside of the cache are evicted. Use BufferCache::get() to access the
+//! process-wide cache that BufferPlayerNode::loadBuffer() and Voice::create() use.
+class BufferCache : public std::enable_shared_from_this<BufferCache> {
+  public:
+	//! Creates a BufferCache that evicts Buffers once they take up more than \a memoryBudgetBytes (default = 256MB).
+	static BufferCacheRef create( size_t memoryBudgetBytes = 256 * 1024 * 1024 );
+	//! Returns the process-wide BufferCache, which is created on first use with the default memory budget.
+	static BufferCache* get();
+
+	//! Returns the decoded contents of \a dataSource at \a sampleRate (the file's native samplerate if 0), decoding it on the calling thread if it isn't cached yet.
+	//! If it is currently being decoded in the background, blocks until that is complete. \note \a dataSource must be file-based. Throws AudioFileExc if it isn't or if decoding fails.
+	BufferRef					load( const DataSourceRef &dataSource, size_t sampleRate = 0 );
+	//! Schedules \a dataSource to be decoded at \a sampleRate on the TaskPool if it isn't cached yet, and returns a future for the decoded Buffer. Decoding errors are delivered through the future.
+	std::shared_future<BufferRef>	loadAsync( const DataSourceRef &dataSource, size_t sampleRate = 0 );
+	//! Called from the thread that completed a decode with the number of completed and total DataSources of a BufferPreload.
+	typedef std::function<void ( size_t numCompleted, size_t numSources )>	PreloadProgressFn;
+
+	//! \brief Schedules all of \a dataSources to be decoded at \a sampleRate concurrently on the TaskPool, and returns a BufferPreload to track their progress.
+	//!
+	//! \a progressFn, if provided, is called each time one of the DataSources finishes decoding. DataSources that are already cached count as completed right away.
+	//! \note all of \a dataSources must be file-based. Throws AudioFileExc if one isn't.
+	BufferPreloadRef			preload( const std::vector<DataSourceRef> &dataSources, size_t sampleRate = 0, const PreloadProgressFn &progressFn = PreloadProgressFn() );
+	//! Returns the cached Buffer for \a filePath at \a sampleRate, or an empty BufferRef if it isn't cached or is still being decoded. Never decodes.
+	BufferRef					find( const fs::path &filePath, size_t sampleRate = 0 );
+
+	//! Removes all Buffers that were decoded from \a filePath from the cache, for example after the file has changed on disk. Players that hold them are not affected.
+	void	remove( const fs::path &filePath );
+	//! Removes all Buffers from the cache. Players that hold them are not affected.
+	void	clear();
+
+	//! Sets the number of bytes that cached Buffers may occupy before being evicted, evicting as needed.
+	void	setMemoryBudget( size_t bytes );
+	//! Returns the number of bytes that cached Buffers may occupy before being evicted.
+	size_t	getMemoryBudget() const;
+	//! Returns the number of bytes occupied by the Buffers that are currently cached.
+	size_t	getMemoryUsage() const;
+
+  private:
+	BufferCache( size_t memoryBudgetBytes );
+
+	typedef std::pair<fs::path, size_t>	Key;
+
+	struct PendingDecode {
+		PendingDecode() : mFuture( mPromise.get_future().share() )	{}
+
+		std::promise<BufferRef>					mPromise;
+		std::shared_future<BufferRef>			mFuture;
+		std::vector<std::function<void ()> >	mCompletionFns;	// guarded by mMutex, called once the decode has finished
+	};
+
+	struct Entry {
+		BufferRef						mBuffer;		// set once decoded
+		std::shared_ptr<PendingDecode>	mPending;		// set while decoding
+		std::list<Key>::iterator		mLruIt;
+		uint64_t						mId;
+	};
+
+	//! Returns the Entry for \a key, creating it if it doesn't exist (in which case \a isNew is set to true). Must be called with mMutex locked.
+	Entry&	acquireEntry( const Key &key, bool *isNew );
+	//! Submits a TaskPool task that decodes \a dataSource into \a entry, which must be new. Must be called with mMutex locked.
+	void	scheduleDecode( const DataSourceRef &dataSource, const Key &key, Entry *entry );
+	void	decode( const DataSourceRef &dataSource, const Key &key, uint64_t id, const std::shared_ptr<PendingDecode> &pending );
+	void	evict(); // must be called with mMutex locked
+
+	std::map<Key, Entry>		mEntries;
+	std::list<Key>				mLru;			// most recently used first
+	size_t						mMemoryBudget, mMemoryUsage;
+	uint64_t					mNextId;
+	mutable std::mutex			mMutex;
+};
+
+} } // namespace cinder::audio
@@ -25,17 +25,22 @@
 
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/Source.h"
+#include "cinder/audio/SampleCache.h"
 #include "cinder/audio/dsp/RingBuffer.h"
 
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class SamplePlayerNode>				SamplePlayerNodeRef;
 typedef std::shared_ptr<class BufferPlayerNode>				BufferPlayerNodeRef;
 typedef std::shared_ptr<class FilePlayerNode>				FilePlayerNodeRef;
+typedef std::shared_ptr<class MappedPlayerNode>				MappedPlayerNodeRef;
+
+class FilePlayerReadPool;
 
 //! \brief Base Node class for sampled audio playback. Can do operations like seek and loop.
 //!
@@ -113,6 +118,8 @@ class BufferPlayerNode : public SamplePlayerNode {
 
 	//! Loads and stores a reference to a Buffer created from the entire contents of \a sourceFile.
 	void loadBuffer( const SourceFileRef &sourceFile );
+	//! Loads the entire contents of \a dataSource at the Context's samplerate through BufferCache::get(), so that the file is only decoded once no matter how many players use it. DataSources that aren't file-based are decoded without caching.
+	void loadBuffer( const DataSourceRef &dataSource );
 	//! Sets the current Buffer. Safe to do while enabled.
 	void setBuffer( const BufferRef &buffer );
 	//! returns a shared_ptr to the current Buffer.
@@ -121,11 +128,50 @@ class BufferPlayerNode : public SamplePlayerNode {
   protected:
 	virtual void enableProcessing()			override;
 	virtual void process( Buffer *buffer )	override;
+	virtual bool supportsProcessFramesRange() const override	{ return true; }
+
+	//! Swaps \a buffer with the current Buffer without locking or reconfiguring, so channel counts must match. Used by VoicePool from the audio thread.
+	void swapBufferImpl( BufferRef &buffer );
 
 	BufferRef mBuffer;
+
+	friend class VoicePool;
 };
 
-//! File-based SamplePlayerNode, where samples are constantly streamed from file. Suitable for large audio files.
+//! \brief SamplePlayerNode that reads directly from a memory-mapped MappedSample, which is shared between all players of the same source.
+//!
+//! Reading is random-access and requires no read thread, so large numbers of voices can play from a big sample library. Until the
+//! SampleCache has finished decoding the MappedSample, the player outputs silence. \see SampleCache
+class MappedPlayerNode : public SamplePlayerNode {
+  public:
+	//! Constructs a MappedPlayerNode without a sample, with the assumption one will be set later.
+	MappedPlayerNode( const Format &format = Format() );
+	//! Constructs a MappedPlayerNode with \a sample. \note Channel mode is always ChannelMode::SPECIFIED and num channels matches \a sample. Format::channels() is ignored.
+	MappedPlayerNode( const MappedSampleRef &sample, const Format &format = Format() );
+
+	virtual ~MappedPlayerNode() {}
+
+	virtual void seek( size_t readPositionFrames ) override;
+
+	//! Sets the current MappedSample. Safe to do while enabled. \note \a sample's samplerate should match the Context's, see SampleCache::load().
+	void setSample( const MappedSampleRef &sample );
+	//! Returns the current MappedSample.
+	const MappedSampleRef& getSample() const	{ return mSample; }
+
+  protected:
+	virtual void enableProcessing()			override;
+	virtual void process( Buffer *buffer )	override;
+	virtual bool supportsProcessFramesRange() const override	{ return true; }
+
+	void copyFrames( Buffer *buffer, size_t bufferOffset, size_t readPos, size_t numFrames );
+
+	MappedSampleRef mSample;
+};
+
+//! \brief File-based SamplePlayerNode, where samples are constantly streamed from file. Suitable for large audio files.
+//!
+//! When reading asynchronously, all FilePlayerNode's share one pool of read threads sized to the hardware concurrency. The audio thread
+//! posts a request when a player's ring buffers drop below half full, and the pool services the emptiest ring buffers first.
 class FilePlayerNode : public SamplePlayerNode {
   public:
 	//! Constructs a FilePlayerNode with optional \a format.
@@ -137,7 +183,7 @@ class FilePlayerNode : public SamplePlayerNode {
 	virtual void stop() override;
 	virtual void seek( size_t readPositionFrames ) override;
 
-	//! Returns whether reading occurs asynchronously (default is false). If true, file reading is done from an internal thread, if false it is done directly on the audio thread.
+	//! Returns whether reading occurs asynchronously (default is true). If true, file reading is done by the shared read thread pool, if false it is done directly on the audio thread.
 	bool isReadAsync() const	{ return mIsReadAsync; }
 
 	//! \note \a sourceFile's samplerate is forced to match this Node's Context.
@@ -156,11 +202,14 @@ class FilePlayerNode : public SamplePlayerNode {
 	void disableProcessing()		override;
 	void process( Buffer *buffer )	override;
 
+	//! Called by the FilePlayerReadPool from one of its threads.
 	void readAsyncImpl();
 	void readImpl();
 	void seekImpl( size_t readPos );
 	void stopImpl();
-	void destroyReadThreadImpl();
+	void removeFromReadPool();
+	//! Returns how full the ring buffers are (0 - 1), used by the FilePlayerReadPool to service the neediest players first.
+	float getRingBufferFillRatio() const;
 
 	std::vector<dsp::RingBuffer>				mRingBuffers;	// used to transfer samples from io to audio thread, one ring buffer per channel
 	BufferDynamic								mIoBuffer;		// used to read samples from the file on read thread, resizeable so the ringbuffer can be filled
@@ -169,10 +218,13 @@ class FilePlayerNode : public SamplePlayerNode {
 	size_t										mBufferFramesThreshold, mRingBufferPaddingFactor;
 	std::atomic<uint64_t>						mLastUnderrun, mLastOverrun;
 
-	std::unique_ptr<std::thread>				mReadThread;
+	std::shared_ptr<FilePlayerReadPool>			mReadPool;
 	std::mutex									mAsyncReadMutex;
-	std::condition_variable						mIssueAsyncReadCond;
-	bool										mIsReadAsync, mAsyncReadShouldQuit;
+	std::atomic<bool>							mReadRequested;	// set on the audio thread, cleared by the read pool once serviced
+	bool										mReadInFlight;	// guarded by the read pool's mutex
+	bool										mIsReadAsync;
+
+	friend class FilePlayerReadPool;
 };
 
 } } // namespace cinder::audio
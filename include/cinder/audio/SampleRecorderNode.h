@@ -25,12 +25,19 @@
 
 #include "cinder/audio/Node.h"
 #include "cinder/audio/SampleType.h"
+#include "cinder/audio/Target.h"
+#include "cinder/audio/dsp/RingBuffer.h"
 #include "cinder/Filesystem.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class SampleRecorderNode> SampleRecorderNodeRef;
 typedef std::shared_ptr<class BufferRecorderNode> BufferRecorderNodeRef;
+typedef std::shared_ptr<class FileRecorderNode> FileRecorderNodeRef;
 
 //! Base Node class for recording audio samples. Inherits from NodeAudioPullable, and therefore does not need to be connected to an output.
 class SampleRecorderNode : public NodeAutoPullable {
@@ -93,4 +100,58 @@ class BufferRecorderNode : public SampleRecorderNode {
 	std::atomic<uint64_t>	mLastOverrun;
 };
 
+//! \brief Records its inputs directly to a file, so the length of a recording is limited by disk space rather than memory.
+//!
+//! The audio thread only copies each block into per-channel ring buffers, while a background thread drains them and writes through a TargetFile.
+//! If the writer falls behind for longer than the ring buffers can hold, blocks are dropped and reported with getLastOverrun().
+class FileRecorderNode : public SampleRecorderNode {
+  public:
+	//! Constructs a FileRecorderNode that will record to \a filePath. The encoding format is derived from \a filePath's extension and \a sampleType (default = SampleType::INT_16).
+	FileRecorderNode( const fs::path &filePath, SampleType sampleType = SampleType::INT_16, const Format &format = Format() );
+	virtual ~FileRecorderNode();
+
+	//! Opens the file for writing (truncating any existing file), starts the writer thread and begins recording. If already recording, the current recording is finished first. \note throws AudioFileExc if the file cannot be opened.
+	void start();
+	//! Stops recording, waits for the writer thread to flush all remaining samples and closes the file.
+	void stop();
+	//! Returns whether a recording is in progress, meaning the file is open and the writer thread is running.
+	bool isRecording() const	{ return mIsRecording; }
+
+	//! Sets the file that the next call to start() will record to.
+	void setFilePath( const fs::path &filePath, SampleType sampleType = SampleType::INT_16 );
+	//! Returns the file that is recorded to.
+	const fs::path&	getFilePath() const	{ return mFilePath; }
+
+	//! Sets how many seconds of audio the ring buffers can hold while waiting on the writer thread (default = 2). Takes effect the next time the Node is initialized.
+	void	setRingBufferSeconds( double seconds )	{ mRingBufferSeconds = seconds; }
+	//! Returns how many seconds of audio the ring buffers can hold while waiting on the writer thread.
+	double	getRingBufferSeconds() const			{ return mRingBufferSeconds; }
+
+	//! Returns the frame of the last buffer overrun or 0 if none since the last time this method was called. When this happens, the writer thread couldn't keep up and some frames were dropped from the recording.
+	uint64_t getLastOverrun();
+
+  protected:
+	virtual void initialize()				override;
+	virtual void uninitialize()				override;
+	virtual void process( Buffer *buffer )	override;
+
+	void finishRecording();
+	void writerThreadLoop();
+	void writeAvailable();
+
+	fs::path					mFilePath;
+	SampleType					mSampleType;
+	double						mRingBufferSeconds;
+	TargetFileRef				mTarget;
+	std::vector<dsp::RingBuffer>	mRingBuffers;	// used to transfer samples from the audio thread to the writer thread, one ring buffer per channel
+	BufferDynamic				mWriteBuffer;	// used on the writer thread to gather samples from the ring buffers
+	std::atomic<uint64_t>		mLastOverrun;
+	std::atomic<bool>			mIsRecording;
+
+	std::thread					mWriterThread;
+	std::mutex					mWriterMutex;
+	std::condition_variable		mWriterCond;
+	bool						mWriterShouldQuit;	// guarded by mWriterMutex
+};
+
 } } // namespace cinder::audio
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "cinder/audio/Buffer.h"
+#include "cinder/audio/dsp/Converter.h"
 #include "cinder/DataSource.h"
 
 #include <boost/noncopyable.hpp>
@@ -33,10 +34,6 @@ namespace cinder { namespace audio {
 typedef std::shared_ptr<class Source>			SourceRef;
 typedef std::shared_ptr<class SourceFile>		SourceFileRef;
 
-namespace dsp {
-	class Converter;
-}
-
 //! Base class that is used to load and read from an audio source.
 class Source : public boost::noncopyable {
   public:
@@ -83,7 +80,8 @@ class Source : public boost::noncopyable {
 class SourceFile : public Source {
   public:
 	//! Creates a new SourceFile from \a dataSource, with optional output samplerate.  If \a sampleRate equals 0 the native file's samplerate is used.
-	static std::unique_ptr<SourceFile> create( const DataSourceRef &dataSource, size_t sampleRate = 0 );
+	//! \a converterQuality selects the dsp::Converter used when \a sampleRate differs from the file's samplerate.
+	static std::unique_ptr<SourceFile> create( const DataSourceRef &dataSource, size_t sampleRate = 0, dsp::Converter::Quality converterQuality = dsp::Converter::Quality::BEST );
 	virtual ~SourceFile()	{}
 
 	size_t	read( Buffer *buffer ) override;
@@ -108,6 +106,12 @@ class SourceFile : public Source {
 	//! Returns the length in seconds.
 	double	getNumSeconds() const						{ return (double)getNumFrames() / (double)getSampleRate(); }
 
+	//! Sets the quality of the dsp::Converter used for samplerate conversion, recreating it if one is in use. Clones share this setting.
+	//! \note Has no effect for implementations that provide their own samplerate conversion (ex. Core Audio files on OS X and iOS).
+	void	setConverterQuality( dsp::Converter::Quality quality );
+	//! Returns the quality of the dsp::Converter used for samplerate conversion.
+	dsp::Converter::Quality	getConverterQuality() const	{ return mConverterQuality; }
+
 	//! Returns a vector of extensions that SourceFile support for loading. Suitable for the \a extensions parameter of getOpenFilePath().
 	static std::vector<std::string>	getSupportedExtensions();
 
@@ -119,10 +123,11 @@ class SourceFile : public Source {
 	//! Sets up samplerate conversion if needed. Can be overridden by implementation if they handle samplerate conversion in a specific way, else it is handled generically with a dsp::Converter.
 	virtual void setupSampleRateConversion();
 
-	size_t mNumFrames, mFileNumFrames, mReadPos;
+	size_t					mNumFrames, mFileNumFrames, mReadPos;
+	dsp::Converter::Quality	mConverterQuality;
 };
 
 //! Convenience method for loading a SourceFile from \a dataSource. \return SourceFileRef. \see SourceFile::create()
-inline SourceFileRef	load( const DataSourceRef &dataSource, size_t sampleRate = 0 )	{ return SourceFile::create( dataSource, sampleRate ); }
+inline SourceFileRef	load( const DataSourceRef &dataSource, size_t sampleRate = 0, dsp::Converter::Quality converterQuality = dsp::Converter::Quality::BEST )	{ return SourceFile::create( dataSource, sampleRate, converterQuality ); }
 
 } } // namespace cinder::audio
@@ -0,0 +1,102 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/Vector.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class SpatialPannerNode>	SpatialPannerNodeRef;
+
+//! \brief Pans any number of mono sources onto a multichannel speaker layout or encodes them into ambisonic B-format.
+//!
+//! Sources are connected with addSource() (plain `operator>>` connections are not pulled), and only their first channel is used.
+//! Each source contributes a column of gains to a matrix that mixes all sources into the output channels in a single Node,
+//! so that spatializing many sources doesn't require a GainNode and ChannelRouterNode per source and speaker.
+//! When a source moves, its gains are interpolated across the following processing block so that there are no zipper artifacts.
+//!
+//! Directions are relative to the listener, with +x to the right, +y up and -z to the front. They don't need to be normalized.
+//!
+//! \code
+//! auto panner = ctx->makeNode( new audio::SpatialPannerNode( speakerDirections ) );
+//! panner->addSource( player, Vec3f( -1, 0, -1 ) );
+//! panner >> ctx->getOutput();
+//! \endcode
+class SpatialPannerNode : public Node {
+  public:
+	//! Constructs a SpatialPannerNode that pans onto speakers located in \a speakerDirections. The number of channels equals the number of speakers, and Format::channels() is ignored.
+	SpatialPannerNode( const std::vector<Vec3f> &speakerDirections, const Format &format = Format() );
+	//! Constructs a SpatialPannerNode that encodes its sources into ambisonic B-format of \a ambisonicOrder (1 to 3), using ACN channel ordering and SN3D normalization (AmbiX). The number of channels is ( \a ambisonicOrder + 1 )^2. Throws AudioFormatExc if \a ambisonicOrder is out of range.
+	SpatialPannerNode( size_t ambisonicOrder, const Format &format = Format() );
+	virtual ~SpatialPannerNode();
+
+	//! Connects \a input as a source located in \a direction, scaled by \a gain.
+	void	addSource( const NodeRef &input, const Vec3f &direction, float gain = 1 );
+	//! Moves the source \a input to \a direction. Safe to call while processing, although not concurrently with addSource() or disconnecting inputs.
+	void	setSourceDirection( const NodeRef &input, const Vec3f &direction );
+	//! Sets the gain of the source \a input. Safe to call while processing, although not concurrently with addSource() or disconnecting inputs.
+	void	setSourceGain( const NodeRef &input, float gain );
+	//! Returns the number of connected sources.
+	size_t	getNumSources() const		{ return mSources.size(); }
+
+	//! \brief Sets how tightly sources are focused onto the speakers closest to them when panning onto a speaker layout (default = 8).
+	//!
+	//! Each speaker's gain is proportional to the cosine of the angle between it and the source raised to \a focus, normalized to constant power.
+	//! Higher values suit dense layouts. Has no effect when encoding ambisonics. Takes effect the next time each source is moved.
+	void	setFocus( float focus )		{ mFocus = focus; }
+	//! Returns how tightly sources are focused onto the speakers closest to them. \see setFocus()
+	float	getFocus() const			{ return mFocus; }
+
+	//! Returns the ambisonic order that sources are encoded with, or 0 if panning onto a speaker layout.
+	size_t	getAmbisonicOrder() const	{ return mAmbisonicOrder; }
+	//! Returns the normalized speaker directions, which is empty when encoding ambisonics.
+	const std::vector<Vec3f>&	getSpeakerDirections() const	{ return mSpeakerDirections; }
+
+	virtual void disconnectAllInputs()									override;
+
+  protected:
+	virtual void initialize()											override;
+	virtual bool supportsInputNumChannels( size_t numChannels ) const	override;
+	virtual bool supportsProcessInPlace() const							override;
+	virtual void sumInputs()											override;
+	virtual void disconnectInput( const NodeRef &input )				override;
+
+	struct Source;
+
+	Source*	findSource( const NodeRef &input ) const;
+	//! Fills \a gains with getNumChannels() gains that place a source at \a direction.
+	void	computeGains( const Vec3f &direction, float gain, float *gains ) const;
+
+	std::vector<std::unique_ptr<Source> >	mSources;		// modified with the Context's mutex locked
+	std::vector<Vec3f>						mSpeakerDirections;
+	size_t									mAmbisonicOrder;
+	std::atomic<float>						mFocus;
+};
+
+} } // namespace cinder::audio
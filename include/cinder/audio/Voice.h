@@ -25,14 +25,18 @@
 
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/SamplePlayerNode.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/PanNode.h"
 #include "cinder/audio/Source.h"
 
 #include <memory>
+#include <vector>
 
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class Voice> VoiceRef;
 typedef std::shared_ptr<class VoiceSamplePlayerNode> VoiceSamplePlayerNodeRef;
+typedef std::shared_ptr<class VoicePool> VoicePoolRef;
 
 //! \brief Interface for performing high-level audio playback tasks.
 //!
@@ -81,6 +85,8 @@ class Voice {
 
 	//! Creates a Voice that manages sample playback of an audio file pointed at with \a sourceFile.
 	static VoiceSamplePlayerNodeRef create( const SourceFileRef &sourceFile, const Options &options = Options() );
+	//! Creates a Voice that manages sample playback of the audio file \a dataSource. When buffer playback is used, the decoded samples are shared with all other Voices of the same file through BufferCache::get().
+	static VoiceSamplePlayerNodeRef create( const DataSourceRef &dataSource, const Options &options = Options() );
 	//! Creates a Voice that continuously calls \a callbackFn to process a Buffer of samples.
 	static VoiceRef create( const CallbackProcessorFn &callbackFn, const Options &options = Options() );
 
@@ -128,6 +134,7 @@ class VoiceSamplePlayerNode : public Voice {
 
   protected:
 	VoiceSamplePlayerNode( const SourceFileRef &sourceFile, const Options &options );
+	VoiceSamplePlayerNode( const DataSourceRef &dataSource, const Options &options );
 	SamplePlayerNodeRef mNode;
 
 	friend class Voice;
@@ -145,4 +152,104 @@ class VoiceCallbackProcessor : public Voice {
 	friend class Voice;
 };
 
+//! \brief Fixed-capacity pool of preallocated voices for firing one-shot samples.
+//!
+//! All BufferPlayerNode -> GainNode -> Pan2dNode chains are created and connected when the pool is created, so play() does not
+//! allocate Node's or make connections. Instead, the buffer swap and restart are posted to the audio thread with Context::postCommand(),
+//! which never takes the Context's mutex. When all voices are busy, one is reused according to the pool's StealPolicy.
+//!
+//! Buffers passed to play() must have getChannels() channels and should match the Context's samplerate (ex. loaded with BufferPlayerNode::loadBuffer() or SourceFile::cloneWithSampleRate()).
+class VoicePool {
+  public:
+	//! Determines which voice is reused when play() is called while all voices are busy.
+	enum class StealPolicy {
+		//! Reuse the voice that was triggered the longest time ago.
+		OLDEST,
+		//! Reuse the voice that was triggered with the lowest volume.
+		QUIETEST,
+		//! Don't steal, play() returns -1 instead.
+		NONE
+	};
+
+	//! Optional parameters passed into VoicePool::create().
+	struct Options {
+		Options()
+			: mMaxVoices( 32 ), mChannels( 1 ), mStealPolicy( StealPolicy::OLDEST ), mConnectToMaster( true )
+		{}
+
+		//! Sets the number of preallocated voices. Default = 32.
+		Options& maxVoices( size_t voices )					{ mMaxVoices = voices; return *this; }
+		//! Sets the number of channels of each voice's player, which all buffers passed to play() must match. Default = 1 (mono, panned to stereo).
+		Options& channels( size_t ch )						{ mChannels = ch; return *this; }
+		//! Sets the voice stealing policy. Default = StealPolicy::OLDEST.
+		Options& stealPolicy( StealPolicy policy )			{ mStealPolicy = policy; return *this; }
+		//! Sets whether the pool's output is automatically connected to master()->getOutput(). Default = true.
+		Options& connectToMaster( bool shouldConnect )		{ mConnectToMaster = shouldConnect; return *this; }
+
+		//! Returns the number of preallocated voices. \see maxVoices()
+		size_t		getMaxVoices() const		{ return mMaxVoices; }
+		//! Returns the number of channels of each voice. \see channels()
+		size_t		getChannels() const			{ return mChannels; }
+		//! Returns the voice stealing policy. \see stealPolicy()
+		StealPolicy	getStealPolicy() const		{ return mStealPolicy; }
+		//! Returns whether or not the pool will be automatically connected to master()->getOutput().
+		bool		getConnectToMaster() const	{ return mConnectToMaster; }
+
+	  protected:
+		size_t		mMaxVoices, mChannels;
+		StealPolicy	mStealPolicy;
+		bool		mConnectToMaster;
+	};
+
+	//! Creates a VoicePool with all of its voices connected to the master Context.
+	static VoicePoolRef create( const Options &options = Options() );
+	~VoicePool();
+
+	//! \brief Plays \a buffer from the beginning at \a volume and pan position \a pan ([0:1], 0.5 = center).
+	//!
+	//! Uses a free voice if there is one, otherwise a voice is stolen according to the StealPolicy.
+	//! \return the index of the voice used, or -1 if \a buffer is invalid or no voice was available.
+	int		play( const BufferRef &buffer, float volume = 1, float pan = 0.5f );
+	//! Stops the voice at \a voiceIndex.
+	void	stop( size_t voiceIndex );
+	//! Stops all voices.
+	void	stopAll();
+
+	//! Returns whether the voice at \a voiceIndex is expected to still be playing.
+	bool	isVoicePlaying( size_t voiceIndex ) const;
+	//! Returns the number of voices that are expected to still be playing.
+	size_t	getNumActiveVoices() const;
+	//! Returns the number of preallocated voices.
+	size_t	getMaxVoices() const					{ return mVoices.size(); }
+
+	//! Sets the volume applied to all voices.
+	void	setVolume( float volume )				{ mOutput->setValue( volume ); }
+	//! Returns the volume applied to all voices.
+	float	getVolume() const						{ return mOutput->getValue(); }
+	//! Returns the Node that all voices are summed into, which is connected to the master output unless disabled with Options::connectToMaster().
+	NodeRef	getOutputNode() const					{ return mOutput; }
+	//! Returns the BufferPlayerNode of the voice at \a voiceIndex.
+	BufferPlayerNodeRef	getPlayerNode( size_t voiceIndex ) const	{ return mVoices.at( voiceIndex ).mPlayer; }
+
+  protected:
+	VoicePool( const Options &options );
+
+	// Voice state is tracked on the user thread, from the trigger time and buffer duration, so that it is correct even before the
+	// audio thread has executed the posted commands.
+	struct PooledVoice {
+		BufferPlayerNodeRef	mPlayer;
+		GainNodeRef			mGain;
+		Pan2dNodeRef		mPan;
+		double				mTriggerTime, mEndTime;
+		float				mVolume;
+	};
+
+	int		findVoice( double currentTime ) const;
+
+	std::vector<PooledVoice>	mVoices;
+	GainNodeRef					mOutput;
+	StealPolicy					mStealPolicy;
+	size_t						mNumChannels;
+};
+
 } } // namespace cinder::audio
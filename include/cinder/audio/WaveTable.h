@@ -78,6 +78,11 @@ class WaveTable2d : public WaveTable {
 	float lookupBandlimited( float phase, float f0 ) const;
 	float lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, float f0 ) const;
 	float lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, const float *f0Array ) const;
+	//! \brief Sums \a numOscillators band-limited oscillators into \a outputArray, which is not cleared first.
+	//!
+	//! Oscillator \a i has a constant frequency of \a f0Array[i] and its gain is ramped linearly from \a gainBeginArray[i] to
+	//! \a gainEndArray[i] over \a outputLength samples. \a phaseArray holds each oscillator's current phase and is updated in place.
+	void lookupBandlimitedSum( float *outputArray, size_t outputLength, float *phaseArray, const float *f0Array, const float *gainBeginArray, const float *gainEndArray, size_t numOscillators ) const;
 
 	void copyTo( float *array, size_t tableIndex ) const;
 	void copyFrom( const float *array, size_t tableIndex );
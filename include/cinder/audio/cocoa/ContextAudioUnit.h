@@ -24,7 +24,7 @@
 #pragma once
 
 #include "cinder/audio/Context.h"
-#include "cinder/audio/dsp/RingBuffer.h"
+#include "cinder/audio/dsp/DriftCompensator.h"
 #include "cinder/audio/cocoa/CinderCoreAudio.h"
 
 #include <AudioUnit/AudioUnit.h>
@@ -75,6 +75,7 @@ class OutputDeviceNodeAudioUnit : public OutputDeviceNode, public NodeAudioUnit
 	static OSStatus renderCallback( void *data, ::AudioUnitRenderActionFlags *flags, const ::AudioTimeStamp *timeStamp, UInt32 busNumber, UInt32 numFrames, ::AudioBufferList *bufferList );
 
 	bool								mSynchronousIO;
+	Float64								mNextSampleTime;	// expected timestamp of the next render callback, used to detect xruns. negative until the first callback.
 
 	friend class InputDeviceNodeAudioUnit;
 };
@@ -87,6 +88,8 @@ class InputDeviceNodeAudioUnit : public InputDeviceNode, public NodeAudioUnit {
 	void enableProcessing()		override;
 	void disableProcessing()	override;
 
+	double getDriftCompensationRatio() const	override;
+
   protected:
 	void initialize()				override;
 	void uninitialize()				override;
@@ -95,8 +98,8 @@ class InputDeviceNodeAudioUnit : public InputDeviceNode, public NodeAudioUnit {
   private:
 	static OSStatus inputCallback( void *data, ::AudioUnitRenderActionFlags *flags, const ::AudioTimeStamp *timeStamp, UInt32 bus, UInt32 numFrames, ::AudioBufferList *bufferList );
 
-	dsp::RingBuffer						mRingBuffer;
-	size_t								mRingBufferPaddingFactor;
+	std::unique_ptr<dsp::DriftCompensator>	mDriftCompensator;
+	BufferDynamic						mCaptureBuffer;
 	AudioBufferListPtr					mBufferList;
 	bool								mSynchronousIO;
 
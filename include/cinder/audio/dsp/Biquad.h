@@ -84,6 +84,8 @@ class Biquad {
     void getFrequencyResponse( int nFrequencies, const float *frequency, float *magResponse, float *phaseResponse );
 	//! Resets filter state
     void reset();
+	//! Returns the normalized coefficients, for the filter defined as: y[n] + a1 * y[n-1] + a2 * y[n-2] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2].
+	void getCoefficients( double *b0, double *b1, double *b2, double *a1, double *a2 ) const	{ *b0 = mB0; *b1 = mB1; *b2 = mB2; *a1 = mA1; *a2 = mA2; }
 
   private:
     void setNormalizedCoefficients( double b0, double b1, double b2, double a0, double a1, double a2 );
@@ -113,4 +115,45 @@ class Biquad {
 #endif
 };
 
+//! \brief Processes a cascade of biquad sections over many channels at once.
+//!
+//! Channels are grouped into SIMD lanes (8 with AVX, 4 with SSE or NEON), and every section of the cascade is run across
+//! each group for the whole block, so a multichannel or multi-band filter costs roughly numSections / laneWidth as much as
+//! a separate Biquad per channel and section. Coefficients are designed with Biquad's set*Params() methods and copied in
+//! with setCoefficients(). Processing is done in single precision.
+class BiquadBank {
+  public:
+	//! Constructs a BiquadBank for \a numChannels channels with \a numSections cascaded sections, initialized as pass-thru.
+	BiquadBank( size_t numChannels = 0, size_t numSections = 1 );
+
+	//! Sets the number of channels and cascaded sections. All coefficients are reset to pass-thru and the filter state is cleared. \note Allocates, not to be called from the audio thread.
+	void	setSize( size_t numChannels, size_t numSections );
+	//! Returns the number of channels.
+	size_t	getNumChannels() const		{ return mNumChannels; }
+	//! Returns the number of cascaded sections.
+	size_t	getNumSections() const		{ return mNumSections; }
+
+	//! Copies the coefficients of \a biquad to \a section for all channels.
+	void	setCoefficients( size_t section, const Biquad &biquad );
+	//! Copies the coefficients of \a biquad to \a section for \a channel only.
+	void	setCoefficients( size_t section, size_t channel, const Biquad &biquad );
+
+	//! Processes \a buffer in place through all sections. \a buffer must have getNumChannels() channels and at most the number of frames passed to setMaxFrames() (or 1024 by default).
+	void	process( Buffer *buffer );
+	//! Sets the maximum number of frames that can be processed in one call to process(). \note Allocates, not to be called from the audio thread.
+	void	setMaxFrames( size_t maxFrames );
+	//! Clears the filter state of all sections and channels.
+	void	reset();
+
+  private:
+	float*	getSectionData( size_t group, size_t section )	{ return &mSectionData[( group * mNumSections + section ) * SECTION_STRIDE * mLaneWidth]; }
+	void	processSection( float *interleaved, size_t numFrames, float *section );
+
+	// each section of each group stores mLaneWidth floats of: b0, b1, b2, a1, a2, x1, x2, y1, y2
+	static const size_t SECTION_STRIDE = 9;
+
+	size_t				mNumChannels, mNumSections, mLaneWidth, mNumGroups;
+	std::vector<float>	mSectionData, mInterleaved;
+};
+
 } } } // namespace cinder::audio::dsp
@@ -32,8 +32,19 @@ namespace cinder { namespace audio { namespace dsp {
 //! A platform-specific converter that supports samplerate and channel conversion.
 class Converter {
   public:
+	//! Selects the samplerate conversion algorithm used by create().
+	enum class Quality {
+		//! Polyphase FIR with short filters, for rational samplerate ratios (ex. 44.1k <-> 48k). Much cheaper to create and run than BEST, suitable for sound effects.
+		FAST,
+		//! Polyphase FIR with longer filters and a narrower transition band than FAST.
+		MEDIUM,
+		//! The platform's high quality converter (Core Audio on OS X and iOS, r8brain elsewhere). This is the default.
+		BEST
+	};
+
 	//! If \a destSampleRate is 0, it is set to match \a sourceSampleRate. If \a destNumChannels is 0, it is set to match \a sourceNumChannels.
-	static std::unique_ptr<Converter> create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock );
+	//! If \a quality is FAST or MEDIUM but the reduced samplerate ratio would need too many filter phases, a BEST quality Converter is returned instead.
+	static std::unique_ptr<Converter> create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality = Quality::BEST );
 
 	virtual ~Converter() {}
 
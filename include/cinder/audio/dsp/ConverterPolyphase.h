@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/dsp/Converter.h"
+
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief \a Converter implementation using a precomputed polyphase FIR filter, for samplerates with a rational ratio.
+//!
+//! The samplerate ratio is reduced to upFactor / downFactor (ex. 48000 / 44100 = 160 / 147) and a Kaiser windowed sinc lowpass filter is
+//! split into upFactor phases. Each output sample is then a single dot product over one phase and the most recent input samples,
+//! which runs with SIMD instructions through dsp::dot(). Output is aligned with the input, the filter's group delay is compensated.
+class ConverterImplPolyphase : public Converter {
+  public:
+	//! \a quality must be either Quality::FAST or Quality::MEDIUM.
+	ConverterImplPolyphase( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality );
+
+	std::pair<size_t, size_t>	convert( const Buffer *sourceBuffer, Buffer *destBuffer )	override;
+	void						clear()														override;
+
+	//! Returns true if the reduced ratio of \a sourceSampleRate to \a destSampleRate results in a reasonable number of filter phases.
+	static bool supportsSampleRates( size_t sourceSampleRate, size_t destSampleRate );
+
+	//! Returns the upsampling factor of the reduced samplerate ratio, which is also the number of filter phases.
+	size_t	getUpFactor() const			{ return mUpFactor; }
+	//! Returns the downsampling factor of the reduced samplerate ratio.
+	size_t	getDownFactor() const		{ return mDownFactor; }
+	//! Returns the number of filter taps used to compute each output sample.
+	size_t	getNumTapsPerPhase() const	{ return mNumTapsPerPhase; }
+
+  private:
+	void	designFilter( float rolloff, float kaiserBeta );
+	size_t	convertChannels( const Buffer *sourceBuffer, Buffer *destBuffer, size_t readCount );
+
+	size_t				mUpFactor, mDownFactor, mNumTapsPerPhase;
+	std::vector<float>	mPhaseCoeffs;		// mUpFactor phases of mNumTapsPerPhase taps each, stored in reverse order
+	Buffer				mHistoryBuffer;		// per channel: mNumTapsPerPhase - 1 samples of history followed by the current input
+	Buffer				mMixingBuffer;
+	size_t				mPhase, mInputOffset;
+};
+
+} } } // namespace cinder::audio::dsp
@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+#include "cinder/audio/dsp/RingBuffer.h"
+
+#include <atomic>
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief Transfers audio from a thread driven by one device clock to a thread driven by another, resampling to compensate for the drift between them.
+//!
+//! Two devices never run at exactly the same rate, so a plain RingBuffer between them slowly fills up or drains until it overruns or underruns,
+//! which is heard as a click. DriftCompensator instead keeps the number of buffered frames at a constant target: a PI controller measures
+//! the fill level before each read and adjusts the rate at which a windowed sinc resampler consumes input, by at most getMaxCorrection().
+//! Real device drift is in the order of 100 parts per million, which the controller tracks within a few seconds without an audible change in pitch.
+//!
+//! Like RingBuffer, write() and read() are lock-free and safe to call from one write thread and one read thread.
+class DriftCompensator {
+  public:
+	//! Constructs a DriftCompensator for \a numChannels channels at \a sampleRate. \a framesPerBlock is the number of frames read at a time and \a maxWriteFrames the most frames written at a time.
+	//! \a targetLatencyFrames is the number of buffered frames the controller aims for, if 0 it defaults to `framesPerBlock + maxWriteFrames`.
+	DriftCompensator( size_t numChannels, size_t sampleRate, size_t framesPerBlock, size_t maxWriteFrames, size_t targetLatencyFrames = 0 );
+
+	//! Writes all frames of \a buffer, which must have getNumChannels() channels. \return `true` on success, or `false` on an overrun, in which case nothing is written. \note only safe to call from the write thread.
+	bool write( const Buffer *buffer );
+	//! \brief Fills all frames of \a buffer (at most the \a framesPerBlock given at construction) with resampled audio. \return `true` on success, or `false` on an underrun, in which case \a buffer is silenced.
+	//!
+	//! Outputs silence until getTargetLatencyFrames() are buffered, which also happens again after an underrun. \note only safe to call from the read thread.
+	bool read( Buffer *buffer );
+
+	//! Discards all buffered audio and the drift measured so far. \note Must be synchronized with both read and write threads.
+	void reset();
+
+	//! Returns the number of channels.
+	size_t	getNumChannels() const				{ return mRingBuffers.size(); }
+	//! Returns the number of buffered frames the controller aims for.
+	size_t	getTargetLatencyFrames() const		{ return mTargetLatencyFrames; }
+	//! Returns the number of input frames consumed per output frame, which is above 1 when the writing clock runs faster than the reading clock. Safe to call from any thread.
+	double	getRatio() const					{ return mRatio; }
+	//! Returns the largest relative correction the controller applies to the ratio, in either direction (default = 0.005).
+	double	getMaxCorrection() const			{ return mMaxCorrection; }
+	//! Sets the largest relative correction the controller applies to the ratio.
+	void	setMaxCorrection( double correction )	{ mMaxCorrection = correction; }
+
+  private:
+	size_t	getAvailableRead() const;
+	double	getNumFramesBuffered( size_t availableRead ) const;
+	void	discard( size_t numFrames );
+	void	computeFilterTable();
+	void	updateRatio( double numFramesBuffered, size_t numFrames );
+
+	std::vector<RingBuffer>	mRingBuffers;
+	BufferDynamic			mWorkBuffer;		// de-queued input with the filter's history, frames to the left of mPosition are consumed
+	std::vector<float>		mFilterTable, mCoefficients;
+	size_t					mSampleRate, mFramesPerBlock, mMaxWriteFrames, mTargetLatencyFrames;
+	size_t					mNumWorkFrames;
+	double					mPosition;			// read position within mWorkBuffer, in frames
+	double					mFilteredFill, mIntegral, mMaxCorrection;
+	std::atomic<double>		mRatio;
+	bool					mPrimed;
+};
+
+} } } // namespace cinder::audio::dsp
@@ -60,6 +60,8 @@ void generateWindow( WindowType windowType, float *window, size_t length );
 
 //! fills \a array with value \a value
 void fill( float value, float *array, size_t length );
+//! fills \a array with the linear ramp \a begin + i * \a increment, where i is the sample index
+void ramp( float begin, float increment, float *array, size_t length );
 //! add \a scalar to \a array of length \a length, into \a result.
 void add( const float *array, float scalar, float *result, size_t length );
 //! add \a length elements of \a arrayA and \a arrayB (element-wise) into \a result.
@@ -78,10 +80,16 @@ void divide( const float *array, float scalar, float *result, size_t length );
 void divide( const float *arrayA, const float *arrayB, float *result, size_t length );
 //! sums \a length elements of \a arrayA by \a arrayB (element-wise), then scales by \a scalar and places the result at \a result.
 void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length );
+//! multiplies \a length elements of \a array by \a scalarMul, then adds \a scalarAdd and places the result at \a result.
+void mulAdd( const float *array, float scalarMul, float scalarAdd, float *result, size_t length );
+//! multiplies \a length elements of \a array by the linear ramp \a begin + i * \a increment, where i is the sample index, and adds them to \a result.
+void mulRampAdd( const float *array, float begin, float increment, float *result, size_t length );
 //! returns the sum of \a array
 float sum( const float *array, size_t length );
 //! returns the Root-Mean-Squared value of \a array
 float rms( const float *array, size_t length );
+//! returns the dot product of \a length elements of \a arrayA and \a arrayB
+float dot( const float *arrayA, const float *arrayB, size_t length );
 //! normalizes \a array to \a maxValue (default = 1)
 void normalize( float *array, size_t length, float maxValue = 1 );
 
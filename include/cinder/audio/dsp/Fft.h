@@ -28,6 +28,7 @@
 
 #include "cinder/Cinder.h"
 
+#include <memory>
 #include <vector>
 
 #if defined( CINDER_AUDIO_VDSP )
@@ -38,7 +39,10 @@
 
 namespace cinder { namespace audio { namespace dsp {
 
-//! Real Discrete Fourier Transform (DFT).
+//! \brief Real Discrete Fourier Transform (DFT).
+//!
+//! The twiddle tables of a given size are computed once and shared by all Fft objects of that size, for as long as one of them exists.
+//! An Fft object itself only owns scratch space, so it is cheap to make one per thread.
 class Fft {
   public:
 	//! Constructs an Fft object. \a fftSize must be a power of two and greater than two.
@@ -47,24 +51,37 @@ class Fft {
 
 	//! Computes the Forward DFT of \a waveform, filling \a spectral with freqency-domain audio data
 	void forward( const Buffer *waveform, BufferSpectral *spectral );
+	//! Computes the Forward DFT of each channel of \a waveform, filling the corresponding element of \a spectra, which is resized to the number of channels if needed.
+	void forward( const Buffer *waveform, std::vector<BufferSpectral> *spectra );
 	//! Computes the Inverse DFT of \a spectral, filling \a waveform with time-domain audio data
 	void inverse( const BufferSpectral *spectral, Buffer *waveform );
+
+	//! \brief Computes the magnitude spectrum of each channel of \a waveform into the corresponding channel of \a magnitudes, scaled by \a scale.
+	//!
+	//! \a magnitudes must have as many channels as \a waveform and getSize() / 2 frames. Bin 0 is the DC component, the nyquist component is discarded.
+	//! The transform's output is converted in place, without going through a BufferSpectral.
+	void computeMagnitudes( const Buffer *waveform, Buffer *magnitudes, float scale = 1 );
+
 	//! Returns the size of the FFT.
 	size_t getSize() const	{ return mSize; }
 
   protected:
+	struct Plan;
+
 	void init();
+	//! Transforms the channel \a waveform into \a real and \a imag, each getSize() / 2 long. Bin 0 holds the DC component in \a real and the nyquist component in \a imag.
+	void forwardImpl( const float *waveform, float *real, float *imag );
+
+	static std::shared_ptr<Plan>	getPlan( size_t fftSize );
 
-	size_t				mSize, mSizeOverTwo;
+	size_t					mSize, mSizeOverTwo;
+	std::shared_ptr<Plan>	mPlan;
 
 #if defined( CINDER_AUDIO_VDSP )
 	size_t				mLog2FftSize;
-	::FFTSetup			mFftSetup;
 	::DSPSplitComplex	mSplitComplexSignal, mSplitComplexResult;
 #elif defined( CINDER_AUDIO_FFT_OOURA )
 	Buffer				mBufferCopy;
-	int					*mOouraIp;
-	float				*mOouraW;
 #endif
 };
 
@@ -38,6 +38,15 @@ class OutputDeviceNodeWasapi : public OutputDeviceNode {
   public:
 	OutputDeviceNodeWasapi( const DeviceRef &device, const Format &format );
 
+	//! \brief Sets whether the device is opened in WASAPI exclusive mode (default is shared mode).
+	//!
+	//! Exclusive mode bypasses the system mixer and uses the smallest period supported by the device, which greatly reduces latency.
+	//! For the lowest latency, the Device's frames per block should be no larger than the device period. If the Node is already initialized, the Context is re-initialized.
+	//! \note Fails with AudioDeviceExc if another application is using the device or exclusive mode is disabled in the device's properties.
+	void	setExclusiveMode( bool exclusive = true );
+	//! Returns whether the device is opened in WASAPI exclusive mode. \see setExclusiveMode()
+	bool	isExclusiveMode() const;
+
 protected:
 	void initialize()				override;
 	void uninitialize()				override;
@@ -59,6 +68,17 @@ public:
 	InputDeviceNodeWasapi( const DeviceRef &device, const Format &format = Format() );
 	virtual ~InputDeviceNodeWasapi();
 
+	//! \brief Sets whether the device is opened in WASAPI exclusive mode (default is shared mode).
+	//!
+	//! Exclusive mode bypasses the system mixer and uses the smallest period supported by the device, which greatly reduces latency.
+	//! For the lowest latency, the Device's frames per block should be no larger than the device period. If the Node is already initialized, the Context is re-initialized.
+	//! \note Fails with AudioDeviceExc if another application is using the device or exclusive mode is disabled in the device's properties.
+	void	setExclusiveMode( bool exclusive = true );
+	//! Returns whether the device is opened in WASAPI exclusive mode. \see setExclusiveMode()
+	bool	isExclusiveMode() const;
+
+	double	getDriftCompensationRatio() const	override;
+
 protected:
 	void initialize()				override;
 	void uninitialize()				override;
@@ -79,6 +79,7 @@ class OutputDeviceNodeXAudio : public OutputDeviceNode {
 	std::unique_ptr<VoiceCallbackImpl>		mVoiceCallback;
 	BufferInterleaved						mBufferInterleaved;
 	bool									mFilterEnabled;
+	UINT32									mNumGlitches;
 
 	friend struct VoiceCallbackImpl;
 };
@@ -35,5 +35,7 @@ namespace cinder { namespace audio { namespace msw {
 
 //! return pointer type is actually a WAVEFORMATEXTENSIBLE, identifiable by the wFormat tag
 std::shared_ptr<::WAVEFORMATEX> interleavedFloatWaveFormat( size_t sampleRate, size_t numChannels );
+//! return pointer type is actually a WAVEFORMATEXTENSIBLE with integer PCM samples of \a bitsPerSample container size, of which \a validBitsPerSample are used (left-justified).
+std::shared_ptr<::WAVEFORMATEX> interleavedPcmWaveFormat( size_t sampleRate, size_t numChannels, size_t bitsPerSample, size_t validBitsPerSample );
 
 } } } // namespace cinder::audio::msw
@@ -163,6 +163,7 @@ CFDataRef createCfDataRef( const cinder::Buffer &buffer );
 
 typedef std::shared_ptr<class ImageSourceCgImage> ImageSourceCgImageRef;
 
+//! ImageSource for a CGImageRef. Honors ImageSource::Options::area(), but not Options::decodeSize().
 class ImageSourceCgImage : public ImageSource {
   public:
 	//! Retains (and later releases) \a imageRef
@@ -178,6 +179,7 @@ class ImageSourceCgImage : public ImageSource {
 	bool						mIsIndexed, mIs16BitPacked;
 	Color8u						mColorTable[256];
 	std::shared_ptr<CGImage>	mImageRef;
+	Vec2i						mDecodeOffset; // upper-left of the decoded area
 
 	uint16_t					m16BitPackedRedOffset, m16BitPackedGreenOffset, m16BitPackedBlueOffset;
 };
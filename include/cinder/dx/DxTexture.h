@@ -34,8 +34,12 @@
 #include "cinder/Surface.h"
 #include "cinder/Rect.h"
 #include "cinder/Stream.h"
+#include "cinder/DataSource.h"
 #include "cinder/FileSystem.h"
+#include "cinder/ip/BlockCompress.h"
 
+#include <exception>
+#include <functional>
 #include <vector>
 #include <utility>
 
@@ -74,6 +78,8 @@ class Texture {
 	static TextureRef	create( const Channel32f &channel, Format format = Format() ) { return TextureRef( new Texture( channel, format ) ); }
 	/** \brief Constructs a texture based on \a imageSource.  */
 	static TextureRef	create( ImageSourceRef imageSource, Format format = Format() ) { return TextureRef( new Texture( imageSource, format ) ); }
+	//! Constructs a Texture from the block compressed levels of \a image, which are uploaded as-is. Every level of \a image becomes a mip level of the Texture.
+	static TextureRef	create( const ip::BlockCompressedImage &image, Format format = Format() ) { return TextureRef( new Texture( image, format ) ); }
 
 	~Texture();
 
@@ -163,6 +169,18 @@ class Texture {
 	//!	Creates a new Texture from raw DirectDraw Stream data
 	static TextureRef	loadDds( IStreamRef ddsStream, Format format );
 
+	//! Called on the main thread with the Texture created by createAsync()
+	typedef std::function<void ( TextureRef )>			AsyncReadyFn;
+	//! Called on the main thread with the exception thrown while loading in createAsync()
+	typedef std::function<void ( std::exception_ptr )>	AsyncErrorFn;
+
+	/** \brief Decodes \a dataSource and creates a Texture from it on the shared TaskPool, then calls \a readyFn with the Texture on the main thread.
+		D3D11 resource creation is free-threaded, so neither the decode nor the creation of the texture blocks the main thread. Sources with a \c .dds extension are loaded with loadDds().
+		If loading throws, \a errorFn is called with the exception on the main thread, or the exception is rethrown there if \a errorFn is empty. Must be called from the main thread. **/
+	static void		createAsync( DataSourceRef dataSource, const AsyncReadyFn &readyFn, Format format = Format(), const AsyncErrorFn &errorFn = AsyncErrorFn() );
+	//! Loads the file at \a path asynchronously. \sa createAsync( DataSourceRef, const AsyncReadyFn&, Format, const AsyncErrorFn& )
+	static void		createAsync( const fs::path &path, const AsyncReadyFn &readyFn, Format format = Format(), const AsyncErrorFn &errorFn = AsyncErrorFn() );
+
 	//! Converts a SurfaceChannelOrder into an appropriate DXGI dataFormat and type
 	//static void		SurfaceChannelOrderToDataFormatAndType( const SurfaceChannelOrder &sco, GLint *dataFormat, GLenum *type );
 	static void		SurfaceChannelOrderToDataFormatAndType( const SurfaceChannelOrder &sco, DXGI_FORMAT *dataFormat, CinderDxgiChannel* type, bool isSurface32f = false );
@@ -264,11 +282,14 @@ class Texture {
 	Texture( const Channel32f &channel, Format format = Format() );
 	/** \brief Constructs a texture based on \a imageSource. A default value of -1 for \a internalFormat chooses an appropriate internal format based on the contents of \a imageSource. **/
 	Texture( ImageSourceRef imageSource, Format format = Format() );
+	//! Constructs a texture from the block compressed levels of \a image.
+	Texture( const ip::BlockCompressedImage &image, Format format = Format() );
 
 	void	init( int width, int height );
 	void	init( const unsigned char *srcData, DXGI_FORMAT srcDataFormat, const Format &format );	
 	void	init( const float *srcData, DXGI_FORMAT srcDataFormat, const Format &format );
 	void	init( ImageSourceRef imageSource, const Format &format );	
+	void	init( const ip::BlockCompressedImage &image, const Format &format );
 		 	
 /*		Obj() : mWidth( -1 ), mHeight( -1 ), mCleanWidth( -1 ), mCleanHeight( -1 ), mInternalFormat( (DXGI_FORMAT)-1 ), mFlipped( false ), mDeallocatorFunc( 0 ), mDxTexture(NULL), mSamplerState(NULL), mSRV(NULL)
 		{}
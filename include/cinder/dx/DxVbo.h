@@ -38,7 +38,8 @@ class Vbo {
 	//void		bind();
 	//void		unbind();
 	
-	void		bufferData( size_t size, const void *data, D3D11_USAGE usage, D3D11_BIND_FLAG bindFlags, D3D11_CPU_ACCESS_FLAG cpuAccess);
+	//! Creates the buffer, replacing any previous one. \a miscFlags is passed through as D3D11_BUFFER_DESC::MiscFlags, e.g. D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS for the argument buffer of dx::drawIndirect()
+	void		bufferData( size_t size, const void *data, D3D11_USAGE usage, D3D11_BIND_FLAG bindFlags, D3D11_CPU_ACCESS_FLAG cpuAccess, UINT miscFlags = 0 );
 	void		bufferSubData( ptrdiff_t offset, size_t size, const void *data );
 	
 	uint8_t*	map( D3D11_MAP access );
@@ -136,14 +137,27 @@ class VboMesh {
 		void	addDynamicCustomVec3f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); }
 		void	addDynamicCustomVec4f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); }
 
+		/** Adds a per-instance custom attribute which advances once every \a stepRate instances. Instance attributes are stored interleaved in the instance buffer, in the order
+			they are added, and are exposed to vertex shaders as consecutive \c INSTANCE semantics starting at \c INSTANCE0. **/
+		void	addInstanceCustomFloat( UINT stepRate = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT, 0 ) ); mCustomInstanceStepRates.push_back( stepRate ); }
+		void	addInstanceCustomVec2f( UINT stepRate = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT2, 0 ) ); mCustomInstanceStepRates.push_back( stepRate ); }
+		void	addInstanceCustomVec3f( UINT stepRate = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); mCustomInstanceStepRates.push_back( stepRate ); }
+		void	addInstanceCustomVec4f( UINT stepRate = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); mCustomInstanceStepRates.push_back( stepRate ); }
+		//! Adds a per-instance Matrix44f as four consecutive float4 columns, occupying four consecutive \c INSTANCE semantics
+		void	addInstanceCustomMatrix44f( UINT stepRate = 1 ) { for( int c = 0; c < 4; ++c ) addInstanceCustomVec4f( stepRate ); }
+		bool	hasInstanceAttributes() const { return ! mCustomInstance.empty(); }
+
 		int												mAttributes[ATTR_TOTAL];
-		std::vector<std::pair<CustomAttr,size_t> >		mCustomDynamic, mCustomStatic; // pair of <types,offset>
+		std::vector<std::pair<CustomAttr,size_t> >		mCustomDynamic, mCustomStatic, mCustomInstance; // pair of <types,offset>
+		std::vector<UINT>								mCustomInstanceStepRates;
 		
 	 private:
 		void initAttributes() { for( int a = 0; a < ATTR_TOTAL; ++a ) mAttributes[a] = NONE; }
 	};
 
-	enum			{ INDEX_BUFFER = 0, STATIC_BUFFER, DYNAMIC_BUFFER, TOTAL_BUFFERS };
+	enum			{ INDEX_BUFFER = 0, STATIC_BUFFER, DYNAMIC_BUFFER, INSTANCE_BUFFER, TOTAL_BUFFERS };
+	//! Input slot the instance buffer is bound to, clear of the per-vertex slots
+	enum			{ INSTANCE_INPUT_SLOT = 8 };
 	
   protected:
 	struct Obj {
@@ -158,6 +172,7 @@ class VboMesh {
 		size_t						mColorRGBOffset, mColorRGBAOffset;		
 		size_t						mTexCoordOffset[ATTR_MAX_TEXTURE_UNIT+1];
 		size_t						mStaticStride, mDynamicStride;	
+		size_t						mInstanceStride, mNumInstances, mInstanceCapacity;
 		D3D11_PRIMITIVE_TOPOLOGY	mPrimitiveType;
 		Layout						mLayout;
 		//std::vector<GLint>			mCustomStaticLocations;
@@ -181,6 +196,10 @@ class VboMesh {
 
 	size_t						getNumIndices() const { return mObj->mNumIndices; }
 	size_t						getNumVertices() const { return mObj->mNumVertices; }
+	//! Returns the number of instances last supplied to bufferInstanceData()
+	size_t						getNumInstances() const { return mObj->mNumInstances; }
+	//! Returns the size in bytes of one instance's interleaved attributes
+	size_t						getInstanceStride() const { return mObj->mInstanceStride; }
 	D3D11_PRIMITIVE_TOPOLOGY	getPrimitiveType() const { return mObj->mPrimitiveType; }
 	
 	const Layout&	getLayout() const { return mObj->mLayout; }
@@ -199,11 +218,20 @@ class VboMesh {
 	void						bufferTexCoords3d( size_t unit, const std::vector<Vec3f> &texCoords );
 	void						bufferColorsRGB( const std::vector<Color> &colors );
 	void						bufferColorsRGBA( const std::vector<ColorA> &colors );
+	/** Replaces the contents of the instance buffer with \a numInstances instances of interleaved attributes, each getInstanceStride() bytes, laid out in the order
+		they were added to the Layout. The buffer is only reallocated when it grows; otherwise it is mapped with D3D11_MAP_WRITE_DISCARD. **/
+	void						bufferInstanceData( const void *data, size_t numInstances );
 	class VertexIter			mapVertexBuffer();
 
 	Vbo&				getIndexVbo() const { return mObj->mBuffers[INDEX_BUFFER]; }
 	Vbo&				getStaticVbo() const { return mObj->mBuffers[STATIC_BUFFER]; }
 	Vbo&				getDynamicVbo() const { return mObj->mBuffers[DYNAMIC_BUFFER]; }
+	Vbo&				getInstanceVbo() const { return mObj->mBuffers[INSTANCE_BUFFER]; }
+
+	//! Returns whether the device supports per-instance vertex data and instanced draws, which dx::drawInstanced() requires (feature level 9_3 and up)
+	static bool			isInstancingSupported();
+	//! Returns whether the device supports draws whose arguments come from a GPU buffer, which dx::drawIndirect() requires (feature level 11_0 and up)
+	static bool			isIndirectDrawSupported();
 
 	//void				setCustomStaticLocation( size_t internalIndex, GLuint location ) { mObj->mCustomStaticLocations[internalIndex] = location; }
 	//void				setCustomDynamicLocation( size_t internalIndex, GLuint location ) { mObj->mCustomDynamicLocations[internalIndex] = location; }
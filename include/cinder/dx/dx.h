@@ -314,6 +314,12 @@ void draw( const VboMesh &vbo );
 void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int vertexStart = -1, int vertexEnd = -1 );
 //! Draws a range of elements from a cinder::gl::VboMesh \a vbo.
 void drawArrays( const VboMesh &vbo, GLint first, GLsizei count );
+/** Draws \a instanceCount instances of cinder::dx::VboMesh \a vbo with a single DrawIndexedInstanced() (or DrawInstanced() when it has no indices), advancing its
+	instance attributes per their step rates. The fixed function VBO shaders ignore instance data, so this is meant for use with a bound HlslProg. Requires VboMesh::isInstancingSupported(). **/
+void drawInstanced( const VboMesh &vbo, size_t instanceCount );
+/** Draws cinder::dx::VboMesh \a vbo with DrawIndexedInstancedIndirect() (or DrawInstancedIndirect() when it has no indices), reading the arguments from \a args at \a alignedByteOffset.
+	\a args must have been created with D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS, and is typically written by a compute shader. Requires VboMesh::isIndirectDrawSupported(). **/
+void drawIndirect( const VboMesh &vbo, const Vbo &args, UINT alignedByteOffset = 0 );
 //!	Draws a textured quad of size \a scale that is aligned with the vectors \a bbRight and \a bbUp at \a pos, rotated by \a rotationDegrees around the vector orthogonal to \a bbRight and \a bbUp.
 	
 void drawBillboard( const Vec3f &pos, const Vec2f &scale, float rotationDegrees, const Vec3f &bbRight, const Vec3f &bbUp );
@@ -0,0 +1,132 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/Camera.h"
+
+#include <functional>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class CascadedShadowMap>	CascadedShadowMapRef;
+
+/** \brief Shadows of a directional light over a large view, from several shadow maps fitted to consecutive slices of the view camera's frustum.
+ *
+ * update() splits the camera's depth range between the cascades, blending logarithmic and uniform splits, and fits an orthographic light camera around
+ * each slice's bounding sphere. The sphere's size only depends on the camera's projection and its center is snapped to whole shadow map texels, so the
+ * shadows don't shimmer as the camera moves or turns. render() then draws the casters into each cascade's tile of a single depth texture.
+ *
+ * With Format::staticCasterCache(), casters which don't move are drawn into a second depth texture only when a cascade's light camera changes, which
+ * with texel snapping is only when the camera has moved by at least a texel, and copied from there each frame before the moving casters are drawn.
+ *
+ * getGlslFunctions() returns GLSL 1.20 declaring the uniforms set by setUniforms() and <tt>float ciShadow( vec3 eyePosition )</tt>, which returns 0 in
+ * shadow and 1 when lit for a position in the view camera's eye coordinates.
+ * \code
+ * mShadowMap->update( mCamera, lightDirection );
+ * mShadowMap->render( [this]( int cascade ) { drawMovingObjects(); }, [this]( int cascade ) { drawBuildings(); } );
+ * gl::setMatrices( mCamera );
+ * mShader.bind();
+ * mShadowMap->setUniforms( mShader, 1 );
+ * drawScene();
+ * \endcode **/
+class CascadedShadowMap {
+  public:
+	//! Draws shadow casters into cascade \a cascade, whose light camera's matrices are current. getLightCamera() returns the camera for culling.
+	typedef std::function<void ( int cascade )>		DrawCastersFn;
+
+	enum { MAX_CASCADES = 4 };
+
+	struct Format {
+		Format() : mNumCascades( 4 ), mResolution( 1024 ), mSplitLambda( 0.75f ), mCasterDistance( 100.0f ), mStaticCasterCache( false ) {}
+
+		//! Sets the number of cascades, from 1 to MAX_CASCADES. Default is 4.
+		Format&		cascades( int numCascades ) { mNumCascades = std::min<int>( std::max( numCascades, 1 ), MAX_CASCADES ); return *this; }
+		//! Sets the width and height in texels of each cascade. Default is 1024.
+		Format&		resolution( int resolution ) { mResolution = resolution; return *this; }
+		//! Sets the blend between uniform (0) and logarithmic (1) splits of the view's depth range. Default is 0.75.
+		Format&		splitLambda( float lambda ) { mSplitLambda = lambda; return *this; }
+		//! Sets how far towards the light beyond a cascade's slice casters are still drawn. Default is 100.
+		Format&		casterDistance( float distance ) { mCasterDistance = distance; return *this; }
+		//! Keeps the depth of static casters between frames, redrawing them only when a cascade's light camera changes. Default is \c false.
+		Format&		staticCasterCache( bool cache = true ) { mStaticCasterCache = cache; return *this; }
+
+		int		getNumCascades() const { return mNumCascades; }
+		int		getResolution() const { return mResolution; }
+		float	getSplitLambda() const { return mSplitLambda; }
+		float	getCasterDistance() const { return mCasterDistance; }
+		bool	isStaticCasterCacheEnabled() const { return mStaticCasterCache; }
+
+	  private:
+		int		mNumCascades, mResolution;
+		float	mSplitLambda, mCasterDistance;
+		bool	mStaticCasterCache;
+	};
+
+	static CascadedShadowMapRef	create( const Format &format = Format() ) { return CascadedShadowMapRef( new CascadedShadowMap( format ) ); }
+
+	//! Fits the cascades to \a camera's frustum, for a directional light shining along \a lightDirection
+	void	update( const CameraPersp &camera, const Vec3f &lightDirection );
+	/** Draws the casters into every cascade, calling \a drawDynamicCasters and \a drawStaticCasters once per cascade with its light camera's matrices set.
+		Without Format::staticCasterCache() both are simply drawn each time. Either may be empty. **/
+	void	render( const DrawCastersFn &drawDynamicCasters, const DrawCastersFn &drawStaticCasters = DrawCastersFn() );
+	//! Forces the static casters to be redrawn by the next render(), after any of them has changed
+	void	invalidateStaticCasters();
+
+	int					getNumCascades() const { return mFormat.getNumCascades(); }
+	//! Returns the distance from the view camera at which cascade \a cascade ends
+	float				getSplitDistance( int cascade ) const { return mSplitDistances[cascade]; }
+	const CameraOrtho&	getLightCamera( int cascade ) const { return mLightCameras[cascade]; }
+	//! Returns the matrix taking the view camera's eye coordinates to cascade \a cascade's texture coordinates and depth in getDepthTexture()
+	const Matrix44f&	getShadowMatrix( int cascade ) const { return mShadowMatrices[cascade]; }
+	//! Returns the depth texture, which holds the cascades side by side and compares with \c GL_COMPARE_R_TO_TEXTURE for \c sampler2DShadow
+	Texture&			getDepthTexture() { return mFbo.getDepthTexture(); }
+	const Format&		getFormat() const { return mFormat; }
+
+	//! Binds the depth texture to \a textureUnit and sets the uniforms declared by getGlslFunctions() on \a shader, which must be bound
+	void				setUniforms( GlslProg &shader, int textureUnit );
+	//! Returns GLSL 1.20 declaring the uniforms set by setUniforms() and <tt>float ciShadow( vec3 eyePosition )</tt>
+	static const char*	getGlslFunctions();
+
+  protected:
+	CascadedShadowMap( const Format &format );
+
+	void	drawCasters( Fbo &fbo, int cascade, const DrawCastersFn &drawCasters, bool clear );
+
+	Format			mFormat;
+	Fbo				mFbo, mStaticFbo;
+	float			mSplitDistances[MAX_CASCADES];
+	CameraOrtho		mLightCameras[MAX_CASCADES];
+	Matrix44f		mShadowMatrices[MAX_CASCADES];
+	Matrix44f		mStaticViewProjections[MAX_CASCADES]; // of the light cameras the cached static casters were drawn with
+	bool			mStaticValid[MAX_CASCADES];
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
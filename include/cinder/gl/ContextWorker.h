@@ -0,0 +1,159 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Exception.h"
+#include "cinder/Thread.h"
+#include "cinder/gl/gl.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#if defined( CINDER_MAC )
+	#include <OpenGL/OpenGL.h>
+#elif defined( CINDER_COCOA_TOUCH )
+	#if defined( __OBJC__ )
+		@class EAGLContext;
+	#else
+		class EAGLContext;
+	#endif
+#endif
+
+namespace cinder { namespace app {
+	class RendererGl;
+} } // namespace cinder::app
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class SharedContext>	SharedContextRef;
+typedef std::shared_ptr<class ContextWorker>	ContextWorkerRef;
+
+/** \brief An OpenGL context which shares resources with a RendererGl's context, for creating resources on another thread.
+ *
+ * Textures, buffer objects (including those of a VboMesh), shaders and display lists created in a SharedContext can be used in the Renderer's context.
+ * Container objects, such as Fbo's, are not shared between contexts. A resource is only safe to use in another context once the commands creating
+ * it have completed, which ContextWorker takes care of. **/
+class SharedContext : private boost::noncopyable {
+  public:
+	//! Creates a context sharing resources with \a renderer's context. Must be called on the main thread once the Renderer is set up, and on MSW the context must also be destroyed there. Throws SharedContextExc on failure.
+	static SharedContextRef		create( app::RendererGl *renderer );
+	~SharedContext();
+
+	//! Makes the context current on the calling thread. A context can only be current on one thread at a time.
+	void	makeCurrent();
+	//! Releases the calling thread's current context
+	void	clearCurrent();
+
+  private:
+	SharedContext();
+
+#if defined( CINDER_MAC )
+	CGLContextObj	mCglContext;
+#elif defined( CINDER_COCOA_TOUCH )
+	EAGLContext		*mEaglContext;
+#elif defined( CINDER_MSW )
+	HWND			mWnd;
+	HDC				mDc;
+	HGLRC			mRc;
+#endif
+};
+
+/** \brief Threads with contexts sharing resources with a RendererGl, which create GL resources in the background and hand them over to the main thread.
+ *
+ * Each submitted job's create function is called on one of the worker's threads with its SharedContext current. A fence is then inserted behind its
+ * commands, and the job's ready function is dispatched to the main thread with App::dispatchAsync() once the fence has been passed, so the resource is
+ * complete by the time the main thread uses it. Where fences aren't supported, the worker thread waits for the commands to finish with glFinish().
+ * Use RendererGl::createContextWorker() to create one.
+ *
+ * \code
+ * mWorker = std::static_pointer_cast<RendererGl>( getWindow()->getRenderer() )->createContextWorker();
+ * mWorker->create<gl::Texture>( [=] { return gl::Texture( loadImage( path ) ); }, [this]( const gl::Texture &tex ) { mTexture = tex; } );
+ * \endcode **/
+class ContextWorker : private boost::noncopyable {
+  public:
+	typedef std::function<void ()>						Fn;
+	typedef std::function<void ( std::exception_ptr )>	ErrorFn;
+
+	//! Creates a ContextWorker with \a numThreads threads, each with a SharedContext of \a renderer's. Must be called on the main thread. Throws SharedContextExc on failure.
+	static ContextWorkerRef	create( app::RendererGl *renderer, size_t numThreads = 1 );
+	//! Stops the threads once their current jobs finish. Jobs which haven't been started are discarded.
+	~ContextWorker();
+
+	//! Schedules \a createFn to be called on a worker thread, and \a readyFn on the main thread once the GL commands issued by \a createFn have completed.
+	//! If \a createFn throws, \a errorFn is called on the main thread with the exception instead, or the exception is rethrown on the main thread if \a errorFn is empty.
+	void	submit( const Fn &createFn, const Fn &readyFn, const ErrorFn &errorFn = ErrorFn() );
+	//! Schedules the T returned by \a createFn on a worker thread to be passed to \a readyFn on the main thread, once its GL commands have completed
+	template<typename T>
+	void	create( const std::function<T ()> &createFn, const std::function<void ( const T& )> &readyFn, const ErrorFn &errorFn = ErrorFn() );
+
+	//! Returns the number of worker threads
+	size_t	getNumThreads() const { return mThreads.size(); }
+	//! Returns the number of jobs which have been submitted and whose ready function hasn't been dispatched yet
+	size_t	getNumPending() const { return mNumPending; }
+
+  private:
+	ContextWorker();
+
+	struct Job {
+		Fn		mCreateFn, mReadyFn;
+		ErrorFn	mErrorFn;
+	};
+
+	void	threadLoop( SharedContext *context );
+	void	dispatch( const Job &job, std::exception_ptr exc );
+
+	std::vector<SharedContextRef>	mContexts;
+	std::vector<std::thread>		mThreads;
+	std::deque<Job>					mJobs;			// guarded by mMutex
+	bool							mShouldQuit;	// guarded by mMutex
+	std::mutex						mMutex;
+	std::condition_variable			mJobCond;
+	std::atomic<size_t>				mNumPending;
+};
+
+template<typename T>
+void ContextWorker::create( const std::function<T ()> &createFn, const std::function<void ( const T& )> &readyFn, const ErrorFn &errorFn )
+{
+	std::shared_ptr<T> result( new T() );
+	submit( [=] { *result = createFn(); }, [=] { readyFn( *result ); }, errorFn );
+}
+
+class SharedContextExc : public Exception {
+  public:
+	SharedContextExc( const std::string &message ) throw() : mMessage( message ) {}
+	virtual ~SharedContextExc() throw() {}
+	virtual const char* what() const throw() { return mMessage.c_str(); }
+
+  private:
+	std::string		mMessage;
+};
+
+} } // namespace cinder::gl
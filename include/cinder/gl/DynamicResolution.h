@@ -0,0 +1,156 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/GpuProfiler.h"
+#include "cinder/Area.h"
+
+#include <boost/noncopyable.hpp>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class DynamicResolution>	DynamicResolutionRef;
+
+/** \brief Renders a scene at a resolution which adapts to its cost, and upscales it to the window with sharpening.
+ *
+ * The scene is drawn between begin() and end() into an Fbo sized for the largest scale, of which only the top-left getRenderSize() is used, so changing scale
+ * never reallocates. end() upscales that region to the output with a bilinear filter followed by an adjustable sharpen, then adjusts the scale for later frames.
+ *
+ * The cost of a frame is the GPU time of the scene as measured by a GpuProfiler where timer queries are supported, and otherwise the App's update and draw
+ * durations from FrameTiming. Costs are smoothed with an exponential moving average. When the smoothed cost exceeds the budget the scale drops, and when it
+ * falls below the budget by more than the hysteresis it rises, in both cases to the scale predicted to land in the middle of that band, assuming cost is
+ * proportional to the number of pixels. Changes are quantized to Format::step() and at least Format::adjustInterval() frames apart.
+ *
+ * \code
+ * void draw() {
+ * 	mDynamicResolution->begin();
+ * 	// draw the scene as usual, for example with mCam, which keeps the window's aspect ratio
+ * 	mDynamicResolution->end();
+ * 	// draw UI at full resolution
+ * }
+ * \endcode **/
+class DynamicResolution : private boost::noncopyable {
+  public:
+	class Format {
+	  public:
+		Format() : mMinScale( 0.5f ), mMaxScale( 1 ), mTargetFrameRate( 0 ), mBudget( 0.85f ), mHysteresis( 0.15f ), mSmoothing( 0.1f ),
+			mStep( 0.05f ), mAdjustInterval( 15 ), mSharpness( 0.4f )
+		{
+			mFboFormat.enableDepthBuffer( true, false );
+		}
+
+		//! Sets the smallest scale of the render resolution relative to the output. Default is \c 0.5.
+		Format&		minScale( float scale ) { mMinScale = scale; return *this; }
+		//! Sets the largest scale of the render resolution relative to the output, which may exceed \c 1 for supersampling. Default is \c 1.
+		Format&		maxScale( float scale ) { mMaxScale = scale; return *this; }
+		//! Sets the frame rate the budget is a fraction of, or \c 0 for the App's frame rate. Default is \c 0.
+		Format&		targetFrameRate( float frameRate ) { mTargetFrameRate = frameRate; return *this; }
+		//! Sets the fraction of the frame period the scene may take, leaving the rest for the upscale, UI and the CPU. Default is \c 0.85.
+		Format&		budget( float fraction ) { mBudget = fraction; return *this; }
+		//! Sets the fraction of the budget by which the cost must fall below it before the scale rises. Default is \c 0.15.
+		Format&		hysteresis( float fraction ) { mHysteresis = fraction; return *this; }
+		//! Sets the weight (0 - 1] of each frame's cost in the moving average. Smaller values react more slowly. Default is \c 0.1.
+		Format&		smoothing( float weight ) { mSmoothing = weight; return *this; }
+		//! Sets the increment the scale is quantized to. Default is \c 0.05.
+		Format&		step( float step ) { mStep = step; return *this; }
+		//! Sets the minimum number of frames between changes of scale, which should exceed the latency of the GPU timings. Default is \c 15.
+		Format&		adjustInterval( int frames ) { mAdjustInterval = frames; return *this; }
+		//! Sets the strength of the sharpening applied when upscaling, where \c 0 is plain bilinear. Default is \c 0.4.
+		Format&		sharpness( float sharpness ) { mSharpness = sharpness; return *this; }
+		//! Sets the format of the Fbo the scene is rendered into. Its filters are overridden with \c GL_LINEAR. Defaults to a depth renderbuffer and no mipmapping.
+		Format&		fboFormat( const Fbo::Format &format ) { mFboFormat = format; return *this; }
+
+		float			getMinScale() const { return mMinScale; }
+		float			getMaxScale() const { return mMaxScale; }
+		float			getTargetFrameRate() const { return mTargetFrameRate; }
+		float			getBudget() const { return mBudget; }
+		float			getHysteresis() const { return mHysteresis; }
+		float			getSmoothing() const { return mSmoothing; }
+		float			getStep() const { return mStep; }
+		int				getAdjustInterval() const { return mAdjustInterval; }
+		float			getSharpness() const { return mSharpness; }
+		const Fbo::Format&	getFboFormat() const { return mFboFormat; }
+
+	  private:
+		float		mMinScale, mMaxScale, mTargetFrameRate, mBudget, mHysteresis, mSmoothing, mStep;
+		int			mAdjustInterval;
+		float		mSharpness;
+		Fbo::Format	mFboFormat;
+	};
+
+	//! Creates a DynamicResolution which upscales to an output of \a outputSize pixels, usually the window's size in pixels. Requires a current GL context.
+	static DynamicResolutionRef		create( const Vec2i &outputSize, const Format &format = Format() ) { return DynamicResolutionRef( new DynamicResolution( outputSize, format ) ); }
+
+	//! Binds the Fbo and sets the viewport to getRenderSize(), saving the current framebuffer binding and viewport
+	void		begin();
+	//! Restores the framebuffer and viewport saved by begin(), draws the upscaled scene into \a outputArea of it (or the output size at the origin if empty), and adjusts the scale. The area is in OpenGL's bottom-left-origin coordinates.
+	void		end( const Area &outputArea = Area::zero() );
+
+	//! Sets the output size, reallocating the Fbo if it grows. Call from resize().
+	void		setOutputSize( const Vec2i &outputSize );
+	const Vec2i&	getOutputSize() const { return mOutputSize; }
+	//! Returns the current scale of the render resolution relative to the output
+	float		getScale() const { return mScale; }
+	//! Sets the scale, clamped to the Format's bounds. Automatic adjustment continues from it unless disabled.
+	void		setScale( float scale );
+	//! Enables or disables automatic adjustment of the scale. Enabled by default.
+	void		enableAdjustment( bool enable = true ) { mAdjustmentEnabled = enable; }
+	bool		isAdjustmentEnabled() const { return mAdjustmentEnabled; }
+	//! Returns the size in pixels the scene is rendered at, which is the output size times getScale()
+	Vec2i		getRenderSize() const;
+	//! Returns the smoothed cost of the scene in seconds
+	double		getSmoothedCost() const { return mSmoothedCost; }
+	//! Returns the Fbo the scene is rendered into. Only the top-left getRenderSize() of it (in Surface coordinates) holds the latest frame.
+	Fbo&		getFbo() { return mFbo; }
+	const Format&	getFormat() const { return mFormat; }
+
+  protected:
+	DynamicResolution( const Vec2i &outputSize, const Format &format );
+
+	void		allocateFbo();
+	void		adjustScale( double cost );
+	void		drawUpscaled( const Area &outputArea );
+
+	Format			mFormat;
+	Vec2i			mOutputSize;
+	Fbo				mFbo;
+	GlslProg		mUpscaleShader;
+	GpuProfilerRef	mGpuProfiler;
+	float			mScale;
+	bool			mAdjustmentEnabled;
+	double			mSmoothedCost;
+	int				mFramesSinceChange;
+	Vec2i			mBeginRenderSize;
+	GLint			mSavedFramebuffer;
+	GLint			mSavedViewport[4];
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -73,6 +73,7 @@ class Renderbuffer {
 		GLuint				mId;
 		GLenum				mInternalFormat;
 		int					mSamples, mCoverageSamples;
+		MemoryAllocation	mAllocation;
 	};
  
 	std::shared_ptr<Obj>		mObj;
@@ -86,6 +87,50 @@ class Renderbuffer {
 	//@}  	
 };
 
+/** \brief Pixels being read back from an Fbo without stalling the CPU. Returned by Fbo::readPixelsAsync() and Fbo::readDepthAsync(). \ImplShared
+	The read is issued into a pixel buffer object. Collecting the result one or two frames later with getSurface() or getChannel() avoids waiting on the GPU, while collecting it immediately blocks like glReadPixels(). **/
+class FboReadback {
+  public:
+	//! Creates a NULL FboReadback
+	FboReadback() {}
+
+	//! Returns the Area of the Fbo that was read, in OpenGL's bottom-left-origin window coordinates
+	const Area&		getArea() const { return mObj->mArea; }
+	//! Returns the color pixels, with the top row first. Maps the pixel buffer object on the first call, which blocks if the transfer is still in flight. NULL if this is a depth readback.
+	Surface8u		getSurface() const;
+	//! Returns the depth values, with the top row first. Maps the pixel buffer object on the first call, which blocks if the transfer is still in flight. NULL if this is a color readback.
+	Channel32f		getChannel() const;
+
+  protected:
+	FboReadback( const Area &area, GLenum dataFormat );
+
+	void		readPixels( GLenum dataFormat, GLenum type );
+	void		collect( void *dst, int32_t dstRowBytes, size_t pixelBytes ) const;
+
+	struct Obj {
+		Obj( const Area &area, GLenum dataFormat ) : mArea( area ), mDataFormat( dataFormat ), mPbo( 0 ) {}
+		~Obj();
+
+		Area				mArea;
+		GLenum				mDataFormat;
+		GLuint				mPbo;
+		mutable Surface8u	mSurface;
+		mutable Channel32f	mChannel;
+	};
+
+	std::shared_ptr<Obj>	mObj;
+
+	friend class Fbo;
+
+  public:
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> FboReadback::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &FboReadback::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
 //! Represents an OpenGL Framebuffer Object. //! Represents an instance of a font at a point size. \ImplShared
 class Fbo {
  public:
@@ -128,6 +173,10 @@ class Fbo {
 	void 			bindFramebuffer();
 	//! Unbinds the Fbo as the currently active framebuffer, restoring the primary context as the target for all subsequent rendering
 	static void 	unbindFramebuffer();
+	//! Sets the framebuffer which unbindFramebuffer(), blitToScreen() and blitFromScreen() treat as the screen. A Window with partial redraw enabled sets its own Fbo while drawing. Defaults to \c 0.
+	static void		setScreenFramebuffer( GLuint framebuffer ) { sScreenFramebuffer = framebuffer; }
+	//! Returns the framebuffer which unbindFramebuffer(), blitToScreen() and blitFromScreen() treat as the screen, which is \c 0 unless a Window with partial redraw enabled is drawing.
+	static GLuint	getScreenFramebuffer() { return sScreenFramebuffer; }
 
 	//! Returns the ID of the framebuffer itself. For antialiased FBOs this is the ID of the output multisampled FBO
 	GLuint		getId() const { return mObj->mId; }
@@ -142,6 +191,13 @@ class Fbo {
 	void		blitToScreen( const Area &srcArea, const Area &dstArea, GLenum filter = GL_NEAREST, GLbitfield mask = GL_COLOR_BUFFER_BIT ) const;
 	//! Copies from the screen from Area \a srcArea to \a dstArea using filter \a filter. \a mask allows specification of color (\c GL_COLOR_BUFFER_BIT) and/or depth(\c GL_DEPTH_BUFFER_BIT). Calls glBlitFramebufferEXT() and is subject to its constraints and coordinate system.
 	void		blitFromScreen( const Area &srcArea, const Area &dstArea, GLenum filter = GL_NEAREST, GLbitfield mask = GL_COLOR_BUFFER_BIT );
+
+	/** \brief Starts reading \a area of color buffer \a attachment into a pixel buffer object and returns immediately. Collect the RGBA result from the returned FboReadback a frame or two later.
+		\a area is in OpenGL's bottom-left-origin coordinates, as with blitTo(). Multisampled FBOs are resolved first. **/
+	FboReadback	readPixelsAsync( const Area &area, int attachment = 0 ) const;
+	/** \brief Starts reading \a area of the depth buffer into a pixel buffer object and returns immediately. Collect the result from the returned FboReadback a frame or two later.
+		\a area is in OpenGL's bottom-left-origin coordinates, as with blitTo(). Multisampled FBOs must have a depth texture so the depth can be resolved. **/
+	FboReadback	readDepthAsync( const Area &area ) const;
 #endif
 
 	//! Returns the maximum number of samples the graphics card is capable of using per pixel in MSAA for an Fbo
@@ -208,6 +264,10 @@ class Fbo {
 //		bool	hasStencilBuffer() const { return mStencilBuffer; }
 		//! Returns whether the contents of the FBO textures are mip-mapped.
 		bool	hasMipMapping() const { return mMipmapping; }
+
+		//! Returns whether every setting of \a rhs matches, meaning an Fbo created with either Format is interchangeable
+		bool	operator==( const Format &rhs ) const;
+		bool	operator!=( const Format &rhs ) const { return ! ( *this == rhs ); }
 		
 	  protected:
 		GLenum		mTarget;
@@ -250,6 +310,7 @@ class Fbo {
 	std::shared_ptr<Obj>	mObj;
 	
 	static GLint			sMaxSamples, sMaxAttachments;
+	static GLuint			sScreenFramebuffer;
 	
   public:
 	//@{
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/Fbo.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class FboPool>	FboPoolRef;
+
+/** \brief Hands out temporary Fbo's for intermediate passes, such as the blur passes of a bloom, and recycles them at the end of each frame.
+ *
+ * Fbo's are created lazily the first time no idle one of the requested size and Format is available, so the pool only ever holds as many as the
+ * frame's peak simultaneous use. Fbo's which go unused for more than a few frames, for example those of the old size after the window is resized,
+ * are destroyed. An acquired Fbo's contents are undefined, and it must not be used after endFrame() or release(), as it is handed out again.
+ *
+ * \code
+ * gl::Fbo blurH = mFboPool->acquire( getWindowSize() / 2, format );
+ * gl::Fbo blurV = mFboPool->acquire( getWindowSize() / 2, format );
+ * ...
+ * mFboPool->endFrame(); // at the end of draw()
+ * \endcode **/
+class FboPool : private boost::noncopyable {
+  public:
+	//! Creates an empty pool, which destroys Fbo's that have gone unused for more than \a maxIdleFrames frames
+	static FboPoolRef	create( uint32_t maxIdleFrames = 2 ) { return FboPoolRef( new FboPool( maxIdleFrames ) ); }
+
+	//! Returns an Fbo \a width pixels wide and \a height pixels high with Format \a format, which isn't in use this frame. Creates it if none is available.
+	Fbo		acquire( int width, int height, const Fbo::Format &format = Fbo::Format() );
+	//! Returns an Fbo of size \a size with Format \a format, which isn't in use this frame. Creates it if none is available.
+	Fbo		acquire( const Vec2i &size, const Fbo::Format &format = Fbo::Format() ) { return acquire( size.x, size.y, format ); }
+	//! Returns \a fbo to the pool before the end of the frame, so that a later pass of the same frame can reuse it
+	void	release( const Fbo &fbo );
+	//! Returns all acquired Fbo's to the pool and destroys those which have been unused for more than getMaxIdleFrames() frames. Call once per frame.
+	void	endFrame();
+	//! Destroys all of the pool's Fbo's
+	void	clear() { mEntries.clear(); }
+
+	//! Returns the number of Fbo's the pool currently holds
+	size_t		getNumFbos() const { return mEntries.size(); }
+	//! Returns the number of Fbo's acquired and not yet released this frame
+	size_t		getNumInUse() const;
+	//! Returns the highest number of Fbo's in use at the same time since the pool was created
+	size_t		getPeakInUse() const { return mPeakInUse; }
+	//! Returns the number of frames an Fbo may go unused before it is destroyed
+	uint32_t	getMaxIdleFrames() const { return mMaxIdleFrames; }
+	void		setMaxIdleFrames( uint32_t maxIdleFrames ) { mMaxIdleFrames = maxIdleFrames; }
+
+  private:
+	FboPool( uint32_t maxIdleFrames ) : mMaxIdleFrames( maxIdleFrames ), mFrame( 0 ), mPeakInUse( 0 ) {}
+
+	struct Entry {
+		Fbo			mFbo;
+		uint32_t	mLastUsedFrame;
+		bool		mInUse;
+	};
+
+	std::vector<Entry>	mEntries;
+	uint32_t			mMaxIdleFrames;
+	uint32_t			mFrame;
+	size_t				mPeakInUse;
+};
+
+} } // namespace cinder::gl
@@ -5530,7 +5530,7 @@ GLEE_EXTERN GLboolean _GLEE_SGIX_texture_range;
 #define GL_MAP_UNSYNCHRONIZED_BIT                          0x0020
 #ifndef GLEE_H_DEFINED_glMapBufferRange
 #define GLEE_H_DEFINED_glMapBufferRange
-  typedef void (APIENTRYP GLEEPFNGLMAPBUFFERRANGEPROC) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+  typedef GLvoid* (APIENTRYP GLEEPFNGLMAPBUFFERRANGEPROC) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
   GLEE_EXTERN GLEEPFNGLMAPBUFFERRANGEPROC GLeeFuncPtr_glMapBufferRange;
   #define glMapBufferRange GLeeFuncPtr_glMapBufferRange
 #endif
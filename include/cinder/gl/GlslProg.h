@@ -28,12 +28,19 @@
 #include <fstream>
 #include <exception>
 #include <map>
+#include <vector>
 
 #include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
 #include "cinder/Vector.h"
 #include "cinder/Color.h"
 #include "cinder/Matrix.h"
 #include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+
+#ifndef GL_UNIFORM_BUFFER
+	#define GL_UNIFORM_BUFFER 0x8A11
+#endif
 
 namespace cinder { namespace gl {
 
@@ -83,12 +90,79 @@ class GlslProg {
 	void	uniform( const std::string &name, const Matrix33f *data, int count, bool transpose = false );
 	void	uniform( const std::string &name, const Matrix44f *data, int count, bool transpose = false );
 
+	//! A uniform location resolved once by getUniformHandle(). Only valid for the GlslProg that returned it.
+	class Uniform {
+	  public:
+		Uniform() : mLocation( -1 ), mSlot( 0 ) {}
+
+		GLint	getLocation() const { return mLocation; }
+		//! Returns whether the uniform is active in the program
+		bool	isValid() const { return mLocation >= 0; }
+
+	  private:
+		Uniform( GLint location, size_t slot ) : mLocation( location ), mSlot( slot ) {}
+
+		GLint	mLocation;
+		size_t	mSlot;
+
+		friend class GlslProg;
+	};
+
+	//! Returns a handle to the uniform \a name, which the uniform() overloads below accept without a name lookup. Cache it alongside the GlslProg.
+	Uniform	getUniformHandle( const std::string &name );
+
+	/** These overloads keep a copy of the last value set through each handle and skip the GL call when it is unchanged. Like the named overloads, they apply
+		to the bound program. Call invalidateUniforms() after setting uniforms of this program behind its back, e.g. with glUniform*() or while another program was bound. **/
+	void	uniform( const Uniform &handle, int data );
+	void	uniform( const Uniform &handle, const Vec2i &data );
+	void	uniform( const Uniform &handle, const int *data, int count );
+	void	uniform( const Uniform &handle, const Vec2i *data, int count );
+	void	uniform( const Uniform &handle, float data );
+	void	uniform( const Uniform &handle, const Vec2f &data );
+	void	uniform( const Uniform &handle, const Vec3f &data );
+	void	uniform( const Uniform &handle, const Vec4f &data );
+	void	uniform( const Uniform &handle, const Color &data );
+	void	uniform( const Uniform &handle, const ColorA &data );
+	void	uniform( const Uniform &handle, const Matrix22f &data, bool transpose = false );
+	void	uniform( const Uniform &handle, const Matrix33f &data, bool transpose = false );
+	void	uniform( const Uniform &handle, const Matrix44f &data, bool transpose = false );
+	void	uniform( const Uniform &handle, const float *data, int count );
+	void	uniform( const Uniform &handle, const Vec2f *data, int count );
+	void	uniform( const Uniform &handle, const Vec3f *data, int count );
+	void	uniform( const Uniform &handle, const Vec4f *data, int count );
+	void	uniform( const Uniform &handle, const Matrix22f *data, int count, bool transpose = false );
+	void	uniform( const Uniform &handle, const Matrix33f *data, int count, bool transpose = false );
+	void	uniform( const Uniform &handle, const Matrix44f *data, int count, bool transpose = false );
+	//! Forgets the values recorded by the handle-based uniform() overloads, so the next call for each uniform uploads unconditionally
+	void	invalidateUniforms();
+
+	/** Assigns the uniform block \a blockName to \a bindingPoint. Uniform buffers are attached to binding points with bindUniformBuffer(), so a block shared
+		by several programs is uploaded once per change rather than once per program. Returns \c false if the block is not active or isUniformBlockSupported() is \c false. **/
+	bool			uniformBlock( const std::string &blockName, GLuint bindingPoint );
+	//! Attaches \a buffer, typically a Vbo with target \c GL_UNIFORM_BUFFER, to \a bindingPoint
+	static void		bindUniformBuffer( GLuint bindingPoint, const Vbo &buffer );
+	//! Returns whether the driver supports ARB_uniform_buffer_object. Currently only implemented on MSW.
+	static bool		isUniformBlockSupported();
+
 	GLint	getUniformLocation( const std::string &name );
 	GLint	getAttribLocation( const std::string &name );
 
 	std::string		getShaderLog( GLuint handle ) const;
 
+	/** Enables an on-disk cache of linked program binaries in \a directory, which is created on demand. Entries are keyed by the shader sources and the GL vendor,
+		renderer and version strings, so a driver update invalidates them; an entry the driver rejects is deleted and the program is recompiled from source.
+		Pass an empty path to disable the cache, which is the default. Has no effect unless isBinaryCacheSupported(). **/
+	static void				setBinaryCacheDirectory( const fs::path &directory );
+	static const fs::path&	getBinaryCacheDirectory();
+	//! Returns whether the driver supports ARB_get_program_binary with at least one binary format. Currently only implemented on MSW.
+	static bool				isBinaryCacheSupported();
+
   protected:
+	void			init( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices );
+	fs::path		getBinaryCachePath( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices ) const;
+	bool			loadBinary( const fs::path &path );
+	void			saveBinary( const fs::path &path ) const;
+	bool			updateUniformValue( const Uniform &handle, const void *data, size_t size, uint8_t tag = 0 );
 	void			loadShader( Buffer shaderSourceBuffer, GLint shaderType );
 	void			loadShader( const char *shaderSource, GLint shaderType );
 	void			attachShaders();
@@ -99,7 +173,10 @@ class GlslProg {
 		~Obj();
 		
 		GLuint						mHandle;
-		std::map<std::string,int>	mUniformLocs;
+		std::map<std::string,Uniform>		mUniforms;
+		std::map<GLint,size_t>				mUniformSlots;
+		//! Last value uploaded through each slot, prefixed by a tag byte; empty when unknown
+		std::vector<std::vector<uint8_t> >	mUniformValues;
 	};
  
 	std::shared_ptr<Obj>	mObj;
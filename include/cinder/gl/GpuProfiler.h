@@ -0,0 +1,123 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class GpuProfiler>	GpuProfilerRef;
+
+/** \brief Measures the time the GPU spends on render passes, such as the passes of a post-processing chain, with timer queries.
+ *
+ * Each frame's queries are read back getNumBufferedFrames() - 1 frames later, by which time the GPU has finished them, so reading never stalls.
+ * Results are available from getPassSeconds() and getLastFrame(), and are recorded on the "GPU" track of the cinder::Profiler, where they
+ * appear in exported traces and the per-frame stats. A pass's zone begins when the pass was submitted, as the GPU's clock isn't related to the CPU's.
+ * Only one timer query can be active at a time, so nested passes are counted as part of the outermost pass. Requires EXT_timer_query (isSupported()), and does nothing otherwise.
+ *
+ * \code
+ * {
+ * 	gl::ScopedGpuPass pass( mGpuProfiler, "bloom" );
+ * 	...
+ * }
+ * mGpuProfiler->endFrame(); // at the end of draw()
+ * \endcode **/
+class GpuProfiler : private boost::noncopyable {
+  public:
+	//! The GPU time of a pass
+	struct Pass {
+		std::string	mName;
+		double		mSeconds;
+	};
+
+	//! Creates a GpuProfiler that buffers the queries of \a numBufferedFrames frames (at least 2) before reading them back. Must be called with a current GL context.
+	static GpuProfilerRef	create( size_t numBufferedFrames = 3 ) { return GpuProfilerRef( new GpuProfiler( numBufferedFrames ) ); }
+	~GpuProfiler();
+
+	//! Returns whether timer queries are supported by the current GL context
+	static bool		isSupported();
+
+	//! Begins timing the pass \a name, which must be a string literal (or otherwise outlive the Profiler's capture). If a pass is already being timed, only nesting is tracked.
+	void	beginPass( const char *name );
+	//! Ends timing the current pass
+	void	endPass();
+	//! Ends the frame, reading back the results of the frame issued getNumBufferedFrames() - 1 frames ago. Call once per frame.
+	void	endFrame();
+
+	//! Returns the GPU time in seconds of the pass \a name in the most recent frame that has been read back, or \c 0 if it had no such pass
+	double					getPassSeconds( const std::string &name ) const;
+	//! Returns the passes of the most recent frame that has been read back, in the order they were issued
+	const std::vector<Pass>&	getLastFrame() const { return mLastFrame; }
+	//! Returns the summed GPU time of the passes of the most recent frame that has been read back
+	double					getLastFrameSeconds() const;
+	//! Returns the number of frames whose queries are buffered
+	size_t					getNumBufferedFrames() const { return mFrames.size(); }
+	//! Returns the number of frames whose results were discarded because the GPU hadn't finished them when they were read back
+	size_t					getNumDroppedFrames() const { return mNumDroppedFrames; }
+
+  private:
+	GpuProfiler( size_t numBufferedFrames );
+
+	struct PendingPass {
+		const char	*mName;
+		GLuint		mQuery;
+		double		mSubmitSeconds;
+	};
+
+	struct Frame {
+		Frame() : mNumPasses( 0 ) {}
+
+		std::vector<PendingPass>	mPasses;	// only the first mNumPasses are in use, the rest keep their queries for reuse
+		size_t						mNumPasses;
+	};
+
+	void	readBack( Frame *frame );
+
+	std::vector<Frame>	mFrames;
+	size_t				mFrameIndex;
+	bool				mSupported;
+	size_t				mPassDepth;
+	size_t				mTrackId;
+	std::vector<Pass>	mLastFrame;
+	size_t				mNumDroppedFrames;
+};
+
+//! Times the GPU work issued during its lifetime as a pass of a GpuProfiler
+class ScopedGpuPass : private boost::noncopyable {
+  public:
+	ScopedGpuPass( const GpuProfilerRef &profiler, const char *name ) : mProfiler( profiler.get() ) { mProfiler->beginPass( name ); }
+	~ScopedGpuPass() { mProfiler->endPass(); }
+
+  private:
+	GpuProfiler		*mProfiler;
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/Texture.h"
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl { namespace ip {
+
+/** \file
+ * GPU counterparts of the cinder::ip functions, which read a Texture and render into an Fbo so that frames from Capture or a movie never leave the GPU.
+ * The GLSL programs are compiled the first time each function is used with a texture target and cached from then on, and intermediate passes use
+ * pooled Fbo's which are recycled across calls. Both belong to the GL context which is current at the time, or its share group.
+ *
+ * Images are addressed in texel coordinates, which match Surface coordinates for a Texture created from a Surface. Color values are normalized, so an 8-bit
+ * threshold of 128 is 128 / 255.0f here. Samples outside of the source repeat its edges, as in the CPU versions. The destination's texture inherits the source's
+ * isFlipped(), and results are written to the intersection of the source's clean bounds and the destination's bounds unless noted otherwise.
+ * \a dstFbo must never be the Fbo whose texture is being read.
+ **/
+
+//! Resizes \a srcArea of \a srcTexture into \a dstArea of \a dstFbo with a separable triangle filter, which is widened when shrinking as in ci::ip::resize()'s default FilterTriangle. Reductions beyond 63x are filtered as 63x.
+void resize( const Texture &srcTexture, const Area &srcArea, Fbo *dstFbo, const Area &dstArea );
+//! Resizes \a srcTexture to fill \a dstFbo with a separable triangle filter
+inline void resize( const Texture &srcTexture, Fbo *dstFbo ) { resize( srcTexture, srcTexture.getCleanBounds(), dstFbo, dstFbo->getBounds() ); }
+
+//! Composites \a foreground over \a background with the equations of ci::ip::blend(), storing the result in \a dstFbo. Outside of \a foreground the background is copied.
+/** Texture has no premultiplied flag, so \a foregroundPremultiplied and \a backgroundPremultiplied stand in for Surface::isPremultiplied(). A \a background without alpha samples as opaque. **/
+void blend( const Texture &background, const Texture &foreground, Fbo *dstFbo, bool foregroundPremultiplied = false, bool backgroundPremultiplied = false );
+//! Composites \a foreground over the contents of \a backgroundFbo in place, by way of a pooled Fbo
+void blend( Fbo *backgroundFbo, const Texture &foreground, bool foregroundPremultiplied = false, bool backgroundPremultiplied = false );
+
+//! Sets the red, green and blue of each pixel of \a srcTexture to 1 when greater than \a value and 0 otherwise, storing the result in \a dstFbo. Alpha is copied.
+void threshold( const Texture &srcTexture, float value, Fbo *dstFbo );
+
+//! Stores the Sobel gradient magnitude of the red, green and blue of \a srcTexture in \a dstFbo, clamped to 1 as ci::ip::edgeDetectSobel() clamps to the range of its type.
+/** Unlike the CPU version alpha is copied rather than edge detected, since an Fbo always has alpha and an opaque source would otherwise produce a transparent result. **/
+void edgeDetectSobel( const Texture &srcTexture, Fbo *dstFbo );
+
+//! Blurs \a srcTexture with a box filter of \a radius texels in two separable passes, storing the result in \a dstFbo. \a radius is limited to 255.
+void boxBlur( const Texture &srcTexture, Fbo *dstFbo, int32_t radius );
+//! Blurs \a srcTexture with a Gaussian of standard deviation \a sigma in two separable passes, storing the result in \a dstFbo.
+/** Rather than ci::ip::gaussianBlur()'s three box filters the Gaussian is sampled directly out to 3 \a sigma, so the cost grows with \a sigma, which is limited to 85. **/
+void gaussianBlur( const Texture &srcTexture, Fbo *dstFbo, float sigma );
+
+//! Stores the luminance of \a srcTexture in the red, green and blue of \a dstFbo, using the same Rec. 709 weights as ci::ip::grayscale(). Alpha is copied.
+void grayscale( const Texture &srcTexture, Fbo *dstFbo );
+
+//! Multiplies the red, green and blue of \a srcTexture by its alpha, storing the result in \a dstFbo
+void premultiply( const Texture &srcTexture, Fbo *dstFbo );
+//! Divides the red, green and blue of \a srcTexture by its alpha, storing the result in \a dstFbo. Transparent pixels are stored unchanged.
+void unpremultiply( const Texture &srcTexture, Fbo *dstFbo );
+
+//! Finds the nearest seed of each texel by jump flooding, where seeds are the texels of \a seedTexture whose red is greater than \a threshold. The red and green of \a nearestFbo receive the texel coordinates of the nearest seed, blue the distance to it and alpha 1, or 0 when there are no seeds.
+/** \a nearestFbo needs a floating point color format such as \c GL_RGBA32F_ARB. The steps halve from half the larger dimension down to 1 and are followed by another step of 1, which corrects most of the texels jump flooding misses; the result is exact for all but a few texels where Voronoi regions are very thin. ci::ip::distanceTransform() is the exact equivalent on the CPU. **/
+void jumpFlood( const Texture &seedTexture, Fbo *nearestFbo, float threshold = 0.5f );
+//! Stores the distance in texels from each texel to the nearest seed of \a seedTexture, as found by jumpFlood(), multiplied by \a scale in the red, green and blue of \a dstFbo. Alpha is 1.
+void distanceTransform( const Texture &seedTexture, Fbo *dstFbo, float threshold = 0.5f, float scale = 1.0f );
+//! Fills each texel of \a dstFbo with the color of \a seedTexture at the nearest seed, as found by jumpFlood(), which gives the discrete Voronoi diagram of the seeds. Texels are transparent black when there are no seeds.
+void voronoi( const Texture &seedTexture, Fbo *dstFbo, float threshold = 0.5f );
+
+} } } // namespace cinder::gl::ip
+
+#endif // ! defined( CINDER_GLES )
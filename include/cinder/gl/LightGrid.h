@@ -0,0 +1,124 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/Camera.h"
+#include "cinder/Color.h"
+
+#include <vector>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class LightGrid>	LightGridRef;
+
+/** \brief Clustered culling of many point lights, so that each fragment only shades the lights which can reach it.
+ *
+ * The view is divided into screen tiles of Format::tileSize() pixels, and each tile into Format::slices() slices spaced logarithmically between the
+ * camera's near and far planes. update() assigns each light to the clusters its sphere of influence overlaps, using the exact screen space bounds of
+ * the sphere, and uploads the lists to three float textures (ARB_texture_float). Fragment shaders find their cluster from \c gl_FragCoord and their
+ * depth, so the cost of a light is limited to the pixels near it.
+ *
+ * getGlslFunctions() returns GLSL 1.20 declaring the uniforms set by setUniforms() and <tt>vec3 ciPointLights( vec3 eyePosition, vec3 eyeNormal )</tt>,
+ * which sums the diffuse light reaching a fragment. Each light's intensity falls off quadratically to 0 at its radius. The viewport is expected to
+ * start at the origin, as \c gl_FragCoord does.
+ **/
+class LightGrid {
+  public:
+	struct PointLight {
+		PointLight( const Vec3f &position, float radius, const Color &color ) : mPosition( position ), mRadius( radius ), mColor( color ) {}
+
+		Vec3f	mPosition;
+		float	mRadius;
+		Color	mColor;
+	};
+
+	struct Format {
+		Format() : mTileSize( 64 ), mNumSlices( 16 ), mMaxLights( 1024 ) {}
+
+		//! Sets the width and height in pixels of each screen tile. Default is 64.
+		Format&		tileSize( int pixels ) { mTileSize = std::max( pixels, 1 ); return *this; }
+		//! Sets the number of depth slices of each tile. Default is 16.
+		Format&		slices( int numSlices ) { mNumSlices = std::max( numSlices, 1 ); return *this; }
+		//! Sets the maximum number of lights, beyond which update() ignores them. Default is 1024.
+		Format&		maxLights( int maxLights ) { mMaxLights = std::max( maxLights, 1 ); return *this; }
+
+		int		getTileSize() const { return mTileSize; }
+		int		getNumSlices() const { return mNumSlices; }
+		int		getMaxLights() const { return mMaxLights; }
+
+	  private:
+		int		mTileSize, mNumSlices, mMaxLights;
+	};
+
+	static LightGridRef	create( const Format &format = Format() ) { return LightGridRef( new LightGrid( format ) ); }
+
+	//! Assigns \a lights, in world coordinates, to the clusters of \a camera's view of a viewport \a viewportSize pixels large, and uploads the result
+	void	update( const CameraPersp &camera, const Vec2i &viewportSize, const std::vector<PointLight> &lights );
+
+	int		getNumTilesX() const { return mNumTilesX; }
+	int		getNumTilesY() const { return mNumTilesY; }
+	int		getNumSlices() const { return mFormat.getNumSlices(); }
+	//! Returns the number of lights overlapping cluster \a tileX, \a tileY, \a slice. Tile 0, 0 is at the bottom left.
+	size_t			getClusterNumLights( int tileX, int tileY, int slice ) const { return mClusterCounts[calcClusterIndex( tileX, tileY, slice )]; }
+	//! Returns the lights overlapping cluster \a tileX, \a tileY, \a slice, as indices into the lights passed to update()
+	const uint32_t*	getClusterLights( int tileX, int tileY, int slice ) const { return mLightIndices.empty() ? NULL : &mLightIndices[mClusterOffsets[calcClusterIndex( tileX, tileY, slice )]]; }
+	//! Returns the total number of light assignments, each costing a texture lookup in the clusters it's assigned to
+	size_t			getNumLightIndices() const { return mLightIndices.size(); }
+	const Format&	getFormat() const { return mFormat; }
+
+	//! Binds the grid's textures to \a firstTextureUnit and the two units after it, and sets the uniforms declared by getGlslFunctions() on \a shader, which must be bound
+	void				setUniforms( GlslProg &shader, int firstTextureUnit );
+	//! Returns GLSL 1.20 declaring the uniforms set by setUniforms() and <tt>vec3 ciPointLights( vec3 eyePosition, vec3 eyeNormal )</tt>
+	static const char*	getGlslFunctions();
+
+  protected:
+	LightGrid( const Format &format );
+
+	size_t	calcClusterIndex( int tileX, int tileY, int slice ) const { return ( slice * mNumTilesY + tileY ) * mNumTilesX + tileX; }
+
+	// The range of clusters a light overlaps, inclusive
+	struct ClusterRange {
+		int		mX0, mX1, mY0, mY1, mSlice0, mSlice1;
+	};
+
+	Format						mFormat;
+	int							mNumTilesX, mNumTilesY;
+	float						mSliceScale, mSliceBias;
+
+	std::vector<ClusterRange>	mLightRanges;
+	std::vector<uint32_t>		mClusterCounts, mClusterOffsets;
+	std::vector<uint32_t>		mLightIndices;
+
+	std::vector<float>			mClusterData, mIndexData, mLightData;
+	Texture						mClusterTexture, mIndexTexture, mLightTexture;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
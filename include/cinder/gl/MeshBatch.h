@@ -0,0 +1,116 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/TriMesh.h"
+
+#include <vector>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class MeshBatch>	MeshBatchRef;
+
+/** \brief Submits many meshes, each drawn any number of times with its own transform and color, in as few GL calls as possible.
+ *
+ * Meshes are appended to one shared vertex and index buffer with addMesh(), and each frame's draws are queued with addDraw(). Where the driver supports
+ * ARB_multi_draw_indirect and ARB_base_instance, draw() builds a buffer of indirect commands, one per mesh drawn with one instance per addDraw(), and
+ * submits all of them with a single \c glMultiDrawElementsIndirect(). Elsewhere it falls back to a \c glDrawElements() per draw from the same buffers,
+ * which still avoids the per-mesh client state setup of gl::draw( VboMesh ).
+ *
+ * The per-draw parameters reach the shader as the attributes \c ciModelMatrix (a \c mat4) and \c ciColor (a \c vec4), instanced in the indirect path and
+ * set as constant attributes in the fallback, so one shader serves both. The vertices are \c gl_Vertex, \c gl_Normal and \c gl_MultiTexCoord0. The
+ * default shader transforms by \c ciModelMatrix and the current \c MODELVIEW and \c PROJECTION matrices and shades \c ciColor with a head light.
+ **/
+class MeshBatch {
+  public:
+	//! Per-draw parameters, as they're stored in the instance buffer
+	struct Instance {
+		Instance( const Matrix44f &modelMatrix, const ColorA &color ) : mModelMatrix( modelMatrix ), mColor( color ) {}
+
+		Matrix44f	mModelMatrix;
+		ColorA		mColor;
+	};
+
+	//! Creates an empty MeshBatch drawn with \a shader, or the default shader when \a shader is null
+	static MeshBatchRef	create( const GlslProg &shader = GlslProg() ) { return MeshBatchRef( new MeshBatch( shader ) ); }
+
+	//! Appends the triangles of \a triMesh to the shared buffers and returns its id for addDraw(). Missing normals and texture coordinates are zero.
+	uint32_t	addMesh( const TriMesh &triMesh );
+	size_t		getNumMeshes() const { return mMeshes.size(); }
+	//! Removes every mesh and draw
+	void		clear();
+
+	//! Queues a draw of mesh \a meshId transformed by \a modelMatrix
+	void		addDraw( uint32_t meshId, const Matrix44f &modelMatrix, const ColorA &color = ColorA::white() );
+	//! Removes the queued draws, typically at the start of a frame. The meshes are kept.
+	void		clearDraws();
+	size_t		getNumDraws() const { return mDrawMeshIds.size(); }
+
+	//! Submits every queued draw. The queue is kept, so an unchanged scene can simply be drawn again.
+	void		draw();
+
+	const GlslProg&		getShader() const { return mShader; }
+	//! Returns the shared vertex and index buffers, built by draw() after meshes are added
+	const VboMeshRef&	getVboMesh() const { return mVboMesh; }
+
+	//! Returns whether the driver supports ARB_multi_draw_indirect and ARB_base_instance, which draw() uses to submit everything with a single call
+	static bool			isMultiDrawIndirectSupported();
+
+  protected:
+	MeshBatch( const GlslProg &shader );
+
+	void	buildDraws();
+
+	// Matches the layout GL expects of each command in the indirect buffer
+	struct DrawElementsIndirectCommand {
+		GLuint	mCount, mInstanceCount, mFirstIndex, mBaseVertex, mBaseInstance;
+	};
+
+	struct Mesh {
+		uint32_t	mFirstIndex, mNumIndices;
+	};
+
+	GlslProg			mShader;
+	GLint				mModelMatrixLocation, mColorLocation;
+
+	TriMesh				mGeometry;
+	std::vector<Mesh>	mMeshes;
+	VboMeshRef			mVboMesh;
+	bool				mGeometryDirty;
+
+	std::vector<uint32_t>						mDrawMeshIds;
+	std::vector<Instance>						mDraws, mSortedDraws; // mSortedDraws are grouped by mesh, in the order of mCommands
+	std::vector<DrawElementsIndirectCommand>	mCommands;
+	Vbo											mInstanceVbo, mCommandVbo;
+	bool										mDrawsDirty;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
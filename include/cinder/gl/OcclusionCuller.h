@@ -0,0 +1,102 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/Camera.h"
+#include "cinder/DepthPyramid.h"
+
+#include <deque>
+#include <vector>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class OcclusionCuller>	OcclusionCullerRef;
+
+/** \brief Hierarchical-Z occlusion culling against the depth of an earlier frame.
+ *
+ * After a frame's occluders are drawn, update() reduces the Fbo's depth texture on the GPU, each pass keeping the farthest depth of 2x2 texels,
+ * until it is no larger than Format::readbackSize() texels in either direction. It then reads that level back without stalling, through
+ * Fbo::readDepthAsync(). Format::latency() frames later the readback is collected into a DepthPyramid, against which isVisible() and testBoxes()
+ * test bounding boxes in world coordinates. Those tests use the camera of the frame the depth was drawn in, so an object uncovered by the camera's
+ * movement since may be culled for that many frames. Frustum culling with the current camera remains a separate step.
+ * \code
+ * for( size_t i = 0; i < mObjects.size(); ++i )
+ *	if( frustum.intersects( mObjects[i].mBounds ) && mCuller->isVisible( mObjects[i].mBounds ) )
+ *		mObjects[i].draw();
+ * mCuller->update( mSceneFbo, mCamera );
+ * \endcode **/
+class OcclusionCuller {
+  public:
+	struct Format {
+		Format() : mReadbackSize( 256 ), mLatency( 1 ) {}
+
+		//! Sets the largest width and height of the depth read back to the CPU. Default is 256.
+		Format&		readbackSize( int size ) { mReadbackSize = std::max( size, 1 ); return *this; }
+		//! Sets the number of frames a readback is given to complete before it's collected. 0 collects immediately, which stalls. Default is 1.
+		Format&		latency( int frames ) { mLatency = std::max( frames, 0 ); return *this; }
+
+		int		getReadbackSize() const { return mReadbackSize; }
+		int		getLatency() const { return mLatency; }
+
+	  private:
+		int		mReadbackSize, mLatency;
+	};
+
+	static OcclusionCullerRef	create( const Format &format = Format() ) { return OcclusionCullerRef( new OcclusionCuller( format ) ); }
+
+	//! Starts reading back the depth of \a depthFbo, which must have a depth texture, drawn through \a camera, and collects the readback from Format::latency() frames ago
+	void	update( Fbo &depthFbo, const Camera &camera );
+
+	//! Returns \c false if \a box is certainly hidden in the collected depth, and \c true if it may be visible or no depth has been collected yet
+	bool	isVisible( const AxisAlignedBox3f &box ) const { return mDepthPyramid.isVisible( box ); }
+	//! Tests \a count boxes as DepthPyramid::testBoxes() does, setting bit <tt>i % 32</tt> of <tt>resultMask[i / 32]</tt> if box \c i may be visible
+	size_t	testBoxes( const AxisAlignedBox3f *boxes, size_t count, uint32_t *resultMask ) const { return mDepthPyramid.testBoxes( boxes, count, resultMask ); }
+
+	const DepthPyramid&		getDepthPyramid() const { return mDepthPyramid; }
+	const Format&			getFormat() const { return mFormat; }
+
+  protected:
+	OcclusionCuller( const Format &format );
+
+	struct PendingReadback {
+		FboReadback		mReadback;
+		Matrix44f		mViewProjection;
+	};
+
+	Format							mFormat;
+	GlslProg						mReduceShader;
+	Vec2i							mSourceSize;
+	std::vector<Fbo>				mLevels;
+	std::deque<PendingReadback>		mPendingReadbacks;
+	DepthPyramid					mDepthPyramid;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
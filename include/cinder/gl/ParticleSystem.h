@@ -0,0 +1,183 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/Color.h"
+#include "cinder/Rect.h"
+#include "cinder/TriMesh.h"
+
+#include <vector>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class ParticleSystem>	ParticleSystemRef;
+
+/** \brief A particle system simulated and drawn entirely on the GPU.
+ *
+ * Particles live in two buffers of getMaxParticles() entries, each the instance buffer of a VboMesh. update() runs a vertex shader over one buffer and
+ * captures its output into the other with transform feedback, so the CPU only uploads a handful of uniforms per frame regardless of the particle count.
+ * draw() then draws the current buffer with drawInstanced(), one camera-facing quad per particle.
+ *
+ * Emitters spawn into the buffers as a ring, replacing the oldest particles first, so getMaxParticles() should be at least the total emission rate times
+ * the longest lifetime to avoid cutting particles short. Particles are accelerated by gravity and by point attractors, slowed by drag, and can collide
+ * with a heightfield. Each particle has two instance attributes, \c positionAge (position in xyz, seconds lived in w) and \c velocityLife (velocity in
+ * xyz, lifetime in seconds in w); a particle is dead when its age reaches its lifetime.
+ *
+ * Requires isSupported(), which is to say EXT_transform_feedback, EXT_gpu_shader4 and VboMesh::isInstancingSupported().
+ **/
+class ParticleSystem {
+  public:
+	static const int MAX_EMITTERS	= 8;
+	static const int MAX_ATTRACTORS	= 8;
+
+	//! Spawns particles in a sphere, with velocities scattered in a sphere around a base velocity
+	struct Emitter {
+		Emitter() : mPosition( Vec3f::zero() ), mRadius( 0 ), mVelocity( 0, 1, 0 ), mVelocitySpread( 0.25f ), mRate( 1000 ), mLifetimeMin( 1 ), mLifetimeMax( 2 ) {}
+
+		Emitter&	position( const Vec3f &position ) { mPosition = position; return *this; }
+		//! Sets the radius of the sphere around position() particles spawn in. Default is 0.
+		Emitter&	radius( float radius ) { mRadius = radius; return *this; }
+		Emitter&	velocity( const Vec3f &velocity ) { mVelocity = velocity; return *this; }
+		//! Sets the radius of the sphere around velocity() the initial velocities are drawn from. Default is 0.25.
+		Emitter&	velocitySpread( float spread ) { mVelocitySpread = spread; return *this; }
+		//! Sets the number of particles spawned per second. Default is 1000.
+		Emitter&	rate( float particlesPerSecond ) { mRate = particlesPerSecond; return *this; }
+		//! Sets the range lifetimes in seconds are drawn from. Default is 1 to 2.
+		Emitter&	lifetime( float minSeconds, float maxSeconds ) { mLifetimeMin = minSeconds; mLifetimeMax = maxSeconds; return *this; }
+
+		Vec3f	mPosition;
+		float	mRadius;
+		Vec3f	mVelocity;
+		float	mVelocitySpread;
+		float	mRate;
+		float	mLifetimeMin, mLifetimeMax;
+	};
+
+	//! Pulls particles towards \a mPosition with an acceleration of \a mStrength over the squared distance. A negative strength repels.
+	struct Attractor {
+		Attractor() : mPosition( Vec3f::zero() ), mStrength( 0 ) {}
+		Attractor( const Vec3f &position, float strength ) : mPosition( position ), mStrength( strength ) {}
+
+		Vec3f	mPosition;
+		float	mStrength;
+	};
+
+	//! Creates a ParticleSystem with room for \a maxParticles particles, all of them dead. Throws ParticleSystemExc if isSupported() is \c false.
+	static ParticleSystemRef	create( size_t maxParticles ) { return ParticleSystemRef( new ParticleSystem( maxParticles ) ); }
+
+	//! Returns whether the driver supports everything a ParticleSystem requires
+	static bool		isSupported();
+
+	size_t		getMaxParticles() const { return mMaxParticles; }
+
+	//! Adds \a emitter and returns its index. Emitters beyond MAX_EMITTERS are ignored.
+	size_t						addEmitter( const Emitter &emitter ) { mEmitters.push_back( emitter ); mEmitterRemainders.push_back( 0 ); return mEmitters.size() - 1; }
+	std::vector<Emitter>&		getEmitters() { return mEmitters; }
+	const std::vector<Emitter>&	getEmitters() const { return mEmitters; }
+	void						clearEmitters() { mEmitters.clear(); mEmitterRemainders.clear(); }
+
+	//! Adds \a attractor and returns its index. Attractors beyond MAX_ATTRACTORS are ignored.
+	size_t						addAttractor( const Attractor &attractor ) { mAttractors.push_back( attractor ); return mAttractors.size() - 1; }
+	std::vector<Attractor>&		getAttractors() { return mAttractors; }
+	const std::vector<Attractor>&	getAttractors() const { return mAttractors; }
+	void						clearAttractors() { mAttractors.clear(); }
+
+	//! Sets the constant acceleration applied to every particle. Default is zero.
+	void			setGravity( const Vec3f &gravity ) { mGravity = gravity; }
+	const Vec3f&	getGravity() const { return mGravity; }
+	//! Sets the fraction of its velocity a particle loses per second. Default is 0.
+	void			setDrag( float drag ) { mDrag = drag; }
+	float			getDrag() const { return mDrag; }
+
+	/** Makes particles collide with the surface <tt>y = heightfield.r * heightScale + heightOffset</tt>, where the texture's s axis spans \a boundsXZ's
+		x1 to x2 in x and its t axis y1 to y2 in z. Particles outside \a boundsXZ don't collide. The texture is sampled in the vertex shader, so it should be
+		a format the driver supports vertex texture fetch for, such as GL_LUMINANCE32F_ARB, and should use GL_LINEAR or GL_NEAREST filtering. **/
+	void		setHeightfield( const Texture &heightfield, const Rectf &boundsXZ, float heightScale = 1, float heightOffset = 0 );
+	void		clearHeightfield() { mHeightfield.reset(); }
+	//! Sets the fraction of the normal velocity kept when bouncing off the heightfield, and the fraction of the tangential velocity lost. Default is 0.5 and 0.1.
+	void		setCollisionResponse( float restitution, float friction ) { mRestitution = restitution; mFriction = friction; }
+
+	//! Sets the width of the quads draw() draws, in the units of the modelview matrix. Default is 1.
+	void			setParticleSize( float size ) { mParticleSize = size; }
+	float			getParticleSize() const { return mParticleSize; }
+	//! Sets the colors draw() fades particles between over their lifetime. Default is opaque white to transparent white.
+	void			setColors( const ColorA &start, const ColorA &end ) { mStartColor = start; mEndColor = end; }
+
+	//! Spawns, moves and collides the particles over \a deltaSeconds
+	void		update( float deltaSeconds );
+	//! Kills every particle
+	void		reset();
+
+	//! Draws each live particle as a quad facing the camera, faded from the start to the end color over its lifetime
+	void		draw();
+	/** Draws every particle with drawInstanced() using \a shader, which should be bound. Its \c positionAge and \c velocityLife attributes are bound to
+		the particle's, and gl_Vertex to the corners of a quad from -0.5 to 0.5 in x and y. Dead particles are drawn too, and should be collapsed by the shader. **/
+	void		draw( GlslProg &shader );
+
+	//! Returns the VboMesh whose instance buffer holds the current particles, for drawing with a custom mesh layout
+	const VboMeshRef&	getMesh() const { return mMeshes[mCurrent]; }
+
+  protected:
+	ParticleSystem( size_t maxParticles );
+
+	void		bindInstanceLocations( VboMesh &mesh, GlslProg &shader );
+
+	size_t					mMaxParticles;
+	VboMeshRef				mMeshes[2];
+	int						mCurrent;
+	size_t					mEmitStart;
+	float					mSeed;
+
+	std::vector<Emitter>	mEmitters;
+	std::vector<float>		mEmitterRemainders;
+	std::vector<Attractor>	mAttractors;
+	Vec3f					mGravity;
+	float					mDrag;
+
+	Texture					mHeightfield;
+	Rectf					mHeightfieldBounds;
+	float					mHeightScale, mHeightOffset;
+	float					mRestitution, mFriction;
+
+	float					mParticleSize;
+	ColorA					mStartColor, mEndColor;
+
+	GlslProg				mUpdateShader, mDrawShader;
+	GLint					mPositionAgeLocation, mVelocityLifeLocation;
+};
+
+class ParticleSystemExc : public Exception {
+  public:
+	virtual const char* what() const throw() { return "ParticleSystem requires EXT_transform_feedback, EXT_gpu_shader4 and instanced arrays"; }
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,98 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Shape2d.h"
+#include "cinder/Triangulate.h"
+
+#include <vector>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class ShapeMesh>	ShapeMeshRef;
+
+/** \brief A Shape2d or Path2d tessellated once into VboMeshes, for vector graphics which are drawn repeatedly.
+ *
+ * The fill is triangulated the first time drawSolid() is called, and the outline, every contour's subdivision as lines, the first time draw() is called,
+ * so an outline-only shape is never triangulated. Each then draws with a single call in the current color and \c MODELVIEW matrix.
+ *
+ * gl::draw() and gl::drawSolid() of a Path2d or Shape2d go through a shared cache of ShapeMeshes keyed by the path's segments and points, its approximation
+ * scale and winding rule. A lookup hashes the path and then compares it exactly, so a change to any point simply misses. A path is only tessellated into the
+ * cache the second time it is seen, so paths which change every frame are drawn as before rather than filling the cache, and the least recently used entries
+ * are evicted beyond getCacheCapacity(). The cache belongs to the GL context current when it is used and must only be used from its thread.
+ **/
+class ShapeMesh {
+  public:
+	//! Creates a ShapeMesh of \a shape, subdivided with \a approximationScale and filled with \a winding
+	static ShapeMeshRef	create( const Shape2d &shape, float approximationScale = 1.0f, Triangulator::Winding winding = Triangulator::WINDING_ODD );
+	//! Creates a ShapeMesh of \a path, subdivided with \a approximationScale and filled with \a winding
+	static ShapeMeshRef	create( const Path2d &path, float approximationScale = 1.0f, Triangulator::Winding winding = Triangulator::WINDING_ODD );
+
+	//! Draws the filled shape
+	void	drawSolid() const;
+	//! Draws the outline of every contour
+	void	draw() const;
+
+	//! Returns the fill as indexed \c GL_TRIANGLES, triangulating it on first use. Null when the shape has no area.
+	const VboMeshRef&	getSolidVboMesh() const;
+	//! Returns the outline as indexed \c GL_LINES, subdividing it on first use. Null when the shape has no segments.
+	const VboMeshRef&	getOutlineVboMesh() const;
+
+	const std::vector<Path2d>&	getContours() const { return mContours; }
+	float						getApproximationScale() const { return mApproximationScale; }
+	Triangulator::Winding		getWinding() const { return mWinding; }
+
+	//! Returns the cached ShapeMesh of \a shape, or null the first time \a shape is seen, in which case it is cached if it is seen again before being evicted
+	static ShapeMeshRef	findCached( const Shape2d &shape, float approximationScale = 1.0f, Triangulator::Winding winding = Triangulator::WINDING_ODD );
+	//! Returns the cached ShapeMesh of \a path, or null the first time \a path is seen, in which case it is cached if it is seen again before being evicted
+	static ShapeMeshRef	findCached( const Path2d &path, float approximationScale = 1.0f, Triangulator::Winding winding = Triangulator::WINDING_ODD );
+
+	//! Returns the number of paths the cache remembers, whether or not they have been tessellated
+	static size_t	getCacheSize();
+	//! Returns the number of paths the cache remembers before evicting the least recently used. Defaults to 1024.
+	static size_t	getCacheCapacity();
+	static void		setCacheCapacity( size_t capacity );
+	//! Releases every cached ShapeMesh
+	static void		clearCache();
+
+  protected:
+	ShapeMesh( const Path2d *contours, size_t numContours, float approximationScale, Triangulator::Winding winding );
+
+	static ShapeMeshRef	findCached( const Path2d *contours, size_t numContours, float approximationScale, Triangulator::Winding winding );
+
+	std::vector<Path2d>		mContours;
+	float					mApproximationScale;
+	Triangulator::Winding	mWinding;
+
+	mutable bool			mSolidBuilt, mOutlineBuilt;
+	mutable VboMeshRef		mSolidVboMesh, mOutlineVboMesh;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,111 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Exception.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/Fbo.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <string>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class SharedTextureSender>		SharedTextureSenderRef;
+typedef std::shared_ptr<class SharedTextureReceiver>	SharedTextureReceiverRef;
+
+/** \brief Publishes frames under a name for SharedTextureReceivers in other processes, without the frames leaving the GPU.
+	The shared texture is an IOSurface on OS X. On Windows it is a Direct3D 11 texture created with a shared handle, which OpenGL renders into through
+	\c WGL_NV_DX_interop, so Direct3D applications can open it as well. The sender advertises the texture in a small block of named shared memory, and
+	receivers alias the same memory, so publishing a frame costs a single blit. Rows are stored top first, as Direct3D and IOSurface expect.
+	Apps on OS X need to link IOSurface.framework. Not available on iOS or WinRT. **/
+class SharedTextureSender : private boost::noncopyable {
+  public:
+	//! Creates a sender named \a name with a shared texture of \a width x \a height pixels. Requires a current OpenGL context. Throws SharedTextureExc on failure.
+	static SharedTextureSenderRef	create( const std::string &name, int width, int height )	{ return SharedTextureSenderRef( new SharedTextureSender( name, width, height ) ); }
+	~SharedTextureSender();
+
+	//! Copies \a texture into the shared texture, scaling it if the sizes differ, and announces a new frame to receivers. The frame appears as gl::draw() would draw \a texture, so one that isFlipped() is flipped back on the way.
+	void	publish( const Texture &texture );
+	//! Copies the color attachment of \a fbo into the shared texture, resolving it first if it is multisampled. See publish( const Texture& ) regarding orientation.
+	void	publish( Fbo fbo )					{ publish( fbo.getTexture() ); }
+
+	//! Replaces the shared texture with one of \a width x \a height pixels. Receivers pick up the new texture with their next checkNewFrame().
+	void	setSize( int width, int height );
+	int		getWidth() const;
+	int		getHeight() const;
+	Vec2i	getSize() const						{ return Vec2i( getWidth(), getHeight() ); }
+
+	const std::string&	getName() const			{ return mName; }
+	//! Returns the number of frames published so far
+	uint32_t			getFrameNumber() const;
+
+  protected:
+	SharedTextureSender( const std::string &name, int width, int height );
+
+	struct Impl;
+	std::unique_ptr<Impl>	mImpl;
+	std::string				mName;
+};
+
+/** \brief Receives the frames published by a SharedTextureSender of the same name, usually in another process.
+	The sender may start after the receiver, stop, and restart with a different size; the receiver reconnects as needed. **/
+class SharedTextureReceiver : private boost::noncopyable {
+  public:
+	//! Creates a receiver for the sender named \a name. Requires a current OpenGL context.
+	static SharedTextureReceiverRef	create( const std::string &name )	{ return SharedTextureReceiverRef( new SharedTextureReceiver( name ) ); }
+	~SharedTextureReceiver();
+
+	//! Returns whether the sender has published a frame since the last call, (re)connecting to it if needed. Call once per frame before getTexture().
+	bool		checkNewFrame();
+	//! Returns whether a sender is currently publishing under the receiver's name
+	bool		isConnected() const;
+	//! \brief Returns a Texture aliasing the sender's shared texture, or a null Texture while disconnected.
+	//! It is a \c GL_TEXTURE_RECTANGLE_ARB on OS X and a \c GL_TEXTURE_2D on Windows. Its contents change as the sender publishes, and it is replaced when the sender resizes.
+	Texture		getTexture() const;
+
+	const std::string&	getName() const			{ return mName; }
+
+  protected:
+	SharedTextureReceiver( const std::string &name );
+
+	struct Impl;
+	std::unique_ptr<Impl>	mImpl;
+	std::string				mName;
+};
+
+class SharedTextureExc : public Exception {
+  public:
+	SharedTextureExc( const std::string &description ) : mDescription( description ) {}
+	virtual const char* what() const throw() { return mDescription.c_str(); }
+
+  protected:
+	std::string		mDescription;
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,106 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Area.h"
+#include "cinder/Matrix.h"
+
+#include <string>
+
+// forward declarations
+namespace cinder {
+	class CameraStereo;
+} // namespace cinder
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+/** \brief Renders both eyes of a CameraStereo with a single submission of the scene.
+ *
+ * Each draw is issued with twice its instance count. The vertex shader sends even instances to the left eye and odd ones to the right, squeezing each
+ * eye's clip space into its half of the viewport and clipping it at the seam with user clip plane 0, so the scene is traversed and its state set once
+ * rather than once per eye. The two halves are side by side or over and under, left eye in the left or lower half, as the StereoscopicRendering sample
+ * lays them out.
+ *
+ * Between begin() and end() the projection is the identity and the modelview holds only model transforms, which shaders combine with the eye's view
+ * matrix through the functions returned by getGlslFunctions():
+ * \code
+ * #version 120
+ * // getGlslFunctions() inserted here
+ * void main() {
+ *	vec4 eyePosition = ciStereoModelView() * gl_Vertex;
+ *	gl_Position = ciStereoPosition( eyePosition );
+ * }
+ * \endcode
+ * Fixed function and non-instanced drawing between begin() and end() only reaches the eye that happens to match, so draw with draw() and such shaders.
+ * Per-instance VboMesh attributes should be added with a divisor of 2, and ciStereoInstance() gives the instance index as the application counts it.
+ * Requires VboMesh::isInstancingSupported().
+ **/
+class SinglePassStereo {
+  public:
+	enum Layout { SIDE_BY_SIDE, OVER_UNDER };
+
+	SinglePassStereo( Layout layout = SIDE_BY_SIDE ) : mLayout( layout ) {}
+
+	//! Returns whether the driver supports the instancing SinglePassStereo relies on
+	static bool		isSupported() { return VboMesh::isInstancingSupported(); }
+
+	Layout		getLayout() const { return mLayout; }
+	void		setLayout( Layout layout ) { mLayout = layout; }
+
+	//! Records both of \a camera's eyes, sets the viewport to \a viewport, loads identity matrices and enables clip plane 0. \a camera's own stereo state is unaffected.
+	void		begin( const CameraStereo &camera, const Area &viewport );
+	//! Restores the viewport, matrices and clip plane saved by begin()
+	void		end();
+
+	//! Sets the uniforms declared by getGlslFunctions() on \a shader, which should be bound
+	void		setUniforms( GlslProg &shader ) const;
+	//! Draws \a instanceCount instances of \a mesh to both eyes
+	void		draw( const VboMesh &mesh, size_t instanceCount = 1 ) const { drawInstanced( mesh, instanceCount * 2 ); }
+	void		draw( const VboMeshRef &mesh, size_t instanceCount = 1 ) const { drawInstanced( *mesh, instanceCount * 2 ); }
+
+	//! Returns the view matrix of the left eye if \a eye is 0 and of the right eye if it is 1, as recorded by the last begin()
+	const Matrix44f&	getViewMatrix( int eye ) const { return mView[eye]; }
+	//! Returns the projection matrix of the left eye if \a eye is 0 and of the right eye if it is 1, as recorded by the last begin()
+	const Matrix44f&	getProjectionMatrix( int eye ) const { return mProjection[eye]; }
+
+	/** Returns GLSL 1.20 vertex shader source, to be inserted after the \c #version directive, which declares:
+		- <tt>int ciStereoEye()</tt>, 0 for the left eye and 1 for the right
+		- <tt>int ciStereoInstance()</tt>, the instance index with the eyes factored out
+		- <tt>mat4 ciStereoModelView()</tt>, the eye's view matrix times gl_ModelViewMatrix
+		- <tt>vec4 ciStereoPosition( vec4 eyePosition )</tt>, the clip space position of an eye space position in the eye's half of the viewport, which also writes gl_ClipVertex **/
+	static std::string	getGlslFunctions();
+
+  protected:
+	Layout		mLayout;
+	Matrix44f	mView[2], mProjection[2];
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,125 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Exception.h"
+
+#include <vector>
+#include <string>
+#include <boost/noncopyable.hpp>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class SkinnedMesh>	SkinnedMeshRef;
+
+/** \brief A mesh deformed by a skeleton on the GPU.
+ *
+ * Each vertex is influenced by up to four bones, whose indices and weights are the \c boneIndices and \c boneWeights static custom attributes of the
+ * underlying VboMesh. Palettes of skinning matrices, as written by Skeleton::calcSkinningMatrices(), are uploaded with setPalettes() and blended in
+ * the vertex shader. When isTextureBufferSupported() the palettes live in a texture buffer, so drawInstanced() can draw any number of characters
+ * sharing the mesh in a single call, each with its own palette; folding each character's model matrix into its palette leaves nothing else to vary
+ * per instance. Otherwise a single palette of up to MAX_UNIFORM_BONES bones is passed as uniforms.
+ *
+ * Skinning matrices are assumed to have uniform scale, so normals are transformed by the same matrices and then renormalized.
+ **/
+class SkinnedMesh : private boost::noncopyable {
+  public:
+	//! The largest palette supported without texture buffers
+	static const size_t MAX_UNIFORM_BONES = 64;
+
+	/** Creates a SkinnedMesh from \a mesh, where vertex \c i is influenced by the bones in \a boneIndices[i] with the weights in \a boneWeights[i], which
+		should sum to 1. Each palette holds \a numBones matrices. Throws SkinnedMeshExc if the attributes don't match the mesh, or if \a numBones exceeds
+		MAX_UNIFORM_BONES and texture buffers aren't supported. **/
+	static SkinnedMeshRef	create( const TriMesh &mesh, const std::vector<Vec4f> &boneIndices, const std::vector<Vec4f> &boneWeights, size_t numBones )
+		{ return SkinnedMeshRef( new SkinnedMesh( mesh, boneIndices, boneWeights, numBones ) ); }
+	~SkinnedMesh();
+
+	//! Returns whether the driver supports ARB_texture_buffer_object and EXT_gpu_shader4, which palettes are stored with when available
+	static bool		isTextureBufferSupported();
+	//! Returns whether palettes are stored in a texture buffer, as required by drawInstanced()
+	bool			usesTextureBuffer() const { return mPaletteTexture != 0; }
+
+	size_t			getNumBones() const { return mNumBones; }
+	//! Returns the number of palettes last uploaded by setPalettes()
+	size_t			getNumPalettes() const { return mNumPalettes; }
+
+	/** Uploads \a numPalettes consecutive palettes of getNumBones() matrices each from \a matrices. Palette \c i is drawn by instance \c i of drawInstanced().
+		Without a texture buffer only the first palette is kept. **/
+	void			setPalettes( const Matrix44f *matrices, size_t numPalettes = 1 );
+	void			setPalettes( const std::vector<Matrix44f> &matrices ) { setPalettes( &matrices[0], matrices.size() / mNumBones ); }
+
+	//! Sets the texture unit the palette texture buffer is bound to while drawing. Default is \c 8, to stay clear of the units of material textures.
+	void			setPaletteTextureUnit( int unit ) { mPaletteUnit = unit; }
+	int				getPaletteTextureUnit() const { return mPaletteUnit; }
+
+	//! Draws the mesh deformed by \a palette with a built-in shader, tinted by the current color and lit by a light at the eye
+	void			draw( size_t palette = 0 );
+	//! Draws the mesh deformed by \a palette with \a shader, which should be bound and built on getSkinningGlsl()
+	void			draw( GlslProg &shader, size_t palette = 0 );
+	//! Draws one instance of the mesh per palette with the built-in shader. Requires usesTextureBuffer() and VboMesh::isInstancingSupported().
+	void			drawInstanced();
+	//! Draws one instance of the mesh per palette with \a shader, which should be bound and built on getSkinningGlsl()
+	void			drawInstanced( GlslProg &shader );
+
+	/** Returns GLSL which should begin a vertex shader, ahead of anything else including \c #version. It declares the \c boneIndices and \c boneWeights
+		attributes and the functions <tt>vec4 skinPosition( vec4 position )</tt> and <tt>vec3 skinNormal( vec3 normal )</tt>, which transform by the
+		weighted bones of the palette being drawn. **/
+	std::string		getSkinningGlsl() const;
+
+	const VboMeshRef&	getVboMesh() const { return mVboMesh; }
+
+  protected:
+	SkinnedMesh( const TriMesh &mesh, const std::vector<Vec4f> &boneIndices, const std::vector<Vec4f> &boneWeights, size_t numBones );
+
+	void		bindPalette( GlslProg &shader, size_t palette );
+	void		unbindPalette();
+
+	VboMeshRef			mVboMesh;
+	size_t				mNumBones, mNumPalettes;
+	std::vector<Vec4f>	mPaletteRows; // three rows of each affine matrix
+	Vbo					mPaletteBuffer;
+	GLuint				mPaletteTexture;
+	int					mPaletteUnit;
+	GlslProg			mDrawShader;
+};
+
+class SkinnedMeshExc : public Exception {
+  public:
+	SkinnedMeshExc( const std::string &description ) : mDescription( description ) {}
+	virtual ~SkinnedMeshExc() throw() {}
+	virtual const char* what() const throw() { return mDescription.c_str(); }
+
+  protected:
+	std::string	mDescription;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,81 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+
+#include <cstdint>
+
+namespace cinder { namespace gl {
+
+/** \brief Shadows the OpenGL state cinder::gl changes most often, so that binding or enabling what is already current costs no GL call.
+ *
+ * Tracked are the active texture unit, the 2D and rectangle texture bindings of the first units, the array, element array and pixel buffer bindings,
+ * the framebuffer bindings, the current program, \c GL_BLEND, \c GL_DEPTH_TEST, \c GL_CULL_FACE, \c GL_ALPHA_TEST, the blend function and the depth mask.
+ * Anything else is forwarded to GL unchanged. All of cinder::gl routes these calls through the cache.
+ *
+ * The cache is disabled by default, in which case every call is forwarded. While it is enabled, state changed with raw GL calls must be reported with
+ * invalidate(). Only the thread which called enable() is tracked, so ContextWorker threads are unaffected, and the renderers and SharedContext invalidate
+ * the cache whenever they switch contexts. **/
+class StateCache {
+  public:
+	//! Starts tracking on the calling thread, which must have the Renderer's context current. Everything starts out unknown.
+	static void		enable();
+	static void		disable();
+	static bool		isEnabled();
+	//! Forgets all tracked state, so the next call for each forwards to GL. Call after changing tracked state with raw GL calls.
+	static void		invalidate();
+
+	//! \a unit is an enum, as in \c glActiveTexture(), e.g. \c GL_TEXTURE0
+	static void		activeTexture( GLenum unit );
+	//! Binds \a texture to \a target on the active texture unit
+	static void		bindTexture( GLenum target, GLuint texture );
+	//! Binds \a texture to \a target on texture unit \a unit, counted from 0, and leaves \c GL_TEXTURE0 active. Skipped entirely if it is already bound there.
+	static void		bindTexture( GLenum target, GLuint texture, GLuint unit );
+	static void		bindBuffer( GLenum target, GLuint buffer );
+	static void		bindFramebuffer( GLenum target, GLuint framebuffer );
+#if ! defined( CINDER_GLES )
+	static void		useProgram( GLuint program );
+#endif
+	//! Equivalent to \c glEnable() or \c glDisable() of \a cap
+	static void		setCapability( GLenum cap, bool enabled );
+	static void		blendFunc( GLenum srcFactor, GLenum dstFactor );
+	static void		depthMask( GLboolean flag );
+
+	//@{
+	//! Must be called when an object is deleted, since GL reverts its bindings to 0 and may reuse its name
+	static void		textureDeleted( GLuint texture );
+	static void		bufferDeleted( GLuint buffer );
+	static void		framebufferDeleted( GLuint framebuffer );
+	static void		programDeleted( GLuint program );
+	//@}
+
+	//! Returns the number of calls forwarded to GL while enabled since the last resetCounters()
+	static uint32_t	getNumCallsIssued();
+	//! Returns the number of redundant calls skipped since the last resetCounters()
+	static uint32_t	getNumCallsSkipped();
+	static void		resetCounters();
+};
+
+} } // namespace cinder::gl
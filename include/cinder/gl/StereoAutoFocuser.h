@@ -44,6 +44,7 @@ class StereoAutoFocuser {
 		\a cam is the CameraStereo you use to render the scene and which should be auto-focussed.
 		\a area is the area that you want to sample.
 		If your autoFocusSpeed is less than 1.0, repeatedly call this function from your update() method.
+		Depth is read back asynchronously, so each call focuses on the samples taken by the previous call and the first call only starts sampling.
 	*/
 	void					autoFocus( CameraStereo *cam, const Area &area = gl::getViewport() ) { autoFocus( cam, area, GL_NONE ); }
 	/** Attempts to set an ideal convergence and eye separation. 
@@ -85,6 +86,7 @@ class StereoAutoFocuser {
 
 	Fbo						mFboSmall;
 	Fbo						mFboLarge;
+	FboReadback				mPendingReadback;
 	std::vector<GLfloat>	mBuffer; 
 
 	//! keeps track of the nearest depth and pixel
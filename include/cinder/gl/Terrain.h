@@ -0,0 +1,210 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/Vbo.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Camera.h"
+#include "cinder/Channel.h"
+#include "cinder/Exception.h"
+#include "cinder/Frustum.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace cinder {
+
+class TaskPool;
+
+namespace gl {
+
+typedef std::shared_ptr<class Terrain>	TerrainRef;
+
+//! \brief Draws a large heightfield as a quadtree of chunks, each a grid of the same number of quads sampled at a power-of-two stride.
+//!
+//! update() refines the quadtree wherever a chunk's geometric error, projected through the Camera, exceeds Format::getPixelError(), and then
+//! restricts it so that neighboring chunks are at most one level apart. A chunk next to a coarser one skips its odd edge vertices, so the two
+//! share exactly the same edge. Chunk meshes are generated on a TaskPool and uploaded by update(). A region is only refined once all of its
+//! children are resident, so until then the coarser chunk keeps being drawn.
+//!
+//! The heightfield lies in the XZ plane with y up. Sample (x, y) is at <tt>( x * spacing.x, height * heightScale, y * spacing.y )</tt>.
+class Terrain {
+  public:
+	struct Format {
+		Format() : mChunkSize( 64 ), mSpacing( 1, 1 ), mHeightScale( 1 ), mPixelError( 2 ), mMaxChunks( 512 ), mMaxUploadsPerFrame( 8 ), mTaskPool( 0 ) {}
+
+		//! Sets the number of quads along a chunk's edge, which must be a power of two. Defaults to \c 64.
+		Format&		chunkSize( int32_t quads ) { mChunkSize = quads; return *this; }
+		//! Sets the distance between neighboring samples along x and z. Defaults to \c (1, 1).
+		Format&		spacing( const Vec2f &spacing ) { mSpacing = spacing; return *this; }
+		//! Sets the factor heights are multiplied by to become y. Defaults to \c 1.
+		Format&		heightScale( float scale ) { mHeightScale = scale; return *this; }
+		//! Sets the largest projected geometric error, in pixels, before a chunk is refined. Defaults to \c 2.
+		Format&		pixelError( float pixels ) { mPixelError = pixels; return *this; }
+		//! Sets the number of chunk meshes kept resident before the least recently selected ones are released. Defaults to \c 512.
+		Format&		maxChunks( size_t count ) { mMaxChunks = count; return *this; }
+		//! Sets the number of generated chunk meshes update() uploads per call. Defaults to \c 8.
+		Format&		maxUploadsPerFrame( size_t count ) { mMaxUploadsPerFrame = count; return *this; }
+		//! Sets the TaskPool chunk meshes are generated on. TaskPool::get() is used if \c null, the default.
+		Format&		taskPool( TaskPool *taskPool ) { mTaskPool = taskPool; return *this; }
+
+		int32_t		getChunkSize() const { return mChunkSize; }
+		const Vec2f&	getSpacing() const { return mSpacing; }
+		float		getHeightScale() const { return mHeightScale; }
+		float		getPixelError() const { return mPixelError; }
+		size_t		getMaxChunks() const { return mMaxChunks; }
+		size_t		getMaxUploadsPerFrame() const { return mMaxUploadsPerFrame; }
+		TaskPool*	getTaskPool() const { return mTaskPool; }
+
+	  protected:
+		int32_t		mChunkSize;
+		Vec2f		mSpacing;
+		float		mHeightScale;
+		float		mPixelError;
+		size_t		mMaxChunks;
+		size_t		mMaxUploadsPerFrame;
+		TaskPool	*mTaskPool;
+	};
+
+	//! Creates a Terrain from \a heights, which is shared rather than copied. Call on the GL thread, since the chunks' shared index buffer is created here. Throws TerrainExc if the chunk size isn't a power of two or \a heights has fewer than 2 x 2 samples.
+	static TerrainRef	create( const Channel32f &heights, const Format &format = Format() ) { return TerrainRef( new Terrain( heights, format ) ); }
+	//! Creates a Terrain from 16-bit \a heights, which are converted to [0,1] as Channel32f( Channel8u ) would.
+	static TerrainRef	create( const Channel16u &heights, const Format &format = Format() );
+	~Terrain();
+
+	//! Selects the chunks to draw for \a cam and a viewport of \a viewportSize pixels, requests the meshes further refinement needs and uploads finished ones. Call once per frame on the GL thread, before draw().
+	void		update( const Camera &cam, const Vec2i &viewportSize );
+	//! Draws the chunks selected by the last update() that intersect its camera's frustum. The meshes have normals and texture coordinates spanning [0,1] over the whole heightfield.
+	void		draw() const;
+
+	//! Returns the height, in world units, at \a xz on the XZ plane, interpolated between the finest samples
+	float		getHeightAt( const Vec2f &xz ) const;
+	//! Returns the world space bounds of the whole heightfield
+	const AxisAlignedBox3f&	getBounds() const { return mBounds; }
+	//! Returns the number of levels in the quadtree, where level 0 samples every height
+	size_t		getNumLevels() const { return mLevels.size(); }
+
+	const Format&	getFormat() const { return mFormat; }
+	//! Returns the number of chunks selected by the last update(), before frustum culling
+	size_t		getNumSelectedChunks() const { return mSelected.size(); }
+	//! Returns the number of chunks drawn by draw()
+	size_t		getNumVisibleChunks() const { return mVisible.size(); }
+	//! Returns the number of chunk meshes uploaded to the GPU
+	size_t		getNumResidentChunks() const;
+	//! Returns the number of chunk meshes requested but not yet uploaded
+	size_t		getNumPendingChunks() const;
+
+  protected:
+	Terrain( const Channel32f &heights, const Format &format );
+
+	//! A quadtree node's geometric error relative to level 0 and its height range, both in heightfield units
+	struct NodeBounds {
+		float	mError, mMinHeight, mMaxHeight;
+	};
+
+	struct Level {
+		int32_t					mNumNodesX, mNumNodesY;
+		std::vector<NodeBounds>	mNodes;
+	};
+
+	//! The immutable heightfield, shared with the tasks generating chunk meshes so that they may outlive the Terrain
+	struct Source {
+		Channel32f		mHeights;
+		int32_t			mChunkSize;
+		Vec2f			mSpacing;
+		float			mHeightScale;
+	};
+
+	//! The vertices of a chunk, written by the task generating them. Holds no GL objects, so the task may release it last.
+	struct ChunkData {
+		ChunkData() : mGenerated( false ), mCanceled( false ) {}
+
+		std::atomic<bool>	mGenerated, mCanceled;
+		std::vector<Vec3f>	mPositions, mNormals;
+		std::vector<Vec2f>	mTexCoords;
+	};
+
+	struct Chunk {
+		Chunk() : mLastUsedFrame( 0 ) {}
+
+		std::shared_ptr<ChunkData>	mData;	// while pending
+		VboMeshRef					mMesh;	// once resident
+		uint32_t					mLastUsedFrame;
+	};
+
+	struct Selection {
+		int32_t		mLevel, mX, mY;
+		uint8_t		mStitchMask;
+		VboMeshRef	mMesh;
+	};
+
+	typedef std::unordered_set<uint64_t>	LeafSet;
+
+	static uint64_t	makeKey( int32_t level, int32_t x, int32_t y ) { return ( (uint64_t)level << 56 ) | ( (uint64_t)y << 28 ) | (uint64_t)x; }
+	static void		generateChunk( const Source &source, int32_t level, int32_t x, int32_t y, ChunkData *data );
+
+	void				initLevels();
+	void				initIndices();
+	AxisAlignedBox3f	getNodeBounds( int32_t level, int32_t x, int32_t y ) const;
+	float				getProjectedError( int32_t level, int32_t x, int32_t y, const Camera &cam, const Vec2i &viewportSize ) const;
+	//! Marks the node's chunk as used this frame and returns its mesh if it is resident. Otherwise requests it and returns null.
+	VboMeshRef			useChunk( int32_t level, int32_t x, int32_t y );
+	//! Uses the chunks of all of the node's children, returning whether they are all resident
+	bool				useChildren( int32_t level, int32_t x, int32_t y );
+	void				selectNode( int32_t level, int32_t x, int32_t y, const Camera &cam, const Vec2i &viewportSize, LeafSet *leaves );
+	void				restrictSelection( LeafSet *leaves );
+	//! Returns the level of the leaf covering level 0 node (\a x, \a y), or -1 if there is none
+	int32_t				findLeafLevel( const LeafSet &leaves, int32_t x, int32_t y ) const;
+	void				uploadChunks();
+	void				releaseChunks();
+
+	std::shared_ptr<const Source>			mSource;
+	Format									mFormat;
+	TaskPool								*mTaskPool;
+	std::vector<Level>						mLevels;
+	AxisAlignedBox3f						mBounds;
+
+	std::unordered_map<uint64_t, Chunk>		mChunks;
+	uint32_t								mFrame;
+	Vbo										mIndexBuffer;	// all 16 stitching variants, one after another
+	size_t									mNumIndices;
+	size_t									mIndexStart[16], mIndexCount[16];
+
+	std::vector<Selection>					mSelected;
+	std::vector<Selection>					mVisible;
+};
+
+class TerrainExc : public Exception {
+  public:
+	TerrainExc( const std::string &message ) : mMessage( message ) {}
+	virtual ~TerrainExc() throw() {}
+	virtual const char* what() const throw() { return mMessage.c_str(); }
+
+  protected:
+	std::string		mMessage;
+};
+
+} } // namespace cinder::gl
@@ -25,8 +25,12 @@
 #include "cinder/Cinder.h"
 #include "cinder/gl/gl.h"
 #include "cinder/Surface.h"
+#include "cinder/ImageIo.h"
+#include "cinder/MemoryStats.h"
 #include "cinder/Rect.h"
 #include "cinder/Stream.h"
+#include "cinder/DataSource.h"
+#include "cinder/ip/BlockCompress.h"
 
 #include <vector>
 #include <utility>
@@ -51,12 +55,20 @@ class Texture {
 	static TextureRef create( const Surface8u &surface, Format format = Format() ) { return std::make_shared<Texture>( surface, format ); }
 	//! Constructs a Texture based on the contents of \a surface
 	static TextureRef create( const Surface32f &surface, Format format = Format() ) { return std::make_shared<Texture>( surface, format ); }
+	//! Constructs a Texture based on the contents of \a surface, uploaded as 16-bit data.
+	static TextureRef create( const Surface16u &surface, Format format = Format() ) { return std::make_shared<Texture>( surface, format ); }
 	//! Constructs a Texture based on the contents of \a channel.
 	static TextureRef create( const Channel8u &channel, Format format = Format() ) { return std::make_shared<Texture>( channel, format ); }
 	//! Constructs a Texture based on the contents of \a channel.
 	static TextureRef create( const Channel32f &channel, Format format = Format() ) { return std::make_shared<Texture>( channel, format ); }
+	//! Constructs a Texture based on the contents of \a channel, uploaded as 16-bit data.
+	static TextureRef create( const Channel16u &channel, Format format = Format() ) { return std::make_shared<Texture>( channel, format ); }
 	//! Constructs a texture based on \a imageSource
 	static TextureRef create( ImageSourceRef imageSource, Format format = Format() ) { return std::make_shared<Texture>( imageSource, format ); }
+#if ! defined( CINDER_GLES )
+	//! Constructs a Texture from the block compressed levels of \a image
+	static TextureRef create( const ip::BlockCompressedImage &image, Format format = Format() ) { return std::make_shared<Texture>( image, format ); }
+#endif
 	//! Constructs a Texture based on an externally initialized OpenGL texture. \a doNotDispose specifies whether the Texture destructor is responsible for disposing of the associated OpenGL resource.
 	static TextureRef create( GLenum target, GLuint textureId, int width, int height, bool doNotDispose ) { return std::make_shared<Texture>( target, textureId, width, height, doNotDispose ); }
 
@@ -71,12 +83,23 @@ class Texture {
 	Texture( const Surface8u &surface, Format format = Format() );
 	/** \brief Constructs a texture based on the contents of \a surface. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
 	Texture( const Surface32f &surface, Format format = Format() );
+	/** \brief Constructs a texture based on the contents of \a surface, uploaded as \c GL_UNSIGNED_SHORT without conversion. An automatic internal format selects \c GL_RGB16 or \c GL_RGBA16.
+		Integer internal formats such as \c GL_RGBA16UI_EXT are also supported, and are sampled with a \c usampler in GLSL. **/
+	Texture( const Surface16u &surface, Format format = Format() );
 	/** \brief Constructs a texture based on the contents of \a channel. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
 	Texture( const Channel8u &channel, Format format = Format() );
 	/** \brief Constructs a texture based on the contents of \a channel. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
 	Texture( const Channel32f &channel, Format format = Format() );
+	/** \brief Constructs a texture based on the contents of \a channel, uploaded as \c GL_UNSIGNED_SHORT without conversion. An automatic internal format selects \c GL_LUMINANCE16.
+		\c GL_R16 and the integer \c GL_R16UI are also supported, the latter preserving raw values such as depth camera millimeters for a \c usampler in GLSL. **/
+	Texture( const Channel16u &channel, Format format = Format() );
 	/** \brief Constructs a texture based on \a imageSource. A default value of -1 for \a internalFormat chooses an appropriate internal format based on the contents of \a imageSource. **/
 	Texture( ImageSourceRef imageSource, Format format = Format() );
+#if ! defined( CINDER_GLES )
+	/** \brief Constructs a Texture from the block compressed levels of \a image, which are uploaded as-is. Every level of \a image becomes a mip level of the Texture,
+		so \a format's mipmapping setting is ignored. Not available in OpenGL ES. **/
+	Texture( const ip::BlockCompressedImage &image, Format format = Format() );
+#endif
 	//! Constructs a Texture based on an externally initialized OpenGL texture. \a aDoNotDispose specifies whether the Texture is responsible for disposing of the associated OpenGL resource.
 	Texture( GLenum aTarget, GLuint aTextureID, int aWidth, int aHeight, bool aDoNotDispose );
 
@@ -107,6 +130,8 @@ class Texture {
 	void			update( const Surface &surface );
 	//! Replaces the pixels of a texture with contents of \a surface. Expects \a surface's size to match the Texture's.
 	void			update( const Surface32f &surface );
+	//! Replaces the pixels of a texture with the 16-bit contents of \a surface. Expects \a surface's size to match the Texture's.
+	void			update( const Surface16u &surface );
 	/** \brief Replaces the pixels of a texture with contents of \a surface. Expects \a area's size to match the Texture's.
 		\todo Method for updating a subrectangle with an offset into the source **/
 	void			update( const Surface &surface, const Area &area );
@@ -114,6 +139,17 @@ class Texture {
 	void			update( const Channel32f &channel );
 	//! Replaces the pixels of a texture with contents of \a channel. Expects \a area's size to match the Texture's.
 	void			update( const Channel8u &channel, const Area &area );
+	//! Replaces the pixels of a texture with the 16-bit contents of \a channel. Expects \a channel's size to match the Texture's. Suited to per-frame depth camera updates, particularly with Format::enableStreaming().
+	void			update( const Channel16u &channel );
+
+	//! Returns whether update() uploads asynchronously through a ring of pixel buffer objects. \sa Format::enableStreaming()
+	bool			isStreaming() const;
+	/** \brief Maps the next streaming pixel buffer object, sized to \a numBytes, for writing. Returns NULL if the Texture is not streaming.
+		Pixels can be decoded into the result directly, then handed to the Texture with unmapStreamBuffer(). **/
+	void*			mapStreamBuffer( size_t numBytes );
+	/** \brief Unmaps the buffer returned by mapStreamBuffer() and uploads it into \a area of the Texture without waiting for the transfer to complete.
+		The buffer holds pixels in \a dataFormat and \a type with \a rowLength pixels per row, where 0 implies rows of exactly \a area's width. **/
+	void			unmapStreamBuffer( const Area &area, GLenum dataFormat, GLenum type, GLint rowLength = 0 );
 	
 	//! the width of the texture in pixels
 	GLint			getWidth() const;
@@ -164,8 +200,20 @@ class Texture {
 	//!	Unbinds the Texture currently bound in the Texture's target
 	void			unbind( GLuint textureUnit = 0 ) const;
 
-	//!	Creates a new Texture from raw DirectDraw Stream data
+#if ! defined( CINDER_GLES )
+	//!	Creates a new Texture from raw DirectDraw Stream data. Returns a null Texture on failure.
 	static Texture	loadDds( IStreamRef ddsStream, Format format );
+	/** \brief Creates a new Texture from the DDS file in \a dataSource, uploading its mip chain as-is with no decompression. Supports DXT1/3/5, ATI1/ATI2 and DX10-header BC1-BC7 files.
+		Large files loaded through a DataSourcePath are uploaded directly from their memory mapping. Throws TextureDataExc if the file is malformed or its format is unsupported. **/
+	static Texture	loadDds( DataSourceRef dataSource, Format format = Format() );
+	//! Creates a new Texture from the DDS file held in \a buffer. \sa loadDds( DataSourceRef, Format )
+	static Texture	loadDds( const Buffer &buffer, Format format = Format() );
+#endif
+	/** \brief Creates a new Texture from the KTX file in \a dataSource, uploading its mip chain as-is. Compressed formats such as ETC2 and BC7 are passed to the driver without decompression.
+		Throws TextureDataExc if the file is malformed or is not a 2D texture. **/
+	static Texture	loadKtx( DataSourceRef dataSource, Format format = Format() );
+	//! Creates a new Texture from the KTX file held in \a buffer. \sa loadKtx( DataSourceRef, Format )
+	static Texture	loadKtx( const Buffer &buffer, Format format = Format() );
 
 	//! Converts a SurfaceChannelOrder into an appropriate OpenGL dataFormat and type
 	static void		SurfaceChannelOrderToDataFormatAndType( const SurfaceChannelOrder &sco, GLint *dataFormat, GLenum *type );
@@ -173,6 +221,8 @@ class Texture {
 	static bool		dataFormatHasAlpha( GLint dataFormat );
 	//! Returns whether a give OpenGL dataFormat contains color channels
 	static bool		dataFormatHasColor( GLint dataFormat );
+	//! Returns an estimate of the bits per texel that drivers allocate for \a internalFormat, as counted by MemoryStats. Unknown formats are assumed to take 32.
+	static int		getInternalFormatBitsPerTexel( GLint internalFormat );
 
 	//! Creates a clone of this texture which does not have ownership, but points to the same resource
 	Texture			weakClone() const;
@@ -195,6 +245,9 @@ class Texture {
 
 		//! Enables or disables mipmapping. Default is disabled.
 		void	enableMipmapping( bool enableMipmapping = true ) { mMipmapping = enableMipmapping; }
+		/** \brief Routes update() through a ring of \a numBuffers pixel buffer objects so uploads become asynchronous DMA transfers. Default is disabled.
+			Requires \c GL_ARB_pixel_buffer_object and is ignored in OpenGL ES. Pass 0 to disable. **/
+		void	enableStreaming( int numBuffers = 3 ) { mNumStreamBuffers = numBuffers; }
 
 		//! Sets the Texture's internal format. A value of -1 implies selecting the best format for the context. 
 		void	setInternalFormat( GLint internalFormat ) { mInternalFormat = internalFormat; }
@@ -220,6 +273,8 @@ class Texture {
 		GLenum	getTarget() const { return mTarget; }
 		//! Returns whether the texture has mipmapping enabled
 		bool	hasMipmapping() const { return mMipmapping; }
+		//! Returns the number of pixel buffer objects used for streaming updates, 0 when streaming is disabled
+		int		getNumStreamBuffers() const { return mNumStreamBuffers; }
 
 		//! Returns the Texture's internal format. A value of -1 implies automatic selection of the internal format based on the context.
 		GLint	getInternalFormat() const { return mInternalFormat; }
@@ -241,6 +296,7 @@ class Texture {
 		GLenum			mMinFilter, mMagFilter;
 		bool			mMipmapping;
 		GLint			mInternalFormat;
+		int				mNumStreamBuffers;
 		
 		friend class Texture;
 	};
@@ -249,10 +305,19 @@ class Texture {
 	void	init( const unsigned char *data, int unpackRowLength, GLenum dataFormat, GLenum type, const Format &format );	
 	void	init( const float *data, GLint dataFormat, const Format &format );
 	void	init( ImageSourceRef imageSource, const Format &format );	
+	void	initStreaming( const Format &format );
+	//! Uploads \a levels, one (pointer, size) pair per mip level starting at the base level. A \a type of 0 marks data already compressed in the Obj's internal format.
+	void	initMipLevels( const std::vector<std::pair<const uint8_t*,size_t> > &levels, GLenum dataFormat, GLenum type, const Format &format );
+	//! Uploads \a area from \a data, which points at the area's first pixel, through the streaming buffers. Returns \c false if the Texture is not streaming.
+	bool	updateStreamed( const void *data, int32_t rowBytes, size_t pixelBytes, const Area &area, GLenum dataFormat, GLenum type );
+	//! Counts the storage of the texture's \a numLevels mip levels (or a full chain if \a fullMipChain) with MemoryStats
+	void	countMemory( size_t numLevels, bool fullMipChain );
+
+	friend class TextureImageTarget;
 		 	
 	struct Obj {
-		Obj() : mWidth( -1 ), mHeight( -1 ), mCleanWidth( -1 ), mCleanHeight( -1 ), mInternalFormat( -1 ), mTextureID( 0 ), mFlipped( false ), mDeallocatorFunc( 0 ) {}
-		Obj( int aWidth, int aHeight ) : mInternalFormat( -1 ), mWidth( aWidth ), mHeight( aHeight ), mCleanWidth( aWidth ), mCleanHeight( aHeight ), mFlipped( false ), mTextureID( 0 ), mDeallocatorFunc( 0 )  {}
+		Obj() : mWidth( -1 ), mHeight( -1 ), mCleanWidth( -1 ), mCleanHeight( -1 ), mInternalFormat( -1 ), mTextureID( 0 ), mFlipped( false ), mDeallocatorFunc( 0 ), mNumStreamBuffers( 0 ), mStreamBufferIndex( 0 ), mAllocation( "gl::Texture", true ) {}
+		Obj( int aWidth, int aHeight ) : mInternalFormat( -1 ), mWidth( aWidth ), mHeight( aHeight ), mCleanWidth( aWidth ), mCleanHeight( aHeight ), mFlipped( false ), mTextureID( 0 ), mDeallocatorFunc( 0 ), mNumStreamBuffers( 0 ), mStreamBufferIndex( 0 ), mAllocation( "gl::Texture", true )  {}
 		~Obj();
 
 		mutable GLint	mWidth, mHeight, mCleanWidth, mCleanHeight;
@@ -264,6 +329,10 @@ class Texture {
 		bool			mFlipped;	
 		void			(*mDeallocatorFunc)(void *refcon);
 		void			*mDeallocatorRefcon;			
+		int					mNumStreamBuffers;
+		size_t				mStreamBufferIndex;
+		std::vector<GLuint>	mStreamBuffers;
+		MemoryAllocation	mAllocation;
 	};
 	std::shared_ptr<Obj>		mObj;
 
@@ -276,6 +345,40 @@ class Texture {
 	//@}  
 };
 
+typedef std::shared_ptr<class TextureImageTarget>	TextureImageTargetRef;
+
+/** \brief An ImageTarget which decodes an ImageSource straight into the upload memory of a new Texture.
+	When pixel buffer objects are supported the rows returned by getRowPointer() live in a mapped buffer, so the decoder's output is handed to the driver without an intermediate copy.
+	create() and finish() must be called on the thread owning the GL context, but ImageSource::load() into the target may run on any thread in between. **/
+class TextureImageTarget : public ImageTarget {
+  public:
+	//! Creates the Texture and maps storage for the pixels of \a imageSource. Throws ImageIoExceptionIllegalColorModel if the image's color model can't be uploaded.
+	static TextureImageTargetRef	create( const ImageSourceRef &imageSource, const Texture::Format &format = Texture::Format() );
+	//! Releases the mapped storage if finish() was never called, which requires the GL context when a pixel buffer object is in use.
+	~TextureImageTarget();
+
+	virtual bool	hasAlpha() const { return mHasAlpha; }
+	virtual void*	getRowPointer( int32_t row ) { return mData + row * mRowBytes; }
+
+	//! Returns whether the rows are mapped pixel buffer memory rather than a system memory staging buffer
+	bool			isMapped() const { return mBuffer != 0; }
+	//! Uploads the decoded pixels and returns the Texture. Later calls return the same Texture.
+	Texture			finish();
+
+  protected:
+	TextureImageTarget( const ImageSourceRef &imageSource, const Texture::Format &format );
+
+	Texture					mTexture;
+	Texture::Format			mFormat;
+	GLenum					mDataFormat, mType;
+	bool					mHasAlpha;
+	size_t					mRowBytes;
+	uint8_t					*mData;
+	std::vector<uint8_t>	mStaging;
+	GLuint					mBuffer;
+	bool					mFinished;
+};
+
 class TextureCache {
  public:
 	TextureCache() {}
@@ -0,0 +1,129 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/Surface.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class TextureAtlas>	TextureAtlasRef;
+
+/** \brief Packs many small images into one Texture at runtime, so that drawing them doesn't require a Texture bind per image.
+ *
+ * Each Surface passed to insert() is placed with a skyline bottom-left packer and returned as a Region. Drawing Regions with draw() inside a
+ * gl::Batch2d submits consecutive Regions of the same atlas as a single draw call. A Region's space is reclaimed once it is passed to remove()
+ * or once every copy of it has been destroyed, the next time the atlas is repacked. insert() repacks automatically when an image doesn't fit,
+ * and since repacking moves Regions, a Region's area and texture coordinates should be queried each time it is drawn rather than stored.
+ * Mipmapping is best avoided, as lower mip levels blend neighbouring Regions. **/
+class TextureAtlas : private boost::noncopyable {
+  public:
+	//! A rectangle of the atlas holding one inserted image
+	class Region {
+	  public:
+		Region() {}
+
+		//! Returns the area of the atlas Texture covered by the Region, in pixels
+		const Area&		getArea() const { return mObj->mArea; }
+		//! Returns the texture coordinates of the Region in the atlas Texture
+		const Rectf&	getTexCoords() const { return mObj->mTexCoords; }
+		int				getWidth() const { return mObj->mArea.getWidth(); }
+		int				getHeight() const { return mObj->mArea.getHeight(); }
+		Vec2i			getSize() const { return mObj->mArea.getSize(); }
+
+	  private:
+		struct Obj {
+			Area	mArea;
+			Rectf	mTexCoords;
+		};
+
+		Region( const std::shared_ptr<Obj> &obj ) : mObj( obj ) {}
+
+		std::shared_ptr<Obj>	mObj;
+
+		friend class TextureAtlas;
+
+	  public:
+		//@{
+		//! Emulates shared_ptr-like behavior
+		typedef std::shared_ptr<Obj> Region::*unspecified_bool_type;
+		operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &Region::mObj; }
+		void reset() { mObj.reset(); }
+		//@}
+	};
+
+	//! Creates an empty atlas \a width pixels wide and \a height pixels high, which leaves \a padding transparent pixels between Regions
+	static TextureAtlasRef	create( int width, int height, const Texture::Format &format = Texture::Format(), int padding = 1 );
+
+	//! Copies \a surface into the atlas, repacking it if necessary. Returns an empty Region if \a surface doesn't fit even after repacking.
+	Region	insert( const Surface8u &surface );
+	//! Releases \a region, whose space is reclaimed when the atlas is next repacked. \a region must not be drawn afterwards.
+	void	remove( const Region &region );
+	//! Packs all live Regions anew, reclaiming the space of removed and unreferenced Regions, and uploads the result. Keeps the current layout if the live Regions don't fit a fresh packing.
+	bool	repack();
+
+	//! Draws \a region on the XY-plane in the rectangle \a destRect
+	void	draw( const Region &region, const Rectf &destRect ) const { gl::draw( mTexture, region.getArea(), destRect ); }
+	//! Draws \a region on the XY-plane at its own size, with its upper-left corner at \a pos
+	void	draw( const Region &region, const Vec2f &pos ) const { draw( region, Rectf( pos, pos + Vec2f( region.getSize() ) ) ); }
+
+	//! Returns the Texture holding all the Regions
+	const Texture&	getTexture() const { return mTexture; }
+	int				getWidth() const { return mTexture.getWidth(); }
+	int				getHeight() const { return mTexture.getHeight(); }
+	int				getPadding() const { return mPadding; }
+	//! Returns the number of Regions held by the atlas, including unreferenced Regions which haven't been reclaimed by repack() yet
+	size_t			getNumRegions() const;
+	//! Returns the fraction of the atlas's area covered by live Regions, from 0 to 1
+	float			getOccupancy() const;
+
+  private:
+	TextureAtlas( int width, int height, const Texture::Format &format, int padding );
+
+	typedef std::shared_ptr<Region::Obj>	RegionObjRef;
+
+	struct SkylineNode {
+		int		mX, mY, mWidth;
+	};
+
+	//! Places a \a width x \a height rectangle on \a skyline, returning false if it doesn't fit
+	bool	pack( std::vector<SkylineNode> *skyline, int width, int height, Vec2i *result ) const;
+	int		fitSkylineNode( const std::vector<SkylineNode> &skyline, size_t index, int width, int height ) const;
+	void	setRegionArea( Region::Obj *region, const Area &area ) const;
+	void	upload( const Area &area );
+
+	Surface8u							mSurface;
+	Texture								mTexture;
+	int									mPadding;
+	std::vector<SkylineNode>			mSkyline;
+	std::vector<RegionObjRef>			mRegions;
+};
+
+} } // namespace cinder::gl
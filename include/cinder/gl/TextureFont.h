@@ -25,9 +25,16 @@
 #include "cinder/Cinder.h"
 #include "cinder/Text.h"
 #include "cinder/Font.h"
+#include "cinder/FreeTypeFont.h"
 #include "cinder/gl/Texture.h"
+#if ! defined( CINDER_GLES )
+	#include "cinder/gl/Vbo.h"
+	#include "cinder/gl/GlslProg.h"
+#endif
 
 #include <map>
+#include <list>
+#include <set>
 #if defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) || defined( _LIBCPP_VERSION )
 	#include <unordered_map>
 #else
@@ -42,7 +49,7 @@ class TextureFont {
   public:
 	class Format {
 	  public:
-		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false )
+		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false ), mSignedDistanceField( false ), mDistanceFieldSpread( 8 ), mDynamicGlyphs( false ), mMaxTextures( 4 ), mFreeType( false )
 		{}
 		
 		//! Sets the width of the textures created internally for glyphs. Default \c 1024
@@ -63,11 +70,42 @@ class TextureFont {
 		Format&		enableMipmapping( bool enable = true ) { mMipmapping = enable; return *this; }
 		//! Returns whether the TextureFont texture has mipmapping enabled
 		bool		hasMipmapping() const { return mMipmapping; }
+
+		/** Enables storing glyphs as a signed distance field rather than coverage. A single TextureFont then renders crisply at any DrawOptions::scale(), so the Font
+			should be created at a large size (48 - 64pt is typical) and scaled down. Drawing uses a shader, or an alpha test under OpenGL ES. Default is disabled. **/
+		Format&		signedDistanceField( bool enable = true ) { mSignedDistanceField = enable; return *this; }
+		//! Returns whether glyphs are stored as a signed distance field
+		bool		isSignedDistanceField() const { return mSignedDistanceField; }
+		//! Sets the distance in texels over which the distance field ramps from inside to outside a glyph edge. Larger values allow bigger outlines and scales. Default \c 8
+		Format&		distanceFieldSpread( int32_t spread ) { mDistanceFieldSpread = spread; return *this; }
+		//! Returns the distance in texels over which the distance field ramps from inside to outside a glyph edge. Default \c 8
+		int32_t		getDistanceFieldSpread() const { return mDistanceFieldSpread; }
+
+		/** Enables rasterizing glyphs the first time they are drawn rather than all up front, so \a supportedChars can be small or empty. Glyphs are packed into
+			uniform cells, and once getMaxTextures() textures are full the least recently drawn glyphs are evicted. Mipmaps are not updated for cached glyphs. Default is disabled. **/
+		Format&		enableDynamicGlyphs( bool enable = true ) { mDynamicGlyphs = enable; return *this; }
+		//! Returns whether glyphs are rasterized the first time they are drawn
+		bool		hasDynamicGlyphs() const { return mDynamicGlyphs; }
+		//! Sets the maximum number of textures a dynamic TextureFont allocates before evicting its least recently drawn glyphs. \c 0 means unlimited. Default \c 4
+		Format&		maxTextures( int32_t maxTextures ) { mMaxTextures = maxTextures; return *this; }
+		//! Returns the maximum number of textures a dynamic TextureFont allocates before evicting its least recently drawn glyphs. Default \c 4
+		int32_t		getMaxTextures() const { return mMaxTextures; }
+
+		/** Enables rasterizing glyphs with a FreeTypeFont of the Font's file rather than with the platform's text APIs. The glyphs are then rasterized in parallel
+			on the threads of TaskPool::get(), along with their distance fields, and packed more tightly. Requires a Font whose file FreeTypeFont can find. Default is disabled. **/
+		Format&		freeType( bool enable = true ) { mFreeType = enable; return *this; }
+		//! Returns whether glyphs are rasterized with FreeType
+		bool		isFreeType() const { return mFreeType; }
 		
 	  protected:
 		int32_t		mTextureWidth, mTextureHeight;
 		bool		mPremultiply;
 		bool		mMipmapping;
+		bool		mSignedDistanceField;
+		int32_t		mDistanceFieldSpread;
+		bool		mDynamicGlyphs;
+		int32_t		mMaxTextures;
+		bool		mFreeType;
 	};
 
 	struct DrawOptions {
@@ -119,6 +157,76 @@ class TextureFont {
 	//! Draws the glyphs in \a glyphMeasures clipped by \a clip, with \a offset added to each of the glyph offsets with DrawOptions \a options. \a glyphMeasures is a vector of pairs of glyph indices and offsets for the glyph baselines.
 	void	drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options = DrawOptions(), const std::vector<ColorA8u> &colors = std::vector<ColorA8u>() );
 
+#if ! defined( CINDER_GLES )
+	/** \brief Retained set of strings whose glyph quads are laid out once and stored in a VBO per glyph texture.
+		With Format::enableDynamicGlyphs(), glyphs evicted after an entry was laid out will draw incorrectly, so size Format::maxTextures() to hold every glyph a Batch uses.
+		Drawing a Batch issues one draw call per glyph texture regardless of how many strings it holds. Replacing an entry whose glyph count per texture is unchanged only
+		uploads that entry's vertices; otherwise the buffers are rebuilt on the next draw(). If any entry has per-glyph colors, entries without them are drawn white; otherwise the current color is used. **/
+	class Batch {
+	  public:
+		Batch() {}
+		explicit Batch( const TextureFontRef &font );
+
+		//! Appends string \a str at baseline \a baseline and returns its index
+		size_t	addString( const std::string &str, const Vec2f &baseline, const DrawOptions &options = DrawOptions() );
+		//! Appends the glyphs in \a glyphMeasures at baseline \a baseline, as with TextureFont::drawGlyphs(), and returns its index
+		size_t	addGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baseline, const DrawOptions &options = DrawOptions(), const std::vector<ColorA8u> &colors = std::vector<ColorA8u>() );
+		//! Replaces entry \a index with string \a str at baseline \a baseline
+		void	setString( size_t index, const std::string &str, const Vec2f &baseline, const DrawOptions &options = DrawOptions() );
+		//! Replaces entry \a index with the glyphs in \a glyphMeasures at baseline \a baseline
+		void	setGlyphs( size_t index, const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baseline, const DrawOptions &options = DrawOptions(), const std::vector<ColorA8u> &colors = std::vector<ColorA8u>() );
+		//! Removes all entries
+		void	clear();
+		//! Returns the number of entries added to the Batch
+		size_t	getNumEntries() const { return mObj->mEntries.size(); }
+
+		//! Draws every entry, uploading any changes first
+		void	draw();
+
+		const TextureFontRef&	getTextureFont() const { return mObj->mFont; }
+
+	  protected:
+		struct Vertex {
+			Vec2f		mPosition;
+			Vec2f		mTexCoord;
+			ColorA8u	mColor;
+		};
+
+		struct Entry {
+			Entry() : mDirty( true ) {}
+
+			std::vector<std::vector<Vertex> >	mVertices; // per glyph texture
+			std::vector<size_t>					mFirstVertex; // per glyph texture, into the texture's Vbo
+			bool								mDirty;
+		};
+
+		struct Obj {
+			Obj( const TextureFontRef &font ) : mFont( font ), mLayoutDirty( true ), mHasColors( false ), mNumIndexedQuads( 0 ) {}
+
+			TextureFontRef				mFont;
+			std::vector<Entry>			mEntries;
+			std::vector<Vbo>			mVertexVbos; // per glyph texture
+			std::vector<size_t>			mNumVertices; // per glyph texture
+			Vbo							mIndexVbo;
+			bool						mLayoutDirty, mHasColors;
+			size_t						mNumIndexedQuads;
+		};
+
+		void	layoutGlyphs( Entry *entry, const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baseline, const DrawOptions &options, const std::vector<ColorA8u> &colors );
+		void	upload();
+
+		std::shared_ptr<Obj>	mObj;
+
+	  public:
+		//@{
+		//! Emulates shared_ptr-like behavior
+		typedef std::shared_ptr<Obj> Batch::*unspecified_bool_type;
+		operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &Batch::mObj; }
+		void reset() { mObj.reset(); }
+		//@}
+	};
+#endif
+
 	//! Returns the size in pixels necessary to render the string \a str with DrawOptions \a options.
 	Vec2f	measureString( const std::string &str, const DrawOptions &options = DrawOptions() ) const;
 #if defined( CINDER_COCOA )
@@ -143,6 +251,8 @@ class TextureFont {
 	float	getDescent() const { return mFont.getDescent(); }
 	//! Returns whether the TextureFont output premultipled output. Default is \c false.
 	bool	isPremultiplied() const { return mFormat.getPremultiply(); }
+	//! Returns whether the TextureFont stores its glyphs as a signed distance field
+	bool	isSignedDistanceField() const { return mFormat.isSignedDistanceField(); }
 
 	//! Returns the default set of characters for a TextureFont, suitable for most English text, including some common ligatures and accented vowels.
 	//! \c "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890().?!,:;'\"&*=+-/\\@#_[]<>%^llflfiphrids"
@@ -152,10 +262,44 @@ class TextureFont {
 	TextureFont( const Font &font, const std::string &supportedChars, const Format &format );
 
 	struct GlyphInfo {
+		GlyphInfo() : mTextureIndex( 0 ), mCell( -1 ), mLastUsed( 0 ) {}
+
 		uint8_t		mTextureIndex;
 		Area		mTexCoords;
 		Vec2f		mOriginOffset;
+		// only used with Format::enableDynamicGlyphs()
+		int32_t								mCell; // -1 for glyphs with no bitmap
+		uint32_t							mLastUsed;
+		std::list<Font::Glyph>::iterator	mLruPosition;
+	};
+
+	//! Enables the distance field shader (or alpha test under GLES) for the lifetime of the object, if \a font uses a signed distance field
+	struct ScopedDistanceField {
+		ScopedDistanceField( const TextureFont &font );
+		~ScopedDistanceField();
+
+		bool		mEnabled;
+		GLint		mOldProgram;
+		GLboolean	mOldAlphaTest;
+		GLint		mOldAlphaFunc;
+		GLfloat		mOldAlphaRef;
 	};
+
+	//! Returns the padding in texels around each glyph in the atlas
+	int32_t		getGlyphPadding() const { return ( mFormat.isSignedDistanceField() ) ? mFormat.getDistanceFieldSpread() : 0; }
+	//! Replaces the coverage in \a channel with a signed distance field
+	static void	convertToDistanceField( Channel8u *channel, int32_t spread );
+
+	//! Creates mFreeTypeFont and the glyph textures from it, rasterizing \a glyphs in parallel unless glyphs are dynamic
+	void	initFreeType( const std::set<Font::Glyph> &glyphs );
+	void	initDynamicGlyphs( const std::set<Font::Glyph> &glyphs );
+	//! Ensures every glyph in \a glyphMeasures is cached and marks them as recently used. Does nothing unless Format::enableDynamicGlyphs()
+	void	cacheGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures );
+	void	cacheGlyph( Font::Glyph glyph );
+	//! Renders the coverage of \a glyph into \a coverage, inset by \a padding, and sets the cell-relative texcoords and origin offset of \a info. Returns \c false if the glyph has no bitmap
+	bool	rasterizeGlyph( Font::Glyph glyph, int32_t padding, Channel8u *coverage, GlyphInfo *info ) const;
+	//! The FreeType implementation of rasterizeGlyph(), used on every platform once mFreeTypeFont is set
+	bool	rasterizeFreeTypeGlyph( Font::Glyph glyph, int32_t padding, Channel8u *coverage, GlyphInfo *info ) const;
 	
 #if defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) || defined( _LIBCPP_VERSION )
 	std::unordered_map<Font::Glyph, GlyphInfo>		mGlyphMap;
@@ -164,7 +308,17 @@ class TextureFont {
 #endif
 	std::vector<gl::Texture>						mTextures;
 	Font											mFont;
+	FreeTypeFont									mFreeTypeFont;
 	Format											mFormat;
+#if ! defined( CINDER_GLES )
+	GlslProg										mDistanceFieldShader;
+#endif
+	// dynamic glyph cache
+	Vec2i											mCellSize;
+	int32_t											mCellsWide, mCellsTall, mNextCell;
+	std::vector<int32_t>							mFreeCells;
+	std::list<Font::Glyph>							mLru; // most recently used first
+	uint32_t										mUseCount;
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
@@ -0,0 +1,140 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/AsyncImageLoader.h"
+#include "cinder/DataSource.h"
+#include "cinder/gl/Texture.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class StreamedTexture>	StreamedTextureRef;
+typedef std::shared_ptr<class TextureStreamer>	TextureStreamerRef;
+
+//! An image managed by a TextureStreamer, whose resolution follows how large it is drawn. Created with TextureStreamer::add().
+class StreamedTexture : private boost::noncopyable {
+  public:
+	//! Reports that the texture will be drawn \a screenSize pixels large this frame. Call each frame it is visible, before TextureStreamer::update().
+	void			demand( const Vec2f &screenSize );
+
+	//! Returns the most detailed Texture currently resident, which is empty until the thumbnail has loaded. Its size changes as detail is streamed in or evicted, so draw it into a destination rectangle.
+	const Texture&	getTexture() const { return mDetail ? mDetail : mThumbnail; }
+	//! Returns whether the thumbnail has loaded, and getTexture() can be drawn
+	bool			isLoaded() const { return mThumbnail; }
+	//! Returns the size of the full-resolution image, which is zero until the thumbnail has loaded
+	const Vec2i&	getFullSize() const { return mFullSize; }
+	//! Returns the mip level of the resident Texture relative to the full-resolution image, where 0 is full resolution
+	int				getResidentLevel() const { return mDetail ? mDetailLevel : mThumbnailLevel; }
+	//! Returns the mip level which matches the most recently demanded screen size
+	int				getDesiredLevel() const { return mDesiredLevel; }
+	const DataSourceRef&	getDataSource() const { return mDataSource; }
+
+  private:
+	StreamedTexture( const DataSourceRef &dataSource ) : mDataSource( dataSource ), mFullSize( Vec2i::zero() ), mThumbnailLevel( 0 ), mDetailLevel( 0 ),
+		mDesiredLevel( 0 ), mDemanded( false ), mDemandedSize( Vec2f::zero() ), mLastDemandedFrame( 0 ), mPendingLevel( -1 ) {}
+
+	DataSourceRef			mDataSource;
+	Vec2i					mFullSize;
+	Texture					mThumbnail, mDetail;
+	int						mThumbnailLevel, mDetailLevel;
+	int						mDesiredLevel;
+	bool					mDemanded;
+	Vec2f					mDemandedSize;	// largest size demanded since the last TextureStreamer::update()
+	uint32_t				mLastDemandedFrame;
+	AsyncImageRequestRef	mPendingRequest;
+	int						mPendingLevel;
+
+	friend class TextureStreamer;
+};
+
+/** \brief Streams image resolution in and out according to how large each image is drawn, within a budget of texture memory.
+ *
+ * Each image added is first loaded as a small thumbnail, which stays resident so that something can always be drawn. Images which are demanded
+ * larger than their resident resolution have a mip-mapped detail Texture of the matching level streamed in through an AsyncImageLoader, largest
+ * on screen first. When the detail Textures exceed the budget, those demanded least recently are evicted back to their thumbnails. Call update()
+ * once per frame after the visible textures' StreamedTexture::demand(). Decoding and downsampling happen on the loader's threads; only the
+ * upload happens on the main thread.
+ *
+ * Most image formats can only be decoded whole, so every level streamed in decodes the full image from its DataSource again. **/
+class TextureStreamer : public std::enable_shared_from_this<TextureStreamer>, private boost::noncopyable {
+  public:
+	//! Creates a streamer keeping detail Textures within \a budgetBytes, loading through \a loader, or a new AsyncImageLoader if it is null
+	static TextureStreamerRef	create( size_t budgetBytes = 256 * 1024 * 1024, const AsyncImageLoaderRef &loader = AsyncImageLoaderRef(), const Texture::Format &format = Texture::Format() );
+	~TextureStreamer();
+
+	//! Adds the image \a dataSource, whose thumbnail starts loading immediately
+	StreamedTextureRef	add( const DataSourceRef &dataSource );
+	//! Stops managing \a texture, canceling its pending load. Its current Texture remains valid.
+	void				remove( const StreamedTextureRef &texture );
+	//! Evicts detail which is no longer demanded or exceeds the budget, and requests the detail demanded since the previous call. Call once per frame.
+	void				update();
+
+	//! Sets the largest side of the thumbnails loaded first, in pixels. Defaults to 64.
+	void		setThumbnailSize( int thumbnailSize ) { mThumbnailSize = thumbnailSize; }
+	int			getThumbnailSize() const { return mThumbnailSize; }
+	//! Sets the number of bytes detail Textures may occupy
+	void		setBudget( size_t budgetBytes ) { mBudget = budgetBytes; }
+	size_t		getBudget() const { return mBudget; }
+	//! Sets the number of frames detail is kept after its texture was last demanded. Defaults to 30.
+	void		setGracePeriod( uint32_t frames ) { mGracePeriod = frames; }
+	uint32_t	getGracePeriod() const { return mGracePeriod; }
+
+	//! Returns the number of bytes occupied by resident detail Textures, estimated from their size
+	size_t		getResidentBytes() const { return mResidentBytes; }
+	//! Returns the number of bytes occupied by thumbnails, which don't count towards the budget
+	size_t		getThumbnailBytes() const { return mThumbnailBytes; }
+	//! Returns the number of detail levels being loaded
+	size_t		getNumPending() const;
+	size_t		getNumTextures() const { return mTextures.size(); }
+
+	//! Returns the estimated number of bytes of a mip-mapped RGBA Texture of size \a size
+	static size_t	calcTextureBytes( const Vec2i &size ) { return size.x * (size_t)size.y * 4 * 4 / 3; }
+
+  private:
+	TextureStreamer( size_t budgetBytes, const AsyncImageLoaderRef &loader, const Texture::Format &format );
+
+	void	requestLevel( const StreamedTextureRef &texture, int level, int32_t priority );
+	void	levelLoaded( const StreamedTextureRef &texture, bool thumbnail, int level, const Vec2i &fullSize, const AsyncImageRequestRef &request );
+	int		calcDesiredLevel( const StreamedTexture &texture ) const;
+	size_t	calcPendingBytes() const;
+	bool	makeRoom( size_t bytes, const StreamedTexture *exclude );
+	void	evictDetail( StreamedTexture *texture );
+	void	cancelPending( StreamedTexture *texture );
+
+	AsyncImageLoaderRef				mLoader;
+	Texture::Format					mFormat;
+	std::vector<StreamedTextureRef>	mTextures;
+	size_t							mBudget, mResidentBytes, mThumbnailBytes;
+	int								mThumbnailSize;
+	uint32_t						mGracePeriod;
+	uint32_t						mFrame;
+};
+
+} } // namespace cinder::gl
@@ -27,19 +27,70 @@
 #include "cinder/Exception.h"
 #include "cinder/Surface.h"
 #include "cinder/Camera.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Stream.h"
+#include "cinder/TaskPool.h"
+#include "cinder/TiledSurface.h"
+#include "cinder/gl/Fbo.h"
+
+#include <deque>
+#include <functional>
+#include <vector>
 
 namespace cinder { namespace gl {
 
+/** \brief Renders an image larger than the window (or the maximum viewport) one tile at a time.
+ *
+ * By default each tile is drawn into the window and read back synchronously before the next one is drawn. With Format::fbos(), tiles are
+ * instead drawn into a ring of Fbos and read back through pixel buffer objects while the following tiles are drawn. The pixels are then composited
+ * into the output on TaskPool threads, so drawing, readback and compositing overlap. Format::rows(), Format::streamToPpm() and Format::tiledSurface() hand the image over
+ * one row of tiles at a time rather than holding all of it in a Surface, for images too big to keep in memory.
+ * \code
+ * gl::TileRender tr( 30000, 30000, 2048, 2048, gl::TileRender::Format().fbos( 3 ).streamToPpm( getDocumentsDirectory() / "print.ppm" ) );
+ * tr.setMatricesWindow( getWindowSize() );
+ * while( tr.nextTile() )
+ *	drawScene();
+ * \endcode **/
 class TileRender {
   public:
-	TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWidth = 512, int32_t tileHeight = 512 );
+	//! Function receiving a row of tiles of the image, \a rows is the full width of the image and \a top is the y coordinate of its first row
+	typedef std::function<void ( const Surface &rows, int32_t top )>	RowsFn;
+
+	struct Format {
+		Format() : mNumFbos( 0 ) {}
+
+		//! Draws tiles into a ring of \a numFbos Fbos, which must be at least 2 to overlap drawing with readback. Tiles may then be larger than the window. Default is 0, which draws into the window. Not supported on OpenGL ES.
+		Format&		fbos( int numFbos, const Fbo::Format &fboFormat = Fbo::Format() ) { mNumFbos = numFbos; mFboFormat = fboFormat; return *this; }
+		//! Hands the image to \a rowsFn one row of tiles at a time, from top to bottom, instead of composing it into getSurface(). \a rowsFn is called on a TaskPool thread, and the Surface it receives is only valid for the duration of the call. Requires fbos().
+		Format&		rows( const RowsFn &rowsFn ) { mRowsFn = rowsFn; return *this; }
+		//! Streams the image to a binary PPM file at \a path one row of tiles at a time, instead of composing it into getSurface(). Requires fbos().
+		Format&		streamToPpm( const fs::path &path ) { mPpmPath = path; return *this; }
+		//! Composes the image into \a tiledSurface one row of tiles at a time, instead of into getSurface(), for images too big to keep in memory. \a tiledSurface must be at least as large as the image. Requires fbos().
+		Format&		tiledSurface( const TiledSurfaceRef &tiledSurface ) { mRowsFn = [tiledSurface]( const Surface &rows, int32_t top ) { tiledSurface->copyFrom( rows, rows.getBounds(), Vec2i( 0, top ) ); }; return *this; }
+
+		int					getNumFbos() const { return mNumFbos; }
+		const Fbo::Format&	getFboFormat() const { return mFboFormat; }
+		const RowsFn&		getRowsFn() const { return mRowsFn; }
+		const fs::path&		getPpmPath() const { return mPpmPath; }
+
+	  private:
+		int				mNumFbos;
+		Fbo::Format		mFboFormat;
+		RowsFn			mRowsFn;
+		fs::path		mPpmPath;
+	};
+
+	TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWidth = 512, int32_t tileHeight = 512, const Format &format = Format() );
 	
+	//! Prepares the next tile for drawing and returns \c true, or finishes the image and returns \c false once all tiles have been drawn
+
 	bool		nextTile();
 	
 	int32_t		getImageWidth() const { return mImageWidth; }
 	int32_t		getImageHeight() const { return mImageHeight; }
 	float		getImageAspectRatio() const { return mImageWidth / (float)mImageHeight; }
 	Area		getCurrentTileArea() const { return mCurrentArea; }
+	//! Returns the image once nextTile() has returned \c false. Empty when the image is streamed with Format::rows(), Format::streamToPpm() or Format::tiledSurface().
 	Surface		getSurface() const { return mSurface; }
 	
 	void		setMatricesWindow( int32_t windowWidth, int32_t windowHeight );
@@ -54,6 +105,18 @@ class TileRender {
 	
   protected:
 	void		updateFrustum();
+	bool		isPipelined() const { return ! mFbos.empty(); }
+	bool		isStreaming() const { return mFormat.getRowsFn() || ! mFormat.getPpmPath().empty(); }
+	void		calcCurrentArea();
+	bool		nextTilePipelined();
+	void		collectTile();
+	void		flushRows( int32_t tileRow );
+	void		finishPipelined();
+
+	struct PendingTile {
+		FboReadback	mReadback;
+		Area		mArea;
+	};
 
 	int32_t		mImageWidth, mImageHeight;
 	int32_t		mTileWidth, mTileHeight;
@@ -67,6 +130,16 @@ class TileRender {
 	
 	Area		mSavedViewport;
 	Surface		mSurface;
+
+	Format										mFormat;
+	std::vector<Fbo>							mFbos;
+	std::shared_ptr<SaveFramebufferBinding>		mSavedFramebuffer;
+	std::deque<PendingTile>						mPendingTiles;
+	std::vector<TaskRef>						mCompositeTasks;	// composites into mSurface when not streaming
+	Surface										mRows[2];			// rows of tiles being composited and written when streaming, alternately
+	std::vector<TaskRef>						mRowsTasks[2];
+	TaskRef										mWriteTask;
+	OStreamFileRef								mPpmStream;
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
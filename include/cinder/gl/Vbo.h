@@ -24,6 +24,7 @@
 
 #include "cinder/gl/gl.h"
 #include "cinder/TriMesh.h"
+#include "cinder/MemoryStats.h"
 
 #include <vector>
 #include <utility>
@@ -54,6 +55,7 @@ class Vbo {
 
 		GLenum			mTarget;
 		GLuint			mId;
+		MemoryAllocation	mAllocation;
 	};
 	
 	std::shared_ptr<Obj>	mObj;
@@ -77,7 +79,7 @@ class VboMesh {
 	enum { ATTR_MAX_TEXTURE_UNIT = 3 };
 
 	struct Layout {
-		Layout() { initAttributes(); }
+		Layout() : mNumDynamicBuffers( 1 ), mQuantized( false ) { initAttributes(); }
 
 		//! \return is the Layout unspecified, presumably TBG by a constructor for VboMesh
 		bool	isDefaults() const { for( int a = 0; a < ATTR_TOTAL; ++a ) if( mAttributes[a] != NONE ) return false; return true; }
@@ -138,15 +140,43 @@ class VboMesh {
 		void	addDynamicCustomVec2f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT2, 0 ) ); }
 		void	addDynamicCustomVec3f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); }
 		void	addDynamicCustomVec4f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); }
+		//! Adds a static custom attribute, which is filled by bufferCustomStatic() and so requires planar static data
+		void	addStaticCustomFloat() { mCustomStatic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT, 0 ) ); }
+		void	addStaticCustomVec2f() { mCustomStatic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT2, 0 ) ); }
+		void	addStaticCustomVec3f() { mCustomStatic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); }
+		void	addStaticCustomVec4f() { mCustomStatic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); }
+
+		//! Adds a per-instance custom attribute which advances once every \a divisor instances. Instance attributes are stored interleaved in the instance buffer, in the order they are added.
+		void	addInstanceCustomFloat( GLuint divisor = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT, 0 ) ); mCustomInstanceDivisors.push_back( divisor ); }
+		void	addInstanceCustomVec2f( GLuint divisor = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT2, 0 ) ); mCustomInstanceDivisors.push_back( divisor ); }
+		void	addInstanceCustomVec3f( GLuint divisor = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); mCustomInstanceDivisors.push_back( divisor ); }
+		void	addInstanceCustomVec4f( GLuint divisor = 1 ) { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); mCustomInstanceDivisors.push_back( divisor ); }
+		//! Adds a per-instance Matrix44f as four consecutive Vec4f columns, which should be bound to four consecutive attribute locations
+		void	addInstanceCustomMatrix44f( GLuint divisor = 1 ) { for( int c = 0; c < 4; ++c ) addInstanceCustomVec4f( divisor ); }
+		bool	hasInstanceAttributes() const { return ! mCustomInstance.empty(); }
+
+		/** Allocates \a numBuffers dynamic buffers which mapVertexBuffer() cycles through, so that writing this frame's vertices never waits on the GPU reading an earlier frame's.
+			Every vertex must be rewritten on each map. Default is \c 1, which orphans the single dynamic buffer instead. **/
+		void	setNumDynamicBuffers( int numBuffers ) { mNumDynamicBuffers = std::max( numBuffers, 1 ); }
+		int		getNumDynamicBuffers() const { return mNumDynamicBuffers; }
+
+		/** Stores static attributes in compact formats: positions as 16-bit integers within the mesh's bounds, normals as normalized bytes, colors as unsigned bytes
+			and 2d texCoords as half floats when GL_ARB_half_float_vertex is available. Indices are 16-bit when the mesh has no more than 65536 vertices.
+			Vertex data is only quantized by the TriMesh constructors; dynamic and custom attributes are always stored as floats. **/
+		void	setQuantized( bool quantized = true ) { mQuantized = quantized; }
+		bool	isQuantized() const { return mQuantized; }
 
 		int												mAttributes[ATTR_TOTAL];
-		std::vector<std::pair<CustomAttr,size_t> >		mCustomDynamic, mCustomStatic; // pair of <types,offset>
+		std::vector<std::pair<CustomAttr,size_t> >		mCustomDynamic, mCustomStatic, mCustomInstance; // pair of <types,offset>
+		std::vector<GLuint>								mCustomInstanceDivisors;
+		int												mNumDynamicBuffers;
+		bool											mQuantized;
 		
 	 private:
 		void initAttributes() { for( int a = 0; a < ATTR_TOTAL; ++a ) mAttributes[a] = NONE; }
 	};
 
-	enum			{ INDEX_BUFFER = 0, STATIC_BUFFER, DYNAMIC_BUFFER, TOTAL_BUFFERS };
+	enum			{ INDEX_BUFFER = 0, STATIC_BUFFER, DYNAMIC_BUFFER, INSTANCE_BUFFER, TOTAL_BUFFERS };
 	
   protected:
 	struct Obj {
@@ -158,10 +188,19 @@ class VboMesh {
 		size_t			mColorRGBOffset, mColorRGBAOffset;		
 		size_t			mTexCoordOffset[ATTR_MAX_TEXTURE_UNIT+1];
 		size_t			mStaticStride, mDynamicStride;	
+		size_t			mInstanceStride, mNumInstances;
 		GLenum			mPrimitiveType;
 		Layout			mLayout;
 		std::vector<GLint>		mCustomStaticLocations;
 		std::vector<GLint>		mCustomDynamicLocations;
+		std::vector<GLint>		mCustomInstanceLocations;
+		std::vector<Vbo>		mDynamicBuffers; // round-robin set when Layout::getNumDynamicBuffers() > 1; mBuffers[DYNAMIC_BUFFER] is the current one
+		size_t					mDynamicBufferIndex;
+		GLenum					mIndexType;
+		bool					mQuantizedStatic; // static positions, normals and colors are stored in compact integer formats
+		GLenum					mStaticTexCoordType;
+		Vec3f					mPositionTranslate;
+		float					mPositionScale;
 	};
 
   public:
@@ -184,7 +223,22 @@ class VboMesh {
 
 	size_t	getNumIndices() const { return mObj->mNumIndices; }
 	size_t	getNumVertices() const { return mObj->mNumVertices; }
+	//! Returns the number of instances last supplied to bufferInstanceData()
+	size_t	getNumInstances() const { return mObj->mNumInstances; }
+	//! Returns the size in bytes of one instance's interleaved attributes
+	size_t	getInstanceStride() const { return mObj->mInstanceStride; }
 	GLenum	getPrimitiveType() const { return mObj->mPrimitiveType; }
+	//! Returns the type of the index buffer's elements, \c GL_UNSIGNED_SHORT for a quantized Layout with no more than 65536 vertices and \c GL_UNSIGNED_INT otherwise
+	GLenum	getIndexType() const { return mObj->mIndexType; }
+	//! Returns the size in bytes of one index
+	size_t	getIndexSize() const { return ( mObj->mIndexType == GL_UNSIGNED_SHORT ) ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+	//! Returns whether static positions are stored as 16-bit integers, which must be transformed by getPositionScale() and getPositionTranslate(). gl::draw() does this on the modelview matrix.
+	bool	hasQuantizedPositions() const { return mObj->mQuantizedStatic && mObj->mLayout.hasStaticPositions(); }
+	//! Returns the uniform scale which maps quantized positions back into object space, applied before getPositionTranslate()
+	float	getPositionScale() const { return mObj->mPositionScale; }
+	//! Returns the object space center of quantized positions
+	const Vec3f&	getPositionTranslate() const { return mObj->mPositionTranslate; }
 	
 	const Layout&	getLayout() const { return mObj->mLayout; }
 
@@ -202,14 +256,25 @@ class VboMesh {
 	void						bufferTexCoords3d( size_t unit, const std::vector<Vec3f> &texCoords );
 	void						bufferColorsRGB( const std::vector<Color> &colors );
 	void						bufferColorsRGBA( const std::vector<ColorA> &colors );
+	//! Replaces static custom attribute \a index with \a data, which holds getNumVertices() values of the attribute's type. Requires planar static data.
+	void						bufferCustomStatic( size_t index, const void *data );
+	/** Replaces the contents of the instance buffer with \a numInstances instances of interleaved attributes, each getInstanceStride() bytes, laid out in the order
+		they were added to the Layout. The previous storage is orphaned so the driver need not wait for draws still using it. **/
+	void						bufferInstanceData( const void *data, size_t numInstances );
+	//! Maps the dynamic buffer for writing. Its previous contents are discarded, so every vertex should be written. Advances to the next buffer when the Layout requests several.
 	class VertexIter			mapVertexBuffer();
 
 	Vbo&				getIndexVbo() const { return mObj->mBuffers[INDEX_BUFFER]; }
 	Vbo&				getStaticVbo() const { return mObj->mBuffers[STATIC_BUFFER]; }
 	Vbo&				getDynamicVbo() const { return mObj->mBuffers[DYNAMIC_BUFFER]; }
+	Vbo&				getInstanceVbo() const { return mObj->mBuffers[INSTANCE_BUFFER]; }
 
 	void				setCustomStaticLocation( size_t internalIndex, GLuint location ) { mObj->mCustomStaticLocations[internalIndex] = location; }
 	void				setCustomDynamicLocation( size_t internalIndex, GLuint location ) { mObj->mCustomDynamicLocations[internalIndex] = location; }
+	void				setCustomInstanceLocation( size_t internalIndex, GLuint location ) { mObj->mCustomInstanceLocations[internalIndex] = location; }
+
+	//! Returns whether the driver supports ARB_draw_instanced and ARB_instanced_arrays, which gl::drawInstanced() requires
+	static bool			isInstancingSupported();
 
 	size_t						getTexCoordOffset( size_t unit ) const { return mObj->mTexCoordOffset[unit]; }
 	void						setTexCoordOffset( size_t unit, size_t aTexCoordOffset ) { mObj->mTexCoordOffset[unit] = aTexCoordOffset; }	
@@ -252,6 +317,10 @@ class VboMesh {
 		void*		getPointer() const { return reinterpret_cast<void*>( mPtr ); }
 		//! \return pointer where the iterator is currently writing positions
 		Vec3f*		getPositionPointer() const { return reinterpret_cast<Vec3f*>( &mPtr[mPositionOffset] ); }		
+		//! \return pointer where the iterator is currently writing 2d texture coordinates for texture unit \a unit
+		Vec2f*		getTexCoord2dPointer( size_t unit ) const { return reinterpret_cast<Vec2f*>( &mPtr[mTexCoordOffset[unit]] ); }
+		//! Advances the iterator by \a count vertices, as after writing them through the pointers above
+		void		advance( size_t count ) { mPtr += mStride * count; }
 
 //		VertexIter( const VertexIter &other ) { set( other ); }	
 //		VertexIter& operator=( const VertexIter &other ) { set( other ); return *this; }
@@ -280,6 +349,8 @@ class VboMesh {
 
  protected:
 	void	initializeBuffers( bool staticDataPlanar );
+	void	bufferIndexData( const uint32_t *indices, size_t count );
+	void	calcPositionQuantization( const Vec3f &boundsMin, const Vec3f &boundsMax );
 
 	std::shared_ptr<Obj>		mObj;
 };
@@ -0,0 +1,71 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/gl/Vbo.h"
+#include "cinder/Camera.h"
+#include "cinder/Sphere.h"
+#include "cinder/TriMesh.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class VboMeshLod>	VboMeshLodRef;
+
+//! A chain of VboMesh levels of detail for one model, ordered fine to coarse. selectLevel() picks the coarsest level whose geometric error, projected to the screen, stays within getPixelError().
+class VboMeshLod {
+  public:
+	//! Creates a VboMeshLod from \a levels ordered fine to coarse. \a errors holds each level's deviation from the finest level in mesh units, as produced by TriMeshSimplifier::createLodChain().
+	static VboMeshLodRef	create( const std::vector<TriMesh> &levels, const std::vector<float> &errors, VboMesh::Layout layout = VboMesh::Layout() ) { return VboMeshLodRef( new VboMeshLod( levels, errors, layout ) ); }
+	//! Creates a VboMeshLod by simplifying \a mesh into up to \a maxLevels levels, each with roughly \a reduction times the triangles of the previous one
+	static VboMeshLodRef	create( const TriMesh &mesh, size_t maxLevels = 6, float reduction = 0.5f, VboMesh::Layout layout = VboMesh::Layout() );
+
+	size_t				getNumLevels() const { return mLevels.size(); }
+	//! Returns the VboMesh of \a level, where 0 is the finest
+	const VboMeshRef&	getLevel( size_t level ) const { return mLevels[level]; }
+	//! Returns the geometric error of \a level in mesh units
+	float				getLevelError( size_t level ) const { return mErrors[level]; }
+	//! Returns the bounding sphere of the finest level, in mesh units
+	const Sphere&		getBoundingSphere() const { return mBoundingSphere; }
+
+	//! Sets the largest projected error, in pixels, that selectLevel() accepts. Defaults to \c 1.
+	void				setPixelError( float pixels ) { mPixelError = pixels; }
+	float				getPixelError() const { return mPixelError; }
+
+	//! Returns the coarsest level whose error, projected through \a cam at the distance of the mesh's bounding sphere, is within getPixelError(). \a modelMatrix places the mesh in world space and \a viewportSize is in pixels.
+	size_t				selectLevel( const Camera &cam, const Vec2i &viewportSize, const Matrix44f &modelMatrix = Matrix44f() ) const;
+	//! Draws the level returned by selectLevel(). \a modelMatrix is only used for the selection and is not applied to the current GL matrices.
+	void				draw( const Camera &cam, const Vec2i &viewportSize, const Matrix44f &modelMatrix = Matrix44f() ) const;
+
+  protected:
+	VboMeshLod( const std::vector<TriMesh> &levels, const std::vector<float> &errors, VboMesh::Layout layout );
+
+	std::vector<VboMeshRef>		mLevels;
+	std::vector<float>			mErrors;
+	Sphere						mBoundingSphere;
+	float						mPixelError;
+};
+
+} } // namespace cinder::gl
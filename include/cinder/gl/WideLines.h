@@ -0,0 +1,96 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/Stroke.h"
+
+#include <vector>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+//! Writes the triangles of \a polyLine's \a stroke through \a vertexIter, as positions and 2d texture coordinates of \a texCoordUnit unless it is negative, and advances it past them. Returns the number of vertices written, which \a vertexIter must have room for as given by Stroke::calcNumVertices().
+size_t		generateStroke( const Stroke &stroke, const PolyLine2f &polyLine, VboMesh::VertexIter *vertexIter, int texCoordUnit = 0 );
+//! Returns a VboMesh of GL_TRIANGLES holding \a polyLine's \a stroke, with dynamic positions and 2d texture coordinates so it can be refilled with generateStroke() when the line moves.
+VboMeshRef	createStrokeMesh( const Stroke &stroke, const PolyLine2f &polyLine );
+
+typedef std::shared_ptr<class WideLines>	WideLinesRef;
+
+/** \brief Draws large numbers of wide line segments, expanding each on the GPU.
+ *
+ * Each segment is one instance of a single quad, which the vertex shader stretches over the segment and the fragment shader trims to a capsule. Segments
+ * which share an endpoint therefore meet in a round join without any knowledge of their neighbors, and only 36 bytes per segment are uploaded when lines
+ * animate, rather than a triangulated stroke. Joins and caps are always round; use Stroke for miters, bevels and butt or square caps. When blending is
+ * enabled the edges are antialiased over a pixel, and translucent segments overlap where they join. Widths are in the same units as the endpoints, which
+ * are transformed by the current modelview and projection matrices.
+ *
+ * The GLSL program is compiled the first time a WideLines is created and shared from then on, by the GL context which is current at the time and its share
+ * group. Requires VboMesh::isInstancingSupported().
+ **/
+class WideLines {
+  public:
+	//! A single segment, laid out as its instance attributes are
+	struct Segment {
+		Segment() {}
+		Segment( const Vec2f &a, const Vec2f &b, float width, const ColorA &color ) : mA( a ), mB( b ), mColor( color ), mWidth( width ) {}
+
+		Vec2f		mA, mB;
+		ColorA		mColor;
+		float		mWidth;
+	};
+
+	//! Creates a WideLines with room for \a reserveSegments segments before it reallocates
+	static WideLinesRef		create( size_t reserveSegments = 0 ) { return WideLinesRef( new WideLines( reserveSegments ) ); }
+
+	//! Removes all segments
+	void		clear() { mSegments.clear(); mDirty = true; }
+	//! Adds a segment from \a a to \a b
+	void		addSegment( const Vec2f &a, const Vec2f &b, float width, const ColorA &color ) { mSegments.push_back( Segment( a, b, width, color ) ); mDirty = true; }
+	//! Adds a segment between each pair of consecutive points of \a polyLine, closing it if it is closed
+	void		addPolyLine( const PolyLine2f &polyLine, float width, const ColorA &color );
+
+	size_t		getNumSegments() const { return mSegments.size(); }
+	const std::vector<Segment>&	getSegments() const { return mSegments; }
+	//! Returns the segments for modification in place, which are uploaded again by the next draw()
+	std::vector<Segment>&		getSegments() { mDirty = true; return mSegments; }
+
+	//! Uploads the segments if they have changed and draws them all with a single instanced draw call
+	void		draw();
+
+  protected:
+	WideLines( size_t reserveSegments );
+
+	std::vector<Segment>	mSegments;
+	bool					mDirty;
+	VboMeshRef				mQuad;
+	GlslProg				mShader;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -42,6 +42,7 @@
 #include "cinder/Rect.h"
 #include "cinder/Font.h"
 #include "cinder/PolyLine.h"
+#include "cinder/Stroke.h"
 #include "cinder/AxisAlignedBox.h"
 
 #if defined( CINDER_MSW )
@@ -149,39 +150,43 @@ void rotate( const Quatf &quat );
 inline void rotate( float degrees ) { rotate( Vec3f( 0, 0, degrees ) ); }
 
 #if ! defined( CINDER_GLES )
-//! Equivalent to glBegin() in immediate mode
-inline void begin( GLenum mode ) { glBegin( mode ); }
+//! Equivalent to glBegin() in immediate mode. While a RecordedDraw is recording the primitive is captured instead of drawn.
+void begin( GLenum mode );
 //! Equivalent to glEnd() in immediate mode
-inline void end() { glEnd(); }
+void end();
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( const Vec2f &v ) { glVertex2fv( &v.x ); }
+void vertex( float x, float y, float z );
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( float x, float y ) { glVertex2f( x, y ); }
+inline void vertex( const Vec2f &v ) { vertex( v.x, v.y, 0 ); }
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( const Vec3f &v ) { glVertex3fv( &v.x ); }
+inline void vertex( float x, float y ) { vertex( x, y, 0 ); }
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( float x, float y, float z ) { glVertex3f( x, y, z ); }
+inline void vertex( const Vec3f &v ) { vertex( v.x, v.y, v.z ); }
 //! Used between calls to gl::begin() and gl::end(), sets the 2D texture coordinate for the next vertex.
-inline void texCoord( float x, float y ) { glTexCoord2f( x, y ); }
+void texCoord( float x, float y );
 //! Used between calls to gl::begin() and gl::end(), sets the 2D texture coordinate for the next vertex.
-inline void texCoord( const Vec2f &v ) { glTexCoord2f( v.x, v.y ); }
-//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex.
-inline void texCoord( float x, float y, float z ) { glTexCoord3f( x, y, z ); }
-//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex.
-inline void texCoord( const Vec3f &v ) { glTexCoord3f( v.x, v.y, v.z ); }
+inline void texCoord( const Vec2f &v ) { texCoord( v.x, v.y ); }
+//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex. A RecordedDraw keeps only \a x and \a y.
+void texCoord( float x, float y, float z );
+//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex. A RecordedDraw keeps only \a x and \a y.
+inline void texCoord( const Vec3f &v ) { texCoord( v.x, v.y, v.z ); }
+//! Sets the current normal, used by the vertices which follow
+void normal( float x, float y, float z );
+//! Sets the current normal, used by the vertices which follow
+inline void normal( const Vec3f &n ) { normal( n.x, n.y, n.z ); }
 #endif // ! defined( CINDER_GLES )
-//! Sets the current color and the alpha value to 1.0
-inline void color( float r, float g, float b ) { glColor4f( r, g, b, 1.0f ); }
 //! Sets the current color and alpha value
-inline void color( float r, float g, float b, float a ) { glColor4f( r, g, b, a ); }
+void color( float r, float g, float b, float a );
+//! Sets the current color and the alpha value to 1.0
+inline void color( float r, float g, float b ) { color( r, g, b, 1.0f ); }
 //! Sets the current color, and the alpha value to 1.0
-inline void color( const Color8u &c ) { glColor4ub( c.r, c.g, c.b, 255 ); }
+inline void color( const Color8u &c ) { color( c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, 1.0f ); }
 //! Sets the current color and alpha value
-inline void color( const ColorA8u &c ) { glColor4ub( c.r, c.g, c.b, c.a ); }
+inline void color( const ColorA8u &c ) { color( c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f ); }
 //! Sets the current color, and the alpha value to 1.0
-inline void color( const Color &c ) { glColor4f( c.r, c.g, c.b, 1.0f ); }
+inline void color( const Color &c ) { color( c.r, c.g, c.b, 1.0f ); }
 //! Sets the current color and alpha value
-inline void color( const ColorA &c ) { glColor4f( c.r, c.g, c.b, c.a ); }
+inline void color( const ColorA &c ) { color( c.r, c.g, c.b, c.a ); }
 
 //! Enables the OpenGL State \a state. Equivalent to calling to glEnable( state );
 inline void enable( GLenum state ) { glEnable( state ); }
@@ -273,14 +278,16 @@ void drawCylinder( float baseRadius, float topRadius, float height, int slices =
 void draw( const class PolyLine<Vec2f> &polyLine );
 //! Draws a 3d PolyLine \a polyLine
 void draw( const class PolyLine<Vec3f> &polyLine );
+//! Draws a 2d PolyLine \a polyLine as a thick line with \a stroke's width, joins and caps, and the texture coordinates of Stroke::generate(). For lines drawn every frame consider a VboMesh filled by gl::generateStroke(), or gl::WideLines.
+void draw( const PolyLine2f &polyLine, const Stroke &stroke );
 //! Draws a Path2d \a path2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc
 void draw( const class Path2d &path2d, float approximationScale = 1.0f );
 //! Draws a Shape2d \a shape2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc
 void draw( const class Shape2d &shape2d, float approximationScale = 1.0f );
 
-//! Draws a solid (filled) Path2d \a path2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. Performance warning: This routine tesselates the polygon into triangles. Consider using Triangulator directly.
+//! Draws a solid (filled) Path2d \a path2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. The tesselation of a Path2d drawn repeatedly is cached; see ShapeMesh.
 void drawSolid( const class Path2d &path2d, float approximationScale = 1.0f );
-//! Draws a solid (filled) Shape2d \a shape2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. Performance warning: This routine tesselates the polygon into triangles. Consider using Triangulator directly.
+//! Draws a solid (filled) Shape2d \a shape2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. The tesselation of a Shape2d drawn repeatedly is cached; see ShapeMesh.
 void drawSolid( const class Shape2d &shape2d, float approximationScale = 1.0f );
 //! Draws a solid (filled) PolyLine2f \a polyLine. Performance warning: This routine tesselates the polygon into triangles. Consider using Triangulator directly.
 void drawSolid( const PolyLine2f &polyLine );
@@ -304,6 +311,10 @@ inline void drawRange( const VboMeshRef &vbo, size_t startIndex, size_t indexCou
 //! Draws a range of elements from a cinder::gl::VboMesh \a vbo.
 void drawArrays( const VboMesh &vbo, GLint first, GLsizei count );
 inline void drawArrays( const VboMeshRef &vbo, GLint first, GLsizei count ) { drawArrays( *vbo, first, count ); }
+/** Draws \a instanceCount instances of cinder::gl::VboMesh \a vbo with a single call, advancing its instance attributes per their divisors.
+	Shaders can also read \c gl_InstanceIDARB. Requires VboMesh::isInstancingSupported(). **/
+void drawInstanced( const VboMesh &vbo, size_t instanceCount );
+inline void drawInstanced( const VboMeshRef &vbo, size_t instanceCount ) { drawInstanced( *vbo, instanceCount ); }
 #endif
 
 //!	Draws a textured quad of size \a scale that is aligned with the vectors \a bbRight and \a bbUp at \a pos, rotated by \a rotationDegrees around the vector orthogonal to \a bbRight and \a bbUp.	
@@ -372,6 +383,76 @@ struct SaveFramebufferBinding {
 	GLint		mOldValue;
 };
 
+/** \brief Scope which batches the 2D drawing helpers into as few draw calls as possible.
+	While a Batch2d exists, drawLine(), drawSolidRect(), drawStrokedRect(), drawSolidCircle(), drawStrokedCircle(), drawSolidEllipse(), drawStrokedEllipse(),
+	drawSolidTriangle(), drawStrokedTriangle() and draw( const Texture& ... ) append to a shared vertex buffer instead of drawing immediately. Each primitive captures the current
+	color and \c MODELVIEW matrix, and consecutive primitives of the same type and texture are submitted together. The buffer is flushed when the outermost Batch2d is destroyed,
+	and before any other cinder::gl draw call, projection, viewport, blending, depth, texture binding or shader change, so drawing order is preserved.
+	Raw OpenGL draw calls or state changes made inside a batch should be preceded by Batch2d::flush(). Batches may be nested. **/
+class Batch2d {
+  public:
+	Batch2d();
+	~Batch2d();
+
+	//! Submits everything accumulated by the active batch. Does nothing when no batch is active.
+	static void		flush();
+	//! Returns whether a batch is currently active
+	static bool		isActive();
+
+  private:
+	Batch2d( const Batch2d & );
+	Batch2d& operator=( const Batch2d & );
+};
+
+class Material;
+
+/** \brief Records drawing into a vertex buffer object for fast replay, as a portable replacement for DisplayList.
+	Between newList() and endList(), primitives drawn with gl::begin(), gl::vertex() and gl::end() and the 2D helpers which Batch2d batches are captured rather than drawn,
+	along with the current color, normal, line width and point size, the texture bound for gl::begin() or drawn by draw( const Texture& ... ), and the
+	\c MODELVIEW matrix relative to the one current at newList(). Every primitive is converted to points, lines or triangles in a single vertex buffer, and
+	draw() replays each run of consecutive primitives which share a mode, texture and width with one glDrawArrays(). Other drawing is not recorded and
+	happens immediately, as do raw glVertex() calls, and only one RecordedDraw may record at a time. Unlike a display list, gl::color() takes effect immediately while recording. **/
+class RecordedDraw {
+  protected:
+	struct Obj;
+
+  public:
+	RecordedDraw() {}
+	//! Creates a RecordedDraw whose vertex buffer is created with \a usage, which should be \c GL_DYNAMIC_DRAW if it will be recorded again often
+	explicit RecordedDraw( GLenum usage /* = GL_STATIC_DRAW */ );
+
+	//! Starts recording, replacing anything recorded previously
+	void	newList();
+	//! Stops recording and uploads the recorded vertices
+	void	endList();
+	//! Returns whether any RecordedDraw is between newList() and endList()
+	static bool		isRecording();
+
+	//! Replays the recording, transformed by the current \c MODELVIEW matrix and getModelMatrix() and lit with the Material if one has been set
+	void	draw() const;
+
+	//! Returns the number of vertices recorded
+	size_t	getNumVertices() const;
+	//! Returns the number of draw calls draw() issues
+	size_t	getNumDrawCalls() const;
+
+	Matrix44f&			getModelMatrix();
+	const Matrix44f&	getModelMatrix() const;
+
+	void			setMaterial( const Material &material );
+	Material&		getMaterial();
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> RecordedDraw::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &RecordedDraw::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+
+  protected:
+	std::shared_ptr<Obj>	mObj;
+};
+
 #if defined( CINDER_MSW )
 //! Initializes the GLee library. This is generally called automatically by the application and is only necessary if you need to use GLee before your app's setup() method is called.
 void initializeGlee();
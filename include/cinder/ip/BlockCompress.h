@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Buffer.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! The block compressed levels of an image, as produced by blockCompress(). Each level holds rows of 4x4 pixel blocks, starting with the top row of the image.
+class BlockCompressedImage {
+  public:
+	//! BC1 (DXT1) stores 8 bytes per block with 1-bit alpha. BC3 (DXT5) stores 16 bytes per block with interpolated alpha.
+	enum Format { BC1, BC3 };
+
+	BlockCompressedImage() : mWidth( 0 ), mHeight( 0 ), mFormat( BC1 ) {}
+	BlockCompressedImage( int32_t width, int32_t height, Format format ) : mWidth( width ), mHeight( height ), mFormat( format ) {}
+
+	int32_t		getWidth() const		{ return mWidth; }
+	int32_t		getHeight() const		{ return mHeight; }
+	Vec2i		getSize() const			{ return Vec2i( mWidth, mHeight ); }
+	Format		getFormat() const		{ return mFormat; }
+	//! Returns the number of bytes in a 4x4 block, 8 for BC1 and 16 for BC3
+	size_t		getBlockBytes() const	{ return ( mFormat == BC1 ) ? 8 : 16; }
+
+	size_t			getNumLevels() const				{ return mLevels.size(); }
+	//! Returns the size of \a level in pixels, which halves with each level down to 1x1
+	Vec2i			getLevelSize( size_t level ) const	{ return Vec2i( std::max( 1, mWidth >> level ), std::max( 1, mHeight >> level ) ); }
+	//! Returns the number of bytes between rows of blocks in \a level
+	size_t			getLevelRowBytes( size_t level ) const	{ return ( ( getLevelSize( level ).x + 3 ) / 4 ) * getBlockBytes(); }
+	const Buffer&	getLevel( size_t level ) const		{ return mLevels[level]; }
+	//! Appends \a level, which must hold the blocks of the next smaller mip level
+	void			appendLevel( const Buffer &level )	{ mLevels.push_back( level ); }
+
+	//! Returns the number of bytes needed to store a (\a width x \a height) image in \a format
+	static size_t	calcLevelBytes( int32_t width, int32_t height, Format format );
+
+  private:
+	int32_t				mWidth, mHeight;
+	Format				mFormat;
+	std::vector<Buffer>	mLevels;
+};
+
+/** \brief Compresses \a surface to \a format on the TaskPool, along with a box filtered mip chain down to 1x1 when \a mipmaps is \c true.
+	Blocks are encoded with a fast bounding box fit using SSE2 or NEON where available. BC1 treats pixels with alpha below 128 as transparent. **/
+BlockCompressedImage blockCompress( const Surface8u &surface, BlockCompressedImage::Format format = BlockCompressedImage::BC1, bool mipmaps = true );
+//! Compresses \a surface to \a format into \a dest, which must hold BlockCompressedImage::calcLevelBytes() bytes
+void blockCompress( const Surface8u &surface, BlockCompressedImage::Format format, uint8_t *dest );
+
+} } // namespace cinder::ip
@@ -0,0 +1,68 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/ip/IntegralImage.h"
+
+namespace cinder { namespace ip {
+
+//! Blurs \a srcArea of \a srcChannel with a box filter of \a radius pixels, storing the result in \a dstChannel at \a dstLT. Pixels outside \a srcArea are treated as repeating its edges.
+/** The cost per pixel is independent of \a radius. The filter is applied separably and multithreaded across rows. \a srcChannel and \a dstChannel can be the same Channel. **/
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, int32_t radius );
+//! Blurs \a srcChannel with a box filter of \a radius pixels, storing the result in \a dstChannel
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius );
+//! Blurs \a srcArea of \a srcSurface with a box filter of \a radius pixels, storing the result in \a dstSurface at \a dstLT. Alpha is blurred when both Surfaces have it.
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, int32_t radius );
+//! Blurs \a srcSurface with a box filter of \a radius pixels, storing the result in \a dstSurface
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius );
+//! Box blurs the image \a integralImage was built from with \a radius pixels, storing the result in \a dstChannel. Near the edges only the pixels inside the image are averaged.
+/** Each pixel costs four table lookups, so the same \a integralImage can be reused for any number of radii. Requires a single channel \a integralImage. **/
+template<typename T, typename SUMT>
+void boxBlur( const IntegralImageT<T,SUMT> &integralImage, ChannelT<T> *dstChannel, int32_t radius );
+//! Box blurs the Surface \a integralImage was built from with \a radius pixels, storing the result in \a dstSurface. Alpha is written when both have it.
+template<typename T, typename SUMT>
+void boxBlur( const IntegralImageT<T,SUMT> &integralImage, SurfaceT<T> *dstSurface, int32_t radius );
+
+//! Blurs \a srcArea of \a srcChannel with a Gaussian of standard deviation \a sigma, storing the result in \a dstChannel at \a dstLT. Pixels outside \a srcArea are treated as repeating its edges.
+/** The Gaussian is approximated by three successive box filters, so the cost per pixel is independent of \a sigma. \a srcChannel and \a dstChannel can be the same Channel. **/
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, float sigma );
+//! Blurs \a srcChannel with a Gaussian of standard deviation \a sigma, storing the result in \a dstChannel
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma );
+//! Blurs \a srcArea of \a srcSurface with a Gaussian of standard deviation \a sigma, storing the result in \a dstSurface at \a dstLT. Alpha is blurred when both Surfaces have it.
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, float sigma );
+//! Blurs \a srcSurface with a Gaussian of standard deviation \a sigma, storing the result in \a dstSurface
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma );
+
+} } // namespace cinder::ip
@@ -0,0 +1,68 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Color.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+//! Conversions performed by convertColorSpace()
+/** All components are normalized, so for Surface8u they span [0,255] rather than [0,1]. Hue is in [0,1), like rgbToHSV(). The full range
+	YCbCr conversions place Cb and Cr around 0.5, as JPEG does, while the \c VIDEO ones map Y to [16,235] and Cb and Cr to [16,240] out of
+	255, as video does. The sRGB conversions apply the sRGB transfer curve to each of red, green and blue. **/
+enum ColorSpaceConversion {
+	RGB_TO_HSV, HSV_TO_RGB,
+	RGB_TO_HSL, HSL_TO_RGB,
+	SRGB_TO_LINEAR, LINEAR_TO_SRGB,
+	RGB_TO_YCBCR_601, YCBCR_601_TO_RGB,
+	RGB_TO_YCBCR_709, YCBCR_709_TO_RGB,
+	RGB_TO_YCBCR_601_VIDEO, YCBCR_601_VIDEO_TO_RGB,
+	RGB_TO_YCBCR_709_VIDEO, YCBCR_709_VIDEO_TO_RGB
+};
+
+//! Converts \a count colors of \a src into \a dst, which may be the same array. Converted colors hold their components in r, g and b, such as hue, saturation and value for \c RGB_TO_HSV.
+void convertColorSpace( const Colorf *src, Colorf *dst, size_t count, ColorSpaceConversion conversion );
+//! Converts the red, green and blue of \a srcSurface into \a dstSurface, which may be the same Surface, converting between 8-bit and float along the way. Alpha is copied, or set to opaque when \a srcSurface has none. Rows are converted in parallel.
+template<typename T, typename Y>
+void convertColorSpace( const SurfaceT<T> &srcSurface, SurfaceT<Y> *dstSurface, ColorSpaceConversion conversion );
+//! Converts the red, green and blue of \a surface in place
+template<typename T>
+void convertColorSpace( SurfaceT<T> *surface, ColorSpaceConversion conversion ) { convertColorSpace( *surface, surface, conversion ); }
+//! Converts the separate planes of a YCbCr image into \a dstSurface using one of the \c YCBCR_*_TO_RGB conversions. \a cb and \a cr may be subsampled, as in 4:2:0 and 4:2:2 video, and are then upsampled with nearest neighbor. Interleaved chroma, as in NV12, can be described by Channels with an increment of 2.
+template<typename T>
+void ycbcrPlanesToRgb( const ChannelT<T> &y, const ChannelT<T> &cb, const ChannelT<T> &cr, SurfaceT<T> *dstSurface, ColorSpaceConversion conversion );
+
+//! Converts \a count sRGB encoded values of \a src to linear ones in \a dst, which may be the same array
+void srgbToLinear( const float *src, float *dst, size_t count );
+//! Converts \a count 8-bit sRGB encoded values of \a src to linear ones in \a dst
+void srgbToLinear( const uint8_t *src, float *dst, size_t count );
+//! Converts \a count linear values of \a src to sRGB encoded ones in \a dst, which may be the same array
+void linearToSrgb( const float *src, float *dst, size_t count );
+//! Converts \a count linear values of \a src to 8-bit sRGB encoded ones in \a dst, clamping them to [0,1]
+void linearToSrgb( const float *src, uint8_t *dst, size_t count );
+
+} } // namespace cinder::ip
@@ -0,0 +1,121 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/Exception.h"
+
+#include <vector>
+#include <functional>
+
+namespace cinder { namespace ip {
+
+//! Determines how convolve() samples pixels which fall outside of the source Area
+enum BorderMode {
+	//! Repeats the nearest edge pixel
+	BORDER_CLAMP,
+	//! Reflects about the edge pixel, so that -1 samples 1
+	BORDER_MIRROR,
+	//! Wraps around to the opposite edge
+	BORDER_WRAP,
+	//! Treats pixels outside of the Area as zero
+	BORDER_ZERO
+};
+
+//! A convolution kernel whose width and height are 1, 3 or 5, applied by convolve()
+/** Each result is <tt>sum( weight * pixel ) * scale + bias</tt>, rounded and clamped to the range of the channel type. Kernels which are the outer product of a row and a column, such as a Gaussian, are applied as two 1D passes. **/
+class ConvolutionKernel {
+  public:
+	//! Constructs a \a width x \a height kernel from the row-major \a weights. A kernel which factors into a row and a column is detected and applied separably.
+	ConvolutionKernel( int32_t width, int32_t height, const float *weights, float scale = 1.0f, float bias = 0.0f );
+	//! Constructs a separable kernel which is the outer product of \a column and \a row
+	ConvolutionKernel( const std::vector<float> &row, const std::vector<float> &column, float scale = 1.0f, float bias = 0.0f );
+
+	//! Returns a normalized \a size x \a size box filter, where \a size is 3 or 5
+	static ConvolutionKernel	box( int32_t size = 3 );
+	//! Returns a normalized \a size x \a size binomial approximation of a Gaussian, where \a size is 3 or 5
+	static ConvolutionKernel	gaussian( int32_t size = 3 );
+	//! Returns a 3x3 kernel which adds \a amount times the 4-neighbor Laplacian to each pixel
+	static ConvolutionKernel	sharpen( float amount = 1.0f );
+	//! Returns the 3x3 4-neighbor Laplacian, whose results are signed
+	static ConvolutionKernel	laplacian();
+	//! Returns the 3x3 Sobel operator for the horizontal gradient, whose results are signed
+	static ConvolutionKernel	sobelX();
+	//! Returns the 3x3 Sobel operator for the vertical gradient, whose results are signed
+	static ConvolutionKernel	sobelY();
+
+	int32_t		getWidth() const { return mWidth; }
+	int32_t		getHeight() const { return mHeight; }
+	//! Returns the weight at column \a x and row \a y, not including the scale
+	float		getWeight( int32_t x, int32_t y ) const { return mWeights[y * mWidth + x]; }
+	float		getScale() const { return mScale; }
+	float		getBias() const { return mBias; }
+
+	//! Returns whether the kernel is applied as a horizontal pass by getRow() followed by a vertical pass by getColumn()
+	bool						isSeparable() const { return ! mRow.empty(); }
+	const std::vector<float>&	getRow() const { return mRow; }
+	const std::vector<float>&	getColumn() const { return mColumn; }
+
+  private:
+	void	findSeparable();
+
+	int32_t				mWidth, mHeight;
+	std::vector<float>	mWeights, mRow, mColumn;
+	float				mScale, mBias;
+};
+
+class ConvolutionKernelExc : public Exception {
+  public:
+	ConvolutionKernelExc( const std::string &description = "" ) : mDescription( description ) {}
+	virtual const char* what() const throw()	{ return mDescription.c_str(); }
+  protected:
+	std::string mDescription;
+};
+
+//! Convolves \a srcArea of \a srcChannel with \a kernel, storing the result in \a dstChannel at \a dstLT. Pixels outside of \a srcArea are sampled according to \a border.
+/** Bands of rows are processed in parallel, using SSE2 or NEON for the arithmetic. \a srcChannel and \a dstChannel can be the same Channel. **/
+template<typename T>
+void convolve( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border = BORDER_CLAMP );
+//! Convolves \a srcChannel with \a kernel, storing the result in \a dstChannel
+template<typename T>
+void convolve( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border = BORDER_CLAMP );
+//! Convolves \a srcArea of \a srcSurface with \a kernel, storing the result in \a dstSurface at \a dstLT. Alpha is convolved when both Surfaces have it.
+template<typename T>
+void convolve( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border = BORDER_CLAMP );
+//! Convolves \a srcSurface with \a kernel, storing the result in \a dstSurface
+template<typename T>
+void convolve( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border = BORDER_CLAMP );
+
+//! Called by convolveRows() with the index of a row relative to the top of the Area, and the unclamped float results of each kernel for that row
+typedef std::function<void ( int32_t row, const float * const *results )>	ConvolveRowFn;
+
+//! Convolves \a srcArea of \a srcChannel with every one of \a kernels in a single pass over the source, passing each row of results to \a rowFn rather than storing them.
+/** Useful for combining several responses per pixel, such as the gradient magnitude of edgeDetectSobel(). \a srcArea is clipped to \a srcChannel, and each result row holds its width.
+	\a rowFn is called from multiple threads, in no particular order of rows. **/
+template<typename T>
+void convolveRows( const ChannelT<T> &srcChannel, const Area &srcArea, const std::vector<ConvolutionKernel> &kernels, const ConvolveRowFn &rowFn, BorderMode border = BORDER_CLAMP );
+
+} } // namespace cinder::ip
@@ -0,0 +1,49 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+#include "cinder/Vector.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! Stores in \a dstChannel the exact Euclidean distance, in pixels, from each pixel to the nearest seed of \a srcChannel, which is any pixel greater than \a threshold.
+/** Implements Felzenszwalb and Huttenlocher's "Distance Transforms of Sampled Functions", which is linear in the number of pixels: one pass finds the nearest seed in each column,
+	and a second takes the lower envelope of the parabolas those define along each row. Both passes are spread across the TaskPool.
+	If \a nearestSeeds is non-null it receives the coordinates of each pixel's nearest seed in row-major order, which is a discrete Voronoi diagram of the seeds.
+	Without any seeds the distances are \c FLT_MAX and the nearest seeds (-1, -1). The intersection of the Channels' bounds is processed. **/
+void distanceTransform( const Channel8u &srcChannel, Channel32f *dstChannel, uint8_t threshold = 127, std::vector<Vec2i> *nearestSeeds = 0 );
+//! Returns the distance from each pixel of \a srcChannel to the nearest pixel greater than \a threshold, as computed by distanceTransform() above
+Channel32f distanceTransform( const Channel8u &srcChannel, uint8_t threshold = 127 );
+
+//! Stores in \a dstChannel the signed distance, in pixels, from each pixel to the outline of the shape formed by the pixels of \a srcChannel greater than \a threshold. Distances are negative inside the shape and positive outside.
+/** The outline is taken to lie halfway between the centers of neighboring inside and outside pixels, so the pixels along it are -0.5 and 0.5. This is the field signed distance field fonts and outline effects sample. **/
+void signedDistanceTransform( const Channel8u &srcChannel, Channel32f *dstChannel, uint8_t threshold = 127 );
+//! Returns the signed distance from each pixel of \a srcChannel to the outline of the pixels greater than \a threshold, as computed by signedDistanceTransform() above
+Channel32f signedDistanceTransform( const Channel8u &srcChannel, uint8_t threshold = 127 );
+
+} } // namespace cinder::ip
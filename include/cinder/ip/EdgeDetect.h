@@ -26,6 +26,7 @@
 
 namespace cinder { namespace ip {
 
+//! Stores the Sobel gradient magnitude of \a srcArea of \a srcChannel in \a dstChannel at \a dstOffset, clamped to the range of \a T. Built on convolveRows(), so rows are processed in parallel. \a srcChannel and \a dstChannel must not overlap.
 template<typename T>
 void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstOffset, ChannelT<T> *dstChannel );
 template<typename T>
@@ -31,7 +31,57 @@ namespace cinder { namespace ip {
 void hdrNormalize( Surface32f *surface );
 /** Normalizes \a channel by scaling the maximum and minimum values to lie in the range \c [0,1] **/
 void hdrNormalize( Channel32f *channel );
-/** Determines the minimum and maximum values of \a channel **/
+/** Determines the minimum and maximum values of \a channel. See Statistics.h for other types, Areas and further statistics. **/
 void getMinMax( const Channel32f &channel, float *resultMin, float *resultMax );
 
+//! Parameters of toneMap(), which maps linear HDR colors to the display range \c [0,1]
+/** Colors are scaled by the exposure, compressed by the operator, clamped and then encoded with the gamma. Use with chained setters:
+	\code ip::toneMap( hdr, &ldr, ip::ToneMap().op( ip::ToneMap::REINHARD_EXTENDED ).whitePoint( 4 ).exposure( 0.5f ) ); \endcode **/
+class ToneMap {
+  public:
+	enum Operator {
+		//! Only scales and clamps
+		LINEAR,
+		//! Scales each color by 1 / (1 + L), where L is its luminance, which preserves hue and brings any luminance below 1
+		REINHARD,
+		//! Reinhard's operator extended so that a luminance of whitePoint() maps to 1
+		REINHARD_EXTENDED,
+		//! Narkowicz's fit of the ACES filmic curve, applied to each channel, which adds contrast and desaturates highlights
+		FILMIC
+	};
+
+	ToneMap() : mOperator( REINHARD ), mExposure( 0 ), mKey( 0 ), mWhitePoint( 1 ), mGamma( 2.2f ) {}
+
+	//! Sets the operator, which defaults to \c REINHARD
+	ToneMap&	op( Operator op ) { mOperator = op; return *this; }
+	//! Sets the exposure adjustment in stops, so that each one doubles the colors before the operator. Defaults to \c 0.
+	ToneMap&	exposure( float stops ) { mExposure = stops; return *this; }
+	//! Scales colors so that the image's log-average luminance maps to \a key before exposure() is applied, as in Reinhard et al.'s automatic exposure. Disabled when \a key is \c 0, the default.
+	ToneMap&	autoExposure( float key = 0.18f ) { mKey = key; return *this; }
+	//! Sets the luminance which \c REINHARD_EXTENDED maps to white. Defaults to \c 1.
+	ToneMap&	whitePoint( float luminance ) { mWhitePoint = luminance; return *this; }
+	//! Sets the gamma the result is encoded with. Defaults to \c 2.2; \c 1 leaves it linear.
+	ToneMap&	gamma( float gamma ) { mGamma = gamma; return *this; }
+
+	Operator	getOperator() const { return mOperator; }
+	float		getExposure() const { return mExposure; }
+	float		getAutoExposureKey() const { return mKey; }
+	float		getWhitePoint() const { return mWhitePoint; }
+	float		getGamma() const { return mGamma; }
+
+  private:
+	Operator	mOperator;
+	float		mExposure, mKey, mWhitePoint, mGamma;
+};
+
+//! Tone maps \a srcSurface into \a dstSurface, converting, quantizing and reordering channels in the same pass. Alpha is copied, or set to opaque when \a srcSurface has none.
+/** Rows are processed in parallel and the operators are vectorized. Pixels outside the intersection of the Surfaces' bounds are left untouched. **/
+void toneMap( const Surface32f &srcSurface, Surface8u *dstSurface, const ToneMap &params = ToneMap() );
+//! Tone maps \a srcSurface into \a dstSurface, which can be the same Surface
+void toneMap( const Surface32f &srcSurface, Surface32f *dstSurface, const ToneMap &params = ToneMap() );
+//! Tone maps \a surface in place
+inline void toneMap( Surface32f *surface, const ToneMap &params = ToneMap() ) { toneMap( *surface, surface, params ); }
+//! Returns the log-average luminance of \a surface, <tt>exp( mean( log( 0.0001 + L ) ) )</tt>, which ToneMap::autoExposure() maps to its key
+float getLogAverageLuminance( const Surface32f &surface );
+
 } } // namespace cinder::ip
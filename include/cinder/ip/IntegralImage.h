@@ -0,0 +1,94 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/ChanTraits.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! Summed-area table of a Channel or of each channel of a Surface, answering the sum of any rectangle with four lookups.
+/** Build it once per frame and query box sums at as many window sizes as needed. \a SUMT is the accumulator type;
+	the default 32-bit accumulator of 8 bit data overflows beyond roughly 16 million pixels, use IntegralImage8u64 for larger images. **/
+template<typename T, typename SUMT = typename CHANTRAIT<T>::Accum>
+class IntegralImageT {
+  private:
+	struct Obj {
+		int32_t							mWidth, mHeight;
+		uint8_t							mNumChannels;
+		std::vector<std::vector<SUMT> >	mData;
+	};
+
+  public:
+	typedef SUMT	SumType;
+
+	IntegralImageT() {}
+	//! Builds the table of \a channel
+	explicit IntegralImageT( const ChannelT<T> &channel );
+	//! Builds a table for each of the red, green and blue channels of \a surface, plus alpha when it has one
+	explicit IntegralImageT( const SurfaceT<T> &surface );
+
+	//! Rebuilds the table from \a channel, reusing the existing storage when the size matches
+	void	update( const ChannelT<T> &channel );
+	//! Rebuilds the tables from \a surface, reusing the existing storage when the size and channel count match
+	void	update( const SurfaceT<T> &surface );
+
+	int32_t	getWidth() const { return mObj->mWidth; }
+	int32_t	getHeight() const { return mObj->mHeight; }
+	Area	getBounds() const { return Area( 0, 0, mObj->mWidth, mObj->mHeight ); }
+	//! Returns the number of tables, which is \c 1 when built from a Channel and \c 3 or \c 4 when built from a Surface (in red, green, blue, alpha order)
+	uint8_t	getNumChannels() const { return mObj->mNumChannels; }
+
+	//! Returns the sum of the source values inside \a area of table \a channel. \a area is clipped to getBounds().
+	SUMT	getSum( const Area &area, uint8_t channel = 0 ) const;
+	//! Returns the sum of the source values in the rectangle [0, \a x) x [0, \a y) of table \a channel. Requires 0 <= \a x <= getWidth(), 0 <= \a y <= getHeight().
+	SUMT	getTableValue( int32_t x, int32_t y, uint8_t channel = 0 ) const { return mObj->mData[channel][y * ( mObj->mWidth + 1 ) + x]; }
+	//! Returns the raw ( getWidth() + 1 ) x ( getHeight() + 1 ) row-major table of \a channel, whose first row and column are zero
+	const SUMT*	getData( uint8_t channel = 0 ) const { return &mObj->mData[channel][0]; }
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> IntegralImageT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &IntegralImageT::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+
+  private:
+	void	allocate( int32_t width, int32_t height, uint8_t numChannels );
+	void	calculate( const ChannelT<T> &channel, uint8_t table );
+
+	std::shared_ptr<Obj>		mObj;
+};
+
+typedef IntegralImageT<uint8_t>				IntegralImage;
+typedef IntegralImageT<uint8_t>				IntegralImage8u;
+typedef IntegralImageT<uint8_t,uint64_t>	IntegralImage8u64;
+typedef IntegralImageT<float>				IntegralImage32f;
+typedef IntegralImageT<float,double>		IntegralImage32f64;
+
+} } // namespace cinder::ip
@@ -0,0 +1,92 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+#include <vector>
+#include <functional>
+
+namespace cinder { namespace ip {
+
+//! Composes per-pixel and per-row ip operations which are applied in a single pass over tiles of rows small enough to stay in cache.
+/** Running grayscale(), threshold() and so on one after another streams the whole image through memory once per operation, often through a full
+	intermediate Surface. A PipelineT only records the operations; apply() reads each tile of the source once, runs every operation on it while it is in
+	cache, and writes it once. Tiles are processed in parallel on the TaskPool. For example:
+	<tt>ip::Pipeline().grayscale().threshold( 128 ).flipVertical().apply( surface, &mask );</tt> **/
+template<typename T>
+class PipelineT {
+  public:
+	//! Called with a view of the tile being processed and the Area of the destination it covers
+	typedef std::function<void ( SurfaceT<T> *tile, const Area &tileArea )>	TileFn;
+
+	PipelineT();
+
+	//! Replaces the red, green and blue channels with their luma, as ip::grayscale()
+	PipelineT&	grayscale();
+	//! Sets the red, green and blue channels to their maximum when above \a value and to zero otherwise, as ip::threshold()
+	PipelineT&	threshold( T value );
+	//! Premultiplies by alpha, as ip::premultiply(). Has no effect without an alpha channel.
+	PipelineT&	premultiply();
+	//! Unpremultiplies by alpha, as ip::unpremultiply(). Has no effect without an alpha channel.
+	PipelineT&	unpremultiply();
+	//! Sets the pixels of the destination inside \a area to \a color, as ip::fill()
+	PipelineT&	fill( const ColorAT<T> &color, const Area &area );
+	//! Sets every pixel to \a color, as ip::fill()
+	PipelineT&	fill( const ColorAT<T> &color );
+	//! Flips the result vertically, as ip::flipVertical(). Regardless of where it is added, the flip happens as source rows are read, so it costs no extra pass except when applied in place.
+	PipelineT&	flipVertical();
+	//! Appends a custom operation, which must only modify \a tile and must not depend on pixels outside of it
+	PipelineT&	custom( const TileFn &fn );
+	//! Sets the approximate size in bytes of the tiles of rows which are processed at once, 256k by default so that a tile stays in the L2 cache
+	PipelineT&	tileBytes( size_t bytes );
+
+	//! Applies the operations to \a srcSurface, storing the result in \a dstSurface, which may have a different channel order
+	void	apply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ) const;
+	//! Applies the operations to \a surface in place
+	void	apply( SurfaceT<T> *surface ) const;
+	//! Applies the operations to \a srcSurface, storing the red channel of the result in \a dstChannel. After grayscale() this is the luma.
+	void	apply( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel ) const;
+
+	//! Returns whether no operations have been added
+	bool	empty() const { return mOps.empty() && ! mFlip; }
+
+  private:
+	// splits \a height rows of \a rowBytes each into tiles of about mTileBytes, calling \a tileFn in parallel with the [first, last) rows of each
+	void	forEachTile( int32_t height, size_t rowBytes, const std::function<void ( int32_t, int32_t )> &tileFn ) const;
+	void	runOps( SurfaceT<T> *tile, const Area &tileArea ) const;
+
+	std::vector<TileFn>		mOps;
+	bool					mFlip;
+	boost::tribool			mPremultiplied;
+	size_t					mTileBytes;
+};
+
+typedef PipelineT<uint8_t>		Pipeline;
+typedef PipelineT<uint8_t>		Pipeline8u;
+typedef PipelineT<float>		Pipeline32f;
+
+} } // namespace cinder::ip
@@ -26,7 +26,11 @@
 #include "cinder/Filter.h"
 #include "cinder/Rect.h"
 
-namespace cinder { namespace ip {
+namespace cinder {
+
+template<typename T> class TiledSurfaceT;
+
+namespace ip {
 
 template<typename T>
 void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter = FilterTriangle() );
@@ -39,5 +43,34 @@ template<typename T>
 SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter = FilterTriangle() );
 template<typename T>
 void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+//! Resizes the continuous rectangle \a srcRect of \a srcSurface into \a dstArea of \a dstSurface. Unlike the Area overloads, the filter may read pixels of \a srcSurface outside of \a srcRect, so resizing adjoining pieces of an image this way matches resizing it whole, as long as each \a srcSurface covers the filter's support around its piece.
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Rectf &srcRect, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+
+//! Resizes \a srcArea of \a srcSurface into \a dstArea of the TiledSurface \a dstSurface, resampling its tiles in parallel. The result matches resize() up to rounding.
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, TiledSurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+//! Resizes \a srcArea of the TiledSurface \a srcSurface into \a dstArea of \a dstSurface in parallel, reading only the source pixels each piece of the destination needs
+template<typename T>
+void resize( const TiledSurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+//! Resizes \a srcArea of the TiledSurface \a srcSurface into \a dstArea of the TiledSurface \a dstSurface, resampling its tiles in parallel
+template<typename T>
+void resize( const TiledSurfaceT<T> &srcSurface, const Area &srcArea, TiledSurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+
+//! Resizes \a srcArea of \a srcSurface into \a dstArea of \a dstSurface, splitting the destination into row bands resampled across \a numThreads threads. A \a numThreads of \c 0 uses System::getNumCores(). The result is identical to resize().
+template<typename T>
+void resizeParallel( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle(), int numThreads = 0 );
+//! Resizes all of \a srcSurface into all of \a dstSurface across \a numThreads threads. A \a numThreads of \c 0 uses System::getNumCores().
+template<typename T>
+void resizeParallel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter = FilterTriangle(), int numThreads = 0 );
+//! Resizes \a srcArea of \a srcChannel into \a dstArea of \a dstChannel across \a numThreads threads. A \a numThreads of \c 0 uses System::getNumCores().
+template<typename T>
+void resizeParallel( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter = FilterTriangle(), int numThreads = 0 );
+//! Resizes all of \a srcChannel into all of \a dstChannel across \a numThreads threads. A \a numThreads of \c 0 uses System::getNumCores().
+template<typename T>
+void resizeParallel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter = FilterTriangle(), int numThreads = 0 );
+//! Returns a new Surface which is a copy of \a srcSurface's area \a srcArea scaled to size \a dstSize, resampled across \a numThreads threads
+template<typename T>
+SurfaceT<T> resizeCopyParallel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter = FilterTriangle(), int numThreads = 0 );
 
 } } // namespace cinder::ip
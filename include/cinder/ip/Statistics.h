@@ -0,0 +1,122 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! The minimum, maximum, mean and standard deviation of the samples of a channel, as computed by getStatistics()
+class ChannelStatistics {
+  public:
+	ChannelStatistics() : mMin( 0 ), mMax( 0 ), mMean( 0 ), mStdDev( 0 ), mCount( 0 ) {}
+	ChannelStatistics( float min, float max, float mean, float stdDev, uint64_t count )
+		: mMin( min ), mMax( max ), mMean( mean ), mStdDev( stdDev ), mCount( count )
+	{}
+
+	float		getMin() const { return mMin; }
+	float		getMax() const { return mMax; }
+	float		getMean() const { return mMean; }
+	//! Returns the population standard deviation
+	float		getStdDev() const { return mStdDev; }
+	float		getVariance() const { return mStdDev * mStdDev; }
+	//! Returns the number of samples, which is zero for an empty Area
+	uint64_t	getCount() const { return mCount; }
+
+  private:
+	float		mMin, mMax, mMean, mStdDev;
+	uint64_t	mCount;
+};
+
+//! Counts of the samples of a channel in equally sized bins spanning a range of values, as computed by getHistogram()
+/** Samples outside of the range are counted in the first or last bin. **/
+class Histogram {
+  public:
+	//! Constructs an empty Histogram with 256 bins spanning [0, 256), which holds one bin per value of an 8-bit channel
+	Histogram();
+	//! Constructs an empty Histogram with \a numBins bins spanning [\a rangeMin, \a rangeMax)
+	Histogram( size_t numBins, float rangeMin, float rangeMax );
+
+	size_t		getNumBins() const { return mCounts.size(); }
+	float		getRangeMin() const { return mRangeMin; }
+	float		getRangeMax() const { return mRangeMax; }
+	float		getBinWidth() const { return ( mRangeMax - mRangeMin ) / mCounts.size(); }
+	//! Returns the smallest value counted in \a bin
+	float		getBinMin( size_t bin ) const { return mRangeMin + bin * getBinWidth(); }
+	//! Returns the bin which counts \a value
+	size_t		getBin( float value ) const;
+
+	uint32_t						getCount( size_t bin ) const { return mCounts[bin]; }
+	const std::vector<uint32_t>&	getCounts() const { return mCounts; }
+	//! Returns the sum of the counts of all bins
+	uint64_t						getTotal() const { return mTotal; }
+
+	//! Returns the value below which \a fraction of the samples lie, interpolated linearly within its bin. \a fraction is clamped to [0, 1].
+	/** Its precision is limited by the bin width, so a Histogram of an 8-bit channel with the default bins returns fractional values which lie within a bin of the exact integer sample. **/
+	float		getPercentile( float fraction ) const;
+	//! Returns the value below which half of the samples lie
+	float		getMedian() const { return getPercentile( 0.5f ); }
+
+	//! Adds \a count samples to \a bin
+	void		add( size_t bin, uint32_t count = 1 ) { mCounts[bin] += count; mTotal += count; }
+	//! Adds the counts of \a rhs, which must have the same number of bins
+	Histogram&	operator+=( const Histogram &rhs );
+	//! Sets the counts of all bins to zero
+	void		clear();
+
+  private:
+	std::vector<uint32_t>	mCounts;
+	float					mRangeMin, mRangeMax;
+	uint64_t				mTotal;
+};
+
+//! Returns the minimum, maximum, mean and standard deviation of the samples of \a channel within \a area
+template<typename T>
+ChannelStatistics getStatistics( const ChannelT<T> &channel, const Area &area );
+//! Returns the minimum, maximum, mean and standard deviation of the samples of \a channel
+template<typename T>
+ChannelStatistics getStatistics( const ChannelT<T> &channel ) { return getStatistics( channel, channel.getBounds() ); }
+//! Calculates the statistics of each color channel of \a surface within \a area in a single pass. \a alpha is ignored when it is NULL or \a surface has no alpha.
+template<typename T>
+void getStatistics( const SurfaceT<T> &surface, const Area &area, ChannelStatistics *red, ChannelStatistics *green, ChannelStatistics *blue, ChannelStatistics *alpha = 0 );
+
+//! Determines the minimum and maximum values of \a channel within \a area, which are left unchanged if \a area is empty
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, const Area &area, T *resultMin, T *resultMax );
+
+//! Returns a Histogram of the samples of \a channel within \a area with \a numBins bins spanning [0, 256) for 8-bit channels and [0, 1] for float channels
+template<typename T>
+Histogram getHistogram( const ChannelT<T> &channel, const Area &area, size_t numBins = 256 );
+//! Replaces the counts of \a result with those of the samples of \a channel within \a area, using \a result's bins
+template<typename T>
+void getHistogram( const ChannelT<T> &channel, const Area &area, Histogram *result );
+//! Replaces the counts of each Histogram with those of the corresponding color channel of \a surface within \a area, in a single pass and using each Histogram's bins. Any of the Histograms can be NULL to skip that channel, and \a alpha is ignored when \a surface has no alpha.
+template<typename T>
+void getHistograms( const SurfaceT<T> &surface, const Area &area, Histogram *red, Histogram *green, Histogram *blue, Histogram *alpha = 0 );
+
+} } // namespace cinder::ip
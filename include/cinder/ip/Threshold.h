@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/IntegralImage.h"
 
 namespace cinder { namespace ip {
 
@@ -55,19 +56,25 @@ void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize );
 template<typename T>
 void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel );
 
+//! Thresholds \a srcChannel like adaptiveThreshold() above, using \a integralImage previously built from \a srcChannel rather than building one per call
+template<typename T, typename SUMT>
+void adaptiveThreshold( const ChannelT<T> &srcChannel, const IntegralImageT<T,SUMT> &integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel );
+//! Thresholds \a srcChannel like adaptiveThresholdZero() above, using \a integralImage previously built from \a srcChannel rather than building one per call
+template<typename T, typename SUMT>
+void adaptiveThresholdZero( const ChannelT<T> &srcChannel, const IntegralImageT<T,SUMT> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel );
+
 template<typename T>
 class AdaptiveThresholdT {
  private:
 	typedef typename CHANTRAIT<T>::Accum SUMT;
 	struct Obj {
 		Obj( ChannelT<T> *channel );
-		~Obj();
 	
-		ChannelT<T>	* mChannel;
-		int32_t		mImageWidth;
-		int32_t		mImageHeight;
-		int8_t		mIncrement;
-		SUMT		* mIntegralImage;
+		ChannelT<T>			* mChannel;
+		int32_t				mImageWidth;
+		int32_t				mImageHeight;
+		int8_t				mIncrement;
+		IntegralImageT<T>	mIntegralImage;
 	};
  public:
 	AdaptiveThresholdT() {};
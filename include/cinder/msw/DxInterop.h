@@ -0,0 +1,62 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+
+#include <windows.h>
+#undef min
+#undef max
+
+// tokens from WGL_NV_DX_interop, which GLee predates
+#if ! defined( WGL_ACCESS_READ_ONLY_NV )
+	#define WGL_ACCESS_READ_ONLY_NV			0x0000
+	#define WGL_ACCESS_READ_WRITE_NV		0x0001
+	#define WGL_ACCESS_WRITE_DISCARD_NV		0x0002
+#endif
+
+namespace cinder { namespace msw {
+
+//! The entry points of \c WGL_NV_DX_interop, which lets OpenGL textures and renderbuffers alias the memory of Direct3D resources.
+struct DxInterop {
+	typedef HANDLE (WINAPI *OpenDeviceFn)( void *dxDevice );
+	typedef BOOL (WINAPI *CloseDeviceFn)( HANDLE device );
+	typedef HANDLE (WINAPI *RegisterObjectFn)( HANDLE device, void *dxObject, GLuint name, GLenum type, GLenum access );
+	typedef BOOL (WINAPI *UnregisterObjectFn)( HANDLE device, HANDLE object );
+	typedef BOOL (WINAPI *LockObjectsFn)( HANDLE device, GLint count, HANDLE *objects );
+	typedef BOOL (WINAPI *UnlockObjectsFn)( HANDLE device, GLint count, HANDLE *objects );
+
+	OpenDeviceFn		openDevice;
+	CloseDeviceFn		closeDevice;
+	RegisterObjectFn	registerObject;
+	UnregisterObjectFn	unregisterObject;
+	LockObjectsFn		lockObjects;
+	UnlockObjectsFn		unlockObjects;
+};
+
+//! Returns the entry points of \c WGL_NV_DX_interop, or \c NULL if the driver doesn't support it. An OpenGL context must be current the first time it is called.
+const DxInterop*	getDxInterop();
+
+} } // namespace cinder::msw
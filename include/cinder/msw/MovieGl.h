@@ -0,0 +1,127 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Exception.h"
+#include "cinder/gl/Texture.h"
+
+namespace cinder { namespace msw {
+
+typedef std::shared_ptr<class MovieGl>	MovieGlRef;
+
+/** \brief Plays a movie through the Media Foundation Media Engine, which decodes on the GPU with DXVA wherever the codec allows.
+	Frames are rendered by Direct3D 11 into a texture that is shared with OpenGL through \c WGL_NV_DX_interop, so they never pass through system memory.
+	Without that extension each frame is read back and uploaded instead. The playback interface mirrors qtime::MovieGl. Requires Windows 8 or later. **/
+class MovieGl {
+  public:
+	MovieGl() {}
+	//! Opens the movie at \a path, waiting until its dimensions and duration are known. Throws MovieGlExc on failure.
+	MovieGl( const fs::path &path );
+
+	static MovieGlRef create( const fs::path &path ) { return MovieGlRef( new MovieGl( path ) ); }
+
+	//! Returns whether the movie has buffered enough to play back without interruption
+	bool		checkPlayable() const;
+
+	//! Returns the width of the movie in pixels
+	int32_t		getWidth() const;
+	//! Returns the height of the movie in pixels
+	int32_t		getHeight() const;
+	//! Returns the size of the movie in pixels
+	Vec2i		getSize() const { return Vec2i( getWidth(), getHeight() ); }
+	//! Returns the movie's aspect ratio, the ratio of its width to its height
+	float		getAspectRatio() const { return getWidth() / (float)getHeight(); }
+	//! the Area defining the Movie's bounds in pixels: [0,0]-[width,height]
+	Area		getBounds() const { return Area( 0, 0, getWidth(), getHeight() ); }
+	//! Returns the movie's length measured in seconds
+	float		getDuration() const;
+
+	//! Returns whether the movie contains a video stream
+	bool		hasVisuals() const;
+	//! Returns whether the movie contains an audio stream
+	bool		hasAudio() const;
+
+	//! Returns whether a new frame has been decoded since the last call to checkNewFrame() or getTexture()
+	bool		checkNewFrame();
+
+	//! Returns the current time of the movie in seconds
+	float		getCurrentTime() const;
+	//! Sets the movie to the time \a seconds
+	void		seekToTime( float seconds );
+	//! Sets the movie time to its beginning
+	void		seekToStart();
+	//! Sets the movie time to its end
+	void		seekToEnd();
+
+	//! Sets whether the movie loops during playback. Unlike qtime::MovieGl, palindrome looping isn't supported.
+	void		setLoop( bool loop = true );
+	//! Pauses the movie and advances it by one frame
+	void		stepForward();
+	//! Pauses the movie and steps it back by one frame
+	void		stepBackward();
+	//! Sets the playback rate, which begins playback immediately for nonzero values. 1.0 represents normal speed and \c 0 stops. Negative rates are only supported by some sources.
+	void		setRate( float rate );
+
+	//! Sets the audio playback volume ranging from [0 - 1.0]
+	void		setVolume( float volume );
+	//! Gets the audio playback volume ranging from [0 - 1.0]
+	float		getVolume() const;
+
+	//! Returns whether the movie is currently playing or is paused/stopped.
+	bool		isPlaying() const;
+	//! Returns whether the movie has completely finished playing
+	bool		isDone() const;
+	//! Begins movie playback.
+	void		play();
+	//! Stops movie playback.
+	void		stop();
+
+	//! Returns the gl::Texture representing the movie's current frame, updating it first if a new frame has been decoded. Requires the GL context the movie was created with, or one sharing with it, to be current.
+	const gl::Texture	getTexture();
+
+  protected:
+	struct Obj;
+	std::shared_ptr<Obj>		mObj;
+
+  public:
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> MovieGl::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &MovieGl::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+class MovieGlExc : public Exception {
+  public:
+	MovieGlExc( const std::string &description ) : mDescription( description ) {}
+	virtual const char* what() const throw() { return mDescription.c_str(); }
+
+  protected:
+	std::string		mDescription;
+};
+
+} } // namespace cinder::msw
@@ -150,6 +150,19 @@ class InterfaceGl {
 	bool	isMaximized() const;
 	//! Sets the position of this interface instance
 	void	setPosition( const ci::Vec2i &pos );
+
+	/** \brief Enables retained-mode drawing, in which draw() renders the interface into a cached Fbo and only re-renders it after user interaction or a change in a param's value.
+		Param values are polled at most getRefreshRate() times per second. Translucent bars composite slightly more transparently than when drawn directly. Ignored on DirectX. **/
+	void	enableCaching( bool enable = true );
+	//! Returns whether retained-mode drawing is enabled. \see enableCaching()
+	bool	isCachingEnabled() const;
+	//! Sets the maximum number of times per second param values are polled for changes while caching is enabled. Defaults to \c 10.
+	void	setRefreshRate( float hz );
+	//! Returns the maximum number of times per second param values are polled for changes while caching is enabled.
+	float	getRefreshRate() const;
+	//! Forces the cached interface to be re-rendered on the next draw().
+	void	invalidate();
+
 	//! Adds \a target as a param to the interface, referring to it with \a name. \return Options<T> for chaining options to the param.
 	template <typename T>
 	Options<T>	addParam( const std::string &name, T *target, bool readOnly = false );
@@ -214,6 +227,8 @@ class InterfaceGl {
   protected:
 	void	init( app::WindowRef window, const std::string &title, const Vec2i &size, const ColorA color );
 	void	implAddParamDeprecated( const std::string &name, void *param, int type, const std::string &optionsStr, bool readOnly );
+	void	addValueWatcher( const std::string &name, const std::function<bool ()> &changedFn );
+	void	drawCached();
 
 	template <typename T>
 	Options<T>	addParamImpl( const std::string &name, T *param, int type, bool readOnly );
@@ -225,6 +240,9 @@ class InterfaceGl {
 	int								mTwWindowId;
 	
 	std::map<std::string, std::shared_ptr<void> >	mStoredCallbacks; // key = name, value = memory managed pointer
+
+	struct Cache;
+	std::shared_ptr<Cache>			mCache; // shared with the window's event handlers, which may outlive this InterfaceGl
 };
 
 template <typename T>
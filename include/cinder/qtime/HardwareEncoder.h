@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Surface.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+
+namespace cinder { namespace qtime {
+
+/** \brief Writes an H.264 movie with the platform's hardware encoder, which MovieWriter uses when Format::enableHardwareEncoding() is set.
+	AVAssetWriter drives VideoToolbox on OS X (10.7 and later; apps link AVFoundation and CoreMedia), and the Media Foundation Sink Writer
+	loads the GPU vendor's encoder on Windows (7 and later). Frames are handed over as soon as they are converted, and encoded while the
+	caller moves on. Unlike the rest of qtime, this doesn't need QuickTime and builds for 64-bit as well. **/
+class HardwareEncoder : private boost::noncopyable {
+  public:
+	struct Options {
+		Options() : mWidth( 0 ), mHeight( 0 ), mFrameRate( 30 ), mQuality( 0.99f ), mAverageBitRate( 0 ), mMaxKeyFrameInterval( 0 ) {}
+
+		int32_t		mWidth, mHeight;
+		double		mFrameRate;
+		//! In the range [0,1], used when mAverageBitRate is 0
+		float		mQuality;
+		//! Bits per second, or 0 to derive it from mQuality
+		int32_t		mAverageBitRate;
+		//! Frames, or 0 to leave key frame placement to the encoder
+		int32_t		mMaxKeyFrameInterval;
+	};
+
+	//! Returns an encoder writing to \a path, replacing any file there, or \c NULL if no hardware H.264 encoder is available
+	static std::unique_ptr<HardwareEncoder>	create( const fs::path &path, const Options &options );
+	~HardwareEncoder();
+
+	//! Encodes \a surface, presented at \a time for \a duration, both measured in seconds. Returns \c false on failure.
+	bool	encodeFrame( const Surface8u &surface, double time, double duration );
+	//! Completes the movie, blocking until the encoder has written the last frame. Returns \c false on failure.
+	bool	finish();
+
+	//! Returns the bit rate derived from \a quality for a movie of \a width x \a height at \a frameRate, from 0.02 bits per pixel at quality 0 to 0.4 at quality 1.
+	static int32_t	getBitRateForQuality( float quality, int32_t width, int32_t height, double frameRate );
+
+  private:
+	HardwareEncoder();
+
+	struct Impl;
+	std::unique_ptr<Impl>	mImpl;
+};
+
+} } // namespace cinder::qtime
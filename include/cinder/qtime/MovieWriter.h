@@ -26,7 +26,11 @@
 #include "cinder/ImageIo.h"
 #include "cinder/Stream.h"
 #include "cinder/qtime/QuickTime.h"
+#include "cinder/qtime/HardwareEncoder.h"
+#include "cinder/gl/Fbo.h"
 
+#include <deque>
+#include <exception>
 #include <string>
 
 // These forward declarations prevent us from having to bring all of QuickTime into the global namespace in MSW
@@ -109,6 +113,28 @@ class MovieWriter {
 		bool		isMultiPass() const { return mEnableMultiPass; }
 		//! Enables multiPass encoding. Defaults to \c false. While multiPass encoding can result in significantly smaller movies, it often takes much longer to compress and requires the creation of two temporary files for storing intermediate results.
 		Format&		enableMultiPass( bool enable = true ) { mEnableMultiPass = enable; return *this; }
+		//! Returns whether frames are compressed on a background thread. Defaults to \c false.
+		bool		isAsync() const { return mAsync; }
+		/** \brief Enables compressing frames on a background thread. Defaults to \c false.
+			addFrame() then only queues the frame, blocking once getMaxFramesInFlight() frames are held in memory. Errors are rethrown by the next addFrame() or by finish(). **/
+		Format&		enableAsync( bool enable = true ) { mAsync = enable; return *this; }
+		//! Returns the maximum number of frames queued for asynchronous compression, including FboReadbacks not yet collected. Defaults to \c 4.
+		size_t		getMaxFramesInFlight() const { return mMaxFramesInFlight; }
+		//! Sets the maximum number of frames queued for asynchronous compression, including FboReadbacks not yet collected. Defaults to \c 4.
+		Format&		setMaxFramesInFlight( size_t frames ) { mMaxFramesInFlight = std::max<size_t>( 1, frames ); return *this; }
+		//! Returns the number of subsequent addFrame() calls an FboReadback is left in flight before it is collected. Defaults to \c 2.
+		size_t		getReadbackLatency() const { return mReadbackLatency; }
+		//! Sets the number of subsequent addFrame() calls an FboReadback is left in flight before it is collected. Defaults to \c 2, which lets the transfer complete without stalling.
+		Format&		setReadbackLatency( size_t frames ) { mReadbackLatency = frames; return *this; }
+		//! Returns whether \c CODEC_H264 movies are encoded by the GPU's hardware encoder when one is available. Defaults to \c false.
+		bool		isHardwareEncoding() const { return mHardwareEncoding; }
+		/** \brief Enables encoding \c CODEC_H264 movies with the GPU's hardware encoder through HardwareEncoder, falling back to QuickTime when none is available. Defaults to \c false.
+			Quality, frame rate (the inverse of getDefaultDuration()) and getMaxKeyFrameRate() carry over; gamma, multiPass and the remaining QuickTime options are ignored. **/
+		Format&		enableHardwareEncoding( bool enable = true ) { mHardwareEncoding = enable; return *this; }
+		//! Returns the average bit rate for hardware encoding, measured in bits per second. Defaults to \c 0, which derives it from getQuality().
+		int32_t		getAverageBitRate() const { return mAverageBitRate; }
+		//! Sets the average bit rate for hardware encoding, measured in bits per second. Defaults to \c 0, which derives it from getQuality().
+		Format&		setAverageBitRate( int32_t bitsPerSecond ) { mAverageBitRate = bitsPerSecond; return *this; }
 
 	  private:
 		void		initDefaults();
@@ -119,6 +145,10 @@ class MovieWriter {
 		float		mQualityFloat;
 		float		mGamma;
 		bool		mEnableMultiPass;
+		bool		mAsync;
+		size_t		mMaxFramesInFlight, mReadbackLatency;
+		bool		mHardwareEncoding;
+		int32_t		mAverageBitRate;
 
 		ICMCompressionSessionOptionsRef		mOptions;
 
@@ -156,9 +186,23 @@ class MovieWriter {
 	/** \brief Appends a frame to the Movie. The optional \a duration parameter allows a frame to be inserted for a time other than the Format's default duration.
 		\note Calling addFrame() after a call to finish() will throw a MovieWriterExcAlreadyFinished exception. **/
 	void addFrame( const ImageSourceRef &imageSource, float duration = -1.0f ) { mObj->addFrame( imageSource, duration ); }
+	/** \brief Appends \a surface to the Movie. In asynchronous mode the Surface is retained and must not be modified afterwards; pass a clone when it is reused.
+		\note Calling addFrame() after a call to finish() will throw a MovieWriterExcAlreadyFinished exception. **/
+	void addFrame( const Surface8u &surface, float duration = -1.0f ) { mObj->addFrame( surface, duration ); }
+	/** \brief Appends the pixels of \a readback to the Movie. In asynchronous mode they are collected after Format::getReadbackLatency() further addFrame() calls, or by finish(), so that the GPU transfer doesn't stall the caller.
+		The GL context the readback was issued in must be current whenever addFrame() or finish() is called. **/
+	void addFrame( const gl::FboReadback &readback, float duration = -1.0f ) { mObj->addFrame( readback, duration ); }
 	
-	//! Returns the number of frames in the movie
+	//! Returns the number of frames in the movie. In asynchronous mode this counts frames compressed so far.
 	uint32_t	getNumFrames() const { return mObj->mNumFrames; }
+	//! Returns the number of frames queued for asynchronous compression, including FboReadbacks not yet collected
+	size_t		getNumFramesInFlight() const { return mObj->getNumFramesInFlight(); }
+	//! Returns whether the asynchronous compressor is falling behind, which is when the next addFrame() would block because Format::getMaxFramesInFlight() frames are already queued
+	bool		isFallingBehind() const { return mObj->mFormat.mAsync && getNumFramesInFlight() >= mObj->mFormat.mMaxFramesInFlight; }
+	//! Returns the number of addFrame() calls that blocked waiting for the asynchronous compressor to catch up
+	uint32_t	getNumStalls() const { return mObj->mNumStalls; }
+	//! Returns whether the movie is being encoded by the hardware encoder rather than QuickTime. See Format::enableHardwareEncoding().
+	bool		isHardwareEncoding() const { return mObj->mHardwareEncoder.get() != NULL; }
 
 	//! Completes the encoding of the movie and closes the file. Calling finish() more than once has no effect.
 	void finish() { mObj->finish(); }
@@ -172,8 +216,24 @@ class MovieWriter {
 		~Obj();
 		
 		void	addFrame( const ImageSourceRef &imageSource, float duration );
+		void	addFrame( const Surface8u &surface, float duration );
+		void	addFrame( const gl::FboReadback &readback, float duration );
+		void	encodeFrame( const ImageSourceRef &imageSource, int64_t durationVal );
+		void	encodeFrame( const Surface8u &surface, int64_t durationVal );
+		void	createMovie();
 		void	createCompressionSession();
 		void	finish();
+
+		// asynchronous mode
+		int64_t	getDurationValue( float duration ) const;
+		void	prepareFrame();
+		void	queueFrame( const Surface8u &surface, int64_t durationVal );
+		void	collectReadback();
+		void	waitForFrames( size_t maxFrames );
+		size_t	getNumFramesInFlight() const;
+		void	stopCompressionThread();
+		void	compressionThreadFn();
+		void	rethrowError();
 		
 		static OSStatus encodedFrameOutputCallback( void *refCon, ::ICMCompressionSessionRef session, OSStatus err, ICMEncodedFrameRef encodedFrame, void *reserved );
 
@@ -184,7 +244,7 @@ class MovieWriter {
 		::ICMCompressionSessionRef		mCompressionSession;
 		::ICMCompressionPassModeFlags 	mMultiPassModeFlags;		
 		fs::path		mPath;
-		uint32_t		mNumFrames;
+		std::atomic<uint32_t>	mNumFrames;
 		int64_t			mCurrentTimeValue;
 		
 		int32_t		mWidth, mHeight;
@@ -193,7 +253,26 @@ class MovieWriter {
 
 		IoStreamRef		mMultiPassFrameCache;
 
+		// replaces the Movie and compression session when hardware encoding
+		std::unique_ptr<HardwareEncoder>	mHardwareEncoder;
+
 		std::vector<std::pair<int64_t,int64_t> >	mFrameTimes;
+
+		struct PendingReadback {
+			gl::FboReadback		mReadback;
+			int64_t				mDurationVal;
+			size_t				mAge;
+		};
+
+		std::thread										mCompressionThread;
+		std::deque<std::pair<Surface8u,int64_t> >		mFrameQueue;
+		std::deque<PendingReadback>						mReadbacks;
+		mutable std::mutex								mMutex;
+		std::condition_variable							mFrameQueuedCond, mFrameFinishedCond;
+		size_t											mNumCompressing; // queued or being compressed
+		bool											mStopCompressionThread;
+		std::atomic<uint32_t>							mNumStalls;
+		std::exception_ptr								mError;
 	};
 	/// \endcond
 	
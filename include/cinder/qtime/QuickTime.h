@@ -33,8 +33,13 @@
 #include "cinder/Url.h"
 #include "cinder/DataSource.h"
 #include "cinder/Thread.h"
+#include "cinder/Timer.h"
+
+#include <boost/noncopyable.hpp>
 
 #include <string>
+#include <vector>
+#include <deque>
 
 #if defined( CINDER_MAC )
 	#include <QuickTime/QuickTime.h>
@@ -55,6 +60,8 @@
 	typedef unsigned long                   FourCharCode;
 	typedef struct __CVBuffer*				CVBufferRef;
 	typedef CVBufferRef						CVImageBufferRef;
+	typedef struct TimeBaseRecord*			TimeBase;
+	typedef struct ComponentRecord*			Component;
 #endif
 
 namespace cinder { namespace qtime {
@@ -104,6 +111,28 @@ class MovieBase {
 	void		seekToTime( float seconds );
 	//! Sets the movie time to the start time of frame \a frame
 	void		seekToFrame( int frame );
+	//! Sets the movie time to the keyframe (sync sample) at or before \a seconds, which QuickTime can display without decoding any other frames
+	void		seekToKeyframe( float seconds );
+	/** \brief Seeks to \a seconds for interactive scrubbing, such as from a slider.
+		Each call displays the nearest keyframe at or before \a seconds immediately, or the exact frame if it is in the frame cache. The exact seek is deferred until
+		no further call has been made for the scrub settle time, so dragging through long GOPs does not decode every intermediate frame. \see setScrubSettleTime(), setFrameCacheSize() **/
+	void		scrubToTime( float seconds );
+	//! Sets how long scrubToTime() waits for further calls before seeking to the exact requested time. Defaults to \c 0.15 seconds.
+	void		setScrubSettleTime( float seconds ) { getObj()->mScrubSettleTime = seconds; }
+	//! Returns how long scrubToTime() waits for further calls before seeking to the exact requested time
+	float		getScrubSettleTime() const { return getObj()->mScrubSettleTime; }
+	//! Retains up to \a numFrames recently decoded frames so that scrubbing back over them is displayed without seeking. \c 0, the default, disables the cache.
+	void		setFrameCacheSize( size_t numFrames );
+	//! Returns the maximum number of decoded frames retained for scrubbing
+	size_t		getFrameCacheSize() const { return getObj()->mFrameCacheSize; }
+
+	/** \brief Builds the index of frame and keyframe times used by seekToFrame(), seekToKeyframe(), scrubToTime() and the frame cache.
+		The index is built on first use; calling this right after loading moves that cost out of the first seek. The movie must be fully loaded. **/
+	void		buildFrameIndex();
+	//! Returns the index of the frame displayed at \a seconds
+	int32_t		getFrameAtTime( float seconds );
+	//! Returns the time in seconds of the keyframe at or before \a seconds
+	float		getKeyframeTime( float seconds );
 	//! Sets the movie time to its beginning
 	void		seekToStart();
 	//! Sets the movie time to its end
@@ -163,6 +192,8 @@ class MovieBase {
 
 	static int32_t		countFrames( ::Movie theMovie );
 	TimeValue			getStartTimeOfFirstSample() const;
+	int32_t				findFrame( TimeValue time );
+	int32_t				findKeyframe( int32_t frame );
 
  protected:
 	void	initFromPath( const fs::path &filePath );
@@ -183,6 +214,11 @@ class MovieBase {
 		// which in turn means this functionality must be in the Obj, not the MovieBase
 		virtual void		releaseFrame() = 0;
 		virtual void		newFrame( CVImageBufferRef cvImage ) = 0;
+		// stores the current frame in the frame cache as frame \a frame, evicting the least recently used frame beyond mFrameCacheSize
+		virtual void		cacheFrame( int32_t frame ) = 0;
+		// makes cached frame \a frame current; returns false if it is not cached
+		virtual bool		showCachedFrame( int32_t frame ) = 0;
+		virtual void		clearFrameCache() = 0;
 				
 		int32_t						mWidth, mHeight;
 		int32_t						mFrameCount;
@@ -197,6 +233,15 @@ class MovieBase {
 		QTVisualContextRef			mVisualContext;
 		::Movie						mMovie;
 
+		std::vector<TimeValue>		mFrameTimes; // start time of every video sample, in movie time
+		std::vector<int32_t>		mKeyframes; // indices into mFrameTimes of the sync samples
+		bool						mFrameIndexBuilt;
+		size_t						mFrameCacheSize;
+		bool						mScrubPending;
+		TimeValue					mScrubTime;
+		float						mScrubSettleTime;
+		Timer						mScrubTimer;
+
 		void		(*mNewFrameCallback)(long timeValue, void *refcon);
 		void		*mNewFrameCallbackRefcon;			
 
@@ -205,6 +250,8 @@ class MovieBase {
 	};
 	
 	virtual Obj*		getObj() const = 0;
+
+	friend class MovieClock;
 };
 
 class MovieSurface;
@@ -238,8 +285,12 @@ class MovieSurface : public MovieBase {
 		
 		virtual void		releaseFrame(); 
 		virtual void		newFrame( CVImageBufferRef cvImage );
+		virtual void		cacheFrame( int32_t frame );
+		virtual bool		showCachedFrame( int32_t frame );
+		virtual void		clearFrameCache() { mFrameCache.clear(); }
 	
 		Surface				mSurface;
+		std::deque<std::pair<int32_t,Surface> >		mFrameCache;
 	};
  	
 	std::shared_ptr<Obj>		mObj;
@@ -289,8 +340,12 @@ class MovieGl : public MovieBase {
 
 		virtual void		releaseFrame();
 		virtual void		newFrame( CVImageBufferRef cvImage );
+		virtual void		cacheFrame( int32_t frame );
+		virtual bool		showCachedFrame( int32_t frame );
+		virtual void		clearFrameCache() { mFrameCache.clear(); }
 		
 		gl::Texture			mTexture;
+		std::deque<std::pair<int32_t,gl::Texture> >	mFrameCache;
 #if defined( CINDER_MSW )
 		gl::TextureCache	mTextureCache;
 #endif
@@ -362,6 +417,65 @@ class MovieLoader {
 	//@}
 };
 
+typedef std::shared_ptr<class MovieClock>	MovieClockRef;
+
+/** \brief A playback clock shared by several movies, such as the tiles of a multi-screen video.
+ *	Each movie added is slaved to the clock's QuickTime time base, so every movie's time is derived from the same clock and they cannot drift apart.
+ *	Control playback through the clock; calling play(), stop(), setRate(), seekToTime() or setLoop() on a slaved movie directly breaks the synchronization.
+ *	The clock retains the movies added to it. **/
+class MovieClock : private boost::noncopyable {
+  public:
+	static MovieClockRef	create() { return MovieClockRef( new MovieClock() ); }
+	~MovieClock();
+
+	//! Slaves \a movie to the clock, seeking it to the clock's current time
+	template<typename MovieT>
+	void	addMovie( const MovieT &movie ) { attachMovie( std::shared_ptr<MovieBase>( new MovieT( movie ) ) ); }
+	//! Releases \a movie from the clock, leaving it stopped at its current time
+	void	removeMovie( const MovieBase &movie );
+	//! Returns the number of movies slaved to the clock
+	size_t	getNumMovies() const { return mMovies.size(); }
+
+	//! Prerolls every movie at the clock's current time and then starts the clock at normal speed, or at its current rate if already running, so that all movies begin on the same frame
+	void	play();
+	//! Stops the clock and every movie with it
+	void	stop();
+	//! Returns whether the clock is running
+	bool	isPlaying() const;
+	//! Sets the clock's playback rate. \c 1.0 represents normal speed, negative values play in reverse and \c 0 stops. Playback starts immediately for nonzero values.
+	void	setRate( float rate );
+	//! Returns the clock's playback rate, which is \c 0 while stopped
+	float	getRate() const;
+
+	//! Sets the clock's time to \a seconds, moving every movie to the same time
+	void	seekToTime( float seconds );
+	//! Sets the clock's time to the start
+	void	seekToStart() { seekToTime( 0 ); }
+	//! Returns the clock's current time in seconds
+	float	getCurrentTime() const;
+	//! Returns the duration of the longest movie slaved to the clock, in seconds
+	float	getDuration() const;
+	//! Sets whether the clock returns to the start after the longest movie ends. Shorter movies hold their last frame until then.
+	void	setLoop( bool loop = true );
+	//! Returns whether the clock loops
+	bool	isLoop() const { return mLoop; }
+
+	/** \brief Gives every movie the chance to pick up its frame for the clock's current time. Call once per frame before drawing.
+		The movies are tasked back to back, so their frames are chosen for the same clock time rather than whenever each getTexture() or getSurface() happens to be called. **/
+	void	update();
+
+  protected:
+	MovieClock();
+
+	void	attachMovie( const std::shared_ptr<MovieBase> &movie );
+	void	updateStopTime();
+
+	::TimeBase									mTimeBase;
+	::Component									mClockComponent;
+	std::vector<std::shared_ptr<MovieBase> >	mMovies;
+	bool										mLoop;
+};
+
 inline int32_t floatToFixed( float fl ) { return ((int32_t)((float)(fl) * ((int32_t) 0x00010000L))); }
 
 //! Initializes QuickTime system-wide. Safe to call multiple times.
@@ -548,6 +548,8 @@ class Path : public Node {
 	virtual Rectf	calcBoundingBox() const { return mPath.calcPreciseBoundingBox(); }
 		
 	Shape2d		mPath;
+
+	friend class Doc;
 };
 
 //! SVG Line element: http://www.w3.org/TR/SVG/shapes.html#LineElement
@@ -776,18 +778,70 @@ class Group : public Node, private boost::noncopyable {
 };
 
 
+typedef std::shared_ptr<class NodeIndex>	NodeIndexRef;
+
+/** \brief A bounding box R-tree over the Nodes of a Group and its descendant Groups, for finding the Node under a point without testing every one.
+ *
+ * The absolute bounding boxes of the Nodes are packed into a static R-tree with Sort-Tile-Recursive bulk loading. nodeUnderPoint() only descends into
+ * boxes which contain the point, and calls containsPoint() on the Nodes found there, topmost first. The index is a snapshot of the Nodes and their transforms,
+ * so it must be rebuilt after either changes. **/
+class NodeIndex : private boost::noncopyable {
+  public:
+	//! Builds an index over the descendants of \a root, including its own transform. The bounding boxes of large documents are calculated in parallel on the TaskPool.
+	static NodeIndexRef	create( const Group &root ) { return NodeIndexRef( new NodeIndex( root ) ); }
+
+	//! Returns the top-most indexed Node which contains \a pt, in the coordinates of the root's parent. Returns NULL if no Node contains the point.
+	Node*	nodeUnderPoint( const Vec2f &pt ) const;
+	//! Appends every indexed Node whose absolute bounding box intersects \a rect to \a result, in no particular order
+	void	queryBoundingBoxes( const Rectf &rect, std::vector<Node*> *result ) const;
+
+	//! Returns the number of Nodes indexed
+	size_t	getNumNodes() const { return mEntries.size(); }
+
+  private:
+	NodeIndex( const Group &root );
+
+	void	addNodes( const Group &group, const MatrixAffine2f &parentInverse );
+	template<typename Fn>
+	void	traverse( const Rectf &rect, const Fn &fn ) const;
+
+	struct Entry {
+		Rectf			mBounds;	// absolute
+		Node			*mNode;
+		uint32_t		mOrder;		// in which the Node is rendered, so higher is closer to the top
+		MatrixAffine2f	mInverse;	// maps absolute coordinates into the Node's local coordinates
+	};
+
+	// A leaf's children are mCount consecutive entries starting at mFirst, an interior node's are mCount consecutive tree nodes
+	struct TreeNode {
+		Rectf		mBounds;
+		uint32_t	mFirst, mCount;
+		bool		mLeaf;
+	};
+
+	std::vector<Entry>		mEntries;
+	std::vector<TreeNode>	mTreeNodes;		// the root is last
+};
+
 typedef std::shared_ptr<Doc>	DocRef;
 //! Represents an SVG Document. See SVG Document Structure http://www.w3.org/TR/SVG/struct.html
 class Doc : public Group {
   public:
-	Doc() : Group( 0 ), mWidth( 0 ), mHeight( 0 ) {}
+	Doc() : Group( 0 ), mWidth( 0 ), mHeight( 0 ), mDeferPathParsing( false ) {}
 	Doc( const fs::path &filePath );
 	Doc( DataSourceRef dataSource, const fs::path &filePath = fs::path() );
+	//! Builds the document from \a xmlTree, which must have been parsed with getParseOptions(). Images are loaded relative to \a filePath.
+	Doc( const std::shared_ptr<XmlTree> &xmlTree, const fs::path &filePath = fs::path() );
 
 	static DocRef	create( const fs::path &filePath );
 	static DocRef	create( DataSourceRef dataSource, const fs::path &filePath = fs::path() );
+	//! Builds the document from \a xmlTree, which must have been parsed with getParseOptions(), such as one loaded through a TreeCache.
+	static DocRef	create( const std::shared_ptr<XmlTree> &xmlTree, const fs::path &filePath = fs::path() );
 	static DocRef	createFromSvgz( DataSourceRef dataSource, const fs::path &filePath = fs::path() );
 
+	//! Returns the options SVG documents are parsed with, which keep the text of \c <text> elements.
+	static XmlTree::ParseOptions	getParseOptions() { return XmlTree::ParseOptions().ignoreDataChildren( false ); }
+
 	//! Returns the width of the document in pixels
 	int32_t		getWidth() const { return mWidth; }
 	//! Returns the height of the document in pixels
@@ -802,13 +856,19 @@ class Doc : public Group {
 	//! Returns the document's dots-per-inch. Currently hardcoded to 72.
 	float		getDpi() const { return 72.0f; }
 	
-	//! Returns the top-most Node which contains \a pt. Returns NULL if no Node contains the point.
+	//! Returns the top-most Node which contains \a pt. Returns NULL if no Node contains the point. Queries getNodeIndex().
 	Node*		nodeUnderPoint( const Vec2f &pt );
+	//! Returns the NodeIndex queried by nodeUnderPoint(), which is built on first use
+	const NodeIndex&	getNodeIndex();
+	//! Discards the NodeIndex so that the next nodeUnderPoint() rebuilds it. Call after modifying the document's Nodes or their transforms.
+	void		invalidateNodeIndex() { mNodeIndex.reset(); }
 	
 	//! Utility function to load an image relative to the document. Caches results.
 	std::shared_ptr<Surface8u>	loadImage( fs::path relativePath );
   private:
   	void 	loadDoc( DataSourceRef source, fs::path filePath );
+	void	loadXml( const std::shared_ptr<XmlTree> &xmlTree, const fs::path &filePath );
+	void	parseDeferredPaths();
 
 	virtual void		renderSelf( Renderer &renderer ) const;
   
@@ -818,6 +878,13 @@ class Doc : public Group {
 	fs::path		mFilePath;
 	Area			mViewBox;
 	int32_t			mWidth, mHeight;
+	NodeIndexRef	mNodeIndex;
+
+	// while loading, Paths defer parsing their data here so that it can be done in parallel once the tree is built
+	bool										mDeferPathParsing;
+	std::vector<std::pair<Path*,std::string> >	mDeferredPaths;
+
+	friend class Path;
 };
 
 //! SVG Exception base-class
@@ -27,9 +27,15 @@
 
 #include "cinder/gl/gl.h"
 #include "cinder/gl/Texture.h"
+#include "cinder/gl/Vbo.h"
 #include "cinder/svg/Svg.h"
 #include "cinder/Triangulate.h"
 
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <vector>
+
 namespace cinder {
 
 class SvgRendererGl : public svg::Renderer {
@@ -174,6 +180,76 @@ class SvgRendererGl : public svg::Renderer {
 	std::vector<svg::FillRule>	mFillRuleStack;
 };
 
+typedef std::shared_ptr<class SvgBatchGl>	SvgBatchGlRef;
+
+/** \brief Retained OpenGL renderer for an svg::Doc.
+ *	The first draw() walks the document once and tessellates it into a single vertex buffer of colored triangles in painter's order. Every later draw() is one
+ *	draw call, with no traversal of the node tree. Fills are tessellated with Triangulator. Strokes are expanded into triangles of the stroke width with bevel joins,
+ *	so unlike SvgRendererGl they scale with the document's transforms. Like SvgRendererGl, gradients draw in their first color; images and text are not drawn.
+ *
+ *	After changing a node's transform or style, call markDirty() on it: only that subtree is re-recorded, its tessellation is reused unless its fill rule or
+ *	stroke width changed, and only its vertices are re-uploaded. Changes to geometry, visibility or the tree's structure require markAllDirty(). **/
+class SvgBatchGl : private boost::noncopyable {
+  public:
+	//! Creates a batch drawing \a doc. \a approximationScale controls curve subdivision as in Triangulator; raise it when the document is drawn magnified.
+	static SvgBatchGlRef	create( const svg::DocRef &doc, float approximationScale = 1.0f ) { return SvgBatchGlRef( new SvgBatchGl( doc, approximationScale ) ); }
+
+	//! Draws the document, first tessellating or re-uploading whatever has been marked dirty
+	void	draw();
+
+	//! Marks \a node and its descendants as having a changed transform or style, to be updated by the next draw()
+	void	markDirty( const svg::Node &node ) { mDirtyNodes.push_back( &node ); }
+	//! Marks the whole document to be re-tessellated by the next draw()
+	void	markAllDirty() { mAllDirty = true; }
+
+	//! Returns the document drawn by the batch
+	const svg::DocRef&	getDoc() const { return mDoc; }
+	//! Returns the number of vertices in the vertex buffer, which is 3 per triangle
+	size_t				getNumVertices() const { return mVertices.size(); }
+
+  protected:
+	SvgBatchGl( const svg::DocRef &doc, float approximationScale );
+
+	class Recorder;
+
+	struct Vertex {
+		Vec2f		mPosition;
+		ColorA8u	mColor;
+	};
+
+	//! The triangles of a single drawable node, in the node's local coordinates
+	struct Item {
+		Item() : mNode( 0 ), mHasFill( false ), mHasStroke( false ), mFirstVertex( 0 ), mNumVertices( 0 ), mDirty( true ) {}
+
+		const svg::Node		*mNode;
+		bool				mHasFill, mHasStroke;
+		svg::FillRule		mFillRule;
+		float				mStrokeWidth;
+		std::vector<Vec2f>	mFillTriangles, mStrokeTriangles;
+		ColorA8u			mFillColor, mStrokeColor;
+		MatrixAffine2f		mTransform;
+		size_t				mFirstVertex, mNumVertices;
+		bool				mDirty;
+	};
+
+	void	update();
+	//! Re-records every dirty subtree in place. Returns false if the document no longer records the same sequence of nodes.
+	bool	updateDirtyNodes();
+	void	rebuildVertexBuffer();
+	void	writeVertices( const Item &item, Vertex *result ) const;
+
+	svg::DocRef							mDoc;
+	float								mApproximationScale;
+
+	std::vector<Item>					mItems;
+	std::map<const svg::Node*,size_t>	mFirstItems; // index of the first Item recorded for each drawable and group node
+	std::vector<Vertex>					mVertices;
+	gl::Vbo								mVbo;
+
+	bool								mAllDirty;
+	std::vector<const svg::Node*>		mDirtyNodes;
+};
+
 namespace gl {
 inline void draw( const svg::Doc &svg )
 {
@@ -122,9 +122,14 @@ static bool verbose = true;
 //videoInput defines
 #define VI_VERSION	 0.1995
 #define VI_MAX_CAMERAS  20
-#define VI_NUM_TYPES    18 //DON'T TOUCH
+#define VI_NUM_TYPES    20 //DON'T TOUCH
+#define VI_NUM_UNCOMPRESSED_TYPES 18 //DON'T TOUCH
 #define VI_NUM_FORMATS  18 //DON'T TOUCH
 
+//defines for setRequestedMediaSubtype - compressed formats which DirectShow decodes ahead of the sample grabber
+#define VI_MEDIASUBTYPE_MJPG 18
+#define VI_MEDIASUBTYPE_H264 19
+
 //defines for setPhyCon - tuner is not as well supported as composite and s-video 
 #define VI_COMPOSITE 0
 #define VI_S_VIDEO   1
@@ -221,6 +226,7 @@ class videoDevice{
 		int	 storeConn;
 		int  myID;
 		long requestedFrameTime; //ie fps
+		int  requestedMediaSubtype; //VI_MEDIASUBTYPE_ index or -1
 		
 		char 	nDeviceName[255];
 		WCHAR 	wDeviceName[255];
@@ -263,6 +269,12 @@ class videoInput{
 		//to a device if videoInput detects that a device has stopped delivering frames. 
 		//you MUST CALL isFrameNew every app loop for this to have any effect
 		void setAutoReconnectOnFreeze(int deviceNumber, bool doReconnect, int numMissedFramesBeforeReconnect);
+
+		//call before setupDevice
+		//asks the device to send one of the VI_MEDIASUBTYPE_ formats at the size given to setupDevice - eg VI_MEDIASUBTYPE_MJPG
+		//compressed formats are decoded by the system's DirectShow decoder, so frames still arrive as RGB
+		//if the device doesn't have the format at that size the usual uncompressed formats are tried
+		void setRequestedMediaSubtype(int deviceNumber, int mediaSubtype);
 		
 		//Choose one of these four to setup your device
 		bool setupDevice(int deviceID);
@@ -308,6 +320,10 @@ class videoInput{
 
 		//bool setVideoSettingCam(int deviceID, long Property, long lValue, long Flags = NULL, bool useDefaultValue = false);
 
+		//returns the VI_MEDIASUBTYPE_ index of the format the device is sending, or -1 if it isn't one of them
+		//should be called after setupDevice
+		int  getMediaSubtype(int deviceID);
+
 		//get width, height and number of pixels
 		int  getWidth(int deviceID);
 		int  getHeight(int deviceID);
@@ -371,6 +387,7 @@ class videoInput{
 		GUID MEDIASUBTYPE_Y800;
 		GUID MEDIASUBTYPE_Y8;
 		GUID MEDIASUBTYPE_GREY;
+		GUID MEDIASUBTYPE_H264_FOURCC;
 
 		videoDevice * VDList[VI_MAX_CAMERAS];
 		GUID mediaSubtypes[VI_NUM_TYPES];
@@ -19,7 +19,7 @@ class FlickrTestMTApp : public AppBasic {
 
 	void loadImagesThreadFn();
 
-	ConcurrentCircularBuffer<Surface>	*mSurfaces;
+	ConcurrentCircularBufferSpsc<Surface>	*mSurfaces;
 
 	bool					mShouldQuit;
 	shared_ptr<thread>		mThread;
@@ -32,7 +32,7 @@ class FlickrTestMTApp : public AppBasic {
 void FlickrTestMTApp::setup()
 {
 	mShouldQuit = false;
-	mSurfaces = new ConcurrentCircularBuffer<Surface>( 5 ); // room for 5 images
+	mSurfaces = new ConcurrentCircularBufferSpsc<Surface>( 5 ); // room for 5 images, single loader thread and single consumer
 	// create and launch the thread
 	mThread = shared_ptr<thread>( new thread( bind( &FlickrTestMTApp::loadImagesThreadFn, this ) ) );
 	mLastTime = getElapsedSeconds();
@@ -0,0 +1,458 @@
+// Measures how much of each common draw path a machine can sustain per frame. Every case of every path
+// (a primitive count or upload size) is drawn for a number of warmup frames, then for a number of measured
+// frames with vertical sync and frame rate limiting off. Reported per case are the frames per second, and the
+// median CPU and GPU frame times. The CPU time is spent issuing the case's GL calls, the GPU time is measured
+// with gl::GpuProfiler where GL_EXT_timer_query is available (-1 otherwise).
+//
+// Results are printed to the console and written as JSON once all cases have run, to the path given with
+// --json <path> or to RenderBenchmark.json in the documents directory. Pass --quit to quit once they're written,
+// which is useful for unattended hardware qualification. Press 'r' to run again.
+
+#include "cinder/app/AppBasic.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/GpuProfiler.h"
+#include "cinder/gl/MeshBatch.h"
+#include "cinder/gl/ParticleSystem.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/TextureFont.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Json.h"
+#include "cinder/Rand.h"
+#include "cinder/Shape2d.h"
+#include "cinder/Surface.h"
+#include "cinder/Timer.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+static const int	WARMUP_FRAMES	= 30;
+static const int	MEASURED_FRAMES	= 120;
+
+class RenderBenchmarkApp : public AppBasic {
+  public:
+	void prepareSettings( Settings *settings );
+	void setup();
+	void keyDown( KeyEvent event );
+	void draw();
+
+  private:
+	// A draw path swept over a number of cases, mDraw is called with the case's parameter once per frame
+	struct Path {
+		string					mName, mParamName;
+		vector<int>				mParams;
+		function<void ( int )>	mDraw;
+	};
+
+	struct Result {
+		string	mPath, mParamName;
+		int		mParam;
+		double	mFps, mCpuMs, mGpuMs;
+	};
+
+	void	addPaths();
+	void	restart();
+	void	finishCase();
+	void	writeResults();
+
+	static double	median( vector<double> values );
+
+	vector<Path>		mPaths;
+	size_t				mPathIndex, mCaseIndex;
+	int					mCaseFrame;
+	double				mCaseStartSeconds;
+	vector<double>		mCpuSeconds, mGpuSeconds;
+	vector<Result>		mResults;
+	bool				mFinished, mQuitWhenFinished;
+	fs::path			mJsonPath;
+
+	gl::GpuProfilerRef	mGpuProfiler;
+	gl::TextureFontRef	mTextureFont;
+	gl::VboMeshRef		mVboMesh;
+	gl::MeshBatchRef	mMeshBatch;
+	uint32_t			mMeshBatchId;
+	gl::ParticleSystemRef	mParticles;
+	gl::RecordedDraw	mRecordedDraw;
+	int					mRecordedCount;
+	Shape2d				mIcon;
+	gl::TextureRef		mUploadTexture;
+	Surface8u			mUploadSurface;
+};
+
+void RenderBenchmarkApp::prepareSettings( Settings *settings )
+{
+	settings->setWindowSize( 1280, 720 );
+	settings->disableFrameRate();
+}
+
+void RenderBenchmarkApp::setup()
+{
+	gl::enableVerticalSync( false );
+
+	mQuitWhenFinished = false;
+	mJsonPath = getDocumentsDirectory() / "RenderBenchmark.json";
+	const vector<string> &args = getArgs();
+	for( size_t i = 1; i < args.size(); ++i ) {
+		if( args[i] == "--quit" )
+			mQuitWhenFinished = true;
+		else if( args[i] == "--json" && i + 1 < args.size() )
+			mJsonPath = args[++i];
+	}
+
+	if( gl::GpuProfiler::isSupported() )
+		mGpuProfiler = gl::GpuProfiler::create();
+
+	mTextureFont = gl::TextureFont::create( Font( "Arial", 18 ) );
+
+	// a 32 x 32 grid, 2048 triangles
+	TriMesh mesh;
+	const int gridSize = 32;
+	for( int y = 0; y <= gridSize; ++y ) {
+		for( int x = 0; x <= gridSize; ++x ) {
+			mesh.appendVertex( Vec3f( x / (float)gridSize, y / (float)gridSize, 0 ) );
+			mesh.appendColorRgb( Color( CM_HSV, x / (float)gridSize, 0.7f, 1 ) );
+		}
+	}
+	for( int y = 0; y < gridSize; ++y ) {
+		for( int x = 0; x < gridSize; ++x ) {
+			size_t i = y * ( gridSize + 1 ) + x;
+			mesh.appendTriangle( i, i + 1, i + gridSize + 2 );
+			mesh.appendTriangle( i, i + gridSize + 2, i + gridSize + 1 );
+		}
+	}
+	mVboMesh = gl::VboMesh::create( mesh );
+	mMeshBatch = gl::MeshBatch::create();
+	mMeshBatchId = mMeshBatch->addMesh( mesh );
+	mRecordedCount = 0;
+
+	// a curved star with a circular hole, unit sized, standing in for a vector icon
+	const int starPoints = 5;
+	for( int i = 0; i < starPoints; ++i ) {
+		float outer = i * 2 * (float)M_PI / starPoints, inner = outer + (float)M_PI / starPoints, next = outer + 2 * (float)M_PI / starPoints;
+		Vec2f outerPt( cos( outer ), sin( outer ) ), innerPt( 0.4f * cos( inner ), 0.4f * sin( inner ) ), nextPt( cos( next ), sin( next ) );
+		if( i == 0 )
+			mIcon.moveTo( outerPt );
+		mIcon.quadTo( innerPt * 0.6f, nextPt );
+	}
+	mIcon.close();
+	mIcon.moveTo( 0.2f, 0 );
+	mIcon.arc( Vec2f::zero(), 0.2f, 0, 2 * (float)M_PI );
+	mIcon.close();
+
+	addPaths();
+	restart();
+}
+
+void RenderBenchmarkApp::addPaths()
+{
+	Path solidRect;
+	solidRect.mName = "gl::drawSolidRect";
+	solidRect.mParamName = "rects";
+	solidRect.mParams.push_back( 1000 );
+	solidRect.mParams.push_back( 5000 );
+	solidRect.mParams.push_back( 20000 );
+	solidRect.mParams.push_back( 50000 );
+	solidRect.mDraw = [this]( int count ) {
+		Rand rand( 1 );
+		Vec2f size = Vec2f( getWindowSize() );
+		for( int i = 0; i < count; ++i ) {
+			gl::color( rand.nextFloat(), rand.nextFloat(), rand.nextFloat() );
+			Vec2f pos( rand.nextFloat( size.x ), rand.nextFloat( size.y ) );
+			gl::drawSolidRect( Rectf( pos, pos + Vec2f( 8, 8 ) ) );
+		}
+	};
+	mPaths.push_back( solidRect );
+
+	Path batchedSolidRect = solidRect;
+	batchedSolidRect.mName = "gl::drawSolidRect in gl::Batch2d";
+	batchedSolidRect.mDraw = [solidRect]( int count ) {
+		gl::Batch2d batch;
+		solidRect.mDraw( count );
+	};
+	mPaths.push_back( batchedSolidRect );
+
+	// recorded the first frame of each case and replayed from then on
+	Path recordedSolidRect = solidRect;
+	recordedSolidRect.mName = "gl::drawSolidRect in gl::RecordedDraw";
+	recordedSolidRect.mDraw = [this, solidRect]( int count ) {
+		if( ! mRecordedDraw || mRecordedCount != count ) {
+			mRecordedDraw = gl::RecordedDraw( GL_STATIC_DRAW );
+			mRecordedDraw.newList();
+			solidRect.mDraw( count );
+			mRecordedDraw.endList();
+			mRecordedCount = count;
+		}
+		mRecordedDraw.draw();
+	};
+	mPaths.push_back( recordedSolidRect );
+
+	Path drawString;
+	drawString.mName = "TextureFont::drawString";
+	drawString.mParamName = "strings";
+	drawString.mParams.push_back( 100 );
+	drawString.mParams.push_back( 500 );
+	drawString.mParams.push_back( 2000 );
+	drawString.mDraw = [this]( int count ) {
+		Rand rand( 1 );
+		Vec2f size = Vec2f( getWindowSize() );
+		gl::color( Color::white() );
+		for( int i = 0; i < count; ++i )
+			mTextureFont->drawString( "The quick brown fox jumps", Vec2f( rand.nextFloat( size.x ), rand.nextFloat( size.y ) ) );
+	};
+	mPaths.push_back( drawString );
+
+	Path vboMesh;
+	vboMesh.mName = "gl::draw( VboMesh )";
+	vboMesh.mParamName = "draws";
+	vboMesh.mParams.push_back( 100 );
+	vboMesh.mParams.push_back( 1000 );
+	vboMesh.mParams.push_back( 5000 );
+	vboMesh.mDraw = [this]( int count ) {
+		Rand rand( 1 );
+		Vec2f size = Vec2f( getWindowSize() );
+		gl::color( Color::white() );
+		for( int i = 0; i < count; ++i ) {
+			gl::pushModelView();
+			gl::translate( rand.nextFloat( size.x ), rand.nextFloat( size.y ) );
+			gl::scale( 40, 40 );
+			gl::draw( mVboMesh );
+			gl::popModelView();
+		}
+	};
+	mPaths.push_back( vboMesh );
+
+	// the same draws as above, queued and submitted together
+	Path meshBatch;
+	meshBatch.mName = "gl::MeshBatch";
+	meshBatch.mParamName = "draws";
+	meshBatch.mParams.push_back( 100 );
+	meshBatch.mParams.push_back( 1000 );
+	meshBatch.mParams.push_back( 5000 );
+	meshBatch.mDraw = [this]( int count ) {
+		Rand rand( 1 );
+		Vec2f size = Vec2f( getWindowSize() );
+		mMeshBatch->clearDraws();
+		for( int i = 0; i < count; ++i ) {
+			Matrix44f modelMatrix = Matrix44f::createTranslation( Vec3f( rand.nextFloat( size.x ), rand.nextFloat( size.y ), 0 ) );
+			modelMatrix.scale( Vec3f( 40, 40, 1 ) );
+			mMeshBatch->addDraw( mMeshBatchId, modelMatrix );
+		}
+		mMeshBatch->draw();
+	};
+	mPaths.push_back( meshBatch );
+
+	// simulated and drawn on the GPU, emitting enough each frame to keep the system about full
+	if( gl::ParticleSystem::isSupported() ) {
+		Path particles;
+		particles.mName = "gl::ParticleSystem";
+		particles.mParamName = "particles";
+		particles.mParams.push_back( 100000 );
+		particles.mParams.push_back( 250000 );
+		particles.mParams.push_back( 1000000 );
+		particles.mDraw = [this]( int count ) {
+			if( ! mParticles || mParticles->getMaxParticles() != (size_t)count ) {
+				mParticles = gl::ParticleSystem::create( count );
+				mParticles->addEmitter( gl::ParticleSystem::Emitter().position( Vec3f( getWindowCenter(), 0 ) ).velocity( Vec3f( 0, -300, 0 ) )
+					.velocitySpread( 200 ).rate( count / 2.0f ).lifetime( 1, 2 ) );
+				mParticles->setGravity( Vec3f( 0, 300, 0 ) );
+				mParticles->setParticleSize( 2 );
+				mParticles->setColors( ColorA( 1, 0.6f, 0.2f, 1 ), ColorA( 0.2f, 0.4f, 1, 0 ) );
+			}
+			mParticles->update( 1 / 60.0f );
+			gl::enableAlphaBlending();
+			mParticles->draw();
+			gl::disableAlphaBlending();
+		};
+		mPaths.push_back( particles );
+	}
+
+	// tessellated on the second frame and drawn from gl::ShapeMesh's cache from then on
+	Path solidShape;
+	solidShape.mName = "gl::drawSolid( Shape2d )";
+	solidShape.mParamName = "draws";
+	solidShape.mParams.push_back( 100 );
+	solidShape.mParams.push_back( 1000 );
+	solidShape.mParams.push_back( 5000 );
+	solidShape.mDraw = [this]( int count ) {
+		Rand rand( 1 );
+		Vec2f size = Vec2f( getWindowSize() );
+		gl::color( Color( 1, 0.8f, 0.2f ) );
+		for( int i = 0; i < count; ++i ) {
+			gl::pushModelView();
+			gl::translate( rand.nextFloat( size.x ), rand.nextFloat( size.y ) );
+			gl::scale( 20, 20 );
+			gl::drawSolid( mIcon, 20 );
+			gl::popModelView();
+		}
+	};
+	mPaths.push_back( solidShape );
+
+	Path textureUpdate;
+	textureUpdate.mName = "Texture::update";
+	textureUpdate.mParamName = "size";
+	textureUpdate.mParams.push_back( 256 );
+	textureUpdate.mParams.push_back( 512 );
+	textureUpdate.mParams.push_back( 1024 );
+	textureUpdate.mParams.push_back( 2048 );
+	textureUpdate.mDraw = [this]( int size ) {
+		if( ! mUploadTexture || mUploadTexture->getWidth() != size ) {
+			mUploadSurface = Surface8u( size, size, true );
+			Rand rand( 1 );
+			uint8_t *data = mUploadSurface.getData();
+			for( int i = 0; i < size * size * 4; ++i )
+				data[i] = (uint8_t)rand.nextInt( 256 );
+			mUploadTexture = gl::Texture::create( mUploadSurface );
+		}
+
+		// change a row each frame, so that drivers can't skip the upload
+		*mUploadSurface.getData( Vec2i( 0, getElapsedFrames() % size ) ) += 1;
+		mUploadTexture->update( mUploadSurface );
+		gl::color( Color::white() );
+		gl::draw( mUploadTexture, Rectf( 0, 0, 256, 256 ) );
+	};
+	mPaths.push_back( textureUpdate );
+}
+
+void RenderBenchmarkApp::restart()
+{
+	mPathIndex = mCaseIndex = 0;
+	mCaseFrame = 0;
+	mCpuSeconds.clear();
+	mGpuSeconds.clear();
+	mResults.clear();
+	mFinished = false;
+}
+
+void RenderBenchmarkApp::keyDown( KeyEvent event )
+{
+	if( event.getChar() == 'r' )
+		restart();
+}
+
+void RenderBenchmarkApp::draw()
+{
+	gl::clear( Color::black() );
+	gl::setMatricesWindow( getWindowSize() );
+
+	if( mFinished ) {
+		gl::color( Color::white() );
+		float y = 30;
+		for( vector<Result>::const_iterator resultIt = mResults.begin(); resultIt != mResults.end(); ++resultIt, y += 22 ) {
+			mTextureFont->drawString( resultIt->mPath + " " + toString( resultIt->mParam ) + " " + resultIt->mParamName + ": " + toString( (int)resultIt->mFps ) + " fps, cpu "
+				+ toString( resultIt->mCpuMs ) + " ms, gpu " + toString( resultIt->mGpuMs ) + " ms", Vec2f( 20, y ) );
+		}
+		mTextureFont->drawString( "Results written to " + mJsonPath.string() + ", press 'r' to run again", Vec2f( 20, y + 22 ) );
+		return;
+	}
+
+	const Path &path = mPaths[mPathIndex];
+	if( mCaseFrame == WARMUP_FRAMES )
+		mCaseStartSeconds = getElapsedSeconds();
+
+	size_t droppedFrames = mGpuProfiler ? mGpuProfiler->getNumDroppedFrames() : 0;
+
+	Timer cpuTimer( true );
+	if( mGpuProfiler )
+		mGpuProfiler->beginPass( "case" );
+	path.mDraw( path.mParams[mCaseIndex] );
+	if( mGpuProfiler ) {
+		mGpuProfiler->endPass();
+		mGpuProfiler->endFrame();
+	}
+	double cpuSeconds = cpuTimer.getSeconds();
+
+	if( mCaseFrame >= WARMUP_FRAMES ) {
+		mCpuSeconds.push_back( cpuSeconds );
+		// the profiler reports the frame issued getNumBufferedFrames() - 1 frames ago, which the warmup frames make sure belongs to this case
+		if( mGpuProfiler && mGpuProfiler->getNumDroppedFrames() == droppedFrames )
+			mGpuSeconds.push_back( mGpuProfiler->getPassSeconds( "case" ) );
+	}
+
+	if( ++mCaseFrame == WARMUP_FRAMES + MEASURED_FRAMES )
+		finishCase();
+}
+
+void RenderBenchmarkApp::finishCase()
+{
+	const Path &path = mPaths[mPathIndex];
+
+	Result result;
+	result.mPath = path.mName;
+	result.mParamName = path.mParamName;
+	result.mParam = path.mParams[mCaseIndex];
+	result.mFps = MEASURED_FRAMES / ( getElapsedSeconds() - mCaseStartSeconds );
+	result.mCpuMs = median( mCpuSeconds ) * 1000;
+	result.mGpuMs = mGpuSeconds.empty() ? -1 : median( mGpuSeconds ) * 1000;
+	mResults.push_back( result );
+
+	console() << result.mPath << " " << result.mParam << " " << result.mParamName << ": " << result.mFps << " fps, cpu " << result.mCpuMs << " ms, gpu " << result.mGpuMs << " ms" << endl;
+
+	mCaseFrame = 0;
+	mCpuSeconds.clear();
+	mGpuSeconds.clear();
+	if( ++mCaseIndex == path.mParams.size() ) {
+		mCaseIndex = 0;
+		if( ++mPathIndex == mPaths.size() ) {
+			mFinished = true;
+			writeResults();
+			if( mQuitWhenFinished )
+				quit();
+		}
+	}
+}
+
+void RenderBenchmarkApp::writeResults()
+{
+	JsonTree settings = JsonTree::makeObject( "settings" );
+	settings.pushBack( JsonTree( "warmupFrames", WARMUP_FRAMES ) );
+	settings.pushBack( JsonTree( "measuredFrames", MEASURED_FRAMES ) );
+	settings.pushBack( JsonTree( "windowWidth", getWindowWidth() ) );
+	settings.pushBack( JsonTree( "windowHeight", getWindowHeight() ) );
+
+	JsonTree renderer = JsonTree::makeObject( "renderer" );
+	renderer.pushBack( JsonTree( "vendor", string( (const char*)glGetString( GL_VENDOR ) ) ) );
+	renderer.pushBack( JsonTree( "renderer", string( (const char*)glGetString( GL_RENDERER ) ) ) );
+	renderer.pushBack( JsonTree( "version", string( (const char*)glGetString( GL_VERSION ) ) ) );
+	renderer.pushBack( JsonTree( "gpuTimerQueries", (bool)mGpuProfiler ) );
+
+	JsonTree results = JsonTree::makeArray( "results" );
+	for( vector<Result>::const_iterator resultIt = mResults.begin(); resultIt != mResults.end(); ++resultIt ) {
+		JsonTree result = JsonTree::makeObject();
+		result.pushBack( JsonTree( "path", resultIt->mPath ) );
+		result.pushBack( JsonTree( resultIt->mParamName, resultIt->mParam ) );
+		result.pushBack( JsonTree( "fps", resultIt->mFps ) );
+		result.pushBack( JsonTree( "cpuMs", resultIt->mCpuMs ) );
+		result.pushBack( JsonTree( "gpuMs", resultIt->mGpuMs ) );
+		results.pushBack( result );
+	}
+
+	JsonTree root = JsonTree::makeObject();
+	root.pushBack( settings );
+	root.pushBack( renderer );
+	root.pushBack( results );
+
+	try {
+		root.write( writeFile( mJsonPath ) );
+		console() << "wrote results to " << mJsonPath << endl;
+	}
+	catch( const std::exception &exc ) {
+		console() << "failed to write results to " << mJsonPath << ": " << exc.what() << endl;
+	}
+}
+
+double RenderBenchmarkApp::median( vector<double> values )
+{
+	if( values.empty() )
+		return 0;
+
+	size_t mid = values.size() / 2;
+	nth_element( values.begin(), values.begin() + mid, values.end() );
+	return values[mid];
+}
+
+CINDER_APP_BASIC( RenderBenchmarkApp, RendererGl )
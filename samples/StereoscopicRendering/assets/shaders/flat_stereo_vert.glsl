@@ -0,0 +1,8 @@
+// Draws in the current color, in single pass stereo. The application prepends
+// "#version 120" and gl::SinglePassStereo::getGlslFunctions().
+
+void main()
+{
+	gl_Position = ciStereoPosition( ciStereoModelView() * gl_Vertex );
+	gl_FrontColor = gl_Color;
+}
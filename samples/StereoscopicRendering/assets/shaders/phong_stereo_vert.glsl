@@ -0,0 +1,18 @@
+// Single pass stereo version of phong_vert.glsl. The application prepends
+// "#version 120" and gl::SinglePassStereo::getGlslFunctions().
+
+varying vec3 v;
+varying vec3 N;
+varying vec3 r;
+
+void main()
+{
+	mat4 modelView = ciStereoModelView();
+	v = vec3(modelView * gl_Vertex);
+	N = normalize(mat3(modelView) * gl_Normal);
+	r = reflect( v, N);
+
+	gl_TexCoord[0] = gl_MultiTexCoord0;
+	gl_Position = ciStereoPosition( vec4(v, 1.0) );
+	gl_FrontColor = gl_Color;
+}
@@ -29,6 +29,9 @@
 	side-by-side stereoscopic and is supported by most 3D televisions. Simply connect your computer to
 	such a television, run the sample in full screen and enable the TV's 3D mode.
 
+	The single pass side-by-side mode (F6) produces the same image with gl::SinglePassStereo, which draws
+	every mesh once with two instances, one per eye, halving the draw calls the CPU has to submit.
+
 	When creating your own stereoscopic application, be careful how you choose your convergence.
 	An excellent article can be found here:
 	http://paulbourke.net/miscellaneous/stereographics/stereorender/
@@ -41,6 +44,7 @@
 #include "cinder/gl/gl.h"
 #include "cinder/gl/Fbo.h"
 #include "cinder/gl/GlslProg.h"
+#include "cinder/gl/SinglePassStereo.h"
 #include "cinder/gl/StereoAutoFocuser.h"
 #include "cinder/gl/Vbo.h"
 
@@ -62,7 +66,7 @@ using namespace std;
 class StereoscopicRenderingApp : public AppBasic {
   public:
 	typedef enum { SET_CONVERGENCE, SET_FOCUS, AUTO_FOCUS } FocusMethod;
-	typedef enum { MONO, ANAGLYPH_RED_CYAN, SIDE_BY_SIDE, OVER_UNDER, INTERLACED_HORIZONTAL } RenderMethod;
+	typedef enum { MONO, ANAGLYPH_RED_CYAN, SIDE_BY_SIDE, OVER_UNDER, INTERLACED_HORIZONTAL, SIDE_BY_SIDE_SINGLE_PASS } RenderMethod;
 public:
 	void prepareSettings( Settings *settings );
 
@@ -83,8 +87,10 @@ private:
 	void renderSideBySide( const Vec2i &size );
 	void renderOverUnder( const Vec2i &size );
 	void renderInterlacedHorizontal( const Vec2i &size );
+	void renderSideBySideSinglePass( const Vec2i &size );
 
 	void render();
+	void renderSinglePass();
 	void renderUI();
 private:
 	bool					mDrawUI;
@@ -97,13 +103,18 @@ private:
 	CameraStereo			mCamera;
 
 	gl::StereoAutoFocuser	mAF;
+	gl::SinglePassStereo	mStereo;
 
 	gl::GlslProg			mShaderPhong;
 	gl::GlslProg			mShaderAnaglyph;
 	gl::GlslProg			mShaderInterlaced;
+	gl::GlslProg			mShaderPhongStereo;
+	gl::GlslProg			mShaderFlatStereo;
 
 	gl::VboMesh				mMeshTrombone;
 	gl::VboMesh				mMeshNote;
+	gl::VboMesh				mMeshGrid;
+	gl::VboMesh				mMeshFloor;
 
 	gl::Fbo					mFbo;
 
@@ -152,6 +163,30 @@ void StereoscopicRenderingApp::setup()
 		
 		mesh.read( loadAsset("models/note.msh") );
 		mMeshNote = gl::VboMesh( mesh ); 
+
+		// the single pass shaders, and the grid and floor as meshes, since they can't be drawn in immediate mode
+		if( gl::SinglePassStereo::isSupported() ) {
+			std::string header = "#version 120\n" + gl::SinglePassStereo::getGlslFunctions();
+			mShaderPhongStereo = gl::GlslProg( ( header + loadString( loadAsset("shaders/phong_stereo_vert.glsl") ) ).c_str(), loadString( loadAsset("shaders/phong_frag.glsl") ).c_str() );
+			mShaderFlatStereo = gl::GlslProg( ( header + loadString( loadAsset("shaders/flat_stereo_vert.glsl") ) ).c_str(), loadString( loadAsset("shaders/flat_frag.glsl") ).c_str() );
+
+			gl::VboMesh::Layout layout;
+			layout.setStaticPositions();
+			std::vector<Vec3f> lines;
+			for(int i=-100; i<=100; ++i) {
+				lines.push_back( Vec3f((float) i, 0, -100) ); lines.push_back( Vec3f((float) i, 0, 100) );
+				lines.push_back( Vec3f(-100, 0, (float) i) ); lines.push_back( Vec3f(100, 0, (float) i) );
+			}
+			mMeshGrid = gl::VboMesh( lines.size(), 0, layout, GL_LINES );
+			mMeshGrid.bufferPositions( lines );
+
+			// the top of the floor cube drawn by render(), which is all of it the camera sees
+			std::vector<Vec3f> quad;
+			quad.push_back( Vec3f(-100, 0, -100) ); quad.push_back( Vec3f(100, 0, -100) );
+			quad.push_back( Vec3f(100, 0, 100) ); quad.push_back( Vec3f(-100, 0, 100) );
+			mMeshFloor = gl::VboMesh( quad.size(), 0, layout, GL_QUADS );
+			mMeshFloor.bufferPositions( quad );
+		}
 	}
 	catch( const std::exception &e ) {
 		// something went wrong, display error and quit
@@ -204,6 +239,7 @@ void StereoscopicRenderingApp::update()
 		case MONO:
 			break;
 		case SIDE_BY_SIDE:
+		case SIDE_BY_SIDE_SINGLE_PASS:
 			// sample half the left eye, half the right eye
 			area = gl::getViewport();
 			area.expand( -area.getWidth()/4, 0 );
@@ -249,6 +285,9 @@ void StereoscopicRenderingApp::draw()
 	case INTERLACED_HORIZONTAL:
 		renderInterlacedHorizontal( getWindowSize() );
 		break;
+	case SIDE_BY_SIDE_SINGLE_PASS:
+		renderSideBySideSinglePass( getWindowSize() );
+		break;
 	}
 
 	// draw auto focus visualizer
@@ -345,6 +384,12 @@ void StereoscopicRenderingApp::keyDown( KeyEvent event )
 		mRenderMethod = INTERLACED_HORIZONTAL;
 		createFbo();
 		break;
+	case KeyEvent::KEY_F6:
+		if( mShaderPhongStereo && mShaderFlatStereo ) {
+			mRenderMethod = SIDE_BY_SIDE_SINGLE_PASS;
+			createFbo();
+		}
+		break;
 	}
 }
 
@@ -479,6 +524,24 @@ void StereoscopicRenderingApp::renderInterlacedHorizontal( const Vec2i &size )
 	mShaderInterlaced.unbind();
 }
 
+void StereoscopicRenderingApp::renderSideBySideSinglePass( const Vec2i &size )
+{
+	// draw the scene once, with each draw broadcast to the left and right half of the window
+	mStereo.begin( mCamera, Area(0, 0, size.x, size.y) );
+	renderSinglePass();
+	mStereo.end();
+
+	// the interface is drawn the usual way, once per half
+	if( mDrawUI ) {
+		glPushAttrib( GL_VIEWPORT_BIT );
+		gl::setViewport( Area(0, 0, size.x / 2, size.y) );
+		renderUI();
+		gl::setViewport( Area(size.x / 2, 0, size.x, size.y) );
+		renderUI();
+		glPopAttrib();
+	}
+}
+
 void StereoscopicRenderingApp::render()
 {	
 	float seconds = (float) getElapsedSeconds();
@@ -563,6 +626,81 @@ void StereoscopicRenderingApp::render()
 	if( mDrawUI ) renderUI();
 }
 
+void StereoscopicRenderingApp::renderSinglePass()
+{
+	// the same scene as render(), drawn with mStereo, which has already set up both eyes
+	float seconds = (float) getElapsedSeconds();
+
+	// enable 3D rendering
+	gl::enableDepthRead();
+	gl::enableDepthWrite();
+
+	if( mMeshTrombone && mMeshNote ) {
+		// enable phong shading
+		mShaderPhongStereo.bind();
+		mStereo.setUniforms( mShaderPhongStereo );
+
+		// draw trombone
+		gl::pushModelView();
+		{
+			gl::color( Color(0.7f, 0.6f, 0.0f) );
+			gl::rotate( Vec3f::yAxis() * 10.0f * seconds );
+			mStereo.draw( mMeshTrombone );
+
+			// reflection
+			gl::scale( 1.0f, -1.0f, 1.0f );
+			mStereo.draw( mMeshTrombone );
+		}
+		gl::popModelView();	
+
+		// draw animated notes
+		Rand rnd;
+		for(int i=-100; i<=100; ++i) {
+			rnd.seed(i);
+
+			float t = rnd.nextFloat() * 200.0f + 2.0f * seconds;
+			float r = rnd.nextFloat() * 360.0f + 60.0f * seconds;
+			float z = fmodf( 5.0f * t, 200.0f ) - 100.0f;		
+
+			gl::color( Color( CM_HSV, rnd.nextFloat(), 1.0f, 1.0f ) );
+
+			gl::pushModelView();
+			gl::translate( i * 0.5f, 0.15f + 1.0f * math<float>::abs( sinf(3.0f * t) ), -z );
+			gl::rotate( Vec3f::yAxis() * r );
+			mStereo.draw( mMeshNote );
+			gl::popModelView();
+			
+			// reflection
+			gl::pushModelView();
+			gl::scale( 1.0f, -1.0f, 1.0f );
+			gl::translate( i * 0.5f, 0.15f + 1.0f * math<float>::abs( sinf(3.0f * t) ), -z );
+			gl::rotate( Vec3f::yAxis() * r );
+			mStereo.draw( mMeshNote );
+			gl::popModelView();
+		}
+
+		mShaderPhongStereo.unbind();
+	}
+
+	mShaderFlatStereo.bind();
+	mStereo.setUniforms( mShaderFlatStereo );
+
+	// draw grid
+	gl::color( Color(0.8f, 0.8f, 0.8f) );
+	mStereo.draw( mMeshGrid );
+
+	// draw floor
+	gl::enableAlphaBlending();
+	gl::color( ColorA(1,1,1,0.75f) );
+	mStereo.draw( mMeshFloor );
+	gl::disableAlphaBlending();
+
+	mShaderFlatStereo.unbind();
+
+	gl::disableDepthWrite();
+	gl::disableDepthRead();
+}
+
 void StereoscopicRenderingApp::renderUI()
 {   
     float w = (float) getWindowWidth() * 0.5f;
@@ -575,6 +713,7 @@ void StereoscopicRenderingApp::renderUI()
 		case OVER_UNDER: renderMode = "Over Under"; break;
 		case ANAGLYPH_RED_CYAN: renderMode = "Anaglyph Red Cyan"; break;
 		case INTERLACED_HORIZONTAL: renderMode = "Interlaced Horizontal"; break;
+		case SIDE_BY_SIDE_SINGLE_PASS: renderMode = "Side By Side (Single Pass)"; break;
 	}
 	switch(mFocusMethod) {
 		case SET_CONVERGENCE: focusMode = "setConvergence(d, false)"; break;
@@ -582,7 +721,7 @@ void StereoscopicRenderingApp::renderUI()
 		case AUTO_FOCUS: focusMode = "autoFocus(cam)"; break;
 	}
 
-    std::string labels( "Render mode (F1-F5):\nFocus mode (1-3):\nFocal Length:\nEye Distance:\nAuto Focus Depth (Up/Down):\nAuto Focus Speed (Left/Right):" );
+    std::string labels( "Render mode (F1-F6):\nFocus mode (1-3):\nFocal Length:\nEye Distance:\nAuto Focus Depth (Up/Down):\nAuto Focus Speed (Left/Right):" );
     boost::format values = boost::format( "%s\n%s\n%.2f\n%.2f\n%.2f\n%.2f" ) % renderMode % focusMode % mCamera.getConvergence() % mCamera.getEyeSeparation() % mAF.getDepth() % mAF.getSpeed();
 
 #if(defined CINDER_MSW)
@@ -61,19 +61,15 @@ Tube& Tube::operator=( const Tube& rhs )
 
 void Tube::sampleCurve()
 {
-	mPs.clear();
-	mTs.clear();
+	mPs.resize( mNumSegs );
+	mTs.resize( mNumSegs );
+	if( mNumSegs <= 0 )
+		return;
 
 	float dt = 1.0f/(float)mNumSegs;
-	for( int i = 0; i < mNumSegs; ++i ) {
-		float t = i*dt;
-	
-		Vec3f P = mBSpline.getPosition( t );
-		mPs.push_back( P );
-		
-		Vec3f T = mBSpline.getDerivative( t );
-		mTs.push_back( T.normalized() );
-	}
+	mBSpline.sampleUniform( 0, ( mNumSegs - 1 )*dt, mNumSegs, &mPs[0], &mTs[0] );
+	for( int i = 0; i < mNumSegs; ++i )
+		mTs[i].normalize();
 }
 
 void Tube::buildPTF() 
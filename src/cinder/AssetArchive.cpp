@@ -0,0 +1,298 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/AssetArchive.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+// Layout, all integers little endian:
+//	header:		"CIAR", uint32 version, 8 reserved bytes
+//	payloads:	each aligned to Format::getAlignment()
+//	index:		per entry uint64 hash, uint64 offset, uint64 stored size, uint64 size, uint32 name offset, uint16 name length, uint16 flags; sorted by hash
+//	names:		entry names, not null terminated
+//	trailer:	uint64 index offset, uint32 entry count, "CIAR"
+namespace {
+
+const char		ARCHIVE_MAGIC[4] = { 'C', 'I', 'A', 'R' };
+const uint32_t	ARCHIVE_VERSION = 1;
+const size_t	HEADER_SIZE = 16;
+const size_t	TRAILER_SIZE = 16;
+const size_t	INDEX_RECORD_SIZE = 40;
+const uint16_t	ENTRY_COMPRESSED = 1;
+
+// entries are always named with forward slashes and without a leading "./"
+string normalizeName( const fs::path &path )
+{
+	string result = path.generic_string();
+	while( result.size() >= 2 && result[0] == '.' && result[1] == '/' )
+		result.erase( 0, 2 );
+	return result;
+}
+
+// 64-bit FNV-1a
+uint64_t hashName( const char *name, size_t length )
+{
+	uint64_t result = 14695981039346656037ULL;
+	for( size_t i = 0; i < length; ++i ) {
+		result ^= (uint8_t)name[i];
+		result *= 1099511628211ULL;
+	}
+	return result;
+}
+
+struct WriteRecord {
+	uint64_t	mHash, mOffset, mStoredSize, mSize;
+	string		mName;
+	uint16_t	mFlags;
+
+	bool operator<( const WriteRecord &rhs ) const { return ( mHash < rhs.mHash ) || ( mHash == rhs.mHash && mName < rhs.mName ); }
+};
+
+// Stream only supports up to 32-bit integers, so 64-bit values are stored as low and high words
+void writeUint64( const OStreamRef &stream, uint64_t value )
+{
+	stream->writeLittle( (uint32_t)( value & 0xFFFFFFFF ) );
+	stream->writeLittle( (uint32_t)( value >> 32 ) );
+}
+
+uint64_t readUint64( const IStreamRef &stream )
+{
+	uint32_t low, high;
+	stream->readLittle( &low );
+	stream->readLittle( &high );
+	return ( (uint64_t)high << 32 ) | low;
+}
+
+void writePadding( const OStreamRef &stream, size_t alignment )
+{
+	const uint8_t zero = 0;
+	while( (size_t)stream->tell() % alignment )
+		stream->writeData( &zero, 1 );
+}
+
+} // anonymous namespace
+
+AssetArchiveRef AssetArchive::create( const fs::path &path )
+{
+	return AssetArchiveRef( new AssetArchive( path ) );
+}
+
+AssetArchive::AssetArchive( const fs::path &path )
+	: mFilePath( path )
+{
+	mMappedFile = MemoryMappedFile::create( path, HEADER_SIZE + TRAILER_SIZE );
+	if( ! mMappedFile )
+		throw AssetArchiveExc( "Unable to map asset archive: " + path.string() );
+
+	const uint8_t *data = static_cast<const uint8_t*>( mMappedFile->getData() );
+	const size_t size = mMappedFile->getSize();
+
+	IStreamMemRef header = IStreamMem::create( data, HEADER_SIZE );
+	char magic[4];
+	uint32_t version;
+	header->readData( magic, 4 );
+	header->readLittle( &version );
+	if( memcmp( magic, ARCHIVE_MAGIC, 4 ) || version != ARCHIVE_VERSION )
+		throw AssetArchiveExc( "Not a supported asset archive: " + path.string() );
+
+	IStreamMemRef trailer = IStreamMem::create( data + size - TRAILER_SIZE, TRAILER_SIZE );
+	const uint64_t indexOffset = readUint64( trailer );
+	uint32_t numEntries;
+	trailer->readLittle( &numEntries );
+	trailer->readData( magic, 4 );
+	if( memcmp( magic, ARCHIVE_MAGIC, 4 ) || indexOffset < HEADER_SIZE || indexOffset > size - TRAILER_SIZE )
+		throw AssetArchiveExc( "Corrupt asset archive index: " + path.string() );
+	const uint64_t namesOffset = indexOffset + (uint64_t)numEntries * INDEX_RECORD_SIZE;
+	if( namesOffset > size - TRAILER_SIZE )
+		throw AssetArchiveExc( "Corrupt asset archive index: " + path.string() );
+
+	IStreamMemRef index = IStreamMem::create( data + indexOffset, (size_t)( namesOffset - indexOffset ) );
+	mEntries.resize( numEntries );
+	for( vector<Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+		uint32_t nameOffset;
+		uint16_t nameLength, flags;
+		entryIt->mHash = readUint64( index );
+		entryIt->mOffset = readUint64( index );
+		entryIt->mStoredSize = readUint64( index );
+		entryIt->mSize = readUint64( index );
+		index->readLittle( &nameOffset );
+		index->readLittle( &nameLength );
+		index->readLittle( &flags );
+		if( entryIt->mOffset < HEADER_SIZE || entryIt->mOffset > indexOffset || entryIt->mStoredSize > indexOffset - entryIt->mOffset || namesOffset + nameOffset + nameLength > size - TRAILER_SIZE )
+			throw AssetArchiveExc( "Corrupt asset archive entry: " + path.string() );
+		entryIt->mName = reinterpret_cast<const char*>( data + namesOffset + nameOffset );
+		entryIt->mNameLength = nameLength;
+		entryIt->mFlags = flags;
+	}
+}
+
+const AssetArchive::Entry* AssetArchive::findEntry( const fs::path &relativePath ) const
+{
+	const string name = normalizeName( relativePath );
+	const uint64_t hash = hashName( name.c_str(), name.size() );
+
+	vector<Entry>::const_iterator entryIt = lower_bound( mEntries.begin(), mEntries.end(), hash, []( const Entry &entry, uint64_t h ) { return entry.mHash < h; } );
+	for( ; entryIt != mEntries.end() && entryIt->mHash == hash; ++entryIt ) {
+		if( entryIt->mNameLength == name.size() && ! memcmp( entryIt->mName, name.c_str(), name.size() ) )
+			return &*entryIt;
+	}
+
+	return 0;
+}
+
+DataSourceRef AssetArchive::load( const fs::path &relativePath ) const
+{
+	const Entry *entry = findEntry( relativePath );
+	if( ! entry )
+		throw AssetArchiveExc( "No entry named " + relativePath.string() + " in asset archive " + mFilePath.string() );
+
+	uint8_t *data = static_cast<uint8_t*>( mMappedFile->getData() ) + entry->mOffset;
+	if( entry->mFlags & ENTRY_COMPRESSED ) {
+		Buffer buffer( (size_t)entry->mSize );
+		uLongf size = (uLongf)entry->mSize;
+		if( uncompress( (Bytef*)buffer.getData(), &size, (const Bytef*)data, (uLong)entry->mStoredSize ) != Z_OK || size != entry->mSize )
+			throw AssetArchiveExc( "Failed to decompress " + relativePath.string() + " in asset archive " + mFilePath.string() );
+		return DataSourceBuffer::create( buffer, relativePath );
+	}
+
+	// zero-copy, the Buffer keeps the mapping alive
+	return DataSourceBuffer::create( Buffer( data, (size_t)entry->mSize, mMappedFile ), relativePath );
+}
+
+void AssetArchive::write( const DataTargetRef &target, const fs::path &directory, const Format &format )
+{
+	if( ! fs::is_directory( directory ) )
+		throw AssetArchiveExc( "Not a directory: " + directory.string() );
+
+	vector<pair<fs::path, DataSourceRef> > entries;
+	for( fs::recursive_directory_iterator it( directory ), end; it != end; ++it ) {
+		if( ! fs::is_regular_file( it->status() ) )
+			continue;
+
+		// strip the directory prefix to form the entry's relative name, skipping anything within a hidden file or directory
+		fs::path relativePath;
+		bool hidden = false;
+		fs::path::const_iterator dirIt = directory.begin(), pathIt = it->path().begin();
+		for( ; dirIt != directory.end() && pathIt != it->path().end() && *dirIt == *pathIt; ++dirIt, ++pathIt )
+			;
+		for( ; pathIt != it->path().end(); ++pathIt ) {
+			const string component = pathIt->string();
+			hidden = hidden || ( ! component.empty() && component[0] == '.' );
+			relativePath /= *pathIt;
+		}
+		if( hidden )
+			continue;
+		entries.push_back( make_pair( relativePath, DataSourceRef( DataSourcePath::create( it->path() ) ) ) );
+	}
+
+	// deterministic output regardless of directory enumeration order
+	sort( entries.begin(), entries.end(), []( const pair<fs::path, DataSourceRef> &a, const pair<fs::path, DataSourceRef> &b ) { return a.first.generic_string() < b.first.generic_string(); } );
+	write( target, entries, format );
+}
+
+void AssetArchive::write( const DataTargetRef &target, const vector<pair<fs::path, DataSourceRef> > &entries, const Format &format )
+{
+	const size_t alignment = std::max<size_t>( format.getAlignment(), 1 );
+	if( alignment & ( alignment - 1 ) )
+		throw AssetArchiveExc( "Asset archive alignment must be a power of two" );
+
+	OStreamRef stream = target->getStream();
+	if( ! stream )
+		throw AssetArchiveExc( "Unable to open asset archive for writing" );
+
+	stream->writeData( ARCHIVE_MAGIC, 4 );
+	stream->writeLittle( ARCHIVE_VERSION );
+	writeUint64( stream, 0 );
+
+	vector<WriteRecord> records;
+	records.reserve( entries.size() );
+	for( vector<pair<fs::path, DataSourceRef> >::const_iterator entryIt = entries.begin(); entryIt != entries.end(); ++entryIt ) {
+		WriteRecord record;
+		record.mName = normalizeName( entryIt->first );
+		record.mHash = hashName( record.mName.c_str(), record.mName.size() );
+		record.mFlags = 0;
+		if( record.mName.empty() || record.mName.size() > 0xFFFF )
+			throw AssetArchiveExc( "Invalid asset archive entry name: " + record.mName );
+
+		// read through a stream rather than getBuffer() so that the DataSource doesn't retain the contents
+		Buffer data = loadStreamBuffer( entryIt->second->createStream() );
+		record.mSize = data.getDataSize();
+		if( format.getCompressionLevel() > 0 && record.mSize > 0 ) {
+			Buffer compressed = compressBuffer( data, (int8_t)format.getCompressionLevel() );
+			if( compressed.getDataSize() < record.mSize * format.getMinCompressionRatio() ) {
+				data = compressed;
+				record.mFlags |= ENTRY_COMPRESSED;
+			}
+		}
+		record.mStoredSize = data.getDataSize();
+
+		writePadding( stream, alignment );
+		record.mOffset = (uint64_t)stream->tell();
+		if( record.mStoredSize > 0 )
+			stream->writeData( data.getData(), data.getDataSize() );
+		records.push_back( record );
+	}
+
+	sort( records.begin(), records.end() );
+	for( size_t i = 1; i < records.size(); ++i ) {
+		if( records[i].mHash == records[i-1].mHash && records[i].mName == records[i-1].mName )
+			throw AssetArchiveExc( "Duplicate asset archive entry: " + records[i].mName );
+	}
+
+	writePadding( stream, 8 );
+	const uint64_t indexOffset = (uint64_t)stream->tell();
+	uint32_t nameOffset = 0;
+	for( vector<WriteRecord>::const_iterator recordIt = records.begin(); recordIt != records.end(); ++recordIt ) {
+		writeUint64( stream, recordIt->mHash );
+		writeUint64( stream, recordIt->mOffset );
+		writeUint64( stream, recordIt->mStoredSize );
+		writeUint64( stream, recordIt->mSize );
+		stream->writeLittle( nameOffset );
+		stream->writeLittle( (uint16_t)recordIt->mName.size() );
+		stream->writeLittle( recordIt->mFlags );
+		nameOffset += (uint32_t)recordIt->mName.size();
+	}
+	for( vector<WriteRecord>::const_iterator recordIt = records.begin(); recordIt != records.end(); ++recordIt )
+		stream->writeData( recordIt->mName.c_str(), recordIt->mName.size() );
+
+	writeUint64( stream, indexOffset );
+	stream->writeLittle( (uint32_t)records.size() );
+	stream->writeData( ARCHIVE_MAGIC, 4 );
+}
+
+AssetArchiveExc::AssetArchiveExc( const string &description ) throw()
+{
+#if defined( CINDER_MSW ) || defined( CINDER_WINRT )
+	sprintf_s( mMessage, "%s", description.c_str() );
+#else
+	snprintf( mMessage, sizeof(mMessage), "%s", description.c_str() );
+#endif
+}
+
+} // namespace cinder
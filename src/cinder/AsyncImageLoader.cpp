@@ -0,0 +1,307 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/AsyncImageLoader.h"
+#include "cinder/TaskPool.h"
+#include "cinder/app/App.h"
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+string errorMessageFor( const std::exception &exc )
+{
+	string result = exc.what();
+	return result.empty() ? "Failed to load image." : result;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - AsyncImageRequest
+// ----------------------------------------------------------------------------------------------------
+
+AsyncImageRequest::AsyncImageRequest( const weak_ptr<AsyncImageLoader> &loader, const DataSourceRef &dataSource, int32_t priority )
+	: mLoader( loader ), mDataSource( dataSource ), mUploadTexture( false ), mPriority( priority ), mState( PENDING )
+{
+}
+
+bool AsyncImageRequest::cancel()
+{
+	AsyncImageLoaderRef loader = mLoader.lock();
+	if( ! loader ) {
+		mState = CANCELED;
+		return false;
+	}
+
+	lock_guard<mutex> lock( loader->mMutex );
+	const State state = getState();
+	if( state == PENDING )
+		loader->mQueue.erase( mQueueIt );
+
+	mState = CANCELED;
+	return state == PENDING;
+}
+
+void AsyncImageRequest::setPriority( int32_t priority )
+{
+	AsyncImageLoaderRef loader = mLoader.lock();
+	if( ! loader ) {
+		mPriority = priority;
+		return;
+	}
+
+	lock_guard<mutex> lock( loader->mMutex );
+	if( mPriority == priority )
+		return;
+
+	mPriority = priority;
+	if( getState() == PENDING ) {
+		AsyncImageRequestRef self = mQueueIt->second;
+		loader->mQueue.erase( mQueueIt );
+		mQueueIt = loader->mQueue.insert( make_pair( priority, self ) );
+	}
+}
+
+int32_t AsyncImageRequest::getPriority() const
+{
+	AsyncImageLoaderRef loader = mLoader.lock();
+	if( ! loader )
+		return mPriority;
+
+	lock_guard<mutex> lock( loader->mMutex );
+	return mPriority;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - AsyncImageLoader
+// ----------------------------------------------------------------------------------------------------
+
+// static
+AsyncImageLoaderRef AsyncImageLoader::create( size_t maxConcurrentLoads, TaskPool *taskPool )
+{
+	if( ! taskPool )
+		taskPool = TaskPool::get();
+
+	return AsyncImageLoaderRef( new AsyncImageLoader( maxConcurrentLoads ? maxConcurrentLoads : taskPool->getNumThreads(), taskPool ) );
+}
+
+AsyncImageLoader::AsyncImageLoader( size_t maxConcurrentLoads, TaskPool *taskPool )
+	: mTaskPool( taskPool ), mMaxConcurrentLoads( max<size_t>( 1, maxConcurrentLoads ) ), mNumActiveWorkers( 0 )
+{
+}
+
+AsyncImageRequestRef AsyncImageLoader::load( const DataSourceRef &dataSource, const Callback &callback, int32_t priority, const ImageSource::Options &options )
+{
+	return enqueue( dataSource, callback, priority, options, false, gl::Texture::Format() );
+}
+
+AsyncImageRequestRef AsyncImageLoader::loadAndProcess( const DataSourceRef &dataSource, const ProcessFn &processFn, const Callback &callback, int32_t priority, const ImageSource::Options &options )
+{
+	return enqueue( dataSource, callback, priority, options, false, gl::Texture::Format(), processFn );
+}
+
+AsyncImageRequestRef AsyncImageLoader::loadTexture( const DataSourceRef &dataSource, const Callback &callback, int32_t priority, const gl::Texture::Format &format, const ImageSource::Options &options )
+{
+	return enqueue( dataSource, callback, priority, options, true, format );
+}
+
+AsyncImageRequestRef AsyncImageLoader::enqueue( const DataSourceRef &dataSource, const Callback &callback, int32_t priority, const ImageSource::Options &options, bool uploadTexture, const gl::Texture::Format &format, const ProcessFn &processFn )
+{
+	AsyncImageRequestRef request( new AsyncImageRequest( shared_from_this(), dataSource, priority ) );
+	request->mCallback = callback;
+	request->mOptions = options;
+	request->mUploadTexture = uploadTexture;
+	request->mTextureFormat = format;
+	request->mProcessFn = processFn;
+
+	bool startWorker = false;
+	{
+		lock_guard<mutex> lock( mMutex );
+		request->mQueueIt = mQueue.insert( make_pair( priority, request ) );
+		if( mNumActiveWorkers < mMaxConcurrentLoads ) {
+			++mNumActiveWorkers;
+			startWorker = true;
+		}
+	}
+
+	// workers pull from the queue until it's empty, so the highest priority request is always the next one started
+	if( startWorker ) {
+		AsyncImageLoaderRef self = shared_from_this();
+		mTaskPool->submit( [self] { self->processRequests(); } );
+	}
+
+	return request;
+}
+
+void AsyncImageLoader::processRequests()
+{
+	while( true ) {
+		AsyncImageRequestRef request;
+		{
+			lock_guard<mutex> lock( mMutex );
+			if( mQueue.empty() ) {
+				--mNumActiveWorkers;
+				return;
+			}
+
+			request = mQueue.begin()->second;
+			mQueue.erase( mQueue.begin() );
+			request->mState = AsyncImageRequest::LOADING;
+		}
+
+		AsyncImageLoaderRef self = shared_from_this();
+		auto app = app::App::get();
+
+		// with an App, texture requests skip the Surface: the main thread maps texture memory, which a worker then decodes into
+		if( request->mUploadTexture && app ) {
+			try {
+				ImageSourceRef imageSource = loadImage( request->mDataSource, request->mOptions );
+				app->dispatchAsync( [self, request, imageSource] { self->mapTexture( request, imageSource ); } );
+			}
+			catch( std::exception &exc ) {
+				fail( request, exc );
+				app->dispatchAsync( [self, request] { self->deliver( request ); } );
+			}
+			continue;
+		}
+
+		Surface surface;
+		string errorMessage;
+		try {
+			surface = Surface( loadImage( request->mDataSource, request->mOptions ) );
+			if( request->mProcessFn )
+				surface = request->mProcessFn( surface );
+		}
+		catch( std::exception &exc ) {
+			errorMessage = errorMessageFor( exc );
+		}
+
+		{
+			lock_guard<mutex> lock( mMutex );
+			if( request->getState() == AsyncImageRequest::CANCELED )
+				continue;
+
+			request->mSurface = surface;
+			request->mErrorMessage = errorMessage;
+			// texture requests are COMPLETE once uploaded
+			if( ! errorMessage.empty() )
+				request->mState = AsyncImageRequest::FAILED;
+			else if( ! request->mUploadTexture )
+				request->mState = AsyncImageRequest::COMPLETE;
+		}
+
+		if( app )
+			app->dispatchAsync( [self, request] { self->deliver( request ); } );
+		else
+			deliver( request );
+	}
+}
+
+void AsyncImageLoader::mapTexture( const AsyncImageRequestRef &request, const ImageSourceRef &imageSource )
+{
+	if( request->isCanceled() )
+		return;
+
+	try {
+		request->mTextureTarget = gl::TextureImageTarget::create( imageSource, request->mTextureFormat );
+	}
+	catch( std::exception &exc ) {
+		fail( request, exc );
+		deliver( request );
+		return;
+	}
+
+	AsyncImageLoaderRef self = shared_from_this();
+	mTaskPool->submit( [self, request, imageSource] { self->decodeTexture( request, imageSource ); } );
+}
+
+void AsyncImageLoader::decodeTexture( const AsyncImageRequestRef &request, const ImageSourceRef &imageSource )
+{
+	if( ! request->isCanceled() ) {
+		try {
+			imageSource->load( request->mTextureTarget );
+		}
+		catch( std::exception &exc ) {
+			fail( request, exc );
+		}
+	}
+
+	// delivered even if canceled, since the target has to be released on the main thread
+	AsyncImageLoaderRef self = shared_from_this();
+	app::App::get()->dispatchAsync( [self, request] { self->deliver( request ); } );
+}
+
+void AsyncImageLoader::fail( const AsyncImageRequestRef &request, const std::exception &exc )
+{
+	lock_guard<mutex> lock( mMutex );
+	if( request->isCanceled() )
+		return;
+
+	request->mErrorMessage = errorMessageFor( exc );
+	request->mState = AsyncImageRequest::FAILED;
+}
+
+void AsyncImageLoader::deliver( const AsyncImageRequestRef &request )
+{
+	gl::TextureImageTargetRef textureTarget;
+	textureTarget.swap( request->mTextureTarget );
+	if( request->isCanceled() )
+		return;
+
+	if( request->mUploadTexture && request->getState() == AsyncImageRequest::LOADING ) {
+		try {
+			if( textureTarget )
+				request->mTexture = textureTarget->finish();
+			else
+				request->mTexture = gl::Texture( request->mSurface, request->mTextureFormat );
+			request->mState = AsyncImageRequest::COMPLETE;
+		}
+		catch( std::exception &exc ) {
+			request->mErrorMessage = exc.what();
+			request->mState = AsyncImageRequest::FAILED;
+		}
+		request->mSurface.reset();
+	}
+
+	if( request->mCallback && ! request->isCanceled() )
+		request->mCallback( request );
+}
+
+void AsyncImageLoader::cancelAll()
+{
+	lock_guard<mutex> lock( mMutex );
+	for( AsyncImageRequest::Queue::iterator queueIt = mQueue.begin(); queueIt != mQueue.end(); ++queueIt )
+		queueIt->second->mState = AsyncImageRequest::CANCELED;
+	mQueue.clear();
+}
+
+size_t AsyncImageLoader::getNumPending() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mQueue.size();
+}
+
+} // namespace cinder
@@ -32,6 +32,7 @@
 #include <memory.h>
 #include <assert.h>
 #include <limits>
+#include <algorithm>
 
 #include "cinder/Vector.h"
 
@@ -405,8 +406,64 @@ void BSplineBasis::compute( float fTime, unsigned int uiOrder, int &riMinIndex,
     riMaxIndex = i;
 }
 
+int BSplineBasis::getSpan( float &time, float *spanBegin, float *spanEnd ) const
+{
+	int i = getKey( time );
+	*spanBegin = mKnots[i];
+	*spanEnd = mKnots[i+1];
+	return i;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 // BSpline
+namespace {
+
+// Evaluates the cubic c[0] + c[1]*s + c[2]*s^2 + c[3]*s^3
+template<typename T>
+inline T evalCubic( const T c[4], float s )
+{
+	return c[0] + ( c[1] + ( c[2] + c[3] * s ) * s ) * s;
+}
+
+// Writes the cubic's values at s0, s0 + h, s0 + 2h, ... to \a out. The forward differences are derived from the coefficients
+// rather than from differencing values, and accumulated in double, so that long runs don't drift.
+template<typename T>
+void forwardDifferenceCubic( const T c[4], double s0, double h, size_t count, T *out )
+{
+	typedef typename T::TYPE S;
+	double diffs[4][T::DIM];
+	for( int k = 0; k < T::DIM; ++k ) {
+		const double c0 = (&c[0].x)[k], c1 = (&c[1].x)[k], c2 = (&c[2].x)[k], c3 = (&c[3].x)[k];
+		// the coefficients shifted to s0
+		const double q1 = c1 + s0 * ( 2 * c2 + 3 * c3 * s0 ), q2 = c2 + 3 * c3 * s0;
+		diffs[0][k] = c0 + s0 * ( c1 + s0 * ( c2 + s0 * c3 ) );
+		diffs[1][k] = h * ( q1 + h * ( q2 + h * c3 ) );
+		diffs[2][k] = h * h * ( 2 * q2 + 6 * c3 * h );
+		diffs[3][k] = 6 * c3 * h * h * h;
+	}
+
+	for( size_t j = 0; j < count; ++j ) {
+		S *target = &out[j].x;
+		for( int k = 0; k < T::DIM; ++k ) {
+			target[k] = (S)diffs[0][k];
+			diffs[0][k] += diffs[1][k];
+			diffs[1][k] += diffs[2][k];
+			diffs[2][k] += diffs[3][k];
+		}
+	}
+}
+
+template<typename T>
+void differentiateCubic( const T c[4], T derivative[4] )
+{
+	derivative[0] = c[1];
+	derivative[1] = c[2] * 2.0f;
+	derivative[2] = c[3] * 3.0f;
+	derivative[3] = T::zero();
+}
+
+} // anonymous namespace
+
 template<typename T>
 BSpline<T>::BSpline( const std::vector<T> &points, int degree, bool loop, bool open )
     : mLoop( loop )
@@ -559,6 +616,133 @@ void BSpline<T>::get( float t, T *position, T *firstDerivative, T *secondDerivat
 	}
 }
 
+template<typename T>
+void BSpline<T>::getSpanPolynomial( float spanMid, T coeffs[4] ) const
+{
+	const int degree = mBasis.getDegree();
+	int iMin, iMax;
+	mBasis.compute( spanMid, degree, iMin, iMax );
+
+	for( int k = 0; k < 4; ++k )
+		coeffs[k] = T::zero();
+	for( int i = iMin; i <= iMax; i++ ) {
+		coeffs[0] += mCtrlPoints[i] * mBasis.getD0( i );
+		coeffs[1] += mCtrlPoints[i] * mBasis.getD1( i );
+		if( degree >= 2 )
+			coeffs[2] += mCtrlPoints[i] * ( mBasis.getD2( i ) / 2.0f );
+		if( degree >= 3 )
+			coeffs[3] += mCtrlPoints[i] * ( mBasis.getD3( i ) / 6.0f );
+	}
+}
+
+template<typename T>
+void BSpline<T>::sample( const float *times, size_t count, T *positions, T *derivatives ) const
+{
+	if( mBasis.getDegree() > 3 ) {
+		for( size_t i = 0; i < count; ++i )
+			get( times[i], positions ? &positions[i] : NULL, derivatives ? &derivatives[i] : NULL );
+		return;
+	}
+
+	T coeffs[4], derivCoeffs[4];
+	int span = -1;
+	float spanBegin = 1, spanEnd = 0, spanMid = 0;
+	for( size_t i = 0; i < count; ++i ) {
+		float t = times[i];
+		if( ! ( t >= spanBegin && t < spanEnd ) ) {
+			const int prevSpan = span;
+			span = mBasis.getSpan( t, &spanBegin, &spanEnd );
+			if( span != prevSpan ) {
+				spanMid = ( spanBegin + spanEnd ) * 0.5f;
+				getSpanPolynomial( spanMid, coeffs );
+				differentiateCubic( coeffs, derivCoeffs );
+			}
+		}
+
+		if( positions )
+			positions[i] = evalCubic( coeffs, t - spanMid );
+		if( derivatives )
+			derivatives[i] = evalCubic( derivCoeffs, t - spanMid );
+	}
+}
+
+template<typename T>
+void BSpline<T>::sampleUniform( float t0, float t1, size_t count, T *positions, T *derivatives ) const
+{
+	const double step = ( count > 1 ) ? ( (double)t1 - t0 ) / ( count - 1 ) : 0;
+	if( mBasis.getDegree() > 3 || step <= 0 ) {
+		// a batch of parameters at a time, which sample() still evaluates faster than one by one
+		const size_t BATCH_SIZE = 256;
+		float times[BATCH_SIZE];
+		for( size_t first = 0; first < count; first += BATCH_SIZE ) {
+			const size_t batch = std::min( BATCH_SIZE, count - first );
+			for( size_t i = 0; i < batch; ++i )
+				times[i] = (float)( t0 + ( first + i ) * step );
+			sample( times, batch, positions ? positions + first : NULL, derivatives ? derivatives + first : NULL );
+		}
+		return;
+	}
+
+	T coeffs[4], derivCoeffs[4];
+	size_t i = 0;
+	while( i < count ) {
+		const float rawT = (float)( t0 + i * step );
+		float t = rawT, spanBegin, spanEnd;
+		mBasis.getSpan( t, &spanBegin, &spanEnd );
+		const float spanMid = ( spanBegin + spanEnd ) * 0.5f;
+		getSpanPolynomial( spanMid, coeffs );
+
+		// the run of parameters through the end of this span, unless t was clamped or wrapped out of step with them
+		size_t end = i + 1;
+		if( t == rawT ) {
+			while( end < count && (float)( t0 + end * step ) < spanEnd )
+				++end;
+		}
+
+		if( positions )
+			forwardDifferenceCubic( coeffs, (double)t - spanMid, step, end - i, positions + i );
+		if( derivatives ) {
+			differentiateCubic( coeffs, derivCoeffs );
+			forwardDifferenceCubic( derivCoeffs, (double)t - spanMid, step, end - i, derivatives + i );
+		}
+		i = end;
+	}
+}
+
+template<typename T>
+void BSpline<T>::sampleArcLengthUniform( size_t count, T *positions, T *derivatives, float *times ) const
+{
+	if( count == 0 )
+		return;
+
+	// arc length is tabulated over a dense uniform sampling, which is then inverted by interpolating within the table
+	const size_t tableSize = std::max<size_t>( count * 4, getNumSpans() * 32 ) + 1;
+	std::vector<T> table( tableSize );
+	sampleUniform( 0, 1, tableSize, &table[0] );
+	std::vector<double> lengths( tableSize );
+	lengths[0] = 0;
+	for( size_t i = 1; i < tableSize; ++i )
+		lengths[i] = lengths[i - 1] + ( table[i] - table[i - 1] ).length();
+
+	std::vector<float> sampleTimes;
+	if( ! times ) {
+		sampleTimes.resize( count );
+		times = &sampleTimes[0];
+	}
+
+	size_t segment = 1;
+	for( size_t j = 0; j < count; ++j ) {
+		const double target = ( count > 1 ) ? lengths.back() * j / ( count - 1 ) : 0;
+		while( segment < tableSize - 1 && lengths[segment] < target )
+			++segment;
+		const double segmentLength = lengths[segment] - lengths[segment - 1];
+		const double fraction = ( segmentLength > 0 ) ? constrain( ( target - lengths[segment - 1] ) / segmentLength, 0.0, 1.0 ) : 0.0;
+		times[j] = (float)( ( segment - 1 + fraction ) / ( tableSize - 1 ) );
+	}
+
+	sample( times, count, positions, derivatives );
+}
+
 template<typename T>
 float BSpline<T>::getTime( float length ) const
 {
@@ -36,6 +36,7 @@
 
 #include <string.h>
 #include <assert.h>
+#include <algorithm>
 
 using std::vector;
 
@@ -587,13 +588,163 @@ bool BSplineFit<T>::solveUpper( BandedMatrixd& rkMatrix, double *adControlData )
 template<typename T>
 BSpline<T> fitBSpline( const std::vector<T> &samples, int degree, int outputSamples )
 {
-	BSplineFit<typename T::TYPE> fit( T::DIM, (int)samples.size(), &(samples[0].x), degree, outputSamples );
+	return BSplineFitter<T>( (int)samples.size(), degree, outputSamples ).fit( samples );
+}
+
+//----------------------------------------------------------------------------
 
-	vector<T> points;
-	for( int c = 0; c < fit.getControlQuantity(); ++c ) {
-		points.push_back( ( T( &fit.getControlData()[c * T::DIM] ) ) );
+template<typename T>
+BSplineFitter<T>::BSplineFitter( int numSamples, int degree, int numControlPoints )
+{
+	assert( numSamples >= 2 );
+
+	// the same adjustments BSplineFit makes
+	if( numControlPoints <= degree + 1 ) numControlPoints = degree + 2;
+	if( numControlPoints > numSamples ) numControlPoints = numSamples;
+	degree = constrain( degree, 1, numControlPoints - 1 );
+
+	mNumSamples = numSamples;
+	mDegree = degree;
+	mNumControlPoints = numControlPoints;
+
+	// Each sample is weighed by degree + 1 consecutive basis functions, which are evaluated once here. The normal equations
+	// A^T*A*X = A^T*B are accumulated from them one sample at a time, rather than as the dot products of whole columns.
+	const int width = degree + 1;
+	BSplineFitBasisd basis( numControlPoints, degree );
+	mBasisFirst.resize( numSamples );
+	mBasisWeights.resize( numSamples * width );
+	std::vector<double> normal( numControlPoints * width, 0.0 ); // row i holds columns i - degree through i
+	for( int s = 0; s < numSamples; ++s ) {
+		int iMin, iMax;
+		basis.compute( s / (double)( numSamples - 1 ), iMin, iMax );
+		mBasisFirst[s] = iMin;
+		double *weights = &mBasisWeights[s * width];
+		for( int k = 0; k < width; ++k )
+			weights[k] = basis.getValue( k );
+		for( int row = 0; row < width; ++row ) {
+			for( int col = 0; col <= row; ++col )
+				normal[( iMin + row ) * width + degree - ( row - col )] += weights[row] * weights[col];
+		}
+	}
+
+	// banded Cholesky factorization, L * L^T = A^T*A, with L stored like the normal matrix
+	mFactor.resize( numControlPoints * width );
+	mInvDiagonal.resize( numControlPoints );
+	for( int i = 0; i < numControlPoints; ++i ) {
+		const int jMin = std::max( 0, i - degree );
+		for( int j = jMin; j <= i; ++j ) {
+			double sum = normal[i * width + degree - ( i - j )];
+			for( int k = jMin; k < j; ++k )
+				sum -= mFactor[i * width + degree - ( i - k )] * mFactor[j * width + degree - ( j - k )];
+			if( j < i )
+				mFactor[i * width + degree - ( i - j )] = sum * mInvDiagonal[j];
+			else {
+				assert( sum > 0 );
+				mFactor[i * width + degree] = math<double>::sqrt( sum );
+				mInvDiagonal[i] = 1.0 / mFactor[i * width + degree];
+			}
+		}
 	}
-	return BSpline<T>( points, fit.getDegree(), false, true );
+}
+
+template<typename T>
+BSpline<T> BSplineFitter<T>::fit( const std::vector<T> &samples ) const
+{
+	assert( (int)samples.size() == mNumSamples );
+	return fit( &samples[0] );
+}
+
+template<typename T>
+BSpline<T> BSplineFitter<T>::fit( const T *samples ) const
+{
+	vector<T> points( mNumControlPoints );
+	fit( samples, &points[0] );
+	return BSpline<T>( points, mDegree, false, true );
+}
+
+template<typename T>
+void BSplineFitter<T>::fit( const T *samples, T *controlPoints ) const
+{
+	typedef typename T::TYPE S;
+	const int dim = T::DIM, width = mDegree + 1;
+
+	// A^T*B*SampleData
+	vector<double> solution( mNumControlPoints * dim, 0.0 );
+	for( int s = 0; s < mNumSamples; ++s ) {
+		const S *sample = &samples[s].x;
+		const double *weights = &mBasisWeights[s * width];
+		double *target = &solution[mBasisFirst[s] * dim];
+		for( int k = 0; k < width; ++k, target += dim ) {
+			for( int d = 0; d < dim; ++d )
+				target[d] += weights[k] * sample[d];
+		}
+	}
+
+	// solves L * Y = A^T*B*SampleData, then L^T * X = Y, in place
+	for( int i = 0; i < mNumControlPoints; ++i ) {
+		double *target = &solution[i * dim];
+		for( int k = std::max( 0, i - mDegree ); k < i; ++k ) {
+			const double factor = mFactor[i * width + mDegree - ( i - k )];
+			for( int d = 0; d < dim; ++d )
+				target[d] -= factor * solution[k * dim + d];
+		}
+		for( int d = 0; d < dim; ++d )
+			target[d] *= mInvDiagonal[i];
+	}
+	for( int i = mNumControlPoints - 1; i >= 0; --i ) {
+		double *target = &solution[i * dim];
+		for( int k = i + 1; k <= std::min( mNumControlPoints - 1, i + mDegree ); ++k ) {
+			const double factor = mFactor[k * width + mDegree - ( k - i )];
+			for( int d = 0; d < dim; ++d )
+				target[d] -= factor * solution[k * dim + d];
+		}
+		for( int d = 0; d < dim; ++d )
+			target[d] *= mInvDiagonal[i];
+	}
+
+	for( int c = 0; c < mNumControlPoints; ++c ) {
+		S *target = &controlPoints[c].x;
+		for( int d = 0; d < dim; ++d )
+			target[d] = (S)solution[c * dim + d];
+	}
+
+	// pass through the first and last samples, as BSplineFit does
+	controlPoints[0] = samples[0];
+	controlPoints[mNumControlPoints - 1] = samples[mNumSamples - 1];
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T>
+BSplineWindowFitter<T>::BSplineWindowFitter( int windowSize, int degree, int numControlPoints )
+	: mFitter( windowSize, degree, numControlPoints ), mDegree( degree ), mNumControlPoints( numControlPoints ),
+	mPoints( windowSize * 2 ), mFirst( 0 ), mNumPoints( 0 )
+{
+}
+
+template<typename T>
+void BSplineWindowFitter<T>::addPoint( const T &point )
+{
+	const int windowSize = getWindowSize();
+	if( mNumPoints < windowSize ) {
+		mPoints[mNumPoints] = mPoints[mNumPoints + windowSize] = point;
+		++mNumPoints;
+	}
+	else {
+		// the oldest point's slots receive the newest, which then ends the window that begins one past them
+		mPoints[mFirst] = mPoints[mFirst + windowSize] = point;
+		mFirst = ( mFirst + 1 ) % windowSize;
+	}
+}
+
+template<typename T>
+BSpline<T> BSplineWindowFitter<T>::fit() const
+{
+	assert( mNumPoints >= 2 );
+	if( isFull() )
+		return mFitter.fit( getPoints() );
+	else
+		return BSplineFitter<T>( mNumPoints, mDegree, mNumControlPoints ).fit( getPoints() );
 }
 
 template class BSplineFit<float>;
@@ -605,5 +756,12 @@ template BSpline<Vec2f> fitBSpline( const std::vector<Vec2f> &samples, int degre
 template BSpline<Vec3f> fitBSpline( const std::vector<Vec3f> &samples, int degree, int outputSamples );
 template BSpline<Vec4f> fitBSpline( const std::vector<Vec4f> &samples, int degree, int outputSamples );
 
+template class BSplineFitter<Vec2f>;
+template class BSplineFitter<Vec3f>;
+template class BSplineFitter<Vec4f>;
+template class BSplineWindowFitter<Vec2f>;
+template class BSplineWindowFitter<Vec3f>;
+template class BSplineWindowFitter<Vec4f>;
+
 
 } // namespace cinder
\ No newline at end of file
@@ -21,201 +21,351 @@
  POSSIBILITY OF SUCH DAMAGE.
 */
 
-/* Significant portions of this code come from the public domain libb64 project. For details, see http://sourceforge.net/projects/libb64 */
+/* The original scalar codec came from the public domain libb64 project. For details, see http://sourceforge.net/projects/libb64 */
 
 #include "cinder/Base64.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace {
 
-typedef enum { step_a, step_b, step_c, step_d } base64_decodestep;
+const char sEncoding[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// maps each byte to its 6-bit value, or -1 for characters outside the alphabet (whitespace, padding, etc), which are skipped
+const int8_t sDecoding[256] = {
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,63,
+	52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1,
+	-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,
+	15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,
+	-1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
+	41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+// size of the chunks read from an IStream by the streaming functions; a multiple of 3 so that encoded chunks never need padding
+const size_t STREAM_CHUNK_SIZE = 48 * 1024;
 
-typedef struct {
-	base64_decodestep step;
-	char plainchar;
-} base64_decodestate;
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = ci::System::hasSse2();
+	return sUseSse2;
+}
+
+// translates sixteen 6-bit values into their Base64 characters
+inline __m128i encodeChars_epi8( __m128i idx )
+{
+	__m128i result = _mm_add_epi8( idx, _mm_set1_epi8( 'A' ) );
+	result = _mm_add_epi8( result, _mm_and_si128( _mm_cmpgt_epi8( idx, _mm_set1_epi8( 25 ) ), _mm_set1_epi8( 'a' - 26 - 'A' ) ) );
+	result = _mm_add_epi8( result, _mm_and_si128( _mm_cmpgt_epi8( idx, _mm_set1_epi8( 51 ) ), _mm_set1_epi8( ( '0' - 52 ) - ( 'a' - 26 ) ) ) );
+	result = _mm_add_epi8( result, _mm_and_si128( _mm_cmpgt_epi8( idx, _mm_set1_epi8( 61 ) ), _mm_set1_epi8( ( '+' - 62 ) - ( '0' - 52 ) ) ) );
+	result = _mm_add_epi8( result, _mm_and_si128( _mm_cmpgt_epi8( idx, _mm_set1_epi8( 62 ) ), _mm_set1_epi8( ( '/' - 63 ) - ( '+' - 62 ) ) ) );
+	return result;
+}
+
+inline __m128i inRange_epi8( __m128i c, char lo, char hi )
+{
+	return _mm_and_si128( _mm_cmpgt_epi8( c, _mm_set1_epi8( lo - 1 ) ), _mm_cmplt_epi8( c, _mm_set1_epi8( hi + 1 ) ) );
+}
+#elif defined( CINDER_NEON )
+// translates sixteen 6-bit values into their Base64 characters
+inline uint8x16_t encodeChars_u8( uint8x16_t idx )
+{
+	uint8x16_t result = vaddq_u8( idx, vdupq_n_u8( 'A' ) );
+	result = vaddq_u8( result, vandq_u8( vcgtq_u8( idx, vdupq_n_u8( 25 ) ), vdupq_n_u8( (uint8_t)( 'a' - 26 - 'A' ) ) ) );
+	result = vaddq_u8( result, vandq_u8( vcgtq_u8( idx, vdupq_n_u8( 51 ) ), vdupq_n_u8( (uint8_t)( ( '0' - 52 ) - ( 'a' - 26 ) ) ) ) );
+	result = vaddq_u8( result, vandq_u8( vcgtq_u8( idx, vdupq_n_u8( 61 ) ), vdupq_n_u8( (uint8_t)( ( '+' - 62 ) - ( '0' - 52 ) ) ) ) );
+	result = vaddq_u8( result, vandq_u8( vcgtq_u8( idx, vdupq_n_u8( 62 ) ), vdupq_n_u8( (uint8_t)( ( '/' - 63 ) - ( '+' - 62 ) ) ) ) );
+	return result;
+}
+
+// translates sixteen Base64 characters into their 6-bit values, clearing lanes of \a valid for characters outside the alphabet
+inline uint8x16_t decodeChars_u8( uint8x16_t c, uint8x16_t *valid )
+{
+	uint8x16_t upper = vandq_u8( vcgeq_u8( c, vdupq_n_u8( 'A' ) ), vcleq_u8( c, vdupq_n_u8( 'Z' ) ) );
+	uint8x16_t lower = vandq_u8( vcgeq_u8( c, vdupq_n_u8( 'a' ) ), vcleq_u8( c, vdupq_n_u8( 'z' ) ) );
+	uint8x16_t digit = vandq_u8( vcgeq_u8( c, vdupq_n_u8( '0' ) ), vcleq_u8( c, vdupq_n_u8( '9' ) ) );
+	uint8x16_t plus = vceqq_u8( c, vdupq_n_u8( '+' ) );
+	uint8x16_t slash = vceqq_u8( c, vdupq_n_u8( '/' ) );
+	*valid = vandq_u8( *valid, vorrq_u8( vorrq_u8( upper, lower ), vorrq_u8( digit, vorrq_u8( plus, slash ) ) ) );
 
-int base64_decode_value( char value_in ) {
-	static const char decoding[] = {62,-1,-1,-1,63,52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-2,-1,-1,-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,-1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51};
-	static const char decoding_size = sizeof(decoding);
-	value_in -= 43;
-	if (value_in < 0 || value_in > decoding_size) return -1;
-	return decoding[(int)value_in];
+	uint8x16_t shift = vandq_u8( upper, vdupq_n_u8( (uint8_t)-'A' ) );
+	shift = vorrq_u8( shift, vandq_u8( lower, vdupq_n_u8( (uint8_t)( 26 - 'a' ) ) ) );
+	shift = vorrq_u8( shift, vandq_u8( digit, vdupq_n_u8( (uint8_t)( 52 - '0' ) ) ) );
+	shift = vorrq_u8( shift, vandq_u8( plus, vdupq_n_u8( (uint8_t)( 62 - '+' ) ) ) );
+	shift = vorrq_u8( shift, vandq_u8( slash, vdupq_n_u8( (uint8_t)( 63 - '/' ) ) ) );
+	return vaddq_u8( c, shift );
 }
 
-void base64_init_decodestate( base64_decodestate* state_in )
+inline bool allLanesSet( uint8x16_t v )
 {
-	state_in->step = step_a;
-	state_in->plainchar = 0;
+	uint8x8_t m = vand_u8( vget_low_u8( v ), vget_high_u8( v ) );
+	m = vpmin_u8( m, m );
+	m = vpmin_u8( m, m );
+	m = vpmin_u8( m, m );
+	return vget_lane_u8( m, 0 ) == 0xFF;
 }
+#endif
 
-int base64_decode_block( const char* code_in, const int length_in, char* plaintext_out, base64_decodestate* state_in )
+// Encodes as many of the \a numGroups 3-byte groups at \a src as the SIMD paths can, returning the number of groups handled.
+size_t encodeGroupsSimd( const uint8_t *src, size_t numGroups, char *dst )
 {
-	const char* codechar = code_in;
-	char* plainchar = plaintext_out;
-	char fragment;
-	
-	*plainchar = state_in->plainchar;
-	
-	switch (state_in->step)
-	{
-		while (1)
-		{
-	case step_a:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_a;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar    = (fragment & 0x03f) << 2;
-	case step_b:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_b;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++ |= (fragment & 0x030) >> 4;
-			*plainchar    = (fragment & 0x00f) << 4;
-	case step_c:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_c;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++ |= (fragment & 0x03c) >> 2;
-			*plainchar    = (fragment & 0x003) << 6;
-	case step_d:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_d;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++   |= (fragment & 0x03f);
+	size_t g = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	const __m128i mask0 = _mm_set1_epi32( 0x0000003F ), mask1 = _mm_set1_epi32( 0x00003F00 );
+	const __m128i mask2 = _mm_set1_epi32( 0x003F0000 ), mask3 = _mm_set1_epi32( 0x3F000000 );
+	for( ; g + 4 <= numGroups; g += 4, src += 12, dst += 16 ) {
+		// each 32-bit lane holds one group as a 24-bit big endian value; split it into four 6-bit values, one per byte in output order
+		__m128i v = _mm_setr_epi32( ( src[0] << 16 ) | ( src[1] << 8 ) | src[2], ( src[3] << 16 ) | ( src[4] << 8 ) | src[5],
+									( src[6] << 16 ) | ( src[7] << 8 ) | src[8], ( src[9] << 16 ) | ( src[10] << 8 ) | src[11] );
+		__m128i idx = _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_srli_epi32( v, 18 ), mask0 ), _mm_and_si128( _mm_srli_epi32( v, 4 ), mask1 ) ),
+									_mm_or_si128( _mm_and_si128( _mm_slli_epi32( v, 10 ), mask2 ), _mm_and_si128( _mm_slli_epi32( v, 24 ), mask3 ) ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), encodeChars_epi8( idx ) );
+	}
+#elif defined( CINDER_NEON )
+	for( ; g + 16 <= numGroups; g += 16, src += 48, dst += 64 ) {
+		uint8x16x3_t in = vld3q_u8( src );
+		uint8x16x4_t out;
+		out.val[0] = encodeChars_u8( vshrq_n_u8( in.val[0], 2 ) );
+		out.val[1] = encodeChars_u8( vorrq_u8( vshlq_n_u8( vandq_u8( in.val[0], vdupq_n_u8( 0x03 ) ), 4 ), vshrq_n_u8( in.val[1], 4 ) ) );
+		out.val[2] = encodeChars_u8( vorrq_u8( vshlq_n_u8( vandq_u8( in.val[1], vdupq_n_u8( 0x0F ) ), 2 ), vshrq_n_u8( in.val[2], 6 ) ) );
+		out.val[3] = encodeChars_u8( vandq_u8( in.val[2], vdupq_n_u8( 0x3F ) ) );
+		vst4q_u8( reinterpret_cast<uint8_t*>( dst ), out );
+	}
+#endif
+	return g;
+}
+
+// Encodes \a numGroups complete 3-byte groups without line breaks, writing 4 characters per group to \a dst
+void encodeGroups( const uint8_t *src, size_t numGroups, char *dst )
+{
+	size_t g = encodeGroupsSimd( src, numGroups, dst );
+	src += g * 3;
+	dst += g * 4;
+	for( ; g < numGroups; ++g, src += 3, dst += 4 ) {
+		uint32_t v = ( src[0] << 16 ) | ( src[1] << 8 ) | src[2];
+		dst[0] = sEncoding[v >> 18];
+		dst[1] = sEncoding[( v >> 12 ) & 0x3F];
+		dst[2] = sEncoding[( v >> 6 ) & 0x3F];
+		dst[3] = sEncoding[v & 0x3F];
+	}
+}
+
+// Decodes as many complete 4-character groups at \a src as the SIMD paths can, stopping at the first block containing a character outside of the alphabet. Returns the number of characters consumed; 3 bytes per 4 characters are written to \a dst.
+size_t decodeCharsSimd( const uint8_t *src, size_t size, uint8_t *dst )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	for( ; i + 16 <= size; i += 16, dst += 12 ) {
+		__m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		__m128i upper = inRange_epi8( c, 'A', 'Z' ), lower = inRange_epi8( c, 'a', 'z' ), digit = inRange_epi8( c, '0', '9' );
+		__m128i plus = _mm_cmpeq_epi8( c, _mm_set1_epi8( '+' ) ), slash = _mm_cmpeq_epi8( c, _mm_set1_epi8( '/' ) );
+		__m128i valid = _mm_or_si128( _mm_or_si128( upper, lower ), _mm_or_si128( digit, _mm_or_si128( plus, slash ) ) );
+		if( _mm_movemask_epi8( valid ) != 0xFFFF )
+			break;
+
+		__m128i shift = _mm_and_si128( upper, _mm_set1_epi8( -'A' ) );
+		shift = _mm_or_si128( shift, _mm_and_si128( lower, _mm_set1_epi8( 26 - 'a' ) ) );
+		shift = _mm_or_si128( shift, _mm_and_si128( digit, _mm_set1_epi8( 52 - '0' ) ) );
+		shift = _mm_or_si128( shift, _mm_and_si128( plus, _mm_set1_epi8( 62 - '+' ) ) );
+		shift = _mm_or_si128( shift, _mm_and_si128( slash, _mm_set1_epi8( 63 - '/' ) ) );
+		__m128i sextets = _mm_add_epi8( c, shift );
+		// merge pairs of 6-bit values into 12 bits, then pairs of those into one 24-bit group per 32-bit lane
+		__m128i pairs = _mm_or_si128( _mm_slli_epi16( _mm_and_si128( sextets, _mm_set1_epi16( 0x00FF ) ), 6 ), _mm_srli_epi16( sextets, 8 ) );
+		__m128i groups = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( pairs, _mm_set1_epi32( 0xFFFF ) ), 12 ), _mm_srli_epi32( pairs, 16 ) );
+		uint32_t g[4];
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( g ), groups );
+		for( int j = 0; j < 4; ++j ) {
+			dst[j * 3 + 0] = (uint8_t)( g[j] >> 16 );
+			dst[j * 3 + 1] = (uint8_t)( g[j] >> 8 );
+			dst[j * 3 + 2] = (uint8_t)g[j];
 		}
 	}
-	/* control should not reach here */
-	return plainchar - plaintext_out;
+#elif defined( CINDER_NEON )
+	for( ; i + 64 <= size; i += 64, dst += 48 ) {
+		uint8x16x4_t in = vld4q_u8( src + i );
+		uint8x16_t valid = vdupq_n_u8( 0xFF );
+		uint8x16_t s0 = decodeChars_u8( in.val[0], &valid ), s1 = decodeChars_u8( in.val[1], &valid );
+		uint8x16_t s2 = decodeChars_u8( in.val[2], &valid ), s3 = decodeChars_u8( in.val[3], &valid );
+		if( ! allLanesSet( valid ) )
+			break;
+		uint8x16x3_t out;
+		out.val[0] = vorrq_u8( vshlq_n_u8( s0, 2 ), vshrq_n_u8( s1, 4 ) );
+		out.val[1] = vorrq_u8( vshlq_n_u8( s1, 4 ), vshrq_n_u8( s2, 2 ) );
+		out.val[2] = vorrq_u8( vshlq_n_u8( s2, 6 ), s3 );
+		vst3q_u8( dst, out );
+	}
+#endif
+	return i;
 }
 
+#if defined( CINDER_NEON )
+const size_t DECODE_SIMD_BLOCK_SIZE = 64;
+#else
+const size_t DECODE_SIMD_BLOCK_SIZE = 16;
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // encode
-typedef enum { step_A, step_B, step_C } base64_encodestep;
+struct EncodeState {
+	EncodeState( int charsPerLine )
+		: mNumPending( 0 ), mGroupsPerLine( charsPerLine >= 4 ? charsPerLine / 4 : 0 ), mLineGroups( 0 )
+	{}
 
-typedef struct {
-	base64_encodestep step;
-	char result;
-	int stepcount;
-} base64_encodestate;
+	uint8_t		mPending[3];	// bytes of an incomplete group left over from the previous block
+	int			mNumPending;
+	size_t		mGroupsPerLine;	// 0 disables line breaks
+	size_t		mLineGroups;	// groups written to the current line
+};
 
-void base64_init_encodestate( base64_encodestate* state_in )
+// Returns an upper bound on the number of characters encodeBlock() and encodeBlockEnd() together write for \a inputSize bytes
+size_t encodedSizeBound( size_t inputSize, const EncodeState &state )
 {
-	state_in->step = step_A;
-	state_in->result = 0;
-	state_in->stepcount = 0;
+	size_t groups = ( inputSize + state.mNumPending + 2 ) / 3;
+	size_t lines = state.mGroupsPerLine ? ( groups / state.mGroupsPerLine + 1 ) : 0;
+	return groups * 4 + lines;
 }
 
-char base64_encode_value(char value_in)
+// Writes \a numGroups complete groups, inserting a newline after every full line. Returns the end of the output.
+char* encodeLines( const uint8_t *src, size_t numGroups, char *dst, EncodeState *state )
 {
-	static const char* encoding = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-	if (value_in > 63) return '=';
-	return encoding[(int)value_in];
+	while( numGroups > 0 ) {
+		size_t n = numGroups;
+		if( state->mGroupsPerLine )
+			n = std::min( n, state->mGroupsPerLine - state->mLineGroups );
+		encodeGroups( src, n, dst );
+		src += n * 3;
+		dst += n * 4;
+		numGroups -= n;
+		if( state->mGroupsPerLine && ( state->mLineGroups += n ) == state->mGroupsPerLine ) {
+			*dst++ = '\n';
+			state->mLineGroups = 0;
+		}
+	}
+	return dst;
 }
 
-int base64_encode_block(const char* plaintext_in, int length_in, char* code_out, base64_encodestate* state_in, int charsPerLine )
+// Encodes \a size bytes, holding back any trailing partial group for the next call. Returns the number of characters written.
+size_t encodeBlock( const uint8_t *src, size_t size, char *dst, EncodeState *state )
 {
-	const char* plainchar = plaintext_in;
-	const char* const plaintextend = plaintext_in + length_in;
-	char* codechar = code_out;
-	char result;
-	char fragment;
-	
-	result = state_in->result;
-	
-	switch (state_in->step)
-	{
-		while (1)
-		{
-	case step_A:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_A;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result = (fragment & 0x0fc) >> 2;
-			*codechar++ = base64_encode_value(result);
-			result = (fragment & 0x003) << 4;
-	case step_B:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_B;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result |= (fragment & 0x0f0) >> 4;
-			*codechar++ = base64_encode_value(result);
-			result = (fragment & 0x00f) << 2;
-	case step_C:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_C;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result |= (fragment & 0x0c0) >> 6;
-			*codechar++ = base64_encode_value(result);
-			result  = (fragment & 0x03f) >> 0;
-			*codechar++ = base64_encode_value(result);
-			
-			++(state_in->stepcount);
-			if ( ( charsPerLine != 0 ) && ( state_in->stepcount == charsPerLine/4 ) )
-			{
-				*codechar++ = '\n';
-				state_in->stepcount = 0;
+	char *out = dst;
+	if( state->mNumPending > 0 ) {
+		while( state->mNumPending < 3 && size > 0 ) {
+			state->mPending[state->mNumPending++] = *src++;
+			--size;
+		}
+		if( state->mNumPending < 3 )
+			return 0;
+		out = encodeLines( state->mPending, 1, out, state );
+		state->mNumPending = 0;
+	}
+
+	size_t numGroups = size / 3;
+	out = encodeLines( src, numGroups, out, state );
+	src += numGroups * 3;
+	size -= numGroups * 3;
+
+	for( ; size > 0; --size )
+		state->mPending[state->mNumPending++] = *src++;
+	return out - dst;
+}
+
+// Encodes the final partial group, if any, with padding. Returns the number of characters written.
+size_t encodeBlockEnd( char *dst, EncodeState *state )
+{
+	char *out = dst;
+	if( state->mNumPending == 1 ) {
+		*out++ = sEncoding[state->mPending[0] >> 2];
+		*out++ = sEncoding[( state->mPending[0] & 0x03 ) << 4];
+		*out++ = '=';
+		*out++ = '=';
+	}
+	else if( state->mNumPending == 2 ) {
+		*out++ = sEncoding[state->mPending[0] >> 2];
+		*out++ = sEncoding[( ( state->mPending[0] & 0x03 ) << 4 ) | ( state->mPending[1] >> 4 )];
+		*out++ = sEncoding[( state->mPending[1] & 0x0F ) << 2];
+		*out++ = '=';
+	}
+	state->mNumPending = 0;
+	return out - dst;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// decode
+struct DecodeState {
+	DecodeState() : mBits( 0 ), mNumPending( 0 ) {}
+
+	uint32_t	mBits;			// 6-bit values of an incomplete group left over from the previous block
+	int			mNumPending;
+};
+
+// Returns an upper bound on the number of bytes decodeBlock() and decodeBlockEnd() together write for \a inputSize characters
+size_t decodedSizeBound( size_t inputSize )
+{
+	return inputSize / 4 * 3 + 3;
+}
+
+// Decodes \a size characters, skipping any outside of the alphabet and holding back a trailing partial group for the next call. Returns the number of bytes written.
+size_t decodeBlock( const uint8_t *src, size_t size, uint8_t *dst, DecodeState *state )
+{
+	const uint8_t *srcEnd = src + size;
+	uint8_t *out = dst;
+	while( src < srcEnd ) {
+		if( state->mNumPending == 0 ) {
+			size_t consumed = decodeCharsSimd( src, srcEnd - src, out );
+			src += consumed;
+			out += consumed / 4 * 3;
+		}
+
+		// step through the block the SIMD path rejected, then on to the next group boundary so that it can resume
+		const uint8_t *blockEnd = src + std::min<size_t>( DECODE_SIMD_BLOCK_SIZE, srcEnd - src );
+		for( ; src < srcEnd && ( src < blockEnd || state->mNumPending != 0 ); ++src ) {
+			int8_t v = sDecoding[*src];
+			if( v < 0 )
+				continue;
+			state->mBits = ( state->mBits << 6 ) | v;
+			if( ++state->mNumPending == 4 ) {
+				*out++ = (uint8_t)( state->mBits >> 16 );
+				*out++ = (uint8_t)( state->mBits >> 8 );
+				*out++ = (uint8_t)state->mBits;
+				state->mBits = 0;
+				state->mNumPending = 0;
 			}
 		}
 	}
-	/* control should not reach here */
-	return codechar - code_out;
+	return out - dst;
 }
 
-int base64_encode_blockend( char* code_out, base64_encodestate* state_in )
+// Decodes the bytes completed by a final, unpadded partial group. Returns the number of bytes written.
+size_t decodeBlockEnd( uint8_t *dst, DecodeState *state )
 {
-	char* codechar = code_out;
-	
-	switch (state_in->step) {
-	case step_B:
-		*codechar++ = base64_encode_value(state_in->result);
-		*codechar++ = '=';
-		*codechar++ = '=';
-		break;
-	case step_C:
-		*codechar++ = base64_encode_value(state_in->result);
-		*codechar++ = '=';
-		break;
-	case step_A:
-		break;
+	uint8_t *out = dst;
+	if( state->mNumPending == 2 ) {
+		*out++ = (uint8_t)( state->mBits >> 4 );
+	}
+	else if( state->mNumPending == 3 ) {
+		*out++ = (uint8_t)( state->mBits >> 10 );
+		*out++ = (uint8_t)( state->mBits >> 2 );
 	}
-	
-	return codechar - code_out;
+	state->mBits = 0;
+	state->mNumPending = 0;
+	return out - dst;
 }
 
 } // anonymous namespace
@@ -237,22 +387,32 @@ std::string toBase64( const void *input, size_t inputSize, int charsPerLine )
 {
 	if( inputSize == 0 ) return std::string();
 
-	if( charsPerLine != 0 )
-		charsPerLine -= charsPerLine % 4;
-	size_t lines = ( charsPerLine == 0 ) ? 0 : ( inputSize * 4 / 3 / charsPerLine + 1 ); // account for inserted carriage returns
-	char *buffer = new char[inputSize * 4 / 3 + 4 + lines];
-
-	base64_encodestate encs;
-	base64_init_encodestate( &encs );
-	size_t resultSize = base64_encode_block( reinterpret_cast<const char*>(input), inputSize, &buffer[0], &encs, charsPerLine );
-	resultSize += base64_encode_blockend( &buffer[resultSize], &encs );
-	buffer[resultSize] = 0; // null terminate the string
-	
-	std::string result( buffer );
-	delete [] buffer;
+	EncodeState encs( charsPerLine );
+	std::string result( encodedSizeBound( inputSize, encs ), 0 );
+	size_t resultSize = encodeBlock( reinterpret_cast<const uint8_t*>( input ), inputSize, &result[0], &encs );
+	resultSize += encodeBlockEnd( &result[resultSize], &encs );
+	result.resize( resultSize );
 	return result;
 }
 
+void toBase64( const IStreamRef &input, const OStreamRef &output, int charsPerLine )
+{
+	EncodeState encs( charsPerLine );
+	std::vector<uint8_t> chunk( STREAM_CHUNK_SIZE );
+	std::vector<char> encoded( encodedSizeBound( STREAM_CHUNK_SIZE + 2, encs ) ); // room for up to two bytes pending from the previous chunk
+	while( ! input->isEof() ) {
+		size_t chunkSize = input->readDataAvailable( &chunk[0], STREAM_CHUNK_SIZE );
+		if( chunkSize == 0 )
+			break;
+		size_t encodedSize = encodeBlock( &chunk[0], chunkSize, &encoded[0], &encs );
+		output->writeData( &encoded[0], encodedSize );
+	}
+
+	size_t encodedSize = encodeBlockEnd( &encoded[0], &encs );
+	if( encodedSize > 0 )
+		output->writeData( &encoded[0], encodedSize );
+}
+
 Buffer fromBase64( const std::string &input )
 {
 	return fromBase64( input.c_str(), input.size() );
@@ -265,16 +425,30 @@ Buffer fromBase64( const Buffer &input )
 
 Buffer fromBase64( const void *input, size_t inputSize )
 {
-	size_t outputSize = inputSize / 4 * 3;
-	Buffer result( outputSize );
-	if( inputSize >= 4 ) {
-		base64_decodestate decs;
-		base64_init_decodestate( &decs );
-		int actualSize = base64_decode_block( reinterpret_cast<const char*>(input), inputSize, (char*)result.getData(), &decs );
-		result.setDataSize( actualSize );
-	}
+	Buffer result( decodedSizeBound( inputSize ) );
+	DecodeState decs;
+	size_t actualSize = decodeBlock( reinterpret_cast<const uint8_t*>( input ), inputSize, (uint8_t*)result.getData(), &decs );
+	actualSize += decodeBlockEnd( (uint8_t*)result.getData() + actualSize, &decs );
+	result.setDataSize( actualSize );
 	return result;
 }
 
+void fromBase64( const IStreamRef &input, const OStreamRef &output )
+{
+	DecodeState decs;
+	std::vector<uint8_t> chunk( STREAM_CHUNK_SIZE );
+	std::vector<uint8_t> decoded( decodedSizeBound( STREAM_CHUNK_SIZE ) );
+	while( ! input->isEof() ) {
+		size_t chunkSize = input->readDataAvailable( &chunk[0], STREAM_CHUNK_SIZE );
+		if( chunkSize == 0 )
+			break;
+		size_t decodedSize = decodeBlock( &chunk[0], chunkSize, &decoded[0], &decs );
+		output->writeData( &decoded[0], decodedSize );
+	}
+
+	size_t decodedSize = decodeBlockEnd( &decoded[0], &decs );
+	if( decodedSize > 0 )
+		output->writeData( &decoded[0], decodedSize );
+}
 
 } // namespace cinder
@@ -24,7 +24,9 @@
 #include "cinder/Buffer.h"
 #include "cinder/DataSource.h"
 #include "cinder/DataTarget.h"
+#include "cinder/TaskPool.h"
 #include <zlib.h>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -60,6 +62,12 @@ Buffer::Buffer( size_t aSize )
 {
 }
 
+Buffer::Buffer( void * aData, size_t aSize, const std::shared_ptr<void> &owner )
+	: mObj( new Obj( aData, aSize, false ) )
+{
+	mObj->mOwner = owner;
+}
+
 void Buffer::resize( size_t newSize )
 {
 	if( ! mObj->mOwnsData ) return;
@@ -82,6 +90,12 @@ void Buffer::write( std::shared_ptr<class DataTarget> dataTarget )
 
 std::shared_ptr<uint8_t>	Buffer::convertToSharedPtr()
 {
+	// data kept alive by an owner can't be free()'d, so the result holds onto the owner instead
+	if( mObj->mOwner ) {
+		std::shared_ptr<void> owner = mObj->mOwner;
+		return std::shared_ptr<uint8_t>( reinterpret_cast<uint8_t*>( mObj->mData ), [owner]( uint8_t * ) {} );
+	}
+
 	mObj->mOwnsData = false;
 	return std::shared_ptr<uint8_t>( reinterpret_cast<uint8_t*>( mObj->mData ), free );
 }
@@ -105,6 +119,20 @@ Buffer compressBuffer( const Buffer &aBuffer, int8_t compressionLevel, bool resi
 	return outBuffer;
 }
 
+Buffer compressBufferParallel( const Buffer &aBuffer, int8_t compressionLevel, bool useGZip, TaskPool *taskPool )
+{
+	OStreamMemRef outStream = OStreamMem::create( std::max<size_t>( aBuffer.getDataSize() / 2, 4096 ) );
+	{
+		OStreamDeflateRef deflateStream = OStreamDeflate::create( outStream, compressionLevel, useGZip ? DEFLATE_FORMAT_GZIP : DEFLATE_FORMAT_ZLIB, taskPool ? taskPool : TaskPool::get() );
+		deflateStream->writeData( aBuffer.getData(), aBuffer.getDataSize() );
+		deflateStream->finish();
+	}
+
+	Buffer outBuffer( (size_t)outStream->tell() );
+	memcpy( outBuffer.getData(), outStream->getBuffer(), outBuffer.getDataSize() );
+	return outBuffer;
+}
+
 Buffer decompressBuffer( const Buffer &aBuffer, bool resizeResult, bool useGZip )
 {
 	int err;
@@ -25,9 +25,100 @@
 
 #include "cinder/Camera.h"
 #include "cinder/Sphere.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 
 namespace cinder {
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+#endif
+
+// Transforms 'points' to clip space by 'm' and calls emitFn( index, ndcX, ndcY, ndcZ, visible ) for each, where visible
+// means the point lies beyond the near plane and inside the left, right, top and bottom planes
+template<typename EmitFn>
+void projectPoints( const Matrix44f &m, const Vec3f *points, size_t count, EmitFn emitFn )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		__m128 col[16];
+		for( int c = 0; c < 16; ++c )
+			col[c] = _mm_set1_ps( m.m[c] );
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1 );
+		for( ; i + 4 <= count; i += 4 ) {
+			const Vec3f *p = points + i;
+			const __m128 x = _mm_setr_ps( p[0].x, p[1].x, p[2].x, p[3].x );
+			const __m128 y = _mm_setr_ps( p[0].y, p[1].y, p[2].y, p[3].y );
+			const __m128 z = _mm_setr_ps( p[0].z, p[1].z, p[2].z, p[3].z );
+			__m128 clip[4];
+			for( int r = 0; r < 4; ++r )
+				clip[r] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( col[r], x ), _mm_mul_ps( col[r+4], y ) ), _mm_add_ps( _mm_mul_ps( col[r+8], z ), col[r+12] ) );
+			const __m128 w = clip[3], negW = _mm_sub_ps( zero, w );
+			__m128 inside = _mm_cmpgt_ps( w, zero );
+			inside = _mm_and_ps( inside, _mm_and_ps( _mm_cmple_ps( clip[0], w ), _mm_cmpge_ps( clip[0], negW ) ) );
+			inside = _mm_and_ps( inside, _mm_and_ps( _mm_cmple_ps( clip[1], w ), _mm_cmpge_ps( clip[1], negW ) ) );
+			inside = _mm_and_ps( inside, _mm_cmpge_ps( clip[2], negW ) );
+			const int visibleBits = _mm_movemask_ps( inside );
+
+			const __m128 invW = _mm_div_ps( one, w );
+			float ndc[3][4];
+			for( int c = 0; c < 3; ++c )
+				_mm_storeu_ps( ndc[c], _mm_mul_ps( clip[c], invW ) );
+			for( int j = 0; j < 4; ++j )
+				emitFn( i + j, ndc[0][j], ndc[1][j], ndc[2][j], ( visibleBits & ( 1 << j ) ) != 0 );
+		}
+	}
+#elif defined( CINDER_NEON )
+	float32x4_t col[16];
+	for( int c = 0; c < 16; ++c )
+		col[c] = vdupq_n_f32( m.m[c] );
+	for( ; i + 4 <= count; i += 4 ) {
+		// Vec3f is tightly packed, so a structured load deinterleaves 4 points
+		const float32x4x3_t p = vld3q_f32( &points[i].x );
+		float32x4_t clip[4];
+		for( int r = 0; r < 4; ++r )
+			clip[r] = vaddq_f32( vaddq_f32( vmulq_f32( col[r], p.val[0] ), vmulq_f32( col[r+4], p.val[1] ) ), vaddq_f32( vmulq_f32( col[r+8], p.val[2] ), col[r+12] ) );
+		const float32x4_t w = clip[3], negW = vnegq_f32( w );
+		uint32x4_t inside = vcgtq_f32( w, vdupq_n_f32( 0 ) );
+		inside = vandq_u32( inside, vandq_u32( vcleq_f32( clip[0], w ), vcgeq_f32( clip[0], negW ) ) );
+		inside = vandq_u32( inside, vandq_u32( vcleq_f32( clip[1], w ), vcgeq_f32( clip[1], negW ) ) );
+		inside = vandq_u32( inside, vcgeq_f32( clip[2], negW ) );
+		uint32_t visible[4];
+		vst1q_u32( visible, inside );
+
+		// reciprocal estimate refined by two Newton-Raphson steps
+		float32x4_t invW = vrecpeq_f32( w );
+		invW = vmulq_f32( vrecpsq_f32( w, invW ), invW );
+		invW = vmulq_f32( vrecpsq_f32( w, invW ), invW );
+		float ndc[3][4];
+		for( int c = 0; c < 3; ++c )
+			vst1q_f32( ndc[c], vmulq_f32( clip[c], invW ) );
+		for( int j = 0; j < 4; ++j )
+			emitFn( i + j, ndc[0][j], ndc[1][j], ndc[2][j], visible[j] != 0 );
+	}
+#endif
+	const float *c = m.m;
+	for( ; i < count; ++i ) {
+		const Vec3f &p = points[i];
+		float clip[4];
+		for( int r = 0; r < 4; ++r )
+			clip[r] = ( c[r] * p.x + c[r+4] * p.y ) + ( c[r+8] * p.z + c[r+12] );
+		const float w = clip[3];
+		const bool visible = ( w > 0 ) && ( clip[0] <= w ) && ( clip[0] >= -w ) && ( clip[1] <= w ) && ( clip[1] >= -w ) && ( clip[2] >= -w );
+		const float invW = 1 / w;
+		emitFn( i, clip[0] * invW, clip[1] * invW, clip[2] * invW, visible );
+	}
+}
+
+} // anonymous namespace
+
 void Camera::setEyePoint( const Vec3f &aEyePoint )
 {
 	mEyePoint = aEyePoint;
@@ -135,6 +226,19 @@ Ray Camera::generateRay( float uPos, float vPos, float imagePlaneApectRatio ) co
 	return Ray( mEyePoint, ( mU * s + mV * t - ( mW * viewDistance ) ).normalized() );
 }
 
+void Camera::generateRays( const Vec2f *uv, size_t count, float imagePlaneApectRatio, Ray *result ) const
+{
+	calcMatrices();
+
+	const float viewDistance = imagePlaneApectRatio / math<float>::abs( mFrustumRight - mFrustumLeft ) * mNearClip;
+	const Vec3f towardImagePlane = mW * viewDistance;
+	for( size_t i = 0; i < count; ++i ) {
+		float s = ( uv[i].x - 0.5f ) * imagePlaneApectRatio;
+		float t = ( uv[i].y - 0.5f );
+		result[i] = Ray( mEyePoint, ( mU * s + mV * t - towardImagePlane ).normalized() );
+	}
+}
+
 void Camera::getBillboardVectors( Vec3f *right, Vec3f *up ) const
 {
 	right->set( getModelViewMatrix().m[0], getModelViewMatrix().m[4], getModelViewMatrix().m[8] );
@@ -149,6 +253,23 @@ Vec2f Camera::worldToScreen( const Vec3f &worldCoord, float screenWidth, float s
 	return Vec2f( ( ndc.x + 1.0f ) / 2.0f * screenWidth, ( 1.0f - ( ndc.y + 1.0f ) / 2.0f ) * screenHeight );
 }
 
+void Camera::worldToScreen( const Vec3f *worldCoords, size_t count, float screenWidth, float screenHeight, Vec2f *result, bool *visible ) const
+{
+	const float halfWidth = screenWidth * 0.5f, halfHeight = screenHeight * 0.5f;
+	projectPoints( getViewProjectionMatrix(), worldCoords, count, [=]( size_t i, float x, float y, float, bool isVisible ) {
+		result[i] = Vec2f( ( x + 1.0f ) * halfWidth, ( 1.0f - y ) * halfHeight );
+		if( visible )
+			visible[i] = isVisible;
+	} );
+}
+
+void Camera::worldToNdc( const Vec3f *worldCoords, size_t count, Vec3f *result ) const
+{
+	projectPoints( getViewProjectionMatrix(), worldCoords, count, [=]( size_t i, float x, float y, float z, bool ) {
+		result[i] = Vec3f( x, y, z );
+	} );
+}
+
 //* This only mostly works
 float Camera::getScreenRadius( const Sphere &sphere, float screenWidth, float screenHeight ) const
 {
@@ -73,14 +73,33 @@ Capture::DeviceRef Capture::findDeviceByNameContains( const string &nameFragment
 	return DeviceRef();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Capture::FrameSink
+void Capture::FrameSink::deliver( const Surface8u &surface, double timestamp )
+{
+	mSignalNewFrame( surface, timestamp );
+	if( mQueue && ( ! mQueue->tryPushFront( std::make_pair( surface, timestamp ) ) ) )
+		++mNumDroppedFrames;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Capture::Obj
-Capture::Obj::Obj( int32_t width, int32_t height, const DeviceRef device )
+Capture::Obj::Obj( int32_t width, int32_t height, const DeviceRef device, const Format &format )
 {
-#if defined( CINDER_COCOA )
+#if defined( CINDER_MAC )
+	mPixelFormat = format.getPixelFormat();
+	mImpl = [[::CapturePlatformImpl alloc] initWithDevice:device width:width height:height pixelFormat:mPixelFormat];
+	[((::CapturePlatformImpl*)mImpl) setFrameSink:&mFrameSink];
+#elif defined( CINDER_COCOA )
+	mPixelFormat = PIXEL_FORMAT_RGB;
 	mImpl = [[::CapturePlatformImpl alloc] initWithDevice:device width:width height:height];
+  #if defined( CINDER_COCOA_TOUCH_DEVICE )
+	[((::CapturePlatformImpl*)mImpl) setFrameSink:&mFrameSink];
+  #endif
 #else
-	mImpl = new CapturePlatformImpl( width, height, device );
+	// videoInput's sample grabber always converts to RGB
+	mPixelFormat = PIXEL_FORMAT_RGB;
+	mImpl = new CapturePlatformImpl( width, height, device, &mFrameSink, format.getCodec(), format.getFrameRate() );
 #endif	
 }
 
@@ -93,9 +112,14 @@ Capture::Obj::~Obj()
 #endif
 }
 
-Capture::Capture( int32_t width, int32_t height, const DeviceRef device ) 
+Capture::Capture( int32_t width, int32_t height, const DeviceRef device, PixelFormat pixelFormat ) 
 {
-	mObj = shared_ptr<Obj>( new Obj( width, height, device ) );
+	mObj = shared_ptr<Obj>( new Obj( width, height, device, Format().pixelFormat( pixelFormat ) ) );
+}
+
+Capture::Capture( int32_t width, int32_t height, const DeviceRef device, const Format &format )
+{
+	mObj = shared_ptr<Obj>( new Obj( width, height, device, format ) );
 }
 
 void Capture::start()
@@ -143,6 +167,120 @@ Surface8u Capture::getSurface() const
 #endif
 }
 
+signals::signal<void( const Surface8u&, double )>& Capture::getSignalNewFrame()
+{
+#if defined( CINDER_MSW )
+	mObj->mImpl->enableFrameDelivery();
+#endif
+	return mObj->mFrameSink.mSignalNewFrame;
+}
+
+void Capture::setFrameQueueDepth( size_t depth )
+{
+	if( depth == getFrameQueueDepth() )
+		return;
+
+	// the capture thread reads the queue without locking, so it is only replaced while not capturing
+	bool wasCapturing = isCapturing();
+	if( wasCapturing )
+		stop();
+
+	if( depth > 0 )
+		mObj->mFrameSink.mQueue.reset( new ConcurrentCircularBufferSpsc<std::pair<Surface8u, double> >( depth ) );
+	else
+		mObj->mFrameSink.mQueue.reset();
+#if defined( CINDER_MSW )
+	mObj->mImpl->enableFrameDelivery();
+#endif
+
+	if( wasCapturing )
+		start();
+}
+
+size_t Capture::getFrameQueueDepth() const
+{
+	return ( mObj->mFrameSink.mQueue ) ? mObj->mFrameSink.mQueue->size() : 0;
+}
+
+bool Capture::popFrame( Surface8u *surface, double *timestamp )
+{
+	std::pair<Surface8u, double> frame;
+	if( ( ! mObj->mFrameSink.mQueue ) || ( ! mObj->mFrameSink.mQueue->tryPopBack( &frame ) ) )
+		return false;
+
+	*surface = frame.first;
+	if( timestamp )
+		*timestamp = frame.second;
+	return true;
+}
+
+uint32_t Capture::getNumDroppedFrames() const
+{
+	return mObj->mFrameSink.mNumDroppedFrames;
+}
+
+Capture::PixelFormat Capture::getPixelFormat() const
+{
+	return mObj->mPixelFormat;
+}
+
+Capture::Codec Capture::getCodec() const
+{
+#if defined( CINDER_MSW )
+	return mObj->mImpl->getCodec();
+#else
+	return CODEC_UNCOMPRESSED;
+#endif
+}
+
+gl::Texture Capture::getTexture() const
+{
+#if defined( CINDER_MAC )
+	return [((::CapturePlatformImpl*)mObj->mImpl) getCurrentTexture];
+#elif defined( CINDER_MSW )
+	return mObj->mImpl->getTexture();
+#else
+	Surface8u surface = getSurface();
+	if( surface ) {
+		if( mObj->mTexture && ( mObj->mTexture.getSize() == surface.getSize() ) )
+			mObj->mTexture.update( surface );
+		else
+			mObj->mTexture = gl::Texture( surface );
+	}
+	return mObj->mTexture;
+#endif
+}
+
+#if ! defined( CINDER_GLES )
+gl::GlslProg Capture::createYCbCrShader()
+{
+	static const char *vertexShader =
+		"void main() {\n"
+		"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+		"	gl_FrontColor = gl_Color;\n"
+		"	gl_Position = ftransform();\n"
+		"}\n";
+	// the Textures store Cr, Y and Cb in red, green and blue
+	static const char *fragmentShader =
+		"#extension GL_ARB_texture_rectangle : enable\n"
+		"uniform sampler2DRect tex;\n"
+		"void main() {\n"
+		"	vec3 crYCb = texture2DRect( tex, gl_TexCoord[0].st ).rgb;\n"
+		"	float y = 1.1644 * ( crYCb.g - 0.0625 );\n"
+		"	float cb = crYCb.b - 0.5;\n"
+		"	float cr = crYCb.r - 0.5;\n"
+		"	vec3 rgb = vec3( y + 1.5960 * cr, y - 0.3918 * cb - 0.8130 * cr, y + 2.0172 * cb );\n"
+		"	gl_FragColor = vec4( rgb, 1.0 ) * gl_Color;\n"
+		"}\n";
+
+	gl::GlslProg result( vertexShader, fragmentShader );
+	result.bind();
+	result.uniform( "tex", 0 );
+	result.unbind();
+	return result;
+}
+#endif
+
 int32_t	Capture::getWidth() const { 
 #if defined( CINDER_COCOA )
 	return [((::CapturePlatformImpl*)mObj->mImpl) getWidth];
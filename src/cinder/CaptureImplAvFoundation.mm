@@ -101,6 +101,7 @@ static BOOL sDevicesEnumerated = false;
 		mWidth = width;
 		mHeight = height;
 		mHasNewFrame = false;
+		mFrameSink = NULL;
 		mExposedFrameBytesPerRow = 0;
 		mExposedFrameWidth = 0;
 		mExposedFrameHeight = 0;
@@ -183,6 +184,11 @@ static BOOL sDevicesEnumerated = false;
 	return true;
 }
 
+- (void)setFrameSink:(cinder::Capture::FrameSink*)frameSink
+{
+	mFrameSink = frameSink;
+}
+
 - (void)startCapture 
 {
 	if( mIsCapturing )
@@ -244,7 +250,19 @@ static BOOL sDevicesEnumerated = false;
 			CVBufferRetain( videoFrame );
 		
 			mWorkingPixelBuffer = (CVPixelBufferRef)videoFrame;
-			mHasNewFrame = true;			
+			mHasNewFrame = true;
+
+			// delivered while synchronized, so that stopCapture waits for a delivery in progress before the frame queue can be replaced
+			if( mFrameSink && mFrameSink->isActive() ) {
+				CVPixelBufferRef pixelBuffer = (CVPixelBufferRef)videoFrame;
+				CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+				CVBufferRetain( pixelBuffer );
+				cinder::Surface8u frame( (uint8_t *)CVPixelBufferGetBaseAddress( pixelBuffer ), (int32_t)CVPixelBufferGetWidth( pixelBuffer ), (int32_t)CVPixelBufferGetHeight( pixelBuffer ),
+										(int32_t)CVPixelBufferGetBytesPerRow( pixelBuffer ), cinder::SurfaceChannelOrder::BGRA );
+				frame.setDeallocator( frameDeallocator, pixelBuffer );
+
+				mFrameSink->deliver( frame, CMTimeGetSeconds( CMSampleBufferGetPresentationTimeStamp( sampleBuffer ) ) );
+			}
 		}
 	}	
 }
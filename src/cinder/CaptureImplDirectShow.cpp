@@ -21,9 +21,12 @@
 */
 
 #include "cinder/CaptureImplDirectShow.h"
+#include "cinder/System.h"
 #include <boost/noncopyable.hpp>
 
 #include <set>
+#include <chrono>
+#include <functional>
 using namespace std;
 
 
@@ -69,48 +72,6 @@ std::shared_ptr<CaptureMgr> CaptureMgr::instance()
 	return sInstance;
 }
 
-class SurfaceCache {
- public:
-	SurfaceCache( int32_t width, int32_t height, SurfaceChannelOrder sco, int numSurfaces )
-		: mWidth( width ), mHeight( height ), mSCO( sco )
-	{
-		for( int i = 0; i < numSurfaces; ++i ) {
-			mSurfaceData.push_back( std::shared_ptr<uint8_t>( new uint8_t[width*height*sco.getPixelInc()], checked_array_deleter<uint8_t>() ) );
-			mDeallocatorRefcon.push_back( make_pair( this, i ) );
-			mSurfaceUsed.push_back( false );
-		}
-	}
-	
-	Surface8u getNewSurface()
-	{
-		// try to find an available block of pixel data to wrap a surface around	
-		for( size_t i = 0; i < mSurfaceData.size(); ++i ) {
-			if( ! mSurfaceUsed[i] ) {
-				mSurfaceUsed[i] = true;
-				Surface8u result( mSurfaceData[i].get(), mWidth, mHeight, mWidth * mSCO.getPixelInc(), mSCO );
-				result.setDeallocator( surfaceDeallocator, &mDeallocatorRefcon[i] );
-				return result;
-			}
-		}
-
-		// we couldn't find an available surface, so we'll need to allocate one
-		return Surface8u( mWidth, mHeight, mSCO.hasAlpha(), mSCO );
-	}
-	
-	static void surfaceDeallocator( void *refcon )
-	{
-		pair<SurfaceCache*,int> *info = reinterpret_cast<pair<SurfaceCache*,int>*>( refcon );
-		info->first->mSurfaceUsed[info->second] = false;
-	}
-
- private:
-	vector<std::shared_ptr<uint8_t> >	mSurfaceData;
-	vector<bool>					mSurfaceUsed;
-	vector<pair<SurfaceCache*,int> >	mDeallocatorRefcon;
-	int32_t				mWidth, mHeight;
-	SurfaceChannelOrder	mSCO;
-};
-
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // CaptureImplDirectShow
 
@@ -140,25 +101,25 @@ const vector<Capture::DeviceRef>& CaptureImplDirectShow::getDevices( bool forceR
 	return sDevices;
 }
 
-CaptureImplDirectShow::CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device )
-	: mWidth( width ), mHeight( height ), mCurrentFrame( width, height, false, SurfaceChannelOrder::BGR ), mDeviceID( 0 )
+CaptureImplDirectShow::CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device, Capture::FrameSink *frameSink, Capture::Codec codec, float frameRate )
+	: mWidth( width ), mHeight( height ), mCurrentFrame( width, height, false, SurfaceChannelOrder::BGR ), mDeviceID( 0 ),
+	mRequestedCodec( codec ), mCodec( Capture::CODEC_UNCOMPRESSED ), mFrameRate( frameRate ),
+	mFrameSink( frameSink ), mFrameDeliveryEnabled( false ), mStopFrameDelivery( false ), mDeliveredFrameCount( 0 ), mTextureFrameCount( 0 )
 {
 	mDevice = device;
 	if( mDevice ) {
 		mDeviceID = device->getUniqueId();
 	}
-	if( ! CaptureMgr::instanceVI()->setupDevice( mDeviceID, mWidth, mHeight ) )
-		throw CaptureExcInitFail();
-	mWidth = CaptureMgr::instanceVI()->getWidth( mDeviceID );
-	mHeight = CaptureMgr::instanceVI()->getHeight( mDeviceID );
+	setupDevice();
 	mIsCapturing = true;
-	mSurfaceCache = std::shared_ptr<SurfaceCache>( new SurfaceCache( mWidth, mHeight, SurfaceChannelOrder::BGR, 4 ) );
+	mSurfacePool = SurfacePool8u( 4 );
 
 	mMgrPtr = CaptureMgr::instance();
 }
 
 CaptureImplDirectShow::~CaptureImplDirectShow()
 {
+	stopFrameDelivery();
 	CaptureMgr::instanceVI()->stopDevice( mDeviceID );
 }
 
@@ -166,19 +127,42 @@ void CaptureImplDirectShow::start()
 {
 	if( mIsCapturing ) return;
 	
-	if( ! CaptureMgr::instanceVI()->setupDevice( mDeviceID, mWidth, mHeight ) )
-		throw CaptureExcInitFail();
+	setupDevice();
 	if( ! CaptureMgr::instanceVI()->isDeviceSetup( mDeviceID ) )
 		throw CaptureExcInitFail();
-	mWidth = CaptureMgr::instanceVI()->getWidth( mDeviceID );
-	mHeight = CaptureMgr::instanceVI()->getHeight( mDeviceID );
 	mIsCapturing = true;
+	if( mFrameDeliveryEnabled )
+		startFrameDelivery();
+}
+
+void CaptureImplDirectShow::setupDevice()
+{
+	videoInput *vi = CaptureMgr::instanceVI();
+	if( mFrameRate > 0 )
+		vi->setIdealFramerate( mDeviceID, static_cast<int>( mFrameRate + 0.5f ) );
+	// the capture pin sends the compressed format, and intelligent connect inserts the system's decoder between it and videoInput's RGB sample grabber
+	switch( mRequestedCodec ) {
+		case Capture::CODEC_MJPEG: vi->setRequestedMediaSubtype( mDeviceID, VI_MEDIASUBTYPE_MJPG ); break;
+		case Capture::CODEC_H264: vi->setRequestedMediaSubtype( mDeviceID, VI_MEDIASUBTYPE_H264 ); break;
+		default: break;
+	}
+
+	if( ! vi->setupDevice( mDeviceID, mWidth, mHeight ) )
+		throw CaptureExcInitFail();
+	mWidth = vi->getWidth( mDeviceID );
+	mHeight = vi->getHeight( mDeviceID );
+	switch( vi->getMediaSubtype( mDeviceID ) ) {
+		case VI_MEDIASUBTYPE_MJPG: mCodec = Capture::CODEC_MJPEG; break;
+		case VI_MEDIASUBTYPE_H264: mCodec = Capture::CODEC_H264; break;
+		default: mCodec = Capture::CODEC_UNCOMPRESSED; break;
+	}
 }
 
 void CaptureImplDirectShow::stop()
 {
 	if( ! mIsCapturing ) return;
 
+	stopFrameDelivery();
 	CaptureMgr::instanceVI()->stopDevice( mDeviceID );
 	mIsCapturing = false;
 }
@@ -195,12 +179,118 @@ bool CaptureImplDirectShow::checkNewFrame() const
 
 Surface8u CaptureImplDirectShow::getSurface() const
 {
+	if( mFrameDeliveryThread ) {
+		std::lock_guard<std::mutex> lock( mDeliveredFrameMutex );
+		return mDeliveredFrame;
+	}
+
 	if( CaptureMgr::instanceVI()->isFrameNew( mDeviceID ) ) {
-		mCurrentFrame = mSurfaceCache->getNewSurface();
+		mCurrentFrame = mSurfacePool.getSurface( mWidth, mHeight, false, SurfaceChannelOrder::BGR );
 		CaptureMgr::instanceVI()->getPixels( mDeviceID, mCurrentFrame.getData(), false, true );
 	}
 	
 	return mCurrentFrame;
 }
 
+gl::Texture CaptureImplDirectShow::getTexture() const
+{
+	if( ! mTexture ) {
+		gl::Texture::Format format;
+		format.setInternalFormat( GL_RGB );
+		format.enableStreaming();
+		mTexture = gl::Texture( mWidth, mHeight, format );
+	}
+
+	if( mFrameDeliveryThread ) {
+		Surface8u frame;
+		{
+			std::lock_guard<std::mutex> lock( mDeliveredFrameMutex );
+			if( mTextureFrameCount != mDeliveredFrameCount ) {
+				frame = mDeliveredFrame;
+				mTextureFrameCount = mDeliveredFrameCount;
+			}
+		}
+		// delivered frames have already been flipped upright
+		if( frame ) {
+			mTexture.setFlipped( false );
+			mTexture.update( frame );
+		}
+	}
+	else if( CaptureMgr::instanceVI()->isFrameNew( mDeviceID ) ) {
+		// the frame is copied straight into the Texture's pixel buffer object, and uploaded from there without waiting for the transfer
+		uint8_t *dst = reinterpret_cast<uint8_t*>( mTexture.mapStreamBuffer( mWidth * mHeight * 3 ) );
+		if( dst ) {
+			CaptureMgr::instanceVI()->getPixels( mDeviceID, dst, false, false );
+			mTexture.setFlipped();
+			mTexture.unmapStreamBuffer( mTexture.getBounds(), GL_BGR, GL_UNSIGNED_BYTE );
+		}
+		else {
+			Surface8u frame = mSurfacePool.getSurface( mWidth, mHeight, false, SurfaceChannelOrder::BGR );
+			CaptureMgr::instanceVI()->getPixels( mDeviceID, frame.getData(), false, false );
+			mTexture.setFlipped();
+			mTexture.update( frame );
+		}
+	}
+
+	return mTexture;
+}
+
+void CaptureImplDirectShow::enableFrameDelivery()
+{
+	if( mFrameDeliveryEnabled )
+		return;
+
+	mFrameDeliveryEnabled = true;
+	if( mIsCapturing )
+		startFrameDelivery();
+}
+
+void CaptureImplDirectShow::startFrameDelivery()
+{
+	if( mFrameDeliveryThread )
+		return;
+
+	mStopFrameDelivery = false;
+	mFrameTimer.start();
+	mFrameDeliveryThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &CaptureImplDirectShow::deliverFrames, this ) ) );
+}
+
+void CaptureImplDirectShow::stopFrameDelivery()
+{
+	if( ! mFrameDeliveryThread )
+		return;
+
+	mStopFrameDelivery = true;
+	mFrameDeliveryThread->join();
+	mFrameDeliveryThread.reset();
+}
+
+void CaptureImplDirectShow::deliverFrames()
+{
+	ThreadSetup threadSetup;
+	// above normal so that frames keep arriving on time while worker threads saturate the cores
+	System::setThreadName( "Capture frame delivery" );
+	System::setThreadPriority( System::PRIORITY_HIGH );
+
+	videoInput *vi = CaptureMgr::instanceVI();
+	while( ! mStopFrameDelivery ) {
+		// the device is polled well above camera frame rates, so that frames are picked up within a millisecond of arriving
+		if( ! vi->isFrameNew( mDeviceID ) ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+			continue;
+		}
+
+		double timestamp = mFrameTimer.getSeconds();
+		Surface8u frame = mSurfacePool.getSurface( mWidth, mHeight, false, SurfaceChannelOrder::BGR );
+		vi->getPixels( mDeviceID, frame.getData(), false, true );
+		{
+			std::lock_guard<std::mutex> lock( mDeliveredFrameMutex );
+			mDeliveredFrame = frame;
+			++mDeliveredFrameCount;
+		}
+
+		mFrameSink->deliver( frame, timestamp );
+	}
+}
+
 } //namespace
\ No newline at end of file
@@ -58,6 +58,7 @@ bool CaptureImplQtKitDevice::isConnected() const
 } //namespace
 
 static void frameDeallocator( void *refcon );
+static void textureDeallocator( void *refcon );
 
 static std::vector<cinder::Capture::DeviceRef> sDevices;
 static BOOL sDevicesEnumerated = false;
@@ -89,7 +90,7 @@ static BOOL sDevicesEnumerated = false;
 	return sDevices;
 }
 
-- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height 
+- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height pixelFormat:(cinder::Capture::PixelFormat)pixelFormat
 {
 	if( ( self = [super init] ) ) {
 
@@ -103,6 +104,13 @@ static BOOL sDevicesEnumerated = false;
 		mWidth = width;
 		mHeight = height;
 		mHasNewFrame = false;
+		mPixelFormat = pixelFormat;
+		mFrameSink = NULL;
+		mWorkingPixelBuffer = 0;
+		mCurrentPixelBuffer = 0;
+		mCurrentFrameIsValid = false;
+		mTextureCache = 0;
+		mCurrentTextureIsValid = false;
 		mExposedFrameBytesPerRow = 0;
 		mExposedFrameWidth = 0;
 		mExposedFrameHeight = 0;
@@ -117,11 +125,20 @@ static BOOL sDevicesEnumerated = false;
 	}
 	
 	[mDeviceUniqueId release];
+
+	mCurrentTexture.reset();
+	if( mTextureCache )
+		CVOpenGLTextureCacheRelease( mTextureCache );
 	
 	[super dealloc];
 }
 
 
+- (void)setFrameSink:(cinder::Capture::FrameSink*)frameSink
+{
+	mFrameSink = frameSink;
+}
+
 - (void)prepareStartCapture
 {
 	mCaptureSession = [[QTCaptureSession alloc] init];
@@ -174,13 +191,14 @@ static BOOL sDevicesEnumerated = false;
 	if( pixelBufferFormat < 0 ) 
 		throw cinder::CaptureExcInvalidChannelOrder(); 	*/
 	
+	// IOSurface-backed buffers can be wrapped as textures by getCurrentTexture without copying, which 24-bit RGB buffers can't
+	OSType pixelBufferFormat = ( mPixelFormat == cinder::Capture::PIXEL_FORMAT_YCBCR_422 ) ? kCVPixelFormatType_422YpCbCr8 : kCVPixelFormatType_32BGRA;
 	NSDictionary *attributes = [NSDictionary dictionaryWithObjectsAndKeys:
 								[NSNumber numberWithDouble:mWidth], (id)kCVPixelBufferWidthKey,
 								[NSNumber numberWithDouble:mHeight], (id)kCVPixelBufferHeightKey,
-								//10.4: k32ARGBPixelFormat
-								//10.5: kCVPixelFormatType_32ARGB
-								//[NSNumber numberWithUnsignedInt:pixelBufferFormat], (id)kCVPixelBufferPixelFormatTypeKey,
-								[NSNumber numberWithUnsignedInt:kCVPixelFormatType_24RGB], (id)kCVPixelBufferPixelFormatTypeKey,
+								[NSNumber numberWithUnsignedInt:pixelBufferFormat], (id)kCVPixelBufferPixelFormatTypeKey,
+								[NSDictionary dictionary], (id)kCVPixelBufferIOSurfacePropertiesKey,
+								[NSNumber numberWithBool:YES], (id)kCVPixelBufferOpenGLCompatibilityKey,
 								nil
 								];
 	
@@ -222,11 +240,16 @@ static BOOL sDevicesEnumerated = false;
 		mHasNewFrame = false;
 		
 		mCurrentFrame.reset();
+		mCurrentTexture.reset();
 		
 		if( mWorkingPixelBuffer ) {
 			CVBufferRelease( mWorkingPixelBuffer );
 			mWorkingPixelBuffer = 0;
-		}		
+		}
+		if( mCurrentPixelBuffer ) {
+			CVBufferRelease( mCurrentPixelBuffer );
+			mCurrentPixelBuffer = 0;
+		}
 	}
 }
 
@@ -235,30 +258,93 @@ static BOOL sDevicesEnumerated = false;
 	return mIsCapturing;
 }
 
+// moves the latest delivered pixel buffer into mCurrentPixelBuffer, from which both the current frame and texture are made. Must be called while synchronized.
+- (void)claimWorkingPixelBuffer
+{
+	if( ! mWorkingPixelBuffer )
+		return;
+
+	if( mCurrentPixelBuffer )
+		CVBufferRelease( mCurrentPixelBuffer );
+	mCurrentPixelBuffer = mWorkingPixelBuffer;
+	mWorkingPixelBuffer = 0;
+	mCurrentFrameIsValid = false;
+	mCurrentTextureIsValid = false;
+}
+
 - (cinder::Surface8u)getCurrentFrame
 {
-	if( ( ! mIsCapturing ) || ( ! mWorkingPixelBuffer ) ) {
+	if( ! mIsCapturing ) {
 		return mCurrentFrame;
 	}
 	
 	@synchronized (self) {
-		CVPixelBufferLockBaseAddress( mWorkingPixelBuffer, 0 );
-		
-		uint8_t *data = (uint8_t *)CVPixelBufferGetBaseAddress( mWorkingPixelBuffer );
-		mExposedFrameBytesPerRow = (int32_t)CVPixelBufferGetBytesPerRow( mWorkingPixelBuffer );
-		mExposedFrameWidth = (int32_t)CVPixelBufferGetWidth( mWorkingPixelBuffer );
-		mExposedFrameHeight = (int32_t)CVPixelBufferGetHeight( mWorkingPixelBuffer );
+		[self claimWorkingPixelBuffer];
+		if( ( ! mCurrentPixelBuffer ) || mCurrentFrameIsValid )
+			return mCurrentFrame;
+		mCurrentFrameIsValid = true;
+
+		// YCbCr frames are only available as textures
+		if( mPixelFormat != cinder::Capture::PIXEL_FORMAT_RGB ) {
+			mCurrentFrame.reset();
+			return mCurrentFrame;
+		}
 
-		mCurrentFrame = cinder::Surface8u( data, mExposedFrameWidth, mExposedFrameHeight, mExposedFrameBytesPerRow, cinder::SurfaceChannelOrder::RGB );
-		mCurrentFrame.setDeallocator( frameDeallocator, mWorkingPixelBuffer );
+		CVPixelBufferLockBaseAddress( mCurrentPixelBuffer, 0 );
 		
-		// mark the working pixel buffer as empty since we have wrapped it in the current frame
-		mWorkingPixelBuffer = 0;
+		uint8_t *data = (uint8_t *)CVPixelBufferGetBaseAddress( mCurrentPixelBuffer );
+		mExposedFrameBytesPerRow = (int32_t)CVPixelBufferGetBytesPerRow( mCurrentPixelBuffer );
+		mExposedFrameWidth = (int32_t)CVPixelBufferGetWidth( mCurrentPixelBuffer );
+		mExposedFrameHeight = (int32_t)CVPixelBufferGetHeight( mCurrentPixelBuffer );
+
+		// the frame keeps its own reference to the pixel buffer, which it unlocks and releases when it is destroyed
+		CVBufferRetain( mCurrentPixelBuffer );
+		mCurrentFrame = cinder::Surface8u( data, mExposedFrameWidth, mExposedFrameHeight, mExposedFrameBytesPerRow, cinder::SurfaceChannelOrder::BGRX );
+		mCurrentFrame.setDeallocator( frameDeallocator, mCurrentPixelBuffer );
 	}
 	
 	return mCurrentFrame;
 }
 
+- (cinder::gl::Texture)getCurrentTexture
+{
+	if( ! mIsCapturing ) {
+		return mCurrentTexture;
+	}
+
+	@synchronized (self) {
+		[self claimWorkingPixelBuffer];
+		if( ( ! mCurrentPixelBuffer ) || mCurrentTextureIsValid )
+			return mCurrentTexture;
+		mCurrentTextureIsValid = true;
+
+		// the cache is created for the context current at the first call; textures from it can be used by any context sharing with that one
+		if( ! mTextureCache ) {
+			CGLContextObj context = CGLGetCurrentContext();
+			if( CVOpenGLTextureCacheCreate( kCFAllocatorDefault, NULL, context, CGLGetPixelFormat( context ), NULL, &mTextureCache ) != kCVReturnSuccess ) {
+				mTextureCache = 0;
+				return mCurrentTexture;
+			}
+		}
+
+		CVOpenGLTextureRef texture = 0;
+		if( CVOpenGLTextureCacheCreateTextureFromImage( kCFAllocatorDefault, mTextureCache, mCurrentPixelBuffer, NULL, &texture ) != kCVReturnSuccess )
+			return mCurrentTexture;
+
+		mCurrentTexture = cinder::gl::Texture( CVOpenGLTextureGetTarget( texture ), CVOpenGLTextureGetName( texture ), (int)CVPixelBufferGetWidth( mCurrentPixelBuffer ), (int)CVPixelBufferGetHeight( mCurrentPixelBuffer ), true );
+		cinder::Vec2f t0, lowerRight, t2, upperLeft;
+		CVOpenGLTextureGetCleanTexCoords( texture, &t0.x, &lowerRight.x, &t2.x, &upperLeft.x );
+		mCurrentTexture.setCleanTexCoords( std::max( upperLeft.x, lowerRight.x ), std::max( upperLeft.y, lowerRight.y ) );
+		mCurrentTexture.setFlipped( ! CVOpenGLTextureIsFlipped( texture ) );
+		mCurrentTexture.setDeallocator( textureDeallocator, texture );
+
+		// lets the cache recycle textures of frames which have been released
+		CVOpenGLTextureCacheFlush( mTextureCache, 0 );
+	}
+
+	return mCurrentTexture;
+}
+
 - (bool)checkNewFrame
 {
 	bool result;
@@ -276,6 +362,11 @@ void frameDeallocator( void *refcon )
 	CVBufferRelease( pixelBuffer );
 }
 
+void textureDeallocator( void *refcon )
+{
+	CVOpenGLTextureRelease( reinterpret_cast<CVOpenGLTextureRef>( refcon ) );
+}
+
 - (const cinder::Capture::DeviceRef)getDevice
 {
 	return mDevice;
@@ -318,7 +409,20 @@ void frameDeallocator( void *refcon )
 			CVBufferRetain( videoFrame );
 		
 			mWorkingPixelBuffer = (CVPixelBufferRef)videoFrame;
-			mHasNewFrame = true;			
+			mHasNewFrame = true;
+
+			// delivered while synchronized, so that stopCapture waits for a delivery in progress before the frame queue can be replaced
+			if( mFrameSink && mFrameSink->isActive() && ( mPixelFormat == cinder::Capture::PIXEL_FORMAT_RGB ) ) {
+				CVPixelBufferRef pixelBuffer = (CVPixelBufferRef)videoFrame;
+				CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+				CVBufferRetain( pixelBuffer );
+				cinder::Surface8u frame( (uint8_t *)CVPixelBufferGetBaseAddress( pixelBuffer ), (int32_t)CVPixelBufferGetWidth( pixelBuffer ), (int32_t)CVPixelBufferGetHeight( pixelBuffer ),
+										(int32_t)CVPixelBufferGetBytesPerRow( pixelBuffer ), cinder::SurfaceChannelOrder::BGRX );
+				frame.setDeallocator( frameDeallocator, pixelBuffer );
+
+				QTTime time = [sampleBuffer presentationTime];
+				mFrameSink->deliver( frame, ( time.timeScale > 0 ) ? ( time.timeValue / (double)time.timeScale ) : 0 );
+			}
 		}
 	}	
 }
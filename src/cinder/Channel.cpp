@@ -110,7 +110,7 @@ class ImageSourceChannel : public ImageSource {
 
 template<typename T>
 ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight )
-	: mWidth( aWidth ), mHeight( aHeight )
+	: mWidth( aWidth ), mHeight( aHeight ), mAllocation( "Channel" )
 {
 	mRowBytes = mWidth * sizeof(T);
 	mIncrement = 1;
@@ -118,13 +118,16 @@ ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight )
 	mOwnsData = true;
 	mData = new T[mWidth * mHeight];
 	mDeallocatorFunc = 0;
+	mAllocation.set( (int64_t)mWidth * mHeight * sizeof(T) );
 }
 
 template<typename T>
 ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, int32_t aRowBytes, uint8_t aIncrement, bool aOwnsData, T *aData )
-	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIncrement( aIncrement ), mOwnsData( aOwnsData ), mData( aData )
+	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIncrement( aIncrement ), mOwnsData( aOwnsData ), mData( aData ), mAllocation( "Channel" )
 {
 	mDeallocatorFunc = 0;
+	if( mOwnsData )
+		mAllocation.set( (int64_t)mHeight * mRowBytes );
 }
 
 template<typename T>
@@ -148,6 +151,15 @@ ChannelT<T>::ChannelT( int32_t width, int32_t height, int32_t rowBytes, uint8_t
 {
 }
 
+template<typename T>
+ChannelT<T>::ChannelT( const ChannelT &parent, const Area &area )
+{
+	Area clipped( area.getClipBy( parent.getBounds() ) );
+	T *data = const_cast<T*>( parent.getData( clipped.getUL() ) );
+	mObj = shared_ptr<Obj>( new Obj( clipped.getWidth(), clipped.getHeight(), parent.getRowBytes(), parent.getIncrement(), false, data ) );
+	mObj->mParent = parent.mObj;
+}
+
 template<typename T>
 ChannelT<T>::ChannelT( ImageSourceRef imageSource )
 {
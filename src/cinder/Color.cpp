@@ -386,6 +386,31 @@ Vec3f rgbToHSV( const Colorf &c )
     return Vec3f( hue, sat, val );
 }
 
+float srgbToLinear( float c )
+{
+	// mirrored for negative values, as extended range sRGB does
+	const float a = fabsf( c );
+	const float result = ( a <= 0.04045f ) ? a / 12.92f : powf( ( a + 0.055f ) / 1.055f, 2.4f );
+	return ( c < 0 ) ? -result : result;
+}
+
+float linearToSrgb( float c )
+{
+	const float a = fabsf( c );
+	const float result = ( a <= 0.0031308f ) ? a * 12.92f : 1.055f * powf( a, 1 / 2.4f ) - 0.055f;
+	return ( c < 0 ) ? -result : result;
+}
+
+Colorf srgbToLinear( const Colorf &c )
+{
+	return Colorf( srgbToLinear( c.r ), srgbToLinear( c.g ), srgbToLinear( c.b ) );
+}
+
+Colorf linearToSrgb( const Colorf &c )
+{
+	return Colorf( linearToSrgb( c.r ), linearToSrgb( c.g ), linearToSrgb( c.b ) );
+}
+
 ColorT<uint8_t> svgNameToRgb( const char *name, bool *found )
 {
 	std::string value = boost::to_lower_copy( std::string( name ) );
@@ -21,36 +21,68 @@
 */
 
 #include "cinder/ConvexHull.h"
+#include "cinder/TaskPool.h"
 
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/point_xy.hpp>
-#include <boost/geometry/geometries/polygon.hpp>
-
+#include <algorithm>
 
 namespace cinder {
 
-typedef boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<double> > polygon;
-
 namespace {
 
-template<typename T>
-PolyLine<Vec2<T> > toPolyLine( const polygon &p )
+// Below this many points the hull is computed on the calling thread
+const size_t PARALLEL_MIN_POINTS = 1 << 16;
+
+bool lexicographicLess( const Vec2f &a, const Vec2f &b )
+{
+	return a.x < b.x || ( a.x == b.x && a.y < b.y );
+}
+
+// Positive when \a o, \a a, \a b turn counter-clockwise, evaluated in double so that nearly collinear points are classified consistently
+double cross( const Vec2f &o, const Vec2f &a, const Vec2f &b )
 {
-	PolyLine<Vec2<T> > result;
+	return ( (double)a.x - o.x ) * ( (double)b.y - o.y ) - ( (double)a.y - o.y ) * ( (double)b.x - o.x );
+}
 
-	for( auto pt = p.outer().begin(); pt != p.outer().end(); ++pt )
-		result.push_back( Vec2<T>( (T)boost::geometry::get<0>(*pt), (T)boost::geometry::get<1>(*pt) ) );
+PolyLine2f toClosedPolyLine( const Vec2f *hull, size_t hullSize )
+{
+	PolyLine2f result;
+	if( hullSize == 0 )
+		return result;
 
-	
+	result.getPoints().reserve( hullSize + 1 );
+	result.getPoints().assign( hull, hull + hullSize );
+	result.push_back( hull[0] );
 	return result;
 }
 
-boost::geometry::model::d2::point_xy<double> makePoint( const Vec2f &p )
+PolyLine2f calcConvexHullOfCopy( std::vector<Vec2f> *points )
 {
-	return boost::geometry::make<boost::geometry::model::d2::point_xy<double> >( p.x, p.y );
+	size_t numPoints = points->size();
+	if( numPoints >= PARALLEL_MIN_POINTS ) {
+		// the hull of the whole is the hull of the hulls of its parts, which are each computed in place and then gathered at the front
+		const size_t numParts = std::min<size_t>( ( TaskPool::get()->getNumThreads() + 1 ) * 4, numPoints / ( PARALLEL_MIN_POINTS / 16 ) );
+		const size_t partSize = ( numPoints + numParts - 1 ) / numParts;
+		std::vector<size_t> partHullSizes( numParts );
+		TaskPool::get()->parallelFor( 0, numParts, [&]( size_t first, size_t last ) {
+			for( size_t part = first; part < last; ++part ) {
+				const size_t begin = part * partSize, end = std::min( begin + partSize, numPoints );
+				partHullSizes[part] = ( begin < end ) ? calcConvexHullInPlace( &(*points)[begin], end - begin ) : 0;
+			}
+		}, 1 );
+
+		size_t gathered = 0;
+		for( size_t part = 0; part < numParts; ++part ) {
+			const Vec2f *partHull = &(*points)[0] + part * partSize;
+			std::copy( partHull, partHull + partHullSizes[part], &(*points)[gathered] );
+			gathered += partHullSizes[part];
+		}
+		numPoints = gathered;
+	}
+
+	return toClosedPolyLine( &(*points)[0], calcConvexHullInPlace( &(*points)[0], numPoints ) );
 }
 
-void includePathExtremeties( const Path2d &p, polygon *output )
+void includePathExtremeties( const Path2d &p, std::vector<Vec2f> *output )
 {
 	size_t firstPoint = 0;
 	for( size_t s = 0; s < p.getSegments().size(); ++s ) {
@@ -59,27 +91,27 @@ void includePathExtremeties( const Path2d &p, polygon *output )
 				float monotoneT[4];
 				int monotoneCnt = Path2d::calcCubicBezierMonotoneRegions( &(p.getPoints()[firstPoint]), monotoneT );
 				for( int monotoneIdx = 0; monotoneIdx < monotoneCnt; ++monotoneIdx )
-					output->outer().push_back( makePoint( Path2d::calcCubicBezierPos( &(p.getPoints()[firstPoint]), monotoneT[monotoneIdx] ) ) );
+					output->push_back( Path2d::calcCubicBezierPos( &(p.getPoints()[firstPoint]), monotoneT[monotoneIdx] ) );
 
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+0] ) );
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+1] ) );
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+2] ) );
+				output->push_back( p.getPoints()[firstPoint+0] );
+				output->push_back( p.getPoints()[firstPoint+1] );
+				output->push_back( p.getPoints()[firstPoint+2] );
 			}
 			break;
 			case Path2d::QUADTO: {
 				float monotoneT[2];
 				int monotoneCnt = Path2d::calcCubicBezierMonotoneRegions( &(p.getPoints()[firstPoint]), monotoneT );
 				for( int monotoneIdx = 0; monotoneIdx < monotoneCnt; ++monotoneIdx )
-					output->outer().push_back( makePoint( Path2d::calcQuadraticBezierPos( &(p.getPoints()[firstPoint]), monotoneT[monotoneIdx] ) ) );
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+0] ) );
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+1] ) );
+					output->push_back( Path2d::calcQuadraticBezierPos( &(p.getPoints()[firstPoint]), monotoneT[monotoneIdx] ) );
+				output->push_back( p.getPoints()[firstPoint+0] );
+				output->push_back( p.getPoints()[firstPoint+1] );
 			}
 			break;
 			case Path2d::LINETO:
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+0] ) );
+				output->push_back( p.getPoints()[firstPoint+0] );
 			break;
 			case Path2d::CLOSE:
-				output->outer().push_back( makePoint( p.getPoints()[firstPoint+0] ) );
+				output->push_back( p.getPoints()[firstPoint+0] );
 			break;
 			default:
 				throw Path2dExc();
@@ -93,54 +125,79 @@ void includePathExtremeties( const Path2d &p, polygon *output )
 
 PolyLine2f calcConvexHull( const std::vector<Vec2f> &points )
 {
-	return calcConvexHull( &points[0], points.size() );
+	return calcConvexHull( points.data(), points.size() );
 }
 
 PolyLine2f calcConvexHull( const Vec2f *points, size_t numPoints )
 {
-	polygon poly;
-	for( size_t p = 0; p < numPoints; ++p )
-		poly.outer().push_back( boost::geometry::make<boost::geometry::model::d2::point_xy<double> >( points[p].x, points[p].y ) );
-
-	polygon result;
-	boost::geometry::convex_hull( poly, result );
-	
-	return toPolyLine<float>( result );
+	std::vector<Vec2f> copy( points, points + numPoints );
+	return calcConvexHullOfCopy( &copy );
+}
+
+size_t calcConvexHullInPlace( Vec2f *points, size_t numPoints )
+{
+	// Andrew's monotone chain, run in place by first partitioning the points around the line from the leftmost point to the
+	// rightmost. Those above it can only belong to the upper hull and those below to the lower, so the points are arranged as
+	// leftmost, upper sorted by increasing x, rightmost, lower sorted by decreasing x, and a single chain walks them clockwise.
+	// The chain never holds more vertices than the points it has visited, so it overwrites the array as it goes.
+	if( numPoints == 0 )
+		return 0;
+
+	Vec2f *leftmost = std::min_element( points, points + numPoints, lexicographicLess );
+	std::iter_swap( points, leftmost );
+	const Vec2f left = points[0];
+	const Vec2f right = *std::max_element( points, points + numPoints, lexicographicLess );
+	if( left == right )
+		return 1;
+
+	Vec2f *upperEnd = std::partition( points + 1, points + numPoints, [&]( const Vec2f &pt ) { return cross( left, right, pt ) > 0; } );
+	Vec2f *lowerEnd = std::partition( upperEnd, points + numPoints, [&]( const Vec2f &pt ) { return cross( left, right, pt ) < 0; } );
+	// the rightmost point is itself on the line, so the collinear points left past lowerEnd make room for it after the upper hull
+	std::copy_backward( upperEnd, lowerEnd, lowerEnd + 1 );
+	*upperEnd = right;
+	std::sort( points + 1, upperEnd, lexicographicLess );
+	std::sort( upperEnd + 1, lowerEnd + 1, [] ( const Vec2f &a, const Vec2f &b ) { return lexicographicLess( b, a ); } );
+
+	const size_t rightIdx = upperEnd - points, count = lowerEnd + 1 - points;
+	size_t size = 1, rightHullIdx = 0;
+	for( size_t i = 1; i < count; ++i ) {
+		// vertices of the upper hull are final once the rightmost point is reached
+		const size_t minSize = ( i > rightIdx ) ? rightHullIdx + 1 : 1;
+		const Vec2f pt = points[i];
+		while( size > minSize && cross( points[size - 2], points[size - 1], pt ) >= 0 )
+			--size;
+		if( i == rightIdx )
+			rightHullIdx = size;
+		points[size++] = pt;
+	}
+
+	// closes the chain back at the leftmost point
+	while( size > rightHullIdx + 1 && cross( points[size - 2], points[size - 1], left ) >= 0 )
+		--size;
+
+	return size;
 }
 
 PolyLine2f calcConvexHull( const Shape2d &shape )
 {
-	polygon poly;
+	std::vector<Vec2f> points;
 	for( auto contourIt = shape.getContours().begin(); contourIt != shape.getContours().end(); ++contourIt )
-		includePathExtremeties( *contourIt, &poly );
-
-	polygon result;
-	boost::geometry::convex_hull( poly, result );
+		includePathExtremeties( *contourIt, &points );
 
-	return toPolyLine<float>( result );	
+	return calcConvexHullOfCopy( &points );
 }
 
 PolyLine2f calcConvexHull( const Path2d &path )
 {
-	polygon poly;
-	includePathExtremeties( path, &poly );
+	std::vector<Vec2f> points;
+	includePathExtremeties( path, &points );
 
-	polygon result;
-	boost::geometry::convex_hull( poly, result );
-	
-	return toPolyLine<float>( result );	
+	return calcConvexHullOfCopy( &points );
 }
 
 PolyLine2f calcConvexHull( const PolyLine2f &polyLine )
 {
-	polygon poly;
-	for( auto ptIt = polyLine.begin(); ptIt != polyLine.end(); ++ptIt )
-		poly.outer().push_back( boost::geometry::make<boost::geometry::model::d2::point_xy<double> >( ptIt->x, ptIt->y ) );
-
-	polygon result;
-	boost::geometry::convex_hull( poly, result );
-	
-	return toPolyLine<float>( result );
+	return calcConvexHull( polyLine.getPoints() );
 }
 
-} // namespace cinder
\ No newline at end of file
+} // namespace cinder
@@ -24,6 +24,8 @@
 
 #include "cinder/DataSource.h"
 
+#include <limits>
+
 namespace cinder {
 
 /////////////////////////////////////////////////////////////////////////////
@@ -62,15 +64,50 @@ DataSourcePathRef DataSourcePath::create( const fs::path &path )
 	return DataSourcePathRef( new DataSourcePath( path ) );
 }
 
+namespace {
+
+size_t sMemoryMapThreshold = 1024 * 1024;
+
+} // anonymous namespace
+
 DataSourcePath::DataSourcePath( const fs::path &path )
-	: DataSource( path, Url() )
+	: DataSource( path, Url() ), mMappingAttempted( false )
 {
 	setFilePathHint( path );
 }
 
+// static
+void DataSourcePath::setMemoryMapThreshold( size_t numBytes )
+{
+	sMemoryMapThreshold = numBytes;
+}
+
+// static
+size_t DataSourcePath::getMemoryMapThreshold()
+{
+	return sMemoryMapThreshold;
+}
+
+const MemoryMappedFileRef& DataSourcePath::getMemoryMappedFile()
+{
+	if( ! mMappingAttempted ) {
+		mMappingAttempted = true;
+		if( sMemoryMapThreshold != std::numeric_limits<size_t>::max() )
+			mMappedFile = MemoryMappedFile::create( mFilePath, sMemoryMapThreshold );
+	}
+
+	return mMappedFile;
+}
+
 void DataSourcePath::createBuffer()
 {
-	// no-op - we already supplied the buffer in the constructor
+	// zero-copy if the file is mapped, the Buffer keeps the mapping alive
+	const MemoryMappedFileRef &mappedFile = getMemoryMappedFile();
+	if( mappedFile ) {
+		mBuffer = Buffer( mappedFile->getData(), mappedFile->getSize(), mappedFile );
+		return;
+	}
+
 	IStreamFileRef stream = loadFileStream( mFilePath );
 	if( ! stream )
 		throw StreamExc();
@@ -79,6 +116,13 @@ void DataSourcePath::createBuffer()
 
 IStreamRef DataSourcePath::createStream()
 {
+	const MemoryMappedFileRef &mappedFile = getMemoryMappedFile();
+	if( mappedFile ) {
+		IStreamMemoryMappedRef stream = IStreamMemoryMapped::create( mappedFile );
+		stream->setFileName( mFilePath );
+		return stream;
+	}
+
 	return loadFileStream( mFilePath );
 }
 
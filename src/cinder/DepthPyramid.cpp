@@ -0,0 +1,139 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/DepthPyramid.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace cinder {
+
+void DepthPyramid::set( const Channel32f &depth, const Matrix44f &viewProjection )
+{
+	mViewProjection = viewProjection;
+	mLevels.clear();
+	if( ! depth || depth.getWidth() <= 0 || depth.getHeight() <= 0 )
+		return;
+
+	// the base level is the depth flipped to OpenGL's bottom-up rows
+	Level base;
+	base.mWidth = depth.getWidth();
+	base.mHeight = depth.getHeight();
+	base.mDepth.resize( base.mWidth * base.mHeight );
+	for( int32_t y = 0; y < base.mHeight; ++y ) {
+		const float *src = depth.getData( Vec2i( 0, base.mHeight - 1 - y ) );
+		const int32_t increment = depth.getIncrement();
+		float *dst = &base.mDepth[y * base.mWidth];
+		for( int32_t x = 0; x < base.mWidth; ++x )
+			dst[x] = src[x * increment];
+	}
+	mLevels.push_back( base );
+
+	// each texel keeps the farthest of the 2x2 below it, the last row and column also taking the one left over by an odd size
+	while( mLevels.back().mWidth > 1 || mLevels.back().mHeight > 1 ) {
+		const Level &src = mLevels.back();
+		Level level;
+		level.mWidth = std::max( src.mWidth / 2, 1 );
+		level.mHeight = std::max( src.mHeight / 2, 1 );
+		level.mDepth.resize( level.mWidth * level.mHeight );
+		for( int32_t y = 0; y < level.mHeight; ++y ) {
+			const int32_t srcY0 = y * 2, srcY1 = ( y == level.mHeight - 1 ) ? src.mHeight - 1 : y * 2 + 1;
+			for( int32_t x = 0; x < level.mWidth; ++x ) {
+				const int32_t srcX0 = x * 2, srcX1 = ( x == level.mWidth - 1 ) ? src.mWidth - 1 : x * 2 + 1;
+				float farthest = 0;
+				for( int32_t sy = srcY0; sy <= srcY1; ++sy )
+					for( int32_t sx = srcX0; sx <= srcX1; ++sx )
+						farthest = std::max( farthest, src.mDepth[sy * src.mWidth + sx] );
+				level.mDepth[y * level.mWidth + x] = farthest;
+			}
+		}
+		mLevels.push_back( level );
+	}
+}
+
+bool DepthPyramid::isVisible( const AxisAlignedBox3f &box ) const
+{
+	if( mLevels.empty() )
+		return true;
+
+	// the box's bounds in normalized device coordinates
+	const Vec3f &boxMin = box.getMin(), &boxMax = box.getMax();
+	const float *m = mViewProjection.m;
+	float minX = numeric_limits<float>::max(), minY = minX, minZ = minX;
+	float maxX = -minX, maxY = -minX;
+	for( int c = 0; c < 8; ++c ) {
+		const float x = ( c & 1 ) ? boxMax.x : boxMin.x, y = ( c & 2 ) ? boxMax.y : boxMin.y, z = ( c & 4 ) ? boxMax.z : boxMin.z;
+		const float w = m[3] * x + m[7] * y + m[11] * z + m[15];
+		if( w <= 0.000001f ) // crosses the near plane
+			return true;
+		const float invW = 1 / w;
+		const float ndcX = ( m[0] * x + m[4] * y + m[8] * z + m[12] ) * invW;
+		const float ndcY = ( m[1] * x + m[5] * y + m[9] * z + m[13] ) * invW;
+		const float ndcZ = ( m[2] * x + m[6] * y + m[10] * z + m[14] ) * invW;
+		minX = std::min( minX, ndcX ); maxX = std::max( maxX, ndcX );
+		minY = std::min( minY, ndcY ); maxY = std::max( maxY, ndcY );
+		minZ = std::min( minZ, ndcZ );
+	}
+	if( maxX < -1 || minX > 1 || maxY < -1 || minY > 1 )
+		return true;
+
+	// texels of the base level, then the first level at which they span at most 2x2
+	const Level &base = mLevels[0];
+	int32_t x0 = std::max( (int32_t)math<float>::floor( ( minX * 0.5f + 0.5f ) * base.mWidth ), 0 );
+	int32_t x1 = std::min( (int32_t)math<float>::floor( ( maxX * 0.5f + 0.5f ) * base.mWidth ), base.mWidth - 1 );
+	int32_t y0 = std::max( (int32_t)math<float>::floor( ( minY * 0.5f + 0.5f ) * base.mHeight ), 0 );
+	int32_t y1 = std::min( (int32_t)math<float>::floor( ( maxY * 0.5f + 0.5f ) * base.mHeight ), base.mHeight - 1 );
+	size_t level = 0;
+	while( level + 1 < mLevels.size() && ( ( x1 >> level ) - ( x0 >> level ) > 1 || ( y1 >> level ) - ( y0 >> level ) > 1 ) )
+		++level;
+
+	// a texel past an odd level's last one was folded into it
+	const Level &l = mLevels[level];
+	x0 = std::min( x0 >> level, l.mWidth - 1 ); x1 = std::min( x1 >> level, l.mWidth - 1 );
+	y0 = std::min( y0 >> level, l.mHeight - 1 ); y1 = std::min( y1 >> level, l.mHeight - 1 );
+	float farthest = 0;
+	for( int32_t y = y0; y <= y1; ++y )
+		for( int32_t x = x0; x <= x1; ++x )
+			farthest = std::max( farthest, l.mDepth[y * l.mWidth + x] );
+
+	return minZ * 0.5f + 0.5f <= farthest;
+}
+
+size_t DepthPyramid::testBoxes( const AxisAlignedBox3f *boxes, size_t count, uint32_t *resultMask ) const
+{
+	std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+	size_t numVisible = 0;
+	for( size_t i = 0; i < count; ++i ) {
+		if( isVisible( boxes[i] ) ) {
+			resultMask[i / 32] |= 1u << ( i % 32 );
+			++numVisible;
+		}
+	}
+
+	return numVisible;
+}
+
+} // namespace cinder
@@ -56,6 +56,9 @@ using std::pair;
 
 namespace cinder {
 
+// the number of distinct strings whose measurements are cached per Font
+static const size_t MAX_CACHED_MEASUREMENTS = 1024;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // FontManager
 class FontManager
@@ -227,6 +230,90 @@ float Font::getSize() const
 	return mObj->mSize;
 }
 
+Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+{
+	{
+		std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+		std::map<Glyph,Shape2d>::const_iterator shapeIt = mObj->mGlyphShapes.find( glyphIndex );
+		if( shapeIt != mObj->mGlyphShapes.end() )
+			return shapeIt->second;
+	}
+
+	// loaded without the lock held; a concurrent load of the same glyph just does redundant work
+	Shape2d result = loadGlyphShape( glyphIndex );
+	std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+	mObj->mGlyphShapes[glyphIndex] = result;
+	return result;
+}
+
+Rectf Font::getGlyphBoundingBox( Glyph glyph ) const
+{
+	{
+		std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+		std::map<Glyph,Rectf>::const_iterator boxIt = mObj->mGlyphBoundingBoxes.find( glyph );
+		if( boxIt != mObj->mGlyphBoundingBoxes.end() )
+			return boxIt->second;
+	}
+
+	Rectf result = loadGlyphBoundingBox( glyph );
+	std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+	mObj->mGlyphBoundingBoxes[glyph] = result;
+	return result;
+}
+
+void Font::clearCaches()
+{
+	std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+	mObj->mGlyphShapes.clear();
+	mObj->mGlyphBoundingBoxes.clear();
+	mObj->mMeasurements.clear();
+}
+
+bool Font::MeasureKey::operator<( const MeasureKey &rhs ) const
+{
+	if( mSize.x != rhs.mSize.x ) return mSize.x < rhs.mSize.x;
+	if( mSize.y != rhs.mSize.y ) return mSize.y < rhs.mSize.y;
+	if( mAlignment != rhs.mAlignment ) return mAlignment < rhs.mAlignment;
+	if( mLigate != rhs.mLigate ) return rhs.mLigate;
+	return mText < rhs.mText;
+}
+
+bool Font::findMeasurement( const MeasureKey &key, Vec2f *size, vector<pair<Glyph,Vec2f> > *glyphs ) const
+{
+	std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+	std::map<MeasureKey,Measurement>::const_iterator measurementIt = mObj->mMeasurements.find( key );
+	if( measurementIt == mObj->mMeasurements.end() )
+		return false;
+
+	const Measurement &cached = measurementIt->second;
+	if( ( size && ! cached.mHasSize ) || ( glyphs && ! cached.mHasGlyphs ) )
+		return false;
+
+	if( size )
+		*size = cached.mSize;
+	if( glyphs )
+		*glyphs = cached.mGlyphs;
+	return true;
+}
+
+void Font::cacheMeasurement( const MeasureKey &key, const Vec2f *size, const vector<pair<Glyph,Vec2f> > *glyphs ) const
+{
+	std::lock_guard<std::mutex> lock( mObj->mCacheMutex );
+	// strings which are never repeated would otherwise grow the cache without bound; starting over is cheap compared to measuring
+	if( mObj->mMeasurements.size() >= MAX_CACHED_MEASUREMENTS && mObj->mMeasurements.find( key ) == mObj->mMeasurements.end() )
+		mObj->mMeasurements.clear();
+
+	Measurement &cached = mObj->mMeasurements[key];
+	if( size ) {
+		cached.mSize = *size;
+		cached.mHasSize = true;
+	}
+	if( glyphs ) {
+		cached.mGlyphs = *glyphs;
+		cached.mHasGlyphs = true;
+	}
+}
+
 #if defined( CINDER_COCOA )
 std::string Font::getFullName() const
 {
@@ -293,7 +380,7 @@ vector<Font::Glyph> Font::getGlyphs( const string &s ) const
 	return result;
 }
 
-Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+Shape2d Font::loadGlyphShape( Glyph glyphIndex ) const
 {
 	CGPathRef path = CTFontCreatePathForGlyph( mObj->mCTFont, static_cast<CGGlyph>( glyphIndex ), NULL );
 	Shape2d resultShape;
@@ -302,7 +389,7 @@ Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
 	return resultShape;
 }
 
-Rectf Font::getGlyphBoundingBox( Glyph glyph ) const
+Rectf Font::loadGlyphBoundingBox( Glyph glyph ) const
 {
 	CGGlyph glyphs[1] = { glyph };
 	CGRect bounds = ::CTFontGetBoundingRectsForGlyphs( mObj->mCTFont, kCTFontDefaultOrientation, glyphs, NULL, 1 );
@@ -394,7 +481,7 @@ vector<Font::Glyph> Font::getGlyphs( const string &utf8String ) const
 	return result;
 }
 
-Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+Shape2d Font::loadGlyphShape( Glyph glyphIndex ) const
 {
 	Shape2d resultShape;
 	static const MAT2 matrix = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, -1 } };
@@ -466,7 +553,7 @@ Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
 	return resultShape;
 }
 
-Rectf Font::getGlyphBoundingBox( Glyph glyphIndex ) const
+Rectf Font::loadGlyphBoundingBox( Glyph glyphIndex ) const
 {
 	static const MAT2 matrix = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, -1 } };
 	GLYPHMETRICS metrics;
@@ -570,7 +657,7 @@ static int ftShape2dCubicTo(const FT_Vector *control1, const FT_Vector *control2
 	return 0;
 }
 
-Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+Shape2d Font::loadGlyphShape( Glyph glyphIndex ) const
 {
 	FT_Face face = mObj->mFace;
 	FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT);
@@ -591,7 +678,7 @@ Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
 	return resultShape;
 }
 
-Rectf Font::getGlyphBoundingBox( Glyph glyphIndex ) const
+Rectf Font::loadGlyphBoundingBox( Glyph glyphIndex ) const
 {
 	FT_Load_Glyph(mObj->mFace, glyphIndex, FT_LOAD_DEFAULT);
 	FT_GlyphSlot glyph = mObj->mFace->glyph;
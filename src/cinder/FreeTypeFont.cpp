@@ -0,0 +1,343 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/FreeTypeFont.h"
+#include "cinder/Unicode.h"
+#include "cinder/ip/Fill.h"
+
+#include <ft2build.h>
+// generic is a reserved word in WinRT C++/CX, and a member name in freetype.h
+#define generic GenericFromFreeTypeLibrary
+#include FT_FREETYPE_H
+#undef generic
+
+#if defined( CINDER_COCOA )
+	#include "cinder/cocoa/CinderCocoa.h"
+	#if defined( CINDER_COCOA_TOUCH )
+		#import <CoreText/CoreText.h>
+	#else
+		#include <ApplicationServices/ApplicationServices.h>
+	#endif
+	#include <climits>
+#elif defined( CINDER_MSW )
+	#include <windows.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using std::string;
+using std::vector;
+using std::pair;
+
+namespace cinder {
+
+struct FreeTypeFont::ThreadFace {
+	FT_Library	mLibrary;
+	FT_Face		mFace;
+};
+
+namespace {
+
+// FreeType's 26.6 fixed point to pixels
+inline float fromFixed( FT_Pos value )
+{
+	return value / 64.0f;
+}
+
+// Composites \a bitmap into \a destination with its upper-left at \a position, clipped to \a destination and keeping the greater coverage
+void blendBitmap( const FT_Bitmap &bitmap, const Vec2i &position, Channel8u *destination )
+{
+	const int32_t x0 = std::max<int32_t>( 0, -position.x ), y0 = std::max<int32_t>( 0, -position.y );
+	const int32_t x1 = std::min<int32_t>( bitmap.width, destination->getWidth() - position.x );
+	const int32_t y1 = std::min<int32_t>( bitmap.rows, destination->getHeight() - position.y );
+	const uint8_t increment = destination->getIncrement();
+	for( int32_t y = y0; y < y1; ++y ) {
+		const uint8_t *src = bitmap.buffer + y * bitmap.pitch;
+		uint8_t *dst = destination->getData( position.x + x0, position.y + y );
+		for( int32_t x = x0; x < x1; ++x, dst += increment ) {
+			// monochrome bitmaps from embedded strikes are one bit per pixel, most significant first
+			const uint8_t value = ( bitmap.pixel_mode == FT_PIXEL_MODE_MONO ) ? ( ( src[x >> 3] & ( 0x80 >> ( x & 7 ) ) ) ? 255 : 0 ) : src[x];
+			*dst = std::max( *dst, value );
+		}
+	}
+}
+
+// Returns the index of the face in the font file or collection \a fontData whose PostScript name, or family name for a regular style, is \a name
+size_t findFaceIndex( const Buffer &fontData, const string &name )
+{
+	FT_Library library;
+	if( FT_Init_FreeType( &library ) )
+		return 0;
+
+	size_t result = 0;
+	FT_Face face;
+	// a negative face index only reads the number of faces
+	if( FT_New_Memory_Face( library, (const FT_Byte*)fontData.getData(), (FT_Long)fontData.getDataSize(), -1, &face ) == 0 ) {
+		const FT_Long numFaces = face->num_faces;
+		FT_Done_Face( face );
+		for( FT_Long faceIndex = 0; ( numFaces > 1 ) && ( faceIndex < numFaces ); ++faceIndex ) {
+			if( FT_New_Memory_Face( library, (const FT_Byte*)fontData.getData(), (FT_Long)fontData.getDataSize(), faceIndex, &face ) )
+				continue;
+			const char *postScriptName = FT_Get_Postscript_Name( face );
+			const bool regular = ( face->style_flags & ( FT_STYLE_FLAG_BOLD | FT_STYLE_FLAG_ITALIC ) ) == 0;
+			const bool matches = ( postScriptName && name == postScriptName ) || ( regular && face->family_name && name == face->family_name );
+			FT_Done_Face( face );
+			if( matches ) {
+				result = (size_t)faceIndex;
+				break;
+			}
+		}
+	}
+
+	FT_Done_FreeType( library );
+	return result;
+}
+
+} // anonymous namespace
+
+FreeTypeFont::FreeTypeFont( DataSourceRef dataSource, float size, size_t faceIndex )
+	: mObj( new Obj( dataSource->getBuffer(), size, faceIndex ) )
+{
+}
+
+FreeTypeFont::FreeTypeFont( const Font &font )
+{
+	Buffer fontData;
+	float size = font.getSize();
+	string faceName = font.getName();
+#if defined( CINDER_COCOA )
+	::CFURLRef url = (::CFURLRef)::CTFontCopyAttribute( font.getCtFontRef(), kCTFontURLAttribute );
+	if( ! url )
+		throw FreeTypeFontExc( "no font file for " + font.getName() );
+	char path[PATH_MAX];
+	const bool foundPath = ::CFURLGetFileSystemRepresentation( url, true, (UInt8*)path, sizeof(path) );
+	::CFRelease( url );
+	if( ! foundPath )
+		throw FreeTypeFontExc( "no font file for " + font.getName() );
+	fontData = loadFile( path )->getBuffer();
+
+	::CFStringRef postScriptName = ::CGFontCopyPostScriptName( font.getCgFontRef() );
+	if( postScriptName ) {
+		faceName = cocoa::convertCfString( postScriptName );
+		::CFRelease( postScriptName );
+	}
+#elif defined( CINDER_MSW )
+	::HDC dc = Font::getGlobalDc();
+	::SelectObject( dc, font.getHfont() );
+	// a collection is only returned whole when asked for by its 'ttcf' tag
+	DWORD table = 0x66637474;
+	DWORD dataSize = ::GetFontData( dc, table, 0, NULL, 0 );
+	if( dataSize == GDI_ERROR ) {
+		table = 0;
+		dataSize = ::GetFontData( dc, table, 0, NULL, 0 );
+	}
+	if( ( dataSize == GDI_ERROR ) || ( dataSize == 0 ) )
+		throw FreeTypeFontExc( "no font data for " + font.getName() );
+	fontData = Buffer( dataSize );
+	if( ::GetFontData( dc, table, 0, fontData.getData(), dataSize ) == GDI_ERROR )
+		throw FreeTypeFontExc( "no font data for " + font.getName() );
+
+	// Font's sizes are relative to 96 dpi on MSW, and the LOGFONT has the resulting height in pixels
+	size = (float)abs( font.getLogfont().lfHeight );
+	faceName = toUtf8( (char16_t*)font.getLogfont().lfFaceName );
+#elif defined( CINDER_WINRT )
+	// the Font's face was created from memory, which its stream still references
+	FT_Face face = font.getFace();
+	fontData = Buffer( face->stream->size );
+	memcpy( fontData.getData(), face->stream->base, face->stream->size );
+#endif
+
+	mObj = std::shared_ptr<Obj>( new Obj( fontData, size, findFaceIndex( fontData, faceName ) ) );
+}
+
+FreeTypeFont::Obj::Obj( const Buffer &fontData, float size, size_t faceIndex )
+	: mFontData( fontData ), mSize( size ), mFaceIndex( faceIndex )
+{
+	// the metrics are read once here, so that only glyph lookups and rasterization need the calling thread's face
+	FT_Face face = getThreadFace()->mFace;
+	const char *postScriptName = FT_Get_Postscript_Name( face );
+	mName = ( postScriptName ) ? postScriptName : ( ( face->family_name ) ? face->family_name : "" );
+	mAscent = fromFixed( face->size->metrics.ascender );
+	mDescent = -fromFixed( face->size->metrics.descender );
+	mLeading = std::max( 0.0f, fromFixed( face->size->metrics.height ) - mAscent - mDescent );
+	mNumGlyphs = (size_t)face->num_glyphs;
+	mHasKerning = FT_HAS_KERNING( face ) != 0;
+}
+
+FreeTypeFont::Obj::~Obj()
+{
+	// no thread can still be using a face, since they only do so through a FreeTypeFont which shares this Obj
+	for( std::map<std::thread::id,ThreadFace*>::iterator faceIt = mFaces.begin(); faceIt != mFaces.end(); ++faceIt ) {
+		FT_Done_Face( faceIt->second->mFace );
+		FT_Done_FreeType( faceIt->second->mLibrary );
+		delete faceIt->second;
+	}
+}
+
+FreeTypeFont::ThreadFace* FreeTypeFont::Obj::getThreadFace()
+{
+	std::lock_guard<std::mutex> lock( mFacesMutex );
+	std::map<std::thread::id,ThreadFace*>::const_iterator faceIt = mFaces.find( std::this_thread::get_id() );
+	if( faceIt != mFaces.end() )
+		return faceIt->second;
+
+	// FreeType objects aren't thread safe, so each thread gets a library of its own along with the face
+	std::unique_ptr<ThreadFace> threadFace( new ThreadFace );
+	if( FT_Init_FreeType( &threadFace->mLibrary ) )
+		throw FreeTypeFontExc( "unable to initialize FreeType" );
+	if( FT_New_Memory_Face( threadFace->mLibrary, (const FT_Byte*)mFontData.getData(), (FT_Long)mFontData.getDataSize(), (FT_Long)mFaceIndex, &threadFace->mFace ) ) {
+		FT_Done_FreeType( threadFace->mLibrary );
+		throw FreeTypeFontExc( "unable to load the font data" );
+	}
+	FT_Select_Charmap( threadFace->mFace, FT_ENCODING_UNICODE );
+	FT_Set_Char_Size( threadFace->mFace, 0, (FT_F26Dot6)( mSize * 64 + 0.5f ), 72, 72 );
+
+	mFaces[std::this_thread::get_id()] = threadFace.get();
+	return threadFace.release();
+}
+
+Font::Glyph FreeTypeFont::getGlyphChar( uint32_t codePoint ) const
+{
+	return (Font::Glyph)FT_Get_Char_Index( mObj->getThreadFace()->mFace, codePoint );
+}
+
+vector<Font::Glyph> FreeTypeFont::getGlyphs( const string &utf8String ) const
+{
+	FT_Face face = mObj->getThreadFace()->mFace;
+	const std::u32string codePoints = toUtf32( utf8String );
+	vector<Font::Glyph> result;
+	result.reserve( codePoints.size() );
+	for( std::u32string::const_iterator codePointIt = codePoints.begin(); codePointIt != codePoints.end(); ++codePointIt )
+		result.push_back( (Font::Glyph)FT_Get_Char_Index( face, *codePointIt ) );
+
+	return result;
+}
+
+float FreeTypeFont::getAdvance( Font::Glyph glyph ) const
+{
+	FT_Face face = mObj->getThreadFace()->mFace;
+	if( FT_Load_Glyph( face, glyph, FT_LOAD_DEFAULT ) )
+		return 0;
+
+	return fromFixed( face->glyph->advance.x );
+}
+
+float FreeTypeFont::getKerning( Font::Glyph left, Font::Glyph right ) const
+{
+	if( ! mObj->mHasKerning )
+		return 0;
+
+	FT_Vector kerning;
+	if( FT_Get_Kerning( mObj->getThreadFace()->mFace, left, right, FT_KERNING_DEFAULT, &kerning ) )
+		return 0;
+
+	return fromFixed( kerning.x );
+}
+
+vector<pair<Font::Glyph,Vec2f> > FreeTypeFont::getGlyphPlacements( const string &utf8String ) const
+{
+	FT_Face face = mObj->getThreadFace()->mFace;
+	const std::u32string codePoints = toUtf32( utf8String );
+	vector<pair<Font::Glyph,Vec2f> > result;
+	result.reserve( codePoints.size() );
+
+	FT_Pos penX = 0;
+	FT_UInt previousGlyph = 0;
+	for( std::u32string::const_iterator codePointIt = codePoints.begin(); codePointIt != codePoints.end(); ++codePointIt ) {
+		const FT_UInt glyph = FT_Get_Char_Index( face, *codePointIt );
+		FT_Vector kerning;
+		if( mObj->mHasKerning && previousGlyph && glyph && ( FT_Get_Kerning( face, previousGlyph, glyph, FT_KERNING_DEFAULT, &kerning ) == 0 ) )
+			penX += kerning.x;
+		result.push_back( std::make_pair( (Font::Glyph)glyph, Vec2f( fromFixed( penX ), 0 ) ) );
+		if( FT_Load_Glyph( face, glyph, FT_LOAD_DEFAULT ) == 0 )
+			penX += face->glyph->advance.x;
+		previousGlyph = glyph;
+	}
+
+	return result;
+}
+
+float FreeTypeFont::measureString( const string &utf8String ) const
+{
+	FT_Face face = mObj->getThreadFace()->mFace;
+	const std::u32string codePoints = toUtf32( utf8String );
+
+	FT_Pos penX = 0;
+	FT_UInt previousGlyph = 0;
+	for( std::u32string::const_iterator codePointIt = codePoints.begin(); codePointIt != codePoints.end(); ++codePointIt ) {
+		const FT_UInt glyph = FT_Get_Char_Index( face, *codePointIt );
+		FT_Vector kerning;
+		if( mObj->mHasKerning && previousGlyph && glyph && ( FT_Get_Kerning( face, previousGlyph, glyph, FT_KERNING_DEFAULT, &kerning ) == 0 ) )
+			penX += kerning.x;
+		if( FT_Load_Glyph( face, glyph, FT_LOAD_DEFAULT ) == 0 )
+			penX += face->glyph->advance.x;
+		previousGlyph = glyph;
+	}
+
+	return fromFixed( penX );
+}
+
+bool FreeTypeFont::renderGlyph( Font::Glyph glyph, Channel8u *coverage, Vec2i *bearing ) const
+{
+	FT_Face face = mObj->getThreadFace()->mFace;
+	if( FT_Load_Glyph( face, glyph, FT_LOAD_RENDER ) )
+		return false;
+
+	const FT_Bitmap &bitmap = face->glyph->bitmap;
+	if( ( bitmap.width <= 0 ) || ( bitmap.rows <= 0 ) )
+		return false;
+
+	*coverage = Channel8u( bitmap.width, bitmap.rows );
+	ip::fill<uint8_t>( coverage, 0 );
+	blendBitmap( bitmap, Vec2i::zero(), coverage );
+	*bearing = Vec2i( face->glyph->bitmap_left, -face->glyph->bitmap_top );
+	return true;
+}
+
+void FreeTypeFont::renderGlyphs( const vector<pair<Font::Glyph,Vec2f> > &placements, const Vec2f &baseline, Channel8u *destination ) const
+{
+	FT_Face face = mObj->getThreadFace()->mFace;
+	for( vector<pair<Font::Glyph,Vec2f> >::const_iterator placementIt = placements.begin(); placementIt != placements.end(); ++placementIt ) {
+		if( FT_Load_Glyph( face, placementIt->first, FT_LOAD_RENDER ) )
+			continue;
+
+		const Vec2f origin = baseline + placementIt->second;
+		const Vec2i position( (int32_t)floor( origin.x + 0.5f ) + face->glyph->bitmap_left, (int32_t)floor( origin.y + 0.5f ) - face->glyph->bitmap_top );
+		blendBitmap( face->glyph->bitmap, position, destination );
+	}
+}
+
+FreeTypeFontExc::FreeTypeFontExc( const std::string &description ) throw()
+{
+#if defined( CINDER_MSW ) || defined( CINDER_WINRT )
+	sprintf_s( mMessage, "%s", description.c_str() );
+#else
+	snprintf( mMessage, sizeof(mMessage), "%s", description.c_str() );
+#endif
+}
+
+} // namespace cinder
@@ -24,6 +24,10 @@
 */
 
 #include "cinder/Frustum.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <cstring>
 
 #if defined( CINDER_MSW )
 	#undef NEAR
@@ -32,6 +36,146 @@
 
 namespace cinder {
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+#endif
+
+const int sNibbleBitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// Copies the planes selected by planeMask to the front of result, returning how many there are
+template<typename T>
+size_t gatherPlanes( const Plane<T> planes[6], uint32_t planeMask, Plane<T> result[6] )
+{
+	size_t numPlanes = 0;
+	for( size_t p = 0; p < 6; ++p ) {
+		if( planeMask & ( 1 << p ) )
+			result[numPlanes++] = planes[p];
+	}
+	return numPlanes;
+}
+
+// The scalar tests perform the same operations in the same order as Plane::distance(), so that they agree with intersects() exactly
+template<typename T>
+size_t cullSpheresScalar( const Plane<T> *planes, size_t numPlanes, const T *centersX, const T *centersY, const T *centersZ, const T *radii, size_t first, size_t count, uint32_t *resultMask )
+{
+	size_t numVisible = 0;
+	for( size_t i = first; i < count; ++i ) {
+		bool visible = true;
+		for( size_t p = 0; p < numPlanes && visible; ++p )
+			visible = planes[p].distance( Vec3<T>( centersX[i], centersY[i], centersZ[i] ) ) >= -radii[i];
+		if( visible ) {
+			resultMask[i >> 5] |= 1u << ( i & 31 );
+			++numVisible;
+		}
+	}
+	return numVisible;
+}
+
+template<typename T>
+size_t cullBoxesScalar( const Plane<T> *planes, size_t numPlanes, const T *minX, const T *minY, const T *minZ, const T *maxX, const T *maxY, const T *maxZ, size_t first, size_t count, uint32_t *resultMask )
+{
+	size_t numVisible = 0;
+	for( size_t i = first; i < count; ++i ) {
+		bool visible = true;
+		for( size_t p = 0; p < numPlanes && visible; ++p ) {
+			// the corner furthest along the plane's normal, as AxisAlignedBox3f::getPositive()
+			const Vec3<T> &n = planes[p].getNormal();
+			Vec3<T> positive( ( n.x > 0 ) ? maxX[i] : minX[i], ( n.y > 0 ) ? maxY[i] : minY[i], ( n.z > 0 ) ? maxZ[i] : minZ[i] );
+			visible = planes[p].distance( positive ) >= 0;
+		}
+		if( visible ) {
+			resultMask[i >> 5] |= 1u << ( i & 31 );
+			++numVisible;
+		}
+	}
+	return numVisible;
+}
+
+size_t cullSpheres( const Plane<double> *planes, size_t numPlanes, const double *centersX, const double *centersY, const double *centersZ, const double *radii, size_t count, uint32_t *resultMask )
+{
+	return cullSpheresScalar<double>( planes, numPlanes, centersX, centersY, centersZ, radii, 0, count, resultMask );
+}
+
+size_t cullBoxes( const Plane<double> *planes, size_t numPlanes, const double *minX, const double *minY, const double *minZ, const double *maxX, const double *maxY, const double *maxZ, size_t count, uint32_t *resultMask )
+{
+	return cullBoxesScalar<double>( planes, numPlanes, minX, minY, minZ, maxX, maxY, maxZ, 0, count, resultMask );
+}
+
+size_t cullSpheres( const Plane<float> *planes, size_t numPlanes, const float *centersX, const float *centersY, const float *centersZ, const float *radii, size_t count, uint32_t *resultMask )
+{
+	size_t first = 0, numVisible = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		__m128 nx[6], ny[6], nz[6], d[6];
+		for( size_t p = 0; p < numPlanes; ++p ) {
+			nx[p] = _mm_set1_ps( planes[p].getNormal().x );
+			ny[p] = _mm_set1_ps( planes[p].getNormal().y );
+			nz[p] = _mm_set1_ps( planes[p].getNormal().z );
+			d[p] = _mm_set1_ps( planes[p].getDistance() );
+		}
+
+		const __m128 signBit = _mm_set1_ps( -0.0f );
+		for( ; first + 4 <= count; first += 4 ) {
+			const __m128 cx = _mm_loadu_ps( centersX + first ), cy = _mm_loadu_ps( centersY + first ), cz = _mm_loadu_ps( centersZ + first );
+			const __m128 negRadius = _mm_xor_ps( _mm_loadu_ps( radii + first ), signBit );
+			__m128 outside = _mm_setzero_ps();
+			for( size_t p = 0; p < numPlanes; ++p ) {
+				__m128 dist = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx[p], cx ), _mm_mul_ps( ny[p], cy ) ), _mm_mul_ps( nz[p], cz ) ), d[p] );
+				outside = _mm_or_ps( outside, _mm_cmplt_ps( dist, negRadius ) );
+			}
+			int visibleBits = ~_mm_movemask_ps( outside ) & 0xF;
+			resultMask[first >> 5] |= (uint32_t)visibleBits << ( first & 31 );
+			numVisible += sNibbleBitCounts[visibleBits];
+		}
+	}
+#endif
+	return numVisible + cullSpheresScalar<float>( planes, numPlanes, centersX, centersY, centersZ, radii, first, count, resultMask );
+}
+
+size_t cullBoxes( const Plane<float> *planes, size_t numPlanes, const float *minX, const float *minY, const float *minZ, const float *maxX, const float *maxY, const float *maxZ, size_t count, uint32_t *resultMask )
+{
+	size_t first = 0, numVisible = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		__m128 nx[6], ny[6], nz[6], d[6];
+		const float *px[6], *py[6], *pz[6];
+		for( size_t p = 0; p < numPlanes; ++p ) {
+			const Vec3f &n = planes[p].getNormal();
+			nx[p] = _mm_set1_ps( n.x );
+			ny[p] = _mm_set1_ps( n.y );
+			nz[p] = _mm_set1_ps( n.z );
+			d[p] = _mm_set1_ps( planes[p].getDistance() );
+			// a plane's normal selects the same corner of every box
+			px[p] = ( n.x > 0 ) ? maxX : minX;
+			py[p] = ( n.y > 0 ) ? maxY : minY;
+			pz[p] = ( n.z > 0 ) ? maxZ : minZ;
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		for( ; first + 4 <= count; first += 4 ) {
+			__m128 outside = _mm_setzero_ps();
+			for( size_t p = 0; p < numPlanes; ++p ) {
+				__m128 dist = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx[p], _mm_loadu_ps( px[p] + first ) ), _mm_mul_ps( ny[p], _mm_loadu_ps( py[p] + first ) ) ),
+											_mm_mul_ps( nz[p], _mm_loadu_ps( pz[p] + first ) ) ), d[p] );
+				outside = _mm_or_ps( outside, _mm_cmplt_ps( dist, zero ) );
+			}
+			int visibleBits = ~_mm_movemask_ps( outside ) & 0xF;
+			resultMask[first >> 5] |= (uint32_t)visibleBits << ( first & 31 );
+			numVisible += sNibbleBitCounts[visibleBits];
+		}
+	}
+#endif
+	return numVisible + cullBoxesScalar<float>( planes, numPlanes, minX, minY, minZ, maxX, maxY, maxZ, first, count, resultMask );
+}
+
+} // anonymous namespace
+
 template<typename T>
 Frustum<T>::Frustum( const Camera &cam )
 {
@@ -138,6 +282,39 @@ bool Frustum<T>::intersects( const AxisAlignedBox3f &box ) const
 	return true;
 }
 
+template<typename T>
+typename Frustum<T>::Classification Frustum<T>::classify( const AxisAlignedBox3f &box, uint32_t *planeMask ) const
+{
+	for( size_t i = 0; i < 6; ++i ) {
+		if( ! ( *planeMask & ( 1 << i ) ) )
+			continue;
+		if( mFrustumPlanes[i].distance(box.getPositive(mFrustumPlanes[i].getNormal())) < 0 )
+			return OUTSIDE;
+		if( mFrustumPlanes[i].distance(box.getNegative(mFrustumPlanes[i].getNormal())) >= 0 )
+			*planeMask &= ~( 1 << i );
+	}
+
+	return ( *planeMask == 0 ) ? INSIDE : INTERSECTS;
+}
+
+template<typename T>
+size_t Frustum<T>::intersectsSpheres( const T *centersX, const T *centersY, const T *centersZ, const T *radii, size_t count, uint32_t *resultMask, uint32_t planeMask ) const
+{
+	memset( resultMask, 0, ( ( count + 31 ) / 32 ) * sizeof(uint32_t) );
+	Plane<T> planes[6];
+	size_t numPlanes = gatherPlanes( mFrustumPlanes, planeMask, planes );
+	return cullSpheres( planes, numPlanes, centersX, centersY, centersZ, radii, count, resultMask );
+}
+
+template<typename T>
+size_t Frustum<T>::intersectsBoxes( const T *minX, const T *minY, const T *minZ, const T *maxX, const T *maxY, const T *maxZ, size_t count, uint32_t *resultMask, uint32_t planeMask ) const
+{
+	memset( resultMask, 0, ( ( count + 31 ) / 32 ) * sizeof(uint32_t) );
+	Plane<T> planes[6];
+	size_t numPlanes = gatherPlanes( mFrustumPlanes, planeMask, planes );
+	return cullBoxes( planes, numPlanes, minX, minY, minZ, maxX, maxY, maxZ, count, resultMask );
+}
+
 template class Frustum<float>;
 template class Frustum<double>;
 
@@ -24,6 +24,7 @@
 
 #include "cinder/ImageIo.h"
 #include "cinder/Utilities.h"
+#include "cinder/Profiler.h"
 
 #include <boost/utility.hpp>
 #include <boost/type_traits/is_same.hpp>
@@ -32,8 +33,10 @@
 #if defined( CINDER_MSW )
 	#include "cinder/ImageSourceFileWic.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
 	#include "cinder/ImageTargetFileWic.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
+	#include "cinder/ImageTargetPng.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
 #elif defined( CINDER_COCOA )
 	#include "cinder/cocoa/CinderCocoa.h"
+	#include "cinder/ImageTargetPng.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
 #elif defined( CINDER_WINRT )
 	#include "cinder/ImageSourceFileWic.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
 	#include "cinder/ImageTargetFileWic.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
@@ -162,6 +165,29 @@ bool ImageSource::isPremultiplied() const
 	return mIsPremultiplied;
 }
 
+Area ImageSource::calcDecodeArea( const Options &options, const Vec2i &imageSize )
+{
+	const Area bounds( Vec2i::zero(), imageSize );
+	if( options.getArea().calcArea() == 0 )
+		return bounds;
+
+	Area result = options.getArea().getClipBy( bounds );
+	if( result.getWidth() <= 0 || result.getHeight() <= 0 )
+		throw ImageIoException( "Decode area is outside of the image." );
+
+	return result;
+}
+
+Vec2i ImageSource::calcDecodeSize( const Options &options, const Vec2i &areaSize )
+{
+	const Vec2i &maxSize = options.getDecodeSize();
+	if( maxSize.x <= 0 || maxSize.y <= 0 || ( areaSize.x <= maxSize.x && areaSize.y <= maxSize.y ) )
+		return areaSize;
+
+	double scale = std::min( maxSize.x / (double)areaSize.x, maxSize.y / (double)areaSize.y );
+	return Vec2i( std::max( 1, (int32_t)( areaSize.x * scale + 0.5 ) ), std::max( 1, (int32_t)( areaSize.y * scale + 0.5 ) ) );
+}
+
 /* SD - source data type, TD - target data type, TCM - target color model */
 template<typename SD, typename TD, ImageIo::ColorModel TCM, bool ALPHA>
 void ImageSource::rowFuncSourceRgb( ImageTargetRef target, int32_t row, const void *data )
@@ -409,6 +435,8 @@ ImageSourceRef loadImage( const fs::path &path, ImageSource::Options options, st
 
 ImageSourceRef loadImage( DataSourceRef dataSource, ImageSource::Options options, string extension )
 {
+	CI_PROFILE_ZONE_CATEGORY( "ImageIo loadImage", "ImageIo" );
+
 #if defined( CINDER_COCOA )
 	cocoa::SafeNsAutoreleasePool autorelease;
 #endif
@@ -0,0 +1,180 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageSequenceWriter.h"
+#include "cinder/TaskPool.h"
+#include "cinder/Utilities.h"
+
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace cinder {
+
+ImageSequenceWriterRef ImageSequenceWriter::create( const fs::path &directory, const string &baseName, const string &extension, const Format &format )
+{
+	return ImageSequenceWriterRef( new ImageSequenceWriter( directory, baseName, extension, format ) );
+}
+
+ImageSequenceWriter::ImageSequenceWriter( const fs::path &directory, const string &baseName, const string &extension, const Format &format )
+	: mDirectory( directory ), mBaseName( baseName ), mExtension( extension ), mFormat( format ), mNextIndex( format.getStartIndex() ),
+	mNumEncoding( 0 ), mNumWritten( 0 )
+{
+	mTaskPool = mFormat.getTaskPool() ? mFormat.getTaskPool() : TaskPool::get();
+
+	if( ! mDirectory.empty() && ! fs::exists( mDirectory ) )
+		createDirectories( mDirectory );
+}
+
+ImageSequenceWriter::~ImageSequenceWriter()
+{
+	try {
+		flush();
+	}
+	catch( ... ) {
+	}
+
+	// flush() may have thrown before the last frames finished; they reference this writer
+	waitForFrames( 1 );
+}
+
+fs::path ImageSequenceWriter::getFramePath( int32_t index ) const
+{
+	ostringstream name;
+	name << mBaseName << setw( mFormat.getNumDigits() ) << setfill( '0' ) << index << "." << mExtension;
+	return mDirectory / name.str();
+}
+
+void ImageSequenceWriter::write( const Surface8u &surface )
+{
+	prepareFrame();
+	encode( surface, mNextIndex++ );
+}
+
+void ImageSequenceWriter::write( const gl::FboReadback &readback )
+{
+	prepareFrame();
+
+	PendingReadback pending;
+	pending.mReadback = readback;
+	pending.mIndex = mNextIndex++;
+	pending.mAge = 0;
+	mReadbacks.push_back( pending );
+}
+
+void ImageSequenceWriter::flush()
+{
+	while( ! mReadbacks.empty() )
+		collectReadback();
+
+	waitForFrames( 1 );
+	rethrowError();
+}
+
+size_t ImageSequenceWriter::getNumFramesInFlight() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mNumEncoding + mReadbacks.size();
+}
+
+size_t ImageSequenceWriter::getNumFramesWritten() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mNumWritten;
+}
+
+void ImageSequenceWriter::prepareFrame()
+{
+	rethrowError();
+
+	for( deque<PendingReadback>::iterator readbackIt = mReadbacks.begin(); readbackIt != mReadbacks.end(); ++readbackIt )
+		++readbackIt->mAge;
+	while( ! mReadbacks.empty() && mReadbacks.front().mAge >= mFormat.getReadbackLatency() )
+		collectReadback();
+
+	// the oldest readback is collected early rather than waiting on encodes, which may be all that's left once it's collected
+	while( getNumFramesInFlight() >= mFormat.getMaxFramesInFlight() && ! mReadbacks.empty() )
+		collectReadback();
+	waitForFrames( mFormat.getMaxFramesInFlight() );
+}
+
+void ImageSequenceWriter::waitForFrames( size_t maxFrames )
+{
+	unique_lock<mutex> lock( mMutex );
+	while( mNumEncoding + mReadbacks.size() >= maxFrames && mNumEncoding > 0 )
+		mFrameFinishedCond.wait( lock );
+}
+
+void ImageSequenceWriter::collectReadback()
+{
+	PendingReadback pending = mReadbacks.front();
+	mReadbacks.pop_front();
+
+	// blocks on the GPU if the transfer is still in flight
+	Surface8u surface = pending.mReadback.getSurface();
+	if( surface )
+		encode( surface, pending.mIndex );
+}
+
+void ImageSequenceWriter::encode( const Surface8u &surface, int32_t index )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		++mNumEncoding;
+	}
+
+	const fs::path path = getFramePath( index );
+	const ImageTarget::Options options = mFormat.getImageOptions();
+	mTaskPool->submit( [this, surface, path, options] {
+		exception_ptr error;
+		try {
+			writeImage( path, surface, options );
+		}
+		catch( ... ) {
+			error = current_exception();
+		}
+
+		lock_guard<mutex> lock( mMutex );
+		if( error && ! mError )
+			mError = error;
+		else if( ! error )
+			++mNumWritten;
+		--mNumEncoding;
+		mFrameFinishedCond.notify_all();
+	} );
+}
+
+void ImageSequenceWriter::rethrowError()
+{
+	exception_ptr error;
+	{
+		lock_guard<mutex> lock( mMutex );
+		swap( error, mError );
+	}
+
+	if( error )
+		rethrow_exception( error );
+}
+
+} // namespace cinder
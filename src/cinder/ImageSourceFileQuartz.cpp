@@ -23,6 +23,8 @@
 #include "cinder/ImageSourceFileQuartz.h"
 #include "cinder/cocoa/CinderCocoa.h"
 
+#include <algorithm>
+
 #if defined( CINDER_COCOA_TOUCH )
 	#include <MobileCoreServices/MobileCoreServices.h>
 	#include <ImageIO/ImageIO.h>
@@ -78,6 +80,66 @@ void ImageSourceFileQuartz::registerSelf()
 
 ///////////////////////////////////////////////////////////////////////////////
 // ImageSourceFileQuartz
+namespace {
+
+int32_t getIntProperty( CFDictionaryRef dict, CFStringRef key )
+{
+	int32_t result = 0;
+	::CFNumberRef number = dict ? (::CFNumberRef)::CFDictionaryGetValue( dict, key ) : NULL;
+	if( number )
+		::CFNumberGetValue( number, kCFNumberSInt32Type, &result );
+	return result;
+}
+
+// Creates the image at options' index, scaled so that Options::area() fits within Options::decodeSize(). Scaling goes through
+// CGImageSourceCreateThumbnailAtIndex(), which lets decoders like JPEG's decode at reduced resolution. The area to crop, which
+// ImageSourceCgImage takes care of, is returned in \a resultArea in the scaled image's pixels.
+std::shared_ptr<CGImage> createImage( CGImageSourceRef sourceRef, const ImageSource::Options &options, CFDictionaryRef optionsDict, CFDictionaryRef indexProperties, Area *resultArea )
+{
+	*resultArea = options.getArea();
+	if( options.getDecodeSize().x <= 0 || options.getDecodeSize().y <= 0 )
+		return std::shared_ptr<CGImage>( ::CGImageSourceCreateImageAtIndex( sourceRef, options.getIndex(), optionsDict ), CGImageRelease );
+
+	Vec2i imageSize( getIntProperty( indexProperties, kCGImagePropertyPixelWidth ), getIntProperty( indexProperties, kCGImagePropertyPixelHeight ) );
+	std::shared_ptr<CGImage> image;
+	if( imageSize.x <= 0 || imageSize.y <= 0 ) { // the size isn't known without decoding
+		image = std::shared_ptr<CGImage>( ::CGImageSourceCreateImageAtIndex( sourceRef, options.getIndex(), optionsDict ), CGImageRelease );
+		if( ! image )
+			return image;
+		imageSize = Vec2i( (int32_t)::CGImageGetWidth( image.get() ), (int32_t)::CGImageGetHeight( image.get() ) );
+	}
+
+	const Area area = ImageSource::calcDecodeArea( options, imageSize );
+	const Vec2i decodeSize = ImageSource::calcDecodeSize( options, area.getSize() );
+
+	if( decodeSize != area.getSize() ) {
+		const double scaleFactor = std::min( decodeSize.x / (double)area.getWidth(), decodeSize.y / (double)area.getHeight() );
+		int32_t maxPixelSize = std::max( 1, (int32_t)( std::max( imageSize.x, imageSize.y ) * scaleFactor + 0.5 ) );
+
+		::CFNumberRef maxPixelSizeRef = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &maxPixelSize );
+		::CFStringRef keys[4] = { kCGImageSourceShouldAllowFloat, kCGImageSourceCreateThumbnailFromImageAlways, kCGImageSourceCreateThumbnailWithTransform, kCGImageSourceThumbnailMaxPixelSize };
+		::CFTypeRef values[4] = { kCFBooleanTrue, kCFBooleanTrue, kCFBooleanFalse, maxPixelSizeRef };
+		const std::shared_ptr<__CFDictionary> thumbnailOptions( (__CFDictionary*)::CFDictionaryCreate( kCFAllocatorDefault, (const void **)&keys, (const void **)&values, 4, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks ), cocoa::safeCfRelease );
+		::CFRelease( maxPixelSizeRef );
+
+		image = std::shared_ptr<CGImage>( ::CGImageSourceCreateThumbnailAtIndex( sourceRef, options.getIndex(), thumbnailOptions.get() ), CGImageRelease );
+		if( ! image )
+			return image;
+
+		// the thumbnail's size is rounded by ImageIO, so the area is mapped through its actual size
+		const double thumbScaleX = ::CGImageGetWidth( image.get() ) / (double)imageSize.x;
+		const double thumbScaleY = ::CGImageGetHeight( image.get() ) / (double)imageSize.y;
+		const Vec2i ul( (int32_t)( area.x1 * thumbScaleX + 0.5 ), (int32_t)( area.y1 * thumbScaleY + 0.5 ) );
+		*resultArea = Area( ul, ul + Vec2i( std::max( 1, (int32_t)( area.getWidth() * thumbScaleX + 0.5 ) ), std::max( 1, (int32_t)( area.getHeight() * thumbScaleY + 0.5 ) ) ) );
+	}
+	else if( ! image )
+		image = std::shared_ptr<CGImage>( ::CGImageSourceCreateImageAtIndex( sourceRef, options.getIndex(), optionsDict ), CGImageRelease );
+
+	return image;
+}
+
+} // anonymous namespace
+
 ImageSourceFileQuartzRef ImageSourceFileQuartz::createFileQuartzRef( DataSourceRef dataSourceRef, ImageSource::Options options )
 {
 	std::shared_ptr<CGImageSource> sourceRef;
@@ -110,17 +172,20 @@ ImageSourceFileQuartzRef ImageSourceFileQuartz::createFileQuartzRef( DataSourceR
 		::CFRelease( dataRef );
 	}
 	
-	if( sourceRef ) {
-		imageRef = std::shared_ptr<CGImage>( ::CGImageSourceCreateImageAtIndex( sourceRef.get(), options.getIndex(), optionsDict.get() ), CGImageRelease );
-		if( ! imageRef )
-			throw ImageIoExceptionFailedLoad( "Core Graphics coult not create image data." );
-	}
-	else
+	if( ! sourceRef )
 		throw ImageIoExceptionFailedLoad( "Failed to load CGImageSource." );
 
 	const std::shared_ptr<__CFDictionary> imageProperties( (__CFDictionary*)::CGImageSourceCopyProperties( sourceRef.get(), NULL ), ::CFRelease );
 	const std::shared_ptr<__CFDictionary> imageIndexProperties( (__CFDictionary*)::CGImageSourceCopyPropertiesAtIndex( sourceRef.get(), options.getIndex(), NULL ), ::CFRelease );
 
+	Area imageArea;
+	imageRef = createImage( sourceRef.get(), options, optionsDict.get(), imageIndexProperties.get(), &imageArea );
+	if( ! imageRef )
+		throw ImageIoExceptionFailedLoad( "Core Graphics coult not create image data." );
+
+	// ImageSourceCgImage crops to the area, expressed in the possibly scaled image's pixels
+	options.area( imageArea );
+
 	return ImageSourceFileQuartzRef( new ImageSourceFileQuartz( imageRef.get(), options, imageProperties, imageIndexProperties ) );
 }
 
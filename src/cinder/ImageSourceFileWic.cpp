@@ -24,6 +24,7 @@
 
 #include "cinder/ImageSourceFileWic.h"
 #include "cinder/Utilities.h"
+#include "cinder/Profiler.h"
 #include "cinder/msw/CinderMsw.h"
 
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
@@ -31,6 +32,7 @@
 #endif
 #include <wincodec.h>
 #include <wincodecsdk.h>
+#include <algorithm>
 #pragma comment( lib, "WindowsCodecs.lib" )
 
 namespace cinder {
@@ -111,7 +113,36 @@ ImageSourceFileWic::ImageSourceFileWic( DataSourceRef dataSourceRef, ImageSource
 
 	UINT width = 0, height = 0;
 	frame->GetSize( &width, &height );
-	mWidth = width; mHeight = height;
+
+	// scaling happens ahead of clipping so that WIC can use the decoder's own downscaling (such as the JPEG decoder's) where available,
+	// which means the rect passed to CopyPixels() is in scaled pixels
+	const Area area = calcDecodeArea( options, Vec2i( width, height ) );
+	const Vec2i decodeSize = calcDecodeSize( options, area.getSize() );
+	WICRect rect = { area.x1, area.y1, area.getWidth(), area.getHeight() };
+
+	std::shared_ptr<IWICBitmapSource> source = frame;
+	if( decodeSize != area.getSize() ) {
+		const double scaleX = decodeSize.x / (double)area.getWidth(), scaleY = decodeSize.y / (double)area.getHeight();
+		const UINT scaledWidth = std::max<UINT>( decodeSize.x, (UINT)( width * scaleX + 0.5 ) );
+		const UINT scaledHeight = std::max<UINT>( decodeSize.y, (UINT)( height * scaleY + 0.5 ) );
+
+		IWICBitmapScaler *scalerP = NULL;
+		hr = IWICFactory->CreateBitmapScaler( &scalerP );
+		if( ! SUCCEEDED( hr ) )
+			throw ImageIoExceptionFailedLoad( "Could not create WIC Bitmap Scaler." );
+		std::shared_ptr<IWICBitmapScaler> scaler = msw::makeComShared( scalerP );
+		hr = scaler->Initialize( frame.get(), scaledWidth, scaledHeight, WICBitmapInterpolationModeFant );
+		if( ! SUCCEEDED( hr ) )
+			throw ImageIoExceptionFailedLoad( "Could not initialize WIC Bitmap Scaler." );
+		source = scaler;
+
+		rect.Width = decodeSize.x;
+		rect.Height = decodeSize.y;
+		rect.X = std::min<INT>( (INT)( area.x1 * scaleX + 0.5 ), scaledWidth - rect.Width );
+		rect.Y = std::min<INT>( (INT)( area.y1 * scaleY + 0.5 ), scaledHeight - rect.Height );
+	}
+
+	mWidth = rect.Width; mHeight = rect.Height;
 	
 	GUID pixelFormat = { 0 }, convertPixelFormat;
 	frame->GetPixelFormat( &pixelFormat );
@@ -127,13 +158,13 @@ ImageSourceFileWic::ImageSourceFileWic( DataSourceRef dataSourceRef, ImageSource
 		if( ! SUCCEEDED( hr ) )
 			throw ImageIoExceptionFailedLoad( "Could not create WIC Format Converter." );
 		std::shared_ptr<IWICFormatConverter> formatConverter = msw::makeComShared( pIFormatConverter );
-		hr = formatConverter->Initialize( frame.get(), convertPixelFormat, WICBitmapDitherTypeNone, NULL, 0.f, WICBitmapPaletteTypeCustom );
+		hr = formatConverter->Initialize( source.get(), convertPixelFormat, WICBitmapDitherTypeNone, NULL, 0.f, WICBitmapPaletteTypeCustom );
 		if( ! SUCCEEDED( hr ) )
 			throw ImageIoExceptionFailedLoad( "Could not initialize WIC Format Converter." );
-		hr = formatConverter->CopyPixels( NULL, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
+		hr = formatConverter->CopyPixels( &rect, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
 	}
 	else
-		hr = frame->CopyPixels( NULL, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
+		hr = source->CopyPixels( &rect, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
 }
 
 // returns true if we need conversion
@@ -194,6 +225,8 @@ bool ImageSourceFileWic::processFormat( const ::GUID &guid, ::GUID *convertGUID
 
 void ImageSourceFileWic::load( ImageTargetRef target )
 {
+	CI_PROFILE_ZONE_CATEGORY( "ImageIo decode", "ImageIo" );
+
 	// get a pointer to the ImageSource function appropriate for handling our data configuration
 	ImageSource::RowFunc func = setupRowFunc( target );
 	
@@ -21,8 +21,12 @@
 */
 
 #include "cinder/ImageSourcePng.h"
+#include "cinder/Profiler.h"
 #include <png.h>
 
+#include <algorithm>
+#include <vector>
+
 using namespace std;
 
 namespace cinder {
@@ -74,8 +78,8 @@ ImageSourcePngRef ImageSourcePng::createRef( DataSourceRef dataSourceRef, ImageS
 	return ImageSourcePngRef( new ImageSourcePng( dataSourceRef, options ) );
 }
 
-ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
-	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 )
+ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options )
+	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 ), mScaled( false ), mNumSourceRowsRead( 0 ), mNumRowsRead( 0 )
 {
 	mPngPtr = png_create_read_struct( PNG_LIBPNG_VER_STRING, (png_voidp)NULL, NULL, NULL );
 	if( ! mPngPtr ) {
@@ -96,6 +100,110 @@ ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Option
 	
 	if( ! loadHeader() )
 		throw ImageSourcePngException( "Could not load png header." );
+
+	setupDecode( options );
+}
+
+void ImageSourcePng::setupDecode( const ImageSource::Options &options )
+{
+	mDecodeArea = calcDecodeArea( options, Vec2i( mWidth, mHeight ) );
+	const Vec2i decodeSize = calcDecodeSize( options, mDecodeArea.getSize() );
+	mSourceRow.resize( png_get_rowbytes( mPngPtr, mInfoPtr ) );
+	setSize( decodeSize.x, decodeSize.y );
+
+	// png has no reduced resolution decoding, so scaling box filters the rows as they're decoded
+	mScaled = ( decodeSize != mDecodeArea.getSize() );
+	if( mScaled ) {
+		mColumnBounds.resize( decodeSize.x + 1 );
+		for( int32_t x = 0; x <= decodeSize.x; ++x )
+			mColumnBounds[x] = mDecodeArea.x1 + (int32_t)( (int64_t)x * mDecodeArea.getWidth() / decodeSize.x );
+		mRowSums.resize( decodeSize.x * channelOrderNumChannels( mChannelOrder ) );
+	}
+}
+
+size_t ImageSourcePng::getRowBytes() const
+{
+	return mWidth * channelOrderNumChannels( mChannelOrder ) * dataTypeBytes( mDataType );
+}
+
+// reads the next decoded row into \a dest. Can longjmp out on a libpng error, so this and its callees must not have locals with destructors
+void ImageSourcePng::readRow( uint8_t *dest )
+{
+	if( mScaled ) {
+		if( mDataType == ImageIo::UINT16 )
+			readRowScaled( reinterpret_cast<uint16_t *>( dest ) );
+		else
+			readRowScaled( dest );
+	}
+	else {
+		// skip rows above the area
+		for( ; mNumSourceRowsRead < mDecodeArea.y1 + mNumRowsRead; ++mNumSourceRowsRead )
+			png_read_row( mPngPtr, &mSourceRow[0], NULL );
+
+		png_read_row( mPngPtr, &mSourceRow[0], NULL );
+		++mNumSourceRowsRead;
+		memcpy( dest, &mSourceRow[mDecodeArea.x1 * channelOrderNumChannels( mChannelOrder ) * dataTypeBytes( mDataType )], getRowBytes() );
+	}
+
+	++mNumRowsRead;
+}
+
+template<typename T>
+void ImageSourcePng::readRowScaled( T *dest )
+{
+	const int32_t numChannels = channelOrderNumChannels( mChannelOrder );
+	const int32_t rowBegin = mDecodeArea.y1 + (int32_t)( (int64_t)mNumRowsRead * mDecodeArea.getHeight() / mHeight );
+	const int32_t rowEnd = std::max( rowBegin + 1, mDecodeArea.y1 + (int32_t)( (int64_t)( mNumRowsRead + 1 ) * mDecodeArea.getHeight() / mHeight ) );
+
+	for( ; mNumSourceRowsRead < rowBegin; ++mNumSourceRowsRead )
+		png_read_row( mPngPtr, &mSourceRow[0], NULL );
+
+	std::fill( mRowSums.begin(), mRowSums.end(), 0.0 );
+	for( ; mNumSourceRowsRead < rowEnd; ++mNumSourceRowsRead ) {
+		png_read_row( mPngPtr, &mSourceRow[0], NULL );
+		const T *src = reinterpret_cast<const T *>( &mSourceRow[0] );
+		double *sums = &mRowSums[0];
+		for( int32_t x = 0; x < mWidth; ++x, sums += numChannels ) {
+			const int32_t columnEnd = std::max( mColumnBounds[x] + 1, mColumnBounds[x + 1] );
+			for( int32_t column = mColumnBounds[x]; column < columnEnd; ++column ) {
+				for( int32_t c = 0; c < numChannels; ++c )
+					sums[c] += src[column * numChannels + c];
+			}
+		}
+	}
+
+	const double *sums = &mRowSums[0];
+	for( int32_t x = 0; x < mWidth; ++x, sums += numChannels ) {
+		const double scale = 1.0 / ( ( rowEnd - rowBegin ) * std::max( 1, mColumnBounds[x + 1] - mColumnBounds[x] ) );
+		for( int32_t c = 0; c < numChannels; ++c )
+			*dest++ = (T)( sums[c] * scale + 0.5 );
+	}
+}
+
+int32_t ImageSourcePng::readRows( void *dest, size_t destRowBytes, int32_t numRows )
+{
+	if( ! mPngPtr )
+		throw ImageSourcePngException( "Failure during load." );
+
+	bool success = true;
+	int32_t rowsRead = 0;
+	if( setjmp( png_jmpbuf(mPngPtr) ) ) {
+		png_destroy_read_struct( &mPngPtr, &mInfoPtr, (png_infopp)NULL );
+		mPngPtr = 0;
+		success = false;
+	}
+	else {
+		uint8_t *destRow = reinterpret_cast<uint8_t *>( dest );
+		for( ; rowsRead < numRows && mNumRowsRead < mHeight; ++rowsRead ) {
+			readRow( destRow );
+			destRow += destRowBytes;
+		}
+	}
+
+	if( ! success )
+		throw ImageSourcePngException( "Failure during load." );
+
+	return rowsRead;
 }
 
 // part of this being separated allows for us to play nicely with the setjmp of libpng
@@ -165,25 +273,16 @@ ImageSourcePng::~ImageSourcePng()
 
 void ImageSourcePng::load( ImageTargetRef target )
 {
-	bool success = true;
-	if( setjmp( png_jmpbuf(mPngPtr) ) ) {
-		png_destroy_read_struct( &mPngPtr, &mInfoPtr, (png_infopp)NULL );
-		mPngPtr = 0;
-		success = false;
-	}
-	else {
-		// get a pointer to the ImageSource function appropriate for handling our data configuration
-		ImageSource::RowFunc func = setupRowFunc( target );
-		//int number_passes = png_set_interlace_handling( mPngPtr );
-		shared_ptr<png_byte> row_pointer( new png_byte[png_get_rowbytes( mPngPtr, mInfoPtr )], checked_array_deleter<png_byte>() );
-		for( int32_t row = 0; row < mHeight; ++row ) {
-			png_read_row( mPngPtr, row_pointer.get(), NULL );
-			((*this).*func)( target, row, row_pointer.get() );
-		}
+	CI_PROFILE_ZONE_CATEGORY( "ImageIo decode", "ImageIo" );
+
+	// get a pointer to the ImageSource function appropriate for handling our data configuration
+	ImageSource::RowFunc func = setupRowFunc( target );
+	//int number_passes = png_set_interlace_handling( mPngPtr );
+	vector<uint8_t> row( getRowBytes() );
+	for( int32_t r = mNumRowsRead; r < mHeight; ++r ) {
+		readRows( &row[0], row.size(), 1 );
+		((*this).*func)( target, r, &row[0] );
 	}
-	
-	if( ! success )
-		throw ImageSourcePngException( "Failure during load." );
 }
 
 } // namespace cinder
\ No newline at end of file
@@ -0,0 +1,285 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageTargetPng.h"
+#include "cinder/TaskPool.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+inline uint8_t paethPredictor( int a, int b, int c )
+{
+	const int p = a + b - c;
+	const int pa = abs( p - a ), pb = abs( p - b ), pc = abs( p - c );
+	if( pa <= pb && pa <= pc )
+		return (uint8_t)a;
+	else if( pb <= pc )
+		return (uint8_t)b;
+	else
+		return (uint8_t)c;
+}
+
+// Deflated part of the IDAT stream. Parts are compressed independently and concatenated, each one primed with the tail of the previous part as its dictionary
+struct DeflatePart {
+	vector<uint8_t>	mData;
+	uLong			mAdler;
+};
+
+const size_t DEFLATE_PART_SIZE = 1024 * 1024;
+const size_t DEFLATE_WINDOW_SIZE = 32768;
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Registrar
+void ImageTargetPng::registerSelf()
+{
+	// ahead of the platform encoders, which don't expose the compression level
+	const int32_t PRIORITY = 1;
+	ImageIoRegistrar::registerTargetType( "png", ImageTargetPng::createRef, PRIORITY, "png" );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ImageTargetPng
+ImageTargetRef ImageTargetPng::createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const string &extensionData )
+{
+	return ImageTargetRef( new ImageTargetPng( dataTarget, imageSource, options ) );
+}
+
+ImageTargetPng::ImageTargetPng( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options )
+	: ImageTarget(), mDataTarget( dataTarget )
+{
+	setSize( imageSource->getWidth(), imageSource->getHeight() );
+	mCompressionLevel = qualityToCompressionLevel( options.getQuality() );
+
+	ImageIo::ColorModel cm = options.isColorModelDefault() ? imageSource->getColorModel() : options.getColorModel();
+	setColorModel( ( cm == ImageIo::CM_GRAY ) ? ImageIo::CM_GRAY : ImageIo::CM_RGB );
+	setDataType( ( imageSource->getDataType() == ImageIo::UINT8 ) ? ImageIo::UINT8 : ImageIo::UINT16 );
+	const bool alpha = imageSource->hasAlpha();
+	if( getColorModel() == ImageIo::CM_GRAY ) {
+		setChannelOrder( alpha ? ImageIo::YA : ImageIo::Y );
+		mPngColorType = alpha ? 4 : 0;
+	}
+	else {
+		setChannelOrder( alpha ? ImageIo::RGBA : ImageIo::RGB );
+		mPngColorType = alpha ? 6 : 2;
+	}
+
+	mPixelBytes = channelOrderNumChannels( getChannelOrder() ) * dataTypeBytes( getDataType() );
+	mRowBytes = mPixelBytes * mWidth;
+	mData.resize( mRowBytes * mHeight );
+}
+
+int ImageTargetPng::qualityToCompressionLevel( float quality )
+{
+	if( quality <= 0 )
+		return Z_NO_COMPRESSION;
+
+	return std::min<int>( Z_BEST_COMPRESSION, std::max<int>( Z_BEST_SPEED, (int)( quality * Z_BEST_COMPRESSION + 0.5f ) ) );
+}
+
+void* ImageTargetPng::getRowPointer( int32_t row )
+{
+	return &mData[row * mRowBytes];
+}
+
+void ImageTargetPng::filterRow( int32_t row, uint8_t *dest, FilterMode mode ) const
+{
+	enum { NONE, SUB, UP, AVERAGE, PAETH };
+
+	const uint8_t *cur = &mData[row * mRowBytes];
+	const uint8_t *prev = ( row > 0 ) ? cur - mRowBytes : 0;
+	const size_t bpp = mPixelBytes;
+
+	int filter;
+	if( mode == FILTER_NONE )
+		filter = NONE;
+	else if( mode == FILTER_SUB )
+		filter = SUB;
+	else {
+		// libpng's heuristic: the filter whose output, taken as signed bytes, has the smallest sum of magnitudes
+		uint32_t sums[5] = { 0, 0, 0, 0, 0 };
+		for( size_t x = 0; x < mRowBytes; ++x ) {
+			const int a = ( x >= bpp ) ? cur[x - bpp] : 0;
+			const int b = prev ? prev[x] : 0;
+			const int c = ( prev && x >= bpp ) ? prev[x - bpp] : 0;
+			sums[NONE] += abs( (int8_t)cur[x] );
+			sums[SUB] += abs( (int8_t)( cur[x] - a ) );
+			sums[UP] += abs( (int8_t)( cur[x] - b ) );
+			sums[AVERAGE] += abs( (int8_t)( cur[x] - ( ( a + b ) >> 1 ) ) );
+			sums[PAETH] += abs( (int8_t)( cur[x] - paethPredictor( a, b, c ) ) );
+		}
+		filter = (int)( min_element( sums, sums + 5 ) - sums );
+	}
+
+	*dest++ = (uint8_t)filter;
+	switch( filter ) {
+		case NONE:
+			memcpy( dest, cur, mRowBytes );
+		break;
+		case SUB:
+			memcpy( dest, cur, std::min( bpp, mRowBytes ) );
+			for( size_t x = bpp; x < mRowBytes; ++x )
+				dest[x] = cur[x] - cur[x - bpp];
+		break;
+		case UP:
+			for( size_t x = 0; x < mRowBytes; ++x )
+				dest[x] = cur[x] - prev[x];
+		break;
+		case AVERAGE:
+			for( size_t x = 0; x < mRowBytes; ++x )
+				dest[x] = cur[x] - (uint8_t)( ( ( ( x >= bpp ) ? cur[x - bpp] : 0 ) + ( prev ? prev[x] : 0 ) ) >> 1 );
+		break;
+		case PAETH:
+			for( size_t x = 0; x < mRowBytes; ++x )
+				dest[x] = cur[x] - paethPredictor( ( x >= bpp ) ? cur[x - bpp] : 0, prev ? prev[x] : 0, ( prev && x >= bpp ) ? prev[x - bpp] : 0 );
+		break;
+	}
+}
+
+void ImageTargetPng::writeChunk( const char *type, const uint8_t *data, size_t size )
+{
+	uLong crc = crc32( 0L, Z_NULL, 0 );
+	crc = crc32( crc, reinterpret_cast<const Bytef*>( type ), 4 );
+	if( size )
+		crc = crc32( crc, data, (uInt)size );
+
+	mStream->writeBig( (uint32_t)size );
+	mStream->writeData( type, 4 );
+	if( size )
+		mStream->writeData( data, size );
+	mStream->writeBig( (uint32_t)crc );
+}
+
+void ImageTargetPng::finalize()
+{
+	TaskPool *taskPool = TaskPool::get();
+
+	// png stores 16 bit samples big endian
+#if defined( CINDER_LITTLE_ENDIAN )
+	if( getDataType() == ImageIo::UINT16 ) {
+		uint16_t *samples = reinterpret_cast<uint16_t*>( &mData[0] );
+		taskPool->parallelFor( 0, mData.size() / 2, [=] ( size_t first, size_t last ) {
+			for( size_t s = first; s < last; ++s )
+				samples[s] = ( samples[s] >> 8 ) | ( samples[s] << 8 );
+		} );
+	}
+#endif
+
+	// each row only depends on the unfiltered previous row, so rows filter independently
+	const FilterMode filterMode = ( mCompressionLevel == Z_NO_COMPRESSION ) ? FILTER_NONE : ( ( mCompressionLevel <= 2 ) ? FILTER_SUB : FILTER_ADAPTIVE );
+	const size_t filteredRowBytes = mRowBytes + 1;
+	vector<uint8_t> filtered( filteredRowBytes * mHeight );
+	taskPool->parallelFor( 0, mHeight, [&] ( size_t first, size_t last ) {
+		for( size_t row = first; row < last; ++row )
+			filterRow( (int32_t)row, &filtered[row * filteredRowBytes], filterMode );
+	} );
+	vector<uint8_t>().swap( mData );
+
+	// deflate the filtered image in independent parts, which are concatenated into a single zlib stream
+	const size_t numParts = std::max<size_t>( 1, ( filtered.size() + DEFLATE_PART_SIZE - 1 ) / DEFLATE_PART_SIZE );
+	vector<DeflatePart> parts( numParts );
+	const int level = mCompressionLevel;
+	taskPool->parallelFor( 0, numParts, [&] ( size_t first, size_t last ) {
+		for( size_t p = first; p < last; ++p ) {
+			const size_t begin = p * DEFLATE_PART_SIZE;
+			const size_t size = std::min( DEFLATE_PART_SIZE, filtered.size() - begin );
+			const bool lastPart = ( p == numParts - 1 );
+
+			z_stream zs;
+			memset( &zs, 0, sizeof(zs) );
+			if( deflateInit2( &zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+				throw ImageIoExceptionFailedWrite( "Could not initialize zlib." );
+			if( p > 0 ) {
+				const size_t dictSize = std::min( begin, DEFLATE_WINDOW_SIZE );
+				deflateSetDictionary( &zs, &filtered[begin - dictSize], (uInt)dictSize );
+			}
+
+			DeflatePart &part = parts[p];
+			part.mData.resize( deflateBound( &zs, (uLong)size ) + 16 );
+			zs.next_in = size ? &filtered[begin] : Z_NULL;
+			zs.avail_in = (uInt)size;
+			int result;
+			do {
+				if( zs.total_out == part.mData.size() )
+					part.mData.resize( part.mData.size() * 2 );
+				zs.next_out = &part.mData[zs.total_out];
+				zs.avail_out = (uInt)( part.mData.size() - zs.total_out );
+				result = deflate( &zs, lastPart ? Z_FINISH : Z_SYNC_FLUSH );
+			} while( ( lastPart && result == Z_OK ) || ( ! lastPart && ( zs.avail_in > 0 || zs.avail_out == 0 ) ) );
+			part.mData.resize( zs.total_out );
+			deflateEnd( &zs );
+			if( result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR )
+				throw ImageIoExceptionFailedWrite( "Could not compress png data." );
+
+			part.mAdler = adler32( adler32( 0L, Z_NULL, 0 ), size ? &filtered[begin] : Z_NULL, (uInt)size );
+		}
+	}, 1 );
+
+	uLong adler = adler32( 0L, Z_NULL, 0 );
+	for( size_t p = 0; p < numParts; ++p )
+		adler = adler32_combine( adler, parts[p].mAdler, (z_off_t)std::min( DEFLATE_PART_SIZE, filtered.size() - p * DEFLATE_PART_SIZE ) );
+
+	// zlib header with the FLEVEL hint, and the big endian adler32 trailer
+	const uint8_t flags[4] = { 0x01, 0x5E, 0x9C, 0xDA };
+	const uint8_t header[2] = { 0x78, flags[( level < 2 ) ? 0 : ( ( level < 6 ) ? 1 : ( ( level == 6 ) ? 2 : 3 ) )] };
+	parts.front().mData.insert( parts.front().mData.begin(), header, header + 2 );
+	const uint8_t trailer[4] = { (uint8_t)( adler >> 24 ), (uint8_t)( adler >> 16 ), (uint8_t)( adler >> 8 ), (uint8_t)adler };
+	parts.back().mData.insert( parts.back().mData.end(), trailer, trailer + 4 );
+
+	mStream = mDataTarget->getStream();
+	if( ! mStream )
+		throw ImageIoExceptionFailedWrite( "Could not open png for writing." );
+	const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	mStream->writeData( signature, 8 );
+
+	uint8_t ihdr[13];
+	const uint32_t size[2] = { (uint32_t)mWidth, (uint32_t)mHeight };
+	for( int i = 0; i < 2; ++i ) {
+		ihdr[i * 4 + 0] = (uint8_t)( size[i] >> 24 );
+		ihdr[i * 4 + 1] = (uint8_t)( size[i] >> 16 );
+		ihdr[i * 4 + 2] = (uint8_t)( size[i] >> 8 );
+		ihdr[i * 4 + 3] = (uint8_t)size[i];
+	}
+	ihdr[8] = (uint8_t)( dataTypeBytes( getDataType() ) * 8 );
+	ihdr[9] = mPngColorType;
+	ihdr[10] = ihdr[11] = ihdr[12] = 0; // deflate, adaptive filtering, no interlacing
+	writeChunk( "IHDR", ihdr, 13 );
+
+	for( size_t p = 0; p < numParts; ++p ) {
+		if( ! parts[p].mData.empty() )
+			writeChunk( "IDAT", &parts[p].mData[0], parts[p].mData.size() );
+	}
+	writeChunk( "IEND", 0, 0 );
+	mStream.reset();
+}
+
+} // namespace cinder
@@ -29,14 +29,179 @@
 #include <json/json.h>
 
 #include "cinder/Json.h"
+#include "cinder/CinderAssert.h"
 #include "cinder/Stream.h"
 #include "cinder/Utilities.h"
 
 #include <cstdlib>
+#include <cstdio>
+#include <limits>
 
 using namespace std;
 
 namespace cinder {
+
+namespace {
+
+// Validates \a literal against the JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isNumberLiteral( const string &literal, bool *isInteger )
+{
+	const char *p = literal.c_str();
+	*isInteger = true;
+	if( *p == '-' )
+		++p;
+	if( *p == '0' )
+		++p;
+	else if( *p >= '1' && *p <= '9' ) {
+		while( *p >= '0' && *p <= '9' )
+			++p;
+	}
+	else
+		return false;
+
+	if( *p == '.' ) {
+		*isInteger = false;
+		++p;
+		if( ! ( *p >= '0' && *p <= '9' ) )
+			return false;
+		while( *p >= '0' && *p <= '9' )
+			++p;
+	}
+	if( *p == 'e' || *p == 'E' ) {
+		*isInteger = false;
+		++p;
+		if( *p == '+' || *p == '-' )
+			++p;
+		if( ! ( *p >= '0' && *p <= '9' ) )
+			return false;
+		while( *p >= '0' && *p <= '9' )
+			++p;
+	}
+	return p == literal.c_str() + literal.size();
+}
+
+// Returns the magnitude of the integer \a literal in \a result, or \c false if it doesn't fit in 64 bits
+bool parseIntegerMagnitude( const string &literal, uint64_t *result )
+{
+	uint64_t value = 0;
+	for( string::const_iterator charIt = literal.begin(); charIt != literal.end(); ++charIt ) {
+		if( *charIt == '-' )
+			continue;
+		uint64_t digit = *charIt - '0';
+		if( value > ( numeric_limits<uint64_t>::max() - digit ) / 10 )
+			return false;
+		value = value * 10 + digit;
+	}
+	*result = value;
+	return true;
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonTree::Builder
+
+//! Builds a JsonTree directly from JsonReader events, adding each node in place as it is parsed
+class JsonTree::Builder : public JsonReader::Handler {
+  public:
+	Builder( JsonTree *root )
+		: mRoot( root )
+	{}
+
+	bool nullValue()
+	{
+		addNode( NODE_VALUE );
+		return true;
+	}
+
+	bool boolValue( bool value )
+	{
+		JsonTree *node = addNode( NODE_VALUE );
+		// matches toString( bool ), which getValue<bool>() expects
+		node->mValue = value ? "1" : "0";
+		node->mValueType = VALUE_BOOL;
+		return true;
+	}
+
+	bool numberValue( const std::string &literal, bool isInteger )
+	{
+		JsonTree *node = addNode( NODE_VALUE );
+		node->mValue = literal;
+		node->mValueType = VALUE_DOUBLE;
+		uint64_t magnitude;
+		if( isInteger && parseIntegerMagnitude( literal, &magnitude ) ) {
+			if( magnitude <= (uint64_t)numeric_limits<int64_t>::max() || ( literal[0] == '-' && magnitude == (uint64_t)numeric_limits<int64_t>::max() + 1 ) )
+				node->mValueType = VALUE_INT;
+			else if( literal[0] != '-' )
+				node->mValueType = VALUE_UINT;
+		}
+		return true;
+	}
+
+	bool stringValue( const std::string &value )
+	{
+		JsonTree *node = addNode( NODE_VALUE );
+		node->mValue = value;
+		node->mValueType = VALUE_STRING;
+		return true;
+	}
+
+	bool startObject()
+	{
+		mStack.push_back( addNode( NODE_OBJECT ) );
+		return true;
+	}
+
+	bool key( const std::string &key )
+	{
+		mKey = key;
+		return true;
+	}
+
+	bool endObject()
+	{
+		mStack.pop_back();
+		return true;
+	}
+
+	bool startArray()
+	{
+		mStack.push_back( addNode( NODE_ARRAY ) );
+		return true;
+	}
+
+	bool endArray()
+	{
+		mStack.pop_back();
+		return true;
+	}
+
+  private:
+	JsonTree* addNode( NodeType nodeType )
+	{
+		// the root node keeps the type its constructor gave it unless the document is a container
+		if( mStack.empty() ) {
+			if( nodeType != NODE_VALUE )
+				mRoot->mNodeType = nodeType;
+			return mRoot;
+		}
+
+		JsonTree *parent = mStack.back();
+		parent->mChildren.push_back( JsonTree() );
+		JsonTree *node = &parent->mChildren.back();
+		node->mParent = parent;
+		node->mNodeType = nodeType;
+		if( parent->mNodeType == NODE_OBJECT )
+			node->mKey.swap( mKey );
+		return node;
+	}
+
+	JsonTree				*mRoot;
+	std::vector<JsonTree*>	mStack;
+	std::string				mKey;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	
 JsonTree::ParseOptions::ParseOptions() 
 	: mIgnoreErrors( false ), mAllowComments( true )
@@ -95,8 +260,8 @@ bool JsonTree::WriteOptions::getIndented() const
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 JsonTree::JsonTree()
+	: mParent( NULL ), mNodeType( NODE_NULL ), mValueType( VALUE_STRING )
 {
-    init( "", Json::Value( Json::nullValue ), true, NODE_NULL );
 }
 
 JsonTree::JsonTree( const JsonTree &jsonTree )
@@ -130,22 +295,17 @@ JsonTree& JsonTree::operator=( const JsonTree &jsonTree )
 }
 
 JsonTree::JsonTree( DataSourceRef dataSource, ParseOptions parseOptions )
-{    
-	string jsonString = loadString( dataSource );
-	Json::Value value = deserializeNative( jsonString, parseOptions );
-	init( "", value, true, NODE_OBJECT );
+	: mParent( NULL ), mNodeType( NODE_OBJECT ), mValueType( VALUE_STRING )
+{
+	Builder builder( this );
+	JsonReader( parseOptions ).parse( dataSource, builder );
 }
 
 JsonTree::JsonTree( const std::string &jsonString, ParseOptions parseOptions )
+	: mParent( NULL ), mNodeType( NODE_NULL ), mValueType( VALUE_STRING )
 {
-	Json::Value value = deserializeNative( jsonString, parseOptions );
-	if ( value.isArray() ) {
-		init ( "", value, true, NODE_ARRAY );
-	} else if ( value.isObject() ) {
-		init ( "", value, true, NODE_OBJECT );
-	} else {
-		init ( "", value, true, NODE_NULL );
-	}
+	Builder builder( this );
+	JsonReader( parseOptions ).parse( jsonString, builder );
 }
 
 JsonTree::JsonTree( const std::string &key, const Json::Value &value )
@@ -274,29 +434,6 @@ void JsonTree::init( const string &key, const Json::Value &value, bool setType,
 	}
 }
 
-//! Converts a JSON string into a JsonCpp object
-Json::Value JsonTree::deserializeNative( const string &jsonString, ParseOptions parseOptions )
-{
-	Json::Features features;
-	features.allowComments_ = parseOptions.getAllowComments();
-	features.strictRoot_ = ! parseOptions.getIgnoreErrors();
-	Json::Reader reader( features );
-	Json::Value value;
-    try {
-        reader.parse( jsonString, value, false );
-    }
-	catch ( ... ) {
-		throw ExcJsonParserError( "Unknown error." );
-    }
-	if( ! parseOptions.getIgnoreErrors() ) {
-		string errorMessage = reader.getFormattedErrorMessages();
-		if( errorMessage.length() > 0 ) {
-			throw ExcJsonParserError( errorMessage );
-		}
-	}
-	return value;
-}
-	
 void JsonTree::clear()
 {
 	mChildren.clear();
@@ -534,7 +671,7 @@ JsonTree* JsonTree::getNodePtr( const string &relativePath, bool caseSensitive,
         // The key is numeric
 		if( isIndex( *pathIt ) ) {
             // Find child which uses this index as its key
-			uint32_t index = boost::lexical_cast<int32_t>( *pathIt );
+			uint32_t index = fromString<int32_t>( *pathIt );
 			uint32_t i = 0;
 			for ( node = curNode->getChildren().begin(); node != curNode->getChildren().end(); ++node, i++ ) {
 				if ( i == index ) {
@@ -675,32 +812,71 @@ void JsonTree::write( const fs::path &path, JsonTree::WriteOptions writeOptions
 
 void JsonTree::write( DataTargetRef target, JsonTree::WriteOptions writeOptions )
 {
-	// Declare output string
-	string jsonString = "";
+	JsonWriter writer( target, writeOptions.getIndented() );
 
 	try {
-		
-		// Create JsonCpp data to send to parser
-		Json::Value value = createNativeDoc( writeOptions );
-
-		// This routine serializes JsonCpp data and formats it
-		if( writeOptions.getIndented() ) {
-			jsonString = value.toStyledString();
-			boost::replace_all( jsonString, "\n", "\r\n" );
-		} else {
-			Json::FastWriter writer;
-			jsonString = writer.write( value );
+		bool createDocument = writeOptions.getCreateDocument() && mNodeType != NODE_NULL && mNodeType != NODE_UNKNOWN;
+		if( createDocument ) {
+			writer.startObject();
+			writer.key( mKey );
+		}
+		writeNode( writer );
+		if( createDocument ) {
+			writer.endObject();
 		}
-		jsonString += "\0";
 	}
-	catch ( ... ) {
+	catch( boost::bad_lexical_cast & ) {
 		throw ExcJsonParserError( "Unable to serialize JsonTree." );
 	}
 
-	// Save data to file
-	OStreamRef os = target->getStream();
-	os->writeData( jsonString.c_str(), jsonString.length() );
-	
+	writer.flush();
+}
+
+void JsonTree::writeNode( JsonWriter &writer ) const
+{
+	switch( mNodeType ) {
+		case NODE_ARRAY:
+			writer.startArray();
+			for( ConstIter childIt = mChildren.begin(); childIt != mChildren.end(); ++childIt ) {
+				childIt->writeNode( writer );
+			}
+			writer.endArray();
+		break;
+		case NODE_OBJECT:
+			writer.startObject();
+			for( ConstIter childIt = mChildren.begin(); childIt != mChildren.end(); ++childIt ) {
+				writer.key( childIt->mKey );
+				childIt->writeNode( writer );
+			}
+			writer.endObject();
+		break;
+		case NODE_VALUE:
+			switch( mValueType ) {
+				case VALUE_BOOL:
+					writer.value( fromString<bool>( mValue ) );
+				break;
+				case VALUE_DOUBLE:
+				case VALUE_INT:
+				case VALUE_UINT: {
+					// parsed and constructed numbers are already valid literals; anything else (inf, nan) goes through conversion
+					bool isInteger;
+					if( isNumberLiteral( mValue, &isInteger ) ) {
+						writer.numberLiteral( mValue );
+					}
+					else {
+						writer.value( fromString<double>( mValue ) );
+					}
+				}
+				break;
+				case VALUE_STRING:
+					writer.value( mValue );
+				break;
+			}
+		break;
+		default:
+			writer.nullValue();
+		break;
+	}
 }
 
 
@@ -747,4 +923,613 @@ ostream& operator<<( ostream &out, const JsonTree &json )
 	return out;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonReader
+
+bool JsonReader::Handler::numberValue( const std::string &literal, bool isInteger )
+{
+	uint64_t magnitude;
+	if( isInteger && parseIntegerMagnitude( literal, &magnitude ) ) {
+		if( literal[0] == '-' ) {
+			if( magnitude <= (uint64_t)numeric_limits<int64_t>::max() + 1 )
+				return intValue( (int64_t)( 0 - magnitude ) );
+		}
+		else if( magnitude <= (uint64_t)numeric_limits<int64_t>::max() )
+			return intValue( (int64_t)magnitude );
+		else
+			return uintValue( magnitude );
+	}
+
+	return doubleValue( strtod( literal.c_str(), NULL ) );
+}
+
+JsonReader::JsonReader( JsonTree::ParseOptions parseOptions )
+	: mParseOptions( parseOptions ), mBegin( NULL ), mPos( NULL ), mEnd( NULL ), mBeginOffset( 0 ), mLineOffset( 0 ), mLine( 1 )
+{
+}
+
+bool JsonReader::parse( DataSourceRef dataSource, Handler &handler )
+{
+	return parse( dataSource->createStream(), handler );
+}
+
+bool JsonReader::parse( IStreamRef stream, Handler &handler )
+{
+	mStream = stream;
+	mChunk.resize( 64 * 1024 );
+	mBegin = mPos = mEnd = &mChunk[0];
+	mBeginOffset = mLineOffset = 0;
+	mLine = 1;
+
+	bool result = parseDocument( handler );
+	mStream.reset();
+	return result;
+}
+
+bool JsonReader::parse( const std::string &jsonString, Handler &handler )
+{
+	// parse the string in place as a single chunk
+	mStream.reset();
+	mBegin = mPos = jsonString.c_str();
+	mEnd = mBegin + jsonString.size();
+	mBeginOffset = mLineOffset = 0;
+	mLine = 1;
+
+	return parseDocument( handler );
+}
+
+bool JsonReader::fill()
+{
+	if( ! mStream )
+		return false;
+
+	size_t bytesRead = mStream->readDataAvailable( &mChunk[0], mChunk.size() );
+	if( bytesRead == 0 )
+		return false;
+
+	mBeginOffset += mEnd - mBegin;
+	mBegin = mPos = &mChunk[0];
+	mEnd = mBegin + bytesRead;
+	return true;
+}
+
+bool JsonReader::parseDocument( Handler &handler )
+{
+	try {
+		skipWhitespace();
+		if( ! mParseOptions.getIgnoreErrors() && peek() != '{' && peek() != '[' )
+			error( "A valid JSON document must be either an array or an object value." );
+
+		// containers are tracked on an explicit stack so deeply nested documents can't overflow the call stack
+		vector<char> scopes;
+		while( true ) {
+			skipWhitespace();
+			bool continueScope = false;
+			switch( peek() ) {
+				case '{':
+					get();
+					if( ! handler.startObject() )
+						return false;
+					skipWhitespace();
+					if( peek() == '}' ) {
+						get();
+						if( ! handler.endObject() )
+							return false;
+					}
+					else {
+						scopes.push_back( '}' );
+						if( ! parseMemberName( handler ) )
+							return false;
+						continueScope = true;
+					}
+				break;
+				case '[':
+					get();
+					if( ! handler.startArray() )
+						return false;
+					skipWhitespace();
+					if( peek() == ']' ) {
+						get();
+						if( ! handler.endArray() )
+							return false;
+					}
+					else {
+						scopes.push_back( ']' );
+						continueScope = true;
+					}
+				break;
+				case '"':
+					get();
+					parseString( &mToken );
+					if( ! handler.stringValue( mToken ) )
+						return false;
+				break;
+				case 't':
+					parseLiteral( "true" );
+					if( ! handler.boolValue( true ) )
+						return false;
+				break;
+				case 'f':
+					parseLiteral( "false" );
+					if( ! handler.boolValue( false ) )
+						return false;
+				break;
+				case 'n':
+					parseLiteral( "null" );
+					if( ! handler.nullValue() )
+						return false;
+				break;
+				case '-': case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9': {
+					bool isInteger;
+					parseNumber( &mToken, &isInteger );
+					if( ! handler.numberValue( mToken, isInteger ) )
+						return false;
+				}
+				break;
+				default:
+					error( "Syntax error: value, object or array expected." );
+			}
+
+			if( continueScope )
+				continue;
+
+			// a value is complete; consume separators and closing brackets until the next value starts
+			while( true ) {
+				// trailing content after the root value is ignored
+				if( scopes.empty() )
+					return true;
+
+				skipWhitespace();
+				int c = get();
+				if( c == ',' ) {
+					if( scopes.back() == '}' && ! parseMemberName( handler ) )
+						return false;
+					break;
+				}
+				else if( c == scopes.back() ) {
+					scopes.pop_back();
+					if( ! ( c == '}' ? handler.endObject() : handler.endArray() ) )
+						return false;
+				}
+				else {
+					if( c >= 0 )
+						--mPos;
+					error( scopes.back() == '}' ? "Missing ',' or '}' in object declaration" : "Missing ',' or ']' in array declaration" );
+				}
+			}
+		}
+	}
+	catch( JsonTree::ExcJsonParserError & ) {
+		if( mParseOptions.getIgnoreErrors() )
+			return false;
+		throw;
+	}
+}
+
+bool JsonReader::parseMemberName( Handler &handler )
+{
+	skipWhitespace();
+	expect( '"', "Missing '}' or object member name" );
+	parseString( &mToken );
+	if( ! handler.key( mToken ) )
+		return false;
+	skipWhitespace();
+	expect( ':', "Missing ':' after object member name" );
+	return true;
+}
+
+void JsonReader::parseString( std::string *result )
+{
+	result->clear();
+	while( true ) {
+		// copy runs of unescaped characters a chunk at a time
+		const char *run = mPos;
+		while( mPos != mEnd && *mPos != '"' && *mPos != '\\' )
+			++mPos;
+		result->append( run, mPos );
+
+		int c = get();
+		if( c == '"' )
+			return;
+		else if( c == '\\' ) {
+			c = get();
+			switch( c ) {
+				case '"':	result->push_back( '"' ); break;
+				case '\\':	result->push_back( '\\' ); break;
+				case '/':	result->push_back( '/' ); break;
+				case 'b':	result->push_back( '\b' ); break;
+				case 'f':	result->push_back( '\f' ); break;
+				case 'n':	result->push_back( '\n' ); break;
+				case 'r':	result->push_back( '\r' ); break;
+				case 't':	result->push_back( '\t' ); break;
+				case 'u':	parseUnicodeEscape( result ); break;
+				default:
+					error( "Bad escape sequence in string" );
+			}
+		}
+		else if( c < 0 )
+			error( "Missing '\"' at end of string" );
+		// otherwise the run ended at the end of the chunk and get() refilled it; c is the next unescaped character
+		else
+			result->push_back( (char)c );
+	}
+}
+
+void JsonReader::parseUnicodeEscape( std::string *result )
+{
+	uint32_t codePoint = parseHex4();
+	if( codePoint >= 0xD800 && codePoint <= 0xDBFF ) {
+		if( get() != '\\' || get() != 'u' )
+			error( "Additional six characters expected to parse unicode surrogate pair." );
+		uint32_t low = parseHex4();
+		if( low < 0xDC00 || low > 0xDFFF )
+			error( "Bad unicode escape sequence in string: expecting the second half of a surrogate pair." );
+		codePoint = 0x10000 + ( ( codePoint - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+	}
+
+	// encode as UTF-8
+	if( codePoint < 0x80 ) {
+		result->push_back( (char)codePoint );
+	}
+	else if( codePoint < 0x800 ) {
+		result->push_back( (char)( 0xC0 | ( codePoint >> 6 ) ) );
+		result->push_back( (char)( 0x80 | ( codePoint & 0x3F ) ) );
+	}
+	else if( codePoint < 0x10000 ) {
+		result->push_back( (char)( 0xE0 | ( codePoint >> 12 ) ) );
+		result->push_back( (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+		result->push_back( (char)( 0x80 | ( codePoint & 0x3F ) ) );
+	}
+	else {
+		result->push_back( (char)( 0xF0 | ( codePoint >> 18 ) ) );
+		result->push_back( (char)( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) ) );
+		result->push_back( (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+		result->push_back( (char)( 0x80 | ( codePoint & 0x3F ) ) );
+	}
+}
+
+uint32_t JsonReader::parseHex4()
+{
+	uint32_t result = 0;
+	for( int i = 0; i < 4; ++i ) {
+		int c = get();
+		result <<= 4;
+		if( c >= '0' && c <= '9' )
+			result += c - '0';
+		else if( c >= 'a' && c <= 'f' )
+			result += c - 'a' + 10;
+		else if( c >= 'A' && c <= 'F' )
+			result += c - 'A' + 10;
+		else
+			error( "Bad unicode escape sequence in string: hexadecimal digit expected." );
+	}
+	return result;
+}
+
+void JsonReader::parseNumber( std::string *result, bool *isInteger )
+{
+	result->clear();
+	while( true ) {
+		int c = peek();
+		if( ( c >= '0' && c <= '9' ) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' ) {
+			result->push_back( (char)c );
+			++mPos;
+		}
+		else
+			break;
+	}
+
+	if( ! isNumberLiteral( *result, isInteger ) )
+		error( "'" + *result + "' is not a number." );
+}
+
+void JsonReader::parseLiteral( const char *literal )
+{
+	for( const char *p = literal; *p; ++p ) {
+		if( get() != *p )
+			error( "Syntax error: value, object or array expected." );
+	}
+}
+
+void JsonReader::skipWhitespace()
+{
+	while( true ) {
+		int c = peek();
+		if( c == ' ' || c == '\t' || c == '\r' ) {
+			++mPos;
+		}
+		else if( c == '\n' ) {
+			++mPos;
+			++mLine;
+			mLineOffset = mBeginOffset + ( mPos - mBegin );
+		}
+		else if( c == '/' && mParseOptions.getAllowComments() ) {
+			++mPos;
+			c = get();
+			if( c == '/' ) {
+				while( peek() >= 0 && peek() != '\n' )
+					++mPos;
+			}
+			else if( c == '*' ) {
+				int prev = 0;
+				while( ( c = get() ) >= 0 && ! ( prev == '*' && c == '/' ) ) {
+					if( c == '\n' ) {
+						++mLine;
+						mLineOffset = mBeginOffset + ( mPos - mBegin );
+					}
+					prev = c;
+				}
+				if( c < 0 )
+					error( "Unterminated comment" );
+			}
+			else
+				error( "Syntax error: value, object or array expected." );
+		}
+		else
+			return;
+	}
+}
+
+void JsonReader::expect( char c, const char *message )
+{
+	if( peek() != (unsigned char)c )
+		error( message );
+	++mPos;
+}
+
+void JsonReader::error( const std::string &message ) const
+{
+	uint64_t column = mBeginOffset + ( mPos - mBegin ) - mLineOffset + 1;
+	throw JsonTree::ExcJsonParserError( "* Line " + toString( mLine ) + ", Column " + toString( column ) + "\n  " + message + "\n" );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonWriter
+
+JsonWriter::JsonWriter( DataTargetRef target, bool indented )
+	: mStream( target->getStream() ), mIndented( indented ), mHasKey( false )
+{
+}
+
+JsonWriter::JsonWriter( OStreamRef stream, bool indented )
+	: mStream( stream ), mIndented( indented ), mHasKey( false )
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+	try {
+		flush();
+	}
+	catch( ... ) {
+	}
+}
+
+JsonWriter& JsonWriter::startObject()
+{
+	beginValue();
+	mBuffer += '{';
+	mScopes.push_back( Scope( true ) );
+	return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+	CI_ASSERT_MSG( ! mScopes.empty() && mScopes.back().mIsObject && ! mHasKey, "endObject() doesn't match an open object" );
+	bool hasMembers = mScopes.back().mCount > 0;
+	mScopes.pop_back();
+	if( hasMembers )
+		newline();
+	mBuffer += '}';
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::startArray()
+{
+	beginValue();
+	mBuffer += '[';
+	mScopes.push_back( Scope( false ) );
+	return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+	CI_ASSERT_MSG( ! mScopes.empty() && ! mScopes.back().mIsObject, "endArray() doesn't match an open array" );
+	bool hasElements = mScopes.back().mCount > 0;
+	mScopes.pop_back();
+	if( hasElements )
+		newline();
+	mBuffer += ']';
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::key( const std::string &key )
+{
+	CI_ASSERT_MSG( ! mScopes.empty() && mScopes.back().mIsObject && ! mHasKey, "key() is only valid before each value in an object" );
+	if( mScopes.back().mCount++ > 0 )
+		mBuffer += ',';
+	newline();
+	writeString( key );
+	mBuffer += mIndented ? " : " : ":";
+	mHasKey = true;
+	return *this;
+}
+
+JsonWriter& JsonWriter::nullValue()
+{
+	beginValue();
+	mBuffer += "null";
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( bool value )
+{
+	beginValue();
+	mBuffer += value ? "true" : "false";
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( int value )
+{
+	return this->value( (int64_t)value );
+}
+
+JsonWriter& JsonWriter::value( uint32_t value )
+{
+	return this->value( (uint64_t)value );
+}
+
+JsonWriter& JsonWriter::value( int64_t value )
+{
+	char buffer[32];
+	char *end = buffer + sizeof( buffer );
+	char *p = end;
+	uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+	do {
+		*--p = (char)( '0' + magnitude % 10 );
+		magnitude /= 10;
+	} while( magnitude );
+	if( value < 0 )
+		*--p = '-';
+
+	beginValue();
+	mBuffer.append( p, end );
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( uint64_t value )
+{
+	char buffer[32];
+	char *end = buffer + sizeof( buffer );
+	char *p = end;
+	do {
+		*--p = (char)( '0' + value % 10 );
+		value /= 10;
+	} while( value );
+
+	beginValue();
+	mBuffer.append( p, end );
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( float value )
+{
+	return this->value( (double)value );
+}
+
+JsonWriter& JsonWriter::value( double value )
+{
+	// infinity and NaN have no JSON representation; ( value - value ) is NaN for both
+	if( value - value != 0 )
+		return nullValue();
+
+	char buffer[32];
+#if (defined (CINDER_MSW ) || defined( CINDER_WINRT ))
+	sprintf_s( buffer, "%.17g", value );
+#else
+	sprintf( buffer, "%.17g", value );
+#endif
+
+	beginValue();
+	mBuffer += buffer;
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( const std::string &value )
+{
+	beginValue();
+	writeString( value );
+	endValue();
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( const char *value )
+{
+	return this->value( string( value ) );
+}
+
+JsonWriter& JsonWriter::numberLiteral( const std::string &literal )
+{
+	beginValue();
+	mBuffer += literal;
+	endValue();
+	return *this;
+}
+
+void JsonWriter::flush()
+{
+	if( ! mBuffer.empty() ) {
+		mStream->writeData( mBuffer.c_str(), mBuffer.size() );
+		mBuffer.clear();
+	}
+}
+
+void JsonWriter::beginValue()
+{
+	if( mScopes.empty() )
+		return;
+
+	if( mScopes.back().mIsObject ) {
+		CI_ASSERT_MSG( mHasKey, "values inside an object must be preceded by key()" );
+		mHasKey = false;
+	}
+	else {
+		if( mScopes.back().mCount++ > 0 )
+			mBuffer += ',';
+		newline();
+	}
+}
+
+void JsonWriter::endValue()
+{
+	// terminate the document like JsonCpp's writers do
+	if( mScopes.empty() )
+		mBuffer += mIndented ? "\r\n" : "\n";
+
+	if( mBuffer.size() >= 64 * 1024 )
+		flush();
+}
+
+void JsonWriter::newline()
+{
+	if( mIndented ) {
+		mBuffer += "\r\n";
+		mBuffer.append( mScopes.size() * 3, ' ' );
+	}
+}
+
+void JsonWriter::writeString( const std::string &s )
+{
+	mBuffer += '"';
+	for( string::const_iterator charIt = s.begin(); charIt != s.end(); ++charIt ) {
+		unsigned char c = (unsigned char)*charIt;
+		switch( c ) {
+			case '"':	mBuffer += "\\\""; break;
+			case '\\':	mBuffer += "\\\\"; break;
+			case '\b':	mBuffer += "\\b"; break;
+			case '\f':	mBuffer += "\\f"; break;
+			case '\n':	mBuffer += "\\n"; break;
+			case '\r':	mBuffer += "\\r"; break;
+			case '\t':	mBuffer += "\\t"; break;
+			default:
+				if( c < 0x20 ) {
+					static const char *hexDigits = "0123456789abcdef";
+					mBuffer += "\\u00";
+					mBuffer += hexDigits[c >> 4];
+					mBuffer += hexDigits[c & 0xF];
+				}
+				else
+					mBuffer += (char)c;
+		}
+	}
+	mBuffer += '"';
+}
+
 } // namespace cinder
@@ -0,0 +1,233 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/MemoryStats.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#if defined( _MSC_VER )
+	#define CI_MEMORY_STATS_THREAD_LOCAL __declspec( thread )
+#else
+	#define CI_MEMORY_STATS_THREAD_LOCAL __thread
+#endif
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// owned by a registry that is never destroyed, so that resources released during static destruction can still be counted
+struct Registry {
+	Registry() : mEnabled( false ) {}
+
+	atomic<bool>												mEnabled;
+	mutex														mMutex;
+	map<pair<string, bool>, unique_ptr<MemoryStats::Category> >	mCategories;
+};
+
+Registry* getRegistry()
+{
+	static Registry *sRegistry = new Registry;
+	return sRegistry;
+}
+
+// created before main(), so that getRegistry()'s initialization doesn't race
+Registry *sRegistryInit = getRegistry();
+
+CI_MEMORY_STATS_THREAD_LOCAL const char *sScopedCategoryName = 0;
+
+// precedes each block returned by MemoryStats::allocate(), in HEADER_SIZE bytes so that blocks keep operator new's 16 byte alignment
+struct AllocationHeader {
+	MemoryStats::Category	*mCategory;
+	size_t					mBytes;
+};
+
+const size_t HEADER_SIZE = 16;
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - MemoryStats::Category
+// ----------------------------------------------------------------------------------------------------
+
+MemoryStats::Category::Category( const string &name, bool gpu )
+	: mName( name ), mGpu( gpu ), mBytes( 0 ), mPeakBytes( 0 ), mNumAllocations( 0 )
+{
+}
+
+void MemoryStats::Category::add( int64_t bytes )
+{
+	const int64_t total = mBytes += bytes;
+	++mNumAllocations;
+
+	int64_t peak = mPeakBytes;
+	while( total > peak && ! mPeakBytes.compare_exchange_weak( peak, total ) )
+		;
+}
+
+void MemoryStats::Category::remove( int64_t bytes )
+{
+	mBytes -= bytes;
+	--mNumAllocations;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - MemoryStats
+// ----------------------------------------------------------------------------------------------------
+
+void MemoryStats::setEnabled( bool enable )
+{
+	getRegistry()->mEnabled = enable;
+}
+
+bool MemoryStats::isEnabled()
+{
+	return getRegistry()->mEnabled;
+}
+
+MemoryStats::Category* MemoryStats::getCategory( const string &name, bool gpu )
+{
+	Registry *registry = getRegistry();
+	lock_guard<mutex> lock( registry->mMutex );
+
+	unique_ptr<Category> &category = registry->mCategories[make_pair( name, gpu )];
+	if( ! category )
+		category.reset( new Category( name, gpu ) );
+	return category.get();
+}
+
+const char* MemoryStats::resolveCategoryName( const char *name )
+{
+	return sScopedCategoryName ? sScopedCategoryName : name;
+}
+
+vector<MemoryStats::Stats> MemoryStats::getStats()
+{
+	vector<Stats> result;
+	{
+		Registry *registry = getRegistry();
+		lock_guard<mutex> lock( registry->mMutex );
+
+		for( const auto &category : registry->mCategories ) {
+			Stats stats;
+			stats.mName = category.second->getName();
+			stats.mGpu = category.second->isGpu();
+			stats.mBytes = category.second->getBytes();
+			stats.mPeakBytes = category.second->getPeakBytes();
+			stats.mNumAllocations = category.second->getNumAllocations();
+			result.push_back( stats );
+		}
+	}
+
+	sort( result.begin(), result.end(), []( const Stats &a, const Stats &b ) { return a.mBytes > b.mBytes; } );
+	return result;
+}
+
+int64_t MemoryStats::getTotalBytes( bool gpu )
+{
+	Registry *registry = getRegistry();
+	lock_guard<mutex> lock( registry->mMutex );
+
+	int64_t result = 0;
+	for( const auto &category : registry->mCategories )
+		if( category.second->isGpu() == gpu )
+			result += category.second->getBytes();
+	return result;
+}
+
+void MemoryStats::resetPeaks()
+{
+	Registry *registry = getRegistry();
+	lock_guard<mutex> lock( registry->mMutex );
+
+	for( const auto &category : registry->mCategories )
+		category.second->mPeakBytes = category.second->getBytes();
+}
+
+void* MemoryStats::allocate( const char *categoryName, size_t bytes )
+{
+	uint8_t *block = static_cast<uint8_t*>( ::operator new( HEADER_SIZE + bytes ) );
+	AllocationHeader *header = reinterpret_cast<AllocationHeader*>( block );
+	header->mCategory = isEnabled() ? getCategory( resolveCategoryName( categoryName ) ) : 0;
+	header->mBytes = bytes;
+	if( header->mCategory )
+		header->mCategory->add( bytes );
+
+	return block + HEADER_SIZE;
+}
+
+void MemoryStats::deallocate( void *ptr )
+{
+	if( ! ptr )
+		return;
+
+	uint8_t *block = static_cast<uint8_t*>( ptr ) - HEADER_SIZE;
+	AllocationHeader *header = reinterpret_cast<AllocationHeader*>( block );
+	if( header->mCategory )
+		header->mCategory->remove( header->mBytes );
+	::operator delete( block );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - MemoryAllocation
+// ----------------------------------------------------------------------------------------------------
+
+void MemoryAllocation::set( int64_t bytes )
+{
+	release();
+	if( mCategoryName && bytes > 0 ) {
+		if( ! mCategory )
+			mCategory = MemoryStats::getCategory( mCategoryName, mGpu );
+		mCategory->add( bytes );
+		mBytes = bytes;
+	}
+}
+
+void MemoryAllocation::release()
+{
+	if( mBytes ) {
+		mCategory->remove( mBytes );
+		mBytes = 0;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ScopedMemoryCategory
+// ----------------------------------------------------------------------------------------------------
+
+ScopedMemoryCategory::ScopedMemoryCategory( const char *name )
+	: mPrevious( sScopedCategoryName )
+{
+	sScopedCategoryName = name;
+}
+
+ScopedMemoryCategory::~ScopedMemoryCategory()
+{
+	sScopedCategoryName = mPrevious;
+}
+
+} // namespace cinder
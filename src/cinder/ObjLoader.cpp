@@ -23,35 +23,36 @@
 */
 
 #include "cinder/ObjLoader.h"
+#include "cinder/TaskPool.h"
 
-#include <boost/lexical_cast.hpp>
-using boost::lexical_cast;
 #include <sstream>
 using std::ostringstream;
 
 #include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 using namespace std;
-using boost::make_tuple;
 
 namespace cinder {
 
 ObjLoader::ObjLoader( shared_ptr<IStreamCinder> stream, bool includeUVs )
-	: mStream( stream )
+	: mGroupFacesExpanded( false )
 {
-	parse( includeUVs );
+	parse( loadStreamBuffer( stream ), includeUVs );
 }
 
 ObjLoader::ObjLoader( DataSourceRef dataSource, bool includeUVs )
-	: mStream( dataSource->createStream() )
+	: mGroupFacesExpanded( false )
 {
-	parse( includeUVs );
+	parse( dataSource->getBuffer(), includeUVs );
 }
 
 ObjLoader::ObjLoader( DataSourceRef dataSource, DataSourceRef materialSource, bool includeUVs )
-    : mStream( dataSource->createStream() )
+	: mGroupFacesExpanded( false )
 {
     parseMaterial( materialSource->createStream() );
-    parse( includeUVs );
+    parse( dataSource->getBuffer(), includeUVs );
 }
     
 ObjLoader::~ObjLoader()
@@ -91,134 +92,527 @@ void ObjLoader::parseMaterial( std::shared_ptr<IStreamCinder> material )
         mMaterials[m.mName] = m;
 }
 
-void ObjLoader::parse( bool includeUVs )
+namespace {
+
+const uint8_t FACE_HAS_TEXCOORDS	= 1;
+const uint8_t FACE_HAS_NORMALS		= 2;
+const uint8_t FACE_EMPTY_TEXCOORD	= 4; // at least one vertex was written as "v//vn"
+
+// files are split into chunks of at least this size for parsing in parallel
+const size_t MIN_PARSE_CHUNK_SIZE	= 4 * 1024 * 1024;
+
+inline bool isSpace( char c )		{ return c == ' ' || c == '\t'; }
+inline bool isEndOfLine( char c )	{ return c == '\n' || c == '\r'; }
+inline bool isDigit( char c )		{ return c >= '0' && c <= '9'; }
+
+inline void skipSpaces( const char *&p, const char *end )
 {
-	Group *currentGroup;
-	mGroups.push_back( Group() );
-	currentGroup = &mGroups[mGroups.size()-1];
-	currentGroup->mBaseVertexOffset = currentGroup->mBaseTexCoordOffset = currentGroup->mBaseNormalOffset = 0;
+	while( p < end && isSpace( *p ) )
+		++p;
+}
 
-    const Material *currentMaterial = 0;
-    
-	size_t lineNumber = 0;
-	while( ! mStream->isEof() ) {
-		lineNumber++;
-		string line = mStream->readLine(), tag;
-        if( line.empty() || line[0] == '#' )
-            continue;
-        
-		stringstream ss( line );
-		ss >> tag;
-		if( tag == "v" ) { // vertex
-			Vec3f v;
-			ss >> v.x >> v.y >> v.z;
+inline void skipToken( const char *&p, const char *end )
+{
+	while( p < end && ! isSpace( *p ) && ! isEndOfLine( *p ) )
+		++p;
+}
+
+inline void skipLine( const char *&p, const char *end )
+{
+	while( p < end && *p != '\n' )
+		++p;
+	if( p < end )
+		++p;
+}
+
+// returns true and advances \a p if the line at \a p starts with \a tag followed by whitespace
+inline bool matchTag( const char *&p, const char *end, const char *tag, size_t tagLength )
+{
+	if( (size_t)( end - p ) <= tagLength || memcmp( p, tag, tagLength ) != 0 || ! isSpace( p[tagLength] ) )
+		return false;
+	p += tagLength;
+	return true;
+}
+
+inline bool parseInt( const char *&p, const char *end, int *result )
+{
+	const char *s = p;
+	bool negative = false;
+	if( s < end && ( *s == '-' || *s == '+' ) )
+		negative = ( *s++ == '-' );
+	if( s == end || ! isDigit( *s ) )
+		return false;
+
+	int value = 0;
+	while( s < end && isDigit( *s ) )
+		value = value * 10 + ( *s++ - '0' );
+
+	*result = negative ? -value : value;
+	p = s;
+	return true;
+}
+
+// Parses a decimal float without going through the locale-aware stream machinery. Anything unusual, such as "inf" or "nan", falls back to strtod().
+bool parseFloat( const char *&p, const char *end, float *result )
+{
+	static const double sPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+											1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char *s = p;
+	bool negative = false;
+	if( s < end && ( *s == '-' || *s == '+' ) )
+		negative = ( *s++ == '-' );
+
+	// accumulate up to 19 significant digits, which fit in a uint64_t
+	uint64_t mantissa = 0;
+	int exponent = 0, numDigits = 0, numSignificant = 0;
+	for( ; s < end && isDigit( *s ); ++s, ++numDigits ) {
+		if( numSignificant < 19 ) {
+			mantissa = mantissa * 10 + ( *s - '0' );
+			if( mantissa )
+				++numSignificant;
+		}
+		else
+			++exponent;
+	}
+	if( s < end && *s == '.' ) {
+		for( ++s; s < end && isDigit( *s ); ++s, ++numDigits ) {
+			if( numSignificant < 19 ) {
+				mantissa = mantissa * 10 + ( *s - '0' );
+				--exponent;
+				if( mantissa )
+					++numSignificant;
+			}
+		}
+	}
+
+	if( numDigits == 0 ) {
+		char token[64];
+		size_t length = 0;
+		for( const char *t = p; t < end && length < sizeof( token ) - 1 && ! isSpace( *t ) && ! isEndOfLine( *t ); ++t )
+			token[length++] = *t;
+		token[length] = 0;
+
+		char *tokenEnd;
+		double value = strtod( token, &tokenEnd );
+		if( tokenEnd == token )
+			return false;
+		*result = (float)value;
+		p += tokenEnd - token;
+		return true;
+	}
+
+	if( s < end && ( *s == 'e' || *s == 'E' ) ) {
+		const char *e = s + 1;
+		int exponentPart;
+		if( parseInt( e, end, &exponentPart ) ) {
+			exponent += exponentPart;
+			s = e;
+		}
+	}
+
+	double value = (double)mantissa;
+	if( exponent < 0 )
+		value = ( exponent >= -22 ) ? value / sPowersOf10[-exponent] : value * pow( 10.0, exponent );
+	else if( exponent > 0 )
+		value = ( exponent <= 22 ) ? value * sPowersOf10[exponent] : value * pow( 10.0, exponent );
+
+	*result = (float)( negative ? -value : value );
+	p = s;
+	return true;
+}
+
+// returns the zero-based index for the one-based OBJ \a index, leaving relative (negative) indices to be resolved once the group's base offset is known
+inline int toZeroBased( int index )
+{
+	return ( index > 0 ) ? index - 1 : ( index < 0 ? index : 0 );
+}
+
+} // anonymous namespace
+
+//! The results of parsing one chunk of the file, with "g" and "usemtl" recorded as events so that chunks can be merged in order afterwards
+struct ObjLoader::ParseChunk {
+	struct Event {
+		bool			mIsGroup; // otherwise a material
+		size_t			mFaceIndex; // number of faces in this chunk preceding the event
+		size_t			mNumVertices, mNumTexCoords, mNumNormals; // same, for the attributes
+		std::string		mName;
+	};
+
+	ParseChunk( const char *begin, const char *end )
+		: mBegin( begin ), mEnd( end ), mHasRelativeIndices( false )
+	{}
+
+	void	parse( bool includeUVs );
+	void	parseFace( const char *p, const char *end, bool includeUVs );
+	void	addEvent( bool isGroup, const char *nameBegin, const char *nameEnd );
+
+	const char				*mBegin, *mEnd;
+	std::vector<Vec3f>		mVertices, mNormals;
+	std::vector<Vec2f>		mTexCoords;
+	FaceList				mFaces;
+	std::vector<Event>		mEvents;
+	bool					mHasRelativeIndices;
+};
+
+void ObjLoader::ParseChunk::parse( bool includeUVs )
+{
+	const char *p = mBegin;
+	while( p < mEnd ) {
+		skipSpaces( p, mEnd );
+		if( p == mEnd )
+			break;
+
+		const char *lineBegin = p;
+		const char *lineEnd = p;
+		while( lineEnd < mEnd && *lineEnd != '\n' )
+			++lineEnd;
+		const char *next = ( lineEnd < mEnd ) ? lineEnd + 1 : lineEnd;
+		if( lineEnd > lineBegin && lineEnd[-1] == '\r' )
+			--lineEnd;
+
+		if( matchTag( p, lineEnd, "v", 1 ) ) { // vertex
+			Vec3f v( Vec3f::zero() );
+			skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &v.x );
+			skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &v.y );
+			skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &v.z );
 			mVertices.push_back( v );
 		}
-		else if( tag == "vt" ) { // vertex texture coordinates
+		else if( matchTag( p, lineEnd, "vt", 2 ) ) { // vertex texture coordinates
 			if( includeUVs ) {
-				Vec2f tex;
-				ss >> tex.x >> tex.y;
+				Vec2f tex( Vec2f::zero() );
+				skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &tex.x );
+				skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &tex.y );
 				mTexCoords.push_back( tex );
 			}
 		}
-		else if( tag == "vn" ) { // vertex normals
-			Vec3f v;
-			ss >> v.x >> v.y >> v.z;
+		else if( matchTag( p, lineEnd, "vn", 2 ) ) { // vertex normals
+			Vec3f v( Vec3f::zero() );
+			skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &v.x );
+			skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &v.y );
+			skipSpaces( p, lineEnd ); parseFloat( p, lineEnd, &v.z );
 			mNormals.push_back( v.normalized() );
 		}
-		else if( tag == "f" ) { // face
-			parseFace( currentGroup, currentMaterial, line, includeUVs );
+		else if( matchTag( p, lineEnd, "f", 1 ) ) { // face
+			parseFace( p, lineEnd, includeUVs );
 		}
-		else if( tag == "g" ) { // group
-			if( ! currentGroup->mFaces.empty() )
-				mGroups.push_back( Group() );
-			currentGroup = &mGroups[mGroups.size()-1];
-			currentGroup->mBaseVertexOffset = mVertices.size();
-			currentGroup->mBaseTexCoordOffset = mTexCoords.size();
-			currentGroup->mBaseNormalOffset = mNormals.size();
-			currentGroup->mName = line.substr( line.find( ' ' ) + 1 );
+		else if( matchTag( p, lineEnd, "g", 1 ) ) { // group
+			addEvent( true, p + 1, lineEnd );
 		}
-        else if( tag == "usemtl") { // material
-            string tag;
-            ss >> tag;
-            std::map<std::string, Material>::const_iterator m = mMaterials.find(tag);
-            if( m != mMaterials.end() ) {
-                currentMaterial = &m->second;
-            }
-        }
+		else if( lineEnd - p == 1 && *p == 'g' ) { // unnamed group, which is named "g" for consistency with the original parser
+			addEvent( true, p, lineEnd );
+		}
+		else if( matchTag( p, lineEnd, "usemtl", 6 ) ) { // material
+			skipSpaces( p, lineEnd );
+			const char *nameBegin = p;
+			skipToken( p, lineEnd );
+			addEvent( false, nameBegin, p );
+		}
+
+		p = next;
 	}
 }
 
-void ObjLoader::parseFace( Group *group, const Material *material, const std::string &s, bool includeUVs )
+void ObjLoader::ParseChunk::parseFace( const char *p, const char *end, bool includeUVs )
 {
-	ObjLoader::Face result;
-	result.mNumVertices = 0;
-    result.mMaterial = material;
-
-	size_t offset = 2; // account for "f "
-	size_t length = s.length();
-	while( offset < length ) {
-		size_t endOfTriple, firstSlashOffset, secondSlashOffset;
-	
-		while( s[offset] == ' ' )
-			++offset;
-	
-		// find the end of this triple "v/vt/vn"
-		endOfTriple = s.find( ' ', offset );
-		if( endOfTriple == string::npos ) endOfTriple = length;
-		firstSlashOffset = s.find( '/', offset );
-		if( firstSlashOffset != string::npos ) {
-			secondSlashOffset = s.find( '/', firstSlashOffset + 1 );
-			if( secondSlashOffset > endOfTriple ) secondSlashOffset = string::npos;
+	const size_t first = mFaces.mVertexIndices.size();
+	size_t numVertices = 0, numTexCoords = 0, numNormals = 0;
+	bool emptyTexCoord = false;
+
+	while( true ) {
+		skipSpaces( p, end );
+		if( p == end )
+			break;
+
+		// "v", "v/vt", "v//vn" or "v/vt/vn"
+		int vertexIndex, texCoordIndex = 0, normalIndex = 0;
+		if( ! parseInt( p, end, &vertexIndex ) ) {
+			skipToken( p, end );
+			continue;
 		}
-		else
-			secondSlashOffset = string::npos;
-		
-		// process the vertex index
-		int vertexIndex = (firstSlashOffset != string::npos) ? 
-            lexical_cast<int>( s.substr( offset, firstSlashOffset - offset ) ) : 
-            lexical_cast<int>( s.substr( offset, endOfTriple - offset));
-        
-		if( vertexIndex < 0 )
-			result.mVertexIndices.push_back( group->mBaseVertexOffset + vertexIndex );
-		else
-			result.mVertexIndices.push_back( vertexIndex - 1 );
-			
-		// process the tex coord index
-		if( includeUVs && ( firstSlashOffset != string::npos ) ) {
-			size_t numSize = ( secondSlashOffset == string::npos ) ? ( endOfTriple - firstSlashOffset - 1 ) : secondSlashOffset - firstSlashOffset - 1;
-			if( numSize > 0 ) {
-				int texCoordIndex = lexical_cast<int>( s.substr( firstSlashOffset + 1, numSize ) );
-				if( texCoordIndex < 0 )
-					result.mTexCoordIndices.push_back( group->mBaseTexCoordOffset + texCoordIndex );
+		if( p < end && *p == '/' ) {
+			++p;
+			if( parseInt( p, end, &texCoordIndex ) ) {
+				if( includeUVs )
+					++numTexCoords;
 				else
-					result.mTexCoordIndices.push_back( texCoordIndex - 1 );
-				if( group->mFaces.empty() )
-					group->mHasTexCoords = true;
+					texCoordIndex = 0;
+			}
+			else if( includeUVs )
+				emptyTexCoord = true;
+
+			if( p < end && *p == '/' ) {
+				++p;
+				if( parseInt( p, end, &normalIndex ) )
+					++numNormals;
 			}
-			else
-				group->mHasTexCoords = false;
 		}
-		else if( group->mFaces.empty() ) // if this is the first face, let's note that this group has no tex coords
-			group->mHasTexCoords = false;
-			
-		// process the normal index
-		if( secondSlashOffset != string::npos ) {
-			int normalIndex = lexical_cast<int>( s.substr( secondSlashOffset + 1, endOfTriple - secondSlashOffset - 1 ) );
-			if( normalIndex < 0 )
-				result.mNormalIndices.push_back( group->mBaseNormalOffset + normalIndex );
-			else
-				result.mNormalIndices.push_back( normalIndex - 1 );
-			group->mHasNormals = true;
+		skipToken( p, end );
+
+		mHasRelativeIndices = mHasRelativeIndices || vertexIndex < 0 || texCoordIndex < 0 || normalIndex < 0;
+		mFaces.mVertexIndices.push_back( toZeroBased( vertexIndex ) );
+		mFaces.mTexCoordIndices.push_back( toZeroBased( texCoordIndex ) );
+		mFaces.mNormalIndices.push_back( toZeroBased( normalIndex ) );
+		++numVertices;
+	}
+
+	// faces with fewer than 3 vertices have no triangles, so they're dropped
+	if( numVertices < 3 ) {
+		mFaces.mVertexIndices.resize( first );
+		mFaces.mTexCoordIndices.resize( first );
+		mFaces.mNormalIndices.resize( first );
+		return;
+	}
+
+	uint8_t flags = 0;
+	if( numTexCoords == numVertices )
+		flags |= FACE_HAS_TEXCOORDS;
+	if( numNormals == numVertices )
+		flags |= FACE_HAS_NORMALS;
+	if( emptyTexCoord )
+		flags |= FACE_EMPTY_TEXCOORD;
+
+	mFaces.mFlags.push_back( flags );
+	mFaces.mOffsets.push_back( (uint32_t)mFaces.mVertexIndices.size() );
+}
+
+void ObjLoader::ParseChunk::addEvent( bool isGroup, const char *nameBegin, const char *nameEnd )
+{
+	Event event;
+	event.mIsGroup = isGroup;
+	event.mFaceIndex = mFaces.getNumFaces();
+	event.mNumVertices = mVertices.size();
+	event.mNumTexCoords = mTexCoords.size();
+	event.mNumNormals = mNormals.size();
+	event.mName.assign( nameBegin, nameEnd );
+	mEvents.push_back( event );
+}
+
+//! Open addressing hash table mapping unique (vertex, texCoord, normal) index triples to their index in the destination TriMesh
+class ObjLoader::VertexTable {
+  public:
+	VertexTable( size_t expectedSize )
+		: mSize( 0 )
+	{
+		size_t capacity = 64;
+		while( capacity < expectedSize * 2 )
+			capacity *= 2;
+		mEntries.resize( capacity );
+		mMask = capacity - 1;
+	}
+
+	//! Returns the index stored for the triple, or inserts \a newIndex and sets \a inserted to true if it isn't present yet
+	uint32_t insert( int vertex, int texCoord, int normal, uint32_t newIndex, bool *inserted )
+	{
+		if( ( mSize + 1 ) * 2 > mEntries.size() )
+			grow();
+
+		size_t i = hash( vertex, texCoord, normal ) & mMask;
+		while( true ) {
+			Entry &entry = mEntries[i];
+			if( entry.mIndex == EMPTY ) {
+				entry.mVertex = vertex;
+				entry.mTexCoord = texCoord;
+				entry.mNormal = normal;
+				entry.mIndex = newIndex;
+				++mSize;
+				*inserted = true;
+				return newIndex;
+			}
+			if( entry.mVertex == vertex && entry.mTexCoord == texCoord && entry.mNormal == normal ) {
+				*inserted = false;
+				return entry.mIndex;
+			}
+			i = ( i + 1 ) & mMask;
 		}
-		else if( group->mFaces.empty() ) // if this is the first face, let's note that this group has no normals
-			group->mHasNormals = false;
-		
-		offset = endOfTriple + 1;
-		result.mNumVertices++;
 	}
-	
-	group->mFaces.push_back( result );
+
+  private:
+	static const uint32_t EMPTY = 0xFFFFFFFF;
+
+	struct Entry {
+		Entry() : mIndex( EMPTY ) {}
+		int			mVertex, mTexCoord, mNormal;
+		uint32_t	mIndex;
+	};
+
+	static size_t hash( int vertex, int texCoord, int normal )
+	{
+		uint64_t h = (uint32_t)vertex * 0x9E3779B97F4A7C15ULL;
+		h ^= ( (uint64_t)(uint32_t)texCoord * 0xC2B2AE3D27D4EB4FULL ) + ( h >> 29 );
+		h ^= ( (uint64_t)(uint32_t)normal * 0x165667B19E3779F9ULL ) + ( h >> 32 );
+		return (size_t)( h ^ ( h >> 31 ) );
+	}
+
+	void grow()
+	{
+		std::vector<Entry> entries( mEntries.size() * 2 );
+		entries.swap( mEntries );
+		mMask = mEntries.size() - 1;
+		for( vector<Entry>::const_iterator entryIt = entries.begin(); entryIt != entries.end(); ++entryIt ) {
+			if( entryIt->mIndex == EMPTY )
+				continue;
+			size_t i = hash( entryIt->mVertex, entryIt->mTexCoord, entryIt->mNormal ) & mMask;
+			while( mEntries[i].mIndex != EMPTY )
+				i = ( i + 1 ) & mMask;
+			mEntries[i] = *entryIt;
+		}
+	}
+
+	std::vector<Entry>	mEntries;
+	size_t				mMask, mSize;
+};
+
+void ObjLoader::parse( const Buffer &buffer, bool includeUVs )
+{
+	const char *data = reinterpret_cast<const char *>( buffer.getData() );
+	const char *dataEnd = data + buffer.getDataSize();
+
+	// split the file into chunks at line boundaries, one or more per thread for large files
+	size_t numChunks = std::max<size_t>( 1, buffer.getDataSize() / MIN_PARSE_CHUNK_SIZE );
+	if( numChunks > 1 )
+		numChunks = std::min( numChunks, ( TaskPool::get()->getNumThreads() + 1 ) * 4 );
+
+	vector<ParseChunk> chunks;
+	const char *chunkBegin = data;
+	for( size_t c = 0; c < numChunks && chunkBegin < dataEnd; ++c ) {
+		const char *chunkEnd = ( c == numChunks - 1 ) ? dataEnd : std::max( chunkBegin, data + buffer.getDataSize() / numChunks * ( c + 1 ) );
+		skipLine( chunkEnd, dataEnd );
+		chunks.push_back( ParseChunk( chunkBegin, chunkEnd ) );
+		chunkBegin = chunkEnd;
+	}
+
+	if( chunks.size() > 1 ) {
+		TaskPool::get()->parallelFor( 0, chunks.size(), [&]( size_t begin, size_t end ) {
+			for( size_t c = begin; c < end; ++c )
+				chunks[c].parse( includeUVs );
+		}, 1 );
+	}
+	else if( ! chunks.empty() )
+		chunks[0].parse( includeUVs );
+
+	// merge the chunks in order, replaying group and material changes
+	size_t totalVertices = 0, totalTexCoords = 0, totalNormals = 0;
+	for( vector<ParseChunk>::const_iterator chunkIt = chunks.begin(); chunkIt != chunks.end(); ++chunkIt ) {
+		totalVertices += chunkIt->mVertices.size();
+		totalTexCoords += chunkIt->mTexCoords.size();
+		totalNormals += chunkIt->mNormals.size();
+	}
+	mVertices.reserve( totalVertices );
+	mTexCoords.reserve( totalTexCoords );
+	mNormals.reserve( totalNormals );
+
+	mGroups.push_back( Group() );
+	mFaceLists.push_back( FaceList() );
+	mGroups.back().mBaseVertexOffset = mGroups.back().mBaseTexCoordOffset = mGroups.back().mBaseNormalOffset = 0;
+	mGroups.back().mHasTexCoords = mGroups.back().mHasNormals = false;
+
+	const Material *currentMaterial = 0;
+	bool currentGroupHasEmptyTexCoords = false;
+
+	for( vector<ParseChunk>::iterator chunkIt = chunks.begin(); chunkIt != chunks.end(); ++chunkIt ) {
+		const ParseChunk &chunk = *chunkIt;
+		const int vertexOffset = (int)mVertices.size(), texCoordOffset = (int)mTexCoords.size(), normalOffset = (int)mNormals.size();
+
+		size_t face = 0, event = 0;
+		while( face < chunk.mFaces.getNumFaces() || event < chunk.mEvents.size() ) {
+			// apply all events preceding the next face
+			for( ; event < chunk.mEvents.size() && chunk.mEvents[event].mFaceIndex == face; ++event ) {
+				const ParseChunk::Event &e = chunk.mEvents[event];
+				if( e.mIsGroup ) {
+					if( mFaceLists.back().getNumFaces() ) {
+						mGroups.push_back( Group() );
+						mFaceLists.push_back( FaceList() );
+					}
+					Group &group = mGroups.back();
+					group.mBaseVertexOffset = vertexOffset + (int)e.mNumVertices;
+					group.mBaseTexCoordOffset = texCoordOffset + (int)e.mNumTexCoords;
+					group.mBaseNormalOffset = normalOffset + (int)e.mNumNormals;
+					group.mName = e.mName;
+					group.mHasTexCoords = group.mHasNormals = false;
+					currentGroupHasEmptyTexCoords = false;
+				}
+				else {
+					std::map<std::string, Material>::const_iterator m = mMaterials.find( e.mName );
+					if( m != mMaterials.end() )
+						currentMaterial = &m->second;
+				}
+			}
+
+			// copy the run of faces up to the next event into the current group
+			const size_t runEnd = ( event < chunk.mEvents.size() ) ? chunk.mEvents[event].mFaceIndex : chunk.mFaces.getNumFaces();
+			if( runEnd == face )
+				continue;
+
+			Group &group = mGroups.back();
+			FaceList &faces = mFaceLists.back();
+			const size_t indexBegin = chunk.mFaces.mOffsets[face], indexEnd = chunk.mFaces.mOffsets[runEnd];
+			const size_t destIndexBegin = faces.mVertexIndices.size();
+
+			if( faces.getNumFaces() == 0 )
+				group.mHasTexCoords = ( chunk.mFaces.mFlags[face] & FACE_HAS_TEXCOORDS ) != 0;
+			for( size_t f = face; f < runEnd; ++f ) {
+				const uint8_t flags = chunk.mFaces.mFlags[f];
+				group.mHasNormals = group.mHasNormals || ( flags & FACE_HAS_NORMALS );
+				currentGroupHasEmptyTexCoords = currentGroupHasEmptyTexCoords || ( flags & FACE_EMPTY_TEXCOORD );
+				faces.mOffsets.push_back( (uint32_t)( chunk.mFaces.mOffsets[f + 1] - indexBegin + destIndexBegin ) );
+			}
+			if( currentGroupHasEmptyTexCoords )
+				group.mHasTexCoords = false;
+
+			faces.mFlags.insert( faces.mFlags.end(), chunk.mFaces.mFlags.begin() + face, chunk.mFaces.mFlags.begin() + runEnd );
+			faces.mMaterials.insert( faces.mMaterials.end(), runEnd - face, currentMaterial );
+			faces.mVertexIndices.insert( faces.mVertexIndices.end(), chunk.mFaces.mVertexIndices.begin() + indexBegin, chunk.mFaces.mVertexIndices.begin() + indexEnd );
+			faces.mTexCoordIndices.insert( faces.mTexCoordIndices.end(), chunk.mFaces.mTexCoordIndices.begin() + indexBegin, chunk.mFaces.mTexCoordIndices.begin() + indexEnd );
+			faces.mNormalIndices.insert( faces.mNormalIndices.end(), chunk.mFaces.mNormalIndices.begin() + indexBegin, chunk.mFaces.mNormalIndices.begin() + indexEnd );
+
+			// relative indices count back from the start of the group
+			if( chunk.mHasRelativeIndices ) {
+				for( size_t i = destIndexBegin; i < faces.mVertexIndices.size(); ++i ) {
+					if( faces.mVertexIndices[i] < 0 )
+						faces.mVertexIndices[i] += group.mBaseVertexOffset;
+					if( faces.mTexCoordIndices[i] < 0 )
+						faces.mTexCoordIndices[i] += group.mBaseTexCoordOffset;
+					if( faces.mNormalIndices[i] < 0 )
+						faces.mNormalIndices[i] += group.mBaseNormalOffset;
+				}
+			}
+
+			face = runEnd;
+		}
+
+		mVertices.insert( mVertices.end(), chunk.mVertices.begin(), chunk.mVertices.end() );
+		mTexCoords.insert( mTexCoords.end(), chunk.mTexCoords.begin(), chunk.mTexCoords.end() );
+		mNormals.insert( mNormals.end(), chunk.mNormals.begin(), chunk.mNormals.end() );
+
+		// release each chunk's memory as soon as it has been merged
+		*chunkIt = ParseChunk( 0, 0 );
+	}
+}
+
+const vector<ObjLoader::Group>& ObjLoader::getGroups() const
+{
+	if( ! mGroupFacesExpanded ) {
+		for( size_t g = 0; g < mGroups.size(); ++g ) {
+			const FaceList &faces = mFaceLists[g];
+			vector<Face> &groupFaces = mGroups[g].mFaces;
+			groupFaces.resize( faces.getNumFaces() );
+			for( size_t f = 0; f < faces.getNumFaces(); ++f ) {
+				const size_t begin = faces.mOffsets[f], end = faces.mOffsets[f + 1];
+				Face &face = groupFaces[f];
+				face.mNumVertices = (int)( end - begin );
+				face.mVertexIndices.assign( faces.mVertexIndices.begin() + begin, faces.mVertexIndices.begin() + end );
+				if( faces.mFlags[f] & FACE_HAS_TEXCOORDS )
+					face.mTexCoordIndices.assign( faces.mTexCoordIndices.begin() + begin, faces.mTexCoordIndices.begin() + end );
+				if( faces.mFlags[f] & FACE_HAS_NORMALS )
+					face.mNormalIndices.assign( faces.mNormalIndices.begin() + begin, faces.mNormalIndices.begin() + end );
+				face.mMaterial = faces.mMaterials[f];
+			}
+		}
+		mGroupFacesExpanded = true;
+	}
+
+	return mGroups;
 }
 
 void ObjLoader::load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool loadNormals, boost::tribool loadTexCoords, bool optimizeVertices )
@@ -236,25 +630,12 @@ void ObjLoader::load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool lo
 	else normals = mGroups[groupIndex].mHasNormals;
 
 	if( ! optimizeVertices ) {
-		loadInternalNoOptimize( mGroups[groupIndex], destTriMesh, texCoords, normals );
-	}
-	else if( normals && texCoords ) {
-		map<VertexTriple,int> uniqueVerts;
-		loadInternalNormalsTextures( mGroups[groupIndex], uniqueVerts, destTriMesh );
-	}
-	else if( normals ) {
-		map<VertexPair,int> uniqueVerts;
-		loadInternalNormals( mGroups[groupIndex], uniqueVerts, destTriMesh );
-	}
-	else if( texCoords ) {
-		map<VertexPair,int> uniqueVerts;
-		loadInternalTextures( mGroups[groupIndex], uniqueVerts, destTriMesh );
+		loadInternalNoOptimize( mFaceLists[groupIndex], destTriMesh, texCoords, normals );
 	}
 	else {
-		map<int,int> uniqueVerts;
-		loadInternal( mGroups[groupIndex], uniqueVerts, destTriMesh );
+		VertexTable uniqueVerts( mFaceLists[groupIndex].mVertexIndices.size() );
+		loadInternalOptimize( mFaceLists[groupIndex], &uniqueVerts, destTriMesh, texCoords, normals );
 	}
-
 }
 
 void ObjLoader::load( TriMesh *destTriMesh, boost::tribool loadNormals, boost::tribool loadTexCoords, bool optimizeVertices )
@@ -287,299 +668,129 @@ void ObjLoader::load( TriMesh *destTriMesh, boost::tribool loadNormals, boost::t
 	}
 
 	if( ! optimizeVertices ) {
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt ) {
-			loadInternalNoOptimize( *groupIt, destTriMesh, texCoords, normals );
-		}	
-	}
-	else if( normals && texCoords ) {
-		map<VertexTriple,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternalNormalsTextures( *groupIt, uniqueVerts, destTriMesh );
-	}
-	else if( normals ) {
-		map<VertexPair,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternalNormals( *groupIt, uniqueVerts, destTriMesh );
-	}
-	else if( texCoords ) {
-		map<VertexPair,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternalTextures( *groupIt, uniqueVerts, destTriMesh );
+		for( size_t g = 0; g < mGroups.size(); ++g )
+			loadInternalNoOptimize( mFaceLists[g], destTriMesh, texCoords, normals );
 	}
 	else {
-		map<int,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternal( *groupIt, uniqueVerts, destTriMesh );
+		size_t numFaceVertices = 0;
+		for( vector<FaceList>::const_iterator facesIt = mFaceLists.begin(); facesIt != mFaceLists.end(); ++facesIt )
+			numFaceVertices += facesIt->mVertexIndices.size();
+
+		VertexTable uniqueVerts( numFaceVertices );
+		for( size_t g = 0; g < mGroups.size(); ++g )
+			loadInternalOptimize( mFaceLists[g], &uniqueVerts, destTriMesh, texCoords, normals );
 	}
 }
 
-void ObjLoader::loadInternalNoOptimize( const Group &group, TriMesh *destTriMesh, bool texCoords, bool normals )
+void ObjLoader::loadInternalNoOptimize( const FaceList &faces, TriMesh *destTriMesh, bool texCoords, bool normals )
 {
-    bool hasColors = mMaterials.size() > 0;
+	bool hasColors = mMaterials.size() > 0;
 	size_t offset = destTriMesh->getNumVertices();
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
+
+	const size_t numVertices = offset + faces.mVertexIndices.size();
+	destTriMesh->getVertices().reserve( numVertices );
+	if( normals )
+		destTriMesh->getNormals().reserve( numVertices );
+	if( texCoords )
+		destTriMesh->getTexCoords().reserve( numVertices );
+	if( hasColors )
+		destTriMesh->getColorsRGB().reserve( numVertices );
+	destTriMesh->getIndices().reserve( destTriMesh->getIndices().size() + ( faces.mVertexIndices.size() - 2 * faces.getNumFaces() ) * 3 );
+
+	for( size_t f = 0; f < faces.getNumFaces(); ++f ) {
+		const size_t begin = faces.mOffsets[f];
+		const int numFaceVertices = (int)( faces.mOffsets[f + 1] - begin );
+		const bool faceHasNormals = ( faces.mFlags[f] & FACE_HAS_NORMALS ) != 0;
+		const bool faceHasTexCoords = ( faces.mFlags[f] & FACE_HAS_TEXCOORDS ) != 0;
+
 		Vec3f normal;
-		if( normals && ( ! group.mHasNormals ) ) { // we'll have to derive it from two edges
-			Vec3f edge1 = mVertices[group.mFaces[f].mVertexIndices[1]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			Vec3f edge2 = mVertices[group.mFaces[f].mVertexIndices[2]] - mVertices[group.mFaces[f].mVertexIndices[0]];
+		if( normals && ! faceHasNormals ) { // we'll have to derive it from two edges
+			Vec3f edge1 = mVertices[faces.mVertexIndices[begin + 1]] - mVertices[faces.mVertexIndices[begin]];
+			Vec3f edge2 = mVertices[faces.mVertexIndices[begin + 2]] - mVertices[faces.mVertexIndices[begin]];
 			normal = edge1.cross( edge2 ).normalized();
 		}
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-			if( normals && group.mHasNormals )
-				destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-			else if( normals && ( ! group.mHasNormals ) ) { // we'll have to use the one derived from two edges
+		for( int v = 0; v < numFaceVertices; ++v ) {
+			destTriMesh->appendVertex( mVertices[faces.mVertexIndices[begin + v]] );
+			if( normals && faceHasNormals )
+				destTriMesh->appendNormal( mNormals[faces.mNormalIndices[begin + v]] );
+			else if( normals ) // we'll have to use the one derived from two edges
 				destTriMesh->appendNormal( normal );
-			}
-			if( texCoords && group.mHasTexCoords ) {
-				Vec2f texCoord = mTexCoords[group.mFaces[f].mTexCoordIndices[v]];
+			if( texCoords && faceHasTexCoords ) {
+				Vec2f texCoord = mTexCoords[faces.mTexCoordIndices[begin + v]];
 				texCoord.y = 1.0f - texCoord.y;
 				destTriMesh->appendTexCoord( texCoord );	
 			}
-			else if( texCoords && ( ! group.mHasTexCoords ) ) // we'll have to make some up
+			else if( texCoords ) // we'll have to make some up
 				destTriMesh->appendTexCoord( Vec2f::zero() );
-            if( hasColors ) {
-                if( group.mFaces[f].mMaterial ) {
-                    const Material *m = group.mFaces[f].mMaterial;
-                    Color rgb(m->Kd[0], m->Kd[1], m->Kd[2]);
-                    destTriMesh->appendColorRgb( rgb );
-                }
-                else {
-                    Color rgb(1, 1, 1);
-                    destTriMesh->appendColorRgb( rgb );
-                }
-            }
+			if( hasColors ) {
+				const Material *m = faces.mMaterials[f];
+				destTriMesh->appendColorRgb( m ? Color( m->Kd[0], m->Kd[1], m->Kd[2] ) : Color( 1, 1, 1 ) );
+			}
 		}
 
-		int triangles = group.mFaces[f].mNumVertices - 2;
+		int triangles = numFaceVertices - 2;
 		for( int t = 0; t < triangles; ++t ) {
 			destTriMesh->appendTriangle( offset + 0, offset + t + 1, offset + t + 2 );
 		}
-		offset += group.mFaces[f].mNumVertices;
+		offset += numFaceVertices;
 	}	
 }
 
-void ObjLoader::loadInternalNormalsTextures( const Group &group, map<VertexTriple,int> &uniqueVerts, TriMesh *destTriMesh )
+void ObjLoader::loadInternalOptimize( const FaceList &faces, VertexTable *uniqueVerts, TriMesh *destTriMesh, bool texCoords, bool normals )
 {
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-		Vec3f inferredNormal;
-		bool forceUnique = false;
-        Color rgb;
-        if( hasColors ) {
-            const Material *m = group.mFaces[f].mMaterial;
-            if( m ) {
-                rgb.r = m->Kd[0];
-                rgb.g = m->Kd[1];
-                rgb.b = m->Kd[2];
-            }
-            else {
-                rgb.r = 1;
-                rgb.g = 1;
-                rgb.b = 1;
-            }
-        }
-		if( group.mFaces[f].mNormalIndices.empty() ) { // we'll have to derive it from two edges
-			Vec3f edge1 = mVertices[group.mFaces[f].mVertexIndices[1]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			Vec3f edge2 = mVertices[group.mFaces[f].mVertexIndices[2]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			inferredNormal = edge1.cross( edge2 ).normalized();
-			forceUnique = true;
-		}
-		
-		if( group.mFaces[f].mTexCoordIndices.empty() )
-			forceUnique = true;
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexTriple triple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mTexCoordIndices[v], group.mFaces[f].mNormalIndices[v] );
-				pair<map<VertexTriple,int>::iterator,bool> result = uniqueVerts.insert( make_pair( triple, destTriMesh->getVertices().size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                    if( hasColors )
-                        destTriMesh->appendColorRgb( rgb );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks either normals or texCoords
-				faceIndices.push_back( destTriMesh->getVertices().size() );
-
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasNormals )
-					destTriMesh->appendNormal( inferredNormal );
-				else
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-				if( ! group.mHasTexCoords )
-					destTriMesh->appendTexCoord( Vec2f::zero() );
-				else
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                if( hasColors )
-                    destTriMesh->appendColorRgb( rgb );
-			}
+	bool hasColors = mMaterials.size() > 0;
+	destTriMesh->getIndices().reserve( destTriMesh->getIndices().size() + ( faces.mVertexIndices.size() - 2 * faces.getNumFaces() ) * 3 );
+
+	vector<uint32_t> faceIndices;
+	for( size_t f = 0; f < faces.getNumFaces(); ++f ) {
+		const size_t begin = faces.mOffsets[f];
+		const int numFaceVertices = (int)( faces.mOffsets[f + 1] - begin );
+		const bool faceHasNormals = ( faces.mFlags[f] & FACE_HAS_NORMALS ) != 0;
+		const bool faceHasTexCoords = ( faces.mFlags[f] & FACE_HAS_TEXCOORDS ) != 0;
+
+		Color rgb( 1, 1, 1 );
+		if( hasColors && faces.mMaterials[f] ) {
+			const Material *m = faces.mMaterials[f];
+			rgb = Color( m->Kd[0], m->Kd[1], m->Kd[2] );
 		}
 
-		int triangles = faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadInternalNormals( const Group &group, map<VertexPair,int> &uniqueVerts, TriMesh *destTriMesh )
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-        Color rgb;
-        if( hasColors ) {
-            const Material *m = group.mFaces[f].mMaterial;
-            if( m ) {
-                rgb.r = m->Kd[0];
-                rgb.g = m->Kd[1];
-                rgb.b = m->Kd[2];
-            }
-            else {
-                rgb.r = 1;
-                rgb.g = 1;
-                rgb.b = 1;
-            }
-        }
+		// vertices of faces that lack a requested attribute aren't shared, since their attribute is made up for the face
 		Vec3f inferredNormal;
 		bool forceUnique = false;
-		if( group.mFaces[f].mNormalIndices.empty() ) { // we'll have to derive it from two edges
-			Vec3f edge1 = mVertices[group.mFaces[f].mVertexIndices[1]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			Vec3f edge2 = mVertices[group.mFaces[f].mVertexIndices[2]] - mVertices[group.mFaces[f].mVertexIndices[0]];
+		if( normals && ! faceHasNormals ) { // we'll have to derive it from two edges
+			Vec3f edge1 = mVertices[faces.mVertexIndices[begin + 1]] - mVertices[faces.mVertexIndices[begin]];
+			Vec3f edge2 = mVertices[faces.mVertexIndices[begin + 2]] - mVertices[faces.mVertexIndices[begin]];
 			inferredNormal = edge1.cross( edge2 ).normalized();
 			forceUnique = true;
 		}
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexPair triple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mNormalIndices[v] );
-				pair<map<VertexPair,int>::iterator,bool> result = uniqueVerts.insert( make_pair( triple, destTriMesh->getVertices().size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-                    if( hasColors )
-                        destTriMesh->appendColorRgb( rgb );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks normals
-				faceIndices.push_back( destTriMesh->getVertices().size() );
-
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasNormals )
-					destTriMesh->appendNormal( inferredNormal );
-				else
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-                if( hasColors )
-                    destTriMesh->appendColorRgb( rgb );
-			}
-		}
-
-		int triangles = faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadInternalTextures( const Group &group, map<VertexPair,int> &uniqueVerts, TriMesh *destTriMesh )
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-        Color rgb;
-        if( hasColors ) {
-            const Material *m = group.mFaces[f].mMaterial;
-            if( m ) {
-                rgb.r = m->Kd[0];
-                rgb.g = m->Kd[1];
-                rgb.b = m->Kd[2];
-            }
-            else {
-                rgb.r = 1;
-                rgb.g = 1;
-                rgb.b = 1;
-            }
-        }
-		bool forceUnique = false;
-		if( group.mFaces[f].mTexCoordIndices.empty() )
+		if( texCoords && ! faceHasTexCoords )
 			forceUnique = true;
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexPair triple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mTexCoordIndices[v] );
-				pair<map<VertexPair,int>::iterator,bool> result = uniqueVerts.insert( make_pair( triple, destTriMesh->getVertices().size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                    if( hasColors )
-                        destTriMesh->appendColorRgb( rgb );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks texCoords
-				faceIndices.push_back( destTriMesh->getVertices().size() );
-
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasTexCoords )
-					destTriMesh->appendTexCoord( Vec2f::zero() );
-				else
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-                if( hasColors )
-                    destTriMesh->appendColorRgb( rgb );
-			}
-		}
-
-		int triangles = faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
-		}
-	}	
-}
 
-void ObjLoader::loadInternal( const Group &group, map<int,int> &uniqueVerts, TriMesh *destTriMesh )
-{
-    bool hasColors = mMaterials.size() > 0;
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-        Color rgb;
-        if( hasColors ) {
-            const Material *m = group.mFaces[f].mMaterial;
-            if( m ) {
-                rgb.r = m->Kd[0];
-                rgb.g = m->Kd[1];
-                rgb.b = m->Kd[2];
-            }
-            else {
-                rgb.r = 1;
-                rgb.g = 1;
-                rgb.b = 1;
-            }
-        }
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			pair<map<int,int>::iterator,bool> result = uniqueVerts.insert( make_pair( group.mFaces[f].mVertexIndices[v], destTriMesh->getVertices().size() ) );
-			if( result.second ) { // we've got a new, unique vertex here, so let's append it
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-                if( hasColors )
-                    destTriMesh->appendColorRgb( rgb );
+		faceIndices.clear();
+		for( int v = 0; v < numFaceVertices; ++v ) {
+			const int vertexIndex = faces.mVertexIndices[begin + v];
+			const int texCoordIndex = texCoords ? faces.mTexCoordIndices[begin + v] : -1;
+			const int normalIndex = normals ? faces.mNormalIndices[begin + v] : -1;
+
+			bool isNewVertex = true;
+			uint32_t index = (uint32_t)destTriMesh->getVertices().size();
+			if( ! forceUnique )
+				index = uniqueVerts->insert( vertexIndex, texCoordIndex, normalIndex, index, &isNewVertex );
+
+			if( isNewVertex ) { // we've got a new, unique vertex here, so let's append it
+				destTriMesh->appendVertex( mVertices[vertexIndex] );
+				if( normals )
+					destTriMesh->appendNormal( faceHasNormals ? mNormals[normalIndex] : inferredNormal );
+				if( texCoords )
+					destTriMesh->appendTexCoord( faceHasTexCoords ? mTexCoords[texCoordIndex] : Vec2f::zero() );
+				if( hasColors )
+					destTriMesh->appendColorRgb( rgb );
 			}
 			// the unique ID of the vertex is appended for this vert
-			faceIndices.push_back( result.first->second );
+			faceIndices.push_back( index );
 		}
 
-		int triangles = faceIndices.size() - 2;
+		int triangles = (int)faceIndices.size() - 2;
 		for( int t = 0; t < triangles; ++t ) {
 			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
 		}
@@ -131,9 +131,12 @@ Path2d::Path2d( const BSpline<Vec2f> &spline, float subdivisionStep )
 		}
 	}
 	else { // this is not a case we handle directly, so we'll have to do a linear approximation
-		moveTo( spline.getPosition( 0 ) );
-		for( float t = subdivisionStep; t <= 1.0f; t += subdivisionStep )
-			lineTo( spline.getPosition( t ) );
+		const size_t numSteps = (size_t)( 1.0f / subdivisionStep );
+		vector<Vec2f> positions( numSteps + 1 );
+		spline.sampleUniform( 0, numSteps * subdivisionStep, numSteps + 1, &positions[0] );
+		moveTo( positions[0] );
+		for( size_t p = 1; p <= numSteps; ++p )
+			lineTo( positions[p] );
 	}	
 }
 
@@ -658,6 +661,101 @@ void Path2d::subdivideCubic( float distanceToleranceSqr, const Vec2f &p1, const
 	subdivideCubic( distanceToleranceSqr, p1234, p234, p34, p4, level + 1, result ); 
 }
 
+vector<Vec2f> Path2d::flatten( float maxError, vector<float> *resultTimes ) const
+{
+	vector<Vec2f> result;
+	if( resultTimes )
+		resultTimes->clear();
+	if( mSegments.empty() )
+		return result;
+
+	// Both flatness tests below compare against 16 * maxError^2
+	float errorSqr16 = 16 * maxError * maxError;
+	float segParamLength = 1.0f / mSegments.size();
+
+	result.push_back( mPoints[0] );
+	if( resultTimes )
+		resultTimes->push_back( 0 );
+
+	size_t firstPoint = 0;
+	for( size_t s = 0; s < mSegments.size(); ++s ) {
+		float t0 = s * segParamLength;
+		float t1 = ( s + 1 ) * segParamLength;
+		switch( mSegments[s] ) {
+			case CUBICTO:
+				flattenCubic( errorSqr16, mPoints[firstPoint], mPoints[firstPoint+1], mPoints[firstPoint+2], mPoints[firstPoint+3], t0, t1, 0, &result, resultTimes );
+			break;
+			case QUADTO:
+				flattenQuadratic( errorSqr16, mPoints[firstPoint], mPoints[firstPoint+1], mPoints[firstPoint+2], t0, t1, 0, &result, resultTimes );
+			break;
+			case LINETO:
+				result.push_back( mPoints[firstPoint+1] );
+				if( resultTimes )
+					resultTimes->push_back( t1 );
+			break;
+			case CLOSE:
+				result.push_back( mPoints[0] );
+				if( resultTimes )
+					resultTimes->push_back( t1 );
+			break;
+			default:
+				throw Path2dExc();
+		}
+
+		firstPoint += sSegmentTypePointCounts[mSegments[s]];
+	}
+
+	return result;
+}
+
+// The greatest distance between a quadratic and its chord is |p1 - 2p2 + p3| / 4
+void Path2d::flattenQuadratic( float errorSqr16, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, float t1, float t3, int level, vector<Vec2f> *result, vector<float> *resultTimes ) const
+{
+	const int recursionLimit = 16;
+
+	if( level >= recursionLimit || ( p1 - p2 * 2 + p3 ).lengthSquared() <= errorSqr16 ) {
+		result->push_back( p3 );
+		if( resultTimes )
+			resultTimes->push_back( t3 );
+		return;
+	}
+
+	Vec2f p12 = ( p1 + p2 ) * 0.5f;
+	Vec2f p23 = ( p2 + p3 ) * 0.5f;
+	Vec2f p123 = ( p12 + p23 ) * 0.5f;
+	float t2 = ( t1 + t3 ) * 0.5f;
+
+	flattenQuadratic( errorSqr16, p1, p12, p123, t1, t2, level + 1, result, resultTimes );
+	flattenQuadratic( errorSqr16, p123, p23, p3, t2, t3, level + 1, result, resultTimes );
+}
+
+// Flatness bound due to Roger Willcocks: the distance between a cubic and its chord never exceeds sqrt( max(ux^2,vx^2) + max(uy^2,vy^2) ) / 4
+void Path2d::flattenCubic( float errorSqr16, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, const Vec2f &p4, float t1, float t4, int level, vector<Vec2f> *result, vector<float> *resultTimes ) const
+{
+	const int recursionLimit = 16;
+
+	Vec2f u = p2 * 3 - p1 * 2 - p4;
+	Vec2f v = p3 * 3 - p1 - p4 * 2;
+	float flatness = std::max( u.x * u.x, v.x * v.x ) + std::max( u.y * u.y, v.y * v.y );
+	if( level >= recursionLimit || flatness <= errorSqr16 ) {
+		result->push_back( p4 );
+		if( resultTimes )
+			resultTimes->push_back( t4 );
+		return;
+	}
+
+	Vec2f p12 = ( p1 + p2 ) * 0.5f;
+	Vec2f p23 = ( p2 + p3 ) * 0.5f;
+	Vec2f p34 = ( p3 + p4 ) * 0.5f;
+	Vec2f p123 = ( p12 + p23 ) * 0.5f;
+	Vec2f p234 = ( p23 + p34 ) * 0.5f;
+	Vec2f p1234 = ( p123 + p234 ) * 0.5f;
+	float t2 = ( t1 + t4 ) * 0.5f;
+
+	flattenCubic( errorSqr16, p1, p12, p123, p1234, t1, t2, level + 1, result, resultTimes );
+	flattenCubic( errorSqr16, p1234, p234, p34, p4, t2, t4, level + 1, result, resultTimes );
+}
+
 void Path2d::scale( const Vec2f &amount, Vec2f scaleCenter )
 {
 	for( vector<Vec2f>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
@@ -1153,5 +1251,85 @@ float Path2dCalcCache::calcTimeForDistance( float distance, bool wrap, float tol
 	return mPath.segmentSolveTimeForDistance( currentSegment, currentSegmentLength, distance, tolerance, maxIterations );
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Path2dArcLengthTable
+Path2dArcLengthTable::Path2dArcLengthTable( const Path2d &path, float maxError )
+	: mLength( 0 )
+{
+	mPoints = path.flatten( maxError, &mTimes );
+	mLengths.reserve( mPoints.size() );
+	for( size_t i = 0; i < mPoints.size(); ++i ) {
+		if( i > 0 )
+			mLength += mPoints[i].distance( mPoints[i-1] );
+		mLengths.push_back( mLength );
+	}
+}
+
+void Path2dArcLengthTable::findEdge( float distance, bool wrap, size_t *edge, float *fraction ) const
+{
+	if( wrap && mLength > 0 ) {
+		distance = math<float>::fmod( distance, mLength );
+		if( distance < 0 )
+			distance += mLength;
+	}
+	else
+		distance = math<float>::clamp( distance, 0, mLength );
+
+	// the first point whose cumulative length exceeds distance ends the edge
+	vector<float>::const_iterator it = std::upper_bound( mLengths.begin(), mLengths.end(), distance );
+	size_t end = std::min<size_t>( std::max<size_t>( it - mLengths.begin(), 1 ), mLengths.size() - 1 );
+	*edge = end - 1;
+	float edgeLength = mLengths[end] - mLengths[end-1];
+	*fraction = ( edgeLength > 0 ) ? math<float>::clamp( ( distance - mLengths[end-1] ) / edgeLength, 0, 1 ) : 0;
+}
+
+Vec2f Path2dArcLengthTable::getPositionAtLength( float distance, bool wrap ) const
+{
+	if( mPoints.size() < 2 )
+		return mPoints.empty() ? Vec2f::zero() : mPoints[0];
+
+	size_t edge;
+	float fraction;
+	findEdge( distance, wrap, &edge, &fraction );
+	return mPoints[edge].lerp( fraction, mPoints[edge+1] );
+}
+
+Vec2f Path2dArcLengthTable::getTangentAtLength( float distance, bool wrap ) const
+{
+	if( mPoints.size() < 2 )
+		return Vec2f::zero();
+
+	size_t edge;
+	float fraction;
+	findEdge( distance, wrap, &edge, &fraction );
+	return ( mPoints[edge+1] - mPoints[edge] ).safeNormalized();
+}
+
+void Path2dArcLengthTable::getPositionAndTangentAtLength( float distance, Vec2f *resultPosition, Vec2f *resultTangent, bool wrap ) const
+{
+	if( mPoints.size() < 2 ) {
+		*resultPosition = mPoints.empty() ? Vec2f::zero() : mPoints[0];
+		*resultTangent = Vec2f::zero();
+		return;
+	}
+
+	size_t edge;
+	float fraction;
+	findEdge( distance, wrap, &edge, &fraction );
+	*resultPosition = mPoints[edge].lerp( fraction, mPoints[edge+1] );
+	*resultTangent = ( mPoints[edge+1] - mPoints[edge] ).safeNormalized();
+}
+
+float Path2dArcLengthTable::getTimeAtLength( float distance, bool wrap ) const
+{
+	if( mPoints.size() < 2 )
+		return 0;
+
+	size_t edge;
+	float fraction;
+	findEdge( distance, wrap, &edge, &fraction );
+	return mTimes[edge] + ( mTimes[edge+1] - mTimes[edge] ) * fraction;
+}
+
 
 } // namespace cinder
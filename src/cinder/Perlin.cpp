@@ -26,7 +26,12 @@
 
 #include "cinder/Perlin.h"
 #include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
 #include "cinder/Rand.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
+
+#include <vector>
 
 namespace cinder {
 
@@ -34,6 +39,142 @@ static inline float fade( float t ) { return t * t * t * (t * (t * 6 - 15) + 10)
 static inline float dfade( float t ) { return 30.0f * t * t * ( t * ( t - 2.0f ) + 1.0f ); }
 inline float nlerp(float t, float a, float b) { return a + t * (b - a); }
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+// Each of these performs the same operations in the same order as its scalar counterpart, so that the batch results are identical
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+inline __m128 floor_ps( __m128 x )
+{
+	__m128 t = _mm_cvtepi32_ps( _mm_cvttps_epi32( x ) );
+	return _mm_sub_ps( t, _mm_and_ps( _mm_cmpgt_ps( t, x ), _mm_set1_ps( 1.0f ) ) );
+}
+
+inline __m128 fade_ps( __m128 t )
+{
+	return _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( t, t ), t ), _mm_add_ps( _mm_mul_ps( t, _mm_sub_ps( _mm_mul_ps( t, _mm_set1_ps( 6 ) ), _mm_set1_ps( 15 ) ) ), _mm_set1_ps( 10 ) ) );
+}
+
+inline __m128 nlerp_ps( __m128 t, __m128 a, __m128 b )
+{
+	return _mm_add_ps( a, _mm_mul_ps( t, _mm_sub_ps( b, a ) ) );
+}
+
+// Perlin::grad(), with z of zero for the 2D variant
+inline __m128 grad_ps( const int32_t hash[4], __m128 x, __m128 y, __m128 z )
+{
+	__m128i h = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( hash ) ), _mm_set1_epi32( 15 ) );
+	__m128 hLt8 = _mm_castsi128_ps( _mm_cmplt_epi32( h, _mm_set1_epi32( 8 ) ) );
+	__m128 hLt4 = _mm_castsi128_ps( _mm_cmplt_epi32( h, _mm_set1_epi32( 4 ) ) );
+	__m128 h12or14 = _mm_castsi128_ps( _mm_or_si128( _mm_cmpeq_epi32( h, _mm_set1_epi32( 12 ) ), _mm_cmpeq_epi32( h, _mm_set1_epi32( 14 ) ) ) );
+	__m128 u = select_ps( hLt8, x, y );
+	__m128 v = select_ps( hLt4, y, select_ps( h12or14, x, z ) );
+	// bits 0 and 1 of the hash negate u and v
+	u = _mm_xor_ps( u, _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( h, _mm_set1_epi32( 1 ) ), 31 ) ) );
+	v = _mm_xor_ps( v, _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( h, _mm_set1_epi32( 2 ) ), 30 ) ) );
+	return _mm_add_ps( u, v );
+}
+
+// Perlin::noise( x, y ) for four points
+__m128 noise_ps( const uint8_t *perms, __m128 x, __m128 y )
+{
+	__m128 fx = floor_ps( x ), fy = floor_ps( y );
+	int32_t X[4], Y[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( X ), _mm_and_si128( _mm_cvttps_epi32( fx ), _mm_set1_epi32( 255 ) ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Y ), _mm_and_si128( _mm_cvttps_epi32( fy ), _mm_set1_epi32( 255 ) ) );
+	x = _mm_sub_ps( x, fx );
+	y = _mm_sub_ps( y, fy );
+	__m128 u = fade_ps( x ), v = fade_ps( y );
+
+	// SSE2 has no gather, so the permutation lookups are scalar
+	int32_t hAA[4], hBA[4], hAB[4], hBB[4];
+	for( int i = 0; i < 4; ++i ) {
+		int32_t A = perms[X[i]]+Y[i], AA = perms[A], AB = perms[A+1], B = perms[X[i]+1]+Y[i], BA = perms[B], BB = perms[B+1];
+		hAA[i] = perms[AA]; hBA[i] = perms[BA]; hAB[i] = perms[AB]; hBB[i] = perms[BB];
+	}
+
+	const __m128 one = _mm_set1_ps( 1 ), zero = _mm_setzero_ps();
+	__m128 x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one );
+	return nlerp_ps( v, nlerp_ps( u, grad_ps( hAA, x, y, zero ), grad_ps( hBA, x1, y, zero ) ),
+						nlerp_ps( u, grad_ps( hAB, x, y1, zero ), grad_ps( hBB, x1, y1, zero ) ) );
+}
+
+// Perlin::noise( x, y, z ) for four points
+__m128 noise_ps( const uint8_t *perms, __m128 x, __m128 y, __m128 z )
+{
+	__m128 fx = floor_ps( x ), fy = floor_ps( y ), fz = floor_ps( z );
+	int32_t X[4], Y[4], Z[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( X ), _mm_and_si128( _mm_cvttps_epi32( fx ), _mm_set1_epi32( 255 ) ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Y ), _mm_and_si128( _mm_cvttps_epi32( fy ), _mm_set1_epi32( 255 ) ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Z ), _mm_and_si128( _mm_cvttps_epi32( fz ), _mm_set1_epi32( 255 ) ) );
+	x = _mm_sub_ps( x, fx );
+	y = _mm_sub_ps( y, fy );
+	z = _mm_sub_ps( z, fz );
+	__m128 u = fade_ps( x ), v = fade_ps( y ), w = fade_ps( z );
+
+	int32_t hA[4], hB[4], hC[4], hD[4], hE[4], hF[4], hG[4], hH[4];
+	for( int i = 0; i < 4; ++i ) {
+		int32_t A = perms[X[i]]+Y[i], AA = perms[A]+Z[i], AB = perms[A+1]+Z[i], B = perms[X[i]+1]+Y[i], BA = perms[B]+Z[i], BB = perms[B+1]+Z[i];
+		hA[i] = perms[AA]; hB[i] = perms[BA]; hC[i] = perms[AB]; hD[i] = perms[BB];
+		hE[i] = perms[AA+1]; hF[i] = perms[BA+1]; hG[i] = perms[AB+1]; hH[i] = perms[BB+1];
+	}
+
+	const __m128 one = _mm_set1_ps( 1 );
+	__m128 x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one ), z1 = _mm_sub_ps( z, one );
+	__m128 a = grad_ps( hA, x, y, z ), b = grad_ps( hB, x1, y, z ), c = grad_ps( hC, x, y1, z ), d = grad_ps( hD, x1, y1, z );
+	__m128 e = grad_ps( hE, x, y, z1 ), f = grad_ps( hF, x1, y, z1 ), g = grad_ps( hG, x, y1, z1 ), h = grad_ps( hH, x1, y1, z1 );
+	return nlerp_ps( w, nlerp_ps( v, nlerp_ps( u, a, b ), nlerp_ps( u, c, d ) ),
+						nlerp_ps( v, nlerp_ps( u, e, f ), nlerp_ps( u, g, h ) ) );
+}
+
+__m128 fBm_ps( const uint8_t *perms, uint8_t octaves, __m128 x, __m128 y )
+{
+	__m128 result = _mm_setzero_ps();
+	float amp = 0.5f;
+	const __m128 two = _mm_set1_ps( 2.0f );
+	for( uint8_t i = 0; i < octaves; i++ ) {
+		result = _mm_add_ps( result, _mm_mul_ps( noise_ps( perms, x, y ), _mm_set1_ps( amp ) ) );
+		x = _mm_mul_ps( x, two ); y = _mm_mul_ps( y, two );
+		amp *= 0.5f;
+	}
+	return result;
+}
+
+__m128 fBm_ps( const uint8_t *perms, uint8_t octaves, __m128 x, __m128 y, __m128 z )
+{
+	__m128 result = _mm_setzero_ps();
+	float amp = 0.5f;
+	const __m128 two = _mm_set1_ps( 2.0f );
+	for( uint8_t i = 0; i < octaves; i++ ) {
+		result = _mm_add_ps( result, _mm_mul_ps( noise_ps( perms, x, y, z ), _mm_set1_ps( amp ) ) );
+		x = _mm_mul_ps( x, two ); y = _mm_mul_ps( y, two ); z = _mm_mul_ps( z, two );
+		amp *= 0.5f;
+	}
+	return result;
+}
+#endif
+
+// Calls fn( first, last ) over [0,count), on taskPool's threads if it is non-NULL
+void batch( size_t count, TaskPool *taskPool, const std::function<void ( size_t, size_t )> &fn )
+{
+	if( taskPool )
+		taskPool->parallelFor( 0, count, fn );
+	else
+		fn( 0, count );
+}
+
+} // anonymous namespace
+
 Perlin::Perlin( uint8_t aOctaves, int32_t aSeed )
 	: mOctaves( aOctaves ), mSeed( aSeed ){
 	initPermutationTable();
@@ -106,6 +247,109 @@ float Perlin::fBm( const Vec3f &v ) const
 	return result;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// batch fBm
+void Perlin::fBmSpan( float x0, float stepX, float y, float z, bool threeD, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128 y4 = _mm_set1_ps( y ), z4 = _mm_set1_ps( z );
+		const __m128 offsets = _mm_set_ps( 3, 2, 1, 0 );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 x4 = _mm_add_ps( _mm_set1_ps( x0 ), _mm_mul_ps( _mm_add_ps( _mm_set1_ps( (float)i ), offsets ), _mm_set1_ps( stepX ) ) );
+			_mm_storeu_ps( result + i, threeD ? fBm_ps( mPerms, mOctaves, x4, y4, z4 ) : fBm_ps( mPerms, mOctaves, x4, y4 ) );
+		}
+	}
+#endif
+	for( ; i < count; ++i ) {
+		float x = x0 + (float)i * stepX;
+		result[i] = threeD ? fBm( Vec3f( x, y, z ) ) : fBm( Vec2f( x, y ) );
+	}
+}
+
+void Perlin::fBm( Channel32f *channel, const Vec2f &origin, const Vec2f &scale, TaskPool *taskPool ) const
+{
+	const int32_t width = channel->getWidth();
+	batch( channel->getHeight(), taskPool, [=]( size_t first, size_t last ) {
+		std::vector<float> row( width );
+		for( size_t y = first; y < last; ++y ) {
+			fBmSpan( origin.x, scale.x, origin.y + (float)y * scale.y, 0, false, width, &row[0] );
+			float *dst = channel->getData( Vec2i( 0, (int32_t)y ) );
+			const uint8_t inc = channel->getIncrement();
+			for( int32_t x = 0; x < width; ++x, dst += inc )
+				*dst = row[x];
+		}
+	} );
+}
+
+void Perlin::fBm( Channel32f *channel, const Vec3f &origin, const Vec2f &scale, TaskPool *taskPool ) const
+{
+	const int32_t width = channel->getWidth();
+	batch( channel->getHeight(), taskPool, [=]( size_t first, size_t last ) {
+		std::vector<float> row( width );
+		for( size_t y = first; y < last; ++y ) {
+			fBmSpan( origin.x, scale.x, origin.y + (float)y * scale.y, origin.z, true, width, &row[0] );
+			float *dst = channel->getData( Vec2i( 0, (int32_t)y ) );
+			const uint8_t inc = channel->getIncrement();
+			for( int32_t x = 0; x < width; ++x, dst += inc )
+				*dst = row[x];
+		}
+	} );
+}
+
+void Perlin::fBm( Surface32f *surface, const Vec2f &origin, const Vec2f &scale, TaskPool *taskPool ) const
+{
+	const int32_t width = surface->getWidth();
+	batch( surface->getHeight(), taskPool, [=]( size_t first, size_t last ) {
+		std::vector<float> row( width );
+		const uint8_t inc = surface->getPixelInc();
+		const uint8_t red = surface->getRedOffset(), green = surface->getGreenOffset(), blue = surface->getBlueOffset();
+		for( size_t y = first; y < last; ++y ) {
+			fBmSpan( origin.x, scale.x, origin.y + (float)y * scale.y, 0, false, width, &row[0] );
+			float *dst = surface->getData( Vec2i( 0, (int32_t)y ) );
+			for( int32_t x = 0; x < width; ++x, dst += inc )
+				dst[red] = dst[green] = dst[blue] = row[x];
+		}
+	} );
+}
+
+void Perlin::fBm( const Vec2f *positions, size_t count, float *result, TaskPool *taskPool ) const
+{
+	batch( count, taskPool, [=]( size_t first, size_t last ) {
+		size_t i = first;
+#if defined( CINDER_SSE2 )
+		if( useSse2() ) {
+			for( ; i + 4 <= last; i += 4 ) {
+				const Vec2f *p = positions + i;
+				__m128 x = _mm_set_ps( p[3].x, p[2].x, p[1].x, p[0].x ), y = _mm_set_ps( p[3].y, p[2].y, p[1].y, p[0].y );
+				_mm_storeu_ps( result + i, fBm_ps( mPerms, mOctaves, x, y ) );
+			}
+		}
+#endif
+		for( ; i < last; ++i )
+			result[i] = fBm( positions[i] );
+	} );
+}
+
+void Perlin::fBm( const Vec3f *positions, size_t count, float *result, TaskPool *taskPool ) const
+{
+	batch( count, taskPool, [=]( size_t first, size_t last ) {
+		size_t i = first;
+#if defined( CINDER_SSE2 )
+		if( useSse2() ) {
+			for( ; i + 4 <= last; i += 4 ) {
+				const Vec3f *p = positions + i;
+				__m128 x = _mm_set_ps( p[3].x, p[2].x, p[1].x, p[0].x ), y = _mm_set_ps( p[3].y, p[2].y, p[1].y, p[0].y ), z = _mm_set_ps( p[3].z, p[2].z, p[1].z, p[0].z );
+				_mm_storeu_ps( result + i, fBm_ps( mPerms, mOctaves, x, y, z ) );
+			}
+		}
+#endif
+		for( ; i < last; ++i )
+			result[i] = fBm( positions[i] );
+	} );
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // dfBm
 /*float Perlin::dfBm( float v ) const
@@ -279,6 +523,191 @@ Vec3f Perlin::dnoise( float x, float y, float z ) const
 					dw * ( k3 + k6*u + k5*v + k7*u*v ) );
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// simplex
+// Simplex noise and its analytic derivatives follow Stefan Gustavson's public domain sdnoise1234, hashing with mPerms. Results are scaled to roughly [-1,1].
+namespace {
+const float sGrad2[8][2] = { { -1, -1 }, { 1, 0 }, { -1, 0 }, { 1, 1 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 } };
+const float sGrad3[16][3] = { { 1, 0, 1 }, { 0, 1, 1 }, { -1, 0, 1 }, { 0, -1, 1 }, { 1, 0, -1 }, { 0, 1, -1 }, { -1, 0, -1 }, { 0, -1, -1 },
+								{ 1, -1, 0 }, { 1, 1, 0 }, { -1, 1, 0 }, { -1, -1, 0 }, { 1, 0, 1 }, { -1, 0, 1 }, { 0, 1, -1 }, { 0, -1, -1 } };
+const float F2 = 0.366025403f;	// 0.5 * ( sqrt( 3 ) - 1 )
+const float G2 = 0.211324865f;	// ( 3 - sqrt( 3 ) ) / 6
+const float F3 = 0.333333333f;
+const float G3 = 0.166666667f;
+} // anonymous namespace
+
+float Perlin::simplex( float x, float y ) const
+{
+	return simplex( x, y, (Vec2f*)NULL );
+}
+
+float Perlin::simplex( float x, float y, float z ) const
+{
+	return simplex( x, y, z, (Vec3f*)NULL );
+}
+
+float Perlin::simplex( float x, float y, Vec2f *resultDerivative ) const
+{
+	// skew to find the simplex cell, then unskew its origin back to (x,y) space
+	float s = ( x + y ) * F2;
+	float xs = x + s, ys = y + s;
+	int32_t i = (int32_t)floorf( xs ), j = (int32_t)floorf( ys );
+	float t = (float)( i + j ) * G2;
+	float x0 = x - ( i - t ), y0 = y - ( j - t );
+
+	// the middle corner is either (1,0) or (0,1)
+	int32_t i1 = ( x0 > y0 ) ? 1 : 0, j1 = 1 - i1;
+	float x1 = x0 - i1 + G2, y1 = y0 - j1 + G2;
+	float x2 = x0 - 1.0f + 2.0f * G2, y2 = y0 - 1.0f + 2.0f * G2;
+
+	int32_t ii = i & 255, jj = j & 255;
+	const float *g0 = sGrad2[mPerms[ii + mPerms[jj]] & 7];
+	const float *g1 = sGrad2[mPerms[ii + i1 + mPerms[jj + j1]] & 7];
+	const float *g2 = sGrad2[mPerms[ii + 1 + mPerms[jj + 1]] & 7];
+
+	float n = 0;
+	Vec2f d = Vec2f::zero();
+	const float cx[3] = { x0, x1, x2 }, cy[3] = { y0, y1, y2 };
+	const float *g[3] = { g0, g1, g2 };
+	for( int c = 0; c < 3; ++c ) {
+		float t0 = 0.5f - cx[c] * cx[c] - cy[c] * cy[c];
+		if( t0 < 0 )
+			continue;
+		float t2 = t0 * t0, t4 = t2 * t2;
+		float gdot = g[c][0] * cx[c] + g[c][1] * cy[c];
+		n += t4 * gdot;
+		// d/dx of t^4 * gdot = -8 t^3 gdot x + t^4 g
+		float temp = t2 * t0 * gdot;
+		d.x += -8.0f * temp * cx[c] + t4 * g[c][0];
+		d.y += -8.0f * temp * cy[c] + t4 * g[c][1];
+	}
+
+	if( resultDerivative )
+		*resultDerivative = d * 70.0f;
+	return 70.0f * n;
+}
+
+float Perlin::simplex( float x, float y, float z, Vec3f *resultDerivative ) const
+{
+	float s = ( x + y + z ) * F3;
+	int32_t i = (int32_t)floorf( x + s ), j = (int32_t)floorf( y + s ), k = (int32_t)floorf( z + s );
+	float t = (float)( i + j + k ) * G3;
+	float x0 = x - ( i - t ), y0 = y - ( j - t ), z0 = z - ( k - t );
+
+	// determine which of the six simplices of the skewed cube we're in
+	int32_t i1, j1, k1, i2, j2, k2;
+	if( x0 >= y0 ) {
+		if( y0 >= z0 )		{ i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+		else if( x0 >= z0 )	{ i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+		else				{ i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+	}
+	else {
+		if( y0 < z0 )		{ i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+		else if( x0 < z0 )	{ i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+		else				{ i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+	}
+
+	const float cx[4] = { x0, x0 - i1 + G3, x0 - i2 + 2.0f * G3, x0 - 1.0f + 3.0f * G3 };
+	const float cy[4] = { y0, y0 - j1 + G3, y0 - j2 + 2.0f * G3, y0 - 1.0f + 3.0f * G3 };
+	const float cz[4] = { z0, z0 - k1 + G3, z0 - k2 + 2.0f * G3, z0 - 1.0f + 3.0f * G3 };
+
+	int32_t ii = i & 255, jj = j & 255, kk = k & 255;
+	const float *g[4] = {
+		sGrad3[mPerms[ii + mPerms[jj + mPerms[kk]]] & 15],
+		sGrad3[mPerms[ii + i1 + mPerms[jj + j1 + mPerms[kk + k1]]] & 15],
+		sGrad3[mPerms[ii + i2 + mPerms[jj + j2 + mPerms[kk + k2]]] & 15],
+		sGrad3[mPerms[ii + 1 + mPerms[jj + 1 + mPerms[kk + 1]]] & 15] };
+
+	float n = 0;
+	Vec3f d = Vec3f::zero();
+	for( int c = 0; c < 4; ++c ) {
+		// a radius squared of 0.5 rather than sdnoise's 0.6 keeps contributions from overlapping neighboring simplices, which would make the noise discontinuous
+		float t0 = 0.5f - cx[c] * cx[c] - cy[c] * cy[c] - cz[c] * cz[c];
+		if( t0 < 0 )
+			continue;
+		float t2 = t0 * t0, t4 = t2 * t2;
+		float gdot = g[c][0] * cx[c] + g[c][1] * cy[c] + g[c][2] * cz[c];
+		n += t4 * gdot;
+		float temp = t2 * t0 * gdot;
+		d.x += -8.0f * temp * cx[c] + t4 * g[c][0];
+		d.y += -8.0f * temp * cy[c] + t4 * g[c][1];
+		d.z += -8.0f * temp * cz[c] + t4 * g[c][2];
+	}
+
+	if( resultDerivative )
+		*resultDerivative = d * 76.0f;
+	return 76.0f * n;
+}
+
+float Perlin::fBmSimplex( const Vec2f &v ) const
+{
+	float result = 0.0f;
+	float amp = 0.5f;
+	float x = v.x, y = v.y;
+
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		result += simplex( x, y ) * amp;
+		x *= 2.0f; y *= 2.0f;
+		amp *= 0.5f;
+	}
+
+	return result;
+}
+
+float Perlin::fBmSimplex( const Vec3f &v ) const
+{
+	float result = 0.0f;
+	float amp = 0.5f;
+	float x = v.x, y = v.y, z = v.z;
+
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		result += simplex( x, y, z ) * amp;
+		x *= 2.0f; y *= 2.0f; z *= 2.0f;
+		amp *= 0.5f;
+	}
+
+	return result;
+}
+
+Vec2f Perlin::dfBmSimplex( const Vec2f &v ) const
+{
+	Vec2f result = Vec2f::zero();
+	float amp = 0.5f;
+	float x = v.x, y = v.y;
+
+	// each octave's frequency doubling also doubles its derivative, cancelling the halved amplitude
+	float scale = 1.0f;
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		Vec2f d;
+		simplex( x, y, &d );
+		result += d * ( amp * scale );
+		x *= 2.0f; y *= 2.0f;
+		amp *= 0.5f;
+		scale *= 2.0f;
+	}
+
+	return result;
+}
+
+Vec3f Perlin::dfBmSimplex( const Vec3f &v ) const
+{
+	Vec3f result = Vec3f::zero();
+	float amp = 0.5f;
+	float x = v.x, y = v.y, z = v.z;
+
+	float scale = 1.0f;
+	for( uint8_t i = 0; i < mOctaves; i++ ) {
+		Vec3f d;
+		simplex( x, y, z, &d );
+		result += d * ( amp * scale );
+		x *= 2.0f; y *= 2.0f; z *= 2.0f;
+		amp *= 0.5f;
+		scale *= 2.0f;
+	}
+
+	return result;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // grad
 
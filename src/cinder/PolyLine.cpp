@@ -22,6 +22,8 @@
 
 #include "cinder/PolyLine.h"
 
+#include "cinder/TaskPool.h"
+
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
@@ -152,6 +154,38 @@ polygon convertPolyLinesToBoostGeometry( const std::vector<PolyLine<T> > &a )
 	
 	return result;
 }
+
+typedef boost::geometry::model::multi_polygon<polygon> multi_polygon;
+
+// Combines \a shapes with \a op pairwise until one remains, like a tournament, running the pairs of each round in parallel
+template<typename T, typename OP>
+std::vector<PolyLine<T> > reducePolyLines( const std::vector<std::vector<PolyLine<T> > > &shapes, const OP &op )
+{
+	std::vector<multi_polygon> items;
+	items.reserve( shapes.size() );
+	for( typename std::vector<std::vector<PolyLine<T> > >::const_iterator shapeIt = shapes.begin(); shapeIt != shapes.end(); ++shapeIt ) {
+		if( ! shapeIt->empty() ) {
+			items.push_back( multi_polygon() );
+			items.back().push_back( convertPolyLinesToBoostGeometry( *shapeIt ) );
+		}
+	}
+
+	while( items.size() > 1 ) {
+		const size_t numPairs = items.size() / 2;
+		std::vector<multi_polygon> next( numPairs + items.size() % 2 );
+		TaskPool::get()->parallelFor( 0, numPairs, [&]( size_t first, size_t last ) {
+			for( size_t pair = first; pair < last; ++pair )
+				op( items[pair * 2], items[pair * 2 + 1], next[pair] );
+		}, 1 );
+		if( items.size() % 2 )
+			next.back().swap( items.back() );
+		items.swap( next );
+	}
+
+	if( items.empty() )
+		return std::vector<PolyLine<T> >();
+	return convertBoostGeometryPolygons<T>( items[0] );
+}
 } // anonymous namespace
 
 template<typename T>
@@ -230,6 +264,22 @@ std::vector<PolyLine<T> > PolyLine<T>::calcDifference( const std::vector<PolyLin
 	return convertBoostGeometryPolygons<T>( output );
 }
 
+template<typename T>
+std::vector<PolyLine<T> > PolyLine<T>::calcUnion( const std::vector<std::vector<PolyLine<T> > > &shapes )
+{
+	return reducePolyLines( shapes, [] ( const multi_polygon &a, const multi_polygon &b, multi_polygon &output ) {
+		boost::geometry::union_( a, b, output );
+	} );
+}
+
+template<typename T>
+std::vector<PolyLine<T> > PolyLine<T>::calcIntersection( const std::vector<std::vector<PolyLine<T> > > &shapes )
+{
+	return reducePolyLines( shapes, [] ( const multi_polygon &a, const multi_polygon &b, multi_polygon &output ) {
+		boost::geometry::intersection( a, b, output );
+	} );
+}
+
 template class PolyLine<Vec2f>;
 template class PolyLine<Vec2d>;
 
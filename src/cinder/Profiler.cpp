@@ -0,0 +1,420 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/Profiler.h"
+#include "cinder/Stream.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#if ! defined( CINDER_WINRT )
+	#include <boost/thread/tss.hpp>
+#endif
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+#if defined( CINDER_WINRT )
+// boost::thread is unavailable on WinRT
+__declspec( thread ) void *sThreadBuffer = NULL;
+
+void* getThreadBufferPtr()
+{
+	return sThreadBuffer;
+}
+
+void setThreadBufferPtr( void *threadBuffer )
+{
+	sThreadBuffer = threadBuffer;
+}
+#else
+// only the slot is deleted at thread exit, the Profiler owns the ThreadBuffer itself
+struct ThreadBufferSlot {
+	void *mThreadBuffer;
+};
+
+boost::thread_specific_ptr<ThreadBufferSlot> sThreadBuffer;
+
+void* getThreadBufferPtr()
+{
+	ThreadBufferSlot *slot = sThreadBuffer.get();
+	return slot ? slot->mThreadBuffer : nullptr;
+}
+
+void setThreadBufferPtr( void *threadBuffer )
+{
+	ThreadBufferSlot *slot = new ThreadBufferSlot;
+	slot->mThreadBuffer = threadBuffer;
+	sThreadBuffer.reset( slot );
+}
+#endif
+
+void writeJsonString( ostream &os, const char *str )
+{
+	os << '"';
+	for( const char *c = str; *c; ++c ) {
+		switch( *c ) {
+			case '"':	os << "\\\""; break;
+			case '\\':	os << "\\\\"; break;
+			case '\n':	os << "\\n"; break;
+			case '\t':	os << "\\t"; break;
+			default:
+				if( (unsigned char)*c < 0x20 )
+					os << "\\u" << hex << setw( 4 ) << setfill( '0' ) << (int)*c << dec << setfill( ' ' );
+				else
+					os << *c;
+		}
+	}
+	os << '"';
+}
+
+// the Profiler is created during static initialization at the latest, while there is only one thread
+Profiler *sProfilerInit = Profiler::get();
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Profiler
+// ----------------------------------------------------------------------------------------------------
+
+Profiler::ThreadBuffer::ThreadBuffer( size_t index )
+	: mIndex( index )
+{
+	stringstream ss;
+	ss << "thread " << index;
+	mName = ss.str();
+}
+
+Profiler* Profiler::get()
+{
+	// Intentionally never destroyed, so that zones can be recorded from static destructors and exiting threads.
+	static Profiler *sInstance = new Profiler;
+	return sInstance;
+}
+
+Profiler::Profiler()
+	: mTimer( true ), mEnabled( false ), mMaxThreadZones( 65536 ), mNumDroppedZones( 0 ), mFrameNumber( 0 ), mFrameBegin( 0 ), mFrameSeconds( 0 ),
+	mCapturing( false ), mMaxCapturedZones( 0 )
+{
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+	ThreadBuffer *result = static_cast<ThreadBuffer *>( getThreadBufferPtr() );
+	if( ! result ) {
+		lock_guard<mutex> lock( mMutex );
+		mThreadBuffers.push_back( unique_ptr<ThreadBuffer>( new ThreadBuffer( mThreadBuffers.size() ) ) );
+		result = mThreadBuffers.back().get();
+		setThreadBufferPtr( result );
+	}
+
+	return result;
+}
+
+void Profiler::recordZone( const char *name, const char *category, double beginSeconds, double endSeconds )
+{
+	if( ! mEnabled )
+		return;
+
+	Zone zone = { name, category, beginSeconds, endSeconds };
+	recordZone( getThreadBuffer(), zone );
+}
+
+void Profiler::recordTrackZone( size_t trackId, const char *name, const char *category, double beginSeconds, double endSeconds )
+{
+	if( ! mEnabled )
+		return;
+
+	ThreadBuffer *threadBuffer;
+	{
+		lock_guard<mutex> lock( mMutex );
+		if( trackId >= mThreadBuffers.size() )
+			return;
+
+		threadBuffer = mThreadBuffers[trackId].get();
+	}
+
+	Zone zone = { name, category, beginSeconds, endSeconds };
+	recordZone( threadBuffer, zone );
+}
+
+void Profiler::recordZone( ThreadBuffer *threadBuffer, const Zone &zone )
+{
+	lock_guard<mutex> lock( threadBuffer->mMutex );
+	if( threadBuffer->mZones.size() >= mMaxThreadZones ) {
+		mNumDroppedZones++;
+		return;
+	}
+
+	threadBuffer->mZones.push_back( zone );
+}
+
+size_t Profiler::getTrack( const string &name )
+{
+	lock_guard<mutex> lock( mMutex );
+	for( size_t trackId : mTracks ) {
+		if( mThreadBuffers[trackId]->mName == name )
+			return trackId;
+	}
+
+	size_t trackId = mThreadBuffers.size();
+	mThreadBuffers.push_back( unique_ptr<ThreadBuffer>( new ThreadBuffer( trackId ) ) );
+	mThreadBuffers.back()->mName = name;
+	mTracks.push_back( trackId );
+	return trackId;
+}
+
+void Profiler::setThreadName( const string &name )
+{
+	ThreadBuffer *threadBuffer = getThreadBuffer();
+	lock_guard<mutex> lock( mMutex );
+	threadBuffer->mName = name;
+}
+
+// note: called with mMutex held. The zones of all threads are appended to zones, the owning thread's index of each to threadIndices.
+void Profiler::collectZones( vector<Zone> *zones, vector<size_t> *threadIndices )
+{
+	for( auto &threadBuffer : mThreadBuffers ) {
+		lock_guard<mutex> lock( threadBuffer->mMutex );
+		zones->insert( zones->end(), threadBuffer->mZones.begin(), threadBuffer->mZones.end() );
+		threadIndices->resize( zones->size(), threadBuffer->mIndex );
+		threadBuffer->mZones.clear();
+	}
+}
+
+// note: called with mMutex held
+void Profiler::captureCollectedZones()
+{
+	for( size_t i = 0; i < mCollectedZones.size(); i++ ) {
+		if( mCapturedZones.size() >= mMaxCapturedZones ) {
+			mNumDroppedZones += mCollectedZones.size() - i;
+			break;
+		}
+
+		CapturedZone captured;
+		static_cast<Zone &>( captured ) = mCollectedZones[i];
+		captured.mThreadIndex = mCollectedThreadIndices[i];
+		mCapturedZones.push_back( captured );
+	}
+}
+
+void Profiler::frameMark()
+{
+	const double now = getSeconds();
+
+	// sampled outside of mMutex, MemoryStats has a lock of its own
+	vector<MemoryStats::Stats> memoryStats;
+	if( MemoryStats::isEnabled() )
+		memoryStats = MemoryStats::getStats();
+
+	lock_guard<mutex> lock( mMutex );
+
+	mCollectedZones.clear();
+	mCollectedThreadIndices.clear();
+	collectZones( &mCollectedZones, &mCollectedThreadIndices );
+
+	map<string, ZoneStats> statsByName;
+	for( const auto &zone : mCollectedZones ) {
+		ZoneStats &stats = statsByName[zone.mName];
+		double seconds = zone.mEnd - zone.mBegin;
+		stats.mCount++;
+		stats.mTotalSeconds += seconds;
+		stats.mMaxSeconds = max( stats.mMaxSeconds, seconds );
+	}
+
+	mFrameStats.clear();
+	for( auto &stats : statsByName ) {
+		stats.second.mName = stats.first;
+		mFrameStats.push_back( stats.second );
+	}
+
+	sort( mFrameStats.begin(), mFrameStats.end(), []( const ZoneStats &a, const ZoneStats &b ) { return a.mTotalSeconds > b.mTotalSeconds; } );
+
+	if( mCapturing ) {
+		captureCollectedZones();
+		mCapturedFrameMarks.push_back( now );
+		if( ! memoryStats.empty() )
+			mCapturedMemoryStats.push_back( make_pair( now, std::move( memoryStats ) ) );
+	}
+
+	mFrameSeconds = now - mFrameBegin;
+	mFrameBegin = now;
+	mFrameNumber++;
+}
+
+uint64_t Profiler::getFrameNumber() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mFrameNumber;
+}
+
+double Profiler::getFrameSeconds() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mFrameSeconds;
+}
+
+vector<Profiler::ZoneStats> Profiler::getFrameStats() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mFrameStats;
+}
+
+void Profiler::beginCapture( size_t maxZones )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		// discard the zones recorded before the capture began
+		mCollectedZones.clear();
+		mCollectedThreadIndices.clear();
+		collectZones( &mCollectedZones, &mCollectedThreadIndices );
+
+		mCapturedZones.clear();
+		mCapturedFrameMarks.clear();
+		mCapturedMemoryStats.clear();
+		mMaxCapturedZones = maxZones;
+		mCapturing = true;
+		mNumDroppedZones = 0;
+	}
+
+	setEnabled();
+}
+
+void Profiler::endCapture()
+{
+	if( ! isCapturing() )
+		return;
+
+	// collect the partial frame into the capture, without disturbing the per-frame stats
+	lock_guard<mutex> lock( mMutex );
+
+	mCollectedZones.clear();
+	mCollectedThreadIndices.clear();
+	collectZones( &mCollectedZones, &mCollectedThreadIndices );
+	captureCollectedZones();
+
+	mCapturing = false;
+}
+
+bool Profiler::isCapturing() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mCapturing;
+}
+
+size_t Profiler::getNumCapturedZones() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mCapturedZones.size();
+}
+
+void Profiler::writeChromeTrace( const DataTargetRef &dataTarget ) const
+{
+	// timestamps and durations are in microseconds, see the Trace Event Format specification
+	stringstream ss;
+	ss << fixed << setprecision( 3 );
+	ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		bool first = true;
+		for( const auto &threadBuffer : mThreadBuffers ) {
+			ss << ( first ? "" : "," ) << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadBuffer->mIndex << ",\"args\":{\"name\":";
+			writeJsonString( ss, threadBuffer->mName.c_str() );
+			ss << "}}";
+			first = false;
+		}
+
+		for( const auto &zone : mCapturedZones ) {
+			ss << ( first ? "" : "," ) << "\n{\"name\":";
+			writeJsonString( ss, zone.mName );
+			ss << ",\"cat\":";
+			writeJsonString( ss, zone.mCategory );
+			ss << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.mThreadIndex << ",\"ts\":" << zone.mBegin * 1e6 << ",\"dur\":" << ( zone.mEnd - zone.mBegin ) * 1e6 << "}";
+			first = false;
+		}
+
+		for( double frameMark : mCapturedFrameMarks ) {
+			ss << ( first ? "" : "," ) << "\n{\"name\":\"frame\",\"cat\":\"cinder\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" << frameMark * 1e6 << "}";
+			first = false;
+		}
+
+		// one counter track each for CPU and GPU memory, stacked by category
+		for( const auto &sample : mCapturedMemoryStats ) {
+			for( int gpu = 0; gpu < 2; ++gpu ) {
+				ss << ( first ? "" : "," ) << "\n{\"name\":\"" << ( gpu ? "memory (GPU)" : "memory (CPU)" ) << "\",\"cat\":\"cinder\",\"ph\":\"C\",\"pid\":1,\"ts\":" << sample.first * 1e6 << ",\"args\":{";
+				bool firstArg = true;
+				for( const auto &stats : sample.second ) {
+					if( stats.mGpu != ( gpu != 0 ) )
+						continue;
+					ss << ( firstArg ? "" : "," );
+					writeJsonString( ss, stats.mName.c_str() );
+					ss << ":" << stats.mBytes;
+					firstArg = false;
+				}
+				ss << "}}";
+				first = false;
+			}
+		}
+	}
+
+	ss << "\n]}\n";
+
+	const string json = ss.str();
+	dataTarget->getStream()->writeData( json.data(), json.size() );
+}
+
+void Profiler::writeChromeTrace( const fs::path &path ) const
+{
+	writeChromeTrace( (DataTargetRef)writeFile( path ) );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ScopedProfileZone
+// ----------------------------------------------------------------------------------------------------
+
+ScopedProfileZone::ScopedProfileZone( const char *name, const char *category )
+	: mName( name ), mCategory( category ), mBegin( 0 )
+{
+	Profiler *profiler = Profiler::get();
+	mActive = profiler->isEnabled();
+	if( mActive )
+		mBegin = profiler->getSeconds();
+}
+
+ScopedProfileZone::~ScopedProfileZone()
+{
+	if( mActive ) {
+		Profiler *profiler = Profiler::get();
+		profiler->recordZone( mName, mCategory, mBegin, profiler->getSeconds() );
+	}
+}
+
+} // namespace cinder
@@ -30,30 +30,130 @@
 #	include <windows.h>
 #endif
 
+#include <atomic>
+#include <mutex>
+#if ! defined( CINDER_WINRT )
+#	include <boost/thread/tss.hpp>
+#endif
+
 namespace cinder {
-	
-std::mt19937 Rand::sBase( 310u );
-std::uniform_real_distribution<float> Rand::sFloatGen;
+
+namespace {
+
+struct ThreadRand {
+	ThreadRand( uint32_t index )
+		: mIndex( index ), mGeneration( 0 )
+	{}
+
+	RandGenerator<std::mt19937>		mRand;
+	uint32_t						mIndex;
+	// seed generation mRand was last seeded from; 0 means never
+	uint32_t						mGeneration;
+};
+
+std::mutex				sSeedMutex;
+unsigned long			sSeed = 310u;
+std::atomic<uint32_t>	sSeedGeneration( 1 );
+std::atomic<uint32_t>	sNextThreadIndex( 0 );
+
+#if defined( CINDER_WINRT )
+// boost::thread is unavailable on WinRT; threads' generators are not reclaimed at thread exit
+__declspec( thread ) ThreadRand *sThreadRand = NULL;
+
+ThreadRand* getThreadRand()
+{
+	return sThreadRand;
+}
+
+void setThreadRand( ThreadRand *threadRand )
+{
+	sThreadRand = threadRand;
+}
+#else
+boost::thread_specific_ptr<ThreadRand> sThreadRand;
+
+ThreadRand* getThreadRand()
+{
+	return sThreadRand.get();
+}
+
+void setThreadRand( ThreadRand *threadRand )
+{
+	sThreadRand.reset( threadRand );
+}
+#endif
+
+void seedThreadRand( ThreadRand *threadRand )
+{
+	unsigned long seed;
+	{
+		std::lock_guard<std::mutex> lock( sSeedMutex );
+		seed = sSeed;
+		threadRand->mGeneration = sSeedGeneration.load();
+	}
+
+	// the first thread matches the single shared generator of earlier releases; later threads get decorrelated seeds
+	if( threadRand->mIndex == 0 )
+		threadRand->mRand = RandGenerator<std::mt19937>( seed );
+	else {
+		uint32_t seedData[2] = { static_cast<uint32_t>( seed ), threadRand->mIndex };
+		std::seed_seq seq( seedData, seedData + 2 );
+		threadRand->mRand = RandGenerator<std::mt19937>( std::mt19937( seq ) );
+	}
+}
+
+ThreadRand* getOrCreateThreadRand()
+{
+	ThreadRand *result = getThreadRand();
+	if( ! result ) {
+		result = new ThreadRand( sNextThreadIndex++ );
+		setThreadRand( result );
+	}
+
+	return result;
+}
+
+void setSeed( unsigned long seed )
+{
+	std::lock_guard<std::mutex> lock( sSeedMutex );
+	sSeed = seed;
+	// skip 0, which marks an unseeded thread
+	if( ++sSeedGeneration == 0 )
+		++sSeedGeneration;
+}
+
+} // anonymous namespace
+
+RandGenerator<std::mt19937>& Rand::threadGenerator()
+{
+	ThreadRand *threadRand = getOrCreateThreadRand();
+	if( threadRand->mGeneration != sSeedGeneration.load( std::memory_order_relaxed ) )
+		seedThreadRand( threadRand );
+
+	return threadRand->mRand;
+}
 
 void Rand::randomize()
 {
 #if defined( CINDER_COCOA )
-	sBase = std::mt19937( mach_absolute_time() );
+	setSeed( static_cast<unsigned long>( mach_absolute_time() ) );
 #elif defined( CINDER_WINRT)
-	sBase = std::mt19937( static_cast<unsigned long>(::GetTickCount64()) );
+	setSeed( static_cast<unsigned long>(::GetTickCount64()) );
 #else
-	sBase = std::mt19937( ::GetTickCount() );
+	setSeed( ::GetTickCount() );
 #endif
 }
 
 void Rand::randSeed( unsigned long seed )
 {
-	sBase = std::mt19937( seed );
+	setSeed( seed );
 }
 
-void Rand::seed( unsigned long seedValue )
+void Rand::randSeedThread( unsigned long seed )
 {
-	mBase = std::mt19937( seedValue );
+	ThreadRand *threadRand = getOrCreateThreadRand();
+	threadRand->mRand = RandGenerator<std::mt19937>( seed );
+	threadRand->mGeneration = sSeedGeneration.load();
 }
 
-} // ci
\ No newline at end of file
+} // namespace cinder
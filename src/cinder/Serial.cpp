@@ -23,9 +23,14 @@
 #include "cinder/Serial.h"
 #include "cinder/Timer.h"
 #include "cinder/Thread.h"
+#include "cinder/System.h"
 #include "cinder/Utilities.h"
 #include "cinder/Unicode.h"
 
+#include <cstring>
+#include "cinder/audio/dsp/RingBuffer.h"
+
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fcntl.h>
@@ -35,6 +40,8 @@
 	#include <sys/ioctl.h>
 	#include <getopt.h>
 	#include <dirent.h>
+	#include <poll.h>
+	#include <IOKit/serial/ioss.h>
 #elif defined( CINDER_MSW )
 	#include <setupapi.h>
 	#pragma comment(lib, "setupapi.lib")
@@ -48,13 +55,36 @@ namespace cinder {
 bool							Serial::sDevicesInited = false;
 std::vector<Serial::Device>		Serial::sDevices;
 
+#if defined( CINDER_MSW )
+namespace {
+
+// The device is opened for overlapped I/O so that the I/O thread can wait on it, which means even synchronous transfers need an OVERLAPPED
+bool transferOverlapped( ::HANDLE deviceHandle, ::HANDLE event, bool write, void *data, size_t numBytes, ::DWORD *bytesTransferred )
+{
+	::OVERLAPPED overlapped;
+	memset( &overlapped, 0, sizeof( overlapped ) );
+	overlapped.hEvent = event;
+	::ResetEvent( event );
+
+	*bytesTransferred = 0;
+	::BOOL success = write ? ::WriteFile( deviceHandle, data, (::DWORD)numBytes, bytesTransferred, &overlapped )
+							: ::ReadFile( deviceHandle, data, (::DWORD)numBytes, bytesTransferred, &overlapped );
+	if( ( ! success ) && ( ::GetLastError() == ERROR_IO_PENDING ) )
+		success = ::GetOverlappedResult( deviceHandle, &overlapped, bytesTransferred, TRUE );
+
+	return success != FALSE;
+}
+
+} // anonymous namespace
+#endif
+
 Serial::Serial( const Serial::Device &device, int baudRate )
 	: mObj( new Obj( device, baudRate ) )
 {
 }
 
 Serial::Obj::Obj( const Serial::Device &device, int baudRate )
-	: mDevice( device )
+	: mDevice( device ), mAsyncRunning( false ), mAsyncFailed( false ), mNumBytesDropped( 0 )
 {
 #if defined( CINDER_MAC )
 	mFd = open( ( "/dev/" + device.getName() ).c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK );
@@ -79,7 +109,8 @@ Serial::Obj::Obj( const Serial::Device &device, int baudRate )
 	baudToConstant[230400] = B230400;	
 	
 	int rateConstant = B9600;
-	if( baudToConstant.find( baudRate ) != baudToConstant.end() )
+	bool standardRate = baudToConstant.find( baudRate ) != baudToConstant.end();
+	if( standardRate )
 		rateConstant = baudToConstant[baudRate];
 	
 	::cfsetispeed( &options, rateConstant );
@@ -91,8 +122,21 @@ Serial::Obj::Obj( const Serial::Device &device, int baudRate )
 	options.c_cflag &= ~CSIZE;
 	options.c_cflag |= CS8;
 	::tcsetattr( mFd, TCSANOW, &options );
+
+	// rates without a termios constant, such as 1000000, are set directly on the driver
+	if( ! standardRate ) {
+		::speed_t speed = baudRate;
+		::ioctl( mFd, IOSSIOSPEED, &speed );
+	}
+
+	if( ::pipe( mWakePipe ) == -1 ) {
+		::close( mFd );
+		throw SerialExcOpenFailed();
+	}
+	::fcntl( mWakePipe[0], F_SETFL, O_NONBLOCK );
+	::fcntl( mWakePipe[1], F_SETFL, O_NONBLOCK );
 #elif defined( CINDER_MSW )
-	mDeviceHandle = ::CreateFileA( mDevice.getPath().c_str(), GENERIC_READ|GENERIC_WRITE, 0, 0, OPEN_EXISTING, 0, 0 );
+	mDeviceHandle = ::CreateFileA( mDevice.getPath().c_str(), GENERIC_READ|GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, 0 );
 	if( mDeviceHandle == INVALID_HANDLE_VALUE ) {
 		throw SerialExcOpenFailed();
 	}
@@ -117,6 +161,9 @@ Serial::Obj::Obj( const Serial::Device &device, int baudRate )
 	timeOuts.ReadTotalTimeoutMultiplier = 0;
 	timeOuts.ReadTotalTimeoutConstant = 0;
 	::SetCommTimeouts( mDeviceHandle, &timeOuts );
+
+	mSyncEvent = ::CreateEvent( 0, TRUE, FALSE, 0 );
+	mWakeEvent = ::CreateEvent( 0, FALSE, FALSE, 0 );
 #endif
 }
 
@@ -212,13 +259,19 @@ const std::vector<Serial::Device>& Serial::getDevices( bool forceRefresh )
 
 Serial::Obj::~Obj()
 {
+	stopAsync();
+
 #if defined( CINDER_MAC )
 	// restore the termios from before we opened the port
 	::tcsetattr( mFd, TCSANOW, &mSavedOptions );
 	::close( mFd );
+	::close( mWakePipe[0] );
+	::close( mWakePipe[1] );
 #elif defined( CINDER_MSW )
 	::SetCommTimeouts( mDeviceHandle, &mSavedTimeouts );
 	::CloseHandle( mDeviceHandle );
+	::CloseHandle( mSyncEvent );
+	::CloseHandle( mWakeEvent );
 #endif
 }
 
@@ -229,16 +282,29 @@ const Serial::Device& Serial::getDevice() const
 
 void Serial::writeBytes( const void *data, size_t numBytes )
 {
+	if( mObj->mAsyncThread ) {
+		if( mObj->mAsyncFailed )
+			throw SerialExcWriteFailure();
+
+		{
+			lock_guard<mutex> lock( mObj->mWriteMutex );
+			mObj->mWriteQueue.insert( mObj->mWriteQueue.end(), (const uint8_t *)data, (const uint8_t *)data + numBytes );
+		}
+		mObj->wakeAsync();
+		return;
+	}
+
 	size_t totalBytesWritten = 0;
 	
 	while( totalBytesWritten < numBytes ) {
+		const uint8_t *src = (const uint8_t *)data + totalBytesWritten;
 #if defined( CINDER_MAC )
-		long bytesWritten = ::write( mObj->mFd, data, numBytes - totalBytesWritten );
+		long bytesWritten = ::write( mObj->mFd, src, numBytes - totalBytesWritten );
 		if( ( bytesWritten == -1 ) && ( errno != EAGAIN ) )
-			throw SerialExcReadFailure();	
+			throw SerialExcWriteFailure();
 #elif defined( CINDER_MSW )
 		::DWORD bytesWritten;
-		if( ! ::WriteFile( mObj->mDeviceHandle, data, numBytes - totalBytesWritten, &bytesWritten, 0 ) )
+		if( ! transferOverlapped( mObj->mDeviceHandle, mObj->mSyncEvent, true, (void *)src, numBytes - totalBytesWritten, &bytesWritten ) )
 			throw SerialExcWriteFailure();
 #endif
 		if( bytesWritten != -1 )
@@ -250,30 +316,47 @@ void Serial::readBytes( void *data, size_t numBytes )
 {
 	size_t totalBytesRead = 0;
 	while( totalBytesRead < numBytes ) {
+		uint8_t *dst = (uint8_t *)data + totalBytesRead;
+		if( mObj->mAsyncThread ) {
+			size_t bytesRead = mObj->readReceived( dst, numBytes - totalBytesRead );
+			if( ( bytesRead == 0 ) && mObj->mAsyncFailed )
+				throw SerialExcReadFailure();
+			totalBytesRead += bytesRead;
+		}
+		else {
 #if defined( CINDER_MAC )
-		long bytesRead = ::read( mObj->mFd, data, numBytes - totalBytesRead );
-		if( ( bytesRead == -1 ) && ( errno != EAGAIN ) )
-			throw SerialExcReadFailure();
+			long bytesRead = ::read( mObj->mFd, dst, numBytes - totalBytesRead );
+			if( ( bytesRead == -1 ) && ( errno != EAGAIN ) )
+				throw SerialExcReadFailure();
 #elif defined( CINDER_MSW )
-		::DWORD bytesRead = 0;
-		if( ! ::ReadFile( mObj->mDeviceHandle, data, numBytes - totalBytesRead, &bytesRead, 0 ) )
-			throw SerialExcReadFailure();
+			::DWORD bytesRead = 0;
+			if( ! transferOverlapped( mObj->mDeviceHandle, mObj->mSyncEvent, false, dst, numBytes - totalBytesRead, &bytesRead ) )
+				throw SerialExcReadFailure();
 #endif
-		if( bytesRead != -1 )
-			totalBytesRead += bytesRead;
+			if( bytesRead != -1 )
+				totalBytesRead += bytesRead;
+		}
 		
 		// yield thread time to the system
-		this_thread::yield();
+		if( totalBytesRead < numBytes )
+			this_thread::yield();
 	}
 }
 
 size_t Serial::readAvailableBytes( void *data, size_t maximumBytes )
 {
+	if( mObj->mAsyncThread ) {
+		size_t bytesRead = mObj->readReceived( data, maximumBytes );
+		if( ( bytesRead == 0 ) && mObj->mAsyncFailed )
+			throw SerialExcReadFailure();
+		return bytesRead;
+	}
+
 #if defined( CINDER_MAC )
 	long bytesRead = ::read( mObj->mFd, data, maximumBytes );
 #elif defined( CINDER_MSW )
 	::DWORD bytesRead = 0;
-	if( ! ::ReadFile( mObj->mDeviceHandle, data, maximumBytes, &bytesRead, 0 ) )
+	if( ! transferOverlapped( mObj->mDeviceHandle, mObj->mSyncEvent, false, data, maximumBytes, &bytesRead ) )
 		throw SerialExcReadFailure();
 #endif
 
@@ -336,12 +419,14 @@ std::string Serial::readStringUntil( char token, size_t maxLength, double timeou
 
 void Serial::writeString( const std::string &str )
 {
-	for( string::const_iterator strIt = str.begin(); strIt != str.end(); ++strIt )
-		writeByte( *strIt );
+	writeBytes( str.data(), str.size() );
 }
 
 size_t Serial::getNumBytesAvailable() const
 {
+	if( mObj->mAsyncThread )
+		return mObj->mReceiveBuffer->getAvailableRead();
+
 	int result;
 	
 #if defined( CINDER_MAC )
@@ -360,6 +445,20 @@ size_t Serial::getNumBytesAvailable() const
 	
 void Serial::flush( bool input, bool output )
 {
+	if( mObj->mAsyncThread ) {
+		// the I/O thread owns the device, so only what has been received or queued is discarded
+		if( input ) {
+			uint8_t discarded[1024];
+			while( mObj->readReceived( discarded, sizeof( discarded ) ) > 0 )
+				;
+		}
+		if( output ) {
+			lock_guard<mutex> lock( mObj->mWriteMutex );
+			mObj->mWriteQueue.clear();
+		}
+		return;
+	}
+
 #if defined( CINDER_MAC )
 	int queue;
 	if( input && output )
@@ -382,4 +481,288 @@ void Serial::flush( bool input, bool output )
 #endif
 }
 
+void Serial::startAsync( const AsyncFormat &format )
+{
+	mObj->startAsync( format );
+}
+
+void Serial::stopAsync()
+{
+	mObj->stopAsync();
+}
+
+bool Serial::isAsync() const
+{
+	return mObj && mObj->mAsyncThread;
+}
+
+size_t Serial::getNumBytesQueued() const
+{
+	lock_guard<mutex> lock( mObj->mWriteMutex );
+	return mObj->mWriteQueue.size();
+}
+
+size_t Serial::getNumBytesDropped() const
+{
+	return mObj->mNumBytesDropped;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Serial::Obj async I/O
+
+void Serial::Obj::startAsync( const AsyncFormat &format )
+{
+	stopAsync();
+
+	mAsyncFormat = format;
+	mReceiveBuffer.reset( new audio::dsp::RingBufferT<uint8_t>( std::max<size_t>( format.getReceiveBufferSize(), 1 ) ) );
+	mNumBytesDropped = 0;
+	mMessage.clear();
+	mAsyncFailed = false;
+	mAsyncRunning = true;
+	mAsyncThread.reset( new thread( bind( &Serial::Obj::asyncThreadFn, this ) ) );
+}
+
+void Serial::Obj::stopAsync()
+{
+	if( ! mAsyncThread )
+		return;
+
+	mAsyncRunning = false;
+	wakeAsync();
+	mAsyncThread->join();
+	mAsyncThread.reset();
+	mReceiveBuffer.reset();
+
+	lock_guard<mutex> lock( mWriteMutex );
+	mWriteQueue.clear();
+}
+
+void Serial::Obj::wakeAsync()
+{
+#if defined( CINDER_MAC )
+	const uint8_t wake = 0;
+	::write( mWakePipe[1], &wake, 1 );
+#elif defined( CINDER_MSW )
+	::SetEvent( mWakeEvent );
+#endif
+}
+
+size_t Serial::Obj::readReceived( void *data, size_t maximumBytes )
+{
+	size_t numBytes = std::min( maximumBytes, mReceiveBuffer->getAvailableRead() );
+	mReceiveBuffer->read( (uint8_t *)data, numBytes );
+	return numBytes;
+}
+
+void Serial::Obj::receive( const uint8_t *data, size_t numBytes )
+{
+	const AsyncFormat::ReceiveFn &receiveFn = mAsyncFormat.getReceiveFn();
+	const AsyncFormat::MessageFn &messageFn = mAsyncFormat.getMessageFn();
+
+	if( receiveFn )
+		receiveFn( data, numBytes );
+
+	if( messageFn ) {
+		const char delimiter = mAsyncFormat.getDelimiter();
+		const size_t maxMessageLength = std::max<size_t>( mAsyncFormat.getMaxMessageLength(), 1 );
+		const uint8_t *end = data + numBytes;
+		while( data < end ) {
+			const uint8_t *found = std::find( data, end, (uint8_t)delimiter );
+			size_t length = std::min<size_t>( found - data, maxMessageLength - mMessage.size() );
+			mMessage.append( (const char *)data, length );
+			data += length;
+
+			if( ( data < end ) && ( *data == (uint8_t)delimiter ) ) {
+				messageFn( mMessage );
+				mMessage.clear();
+				++data;
+			}
+			else if( mMessage.size() == maxMessageLength ) {
+				messageFn( mMessage );
+				mMessage.clear();
+			}
+		}
+	}
+	else if( ! receiveFn ) {
+		size_t numWritten = std::min( numBytes, mReceiveBuffer->getAvailableWrite() );
+		mReceiveBuffer->write( data, numWritten );
+		mNumBytesDropped += numBytes - numWritten;
+	}
+}
+
+#if defined( CINDER_MAC )
+
+void Serial::Obj::asyncThreadFn()
+{
+	System::setThreadName( "serial I/O" );
+	System::setThreadPriority( System::PRIORITY_HIGH );
+
+	vector<uint8_t> readBuffer( 4096 ), writing;
+	size_t writeOffset = 0;
+
+	while( mAsyncRunning ) {
+		if( writeOffset == writing.size() ) {
+			writing.clear();
+			writeOffset = 0;
+			lock_guard<mutex> lock( mWriteMutex );
+			writing.swap( mWriteQueue );
+		}
+
+		::pollfd fds[2];
+		fds[0].fd = mFd;
+		fds[0].events = POLLIN | ( writing.empty() ? 0 : POLLOUT );
+		fds[0].revents = 0;
+		fds[1].fd = mWakePipe[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+
+		if( ::poll( fds, 2, -1 ) == -1 ) {
+			if( errno == EINTR )
+				continue;
+			mAsyncFailed = true;
+			break;
+		}
+
+		if( fds[1].revents & POLLIN ) {
+			uint8_t drained[64];
+			while( ::read( mWakePipe[0], drained, sizeof( drained ) ) > 0 )
+				;
+		}
+
+		if( fds[0].revents & ( POLLERR | POLLHUP | POLLNVAL ) ) {
+			mAsyncFailed = true;
+			break;
+		}
+
+		if( fds[0].revents & POLLIN ) {
+			long bytesRead;
+			while( ( bytesRead = ::read( mFd, readBuffer.data(), readBuffer.size() ) ) > 0 )
+				receive( readBuffer.data(), bytesRead );
+			if( ( bytesRead == -1 ) && ( errno != EAGAIN ) ) {
+				mAsyncFailed = true;
+				break;
+			}
+		}
+
+		if( fds[0].revents & POLLOUT ) {
+			long bytesWritten = ::write( mFd, writing.data() + writeOffset, writing.size() - writeOffset );
+			if( bytesWritten > 0 )
+				writeOffset += bytesWritten;
+			else if( ( bytesWritten == -1 ) && ( errno != EAGAIN ) ) {
+				mAsyncFailed = true;
+				break;
+			}
+		}
+	}
+}
+
+#elif defined( CINDER_MSW )
+
+void Serial::Obj::asyncThreadFn()
+{
+	System::setThreadName( "serial I/O" );
+	System::setThreadPriority( System::PRIORITY_HIGH );
+
+	// larger driver queues ride out the I/O thread being descheduled at high baud rates
+	::SetupComm( mDeviceHandle, 65536, 65536 );
+	::SetCommMask( mDeviceHandle, EV_RXCHAR );
+
+	::HANDLE readEvent = ::CreateEvent( 0, TRUE, FALSE, 0 );
+	::OVERLAPPED commOverlapped, writeOverlapped;
+	memset( &commOverlapped, 0, sizeof( commOverlapped ) );
+	memset( &writeOverlapped, 0, sizeof( writeOverlapped ) );
+	commOverlapped.hEvent = ::CreateEvent( 0, TRUE, FALSE, 0 );
+	writeOverlapped.hEvent = ::CreateEvent( 0, TRUE, FALSE, 0 );
+
+	vector<uint8_t> readBuffer( 4096 ), writing;
+	size_t writeOffset = 0;
+	bool commPending = false, writePending = false;
+	::DWORD commMask = 0;
+
+	while( mAsyncRunning ) {
+		// with the COMMTIMEOUTS set by the constructor, reads complete immediately with whatever has been received
+		::DWORD bytesRead = 0;
+		bool readSucceeded;
+		while( ( readSucceeded = transferOverlapped( mDeviceHandle, readEvent, false, readBuffer.data(), readBuffer.size(), &bytesRead ) ) && ( bytesRead > 0 ) )
+			receive( readBuffer.data(), bytesRead );
+		if( ! readSucceeded ) {
+			mAsyncFailed = true;
+			break;
+		}
+
+		if( ! commPending ) {
+			::ResetEvent( commOverlapped.hEvent );
+			if( ::WaitCommEvent( mDeviceHandle, &commMask, &commOverlapped ) )
+				continue; // bytes arrived in the meantime
+			if( ::GetLastError() != ERROR_IO_PENDING ) {
+				mAsyncFailed = true;
+				break;
+			}
+			commPending = true;
+		}
+
+		if( ! writePending ) {
+			if( writeOffset == writing.size() ) {
+				writing.clear();
+				writeOffset = 0;
+				lock_guard<mutex> lock( mWriteMutex );
+				writing.swap( mWriteQueue );
+			}
+
+			if( ! writing.empty() ) {
+				::ResetEvent( writeOverlapped.hEvent );
+				::DWORD bytesWritten = 0;
+				if( ::WriteFile( mDeviceHandle, writing.data() + writeOffset, (::DWORD)( writing.size() - writeOffset ), &bytesWritten, &writeOverlapped ) ) {
+					writeOffset += bytesWritten;
+					continue;
+				}
+				if( ::GetLastError() != ERROR_IO_PENDING ) {
+					mAsyncFailed = true;
+					break;
+				}
+				writePending = true;
+			}
+		}
+
+		::HANDLE events[3] = { mWakeEvent, commOverlapped.hEvent, writeOverlapped.hEvent };
+		::DWORD result = ::WaitForMultipleObjects( writePending ? 3 : 2, events, FALSE, INFINITE );
+		if( result == WAIT_OBJECT_0 + 1 ) {
+			::DWORD unused;
+			::GetOverlappedResult( mDeviceHandle, &commOverlapped, &unused, FALSE );
+			commPending = false;
+		}
+		else if( result == WAIT_OBJECT_0 + 2 ) {
+			::DWORD bytesWritten = 0;
+			writePending = false;
+			if( ! ::GetOverlappedResult( mDeviceHandle, &writeOverlapped, &bytesWritten, FALSE ) ) {
+				mAsyncFailed = true;
+				break;
+			}
+			writeOffset += bytesWritten;
+		}
+		else if( result == WAIT_FAILED ) {
+			mAsyncFailed = true;
+			break;
+		}
+	}
+
+	// the OVERLAPPED structures must outlive any transfer still in flight
+	if( commPending || writePending ) {
+		::CancelIo( mDeviceHandle );
+		::DWORD unused;
+		if( commPending )
+			::GetOverlappedResult( mDeviceHandle, &commOverlapped, &unused, TRUE );
+		if( writePending )
+			::GetOverlappedResult( mDeviceHandle, &writeOverlapped, &unused, TRUE );
+	}
+
+	::SetCommMask( mDeviceHandle, 0 );
+	::CloseHandle( readEvent );
+	::CloseHandle( commOverlapped.hEvent );
+	::CloseHandle( writeOverlapped.hEvent );
+}
+
+#endif
+
 } // namespace cinder
\ No newline at end of file
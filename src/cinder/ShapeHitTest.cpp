@@ -0,0 +1,256 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ShapeHitTest.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <functional>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+// Matches the crossing rule of Path2d::contains() and PolyLine::contains()
+inline bool edgeCrosses( const Vec2f &p0, const Vec2f &p1, const Vec2f &pt )
+{
+	if( ( p0.x < pt.x && pt.x <= p1.x ) || ( p1.x < pt.x && pt.x <= p0.x ) )
+		return pt.y > p0.y + ( p1.y - p0.y ) * ( pt.x - p0.x ) / ( p1.x - p0.x );
+	return false;
+}
+
+// Shapes covering more than this many hash cells are kept in a separate list instead
+const int MAX_CELLS_PER_SHAPE = 1024;
+const int MAX_COLUMNS = 1024;
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShapeHitTester
+ShapeHitTester::ShapeHitTester( const Shape2d &shape, float approximationScale )
+	: mNumColumns( 0 ), mColumnScale( 0 )
+{
+	for( vector<Path2d>::const_iterator contIt = shape.getContours().begin(); contIt != shape.getContours().end(); ++contIt ) {
+		vector<Vec2f> points = contIt->subdivide( approximationScale );
+		// subdivide() repeats the endpoints of adjacent segments
+		points.erase( std::unique( points.begin(), points.end() ), points.end() );
+		addContour( points );
+	}
+	buildColumns();
+}
+
+ShapeHitTester::ShapeHitTester( const PolyLine2f &polyLine )
+	: mNumColumns( 0 ), mColumnScale( 0 )
+{
+	addContour( polyLine.getPoints() );
+	buildColumns();
+}
+
+ShapeHitTester::ShapeHitTester( const vector<PolyLine2f> &polyLines )
+	: mNumColumns( 0 ), mColumnScale( 0 )
+{
+	for( vector<PolyLine2f>::const_iterator lineIt = polyLines.begin(); lineIt != polyLines.end(); ++lineIt )
+		addContour( lineIt->getPoints() );
+	buildColumns();
+}
+
+void ShapeHitTester::addContour( const vector<Vec2f> &points )
+{
+	if( points.size() < 2 )
+		return;
+
+	// contours are always treated as closed
+	for( size_t p = 0; p < points.size(); ++p ) {
+		const Vec2f &p0 = points[p];
+		const Vec2f &p1 = points[( p + 1 ) % points.size()];
+		// vertical edges never cross the ray
+		if( p0.x == p1.x )
+			continue;
+		mEdges.push_back( p0 );
+		mEdges.push_back( p1 );
+	}
+}
+
+void ShapeHitTester::buildColumns()
+{
+	if( mEdges.empty() )
+		return;
+
+	mBounds = Rectf( mEdges[0], mEdges[0] );
+	mBounds.include( mEdges );
+
+	size_t numEdges = mEdges.size() / 2;
+	mNumColumns = (int)std::min<size_t>( std::max<size_t>( numEdges, 1 ), MAX_COLUMNS );
+	mColumnScale = ( mBounds.getWidth() > 0 ) ? mNumColumns / mBounds.getWidth() : 0;
+
+	// count the edges overlapping each column, then fill them in
+	vector<int> firstColumns( numEdges ), lastColumns( numEdges );
+	mColumnStarts.assign( mNumColumns + 1, 0 );
+	for( size_t e = 0; e < numEdges; ++e ) {
+		float x0 = ( std::min( mEdges[e*2].x, mEdges[e*2+1].x ) - mBounds.x1 ) * mColumnScale;
+		float x1 = ( std::max( mEdges[e*2].x, mEdges[e*2+1].x ) - mBounds.x1 ) * mColumnScale;
+		firstColumns[e] = math<int>::clamp( (int)x0, 0, mNumColumns - 1 );
+		lastColumns[e] = math<int>::clamp( (int)x1, 0, mNumColumns - 1 );
+		for( int c = firstColumns[e]; c <= lastColumns[e]; ++c )
+			mColumnStarts[c+1]++;
+	}
+	for( int c = 0; c < mNumColumns; ++c )
+		mColumnStarts[c+1] += mColumnStarts[c];
+
+	mColumnEdges.resize( mColumnStarts.back() );
+	vector<uint32_t> fill( mColumnStarts.begin(), mColumnStarts.end() - 1 );
+	for( size_t e = 0; e < numEdges; ++e ) {
+		for( int c = firstColumns[e]; c <= lastColumns[e]; ++c )
+			mColumnEdges[fill[c]++] = (uint32_t)e;
+	}
+}
+
+bool ShapeHitTester::contains( const Vec2f &pt ) const
+{
+	if( mEdges.empty() || ! mBounds.contains( pt ) )
+		return false;
+
+	int column = math<int>::clamp( (int)( ( pt.x - mBounds.x1 ) * mColumnScale ), 0, mNumColumns - 1 );
+	size_t crossings = 0;
+	for( uint32_t i = mColumnStarts[column]; i < mColumnStarts[column+1]; ++i ) {
+		uint32_t e = mColumnEdges[i];
+		if( edgeCrosses( mEdges[e*2], mEdges[e*2+1], pt ) )
+			++crossings;
+	}
+
+	return ( crossings & 1 ) == 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShapeHitIndex
+ShapeHitIndex::ShapeHitIndex( float cellSize )
+	: mCellSize( cellSize ), mCellScale( 1.0f / cellSize )
+{
+}
+
+size_t ShapeHitIndex::add( const Shape2d &shape, float approximationScale )
+{
+	return add( ShapeHitTester( shape, approximationScale ) );
+}
+
+size_t ShapeHitIndex::add( const PolyLine2f &polyLine )
+{
+	return add( ShapeHitTester( polyLine ) );
+}
+
+size_t ShapeHitIndex::add( const ShapeHitTester &hitTester )
+{
+	uint32_t index = (uint32_t)mShapes.size();
+	mShapes.push_back( hitTester );
+	if( hitTester.getNumEdges() == 0 )
+		return index;
+
+	const Rectf &bounds = hitTester.getBounds();
+	int cellX1 = calcCell( bounds.x1 ), cellX2 = calcCell( bounds.x2 );
+	int cellY1 = calcCell( bounds.y1 ), cellY2 = calcCell( bounds.y2 );
+	if( (int64_t)( cellX2 - cellX1 + 1 ) * ( cellY2 - cellY1 + 1 ) > MAX_CELLS_PER_SHAPE ) {
+		mOversized.push_back( index );
+		return index;
+	}
+
+	for( int y = cellY1; y <= cellY2; ++y )
+		for( int x = cellX1; x <= cellX2; ++x )
+			mCells[calcCellKey( x, y )].push_back( index );
+
+	return index;
+}
+
+void ShapeHitIndex::clear()
+{
+	mShapes.clear();
+	mCells.clear();
+	mOversized.clear();
+}
+
+int ShapeHitIndex::calcCell( float v ) const
+{
+	return (int)math<float>::floor( v * mCellScale );
+}
+
+int ShapeHitIndex::hitTest( const Vec2f &pt ) const
+{
+	int result = -1;
+
+	// indices within each list are ascending, so the first hit from the back is the topmost
+	std::unordered_map<uint64_t,vector<uint32_t> >::const_iterator cellIt = mCells.find( calcCellKey( calcCell( pt.x ), calcCell( pt.y ) ) );
+	if( cellIt != mCells.end() ) {
+		for( vector<uint32_t>::const_reverse_iterator it = cellIt->second.rbegin(); it != cellIt->second.rend(); ++it ) {
+			if( mShapes[*it].contains( pt ) ) {
+				result = (int)*it;
+				break;
+			}
+		}
+	}
+
+	for( vector<uint32_t>::const_reverse_iterator it = mOversized.rbegin(); it != mOversized.rend(); ++it ) {
+		if( (int)*it <= result )
+			break;
+		if( mShapes[*it].contains( pt ) ) {
+			result = (int)*it;
+			break;
+		}
+	}
+
+	return result;
+}
+
+void ShapeHitIndex::hitTest( const Vec2f *points, size_t numPoints, int *result ) const
+{
+	for( size_t p = 0; p < numPoints; ++p )
+		result[p] = hitTest( points[p] );
+}
+
+void ShapeHitIndex::hitTestAll( const Vec2f &pt, vector<size_t> *result ) const
+{
+	vector<size_t> candidates;
+	queryBounds( pt, &candidates );
+	std::sort( candidates.begin(), candidates.end(), std::greater<size_t>() );
+	for( vector<size_t>::const_iterator it = candidates.begin(); it != candidates.end(); ++it ) {
+		if( mShapes[*it].contains( pt ) )
+			result->push_back( *it );
+	}
+}
+
+void ShapeHitIndex::queryBounds( const Vec2f &pt, vector<size_t> *result ) const
+{
+	std::unordered_map<uint64_t,vector<uint32_t> >::const_iterator cellIt = mCells.find( calcCellKey( calcCell( pt.x ), calcCell( pt.y ) ) );
+	if( cellIt != mCells.end() ) {
+		for( vector<uint32_t>::const_iterator it = cellIt->second.begin(); it != cellIt->second.end(); ++it ) {
+			if( mShapes[*it].getBounds().contains( pt ) )
+				result->push_back( *it );
+		}
+	}
+
+	for( vector<uint32_t>::const_iterator it = mOversized.begin(); it != mOversized.end(); ++it ) {
+		if( mShapes[*it].getBounds().contains( pt ) )
+			result->push_back( *it );
+	}
+}
+
+} // namespace cinder
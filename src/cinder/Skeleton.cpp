@@ -0,0 +1,343 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/Skeleton.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// Rotations are blended with a normalized lerp whose parameter is adjusted by a polynomial in t and the cosine between the quaternions, fit to
+// slerp's angular velocity (after Kapoulkine, "Approximating slerp", 2015). It matches slerp to within 0.0015 radians but vectorizes as plain arithmetic.
+inline void slerpCorrection( float t, float *c1, float *c2 )
+{
+	*c1 = t * ( t - 0.5f ) * ( t - 1 );
+	*c2 = ( t - 0.5f ) * ( t - 0.5f );
+}
+
+void lerpScalar( const float *a, const float *b, float t, float *result, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		result[i] = a[i] + ( b[i] - a[i] ) * t;
+}
+
+void slerpScalar( const float * const a[4], const float * const b[4], float t, float * const result[4], size_t count )
+{
+	float c1, c2;
+	slerpCorrection( t, &c1, &c2 );
+	for( size_t i = 0; i < count; ++i ) {
+		float d = a[0][i] * b[0][i] + a[1][i] * b[1][i] + a[2][i] * b[2][i] + a[3][i] * b[3][i];
+		const float sign = ( d < 0 ) ? -1.0f : 1.0f;
+		d = fabs( d );
+		const float k = ( 1.0904f + d * ( -3.2452f + d * ( 3.55645f - d * 1.43519f ) ) ) * c2 + ( 0.848013f + d * ( -1.06021f + d * 0.215638f ) );
+		const float ot = t + c1 * k;
+		const float wa = 1 - ot, wb = ot * sign;
+		float q[4], lengthSq = 0;
+		for( int c = 0; c < 4; ++c ) {
+			q[c] = a[c][i] * wa + b[c][i] * wb;
+			lengthSq += q[c] * q[c];
+		}
+		const float invLength = 1.0f / sqrt( lengthSq );
+		for( int c = 0; c < 4; ++c )
+			result[c][i] = q[c] * invLength;
+	}
+}
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+// SkeletonPose pads its channels to a multiple of 4 bones, so count always is too
+void lerpSse2( const float *a, const float *b, float t, float *result, size_t count )
+{
+	const __m128 vt = _mm_set1_ps( t );
+	for( size_t i = 0; i < count; i += 4 ) {
+		const __m128 va = _mm_loadu_ps( a + i );
+		_mm_storeu_ps( result + i, _mm_add_ps( va, _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( b + i ), va ), vt ) ) );
+	}
+}
+
+void slerpSse2( const float * const a[4], const float * const b[4], float t, float * const result[4], size_t count )
+{
+	float c1, c2;
+	slerpCorrection( t, &c1, &c2 );
+	const __m128 vt = _mm_set1_ps( t ), vc1 = _mm_set1_ps( c1 ), vc2 = _mm_set1_ps( c2 ), one = _mm_set1_ps( 1 );
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	for( size_t i = 0; i < count; i += 4 ) {
+		__m128 qa[4], qb[4];
+		for( int c = 0; c < 4; ++c ) {
+			qa[c] = _mm_loadu_ps( a[c] + i );
+			qb[c] = _mm_loadu_ps( b[c] + i );
+		}
+		__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( qa[0], qb[0] ), _mm_mul_ps( qa[1], qb[1] ) ), _mm_add_ps( _mm_mul_ps( qa[2], qb[2] ), _mm_mul_ps( qa[3], qb[3] ) ) );
+		const __m128 sign = _mm_and_ps( d, signBit );
+		d = _mm_andnot_ps( signBit, d );
+		__m128 ka = _mm_sub_ps( _mm_set1_ps( 3.55645f ), _mm_mul_ps( d, _mm_set1_ps( 1.43519f ) ) );
+		ka = _mm_add_ps( _mm_set1_ps( -3.2452f ), _mm_mul_ps( d, ka ) );
+		ka = _mm_add_ps( _mm_set1_ps( 1.0904f ), _mm_mul_ps( d, ka ) );
+		__m128 kb = _mm_add_ps( _mm_set1_ps( -1.06021f ), _mm_mul_ps( d, _mm_set1_ps( 0.215638f ) ) );
+		kb = _mm_add_ps( _mm_set1_ps( 0.848013f ), _mm_mul_ps( d, kb ) );
+		const __m128 ot = _mm_add_ps( vt, _mm_mul_ps( vc1, _mm_add_ps( _mm_mul_ps( ka, vc2 ), kb ) ) );
+		const __m128 wa = _mm_sub_ps( one, ot ), wb = _mm_xor_ps( ot, sign );
+
+		__m128 q[4], lengthSq = _mm_setzero_ps();
+		for( int c = 0; c < 4; ++c ) {
+			q[c] = _mm_add_ps( _mm_mul_ps( qa[c], wa ), _mm_mul_ps( qb[c], wb ) );
+			lengthSq = _mm_add_ps( lengthSq, _mm_mul_ps( q[c], q[c] ) );
+		}
+		const __m128 invLength = _mm_div_ps( one, _mm_sqrt_ps( lengthSq ) );
+		for( int c = 0; c < 4; ++c )
+			_mm_storeu_ps( result[c] + i, _mm_mul_ps( q[c], invLength ) );
+	}
+}
+#endif // defined( CINDER_SSE2 )
+
+#if defined( CINDER_NEON )
+void lerpNeon( const float *a, const float *b, float t, float *result, size_t count )
+{
+	const float32x4_t vt = vdupq_n_f32( t );
+	for( size_t i = 0; i < count; i += 4 ) {
+		const float32x4_t va = vld1q_f32( a + i );
+		vst1q_f32( result + i, vmlaq_f32( va, vsubq_f32( vld1q_f32( b + i ), va ), vt ) );
+	}
+}
+
+void slerpNeon( const float * const a[4], const float * const b[4], float t, float * const result[4], size_t count )
+{
+	float c1, c2;
+	slerpCorrection( t, &c1, &c2 );
+	const float32x4_t vt = vdupq_n_f32( t ), vc1 = vdupq_n_f32( c1 ), vc2 = vdupq_n_f32( c2 ), one = vdupq_n_f32( 1 );
+	const uint32x4_t signBit = vdupq_n_u32( 0x80000000 );
+	for( size_t i = 0; i < count; i += 4 ) {
+		float32x4_t qa[4], qb[4];
+		for( int c = 0; c < 4; ++c ) {
+			qa[c] = vld1q_f32( a[c] + i );
+			qb[c] = vld1q_f32( b[c] + i );
+		}
+		float32x4_t d = vmulq_f32( qa[0], qb[0] );
+		d = vmlaq_f32( d, qa[1], qb[1] );
+		d = vmlaq_f32( d, qa[2], qb[2] );
+		d = vmlaq_f32( d, qa[3], qb[3] );
+		const uint32x4_t sign = vandq_u32( vreinterpretq_u32_f32( d ), signBit );
+		d = vabsq_f32( d );
+		float32x4_t ka = vmlsq_f32( vdupq_n_f32( 3.55645f ), d, vdupq_n_f32( 1.43519f ) );
+		ka = vmlaq_f32( vdupq_n_f32( -3.2452f ), d, ka );
+		ka = vmlaq_f32( vdupq_n_f32( 1.0904f ), d, ka );
+		float32x4_t kb = vmlaq_f32( vdupq_n_f32( -1.06021f ), d, vdupq_n_f32( 0.215638f ) );
+		kb = vmlaq_f32( vdupq_n_f32( 0.848013f ), d, kb );
+		const float32x4_t ot = vmlaq_f32( vt, vc1, vmlaq_f32( kb, ka, vc2 ) );
+		const float32x4_t wa = vsubq_f32( one, ot ), wb = vreinterpretq_f32_u32( veorq_u32( vreinterpretq_u32_f32( ot ), sign ) );
+
+		float32x4_t q[4], lengthSq = vdupq_n_f32( 0 );
+		for( int c = 0; c < 4; ++c ) {
+			q[c] = vmlaq_f32( vmulq_f32( qa[c], wa ), qb[c], wb );
+			lengthSq = vmlaq_f32( lengthSq, q[c], q[c] );
+		}
+		// reciprocal square root estimate refined by two Newton-Raphson steps
+		float32x4_t invLength = vrsqrteq_f32( lengthSq );
+		invLength = vmulq_f32( invLength, vrsqrtsq_f32( vmulq_f32( lengthSq, invLength ), invLength ) );
+		invLength = vmulq_f32( invLength, vrsqrtsq_f32( vmulq_f32( lengthSq, invLength ), invLength ) );
+		for( int c = 0; c < 4; ++c )
+			vst1q_f32( result[c] + i, vmulq_f32( q[c], invLength ) );
+	}
+}
+#endif // defined( CINDER_NEON )
+
+} // anonymous namespace
+
+Matrix44f BoneTransform::toMatrix44() const
+{
+	Matrix44f result = mRotation.toMatrix44();
+	for( int row = 0; row < 3; ++row ) {
+		result.m[row] *= mScale.x;
+		result.m[4 + row] *= mScale.y;
+		result.m[8 + row] *= mScale.z;
+	}
+	result.m[12] = mTranslation.x;
+	result.m[13] = mTranslation.y;
+	result.m[14] = mTranslation.z;
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SkeletonPose
+SkeletonPose::SkeletonPose( size_t numBones )
+	: mNumBones( numBones ), mStride( ( numBones + 3 ) & ~3 ), mData( mStride * NUM_CHANNELS, 0.0f )
+{
+	// padding bones are identity too, so that they blend to something harmless
+	std::fill( getChannel( ROTATION_W ), getChannel( ROTATION_W ) + mStride, 1.0f );
+	std::fill( getChannel( SCALE_X ), getChannel( SCALE_X ) + mStride * 3, 1.0f );
+}
+
+BoneTransform SkeletonPose::getTransform( size_t bone ) const
+{
+	const float *d = &mData[bone];
+	const size_t s = mStride;
+	return BoneTransform( Vec3f( d[TRANSLATION_X * s], d[TRANSLATION_Y * s], d[TRANSLATION_Z * s] ),
+						Quatf( d[ROTATION_W * s], d[ROTATION_X * s], d[ROTATION_Y * s], d[ROTATION_Z * s] ),
+						Vec3f( d[SCALE_X * s], d[SCALE_Y * s], d[SCALE_Z * s] ) );
+}
+
+void SkeletonPose::setTransform( size_t bone, const BoneTransform &transform )
+{
+	float *d = &mData[bone];
+	const size_t s = mStride;
+	d[TRANSLATION_X * s] = transform.mTranslation.x;
+	d[TRANSLATION_Y * s] = transform.mTranslation.y;
+	d[TRANSLATION_Z * s] = transform.mTranslation.z;
+	d[ROTATION_X * s] = transform.mRotation.v.x;
+	d[ROTATION_Y * s] = transform.mRotation.v.y;
+	d[ROTATION_Z * s] = transform.mRotation.v.z;
+	d[ROTATION_W * s] = transform.mRotation.w;
+	d[SCALE_X * s] = transform.mScale.x;
+	d[SCALE_Y * s] = transform.mScale.y;
+	d[SCALE_Z * s] = transform.mScale.z;
+}
+
+void SkeletonPose::blend( const SkeletonPose &a, const SkeletonPose &b, float t, SkeletonPose *result )
+{
+	if( a.mNumBones != b.mNumBones )
+		throw SkeletonExc( "SkeletonPose::blend(): poses have different numbers of bones" );
+	if( result->mNumBones != a.mNumBones )
+		*result = SkeletonPose( a.mNumBones );
+
+	const size_t stride = a.mStride;
+	const float * const rotationsA[4] = { a.getChannel( ROTATION_X ), a.getChannel( ROTATION_Y ), a.getChannel( ROTATION_Z ), a.getChannel( ROTATION_W ) };
+	const float * const rotationsB[4] = { b.getChannel( ROTATION_X ), b.getChannel( ROTATION_Y ), b.getChannel( ROTATION_Z ), b.getChannel( ROTATION_W ) };
+	float * const rotationsResult[4] = { result->getChannel( ROTATION_X ), result->getChannel( ROTATION_Y ), result->getChannel( ROTATION_Z ), result->getChannel( ROTATION_W ) };
+
+	// translations and scales are each three consecutive channels
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		lerpSse2( a.getChannel( TRANSLATION_X ), b.getChannel( TRANSLATION_X ), t, result->getChannel( TRANSLATION_X ), stride * 3 );
+		lerpSse2( a.getChannel( SCALE_X ), b.getChannel( SCALE_X ), t, result->getChannel( SCALE_X ), stride * 3 );
+		slerpSse2( rotationsA, rotationsB, t, rotationsResult, stride );
+		return;
+	}
+#elif defined( CINDER_NEON )
+	lerpNeon( a.getChannel( TRANSLATION_X ), b.getChannel( TRANSLATION_X ), t, result->getChannel( TRANSLATION_X ), stride * 3 );
+	lerpNeon( a.getChannel( SCALE_X ), b.getChannel( SCALE_X ), t, result->getChannel( SCALE_X ), stride * 3 );
+	slerpNeon( rotationsA, rotationsB, t, rotationsResult, stride );
+	return;
+#endif
+	lerpScalar( a.getChannel( TRANSLATION_X ), b.getChannel( TRANSLATION_X ), t, result->getChannel( TRANSLATION_X ), stride * 3 );
+	lerpScalar( a.getChannel( SCALE_X ), b.getChannel( SCALE_X ), t, result->getChannel( SCALE_X ), stride * 3 );
+	slerpScalar( rotationsA, rotationsB, t, rotationsResult, stride );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Skeleton
+int Skeleton::addBone( const std::string &name, int parent, const BoneTransform &bindTransform )
+{
+	if( parent < -1 || parent >= (int)mParents.size() )
+		throw SkeletonExc( "Skeleton::addBone(): the parent of bone '" + name + "' must be added before it" );
+
+	Matrix44f bindMatrix = bindTransform.toMatrix44();
+	if( parent >= 0 )
+		bindMatrix = mBindMatrices[parent] * bindMatrix;
+
+	mNames.push_back( name );
+	mParents.push_back( parent );
+	mBindTransforms.push_back( bindTransform );
+	mBindMatrices.push_back( bindMatrix );
+	mInverseBindMatrices.push_back( bindMatrix.inverted() );
+	return (int)mParents.size() - 1;
+}
+
+int Skeleton::findBone( const std::string &name ) const
+{
+	for( size_t b = 0; b < mNames.size(); ++b ) {
+		if( mNames[b] == name )
+			return (int)b;
+	}
+	return -1;
+}
+
+SkeletonPose Skeleton::getBindPose() const
+{
+	SkeletonPose result( getNumBones() );
+	for( size_t b = 0; b < getNumBones(); ++b )
+		result.setTransform( b, mBindTransforms[b] );
+	return result;
+}
+
+void Skeleton::calcGlobalMatrices( const SkeletonPose &pose, Matrix44f *result ) const
+{
+	if( pose.getNumBones() != getNumBones() )
+		throw SkeletonExc( "Skeleton::calcGlobalMatrices(): the pose doesn't match the skeleton" );
+
+	for( size_t b = 0; b < getNumBones(); ++b ) {
+		if( mParents[b] >= 0 )
+			result[b] = result[mParents[b]] * pose.getTransform( b ).toMatrix44();
+		else
+			result[b] = pose.getTransform( b ).toMatrix44();
+	}
+}
+
+void Skeleton::calcSkinningMatrices( const SkeletonPose &pose, Matrix44f *result, const Matrix44f &transform ) const
+{
+	calcGlobalMatrices( pose, result );
+	for( size_t b = 0; b < getNumBones(); ++b )
+		result[b] = transform * result[b] * mInverseBindMatrices[b];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SkeletalAnimation
+SkeletalAnimation::SkeletalAnimation( size_t numBones, size_t numFrames, float framesPerSecond )
+	: mNumBones( numBones ), mFramesPerSecond( framesPerSecond ), mFrames( std::max<size_t>( numFrames, 1 ), SkeletonPose( numBones ) )
+{
+	if( framesPerSecond <= 0 )
+		throw SkeletonExc( "SkeletalAnimation: framesPerSecond must be positive" );
+}
+
+void SkeletalAnimation::sample( float seconds, SkeletonPose *result, bool loop ) const
+{
+	const size_t lastFrame = mFrames.size() - 1;
+	if( lastFrame == 0 ) {
+		*result = mFrames[0];
+		return;
+	}
+
+	float position = seconds * mFramesPerSecond;
+	if( loop ) {
+		position = fmod( position, (float)lastFrame );
+		if( position < 0 )
+			position += lastFrame;
+	}
+	else
+		position = std::min( std::max( position, 0.0f ), (float)lastFrame );
+
+	const size_t frame = std::min( (size_t)position, lastFrame - 1 );
+	SkeletonPose::blend( mFrames[frame], mFrames[frame + 1], position - frame, result );
+}
+
+} // namespace cinder
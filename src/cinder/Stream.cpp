@@ -25,9 +25,20 @@
 #include "cinder/Cinder.h"
 #include "cinder/Stream.h"
 #include "cinder/Utilities.h"
+#include "cinder/TaskPool.h"
 
 #include <stdio.h>
 #include <limits>
+#include <algorithm>
+#include <zlib.h>
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#elif ! defined( CINDER_WINRT )
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
 #include <boost/scoped_array.hpp>
 #include <iostream>
 #include <boost/preprocessor/seq/for_each.hpp>
@@ -62,6 +73,62 @@ void OStream::writeLittle( T t )
 #endif
 }
 
+namespace {
+
+// swaps the byte order of \a count values of type T in place
+template<typename T>
+void swapEndianArray( T *t, size_t count )
+{
+	switch( sizeof(T) ) {
+		case 2: swapEndianBlock( reinterpret_cast<uint16_t*>( t ), count * sizeof(T) ); break;
+		case 4: swapEndianBlock( reinterpret_cast<uint32_t*>( t ), count * sizeof(T) ); break;
+		case 8: swapEndianBlock( reinterpret_cast<double*>( t ), count * sizeof(T) ); break;
+	}
+}
+
+} // anonymous namespace
+
+template<typename T>
+void OStream::writeSwapped( const T *t, size_t count )
+{
+	if( sizeof(T) == 1 ) {
+		IOWrite( t, count );
+		return;
+	}
+
+	// the source can't be modified, so swap through a fixed size scratch buffer
+	T buffer[8192 / sizeof(T)];
+	const size_t bufferCount = sizeof(buffer) / sizeof(T);
+	while( count > 0 ) {
+		const size_t batch = std::min( count, bufferCount );
+		memcpy( buffer, t, batch * sizeof(T) );
+		swapEndianArray( buffer, batch );
+		IOWrite( buffer, batch * sizeof(T) );
+		t += batch;
+		count -= batch;
+	}
+}
+
+template<typename T>
+void OStream::writeBig( const T *t, size_t count )
+{
+#ifdef BOOST_BIG_ENDIAN
+	IOWrite( t, count * sizeof(T) );
+#else
+	writeSwapped( t, count );
+#endif
+}
+
+template<typename T>
+void OStream::writeLittle( const T *t, size_t count )
+{
+#ifdef CINDER_LITTLE_ENDIAN
+	IOWrite( t, count * sizeof(T) );
+#else
+	writeSwapped( t, count );
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////
 void IStreamCinder::read( std::string *s )
 {
@@ -103,6 +170,24 @@ void IStreamCinder::readLittle( T *t )
 #endif
 }
 
+template<typename T>
+void IStreamCinder::readBig( T *t, size_t count )
+{
+	IORead( t, count * sizeof(T) );
+#ifndef BOOST_BIG_ENDIAN
+	swapEndianArray( t, count );
+#endif
+}
+
+template<typename T>
+void IStreamCinder::readLittle( T *t, size_t count )
+{
+	IORead( t, count * sizeof(T) );
+#ifndef CINDER_LITTLE_ENDIAN
+	swapEndianArray( t, count );
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 
 void IStreamCinder::readFixedString( char *t, size_t size, bool nullTerminate )
@@ -483,6 +568,87 @@ void IStreamMem::IORead( void *t, size_t size )
 	mOffset += size;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+// MemoryMappedFile
+MemoryMappedFileRef MemoryMappedFile::create( const fs::path &path, size_t minSize )
+{
+#if defined( CINDER_MSW )
+	HANDLE file = ::CreateFileW( expandPath( path ).wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		return MemoryMappedFileRef();
+
+	LARGE_INTEGER fileSize;
+	if( ! ::GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0 || (uint64_t)fileSize.QuadPart < (uint64_t)minSize || (uint64_t)fileSize.QuadPart > (uint64_t)std::numeric_limits<size_t>::max() ) {
+		::CloseHandle( file );
+		return MemoryMappedFileRef();
+	}
+
+	HANDLE mapping = ::CreateFileMappingW( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	if( ! mapping ) {
+		::CloseHandle( file );
+		return MemoryMappedFileRef();
+	}
+
+	void *data = ::MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+	if( ! data ) {
+		::CloseHandle( mapping );
+		::CloseHandle( file );
+		return MemoryMappedFileRef();
+	}
+
+	return MemoryMappedFileRef( new MemoryMappedFile( data, (size_t)fileSize.QuadPart, file, mapping ) );
+#elif defined( CINDER_WINRT )
+	return MemoryMappedFileRef(); // not supported, callers fall back to reading the file
+#else
+	int fd = ::open( expandPath( path ).string().c_str(), O_RDONLY );
+	if( fd < 0 )
+		return MemoryMappedFileRef();
+
+	struct stat fileStat;
+	if( ::fstat( fd, &fileStat ) != 0 || ! S_ISREG( fileStat.st_mode ) || fileStat.st_size == 0 || (uint64_t)fileStat.st_size < (uint64_t)minSize || (uint64_t)fileStat.st_size > (uint64_t)std::numeric_limits<size_t>::max() ) {
+		::close( fd );
+		return MemoryMappedFileRef();
+	}
+
+	// the mapping remains valid after the file descriptor is closed
+	size_t size = (size_t)fileStat.st_size;
+	void *data = ::mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	::close( fd );
+	if( data == MAP_FAILED )
+		return MemoryMappedFileRef();
+
+	return MemoryMappedFileRef( new MemoryMappedFile( data, size, NULL, NULL ) );
+#endif
+}
+
+MemoryMappedFile::MemoryMappedFile( void *data, size_t size, void *fileHandle, void *mappingHandle )
+	: mData( data ), mSize( size ), mFileHandle( fileHandle ), mMappingHandle( mappingHandle )
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+#if defined( CINDER_MSW )
+	::UnmapViewOfFile( mData );
+	::CloseHandle( mMappingHandle );
+	::CloseHandle( mFileHandle );
+#elif ! defined( CINDER_WINRT )
+	::munmap( mData, mSize );
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// IStreamMemoryMapped
+IStreamMemoryMappedRef IStreamMemoryMapped::create( const MemoryMappedFileRef &mappedFile )
+{
+	return IStreamMemoryMappedRef( new IStreamMemoryMapped( mappedFile ) );
+}
+
+IStreamMemoryMapped::IStreamMemoryMapped( const MemoryMappedFileRef &mappedFile )
+	: IStreamMem( mappedFile->getData(), mappedFile->getSize() ), mMappedFile( mappedFile )
+{
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // OStreamMem
 OStreamMem::OStreamMem( size_t bufferSizeHint )
@@ -523,6 +689,347 @@ void OStreamMem::IOWrite( const void *t, size_t size )
 	mOffset += size;
 }
 
+/////////////////////////////////////////////////////////////////////
+// OStreamDeflate
+namespace {
+
+const size_t DEFLATE_CHUNK_SIZE = 16384;
+const size_t DEFLATE_WINDOW_SIZE = 32768;
+
+int deflateWindowBits( DeflateFormat format )
+{
+	switch( format ) {
+		case DEFLATE_FORMAT_GZIP: return 16 + MAX_WBITS;
+		case DEFLATE_FORMAT_RAW: return -MAX_WBITS;
+		default: return MAX_WBITS;
+	}
+}
+
+void deleteDeflateStream( z_stream *zs )
+{
+	deflateEnd( zs );
+	delete zs;
+}
+
+void deleteInflateStream( z_stream *zs )
+{
+	inflateEnd( zs );
+	delete zs;
+}
+
+} // anonymous namespace
+
+OStreamDeflateRef OStreamDeflate::create( const OStreamRef &output, int8_t compressionLevel, DeflateFormat format, TaskPool *taskPool, size_t blockSize )
+{
+	return OStreamDeflateRef( new OStreamDeflate( output, compressionLevel, format, taskPool, blockSize ) );
+}
+
+OStreamDeflate::OStreamDeflate( const OStreamRef &output, int8_t compressionLevel, DeflateFormat format, TaskPool *taskPool, size_t blockSize )
+	: mOutput( output ), mCompressionLevel( compressionLevel ), mFormat( format ), mTaskPool( taskPool ), mBlockSize( std::max<size_t>( blockSize, DEFLATE_WINDOW_SIZE ) ),
+	mTotalIn( 0 ), mFinished( false ), mPendingSize( 0 ), mCheck( 0 )
+{
+	if( ! mOutput )
+		throw StreamExc();
+
+	if( ! mTaskPool ) {
+		z_stream *zs = new z_stream;
+		memset( zs, 0, sizeof(z_stream) );
+		if( deflateInit2( zs, mCompressionLevel, Z_DEFLATED, deflateWindowBits( mFormat ), 8, Z_DEFAULT_STRATEGY ) != Z_OK ) {
+			delete zs;
+			throw StreamExc();
+		}
+		mZStream = std::shared_ptr<z_stream>( zs, deleteDeflateStream );
+		mOutBuffer.resize( DEFLATE_CHUNK_SIZE );
+	}
+	else {
+		// the calling thread participates in parallelFor(), so gather one block per thread plus one
+		mPending.resize( mBlockSize * ( mTaskPool->getNumThreads() + 1 ) );
+		if( mFormat == DEFLATE_FORMAT_ZLIB ) {
+			const uint8_t flags[4] = { 0x01, 0x5E, 0x9C, 0xDA };
+			const uint8_t header[2] = { 0x78, flags[( mCompressionLevel < 2 ) ? 0 : ( ( mCompressionLevel < 6 ) ? 1 : ( ( mCompressionLevel == 6 ) ? 2 : 3 ) )] };
+			mOutput->writeData( header, 2 );
+			mCheck = adler32( 0L, Z_NULL, 0 );
+		}
+		else if( mFormat == DEFLATE_FORMAT_GZIP ) {
+			// no file name or modification time, unknown OS
+			const uint8_t header[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+			mOutput->writeData( header, 10 );
+			mCheck = crc32( 0L, Z_NULL, 0 );
+		}
+	}
+}
+
+OStreamDeflate::~OStreamDeflate()
+{
+	try {
+		finish();
+	}
+	catch( ... ) {
+	}
+}
+
+void OStreamDeflate::seekAbsolute( off_t absoluteOffset )
+{
+	throw StreamExc();
+}
+
+void OStreamDeflate::seekRelative( off_t relativeOffset )
+{
+	throw StreamExc();
+}
+
+void OStreamDeflate::IOWrite( const void *t, size_t size )
+{
+	if( mFinished )
+		throw StreamExc();
+	mTotalIn += size;
+
+	const uint8_t *data = reinterpret_cast<const uint8_t*>( t );
+	if( ! mTaskPool ) {
+		deflateSerial( data, size, Z_NO_FLUSH );
+		return;
+	}
+
+	while( size > 0 ) {
+		// large writes are compressed in place rather than copied through mPending
+		if( mPendingSize == 0 && size >= mPending.size() ) {
+			deflateParallel( data, mPending.size(), Z_NO_FLUSH );
+			data += mPending.size();
+			size -= mPending.size();
+			continue;
+		}
+
+		size_t toCopy = std::min( size, mPending.size() - mPendingSize );
+		memcpy( &mPending[mPendingSize], data, toCopy );
+		mPendingSize += toCopy;
+		data += toCopy;
+		size -= toCopy;
+		if( mPendingSize == mPending.size() ) {
+			deflateParallel( &mPending[0], mPendingSize, Z_NO_FLUSH );
+			mPendingSize = 0;
+		}
+	}
+}
+
+void OStreamDeflate::flush()
+{
+	if( mFinished )
+		return;
+
+	if( ! mTaskPool )
+		deflateSerial( 0, 0, Z_SYNC_FLUSH );
+	else if( mPendingSize > 0 ) {
+		deflateParallel( &mPending[0], mPendingSize, Z_SYNC_FLUSH );
+		mPendingSize = 0;
+	}
+}
+
+void OStreamDeflate::finish()
+{
+	if( mFinished )
+		return;
+	mFinished = true;
+
+	if( ! mTaskPool ) {
+		deflateSerial( 0, 0, Z_FINISH );
+		mZStream.reset();
+		return;
+	}
+
+	deflateParallel( mPendingSize ? &mPending[0] : 0, mPendingSize, Z_FINISH );
+	mPendingSize = 0;
+	std::vector<uint8_t>().swap( mPending );
+
+	if( mFormat == DEFLATE_FORMAT_ZLIB ) {
+		const uint8_t trailer[4] = { (uint8_t)( mCheck >> 24 ), (uint8_t)( mCheck >> 16 ), (uint8_t)( mCheck >> 8 ), (uint8_t)mCheck };
+		mOutput->writeData( trailer, 4 );
+	}
+	else if( mFormat == DEFLATE_FORMAT_GZIP ) {
+		const uint32_t totalIn = (uint32_t)mTotalIn; // modulo 2^32
+		const uint8_t trailer[8] = { (uint8_t)mCheck, (uint8_t)( mCheck >> 8 ), (uint8_t)( mCheck >> 16 ), (uint8_t)( mCheck >> 24 ),
+									(uint8_t)totalIn, (uint8_t)( totalIn >> 8 ), (uint8_t)( totalIn >> 16 ), (uint8_t)( totalIn >> 24 ) };
+		mOutput->writeData( trailer, 8 );
+	}
+}
+
+void OStreamDeflate::deflateSerial( const uint8_t *data, size_t size, int flush )
+{
+	z_stream *zs = mZStream.get();
+	// avail_in is 32 bits, so very large writes are fed in pieces
+	const size_t maxPieceSize = 1 << 30;
+	do {
+		const size_t pieceSize = std::min( size, maxPieceSize );
+		const int pieceFlush = ( pieceSize == size ) ? flush : Z_NO_FLUSH;
+		zs->next_in = const_cast<Bytef*>( data );
+		zs->avail_in = (uInt)pieceSize;
+		int result;
+		do {
+			zs->next_out = &mOutBuffer[0];
+			zs->avail_out = (uInt)mOutBuffer.size();
+			result = deflate( zs, pieceFlush );
+			if( result == Z_STREAM_ERROR )
+				throw StreamExc();
+			size_t produced = mOutBuffer.size() - zs->avail_out;
+			if( produced > 0 )
+				mOutput->writeData( &mOutBuffer[0], produced );
+		} while( zs->avail_out == 0 || ( pieceFlush == Z_FINISH && result != Z_STREAM_END ) );
+		data += pieceSize;
+		size -= pieceSize;
+	} while( size > 0 );
+}
+
+void OStreamDeflate::deflateParallel( const uint8_t *data, size_t size, int flush )
+{
+	// each block is deflated independently as raw data primed with the 32k preceding it, and all but the last of the stream end on a sync flush so that they concatenate
+	const size_t numBlocks = std::max<size_t>( 1, ( size + mBlockSize - 1 ) / mBlockSize );
+	std::vector<std::vector<uint8_t> > blocks( numBlocks );
+	std::vector<uLong> checks( numBlocks );
+	mTaskPool->parallelFor( 0, numBlocks, [&] ( size_t first, size_t last ) {
+		for( size_t b = first; b < last; ++b ) {
+			const size_t begin = b * mBlockSize;
+			const size_t blockSize = std::min( mBlockSize, size - begin );
+			const int blockFlush = ( flush == Z_FINISH && b == numBlocks - 1 ) ? Z_FINISH : Z_SYNC_FLUSH;
+
+			z_stream zs;
+			memset( &zs, 0, sizeof(zs) );
+			if( deflateInit2( &zs, mCompressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+				throw StreamExc();
+			if( b > 0 ) {
+				const size_t dictSize = std::min( begin, DEFLATE_WINDOW_SIZE );
+				deflateSetDictionary( &zs, data + begin - dictSize, (uInt)dictSize );
+			}
+			else if( ! mDictionary.empty() )
+				deflateSetDictionary( &zs, &mDictionary[0], (uInt)mDictionary.size() );
+
+			std::vector<uint8_t> &out = blocks[b];
+			out.resize( deflateBound( &zs, (uLong)blockSize ) + 16 );
+			zs.next_in = blockSize ? const_cast<Bytef*>( data + begin ) : Z_NULL;
+			zs.avail_in = (uInt)blockSize;
+			int result;
+			do {
+				if( zs.total_out == out.size() )
+					out.resize( out.size() * 2 );
+				zs.next_out = &out[zs.total_out];
+				zs.avail_out = (uInt)( out.size() - zs.total_out );
+				result = deflate( &zs, blockFlush );
+			} while( ( blockFlush == Z_FINISH && result == Z_OK ) || ( blockFlush != Z_FINISH && ( zs.avail_in > 0 || zs.avail_out == 0 ) ) );
+			out.resize( zs.total_out );
+			deflateEnd( &zs );
+			if( result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR )
+				throw StreamExc();
+
+			if( mFormat == DEFLATE_FORMAT_ZLIB )
+				checks[b] = adler32( adler32( 0L, Z_NULL, 0 ), blockSize ? data + begin : Z_NULL, (uInt)blockSize );
+			else if( mFormat == DEFLATE_FORMAT_GZIP )
+				checks[b] = crc32( crc32( 0L, Z_NULL, 0 ), blockSize ? data + begin : Z_NULL, (uInt)blockSize );
+		}
+	}, 1 );
+
+	for( size_t b = 0; b < numBlocks; ++b ) {
+		const z_off_t blockSize = (z_off_t)std::min( mBlockSize, size - b * mBlockSize );
+		if( mFormat == DEFLATE_FORMAT_ZLIB )
+			mCheck = adler32_combine( mCheck, checks[b], blockSize );
+		else if( mFormat == DEFLATE_FORMAT_GZIP )
+			mCheck = crc32_combine( mCheck, checks[b], blockSize );
+		if( ! blocks[b].empty() )
+			mOutput->writeData( &blocks[b][0], blocks[b].size() );
+	}
+
+	// keep the tail of the input as the dictionary for the next call, since \a data may not outlive it
+	if( size >= DEFLATE_WINDOW_SIZE )
+		mDictionary.assign( data + size - DEFLATE_WINDOW_SIZE, data + size );
+	else if( size > 0 ) {
+		mDictionary.insert( mDictionary.end(), data, data + size );
+		if( mDictionary.size() > DEFLATE_WINDOW_SIZE )
+			mDictionary.erase( mDictionary.begin(), mDictionary.end() - DEFLATE_WINDOW_SIZE );
+	}
+}
+
+/////////////////////////////////////////////////////////////////////
+// IStreamInflate
+IStreamInflateRef IStreamInflate::create( const IStreamRef &input, DeflateFormat format )
+{
+	return IStreamInflateRef( new IStreamInflate( input, format ) );
+}
+
+IStreamInflate::IStreamInflate( const IStreamRef &input, DeflateFormat format )
+	: mInput( input ), mInBuffer( DEFLATE_CHUNK_SIZE ), mTotalOut( 0 ), mStreamEnd( false )
+{
+	if( ! mInput )
+		throw StreamExc();
+
+	z_stream *zs = new z_stream;
+	memset( zs, 0, sizeof(z_stream) );
+	if( inflateInit2( zs, deflateWindowBits( format ) ) != Z_OK ) {
+		delete zs;
+		throw StreamExc();
+	}
+	mZStream = std::shared_ptr<z_stream>( zs, deleteInflateStream );
+}
+
+size_t IStreamInflate::readDataAvailable( void *dest, size_t maxSize )
+{
+	if( mStreamEnd || maxSize == 0 )
+		return 0;
+
+	z_stream *zs = mZStream.get();
+	zs->next_out = reinterpret_cast<Bytef*>( dest );
+	zs->avail_out = (uInt)maxSize;
+	// keep going until something is produced, since a block of input may only hold headers
+	while( zs->avail_out == maxSize ) {
+		if( zs->avail_in == 0 ) {
+			size_t bytesRead = mInput->isEof() ? 0 : mInput->readDataAvailable( &mInBuffer[0], mInBuffer.size() );
+			if( bytesRead == 0 )
+				throw StreamExc(); // truncated
+			zs->next_in = &mInBuffer[0];
+			zs->avail_in = (uInt)bytesRead;
+		}
+
+		int result = inflate( zs, Z_NO_FLUSH );
+		if( result == Z_STREAM_END ) {
+			mStreamEnd = true;
+			break;
+		}
+		else if( result != Z_OK && result != Z_BUF_ERROR )
+			throw StreamExc();
+	}
+
+	size_t produced = maxSize - zs->avail_out;
+	mTotalOut += produced;
+	return produced;
+}
+
+void IStreamInflate::seekAbsolute( off_t absoluteOffset )
+{
+	seekRelative( absoluteOffset - mTotalOut );
+}
+
+void IStreamInflate::seekRelative( off_t relativeOffset )
+{
+	if( relativeOffset < 0 )
+		throw StreamExc();
+
+	uint8_t discard[4096];
+	while( relativeOffset > 0 ) {
+		size_t bytesRead = readDataAvailable( discard, (size_t)std::min<off_t>( relativeOffset, sizeof(discard) ) );
+		if( bytesRead == 0 )
+			throw StreamExc();
+		relativeOffset -= bytesRead;
+	}
+}
+
+void IStreamInflate::IORead( void *t, size_t size )
+{
+	uint8_t *dest = reinterpret_cast<uint8_t*>( t );
+	while( size > 0 ) {
+		size_t bytesRead = readDataAvailable( dest, size );
+		if( bytesRead == 0 )
+			throw StreamExc();
+		dest += bytesRead;
+		size -= bytesRead;
+	}
+}
+
 /////////////////////////////////////////////////////////////////////
 
 IStreamFileRef loadFileStream( const fs::path &path )
@@ -632,7 +1139,11 @@ Buffer loadStreamBuffer( IStreamRef is )
 	template void IStreamCinder::read<T>( T *t ); \
 	template void IStreamCinder::readEndian<T>( T *t, uint8_t endian ); \
 	template void IStreamCinder::readBig<T>( T *t ); \
-	template void IStreamCinder::readLittle<T>( T *t );
+	template void IStreamCinder::readLittle<T>( T *t ); \
+	template void OStream::writeBig<T>( const T *t, size_t count ); \
+	template void OStream::writeLittle<T>( const T *t, size_t count ); \
+	template void IStreamCinder::readBig<T>( T *t, size_t count ); \
+	template void IStreamCinder::readLittle<T>( T *t, size_t count );
 
 BOOST_PP_SEQ_FOR_EACH( STREAM_PROTOTYPES, ~, (int8_t)(uint8_t)(int16_t)(uint16_t)(int32_t)(uint32_t)(float)(double) )
 
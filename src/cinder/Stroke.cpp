@@ -0,0 +1,283 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/Stroke.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+namespace {
+
+// Arcs are never split into more than this many triangles, however small the tolerance
+const int MAX_ARC_SEGMENTS = 256;
+
+// Emitters receive each vertex in turn; the counter lets calcNumVertices() share the generator so that the two always agree
+struct VertexCounter {
+	VertexCounter() : mCount( 0 ) {}
+	void operator()( const Vec2f &/*position*/, const Vec2f &/*texCoord*/ ) { ++mCount; }
+
+	size_t	mCount;
+};
+
+struct StridedWriter {
+	StridedWriter( Vec3f *positions, size_t positionStride, Vec2f *texCoords, size_t texCoordStride )
+		: mPositions( reinterpret_cast<uint8_t*>( positions ) ), mPositionStride( positionStride ? positionStride : sizeof(Vec3f) ),
+		mTexCoords( reinterpret_cast<uint8_t*>( texCoords ) ), mTexCoordStride( texCoordStride ? texCoordStride : sizeof(Vec2f) ), mCount( 0 )
+	{}
+
+	void operator()( const Vec2f &position, const Vec2f &texCoord )
+	{
+		*reinterpret_cast<Vec3f*>( mPositions ) = Vec3f( position.x, position.y, 0 );
+		mPositions += mPositionStride;
+		if( mTexCoords ) {
+			*reinterpret_cast<Vec2f*>( mTexCoords ) = texCoord;
+			mTexCoords += mTexCoordStride;
+		}
+		++mCount;
+	}
+
+	uint8_t		*mPositions;
+	size_t		mPositionStride;
+	uint8_t		*mTexCoords;
+	size_t		mTexCoordStride;
+	size_t		mCount;
+};
+
+struct VectorWriter {
+	VectorWriter( std::vector<Vec3f> *positions, std::vector<Vec2f> *texCoords ) : mPositions( positions ), mTexCoords( texCoords ) {}
+
+	void operator()( const Vec2f &position, const Vec2f &texCoord )
+	{
+		mPositions->push_back( Vec3f( position.x, position.y, 0 ) );
+		if( mTexCoords )
+			mTexCoords->push_back( texCoord );
+	}
+
+	std::vector<Vec3f>	*mPositions;
+	std::vector<Vec2f>	*mTexCoords;
+};
+
+template<typename EmitT>
+class StrokeGenerator {
+  public:
+	StrokeGenerator( const Stroke &stroke, EmitT &emit )
+		: mStroke( stroke ), mEmit( emit ), mHalfWidth( stroke.getWidth() * 0.5f )
+	{
+		// the largest angle whose chord stays within the tolerance of its arc
+		const float tolerance = std::max( stroke.getTolerance(), 0.0f );
+		mMaxArcStep = ( tolerance < mHalfWidth ) ? 2 * math<float>::acos( 1 - tolerance / mHalfWidth ) : (float)M_PI;
+	}
+
+	void operator()( const PolyLine2f &polyLine )
+	{
+		const std::vector<Vec2f> &points = polyLine.getPoints();
+		if( mHalfWidth <= 0 || points.size() < 2 )
+			return;
+
+		// a closed PolyLine may or may not repeat its first point at its end
+		const bool closed = polyLine.isClosed();
+		size_t end = points.size();
+		if( closed )
+			while( end > 1 && points[end - 1] == points[0] )
+				--end;
+
+		Vec2f firstDir, prevDir;
+		bool haveSegment = false;
+		float distance = 0;
+		size_t a = 0;
+		for( size_t b = 1; b < end || ( closed && b == end ); ++b ) {
+			const Vec2f &pa = points[a];
+			const Vec2f &pb = points[( b == end ) ? 0 : b];
+			const float length = pa.distance( pb );
+			if( length <= 0 )
+				continue;
+
+			const Vec2f dir = ( pb - pa ) / length;
+			if( haveSegment )
+				join( pa, prevDir, dir, distance );
+			else {
+				firstDir = dir;
+				if( ! closed )
+					cap( pa, dir, distance, true );
+				haveSegment = true;
+			}
+
+			quad( pa, pb, dir, distance, distance + length );
+			distance += length;
+			prevDir = dir;
+			a = ( b == end ) ? 0 : b;
+		}
+
+		if( ! haveSegment )
+			return;
+		if( closed )
+			join( points[0], prevDir, firstDir, distance );
+		else
+			cap( points[a], prevDir, distance, false );
+	}
+
+  private:
+	static Vec2f	leftOf( const Vec2f &dir ) { return Vec2f( -dir.y, dir.x ); }
+
+	// Texture coordinates of a point at \a offset from a point on the centerline \a distance along it, where it runs in \a dir
+	Vec2f	texCoordOf( const Vec2f &offset, const Vec2f &dir, float distance ) const
+	{
+		return Vec2f( distance + offset.dot( dir ), 0.5f - offset.dot( leftOf( dir ) ) / ( 2 * mHalfWidth ) );
+	}
+
+	// Two counter-clockwise triangles, with y up, covering the width of the line from \a a to \a b
+	void	quad( const Vec2f &a, const Vec2f &b, const Vec2f &dir, float distanceA, float distanceB )
+	{
+		const Vec2f side = leftOf( dir ) * mHalfWidth;
+		const Vec2f l0 = a + side, r0 = a - side, l1 = b + side, r1 = b - side;
+		mEmit( l0, Vec2f( distanceA, 0 ) ); mEmit( r0, Vec2f( distanceA, 1 ) ); mEmit( l1, Vec2f( distanceB, 0 ) );
+		mEmit( l1, Vec2f( distanceB, 0 ) ); mEmit( r0, Vec2f( distanceA, 1 ) ); mEmit( r1, Vec2f( distanceB, 1 ) );
+	}
+
+	int		calcArcSegments( float angle ) const
+	{
+		if( mMaxArcStep <= 0 )
+			return MAX_ARC_SEGMENTS;
+		return std::min( std::max( (int)math<float>::ceil( angle / mMaxArcStep ), 1 ), MAX_ARC_SEGMENTS );
+	}
+
+	// Fans \a numSegments triangles around \a center, rotating \a from by \a angle to \a to, counter-clockwise when \a ccw. Texture coordinates
+	// follow the frame of \a dir unless \a rimTexCoord is given, which is then used for every vertex on the rim.
+	void	fan( const Vec2f &center, const Vec2f &from, const Vec2f &to, float angle, bool ccw, int numSegments, const Vec2f &dir, float distance, const Vec2f *rimTexCoord )
+	{
+		const float step = ( ccw ? angle : -angle ) / numSegments;
+		const float c = math<float>::cos( step ), s = math<float>::sin( step );
+		const Vec2f centerTexCoord = rimTexCoord ? Vec2f( distance, 0.5f ) : texCoordOf( Vec2f::zero(), dir, distance );
+		Vec2f prev = from;
+		for( int i = 0; i < numSegments; ++i ) {
+			// the last step lands exactly on \a to, so that the fan meets the geometry beside it without a crack
+			const Vec2f next = ( i == numSegments - 1 ) ? to : Vec2f( prev.x * c - prev.y * s, prev.x * s + prev.y * c );
+			const Vec2f &first = ccw ? prev : next;
+			const Vec2f &second = ccw ? next : prev;
+			mEmit( center, centerTexCoord );
+			mEmit( center + first, rimTexCoord ? *rimTexCoord : texCoordOf( first, dir, distance ) );
+			mEmit( center + second, rimTexCoord ? *rimTexCoord : texCoordOf( second, dir, distance ) );
+			prev = next;
+		}
+	}
+
+	// Fills the outer side of the turn at \a p from \a dir0 to \a dir1; the inner side is covered by the overlapping segments
+	void	join( const Vec2f &p, const Vec2f &dir0, const Vec2f &dir1, float distance )
+	{
+		const float cross = dir0.x * dir1.y - dir0.y * dir1.x;
+		const float dot = dir0.dot( dir1 );
+		if( cross == 0 && dot > 0 )
+			return;
+
+		// turning left the outer side is on the right, and the outer edge sweeps counter-clockwise
+		const bool ccw = cross > 0;
+		const float outer = ccw ? -mHalfWidth : mHalfWidth;
+		const Vec2f o0 = leftOf( dir0 ) * outer, o1 = leftOf( dir1 ) * outer;
+		const Vec2f rimTexCoord( distance, ccw ? 1.0f : 0.0f );
+		const Vec2f centerTexCoord( distance, 0.5f );
+
+		if( mStroke.getJoin() == Stroke::JOIN_ROUND ) {
+			const float angle = math<float>::atan2( math<float>::abs( cross ), dot );
+			fan( p, o0, o1, angle, ccw, calcArcSegments( angle ), dir0, distance, &rimTexCoord );
+			return;
+		}
+
+		const Vec2f &first = ccw ? o0 : o1;
+		const Vec2f &second = ccw ? o1 : o0;
+		if( mStroke.getJoin() == Stroke::JOIN_MITER ) {
+			// the miter's tip lies along the bisector of the two offsets, at half the width over the cosine of half the turn
+			const Vec2f bisector = o0 + o1;
+			const float bisectorLength = bisector.length();
+			const float cosHalfTurn = bisectorLength / ( 2 * mHalfWidth );
+			if( cosHalfTurn > 0 && 1 <= mStroke.getMiterLimit() * cosHalfTurn ) {
+				const Vec2f tip = p + bisector * ( mHalfWidth / ( cosHalfTurn * bisectorLength ) );
+				mEmit( p, centerTexCoord ); mEmit( p + first, rimTexCoord ); mEmit( tip, rimTexCoord );
+				mEmit( p, centerTexCoord ); mEmit( tip, rimTexCoord ); mEmit( p + second, rimTexCoord );
+				return;
+			}
+		}
+
+		mEmit( p, centerTexCoord ); mEmit( p + first, rimTexCoord ); mEmit( p + second, rimTexCoord );
+	}
+
+	// Caps the line at \a p, where it leaves in \a dir when \a start and arrives in \a dir otherwise
+	void	cap( const Vec2f &p, const Vec2f &dir, float distance, bool start )
+	{
+		switch( mStroke.getCap() ) {
+			case Stroke::CAP_SQUARE:
+				if( start )
+					quad( p - dir * mHalfWidth, p, dir, distance - mHalfWidth, distance );
+				else
+					quad( p, p + dir * mHalfWidth, dir, distance, distance + mHalfWidth );
+			break;
+			case Stroke::CAP_ROUND:
+				// a half circle from the left side to the right, around the back of the start or the front of the end
+				fan( p, leftOf( dir ) * mHalfWidth, leftOf( dir ) * -mHalfWidth, (float)M_PI, start, calcArcSegments( (float)M_PI ), dir, distance, NULL );
+			break;
+			default:
+			break;
+		}
+	}
+
+	const Stroke	&mStroke;
+	EmitT			&mEmit;
+	float			mHalfWidth, mMaxArcStep;
+};
+
+template<typename EmitT>
+void generateStroke( const Stroke &stroke, const PolyLine2f &polyLine, EmitT &emit )
+{
+	StrokeGenerator<EmitT> generator( stroke, emit );
+	generator( polyLine );
+}
+
+} // anonymous namespace
+
+size_t Stroke::calcNumVertices( const PolyLine2f &polyLine ) const
+{
+	VertexCounter counter;
+	generateStroke( *this, polyLine, counter );
+	return counter.mCount;
+}
+
+size_t Stroke::generate( const PolyLine2f &polyLine, Vec3f *positions, size_t positionStride, Vec2f *texCoords, size_t texCoordStride ) const
+{
+	StridedWriter writer( positions, positionStride, texCoords, texCoordStride );
+	generateStroke( *this, polyLine, writer );
+	return writer.mCount;
+}
+
+void Stroke::generate( const PolyLine2f &polyLine, std::vector<Vec3f> *positions, std::vector<Vec2f> *texCoords ) const
+{
+	const size_t numVertices = calcNumVertices( polyLine );
+	positions->reserve( positions->size() + numVertices );
+	if( texCoords )
+		texCoords->reserve( texCoords->size() + numVertices );
+
+	VectorWriter writer( positions, texCoords );
+	generateStroke( *this, polyLine, writer );
+}
+
+} // namespace cinder
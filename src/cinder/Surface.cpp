@@ -37,9 +37,13 @@ using namespace Concurrency;
 #endif
 
 #include "cinder/ImageIo.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
 #include "cinder/ip/Fill.h"
 
 #include <boost/preprocessor/seq.hpp>
+#include <boost/preprocessor/tuple/elem.hpp>
 #include <boost/type_traits/is_same.hpp>
 using boost::tribool;
 
@@ -189,14 +193,283 @@ int	SurfaceChannelOrder::getImageIoChannelOrder() const
 
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copy and conversion kernels
+namespace {
+
+// copies of at least this many destination bytes are split into bands of rows across the TaskPool
+const size_t PARALLEL_COPY_MIN_BYTES = 1 << 20;
+
+template<typename FN>
+void forEachRowBand( int32_t height, size_t rowCopyBytes, const FN &fn )
+{
+	if( ( height > 1 ) && ( rowCopyBytes * height >= PARALLEL_COPY_MIN_BYTES ) )
+		TaskPool::get()->parallelFor( 0, height, [&]( size_t first, size_t last ) { fn( (int32_t)first, (int32_t)last ); } );
+	else
+		fn( 0, height );
+}
+
+// For each channel of a destination pixel, the offset of the source channel it is copied from, or -1 to fill it with full alpha.
+struct SwizzleMap {
+	SwizzleMap( const SurfaceChannelOrder &srcOrder, const SurfaceChannelOrder &dstOrder )
+	{
+		mSrc[0] = mSrc[1] = mSrc[2] = mSrc[3] = -1;
+		mSrc[dstOrder.getRedOffset()] = srcOrder.getRedOffset();
+		mSrc[dstOrder.getGreenOffset()] = srcOrder.getGreenOffset();
+		mSrc[dstOrder.getBlueOffset()] = srcOrder.getBlueOffset();
+		if( dstOrder.hasAlpha() && srcOrder.hasAlpha() )
+			mSrc[dstOrder.getAlphaOffset()] = srcOrder.getAlphaOffset();
+	}
+
+	int8_t	mSrc[4];
+};
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+// Permutes the bytes of the four pixels held in the 32-bit lanes of a register. SSE2 has no byte shuffle, so each channel is shifted into place and masked.
+class SwizzleSse2 {
+  public:
+	SwizzleSse2( const SwizzleMap &map )
+	{
+		mFill = _mm_setzero_si128();
+		for( int c = 0; c < 4; ++c ) {
+			const bool fill = map.mSrc[c] < 0;
+			mSrcShift[c] = _mm_cvtsi32_si128( fill ? 0 : map.mSrc[c] * 8 );
+			mDstShift[c] = _mm_cvtsi32_si128( c * 8 );
+			mMask[c] = _mm_set1_epi32( fill ? 0 : 0xFF );
+			if( fill )
+				mFill = _mm_or_si128( mFill, _mm_set1_epi32( (int)( 0xFFu << ( c * 8 ) ) ) );
+		}
+	}
+
+	__m128i operator()( __m128i px ) const
+	{
+		__m128i result = mFill;
+		for( int c = 0; c < 4; ++c )
+			result = _mm_or_si128( result, _mm_sll_epi32( _mm_and_si128( _mm_srl_epi32( px, mSrcShift[c] ), mMask[c] ), mDstShift[c] ) );
+		return result;
+	}
+
+  private:
+	__m128i		mSrcShift[4], mDstShift[4], mMask[4], mFill;
+};
+
+int32_t swizzleRowSse2( const uint8_t *src, uint8_t srcInc, uint8_t *dst, uint8_t dstInc, const SwizzleMap &map, int32_t width )
+{
+	const SwizzleSse2 swizzle( map );
+	int32_t x = 0;
+	if( srcInc == 4 && dstInc == 4 ) {
+		for( ; x + 4 <= width; x += 4, src += 16, dst += 16 )
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), swizzle( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ) ) );
+	}
+	else if( srcInc == 3 && dstInc == 4 ) {
+		// spread four 3-byte pixels into 32-bit lanes; the 16-byte load reads 4 bytes past the pixels, so stay clear of the row's end
+		for( ; x + 6 <= width; x += 4, src += 12, dst += 16 ) {
+			__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+			__m128i px01 = _mm_unpacklo_epi32( v, _mm_srli_si128( v, 3 ) );
+			__m128i px23 = _mm_unpacklo_epi32( _mm_srli_si128( v, 6 ), _mm_srli_si128( v, 9 ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), swizzle( _mm_unpacklo_epi64( px01, px23 ) ) );
+		}
+	}
+	return x;
+}
+
+int32_t convertRowSse2( const uint8_t *src, float *dst, int32_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		__m128i lo = _mm_unpacklo_epi8( v, zero );
+		__m128i hi = _mm_unpackhi_epi8( v, zero );
+		// divide rather than multiply by the reciprocal so results match CHANTRAIT<float>::convert() exactly
+		_mm_storeu_ps( dst + i, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 4, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 8, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 12, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale ) );
+	}
+	return i;
+}
+
+inline __m128i convert4Sse2( const float *src )
+{
+	__m128 v = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src ), _mm_setzero_ps() ), _mm_set1_ps( 1.0f ) );
+	return _mm_cvttps_epi32( _mm_mul_ps( v, _mm_set1_ps( 255.0f ) ) );
+}
+
+int32_t convertRowSse2( const float *src, uint8_t *dst, int32_t count )
+{
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		__m128i lo = _mm_packs_epi32( convert4Sse2( src + i ), convert4Sse2( src + i + 4 ) );
+		__m128i hi = _mm_packs_epi32( convert4Sse2( src + i + 8 ), convert4Sse2( src + i + 12 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( lo, hi ) );
+	}
+	return i;
+}
+
+#elif defined( CINDER_NEON )
+
+template<typename V>
+inline uint8x16_t swizzleChannelNeon( const V &in, int8_t src )
+{
+	return ( src < 0 ) ? vdupq_n_u8( 255 ) : in.val[src];
+}
+
+int32_t swizzleRowNeon( const uint8_t *src, uint8_t srcInc, uint8_t *dst, uint8_t dstInc, const SwizzleMap &map, int32_t width )
+{
+	int32_t x = 0;
+	for( ; x + 16 <= width; x += 16, src += 16 * srcInc, dst += 16 * dstInc ) {
+		if( srcInc == 4 && dstInc == 4 ) {
+			uint8x16x4_t in = vld4q_u8( src ), out;
+			for( int c = 0; c < 4; ++c )
+				out.val[c] = swizzleChannelNeon( in, map.mSrc[c] );
+			vst4q_u8( dst, out );
+		}
+		else if( srcInc == 3 && dstInc == 4 ) {
+			uint8x16x3_t in = vld3q_u8( src );
+			uint8x16x4_t out;
+			for( int c = 0; c < 4; ++c )
+				out.val[c] = swizzleChannelNeon( in, map.mSrc[c] );
+			vst4q_u8( dst, out );
+		}
+		else if( srcInc == 4 && dstInc == 3 ) {
+			uint8x16x4_t in = vld4q_u8( src );
+			uint8x16x3_t out;
+			for( int c = 0; c < 3; ++c )
+				out.val[c] = swizzleChannelNeon( in, map.mSrc[c] );
+			vst3q_u8( dst, out );
+		}
+		else {
+			uint8x16x3_t in = vld3q_u8( src ), out;
+			for( int c = 0; c < 3; ++c )
+				out.val[c] = swizzleChannelNeon( in, map.mSrc[c] );
+			vst3q_u8( dst, out );
+		}
+	}
+	return x;
+}
+
+// multiplies by the reciprocal, as NEON has no divide, so results may differ from CHANTRAIT<float>::convert() by an ulp
+int32_t convertRowNeon( const uint8_t *src, float *dst, int32_t count )
+{
+	const float32x4_t scale = vdupq_n_f32( 1.0f / 255.0f );
+	int32_t i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		uint16x8_t v = vmovl_u8( vld1_u8( src + i ) );
+		vst1q_f32( dst + i, vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_low_u16( v ) ) ), scale ) );
+		vst1q_f32( dst + i + 4, vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_high_u16( v ) ) ), scale ) );
+	}
+	return i;
+}
+
+inline uint16x4_t convert4Neon( const float *src )
+{
+	float32x4_t v = vminq_f32( vmaxq_f32( vld1q_f32( src ), vdupq_n_f32( 0 ) ), vdupq_n_f32( 1.0f ) );
+	return vmovn_u32( vcvtq_u32_f32( vmulq_f32( v, vdupq_n_f32( 255.0f ) ) ) );
+}
+
+int32_t convertRowNeon( const float *src, uint8_t *dst, int32_t count )
+{
+	int32_t i = 0;
+	for( ; i + 8 <= count; i += 8 )
+		vst1_u8( dst + i, vmovn_u16( vcombine_u16( convert4Neon( src + i ), convert4Neon( src + i + 4 ) ) ) );
+	return i;
+}
+#endif
+
+// Swizzles as many pixels of an 8-bit row as the SIMD kernels can handle, returning the count; the caller finishes the rest.
+int32_t swizzleRowSimd( const uint8_t *src, uint8_t srcInc, uint8_t *dst, uint8_t dstInc, const SwizzleMap &map, int32_t width )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return swizzleRowSse2( src, srcInc, dst, dstInc, map, width );
+#elif defined( CINDER_NEON )
+	return swizzleRowNeon( src, srcInc, dst, dstInc, map, width );
+#endif
+	return 0;
+}
+
+template<typename T>
+int32_t swizzleRowSimd( const T *src, uint8_t srcInc, T *dst, uint8_t dstInc, const SwizzleMap &map, int32_t width )
+{
+	return 0;
+}
+
+template<typename T, typename Y>
+inline T convertChannel( Y v )
+{
+	return CHANTRAIT<T>::convert( v );
+}
+
+template<>
+inline uint8_t convertChannel<uint8_t,float>( float v )
+{
+	return CHANTRAIT<uint8_t>::convert( constrain( v, 0.0f, 1.0f ) );
+}
+
+template<>
+inline uint16_t convertChannel<uint16_t,float>( float v )
+{
+	return CHANTRAIT<uint16_t>::convert( constrain( v, 0.0f, 1.0f ) );
+}
+
+template<typename T, typename Y>
+int32_t convertRowSimd( const Y *src, T *dst, int32_t count )
+{
+	return 0;
+}
+
+#if defined( CINDER_SSE2 ) || defined( CINDER_NEON )
+template<>
+int32_t convertRowSimd<float,uint8_t>( const uint8_t *src, float *dst, int32_t count )
+{
+#if defined( CINDER_SSE2 )
+	return useSse2() ? convertRowSse2( src, dst, count ) : 0;
+#else
+	return convertRowNeon( src, dst, count );
+#endif
+}
+
+template<>
+int32_t convertRowSimd<uint8_t,float>( const float *src, uint8_t *dst, int32_t count )
+{
+#if defined( CINDER_SSE2 )
+	return useSse2() ? convertRowSse2( src, dst, count ) : 0;
+#else
+	return convertRowNeon( src, dst, count );
+#endif
+}
+#endif
+
+// converts \a count consecutive values, which suffices when source and destination share a channel order
+template<typename T, typename Y>
+void convertRow( const Y *src, T *dst, int32_t count )
+{
+	for( int32_t i = convertRowSimd( src, dst, count ); i < count; ++i )
+		dst[i] = convertChannel<T>( src[i] );
+}
+
+} // anonymous namespace
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // SurfaceT::Obj
 template<typename T>
 SurfaceT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, T *aData, bool aOwnsData, int32_t aRowBytes )
-	: mWidth( aWidth ), mHeight( aHeight ), mChannelOrder( aChannelOrder ), mData( aData ), mOwnsData( aOwnsData ), mRowBytes( aRowBytes ), mIsPremultiplied( false )
+	: mWidth( aWidth ), mHeight( aHeight ), mChannelOrder( aChannelOrder ), mData( aData ), mOwnsData( aOwnsData ), mRowBytes( aRowBytes ), mIsPremultiplied( false ),
+	mAllocation( "Surface" )
 {
 	mDeallocatorFunc = NULL;
 	initChannels();
+	// owned data is always allocated as mHeight * mRowBytes elements of T
+	if( mOwnsData )
+		mAllocation.set( (int64_t)mHeight * mRowBytes * sizeof(T) );
 }
 
 template<typename T>
@@ -262,6 +535,16 @@ SurfaceT<T>::SurfaceT( T *aData, int32_t aWidth, int32_t aHeight, int32_t aRowBy
 	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, aChannelOrder, aData, false, aRowBytes ) );
 }
 
+template<typename T>
+SurfaceT<T>::SurfaceT( const SurfaceT &parent, const Area &area )
+{
+	Area clipped( area.getClipBy( parent.getBounds() ) );
+	T *data = const_cast<T*>( parent.getData( clipped.getUL() ) );
+	mObj = std::shared_ptr<Obj>( new Obj( clipped.getWidth(), clipped.getHeight(), parent.getChannelOrder(), data, false, parent.getRowBytes() ) );
+	mObj->mIsPremultiplied = parent.isPremultiplied();
+	mObj->mParent = parent.mObj;
+}
+
 template<typename T>
 SurfaceT<T>::SurfaceT( ImageSourceRef imageSource, const SurfaceConstraints &constraints, boost::tribool alpha )
 {
@@ -303,6 +586,19 @@ void SurfaceT<T>::loadImageAsync(const fs::path path, SurfaceT &surface, const S
 
 
 
+template<typename T>
+template<typename Y>
+SurfaceT<T>::SurfaceT( const SurfaceT<Y> &rhs, const SurfaceConstraints &constraints )
+{
+	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( rhs.hasAlpha() );
+	int32_t rowBytes = constraints.getRowBytes( rhs.getWidth(), channelOrder, sizeof(T) );
+	T *data = new T[rhs.getHeight() * rowBytes];
+	mObj = std::shared_ptr<Obj>( new Obj( rhs.getWidth(), rhs.getHeight(), channelOrder, data, true, rowBytes ) );
+	mObj->mIsPremultiplied = rhs.isPremultiplied();
+
+	copyFrom( rhs, rhs.getBounds() );
+}
+
 template<typename T>
 SurfaceT<T>::operator ImageSourceRef() const
 {
@@ -392,6 +688,39 @@ void SurfaceT<T>::copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea,
 		copyRawRgb( srcSurface, srcDst.first, srcDst.second );
 }
 
+template<typename T>
+template<typename Y>
+void SurfaceT<T>::copyFrom( const SurfaceT<Y> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset )
+{
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcSurface.getBounds(), srcArea, getBounds(), srcArea.getUL() + relativeOffset );
+	const Area &area = srcDst.first;
+	const Vec2i &absoluteOffset = srcDst.second;
+
+	const bool sameChannelOrder = getChannelOrder() == srcSurface.getChannelOrder();
+	const uint8_t srcPixelInc = srcSurface.getPixelInc();
+	const uint8_t dstPixelInc = getPixelInc();
+	const SwizzleMap map( srcSurface.getChannelOrder(), getChannelOrder() );
+	const T fullAlpha = CHANTRAIT<T>::max();
+	const int32_t width = area.getWidth();
+
+	forEachRowBand( area.getHeight(), width * dstPixelInc * sizeof(T), [&]( int32_t first, int32_t last ) {
+		for( int32_t y = first; y < last; ++y ) {
+			const Y *src = srcSurface.getData( Vec2i( area.x1, area.y1 + y ) );
+			T *dst = getData( absoluteOffset + Vec2i( 0, y ) );
+			if( sameChannelOrder ) {
+				convertRow( src, dst, width * dstPixelInc );
+				continue;
+			}
+			for( int32_t x = 0; x < width; ++x ) {
+				for( uint8_t c = 0; c < dstPixelInc; ++c )
+					dst[c] = ( map.mSrc[c] < 0 ) ? fullAlpha : convertChannel<T>( src[map.mSrc[c]] );
+				src += srcPixelInc;
+				dst += dstPixelInc;
+			}
+		}
+	} );
+}
+
 template<typename T>
 void SurfaceT<T>::copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset )
 {
@@ -399,11 +728,13 @@ void SurfaceT<T>::copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const
 	int32_t srcPixelInc = srcSurface.getPixelInc();
 	int32_t dstPixelInc = getPixelInc();
 	size_t copyBytes = srcArea.getWidth() * srcPixelInc * sizeof(T);
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *srcPtr = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		memcpy( dstPtr, srcPtr, copyBytes );
-	}
+	forEachRowBand( srcArea.getHeight(), copyBytes, [&]( int32_t first, int32_t last ) {
+		for( int32_t y = first; y < last; ++y ) {
+			const T *srcPtr = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
+			T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
+			memcpy( dstPtr, srcPtr, copyBytes );
+		}
+	} );
 }
 
 template<typename T>
@@ -421,19 +752,25 @@ void SurfaceT<T>::copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcAre
 	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
 	
 	int32_t width = srcArea.getWidth();
+	const SwizzleMap map( srcSurface.getChannelOrder(), getChannelOrder() );
 	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			dst[dstAlpha] = src[srcAlpha];
-			src += 4;
-			dst += 4;
+	forEachRowBand( srcArea.getHeight(), width * 4 * sizeof(T), [&]( int32_t first, int32_t last ) {
+		for( int32_t y = first; y < last; ++y ) {
+			const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
+			T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
+			int32_t x = swizzleRowSimd( src, 4, dst, 4, map, width );
+			src += x * 4;
+			dst += x * 4;
+			for( ; x < width; ++x ) {
+				dst[dstRed] = src[srcRed];
+				dst[dstGreen] = src[srcGreen];
+				dst[dstBlue] = src[srcBlue];
+				dst[dstAlpha] = src[srcAlpha];
+				src += 4;
+				dst += 4;
+			}
 		}
-	}
+	} );
 }
 
 template<typename T>
@@ -452,19 +789,25 @@ void SurfaceT<T>::copyRawRgbFullAlpha( const SurfaceT<T> &srcSurface, const Area
 	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
 	
 	int32_t width = srcArea.getWidth();
+	const SwizzleMap map( srcSurface.getChannelOrder(), getChannelOrder() );
 	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			dst[dstAlpha] = fullAlpha;
-			src += srcPixelInc;
-			dst += 4;
+	forEachRowBand( srcArea.getHeight(), width * 4 * sizeof(T), [&]( int32_t first, int32_t last ) {
+		for( int32_t y = first; y < last; ++y ) {
+			const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
+			T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
+			int32_t x = swizzleRowSimd( src, srcPixelInc, dst, 4, map, width );
+			src += x * srcPixelInc;
+			dst += x * 4;
+			for( ; x < width; ++x ) {
+				dst[dstRed] = src[srcRed];
+				dst[dstGreen] = src[srcGreen];
+				dst[dstBlue] = src[srcBlue];
+				dst[dstAlpha] = fullAlpha;
+				src += srcPixelInc;
+				dst += 4;
+			}
 		}
-	}
+	} );
 }
 
 template<typename T>
@@ -482,18 +825,25 @@ void SurfaceT<T>::copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea
 	const uint8_t dstBlue = getChannelOrder().getBlueOffset();
 	
 	int32_t width = srcArea.getWidth();
+	const SwizzleMap map( srcSurface.getChannelOrder(), getChannelOrder() );
 	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			src += srcPixelInc;
-			dst += dstPixelInc;
+	forEachRowBand( srcArea.getHeight(), width * dstPixelInc * sizeof(T), [&]( int32_t first, int32_t last ) {
+		for( int32_t y = first; y < last; ++y ) {
+			const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
+			T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
+			// the SIMD kernels fill a destination padding channel (as in XRGB) with full alpha rather than leaving it untouched
+			int32_t x = swizzleRowSimd( src, srcPixelInc, dst, dstPixelInc, map, width );
+			src += x * srcPixelInc;
+			dst += x * dstPixelInc;
+			for( ; x < width; ++x ) {
+				dst[dstRed] = src[srcRed];
+				dst[dstGreen] = src[srcGreen];
+				dst[dstBlue] = src[srcBlue];
+				src += srcPixelInc;
+				dst += dstPixelInc;
+			}
 		}
-	}
+	} );
 }
 
 template<typename T>
@@ -595,4 +945,10 @@ void* ImageTargetSurface<T>::getRowPointer( int32_t row )
 
 BOOST_PP_SEQ_FOR_EACH( Surface_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
+#define Surface_CONVERSION_PROTOTYPES(r,data,TY)\
+	template SurfaceT<BOOST_PP_TUPLE_ELEM(2,0,TY)>::SurfaceT( const SurfaceT<BOOST_PP_TUPLE_ELEM(2,1,TY)> &rhs, const SurfaceConstraints &constraints );\
+	template void SurfaceT<BOOST_PP_TUPLE_ELEM(2,0,TY)>::copyFrom<BOOST_PP_TUPLE_ELEM(2,1,TY)>( const SurfaceT<BOOST_PP_TUPLE_ELEM(2,1,TY)> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset );
+
+BOOST_PP_SEQ_FOR_EACH( Surface_CONVERSION_PROTOTYPES, ~, ((uint8_t,uint16_t))((uint8_t,float))((uint16_t,uint8_t))((uint16_t,float))((float,uint8_t))((float,uint16_t)) )
+
 } // namespace cinder
\ No newline at end of file
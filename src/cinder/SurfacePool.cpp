@@ -0,0 +1,163 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/SurfacePool.h"
+
+using namespace std;
+
+namespace cinder {
+
+template<typename T>
+bool SurfacePoolT<T>::Key::operator<( const Key &rhs ) const
+{
+	if( mWidth != rhs.mWidth )
+		return mWidth < rhs.mWidth;
+	else if( mHeight != rhs.mHeight )
+		return mHeight < rhs.mHeight;
+	else if( mCode != rhs.mCode )
+		return mCode < rhs.mCode;
+	else
+		return mRowBytes < rhs.mRowBytes;
+}
+
+template<typename T>
+SurfacePoolT<T>::Obj::~Obj()
+{
+	for( typename map<Key,vector<T*> >::iterator formatIt = mFree.begin(); formatIt != mFree.end(); ++formatIt )
+		for( typename vector<T*>::iterator dataIt = formatIt->second.begin(); dataIt != formatIt->second.end(); ++dataIt )
+			delete [] *dataIt;
+}
+
+// assumes mMutex is held
+template<typename T>
+void SurfacePoolT<T>::Obj::trim()
+{
+	for( typename map<Key,vector<T*> >::iterator formatIt = mFree.begin(); formatIt != mFree.end(); ++formatIt ) {
+		while( formatIt->second.size() > mMaxFreePerFormat ) {
+			delete [] formatIt->second.back();
+			formatIt->second.pop_back();
+		}
+	}
+}
+
+template<typename T>
+SurfacePoolT<T>::SurfacePoolT( size_t maxFreePerFormat )
+	: mObj( new Obj( maxFreePerFormat ) )
+{
+}
+
+template<typename T>
+SurfaceT<T> SurfacePoolT<T>::getSurface( int32_t width, int32_t height, bool alpha, SurfaceChannelOrder channelOrder )
+{
+	if( channelOrder == SurfaceChannelOrder::UNSPECIFIED )
+		channelOrder = ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB;
+	return getSurface( width, height, channelOrder, width * sizeof(T) * channelOrder.getPixelInc() );
+}
+
+template<typename T>
+SurfaceT<T> SurfacePoolT<T>::getSurface( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints )
+{
+	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( alpha );
+	return getSurface( width, height, channelOrder, constraints.getRowBytes( width, channelOrder, sizeof(T) ) );
+}
+
+template<typename T>
+SurfaceT<T> SurfacePoolT<T>::getSurface( int32_t width, int32_t height, const SurfaceChannelOrder &channelOrder, int32_t rowBytes )
+{
+	if( ! mObj )
+		return SurfaceT<T>( width, height, channelOrder.hasAlpha(), channelOrder );
+
+	Refcon *refcon = new Refcon( mObj, Key( width, height, channelOrder.getCode(), rowBytes ) );
+	{
+		lock_guard<mutex> lock( mObj->mMutex );
+		typename map<Key,vector<T*> >::iterator formatIt = mObj->mFree.find( refcon->mKey );
+		if( formatIt != mObj->mFree.end() && ( ! formatIt->second.empty() ) ) {
+			refcon->mData = formatIt->second.back();
+			formatIt->second.pop_back();
+		}
+	}
+
+	// same allocation size as SurfaceT's own constructors
+	if( ! refcon->mData )
+		refcon->mData = new T[height * rowBytes];
+
+	SurfaceT<T> result( refcon->mData, width, height, rowBytes, channelOrder );
+	result.setDeallocator( surfaceDeallocator, refcon );
+	return result;
+}
+
+template<typename T>
+void SurfacePoolT<T>::surfaceDeallocator( void *refcon )
+{
+	Refcon *info = reinterpret_cast<Refcon*>( refcon );
+	{
+		lock_guard<mutex> lock( info->mPool->mMutex );
+		vector<T*> &freeList = info->mPool->mFree[info->mKey];
+		if( freeList.size() < info->mPool->mMaxFreePerFormat )
+			freeList.push_back( info->mData );
+		else
+			delete [] info->mData;
+	}
+	delete info;
+}
+
+template<typename T>
+size_t SurfacePoolT<T>::getNumFree() const
+{
+	lock_guard<mutex> lock( mObj->mMutex );
+	size_t result = 0;
+	for( typename map<Key,vector<T*> >::const_iterator formatIt = mObj->mFree.begin(); formatIt != mObj->mFree.end(); ++formatIt )
+		result += formatIt->second.size();
+	return result;
+}
+
+template<typename T>
+size_t SurfacePoolT<T>::getMaxFreePerFormat() const
+{
+	lock_guard<mutex> lock( mObj->mMutex );
+	return mObj->mMaxFreePerFormat;
+}
+
+template<typename T>
+void SurfacePoolT<T>::setMaxFreePerFormat( size_t maxFreePerFormat )
+{
+	lock_guard<mutex> lock( mObj->mMutex );
+	mObj->mMaxFreePerFormat = maxFreePerFormat;
+	mObj->trim();
+}
+
+template<typename T>
+void SurfacePoolT<T>::clear()
+{
+	lock_guard<mutex> lock( mObj->mMutex );
+	size_t maxFree = mObj->mMaxFreePerFormat;
+	mObj->mMaxFreePerFormat = 0;
+	mObj->trim();
+	mObj->mMaxFreePerFormat = maxFree;
+}
+
+template class SurfacePoolT<uint8_t>;
+template class SurfacePoolT<uint16_t>;
+template class SurfacePoolT<float>;
+
+} // namespace cinder
@@ -41,6 +41,10 @@
 	#import <net/if_dl.h>
 	#include <sys/sysctl.h>
 	#include <cxxabi.h>
+	#include <pthread.h>
+	#include <mach/mach.h>
+	#include <mach/mach_time.h>
+	#include <mach/thread_policy.h>
 		#if defined( CINDER_MAC )
 		#include <CoreServices/CoreServices.h>
 	#endif
@@ -48,6 +52,9 @@
 	#include <windows.h>
 	#include <windowsx.h>
 	#include <iphlpapi.h>
+	#include <intrin.h>
+	#include <avrt.h>
+	#include "cinder/msw/CinderMsw.h"
 	#pragma comment(lib, "IPHLPAPI.lib")
 	namespace cinder {
 		void cpuidwrap( int *p, unsigned int param );
@@ -63,6 +70,7 @@
 	using namespace cinder::winrt;
 #endif
 
+#include <algorithm>
 #include <string>
 using namespace std;
 
@@ -340,6 +348,29 @@ bool System::hasSse4_2()
 	return instance()->mHasSSE4_2;
 }
 
+bool System::hasAvx()
+{
+	if( ! instance()->mCachedValues[HAS_AVX] ) {
+#if defined( CINDER_COCOA_TOUCH )
+		instance()->mHasAvx = false;
+#elif defined( CINDER_COCOA )
+		instance()->mHasAvx = ( getSysCtlValue<int>( "hw.optional.avx1_0" ) == 1 );
+#elif defined( CINDER_MSW )
+		// AVX is only usable when the OS saves the ymm registers as well (OSXSAVE + XCR0 bits 1 and 2)
+		int info[4];
+		__cpuid( info, 1 );
+		bool hasOsxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+		bool hasAvxInstructions = ( info[2] & ( 1 << 28 ) ) != 0;
+		instance()->mHasAvx = hasOsxsave && hasAvxInstructions && ( _xgetbv( 0 ) & 0x6 ) == 0x6;
+#else
+		instance()->mHasAvx = false;
+#endif
+		instance()->mCachedValues[HAS_AVX] = true;
+	}
+
+	return instance()->mHasAvx;
+}
+
 bool System::hasArm()
 {
 	if( ! instance()->mCachedValues[HAS_ARM] ) {
@@ -450,6 +481,209 @@ int System::getNumCores()
 	return instance()->mLogicalCPUs;
 }
 
+const std::vector<std::vector<int> >& System::getCoreTopology()
+{
+	if( ! instance()->mCachedValues[CORE_TOPOLOGY] ) {
+		std::vector<std::vector<int> > &topology = instance()->mCoreTopology;
+#if defined( CINDER_MSW )
+		DWORD length = 0;
+		::GetLogicalProcessorInformation( NULL, &length );
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info( length / sizeof( SYSTEM_LOGICAL_PROCESSOR_INFORMATION ) );
+		if( ! info.empty() && ::GetLogicalProcessorInformation( &info[0], &length ) ) {
+			for( size_t i = 0; i < info.size(); ++i ) {
+				if( info[i].Relationship != ::RelationProcessorCore )
+					continue;
+				std::vector<int> core;
+				for( int bit = 0; bit < (int)sizeof( ULONG_PTR ) * 8; ++bit )
+					if( info[i].ProcessorMask & ( ULONG_PTR( 1 ) << bit ) )
+						core.push_back( bit );
+				topology.push_back( core );
+			}
+		}
+#endif
+		// without a mapping, siblings are assumed to be numbered consecutively, which is how OS X numbers them
+		if( topology.empty() ) {
+			const int numLogical = std::max( getNumCores(), 1 );
+#if defined( CINDER_COCOA )
+			const int numPhysical = std::max( std::min( getSysCtlValue<int>( "hw.physicalcpu" ), numLogical ), 1 );
+#else
+			const int numPhysical = numLogical;
+#endif
+			topology.resize( numPhysical );
+			for( int i = 0; i < numLogical; ++i )
+				topology[i * numPhysical / numLogical].push_back( i );
+		}
+		instance()->mCachedValues[CORE_TOPOLOGY] = true;
+	}
+
+	return instance()->mCoreTopology;
+}
+
+int System::getNumPhysicalCores()
+{
+	return (int)getCoreTopology().size();
+}
+
+#if defined( CINDER_MSW )
+namespace {
+
+// MMCSS lives in avrt.dll, which is loaded on demand so that XP, which lacks it, is still supported
+typedef ::HANDLE (WINAPI *AvSetMmThreadCharacteristicsFn)( LPCWSTR, LPDWORD );
+typedef BOOL (WINAPI *AvSetMmThreadPriorityFn)( ::HANDLE, ::AVRT_PRIORITY );
+typedef BOOL (WINAPI *AvRevertMmThreadCharacteristicsFn)( ::HANDLE );
+// only present from Windows 10 1607 on
+typedef HRESULT (WINAPI *SetThreadDescriptionFn)( ::HANDLE, PCWSTR );
+
+// the MMCSS registration of each thread, which must be reverted by the same thread
+__declspec(thread) ::HANDLE sMmcssHandle = NULL;
+
+HMODULE getAvrtModule()
+{
+	static HMODULE sAvrtModule = ::LoadLibraryW( L"avrt.dll" );
+	return sAvrtModule;
+}
+
+void revertMmcss()
+{
+	if( ! sMmcssHandle )
+		return;
+
+	AvRevertMmThreadCharacteristicsFn revert = (AvRevertMmThreadCharacteristicsFn)::GetProcAddress( getAvrtModule(), "AvRevertMmThreadCharacteristics" );
+	if( revert )
+		revert( sMmcssHandle );
+	sMmcssHandle = NULL;
+}
+
+#pragma pack( push, 8 )
+struct ThreadNameInfo {
+	DWORD	mType; // must be 0x1000
+	LPCSTR	mName;
+	DWORD	mThreadId; // -1 for the calling thread
+	DWORD	mFlags;
+};
+#pragma pack( pop )
+
+// The exception understood by Visual Studio's debugger as naming a thread. This function can't hold objects with destructors because of __try.
+void raiseThreadNameException( const char *name )
+{
+	ThreadNameInfo info = { 0x1000, name, (DWORD)-1, 0 };
+	__try {
+		::RaiseException( 0x406D1388, 0, sizeof( info ) / sizeof( ULONG_PTR ), (ULONG_PTR*)&info );
+	}
+	__except( EXCEPTION_EXECUTE_HANDLER ) {
+	}
+}
+
+} // anonymous namespace
+#endif // defined( CINDER_MSW )
+
+bool System::setThreadPriority( ThreadPriority priority )
+{
+#if defined( CINDER_COCOA )
+	// revert setThreadRealtime()
+	thread_standard_policy_data_t standardPolicy;
+	::thread_policy_set( ::pthread_mach_thread_np( ::pthread_self() ), THREAD_STANDARD_POLICY, (thread_policy_t)&standardPolicy, THREAD_STANDARD_POLICY_COUNT );
+
+	const int policy = ( priority == PRIORITY_TIME_CRITICAL ) ? SCHED_FIFO : SCHED_OTHER;
+	const int minPriority = ::sched_get_priority_min( policy ), maxPriority = ::sched_get_priority_max( policy );
+	sched_param param;
+	switch( priority ) {
+		case PRIORITY_LOW:		param.sched_priority = minPriority; break;
+		case PRIORITY_NORMAL:	param.sched_priority = ( minPriority + maxPriority ) / 2; break;
+		case PRIORITY_HIGH:		param.sched_priority = minPriority + ( maxPriority - minPriority ) * 3 / 4; break;
+		default:				param.sched_priority = maxPriority; break;
+	}
+	return ::pthread_setschedparam( ::pthread_self(), policy, &param ) == 0;
+#elif defined( CINDER_MSW )
+	revertMmcss();
+
+	int value;
+	switch( priority ) {
+		case PRIORITY_LOW:		value = THREAD_PRIORITY_BELOW_NORMAL; break;
+		case PRIORITY_NORMAL:	value = THREAD_PRIORITY_NORMAL; break;
+		case PRIORITY_HIGH:		value = THREAD_PRIORITY_HIGHEST; break;
+		default:				value = THREAD_PRIORITY_TIME_CRITICAL; break;
+	}
+	return ::SetThreadPriority( ::GetCurrentThread(), value ) != 0;
+#else
+	return false;
+#endif
+}
+
+bool System::setThreadRealtime( double periodSeconds, double computationSeconds, bool critical )
+{
+#if defined( CINDER_COCOA )
+	// the policy is expressed in mach absolute time units
+	mach_timebase_info_data_t timebase;
+	::mach_timebase_info( &timebase );
+	const double unitsPerSecond = 1e9 * timebase.denom / timebase.numer;
+
+	thread_time_constraint_policy_data_t policy;
+	policy.period = uint32_t( periodSeconds * unitsPerSecond );
+	policy.computation = uint32_t( std::min( computationSeconds, periodSeconds ) * unitsPerSecond );
+	policy.constraint = policy.period;
+	policy.preemptible = 1;
+	if( ::thread_policy_set( ::pthread_mach_thread_np( ::pthread_self() ), THREAD_TIME_CONSTRAINT_POLICY, (thread_policy_t)&policy, THREAD_TIME_CONSTRAINT_POLICY_COUNT ) == KERN_SUCCESS )
+		return true;
+#elif defined( CINDER_MSW )
+	// MMCSS schedules by task rather than by period
+	if( ! sMmcssHandle ) {
+		AvSetMmThreadCharacteristicsFn setCharacteristics = (AvSetMmThreadCharacteristicsFn)::GetProcAddress( getAvrtModule(), "AvSetMmThreadCharacteristicsW" );
+		DWORD taskIndex = 0;
+		if( setCharacteristics )
+			sMmcssHandle = setCharacteristics( L"Pro Audio", &taskIndex );
+	}
+	if( sMmcssHandle ) {
+		AvSetMmThreadPriorityFn setPriority = (AvSetMmThreadPriorityFn)::GetProcAddress( getAvrtModule(), "AvSetMmThreadPriority" );
+		if( setPriority )
+			setPriority( sMmcssHandle, critical ? ::AVRT_PRIORITY_CRITICAL : ::AVRT_PRIORITY_NORMAL );
+		return true;
+	}
+#endif
+
+	return setThreadPriority( PRIORITY_TIME_CRITICAL );
+}
+
+bool System::setThreadAffinity( const std::vector<int> &logicalProcessors )
+{
+#if defined( CINDER_COCOA )
+	// OS X only supports affinity tags, which ask for threads sharing a tag to share a cache. Unsupported on iOS, where this fails.
+	thread_affinity_policy_data_t policy;
+	policy.affinity_tag = logicalProcessors.empty() ? THREAD_AFFINITY_TAG_NULL : logicalProcessors.front() + 1;
+	return ::thread_policy_set( ::pthread_mach_thread_np( ::pthread_self() ), THREAD_AFFINITY_POLICY, (thread_policy_t)&policy, THREAD_AFFINITY_POLICY_COUNT ) == KERN_SUCCESS;
+#elif defined( CINDER_MSW )
+	DWORD_PTR mask = 0;
+	if( logicalProcessors.empty() ) {
+		DWORD_PTR systemMask;
+		if( ! ::GetProcessAffinityMask( ::GetCurrentProcess(), &mask, &systemMask ) )
+			return false;
+	}
+	else {
+		for( size_t i = 0; i < logicalProcessors.size(); ++i )
+			if( logicalProcessors[i] >= 0 && logicalProcessors[i] < (int)sizeof( DWORD_PTR ) * 8 )
+				mask |= DWORD_PTR( 1 ) << logicalProcessors[i];
+		if( ! mask )
+			return false;
+	}
+	return ::SetThreadAffinityMask( ::GetCurrentThread(), mask ) != 0;
+#else
+	return false;
+#endif
+}
+
+void System::setThreadName( const std::string &name )
+{
+#if defined( CINDER_COCOA )
+	::pthread_setname_np( name.substr( 0, 63 ).c_str() );
+#elif defined( CINDER_MSW )
+	SetThreadDescriptionFn setDescription = (SetThreadDescriptionFn)::GetProcAddress( ::GetModuleHandleW( L"kernel32.dll" ), "SetThreadDescription" );
+	if( setDescription )
+		setDescription( ::GetCurrentThread(), msw::toWideString( name ).c_str() );
+	if( ::IsDebuggerPresent() )
+		raiseThreadNameException( name.c_str() );
+#endif
+}
+
 int System::getOsMajorVersion()
 {
 	if( ! instance()->mCachedValues[OS_MAJOR] ) {
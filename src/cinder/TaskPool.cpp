@@ -0,0 +1,402 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TaskPool.h"
+#include "cinder/app/App.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Profiler.h"
+#include "cinder/System.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace cinder {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Task
+// ----------------------------------------------------------------------------------------------------
+
+Task::Task( TaskPool *pool, const std::function<void ()> &fn )
+	: mPool( pool ), mFn( fn ), mComplete( false )
+{
+}
+
+void Task::run()
+{
+	try {
+		mFn();
+	}
+	catch( ... ) {
+		mException = current_exception();
+	}
+
+	// release anything captured by the function as soon as possible
+	mFn = nullptr;
+
+	vector<TaskRef> continuations;
+	vector<function<void ()> > mainThreadContinuations;
+	{
+		lock_guard<mutex> lock( mMutex );
+		mComplete = true;
+		continuations.swap( mContinuations );
+		mainThreadContinuations.swap( mMainThreadContinuations );
+	}
+	mCompleteCond.notify_all();
+
+	for( const auto &continuation : continuations )
+		mPool->schedule( continuation );
+
+	for( const auto &fn : mainThreadContinuations )
+		mPool->dispatchToMainThread( fn );
+}
+
+void Task::wait()
+{
+	size_t workerIndex = mPool->getCurrentWorkerIndex();
+	if( workerIndex != TaskPool::INVALID_WORKER ) {
+		// help out with other tasks, so that waiting on a pool thread can't deadlock the pool.
+		while( ! mComplete ) {
+			if( ! mPool->runNextTask( workerIndex ) )
+				this_thread::yield();
+		}
+	}
+	else {
+		unique_lock<mutex> lock( mMutex );
+		while( ! mComplete )
+			mCompleteCond.wait( lock );
+	}
+
+	if( mException )
+		rethrow_exception( mException );
+}
+
+TaskRef Task::then( const std::function<void ()> &fn )
+{
+	TaskRef continuation( new Task( mPool, fn ) );
+	{
+		lock_guard<mutex> lock( mMutex );
+		if( ! mComplete ) {
+			mContinuations.push_back( continuation );
+			return continuation;
+		}
+	}
+
+	mPool->schedule( continuation );
+	return continuation;
+}
+
+void Task::thenOnMainThread( const std::function<void ()> &fn )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		if( ! mComplete ) {
+			mMainThreadContinuations.push_back( fn );
+			return;
+		}
+	}
+
+	mPool->dispatchToMainThread( fn );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - TaskPool
+// ----------------------------------------------------------------------------------------------------
+
+const size_t TaskPool::INVALID_WORKER = numeric_limits<size_t>::max();
+
+// static
+TaskPoolRef TaskPool::create( size_t numThreads )
+{
+	if( numThreads == 0 ) {
+		size_t hardwareThreads = thread::hardware_concurrency();
+		numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	return TaskPoolRef( new TaskPool( numThreads ) );
+}
+
+// static
+TaskPool* TaskPool::get()
+{
+	// The shared pool is intentionally never destroyed: joining threads from static destructors can deadlock on some platforms,
+	// and its threads are idle once the App has shut down.
+	static mutex sMutex;
+	static TaskPoolRef *sPool = nullptr;
+
+	lock_guard<mutex> lock( sMutex );
+	if( ! sPool )
+		sPool = new TaskPoolRef( create() );
+
+	return sPool->get();
+}
+
+TaskPool::TaskPool( size_t numThreads )
+	: mNumQueued( 0 ), mNumSleeping( 0 ), mShouldQuit( false )
+{
+	CI_ASSERT( numThreads > 0 );
+
+	for( size_t i = 0; i < numThreads; i++ )
+		mWorkers.push_back( unique_ptr<Worker>( new Worker ) );
+
+	// mThreadIds is filled before any thread starts looking for tasks (they first wait on mSleepMutex), so that getCurrentWorkerIndex() needs no locking.
+	mThreadIds.resize( numThreads );
+	lock_guard<mutex> lock( mSleepMutex );
+	for( size_t i = 0; i < numThreads; i++ ) {
+		mThreads.push_back( thread( bind( &TaskPool::threadLoop, this, i ) ) );
+		mThreadIds[i] = mThreads.back().get_id();
+	}
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		lock_guard<mutex> lock( mSleepMutex );
+		mShouldQuit = true;
+	}
+	mSleepCond.notify_all();
+
+	for( auto &t : mThreads )
+		t.join();
+}
+
+bool TaskPool::isPoolThread() const
+{
+	return getCurrentWorkerIndex() != INVALID_WORKER;
+}
+
+size_t TaskPool::getCurrentWorkerIndex() const
+{
+	auto threadId = this_thread::get_id();
+	for( size_t i = 0; i < mThreadIds.size(); i++ ) {
+		if( mThreadIds[i] == threadId )
+			return i;
+	}
+
+	return INVALID_WORKER;
+}
+
+TaskRef TaskPool::submit( const std::function<void ()> &fn )
+{
+	TaskRef task( new Task( this, fn ) );
+	schedule( task );
+	return task;
+}
+
+void TaskPool::schedule( const TaskRef &task )
+{
+	size_t workerIndex = getCurrentWorkerIndex();
+	if( workerIndex != INVALID_WORKER ) {
+		Worker *worker = mWorkers[workerIndex].get();
+		lock_guard<mutex> lock( worker->mMutex );
+		worker->mTasks.push_back( task );
+	}
+	else {
+		lock_guard<mutex> lock( mSharedMutex );
+		mSharedTasks.push_back( task );
+	}
+
+	// mNumQueued and mNumSleeping are sequentially consistent, so either a sleeping thread sees the new task or this sees the sleeper.
+	++mNumQueued;
+	if( mNumSleeping > 0 ) {
+		lock_guard<mutex> lock( mSleepMutex );
+		mSleepCond.notify_one();
+	}
+}
+
+TaskRef TaskPool::popTask( size_t workerIndex )
+{
+	TaskRef result;
+
+	// own queue first, newest task (LIFO) for cache locality
+	if( workerIndex != INVALID_WORKER ) {
+		Worker *worker = mWorkers[workerIndex].get();
+		lock_guard<mutex> lock( worker->mMutex );
+		if( ! worker->mTasks.empty() ) {
+			result = worker->mTasks.back();
+			worker->mTasks.pop_back();
+		}
+	}
+
+	// then tasks submitted from outside the pool
+	if( ! result ) {
+		lock_guard<mutex> lock( mSharedMutex );
+		if( ! mSharedTasks.empty() ) {
+			result = mSharedTasks.front();
+			mSharedTasks.pop_front();
+		}
+	}
+
+	// then steal the oldest task from another thread, starting with the next one over to spread out contention
+	if( ! result ) {
+		const size_t numWorkers = mWorkers.size();
+		const size_t start = workerIndex != INVALID_WORKER ? workerIndex + 1 : 0;
+		for( size_t i = 0; i < numWorkers && ! result; i++ ) {
+			size_t victimIndex = ( start + i ) % numWorkers;
+			if( victimIndex == workerIndex )
+				continue;
+
+			Worker *victim = mWorkers[victimIndex].get();
+			lock_guard<mutex> lock( victim->mMutex );
+			if( ! victim->mTasks.empty() ) {
+				result = victim->mTasks.front();
+				victim->mTasks.pop_front();
+			}
+		}
+	}
+
+	if( result )
+		--mNumQueued;
+
+	return result;
+}
+
+bool TaskPool::runNextTask( size_t workerIndex )
+{
+	TaskRef task = popTask( workerIndex );
+	if( ! task )
+		return false;
+
+	task->run();
+	return true;
+}
+
+void TaskPool::threadLoop( size_t workerIndex )
+{
+	ThreadSetup threadSetup;
+	Profiler::get()->setThreadName( "TaskPool " + toString( workerIndex ) );
+	System::setThreadName( "TaskPool " + toString( workerIndex ) );
+
+	{
+		lock_guard<mutex> lock( mSleepMutex );
+	}
+
+	while( true ) {
+		if( runNextTask( workerIndex ) )
+			continue;
+
+		unique_lock<mutex> lock( mSleepMutex );
+		++mNumSleeping;
+		while( mNumQueued == 0 && ! mShouldQuit )
+			mSleepCond.wait( lock );
+		--mNumSleeping;
+
+		if( mShouldQuit )
+			return;
+	}
+}
+
+void TaskPool::dispatchToMainThread( const std::function<void ()> &fn )
+{
+	auto app = app::App::get();
+	if( app )
+		app->dispatchAsync( fn );
+	else
+		submit( fn );
+}
+
+void TaskPool::parallelFor( size_t begin, size_t end, const std::function<void ( size_t, size_t )> &fn, size_t grainSize )
+{
+	if( begin >= end )
+		return;
+
+	const size_t length = end - begin;
+	const size_t numThreads = mThreads.size() + 1; // including the calling thread
+	if( grainSize == 0 )
+		grainSize = std::max<size_t>( 1, length / ( numThreads * 4 ) );
+
+	const size_t numChunks = ( length + grainSize - 1 ) / grainSize;
+	if( numChunks == 1 ) {
+		fn( begin, end );
+		return;
+	}
+
+	// Chunks are claimed from a shared counter by the calling thread and by helper tasks, so a busy pool thread just means fewer helpers.
+	// The exception state is shared since helpers may still be running when the first exception is caught.
+	struct Job {
+		atomic<size_t>		mNextChunk;
+		mutex				mExceptionMutex;
+		exception_ptr		mException;
+	};
+
+	auto job = make_shared<Job>();
+	job->mNextChunk = 0;
+
+	auto runChunks = [job, begin, end, grainSize, numChunks, &fn] {
+		while( true ) {
+			size_t chunk = job->mNextChunk++;
+			if( chunk >= numChunks )
+				return;
+
+			size_t first = begin + chunk * grainSize;
+			size_t last = std::min( first + grainSize, end );
+			try {
+				fn( first, last );
+			}
+			catch( ... ) {
+				lock_guard<mutex> lock( job->mExceptionMutex );
+				if( ! job->mException )
+					job->mException = current_exception();
+				job->mNextChunk = numChunks; // skip remaining chunks
+			}
+		}
+	};
+
+	const size_t numHelpers = std::min( numChunks, numThreads ) - 1;
+	vector<TaskRef> helpers;
+	helpers.reserve( numHelpers );
+	for( size_t i = 0; i < numHelpers; i++ )
+		helpers.push_back( submit( runChunks ) );
+
+	runChunks();
+
+	// fn is referenced by the helpers, so they all need to finish before returning (they exit immediately if all chunks were claimed).
+	for( const auto &helper : helpers )
+		helper->wait();
+
+	if( job->mException )
+		rethrow_exception( job->mException );
+}
+
+void TaskPool::parallelFor( const Area &area, const Vec2i &tileSize, const std::function<void ( const Area & )> &fn )
+{
+	CI_ASSERT( tileSize.x > 0 && tileSize.y > 0 );
+
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	const int32_t tilesX = ( area.getWidth() + tileSize.x - 1 ) / tileSize.x;
+	const int32_t tilesY = ( area.getHeight() + tileSize.y - 1 ) / tileSize.y;
+
+	parallelFor( 0, size_t( tilesX * tilesY ), [&]( size_t first, size_t last ) {
+		for( size_t i = first; i < last; i++ ) {
+			int32_t x1 = area.x1 + int32_t( i % tilesX ) * tileSize.x;
+			int32_t y1 = area.y1 + int32_t( i / tilesX ) * tileSize.y;
+			fn( Area( x1, y1, std::min( x1 + tileSize.x, area.x2 ), std::min( y1 + tileSize.y, area.y2 ) ) );
+		}
+	}, 1 );
+}
+
+} // namespace cinder
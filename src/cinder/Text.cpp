@@ -26,6 +26,8 @@
 #include "cinder/ip/Fill.h"
 #include "cinder/ip/Premultiply.h"
 #include "cinder/Utilities.h"
+#include "cinder/Unicode.h"
+#include "cinder/TaskPool.h"
 
 #if defined( CINDER_COCOA )
 	#include "cinder/cocoa/CinderCocoa.h"
@@ -43,7 +45,7 @@
 	#include "cinder/msw/CinderMsw.h"
 	#include "cinder/msw/CinderMswGdiPlus.h"
 	#pragma comment(lib, "gdiplus")
-	#include "cinder/Unicode.h"
+	#include <boost/thread/tss.hpp>
 
 static const float MAX_SIZE = 1000000.0f;
 
@@ -58,6 +60,7 @@ namespace cinder {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // TextManager
+// On MSW each thread gets its own TextManager, since GDI and GDI+ objects can't be used by several threads at once
 class TextManager : private boost::noncopyable
 {
  public:
@@ -69,19 +72,28 @@ class TextManager : private boost::noncopyable
 #elif defined( CINDER_MSW )
 	HDC					getDc() { return mDummyDC; }
 	Gdiplus::Graphics*	getGraphics() { return mGraphics; }
+	//! Returns this thread's clone of \a font's Gdiplus::Font
+	const Gdiplus::Font*	getGdiplusFont( const Font &font );
 #endif
 
  private:
-	static TextManager	*sInstance;
+#if defined( CINDER_MSW )
+	static boost::thread_specific_ptr<TextManager>	sThreadInstance;
 
-#if defined( CINDER_MAC )
-#elif defined( CINDER_MSW )
 	HDC					mDummyDC;
 	Gdiplus::Graphics	*mGraphics;
+	// keyed by the Font's own Gdiplus::Font; the Font is held so that the key can't be reused by another Font
+	std::map<const Gdiplus::Font*,std::pair<Font,std::shared_ptr<Gdiplus::Font> > >	mFonts;
+#else
+	static TextManager	*sInstance;
 #endif
 };
 
+#if defined( CINDER_MSW )
+boost::thread_specific_ptr<TextManager> TextManager::sThreadInstance;
+#else
 TextManager *TextManager::sInstance = 0;
+#endif
 
 TextManager::TextManager()
 {
@@ -96,17 +108,48 @@ TextManager::~TextManager()
 {
 #if defined( CINDER_MAC )
 #elif defined( CINDER_MSW )
+	mFonts.clear();
+	delete mGraphics;
 	::DeleteDC( mDummyDC );
 #endif
 }
 
 TextManager* TextManager::instance()
 {
+#if defined( CINDER_MSW )
+	if( ! sThreadInstance.get() )
+		sThreadInstance.reset( new TextManager );
+
+	return sThreadInstance.get();
+#else
 	if( ! TextManager::sInstance )
 		TextManager::sInstance = new TextManager;
 		
 	return TextManager::sInstance;
+#endif
+}
+
+#if defined( CINDER_MSW )
+const Gdiplus::Font* TextManager::getGdiplusFont( const Font &font )
+{
+	const Gdiplus::Font *shared = font.getGdiplusFont();
+	std::map<const Gdiplus::Font*,std::pair<Font,std::shared_ptr<Gdiplus::Font> > >::const_iterator fontIt = mFonts.find( shared );
+	if( fontIt != mFonts.end() )
+		return fontIt->second.second.get();
+
+	// forget the clones of Fonts which nothing else references anymore
+	for( std::map<const Gdiplus::Font*,std::pair<Font,std::shared_ptr<Gdiplus::Font> > >::iterator cachedIt = mFonts.begin(); cachedIt != mFonts.end(); ) {
+		if( cachedIt->second.first.mObj.unique() )
+			mFonts.erase( cachedIt++ );
+		else
+			++cachedIt;
+	}
+
+	std::shared_ptr<Gdiplus::Font> clone( shared->Clone() );
+	mFonts[shared] = std::make_pair( font, clone );
+	return clone.get();
 }
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Run
@@ -205,39 +248,53 @@ void Line::calcExtents()
 #elif defined( CINDER_MSW )
 	mHeight = mWidth = mAscent = mDescent = mLeading = 0;
 	for( vector<Run>::iterator runIt = mRuns.begin(); runIt != mRuns.end(); ++runIt ) {
-		Gdiplus::StringFormat format;
-		format.SetAlignment( Gdiplus::StringAlignmentNear ); format.SetLineAlignment( Gdiplus::StringAlignmentNear );
-		Gdiplus::RectF sizeRect;
-		const Gdiplus::Font *font = runIt->mFont.getGdiplusFont();
-		TextManager::instance()->getGraphics()->MeasureString( (wchar_t*)&runIt->mWideText[0], -1, font, Gdiplus::PointF( 0, 0 ), &format, &sizeRect );
+		// runs are measured unconstrained; an alignment of -1 keeps them apart from TextBox's measurements
+		Font::MeasureKey key( runIt->mText, Vec2i::zero(), -1, false );
+		Vec2f size;
+		if( ! runIt->mFont.findMeasurement( key, &size, NULL ) ) {
+			Gdiplus::StringFormat format;
+			format.SetAlignment( Gdiplus::StringAlignmentNear ); format.SetLineAlignment( Gdiplus::StringAlignmentNear );
+			Gdiplus::RectF sizeRect;
+			const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( runIt->mFont );
+			TextManager::instance()->getGraphics()->MeasureString( (wchar_t*)&runIt->mWideText[0], -1, font, Gdiplus::PointF( 0, 0 ), &format, &sizeRect );
+			size = Vec2f( sizeRect.Width, sizeRect.Height );
+			runIt->mFont.cacheMeasurement( key, &size, NULL );
+		}
 		
-		runIt->mWidth = sizeRect.Width;
+		runIt->mWidth = size.x;
 		runIt->mAscent = runIt->mFont.getAscent();
 		runIt->mDescent = runIt->mFont.getDescent();
 		runIt->mLeading = runIt->mFont.getLeading();
 		
-		mWidth += sizeRect.Width;
+		mWidth += size.x;
 		mAscent = std::max( runIt->mFont.getAscent(), mAscent );
 		mDescent = std::max( runIt->mFont.getDescent(), mDescent );
 		mLeading = std::max( runIt->mFont.getLeading(), mLeading );
-		mHeight = std::max( mHeight, sizeRect.Height );
+		mHeight = std::max( mHeight, size.y );
 	}
 #elif defined( CINDER_WINRT )
 	mHeight = mWidth = mAscent = mDescent = mLeading = 0;
 	for( vector<Run>::iterator runIt = mRuns.begin(); runIt != mRuns.end(); ++runIt ) {
-		FT_Face face = runIt->mFont.getFace();
+		// runs are measured unconstrained; an alignment of -1 keeps them apart from TextBox's measurements
+		Font::MeasureKey key( runIt->mText, Vec2i::zero(), -1, false );
+		Vec2f size;
+		if( ! runIt->mFont.findMeasurement( key, &size, NULL ) ) {
+			FT_Face face = runIt->mFont.getFace();
 		
-		int width = 0;
-		for(string::iterator strIt = runIt->mText.begin(); strIt != runIt->mText.end(); ++strIt)
-		{
-			FT_Load_Char(face, *strIt, FT_LOAD_DEFAULT);
-			width += face->glyph->advance.x;
+			int width = 0;
+			for(string::iterator strIt = runIt->mText.begin(); strIt != runIt->mText.end(); ++strIt)
+			{
+				FT_Load_Char(face, *strIt, FT_LOAD_DEFAULT);
+				width += face->glyph->advance.x;
+			}
+			size = Vec2f( width / 64.0f, face->bbox.yMax / 64.0f );
+			runIt->mFont.cacheMeasurement( key, &size, NULL );
 		}
-		mWidth += width / 64.0f;
+		mWidth += size.x;
 		mAscent = std::max( runIt->mFont.getAscent(), mAscent );
 		mDescent = std::max( runIt->mFont.getDescent(), mDescent );
 		mLeading = std::max( runIt->mFont.getLeading(), mLeading );
-		mHeight = std::max( mHeight, face->bbox.yMax / 64.0f );
+		mHeight = std::max( mHeight, size.y );
 	}
 #endif
 
@@ -266,7 +323,7 @@ void Line::render( Gdiplus::Graphics *graphics, float currentY, float xBorder, f
 	else if( mJustification == RIGHT )
 		currentX = maxWidth - mWidth - xBorder;
 	for( vector<Run>::const_iterator runIt = mRuns.begin(); runIt != mRuns.end(); ++runIt ) {
-		const Gdiplus::Font *font = runIt->mFont.getGdiplusFont();;
+		const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( runIt->mFont );
 		ColorA8u nativeColor( runIt->mColor );
 		Gdiplus::SolidBrush brush( Gdiplus::Color( nativeColor.a, nativeColor.r, nativeColor.g, nativeColor.b ) );
 		graphics->DrawString( (wchar_t*)&runIt->mWideText[0], -1, font, Gdiplus::PointF( currentX, currentY + (mAscent - runIt->mAscent) ), &brush );
@@ -384,7 +441,7 @@ void TextLayout::setColor( const ColorA &color )
 	mCurrentColor = color;
 }
 
-Surface	TextLayout::render( bool useAlpha, bool premultiplied )
+Surface	TextLayout::render( bool useAlpha, bool premultiplied, SurfacePool pool )
 {
 	Surface result;
 	
@@ -412,7 +469,7 @@ Surface	TextLayout::render( bool useAlpha, bool premultiplied )
 
 	// allocate the surface based on our collective extents
 #if defined( CINDER_COCOA )
-	result = Surface( pixelWidth, pixelHeight, useAlpha, (useAlpha)?SurfaceChannelOrder::RGBA:SurfaceChannelOrder::RGBX );
+	result = pool.getSurface( pixelWidth, pixelHeight, useAlpha, (useAlpha)?SurfaceChannelOrder::RGBA:SurfaceChannelOrder::RGBX );
 	CGContextRef cgContext = cocoa::createCgBitmapContext( result );
 	ip::fill( &result, mBackgroundColor.premultiplied() );
 
@@ -436,7 +493,7 @@ Surface	TextLayout::render( bool useAlpha, bool premultiplied )
 	pixelHeight += 1;
 	// prep our GDI and GDI+ resources
 	HDC dc = TextManager::instance()->getDc();
-	result = Surface8u( pixelWidth, pixelHeight, useAlpha, SurfaceConstraintsGdiPlus() );
+	result = pool.getSurface( pixelWidth, pixelHeight, useAlpha, SurfaceConstraintsGdiPlus() );
 	result.setPremultiplied( premultiplied );
 	Gdiplus::Bitmap *offscreenBitmap = msw::createGdiplusBitmap( result );
 	//Gdiplus::Bitmap *offscreenBitmap = new Gdiplus::Bitmap( pixelWidth, pixelHeight, (premultiplied) ? PixelFormat32bppPARGB : PixelFormat32bppARGB );
@@ -598,6 +655,228 @@ Surface renderString( const string &str, const Font &font, const ColorA &color,
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // TextBox
+#if defined( CINDER_COCOA ) || defined( CINDER_MSW )
+namespace {
+// the number of distinct paragraphs whose line breaks a TextBox remembers
+const size_t MAX_CACHED_PARAGRAPHS = 256;
+} // anonymous namespace
+
+const vector<string>& TextBox::breakParagraph( const string &paragraph )
+{
+	map<string,vector<string> >::const_iterator breaksIt = mLineBreaks.find( paragraph );
+	if( breaksIt != mLineBreaks.end() )
+		return breaksIt->second;
+
+	if( mLineBreaks.size() >= MAX_CACHED_PARAGRAPHS )
+		mLineBreaks.clear();
+
+	vector<string> &result = mLineBreaks[paragraph];
+	if( mSize.x > 0 && ! paragraph.empty() ) {
+		const Font &font = mFont;
+		const bool ligate = mLigate;
+		const float maxWidth = (float)mSize.x;
+		// single-line measurements come out of the Font's measurement cache after the first time
+		std::function<bool(const char*,size_t)> measureFn = [&]( const char *line, size_t len ) {
+			return TextBox().font( font ).text( string( line, len ) ).ligate( ligate ).measure().x <= maxWidth;
+		};
+		std::function<void(const char*,size_t)> lineFn = [&]( const char *line, size_t len ) { result.push_back( string( line, len ) ); };
+		lineBreakUtf8( paragraph.c_str(), measureFn, lineFn );
+	}
+	if( result.empty() )
+		result.push_back( paragraph );
+
+	return result;
+}
+
+vector<pair<uint16_t,Vec2f> > TextBox::layoutFreeType( Vec2f *size ) const
+{
+	// break into lines at newlines and, for a fixed width, wherever a line would overflow it
+	vector<string> lines;
+	const FreeTypeFont &font = mFreeTypeFont;
+	const float maxWidth = (float)mSize.x;
+	// glyphs and advances are looked up once per distinct code point, so each character costs a map lookup and a kerning query
+	map<uint32_t,pair<Font::Glyph,float> > glyphCache;
+	std::function<float(uint32_t,uint32_t)> advanceFn = [&]( uint32_t prevChar, uint32_t ch ) -> float {
+		map<uint32_t,pair<Font::Glyph,float> >::iterator glyphIt = glyphCache.find( ch );
+		if( glyphIt == glyphCache.end() ) {
+			const Font::Glyph glyph = font.getGlyphChar( ch );
+			glyphIt = glyphCache.insert( make_pair( ch, make_pair( glyph, font.getAdvance( glyph ) ) ) ).first;
+		}
+		float advance = glyphIt->second.second;
+		if( prevChar ) {
+			const Font::Glyph prevGlyph = glyphCache[prevChar].first;
+			if( prevGlyph && glyphIt->second.first )
+				advance += font.getKerning( prevGlyph, glyphIt->second.first );
+		}
+		return advance;
+	};
+	std::function<void(const char*,size_t)> lineFn = [&]( const char *line, size_t len ) { lines.push_back( string( line, len ) ); };
+	string::size_type paragraphStart = 0;
+	while( paragraphStart <= mText.size() ) {
+		string::size_type paragraphEnd = mText.find( '\n', paragraphStart );
+		if( paragraphEnd == string::npos )
+			paragraphEnd = mText.size();
+		const string paragraph = mText.substr( paragraphStart, paragraphEnd - paragraphStart );
+		const size_t numLines = lines.size();
+		if( mSize.x > 0 && ! paragraph.empty() )
+			lineBreakUtf8( paragraph.c_str(), paragraph.size(), maxWidth, advanceFn, lineFn );
+		if( lines.size() == numLines )
+			lines.push_back( paragraph );
+		paragraphStart = paragraphEnd + 1;
+	}
+
+	vector<vector<pair<uint16_t,Vec2f> > > lineGlyphs( lines.size() );
+	vector<float> lineWidths( lines.size() );
+	float textWidth = 0;
+	for( size_t l = 0; l < lines.size(); ++l ) {
+		lineGlyphs[l] = font.getGlyphPlacements( lines[l] );
+		lineWidths[l] = font.measureString( lines[l] );
+		textWidth = std::max( textWidth, lineWidths[l] );
+	}
+
+	float flush = 0;
+	if( mAlign == TextBox::CENTER ) flush = 0.5f;
+	else if( mAlign == TextBox::RIGHT ) flush = 1;
+	const float boxWidth = ( mSize.x > 0 ) ? (float)mSize.x : textWidth;
+	const float lineHeight = font.getAscent() + font.getDescent() + font.getLeading();
+
+	vector<pair<uint16_t,Vec2f> > result;
+	for( size_t l = 0; l < lines.size(); ++l ) {
+		const Vec2f lineOffset( ( boxWidth - lineWidths[l] ) * flush, font.getAscent() + l * lineHeight );
+		for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = lineGlyphs[l].begin(); glyphIt != lineGlyphs[l].end(); ++glyphIt )
+			result.push_back( make_pair( glyphIt->first, glyphIt->second + lineOffset ) );
+	}
+
+	if( size )
+		*size = ( mText.empty() ) ? Vec2f::zero() : Vec2f( textWidth, lines.size() * lineHeight );
+	return result;
+}
+
+Surface TextBox::renderFreeType( Vec2f offset ) const
+{
+	Vec2f textSize;
+	const vector<pair<uint16_t,Vec2f> > glyphs = layoutFreeType( &textSize );
+	const int32_t width = (int32_t)math<float>::ceil( ( mSize.x <= 0 ) ? textSize.x : mSize.x );
+	const int32_t height = (int32_t)math<float>::ceil( ( mSize.y <= 0 ) ? textSize.y : mSize.y );
+
+	Channel8u coverage( width, height );
+	ip::fill<uint8_t>( &coverage, 0 );
+	mFreeTypeFont.renderGlyphs( glyphs, offset, &coverage );
+
+	// composite the text color over the background color by the coverage
+	Surface result( width, height, true );
+	result.setPremultiplied( mPremultiplied );
+	const ColorA8u background( mBackgroundColor.premultiplied() );
+	const ColorA8u text( mColor.premultiplied() );
+	Channel8u::Iter coverageIter = coverage.getIter();
+	Surface::Iter resultIter = result.getIter();
+	while( coverageIter.line() && resultIter.line() ) {
+		while( coverageIter.pixel() && resultIter.pixel() ) {
+			const uint32_t c = coverageIter.v(), inverse = 255 - c;
+			resultIter.r() = (uint8_t)( ( text.r * c + background.r * inverse ) / 255 );
+			resultIter.g() = (uint8_t)( ( text.g * c + background.g * inverse ) / 255 );
+			resultIter.b() = (uint8_t)( ( text.b * c + background.b * inverse ) / 255 );
+			resultIter.a() = (uint8_t)( ( text.a * c + background.a * inverse ) / 255 );
+		}
+	}
+	if( ! mPremultiplied )
+		ip::unpremultiply( &result );
+
+	return result;
+}
+
+Area TextBox::renderIncremental( Vec2f offset )
+{
+	if( mLineBreakFont.mObj != mFont.mObj || mLineBreakWidth != mSize.x || mLineBreakLigate != mLigate ) {
+		mLineBreaks.clear();
+		mLineBreakFont = mFont;
+		mLineBreakWidth = mSize.x;
+		mLineBreakLigate = mLigate;
+	}
+
+	// break each paragraph, reusing the breaks of those which haven't changed
+	vector<string> lines;
+	size_t paragraphStart = 0;
+	while( true ) {
+		size_t paragraphEnd = mText.find( '\n', paragraphStart );
+		const vector<string> &paragraphLines = breakParagraph( mText.substr( paragraphStart, ( paragraphEnd == string::npos ) ? string::npos : paragraphEnd - paragraphStart ) );
+		lines.insert( lines.end(), paragraphLines.begin(), paragraphLines.end() );
+		if( paragraphEnd == string::npos )
+			break;
+		paragraphStart = paragraphEnd + 1;
+	}
+
+	const Vec2i pixelOffset( (int)math<float>::floor( offset.x ), (int)math<float>::floor( offset.y ) );
+	const int lineHeight = std::max( 1, (int)math<float>::ceil( mFont.getAscent() + mFont.getDescent() + mFont.getLeading() ) );
+	int width = mSize.x, height = mSize.y;
+	if( width <= 0 ) {
+		width = ( mIncrementalSurface ) ? mIncrementalSurface.getWidth() : 1;
+		for( vector<string>::const_iterator lineIt = lines.begin(); lineIt != lines.end(); ++lineIt ) {
+			int lineWidth = (int)math<float>::ceil( TextBox().font( mFont ).text( *lineIt ).ligate( mLigate ).measure().x ) + pixelOffset.x;
+			width = std::max( width, lineWidth );
+		}
+	}
+	if( height <= 0 ) {
+		height = ( mIncrementalSurface ) ? mIncrementalSurface.getHeight() : 1;
+		height = std::max( height, (int)lines.size() * lineHeight + pixelOffset.y );
+	}
+
+	bool redrawAll = ( ! mIncrementalSurface ) || ( mIncrementalSurface.getSize() != Vec2i( width, height ) ) || ( mRenderedFont.mObj != mFont.mObj )
+			|| ( mRenderedColor != mColor ) || ( mRenderedBackgroundColor != mBackgroundColor ) || ( mRenderedAlign != mAlign )
+			|| ( mRenderedOffset != pixelOffset ) || ( mRenderedPremultiplied != mPremultiplied ) || ( mRenderedLigate != mLigate );
+	if( redrawAll ) {
+		if( ( ! mIncrementalSurface ) || ( mIncrementalSurface.getSize() != Vec2i( width, height ) ) )
+			mIncrementalSurface = Surface( width, height, true );
+		mIncrementalSurface.setPremultiplied( mPremultiplied );
+		ip::fill( &mIncrementalSurface, mBackgroundColor );
+		mRenderedLines.clear();
+		mRenderedFont = mFont;
+		mRenderedColor = mColor;
+		mRenderedBackgroundColor = mBackgroundColor;
+		mRenderedAlign = mAlign;
+		mRenderedOffset = pixelOffset;
+		mRenderedPremultiplied = mPremultiplied;
+		mRenderedLigate = mLigate;
+	}
+
+	Area dirtyArea( 0, 0, 0, 0 );
+	const size_t numRows = std::max( lines.size(), mRenderedLines.size() );
+	for( size_t row = 0; row < numRows; ++row ) {
+		const bool hasLine = row < lines.size();
+		if( hasLine && row < mRenderedLines.size() && lines[row] == mRenderedLines[row] )
+			continue;
+
+		Area rowArea( 0, pixelOffset.y + (int)row * lineHeight, width, pixelOffset.y + (int)( row + 1 ) * lineHeight );
+		rowArea.clipBy( mIncrementalSurface.getBounds() );
+		if( rowArea.calcArea() <= 0 )
+			continue;
+
+		if( ! redrawAll )
+			ip::fill( &mIncrementalSurface, mBackgroundColor, rowArea );
+		if( hasLine && ! lines[row].empty() ) {
+			TextBox lineBox = TextBox().font( mFont ).text( lines[row] ).color( mColor ).backgroundColor( mBackgroundColor ).premultiplied( mPremultiplied ).ligate( mLigate );
+			Surface lineSurface = lineBox.render();
+			int x = pixelOffset.x;
+			const int contentWidth = width - pixelOffset.x;
+			if( mAlign == CENTER ) x += ( contentWidth - lineSurface.getWidth() ) / 2;
+			else if( mAlign == RIGHT ) x += contentWidth - lineSurface.getWidth();
+			mIncrementalSurface.copyFrom( lineSurface, Area( 0, 0, lineSurface.getWidth(), std::min( lineSurface.getHeight(), rowArea.getHeight() ) ), Vec2i( x, rowArea.y1 ) );
+		}
+
+		if( dirtyArea.calcArea() > 0 )
+			dirtyArea.include( rowArea );
+		else
+			dirtyArea = rowArea;
+	}
+
+	if( redrawAll )
+		dirtyArea = mIncrementalSurface.getBounds();
+	mRenderedLines.swap( lines );
+
+	return dirtyArea;
+}
+#endif
+
 #if defined( CINDER_COCOA )
 void TextBox::createLines() const
 {
@@ -644,8 +923,15 @@ void TextBox::createLines() const
 
 vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 {
+	if( mFreeTypeFont )
+		return layoutFreeType( NULL );
+
 	vector<pair<uint16_t,Vec2f> > result;
 
+	Font::MeasureKey key( mText, mSize, mAlign, mLigate );
+	if( mFont.findMeasurement( key, NULL, &result ) )
+		return result;
+
 	createLines();
 	CFRange range = CFRangeMake( 0, 0 );
 	for( vector<pair<shared_ptr<const __CTLine>,Vec2f> >::const_iterator lineIt = mLines.begin(); lineIt != mLines.end(); ++lineIt ) {
@@ -663,17 +949,37 @@ vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 		}
 	}
 	
+	mFont.cacheMeasurement( key, &mCalculatedSize, &result );
 	return result;
 }
 
 Vec2f TextBox::measure() const
 {
-	createLines();
+	if( mFreeTypeFont ) {
+		Vec2f size;
+		layoutFreeType( &size );
+		return size;
+	}
+
+	if( mInvalid ) {
+		// a cached size spares building the CTLines, which only render() needs
+		Font::MeasureKey key( mText, mSize, mAlign, mLigate );
+		Vec2f size;
+		if( mFont.findMeasurement( key, &size, NULL ) )
+			return size;
+
+		createLines();
+		mFont.cacheMeasurement( key, &mCalculatedSize, NULL );
+	}
+
 	return mCalculatedSize;
 }
 
 Surface	TextBox::render( Vec2f offset )
 {
+	if( mFreeTypeFont )
+		return renderFreeType( offset );
+
 	createLines();
 	
 	float sizeX = ( mSize.x <= 0 ) ? mCalculatedSize.x : mSize.x;
@@ -713,12 +1019,18 @@ void TextBox::calculate() const
 	}
 	mWideText = toUtf16( mText );
 
+	Font::MeasureKey key( mText, mSize, mAlign, mLigate );
+	if( mFont.findMeasurement( key, &mCalculatedSize, NULL ) ) {
+		mInvalid = false;
+		return;
+	}
+
 	Gdiplus::StringFormat format;
 	Gdiplus::StringAlignment align = Gdiplus::StringAlignmentNear;
 	if( mAlign == TextBox::CENTER ) align = Gdiplus::StringAlignmentCenter;
 	else if( mAlign == TextBox::RIGHT ) align = Gdiplus::StringAlignmentFar;
 	format.SetAlignment( align ); format.SetLineAlignment( align );
-	const Gdiplus::Font *font = mFont.getGdiplusFont();
+	const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( mFont );
 	Gdiplus::RectF sizeRect( 0, 0, 0, 0 ), outSize;
 	sizeRect.Width = ( mSize.x <= 0 ) ? MAX_SIZE : mSize.x;
 	sizeRect.Height = ( mSize.y <= 0 ) ? MAX_SIZE : mSize.y;
@@ -727,12 +1039,19 @@ void TextBox::calculate() const
 
 	mCalculatedSize.x = outSize.Width;
 	mCalculatedSize.y = outSize.Height;
+	mFont.cacheMeasurement( key, &mCalculatedSize, NULL );
 
 	mInvalid = false;
 }
 
 Vec2f TextBox::measure() const
 {
+	if( mFreeTypeFont ) {
+		Vec2f size;
+		layoutFreeType( &size );
+		return size;
+	}
+
 	calculate();
 	return mCalculatedSize;
 }
@@ -741,7 +1060,7 @@ vector<string> TextBox::calculateLineBreaks() const
 {
 	vector<string> result;
 
-	::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+	::SelectObject( TextManager::instance()->getDc(), mFont.getHfont() );
 
 	vector<string> strings;
 	struct LineProcessor {
@@ -750,7 +1069,7 @@ vector<string> TextBox::calculateLineBreaks() const
 		mutable vector<string> *mStrings;
 	};
 	struct LineMeasure {
-		LineMeasure( int maxWidth, const Font &font ) : mMaxWidth( maxWidth ), mFont( font.getGdiplusFont() ) {}
+		LineMeasure( int maxWidth, const Font &font ) : mMaxWidth( maxWidth ), mFont( TextManager::instance()->getGdiplusFont( font ) ) {}
 		bool operator()( const char *line, size_t len ) const {
 			if( mMaxWidth >= MAX_SIZE ) return true; // too big anyway so just return true
 			Gdiplus::StringFormat format;
@@ -775,16 +1094,23 @@ vector<string> TextBox::calculateLineBreaks() const
 
 vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 {
+	if( mFreeTypeFont )
+		return layoutFreeType( NULL );
+
 	vector<pair<uint16_t,Vec2f> > result;
 
 	if( mText.empty() )
 		return result;
 
+	Font::MeasureKey key( mText, mSize, mAlign, mLigate );
+	if( mFont.findMeasurement( key, NULL, &result ) )
+		return result;
+
 	GCP_RESULTSW gcpResults;
 	WCHAR *glyphIndices = NULL;
 	int *dx = NULL;
 
-	::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+	::SelectObject( TextManager::instance()->getDc(), mFont.getHfont() );
 	
 	vector<string> mLines = calculateLineBreaks();
 	
@@ -815,7 +1141,7 @@ vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 			gcpResults.lpDx = dx;
 			gcpResults.lpGlyphs = glyphIndices;
 
-			if( ! ::GetCharacterPlacementW( Font::getGlobalDc(), (wchar_t*)&wideText[0], wideText.length(), 0,
+			if( ! ::GetCharacterPlacementW( TextManager::instance()->getDc(), (wchar_t*)&wideText[0], wideText.length(), 0,
 							&gcpResults, GCP_DIACRITIC | GCP_LIGATE | GCP_GLYPHSHAPE | GCP_REORDER ) ) {
 				return vector<pair<uint16_t,Vec2f> >(); // failure
 			}
@@ -844,11 +1170,15 @@ vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 	if( dx )
 		free( dx );
 
+	mFont.cacheMeasurement( key, NULL, &result );
 	return result;
 }
 
 Surface	TextBox::render( Vec2f offset )
 {
+	if( mFreeTypeFont )
+		return renderFreeType( offset );
+
 	calculate();
 	
 	float sizeX = ( mSize.x <= 0 ) ? mCalculatedSize.x : mSize.x;
@@ -868,7 +1198,7 @@ Surface	TextBox::render( Vec2f offset )
 	// fill the surface with the background color
 	offscreenGraphics->Clear( Gdiplus::Color( (BYTE)(mBackgroundColor.a * 255), (BYTE)(mBackgroundColor.r * 255), 
 			(BYTE)(mBackgroundColor.g * 255), (BYTE)(mBackgroundColor.b * 255) ) );
-	const Gdiplus::Font *font = mFont.getGdiplusFont();;
+	const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( mFont );
 	ColorA8u nativeColor( mColor );
 	Gdiplus::StringFormat format;
 	Gdiplus::StringAlignment align = Gdiplus::StringAlignmentNear;
@@ -887,4 +1217,26 @@ Surface	TextBox::render( Vec2f offset )
 }
 #endif
 
+#if defined( CINDER_COCOA ) || defined( CINDER_MSW )
+vector<Surface> renderTextBoxes( const vector<TextBox> &boxes, TaskPool *taskPool )
+{
+	if( ! taskPool )
+		taskPool = TaskPool::get();
+
+	// the default Font is created on first use, which mustn't race between the workers
+	Font::getDefault();
+
+	vector<Surface> result( boxes.size() );
+	taskPool->parallelFor( 0, boxes.size(), [&]( size_t first, size_t last ) {
+		for( size_t i = first; i < last; ++i ) {
+			// render() caches its layout in the TextBox, so each one is rendered from a copy
+			TextBox box = boxes[i];
+			result[i] = box.render();
+		}
+	} );
+
+	return result;
+}
+#endif
+
 } // namespace cinder
@@ -0,0 +1,507 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TiledSurface.h"
+#include "cinder/Stream.h"
+#include "cinder/TaskPool.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <boost/preprocessor/seq.hpp>
+#include <boost/type_traits/is_same.hpp>
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#elif ! defined( CINDER_WINRT )
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace cinder {
+
+namespace {
+
+const char		TILE_FILE_MAGIC[4] = { 'C', 'I', 'T', 'S' };
+const uint32_t	TILE_FILE_VERSION = 1;
+// the tiles follow the header at this offset
+const uint64_t	TILE_FILE_HEADER_SIZE = 64;
+
+// Begins the tile file, in native byte order
+struct TileFileHeader {
+	char		mMagic[4];
+	uint32_t	mVersion;
+	int32_t		mWidth, mHeight, mTileSize;
+	int32_t		mChannelOrder;
+	uint32_t	mBytesPerChannel;
+	uint32_t	mIsFloat;
+};
+
+// Mappings have to start at a multiple of this, so the view of a tile may begin before it
+size_t getMapGranularity()
+{
+#if defined( CINDER_MSW )
+	SYSTEM_INFO info;
+	::GetSystemInfo( &info );
+	return info.dwAllocationGranularity;
+#elif defined( CINDER_WINRT )
+	return 1;
+#else
+	return (size_t)::sysconf( _SC_PAGESIZE );
+#endif
+}
+
+} // anonymous namespace
+
+// The open tile file. Mapped tiles keep it alive, and a temporary file is deleted once the last of them is unmapped.
+template<typename T>
+struct TiledSurfaceT<T>::File : private boost::noncopyable {
+	File( const fs::path &path, bool temporary, const TileFileHeader *createHeader, uint64_t createSize );
+	~File();
+
+	// Maps \a size bytes at \a offset, returning a pointer to them. The view to unmap, which may begin earlier, is returned in \a resultView and \a resultViewSize.
+	uint8_t*	map( uint64_t offset, size_t size, void **resultView, size_t *resultViewSize );
+	static void	unmap( void *view, size_t viewSize );
+	static void	flush( void *view, size_t viewSize );
+
+	fs::path		mPath;
+	bool			mTemporary;
+	TileFileHeader	mHeader;
+	size_t			mGranularity;
+#if defined( CINDER_MSW )
+	HANDLE			mFile, mMapping;
+#else
+	int				mFd;
+#endif
+};
+
+template<typename T>
+TiledSurfaceT<T>::File::File( const fs::path &path, bool temporary, const TileFileHeader *createHeader, uint64_t createSize )
+	: mPath( path ), mTemporary( temporary ), mGranularity( getMapGranularity() )
+{
+#if defined( CINDER_MSW )
+	mFile = ::CreateFileW( expandPath( path ).wstring().c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, createHeader ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( mFile == INVALID_HANDLE_VALUE )
+		throw TiledSurfaceExc( "Could not open tile file " + path.string() );
+
+	DWORD bytesTransferred = 0;
+	LARGE_INTEGER fileSize;
+	if( createHeader ) {
+		mHeader = *createHeader;
+		fileSize.QuadPart = (LONGLONG)createSize;
+		if( ! ::WriteFile( mFile, &mHeader, sizeof(mHeader), &bytesTransferred, NULL ) || ! ::SetFilePointerEx( mFile, fileSize, NULL, FILE_BEGIN ) || ! ::SetEndOfFile( mFile ) ) {
+			::CloseHandle( mFile );
+			throw TiledSurfaceExc( "Could not allocate tile file " + path.string() );
+		}
+	}
+	else if( ! ::ReadFile( mFile, &mHeader, sizeof(mHeader), &bytesTransferred, NULL ) || bytesTransferred != sizeof(mHeader) || ! ::GetFileSizeEx( mFile, &fileSize ) ) {
+		::CloseHandle( mFile );
+		throw TiledSurfaceExc( "Could not read tile file " + path.string() );
+	}
+
+	mMapping = ::CreateFileMappingW( mFile, NULL, PAGE_READWRITE, 0, 0, NULL );
+	if( ! mMapping ) {
+		::CloseHandle( mFile );
+		throw TiledSurfaceExc( "Could not map tile file " + path.string() );
+	}
+#elif defined( CINDER_WINRT )
+	throw TiledSurfaceExc( "TiledSurface is not supported on WinRT" );
+#else
+	mFd = ::open( expandPath( path ).string().c_str(), createHeader ? ( O_RDWR | O_CREAT | O_TRUNC ) : O_RDWR, 0644 );
+	if( mFd < 0 )
+		throw TiledSurfaceExc( "Could not open tile file " + path.string() );
+
+	if( createHeader ) {
+		mHeader = *createHeader;
+		// the file is sparse where supported, so untouched tiles take no disk space and read as zero
+		if( ::pwrite( mFd, &mHeader, sizeof(mHeader), 0 ) != (ssize_t)sizeof(mHeader) || ::ftruncate( mFd, (off_t)createSize ) != 0 ) {
+			::close( mFd );
+			throw TiledSurfaceExc( "Could not allocate tile file " + path.string() );
+		}
+	}
+	else if( ::pread( mFd, &mHeader, sizeof(mHeader), 0 ) != (ssize_t)sizeof(mHeader) ) {
+		::close( mFd );
+		throw TiledSurfaceExc( "Could not read tile file " + path.string() );
+	}
+#endif
+}
+
+template<typename T>
+TiledSurfaceT<T>::File::~File()
+{
+#if defined( CINDER_MSW )
+	::CloseHandle( mMapping );
+	::CloseHandle( mFile );
+#elif ! defined( CINDER_WINRT )
+	::close( mFd );
+#endif
+	if( mTemporary ) {
+		try {
+			fs::remove( mPath );
+		}
+		catch( ... ) {}
+	}
+}
+
+template<typename T>
+uint8_t* TiledSurfaceT<T>::File::map( uint64_t offset, size_t size, void **resultView, size_t *resultViewSize )
+{
+	const uint64_t viewOffset = offset / mGranularity * mGranularity;
+	const size_t viewSize = size + (size_t)( offset - viewOffset );
+	void *view = NULL;
+#if defined( CINDER_MSW )
+	view = ::MapViewOfFile( mMapping, FILE_MAP_WRITE, (DWORD)( viewOffset >> 32 ), (DWORD)( viewOffset & 0xFFFFFFFF ), viewSize );
+#elif ! defined( CINDER_WINRT )
+	view = ::mmap( NULL, viewSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, (off_t)viewOffset );
+	if( view == MAP_FAILED )
+		view = NULL;
+#endif
+	if( ! view )
+		throw TiledSurfaceExc( "Could not map tile of " + mPath.string() );
+
+	*resultView = view;
+	*resultViewSize = viewSize;
+	return reinterpret_cast<uint8_t*>( view ) + ( offset - viewOffset );
+}
+
+template<typename T>
+void TiledSurfaceT<T>::File::unmap( void *view, size_t viewSize )
+{
+#if defined( CINDER_MSW )
+	::UnmapViewOfFile( view );
+#elif ! defined( CINDER_WINRT )
+	::munmap( view, viewSize );
+#endif
+}
+
+template<typename T>
+void TiledSurfaceT<T>::File::flush( void *view, size_t viewSize )
+{
+#if defined( CINDER_MSW )
+	::FlushViewOfFile( view, viewSize );
+#elif ! defined( CINDER_WINRT )
+	::msync( view, viewSize, MS_SYNC );
+#endif
+}
+
+// A mapped tile
+template<typename T>
+struct TiledSurfaceT<T>::Tile : private boost::noncopyable {
+	Tile( const std::shared_ptr<File> &file, uint64_t offset, size_t size )
+		: mFile( file )
+	{
+		mData = reinterpret_cast<T*>( mFile->map( offset, size, &mView, &mViewSize ) );
+	}
+
+	~Tile()
+	{
+		File::unmap( mView, mViewSize );
+	}
+
+	std::shared_ptr<File>	mFile;
+	void					*mView;
+	size_t					mViewSize;
+	T						*mData;
+};
+
+// Buffers the row an ImageSource is writing and copies it into the TiledSurface once the next one is requested, or on finalize()
+template<typename T>
+class ImageTargetTiledSurface : public ImageTarget {
+  public:
+	ImageTargetTiledSurface( TiledSurfaceT<T> *surface )
+		: mSurface( surface ), mRow( surface->getWidth(), 1, surface->hasAlpha(), surface->getChannelOrder() ), mPendingRow( -1 )
+	{
+		if( boost::is_same<T,float>::value )
+			setDataType( ImageIo::FLOAT32 );
+		else if( boost::is_same<T,uint16_t>::value )
+			setDataType( ImageIo::UINT16 );
+		else
+			setDataType( ImageIo::UINT8 );
+		setColorModel( ImageIo::CM_RGB );
+		setChannelOrder( ImageIo::ChannelOrder( surface->getChannelOrder().getImageIoChannelOrder() ) );
+	}
+
+	virtual bool	hasAlpha() const { return mSurface->hasAlpha(); }
+
+	virtual void*	getRowPointer( int32_t row )
+	{
+		if( row != mPendingRow ) {
+			finalize();
+			mPendingRow = row;
+		}
+		return mRow.getData();
+	}
+
+	virtual void	finalize()
+	{
+		if( mPendingRow >= 0 )
+			mSurface->copyFrom( mRow, mRow.getBounds(), Vec2i( 0, mPendingRow ) );
+		mPendingRow = -1;
+	}
+
+  private:
+	TiledSurfaceT<T>	*mSurface;
+	SurfaceT<T>			mRow;
+	int32_t				mPendingRow;
+};
+
+template<typename T>
+std::shared_ptr<TiledSurfaceT<T> > TiledSurfaceT<T>::create( int32_t width, int32_t height, bool alpha, const Format &format )
+{
+	if( width <= 0 || height <= 0 || format.getTileSize() <= 0 )
+		throw TiledSurfaceExc( "Invalid TiledSurface dimensions" );
+
+	SurfaceChannelOrder channelOrder = format.getChannelOrder();
+	if( channelOrder.getCode() == SurfaceChannelOrder::UNSPECIFIED )
+		channelOrder = alpha ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB;
+
+	TileFileHeader header;
+	std::copy( TILE_FILE_MAGIC, TILE_FILE_MAGIC + 4, header.mMagic );
+	header.mVersion = TILE_FILE_VERSION;
+	header.mWidth = width;
+	header.mHeight = height;
+	header.mTileSize = format.getTileSize();
+	header.mChannelOrder = channelOrder.getCode();
+	header.mBytesPerChannel = sizeof(T);
+	header.mIsFloat = boost::is_same<T,float>::value ? 1 : 0;
+
+	const uint64_t numTiles = (uint64_t)( ( width + header.mTileSize - 1 ) / header.mTileSize ) * ( ( height + header.mTileSize - 1 ) / header.mTileSize );
+	const uint64_t tileBytes = (uint64_t)header.mTileSize * header.mTileSize * channelOrder.getPixelInc() * sizeof(T);
+	const bool temporary = format.getPath().empty();
+	const fs::path path = temporary ? getTemporaryFilePath( "cinder-tiles" ) : format.getPath();
+
+	std::shared_ptr<File> file( new File( path, temporary, &header, TILE_FILE_HEADER_SIZE + numTiles * tileBytes ) );
+	return std::shared_ptr<TiledSurfaceT<T> >( new TiledSurfaceT<T>( file, format.getCacheSize() ) );
+}
+
+template<typename T>
+std::shared_ptr<TiledSurfaceT<T> > TiledSurfaceT<T>::create( ImageSourceRef imageSource, const Format &format )
+{
+	std::shared_ptr<TiledSurfaceT<T> > result = create( imageSource->getWidth(), imageSource->getHeight(), imageSource->hasAlpha(), format );
+	ImageTargetRef target = result->createImageTarget();
+	imageSource->load( target );
+	target->finalize();
+	return result;
+}
+
+template<typename T>
+std::shared_ptr<TiledSurfaceT<T> > TiledSurfaceT<T>::open( const fs::path &path, size_t cacheSize )
+{
+	std::shared_ptr<File> file( new File( path, false, NULL, 0 ) );
+	const TileFileHeader &header = file->mHeader;
+	if( ! std::equal( TILE_FILE_MAGIC, TILE_FILE_MAGIC + 4, header.mMagic ) || header.mVersion != TILE_FILE_VERSION )
+		throw TiledSurfaceExc( path.string() + " is not a tile file" );
+	if( header.mBytesPerChannel != sizeof(T) || header.mIsFloat != ( boost::is_same<T,float>::value ? 1u : 0u ) )
+		throw TiledSurfaceExc( path.string() + " holds a different pixel type" );
+	if( header.mWidth <= 0 || header.mHeight <= 0 || header.mTileSize <= 0 || header.mChannelOrder < 0 || header.mChannelOrder >= SurfaceChannelOrder::UNSPECIFIED )
+		throw TiledSurfaceExc( path.string() + " is corrupt" );
+
+	return std::shared_ptr<TiledSurfaceT<T> >( new TiledSurfaceT<T>( file, cacheSize ) );
+}
+
+template<typename T>
+TiledSurfaceT<T>::TiledSurfaceT( const std::shared_ptr<File> &file, size_t cacheSize )
+	: mFile( file ), mCacheSize( cacheSize )
+{
+	const TileFileHeader &header = mFile->mHeader;
+	mWidth = header.mWidth;
+	mHeight = header.mHeight;
+	mTileSize = header.mTileSize;
+	mNumTilesX = ( mWidth + mTileSize - 1 ) / mTileSize;
+	mNumTilesY = ( mHeight + mTileSize - 1 ) / mTileSize;
+	mChannelOrder = SurfaceChannelOrder( header.mChannelOrder );
+	mTileBytes = (size_t)mTileSize * mTileSize * mChannelOrder.getPixelInc() * sizeof(T);
+}
+
+template<typename T>
+const fs::path& TiledSurfaceT<T>::getPath() const
+{
+	return mFile->mPath;
+}
+
+template<typename T>
+Area TiledSurfaceT<T>::getTileArea( int32_t tileX, int32_t tileY ) const
+{
+	return Area( tileX * mTileSize, tileY * mTileSize, std::min( ( tileX + 1 ) * mTileSize, mWidth ), std::min( ( tileY + 1 ) * mTileSize, mHeight ) );
+}
+
+template<typename T>
+std::shared_ptr<typename TiledSurfaceT<T>::Tile> TiledSurfaceT<T>::lockTile( int32_t tileX, int32_t tileY ) const
+{
+	const int64_t index = (int64_t)tileY * mNumTilesX + tileX;
+
+	std::lock_guard<std::mutex> lock( mCacheMutex );
+	typename std::map<int64_t,typename TileList::iterator>::iterator cached = mCachedTileMap.find( index );
+	if( cached != mCachedTileMap.end() ) {
+		mCachedTiles.splice( mCachedTiles.begin(), mCachedTiles, cached->second );
+		return cached->second->second;
+	}
+
+	std::shared_ptr<Tile> tile( new Tile( mFile, TILE_FILE_HEADER_SIZE + (uint64_t)index * mTileBytes, mTileBytes ) );
+	mCachedTiles.push_front( std::make_pair( index, tile ) );
+	mCachedTileMap[index] = mCachedTiles.begin();
+	evict();
+	return tile;
+}
+
+// requires mCacheMutex; always keeps the most recently used tile
+template<typename T>
+void TiledSurfaceT<T>::evict() const
+{
+	while( mCachedTiles.size() > 1 && mCachedTiles.size() * mTileBytes > mCacheSize ) {
+		mCachedTileMap.erase( mCachedTiles.back().first );
+		mCachedTiles.pop_back();
+	}
+}
+
+template<typename T>
+void TiledSurfaceT<T>::tileDeallocator( void *refcon )
+{
+	delete reinterpret_cast<std::shared_ptr<Tile>*>( refcon );
+}
+
+template<typename T>
+SurfaceT<T> TiledSurfaceT<T>::getTile( int32_t tileX, int32_t tileY ) const
+{
+	std::shared_ptr<Tile> tile = lockTile( tileX, tileY );
+	const Area area = getTileArea( tileX, tileY );
+	SurfaceT<T> result( tile->mData, area.getWidth(), area.getHeight(), mTileSize * mChannelOrder.getPixelInc() * sizeof(T), mChannelOrder );
+	result.setDeallocator( tileDeallocator, new std::shared_ptr<Tile>( tile ) );
+	return result;
+}
+
+template<typename T>
+void TiledSurfaceT<T>::copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset )
+{
+	const Area dstArea = ( srcArea.getClipBy( srcSurface.getBounds() ) + relativeOffset ).getClipBy( getBounds() );
+	if( dstArea.getWidth() <= 0 || dstArea.getHeight() <= 0 )
+		return;
+
+	const Area tiles( dstArea.x1 / mTileSize * mTileSize, dstArea.y1 / mTileSize * mTileSize, dstArea.x2, dstArea.y2 );
+	TaskPool::get()->parallelFor( tiles, Vec2i( mTileSize, mTileSize ), [&]( const Area &tileArea ) {
+		const Area piece = tileArea.getClipBy( dstArea );
+		SurfaceT<T> tile = getTile( tileArea.x1 / mTileSize, tileArea.y1 / mTileSize );
+		tile.copyFrom( srcSurface, piece - relativeOffset, relativeOffset - tileArea.getUL() );
+	} );
+}
+
+template<typename T>
+void TiledSurfaceT<T>::copyTo( SurfaceT<T> *dstSurface, const Area &area, const Vec2i &relativeOffset ) const
+{
+	const Area srcArea = area.getClipBy( getBounds() ).getClipBy( dstSurface->getBounds() - relativeOffset );
+	if( srcArea.getWidth() <= 0 || srcArea.getHeight() <= 0 )
+		return;
+
+	const Area tiles( srcArea.x1 / mTileSize * mTileSize, srcArea.y1 / mTileSize * mTileSize, srcArea.x2, srcArea.y2 );
+	TaskPool::get()->parallelFor( tiles, Vec2i( mTileSize, mTileSize ), [&]( const Area &tileArea ) {
+		const Area piece = tileArea.getClipBy( srcArea );
+		const SurfaceT<T> tile = getTile( tileArea.x1 / mTileSize, tileArea.y1 / mTileSize );
+		dstSurface->copyFrom( tile, piece - tileArea.getUL(), tileArea.getUL() + relativeOffset );
+	} );
+}
+
+template<typename T>
+SurfaceT<T> TiledSurfaceT<T>::getSurface( const Area &area ) const
+{
+	const Area clippedArea = area.getClipBy( getBounds() );
+	SurfaceT<T> result( clippedArea.getWidth(), clippedArea.getHeight(), hasAlpha(), mChannelOrder );
+	copyTo( &result, clippedArea, -clippedArea.getUL() );
+	return result;
+}
+
+template<typename T>
+ImageTargetRef TiledSurfaceT<T>::createImageTarget()
+{
+	return ImageTargetRef( new ImageTargetTiledSurface<T>( this ) );
+}
+
+template<typename T>
+void TiledSurfaceT<T>::flush()
+{
+	std::lock_guard<std::mutex> lock( mCacheMutex );
+	for( typename TileList::iterator tileIt = mCachedTiles.begin(); tileIt != mCachedTiles.end(); ++tileIt )
+		File::flush( tileIt->second->mView, tileIt->second->mViewSize );
+}
+
+template<typename T>
+void TiledSurfaceT<T>::setCacheSize( size_t bytes )
+{
+	std::lock_guard<std::mutex> lock( mCacheMutex );
+	mCacheSize = bytes;
+	evict();
+}
+
+template<typename T>
+std::vector<std::shared_ptr<TiledSurfaceT<T> > > buildPyramid( const std::shared_ptr<TiledSurfaceT<T> > &surface, int32_t minSize, const FilterBase &filter )
+{
+	std::vector<std::shared_ptr<TiledSurfaceT<T> > > result( 1, surface );
+	minSize = std::max<int32_t>( minSize, 1 );
+	while( result.back()->getWidth() > minSize || result.back()->getHeight() > minSize ) {
+		const TiledSurfaceT<T> &previous = *result.back();
+		typename TiledSurfaceT<T>::Format format = typename TiledSurfaceT<T>::Format().tileSize( previous.getTileSize() ).cacheSize( previous.getCacheSize() ).channelOrder( previous.getChannelOrder() );
+		std::shared_ptr<TiledSurfaceT<T> > level = TiledSurfaceT<T>::create( ( previous.getWidth() + 1 ) / 2, ( previous.getHeight() + 1 ) / 2, previous.hasAlpha(), format );
+		ip::resize( previous, previous.getBounds(), level.get(), level->getBounds(), filter );
+		result.push_back( level );
+	}
+
+	return result;
+}
+
+template<typename T>
+void writeDeepZoom( const std::shared_ptr<TiledSurfaceT<T> > &surface, const fs::path &dziPath, const DeepZoomFormat &format )
+{
+	const int32_t tileSize = format.getTileSize(), overlap = format.getOverlap();
+	const std::string descriptor = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"" + format.getExtension() + "\" Overlap=\"" + toString( overlap ) + "\" TileSize=\"" + toString( tileSize ) + "\">\n"
+		"\t<Size Width=\"" + toString( surface->getWidth() ) + "\" Height=\"" + toString( surface->getHeight() ) + "\"/>\n"
+		"</Image>\n";
+	writeFileStream( dziPath )->writeData( descriptor.data(), descriptor.size() );
+
+	// Deep Zoom numbers the levels from the 1x1 one up to the full image
+	const fs::path filesPath = dziPath.parent_path() / ( dziPath.stem().string() + "_files" );
+	std::vector<std::shared_ptr<TiledSurfaceT<T> > > pyramid = buildPyramid( surface );
+	for( size_t level = 0; level < pyramid.size(); ++level ) {
+		const TiledSurfaceT<T> &levelSurface = *pyramid[pyramid.size() - 1 - level];
+		const fs::path levelPath = filesPath / toString( level );
+		fs::create_directories( levelPath );
+		for( int32_t row = 0; row * tileSize < levelSurface.getHeight(); ++row ) {
+			for( int32_t col = 0; col * tileSize < levelSurface.getWidth(); ++col ) {
+				const Area area( col * tileSize - ( col > 0 ? overlap : 0 ), row * tileSize - ( row > 0 ? overlap : 0 ), ( col + 1 ) * tileSize + overlap, ( row + 1 ) * tileSize + overlap );
+				writeImage( levelPath / ( toString( col ) + "_" + toString( row ) + "." + format.getExtension() ), levelSurface.getSurface( area ), format.getOptions(), format.getExtension() );
+			}
+		}
+	}
+}
+
+#define TiledSurface_PROTOTYPES(r,data,T)\
+	template class TiledSurfaceT<T>;
+
+#define TiledSurface_PYRAMID_PROTOTYPES(r,data,T)\
+	template std::vector<std::shared_ptr<TiledSurfaceT<T> > > buildPyramid( const std::shared_ptr<TiledSurfaceT<T> > &surface, int32_t minSize, const FilterBase &filter ); \
+	template void writeDeepZoom( const std::shared_ptr<TiledSurfaceT<T> > &surface, const fs::path &dziPath, const DeepZoomFormat &format );
+
+BOOST_PP_SEQ_FOR_EACH( TiledSurface_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+// ip::resize() is only instantiated for CHANNEL_TYPES
+BOOST_PP_SEQ_FOR_EACH( TiledSurface_PYRAMID_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} // namespace cinder
@@ -24,6 +24,7 @@
 
 #include "cinder/Timeline.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace std;
@@ -36,16 +37,20 @@ typedef std::multimap<void*,TimelineItemRef>::iterator s_iter;
 typedef std::multimap<void*,TimelineItemRef>::const_iterator s_const_iter;
 
 Timeline::Timeline()
-	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 )
+	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 ),
+		mScheduled( false ), mScheduleDirty( true ), mBatched( false ), mSteppingItems( false ), mNeedsEraseScan( false ), mScheduleTime( 0 ), mScheduleSequence( 0 ), mInsertSequence( 0 ), mSteppingItem( 0 )
 {
 	mUseAbsoluteTime = true;
 }
 
 Timeline::Timeline( const Timeline &rhs )
-	: TimelineItem( rhs ), mDefaultAutoRemove( rhs.mDefaultAutoRemove ), mCurrentTime( rhs.mCurrentTime )
+	: TimelineItem( rhs ), mDefaultAutoRemove( rhs.mDefaultAutoRemove ), mCurrentTime( rhs.mCurrentTime ),
+		mScheduled( rhs.mScheduled ), mScheduleDirty( true ), mBatched( rhs.mBatched ), mSteppingItems( false ), mNeedsEraseScan( false ), mScheduleTime( rhs.mScheduleTime ), mScheduleSequence( 0 ), mInsertSequence( 0 ), mSteppingItem( 0 )
 {
 	for( s_const_iter iter = rhs.mItems.begin(); iter != rhs.mItems.end(); ++iter ) {
-		mItems.insert( make_pair( iter->first, iter->second->clone() ) );
+		TimelineItemRef cloned = iter->second->clone();
+		cloned->mParent = this;
+		insertItem( cloned );
 	}
 }
 
@@ -59,20 +64,260 @@ void Timeline::stepTo( float absoluteTime )
 {	
 	bool reverse = mCurrentTime > absoluteTime;
 	mCurrentTime = absoluteTime;
+
+	if( mScheduled ) {
+		if( absoluteTime >= mScheduleTime ) {
+			stepScheduled();
+			return;
+		}
+		// stepping backwards can restart any item, so all of them are evaluated and the schedule is rebuilt on the next step forward
+		unscheduleAll();
+		mScheduleDirty = true;
+	}
 	
 	eraseMarked();
 	
 	// we need to cache the end(). If a tween's update() fn or similar were to manipulate
 	// the list of items by adding new ones, we'll have invalidated our iterator.
 	// Deleted items are never removed immediately, but are marked for deletion.
+	mSteppingItems = true;
 	s_iter endItem = mItems.end();
 	for( s_iter iter = mItems.begin(); iter != endItem; ++iter ) {
 		iter->second->stepTo( mCurrentTime, reverse );
 		if( iter->second->isComplete() && iter->second->getAutoRemove() )
 			iter->second->mMarkedForRemoval = true;
 	}
+	mSteppingItems = false;
 	
-	eraseMarked();	
+	eraseMarked();
+	mScheduleTime = mCurrentTime;
+}
+
+// Active items are kept in the order of mItems, by target and then insertion, so that they're stepped in the same order as by an unscheduled Timeline
+bool Timeline::itemOrder( const TimelineItemRef &lhs, const TimelineItemRef &rhs )
+{
+	return itemBefore( lhs.get(), rhs.get() );
+}
+
+bool Timeline::itemBefore( const TimelineItem *lhs, const TimelineItem *rhs )
+{
+	if( lhs->mTarget != rhs->mTarget )
+		return std::less<void*>()( lhs->mTarget, rhs->mTarget );
+	return lhs->mSlot.mInsertSequence < rhs->mSlot.mInsertSequence;
+}
+
+void Timeline::stepScheduled()
+{
+	if( mScheduleDirty )
+		rebuildSchedule();
+	if( mNeedsEraseScan )
+		eraseMarked();
+
+	// activate the pending items whose start time has been reached, skipping entries superseded by a change of start time
+	while( ( ! mPending.empty() ) && ( mPending.front().mStartTime <= mCurrentTime ) ) {
+		std::pop_heap( mPending.begin(), mPending.end() );
+		TimelineItemRef item = mPending.back().mItem;
+		const uint64_t sequence = mPending.back().mSequence;
+		mPending.pop_back();
+		if( item->mSlot.mPendingSequence != sequence )
+			continue;
+
+		item->mSlot.mPendingSequence = 0;
+		if( item->mMarkedForRemoval )
+			item->mSlot.mIsScheduled = false;
+		else {
+			if( ! mTweenBatch.empty() )
+				unbatchTarget( item->mTarget );
+			mActivated.push_back( item );
+		}
+	}
+
+	mergeActivated();
+
+	// Items that remain active are compacted towards the front. Items activated by callbacks that come after the current item
+	// are appended, so mActive is indexed rather than iterated; the others wait in mActivated for the next step.
+	const size_t numPreviouslyActive = mActive.size();
+	size_t numActive = 0, numKeptPreviouslyActive = 0;
+
+	// Batched items are updated once the items without a target, such as Cues, have been stepped, which is where they'd be in order.
+	// Those that have reached their end time are appended, to be stepped individually and complete.
+	bool stepBatch = ! mTweenBatch.empty();
+	size_t batchIndex = 0;
+	while( ( batchIndex < mActive.size() ) && ( mActive[batchIndex]->mTarget == 0 ) )
+		++batchIndex;
+
+	for( size_t i = 0; ( i < mActive.size() ) || stepBatch; ++i ) {
+		if( stepBatch && ( i == batchIndex ) ) {
+			stepBatch = false;
+			mTweenBatch.stepTo( mCurrentTime, &mActive );
+			if( i == mActive.size() )
+				break;
+		}
+
+		if( i == numPreviouslyActive )
+			numKeptPreviouslyActive = numActive;
+
+		TimelineItem *item = mActive[i].get();
+		bool keep = false, batched = false;
+		if( ! item->mMarkedForRemoval ) {
+			if( item->mStartTime > mCurrentTime ) { // moved later since it was activated
+				pushPending( mActive[i] );
+				continue;
+			}
+
+			mSteppingItem = item;
+			item->stepTo( mCurrentTime, false );
+			// the item may also have been removed by one of its callbacks
+			if( item->isComplete() && item->getAutoRemove() )
+				removeItem( item );
+			keep = ! ( item->isComplete() || item->mMarkedForRemoval );
+			if( keep && mBatched && item->canBatch() && isSoleActiveItem( item ) ) {
+				item->addToBatch( &mTweenBatch );
+				keep = false;
+				batched = true;
+			}
+		}
+
+		if( keep ) {
+			if( numActive != i )
+				mActive[numActive] = std::move( mActive[i] );
+			++numActive;
+		}
+		else if( ! batched )
+			item->mSlot.mIsScheduled = false;
+	}
+	mSteppingItem = 0;
+	if( mActive.size() == numPreviouslyActive )
+		numKeptPreviouslyActive = numActive;
+	mActive.resize( numActive );
+
+	// restore the order of the items activated during the pass
+	if( numKeptPreviouslyActive < numActive ) {
+		std::sort( mActive.begin() + numKeptPreviouslyActive, mActive.end(), itemOrder );
+		std::inplace_merge( mActive.begin(), mActive.begin() + numKeptPreviouslyActive, mActive.end(), itemOrder );
+	}
+
+	mScheduleTime = mCurrentTime;
+}
+
+void Timeline::mergeActivated()
+{
+	if( mActivated.empty() )
+		return;
+
+	const size_t numActive = mActive.size();
+	std::sort( mActivated.begin(), mActivated.end(), itemOrder );
+	mActive.insert( mActive.end(), mActivated.begin(), mActivated.end() );
+	mActivated.clear();
+	std::inplace_merge( mActive.begin(), mActive.begin() + numActive, mActive.end(), itemOrder );
+}
+
+void Timeline::activateItem( const TimelineItemRef &item )
+{
+	// an item activated on a batched item's target is ordered with it as usual
+	if( ! mTweenBatch.empty() )
+		unbatchTarget( item->mTarget );
+
+	if( mSteppingItem && itemBefore( mSteppingItem, item.get() ) )
+		mActive.push_back( item );
+	else
+		mActivated.push_back( item );
+}
+
+void Timeline::unbatchItem( TimelineItem *item )
+{
+	mTweenBatch.remove( item );
+	if( item->mSlot.mInItems )
+		activateItem( item->mSlot.mItemsIt->second );
+}
+
+void Timeline::unbatchTarget( void *target )
+{
+	pair<s_iter,s_iter> range = mItems.equal_range( target );
+	for( s_iter iter = range.first; iter != range.second; ++iter ) {
+		if( TweenBatch::isBatched( iter->second.get() ) )
+			unbatchItem( iter->second.get() );
+	}
+}
+
+bool Timeline::isSoleActiveItem( const TimelineItem *item ) const
+{
+	pair<s_const_iter,s_const_iter> range = mItems.equal_range( item->mTarget );
+	for( s_const_iter iter = range.first; iter != range.second; ++iter ) {
+		const TimelineItem *other = iter->second.get();
+		if( ( other != item ) && other->mSlot.mIsScheduled && ( other->mSlot.mPendingSequence == 0 ) && ( ! other->mMarkedForRemoval ) )
+			return false;
+	}
+
+	return true;
+}
+
+void Timeline::setBatched( bool batched )
+{
+	if( mBatched == batched )
+		return;
+
+	mBatched = batched;
+	if( ! mBatched )
+		mTweenBatch.clear( &mActivated );
+}
+
+void Timeline::setScheduled( bool scheduled )
+{
+	if( mScheduled == scheduled )
+		return;
+
+	eraseMarked();
+	unscheduleAll();
+	mScheduled = scheduled;
+	mScheduleDirty = true;
+	mScheduleTime = mCurrentTime;
+}
+
+void Timeline::scheduleItem( const TimelineItemRef &item )
+{
+	if( ( ! mScheduled ) || mScheduleDirty || item->mSlot.mIsScheduled )
+		return;
+
+	item->mSlot.mIsScheduled = true;
+	if( item->mStartTime <= mCurrentTime )
+		activateItem( item );
+	else
+		pushPending( item );
+}
+
+void Timeline::pushPending( const TimelineItemRef &item )
+{
+	item->mSlot.mPendingSequence = ++mScheduleSequence;
+	mPending.push_back( PendingItem( item->mStartTime, item->mSlot.mPendingSequence, item ) );
+	std::push_heap( mPending.begin(), mPending.end() );
+}
+
+void Timeline::unscheduleAll()
+{
+	mTweenBatch.clear( &mActivated );
+	for( vector<TimelineItemRef>::iterator activeIt = mActive.begin(); activeIt != mActive.end(); ++activeIt )
+		(*activeIt)->mSlot.mIsScheduled = false;
+	for( vector<TimelineItemRef>::iterator activatedIt = mActivated.begin(); activatedIt != mActivated.end(); ++activatedIt )
+		(*activatedIt)->mSlot.mIsScheduled = false;
+	for( vector<PendingItem>::iterator pendingIt = mPending.begin(); pendingIt != mPending.end(); ++pendingIt ) {
+		pendingIt->mItem->mSlot.mIsScheduled = false;
+		pendingIt->mItem->mSlot.mPendingSequence = 0;
+	}
+	mActive.clear();
+	mActivated.clear();
+	mPending.clear();
+}
+
+// Completed items are scheduled too; they're dropped again after the first step
+void Timeline::rebuildSchedule()
+{
+	unscheduleAll();
+	mScheduleDirty = false;
+	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
+		if( ! iter->second->mMarkedForRemoval )
+			scheduleItem( iter->second );
+	}
 }
 
 CueRef Timeline::add( const std::function<void ()> &action, float atTime )
@@ -85,6 +330,9 @@ CueRef Timeline::add( const std::function<void ()> &action, float atTime )
 
 void Timeline::clear()
 {
+	unscheduleAll();
+	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
+		iter->second->mSlot.mInItems = false;
 	mItems.clear();	
 }
 
@@ -100,7 +348,9 @@ void Timeline::appendPingPong()
 	}
 	
 	for( vector<TimelineItemRef>::const_iterator appIt = toAppend.begin(); appIt != toAppend.end(); ++appIt ) {
-		mItems.insert( make_pair( (*appIt)->mTarget, *appIt ) );
+		(*appIt)->mParent = this;
+		insertItem( *appIt );
+		scheduleItem( *appIt );
 	}
 	
 	setDurationDirty();
@@ -117,23 +367,59 @@ void Timeline::add( TimelineItemRef item )
 {
 	item->mParent = this;
 	item->mStartTime = mCurrentTime;
-	mItems.insert( make_pair( item->mTarget, item ) );
+	insertItem( item );
+	scheduleItem( item );
 	setDurationDirty();
 }
 
 void Timeline::insert( TimelineItemRef item )
 {
 	item->mParent = this;
-	mItems.insert( make_pair( item->mTarget, item ) );
+	insertItem( item );
+	scheduleItem( item );
+	setDurationDirty();
+}
+
+void Timeline::insertItem( const TimelineItemRef &item )
+{
+	item->mSlot.mItemsIt = mItems.insert( make_pair( item->mTarget, item ) );
+	item->mSlot.mInItems = true;
+	item->mSlot.mInsertSequence = ++mInsertSequence;
+}
+
+void Timeline::eraseItem( TimelineItem *item )
+{
+	if( ! item->mSlot.mInItems )
+		return;
+
+	item->mSlot.mInItems = false;
+	mItems.erase( item->mSlot.mItemsIt );
 	setDurationDirty();
 }
 
+void Timeline::removeItem( TimelineItem *item )
+{
+	if( item->mMarkedForRemoval )
+		return;
+
+	item->mMarkedForRemoval = true;
+	if( TweenBatch::isBatched( item ) ) {
+		mTweenBatch.remove( item );
+		item->mSlot.mIsScheduled = false;
+	}
+	if( mScheduled && ( ! mSteppingItems ) && item->mSlot.mInItems && ( item->mParent == this ) )
+		eraseItem( item );
+	else
+		mNeedsEraseScan = true;
+}
+
 // remove all items which have been marked for removal
 void Timeline::eraseMarked()
 {
 	bool needRecalc = false;
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ) {
 		if( iter->second->mMarkedForRemoval ) {
+			iter->second->mSlot.mInItems = false;
 			mItems.erase( iter++ );
 			needRecalc = true;
 		}
@@ -141,6 +427,7 @@ void Timeline::eraseMarked()
 			++iter;
 	}
 	
+	mNeedsEraseScan = false;
 	if( needRecalc )
 		setDurationDirty();
 }	
@@ -158,20 +445,19 @@ float Timeline::calcDuration() const
 
 TimelineItemRef Timeline::find( void *target ) const
 {
-	s_const_iter iter = mItems.begin();
-	while( iter != mItems.end() ) {
-		if( iter->second->getTarget() == target )
-			return iter->second;
-		++iter;
-	}
+	s_const_iter iter = mItems.find( target );
+	if( iter != mItems.end() )
+		return iter->second;
 	
 	return TimelineItemRef(); // failed returns null tween
 }
 
 TimelineItemRef Timeline::findLast( void *target ) const
 {
+	pair<s_const_iter,s_const_iter> range = mItems.equal_range( target );
+
 	s_const_iter result = mItems.end();
-	for( s_const_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
+	for( s_const_iter iter = range.first; iter != range.second; ++iter ) {
 		if( iter->second->getTarget() == target && ( ! iter->second->mMarkedForRemoval ) ) {
 			if( result == mItems.end() )
 				result = iter;
@@ -231,12 +517,8 @@ float Timeline::findEndTimeOf( void *target, bool *found ) const
 
 void Timeline::remove( TimelineItemRef item )
 {
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
-		if( iter->second == item ) {
-			iter->second->mMarkedForRemoval = true;
-			break;
-		}
-	}
+	if( item && item->mSlot.mInItems && ( item->mParent == this ) )
+		removeItem( item.get() );
 }
 
 void Timeline::removeTarget( void *target )
@@ -244,9 +526,12 @@ void Timeline::removeTarget( void *target )
 	if( target == 0 )
 		return;
 		
+	// removeItem() may erase the item, so the iterator is advanced first
 	pair<s_iter,s_iter> range = mItems.equal_range( target );
-	for( s_iter iter = range.first; iter != range.second; ++iter )
-		iter->second->mMarkedForRemoval = true;
+	for( s_iter iter = range.first; iter != range.second; ) {
+		TimelineItem *item = ( iter++ )->second.get();
+		removeItem( item );
+	}
 
 	setDurationDirty();
 }
@@ -265,8 +550,11 @@ void Timeline::cloneAndReplaceTarget( void *target, void *replacementTarget )
 		newItems.back()->setTarget( replacementTarget );
 	}
 
-	for( vector<TimelineItemRef>::iterator newItemIt = newItems.begin(); newItemIt != newItems.end(); ++newItemIt )
-		mItems.insert( make_pair( replacementTarget, *newItemIt ) );
+	for( vector<TimelineItemRef>::iterator newItemIt = newItems.begin(); newItemIt != newItems.end(); ++newItemIt ) {
+		(*newItemIt)->mParent = this;
+		insertItem( *newItemIt );
+		scheduleItem( *newItemIt );
+	}
 
 	setDurationDirty();
 }
@@ -280,10 +568,15 @@ void Timeline::replaceTarget( void *target, void *replacementTarget )
 	for( s_iter iter = range.first; iter != range.second; ) {
 		s_iter oldIter = iter;
 		++iter;
-		oldIter->second->setTarget( replacementTarget );
-		mItems.insert( make_pair( replacementTarget, oldIter->second ) );
+		TimelineItemRef item = oldIter->second;
+		item->setTarget( replacementTarget );
 		mItems.erase( oldIter );
+		insertItem( item );
 	}
+
+	// the replacement target may have had a batched item of its own, which is now joined by the items that were moved
+	if( ! mTweenBatch.empty() )
+		unbatchTarget( replacementTarget );
 }
 
 void Timeline::reset( bool unsetStarted )
@@ -292,6 +585,8 @@ void Timeline::reset( bool unsetStarted )
 	
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
 		iter->second->reset( unsetStarted );
+	mScheduleDirty = true;
+	mScheduleTime = mCurrentTime;
 }
 
 
@@ -304,6 +599,7 @@ void Timeline::reverse()
 {
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
 		iter->second->reverse();
+	mScheduleDirty = true;
 }
 
 TimelineItemRef Timeline::clone() const
@@ -330,6 +626,26 @@ void Timeline::update( float absTime )
 void Timeline::itemTimeChanged( TimelineItem *item )
 {
 	setDurationDirty();
+	if( ( ! mScheduled ) || mScheduleDirty || ( ! item->mSlot.mInItems ) || ( item->mParent != this ) )
+		return;
+	if( TweenBatch::isBatched( item ) ) {
+		unbatchItem( item );
+		return;
+	}
+
+	// a pending item is requeued at its new start time, superseding its old entry, and a completed one is reactivated.
+	// Active items whose start time moves ahead are requeued when next stepped.
+	const TimelineItemRef &itemRef = item->mSlot.mItemsIt->second;
+	if( item->mSlot.mPendingSequence ) {
+		if( item->mStartTime <= mCurrentTime ) {
+			item->mSlot.mPendingSequence = 0;
+			activateItem( itemRef );
+		}
+		else
+			pushPending( itemRef );
+	}
+	else
+		scheduleItem( itemRef );
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
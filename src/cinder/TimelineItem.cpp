@@ -44,7 +44,15 @@ TimelineItem::TimelineItem( Timeline *parent, void *target, float startTime, flo
 
 void TimelineItem::removeSelf()
 {
-	mMarkedForRemoval = true;
+	if( mParent )
+		mParent->removeItem( this );
+	else
+		mMarkedForRemoval = true;
+}
+
+void TimelineItem::unbatchFromParent()
+{
+	mParent->unbatchItem( this );
 }
 
 void TimelineItem::stepTo( float newTime, bool reverse )
@@ -0,0 +1,655 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TreeCache.h"
+#include "cinder/Stream.h"
+#include "cinder/Utilities.h"
+#include "cinder/svg/Svg.h"
+
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+
+using namespace std;
+
+namespace cinder {
+
+// Layout, all integers little endian:
+//	header:		FileHeader
+//	nodes:		a NodeRecord per node in breadth-first order, so that the children of each node are contiguous; the root is first
+//	attributes:	an AttrRecord per attribute, those of each node contiguous
+//	offsets:	numStrings + 1 uint32 offsets into the string data, the last being its size
+//	strings:	every unique string, null terminated; string 0 is empty
+
+namespace {
+
+const char		TREE_MAGIC[4] = { 'C', 'I', 'B', 'T' };
+const uint32_t	TREE_VERSION = 1;
+const uint32_t	NO_PARENT = 0xFFFFFFFF;
+
+struct FileHeader {
+	char		mMagic[4];
+	uint32_t	mVersion;
+	uint32_t	mSourceType;
+	uint32_t	mDocType;
+	uint64_t	mSourceHash;
+	uint32_t	mNumNodes;
+	uint32_t	mNumAttributes;
+	uint32_t	mNumStrings;
+	uint32_t	mStringDataSize;
+	uint8_t		mReserved[24];
+};
+
+struct NodeRecord {
+	uint32_t	mName, mValue;
+	uint32_t	mParent;
+	uint32_t	mFirstChild, mNumChildren;
+	uint32_t	mFirstAttribute, mNumAttributes;
+	uint8_t		mNodeType, mValueType;
+	uint16_t	mReserved;
+};
+
+struct AttrRecord {
+	uint32_t	mName, mValue;
+};
+
+static_assert( sizeof( FileHeader ) == 64, "unexpected FileHeader size" );
+static_assert( sizeof( NodeRecord ) == 32, "unexpected NodeRecord size" );
+static_assert( sizeof( AttrRecord ) == 8, "unexpected AttrRecord size" );
+
+class Encoder {
+  public:
+	Encoder()
+	{
+		intern( string() );
+	}
+
+	uint32_t intern( const string &s )
+	{
+		pair<unordered_map<string,uint32_t>::iterator, bool> inserted = mStringIndices.insert( make_pair( s, (uint32_t)mStringOffsets.size() ) );
+		if( inserted.second ) {
+			if( mStringData.size() + s.size() + 1 > 0xFFFFFFFF )
+				throw BinaryTreeExc( "BinaryTree string table exceeds 4 GB" );
+			mStringOffsets.push_back( (uint32_t)mStringData.size() );
+			mStringData.append( s );
+			mStringData.push_back( 0 );
+		}
+		return inserted.first->second;
+	}
+
+	Buffer finish( BinaryTree::SourceType sourceType, const string &docType, uint64_t sourceHash )
+	{
+		FileHeader header;
+		memset( &header, 0, sizeof( header ) );
+		memcpy( header.mMagic, TREE_MAGIC, sizeof( TREE_MAGIC ) );
+		header.mVersion = TREE_VERSION;
+		header.mSourceType = sourceType;
+		header.mDocType = intern( docType );
+		header.mSourceHash = sourceHash;
+		header.mNumNodes = (uint32_t)mNodes.size();
+		header.mNumAttributes = (uint32_t)mAttributes.size();
+		header.mNumStrings = (uint32_t)mStringOffsets.size();
+		header.mStringDataSize = (uint32_t)mStringData.size();
+		mStringOffsets.push_back( (uint32_t)mStringData.size() );
+
+		const size_t nodesSize = mNodes.size() * sizeof( NodeRecord ), attributesSize = mAttributes.size() * sizeof( AttrRecord ), offsetsSize = mStringOffsets.size() * sizeof( uint32_t );
+		Buffer result( sizeof( header ) + nodesSize + attributesSize + offsetsSize + mStringData.size() );
+		uint8_t *out = static_cast<uint8_t*>( result.getData() );
+		memcpy( out, &header, sizeof( header ) );
+		out += sizeof( header );
+		if( nodesSize )
+			memcpy( out, &mNodes[0], nodesSize );
+		out += nodesSize;
+		if( attributesSize )
+			memcpy( out, &mAttributes[0], attributesSize );
+		out += attributesSize;
+		memcpy( out, &mStringOffsets[0], offsetsSize );
+		out += offsetsSize;
+		memcpy( out, mStringData.data(), mStringData.size() );
+
+		return result;
+	}
+
+	vector<NodeRecord>	mNodes;
+	vector<AttrRecord>	mAttributes;
+
+  private:
+	unordered_map<string,uint32_t>	mStringIndices;
+	vector<uint32_t>				mStringOffsets;
+	string							mStringData;
+};
+
+// Stores \a root and its descendants breadth-first. \a describe fills in a node's name, value, types and attributes, and appends its children to the vector it's passed.
+template<typename T, typename DescribeFn>
+void flatten( const T &root, Encoder *encoder, const DescribeFn &describe )
+{
+	vector<const T*> nodes( 1, &root );
+	vector<uint32_t> parents( 1, NO_PARENT );
+	for( size_t i = 0; i < nodes.size(); ++i ) {
+		NodeRecord record;
+		memset( &record, 0, sizeof( record ) );
+		record.mParent = parents[i];
+		record.mFirstChild = (uint32_t)nodes.size();
+		record.mFirstAttribute = (uint32_t)encoder->mAttributes.size();
+		describe( *nodes[i], &record, &nodes );
+		record.mNumChildren = (uint32_t)nodes.size() - record.mFirstChild;
+		record.mNumAttributes = (uint32_t)encoder->mAttributes.size() - record.mFirstAttribute;
+		parents.resize( nodes.size(), (uint32_t)i );
+		encoder->mNodes.push_back( record );
+	}
+}
+
+void writeBuffer( const DataTargetRef &target, const Buffer &buffer )
+{
+	OStreamRef stream;
+	try {
+		stream = target->getStream();
+		if( stream )
+			stream->writeData( buffer.getData(), buffer.getDataSize() );
+	}
+	catch( std::exception &exc ) {
+		throw BinaryTreeExc( string( "failed writing BinaryTree: " ) + exc.what() );
+	}
+
+	if( ! stream )
+		throw BinaryTreeExc( "failed writing BinaryTree: couldn't open target" );
+}
+
+bool namesMatch( const char *name, size_t nameSize, const string &searchName, bool caseSensitive )
+{
+	if( nameSize != searchName.size() )
+		return false;
+	if( caseSensitive )
+		return memcmp( name, searchName.data(), nameSize ) == 0;
+
+	for( size_t i = 0; i < nameSize; ++i ) {
+		if( toupper( (unsigned char)name[i] ) != toupper( (unsigned char)searchName[i] ) )
+			return false;
+	}
+	return true;
+}
+
+bool isIndex( const string &pathComponent )
+{
+	for( string::const_iterator charIt = pathComponent.begin(); charIt != pathComponent.end(); ++charIt ) {
+		if( ! isdigit( (unsigned char)*charIt ) )
+			return false;
+	}
+	return ! pathComponent.empty();
+}
+
+// 64-bit FNV-1a applied to 8 bytes at a time, folding the upper half of the hash into the lower after each word so that every byte affects every bit.
+// This runs at memory speed, which is what makes hashing a source on every load cheap compared to parsing it.
+uint64_t hashData( const void *data, size_t size, uint64_t seed )
+{
+	const uint8_t *bytes = static_cast<const uint8_t*>( data );
+	uint64_t result = 14695981039346656037ULL ^ seed;
+	size_t i = 0;
+	for( ; i + 8 <= size; i += 8 ) {
+		uint64_t word;
+		memcpy( &word, bytes + i, sizeof( word ) );
+		result = ( result ^ word ) * 1099511628211ULL;
+		result ^= result >> 32;
+	}
+	for( ; i < size; ++i )
+		result = ( result ^ bytes[i] ) * 1099511628211ULL;
+
+	return result ^ size;
+}
+
+// The cache file is named after the source, with a hash of everything identifying it so that sources with the same name don't collide
+string getCacheFileName( const DataSourceRef &source, BinaryTree::SourceType sourceType, uint32_t options, uint64_t sourceHash )
+{
+	const fs::path path = source->isFilePath() ? source->getFilePath() : source->getFilePathHint();
+	ostringstream key;
+	if( path.empty() )
+		key << sourceHash;
+	else
+		key << path.string();
+	key << "|" << sourceType << "|" << options;
+	const string keyString = key.str();
+
+	ostringstream result;
+	result << ( path.empty() ? string( "tree" ) : getPathFileName( path.string() ) ) << "_" << hex << hashData( keyString.data(), keyString.size(), 0 ) << ".citree";
+	return result.str();
+}
+
+inline const NodeRecord* getNodeRecord( const void *record )
+{
+	return static_cast<const NodeRecord*>( record );
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////
+// BinaryTree::Node
+XmlTree::NodeType BinaryTree::Node::getXmlNodeType() const
+{
+	if( ( ! mTree ) || ( mTree->mSourceType != SOURCE_XML ) )
+		return XmlTree::NODE_UNKNOWN;
+
+	return (XmlTree::NodeType)getNodeRecord( mRecord )->mNodeType;
+}
+
+JsonTree::NodeType BinaryTree::Node::getJsonNodeType() const
+{
+	if( ( ! mTree ) || ( mTree->mSourceType != SOURCE_JSON ) )
+		return JsonTree::NODE_UNKNOWN;
+
+	return (JsonTree::NodeType)getNodeRecord( mRecord )->mNodeType;
+}
+
+const char* BinaryTree::Node::getName() const
+{
+	return mTree ? mTree->getString( getNodeRecord( mRecord )->mName ) : "";
+}
+
+size_t BinaryTree::Node::getNameSize() const
+{
+	return mTree ? mTree->getStringSize( getNodeRecord( mRecord )->mName ) : 0;
+}
+
+const char* BinaryTree::Node::getValue() const
+{
+	return mTree ? mTree->getString( getNodeRecord( mRecord )->mValue ) : "";
+}
+
+size_t BinaryTree::Node::getValueSize() const
+{
+	return mTree ? mTree->getStringSize( getNodeRecord( mRecord )->mValue ) : 0;
+}
+
+bool BinaryTree::Node::hasParent() const
+{
+	return mTree && ( getNodeRecord( mRecord )->mParent != NO_PARENT );
+}
+
+BinaryTree::Node BinaryTree::Node::getParent() const
+{
+	if( ! hasParent() )
+		return Node();
+
+	return Node( mTree, mTree->mNodes + getNodeRecord( mRecord )->mParent * sizeof( NodeRecord ) );
+}
+
+size_t BinaryTree::Node::getNumChildren() const
+{
+	return mTree ? getNodeRecord( mRecord )->mNumChildren : 0;
+}
+
+BinaryTree::Node BinaryTree::Node::getChild( size_t index ) const
+{
+	return Node( mTree, mTree->mNodes + ( getNodeRecord( mRecord )->mFirstChild + index ) * sizeof( NodeRecord ) );
+}
+
+BinaryTree::Node BinaryTree::Node::getChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	Node child = findChild( relativePath, caseSensitive, separator );
+	if( ! child.isValid() )
+		throw BinaryTreeExc( "could not find child: " + relativePath + " for node: " + getPath( separator ) );
+
+	return child;
+}
+
+BinaryTree::Node BinaryTree::Node::findChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	if( ! mTree )
+		return Node();
+
+	Node result = *this;
+	vector<string> pathComponents = split( relativePath, separator );
+	for( vector<string>::const_iterator pathIt = pathComponents.begin(); pathIt != pathComponents.end(); ++pathIt ) {
+		if( pathIt->empty() )
+			continue;
+
+		const size_t numChildren = result.getNumChildren();
+		Node child;
+		if( ( result.getJsonNodeType() == JsonTree::NODE_ARRAY ) && isIndex( *pathIt ) ) {
+			const size_t index = (size_t)strtoul( pathIt->c_str(), 0, 10 );
+			if( index < numChildren )
+				child = result.getChild( index );
+		}
+		else {
+			for( size_t i = 0; i < numChildren; ++i ) {
+				Node candidate = result.getChild( i );
+				if( namesMatch( candidate.getName(), candidate.getNameSize(), *pathIt, caseSensitive ) ) {
+					child = candidate;
+					break;
+				}
+			}
+		}
+
+		if( ! child.isValid() )
+			return Node();
+		result = child;
+	}
+
+	return result;
+}
+
+size_t BinaryTree::Node::getNumAttributes() const
+{
+	return mTree ? getNodeRecord( mRecord )->mNumAttributes : 0;
+}
+
+const char* BinaryTree::Node::getAttributeName( size_t index ) const
+{
+	const AttrRecord *attr = reinterpret_cast<const AttrRecord*>( mTree->mAttributes ) + getNodeRecord( mRecord )->mFirstAttribute + index;
+	return mTree->getString( attr->mName );
+}
+
+const char* BinaryTree::Node::getAttributeValue( size_t index ) const
+{
+	const AttrRecord *attr = reinterpret_cast<const AttrRecord*>( mTree->mAttributes ) + getNodeRecord( mRecord )->mFirstAttribute + index;
+	return mTree->getString( attr->mValue );
+}
+
+const char* BinaryTree::Node::findAttribute( const string &attrName ) const
+{
+	if( ! mTree )
+		return 0;
+
+	const NodeRecord *record = getNodeRecord( mRecord );
+	const AttrRecord *attrs = reinterpret_cast<const AttrRecord*>( mTree->mAttributes ) + record->mFirstAttribute;
+	for( uint32_t i = 0; i < record->mNumAttributes; ++i ) {
+		if( namesMatch( mTree->getString( attrs[i].mName ), mTree->getStringSize( attrs[i].mName ), attrName, true ) )
+			return mTree->getString( attrs[i].mValue );
+	}
+
+	return 0;
+}
+
+const char* BinaryTree::Node::getAttributeValueChecked( const string &attrName ) const
+{
+	const char *result = findAttribute( attrName );
+	if( ! result )
+		throw BinaryTreeExc( "could not find attribute: " + attrName + " for node: " + getPath() );
+
+	return result;
+}
+
+string BinaryTree::Node::getPath( char separator ) const
+{
+	string result;
+
+	for( Node node = *this; node.isValid(); node = node.getParent() ) {
+		string nodeName( node.getName(), node.getNameSize() );
+		if( node != *this )
+			nodeName += separator;
+		result = nodeName + result;
+	}
+
+	return result;
+}
+
+XmlTree BinaryTree::Node::toXmlTree() const
+{
+	if( ( ! mTree ) || ( mTree->mSourceType != SOURCE_XML ) )
+		throw BinaryTreeExc( "toXmlTree() requires a node of a BinaryTree written from XML" );
+
+	XmlTree result;
+	mTree->copyNode( *this, &result );
+	return result;
+}
+
+JsonTree BinaryTree::Node::toJsonTree() const
+{
+	if( ( ! mTree ) || ( mTree->mSourceType != SOURCE_JSON ) )
+		throw BinaryTreeExc( "toJsonTree() requires a node of a BinaryTree written from JSON" );
+
+	JsonTree result;
+	mTree->copyNode( *this, &result );
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// BinaryTree
+BinaryTreeRef BinaryTree::create( const fs::path &path )
+{
+	MemoryMappedFileRef mappedFile = MemoryMappedFile::create( path, sizeof( FileHeader ) );
+	if( ! mappedFile )
+		throw BinaryTreeExc( "failed to map BinaryTree file: " + path.string() );
+
+	return create( Buffer( mappedFile->getData(), mappedFile->getSize(), mappedFile ) );
+}
+
+BinaryTreeRef BinaryTree::create( const Buffer &buffer )
+{
+	return BinaryTreeRef( new BinaryTree( buffer ) );
+}
+
+BinaryTree::BinaryTree( const Buffer &buffer )
+	: mBuffer( buffer )
+{
+	const uint8_t *data = static_cast<const uint8_t*>( mBuffer.getData() );
+	const size_t size = mBuffer.getDataSize();
+	if( size < sizeof( FileHeader ) )
+		throw BinaryTreeExc( "BinaryTree data is truncated" );
+
+	FileHeader header;
+	memcpy( &header, data, sizeof( header ) );
+	if( memcmp( header.mMagic, TREE_MAGIC, sizeof( TREE_MAGIC ) ) != 0 || header.mVersion != TREE_VERSION || header.mSourceType > SOURCE_JSON )
+		throw BinaryTreeExc( "not a BinaryTree, or written by an incompatible version" );
+
+	// sizes are summed in 64 bits so that corrupt counts can't overflow
+	const uint64_t nodesSize = (uint64_t)header.mNumNodes * sizeof( NodeRecord ), attributesSize = (uint64_t)header.mNumAttributes * sizeof( AttrRecord );
+	const uint64_t offsetsSize = ( (uint64_t)header.mNumStrings + 1 ) * sizeof( uint32_t );
+	if( header.mNumNodes == 0 || header.mNumStrings == 0 || header.mDocType >= header.mNumStrings
+			|| (uint64_t)size < sizeof( FileHeader ) + nodesSize + attributesSize + offsetsSize + header.mStringDataSize )
+		throw BinaryTreeExc( "BinaryTree data is truncated" );
+
+	mSourceType = (SourceType)header.mSourceType;
+	mSourceHash = header.mSourceHash;
+	mDocType = header.mDocType;
+	mNumNodes = header.mNumNodes;
+	mNumAttributes = header.mNumAttributes;
+	mNumStrings = header.mNumStrings;
+	mNodes = data + sizeof( FileHeader );
+	mAttributes = mNodes + nodesSize;
+	mStringOffsets = reinterpret_cast<const uint32_t*>( mAttributes + attributesSize );
+	mStrings = reinterpret_cast<const char*>( mAttributes + attributesSize + offsetsSize );
+	if( mStringOffsets[mNumStrings] != header.mStringDataSize )
+		throw BinaryTreeExc( "BinaryTree string table is corrupt" );
+}
+
+void BinaryTree::write( const DataTargetRef &target, const XmlTree &xml, uint64_t sourceHash )
+{
+	writeBuffer( target, encode( xml, sourceHash ) );
+}
+
+void BinaryTree::write( const DataTargetRef &target, const JsonTree &json, uint64_t sourceHash )
+{
+	writeBuffer( target, encode( json, sourceHash ) );
+}
+
+Buffer BinaryTree::encode( const XmlTree &xml, uint64_t sourceHash )
+{
+	Encoder encoder;
+	flatten( xml, &encoder, [&encoder]( const XmlTree &node, NodeRecord *record, vector<const XmlTree*> *children ) {
+		record->mName = encoder.intern( node.getTag() );
+		record->mValue = encoder.intern( node.getValue() );
+		record->mNodeType = (uint8_t)node.getNodeType();
+		for( list<XmlTree::Attr>::const_iterator attrIt = node.getAttributes().begin(); attrIt != node.getAttributes().end(); ++attrIt ) {
+			AttrRecord attr = { encoder.intern( attrIt->getName() ), encoder.intern( attrIt->getValue() ) };
+			encoder.mAttributes.push_back( attr );
+		}
+		for( XmlTree::Container::const_iterator childIt = node.getChildren().begin(); childIt != node.getChildren().end(); ++childIt )
+			children->push_back( childIt->get() );
+	} );
+
+	return encoder.finish( SOURCE_XML, xml.getDocType(), sourceHash );
+}
+
+Buffer BinaryTree::encode( const JsonTree &json, uint64_t sourceHash )
+{
+	Encoder encoder;
+	flatten( json, &encoder, [&encoder]( const JsonTree &node, NodeRecord *record, vector<const JsonTree*> *children ) {
+		record->mName = encoder.intern( node.mKey );
+		record->mValue = encoder.intern( node.mValue );
+		record->mNodeType = (uint8_t)node.mNodeType;
+		record->mValueType = (uint8_t)node.mValueType;
+		for( JsonTree::ConstIter childIt = node.mChildren.begin(); childIt != node.mChildren.end(); ++childIt )
+			children->push_back( &*childIt );
+	} );
+
+	return encoder.finish( SOURCE_JSON, string(), sourceHash );
+}
+
+BinaryTree::Node BinaryTree::getRoot() const
+{
+	return Node( this, mNodes );
+}
+
+const char* BinaryTree::getDocType() const
+{
+	return getString( mDocType );
+}
+
+const char* BinaryTree::getString( uint32_t index ) const
+{
+	return mStrings + mStringOffsets[index];
+}
+
+size_t BinaryTree::getStringSize( uint32_t index ) const
+{
+	return mStringOffsets[index + 1] - mStringOffsets[index] - 1;
+}
+
+void BinaryTree::copyNode( const Node &node, XmlTree *result ) const
+{
+	result->setTag( string( node.getName(), node.getNameSize() ) );
+	result->setValue( string( node.getValue(), node.getValueSize() ) );
+	result->setNodeType( node.getXmlNodeType() );
+	if( node.mRecord == mNodes )
+		result->setDocType( string( getDocType(), getStringSize( mDocType ) ) );
+
+	const size_t numAttributes = node.getNumAttributes();
+	for( size_t i = 0; i < numAttributes; ++i )
+		result->getAttributes().push_back( XmlTree::Attr( result, node.getAttributeName( i ), node.getAttributeValue( i ) ) );
+
+	// children are created in place, as parseItem() does, rather than copied by push_back()
+	XmlTree::Container &children = result->getChildren();
+	const size_t numChildren = node.getNumChildren();
+	for( size_t i = 0; i < numChildren; ++i ) {
+		children.push_back( unique_ptr<XmlTree>( new XmlTree( "", "", result ) ) );
+		copyNode( node.getChild( i ), children.back().get() );
+	}
+}
+
+void BinaryTree::copyNode( const Node &node, JsonTree *result ) const
+{
+	const NodeRecord *record = getNodeRecord( node.mRecord );
+	result->mKey.assign( node.getName(), node.getNameSize() );
+	result->mValue.assign( node.getValue(), node.getValueSize() );
+	result->mNodeType = (JsonTree::NodeType)record->mNodeType;
+	result->mValueType = (JsonTree::ValueType)record->mValueType;
+
+	const size_t numChildren = node.getNumChildren();
+	for( size_t i = 0; i < numChildren; ++i ) {
+		result->mChildren.push_back( JsonTree() );
+		JsonTree *child = &result->mChildren.back();
+		child->mParent = result;
+		copyNode( node.getChild( i ), child );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// TreeCache
+TreeCache::TreeCache( const fs::path &cacheDirectory )
+	: mCacheDirectory( cacheDirectory )
+{
+	if( ! fs::exists( mCacheDirectory ) )
+		fs::create_directories( mCacheDirectory );
+}
+
+BinaryTreeRef TreeCache::loadXml( const DataSourceRef &source, const XmlTree::ParseOptions &parseOptions )
+{
+	const uint32_t options = ( parseOptions.getParseComments() ? 1 : 0 ) | ( parseOptions.getCollapseCData() ? 2 : 0 ) | ( parseOptions.getIgnoreDataChildren() ? 4 : 0 );
+	return load( source, BinaryTree::SOURCE_XML, options, [&parseOptions]( const DataSourceRef &contents, uint64_t sourceHash ) {
+		return BinaryTree::encode( XmlTree( contents, parseOptions ), sourceHash );
+	} );
+}
+
+BinaryTreeRef TreeCache::loadJson( const DataSourceRef &source, const JsonTree::ParseOptions &parseOptions )
+{
+	const uint32_t options = ( parseOptions.getIgnoreErrors() ? 1 : 0 ) | ( parseOptions.getAllowComments() ? 2 : 0 );
+	return load( source, BinaryTree::SOURCE_JSON, options, [&parseOptions]( const DataSourceRef &contents, uint64_t sourceHash ) {
+		return BinaryTree::encode( JsonTree( contents, parseOptions ), sourceHash );
+	} );
+}
+
+shared_ptr<svg::Doc> TreeCache::loadSvg( const DataSourceRef &source )
+{
+	BinaryTreeRef tree = loadXml( source, svg::Doc::getParseOptions() );
+	shared_ptr<XmlTree> xml( new XmlTree( tree->getRoot().toXmlTree() ) );
+	return svg::Doc::create( xml, source->getFilePathHint() );
+}
+
+BinaryTreeRef TreeCache::load( const DataSourceRef &source, BinaryTree::SourceType sourceType, uint32_t options, const function<Buffer( const DataSourceRef &, uint64_t )> &encode )
+{
+	// large files are memory mapped by getBuffer(), so hashing them involves no copy. The parse options are hashed too, as they change the tree.
+	Buffer contents = source->getBuffer();
+	const uint64_t sourceHash = hashData( contents.getData(), contents.getDataSize(), ( (uint64_t)sourceType << 32 ) | options );
+	const fs::path cachePath = mCacheDirectory / getCacheFileName( source, sourceType, options, sourceHash );
+
+	if( fs::exists( cachePath ) ) {
+		try {
+			BinaryTreeRef cached = BinaryTree::create( cachePath );
+			if( cached->getSourceType() == sourceType && cached->getSourceHash() == sourceHash )
+				return cached;
+		}
+		catch( BinaryTreeExc & ) {
+			// an incomplete or incompatible file is rewritten below
+		}
+	}
+
+	Buffer encoded = encode( DataSourceBuffer::create( contents, source->getFilePathHint() ), sourceHash );
+
+	// the file is written beside its final path and renamed into place, so that no reader ever maps a partially written file
+	const fs::path tempPath( cachePath.string() + ".partial" );
+	try {
+		writeBuffer( writeFile( tempPath ), encoded );
+		if( fs::exists( cachePath ) )
+			fs::remove( cachePath );
+		fs::rename( tempPath, cachePath );
+	}
+	catch( std::exception & ) {
+		// an unwritable cache only means the next load parses again
+	}
+
+	return BinaryTree::create( encoded );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// BinaryTreeExc
+BinaryTreeExc::BinaryTreeExc( const string &description ) throw()
+{
+#if defined( CINDER_MSW ) || defined( CINDER_WINRT )
+	sprintf_s( mMessage, "%s", description.c_str() );
+#else
+	snprintf( mMessage, sizeof(mMessage), "%s", description.c_str() );
+#endif
+}
+
+} // namespace cinder
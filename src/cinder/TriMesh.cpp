@@ -21,6 +21,11 @@
 */
 
 #include "cinder/TriMesh.h"
+#include "cinder/Buffer.h"
+#include "cinder/Utilities.h"
+#include "cinder/TaskPool.h"
+
+#include <cstring>
 
 using std::vector;
 
@@ -32,6 +37,7 @@ void TriMesh::clear()
 {
 	mVertices.clear();
 	mNormals.clear();
+	mTangents.clear();
 	mColorsRGB.clear();
 	mColorsRGBA.clear();
 	mTexCoords.clear();
@@ -139,98 +145,608 @@ AxisAlignedBox3f TriMesh::calcBoundingBox( const Matrix44f &transform ) const
 }
 
 
-void TriMesh::read( DataSourceRef dataSource )
+// Version 1 is a 17 byte header (version, then the four uint32 attribute counts) followed by the tightly packed attribute arrays.
+// Version 2 is a 32 byte header followed by the attribute arrays, each padded to a multiple of 16 bytes. When compressed,
+// the arrays are stored as a single zlib stream. All values are little endian.
+namespace {
+
+const uint8_t	TRIMESH_VERSION_LATEST = 2;
+const uint8_t	TRIMESH_FLAG_COMPRESSED = 1;
+const size_t	TRIMESH_V1_HEADER_SIZE = 17;
+const size_t	TRIMESH_V2_HEADER_SIZE = 32;
+const size_t	TRIMESH_V2_ALIGNMENT = 16;
+
+struct TriMeshHeaderV2 {
+	uint8_t		mVersion;
+	uint8_t		mFlags;
+	uint16_t	mReserved0;
+	uint32_t	mNumVertices, mNumNormals, mNumTexCoords, mNumIndices;
+	uint32_t	mPayloadSizeLow, mPayloadSizeHigh; // size of the arrays as stored, which is the compressed size when compressed
+	uint32_t	mReserved1;
+};
+
+static_assert( sizeof( TriMeshHeaderV2 ) == TRIMESH_V2_HEADER_SIZE, "unexpected TriMeshHeaderV2 size" );
+static_assert( sizeof( Vec3f ) == 3 * sizeof( float ) && sizeof( Vec2f ) == 2 * sizeof( float ), "TriMesh serialization requires tightly packed vectors" );
+
+size_t alignedSize( size_t size )
 {
-	IStreamRef in = dataSource->createStream();
-	clear();
+	return ( size + TRIMESH_V2_ALIGNMENT - 1 ) & ~( TRIMESH_V2_ALIGNMENT - 1 );
+}
 
-	uint8_t versionNumber;
-	in->read( &versionNumber );
-	
-	uint32_t numVertices, numNormals, numTexCoords, numIndices;
-	in->readLittle( &numVertices );
-	in->readLittle( &numNormals );
-	in->readLittle( &numTexCoords );
-	in->readLittle( &numIndices );
-	
-	for( size_t idx = 0; idx < numVertices; ++idx ) {
-		Vec3f v;
-		in->readLittle( &v.x ); in->readLittle( &v.y ); in->readLittle( &v.z );
-		mVertices.push_back( v );
-	}
+template<typename T>
+T readLittleValue( const uint8_t *src )
+{
+	T result;
+	memcpy( &result, src, sizeof( T ) );
+#if ! defined( CINDER_LITTLE_ENDIAN )
+	result = swapEndian( result );
+#endif
+	return result;
+}
 
-	for( size_t idx = 0; idx < numNormals; ++idx ) {
-		Vec3f v;
-		in->readLittle( &v.x ); in->readLittle( &v.y ); in->readLittle( &v.z );
-		mNormals.push_back( v );
-	}
+// copies \a count elements of T from \a *src into \a dst, throwing if that would read past \a end, and advances \a *src by \a stride bytes.
+template<typename T>
+void readArray( vector<T> *dst, size_t count, const uint8_t **src, const uint8_t *end, size_t stride )
+{
+	const size_t numBytes = count * sizeof( T );
+	if( count > (size_t)( end - *src ) / sizeof( T ) || stride > (size_t)( end - *src ) )
+		throw StreamExc();
+
+	dst->resize( count );
+	if( numBytes )
+		memcpy( &(*dst)[0], *src, numBytes );
+#if ! defined( CINDER_LITTLE_ENDIAN )
+	if( numBytes )
+		swapEndianBlock( reinterpret_cast<float *>( &(*dst)[0] ), numBytes ); // every attribute is made up of 32-bit values
+#endif
+	*src += stride;
+}
 
-	for( size_t idx = 0; idx < numTexCoords; ++idx ) {
-		Vec2f v;
-		in->readLittle( &v.x ); in->readLittle( &v.y );
-		mTexCoords.push_back( v );
+template<typename T>
+void writeArray( OStreamRef &out, const vector<T> &src, bool pad )
+{
+	const size_t numBytes = src.size() * sizeof( T );
+#if defined( CINDER_LITTLE_ENDIAN )
+	if( numBytes )
+		out->writeData( &src[0], numBytes );
+#else
+	if( numBytes )
+		out->writeLittle( reinterpret_cast<const uint32_t *>( &src[0] ), numBytes / 4 ); // every attribute is made up of 32-bit values
+#endif
+
+	if( pad ) {
+		const uint8_t zeros[TRIMESH_V2_ALIGNMENT] = { 0 };
+		size_t padding = alignedSize( numBytes ) - numBytes;
+		if( padding )
+			out->writeData( zeros, padding );
 	}
+}
 
-	for( size_t idx = 0; idx < numIndices; ++idx ) {
-		uint32_t v;
-		in->readLittle( &v );
-		mIndices.push_back( v );
+} // anonymous namespace
+
+void TriMesh::read( DataSourceRef dataSource )
+{
+	// DataSourcePath memory maps large files, in which case this doesn't copy
+	Buffer buffer = dataSource->getBuffer();
+	clear();
+
+	const uint8_t *src = reinterpret_cast<const uint8_t *>( buffer.getData() );
+	const uint8_t *end = src + buffer.getDataSize();
+	if( buffer.getDataSize() < TRIMESH_V1_HEADER_SIZE )
+		throw StreamExc();
+
+	const uint8_t versionNumber = src[0];
+	if( versionNumber == 1 ) {
+		uint32_t numVertices = readLittleValue<uint32_t>( src + 1 );
+		uint32_t numNormals = readLittleValue<uint32_t>( src + 5 );
+		uint32_t numTexCoords = readLittleValue<uint32_t>( src + 9 );
+		uint32_t numIndices = readLittleValue<uint32_t>( src + 13 );
+		src += TRIMESH_V1_HEADER_SIZE;
+
+		readArray( &mVertices, numVertices, &src, end, numVertices * sizeof( Vec3f ) );
+		readArray( &mNormals, numNormals, &src, end, numNormals * sizeof( Vec3f ) );
+		readArray( &mTexCoords, numTexCoords, &src, end, numTexCoords * sizeof( Vec2f ) );
+		readArray( &mIndices, numIndices, &src, end, numIndices * sizeof( uint32_t ) );
+	}
+	else if( versionNumber == 2 ) {
+		if( buffer.getDataSize() < TRIMESH_V2_HEADER_SIZE )
+			throw StreamExc();
+
+		TriMeshHeaderV2 header;
+		header.mFlags = src[1];
+		header.mNumVertices = readLittleValue<uint32_t>( src + 4 );
+		header.mNumNormals = readLittleValue<uint32_t>( src + 8 );
+		header.mNumTexCoords = readLittleValue<uint32_t>( src + 12 );
+		header.mNumIndices = readLittleValue<uint32_t>( src + 16 );
+		header.mPayloadSizeLow = readLittleValue<uint32_t>( src + 20 );
+		header.mPayloadSizeHigh = readLittleValue<uint32_t>( src + 24 );
+		src += TRIMESH_V2_HEADER_SIZE;
+
+		const uint64_t payloadSize = ( (uint64_t)header.mPayloadSizeHigh << 32 ) | header.mPayloadSizeLow;
+		if( payloadSize > (uint64_t)( end - src ) )
+			throw StreamExc();
+
+		Buffer decompressed;
+		if( header.mFlags & TRIMESH_FLAG_COMPRESSED ) {
+			Buffer compressed( const_cast<uint8_t *>( src ), (size_t)payloadSize );
+			decompressed = decompressBuffer( compressed, false );
+			src = reinterpret_cast<const uint8_t *>( decompressed.getData() );
+			end = src + decompressed.getDataSize();
+		}
+		else
+			end = src + payloadSize;
+
+		readArray( &mVertices, header.mNumVertices, &src, end, alignedSize( header.mNumVertices * sizeof( Vec3f ) ) );
+		readArray( &mNormals, header.mNumNormals, &src, end, alignedSize( header.mNumNormals * sizeof( Vec3f ) ) );
+		readArray( &mTexCoords, header.mNumTexCoords, &src, end, alignedSize( header.mNumTexCoords * sizeof( Vec2f ) ) );
+		readArray( &mIndices, header.mNumIndices, &src, end, alignedSize( header.mNumIndices * sizeof( uint32_t ) ) );
 	}
+	else
+		throw StreamExc();
 }
 
-void TriMesh::write( DataTargetRef dataTarget ) const
+void TriMesh::write( DataTargetRef dataTarget, bool compressed ) const
 {
 	OStreamRef out = dataTarget->getStream();
-	
-	const uint8_t versionNumber = 1;
-	out->write( versionNumber );
-	
+
+	const size_t payloadSize = alignedSize( mVertices.size() * sizeof( Vec3f ) ) + alignedSize( mNormals.size() * sizeof( Vec3f ) )
+								+ alignedSize( mTexCoords.size() * sizeof( Vec2f ) ) + alignedSize( mIndices.size() * sizeof( uint32_t ) );
+
+	Buffer compressedPayload;
+	if( compressed ) {
+		OStreamMemRef payloadStream = OStreamMem::create( payloadSize );
+		OStreamRef payloadOut = payloadStream;
+		writeArray( payloadOut, mVertices, true );
+		writeArray( payloadOut, mNormals, true );
+		writeArray( payloadOut, mTexCoords, true );
+		writeArray( payloadOut, mIndices, true );
+		compressedPayload = compressBuffer( Buffer( payloadStream->getBuffer(), (size_t)payloadStream->tell() ) );
+	}
+
+	out->write( TRIMESH_VERSION_LATEST );
+	out->write( compressed ? TRIMESH_FLAG_COMPRESSED : uint8_t( 0 ) );
+	out->writeLittle( uint16_t( 0 ) );
 	out->writeLittle( static_cast<uint32_t>( mVertices.size() ) );
 	out->writeLittle( static_cast<uint32_t>( mNormals.size() ) );
 	out->writeLittle( static_cast<uint32_t>( mTexCoords.size() ) );
 	out->writeLittle( static_cast<uint32_t>( mIndices.size() ) );
-	
-	for( vector<Vec3f>::const_iterator it = mVertices.begin(); it != mVertices.end(); ++it ) {
-		out->writeLittle( it->x ); out->writeLittle( it->y ); out->writeLittle( it->z );
+	const uint64_t storedSize = compressed ? compressedPayload.getDataSize() : payloadSize;
+	out->writeLittle( static_cast<uint32_t>( storedSize & 0xFFFFFFFF ) );
+	out->writeLittle( static_cast<uint32_t>( storedSize >> 32 ) );
+	out->writeLittle( uint32_t( 0 ) );
+
+	if( compressed )
+		out->writeData( compressedPayload.getData(), compressedPayload.getDataSize() );
+	else {
+		writeArray( out, mVertices, true );
+		writeArray( out, mNormals, true );
+		writeArray( out, mTexCoords, true );
+		writeArray( out, mIndices, true );
+	}
+}
+
+namespace {
+
+// Returns the next fanning vertex once the candidates are exhausted: the most recently used vertex that still has triangles, or else the next one in index order.
+int64_t skipDeadEnd( const vector<uint32_t> &liveCount, vector<uint32_t> *deadEnd, size_t *cursor )
+{
+	while( ! deadEnd->empty() ) {
+		uint32_t v = deadEnd->back();
+		deadEnd->pop_back();
+		if( liveCount[v] > 0 )
+			return v;
+	}
+	for( ; *cursor < liveCount.size(); ++*cursor ) {
+		if( liveCount[*cursor] > 0 )
+			return (int64_t)*cursor;
+	}
+	return -1;
+}
+
+// Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007). Writes the reordered
+// indices to result, and the first triangle of each cluster, delimited wherever the fan had to jump to a dead end, to clusterStarts.
+void tipsify( const vector<uint32_t> &indices, size_t numVertices, size_t cacheSize, vector<uint32_t> *result, vector<size_t> *clusterStarts )
+{
+	const size_t numTriangles = indices.size() / 3;
+
+	vector<uint32_t> offsets( numVertices + 1, 0 );
+	for( size_t i = 0; i < numTriangles * 3; ++i )
+		++offsets[indices[i] + 1];
+	for( size_t v = 0; v < numVertices; ++v )
+		offsets[v + 1] += offsets[v];
+	vector<uint32_t> adjacency( numTriangles * 3 );
+	vector<uint32_t> liveCount( numVertices, 0 );
+	for( size_t i = 0; i < numTriangles * 3; ++i )
+		adjacency[offsets[indices[i]] + liveCount[indices[i]]++] = (uint32_t)( i / 3 );
+
+	vector<size_t> cacheTime( numVertices, 0 );
+	vector<uint8_t> emitted( numTriangles, 0 );
+	vector<uint32_t> deadEnd, candidates;
+	size_t time = cacheSize + 1;
+	size_t cursor = 0;
+
+	result->clear();
+	result->reserve( numTriangles * 3 );
+	clusterStarts->clear();
+	int64_t fanning = skipDeadEnd( liveCount, &deadEnd, &cursor );
+	bool newCluster = true;
+	while( fanning >= 0 ) {
+		if( newCluster )
+			clusterStarts->push_back( result->size() / 3 );
+
+		candidates.clear();
+		for( uint32_t k = offsets[fanning]; k < offsets[fanning + 1]; ++k ) {
+			uint32_t t = adjacency[k];
+			if( emitted[t] )
+				continue;
+			emitted[t] = 1;
+			for( int c = 0; c < 3; ++c ) {
+				uint32_t v = indices[t * 3 + c];
+				result->push_back( v );
+				deadEnd.push_back( v );
+				candidates.push_back( v );
+				--liveCount[v];
+				if( time - cacheTime[v] > cacheSize )
+					cacheTime[v] = time++;
+			}
+		}
+
+		// prefer the candidate that has been in the cache longest while still being certain to stay there for all of its remaining triangles
+		int64_t best = -1;
+		size_t bestPriority = 0;
+		for( size_t c = 0; c < candidates.size(); ++c ) {
+			uint32_t v = candidates[c];
+			if( liveCount[v] == 0 )
+				continue;
+			size_t priority = 0;
+			if( time - cacheTime[v] + 2 * liveCount[v] <= cacheSize )
+				priority = time - cacheTime[v];
+			if( best < 0 || priority > bestPriority ) {
+				best = v;
+				bestPriority = priority;
+			}
+		}
+
+		newCluster = best < 0;
+		fanning = newCluster ? skipDeadEnd( liveCount, &deadEnd, &cursor ) : best;
+	}
+}
+
+// Sorts clusters so that those on the outside of the mesh facing away from its centroid come first, since they are most likely to occlude the rest
+void sortClustersForOverdraw( const vector<Vec3f> &vertices, const vector<size_t> &clusterStarts, vector<uint32_t> *indices )
+{
+	const size_t numTriangles = indices->size() / 3;
+	const size_t numClusters = clusterStarts.size();
+	if( numClusters < 2 )
+		return;
+
+	vector<Vec3f> centroids( numClusters, Vec3f::zero() ), normals( numClusters, Vec3f::zero() );
+	vector<float> areas( numClusters, 0 );
+	Vec3f meshCentroid = Vec3f::zero();
+	float meshArea = 0;
+	for( size_t c = 0; c < numClusters; ++c ) {
+		size_t end = ( c + 1 < numClusters ) ? clusterStarts[c + 1] : numTriangles;
+		for( size_t t = clusterStarts[c]; t < end; ++t ) {
+			const Vec3f &p0 = vertices[(*indices)[t * 3]], &p1 = vertices[(*indices)[t * 3 + 1]], &p2 = vertices[(*indices)[t * 3 + 2]];
+			Vec3f n = ( p1 - p0 ).cross( p2 - p0 );
+			float area = n.length();
+			normals[c] += n;
+			centroids[c] += ( p0 + p1 + p2 ) * area;
+			areas[c] += area;
+		}
+		meshCentroid += centroids[c];
+		meshArea += areas[c];
+		if( areas[c] > 0 )
+			centroids[c] /= areas[c];
+	}
+	if( meshArea > 0 )
+		meshCentroid /= meshArea;
+	else
+		return;
+	meshCentroid /= 3;
+
+	vector<std::pair<float,size_t> > keys( numClusters );
+	for( size_t c = 0; c < numClusters; ++c ) {
+		Vec3f centroid = centroids[c] / 3;
+		keys[c] = std::make_pair( -( centroid - meshCentroid ).dot( normals[c].safeNormalized() ), c );
+	}
+	std::stable_sort( keys.begin(), keys.end() );
+
+	vector<uint32_t> sorted;
+	sorted.reserve( indices->size() );
+	for( size_t k = 0; k < numClusters; ++k ) {
+		size_t c = keys[k].second;
+		size_t end = ( c + 1 < numClusters ) ? clusterStarts[c + 1] : numTriangles;
+		sorted.insert( sorted.end(), indices->begin() + clusterStarts[c] * 3, indices->begin() + end * 3 );
+	}
+	indices->swap( sorted );
+}
+
+template<typename T>
+void permuteVertices( const vector<uint32_t> &newIndex, vector<T> *attribute )
+{
+	if( attribute->size() != newIndex.size() )
+		return;
+	vector<T> result( attribute->size() );
+	for( size_t v = 0; v < newIndex.size(); ++v )
+		result[newIndex[v]] = (*attribute)[v];
+	attribute->swap( result );
+}
+
+} // anonymous namespace
+
+void TriMesh::optimize( size_t cacheSize, bool reduceOverdraw )
+{
+	const size_t numVertices = mVertices.size();
+	if( mIndices.empty() || numVertices == 0 )
+		return;
+
+	vector<uint32_t> reordered;
+	vector<size_t> clusterStarts;
+	tipsify( mIndices, numVertices, cacheSize, &reordered, &clusterStarts );
+	if( reduceOverdraw )
+		sortClustersForOverdraw( mVertices, clusterStarts, &reordered );
+	mIndices.swap( reordered );
+
+	// renumber vertices in order of first use
+	const uint32_t UNUSED = 0xFFFFFFFF;
+	vector<uint32_t> newIndex( numVertices, UNUSED );
+	uint32_t next = 0;
+	for( size_t i = 0; i < mIndices.size(); ++i ) {
+		if( newIndex[mIndices[i]] == UNUSED )
+			newIndex[mIndices[i]] = next++;
+		mIndices[i] = newIndex[mIndices[i]];
 	}
+	for( size_t v = 0; v < numVertices; ++v ) {
+		if( newIndex[v] == UNUSED )
+			newIndex[v] = next++;
+	}
+
+	permuteVertices( newIndex, &mVertices );
+	permuteVertices( newIndex, &mNormals );
+	permuteVertices( newIndex, &mTangents );
+	permuteVertices( newIndex, &mColorsRGB );
+	permuteVertices( newIndex, &mColorsRGBA );
+	permuteVertices( newIndex, &mTexCoords );
+}
 
-	for( vector<Vec3f>::const_iterator it = mNormals.begin(); it != mNormals.end(); ++it ) {
-		out->writeLittle( it->x ); out->writeLittle( it->y ); out->writeLittle( it->z );
+float TriMesh::calcCacheMissRatio( size_t cacheSize ) const
+{
+	const size_t numTriangles = getNumTriangles();
+	if( numTriangles == 0 )
+		return 0;
+
+	// FIFO simulation; a vertex is cached while fewer than cacheSize misses have happened since it was inserted
+	vector<size_t> insertTime( mVertices.size(), 0 );
+	size_t time = cacheSize + 1, misses = 0;
+	for( size_t i = 0; i < numTriangles * 3; ++i ) {
+		uint32_t v = mIndices[i];
+		if( insertTime[v] == 0 || time - insertTime[v] > cacheSize ) {
+			insertTime[v] = time++;
+			++misses;
+		}
 	}
 
-	for( vector<Vec2f>::const_iterator it = mTexCoords.begin(); it != mTexCoords.end(); ++it ) {
-		out->writeLittle( it->x ); out->writeLittle( it->y );
+	return misses / (float)numTriangles;
+}
+
+void TriMesh::transform( const Matrix44f &transform )
+{
+	if( ! mVertices.empty() )
+		transform.transformPointsAffine( &mVertices[0], &mVertices[0], mVertices.size() );
+
+	if( ! mNormals.empty() ) {
+		Matrix44f normalMatrix = transform.affineInverted().transposed();
+		normalMatrix.transformVecs( &mNormals[0], &mNormals[0], mNormals.size() );
+		std::for_each( mNormals.begin(), mNormals.end(), std::mem_fun_ref(&Vec3f::normalize) );
 	}
+}
 
-	for( vector<uint32_t>::const_iterator it = mIndices.begin(); it != mIndices.end(); ++it ) {
-		out->writeLittle( *it );
+namespace {
+
+// Meshes with fewer triangles than this per task are processed serially
+const size_t MIN_PARALLEL_TRIANGLES = 16384;
+
+// Sums faceFn( triangle ) into each of the triangle's vertices, then calls finalize( vertex, sum ). In parallel, each task
+// accumulates a contiguous range of triangles into its own array and the arrays are reduced per vertex afterwards, so no atomics are needed.
+template<typename FaceFn, typename FinalizeFn>
+void accumulateFaceVectors( const vector<uint32_t> &indices, size_t numVertices, TaskPool *taskPool, FaceFn faceFn, FinalizeFn finalize, vector<Vec3f> *result )
+{
+	const size_t numTriangles = indices.size() / 3;
+	result->assign( numVertices, Vec3f::zero() );
+
+	size_t numChunks = 1;
+	if( taskPool && taskPool->getNumThreads() > 0 )
+		numChunks = std::min( taskPool->getNumThreads() + 1, numTriangles / MIN_PARALLEL_TRIANGLES );
+
+	if( numChunks <= 1 ) {
+		Vec3f *sums = numVertices ? &(*result)[0] : NULL;
+		for( size_t t = 0; t < numTriangles; ++t ) {
+			Vec3f v = faceFn( t );
+			sums[indices[t * 3]] += v;
+			sums[indices[t * 3 + 1]] += v;
+			sums[indices[t * 3 + 2]] += v;
+		}
+		for( size_t v = 0; v < numVertices; ++v )
+			finalize( v, sums[v] );
+		return;
 	}
+
+	// the first chunk accumulates directly into result
+	vector<vector<Vec3f> > partials( numChunks - 1 );
+	taskPool->parallelFor( 0, numChunks, [&]( size_t first, size_t last ) {
+		for( size_t c = first; c < last; ++c ) {
+			Vec3f *sums = &(*result)[0];
+			if( c > 0 ) {
+				partials[c - 1].assign( numVertices, Vec3f::zero() );
+				sums = &partials[c - 1][0];
+			}
+			const size_t end = numTriangles * ( c + 1 ) / numChunks;
+			for( size_t t = numTriangles * c / numChunks; t < end; ++t ) {
+				Vec3f v = faceFn( t );
+				sums[indices[t * 3]] += v;
+				sums[indices[t * 3 + 1]] += v;
+				sums[indices[t * 3 + 2]] += v;
+			}
+		}
+	}, 1 );
+
+	taskPool->parallelFor( 0, numVertices, [&]( size_t first, size_t last ) {
+		for( size_t v = first; v < last; ++v ) {
+			Vec3f &sum = (*result)[v];
+			for( size_t p = 0; p < partials.size(); ++p )
+				sum += partials[p][v];
+			finalize( v, sum );
+		}
+	} );
 }
 
-void TriMesh::recalculateNormals()
+// Recomputes only the vertices referenced by dirtyTriangles. Every triangle sharing one of those vertices contributes, in
+// index order, so the values match a full recalculation exactly.
+template<typename FaceFn, typename FinalizeFn>
+void accumulateDirtyFaceVectors( const vector<uint32_t> &indices, const uint32_t *dirtyTriangles, size_t numDirty, FaceFn faceFn, FinalizeFn finalize, vector<Vec3f> *result )
 {
-	mNormals.assign( mVertices.size(), Vec3f::zero() );
+	vector<uint8_t> touched( result->size(), 0 );
+	vector<uint32_t> touchedVertices;
+	touchedVertices.reserve( numDirty * 3 );
+	for( size_t i = 0; i < numDirty; ++i ) {
+		for( size_t k = 0; k < 3; ++k ) {
+			uint32_t v = indices[dirtyTriangles[i] * 3 + k];
+			if( ! touched[v] ) {
+				touched[v] = 1;
+				touchedVertices.push_back( v );
+				(*result)[v] = Vec3f::zero();
+			}
+		}
+	}
+
+	const size_t numTriangles = indices.size() / 3;
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		uint32_t i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+		if( ! ( touched[i0] | touched[i1] | touched[i2] ) )
+			continue;
+
+		Vec3f v = faceFn( t );
+		if( touched[i0] ) (*result)[i0] += v;
+		if( touched[i1] ) (*result)[i1] += v;
+		if( touched[i2] ) (*result)[i2] += v;
+	}
+
+	for( size_t i = 0; i < touchedVertices.size(); ++i )
+		finalize( touchedVertices[i], (*result)[touchedVertices[i]] );
+}
 
-	size_t n = getNumTriangles();
-	for( size_t i = 0; i < n; ++i ) {
-		uint32_t index0 = mIndices[i * 3];
-		uint32_t index1 = mIndices[i * 3 + 1];
-		uint32_t index2 = mIndices[i * 3 + 2];
+struct FaceNormal {
+	FaceNormal( const Vec3f *vertices, const uint32_t *indices )
+		: mVertices( vertices ), mIndices( indices )
+	{}
 
-		Vec3f v0 = mVertices[ index0 ];
-		Vec3f v1 = mVertices[ index1 ];
-		Vec3f v2 = mVertices[ index2 ];
+	Vec3f operator()( size_t t ) const
+	{
+		Vec3f v0 = mVertices[ mIndices[t * 3] ];
+		Vec3f v1 = mVertices[ mIndices[t * 3 + 1] ];
+		Vec3f v2 = mVertices[ mIndices[t * 3 + 2] ];
 
 		Vec3f e0 = v1 - v0;
 		Vec3f e1 = v2 - v0;
-		Vec3f normal = e0.cross(e1).normalized();
+		return e0.cross(e1).normalized();
+	}
+
+	const Vec3f		*mVertices;
+	const uint32_t	*mIndices;
+};
+
+struct NormalizeNormal {
+	void operator()( size_t, Vec3f &n ) const { n.normalize(); }
+};
+
+struct FaceTangent {
+	FaceTangent( const Vec3f *vertices, const Vec2f *texCoords, const uint32_t *indices )
+		: mVertices( vertices ), mTexCoords( texCoords ), mIndices( indices )
+	{}
+
+	Vec3f operator()( size_t t ) const
+	{
+		uint32_t i0 = mIndices[t * 3], i1 = mIndices[t * 3 + 1], i2 = mIndices[t * 3 + 2];
+		Vec3f e1 = mVertices[i1] - mVertices[i0];
+		Vec3f e2 = mVertices[i2] - mVertices[i0];
+		Vec2f st1 = mTexCoords[i1] - mTexCoords[i0];
+		Vec2f st2 = mTexCoords[i2] - mTexCoords[i0];
+
+		// triangles with degenerate texture coordinates don't contribute
+		float r = st1.x * st2.y - st2.x * st1.y;
+		if( r == 0 )
+			return Vec3f::zero();
+
+		return ( e1 * st2.y - e2 * st1.y ) / r;
+	}
+
+	const Vec3f		*mVertices;
+	const Vec2f		*mTexCoords;
+	const uint32_t	*mIndices;
+};
+
+struct OrthonormalizeTangent {
+	OrthonormalizeTangent( const Vec3f *normals )
+		: mNormals( normals )
+	{}
+
+	void operator()( size_t v, Vec3f &t ) const
+	{
+		if( mNormals )
+			t -= mNormals[v] * mNormals[v].dot( t );
+		t.safeNormalize();
+	}
+
+	const Vec3f		*mNormals;
+};
+
+} // anonymous namespace
+
+void TriMesh::recalculateNormals( TaskPool *taskPool )
+{
+	if( mIndices.empty() ) {
+		mNormals.assign( mVertices.size(), Vec3f::zero() );
+		return;
+	}
+
+	accumulateFaceVectors( mIndices, mVertices.size(), taskPool, FaceNormal( &mVertices[0], &mIndices[0] ), NormalizeNormal(), &mNormals );
+}
+
+void TriMesh::recalculateNormals( const uint32_t *dirtyTriangles, size_t numTriangles )
+{
+	if( mNormals.size() != mVertices.size() ) {
+		recalculateNormals();
+		return;
+	}
+	if( numTriangles == 0 )
+		return;
+
+	accumulateDirtyFaceVectors( mIndices, dirtyTriangles, numTriangles, FaceNormal( &mVertices[0], &mIndices[0] ), NormalizeNormal(), &mNormals );
+}
 
-		mNormals[ index0 ] += normal;
-		mNormals[ index1 ] += normal;
-		mNormals[ index2 ] += normal;
+void TriMesh::recalculateTangents( TaskPool *taskPool )
+{
+	if( mTexCoords.size() != mVertices.size() || mIndices.empty() ) {
+		mTangents.clear();
+		return;
+	}
+
+	const Vec3f *normals = ( mNormals.size() == mVertices.size() ) ? &mNormals[0] : NULL;
+	accumulateFaceVectors( mIndices, mVertices.size(), taskPool, FaceTangent( &mVertices[0], &mTexCoords[0], &mIndices[0] ), OrthonormalizeTangent( normals ), &mTangents );
+}
+
+void TriMesh::recalculateTangents( const uint32_t *dirtyTriangles, size_t numTriangles )
+{
+	if( mTangents.size() != mVertices.size() || mTexCoords.size() != mVertices.size() ) {
+		recalculateTangents();
+		return;
 	}
+	if( numTriangles == 0 )
+		return;
 
-	std::for_each( mNormals.begin(), mNormals.end(), std::mem_fun_ref(&Vec3f::normalize) );
+	const Vec3f *normals = ( mNormals.size() == mVertices.size() ) ? &mNormals[0] : NULL;
+	accumulateDirtyFaceVectors( mIndices, dirtyTriangles, numTriangles, FaceTangent( &mVertices[0], &mTexCoords[0], &mIndices[0] ), OrthonormalizeTangent( normals ), &mTangents );
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,351 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TriMeshBvh.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+const int		NUM_BINS = 16;
+const uint32_t	MAX_LEAF_SIZE = 8;
+const int		MAX_DEPTH = 60;
+// relative cost of visiting a node versus intersecting a triangle
+const float		TRAVERSAL_COST = 1.0f;
+// meshes smaller than this are always built on the calling thread
+const size_t	MIN_PARALLEL_TRIANGLES = 65536;
+
+struct Bounds {
+	Bounds() : mMin( FLT_MAX, FLT_MAX, FLT_MAX ), mMax( -FLT_MAX, -FLT_MAX, -FLT_MAX ) {}
+
+	void	include( const Vec3f &p ) { mMin.x = std::min( mMin.x, p.x ); mMin.y = std::min( mMin.y, p.y ); mMin.z = std::min( mMin.z, p.z );
+										mMax.x = std::max( mMax.x, p.x ); mMax.y = std::max( mMax.y, p.y ); mMax.z = std::max( mMax.z, p.z ); }
+	void	include( const Bounds &b ) { if( ! b.isEmpty() ) { include( b.mMin ); include( b.mMax ); } }
+	bool	isEmpty() const { return mMin.x > mMax.x; }
+	float	calcHalfArea() const { if( isEmpty() ) return 0; Vec3f s = mMax - mMin; return s.x * s.y + s.y * s.z + s.z * s.x; }
+
+	Vec3f	mMin, mMax;
+};
+
+inline bool intersectBox( const Vec3f &boxMin, const Vec3f &boxMax, const Vec3f &origin, const Vec3f &invDir, float minDistance, float maxDistance, float *entry )
+{
+	float tx1 = ( boxMin.x - origin.x ) * invDir.x, tx2 = ( boxMax.x - origin.x ) * invDir.x;
+	float tMin = std::min( tx1, tx2 ), tMax = std::max( tx1, tx2 );
+	float ty1 = ( boxMin.y - origin.y ) * invDir.y, ty2 = ( boxMax.y - origin.y ) * invDir.y;
+	tMin = std::max( tMin, std::min( ty1, ty2 ) ); tMax = std::min( tMax, std::max( ty1, ty2 ) );
+	float tz1 = ( boxMin.z - origin.z ) * invDir.z, tz2 = ( boxMax.z - origin.z ) * invDir.z;
+	tMin = std::max( tMin, std::min( tz1, tz2 ) ); tMax = std::min( tMax, std::max( tz1, tz2 ) );
+	tMin = std::max( tMin, minDistance );
+	tMax = std::min( tMax, maxDistance );
+	*entry = tMin;
+	return tMax >= tMin;
+}
+
+} // anonymous namespace
+
+struct TriMeshBvh::BuildTriangle {
+	Bounds		mBounds;
+	Vec3f		mCentroid;
+	uint32_t	mIndex;
+};
+
+struct TriMeshBvh::PendingSubtree {
+	uint32_t	mNode, mFirst, mCount;
+	int			mDepth;
+};
+
+TriMeshBvh::TriMeshBvh( const TriMesh &mesh, TaskPool *taskPool )
+{
+	size_t numTriangles = mesh.getNumTriangles();
+	if( numTriangles == 0 )
+		return;
+
+	vector<BuildTriangle> build( numTriangles );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		Vec3f a, b, c;
+		mesh.getTriangleVertices( t, &a, &b, &c );
+		build[t].mBounds.include( a );
+		build[t].mBounds.include( b );
+		build[t].mBounds.include( c );
+		build[t].mCentroid = ( a + b + c ) / 3.0f;
+		build[t].mIndex = (uint32_t)t;
+	}
+
+	// Large meshes build their upper levels here, deferring subtrees below deferThreshold triangles to the TaskPool
+	bool parallel = taskPool && numTriangles >= MIN_PARALLEL_TRIANGLES;
+	size_t deferThreshold = parallel ? std::max<size_t>( numTriangles / ( ( taskPool->getNumThreads() + 1 ) * 8 ), MIN_PARALLEL_TRIANGLES / 4 ) : 0;
+	mNodes.reserve( numTriangles * 2 / MAX_LEAF_SIZE + 1 );
+	mNodes.resize( 1 );
+	vector<PendingSubtree> deferred;
+	buildNode( &mNodes, 0, 0, build, 0, (uint32_t)numTriangles, deferThreshold, parallel ? &deferred : NULL );
+
+	if( ! deferred.empty() ) {
+		vector<vector<Node> > subtrees( deferred.size() );
+		taskPool->parallelFor( 0, deferred.size(), [&]( size_t first, size_t last ) {
+			for( size_t d = first; d < last; ++d ) {
+				subtrees[d].resize( 1 );
+				buildNode( &subtrees[d], 0, deferred[d].mDepth, build, deferred[d].mFirst, deferred[d].mCount, 0, NULL );
+			}
+		}, 1 );
+
+		// splice each subtree in, its root replacing the placeholder and its other nodes appended
+		for( size_t d = 0; d < deferred.size(); ++d ) {
+			const vector<Node> &subtree = subtrees[d];
+			uint32_t offset = (uint32_t)mNodes.size() - 1;
+			for( size_t n = 0; n < subtree.size(); ++n ) {
+				Node node = subtree[n];
+				if( node.mCount == 0 )
+					node.mFirst += offset;
+				if( n == 0 )
+					mNodes[deferred[d].mNode] = node;
+				else
+					mNodes.push_back( node );
+			}
+		}
+	}
+
+	mTriangles.resize( numTriangles );
+	mTriangleIndices.resize( numTriangles );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		Vec3f a, b, c;
+		mesh.getTriangleVertices( build[t].mIndex, &a, &b, &c );
+		mTriangles[t].mVert0 = a;
+		mTriangles[t].mEdge1 = b - a;
+		mTriangles[t].mEdge2 = c - a;
+		mTriangleIndices[t] = build[t].mIndex;
+	}
+}
+
+void TriMeshBvh::buildNode( vector<Node> *nodes, uint32_t nodeIndex, int depth, vector<BuildTriangle> &build, uint32_t first, uint32_t count, size_t deferThreshold, vector<PendingSubtree> *deferred ) const
+{
+	if( deferred && count <= deferThreshold ) {
+		PendingSubtree pending = { nodeIndex, first, count, depth };
+		deferred->push_back( pending );
+		return;
+	}
+
+	Bounds bounds, centroidBounds;
+	for( uint32_t t = first; t < first + count; ++t ) {
+		bounds.include( build[t].mBounds );
+		centroidBounds.include( build[t].mCentroid );
+	}
+
+	Node &node = (*nodes)[nodeIndex];
+	node.mMin = bounds.mMin;
+	node.mMax = bounds.mMax;
+	node.mFirst = first;
+	node.mCount = count;
+	if( count <= 2 || depth >= MAX_DEPTH )
+		return;
+
+	// Binned SAH: evaluate NUM_BINS - 1 candidate planes along each axis of the centroid bounds
+	int bestAxis = -1, bestSplit = 0;
+	float bestCost = FLT_MAX;
+	for( int axis = 0; axis < 3; ++axis ) {
+		float extent = centroidBounds.mMax[axis] - centroidBounds.mMin[axis];
+		if( extent <= 0 )
+			continue;
+
+		Bounds binBounds[NUM_BINS];
+		uint32_t binCounts[NUM_BINS] = { 0 };
+		float binScale = NUM_BINS / extent;
+		for( uint32_t t = first; t < first + count; ++t ) {
+			int bin = std::min( (int)( ( build[t].mCentroid[axis] - centroidBounds.mMin[axis] ) * binScale ), NUM_BINS - 1 );
+			binBounds[bin].include( build[t].mBounds );
+			binCounts[bin]++;
+		}
+
+		float rightAreas[NUM_BINS];
+		uint32_t rightCounts[NUM_BINS];
+		Bounds right;
+		uint32_t rightCount = 0;
+		for( int b = NUM_BINS - 1; b > 0; --b ) {
+			right.include( binBounds[b] );
+			rightCount += binCounts[b];
+			rightAreas[b] = right.calcHalfArea();
+			rightCounts[b] = rightCount;
+		}
+
+		Bounds left;
+		uint32_t leftCount = 0;
+		for( int b = 0; b < NUM_BINS - 1; ++b ) {
+			left.include( binBounds[b] );
+			leftCount += binCounts[b];
+			if( leftCount == 0 || rightCounts[b+1] == 0 )
+				continue;
+			float cost = left.calcHalfArea() * leftCount + rightAreas[b+1] * rightCounts[b+1];
+			if( cost < bestCost ) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b + 1;
+			}
+		}
+	}
+
+	// all centroids coincide; nothing separates them
+	if( bestAxis < 0 )
+		return;
+
+	float leafCost = bounds.calcHalfArea() * count;
+	if( TRAVERSAL_COST * bounds.calcHalfArea() + bestCost >= leafCost && count <= MAX_LEAF_SIZE )
+		return;
+
+	float axisMin = centroidBounds.mMin[bestAxis];
+	float binScale = NUM_BINS / ( centroidBounds.mMax[bestAxis] - axisMin );
+	vector<BuildTriangle>::iterator mid = std::partition( build.begin() + first, build.begin() + first + count, [=]( const BuildTriangle &t ) {
+		return std::min( (int)( ( t.mCentroid[bestAxis] - axisMin ) * binScale ), NUM_BINS - 1 ) < bestSplit;
+	} );
+	uint32_t leftCount = (uint32_t)( mid - ( build.begin() + first ) );
+
+	uint32_t leftChild = (uint32_t)nodes->size();
+	nodes->resize( nodes->size() + 2 );
+	(*nodes)[nodeIndex].mFirst = leftChild;
+	(*nodes)[nodeIndex].mCount = 0;
+
+	buildNode( nodes, leftChild, depth + 1, build, first, leftCount, deferThreshold, deferred );
+	buildNode( nodes, leftChild + 1, depth + 1, build, first + leftCount, count - leftCount, deferThreshold, deferred );
+}
+
+template<bool ANY_HIT>
+bool TriMeshBvh::traverse( const Ray &ray, Hit *result, float minDistance, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	const Vec3f &origin = ray.getOrigin();
+	const Vec3f &dir = ray.getDirection();
+	const Vec3f &invDir = ray.getInverseDirection();
+	const float EPSILON = 0.000001f;
+
+	float entry;
+	if( ! intersectBox( mNodes[0].mMin, mNodes[0].mMax, origin, invDir, minDistance, maxDistance, &entry ) )
+		return false;
+
+	// each level pushes at most its farther child
+	struct StackEntry { uint32_t mNode; float mEntry; };
+	StackEntry stack[MAX_DEPTH + 4];
+	int stackSize = 0;
+
+	float closest = maxDistance;
+	bool found = false;
+	uint32_t nodeIndex = 0;
+	while( true ) {
+		const Node &node = mNodes[nodeIndex];
+		if( node.mCount > 0 ) {
+			// the same test as Ray::calcTriangleIntersection(), keeping the barycentric coordinates
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				const Triangle &tri = mTriangles[t];
+				Vec3f pvec = dir.cross( tri.mEdge2 );
+				float det = tri.mEdge1.dot( pvec );
+				if( det > -EPSILON && det < EPSILON )
+					continue;
+				float invDet = 1.0f / det;
+				Vec3f tvec = origin - tri.mVert0;
+				float u = tvec.dot( pvec ) * invDet;
+				if( u < 0 || u > 1 )
+					continue;
+				Vec3f qvec = tvec.cross( tri.mEdge1 );
+				float v = dir.dot( qvec ) * invDet;
+				if( v < 0 || u + v > 1 )
+					continue;
+				float distance = tri.mEdge2.dot( qvec ) * invDet;
+				if( distance < minDistance || distance > closest )
+					continue;
+
+				found = true;
+				if( ANY_HIT )
+					return true;
+				closest = distance;
+				result->mTriangle = mTriangleIndices[t];
+				result->mDistance = distance;
+				result->mU = u;
+				result->mV = v;
+			}
+		}
+		else {
+			const Node &left = mNodes[node.mFirst];
+			const Node &right = mNodes[node.mFirst + 1];
+			float leftEntry, rightEntry;
+			bool hitLeft = intersectBox( left.mMin, left.mMax, origin, invDir, minDistance, closest, &leftEntry );
+			bool hitRight = intersectBox( right.mMin, right.mMax, origin, invDir, minDistance, closest, &rightEntry );
+			if( hitLeft && hitRight ) {
+				bool leftFirst = leftEntry <= rightEntry;
+				StackEntry far = { leftFirst ? node.mFirst + 1 : node.mFirst, leftFirst ? rightEntry : leftEntry };
+				stack[stackSize++] = far;
+				nodeIndex = leftFirst ? node.mFirst : node.mFirst + 1;
+				continue;
+			}
+			else if( hitLeft || hitRight ) {
+				nodeIndex = hitLeft ? node.mFirst : node.mFirst + 1;
+				continue;
+			}
+		}
+
+		// pop, skipping nodes which begin beyond the closest hit so far
+		while( stackSize > 0 && stack[stackSize-1].mEntry > closest )
+			--stackSize;
+		if( stackSize == 0 )
+			break;
+		nodeIndex = stack[--stackSize].mNode;
+	}
+
+	return found;
+}
+
+bool TriMeshBvh::intersect( const Ray &ray, Hit *result, float minDistance, float maxDistance ) const
+{
+	*result = Hit();
+	return traverse<false>( ray, result, minDistance, maxDistance );
+}
+
+bool TriMeshBvh::intersectsAny( const Ray &ray, float minDistance, float maxDistance ) const
+{
+	return traverse<true>( ray, NULL, minDistance, maxDistance );
+}
+
+void TriMeshBvh::intersect( const Ray *rays, size_t numRays, Hit *results, TaskPool *taskPool, float minDistance, float maxDistance ) const
+{
+	if( taskPool ) {
+		taskPool->parallelFor( 0, numRays, [=]( size_t first, size_t last ) {
+			for( size_t r = first; r < last; ++r )
+				intersect( rays[r], &results[r], minDistance, maxDistance );
+		} );
+	}
+	else {
+		for( size_t r = 0; r < numRays; ++r )
+			intersect( rays[r], &results[r], minDistance, maxDistance );
+	}
+}
+
+AxisAlignedBox3f TriMeshBvh::getBounds() const
+{
+	if( mNodes.empty() )
+		return AxisAlignedBox3f( Vec3f::zero(), Vec3f::zero() );
+	return AxisAlignedBox3f( mNodes[0].mMin, mNodes[0].mMax );
+}
+
+} // namespace cinder
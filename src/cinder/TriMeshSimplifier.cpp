@@ -0,0 +1,463 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/TriMeshSimplifier.h"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace cinder {
+
+namespace {
+
+enum { GROUP_BORDER = 1, GROUP_LOCKED = 2 };
+
+// A triangle edge, keyed by its pair of position groups so that edges of different triangles can be matched
+struct EdgeRef {
+	bool operator<( const EdgeRef &rhs ) const { return mKey < rhs.mKey; }
+
+	uint64_t	mKey;
+	uint32_t	mTriangle, mA, mB;
+};
+
+struct PositionLess {
+	PositionLess( const Vec3f *positions ) : mPositions( positions ) {}
+
+	bool operator()( uint32_t a, uint32_t b ) const
+	{
+		const Vec3f &pa = mPositions[a], &pb = mPositions[b];
+		if( pa.x != pb.x ) return pa.x < pb.x;
+		if( pa.y != pb.y ) return pa.y < pb.y;
+		if( pa.z != pb.z ) return pa.z < pb.z;
+		return a < b;
+	}
+
+	const Vec3f		*mPositions;
+};
+
+} // anonymous namespace
+
+void TriMeshSimplifier::Quadric::addPlane( const Vec3f &n, float d, float weight )
+{
+	double nx = n.x, ny = n.y, nz = n.z, dd = d, ww = weight;
+	a00 += ww * nx * nx; a01 += ww * nx * ny; a02 += ww * nx * nz;
+	a11 += ww * ny * ny; a12 += ww * ny * nz; a22 += ww * nz * nz;
+	b0 += ww * nx * dd; b1 += ww * ny * dd; b2 += ww * nz * dd;
+	c += ww * dd * dd;
+	w += ww;
+}
+
+void TriMeshSimplifier::Quadric::operator+=( const Quadric &rhs )
+{
+	a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02;
+	a11 += rhs.a11; a12 += rhs.a12; a22 += rhs.a22;
+	b0 += rhs.b0; b1 += rhs.b1; b2 += rhs.b2;
+	c += rhs.c;
+	w += rhs.w;
+}
+
+double TriMeshSimplifier::Quadric::eval( const Vec3f &p ) const
+{
+	double x = p.x, y = p.y, z = p.z;
+	return x * ( a00 * x + 2 * ( a01 * y + a02 * z + b0 ) ) + y * ( a11 * y + 2 * ( a12 * z + b1 ) ) + z * ( a22 * z + 2 * b2 ) + c;
+}
+
+TriMeshSimplifier::TriMeshSimplifier( const TriMesh &mesh, const Format &format )
+	: mSource( mesh ), mFormat( format ), mError( 0 )
+{
+	const vector<Vec3f> &positions = mSource.getVertices();
+	const uint32_t numVertices = (uint32_t)positions.size();
+
+	// weld vertices with identical positions into groups; copies within a group differ only in their attributes
+	mGroups.resize( numVertices );
+	if( numVertices ) {
+		vector<uint32_t> order( numVertices );
+		for( uint32_t i = 0; i < numVertices; ++i )
+			order[i] = i;
+		std::sort( order.begin(), order.end(), PositionLess( &positions[0] ) );
+		for( uint32_t i = 0; i < numVertices; ++i ) {
+			if( i == 0 || positions[order[i]] != positions[order[i - 1]] )
+				mGroupPositions.push_back( positions[order[i]] );
+			mGroups[order[i]] = (uint32_t)mGroupPositions.size() - 1;
+		}
+	}
+	mQuadrics.resize( mGroupPositions.size() );
+	mGroupFlags.resize( mGroupPositions.size(), 0 );
+
+	// drop triangles that are degenerate once welded
+	const vector<uint32_t> &indices = mSource.getIndices();
+	mIndices.reserve( indices.size() );
+	for( size_t t = 0; t + 2 < indices.size(); t += 3 ) {
+		uint32_t g0 = mGroups[indices[t]], g1 = mGroups[indices[t + 1]], g2 = mGroups[indices[t + 2]];
+		if( g0 != g1 && g1 != g2 && g0 != g2 )
+			mIndices.insert( mIndices.end(), indices.begin() + t, indices.begin() + t + 3 );
+	}
+
+	// surface quadrics, weighted by area
+	const size_t numTriangles = mIndices.size() / 3;
+	vector<Vec3f> faceNormals( numTriangles );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		const Vec3f &p0 = positions[mIndices[t * 3]], &p1 = positions[mIndices[t * 3 + 1]], &p2 = positions[mIndices[t * 3 + 2]];
+		Vec3f n = ( p1 - p0 ).cross( p2 - p0 );
+		float area2 = n.length();
+		if( area2 <= 0 )
+			continue;
+		n /= area2;
+		faceNormals[t] = n;
+		for( int k = 0; k < 3; ++k )
+			mQuadrics[mGroups[mIndices[t * 3 + k]]].addPlane( n, -n.dot( p0 ), area2 * 0.5f );
+	}
+
+	// classify the edges: those with one triangle are borders, those whose two triangles use different vertex copies are seams,
+	// and those shared by more than two triangles are non-manifold and lock their vertices
+	vector<EdgeRef> edges( numTriangles * 3 );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		for( int k = 0; k < 3; ++k ) {
+			EdgeRef &e = edges[t * 3 + k];
+			e.mA = mIndices[t * 3 + k];
+			e.mB = mIndices[t * 3 + ( k + 1 ) % 3];
+			uint64_t ga = mGroups[e.mA], gb = mGroups[e.mB];
+			e.mKey = ( std::min( ga, gb ) << 32 ) | std::max( ga, gb );
+			e.mTriangle = (uint32_t)t;
+		}
+	}
+	std::sort( edges.begin(), edges.end() );
+
+	for( size_t i = 0; i < edges.size(); ) {
+		size_t end = i + 1;
+		while( end < edges.size() && edges[end].mKey == edges[i].mKey )
+			++end;
+
+		const uint32_t ga = mGroups[edges[i].mA], gb = mGroups[edges[i].mB];
+		bool constrain = false;
+		if( end - i == 1 ) {
+			mGroupFlags[ga] |= GROUP_BORDER;
+			mGroupFlags[gb] |= GROUP_BORDER;
+			if( mFormat.getLockBoundaries() ) {
+				mGroupFlags[ga] |= GROUP_LOCKED;
+				mGroupFlags[gb] |= GROUP_LOCKED;
+			}
+			constrain = true;
+		}
+		else if( end - i == 2 )
+			constrain = ! ( edges[i].mA == edges[i + 1].mB && edges[i].mB == edges[i + 1].mA );
+		else {
+			mGroupFlags[ga] |= GROUP_LOCKED;
+			mGroupFlags[gb] |= GROUP_LOCKED;
+		}
+
+		// constraint planes through the edge, perpendicular to the face, keep borders and seams from drifting
+		if( constrain ) {
+			for( size_t j = i; j < end; ++j ) {
+				const Vec3f &pa = mGroupPositions[ga], &pb = mGroupPositions[gb];
+				Vec3f edge = pb - pa;
+				Vec3f n = edge.cross( faceNormals[edges[j].mTriangle] );
+				float len = n.length();
+				if( len <= 0 )
+					continue;
+				n /= len;
+				float weight = edge.lengthSquared() * mFormat.getBoundaryWeight();
+				mQuadrics[ga].addPlane( n, -n.dot( pa ), weight );
+				mQuadrics[gb].addPlane( n, -n.dot( pa ), weight );
+			}
+		}
+
+		i = end;
+	}
+}
+
+void TriMeshSimplifier::buildAdjacency()
+{
+	const size_t numGroups = mGroupPositions.size();
+	const size_t numTriangles = mIndices.size() / 3;
+
+	mAdjacencyOffsets.assign( numGroups + 1, 0 );
+	for( size_t i = 0; i < mIndices.size(); ++i )
+		++mAdjacencyOffsets[mGroups[mIndices[i]] + 1];
+	for( size_t g = 0; g < numGroups; ++g )
+		mAdjacencyOffsets[g + 1] += mAdjacencyOffsets[g];
+
+	mAdjacency.resize( mIndices.size() );
+	vector<uint32_t> fill( mAdjacencyOffsets.begin(), mAdjacencyOffsets.end() - 1 );
+	for( size_t t = 0; t < numTriangles; ++t )
+		for( int k = 0; k < 3; ++k )
+			mAdjacency[fill[mGroups[mIndices[t * 3 + k]]]++] = (uint32_t)t;
+}
+
+void TriMeshSimplifier::gatherNeighbors( uint32_t group, vector<uint32_t> *result ) const
+{
+	result->clear();
+	for( uint32_t i = mAdjacencyOffsets[group]; i < mAdjacencyOffsets[group + 1]; ++i ) {
+		const uint32_t *tri = &mIndices[mAdjacency[i] * 3];
+		for( int k = 0; k < 3; ++k ) {
+			uint32_t g = mGroups[tri[k]];
+			if( g != group )
+				result->push_back( g );
+		}
+	}
+	std::sort( result->begin(), result->end() );
+	result->erase( std::unique( result->begin(), result->end() ), result->end() );
+}
+
+bool TriMeshSimplifier::isValidCollapse( uint32_t from, uint32_t to, vector<std::pair<uint32_t,uint32_t> > *remap ) const
+{
+	if( mGroupFlags[from] & GROUP_LOCKED )
+		return false;
+
+	// every copy of 'from' must map onto the copy of 'to' that it shares a triangle edge with, so that attributes stay continuous
+	remap->clear();
+	size_t numEdgeTriangles = 0;
+	uint32_t third[2] = { 0, 0 };
+	for( uint32_t i = mAdjacencyOffsets[from]; i < mAdjacencyOffsets[from + 1]; ++i ) {
+		const uint32_t *tri = &mIndices[mAdjacency[i] * 3];
+		int kFrom = -1, kTo = -1;
+		for( int k = 0; k < 3; ++k ) {
+			uint32_t g = mGroups[tri[k]];
+			if( g == from ) kFrom = k;
+			else if( g == to ) kTo = k;
+		}
+		if( kTo < 0 )
+			continue;
+		if( numEdgeTriangles == 2 )
+			return false;
+		third[numEdgeTriangles++] = mGroups[tri[3 - kFrom - kTo]];
+		for( size_t r = 0; r < remap->size(); ++r ) {
+			if( (*remap)[r].first == tri[kFrom] && (*remap)[r].second != tri[kTo] )
+				return false;
+		}
+		remap->push_back( std::make_pair( tri[kFrom], tri[kTo] ) );
+	}
+	if( numEdgeTriangles == 0 )
+		return false;
+	// border vertices only slide along their border
+	if( ( mGroupFlags[from] & GROUP_BORDER ) != 0 && numEdgeTriangles != 1 )
+		return false;
+	if( ( mGroupFlags[from] & GROUP_BORDER ) == 0 && numEdgeTriangles != 2 )
+		return false;
+
+	for( uint32_t i = mAdjacencyOffsets[from]; i < mAdjacencyOffsets[from + 1]; ++i ) {
+		const uint32_t *tri = &mIndices[mAdjacency[i] * 3];
+		uint32_t v = tri[0];
+		if( mGroups[tri[1]] == from ) v = tri[1];
+		else if( mGroups[tri[2]] == from ) v = tri[2];
+		bool mapped = false;
+		for( size_t r = 0; r < remap->size() && ! mapped; ++r )
+			mapped = (*remap)[r].first == v;
+		if( ! mapped )
+			return false;
+	}
+
+	// the link condition: the only neighbors in common are the opposite vertices of the collapsing edge, or the mesh would become non-manifold
+	vector<uint32_t> fromNeighbors, toNeighbors;
+	gatherNeighbors( from, &fromNeighbors );
+	gatherNeighbors( to, &toNeighbors );
+	size_t numCommon = 0;
+	for( size_t a = 0, b = 0; a < fromNeighbors.size() && b < toNeighbors.size(); ) {
+		if( fromNeighbors[a] < toNeighbors[b] ) ++a;
+		else if( toNeighbors[b] < fromNeighbors[a] ) ++b;
+		else { ++numCommon; ++a; ++b; }
+	}
+	if( numCommon != numEdgeTriangles || ( numEdgeTriangles == 2 && third[0] == third[1] ) )
+		return false;
+
+	// reject collapses that would flip, degenerate or turn any surviving triangle by more than about 78 degrees
+	const Vec3f &target = mGroupPositions[to];
+	for( uint32_t i = mAdjacencyOffsets[from]; i < mAdjacencyOffsets[from + 1]; ++i ) {
+		const uint32_t *tri = &mIndices[mAdjacency[i] * 3];
+		Vec3f p[3];
+		bool hasTo = false;
+		int kFrom = 0;
+		for( int k = 0; k < 3; ++k ) {
+			uint32_t g = mGroups[tri[k]];
+			p[k] = mGroupPositions[g];
+			hasTo = hasTo || g == to;
+			if( g == from ) kFrom = k;
+		}
+		if( hasTo )
+			continue;
+		Vec3f before = ( p[1] - p[0] ).cross( p[2] - p[0] );
+		p[kFrom] = target;
+		Vec3f after = ( p[1] - p[0] ).cross( p[2] - p[0] );
+		if( after.dot( before ) <= 0.2f * after.length() * before.length() )
+			return false;
+	}
+
+	return true;
+}
+
+float TriMeshSimplifier::collapseError( const Quadric &q, const Vec3f &p ) const
+{
+	if( q.w <= 0 )
+		return 0;
+	return (float)math<double>::sqrt( std::max( 0.0, q.eval( p ) / q.w ) );
+}
+
+size_t TriMeshSimplifier::simplify( size_t targetTriangles )
+{
+	const size_t numVertices = mGroups.size();
+	const size_t numGroups = mGroupPositions.size();
+	vector<Collapse> collapses;
+	vector<uint32_t> neighbors;
+	vector<std::pair<uint32_t,uint32_t> > remap;
+	vector<uint8_t> touched;
+	vector<uint32_t> vertexRemap;
+
+	while( getNumTriangles() > targetTriangles ) {
+		buildAdjacency();
+
+		// each group proposes its cheapest valid collapse
+		collapses.clear();
+		for( uint32_t from = 0; from < numGroups; ++from ) {
+			if( mAdjacencyOffsets[from] == mAdjacencyOffsets[from + 1] || ( mGroupFlags[from] & GROUP_LOCKED ) )
+				continue;
+
+			gatherNeighbors( from, &neighbors );
+			Collapse best( from, 0, -1 );
+			for( size_t n = 0; n < neighbors.size(); ++n ) {
+				const uint32_t to = neighbors[n];
+				Quadric q = mQuadrics[from];
+				q += mQuadrics[to];
+				double cost = q.eval( mGroupPositions[to] );
+				if( ( best.mCost >= 0 && cost >= best.mCost ) || collapseError( q, mGroupPositions[to] ) > mFormat.getMaxError() )
+					continue;
+				if( isValidCollapse( from, to, &remap ) )
+					best = Collapse( from, to, cost );
+			}
+			if( best.mCost >= 0 )
+				collapses.push_back( best );
+		}
+		if( collapses.empty() )
+			break;
+		std::sort( collapses.begin(), collapses.end() );
+
+		// apply the cheapest collapses whose neighborhoods don't overlap, so every one of them remains valid
+		touched.assign( numGroups, 0 );
+		vertexRemap.resize( numVertices );
+		for( size_t v = 0; v < numVertices; ++v )
+			vertexRemap[v] = (uint32_t)v;
+		size_t remaining = getNumTriangles();
+		size_t numApplied = 0;
+		for( size_t c = 0; c < collapses.size() && remaining > targetTriangles; ++c ) {
+			const Collapse &collapse = collapses[c];
+			if( touched[collapse.mFrom] || touched[collapse.mTo] )
+				continue;
+			isValidCollapse( collapse.mFrom, collapse.mTo, &remap );
+			for( size_t r = 0; r < remap.size(); ++r )
+				vertexRemap[remap[r].first] = remap[r].second;
+
+			Quadric &q = mQuadrics[collapse.mTo];
+			q += mQuadrics[collapse.mFrom];
+			mError = std::max( mError, collapseError( q, mGroupPositions[collapse.mTo] ) );
+			remaining -= ( mGroupFlags[collapse.mFrom] & GROUP_BORDER ) ? 1 : 2;
+			++numApplied;
+
+			touched[collapse.mFrom] = 1;
+			gatherNeighbors( collapse.mFrom, &neighbors );
+			for( size_t n = 0; n < neighbors.size(); ++n )
+				touched[neighbors[n]] = 1;
+		}
+		if( numApplied == 0 )
+			break;
+
+		size_t out = 0;
+		for( size_t t = 0; t < mIndices.size(); t += 3 ) {
+			uint32_t i0 = vertexRemap[mIndices[t]], i1 = vertexRemap[mIndices[t + 1]], i2 = vertexRemap[mIndices[t + 2]];
+			uint32_t g0 = mGroups[i0], g1 = mGroups[i1], g2 = mGroups[i2];
+			if( g0 == g1 || g1 == g2 || g0 == g2 )
+				continue;
+			mIndices[out++] = i0;
+			mIndices[out++] = i1;
+			mIndices[out++] = i2;
+		}
+		mIndices.resize( out );
+	}
+
+	return getNumTriangles();
+}
+
+TriMesh TriMeshSimplifier::getMesh() const
+{
+	const size_t numVertices = mGroups.size();
+	vector<uint32_t> newIndex( numVertices, 0 );
+	for( size_t i = 0; i < mIndices.size(); ++i )
+		newIndex[mIndices[i]] = 1;
+
+	TriMesh result;
+	const bool normals = mSource.getNormals().size() == numVertices;
+	const bool tangents = mSource.getTangents().size() == numVertices;
+	const bool texCoords = mSource.getTexCoords().size() == numVertices;
+	const bool colorsRgb = mSource.getColorsRGB().size() == numVertices;
+	const bool colorsRgba = mSource.getColorsRGBA().size() == numVertices;
+	uint32_t numUsed = 0;
+	for( size_t v = 0; v < numVertices; ++v ) {
+		if( ! newIndex[v] )
+			continue;
+		newIndex[v] = numUsed++;
+		result.appendVertex( mSource.getVertices()[v] );
+		if( normals )
+			result.appendNormal( mSource.getNormals()[v] );
+		if( tangents )
+			result.getTangents().push_back( mSource.getTangents()[v] );
+		if( texCoords )
+			result.appendTexCoord( mSource.getTexCoords()[v] );
+		if( colorsRgb )
+			result.appendColorRgb( mSource.getColorsRGB()[v] );
+		if( colorsRgba )
+			result.appendColorRgba( mSource.getColorsRGBA()[v] );
+	}
+
+	vector<uint32_t> &indices = result.getIndices();
+	indices.resize( mIndices.size() );
+	for( size_t i = 0; i < mIndices.size(); ++i )
+		indices[i] = newIndex[mIndices[i]];
+
+	return result;
+}
+
+vector<TriMesh> TriMeshSimplifier::createLodChain( const TriMesh &mesh, size_t maxLevels, float reduction, const Format &format, vector<float> *errors )
+{
+	vector<TriMesh> result;
+	if( maxLevels == 0 )
+		return result;
+
+	result.push_back( mesh );
+	if( errors )
+		errors->push_back( 0 );
+
+	TriMeshSimplifier simplifier( mesh, format );
+	size_t prevTriangles = mesh.getNumTriangles();
+	while( result.size() < maxLevels ) {
+		size_t numTriangles = simplifier.simplify( (size_t)( prevTriangles * reduction ) );
+		if( numTriangles == 0 || numTriangles >= prevTriangles )
+			break;
+		result.push_back( simplifier.getMesh() );
+		if( errors )
+			errors->push_back( simplifier.getError() );
+		prevTriangles = numTriangles;
+	}
+
+	return result;
+}
+
+} // namespace cinder
@@ -22,6 +22,7 @@
 
 #include "cinder/Triangulate.h"
 #include "cinder/Shape2d.h"
+#include "cinder/TaskPool.h"
 #include "../libtess2/tesselator.h"
 
 using namespace std;
@@ -102,11 +103,177 @@ TriMesh2d Triangulator::calcMesh( Winding winding )
 {
 	TriMesh2d result;
 	
-	tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 );
+	// fails without touching the previous output's counts when no contours were added, which happens on reuse
+	if( ! tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 ) )
+		return result;
 	result.appendVertices( (Vec2f*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
 	result.appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
 	
 	return result;
 }
 
+vector<TriMesh2d> Triangulator::calcMeshes( const vector<Shape2d> &shapes, Winding winding, float approximationScale, TriangulatorCache *cache, TaskPool *taskPool )
+{
+	vector<TriMesh2d> result( shapes.size() );
+	if( ! taskPool )
+		taskPool = TaskPool::get();
+
+	taskPool->parallelFor( 0, shapes.size(), [&]( size_t first, size_t last ) {
+		Triangulator triangulator;
+		for( size_t s = first; s < last; ++s ) {
+			if( cache && cache->find( shapes[s], winding, approximationScale, &result[s] ) )
+				continue;
+			if( shapes[s].getContours().empty() )
+				continue;
+
+			triangulator.addShape( shapes[s], approximationScale );
+			result[s] = triangulator.calcMesh( winding );
+			if( cache )
+				cache->insert( shapes[s], winding, approximationScale, result[s] );
+		}
+	} );
+
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TriangulatorCache
+namespace {
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+inline uint64_t hashBytes( uint64_t hash, const void *data, size_t size )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( data );
+	for( size_t b = 0; b < size; ++b )
+		hash = ( hash ^ bytes[b] ) * FNV_PRIME;
+	return hash;
+}
+
+bool shapesEqual( const Shape2d &a, const Shape2d &b )
+{
+	const vector<Path2d> &contoursA = a.getContours();
+	const vector<Path2d> &contoursB = b.getContours();
+	if( contoursA.size() != contoursB.size() )
+		return false;
+
+	for( size_t c = 0; c < contoursA.size(); ++c ) {
+		if( contoursA[c].getSegments() != contoursB[c].getSegments() || contoursA[c].getPoints() != contoursB[c].getPoints() )
+			return false;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+TriangulatorCache::TriangulatorCache( size_t maxMeshes )
+	: mMaxMeshes( maxMeshes ), mNumHits( 0 ), mNumMisses( 0 )
+{
+}
+
+uint64_t TriangulatorCache::calcHash( const Shape2d &shape, Triangulator::Winding winding, float approximationScale )
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	int32_t windingValue = (int32_t)winding;
+	hash = hashBytes( hash, &windingValue, sizeof(windingValue) );
+	hash = hashBytes( hash, &approximationScale, sizeof(approximationScale) );
+
+	const vector<Path2d> &contours = shape.getContours();
+	for( vector<Path2d>::const_iterator contourIt = contours.begin(); contourIt != contours.end(); ++contourIt ) {
+		// the segment count separates contours, so that points can't shift between them without changing the hash
+		uint32_t numSegments = (uint32_t)contourIt->getNumSegments();
+		hash = hashBytes( hash, &numSegments, sizeof(numSegments) );
+		for( size_t s = 0; s < numSegments; ++s ) {
+			uint8_t segmentType = (uint8_t)contourIt->getSegmentType( s );
+			hash = hashBytes( hash, &segmentType, sizeof(segmentType) );
+		}
+		const vector<Vec2f> &points = contourIt->getPoints();
+		if( ! points.empty() )
+			hash = hashBytes( hash, &points[0], points.size() * sizeof(Vec2f) );
+	}
+
+	return hash;
+}
+
+TriMesh2d TriangulatorCache::calcMesh( const Shape2d &shape, Triangulator::Winding winding, float approximationScale )
+{
+	TriMesh2d result;
+	if( find( shape, winding, approximationScale, &result ) )
+		return result;
+
+	if( ! shape.getContours().empty() )
+		result = Triangulator( shape, approximationScale ).calcMesh( winding );
+	insert( shape, winding, approximationScale, result );
+	return result;
+}
+
+bool TriangulatorCache::find( const Shape2d &shape, Triangulator::Winding winding, float approximationScale, TriMesh2d *result )
+{
+	uint64_t hash = calcHash( shape, winding, approximationScale );
+
+	lock_guard<mutex> lock( mMutex );
+	unordered_map<uint64_t,EntryList::iterator>::iterator indexIt = mIndex.find( hash );
+	if( indexIt != mIndex.end() ) {
+		const Entry &entry = *indexIt->second;
+		if( entry.mWinding == winding && entry.mApproximationScale == approximationScale && shapesEqual( entry.mShape, shape ) ) {
+			mEntries.splice( mEntries.begin(), mEntries, indexIt->second );
+			*result = entry.mMesh;
+			++mNumHits;
+			return true;
+		}
+	}
+
+	++mNumMisses;
+	return false;
+}
+
+void TriangulatorCache::insert( const Shape2d &shape, Triangulator::Winding winding, float approximationScale, const TriMesh2d &mesh )
+{
+	Entry entry;
+	entry.mHash = calcHash( shape, winding, approximationScale );
+	entry.mShape = shape;
+	entry.mWinding = winding;
+	entry.mApproximationScale = approximationScale;
+	entry.mMesh = mesh;
+
+	lock_guard<mutex> lock( mMutex );
+	unordered_map<uint64_t,EntryList::iterator>::iterator indexIt = mIndex.find( entry.mHash );
+	if( indexIt != mIndex.end() )
+		mEntries.erase( indexIt->second );
+
+	mEntries.push_front( entry );
+	mIndex[entry.mHash] = mEntries.begin();
+	evict();
+}
+
+void TriangulatorCache::clear()
+{
+	lock_guard<mutex> lock( mMutex );
+	mEntries.clear();
+	mIndex.clear();
+}
+
+size_t TriangulatorCache::getNumMeshes() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mEntries.size();
+}
+
+void TriangulatorCache::setMaxMeshes( size_t maxMeshes )
+{
+	lock_guard<mutex> lock( mMutex );
+	mMaxMeshes = maxMeshes;
+	evict();
+}
+
+void TriangulatorCache::evict()
+{
+	while( mEntries.size() > mMaxMeshes ) {
+		mIndex.erase( mEntries.back().mHash );
+		mEntries.pop_back();
+	}
+}
+
 } // namespace cinder
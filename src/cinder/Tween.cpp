@@ -32,6 +32,7 @@ namespace cinder {
 TweenBase::TweenBase( void *target, bool copyStartValue, float startTime, float duration, EaseFn easeFunction )
 	: TimelineItem( 0, target, startTime, duration ), mCopyStartValue( copyStartValue ), mEaseFunction( easeFunction )
 {
+	mEaseType = TweenBatch::getEaseType( mEaseFunction );
 }
 
 /*TweenScope::~TweenScope()
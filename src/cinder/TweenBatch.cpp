@@ -0,0 +1,383 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TweenBatch.h"
+#include "cinder/Easing.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/CinderMath.h"
+
+#include <limits>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+inline __m128 negate_ps( __m128 x )
+{
+	return _mm_xor_ps( x, _mm_set1_ps( -0.0f ) );
+}
+#endif
+
+// Each easing equation as a scalar function and an SSE equivalent performing the same operations in the same order, so that results are identical
+template<TweenBatch::EaseType EASE>
+struct Ease;
+
+template<>
+struct Ease<TweenBatch::EASE_IN_QUAD> {
+	static float scalar( float t ) { return easeInQuad( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t ) { return _mm_mul_ps( t, t ); }
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_OUT_QUAD> {
+	static float scalar( float t ) { return easeOutQuad( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t ) { return _mm_mul_ps( negate_ps( t ), _mm_sub_ps( t, _mm_set1_ps( 2 ) ) ); }
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_IN_OUT_QUAD> {
+	static float scalar( float t ) { return easeInOutQuad( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t )
+	{
+		t = _mm_mul_ps( t, _mm_set1_ps( 2 ) );
+		const __m128 in = _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 0.5f ), t ), t );
+		const __m128 u = _mm_sub_ps( t, _mm_set1_ps( 1 ) );
+		const __m128 out = _mm_mul_ps( _mm_set1_ps( -0.5f ), _mm_sub_ps( _mm_mul_ps( u, _mm_sub_ps( u, _mm_set1_ps( 2 ) ) ), _mm_set1_ps( 1 ) ) );
+		return select_ps( _mm_cmplt_ps( t, _mm_set1_ps( 1 ) ), in, out );
+	}
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_IN_CUBIC> {
+	static float scalar( float t ) { return easeInCubic( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t ) { return _mm_mul_ps( _mm_mul_ps( t, t ), t ); }
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_OUT_CUBIC> {
+	static float scalar( float t ) { return easeOutCubic( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t )
+	{
+		const __m128 u = _mm_sub_ps( t, _mm_set1_ps( 1 ) );
+		return _mm_add_ps( _mm_mul_ps( _mm_mul_ps( u, u ), u ), _mm_set1_ps( 1 ) );
+	}
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_IN_OUT_CUBIC> {
+	static float scalar( float t ) { return easeInOutCubic( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t )
+	{
+		t = _mm_mul_ps( t, _mm_set1_ps( 2 ) );
+		const __m128 in = _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 0.5f ), t ), t ), t );
+		const __m128 u = _mm_sub_ps( t, _mm_set1_ps( 2 ) );
+		const __m128 out = _mm_mul_ps( _mm_set1_ps( 0.5f ), _mm_add_ps( _mm_mul_ps( _mm_mul_ps( u, u ), u ), _mm_set1_ps( 2 ) ) );
+		return select_ps( _mm_cmplt_ps( t, _mm_set1_ps( 1 ) ), in, out );
+	}
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_IN_QUART> {
+	static float scalar( float t ) { return easeInQuart( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t ) { return _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( t, t ), t ), t ); }
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_OUT_QUART> {
+	static float scalar( float t ) { return easeOutQuart( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t )
+	{
+		const __m128 u = _mm_sub_ps( t, _mm_set1_ps( 1 ) );
+		return negate_ps( _mm_sub_ps( _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( u, u ), u ), u ), _mm_set1_ps( 1 ) ) );
+	}
+#endif
+};
+
+template<>
+struct Ease<TweenBatch::EASE_IN_OUT_QUART> {
+	static float scalar( float t ) { return easeInOutQuart( t ); }
+#if defined( CINDER_SSE2 )
+	static __m128 sse( __m128 t )
+	{
+		t = _mm_mul_ps( t, _mm_set1_ps( 2 ) );
+		const __m128 in = _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 0.5f ), t ), t ), t ), t );
+		const __m128 u = _mm_sub_ps( t, _mm_set1_ps( 2 ) );
+		const __m128 out = _mm_mul_ps( _mm_set1_ps( -0.5f ), _mm_sub_ps( _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( u, u ), u ), u ), _mm_set1_ps( 2 ) ) );
+		return select_ps( _mm_cmplt_ps( t, _mm_set1_ps( 1 ) ), in, out );
+	}
+#endif
+};
+
+template<TweenBatch::EaseType EASE>
+void easeTimes( float *times, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		for( ; i + 4 <= count; i += 4 )
+			_mm_storeu_ps( times + i, Ease<EASE>::sse( _mm_loadu_ps( times + i ) ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		times[i] = Ease<EASE>::scalar( times[i] );
+}
+
+void easeTimes( TweenBatch::EaseType easeType, float *times, size_t count )
+{
+	switch( easeType ) {
+		case TweenBatch::EASE_IN_QUAD: easeTimes<TweenBatch::EASE_IN_QUAD>( times, count ); break;
+		case TweenBatch::EASE_OUT_QUAD: easeTimes<TweenBatch::EASE_OUT_QUAD>( times, count ); break;
+		case TweenBatch::EASE_IN_OUT_QUAD: easeTimes<TweenBatch::EASE_IN_OUT_QUAD>( times, count ); break;
+		case TweenBatch::EASE_IN_CUBIC: easeTimes<TweenBatch::EASE_IN_CUBIC>( times, count ); break;
+		case TweenBatch::EASE_OUT_CUBIC: easeTimes<TweenBatch::EASE_OUT_CUBIC>( times, count ); break;
+		case TweenBatch::EASE_IN_OUT_CUBIC: easeTimes<TweenBatch::EASE_IN_OUT_CUBIC>( times, count ); break;
+		case TweenBatch::EASE_IN_QUART: easeTimes<TweenBatch::EASE_IN_QUART>( times, count ); break;
+		case TweenBatch::EASE_OUT_QUART: easeTimes<TweenBatch::EASE_OUT_QUART>( times, count ); break;
+		case TweenBatch::EASE_IN_OUT_QUART: easeTimes<TweenBatch::EASE_IN_OUT_QUART>( times, count ); break;
+		default: break; // EASE_NONE and EASE_CUSTOM times are already eased
+	}
+}
+
+// Computes the relative time of each tween, as TimelineItem::stepTo() does for a tween that neither loops nor ping-pongs
+void relativeTimes( float time, const float *startTimes, const float *invDurations, float *result, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128 now = _mm_set1_ps( time );
+		const __m128 one = _mm_set1_ps( 1 );
+		for( ; i + 4 <= count; i += 4 ) {
+			const __m128 absTime = _mm_sub_ps( now, _mm_loadu_ps( startTimes + i ) );
+			_mm_storeu_ps( result + i, _mm_min_ps( _mm_mul_ps( absTime, _mm_loadu_ps( invDurations + i ) ), one ) );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = math<float>::min( ( time - startTimes[i] ) * invDurations[i], 1 );
+}
+
+// Applies tweenLerp() to each update, interpolating its components together and writing the first \a NUM_COMPONENTS to its target
+template<size_t NUM_COMPONENTS, typename UpdateT>
+void lerpUpdates( const vector<UpdateT> &updates, const float *times )
+{
+	const size_t count = updates.size();
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128 one = _mm_set1_ps( 1 );
+		float values[4];
+		for( size_t i = 0; i < count; ++i ) {
+			const UpdateT &update = updates[i];
+			const __m128 t = _mm_set1_ps( times[i] );
+			const __m128 start = _mm_loadu_ps( update.mStartValue );
+			const __m128 end = _mm_loadu_ps( update.mEndValue );
+			_mm_storeu_ps( values, _mm_add_ps( _mm_mul_ps( start, _mm_sub_ps( one, t ) ), _mm_mul_ps( end, t ) ) );
+			for( size_t c = 0; c < NUM_COMPONENTS; ++c )
+				update.mTarget[c] = values[c];
+		}
+		return;
+	}
+#endif
+	for( size_t i = 0; i < count; ++i ) {
+		const UpdateT &update = updates[i];
+		const float t = times[i];
+		for( size_t c = 0; c < NUM_COMPONENTS; ++c )
+			update.mTarget[c] = update.mStartValue[c] * ( 1 - t ) + update.mEndValue[c] * t;
+	}
+}
+
+} // anonymous namespace
+
+TweenBatch::TweenBatch()
+	: mNumItems( 0 )
+{
+}
+
+TweenBatch::EaseType TweenBatch::getEaseType( const std::function<float (float)> &easeFn )
+{
+	typedef float (*EaseFnPtr)( float );
+
+	if( const EaseFnPtr *fnPtr = easeFn.target<EaseFnPtr>() ) {
+		const EaseFnPtr fn = *fnPtr;
+		if( fn == &easeNone ) return EASE_NONE;
+		else if( fn == &easeInQuad ) return EASE_IN_QUAD;
+		else if( fn == &easeOutQuad ) return EASE_OUT_QUAD;
+		else if( fn == &easeInOutQuad ) return EASE_IN_OUT_QUAD;
+		else if( fn == &easeInCubic ) return EASE_IN_CUBIC;
+		else if( fn == &easeOutCubic ) return EASE_OUT_CUBIC;
+		else if( fn == &easeInOutCubic ) return EASE_IN_OUT_CUBIC;
+		else if( fn == &easeInQuart ) return EASE_IN_QUART;
+		else if( fn == &easeOutQuart ) return EASE_OUT_QUART;
+		else if( fn == &easeInOutQuart ) return EASE_IN_OUT_QUART;
+	}
+	else if( easeFn.target<EaseNone>() ) return EASE_NONE;
+	else if( easeFn.target<EaseInQuad>() ) return EASE_IN_QUAD;
+	else if( easeFn.target<EaseOutQuad>() ) return EASE_OUT_QUAD;
+	else if( easeFn.target<EaseInOutQuad>() ) return EASE_IN_OUT_QUAD;
+	else if( easeFn.target<EaseInCubic>() ) return EASE_IN_CUBIC;
+	else if( easeFn.target<EaseOutCubic>() ) return EASE_OUT_CUBIC;
+	else if( easeFn.target<EaseInOutCubic>() ) return EASE_IN_OUT_CUBIC;
+	else if( easeFn.target<EaseInQuart>() ) return EASE_IN_QUART;
+	else if( easeFn.target<EaseOutQuart>() ) return EASE_OUT_QUART;
+	else if( easeFn.target<EaseInOutQuart>() ) return EASE_IN_OUT_QUART;
+
+	return EASE_CUSTOM;
+}
+
+void TweenBatch::add( TimelineItem *item, int groupIndex, const Update &update, const std::function<float (float)> *easeFn )
+{
+	Group &group = mGroups[groupIndex];
+
+	item->updateDuration();
+	item->mSlot.mBatchGroup = groupIndex;
+	item->mSlot.mBatchIndex = static_cast<uint32_t>( group.mItems.size() );
+
+	group.mStartTimes.push_back( item->mStartTime );
+	group.mInvDurations.push_back( item->mInvDuration );
+	// an infinite item is never complete, so never leaves the batch
+	group.mEndTimes.push_back( item->mInfinite ? numeric_limits<float>::max() : ( item->mStartTime + item->mDuration ) );
+	group.mUpdates.push_back( update );
+	group.mItems.push_back( item );
+	if( groupIndex % NUM_EASE_TYPES == EASE_CUSTOM )
+		group.mEaseFns.push_back( easeFn );
+	++mNumItems;
+}
+
+void TweenBatch::remove( TimelineItem *item )
+{
+	removeAt( item->mSlot.mBatchGroup, item->mSlot.mBatchIndex );
+}
+
+// Moves the group's last item into \a index
+void TweenBatch::removeAt( int groupIndex, size_t index )
+{
+	Group &group = mGroups[groupIndex];
+	group.mItems[index]->mSlot.mBatchGroup = -1;
+
+	const size_t last = group.mItems.size() - 1;
+	if( index != last ) {
+		group.mStartTimes[index] = group.mStartTimes[last];
+		group.mInvDurations[index] = group.mInvDurations[last];
+		group.mEndTimes[index] = group.mEndTimes[last];
+		group.mUpdates[index] = group.mUpdates[last];
+		group.mItems[index] = group.mItems[last];
+		group.mItems[index]->mSlot.mBatchIndex = static_cast<uint32_t>( index );
+		if( ! group.mEaseFns.empty() )
+			group.mEaseFns[index] = group.mEaseFns[last];
+	}
+
+	group.mStartTimes.pop_back();
+	group.mInvDurations.pop_back();
+	group.mEndTimes.pop_back();
+	group.mUpdates.pop_back();
+	group.mItems.pop_back();
+	if( ! group.mEaseFns.empty() )
+		group.mEaseFns.pop_back();
+	--mNumItems;
+}
+
+void TweenBatch::clear( vector<TimelineItemRef> *removed )
+{
+	for( int g = 0; g < 4 * NUM_EASE_TYPES; ++g ) {
+		Group &group = mGroups[g];
+		for( vector<TimelineItem*>::iterator itemIt = group.mItems.begin(); itemIt != group.mItems.end(); ++itemIt ) {
+			(*itemIt)->mSlot.mBatchGroup = -1;
+			removed->push_back( (*itemIt)->mSlot.mItemsIt->second );
+		}
+		group.mStartTimes.clear();
+		group.mInvDurations.clear();
+		group.mEndTimes.clear();
+		group.mUpdates.clear();
+		group.mItems.clear();
+		group.mEaseFns.clear();
+	}
+	mNumItems = 0;
+}
+
+void TweenBatch::stepTo( float time, vector<TimelineItemRef> *finished )
+{
+	for( int g = 0; g < 4 * NUM_EASE_TYPES; ++g ) {
+		Group &group = mGroups[g];
+		const size_t count = group.mItems.size();
+		if( count == 0 )
+			continue;
+
+		mTimes.resize( count );
+		relativeTimes( time, &group.mStartTimes[0], &group.mInvDurations[0], &mTimes[0], count );
+
+		const EaseType easeType = static_cast<EaseType>( g % NUM_EASE_TYPES );
+		if( easeType == EASE_CUSTOM ) {
+			for( size_t i = 0; i < count; ++i )
+				mTimes[i] = (*group.mEaseFns[i])( mTimes[i] );
+		}
+		else
+			easeTimes( easeType, &mTimes[0], count );
+
+		switch( g / NUM_EASE_TYPES ) {
+			case 0: lerpUpdates<1>( group.mUpdates, &mTimes[0] ); break;
+			case 1: lerpUpdates<2>( group.mUpdates, &mTimes[0] ); break;
+			case 2: lerpUpdates<3>( group.mUpdates, &mTimes[0] ); break;
+			default: lerpUpdates<4>( group.mUpdates, &mTimes[0] ); break;
+		}
+
+		// items that have reached their end are handed back, for TimelineItem::stepTo() to complete
+		for( size_t i = count; i-- > 0; ) {
+			if( time >= group.mEndTimes[i] ) {
+				TimelineItem *item = group.mItems[i];
+				removeAt( g, i );
+				finished->push_back( item->mSlot.mItemsIt->second );
+			}
+		}
+	}
+}
+
+} // namespace cinder
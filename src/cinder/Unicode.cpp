@@ -45,6 +45,8 @@
  */
 
 #include "cinder/Unicode.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 #include <cstring>
 #include <string>
 
@@ -72,21 +74,246 @@ static const int halfShift = 10; // shift by 10 bits
 #define UNI_MAX_UTF32			(char32_t)0x7FFFFFFF
 #define UNI_MAX_LEGAL_UTF32		(char32_t)0x0010FFFF
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+#endif
+
+#if defined( CINDER_NEON )
+bool anyBitsNeon( uint8x16_t v )
+{
+	const uint8x8_t folded = vorr_u8( vget_low_u8( v ), vget_high_u8( v ) );
+	return vget_lane_u64( vreinterpret_u64_u8( folded ), 0 ) != 0;
+}
+#endif
+
+// Each of the ASCII helpers converts the leading run of ASCII code units in 'src', up to 'count', and returns the length of that run.
+// Blocks of 16 units are handled with SIMD, stopping at the first block containing anything else
+size_t widenAscii( const char *src, size_t count, char16_t *dst )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128i zero = _mm_setzero_si128();
+		for( ; i + 16 <= count; i += 16 ) {
+			const __m128i v = _mm_loadu_si128( (const __m128i*)( src + i ) );
+			if( _mm_movemask_epi8( v ) )
+				break;
+			_mm_storeu_si128( (__m128i*)( dst + i ), _mm_unpacklo_epi8( v, zero ) );
+			_mm_storeu_si128( (__m128i*)( dst + i + 8 ), _mm_unpackhi_epi8( v, zero ) );
+		}
+	}
+#elif defined( CINDER_NEON )
+	for( ; i + 16 <= count; i += 16 ) {
+		const uint8x16_t v = vld1q_u8( (const uint8_t*)( src + i ) );
+		if( anyBitsNeon( vandq_u8( v, vdupq_n_u8( 0x80 ) ) ) )
+			break;
+		vst1q_u16( (uint16_t*)( dst + i ), vmovl_u8( vget_low_u8( v ) ) );
+		vst1q_u16( (uint16_t*)( dst + i + 8 ), vmovl_u8( vget_high_u8( v ) ) );
+	}
+#endif
+	for( ; i < count && (uint8_t)src[i] < 0x80; ++i )
+		dst[i] = (char16_t)src[i];
+	return i;
+}
+
+size_t widenAscii( const char *src, size_t count, char32_t *dst )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128i zero = _mm_setzero_si128();
+		for( ; i + 16 <= count; i += 16 ) {
+			const __m128i v = _mm_loadu_si128( (const __m128i*)( src + i ) );
+			if( _mm_movemask_epi8( v ) )
+				break;
+			const __m128i lo = _mm_unpacklo_epi8( v, zero ), hi = _mm_unpackhi_epi8( v, zero );
+			_mm_storeu_si128( (__m128i*)( dst + i ), _mm_unpacklo_epi16( lo, zero ) );
+			_mm_storeu_si128( (__m128i*)( dst + i + 4 ), _mm_unpackhi_epi16( lo, zero ) );
+			_mm_storeu_si128( (__m128i*)( dst + i + 8 ), _mm_unpacklo_epi16( hi, zero ) );
+			_mm_storeu_si128( (__m128i*)( dst + i + 12 ), _mm_unpackhi_epi16( hi, zero ) );
+		}
+	}
+#elif defined( CINDER_NEON )
+	for( ; i + 16 <= count; i += 16 ) {
+		const uint8x16_t v = vld1q_u8( (const uint8_t*)( src + i ) );
+		if( anyBitsNeon( vandq_u8( v, vdupq_n_u8( 0x80 ) ) ) )
+			break;
+		const uint16x8_t lo = vmovl_u8( vget_low_u8( v ) ), hi = vmovl_u8( vget_high_u8( v ) );
+		vst1q_u32( (uint32_t*)( dst + i ), vmovl_u16( vget_low_u16( lo ) ) );
+		vst1q_u32( (uint32_t*)( dst + i + 4 ), vmovl_u16( vget_high_u16( lo ) ) );
+		vst1q_u32( (uint32_t*)( dst + i + 8 ), vmovl_u16( vget_low_u16( hi ) ) );
+		vst1q_u32( (uint32_t*)( dst + i + 12 ), vmovl_u16( vget_high_u16( hi ) ) );
+	}
+#endif
+	for( ; i < count && (uint8_t)src[i] < 0x80; ++i )
+		dst[i] = (char32_t)src[i];
+	return i;
+}
+
+size_t narrowAscii( const char16_t *src, size_t count, char *dst )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128i nonAscii = _mm_set1_epi16( (short)0xFF80 ), zero = _mm_setzero_si128();
+		for( ; i + 16 <= count; i += 16 ) {
+			const __m128i a = _mm_loadu_si128( (const __m128i*)( src + i ) );
+			const __m128i b = _mm_loadu_si128( (const __m128i*)( src + i + 8 ) );
+			const __m128i high = _mm_and_si128( _mm_or_si128( a, b ), nonAscii );
+			if( _mm_movemask_epi8( _mm_cmpeq_epi16( high, zero ) ) != 0xFFFF )
+				break;
+			_mm_storeu_si128( (__m128i*)( dst + i ), _mm_packus_epi16( a, b ) );
+		}
+	}
+#elif defined( CINDER_NEON )
+	for( ; i + 16 <= count; i += 16 ) {
+		const uint16x8_t a = vld1q_u16( (const uint16_t*)( src + i ) );
+		const uint16x8_t b = vld1q_u16( (const uint16_t*)( src + i + 8 ) );
+		if( anyBitsNeon( vreinterpretq_u8_u16( vandq_u16( vorrq_u16( a, b ), vdupq_n_u16( 0xFF80 ) ) ) ) )
+			break;
+		vst1q_u8( (uint8_t*)( dst + i ), vcombine_u8( vmovn_u16( a ), vmovn_u16( b ) ) );
+	}
+#endif
+	for( ; i < count && src[i] < 0x80; ++i )
+		dst[i] = (char)src[i];
+	return i;
+}
+
+size_t narrowAscii( const char32_t *src, size_t count, char *dst )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128i nonAscii = _mm_set1_epi32( (int)0xFFFFFF80 ), zero = _mm_setzero_si128();
+		for( ; i + 16 <= count; i += 16 ) {
+			__m128i v[4];
+			for( int j = 0; j < 4; ++j )
+				v[j] = _mm_loadu_si128( (const __m128i*)( src + i + j * 4 ) );
+			const __m128i high = _mm_and_si128( _mm_or_si128( _mm_or_si128( v[0], v[1] ), _mm_or_si128( v[2], v[3] ) ), nonAscii );
+			if( _mm_movemask_epi8( _mm_cmpeq_epi32( high, zero ) ) != 0xFFFF )
+				break;
+			const __m128i lo = _mm_packs_epi32( v[0], v[1] ), hi = _mm_packs_epi32( v[2], v[3] );
+			_mm_storeu_si128( (__m128i*)( dst + i ), _mm_packus_epi16( lo, hi ) );
+		}
+	}
+#elif defined( CINDER_NEON )
+	for( ; i + 16 <= count; i += 16 ) {
+		uint32x4_t v[4];
+		for( int j = 0; j < 4; ++j )
+			v[j] = vld1q_u32( (const uint32_t*)( src + i + j * 4 ) );
+		const uint32x4_t all = vorrq_u32( vorrq_u32( v[0], v[1] ), vorrq_u32( v[2], v[3] ) );
+		if( anyBitsNeon( vreinterpretq_u8_u32( vandq_u32( all, vdupq_n_u32( 0xFFFFFF80 ) ) ) ) )
+			break;
+		const uint16x8_t lo = vcombine_u16( vmovn_u32( v[0] ), vmovn_u32( v[1] ) );
+		const uint16x8_t hi = vcombine_u16( vmovn_u32( v[2] ), vmovn_u32( v[3] ) );
+		vst1q_u8( (uint8_t*)( dst + i ), vcombine_u8( vmovn_u16( lo ), vmovn_u16( hi ) ) );
+	}
+#endif
+	for( ; i < count && src[i] < 0x80; ++i )
+		dst[i] = (char)src[i];
+	return i;
+}
+
+inline uint32_t codeUnit( char c ) { return (uint8_t)c; }
+inline uint32_t codeUnit( char16_t c ) { return c; }
+inline uint32_t codeUnit( char32_t c ) { return c; }
+
+// Returns the end of the run of non-ASCII code units starting at 'src'. ASCII never occurs inside a multi-unit
+// sequence in UTF-8 or UTF-16, so the run always ends on a code point boundary
+template<typename T>
+const T* nonAsciiRunEnd( const T *src, const T *end )
+{
+	while( src != end && codeUnit( *src ) >= 0x80 )
+		++src;
+	return src;
+}
+
+} // anonymous namespace
+
+size_t toUtf16( const char *utf8Str, size_t lengthInBytes, char16_t *result )
+{
+	const char *src = utf8Str, *end = utf8Str + lengthInBytes;
+	char16_t *dst = result;
+	while( src != end ) {
+		const size_t ascii = widenAscii( src, end - src, dst );
+		src += ascii;
+		dst += ascii;
+		const char *runEnd = nonAsciiRunEnd( src, end );
+		dst = utf8::utf8to16( src, runEnd, dst );
+		src = runEnd;
+	}
+
+	return dst - result;
+}
+
+size_t toUtf32( const char *utf8Str, size_t lengthInBytes, char32_t *result )
+{
+	const char *src = utf8Str, *end = utf8Str + lengthInBytes;
+	char32_t *dst = result;
+	while( src != end ) {
+		const size_t ascii = widenAscii( src, end - src, dst );
+		src += ascii;
+		dst += ascii;
+		const char *runEnd = nonAsciiRunEnd( src, end );
+		dst = utf8::utf8to32( src, runEnd, dst );
+		src = runEnd;
+	}
+
+	return dst - result;
+}
+
+size_t toUtf8( const char16_t *utf16Str, size_t lengthInBytes, char *result )
+{
+	const char16_t *src = utf16Str, *end = utf16Str + lengthInBytes / 2;
+	char *dst = result;
+	while( src != end ) {
+		const size_t ascii = narrowAscii( src, end - src, dst );
+		src += ascii;
+		dst += ascii;
+		const char16_t *runEnd = nonAsciiRunEnd( src, end );
+		dst = utf8::utf16to8( src, runEnd, dst );
+		src = runEnd;
+	}
+
+	return dst - result;
+}
+
+size_t toUtf8( const char32_t *utf32Str, size_t lengthInBytes, char *result )
+{
+	const char32_t *src = utf32Str, *end = utf32Str + lengthInBytes / 4;
+	char *dst = result;
+	while( src != end ) {
+		const size_t ascii = narrowAscii( src, end - src, dst );
+		src += ascii;
+		dst += ascii;
+		const char32_t *runEnd = nonAsciiRunEnd( src, end );
+		dst = utf8::utf32to8( src, runEnd, dst );
+		src = runEnd;
+	}
+
+	return dst - result;
+}
+
 std::u16string toUtf16( const char *utf8Str, size_t lengthInBytes )
 {
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( utf8Str );
 	
-	std::u16string result;
-	utf8::utf8to16( utf8Str, utf8Str + lengthInBytes, back_inserter( result ));
+	std::u16string result( lengthInBytes, 0 );
+	if( lengthInBytes )
+		result.resize( toUtf16( utf8Str, lengthInBytes, &result[0] ) );
 	return result;
 }
 
 std::u16string toUtf16( const std::string &utf8Str )
 {
-	std::u16string result;
-	utf8::utf8to16( utf8Str.begin(), utf8Str.end(), back_inserter( result ));
-	return result;
+	return toUtf16( utf8Str.c_str(), utf8Str.size() );
 }
 
 std::u32string toUtf32( const char *utf8Str, size_t lengthInBytes )
@@ -94,56 +321,54 @@ std::u32string toUtf32( const char *utf8Str, size_t lengthInBytes )
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( utf8Str );
 	
-	std::u32string result;
-	utf8::utf8to32( utf8Str, utf8Str + lengthInBytes, back_inserter( result ));
+	std::u32string result( lengthInBytes, 0 );
+	if( lengthInBytes )
+		result.resize( toUtf32( utf8Str, lengthInBytes, &result[0] ) );
 	return result;
 }
 
 std::u32string toUtf32( const std::string &utf8Str )
 {
-	std::u32string result;
-	utf8::utf8to32( utf8Str.begin(), utf8Str.end(), back_inserter( result ));
-	return result;
+	return toUtf32( utf8Str.c_str(), utf8Str.size() );
 }
 
 std::string toUtf8( const char16_t *utf16Str, size_t lengthInBytes )
 {
-	if( lengthInBytes == 0 )
+	if( lengthInBytes == 0 ) {
 		while( utf16Str[lengthInBytes] )
 			++lengthInBytes;
-	else
-		lengthInBytes /= 2;
+		lengthInBytes *= 2;
+	}
 
-	std::string result;
-	utf8::utf16to8( utf16Str, utf16Str + lengthInBytes, back_inserter( result ));
+	// at most 3 UTF-8 bytes per UTF-16 code unit
+	std::string result( lengthInBytes / 2 * 3, 0 );
+	if( lengthInBytes )
+		result.resize( toUtf8( utf16Str, lengthInBytes, &result[0] ) );
 	return result;	
 }
 
 std::string	toUtf8( const std::u16string &utf16Str )
 {
-	std::string result;
-	utf8::utf16to8( utf16Str.begin(), utf16Str.end(), back_inserter( result ));
-	return result;
+	return toUtf8( utf16Str.c_str(), utf16Str.size() * 2 );
 }
 
 std::string toUtf8( const char32_t *utf32Str, size_t lengthInBytes )
 {
-	if( lengthInBytes == 0 )
+	if( lengthInBytes == 0 ) {
 		while( utf32Str[lengthInBytes] )
 			++lengthInBytes;
-	else
-		lengthInBytes /= 4;
+		lengthInBytes *= 4;
+	}
 
-	std::string result;
-	utf8::utf32to8( utf32Str, utf32Str + lengthInBytes, back_inserter( result ));
+	std::string result( lengthInBytes, 0 );
+	if( lengthInBytes )
+		result.resize( toUtf8( utf32Str, lengthInBytes, &result[0] ) );
 	return result;
 }
 
 std::string	toUtf8( const std::u32string &utf32Str )
 {
-	std::string result;
-	utf8::utf32to8( utf32Str.begin(), utf32Str.end(), back_inserter( result ));
-	return result;
+	return toUtf8( utf32Str.c_str(), utf32Str.size() * 4 );
 }
 
 size_t stringLengthUtf8( const char *str, size_t lengthInBytes )
@@ -302,6 +527,54 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 	}
 }
 
+void lineBreakUtf8( const char *str, size_t lengthInBytes, float maxWidth, const std::function<float(uint32_t,uint32_t)> &advanceFn, const std::function<void(const char *,size_t)> &lineProcessFn )
+{
+	if( lengthInBytes == 0 )
+		lengthInBytes = strlen( str );
+	if( lengthInBytes == 0 )
+		return;
+
+	// typical paragraphs fit the stack buffer, so the break opportunities don't require an allocation
+	char stackBreaks[1024];
+	std::vector<char> heapBreaks;
+	char *brks = stackBreaks;
+	if( lengthInBytes > sizeof(stackBreaks) ) {
+		heapBreaks.resize( lengthInBytes );
+		brks = &heapBreaks[0];
+	}
+	set_linebreaks_utf8( (const uint8_t*)str, lengthInBytes, NULL, brks );
+
+	size_t lineStartByte = 0;
+	while( lineStartByte < lengthInBytes ) {
+		// widths accumulate one character at a time; 'lastBreakByte' is the end of the last break opportunity which fit
+		float width = 0;
+		uint32_t prevChar = 0;
+		size_t lastBreakByte = lineStartByte, curByte = lineStartByte, lineEndByte = lengthInBytes;
+		while( curByte < lengthInBytes ) {
+			const size_t charStartByte = curByte;
+			const uint32_t ch = lb_get_next_char_utf8( (const utf8_t*)str, lengthInBytes, &curByte );
+			width += advanceFn( prevChar, ch );
+			prevChar = ch;
+			if( width > maxWidth && charStartByte > lineStartByte ) { // always place at least one character
+				lineEndByte = ( lastBreakByte > lineStartByte ) ? lastBreakByte : charStartByte;
+				break;
+			}
+			else if( brks[curByte-1] == LINEBREAK_MUSTBREAK ) {
+				lineEndByte = curByte;
+				break;
+			}
+			else if( brks[curByte-1] == LINEBREAK_ALLOWBREAK )
+				lastBreakByte = curByte;
+		}
+
+		lineProcessFn( str + lineStartByte, lineEndByte - lineStartByte );
+		lineStartByte = lineEndByte;
+		// eat any spaces we'd start on on the next line
+		while( lineStartByte < lengthInBytes && str[lineStartByte] == ' ' )
+			++lineStartByte;
+	}
+}
+
 void calcLinebreaksUtf8( const char *str, std::vector<uint8_t> *resultBreaks )
 {
 	calcLinebreaksUtf8( str, strlen( str ), resultBreaks );
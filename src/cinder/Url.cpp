@@ -26,14 +26,19 @@
 #include "cinder/DataSource.h"
 #include "cinder/Utilities.h"
 #include "cinder/Unicode.h"
+#if defined( CINDER_MSW ) || defined( CINDER_COCOA )
+	#include "cinder/UrlImplRanged.h"
+#endif
 #if defined( CINDER_MSW )
 	#include <Shlwapi.h>
 	#include "cinder/UrlImplWinInet.h"
 	typedef cinder::IStreamUrlImplWinInet	IStreamUrlPlatformImpl;
+	typedef cinder::UrlFetchSessionWinInet	UrlFetchSessionPlatformImpl;
 #elif defined( CINDER_COCOA )
 	#include "cinder/cocoa/CinderCocoa.h"
 	#include "cinder/UrlImplCocoa.h"
 	typedef cinder::IStreamUrlImplCocoa		IStreamUrlPlatformImpl;
+	typedef cinder::UrlFetchSessionCocoa	UrlFetchSessionPlatformImpl;
 #elif defined( CINDER_WINRT )
 	#include "cinder/WinRTUtils.h"
 	#include "cinder/msw/CinderMsw.h"
@@ -90,7 +95,12 @@ IStreamUrl::IStreamUrl( const std::string &url, const std::string &user, const s
 	: IStreamCinder()
 {
 	setFileName( url );
-	mImpl = std::shared_ptr<IStreamUrlImpl>( new IStreamUrlPlatformImpl( url, user, password, options ) );
+#if defined( CINDER_MSW ) || defined( CINDER_COCOA )
+	if( options.getRangeRequests() )
+		mImpl = IStreamUrlImplRanged::create( url, user, password, options );
+	if( ! mImpl )
+#endif
+		mImpl = std::shared_ptr<IStreamUrlImpl>( new IStreamUrlPlatformImpl( url, user, password, options ) );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -104,6 +114,50 @@ IStreamUrlRef loadUrlStream( const std::string &url, const std::string &user, co
 {
 	return IStreamUrl::create( Url( url ), user, password, options );
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlFetchSessionImpl
+#if ! defined( CINDER_MSW ) && ! defined( CINDER_COCOA )
+namespace {
+
+// Reads each request through an IStreamUrl, which opens a new connection every time
+class UrlFetchSessionStream : public UrlFetchSessionImpl {
+  public:
+	UrlFetchSessionStream( size_t /*maxConnectionsPerServer*/ ) {}
+
+	virtual int fetch( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, Buffer *data )
+	{
+		IStreamUrlRef stream = IStreamUrl::create( url, user, password, options );
+		Buffer result( 64 * 1024 );
+		size_t size = 0;
+		while( ! stream->isEof() ) {
+			if( size == result.getAllocatedSize() )
+				result.resize( size * 2 );
+			size += stream->readDataAvailable( (uint8_t*)result.getData() + size, result.getAllocatedSize() - size );
+		}
+		result.setDataSize( size );
+		*data = result;
+		return 200; // IStreamUrl throws UrlLoadExc for error statuses
+	}
+
+	// IStreamUrl can't send a Range header, so the complete body is returned
+	virtual int fetchRange( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, uint64_t /*offset*/, size_t /*size*/, Buffer *data, int64_t *totalSize )
+	{
+		int status = fetch( url, user, password, options, data );
+		*totalSize = data->getDataSize();
+		return status;
+	}
+};
+
+} // anonymous namespace
+
+typedef UrlFetchSessionStream	UrlFetchSessionPlatformImpl;
+#endif
+
+std::shared_ptr<UrlFetchSessionImpl> UrlFetchSessionImpl::create( size_t maxConnectionsPerServer )
+{
+	return std::shared_ptr<UrlFetchSessionImpl>( new UrlFetchSessionPlatformImpl( maxConnectionsPerServer ) );
+}
 #endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,283 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/UrlFetcher.h"
+#include "cinder/Utilities.h"
+#include "cinder/app/App.h"
+
+#include <algorithm>
+#include <ctime>
+#include <cstdio>
+
+using namespace std;
+
+namespace cinder {
+
+#if ! defined( CINDER_WINRT )
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - UrlFetchRequest
+// ----------------------------------------------------------------------------------------------------
+
+UrlFetchRequest::UrlFetchRequest( const weak_ptr<UrlFetcher> &fetcher, const Url &url, const UrlOptions &options, const string &user, const string &password )
+	: mFetcher( fetcher ), mUrl( url ), mOptions( options ), mUser( user ), mPassword( password ), mState( PENDING ), mStatusCode( 0 ), mFromCache( false )
+{
+}
+
+bool UrlFetchRequest::cancel()
+{
+	UrlFetcherRef fetcher = mFetcher.lock();
+	if( ! fetcher ) {
+		mState = CANCELED;
+		return false;
+	}
+
+	lock_guard<mutex> lock( fetcher->mMutex );
+	const State state = getState();
+	if( state == PENDING ) {
+		Queue::iterator queueIt = find_if( fetcher->mQueue.begin(), fetcher->mQueue.end(), [this]( const UrlFetchRequestRef &request ) { return request.get() == this; } );
+		if( queueIt != fetcher->mQueue.end() )
+			fetcher->mQueue.erase( queueIt );
+	}
+
+	mState = CANCELED;
+	return state == PENDING;
+}
+
+DataSourceRef UrlFetchRequest::getDataSource() const
+{
+	// strip the query and fragment so that only the path's extension remains
+	string path = mUrl.str();
+	path = path.substr( 0, path.find_first_of( "?#" ) );
+	return DataSourceBuffer::create( mData, path );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - UrlFetcher
+// ----------------------------------------------------------------------------------------------------
+
+// static
+UrlFetcherRef UrlFetcher::create( const Format &format )
+{
+	return UrlFetcherRef( new UrlFetcher( format ) );
+}
+
+UrlFetcher::UrlFetcher( const Format &format )
+	: mFormat( format ), mNumActiveWorkers( 0 )
+{
+	mSession = UrlFetchSessionImpl::create( mFormat.getMaxConnections() );
+	if( ! mFormat.getCacheDirectory().empty() )
+		createDirectories( mFormat.getCacheDirectory() );
+}
+
+UrlFetchRequestRef UrlFetcher::fetch( const Url &url, const Callback &callback, const UrlOptions &options, const string &user, const string &password )
+{
+	UrlFetchRequestRef request( new UrlFetchRequest( shared_from_this(), url, options, user, password ) );
+	request->mCallback = callback;
+
+	bool startWorker = false;
+	{
+		lock_guard<mutex> lock( mMutex );
+		mQueue.push_back( request );
+		if( mNumActiveWorkers < mFormat.getMaxConnections() ) {
+			++mNumActiveWorkers;
+			startWorker = true;
+		}
+	}
+
+	// network requests block for most of their duration, so rather than occupy the TaskPool each worker gets its own thread, which exits once the queue is empty
+	if( startWorker ) {
+		UrlFetcherRef self = shared_from_this();
+		thread( [self] { self->processRequests(); } ).detach();
+	}
+
+	return request;
+}
+
+void UrlFetcher::processRequests()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		UrlFetchRequestRef request;
+		{
+			lock_guard<mutex> lock( mMutex );
+			if( mQueue.empty() ) {
+				--mNumActiveWorkers;
+				return;
+			}
+
+			request = mQueue.front();
+			mQueue.pop_front();
+			request->mState = UrlFetchRequest::FETCHING;
+		}
+
+		int statusCode = 0;
+		Buffer data;
+		bool fromCache = false;
+		string errorMessage;
+		try {
+			if( readCache( request->mUrl, request->mOptions, &data ) ) {
+				statusCode = 200;
+				fromCache = true;
+			}
+			else {
+				statusCode = mSession->fetch( request->mUrl, request->mUser, request->mPassword, request->mOptions, &data );
+				if( statusCode >= 400 )
+					errorMessage = "HTTP error " + toString( statusCode ) + " fetching " + request->mUrl.str();
+			}
+		}
+		catch( UrlLoadExc &exc ) {
+			statusCode = exc.statusCode();
+			errorMessage = exc.what();
+		}
+		catch( std::exception &exc ) {
+			errorMessage = exc.what();
+		}
+		if( ! errorMessage.empty() )
+			data.reset();
+		else if( ! fromCache && ( statusCode < 300 ) )
+			writeCache( request->mUrl, data );
+
+		{
+			lock_guard<mutex> lock( mMutex );
+			if( request->getState() == UrlFetchRequest::CANCELED )
+				continue;
+
+			request->mStatusCode = statusCode;
+			request->mData = data;
+			request->mFromCache = fromCache;
+			request->mErrorMessage = errorMessage;
+			request->mState = errorMessage.empty() ? UrlFetchRequest::COMPLETE : UrlFetchRequest::FAILED;
+		}
+
+		UrlFetcherRef self = shared_from_this();
+		auto app = app::App::get();
+		if( app )
+			app->dispatchAsync( [self, request] { self->deliver( request ); } );
+		else
+			deliver( request );
+	}
+}
+
+void UrlFetcher::deliver( const UrlFetchRequestRef &request )
+{
+	if( request->mCallback && ! request->isCanceled() )
+		request->mCallback( request );
+}
+
+void UrlFetcher::cancelAll()
+{
+	lock_guard<mutex> lock( mMutex );
+	for( UrlFetchRequest::Queue::iterator queueIt = mQueue.begin(); queueIt != mQueue.end(); ++queueIt )
+		(*queueIt)->mState = UrlFetchRequest::CANCELED;
+	mQueue.clear();
+}
+
+size_t UrlFetcher::getNumPending() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mQueue.size();
+}
+
+fs::path UrlFetcher::getCachePath( const Url &url ) const
+{
+	if( mFormat.getCacheDirectory().empty() )
+		return fs::path();
+
+	// 64-bit FNV-1a, which unlike std::hash is stable across runs and platforms
+	const string urlStr = url.str();
+	uint64_t hash = 14695981039346656037ULL;
+	for( string::const_iterator it = urlStr.begin(); it != urlStr.end(); ++it ) {
+		hash ^= static_cast<uint8_t>( *it );
+		hash *= 1099511628211ULL;
+	}
+
+	char name[17];
+#if defined( CINDER_MSW )
+	sprintf_s( name, sizeof(name), "%016llx", static_cast<unsigned long long>( hash ) );
+#else
+	sprintf( name, "%016llx", static_cast<unsigned long long>( hash ) );
+#endif
+	return mFormat.getCacheDirectory() / name;
+}
+
+bool UrlFetcher::readCache( const Url &url, const UrlOptions &options, Buffer *data ) const
+{
+	if( mFormat.getCacheDirectory().empty() || options.getIgnoreCache() )
+		return false;
+
+	fs::path path = getCachePath( url );
+	boost::system::error_code ec;
+	time_t modified = fs::last_write_time( path, ec );
+	if( ec )
+		return false;
+	if( ( mFormat.getCacheMaxAge() > 0 ) && ( difftime( time( 0 ), modified ) > mFormat.getCacheMaxAge() ) )
+		return false;
+
+	try {
+		*data = Buffer( loadFile( path ) );
+	}
+	catch( ... ) {
+		return false;
+	}
+
+	return true;
+}
+
+void UrlFetcher::writeCache( const Url &url, const Buffer &data ) const
+{
+	if( mFormat.getCacheDirectory().empty() )
+		return;
+
+	// write to a unique temporary file and rename it into place, so that concurrent readers never see a partial response
+	static atomic<uint32_t> sTempIndex( 0 );
+	fs::path path = getCachePath( url );
+	fs::path tempPath = path;
+	tempPath += "." + toString( sTempIndex++ ) + ".tmp";
+	try {
+		writeFileStream( tempPath )->write( data );
+		fs::rename( tempPath, path );
+	}
+	catch( ... ) {
+		boost::system::error_code ec;
+		fs::remove( tempPath, ec );
+	}
+}
+
+void UrlFetcher::clearCache()
+{
+	if( mFormat.getCacheDirectory().empty() )
+		return;
+
+	boost::system::error_code ec;
+	for( fs::directory_iterator it( mFormat.getCacheDirectory(), ec ), end; it != end; it.increment( ec ) ) {
+		if( ec )
+			break;
+		fs::remove( it->path(), ec );
+	}
+}
+
+#endif // ! defined( CINDER_WINRT )
+
+} // namespace cinder
@@ -21,6 +21,7 @@
 */
 
 #include "cinder/UrlImplCocoa.h"
+#include "cinder/Base64.h"
 
 #if defined( CINDER_COCOA_TOUCH )
 	#import <UIKit/UIKit.h>
@@ -400,4 +401,73 @@ size_t IStreamUrlImplCocoa::readDataAvailable( void *dest, size_t maxSize )
 	return [mDelegate readDataAvailable:dest withSize:maxSize];
 }
 
-} // namespace cinder
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlFetchSessionCocoa
+int UrlFetchSessionCocoa::fetch( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, Buffer *data )
+{
+	int64_t totalSize;
+	return sendRequest( url, user, password, options, std::string(), data, &totalSize );
+}
+
+int UrlFetchSessionCocoa::fetchRange( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, uint64_t offset, size_t size, Buffer *data, int64_t *totalSize )
+{
+	char range[128];
+	sprintf( range, "bytes=%llu-%llu", (unsigned long long)offset, (unsigned long long)( offset + size - 1 ) );
+	return sendRequest( url, user, password, options, range, data, totalSize );
+}
+
+int UrlFetchSessionCocoa::sendRequest( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, const std::string &range, Buffer *data, int64_t *totalSize )
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+	NSURL *nsUrl = [NSURL URLWithString:[NSString stringWithUTF8String:url.c_str()]];
+	if( ! nsUrl ) {
+		[pool drain];
+		throw UrlLoadExc( 0, "Invalid URL: " + url.str() );
+	}
+
+	NSURLRequestCachePolicy cachePolicy = ( options.getIgnoreCache() ) ? NSURLRequestReloadIgnoringLocalCacheData : NSURLRequestUseProtocolCachePolicy;
+	NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:nsUrl cachePolicy:cachePolicy timeoutInterval:options.getTimeout()];
+	// a synchronous request can't answer an authentication challenge, so credentials are sent up front
+	if( ! user.empty() ) {
+		std::string authorization = "Basic " + toBase64( user + ":" + password );
+		[request setValue:[NSString stringWithUTF8String:authorization.c_str()] forHTTPHeaderField:@"Authorization"];
+	}
+	if( ! range.empty() )
+		[request setValue:[NSString stringWithUTF8String:range.c_str()] forHTTPHeaderField:@"Range"];
+
+	NSURLResponse *response = nil;
+	NSError *error = nil;
+	NSData *responseData = [NSURLConnection sendSynchronousRequest:request returningResponse:&response error:&error];
+	if( ! response ) {
+		std::string message = ( error ) ? [[error localizedDescription] UTF8String] : "Unknown URL load error";
+		[pool drain];
+		throw UrlLoadExc( 0, message );
+	}
+
+	int status = 0;
+	// the complete body is always read, so unless the response is partial it's the whole resource
+	*totalSize = [responseData length];
+	if( [response isKindOfClass:[NSHTTPURLResponse class]] ) {
+		NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
+		status = static_cast<int>( [httpResponse statusCode] );
+		if( status == 206 ) {
+			*totalSize = -1;
+			NSString *contentRange = [[httpResponse allHeaderFields] objectForKey:@"Content-Range"];
+			NSRange slash = ( contentRange ) ? [contentRange rangeOfString:@"/"] : NSMakeRange( NSNotFound, 0 );
+			if( ( slash.location != NSNotFound ) && ! [[contentRange substringFromIndex:slash.location + 1] isEqualToString:@"*"] )
+				*totalSize = [[contentRange substringFromIndex:slash.location + 1] longLongValue];
+		}
+	}
+
+	Buffer result( std::max<size_t>( 1, [responseData length] ) );
+	if( [responseData length] > 0 )
+		result.copyFrom( [responseData bytes], [responseData length] );
+	result.setDataSize( [responseData length] );
+	*data = result;
+
+	[pool drain];
+	return status;
+}
+
+} // namespace cinder
@@ -0,0 +1,190 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/UrlImplRanged.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace cinder {
+
+const size_t IStreamUrlImplRanged::BLOCK_SIZE;
+const size_t IStreamUrlImplRanged::MAX_READ_AHEAD_BLOCKS;
+const size_t IStreamUrlImplRanged::MAX_CACHED_BYTES;
+
+// static
+std::shared_ptr<IStreamUrlImpl> IStreamUrlImplRanged::create( const std::string &url, const std::string &user, const std::string &password, const UrlOptions &options )
+{
+	std::string scheme = url.substr( 0, url.find( ':' ) );
+	std::transform( scheme.begin(), scheme.end(), scheme.begin(), ::tolower );
+	if( ( scheme != "http" ) && ( scheme != "https" ) )
+		return std::shared_ptr<IStreamUrlImpl>();
+
+	// the first block doubles as the probe for Range support
+	std::shared_ptr<UrlFetchSessionImpl> session = UrlFetchSessionImpl::create( 1 );
+	Buffer data;
+	int64_t totalSize;
+	int status = session->fetchRange( Url( url, true ), user, password, options, 0, BLOCK_SIZE, &data, &totalSize );
+	if( ( status >= 400 ) && ( status != 416 ) )
+		throw UrlLoadExc( status, "HTTP Server Error" );
+
+	// a server ignoring the range may still have sent the complete body, which is then kept in its entirety
+	const bool complete = ( status != 206 ) && ( status < 300 ) && ( totalSize == static_cast<int64_t>( data.getDataSize() ) );
+	if( ( ( status != 206 ) || ( totalSize < 0 ) ) && ! complete )
+		return std::shared_ptr<IStreamUrlImpl>();
+
+	IStreamUrlImplRanged *result = new IStreamUrlImplRanged( url, user, password, options, session, static_cast<uint64_t>( totalSize ) );
+	result->mEvictable = ! complete;
+	result->insertBlocks( 0, data );
+	return std::shared_ptr<IStreamUrlImpl>( result );
+}
+
+IStreamUrlImplRanged::IStreamUrlImplRanged( const std::string &url, const std::string &user, const std::string &password, const UrlOptions &options, const std::shared_ptr<UrlFetchSessionImpl> &session, uint64_t size )
+	: IStreamUrlImpl( user, password, options ), mUrl( url, true ), mSession( session ), mSize( size ), mPos( 0 ), mEvictable( true ), 
+	mCachedBytes( 0 ), mUseCount( 0 ), mLastBlockRead( 0 ), mReadAheadBlocks( 1 )
+{
+}
+
+const IStreamUrlImplRanged::Block& IStreamUrlImplRanged::getBlock( uint64_t index )
+{
+	std::map<uint64_t, Block>::iterator blockIt = mBlocks.find( index );
+	if( blockIt == mBlocks.end() ) {
+		// sequential reads double the run of blocks fetched at once, amortizing the request latency; a seek starts over with a single block
+		if( index == mLastBlockRead + 1 )
+			mReadAheadBlocks = std::min<size_t>( mReadAheadBlocks * 2, MAX_READ_AHEAD_BLOCKS );
+		else
+			mReadAheadBlocks = 1;
+
+		const uint64_t numBlocks = ( mSize + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+		size_t count = 1;
+		while( ( count < mReadAheadBlocks ) && ( index + count < numBlocks ) && ( mBlocks.find( index + count ) == mBlocks.end() ) )
+			++count;
+
+		const uint64_t offset = index * BLOCK_SIZE;
+		const size_t size = static_cast<size_t>( std::min<uint64_t>( count * BLOCK_SIZE, mSize - offset ) );
+		Buffer data;
+		int64_t totalSize;
+		int status = mSession->fetchRange( mUrl, mUser, mPassword, mOptions, offset, size, &data, &totalSize );
+		if( status >= 400 )
+			throw UrlLoadExc( status, "HTTP Server Error" );
+		if( ( status != 206 ) || ( data.getDataSize() != size ) )
+			throw UrlLoadExc( status, "Range request failed for " + mUrl.str() );
+
+		insertBlocks( index, data );
+		blockIt = mBlocks.find( index );
+	}
+
+	mLastBlockRead = index;
+	blockIt->second.mLastUsed = ++mUseCount;
+	return blockIt->second;
+}
+
+void IStreamUrlImplRanged::insertBlocks( uint64_t firstIndex, const Buffer &data )
+{
+	// the blocks reference the fetched data rather than copying it
+	std::shared_ptr<void> owner( new Buffer( data ) );
+	uint8_t *bytes = static_cast<uint8_t*>( static_cast<Buffer*>( owner.get() )->getData() );
+	size_t size = data.getDataSize();
+	size_t numBlocks = ( size + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+	for( size_t b = 0; b < numBlocks; ++b ) {
+		Block &block = mBlocks[firstIndex + b];
+		const size_t blockSize = std::min<size_t>( BLOCK_SIZE, size - b * BLOCK_SIZE );
+		mCachedBytes += blockSize - ( block.mData ? block.mData.getDataSize() : 0 );
+		block.mData = Buffer( bytes + b * BLOCK_SIZE, blockSize, owner );
+		block.mLastUsed = ++mUseCount;
+	}
+
+	evictBlocks();
+}
+
+void IStreamUrlImplRanged::evictBlocks()
+{
+	if( ! mEvictable )
+		return;
+
+	// blocks sharing a fetch's data are released together with its last one
+	while( ( mCachedBytes > MAX_CACHED_BYTES ) && ( mBlocks.size() > 1 ) ) {
+		std::map<uint64_t, Block>::iterator oldest = mBlocks.begin();
+		for( std::map<uint64_t, Block>::iterator blockIt = mBlocks.begin(); blockIt != mBlocks.end(); ++blockIt ) {
+			if( blockIt->second.mLastUsed < oldest->second.mLastUsed )
+				oldest = blockIt;
+		}
+		mCachedBytes -= oldest->second.mData.getDataSize();
+		mBlocks.erase( oldest );
+	}
+}
+
+size_t IStreamUrlImplRanged::readDataAvailable( void *dest, size_t maxSize )
+{
+	if( isEof() )
+		return 0;
+
+	const uint64_t index = mPos / BLOCK_SIZE;
+	const Block &block = getBlock( index );
+	const size_t offset = static_cast<size_t>( mPos - index * BLOCK_SIZE );
+	const size_t bytes = std::min( maxSize, block.mData.getDataSize() - offset );
+	memcpy( dest, static_cast<const uint8_t*>( block.mData.getData() ) + offset, bytes );
+	mPos += bytes;
+	return bytes;
+}
+
+void IStreamUrlImplRanged::IORead( void *t, size_t size )
+{
+	uint8_t *dest = static_cast<uint8_t*>( t );
+	while( size > 0 ) {
+		size_t bytes = readDataAvailable( dest, size );
+		if( bytes == 0 )
+			throw StreamExc();
+		dest += bytes;
+		size -= bytes;
+	}
+}
+
+void IStreamUrlImplRanged::seekAbsolute( off_t absoluteOffset )
+{
+	if( ( absoluteOffset < 0 ) || ( static_cast<uint64_t>( absoluteOffset ) > mSize ) )
+		throw StreamExc();
+	mPos = absoluteOffset;
+}
+
+void IStreamUrlImplRanged::seekRelative( off_t relativeOffset )
+{
+	seekAbsolute( static_cast<off_t>( mPos ) + relativeOffset );
+}
+
+off_t IStreamUrlImplRanged::tell() const
+{
+	return static_cast<off_t>( mPos );
+}
+
+off_t IStreamUrlImplRanged::size() const
+{
+	return static_cast<off_t>( mSize );
+}
+
+bool IStreamUrlImplRanged::isEof() const
+{
+	return mPos >= mSize;
+}
+
+} // namespace cinder
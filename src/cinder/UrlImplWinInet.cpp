@@ -27,6 +27,8 @@
 #include <Windows.h>
 #include <Wininet.h>
 #include <Strsafe.h>
+#include <algorithm>
+#include <limits>
 #pragma comment( lib, "wininet.lib" )
 
 namespace cinder {
@@ -269,4 +271,129 @@ size_t IStreamUrlImplWinInet::readDataAvailable( void *dest, size_t maxSize )
 	return maxSize;
 }
 
-} // namespace cinder
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlFetchSessionWinInet
+UrlFetchSessionWinInet::UrlFetchSessionWinInet( size_t maxConnectionsPerServer )
+{
+	mSession = std::shared_ptr<void>( ::InternetOpen( AGENT_NAME, INTERNET_OPEN_TYPE_PRECONFIG, NULL, NULL, 0 ), safeInternetCloseHandle );
+	if( ! mSession )
+		throw UrlLoadExc( 0, "Failed to open an internet session" );
+
+	// the limit on connections per server is process-wide; raise it so that concurrent requests to one host aren't serialized
+	DWORD maxConns = 0;
+	DWORD maxConnsSize( sizeof(maxConns) );
+	if( ::InternetQueryOption( NULL, INTERNET_OPTION_MAX_CONNS_PER_SERVER, &maxConns, &maxConnsSize ) && ( maxConns < maxConnectionsPerServer ) ) {
+		maxConns = static_cast<DWORD>( maxConnectionsPerServer );
+		::InternetSetOption( NULL, INTERNET_OPTION_MAX_CONNS_PER_SERVER, &maxConns, sizeof(maxConns) );
+		::InternetSetOption( NULL, INTERNET_OPTION_MAX_CONNS_PER_1_0_SERVER, &maxConns, sizeof(maxConns) );
+	}
+}
+
+int UrlFetchSessionWinInet::fetch( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, Buffer *data )
+{
+	int64_t totalSize;
+	return sendRequest( url, user, password, options, std::wstring(), std::numeric_limits<size_t>::max(), data, &totalSize );
+}
+
+int UrlFetchSessionWinInet::fetchRange( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, uint64_t offset, size_t size, Buffer *data, int64_t *totalSize )
+{
+	WCHAR range[128];
+	::StringCchPrintfW( range, 128, L"Range: bytes=%llu-%llu\r\n", offset, offset + size - 1 );
+	return sendRequest( url, user, password, options, range, size, data, totalSize );
+}
+
+int UrlFetchSessionWinInet::sendRequest( const Url &url, const std::string &user, const std::string &password, const UrlOptions &options, const std::wstring &headers, size_t maxSize, Buffer *data, int64_t *totalSize )
+{
+	std::u16string wideUrl = toUtf16( url.str() );
+
+	URL_COMPONENTS urlComponents;
+	::memset( &urlComponents, 0, sizeof(urlComponents) );
+	urlComponents.dwStructSize = sizeof(urlComponents);
+	urlComponents.dwSchemeLength = 1;
+	urlComponents.dwHostNameLength = 1;
+	urlComponents.dwUrlPathLength = 1;
+	if( ! ::InternetCrackUrl( (wchar_t*)wideUrl.c_str(), 0, 0, &urlComponents ) )
+		throw UrlLoadExc( 0, "Invalid URL: " + url.str() );
+	if( ( urlComponents.nScheme != INTERNET_SCHEME_HTTP ) && ( urlComponents.nScheme != INTERNET_SCHEME_HTTPS ) )
+		throw UrlLoadExc( 0, "Unsupported URL scheme: " + url.str() );
+
+	std::wstring host( urlComponents.lpszHostName, urlComponents.dwHostNameLength );
+	std::wstring path( urlComponents.lpszUrlPath, urlComponents.dwUrlPathLength );
+	std::u16string wideUser = toUtf16( user );
+	std::u16string widePassword = toUtf16( password );
+
+	// connection handles don't own a socket; the session keeps the server's sockets alive and hands them to subsequent requests
+	std::shared_ptr<void> connection( ::InternetConnect( mSession.get(), host.c_str(), urlComponents.nPort, (wchar_t*)((wideUser.empty()) ? NULL : wideUser.c_str()), (wchar_t*)((widePassword.empty()) ? NULL : widePassword.c_str()), INTERNET_SERVICE_HTTP, 0, NULL ),
+										safeInternetCloseHandle );
+	if( ! connection )
+		throw UrlLoadExc( 0, "Failed to connect to " + url.str() );
+
+	unsigned long timeoutMillis = static_cast<unsigned long>( options.getTimeout() * 1000 );
+	::InternetSetOptionW( connection.get(), INTERNET_OPTION_RECEIVE_TIMEOUT, &timeoutMillis, sizeof(unsigned long) );
+	::InternetSetOptionW( connection.get(), INTERNET_OPTION_CONNECT_TIMEOUT, &timeoutMillis, sizeof(unsigned long) );
+	::InternetSetOptionW( connection.get(), INTERNET_OPTION_SEND_TIMEOUT, &timeoutMillis, sizeof(unsigned long) );
+
+	DWORD flags = INTERNET_FLAG_KEEP_CONNECTION | INTERNET_FLAG_NO_CACHE_WRITE | INTERNET_FLAG_NO_COOKIES | INTERNET_FLAG_NO_UI;
+	if( options.getIgnoreCache() )
+		flags |= INTERNET_FLAG_RELOAD;
+	if( urlComponents.nScheme == INTERNET_SCHEME_HTTPS )
+		flags |= INTERNET_FLAG_SECURE;
+
+	static LPCTSTR lpszAcceptTypes[] = { L"*/*", NULL };
+	std::shared_ptr<void> request( ::HttpOpenRequest( connection.get(), L"GET", path.c_str(), NULL, NULL, lpszAcceptTypes, flags, NULL ), safeInternetCloseHandle );
+	if( ! request )
+		throw UrlLoadExc( 0, "Unknown URL load error" );
+	if( ! ::HttpSendRequest( request.get(), headers.empty() ? NULL : headers.c_str(), static_cast<DWORD>( headers.size() ), NULL, 0 ) )
+		throw UrlLoadExc( 0, "Failed to send request for " + url.str() );
+
+	DWORD status = 0;
+	DWORD statusSize( sizeof(status) );
+	::HttpQueryInfo( request.get(), HTTP_QUERY_FLAG_NUMBER | HTTP_QUERY_STATUS_CODE, &status, &statusSize, NULL );
+
+	// a partial response carries the length of the whole resource after the '/' of its Content-Range
+	*totalSize = -1;
+	WCHAR contentRange[128];
+	DWORD contentRangeSize( sizeof(contentRange) );
+	WCHAR contentLength[32];
+	DWORD contentLengthSize( sizeof(contentLength) );
+	if( status == 206 ) {
+		if( ::HttpQueryInfo( request.get(), HTTP_QUERY_CONTENT_RANGE, contentRange, &contentRangeSize, NULL ) ) {
+			const WCHAR *total = ::wcschr( contentRange, L'/' );
+			if( total && ( total[1] != L'*' ) )
+				*totalSize = ::_wcstoui64( total + 1, NULL, 10 );
+		}
+	}
+	else if( ::HttpQueryInfo( request.get(), HTTP_QUERY_CONTENT_LENGTH, contentLength, &contentLengthSize, NULL ) )
+		*totalSize = ::_wcstoui64( contentLength, NULL, 10 );
+
+	// reading the body to the end returns the connection to the session
+	size_t capacity = 64 * 1024;
+	if( ( status == 206 ) || ( *totalSize > 0 ) )
+		capacity = ( status == 206 ) ? maxSize : static_cast<size_t>( std::min<uint64_t>( *totalSize, maxSize ) );
+
+	Buffer result( std::max<size_t>( 1, capacity ) );
+	size_t size = 0;
+	bool complete = false;
+	while( size < maxSize ) {
+		if( size == result.getAllocatedSize() )
+			result.resize( std::min( size * 2, maxSize ) );
+		DWORD bytesRead = 0;
+		if( ! ::InternetReadFile( request.get(), (uint8_t*)result.getData() + size, static_cast<DWORD>( std::min<size_t>( result.getAllocatedSize() - size, 1 << 30 ) ), &bytesRead ) )
+			throw UrlLoadExc( status, "Failed to read response from " + url.str() );
+		if( bytesRead == 0 ) {
+			complete = true;
+			break;
+		}
+		size += bytesRead;
+	}
+	result.setDataSize( size );
+	*data = result;
+
+	// a whole body cut short at maxSize isn't of use as the complete resource
+	if( status != 206 )
+		*totalSize = ( complete || ( *totalSize == static_cast<int64_t>( size ) ) ) ? static_cast<int64_t>( size ) : -1;
+
+	return static_cast<int>( status );
+}
+
+} // namespace cinder
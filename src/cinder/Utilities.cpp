@@ -29,6 +29,8 @@
 #include "cinder/Cinder.h"
 #include "cinder/Utilities.h"
 #include "cinder/Unicode.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 
 #if defined( CINDER_COCOA_TOUCH )
 	#import <UIKit/UIKit.h>
@@ -58,6 +60,15 @@
 #endif
 
 #include <vector>
+#include <cctype>
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <typeinfo>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -283,6 +294,441 @@ string loadString( DataSourceRef dataSource )
 	return string( static_cast<const char*>( padded.getData() ) );
 }
 
+namespace {
+
+void throwBadNumber( const std::type_info &target )
+{
+	throw boost::bad_lexical_cast( typeid(std::string), target );
+}
+
+inline bool isDecimalDigit( char c )
+{
+	return (unsigned)( c - '0' ) < 10;
+}
+
+// Parses an optionally signed run of decimal digits spanning [p, end) and returns its magnitude. Throws on anything else, or on overflowing 64 bits.
+uint64_t parseMagnitude( const char *p, const char *end, bool *negative, const std::type_info &target )
+{
+	*negative = false;
+	if( p != end && ( *p == '-' || *p == '+' ) )
+		*negative = ( *p++ == '-' );
+	if( p == end )
+		throwBadNumber( target );
+
+	uint64_t result = 0;
+	for( ; p != end; ++p ) {
+		const unsigned digit = (unsigned)( *p - '0' );
+		if( digit > 9 || result > ( std::numeric_limits<uint64_t>::max() - digit ) / 10 )
+			throwBadNumber( target );
+		result = result * 10 + digit;
+	}
+	return result;
+}
+
+template<typename T>
+T parseSigned( const char *str, size_t length )
+{
+	bool negative;
+	const uint64_t magnitude = parseMagnitude( str, str + length, &negative, typeid(T) );
+	if( magnitude > (uint64_t)std::numeric_limits<T>::max() + ( negative ? 1 : 0 ) )
+		throwBadNumber( typeid(T) );
+	return negative ? (T)( -(int64_t)( magnitude - 1 ) - 1 ) : (T)magnitude;
+}
+
+// like lexical_cast, a leading minus sign wraps around
+template<typename T>
+T parseUnsigned( const char *str, size_t length )
+{
+	bool negative;
+	const uint64_t magnitude = parseMagnitude( str, str + length, &negative, typeid(T) );
+	if( magnitude > (uint64_t)std::numeric_limits<T>::max() )
+		throwBadNumber( typeid(T) );
+	return negative ? (T)( 0 - (T)magnitude ) : (T)magnitude;
+}
+
+string formatMagnitude( uint64_t magnitude, bool negative )
+{
+	char buffer[24];
+	char *p = buffer + sizeof(buffer);
+	do {
+		*--p = (char)( '0' + magnitude % 10 );
+		magnitude /= 10;
+	} while( magnitude );
+	if( negative )
+		*--p = '-';
+	return string( p, buffer + sizeof(buffer) );
+}
+
+template<typename T>
+string formatSigned( T value )
+{
+	return ( value < 0 ) ? formatMagnitude( (uint64_t)( -( value + 1 ) ) + 1, true ) : formatMagnitude( (uint64_t)value, false );
+}
+
+// Compares \a str to the lowercase \a lower, ignoring the case of \a str
+bool equalsIgnoringCase( const char *str, const char *lower )
+{
+	for( ; *str && *lower; ++str, ++lower ) {
+		if( tolower( (unsigned char)*str ) != *lower )
+			return false;
+	}
+	return *str == *lower;
+}
+
+// Everything the fast path below doesn't handle, such as more than 19 significant digits, large exponents, infinity and NaN
+template<typename T>
+T parseFloatSlow( const char *str, size_t length )
+{
+	const string s( str, length );
+	const bool negative = ( ! s.empty() && s[0] == '-' );
+	const char *unsignedPart = s.c_str() + ( ( negative || ( ! s.empty() && s[0] == '+' ) ) ? 1 : 0 );
+	if( equalsIgnoringCase( unsignedPart, "inf" ) || equalsIgnoringCase( unsignedPart, "infinity" ) )
+		return negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+	if( equalsIgnoringCase( unsignedPart, "nan" ) )
+		return negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+
+	// lexical_cast rejects whitespace and hexadecimal, which strtod() would accept
+	if( s.empty() || isspace( (unsigned char)s[0] ) || s.find_first_of( "xX" ) != string::npos )
+		throwBadNumber( typeid(T) );
+
+	// strtod() is much faster than a stream, but only usable when the current locale's decimal point is '.', as it almost always is
+	if( *localeconv()->decimal_point == '.' ) {
+		char *parsedEnd;
+		errno = 0;
+		const double result = strtod( s.c_str(), &parsedEnd );
+		if( parsedEnd != s.c_str() + s.size() || ( errno == ERANGE && fabs( result ) == HUGE_VAL ) || fabs( result ) > std::numeric_limits<T>::max() )
+			throwBadNumber( typeid(T) );
+		return (T)result;
+	}
+
+	std::istringstream stream( s );
+	stream.imbue( std::locale::classic() );
+	T result;
+	if( ! ( stream >> std::noskipws >> result ) || stream.get() != std::char_traits<char>::eof() )
+		throwBadNumber( typeid(T) );
+	return result;
+}
+
+const double sPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/* Clinger's fast path: when the decimal digits form an integer of at most MANTISSA_BITS bits and the exponent is within MAX_EXPONENT, both are exact
+	in T and a single multiplication or division rounds correctly. That covers nearly every number written by people and by toString(). */
+template<typename T, int MANTISSA_BITS, int MAX_EXPONENT>
+T parseFloat( const char *str, size_t length )
+{
+	const char *p = str, *end = str + length;
+	bool negative = false;
+	if( p != end && ( *p == '-' || *p == '+' ) )
+		negative = ( *p++ == '-' );
+
+	// digits past the 19th are dropped, which is only exact if they're zeros
+	uint64_t mantissa = 0;
+	int exponent = 0, numDigits = 0;
+	bool exact = true;
+	for( ; p != end && isDecimalDigit( *p ); ++p, ++numDigits ) {
+		if( mantissa < 1000000000000000000ULL )
+			mantissa = mantissa * 10 + ( *p - '0' );
+		else {
+			++exponent;
+			exact = exact && ( *p == '0' );
+		}
+	}
+	if( p != end && *p == '.' ) {
+		for( ++p; p != end && isDecimalDigit( *p ); ++p, ++numDigits ) {
+			if( mantissa < 1000000000000000000ULL ) {
+				mantissa = mantissa * 10 + ( *p - '0' );
+				--exponent;
+			}
+			else
+				exact = exact && ( *p == '0' );
+		}
+	}
+	if( numDigits == 0 )
+		return parseFloatSlow<T>( str, length );
+
+	if( p != end && ( *p == 'e' || *p == 'E' ) ) {
+		++p;
+		bool negativeExponent = false;
+		if( p != end && ( *p == '-' || *p == '+' ) )
+			negativeExponent = ( *p++ == '-' );
+		if( p == end || ! isDecimalDigit( *p ) )
+			return parseFloatSlow<T>( str, length );
+		int explicitExponent = 0;
+		for( ; p != end && isDecimalDigit( *p ); ++p )
+			explicitExponent = std::min( explicitExponent * 10 + ( *p - '0' ), 100000 );
+		exponent += negativeExponent ? -explicitExponent : explicitExponent;
+	}
+	if( p != end )
+		throwBadNumber( typeid(T) );
+
+	if( ! exact || mantissa > ( 1ULL << MANTISSA_BITS ) || exponent < -MAX_EXPONENT || exponent > MAX_EXPONENT )
+		return parseFloatSlow<T>( str, length );
+
+	T result = (T)mantissa;
+	if( exponent < 0 )
+		result /= (T)sPowersOf10[-exponent];
+	else
+		result *= (T)sPowersOf10[exponent];
+	return negative ? -result : result;
+}
+
+// A floating point value as a 64 bit significand and a binary exponent, for grisu2()
+struct DiyFp {
+	DiyFp() {}
+	DiyFp( uint64_t f, int e ) : mF( f ), mE( e ) {}
+
+	DiyFp	operator-( const DiyFp &rhs ) const { return DiyFp( mF - rhs.mF, mE ); }
+	// the upper 64 bits of the 128 bit product, rounded
+	DiyFp	operator*( const DiyFp &rhs ) const
+	{
+		const uint64_t a = mF >> 32, b = mF & 0xFFFFFFFF, c = rhs.mF >> 32, d = rhs.mF & 0xFFFFFFFF;
+		const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+		const uint64_t middle = ( bd >> 32 ) + ( ad & 0xFFFFFFFF ) + ( bc & 0xFFFFFFFF ) + ( 1ULL << 31 );
+		return DiyFp( ac + ( ad >> 32 ) + ( bc >> 32 ) + ( middle >> 32 ), mE + rhs.mE + 64 );
+	}
+	DiyFp	normalized() const
+	{
+		DiyFp result( *this );
+		while( ! ( result.mF & ( 1ULL << 63 ) ) ) {
+			result.mF <<= 1;
+			--result.mE;
+		}
+		return result;
+	}
+
+	uint64_t	mF;
+	int			mE;
+};
+
+// 10^k normalized to 64 bits, for k = -348, -340, ..., 340
+const struct { uint64_t mF; int16_t mE; } sCachedPowers[] = {
+	{ 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 }, { 0x8b16fb203055ac76ULL, -1166 },
+	{ 0xcf42894a5dce35eaULL, -1140 }, { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+	{ 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 }, { 0xbe5691ef416bd60cULL, -1007 },
+	{ 0x8dd01fad907ffc3cULL, -980 }, { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+	{ 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 }, { 0x823c12795db6ce57ULL, -847 },
+	{ 0xc21094364dfb5637ULL, -821 }, { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 },
+	{ 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 }, { 0xb23867fb2a35b28eULL, -688 },
+	{ 0x84c8d4dfd2c63f3bULL, -661 }, { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+	{ 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 }, { 0xf3e2f893dec3f126ULL, -529 },
+	{ 0xb5b5ada8aaff80b8ULL, -502 }, { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 },
+	{ 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 }, { 0xa6dfbd9fb8e5b88fULL, -369 },
+	{ 0xf8a95fcf88747d94ULL, -343 }, { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+	{ 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 }, { 0xe45c10c42a2b3b06ULL, -210 },
+	{ 0xaa242499697392d3ULL, -183 }, { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 },
+	{ 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 }, { 0x9c40000000000000ULL, -50 },
+	{ 0xe8d4a51000000000ULL, -24 }, { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+	{ 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 }, { 0xd5d238a4abe98068ULL, 109 },
+	{ 0x9f4f2726179a2245ULL, 136 }, { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 },
+	{ 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 }, { 0x924d692ca61be758ULL, 269 },
+	{ 0xda01ee641a708deaULL, 295 }, { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+	{ 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 }, { 0xc83553c5c8965d3dULL, 428 },
+	{ 0x952ab45cfa97a0b3ULL, 455 }, { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 },
+	{ 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 }, { 0x88fcf317f22241e2ULL, 588 },
+	{ 0xcc20ce9bd35c78a5ULL, 614 }, { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+	{ 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 }, { 0xbb764c4ca7a44410ULL, 747 },
+	{ 0x8bab8eefb6409c1aULL, 774 }, { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 },
+	{ 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 }, { 0x80444b5e7aa7cf85ULL, 907 },
+	{ 0xbf21e44003acdd2dULL, 933 }, { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+	{ 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 }, { 0xaf87023b9bf0ee6bULL, 1066 }
+};
+
+const uint32_t sPowersOf10Int[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+// Moves the last digit towards the exact value while the result stays within the rounding interval
+void grisuRound( char *digits, int numDigits, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance )
+{
+	while( rest < distance && delta - rest >= tenKappa && ( rest + tenKappa < distance || distance - rest > rest + tenKappa - distance ) ) {
+		--digits[numDigits - 1];
+		rest += tenKappa;
+	}
+}
+
+void grisuDigits( const DiyFp &w, const DiyFp &upper, uint64_t delta, char *digits, int *numDigits, int *decimalExponent )
+{
+	const DiyFp one( 1ULL << -upper.mE, upper.mE );
+	const uint64_t distance = ( upper - w ).mF;
+	uint32_t integral = (uint32_t)( upper.mF >> -one.mE );
+	uint64_t fractional = upper.mF & ( one.mF - 1 );
+	int kappa = 1;
+	while( kappa < 10 && integral >= sPowersOf10Int[kappa] )
+		++kappa;
+
+	*numDigits = 0;
+	while( kappa > 0 ) {
+		const uint32_t digit = integral / sPowersOf10Int[kappa - 1];
+		integral %= sPowersOf10Int[kappa - 1];
+		if( digit || *numDigits )
+			digits[(*numDigits)++] = (char)( '0' + digit );
+		--kappa;
+		const uint64_t rest = ( (uint64_t)integral << -one.mE ) + fractional;
+		if( rest <= delta ) {
+			*decimalExponent += kappa;
+			grisuRound( digits, *numDigits, delta, rest, (uint64_t)sPowersOf10Int[kappa] << -one.mE, distance );
+			return;
+		}
+	}
+
+	for( ;; ) {
+		fractional *= 10;
+		delta *= 10;
+		const char digit = (char)( fractional >> -one.mE );
+		if( digit || *numDigits )
+			digits[(*numDigits)++] = (char)( '0' + digit );
+		fractional &= one.mF - 1;
+		--kappa;
+		if( fractional < delta ) {
+			*decimalExponent += kappa;
+			grisuRound( digits, *numDigits, delta, fractional, one.mF, ( -kappa < 10 ) ? distance * sPowersOf10Int[-kappa] : 0 );
+			return;
+		}
+	}
+}
+
+/* Florian Loitsch's Grisu2, which finds a short decimal significand for significand * 2^exponent that reads back as the same value, with
+	digits * 10^decimalExponent being that value. It isn't always the shortest, but is in the vast majority of cases. \a hiddenBit is the implicit
+	leading bit of the type's normalized significands, which determines the spacing to the neighboring values. */
+void grisu2( uint64_t significand, int exponent, uint64_t hiddenBit, char *digits, int *numDigits, int *decimalExponent )
+{
+	const DiyFp v( significand, exponent );
+	const DiyFp upper = DiyFp( ( v.mF << 1 ) + 1, v.mE - 1 ).normalized();
+	DiyFp lower = ( v.mF == hiddenBit ) ? DiyFp( ( v.mF << 2 ) - 1, v.mE - 2 ) : DiyFp( ( v.mF << 1 ) - 1, v.mE - 1 );
+	lower.mF <<= lower.mE - upper.mE;
+	lower.mE = upper.mE;
+
+	// a power of ten which brings the binary exponent into [-60, -32], so the integral part of the scaled value fits 32 bits
+	const double dk = ( -61 - upper.mE ) * 0.30102999566398114 + 347;
+	int k = (int)dk;
+	if( dk - k > 0.0 )
+		++k;
+	const unsigned index = (unsigned)( ( k >> 3 ) + 1 );
+	*decimalExponent = -( -348 + (int)index * 8 );
+	const DiyFp cachedPower( sCachedPowers[index].mF, sCachedPowers[index].mE );
+
+	const DiyFp w = v.normalized() * cachedPower;
+	DiyFp scaledUpper = upper * cachedPower, scaledLower = lower * cachedPower;
+	++scaledLower.mF;
+	--scaledUpper.mF;
+	grisuDigits( w, scaledUpper, scaledUpper.mF - scaledLower.mF, digits, numDigits, decimalExponent );
+}
+
+// Lays out digits * 10^decimalExponent as %g would with \a precision, without its trailing zeros
+string formatDigits( bool negative, const char *digits, int numDigits, int decimalExponent, int precision )
+{
+	string result;
+	result.reserve( numDigits + 8 );
+	if( negative )
+		result += '-';
+
+	const int pointPosition = numDigits + decimalExponent; // digits before the decimal point
+	if( pointPosition - 1 >= -4 && pointPosition - 1 < precision ) {
+		if( pointPosition <= 0 ) {
+			result.append( "0." );
+			result.append( -pointPosition, '0' );
+			result.append( digits, numDigits );
+		}
+		else if( pointPosition >= numDigits ) {
+			result.append( digits, numDigits );
+			result.append( pointPosition - numDigits, '0' );
+		}
+		else {
+			result.append( digits, pointPosition );
+			result += '.';
+			result.append( digits + pointPosition, numDigits - pointPosition );
+		}
+	}
+	else {
+		result += digits[0];
+		if( numDigits > 1 ) {
+			result += '.';
+			result.append( digits + 1, numDigits - 1 );
+		}
+		int exponent = pointPosition - 1;
+		result += 'e';
+		result += ( exponent < 0 ) ? '-' : '+';
+		exponent = ( exponent < 0 ) ? -exponent : exponent;
+		if( exponent < 10 )
+			result += '0';
+		result += formatMagnitude( (uint64_t)exponent, false );
+	}
+	return result;
+}
+
+// Formats as lexical_cast would with a precision of \a precision, but with only as many digits as it takes to read back as \a value
+template<typename T>
+string formatFloat( T value, int precision )
+{
+	if( value != value )
+		return "nan";
+	if( value == std::numeric_limits<T>::infinity() )
+		return "inf";
+	if( value == -std::numeric_limits<T>::infinity() )
+		return "-inf";
+
+	const bool negative = ( value < 0 ) || ( value == 0 && 1 / value < 0 );
+	if( value == 0 )
+		return negative ? "-0" : "0";
+
+	uint64_t significand;
+	int exponent;
+	uint64_t hiddenBit;
+	if( sizeof(T) == sizeof(double) ) {
+		uint64_t bits;
+		memcpy( &bits, &value, sizeof(bits) );
+		const int biasedExponent = (int)( ( bits >> 52 ) & 0x7FF );
+		hiddenBit = 1ULL << 52;
+		significand = bits & ( hiddenBit - 1 );
+		if( biasedExponent ) {
+			significand |= hiddenBit;
+			exponent = biasedExponent - 1075;
+		}
+		else
+			exponent = -1074;
+	}
+	else {
+		uint32_t bits;
+		memcpy( &bits, &value, sizeof(bits) );
+		const int biasedExponent = (int)( ( bits >> 23 ) & 0xFF );
+		hiddenBit = 1ULL << 23;
+		significand = bits & ( hiddenBit - 1 );
+		if( biasedExponent ) {
+			significand |= hiddenBit;
+			exponent = biasedExponent - 150;
+		}
+		else
+			exponent = -149;
+	}
+
+	char digits[20];
+	int numDigits, decimalExponent;
+	grisu2( significand, exponent, hiddenBit, digits, &numDigits, &decimalExponent );
+	return formatDigits( negative, digits, numDigits, decimalExponent, precision );
+}
+
+} // anonymous namespace
+
+template<> string toString<short>( const short &t ) { return formatSigned( t ); }
+template<> string toString<unsigned short>( const unsigned short &t ) { return formatMagnitude( t, false ); }
+template<> string toString<int>( const int &t ) { return formatSigned( t ); }
+template<> string toString<unsigned int>( const unsigned int &t ) { return formatMagnitude( t, false ); }
+template<> string toString<long>( const long &t ) { return formatSigned( t ); }
+template<> string toString<unsigned long>( const unsigned long &t ) { return formatMagnitude( t, false ); }
+template<> string toString<long long>( const long long &t ) { return formatSigned( t ); }
+template<> string toString<unsigned long long>( const unsigned long long &t ) { return formatMagnitude( t, false ); }
+template<> string toString<float>( const float &t ) { return formatFloat( t, 9 ); }
+template<> string toString<double>( const double &t ) { return formatFloat( t, 17 ); }
+
+template<> short fromString<short>( const char *str, size_t length ) { return parseSigned<short>( str, length ); }
+template<> unsigned short fromString<unsigned short>( const char *str, size_t length ) { return parseUnsigned<unsigned short>( str, length ); }
+template<> int fromString<int>( const char *str, size_t length ) { return parseSigned<int>( str, length ); }
+template<> unsigned int fromString<unsigned int>( const char *str, size_t length ) { return parseUnsigned<unsigned int>( str, length ); }
+template<> long fromString<long>( const char *str, size_t length ) { return parseSigned<long>( str, length ); }
+template<> unsigned long fromString<unsigned long>( const char *str, size_t length ) { return parseUnsigned<unsigned long>( str, length ); }
+template<> long long fromString<long long>( const char *str, size_t length ) { return parseSigned<long long>( str, length ); }
+template<> unsigned long long fromString<unsigned long long>( const char *str, size_t length ) { return parseUnsigned<unsigned long long>( str, length ); }
+template<> float fromString<float>( const char *str, size_t length ) { return parseFloat<float, 24, 10>( str, length ); }
+template<> double fromString<double>( const char *str, size_t length ) { return parseFloat<double, 53, 22>( str, length ); }
+
 void sleep( float milliseconds )
 {
 #if defined( CINDER_MSW )
@@ -426,24 +872,89 @@ double swapEndian( double val ) {
 	return s2.d;
 }
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+inline __m128i swap16_epi16( __m128i v )
+{
+	return _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+}
+
+inline __m128i swap32_epi32( __m128i v )
+{
+	v = swap16_epi16( v );
+	return _mm_or_si128( _mm_slli_epi32( v, 16 ), _mm_srli_epi32( v, 16 ) );
+}
+#endif
+
+// Swaps as many of the \a count values of \a valueSize bytes at \a ptr as the SIMD paths can, returning the number of values handled.
+size_t swapEndianBlockSimd( uint8_t *ptr, size_t count, size_t valueSize )
+{
+	const size_t numBytes = ( count * valueSize ) & ~size_t( 15 );
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	for( ; i < numBytes; i += 16 ) {
+		__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( ptr + i ) );
+		if( valueSize == 2 )
+			v = swap16_epi16( v );
+		else if( valueSize == 4 )
+			v = swap32_epi32( v );
+		else
+			v = _mm_shuffle_epi32( swap32_epi32( v ), _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( ptr + i ), v );
+	}
+#elif defined( CINDER_NEON )
+	for( ; i < numBytes; i += 16 ) {
+		uint8x16_t v = vld1q_u8( ptr + i );
+		if( valueSize == 2 )
+			v = vrev16q_u8( v );
+		else if( valueSize == 4 )
+			v = vrev32q_u8( v );
+		else
+			v = vrev64q_u8( v );
+		vst1q_u8( ptr + i, v );
+	}
+#endif
+	return i / valueSize;
+}
+
+} // anonymous namespace
+
 void swapEndianBlock( uint16_t *blockPtr, size_t blockSizeInBytes )
 {
 	size_t blockSize = blockSizeInBytes / sizeof(uint16_t);
 
-	for( size_t b = 0; b < blockSize; b++ ) {
-		*blockPtr = swapEndian( *blockPtr );
-		blockPtr++;
-	}
+	for( size_t b = swapEndianBlockSimd( reinterpret_cast<uint8_t*>( blockPtr ), blockSize, sizeof(uint16_t) ); b < blockSize; b++ )
+		blockPtr[b] = swapEndian( blockPtr[b] );
+}
+
+void swapEndianBlock( uint32_t *blockPtr, size_t blockSizeInBytes )
+{
+	size_t blockSize = blockSizeInBytes / sizeof(uint32_t);
+
+	for( size_t b = swapEndianBlockSimd( reinterpret_cast<uint8_t*>( blockPtr ), blockSize, sizeof(uint32_t) ); b < blockSize; b++ )
+		blockPtr[b] = swapEndian( blockPtr[b] );
 }
 
 void swapEndianBlock( float *blockPtr, size_t blockSizeInBytes )
 {
-	size_t blockSize = blockSizeInBytes / sizeof(float);
+	swapEndianBlock( reinterpret_cast<uint32_t*>( blockPtr ), blockSizeInBytes );
+}
 
-	for( size_t b = 0; b < blockSize; b++ ) {
-		*(reinterpret_cast<uint32_t*>(blockPtr)) = swapEndian( *(reinterpret_cast<uint32_t*>(blockPtr)) );
-		blockPtr++;
-	}
+void swapEndianBlock( double *blockPtr, size_t blockSizeInBytes )
+{
+	size_t blockSize = blockSizeInBytes / sizeof(double);
+
+	for( size_t b = swapEndianBlockSimd( reinterpret_cast<uint8_t*>( blockPtr ), blockSize, sizeof(double) ); b < blockSize; b++ )
+		blockPtr[b] = swapEndian( blockPtr[b] );
 }
 
 } // namespace cinder
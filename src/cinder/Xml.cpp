@@ -27,6 +27,8 @@
 #include "cinder/Xml.h"
 #include "cinder/Utilities.h"
 #include <boost/algorithm/string.hpp>
+#include <cctype>
+#include <unordered_map>
 
 #include "rapidxml/rapidxml.hpp"
 #include "rapidxml/rapidxml_print.hpp"
@@ -47,8 +49,34 @@ bool tagsMatch( const std::string &tag1, const std::string &tag2, bool caseSensi
 	else
 		return false;
 }
+
+// nodes with fewer children than this are searched linearly rather than indexed
+const size_t CHILD_INDEX_MIN_CHILDREN = 16;
+
+// Hashes a tag case-insensitively, consistent with tagsMatch()
+struct TagHash {
+	size_t operator()( const std::string *tag ) const
+	{
+		size_t result = 2166136261U;
+		for( std::string::const_iterator charIt = tag->begin(); charIt != tag->end(); ++charIt )
+			result = ( result ^ (size_t)toupper( (unsigned char)*charIt ) ) * 16777619U;
+		return result;
+	}
+};
+
+struct TagEqual {
+	bool operator()( const std::string *lhs, const std::string *rhs ) const { return boost::iequals( *lhs, *rhs ); }
+};
 } // anonymous namespace
 
+//! Maps each distinct tag, ignoring case, to the first child carrying it. Keys point at the children's own tags rather than copies.
+struct XmlTree::ChildIndex {
+	typedef std::unordered_map<const std::string*, Container::const_iterator, TagHash, TagEqual>	Map;
+
+	Map		mFirstChildren;
+	size_t	mNumChildren;
+};
+
 XmlTree::ConstIter::ConstIter( const Container *sequence )
 {
 	mSequenceStack.push_back( sequence );
@@ -76,12 +104,10 @@ XmlTree::ConstIter::ConstIter( const XmlTree &root, const string &filterPath, bo
 	}	
 
 	for( vector<string>::const_iterator filterComp = mFilter.begin(); filterComp != mFilter.end(); ++filterComp ) {
-		if( mIterStack.empty() ) // first item
-			mSequenceStack.push_back( &root.getChildren() );
-		else
-			mSequenceStack.push_back( &(*mIterStack.back())->getChildren() );
+		const XmlTree *parent = mIterStack.empty() ? &root : mIterStack.back()->get(); // root for the first item
+		mSequenceStack.push_back( &parent->mChildren );
 		
-		Container::const_iterator child = findNextChildNamed( *mSequenceStack.back(), mSequenceStack.back()->begin(), *filterComp, mCaseSensitive );
+		Container::const_iterator child = parent->findFirstChildNamed( *filterComp, mCaseSensitive );
 		if( child != (mSequenceStack.back())->end() )
 			mIterStack.push_back( child );
 		else { // failed to find an item that matches this part of the filter; mark as finished and return
@@ -148,6 +174,35 @@ XmlTree::Container::const_iterator XmlTree::findNextChildNamed( const Container
 	return result;
 }
 
+XmlTree::Container::const_iterator XmlTree::findFirstChildNamed( const string &searchTag, bool caseSensitive ) const
+{
+	if( mChildren.size() < CHILD_INDEX_MIN_CHILDREN )
+		return findNextChildNamed( mChildren, mChildren.begin(), searchTag, caseSensitive );
+
+	// the child count catches children added or removed through a retained reference from getChildren()
+	if( ( ! mChildIndex ) || ( mChildIndex->mNumChildren != mChildren.size() ) ) {
+		mChildIndex.reset( new ChildIndex );
+		mChildIndex->mNumChildren = mChildren.size();
+		for( Container::const_iterator childIt = mChildren.begin(); childIt != mChildren.end(); ++childIt )
+			mChildIndex->mFirstChildren.insert( make_pair( &(*childIt)->mTag, childIt ) ); // keeps the first of each tag
+	}
+
+	ChildIndex::Map::const_iterator found = mChildIndex->mFirstChildren.find( &searchTag );
+	if( found == mChildIndex->mFirstChildren.end() )
+		return mChildren.end();
+
+	// the index is case-insensitive; a case-sensitive search continues from the first candidate
+	Container::const_iterator result = found->second;
+	if( caseSensitive && ( (*result)->mTag != searchTag ) )
+		result = findNextChildNamed( mChildren, result, searchTag, true );
+	return result;
+}
+
+void XmlTree::invalidateChildIndex()
+{
+	mChildIndex.reset();
+}
+
 XmlTree::XmlTree( const XmlTree &rhs )
 	: mNodeType( rhs.mNodeType ), mTag( rhs.mTag ), mValue( rhs.mValue ), mDocType( rhs.mDocType ),
 	 mParent( 0 ), mAttributes( rhs.mAttributes )
@@ -168,6 +223,7 @@ XmlTree& XmlTree::operator=( const XmlTree &rhs )
 	mAttributes = rhs.mAttributes;
 
 	mChildren.clear();
+	mChildIndex.reset();
 
 	for( XmlTree::ConstIter childIt = rhs.begin(); childIt != rhs.end(); ++childIt ) {
 		mChildren.push_back( unique_ptr<XmlTree>( new XmlTree( *childIt ) ) );
@@ -178,6 +234,7 @@ XmlTree& XmlTree::operator=( const XmlTree &rhs )
 }
 
 XmlTree::XmlTree( const std::string &xmlString, ParseOptions parseOptions )
+	: mNodeType( NODE_DOCUMENT ), mParent( 0 )
 {
 	std::string strCopy( xmlString );
 	rapidxml::xml_document<> doc;    // character type defaults to char
@@ -191,7 +248,9 @@ XmlTree::XmlTree( const std::string &xmlString, ParseOptions parseOptions )
 
 void parseItem( const rapidxml::xml_node<> &node, XmlTree *parent, XmlTree *result, const XmlTree::ParseOptions &options )
 {
-	*result = XmlTree( node.name(), node.value(), parent );
+	// result was created by its parent, so assign its contents rather than the whole node to keep its parent pointer
+	result->setTag( node.name() );
+	result->setValue( node.value() );
 	for( const rapidxml::xml_node<> *item = node.first_node(); item; item = item->next_sibling() ) {
 		XmlTree::NodeType type;
 		switch( item->type() ) {
@@ -226,7 +285,7 @@ void parseItem( const rapidxml::xml_node<> &node, XmlTree *parent, XmlTree *resu
 				continue;
 		}
 		
-		result->getChildren().push_back( unique_ptr<XmlTree>( new XmlTree ) );
+		result->getChildren().push_back( unique_ptr<XmlTree>( new XmlTree( "", "", result ) ) );
 		parseItem( *item, result, result->getChildren().back().get(), options );
 		result->getChildren().back()->setNodeType( type );
 	}
@@ -324,26 +383,33 @@ string	XmlTree::getPath( char separator ) const
 
 void XmlTree::push_back( const XmlTree &newChild )
 {
+	invalidateChildIndex();
 	mChildren.push_back( unique_ptr<XmlTree>( new XmlTree( newChild ) ) );
 	mChildren.back()->mParent = this;
 }
 
 XmlTree* XmlTree::getNodePtr( const string &relativePath, bool caseSensitive, char separator ) const
 {
-	XmlTree *curNode = const_cast<XmlTree*>( this );
+	// single names, as used by operator/, don't need splitting
+	if( ( ! relativePath.empty() ) && ( relativePath.find( separator ) == string::npos ) ) {
+		Container::const_iterator node = findFirstChildNamed( relativePath, caseSensitive );
+		return ( node != mChildren.end() ) ? node->get() : 0;
+	}
+
+	const XmlTree *curNode = this;
 
 	vector<string> pathComponents = split( relativePath, separator );
 	for( vector<string>::const_iterator pathIt = pathComponents.begin(); pathIt != pathComponents.end(); ++pathIt ) {
 		if( pathIt->empty() )
 			continue;
-		Container::const_iterator node = XmlTree::findNextChildNamed( curNode->getChildren(), curNode->getChildren().begin(), *pathIt, caseSensitive )	;
-		if( node != curNode->getChildren().end() )
-			curNode = const_cast<XmlTree*>( node->get() );
+		Container::const_iterator node = curNode->findFirstChildNamed( *pathIt, caseSensitive );
+		if( node != curNode->mChildren.end() )
+			curNode = node->get();
 		else
 			return 0;
 	}
 
-	return curNode;
+	return const_cast<XmlTree*>( curNode );
 }
 
 void XmlTree::appendRapidXmlNode( rapidxml::xml_document<char> &doc, rapidxml::xml_node<char> *parent ) const
@@ -436,5 +502,347 @@ XmlTree::ExcAttrNotFound::ExcAttrNotFound( const XmlTree &node, const string &at
 	sprintf( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), node.getPath().c_str() );
 #endif
 }
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlView
+
+//! Owns the in-situ parsed text and the rapidxml document, including the memory pool its nodes live in
+class XmlView::Document {
+  public:
+	Document( const XmlTree::ParseOptions &parseOptions )
+		: mParseOptions( parseOptions )
+	{}
+
+	std::vector<char>				mText;
+	rapidxml::xml_document<char>	mDoc;
+	XmlTree::ParseOptions			mParseOptions;
+};
+
+namespace {
+
+// Returns whether \a node is exposed as a child, matching the nodes parseItem() creates for an XmlTree
+bool isViewChild( const rapidxml::xml_node<> *node, const XmlTree::ParseOptions &options )
+{
+	switch( node->type() ) {
+		case rapidxml::node_element:
+		case rapidxml::node_comment:
+			return true;
+		case rapidxml::node_cdata:
+			return ! options.getCollapseCData();
+		case rapidxml::node_data:
+			return ! options.getIgnoreDataChildren();
+		default:
+			return false;
+	}
+}
+
+const rapidxml::xml_node<>* nextViewSibling( const rapidxml::xml_node<> *node, const XmlTree::ParseOptions &options )
+{
+	do {
+		node = node->next_sibling();
+	} while( node && ! isViewChild( node, options ) );
+	return node;
+}
+
+const rapidxml::xml_node<>* firstViewChild( const rapidxml::xml_node<> *node, const XmlTree::ParseOptions &options )
+{
+	node = node->first_node();
+	if( node && ! isViewChild( node, options ) )
+		node = nextViewSibling( node, options );
+	return node;
+}
+
+bool tagsMatch( const rapidxml::xml_node<> *node, const std::string &tag, bool caseSensitive )
+{
+	return rapidxml::internal::compare( node->name(), node->name_size(), tag.c_str(), tag.size(), caseSensitive );
+}
+
+} // anonymous namespace
+
+XmlView::ConstIter::ConstIter( const XmlView &parent )
+	: mCaseSensitive( false )
+{
+	if( parent.mNode )
+		mCurrent = XmlView( parent.mDocument, firstViewChild( parent.mNode, parent.mDocument->mParseOptions ) );
+}
+
+XmlView::ConstIter::ConstIter( const XmlView &root, const string &filterPath, bool caseSensitive, char separator )
+	: mCaseSensitive( caseSensitive )
+{
+	mFilter = split( filterPath, separator );
+
+	// we ignore a leading separator so that "/one/two" is equivalent to "one/two"
+	if( ( ! filterPath.empty() ) && ( filterPath[0] == separator ) && ( ! mFilter.empty() ) )
+		mFilter.erase( mFilter.begin() );
+
+	if( mFilter.empty() || ( ! root.mNode ) ) // empty filter means nothing matches
+		return;
+
+	mCurrent.mDocument = root.mDocument;
+	seek( 0, firstViewChild( root.mNode, root.mDocument->mParseOptions ) );
+}
+
+void XmlView::ConstIter::increment()
+{
+	const XmlTree::ParseOptions &options = mCurrent.mDocument->mParseOptions;
+	if( mFilter.empty() )
+		mCurrent.mNode = nextViewSibling( mCurrent.mNode, options );
+	else
+		seek( mStack.size() - 1, nextViewSibling( mStack.back(), options ) );
+}
+
+// Finds the next node matching the filter, starting with the siblings from \a candidate at depth \a level and backtracking up the stack once they're exhausted
+void XmlView::ConstIter::seek( size_t level, const Node *candidate )
+{
+	const XmlTree::ParseOptions &options = mCurrent.mDocument->mParseOptions;
+	while( true ) {
+		while( candidate && ! tagsMatch( candidate, mFilter[level], mCaseSensitive ) )
+			candidate = nextViewSibling( candidate, options );
+
+		if( candidate ) {
+			mStack.resize( level + 1 );
+			mStack[level] = candidate;
+			if( level + 1 == mFilter.size() ) {
+				mCurrent.mNode = candidate;
+				return;
+			}
+			candidate = firstViewChild( candidate, options );
+			++level;
+		}
+		else if( level == 0 ) {
+			mStack.clear();
+			mCurrent.mNode = 0;
+			return;
+		}
+		else {
+			--level;
+			candidate = nextViewSibling( mStack[level], options );
+		}
+	}
+}
+
+XmlView::Attr XmlView::Attr::getNext() const
+{
+	return Attr( mAttr ? mAttr->next_attribute() : 0 );
+}
+
+const char* XmlView::Attr::getName() const
+{
+	return mAttr ? mAttr->name() : "";
+}
+
+const char* XmlView::Attr::getValue() const
+{
+	return mAttr ? mAttr->value() : "";
+}
+
+size_t XmlView::Attr::getValueSize() const
+{
+	return mAttr ? mAttr->value_size() : 0;
+}
+
+XmlView::XmlView( DataSourceRef dataSource, XmlTree::ParseOptions parseOptions )
+	: mNode( 0 )
+{
+	shared_ptr<Document> document( new Document( parseOptions ) );
+
+	// files are read straight into the parse buffer; other sources are copied once to make room for the terminator
+	if( dataSource->isFilePath() ) {
+		IStreamRef stream = dataSource->createStream();
+		size_t dataSize = (size_t)stream->size();
+		document->mText.resize( dataSize + 1 );
+		stream->readData( &document->mText[0], dataSize );
+	}
+	else {
+		Buffer buf = dataSource->getBuffer();
+		document->mText.resize( buf.getDataSize() + 1 );
+		memcpy( &document->mText[0], buf.getData(), buf.getDataSize() );
+	}
+	document->mText.back() = 0;
+
+	parse( document );
+}
+
+XmlView::XmlView( const std::string &xmlString, XmlTree::ParseOptions parseOptions )
+	: mNode( 0 )
+{
+	shared_ptr<Document> document( new Document( parseOptions ) );
+	document->mText.assign( xmlString.c_str(), xmlString.c_str() + xmlString.size() + 1 );
+	parse( document );
+}
+
+void XmlView::parse( const shared_ptr<Document> &document )
+{
+	if( document->mParseOptions.getParseComments() )
+		document->mDoc.parse<rapidxml::parse_comment_nodes | rapidxml::parse_doctype_node>( &document->mText[0] );
+	else
+		document->mDoc.parse<rapidxml::parse_doctype_node>( &document->mText[0] );
+
+	mDocument = document;
+	mNode = &document->mDoc;
+}
+
+XmlTree::NodeType XmlView::getNodeType() const
+{
+	if( ! mNode )
+		return XmlTree::NODE_UNKNOWN;
+
+	switch( mNode->type() ) {
+		case rapidxml::node_document: return XmlTree::NODE_DOCUMENT;
+		case rapidxml::node_element: return XmlTree::NODE_ELEMENT;
+		case rapidxml::node_cdata: return XmlTree::NODE_CDATA;
+		case rapidxml::node_comment: return XmlTree::NODE_COMMENT;
+		case rapidxml::node_data: return XmlTree::NODE_DATA;
+		default: return XmlTree::NODE_UNKNOWN;
+	}
+}
+
+const char* XmlView::getTag() const
+{
+	return mNode ? mNode->name() : "";
+}
+
+const XmlView::Node* XmlView::getValueNode() const
+{
+	// an element whose only text is CDATA has no value of its own in rapidxml
+	if( mNode && ( mNode->value_size() == 0 ) && ( mNode->type() == rapidxml::node_element ) && mDocument->mParseOptions.getCollapseCData() ) {
+		for( const Node *child = mNode->first_node(); child; child = child->next_sibling() ) {
+			if( child->type() == rapidxml::node_cdata )
+				return child;
+		}
+	}
+
+	return mNode;
+}
+
+const char* XmlView::getValue() const
+{
+	const Node *node = getValueNode();
+	return node ? node->value() : "";
+}
+
+size_t XmlView::getValueSize() const
+{
+	const Node *node = getValueNode();
+	return node ? node->value_size() : 0;
+}
+
+bool XmlView::hasParent() const
+{
+	return mNode && mNode->parent();
+}
+
+XmlView XmlView::getParent() const
+{
+	return XmlView( mDocument, mNode ? mNode->parent() : 0 );
+}
+
+bool XmlView::hasChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	return findChild( relativePath, caseSensitive, separator ) != 0;
+}
+
+XmlView XmlView::getChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	const Node *child = findChild( relativePath, caseSensitive, separator );
+	if( child )
+		return XmlView( mDocument, child );
+	else
+		throw ExcChildNotFound( *this, relativePath );
+}
+
+const XmlView::Node* XmlView::findChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	if( ! mNode )
+		return 0;
+
+	const XmlTree::ParseOptions &options = mDocument->mParseOptions;
+	const Node *curNode = mNode;
+	vector<string> pathComponents = split( relativePath, separator );
+	for( vector<string>::const_iterator pathIt = pathComponents.begin(); pathIt != pathComponents.end(); ++pathIt ) {
+		if( pathIt->empty() )
+			continue;
+		const Node *child = firstViewChild( curNode, options );
+		while( child && ! tagsMatch( child, *pathIt, caseSensitive ) )
+			child = nextViewSibling( child, options );
+		if( ! child )
+			return 0;
+		curNode = child;
+	}
+
+	return curNode;
+}
+
+XmlView::Attr XmlView::getFirstAttribute() const
+{
+	return Attr( mNode ? mNode->first_attribute() : 0 );
+}
+
+XmlView::Attr XmlView::getAttribute( const string &attrName ) const
+{
+	const NodeAttr *attr = findAttribute( attrName );
+	if( attr )
+		return Attr( attr );
+	else
+		throw ExcAttrNotFound( *this, attrName );
+}
+
+const XmlView::NodeAttr* XmlView::findAttribute( const string &attrName ) const
+{
+	return mNode ? mNode->first_attribute( attrName.c_str(), attrName.size() ) : 0;
+}
+
+string XmlView::getPath( char separator ) const
+{
+	string result;
+
+	for( const Node *node = mNode; node; node = node->parent() ) {
+		string nodeName( node->name(), node->name_size() );
+		if( node != mNode )
+			nodeName += separator;
+		result = nodeName + result;
+	}
+
+	return result;
+}
+
+string XmlView::getDocType() const
+{
+	if( mNode ) {
+		for( const Node *child = mNode->first_node(); child; child = child->next_sibling() ) {
+			if( child->type() == rapidxml::node_doctype )
+				return string( child->value(), child->value_size() );
+		}
+	}
+
+	return string();
+}
+
+XmlTree XmlView::toXmlTree() const
+{
+	XmlTree result;
+	if( mNode ) {
+		parseItem( *mNode, NULL, &result, mDocument->mParseOptions );
+		result.setNodeType( getNodeType() ); // call this after parse - constructor replaces it
+	}
+	return result;
+}
+
+XmlView::ExcChildNotFound::ExcChildNotFound( const XmlView &node, const string &childPath ) throw()
+{
+#if (defined (CINDER_MSW ) || defined( CINDER_WINRT ))
+	sprintf_s( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), node.getPath().c_str() );
+#else
+	sprintf( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), node.getPath().c_str() );
+#endif
+}
+
+XmlView::ExcAttrNotFound::ExcAttrNotFound( const XmlView &node, const string &attrName ) throw()
+{
+#if (defined (CINDER_MSW ) || defined( CINDER_WINRT ))
+	sprintf_s( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), node.getPath().c_str() );
+#else
+	sprintf( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), node.getPath().c_str() );
+#endif
+}
 
 } // namespace cinder
\ No newline at end of file
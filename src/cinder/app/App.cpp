@@ -28,6 +28,7 @@
 #include "cinder/Utilities.h"
 #include "cinder/Timeline.h"
 #include "cinder/Thread.h"
+#include "cinder/Profiler.h"
 
 #if defined( CINDER_COCOA )
 	#if defined( CINDER_MAC )
@@ -69,6 +70,9 @@ App::Settings::Settings()
 	mPowerManagement = false;
 	mFrameRateEnabled = true;
 	mFrameRate = 60.0f;
+	mHighPrecisionFrameRate = false;
+	mSingleGlContext = false;
+	mOnDemandRendering = false;
 #if defined( CINDER_COCOA_TOUCH )
 	mEnableHighDensityDisplay = true;
 	mEnableMultiTouch = true;
@@ -76,6 +80,8 @@ App::Settings::Settings()
 	mEnableHighDensityDisplay = false;
 	mEnableMultiTouch = false;	
 #endif	
+	mEnableTouchCoalescing = false;
+	mEnableTouchHistory = false;
 }
 
 void App::Settings::disableFrameRate()
@@ -101,7 +107,7 @@ void App::Settings::prepareWindow( const Window::Format &format )
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // App::App
 App::App()
-	: mFrameCount( 0 ), mAverageFps( 0 ), mFpsSampleInterval( 1 ), mTimer( true ), mTimeline( Timeline::create() )
+	: mFrameCount( 0 ), mAverageFps( 0 ), mFpsSampleInterval( 1 ), mTimer( true ), mTimeline( Timeline::create() ), mInvalidated( true )
 {
 	mFpsLastSampleFrame = 0;
 	mFpsLastSampleTime = 0;
@@ -129,13 +135,36 @@ App::~App()
 void App::privateSetup__()
 {
 	mTimeline->stepTo( static_cast<float>( getElapsedSeconds() ) );
+	Profiler::get()->setThreadName( "main" );
 
 	setup();
 }
 
+void App::invalidate()
+{
+	mInvalidated = true;
+	if( getSettings().isOnDemandRenderingEnabled() )
+		wakeUp();
+}
+
+bool App::privateShouldRenderFrame__()
+{
+	if( ! getSettings().isOnDemandRenderingEnabled() )
+		return true;
+
+	return mInvalidated.exchange( false );
+}
+
 void App::privateUpdate__()
 {
+	// the previous frame ends as this one begins, just as with FrameTiming
+	Profiler::get()->frameMark();
+	CI_PROFILE_ZONE( "App::update" );
+
 	mFrameCount++;
+	double updateStart = mTimer.getSeconds();
+	// with on-demand rendering the gaps between frames are expected, so they aren't counted as late
+	mFrameTiming.beginFrame( mFrameCount, updateStart, getSettings().isOnDemandRenderingEnabled() ? 0 : getFrameRate() );
 
 #if !defined( CINDER_WINRT )
 	// service boost::asio::io_service
@@ -147,8 +176,17 @@ void App::privateUpdate__()
 	update();
 
 	mTimeline->stepTo( static_cast<float>( getElapsedSeconds() ) );
+	// keep rendering for as long as anything is animating
+	if( ! mTimeline->empty() )
+		invalidate();
+
+	// functions from dispatchAsync(), up to the queue's budget; anything left over runs in the following frames
+	mMainThreadQueue.drain();
+	if( mMainThreadQueue.getDepth() > 0 )
+		invalidate();
 
 	double now = mTimer.getSeconds();
+	mFrameTiming.addUpdateDuration( now - updateStart );
 	if( now > mFpsLastSampleTime + mFpsSampleInterval ) {
 		//calculate average Fps over sample interval
 		uint32_t framesPassed = mFrameCount - mFpsLastSampleFrame;
@@ -179,6 +217,9 @@ void App::emitDidBecomeActive()
 
 DataSourceRef App::loadResource( const string &macPath, int mswID, const string &mswType )
 {
+	if( DataSourceRef archived = App::get()->loadArchivedAsset( macPath ) )
+		return archived;
+
 #if defined( CINDER_COCOA )
 	return loadResource( macPath );
 #elif defined( CINDER_WINRT )
@@ -191,6 +232,9 @@ DataSourceRef App::loadResource( const string &macPath, int mswID, const string
 #if defined( CINDER_COCOA )
 DataSourceRef App::loadResource( const string &macPath )
 {
+	if( DataSourceRef archived = App::get()->loadArchivedAsset( macPath ) )
+		return archived;
+
 	fs::path resourcePath = App::get()->getResourcePath( macPath );
 	if( resourcePath.empty() )
 		throw ResourceLoadExc( macPath );
@@ -274,8 +318,21 @@ fs::path App::findAssetPath( const fs::path &relativePath )
 	return fs::path();
 }
 
+DataSourceRef App::loadArchivedAsset( const fs::path &relativePath )
+{
+	for( vector<AssetArchiveRef>::const_iterator archiveIt = mAssetArchives.begin(); archiveIt != mAssetArchives.end(); ++archiveIt ) {
+		if( (*archiveIt)->contains( relativePath ) )
+			return (*archiveIt)->load( relativePath );
+	}
+
+	return DataSourceRef();
+}
+
 DataSourceRef App::loadAsset( const fs::path &relativePath )
 {
+	if( DataSourceRef archived = loadArchivedAsset( relativePath ) )
+		return archived;
+
 	fs::path assetPath = findAssetPath( relativePath );
 	if( ! assetPath.empty() )
 		return DataSourcePath::create( assetPath.string() );
@@ -294,6 +351,11 @@ void App::addAssetDirectory( const fs::path &dirPath )
 	mAssetDirectories.push_back( dirPath );
 }
 
+void App::addAssetArchive( const AssetArchiveRef &archive )
+{
+	mAssetArchives.push_back( archive );
+}
+
 #if defined( CINDER_COCOA )
 NSBundle* App::getBundle() const
 {
@@ -493,19 +555,12 @@ bool App::isPrimaryThread()
 	return std::this_thread::get_id() == sPrimaryThreadId;
 }
 
-#if !defined( CINDER_WINRT )
-void App::dispatchAsync( const std::function<void()> &fn )
+void App::dispatchAsync( const std::function<void()> &fn, MainThreadQueue::Priority priority )
 {
-	io_service().post( fn );
+	mMainThreadQueue.push( fn, priority );
+	// the queue is only drained during update()
+	invalidate();
 }
-#else
-void App::dispatchAsync( const std::function<void()> &fn )
-{
-	std::async(fn);
-}
-
-
-#endif
 
 Surface	App::copyWindowSurface()
 {
@@ -277,6 +277,13 @@ void AppBasic::quit()
 #endif
 }
 
+#if defined( CINDER_MSW )
+void AppBasic::wakeUp()
+{
+	mImpl->wakeUp();
+}
+#endif
+
 bool AppBasic::privateShouldQuit()
 {
 	return mSignalShouldQuit();
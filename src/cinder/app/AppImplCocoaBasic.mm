@@ -129,6 +129,10 @@
 		}
 	}
 
+	// with on-demand rendering, skip frames until something invalidates the App
+	if( ! mApp->privateShouldRenderFrame__() )
+		return;
+
 	// issue update() event
 	mApp->privateUpdate__();
 
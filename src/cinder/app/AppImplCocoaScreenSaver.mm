@@ -433,7 +433,8 @@ AppImplCocoaScreenSaver* getAppImpl()
 		}
 	}
 
-	if( allWindowsDrawn ) {
+	// with on-demand rendering, skip updating (and so redrawing) until something invalidates the App
+	if( allWindowsDrawn && mApp->privateShouldRenderFrame__() ) {
 		[self setActiveWindow:callee];
 		mApp->privateUpdate__();
 		for( auto &win : mWindows )
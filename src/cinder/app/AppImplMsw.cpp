@@ -324,7 +324,7 @@ fs::path AppImplMsw::getSaveFilePath( const fs::path &initialPath, vector<string
 ///////////////////////////////////////////////////////////////////////////////
 // WindowImplMsw
 WindowImplMsw::WindowImplMsw( const Window::Format &format, RendererRef sharedRenderer, AppImplMsw *appImpl )
-	: mWindowOffset( 0, 0 ), mAppImpl( appImpl ), mIsDragging( false ), mHidden( false )
+	: mWindowOffset( 0, 0 ), mAppImpl( appImpl ), mIsDragging( false ), mHidden( false ), mCoalesceTouches( false )
 {	
 	mFullScreen = format.isFullScreen();
 	mDisplay = format.getDisplay();
@@ -351,7 +351,7 @@ WindowImplMsw::WindowImplMsw( const Window::Format &format, RendererRef sharedRe
 }
 
 WindowImplMsw::WindowImplMsw( HWND hwnd, RendererRef renderer, RendererRef sharedRenderer, AppImplMsw *appImpl )
-	: mWnd( hwnd ), mRenderer( renderer ), mAppImpl( appImpl ), mIsDragging( false )
+	: mWnd( hwnd ), mRenderer( renderer ), mAppImpl( appImpl ), mIsDragging( false ), mCoalesceTouches( false )
 {
 	RECT rect;
 	::GetWindowRect( mWnd, &rect );
@@ -445,6 +445,8 @@ void WindowImplMsw::completeCreation()
 	::DragAcceptFiles( mWnd, TRUE );
 	if( mAppImpl->mApp->getSettings().isMultiTouchEnabled() )
 		enableMultiTouch();
+	mCoalesceTouches = mAppImpl->mApp->getSettings().isTouchCoalescingEnabled();
+	mTouchCoalescer.setHistoryEnabled( mAppImpl->mApp->getSettings().isTouchHistoryEnabled() );
 
 	::ShowWindow( mWnd, SW_SHOW );
 	::SetForegroundWindow( mWnd );
@@ -606,6 +608,12 @@ void WindowImplMsw::enableMultiTouch()
 	}
 }
 
+void WindowImplMsw::flushTouches()
+{
+	if( mCoalesceTouches && mTouchCoalescer.hasPendingTouches() )
+		mTouchCoalescer.flush( getWindow() );
+}
+
 void WindowImplMsw::onTouch( HWND hWnd, WPARAM wParam, LPARAM lParam )
 {
 	// pull these symbols dynamically out of the user32.dll
@@ -619,12 +627,15 @@ void WindowImplMsw::onTouch( HWND hWnd, WPARAM wParam, LPARAM lParam )
 	bool handled = false;
 	double currentTime = app::getElapsedSeconds(); // we don't trust the device's sense of time
 	unsigned int numInputs = LOWORD( wParam );
-	std::shared_ptr<TOUCHINPUT> pInputs = std::shared_ptr<TOUCHINPUT>( new TOUCHINPUT[numInputs], checked_array_deleter<TOUCHINPUT>() );
-	if( pInputs ) {
+	// the input array is reused across messages; it only needs to outlive the events emitted below
+	if( mTouchInputs.size() < numInputs )
+		mTouchInputs.resize( numInputs );
+	TOUCHINPUT *pInputs = mTouchInputs.data();
+	if( numInputs ) {
 		vector<TouchEvent::Touch> beganTouches, movedTouches, endTouches, activeTouches;
-		if( GetTouchInputInfo((HTOUCHINPUT)lParam, numInputs, pInputs.get(), sizeof(TOUCHINPUT) ) ) {
+		if( GetTouchInputInfo((HTOUCHINPUT)lParam, numInputs, pInputs, sizeof(TOUCHINPUT) ) ) {
 			for( unsigned int i = 0; i < numInputs; i++ ) {
-				const TOUCHINPUT &ti = pInputs.get()[i];
+				const TOUCHINPUT &ti = pInputs[i];
 				if( ti.dwID != 0 ) {
 					POINT pt;
 					// this has a small problem, which is that we lose the subpixel precision of the touch points.
@@ -635,16 +646,16 @@ void WindowImplMsw::onTouch( HWND hWnd, WPARAM wParam, LPARAM lParam )
 					::ScreenToClient( hWnd, &pt );
 					if( ti.dwFlags & 0x0004/*TOUCHEVENTF_UP*/ ) {
 						Vec2f prevPos = mMultiTouchPrev[ti.dwID];
-						endTouches.push_back( TouchEvent::Touch( Vec2f( (float)pt.x, (float)pt.y ), prevPos, ti.dwID, currentTime, &pInputs.get()[i] ) );
+						endTouches.push_back( TouchEvent::Touch( Vec2f( (float)pt.x, (float)pt.y ), prevPos, ti.dwID, currentTime, &pInputs[i] ) );
 						mMultiTouchPrev.erase( ti.dwID );
 					}
 					else if( ti.dwFlags & 0x0002/*TOUCHEVENTF_DOWN*/ ) {
-						beganTouches.push_back( TouchEvent::Touch( Vec2f( (float)pt.x, (float)pt.y ), Vec2f( (float)pt.x, (float)pt.y ), ti.dwID, currentTime, &pInputs.get()[i] ) );
+						beganTouches.push_back( TouchEvent::Touch( Vec2f( (float)pt.x, (float)pt.y ), Vec2f( (float)pt.x, (float)pt.y ), ti.dwID, currentTime, &pInputs[i] ) );
 						mMultiTouchPrev[ti.dwID] = Vec2f( (float)pt.x, (float)pt.y );
 						activeTouches.push_back( beganTouches.back() );
 					}
 					else if( ti.dwFlags & 0x0001/*TOUCHEVENTF_MOVE*/ ) {
-						movedTouches.push_back( TouchEvent::Touch( Vec2f( (float)pt.x, (float)pt.y ), mMultiTouchPrev[ti.dwID], ti.dwID, currentTime, &pInputs.get()[i] ) );
+						movedTouches.push_back( TouchEvent::Touch( Vec2f( (float)pt.x, (float)pt.y ), mMultiTouchPrev[ti.dwID], ti.dwID, currentTime, &pInputs[i] ) );
 						activeTouches.push_back( movedTouches.back() );
 						mMultiTouchPrev[ti.dwID] = Vec2f( (float)pt.x, (float)pt.y );
 					}
@@ -652,19 +663,30 @@ void WindowImplMsw::onTouch( HWND hWnd, WPARAM wParam, LPARAM lParam )
             }
             
 			mActiveTouches = activeTouches;
-            
-            // we need to post the event here so that our pInputs array is still valid since we've passed addresses into it as the native pointers
-            if( ! beganTouches.empty() ) {
-				TouchEvent event( getWindow(), beganTouches );
-				getWindow()->emitTouchesBegan( &event );
-			}
-			if( ! movedTouches.empty() ) {
-				TouchEvent event( getWindow(), movedTouches );
-				getWindow()->emitTouchesMoved( &event );
+
+			if( mCoalesceTouches ) {
+				// delivered by flushTouches() at the start of the next frame
+				for( vector<TouchEvent::Touch>::const_iterator touchIt = beganTouches.begin(); touchIt != beganTouches.end(); ++touchIt )
+					mTouchCoalescer.touchBegan( *touchIt );
+				for( vector<TouchEvent::Touch>::const_iterator touchIt = movedTouches.begin(); touchIt != movedTouches.end(); ++touchIt )
+					mTouchCoalescer.touchMoved( *touchIt );
+				for( vector<TouchEvent::Touch>::const_iterator touchIt = endTouches.begin(); touchIt != endTouches.end(); ++touchIt )
+					mTouchCoalescer.touchEnded( *touchIt );
 			}
-			if( ! endTouches.empty() ) {
-				TouchEvent event( getWindow(), endTouches );
-				getWindow()->emitTouchesEnded( &event );
+			else {
+				// we need to post the event here so that our pInputs array is still valid since we've passed addresses into it as the native pointers
+				if( ! beganTouches.empty() ) {
+					TouchEvent event( getWindow(), beganTouches );
+					getWindow()->emitTouchesBegan( &event );
+				}
+				if( ! movedTouches.empty() ) {
+					TouchEvent event( getWindow(), movedTouches );
+					getWindow()->emitTouchesMoved( &event );
+				}
+				if( ! endTouches.empty() ) {
+					TouchEvent event( getWindow(), endTouches );
+					getWindow()->emitTouchesEnded( &event );
+				}
 			}
 			
             handled = ( ! beganTouches.empty() ) || ( ! movedTouches.empty() ) || ( ! endTouches.empty() );
@@ -993,7 +1015,10 @@ void WindowImplMsw::draw()
 	mAppImpl->setWindow( mWindowRef );
 	mRenderer->startDraw();
 	mWindowRef->emitDraw();
+	App *app = mAppImpl->getApp();
+	double swapStart = app->getElapsedSeconds();
 	mRenderer->finishDraw();
+	app->getFrameTiming().addSwapDuration( app->getElapsedSeconds() - swapStart );
 }
 
 void WindowImplMsw::resize()
@@ -24,11 +24,14 @@
 #include "cinder/app/AppImplMswBasic.h"
 #include "cinder/app/AppBasic.h"
 #include "cinder/app/AppImplMswRenderer.h"
+#include "cinder/app/AppImplMswRendererGl.h"
 #include "cinder/app/Renderer.h"
 #include "cinder/Utilities.h"
 
 #include <windowsx.h>
 #include <winuser.h>
+#include <mmsystem.h>
+#pragma comment( lib, "winmm.lib" )
 
 using std::vector;
 using std::string;
@@ -39,12 +42,19 @@ AppImplMswBasic::AppImplMswBasic( AppBasic *aApp )
 	: AppImplMsw( aApp ), mApp( aApp )
 {
 	mShouldQuit = false;
+	mWakeEvent = ::CreateEvent( NULL, FALSE, FALSE, NULL );
 }
 
 void AppImplMswBasic::run()
 {
 	mFrameRate = mApp->getSettings().getFrameRate();
 	mFrameRateEnabled = mApp->getSettings().isFrameRateEnabled();
+	mHighPrecisionFrameRate = mApp->getSettings().isHighPrecisionFrameRateEnabled();
+	mOnDemandRendering = mApp->getSettings().isOnDemandRenderingEnabled();
+
+	// raising the system timer's resolution to 1 ms lets the waitable timer wake up close to the time requested
+	if( mHighPrecisionFrameRate )
+		::timeBeginPeriod( 1 );
 
 	auto formats = mApp->getSettings().getWindowFormats();
 	if( formats.empty() )
@@ -69,10 +79,22 @@ void AppImplMswBasic::run()
 
 	// inner loop
 	while( ! mShouldQuit ) {
+		// with on-demand rendering, process messages without updating or drawing until something invalidates the App
+		if( mOnDemandRendering && ( ! mApp->privateShouldRenderFrame__() ) ) {
+			waitForInvalidation();
+			continue;
+		}
+
 		// update and draw
+		for( auto windowIt = mWindows.begin(); windowIt != mWindows.end(); ++windowIt )
+			(*windowIt)->flushTouches();
 		mApp->privateUpdate__();
+		AppImplMswRendererGl::beginSwapPass();
 		for( auto windowIt = mWindows.begin(); windowIt != mWindows.end(); ++windowIt )
 			(*windowIt)->redraw();
+		double swapStart = mApp->getElapsedSeconds();
+		if( AppImplMswRendererGl::endSwapPass() )
+			mApp->getFrameTiming().addSwapDuration( mApp->getElapsedSeconds() - swapStart );
 
 		// get current time in seconds
 		double currentSeconds = mApp->getElapsedSeconds();
@@ -91,8 +113,12 @@ void AppImplMswBasic::run()
 		mNextFrameTime += secondsPerFrame;
 
 		// sleep and process messages until next frame
-		if( ( mFrameRateEnabled ) && ( mNextFrameTime > currentSeconds ) )
-			sleep(mNextFrameTime - currentSeconds);
+		if( ( mFrameRateEnabled ) && ( mNextFrameTime > currentSeconds ) ) {
+			if( mHighPrecisionFrameRate )
+				sleepUntil( mNextFrameTime );
+			else
+				sleep(mNextFrameTime - currentSeconds);
+		}
 		else {
 			MSG msg;
 			while( ::PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
@@ -102,11 +128,41 @@ void AppImplMswBasic::run()
 		}
 	}
 
+	if( mHighPrecisionFrameRate )
+		::timeEndPeriod( 1 );
+	::CloseHandle( mWakeEvent );
+
 //	killWindow( mFullScreen );
 	mApp->emitShutdown();
 	delete mApp;
 }
 
+void AppImplMswBasic::quit()
+{
+	mShouldQuit = true;
+	wakeUp();
+}
+
+void AppImplMswBasic::wakeUp()
+{
+	::SetEvent( mWakeEvent );
+}
+
+void AppImplMswBasic::waitForInvalidation()
+{
+	// blocks until a message arrives or wakeUp() is called; the event is auto-reset
+	::MsgWaitForMultipleObjects( 1, &mWakeEvent, FALSE, INFINITE, QS_ALLINPUT );
+
+	MSG msg;
+	while( ::PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
+		::TranslateMessage( &msg );
+		::DispatchMessage( &msg );
+	}
+
+	// don't try to catch up on the frames which weren't rendered while waiting
+	mNextFrameTime = std::max( mNextFrameTime, mApp->getElapsedSeconds() );
+}
+
 void AppImplMswBasic::sleep( double seconds )
 {
 	// create waitable timer
@@ -138,6 +194,26 @@ void AppImplMswBasic::sleep( double seconds )
 	}
 }
 
+void AppImplMswBasic::sleepUntil( double deadlineSeconds )
+{
+	// the waitable timer can wake up a millisecond or more late, so it's only used until shortly before the deadline,
+	// and the remainder is spent spinning while processing messages
+	const double SPIN_SECONDS = 0.002;
+
+	double remaining = deadlineSeconds - mApp->getElapsedSeconds();
+	if( remaining > SPIN_SECONDS )
+		sleep( remaining - SPIN_SECONDS );
+
+	MSG msg;
+	while( ( ! mShouldQuit ) && ( mApp->getElapsedSeconds() < deadlineSeconds ) ) {
+		while( ::PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
+			::TranslateMessage( &msg );
+			::DispatchMessage( &msg );
+		}
+		YieldProcessor();
+	}
+}
+
 WindowRef AppImplMswBasic::createWindow( Window::Format format )
 {
 	if( ! format.getRenderer() )
@@ -170,6 +170,40 @@ namespace Shaders {
 
 namespace cinder { namespace app {
 
+namespace {
+
+// FNV-1a over the raw bytes of a D3D11 state description
+template<typename DescT>
+size_t hashStateDesc( const DescT &desc )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( &desc );
+	uint32_t hash = 2166136261U;
+	for( size_t i = 0; i < sizeof(DescT); ++i )
+		hash = ( hash ^ bytes[i] ) * 16777619U;
+	return hash;
+}
+
+template<typename DescT, typename StateT>
+StateT* findCachedState( const std::unordered_multimap<size_t, std::pair<DescT, StateT*> > &cache, const DescT &desc, size_t hash )
+{
+	auto range = cache.equal_range( hash );
+	for( auto it = range.first; it != range.second; ++it ) {
+		if( memcmp( &it->second.first, &desc, sizeof(DescT) ) == 0 )
+			return it->second.second;
+	}
+	return NULL;
+}
+
+template<typename CacheT>
+void releaseCachedStates( CacheT *cache )
+{
+	for( auto it = cache->begin(); it != cache->end(); ++it )
+		it->second.second->Release();
+	cache->clear();
+}
+
+} // anonymous namespace
+
 //bool sMultisampleSupported = false;
 //int sArbMultisampleFormat;
 
@@ -214,12 +248,17 @@ AppImplMswRendererDx::AppImplMswRendererDx( App *aApp, RendererDx *aRenderer )
   mFixedLayout( NULL ),
   mVertexBuffer( NULL ),
   mIndexBuffer( NULL ),
+  mBatchVertexBuffer( NULL ),
+  mBatchVertexOffset( BATCH_RING_VERTICES ),
   mDefaultRenderState( NULL ),
   mDepthStencilState( NULL ),
   mCBMatrices( NULL ),
   mCBLights( NULL ),
   mCBFixedParameters( NULL ),
   mBlendState( NULL ),
+  mCBMatricesValid( false ),
+  mCBFixedParametersValid( false ),
+  mCBLightsValid( false ),
   mStateFlags(0),
   mVsyncEnable( false ),
   mFullScreen( false )
@@ -286,12 +325,15 @@ void AppImplMswRendererDx::releaseNonDeviceResources()
 	if(mFixedLayout) mFixedLayout->Release(); mFixedLayout = NULL;
 	if(mVertexBuffer) mVertexBuffer->Release(); mVertexBuffer = NULL;
 	if(mIndexBuffer) mIndexBuffer->Release(); mIndexBuffer = NULL;
+	if(mBatchVertexBuffer) mBatchVertexBuffer->Release(); mBatchVertexBuffer = NULL;
+	mBatch.mVerts.clear();
 	if(mCBMatrices) mCBMatrices->Release(); mCBMatrices = NULL;
 	if(mCBLights) mCBLights->Release(); mCBLights = NULL;
 	if(mCBFixedParameters) mCBFixedParameters->Release(); mCBFixedParameters = NULL;
-	if(mBlendState) mBlendState->Release(); mBlendState = NULL;
-	if(mDefaultRenderState) mDefaultRenderState->Release(); mDefaultRenderState = NULL;
-	if(mDepthStencilState) mDepthStencilState->Release(); mDepthStencilState = NULL;
+	releaseCachedStates( &mBlendStateCache ); mBlendState = NULL;
+	releaseCachedStates( &mRasterizerStateCache ); mDefaultRenderState = NULL;
+	releaseCachedStates( &mDepthStencilStateCache ); mDepthStencilState = NULL;
+	mCBMatricesValid = mCBFixedParametersValid = mCBLightsValid = false;
 	if(mMainFramebuffer) mMainFramebuffer->Release(); mMainFramebuffer = NULL;
 	if(mSwapChain) mSwapChain->Release(); mSwapChain = NULL;
 }
@@ -324,12 +366,28 @@ void AppImplMswRendererDx::defaultResize() const
 
 void AppImplMswRendererDx::swapBuffers() const
 {
+	const_cast<AppImplMswRendererDx*>(this)->flushBatch();
+
 	DXGI_PRESENT_PARAMETERS parameters = {0};
 	parameters.DirtyRectsCount = 0;
 	parameters.pDirtyRects = nullptr;
 	parameters.pScrollRect = nullptr;
 	parameters.pScrollOffset = nullptr;
 
+	// with partial redraw only the dirty areas are presented, which spares the compositor the rest of the window
+	std::vector<RECT> dirtyRects;
+	WindowRef window = mApp->getWindow();
+	if( window && window->isPartialRedrawEnabled() ) {
+		const std::vector<Area> &dirtyAreas = window->getDirtyAreas();
+		for( std::vector<Area>::const_iterator areaIt = dirtyAreas.begin(); areaIt != dirtyAreas.end(); ++areaIt ) {
+			Area area = window->toPixels( *areaIt );
+			RECT rect = { area.x1, area.y1, area.x2, area.y2 };
+			dirtyRects.push_back( rect );
+		}
+		parameters.DirtyRectsCount = static_cast<UINT>( dirtyRects.size() );
+		parameters.pDirtyRects = dirtyRects.empty() ? nullptr : &dirtyRects[0];
+	}
+
 	HRESULT hr;
 #if defined( CINDER_WINRT ) || ( _WIN32_WINNT >= 0x0602 )
 	if( mVsyncEnable )
@@ -365,20 +423,18 @@ void AppImplMswRendererDx::setViewport(int x, int y, int width, int height) cons
     vp.MaxDepth = 1.0f;
     vp.TopLeftX = (FLOAT)x;
     vp.TopLeftY = (FLOAT)y;
+	const_cast<AppImplMswRendererDx*>(this)->flushBatch();
 	mDeviceContext->RSSetViewports( 1, &vp );
 }
 
 void AppImplMswRendererDx::enableDepthTesting(bool enable)
 {
 	mDepthStencilDesc.DepthEnable = enable == true;
-	if(mDepthStencilState) mDepthStencilState->Release();
-	md3dDevice->CreateDepthStencilState(&mDepthStencilDesc, &mDepthStencilState);
-	mDeviceContext->OMSetDepthStencilState(mDepthStencilState, 0xff);
+	setDepthStencilState(mDepthStencilDesc);
 }
 
 void AppImplMswRendererDx::enableAlphaBlending(bool premultiplied)
 {
-	if(mBlendState) mBlendState->Release();
 	mBlendDesc.RenderTarget[0].BlendEnable = TRUE;
 	mBlendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
 	mBlendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
@@ -393,36 +449,179 @@ void AppImplMswRendererDx::enableAlphaBlending(bool premultiplied)
 		mBlendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
 		mBlendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
 	}
-	md3dDevice->CreateBlendState(&mBlendDesc, &mBlendState);
-	mDeviceContext->OMSetBlendState(mBlendState, 0, 0xffffffff);
+	setBlendState(mBlendDesc);
 }
 
 void AppImplMswRendererDx::disableAlphaBlending()
 {
-	if(mBlendState) mBlendState->Release();
 	mBlendDesc.RenderTarget[0].BlendEnable = FALSE;
-	md3dDevice->CreateBlendState(&mBlendDesc, &mBlendState);
-	mDeviceContext->OMSetBlendState(mBlendState, 0, 0xffffffff);
+	setBlendState(mBlendDesc);
 }
 
 void AppImplMswRendererDx::enableAdditiveBlending()
 {
-	if(mBlendState) mBlendState->Release();
 	mBlendDesc.RenderTarget[0].BlendEnable = TRUE;
 	mBlendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
 	mBlendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
 	mBlendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
 	mBlendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
 	mBlendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_SRC_ALPHA;
-	md3dDevice->CreateBlendState(&mBlendDesc, &mBlendState);
-	mDeviceContext->OMSetBlendState(mBlendState, 0, 0xffffffff);
+	setBlendState(mBlendDesc);
+}
+
+void AppImplMswRendererDx::batchVertices( const FixedVertex *verts, size_t count, D3D_PRIMITIVE_TOPOLOGY topology, ID3D11VertexShader *vs, ID3D11PixelShader *ps, ID3D11ShaderResourceView *srv )
+{
+	if( count == 0 )
+		return;
+
+	if( ( ! mBatch.mVerts.empty() ) && ( mBatch.mTopology != topology || mBatch.mVertexShader != vs || mBatch.mPixelShader != ps || mBatch.mShaderResourceView != srv ) )
+		flushBatch();
+
+	mBatch.mTopology = topology;
+	mBatch.mVertexShader = vs;
+	mBatch.mPixelShader = ps;
+	mBatch.mShaderResourceView = srv;
+	mBatch.mVerts.insert( mBatch.mVerts.end(), verts, verts + count );
+
+	// custom shaders and lights can have their constant buffers updated between draws without our knowledge, so don't hold on to their geometry
+	if( mLightingEnabled || getRenderFlag( CUSTOM_SHADER_ACTIVE ) )
+		flushBatch();
+}
+
+void AppImplMswRendererDx::flushBatch()
+{
+	if( mBatch.mVerts.empty() || ! mBatchVertexBuffer )
+		return;
+
+	// batched vertices are already transformed into clip space
+	updateMatrices( Matrix44f::identity(), Matrix44f::identity() );
+	if( mLightingEnabled )
+		mDeviceContext->VSSetConstantBuffers( 1, 1, &mCBLights );
+	if( ! getRenderFlag( CUSTOM_SHADER_ACTIVE ) ) {
+		mDeviceContext->VSSetShader( mBatch.mVertexShader, NULL, 0 );
+		mDeviceContext->PSSetShader( mBatch.mPixelShader, NULL, 0 );
+	}
+	mDeviceContext->VSSetConstantBuffers( 0, 1, &mCBMatrices );
+	mDeviceContext->IASetPrimitiveTopology( mBatch.mTopology );
+	UINT stride = sizeof(FixedVertex);
+	UINT offset = 0;
+	mDeviceContext->IASetVertexBuffers( 0, 1, &mBatchVertexBuffer, &stride, &offset );
+	mDeviceContext->IASetInputLayout( mFixedLayout );
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	const FixedVertex *verts = mBatch.mVerts.data();
+	size_t remaining = mBatch.mVerts.size();
+	while( remaining > 0 ) {
+		UINT count = (UINT)std::min<size_t>( remaining, BATCH_MAX_DRAW_VERTICES );
+		// append behind the data the GPU may still be reading; only discard once the ring wraps
+		D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+		if( mBatchVertexOffset + count > BATCH_RING_VERTICES ) {
+			mapType = D3D11_MAP_WRITE_DISCARD;
+			mBatchVertexOffset = 0;
+		}
+		if( FAILED( mDeviceContext->Map( mBatchVertexBuffer, 0, mapType, 0, &mappedResource ) ) )
+			break;
+		memcpy( static_cast<FixedVertex*>( mappedResource.pData ) + mBatchVertexOffset, verts, count * sizeof(FixedVertex) );
+		mDeviceContext->Unmap( mBatchVertexBuffer, 0 );
+		mDeviceContext->Draw( count, mBatchVertexOffset );
+
+		mBatchVertexOffset += count;
+		verts += count;
+		remaining -= count;
+	}
+
+	mBatch.mVerts.clear();
 }
 
 void AppImplMswRendererDx::enableDepthWriting(bool enable)
 {
 	mDepthStencilDesc.DepthWriteMask = (enable) ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
-	if(mDepthStencilState) mDepthStencilState->Release();
-	md3dDevice->CreateDepthStencilState(&mDepthStencilDesc, &mDepthStencilState);
+	setDepthStencilState(mDepthStencilDesc);
+}
+
+void AppImplMswRendererDx::setBlendState( const D3D11_BLEND_DESC &desc )
+{
+	const size_t hash = hashStateDesc( desc );
+	ID3D11BlendState *state = findCachedState( mBlendStateCache, desc, hash );
+	if( ! state ) {
+		if( FAILED( md3dDevice->CreateBlendState( &desc, &state ) ) )
+			return;
+		mBlendStateCache.insert( std::make_pair( hash, std::make_pair( desc, state ) ) );
+	}
+	if( state == mBlendState )
+		return;
+
+	flushBatch();
+	mBlendState = state;
+	mDeviceContext->OMSetBlendState( mBlendState, 0, 0xffffffff );
+}
+
+void AppImplMswRendererDx::setDepthStencilState( const D3D11_DEPTH_STENCIL_DESC &desc )
+{
+	const size_t hash = hashStateDesc( desc );
+	ID3D11DepthStencilState *state = findCachedState( mDepthStencilStateCache, desc, hash );
+	if( ! state ) {
+		if( FAILED( md3dDevice->CreateDepthStencilState( &desc, &state ) ) )
+			return;
+		mDepthStencilStateCache.insert( std::make_pair( hash, std::make_pair( desc, state ) ) );
+	}
+	if( state == mDepthStencilState )
+		return;
+
+	flushBatch();
+	mDepthStencilState = state;
+	mDeviceContext->OMSetDepthStencilState( mDepthStencilState, 0 );
+}
+
+void AppImplMswRendererDx::setRasterizerState( const D3D11_RASTERIZER_DESC &desc )
+{
+	const size_t hash = hashStateDesc( desc );
+	ID3D11RasterizerState *state = findCachedState( mRasterizerStateCache, desc, hash );
+	if( ! state ) {
+		if( FAILED( md3dDevice->CreateRasterizerState( &desc, &state ) ) )
+			return;
+		mRasterizerStateCache.insert( std::make_pair( hash, std::make_pair( desc, state ) ) );
+	}
+	if( state == mDefaultRenderState )
+		return;
+
+	flushBatch();
+	mDefaultRenderState = state;
+	mDeviceContext->RSSetState( mDefaultRenderState );
+}
+
+bool AppImplMswRendererDx::updateConstantBuffer( ID3D11Buffer *buffer, void *shadow, const void *data, size_t size, bool *valid )
+{
+	if( *valid && memcmp( shadow, data, size ) == 0 )
+		return false;
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	if( FAILED( mDeviceContext->Map( buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource ) ) ) {
+		*valid = false;
+		return false;
+	}
+	memcpy( mappedResource.pData, data, size );
+	mDeviceContext->Unmap( buffer, 0 );
+	memcpy( shadow, data, size );
+	*valid = true;
+	return true;
+}
+
+void AppImplMswRendererDx::updateMatrices( const Matrix44f &projection, const Matrix44f &modelView )
+{
+	const Matrix44f matrices[2] = { projection, modelView };
+	updateConstantBuffer( mCBMatrices, mCBMatricesData, matrices, sizeof(matrices), &mCBMatricesValid );
+}
+
+void AppImplMswRendererDx::updateFixedParameters()
+{
+	const Vec4f parameters[3] = { Vec4f( mCurrentNormal, 0 ), Vec4f( mCurrentUV.x, mCurrentUV.y, 0, 0 ), mCurrentColor };
+	updateConstantBuffer( mCBFixedParameters, mCBFixedParametersData, parameters, sizeof(parameters), &mCBFixedParametersValid );
+}
+
+void AppImplMswRendererDx::updateLights()
+{
+	updateConstantBuffer( mCBLights, mCBLightsData, mLights, sizeof(mLights), &mCBLightsValid );
 }
 
 #if defined( CINDER_MSW )
@@ -536,6 +735,13 @@ bool AppImplMswRendererDx::initializeInternal( DX_WINDOW_TYPE wnd )
 	if(hr != S_OK)
 		return false;
 
+	// create the ring buffer used for batched immediate mode drawing
+	bd.ByteWidth = BATCH_RING_VERTICES * sizeof(FixedVertex);
+	hr = md3dDevice->CreateBuffer( &bd, NULL, &mBatchVertexBuffer );
+	if(hr != S_OK)
+		return false;
+	mBatchVertexOffset = BATCH_RING_VERTICES;
+
 	// create index buffer
 	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	bd.ByteWidth = D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT * sizeof(int);
@@ -576,12 +782,12 @@ bool AppImplMswRendererDx::initializeInternal( DX_WINDOW_TYPE wnd )
 	rd.ScissorEnable = FALSE;
 	rd.MultisampleEnable = FALSE;
 	rd.AntialiasedLineEnable = FALSE;
-	hr = md3dDevice->CreateRasterizerState( &rd, &mDefaultRenderState );
-	if(hr != S_OK)
+	setRasterizerState( rd );
+	if( ! mDefaultRenderState )
 		__debugbreak();
-	mDeviceContext->RSSetState( mDefaultRenderState );
 
 	//copying the default OpenGL depth behavior
+	ZeroMemory( &mDepthStencilDesc, sizeof(mDepthStencilDesc) );
 	mDepthStencilDesc.DepthEnable = FALSE;
 	mDepthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
 	mDepthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
@@ -593,11 +799,12 @@ bool AppImplMswRendererDx::initializeInternal( DX_WINDOW_TYPE wnd )
 	mDepthStencilDesc.FrontFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
 	mDepthStencilDesc.FrontFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
 	mDepthStencilDesc.BackFace = mDepthStencilDesc.FrontFace;
-	hr = md3dDevice->CreateDepthStencilState( &mDepthStencilDesc, &mDepthStencilState );
-	if(hr != S_OK)
+	setDepthStencilState( mDepthStencilDesc );
+	if( ! mDepthStencilState )
 		__debugbreak();
-	mDeviceContext->OMSetDepthStencilState( mDepthStencilState, 0 );
 
+	// zeroed so that the unused render targets and padding hash consistently
+	ZeroMemory( &mBlendDesc, sizeof(mBlendDesc) );
 	mBlendDesc.AlphaToCoverageEnable = FALSE;
 	mBlendDesc.IndependentBlendEnable = FALSE;
 	mBlendDesc.RenderTarget[0].BlendEnable = FALSE;
@@ -608,10 +815,9 @@ bool AppImplMswRendererDx::initializeInternal( DX_WINDOW_TYPE wnd )
 	mBlendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
 	mBlendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 	mBlendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-	hr = md3dDevice->CreateBlendState(&mBlendDesc, &mBlendState);
-	if(hr != S_OK)
+	setBlendState( mBlendDesc );
+	if( ! mBlendState )
 		__debugbreak();
-	mDeviceContext->OMSetBlendState(mBlendState, 0, 0xffffffff);
 
 	return true;									// Success
 }
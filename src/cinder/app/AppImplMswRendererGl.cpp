@@ -23,25 +23,42 @@
 
 #include "cinder/app/AppImplMswRendererGl.h"
 #include "cinder/gl/gl.h"
+#include "cinder/gl/StateCache.h"
 #include "cinder/app/App.h"
 #include "cinder/Camera.h"
 #include <windowsx.h>
+#include <algorithm>
+#include <vector>
 
 namespace cinder { namespace app {
 
 bool sMultisampleSupported = false;
 int sArbMultisampleFormat;
 
+namespace {
+// the context shared by every window when App::Settings::isSingleGlContextEnabled()
+HGLRC					sSingleRC = NULL;
+int						sSinglePixelFormat = 0;
+size_t					sSingleRCUsers = 0;
+AppImplMswRendererGl	*sSingleRCDrawable = NULL; // the renderer whose window the single context currently draws to
+bool					sSwapPassActive = false;
+std::vector<HDC>		sPendingSwaps;
+} // anonymous namespace
+
 AppImplMswRendererGl::AppImplMswRendererGl( App *aApp, RendererGl *aRenderer )
 	: AppImplMswRenderer( aApp ), mRenderer( aRenderer )
 {
 	mPrevRC = 0;
 	mRC = 0;
+	mUsesSingleContext = false;
+	mHasDrawableState = false;
 }
 
 void AppImplMswRendererGl::prepareToggleFullScreen()
 {
-	mPrevRC = mRC;
+	// the single context outlives the window, so it is simply pointed at the new one
+	if( ! mUsesSingleContext )
+		mPrevRC = mRC;
 	mWasVerticalSynced = gl::isVerticalSyncEnabled();
 }
 
@@ -75,12 +92,79 @@ void AppImplMswRendererGl::defaultResize() const
 
 void AppImplMswRendererGl::swapBuffers() const
 {
-	::SwapBuffers( mDC );
+	if( mUsesSingleContext && sSwapPassActive )
+		sPendingSwaps.push_back( mDC );
+	else
+		::SwapBuffers( mDC );
 }
 
 void AppImplMswRendererGl::makeCurrentContext()
 {
-	::wglMakeCurrent( mDC, mRC );
+	if( mUsesSingleContext && ( sSingleRCDrawable != this ) ) {
+		if( sSingleRCDrawable && ( ::wglGetCurrentContext() == mRC ) )
+			sSingleRCDrawable->saveDrawableState();
+		else
+			gl::StateCache::invalidate();
+		::wglMakeCurrent( mDC, mRC );
+		sSingleRCDrawable = this;
+		if( mHasDrawableState )
+			restoreDrawableState();
+	}
+	// wglMakeCurrent() is expensive even when nothing changes, so it is skipped when this context and window are already current
+	else if( ( ::wglGetCurrentContext() != mRC ) || ( ::wglGetCurrentDC() != mDC ) ) {
+		// bindings belong to the context, so they only need to be forgotten when that changes
+		if( ::wglGetCurrentContext() != mRC )
+			gl::StateCache::invalidate();
+		::wglMakeCurrent( mDC, mRC );
+	}
+}
+
+void AppImplMswRendererGl::saveDrawableState()
+{
+	glGetIntegerv( GL_VIEWPORT, mViewport );
+	glGetFloatv( GL_PROJECTION_MATRIX, mProjection );
+	glGetFloatv( GL_MODELVIEW_MATRIX, mModelView );
+	mHasDrawableState = true;
+}
+
+void AppImplMswRendererGl::restoreDrawableState()
+{
+	GLint matrixMode;
+	glGetIntegerv( GL_MATRIX_MODE, &matrixMode );
+
+	glViewport( mViewport[0], mViewport[1], mViewport[2], mViewport[3] );
+	glMatrixMode( GL_PROJECTION );
+	glLoadMatrixf( mProjection );
+	glMatrixMode( GL_MODELVIEW );
+	glLoadMatrixf( mModelView );
+
+	glMatrixMode( matrixMode );
+}
+
+void AppImplMswRendererGl::beginSwapPass()
+{
+	sSwapPassActive = true;
+}
+
+bool AppImplMswRendererGl::endSwapPass()
+{
+	sSwapPassActive = false;
+	if( sPendingSwaps.empty() )
+		return false;
+
+	// The swap interval belongs to the context, so every window but the last swaps immediately and only the last waits for vertical sync,
+	// rather than each window waiting in turn. With desktop composition enabled the windows are presented together at the compositor's next refresh.
+	bool verticalSync = ( sPendingSwaps.size() > 1 ) && ( ::wglGetCurrentContext() == sSingleRC ) && gl::isVerticalSyncEnabled();
+	if( verticalSync )
+		gl::enableVerticalSync( false );
+	for( size_t s = 0; s + 1 < sPendingSwaps.size(); ++s )
+		::SwapBuffers( sPendingSwaps[s] );
+	if( verticalSync )
+		gl::enableVerticalSync( true );
+	::SwapBuffers( sPendingSwaps.back() );
+
+	sPendingSwaps.clear();
+	return true;
 }
 
 HWND createDummyWindow( int *width, int *height, bool fullscreen )
@@ -156,6 +240,12 @@ HWND createDummyWindow( int *width, int *height, bool fullscreen )
 
 bool AppImplMswRendererGl::initialize( HWND wnd, HDC dc, RendererRef sharedRenderer )
 {
+	bool singleContext = mApp->getSettings().isSingleGlContextEnabled();
+	if( singleContext && sSingleRC ) {
+		mWnd = wnd;
+		return initializeWithSingleContext( dc );
+	}
+
 	if( ( ! sMultisampleSupported ) && mRenderer->getAntiAliasing() ) {
 		// first create a dummy window and use it to determine if we can do antialiasing
 		int width = 640;
@@ -177,7 +267,43 @@ bool AppImplMswRendererGl::initialize( HWND wnd, HDC dc, RendererRef sharedRende
 	RendererGl *sharedRendererGl = dynamic_cast<RendererGl*>( sharedRenderer.get() );
 	HGLRC sharedRC = ( sharedRenderer ) ? sharedRendererGl->mImpl->mRC : NULL;
 
-	return initializeInternal( wnd, dc, sharedRC );
+	bool result = initializeInternal( wnd, dc, sharedRC );
+	// the first window's context becomes the one all later windows render with
+	if( result && singleContext && mRC ) {
+		sSingleRC = mRC;
+		sSinglePixelFormat = ::GetPixelFormat( dc );
+		sSingleRCUsers = 1;
+		sSingleRCDrawable = this;
+		mUsesSingleContext = true;
+	}
+
+	return result;
+}
+
+bool AppImplMswRendererGl::initializeWithSingleContext( HDC dc )
+{
+	mDC = dc;
+
+	// a context can only be made current with windows sharing its pixel format
+	PIXELFORMATDESCRIPTOR pfd;
+	if( ! ::DescribePixelFormat( dc, sSinglePixelFormat, sizeof( pfd ), &pfd ) )
+		return false;
+	if( ! ::SetPixelFormat( dc, sSinglePixelFormat, &pfd ) )
+		return false;
+
+	mRC = sSingleRC;
+	if( ! mUsesSingleContext ) {
+		mUsesSingleContext = true;
+		++sSingleRCUsers;
+	}
+
+	// a new window starts out with the previous drawable's state, until it is resized
+	mHasDrawableState = false;
+	if( sSingleRCDrawable == this )
+		sSingleRCDrawable = NULL;
+	makeCurrentContext();
+
+	return true;
 }
 
 bool AppImplMswRendererGl::initializeInternal( HWND wnd, HDC dc, HGLRC sharedRC )
@@ -314,6 +440,22 @@ int AppImplMswRendererGl::initMultisample( PIXELFORMATDESCRIPTOR pfd, int reques
 
 void AppImplMswRendererGl::kill()
 {
+	if( mUsesSingleContext ) {
+		sPendingSwaps.erase( std::remove( sPendingSwaps.begin(), sPendingSwaps.end(), mDC ), sPendingSwaps.end() );
+		if( sSingleRCDrawable == this ) {
+			::wglMakeCurrent( NULL, NULL );
+			sSingleRCDrawable = NULL;
+		}
+		// the single context is deleted along with the last window using it
+		if( --sSingleRCUsers == 0 ) {
+			::wglDeleteContext( sSingleRC );
+			sSingleRC = NULL;
+		}
+		mUsesSingleContext = false;
+		mRC = 0;
+		return;
+	}
+
 	if( mRC ) {											// Do We Have A Rendering Context?
 		::wglMakeCurrent( NULL, NULL );					// release The DC And RC Contexts
 		::wglDeleteContext( mRC );						// delete The RC
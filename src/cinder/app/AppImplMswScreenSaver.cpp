@@ -126,7 +126,12 @@ LRESULT AppImplMswScreenSaver::eventHandler( HWND hWnd, UINT message, WPARAM wPa
 {
 	switch( message ) {
 		case WM_TIMER:
+			// with on-demand rendering, skip frames until something invalidates the App
+			if( ! mApp->privateShouldRenderFrame__() )
+				return 0;
 			setWindow( mWindows.front()->getWindow() );
+			for( auto winIt = mWindows.begin(); winIt != mWindows.end(); ++winIt )
+				(*winIt)->flushTouches();
 			mApp->privateUpdate__();
 			for( auto winIt = mWindows.begin(); winIt != mWindows.end(); ++winIt ) {
 				(*winIt)->draw();
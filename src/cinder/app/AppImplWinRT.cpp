@@ -730,7 +730,10 @@ void WindowImplWinRT::draw()
 	mAppImpl->setWindow( mWindowRef );
 	mRenderer->startDraw();
 	mWindowRef->emitDraw();
+	App *app = mAppImpl->getApp();
+	double swapStart = app->getElapsedSeconds();
 	mRenderer->finishDraw();
+	app->getFrameTiming().addSwapDuration( app->getElapsedSeconds() - swapStart );
 }
 
 void WindowImplWinRT::resize()
@@ -182,7 +182,9 @@
 
 	mRenderer->startDraw();
 	[mDelegate draw];
+	double swapStart = mApp->getElapsedSeconds();
 	mRenderer->finishDraw();
+	mApp->getFrameTiming().addSwapDuration( mApp->getElapsedSeconds() - swapStart );
 }
 
 - (void)setFrameSize:(NSSize)newSize
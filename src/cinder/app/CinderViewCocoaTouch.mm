@@ -80,11 +80,18 @@ static Boolean sIsEaglLayer;
 	[mDelegate resize];
 }
 
+- (void)finishDraw
+{
+	double swapStart = mApp->getElapsedSeconds();
+	mRenderer->finishDraw();
+	mApp->getFrameTiming().addSwapDuration( mApp->getElapsedSeconds() - swapStart );
+}
+
 - (void)drawRect:(CGRect)rect
 {
 	mRenderer->startDraw();
 	[mDelegate draw];
-	mRenderer->finishDraw();
+	[self finishDraw];
 }
 
 - (void)drawView
@@ -92,7 +99,7 @@ static Boolean sIsEaglLayer;
 	if( sIsEaglLayer ) {
 		mRenderer->startDraw();
 		[mDelegate draw];
-		mRenderer->finishDraw();
+		[self finishDraw];
 	}
 	else
 		[self performSelectorOnMainThread:@selector(setNeedsDisplay) withObject:self waitUntilDone:NO];
@@ -0,0 +1,278 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/app/FrameTiming.h"
+#include "cinder/CinderMath.h"
+
+#if ! defined( CINDER_WINRT )
+	#include "cinder/app/App.h"
+	#include "cinder/gl/gl.h"
+	#include "cinder/gl/Texture.h"
+	#include "cinder/Text.h"
+	#include <sstream>
+	#include <iomanip>
+#endif
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace app {
+
+namespace {
+
+const float		HISTOGRAM_BIN_SECONDS = 0.0001f;
+const size_t	HISTOGRAM_NUM_BINS = 2001; // 200 ms in 0.1 ms bins, plus one for anything longer
+
+float getMeasure( const FrameTiming::Frame &frame, FrameTiming::Measure measure )
+{
+	switch( measure ) {
+		case FrameTiming::INTERVAL: return frame.mInterval;
+		case FrameTiming::UPDATE: return frame.mUpdateDuration;
+		case FrameTiming::DRAW: return frame.mDrawDuration;
+		case FrameTiming::SWAP: return frame.mSwapDuration;
+		default: return 0;
+	}
+}
+
+} // anonymous namespace
+
+FrameTiming::FrameTiming()
+	: mTargetFrameRate( 0 ), mLateTolerance( 0.5f ), mRecentSize( 600 ), mLateFramesSize( 1000 ), mOverlayEnabled( false )
+{
+	for( int m = 0; m < NUM_MEASURES; ++m )
+		mHistograms[m].resize( HISTOGRAM_NUM_BINS );
+	reset();
+}
+
+void FrameTiming::reset()
+{
+	mInFrame = false;
+	mCurrentFrame = mLastFrame = Frame();
+	mNumFrames = mNumLateFrames = mNumMissedFrames = 0;
+	for( int m = 0; m < NUM_MEASURES; ++m ) {
+		mSum[m] = 0;
+		mMax[m] = 0;
+		std::fill( mHistograms[m].begin(), mHistograms[m].end(), 0 );
+	}
+
+	mRecentFrames.clear();
+	mRecentNext = 0;
+	mLateFrames.clear();
+}
+
+void FrameTiming::beginFrame( uint32_t frameNumber, double time, float appFrameRate )
+{
+	if( mInFrame ) {
+		mCurrentFrame.mInterval = (float)( time - mCurrentFrame.mStartTime );
+
+		float frameRate = ( mTargetFrameRate > 0 ) ? mTargetFrameRate : appFrameRate;
+		if( frameRate > 0 ) {
+			float periods = mCurrentFrame.mInterval * frameRate;
+			if( periods > 1 + mLateTolerance )
+				mCurrentFrame.mMissedFrames = std::max<uint32_t>( 1, (uint32_t)( periods + 0.5f ) - 1 );
+		}
+
+		completeFrame( mCurrentFrame );
+	}
+
+	mInFrame = true;
+	mCurrentFrame = Frame();
+	mCurrentFrame.mFrameNumber = frameNumber;
+	mCurrentFrame.mStartTime = time;
+}
+
+void FrameTiming::completeFrame( const Frame &frame )
+{
+	++mNumFrames;
+	for( int m = 0; m < NUM_MEASURES; ++m ) {
+		float value = getMeasure( frame, (Measure)m );
+		mSum[m] += value;
+		mMax[m] = std::max( mMax[m], value );
+		size_t bin = std::min<size_t>( (size_t)( std::max( value, 0.0f ) / HISTOGRAM_BIN_SECONDS ), HISTOGRAM_NUM_BINS - 1 );
+		++mHistograms[m][bin];
+	}
+
+	if( mRecentSize > 0 ) {
+		if( mRecentFrames.size() < mRecentSize )
+			mRecentFrames.push_back( frame );
+		else
+			mRecentFrames[mRecentNext] = frame;
+		mRecentNext = ( mRecentNext + 1 ) % mRecentSize;
+	}
+
+	mLastFrame = frame;
+	if( frame.isLate() ) {
+		++mNumLateFrames;
+		mNumMissedFrames += frame.mMissedFrames;
+		if( mLateFramesSize > 0 ) {
+			if( mLateFrames.size() == mLateFramesSize )
+				mLateFrames.pop_front();
+			mLateFrames.push_back( frame );
+		}
+		mSignalLateFrame( frame );
+	}
+}
+
+float FrameTiming::getMean( Measure measure ) const
+{
+	return mNumFrames ? (float)( mSum[measure] / mNumFrames ) : 0;
+}
+
+float FrameTiming::getPercentile( Measure measure, float percentile ) const
+{
+	if( mNumFrames == 0 )
+		return 0;
+
+	uint64_t rank = std::max<uint64_t>( 1, (uint64_t)math<double>::ceil( constrain<double>( percentile, 0, 100 ) / 100.0 * mNumFrames ) );
+	const vector<uint32_t> &histogram = mHistograms[measure];
+	uint64_t count = 0;
+	for( size_t bin = 0; bin < HISTOGRAM_NUM_BINS - 1; ++bin ) {
+		count += histogram[bin];
+		if( count >= rank )
+			return std::min( ( bin + 1 ) * HISTOGRAM_BIN_SECONDS, mMax[measure] );
+	}
+
+	return mMax[measure];
+}
+
+vector<FrameTiming::Frame> FrameTiming::getRecentFrames() const
+{
+	vector<Frame> result;
+	result.reserve( mRecentFrames.size() );
+	if( mRecentFrames.size() < mRecentSize )
+		result = mRecentFrames;
+	else {
+		result.insert( result.end(), mRecentFrames.begin() + mRecentNext, mRecentFrames.end() );
+		result.insert( result.end(), mRecentFrames.begin(), mRecentFrames.begin() + mRecentNext );
+	}
+
+	return result;
+}
+
+void FrameTiming::setRecentFramesSize( size_t size )
+{
+	vector<Frame> recent = getRecentFrames();
+	if( recent.size() > size )
+		recent.erase( recent.begin(), recent.end() - size );
+
+	mRecentFrames.swap( recent );
+	mRecentSize = size;
+	mRecentNext = ( size > 0 ) ? ( mRecentFrames.size() % size ) : 0;
+}
+
+void FrameTiming::setLateFramesSize( size_t size )
+{
+	while( mLateFrames.size() > size )
+		mLateFrames.pop_front();
+	mLateFramesSize = size;
+}
+
+#if ! defined( CINDER_WINRT )
+
+// The overlay's text is rendered to a texture a few times a second, as rendering it every frame would slow the frames being measured
+struct FrameTiming::Overlay {
+	Overlay() : mTextTime( -1 ) {}
+
+	gl::Texture		mText;
+	double			mTextTime;
+};
+
+void FrameTiming::drawOverlay( const Vec2f &pos )
+{
+	const float TEXT_REFRESH_SECONDS = 0.25f;
+	const float GRAPH_HEIGHT = 60;
+	const size_t GRAPH_FRAMES = 240;
+
+	if( ! mOverlay )
+		mOverlay = shared_ptr<Overlay>( new Overlay );
+
+	App *app = App::get();
+	double now = app->getElapsedSeconds();
+	if( ( ! mOverlay->mText ) || ( now - mOverlay->mTextTime >= TEXT_REFRESH_SECONDS ) || ( now < mOverlay->mTextTime ) ) {
+		ostringstream ss[4];
+		for( int i = 0; i < 4; ++i )
+			ss[i] << fixed << setprecision( 2 );
+		ss[0] << app->getAverageFps() << " fps  frame " << mLastFrame.mFrameNumber << "  " << mLastFrame.mInterval * 1000 << " ms";
+		ss[1] << "update " << mLastFrame.mUpdateDuration * 1000 << "  draw " << mLastFrame.mDrawDuration * 1000 << "  swap " << mLastFrame.mSwapDuration * 1000 << " ms";
+		ss[2] << "interval p50 " << getPercentile( INTERVAL, 50 ) * 1000 << "  p99 " << getPercentile( INTERVAL, 99 ) * 1000 << "  max " << getMax( INTERVAL ) * 1000 << " ms";
+		ss[3] << "late " << mNumLateFrames << "  missed " << mNumMissedFrames << " of " << mNumFrames;
+
+		TextLayout layout;
+		layout.clear( ColorA( 0, 0, 0, 0.6f ) );
+		layout.setColor( Color::white() );
+		layout.setBorder( 4, 2 );
+		for( int i = 0; i < 4; ++i )
+			layout.addLine( ss[i].str() );
+		mOverlay->mText = gl::Texture( layout.render( true ) );
+		mOverlay->mTextTime = now;
+	}
+
+	float frameRate = ( mTargetFrameRate > 0 ) ? mTargetFrameRate : app->getFrameRate();
+	float period = ( frameRate > 0 ) ? ( 1 / frameRate ) : 0;
+	float scale = ( period > 0 ) ? ( GRAPH_HEIGHT / ( 2 * period ) ) : ( GRAPH_HEIGHT / 0.033f ); // the graph's height is two frame periods
+
+#if ! defined( CINDER_GLES )
+	glPushAttrib( GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT );
+#endif
+	gl::pushMatrices();
+	gl::setMatricesWindow( app->getWindowSize() );
+	gl::disableDepthRead();
+	gl::enableAlphaBlending();
+
+	{
+		gl::Batch2d batch;
+		gl::color( Color::white() );
+		gl::draw( mOverlay->mText, pos );
+
+		Vec2f graphPos = pos + Vec2f( 0, (float)mOverlay->mText.getHeight() + GRAPH_HEIGHT );
+		gl::color( ColorA( 0, 0, 0, 0.6f ) );
+		gl::drawSolidRect( Rectf( graphPos.x, graphPos.y - GRAPH_HEIGHT, graphPos.x + GRAPH_FRAMES, graphPos.y ) );
+
+		vector<Frame> recent = getRecentFrames();
+		size_t first = ( recent.size() > GRAPH_FRAMES ) ? ( recent.size() - GRAPH_FRAMES ) : 0;
+		for( size_t i = first; i < recent.size(); ++i ) {
+			float x = graphPos.x + ( i - first ) + 0.5f;
+			float height = std::min( recent[i].mInterval * scale, GRAPH_HEIGHT );
+			gl::color( recent[i].isLate() ? Color( 1, 0.2f, 0.2f ) : Color( 0.2f, 1, 0.2f ) );
+			gl::drawLine( Vec2f( x, graphPos.y ), Vec2f( x, graphPos.y - height ) );
+		}
+
+		if( period > 0 ) {
+			gl::color( ColorA( 1, 1, 0, 0.8f ) );
+			gl::drawLine( Vec2f( graphPos.x, graphPos.y - period * scale ), Vec2f( graphPos.x + GRAPH_FRAMES, graphPos.y - period * scale ) );
+		}
+	}
+
+	gl::popMatrices();
+#if ! defined( CINDER_GLES )
+	glPopAttrib();
+#else
+	gl::disableAlphaBlending();
+	gl::color( Color::white() );
+#endif
+}
+
+#endif // ! defined( CINDER_WINRT )
+
+} } // namespace cinder::app
@@ -0,0 +1,138 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/app/MainThreadQueue.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace app {
+
+MainThreadQueue::MainThreadQueue()
+	: mDepth( 0 ), mMaxDepth( 0 ), mNextSequence( 0 ), mBudget( 0 )
+{
+	resetStats();
+}
+
+void MainThreadQueue::push( const std::function<void()> &fn, Priority priority )
+{
+	lock_guard<mutex> lock( mMutex );
+	mJobs[priority].push_back( Job( fn, mNextSequence++ ) );
+	mMaxDepth = std::max( mMaxDepth, ++mDepth );
+}
+
+bool MainThreadQueue::pop( uint64_t endSequence, Job *result )
+{
+	lock_guard<mutex> lock( mMutex );
+	for( size_t p = 0; p < NUM_PRIORITIES; ++p ) {
+		// each priority is in push order, so only its front needs checking
+		if( ! mJobs[p].empty() && mJobs[p].front().mSequence < endSequence ) {
+			*result = std::move( mJobs[p].front() );
+			mJobs[p].pop_front();
+			--mDepth;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t MainThreadQueue::drain()
+{
+	const Clock::time_point start = Clock::now();
+	const Clock::time_point deadline = start + chrono::duration_cast<Clock::duration>( chrono::duration<double>( mBudget ) );
+
+	// jobs pushed while draining, whether by the jobs themselves or by other threads, wait for the next drain
+	uint64_t endSequence;
+	{
+		lock_guard<mutex> lock( mMutex );
+		endSequence = mNextSequence;
+	}
+
+	size_t executed = 0;
+	bool outOfBudget = false;
+	Job job( nullptr, 0 );
+	while( pop( endSequence, &job ) ) {
+		Clock::time_point now = Clock::now();
+		double latency = chrono::duration<double>( now - job.mPushTime ).count();
+		mLatencySum += latency;
+		mMaxLatency = std::max( mMaxLatency, latency );
+
+		job.mFn();
+		job.mFn = nullptr;
+		++executed;
+
+		if( mBudget > 0 && Clock::now() >= deadline ) {
+			outOfBudget = true;
+			break;
+		}
+	}
+
+	if( outOfBudget && getDepth() > 0 )
+		++mNumDeferrals;
+	mNumExecuted += executed;
+	mLastNumExecuted = executed;
+	mLastDuration = chrono::duration<double>( Clock::now() - start ).count();
+	return executed;
+}
+
+void MainThreadQueue::clear()
+{
+	lock_guard<mutex> lock( mMutex );
+	for( size_t p = 0; p < NUM_PRIORITIES; ++p )
+		mJobs[p].clear();
+	mDepth = 0;
+}
+
+size_t MainThreadQueue::getDepth() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mDepth;
+}
+
+size_t MainThreadQueue::getDepth( Priority priority ) const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mJobs[priority].size();
+}
+
+size_t MainThreadQueue::getMaxDepth() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMaxDepth;
+}
+
+void MainThreadQueue::resetStats()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mMaxDepth = mDepth;
+	}
+	mNumExecuted = mNumDeferrals = 0;
+	mLatencySum = mMaxLatency = 0;
+	mLastNumExecuted = 0;
+	mLastDuration = 0;
+}
+
+} } // namespace cinder::app
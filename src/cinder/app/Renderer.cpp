@@ -25,6 +25,8 @@
 
 #if !defined( CINDER_WINRT)
 	#include "cinder/gl/gl.h"
+	#include "cinder/gl/ContextWorker.h"
+	#include "cinder/gl/StateCache.h"
 #endif
 
 #include "cinder/app/App.h"
@@ -82,6 +84,16 @@ void RendererGl::setAntiAliasing( int aAntiAliasing )
 	mAntiAliasing = aAntiAliasing;
 }
 
+gl::SharedContextRef RendererGl::createSharedContext()
+{
+	return gl::SharedContext::create( this );
+}
+
+gl::ContextWorkerRef RendererGl::createContextWorker( size_t numThreads )
+{
+	return gl::ContextWorker::create( this, numThreads );
+}
+
 #if defined( CINDER_MAC )
 RendererGl::~RendererGl()
 {
@@ -100,7 +112,7 @@ void RendererGl::setup( App *aApp, CGRect frame, NSView *cinderView, RendererRef
 
 void RendererGl::startDraw()
 {
-	[mImpl makeCurrentContext];
+	makeCurrentContext();
 }
 
 void RendererGl::finishDraw()
@@ -148,7 +160,11 @@ NSOpenGLContext* RendererGl::getNsOpenGlContext()
 
 void RendererGl::makeCurrentContext()
 {
+	// only a switch to another context invalidates the gl::StateCache
+	CGLContextObj previousContext = ::CGLGetCurrentContext();
 	[mImpl makeCurrentContext];
+	if( ::CGLGetCurrentContext() != previousContext )
+		gl::StateCache::invalidate();
 }
 
 #elif defined( CINDER_COCOA_TOUCH ) 
@@ -171,12 +187,13 @@ EAGLContext* RendererGl::getEaglContext() const
 
 void RendererGl::startDraw()
 {
-	[mImpl makeCurrentContext];
+	makeCurrentContext();
 }
 
 void RendererGl::finishDraw()
 {
 	[mImpl flushBuffer];
+	gl::StateCache::invalidate();
 }
 
 void RendererGl::setFrameSize( int width, int height )
@@ -191,7 +208,9 @@ void RendererGl::defaultResize()
 
 void RendererGl::makeCurrentContext()
 {
+	// the view's framebuffers are bound directly, which the gl::StateCache cannot see
 	[mImpl makeCurrentContext];
+	gl::StateCache::invalidate();
 }
 
 Surface	RendererGl::copyWindowSurface( const Area &area )
@@ -259,6 +278,16 @@ void RendererGl::defaultResize()
 	mImpl->defaultResize();
 }
 
+HGLRC RendererGl::getHglrc()
+{
+	return mImpl->getRc();
+}
+
+HDC RendererGl::getDc()
+{
+	return mImpl->getDc();
+}
+
 Surface	RendererGl::copyWindowSurface( const Area &area )
 {
 	Surface s( area.getWidth(), area.getHeight(), false );
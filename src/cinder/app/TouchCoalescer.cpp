@@ -0,0 +1,163 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/app/TouchCoalescer.h"
+#include "cinder/app/Window.h"
+
+#include <algorithm>
+
+namespace cinder { namespace app {
+
+TouchCoalescer::TouchCoalescer()
+	: mHistoryEnabled( false )
+{
+}
+
+int TouchCoalescer::findEntry( uint32_t id ) const
+{
+	// the latest lifetime of an ID is always its last entry
+	for( int i = (int)mEntries.size() - 1; i >= 0; --i ) {
+		if( mEntries[i].mId == id )
+			return i;
+	}
+
+	return -1;
+}
+
+size_t TouchCoalescer::addEntry( uint32_t id, uint32_t generation )
+{
+	Entry entry;
+	entry.mId = id;
+	entry.mGeneration = generation;
+	entry.mBegan = entry.mMoved = entry.mEnded = false;
+	mEntries.push_back( entry );
+
+	if( mHistories.size() < mEntries.size() )
+		mHistories.resize( mEntries.size() );
+	mHistories[mEntries.size() - 1].clear();
+
+	return mEntries.size() - 1;
+}
+
+void TouchCoalescer::addHistory( size_t entryIndex, const TouchEvent::Touch &touch )
+{
+	if( mHistoryEnabled )
+		mHistories[entryIndex].push_back( touch );
+}
+
+void TouchCoalescer::touchBegan( const TouchEvent::Touch &touch )
+{
+	int existing = findEntry( touch.getId() );
+	size_t index = addEntry( touch.getId(), ( existing >= 0 ) ? mEntries[existing].mGeneration + 1 : 0 );
+
+	Entry &entry = mEntries[index];
+	entry.mBegan = true;
+	entry.mBeganTouch = TouchEvent::Touch( touch.getPos(), touch.getPos(), touch.getId(), touch.getTime(), NULL );
+	addHistory( index, entry.mBeganTouch );
+}
+
+void TouchCoalescer::touchMoved( const TouchEvent::Touch &touch )
+{
+	int existing = findEntry( touch.getId() );
+	if( existing >= 0 && mEntries[existing].mEnded ) // a stray move after the touch ended
+		return;
+	size_t index = ( existing >= 0 ) ? (size_t)existing : addEntry( touch.getId(), 0 );
+
+	Entry &entry = mEntries[index];
+	// keep the previous position from the first move so that the merged Touch spans every move since the last flush
+	Vec2f prevPos = entry.mMoved ? entry.mMovedTouch.getPrevPos() : touch.getPrevPos();
+	entry.mMoved = true;
+	entry.mMovedTouch = TouchEvent::Touch( touch.getPos(), prevPos, touch.getId(), touch.getTime(), NULL );
+	addHistory( index, TouchEvent::Touch( touch.getPos(), touch.getPrevPos(), touch.getId(), touch.getTime(), NULL ) );
+}
+
+void TouchCoalescer::touchEnded( const TouchEvent::Touch &touch )
+{
+	int existing = findEntry( touch.getId() );
+	if( existing >= 0 && mEntries[existing].mEnded )
+		return;
+	size_t index = ( existing >= 0 ) ? (size_t)existing : addEntry( touch.getId(), 0 );
+
+	Entry &entry = mEntries[index];
+	entry.mEnded = true;
+	entry.mEndedTouch = TouchEvent::Touch( touch.getPos(), touch.getPrevPos(), touch.getId(), touch.getTime(), NULL );
+	addHistory( index, entry.mEndedTouch );
+}
+
+void TouchCoalescer::fillEvent( TouchEvent *event, const WindowRef &window, uint32_t generation, bool Entry::*phase, TouchEvent::Touch Entry::*touch )
+{
+	event->setWindow( window );
+	event->setHandled( false );
+	event->mTouches.clear();
+	event->mHasHistory = mHistoryEnabled;
+	for( size_t i = 0; i < mEntries.size(); ++i ) {
+		const Entry &entry = mEntries[i];
+		if( entry.mGeneration != generation || ! ( entry.*phase ) )
+			continue;
+
+		event->mTouches.push_back( entry.*touch );
+		if( mHistoryEnabled ) {
+			if( event->mHistory.size() < event->mTouches.size() )
+				event->mHistory.resize( event->mTouches.size() );
+			event->mHistory[event->mTouches.size() - 1] = mHistories[i];
+		}
+	}
+}
+
+void TouchCoalescer::flush( const WindowRef &window, const EventFn &began, const EventFn &moved, const EventFn &ended )
+{
+	uint32_t maxGeneration = 0;
+	for( std::vector<Entry>::const_iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt )
+		maxGeneration = std::max( maxGeneration, entryIt->mGeneration );
+
+	for( uint32_t generation = 0; generation <= maxGeneration && ! mEntries.empty(); ++generation ) {
+		fillEvent( &mBeganEvent, window, generation, &Entry::mBegan, &Entry::mBeganTouch );
+		if( ! mBeganEvent.mTouches.empty() && began )
+			began( &mBeganEvent );
+
+		fillEvent( &mMovedEvent, window, generation, &Entry::mMoved, &Entry::mMovedTouch );
+		if( ! mMovedEvent.mTouches.empty() && moved )
+			moved( &mMovedEvent );
+
+		fillEvent( &mEndedEvent, window, generation, &Entry::mEnded, &Entry::mEndedTouch );
+		if( ! mEndedEvent.mTouches.empty() && ended )
+			ended( &mEndedEvent );
+	}
+
+	mEntries.clear();
+}
+
+void TouchCoalescer::flush( const WindowRef &window )
+{
+	Window *win = window.get();
+	flush( window, std::bind( &Window::emitTouchesBegan, win, std::placeholders::_1 ),
+		std::bind( &Window::emitTouchesMoved, win, std::placeholders::_1 ),
+		std::bind( &Window::emitTouchesEnded, win, std::placeholders::_1 ) );
+}
+
+void TouchCoalescer::clear()
+{
+	mEntries.clear();
+}
+
+} } // namespace cinder::app
@@ -25,6 +25,13 @@
 #include "cinder/Cinder.h"
 #include "cinder/app/Window.h"
 #include "cinder/app/App.h"
+#include "cinder/Profiler.h"
+#if ! defined( CINDER_GLES ) && ! defined( CINDER_WINRT )
+	#include "cinder/gl/Fbo.h"
+	#include "cinder/gl/StateCache.h"
+#endif
+
+#include <algorithm>
 
 #if defined( CINDER_MSW )
 	#include "cinder/app/AppImplMsw.h"
@@ -273,6 +280,90 @@ UIViewController* Window::getNativeViewController()
 #endif
 
 
+// Dirty Areas
+void Window::invalidate( const Area &area )
+{
+	Area clipped( std::min( area.x1, area.x2 ), std::min( area.y1, area.y2 ), std::max( area.x1, area.x2 ), std::max( area.y1, area.y2 ) );
+	clipped.clipBy( getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return;
+
+	getApp()->invalidate();
+	for( std::vector<Area>::const_iterator areaIt = mPendingDirtyAreas.begin(); areaIt != mPendingDirtyAreas.end(); ++areaIt ) {
+		if( areaIt->x1 <= clipped.x1 && areaIt->y1 <= clipped.y1 && areaIt->x2 >= clipped.x2 && areaIt->y2 >= clipped.y2 )
+			return;
+	}
+
+	// past a handful of areas their bounds are as cheap to redraw as the areas themselves
+	static const size_t MAX_DIRTY_AREAS = 16;
+	mPendingDirtyAreas.push_back( clipped );
+	if( mPendingDirtyAreas.size() > MAX_DIRTY_AREAS ) {
+		Area bounds = mPendingDirtyAreas.front();
+		for( std::vector<Area>::const_iterator areaIt = mPendingDirtyAreas.begin() + 1; areaIt != mPendingDirtyAreas.end(); ++areaIt )
+			bounds.include( *areaIt );
+		mPendingDirtyAreas.assign( 1, bounds );
+	}
+}
+
+Area Window::getDirtyArea() const
+{
+	if( mDirtyAreas.empty() )
+		return Area::zero();
+
+	Area result = mDirtyAreas.front();
+	for( std::vector<Area>::const_iterator areaIt = mDirtyAreas.begin() + 1; areaIt != mDirtyAreas.end(); ++areaIt )
+		result.include( *areaIt );
+	return result;
+}
+
+void Window::enablePartialRedraw( bool enable )
+{
+	mPartialRedraw = enable;
+	mPartialRedrawFbo.reset();
+	invalidate();
+}
+
+#if ! defined( CINDER_GLES ) && ! defined( CINDER_WINRT )
+void Window::drawPartialGl()
+{
+	const Vec2i size = toPixels( getSize() );
+	if( ! mPartialRedrawFbo || mPartialRedrawFbo->getSize() != size ) {
+		static const int samplesForAntiAliasing[] = { 0, 2, 4, 6, 8, 16, 32 };
+		int antiAliasing = static_cast<RendererGl*>( getRenderer().get() )->getAntiAliasing();
+		gl::Fbo::Format format;
+		format.setSamples( std::min<int>( samplesForAntiAliasing[antiAliasing], gl::Fbo::getMaxSamples() ) );
+		mPartialRedrawFbo = std::make_shared<gl::Fbo>( size.x, size.y, format );
+		// a new Fbo's contents are undefined
+		mDirtyAreas.assign( 1, getBounds() );
+	}
+
+	if( ! mDirtyAreas.empty() ) {
+		mPartialRedrawFbo->bindFramebuffer();
+		gl::Fbo::setScreenFramebuffer( mPartialRedrawFbo->getId() );
+		// the scissor is in pixels from the bottom left
+		Area dirty = toPixels( getDirtyArea() );
+		glScissor( dirty.x1, size.y - dirty.y2, dirty.getWidth(), dirty.getHeight() );
+		glEnable( GL_SCISSOR_TEST );
+
+		mSignalDraw();
+		getApp()->draw();
+		mSignalPostDraw();
+
+		glDisable( GL_SCISSOR_TEST );
+		gl::Fbo::setScreenFramebuffer( 0 );
+		gl::Fbo::unbindFramebuffer();
+	}
+
+	// the back buffer isn't preserved across swaps, so all of the Fbo is copied every frame; getTexture() resolves multisampling so that
+	// the copy is from a single-sampled framebuffer whatever the window's own samples
+	mPartialRedrawFbo->getTexture();
+	gl::SaveFramebufferBinding saveFramebufferBinding;
+	gl::StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mPartialRedrawFbo->getResolveId() );
+	gl::StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, 0 );
+	glBlitFramebufferEXT( 0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST );
+}
+#endif
+
 // Signal Emitters
 void Window::emitClose()
 {
@@ -281,12 +372,14 @@ void Window::emitClose()
 
 void Window::emitMove()
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalMove();
 }
 
 void Window::emitResize()
 {
+	invalidate();
 	getRenderer()->makeCurrentContext();
 	getRenderer()->defaultResize();
 	mSignalResize();
@@ -295,12 +388,14 @@ void Window::emitResize()
 
 void Window::emitDisplayChange()
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalDisplayChange();
 }
 
 void Window::emitMouseDown( MouseEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalMouseDown.set_combiner( EventCombiner<cinder::app::MouseEvent>( event ) );
 	mSignalMouseDown( *event );
@@ -310,6 +405,7 @@ void Window::emitMouseDown( MouseEvent *event )
 
 void Window::emitMouseDrag( MouseEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalMouseDrag.set_combiner( EventCombiner<cinder::app::MouseEvent>( event ) );
 	mSignalMouseDrag( *event );
@@ -319,6 +415,7 @@ void Window::emitMouseDrag( MouseEvent *event )
 
 void Window::emitMouseUp( MouseEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalMouseUp.set_combiner( EventCombiner<cinder::app::MouseEvent>( event ) );
 	mSignalMouseUp( *event );
@@ -328,6 +425,7 @@ void Window::emitMouseUp( MouseEvent *event )
 
 void Window::emitMouseWheel( MouseEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalMouseWheel.set_combiner( EventCombiner<cinder::app::MouseEvent>( event ) );
 	mSignalMouseWheel( *event );
@@ -337,6 +435,7 @@ void Window::emitMouseWheel( MouseEvent *event )
 
 void Window::emitMouseMove( MouseEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalMouseMove.set_combiner( EventCombiner<cinder::app::MouseEvent>( event ) );
 	mSignalMouseMove( *event );
@@ -346,6 +445,7 @@ void Window::emitMouseMove( MouseEvent *event )
 
 void Window::emitTouchesBegan( TouchEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalTouchesBegan.set_combiner( EventCombiner<cinder::app::TouchEvent>( event ) );
 	mSignalTouchesBegan( *event );
@@ -355,6 +455,7 @@ void Window::emitTouchesBegan( TouchEvent *event )
 
 void Window::emitTouchesMoved( TouchEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalTouchesMoved.set_combiner( EventCombiner<cinder::app::TouchEvent>( event ) );
 	mSignalTouchesMoved( *event );
@@ -364,6 +465,7 @@ void Window::emitTouchesMoved( TouchEvent *event )
 
 void Window::emitTouchesEnded( TouchEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalTouchesEnded.set_combiner( EventCombiner<cinder::app::TouchEvent>( event ) );
 	mSignalTouchesEnded( *event );
@@ -387,6 +489,7 @@ const std::vector<TouchEvent::Touch>& Window::getActiveTouches() const
 
 void Window::emitKeyDown( KeyEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalKeyDown.set_combiner( EventCombiner<cinder::app::KeyEvent>( event ) );
 	mSignalKeyDown( *event );
@@ -396,6 +499,7 @@ void Window::emitKeyDown( KeyEvent *event )
 
 void Window::emitKeyUp( KeyEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalKeyUp.set_combiner( EventCombiner<cinder::app::KeyEvent>( event ) );
 	mSignalKeyUp( *event );
@@ -405,13 +509,36 @@ void Window::emitKeyUp( KeyEvent *event )
 
 void Window::emitDraw()
 {
-	mSignalDraw();
-	getApp()->draw();
-	mSignalPostDraw();
+	CI_PROFILE_ZONE( "App::draw" );
+
+	// areas invalidated from here on are drawn next time, and these stay available to the Renderer until then
+	mDirtyAreas.swap( mPendingDirtyAreas );
+	mPendingDirtyAreas.clear();
+
+	App *app = getApp();
+	double drawStart = app->getElapsedSeconds();
+#if ! defined( CINDER_GLES ) && ! defined( CINDER_WINRT )
+	if( mPartialRedraw && dynamic_cast<RendererGl*>( getRenderer().get() ) )
+		drawPartialGl();
+	else
+#endif
+	{
+		mSignalDraw();
+		app->draw();
+		mSignalPostDraw();
+	}
+
+	FrameTiming &frameTiming = app->getFrameTiming();
+	frameTiming.addDrawDuration( app->getElapsedSeconds() - drawStart );
+#if ! defined( CINDER_WINRT )
+	if( frameTiming.isOverlayEnabled() && dynamic_cast<RendererGl*>( getRenderer().get() ) )
+		frameTiming.drawOverlay();
+#endif
 }
 
 void Window::emitFileDrop( FileDropEvent *event )
 {
+	getApp()->invalidate();
 	getRenderer()->makeCurrentContext();
 	mSignalFileDrop.set_combiner( EventCombiner<cinder::app::FileDropEvent>( event ) );
 	mSignalFileDrop( *event );
@@ -72,6 +72,12 @@ bool ChannelRouterNode::supportsProcessInPlace() const
 	return false;
 }
 
+// an input routed more than once is pulled once per route, with other inputs pulled in between
+bool ChannelRouterNode::supportsSharedInputBuffers() const
+{
+	return false;
+}
+
 void ChannelRouterNode::addInputRoute( const NodeRef &input, size_t inputChannelIndex, size_t outputChannelIndex, size_t numChannels )
 {
 	CI_ASSERT_MSG( input, "bad input" );
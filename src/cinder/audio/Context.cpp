@@ -28,8 +28,11 @@
 #include "cinder/audio/Debug.h"
 
 #include "cinder/Cinder.h"
+#include "cinder/Profiler.h"
+#include "cinder/System.h"
 #include "cinder/app/App.h"
 
+#include <map>
 #include <sstream>
 
 #if defined( CINDER_COCOA )
@@ -54,6 +57,9 @@ std::unique_ptr<DeviceManager>	Context::sDeviceManager;
 
 bool sIsRegisteredForShutdown = false;
 
+// maximum number of commands posted with postCommand() that can be waiting for the audio thread
+const size_t MAX_QUEUED_COMMANDS = 1024;
+
 // static
 void Context::registerClearStatics()
 {
@@ -117,15 +123,30 @@ void Context::setMaster( Context *masterContext, DeviceManager *deviceManager )
 }
 
 Context::Context()
-	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 )
+	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 ),
+	mScheduledEvents( nullptr ), mActiveEvents( nullptr ), mFinishedEvents( MAX_QUEUED_COMMANDS ), mCommands( MAX_QUEUED_COMMANDS ), mFinishedCommands( MAX_QUEUED_COMMANDS ), mRenderGeneration( 0 ), mRenderNode( nullptr ),
+	mRenderNumJobs( 0 ), mRenderJobCounter( 0 ), mRenderJobsFinished( 0 ), mRenderThreadsShouldQuit( false ), mRenderDispatching( false ),
+	mProfilingEnabled( false ), mProfileBlockSeconds( 0 ), mProfileBlockLoad( 0 ), mProfileBlockLoadPeak( 0 ), mNumXruns( 0 ),
+	mProfileGeneration( 0 ), mProfileBlockGeneration( 0 ), mProfilingBlock( false ), mTraceBlockBegin( -1 ), mBufferSharingEnabled( false )
 {
 }
 
 Context::~Context()
 {
 	disable();
+	stopRenderThreads();
 	lock_guard<mutex> lock( mMutex );
+	processCommands();
+	collectFinishedCommands();
+	deleteScheduledEvents();
 	uninitializeAllNodes();
+
+	// Node's may outlive the Context, so they can't be left pointing at its buffers
+	for( const auto &weakNode : mSharedBufferNodes ) {
+		NodeRef node = weakNode.lock();
+		if( node )
+			node->useOwnedBuffers();
+	}
 }
 
 void Context::enable()
@@ -190,6 +211,7 @@ void Context::disconnectAllNodes()
 void Context::setOutput( const OutputNodeRef &output )
 {
 	mOutput = output;
+	compileGraph();
 }
 
 const OutputNodeRef& Context::getOutput()
@@ -272,26 +294,319 @@ void Context::removeAutoPulledNode( const NodeRef &node )
 
 void Context::schedule( double when, const NodeRef &node, bool enable, const std::function<void ()> &func )
 {
-	const uint64_t framesPerBlock = (uint64_t)getFramesPerBlock();
-	uint64_t eventFrameThreshold = timeToFrame( when, getSampleRate() );
+	// Node's that don't handle getProcessFramesRange() themselves are processed on a sub-block when an event lands mid-block,
+	// which needs storage. This only has to synchronize with the audio thread the first time a Node is scheduled.
+	const size_t framesPerBlock = getFramesPerBlock();
+	const size_t numChannels = node->getNumChannels();
+	if( ! node->supportsProcessFramesRange() && node->mSubBlockBuffer.getAllocatedSize() < framesPerBlock * numChannels ) {
+		if( isAudioThread() )
+			node->mSubBlockBuffer.setSize( framesPerBlock, numChannels );
+		else {
+			lock_guard<mutex> lock( mMutex );
+			node->mSubBlockBuffer.setSize( framesPerBlock, numChannels );
+		}
+	}
+
+	ScheduledEvent *event = new ScheduledEvent( timeToFrame( when, getSampleRate() ), node, enable, func );
+	postCommand( [this, event] { insertScheduledEvent( event ); } );
+}
+
+bool Context::isAudioThread() const
+{
+	auto threadId = std::this_thread::get_id();
+	if( mAudioThreadId == threadId )
+		return true;
+
+	for( const auto &renderThreadId : mRenderThreadIds ) {
+		if( renderThreadId == threadId )
+			return true;
+	}
+
+	return false;
+}
+
+namespace {
+
+void collectNodesRecursive( Node *node, set<Node *> &nodes )
+{
+	if( ! nodes.insert( node ).second )
+		return;
+
+	for( const auto &input : node->getInputs() )
+		collectNodesRecursive( input.get(), nodes );
+}
+
+bool reachesNode( Node *node, Node *target, set<Node *> &traversedNodes )
+{
+	if( node == target )
+		return true;
+	if( ! traversedNodes.insert( node ).second )
+		return false;
 
-	// Place the threshold back one block so we can process the block first, guarding against wrap around
-	if( eventFrameThreshold >= framesPerBlock )
-		eventFrameThreshold -= framesPerBlock;
+	for( const auto &input : node->getInputs() ) {
+		if( reachesNode( input.get(), target, traversedNodes ) )
+			return true;
+	}
+
+	return false;
+}
+
+// records the most sharing Node's that can be above each Node on the pull stack, over every path from the roots
+void computeSharedLevels( Node *node, size_t level, const set<Node *> &sharingNodes, map<Node *, size_t> &levels, set<Node *> &stack )
+{
+	if( stack.count( node ) )
+		return;
+
+	auto levelIt = levels.find( node );
+	if( levelIt != levels.end() && levelIt->second >= level )
+		return;
+
+	levels[node] = level;
+
+	stack.insert( node );
+	const size_t inputLevel = sharingNodes.count( node ) ? level + 1 : level;
+	for( const auto &input : node->getInputs() )
+		computeSharedLevels( input.get(), inputLevel, sharingNodes, levels, stack );
+
+	stack.erase( node );
+}
+
+} // anonymous namespace
+
+void Context::setBufferSharingEnabled( bool enable )
+{
+	if( mBufferSharingEnabled == enable )
+		return;
+
+	mBufferSharingEnabled = enable;
+	compileGraph();
+}
+
+void Context::compileGraph()
+{
+	if( ! mBufferSharingEnabled && mSharedBufferNodes.empty() )
+		return;
 
 	lock_guard<mutex> lock( mMutex );
-	mScheduledEvents.push_back( ScheduledEvent( eventFrameThreshold, node, enable, func ) );
+	compileGraphImpl();
 }
 
-bool Context::isAudioThread() const
+// The graph is pulled depth-first from the roots. A summing Node's buffers are in use from when it is pulled until its output has read the result,
+// which happens right after, so only the sharing Node's on the current pull stack have buffers in use. Each sharing Node is given the pair of buffers
+// of its level, the most sharing Node's that can be above it on the stack, which holds regardless of the order a Node pulls its inputs in.
+void Context::compileGraphImpl()
 {
-	return mAudioThreadId == std::this_thread::get_id();
+	vector<Node *> roots;
+	if( mOutput )
+		roots.push_back( mOutput.get() );
+	for( const auto &node : mAutoPulledNodes )
+		roots.push_back( node.get() );
+
+	set<Node *> nodes;
+	if( mBufferSharingEnabled && mRenderThreads.empty() ) {
+		for( Node *root : roots )
+			collectNodesRecursive( root, nodes );
+	}
+
+	// Node's that are pulled from more than one place, or from outside the graph along with their inputs, keep their own buffers
+	set<Node *> excludedNodes( roots.begin(), roots.end() );
+	set<Node *> externallyPulledNodes;
+	for( Node *node : nodes ) {
+		if( node->getNumConnectedOutputs() > 1 )
+			excludedNodes.insert( node );
+
+		for( const auto &output : node->getOutputs() ) {
+			if( ! nodes.count( output.get() ) )
+				collectNodesRecursive( node, externallyPulledNodes );
+		}
+
+		if( node->mIsParamProcessor )
+			collectNodesRecursive( node, externallyPulledNodes );
+
+		if( ! node->supportsSharedInputBuffers() ) {
+			for( const auto &input : node->getInputs() )
+				excludedNodes.insert( input.get() );
+		}
+
+		// Node's on a cycle are read by their output before they're processed
+		set<Node *> traversedNodes;
+		for( const auto &input : node->getInputs() ) {
+			if( reachesNode( input.get(), node, traversedNodes ) ) {
+				excludedNodes.insert( node );
+				break;
+			}
+		}
+	}
+
+	excludedNodes.insert( externallyPulledNodes.begin(), externallyPulledNodes.end() );
+
+	set<Node *> sharingNodes;
+	for( Node *node : nodes ) {
+		if( node->isInitialized() && ! node->getProcessesInPlace() && ! excludedNodes.count( node ) )
+			sharingNodes.insert( node );
+	}
+
+	map<Node *, size_t> levels;
+	set<Node *> stack;
+	for( Node *root : roots )
+		computeSharedLevels( root, 0, sharingNodes, levels, stack );
+
+	// each level's buffers are large enough for the channels of any Node on it, or of its inputs
+	vector<size_t> levelChannels;
+	for( Node *node : sharingNodes ) {
+		const size_t level = levels[node];
+		if( levelChannels.size() <= level )
+			levelChannels.resize( level + 1, 0 );
+
+		levelChannels[level] = max( levelChannels[level], max( node->getNumChannels(), node->getMaxNumInputChannels() ) );
+	}
+
+	const size_t framesPerBlock = levelChannels.empty() ? 0 : getFramesPerBlock();
+	vector<BufferDynamic> sharedBuffers( levelChannels.size() * 2 );
+	for( size_t i = 0; i < sharedBuffers.size(); i++ )
+		sharedBuffers[i].setSize( framesPerBlock, levelChannels[i / 2] );
+
+	// Node's that no longer share go back to their own buffers before the previous pool is released
+	for( const auto &weakNode : mSharedBufferNodes ) {
+		NodeRef node = weakNode.lock();
+		if( ! node || sharingNodes.count( node.get() ) )
+			continue;
+
+		if( node->getProcessesInPlace() )
+			node->useOwnedBuffers();
+		else
+			node->setupProcessWithSumming();
+	}
+
+	mSharedBuffers.swap( sharedBuffers );
+	mSharedBufferNodes.clear();
+	for( Node *node : sharingNodes ) {
+		const size_t level = levels[node];
+		node->useSharedBuffers( &mSharedBuffers[level * 2], &mSharedBuffers[level * 2 + 1] );
+		mSharedBufferNodes.push_back( node->shared_from_this() );
+	}
+}
+
+void Context::setNumRenderThreads( size_t numThreads )
+{
+	if( numThreads == mRenderThreads.size() )
+		return;
+
+	lock_guard<mutex> lock( mMutex );
+
+	stopRenderThreads();
+
+	mRenderThreadsShouldQuit = false;
+	const double blockSeconds = (double)getFramesPerBlock() / (double)getSampleRate();
+	for( size_t i = 0; i < numThreads; i++ ) {
+		mRenderThreads.push_back( thread( bind( &Context::renderThreadLoop, this, blockSeconds ) ) );
+		mRenderThreadIds.push_back( mRenderThreads.back().get_id() );
+	}
+
+	// Node's pulled in parallel can't share buffers
+	compileGraphImpl();
+}
+
+void Context::stopRenderThreads()
+{
+	{
+		lock_guard<mutex> lock( mRenderMutex );
+		mRenderThreadsShouldQuit = true;
+	}
+
+	mRenderCondition.notify_all();
+	for( auto &renderThread : mRenderThreads )
+		renderThread.join();
+
+	mRenderThreads.clear();
+	mRenderThreadIds.clear();
+}
+
+bool Context::renderParallel( Node *node, size_t numJobs )
+{
+	// only the audio thread dispatches, nested summing Node's within a parallel branch are rendered serially
+	if( mRenderThreads.empty() || mRenderDispatching || mAudioThreadId != std::this_thread::get_id() )
+		return false;
+
+	mRenderDispatching = true;
+
+	uint32_t generation;
+	{
+		lock_guard<mutex> lock( mRenderMutex );
+		generation = ++mRenderGeneration;
+		mRenderNode = node;
+		mRenderNumJobs = numJobs;
+		mRenderJobsFinished = 0;
+		mRenderJobCounter = uint64_t( generation ) << 32;
+	}
+
+	mRenderCondition.notify_all();
+
+	// the audio thread takes jobs too, then waits for the render threads to finish the rest
+	runRenderJobs( generation, node, numJobs );
+	while( mRenderJobsFinished < numJobs )
+		this_thread::yield();
+
+	mRenderDispatching = false;
+	return true;
+}
+
+void Context::runRenderJobs( uint32_t generation, Node *node, size_t numJobs )
+{
+	// Jobs are claimed by incrementing the lower half of mRenderJobCounter, which only succeeds while the upper half still matches
+	// generation. This way a render thread that wakes up late can never process a job of a newer dispatch with a stale node.
+	uint64_t counter = mRenderJobCounter;
+	while( true ) {
+		size_t job = size_t( counter & 0xFFFFFFFF );
+		if( uint32_t( counter >> 32 ) != generation || job >= numJobs )
+			break;
+
+		if( mRenderJobCounter.compare_exchange_weak( counter, counter + 1 ) ) {
+			node->pullParallelInput( job );
+			mRenderJobsFinished++;
+			counter++;
+		}
+	}
+}
+
+void Context::renderThreadLoop( double blockSeconds )
+{
+	// render threads share the audio thread's deadline, so they are scheduled like it where the platform allows it
+	System::setThreadName( "audio render" );
+	System::setThreadRealtime( blockSeconds, blockSeconds / 2 );
+
+	uint32_t lastGeneration = 0;
+	while( true ) {
+		uint32_t generation;
+		Node *node;
+		size_t numJobs;
+		{
+			unique_lock<mutex> lock( mRenderMutex );
+			mRenderCondition.wait( lock, [&] { return mRenderThreadsShouldQuit || mRenderGeneration != lastGeneration; } );
+			if( mRenderThreadsShouldQuit )
+				return;
+
+			generation = lastGeneration = mRenderGeneration;
+			node = mRenderNode;
+			numJobs = mRenderNumJobs;
+		}
+
+		runRenderJobs( generation, node, numJobs );
+	}
 }
 
 void Context::preProcess()
 {
 	mAudioThreadId = std::this_thread::get_id();
 
+	Profiler *profiler = Profiler::get();
+	mTraceBlockBegin = profiler->isEnabled() ? profiler->getSeconds() : -1;
+
+	mProfilingBlock = mProfilingEnabled;
+	if( mProfilingBlock )
+		mProfileTimer.start();
+
+	processCommands();
 	preProcessScheduledEvents();
 }
 
@@ -299,14 +614,97 @@ void Context::postProcess()
 {
 	processAutoPulledNodes();
 	postProcessScheduledEvents();
+
+	if( mProfilingBlock ) {
+		mProfileTimer.stop();
+		double seconds = mProfileTimer.getSeconds();
+		float load = float( seconds * (double)getSampleRate() / (double)getFramesPerBlock() );
+
+		uint32_t generation = mProfileGeneration;
+		if( mProfileBlockGeneration != generation ) {
+			mProfileBlockGeneration = generation;
+			mProfileBlockLoadPeak = 0;
+		}
+
+		mProfileBlockSeconds = seconds;
+		mProfileBlockLoad = load;
+		if( load > mProfileBlockLoadPeak )
+			mProfileBlockLoadPeak = load;
+	}
+
+	if( mTraceBlockBegin >= 0 ) {
+		Profiler *profiler = Profiler::get();
+		profiler->recordZone( "audio::Context render", "audio", mTraceBlockBegin, profiler->getSeconds() );
+	}
+
 	incrementFrameCount();
 }
 
+void Context::setProfilingEnabled( bool enable )
+{
+	if( enable && ! mProfilingEnabled )
+		resetProfile();
+
+	mProfilingEnabled = enable;
+}
+
+void Context::resetProfile()
+{
+	mNumXruns = 0;
+	mProfileBlockLoadPeak = 0;
+	mProfileGeneration++;
+}
+
 void Context::incrementFrameCount()
 {
 	mNumProcessedFrames += getFramesPerBlock();
 }
 
+void Context::postCommand( const function<void ()> &command )
+{
+	if( isAudioThread() ) {
+		command();
+		return;
+	}
+
+	lock_guard<mutex> writeLock( mCommandsWriteMutex );
+	collectFinishedCommands();
+
+	Command *cmd = new Command( command );
+	if( mEnabled && mCommands.write( &cmd, 1 ) )
+		return;
+
+	// Either nothing is pulling the audio graph or the queue is full. Drain the queue on this thread while holding
+	// the audio mutex (the audio thread can't be consuming commands at the same time) so ordering is preserved.
+	lock_guard<mutex> lock( mMutex );
+	processCommands();
+	(*cmd)();
+	delete cmd;
+	collectFinishedCommands();
+}
+
+// note: called either from the audio thread or with mMutex held, so there is only ever one reader of mCommands
+void Context::processCommands()
+{
+	Command *cmd;
+	while( mCommands.read( &cmd, 1 ) ) {
+		(*cmd)();
+		if( ! mFinishedCommands.write( &cmd, 1 ) )
+			delete cmd;
+	}
+}
+
+void Context::collectFinishedCommands()
+{
+	Command *cmd;
+	while( mFinishedCommands.read( &cmd, 1 ) )
+		delete cmd;
+
+	ScheduledEvent *event;
+	while( mFinishedEvents.read( &event, 1 ) )
+		delete event;
+}
+
 void Context::processAutoPulledNodes()
 {
 	if( ! mAutoPullRequired )
@@ -320,45 +718,85 @@ void Context::processAutoPulledNodes()
 	}
 }
 
-void Context::preProcessScheduledEvents()
+// note: called on the audio thread (or with mMutex held) from a command posted by schedule(). Events with the same frame keep the order they were scheduled in.
+void Context::insertScheduledEvent( ScheduledEvent *event )
 {
-	const uint64_t framesPerBlock = (uint64_t)getFramesPerBlock();
-	const uint64_t numProcessedFrames = mNumProcessedFrames;
+	ScheduledEvent **next = &mScheduledEvents;
+	while( *next && (*next)->mEventFrame <= event->mEventFrame )
+		next = &(*next)->mNext;
 
-	for( auto &event : mScheduledEvents ) {
-		if( numProcessedFrames >= event.mEventFrameThreshold ) {
-			uint64_t frameOffset = numProcessedFrames - event.mEventFrameThreshold;
-			if( event.mEnable ) {
-				event.mNode->mProcessFramesRange.first = size_t( framesPerBlock - frameOffset );
-				event.mFunc();
-			}
-			else {
-				// set the process range but don't call its function until postProcess() (which should be disable()'ing the Node)
-				event.mNode->mProcessFramesRange.second = (size_t)frameOffset;
+	event->mNext = *next;
+	*next = event;
+}
+
+void Context::preProcessScheduledEvents()
+{
+	const size_t framesPerBlock = getFramesPerBlock();
+	const uint64_t blockBegin = mNumProcessedFrames;
+	const uint64_t blockEnd = blockBegin + framesPerBlock;
+
+	// move the events that land within this block to mActiveEvents, preserving their order
+	ScheduledEvent **activeTail = &mActiveEvents;
+	while( mScheduledEvents && mScheduledEvents->mEventFrame < blockEnd ) {
+		ScheduledEvent *event = mScheduledEvents;
+		mScheduledEvents = event->mNext;
+		event->mNext = nullptr;
+
+		// events that were scheduled too late are applied at the beginning of the block
+		const size_t frameOffset = event->mEventFrame > blockBegin ? size_t( event->mEventFrame - blockBegin ) : 0;
+		auto &range = event->mNode->mProcessFramesRange;
+		if( event->mEnable ) {
+			// an earlier disable of the same Node within this block is superseded
+			for( ScheduledEvent *active = mActiveEvents; active; active = active->mNext ) {
+				if( active->mNode == event->mNode && ! active->mEnable )
+					active->mCancelled = true;
 			}
 
-			event.mFinished = true;
+			// call the function first, as enabling may initialize the Node, which resets its range
+			event->mFunc();
+			range.first = frameOffset;
+			range.second = framesPerBlock;
+		}
+		else {
+			// set the process range but don't call its function until postProcess() (which should be disable()'ing the Node)
+			range.second = frameOffset;
 		}
+
+		*activeTail = event;
+		activeTail = &event->mNext;
 	}
 }
 
 void Context::postProcessScheduledEvents()
 {
-	for( auto eventIt = mScheduledEvents.begin(); eventIt != mScheduledEvents.end(); /* */ ) {
-		if( eventIt->mFinished ) {
-			if( ! eventIt->mEnable )
-				eventIt->mFunc();
+	while( mActiveEvents ) {
+		ScheduledEvent *event = mActiveEvents;
+		mActiveEvents = event->mNext;
+
+		if( ! event->mEnable && ! event->mCancelled )
+			event->mFunc();
+
+		// reset process frame range
+		auto &range = event->mNode->mProcessFramesRange;
+		range.first = 0;
+		range.second = getFramesPerBlock();
 
-			// reset process frame range
-			auto &range = eventIt->mNode->mProcessFramesRange;
-			range.first = 0;
-			range.second = getFramesPerBlock();
+		if( ! mFinishedEvents.write( &event, 1 ) )
+			delete event;
+	}
+}
 
-			eventIt = mScheduledEvents.erase( eventIt );
+void Context::deleteScheduledEvents()
+{
+	for( ScheduledEvent *list : { mScheduledEvents, mActiveEvents } ) {
+		while( list ) {
+			ScheduledEvent *next = list->mNext;
+			delete list;
+			list = next;
 		}
-		else
-			++eventIt;
 	}
+
+	mScheduledEvents = mActiveEvents = nullptr;
 }
 
 const std::vector<Node *>& Context::getAutoPulledNodes()
@@ -373,7 +811,7 @@ const std::vector<Node *>& Context::getAutoPulledNodes()
 
 namespace {
 
-void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes )
+void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes, bool includeProfile )
 {
 	if( ! node )
 		return;
@@ -398,25 +836,34 @@ void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<Nod
 	stream << ", ch: " << node->getNumChannels();
 	stream << ", ch mode: " << channelMode;
 	stream << ", " << ( node->getProcessesInPlace() ? "in-place" : "sum" );
+	if( node->isSharingBuffers() )
+		stream << ", shared buffers";
+	if( includeProfile )
+		stream << ", process: " << node->getProfileProcessSeconds() * 1000 << "ms (peak: " << node->getProfileProcessSecondsPeak() * 1000 << "ms)";
 	stream << " ]" << endl;
 
 	for( const auto &input : node->getInputs() )
-		printRecursive( stream, input, depth + 1, traversedNodes );
+		printRecursive( stream, input, depth + 1, traversedNodes, includeProfile );
 };
 
 } // anonymous namespace
 
-string Context::printGraphToString()
+string Context::printGraphToString( bool includeProfile )
 {
 	stringstream stream;
 	set<NodeRef> traversedNodes;
 
-	printRecursive( stream, getOutput(), 0, traversedNodes );
+	if( includeProfile ) {
+		stream << "(block: " << getProfileBlockSeconds() * 1000 << "ms, load: " << getProfileBlockLoad() * 100 << "% (peak: " << getProfileBlockLoadPeak() * 100;
+		stream << "%), xruns: " << getNumXruns() << ")" << endl;
+	}
+
+	printRecursive( stream, getOutput(), 0, traversedNodes, includeProfile );
 
 	if( ! mAutoPulledNodes.empty() ) {
 		stream << "(auto-pulled:)" << endl;
 		for( const auto& node : mAutoPulledNodes )
-			printRecursive( stream, node, 0, traversedNodes );
+			printRecursive( stream, node, 0, traversedNodes, includeProfile );
 	}
 
 	return stream.str();
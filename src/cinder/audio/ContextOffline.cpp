@@ -0,0 +1,146 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/Utilities.h"
+#include "cinder/audio/Debug.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - OutputOfflineNode
+// ----------------------------------------------------------------------------------------------------
+
+OutputOfflineNode::OutputOfflineNode( size_t sampleRate, size_t framesPerBlock, const Format &format )
+	: OutputNode( format ), mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock )
+{
+	if( getChannelMode() != ChannelMode::SPECIFIED ) {
+		setChannelMode( ChannelMode::SPECIFIED );
+		setNumChannels( 2 );
+	}
+}
+
+void OutputOfflineNode::renderBlock()
+{
+	Buffer *internalBuffer = getInternalBuffer();
+	internalBuffer->zero();
+	pullInputs( internalBuffer );
+
+	// if clip detection is enabled and buffer clipped, silence it
+	if( checkNotClipping() )
+		internalBuffer->zero();
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ContextOffline
+// ----------------------------------------------------------------------------------------------------
+
+// static
+ContextOfflineRef ContextOffline::create( size_t sampleRate, size_t framesPerBlock, size_t numChannels )
+{
+	ContextOfflineRef result( new ContextOffline() );
+	result->setOutput( result->makeNode( new OutputOfflineNode( sampleRate, framesPerBlock, Node::Format().channels( numChannels ) ) ) );
+	return result;
+}
+
+ContextOffline::ContextOffline()
+	: mCancelRequested( false ), mRendering( false )
+{
+}
+
+OutputDeviceNodeRef ContextOffline::createOutputDeviceNode( const DeviceRef &device, const Node::Format &format )
+{
+	throw AudioContextExc( "ContextOffline can not create an OutputDeviceNode." );
+}
+
+InputDeviceNodeRef ContextOffline::createInputDeviceNode( const DeviceRef &device, const Node::Format &format )
+{
+	throw AudioContextExc( "ContextOffline can not create an InputDeviceNode." );
+}
+
+void ContextOffline::setOutput( const OutputNodeRef &output )
+{
+	auto outputOffline = dynamic_pointer_cast<OutputOfflineNode>( output );
+	if( ! outputOffline )
+		throw AudioContextExc( "ContextOffline requires an OutputOfflineNode." );
+
+	mOutputOffline = outputOffline;
+	Context::setOutput( output );
+}
+
+uint64_t ContextOffline::render( uint64_t numFrames, TargetFile *target, const BlockCallback &blockCallback )
+{
+	CI_ASSERT_MSG( ! mRendering, "render() is already in progress" );
+
+	if( target && target->getNumChannels() != mOutputOffline->getNumChannels() )
+		throw AudioContextExc( "TargetFile channel count does not match the OutputOfflineNode." );
+
+	mRendering = true;
+	mCancelRequested = false;
+
+	// while enabled, commands posted from other threads are queued for the start of the next block.
+	ScopedEnableContext enableContext( this, true );
+
+	const uint64_t framesPerBlock = getFramesPerBlock();
+	uint64_t numRendered = 0;
+	try {
+		while( numRendered < numFrames && ! mCancelRequested ) {
+			const size_t blockFrames = (size_t)min( framesPerBlock, numFrames - numRendered );
+			{
+				lock_guard<mutex> lock( getMutex() );
+
+				preProcess();
+				mOutputOffline->renderBlock();
+				postProcess();
+			}
+
+			// delivered outside of the lock, so that writing to disk doesn't block other threads from modifying the graph.
+			const Buffer &buffer = *mOutputOffline->getInternalBuffer();
+			if( target )
+				target->write( &buffer, blockFrames );
+			if( blockCallback )
+				blockCallback( buffer, blockFrames );
+
+			numRendered += blockFrames;
+		}
+	}
+	catch( ... ) {
+		mRendering = false;
+		throw;
+	}
+
+	mRendering = false;
+	return numRendered;
+}
+
+uint64_t ContextOffline::renderSeconds( double seconds, TargetFile *target, const BlockCallback &blockCallback )
+{
+	return render( timeToFrame( seconds, getSampleRate() ), target, blockCallback );
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,217 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/ConvolverNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Debug.h"
+
+using namespace ci;
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// Accumulates the complex product of a and b into result. Bin 0 holds the DC component in its real part and the nyquist
+// component in its imaginary part (both purely real), the way dsp::Fft packs them.
+void multiplyAccumulate( const BufferSpectral &a, const BufferSpectral &b, BufferSpectral *result )
+{
+	const size_t numBins = a.getNumFrames();
+	const float *aReal = a.getReal();
+	const float *aImag = a.getImag();
+	const float *bReal = b.getReal();
+	const float *bImag = b.getImag();
+	float *resultReal = result->getReal();
+	float *resultImag = result->getImag();
+
+	resultReal[0] += aReal[0] * bReal[0];
+	resultImag[0] += aImag[0] * bImag[0];
+
+	for( size_t k = 1; k < numBins; k++ ) {
+		resultReal[k] += aReal[k] * bReal[k] - aImag[k] * bImag[k];
+		resultImag[k] += aReal[k] * bImag[k] + aImag[k] * bReal[k];
+	}
+}
+
+} // anonymous namespace
+
+ConvolverNode::ConvolverNode( const Format &format )
+	: Node( format ), mBlockSize( 0 ), mNumPartitions( 0 ), mNumImpulseChannels( 0 ), mDelayLineIndex( 0 )
+{
+}
+
+ConvolverNode::ConvolverNode( const BufferRef &impulseResponse, const Format &format )
+	: Node( format ), mImpulseResponse( impulseResponse ), mBlockSize( 0 ), mNumPartitions( 0 ), mNumImpulseChannels( 0 ), mDelayLineIndex( 0 )
+{
+}
+
+void ConvolverNode::setImpulseResponse( const BufferRef &impulseResponse )
+{
+	if( ! isInitialized() || ! impulseResponse ) {
+		mImpulseResponse = impulseResponse;
+		if( ! impulseResponse ) {
+			lock_guard<mutex> lock( getContext()->getMutex() );
+			mNumPartitions = 0;
+		}
+		return;
+	}
+
+	// transform the partitions before taking the lock, so the audio thread is only blocked while swapping them in.
+	vector<BufferSpectral> partitions;
+	size_t numPartitions = preparePartitions( impulseResponse.get(), mBlockSize, &partitions );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mImpulseResponse = impulseResponse;
+	mPartitions.swap( partitions );
+	mNumPartitions = numPartitions;
+	mNumImpulseChannels = impulseResponse->getNumChannels();
+	setupDelayLine();
+}
+
+void ConvolverNode::setImpulseResponse( const SourceFileRef &sourceFile )
+{
+	if( ! sourceFile ) {
+		setImpulseResponse( BufferRef() );
+		return;
+	}
+
+	size_t sampleRate = getSampleRate();
+	if( sourceFile->getSampleRate() != sampleRate )
+		setImpulseResponse( sourceFile->cloneWithSampleRate( sampleRate )->loadBuffer() );
+	else
+		setImpulseResponse( sourceFile->loadBuffer() );
+}
+
+void ConvolverNode::initialize()
+{
+	mBlockSize = getFramesPerBlock();
+	mFft.reset( new dsp::Fft( mBlockSize * 2 ) );
+	mAccumSpectral = BufferSpectral( mBlockSize * 2 );
+	mOutputTime = Buffer( mBlockSize * 2 );
+
+	if( mImpulseResponse ) {
+		mNumPartitions = preparePartitions( mImpulseResponse.get(), mBlockSize, &mPartitions );
+		mNumImpulseChannels = mImpulseResponse->getNumChannels();
+	}
+	else
+		mNumPartitions = 0;
+
+	setupDelayLine();
+}
+
+void ConvolverNode::uninitialize()
+{
+	mFft.reset();
+	mPartitions.clear();
+	mDelayLine.clear();
+	mInputHistory.clear();
+	mNumPartitions = 0;
+}
+
+void ConvolverNode::setupDelayLine()
+{
+	const size_t numChannels = getNumChannels();
+
+	mDelayLine.assign( numChannels * mNumPartitions, BufferSpectral( mBlockSize * 2 ) );
+	mInputHistory.assign( numChannels, Buffer( mBlockSize * 2 ) );
+	mDelayLineIndex = 0;
+}
+
+// static
+size_t ConvolverNode::preparePartitions( const Buffer *impulseResponse, size_t blockSize, vector<BufferSpectral> *partitions )
+{
+	const size_t fftSize = blockSize * 2;
+	const size_t numFrames = impulseResponse->getNumFrames();
+	const size_t numChannels = impulseResponse->getNumChannels();
+	const size_t numPartitions = ( numFrames + blockSize - 1 ) / blockSize;
+
+	dsp::Fft fft( fftSize );
+	Buffer partitionTime( fftSize );
+
+	// find the forward transform's gain (which is platform specific) from the transform of a unit impulse, so that
+	// multiplying by the partitions and transforming back yields a unity-gain convolution.
+	BufferSpectral impulseSpectral( fftSize );
+	partitionTime.zero();
+	partitionTime[0] = 1;
+	fft.forward( &partitionTime, &impulseSpectral );
+	const float normalizer = 1.0f / impulseSpectral.getReal()[0];
+
+	partitions->assign( numChannels * numPartitions, BufferSpectral( fftSize ) );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		const float *channel = impulseResponse->getChannel( ch );
+		for( size_t p = 0; p < numPartitions; p++ ) {
+			// each partition fills the first half of the transform, the second half is zero padding for overlap-save.
+			const size_t offset = p * blockSize;
+			const size_t count = min( blockSize, numFrames - offset );
+
+			partitionTime.zero();
+			memcpy( partitionTime.getData(), channel + offset, count * sizeof( float ) );
+
+			BufferSpectral &partition = (*partitions)[ch * numPartitions + p];
+			fft.forward( &partitionTime, &partition );
+			dsp::mul( partition.getData(), normalizer, partition.getData(), partition.getSize() );
+		}
+	}
+
+	return numPartitions;
+}
+
+void ConvolverNode::process( Buffer *buffer )
+{
+	const size_t numPartitions = mNumPartitions;
+	if( ! numPartitions || buffer->getNumFrames() != mBlockSize )
+		return;
+
+	const size_t blockSize = mBlockSize;
+	const size_t numChannels = min( buffer->getNumChannels(), mInputHistory.size() );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		float *channel = buffer->getChannel( ch );
+
+		// slide the input history by one block and transform the last two blocks into the newest delay line slot
+		float *history = mInputHistory[ch].getData();
+		memcpy( history, history + blockSize, blockSize * sizeof( float ) );
+		memcpy( history + blockSize, channel, blockSize * sizeof( float ) );
+
+		BufferSpectral *delayLine = &mDelayLine[ch * numPartitions];
+		mFft->forward( &mInputHistory[ch], &delayLine[mDelayLineIndex] );
+
+		// partition p is applied to the input spectrum from p blocks ago
+		const BufferSpectral *partitions = &mPartitions[( ch % mNumImpulseChannels ) * numPartitions];
+		mAccumSpectral.zero();
+		for( size_t p = 0; p < numPartitions; p++ ) {
+			size_t slot = ( mDelayLineIndex + numPartitions - p ) % numPartitions;
+			multiplyAccumulate( delayLine[slot], partitions[p], &mAccumSpectral );
+		}
+
+		// overlap-save: the second half of the inverse transform is the valid, non-aliased output
+		mFft->inverse( &mAccumSpectral, &mOutputTime );
+		memcpy( channel, mOutputTime.getData() + blockSize, blockSize * sizeof( float ) );
+	}
+
+	mDelayLineIndex = ( mDelayLineIndex + 1 ) % numPartitions;
+}
+
+} } // namespace cinder::audio
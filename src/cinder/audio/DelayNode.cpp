@@ -146,4 +146,157 @@ void DelayNode::process( Buffer *buffer )
 	mWriteIndex = writeIndex;
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - MultiTapDelayNode
+// ----------------------------------------------------------------------------------------------------
+
+MultiTapDelayNode::MultiTapDelayNode( size_t numTaps, const Format &format )
+	: Node( format ), mMaxDelaySeconds( 0 ), mSampleRate( 0 ), mWriteIndex( 0 ), mRingFrames( 0 ), mMaxDelayFrames( 0 )
+{
+	for( size_t i = 0; i < numTaps; i++ )
+		mTaps.push_back( unique_ptr<Tap>( new Tap( this ) ) );
+}
+
+void MultiTapDelayNode::setMaxDelaySeconds( float seconds )
+{
+	mMaxDelaySeconds = math<float>::max( seconds, 0 );
+
+	if( isInitialized() ) {
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		allocateDelayBuffer();
+	}
+}
+
+void MultiTapDelayNode::setTap( size_t tap, float delaySeconds, float gain )
+{
+	delaySeconds = math<float>::max( delaySeconds, 0 );
+
+	getParamDelaySeconds( tap )->setValue( delaySeconds );
+	getParamGain( tap )->setValue( gain );
+
+	if( delaySeconds > mMaxDelaySeconds )
+		setMaxDelaySeconds( delaySeconds );
+}
+
+void MultiTapDelayNode::clearBuffer()
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mDelayBuffer.zero();
+}
+
+void MultiTapDelayNode::initialize()
+{
+	mSampleRate = (float)getSampleRate();
+	allocateDelayBuffer();
+}
+
+void MultiTapDelayNode::allocateDelayBuffer()
+{
+	const size_t framesPerBlock = getFramesPerBlock();
+
+	// the ring holds the longest delay behind a whole block, since the block is written before the taps are read.
+	// One extra frame past the mirrored block lets interpolation read the frame after a tap's last position without wrapping.
+	mMaxDelayFrames = (size_t)ceil( mMaxDelaySeconds * mSampleRate );
+	mRingFrames = mMaxDelayFrames + framesPerBlock + 1;
+
+	mDelayBuffer.setSize( mRingFrames + framesPerBlock + 1, getNumChannels() );
+	mDelayBuffer.zero();
+	mWriteIndex = 0;
+}
+
+void MultiTapDelayNode::process( Buffer *buffer )
+{
+	const size_t writeIndex = mWriteIndex;
+
+	writeBlock( buffer );
+	buffer->zero();
+
+	for( auto &tap : mTaps )
+		readTap( tap.get(), writeIndex, buffer );
+}
+
+void MultiTapDelayNode::writeBlock( const Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numFramesBeforeWrap = min( numFrames, mRingFrames - mWriteIndex );
+	const size_t numMirroredFrames = mDelayBuffer.getNumFrames() - mRingFrames;
+
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+		const float *input = buffer->getChannel( ch );
+		float *delayChannel = mDelayBuffer.getChannel( ch );
+
+		memcpy( delayChannel + mWriteIndex, input, numFramesBeforeWrap * sizeof( float ) );
+		memcpy( delayChannel, input + numFramesBeforeWrap, ( numFrames - numFramesBeforeWrap ) * sizeof( float ) );
+
+		// keep the start of the ring mirrored past its end, so any span of a block starting within the ring can be read contiguously
+		memcpy( delayChannel + mRingFrames, delayChannel, numMirroredFrames * sizeof( float ) );
+	}
+
+	mWriteIndex = ( mWriteIndex + numFrames ) % mRingFrames;
+}
+
+void MultiTapDelayNode::readTap( Tap *tap, size_t writeIndex, Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t ringFrames = mRingFrames;
+	const float maxDelayFrames = (float)mMaxDelayFrames;
+
+	const bool delayVarying = tap->mDelaySeconds.eval();
+	const bool gainVarying = tap->mGain.eval();
+	const float *gainArray = gainVarying ? tap->mGain.getValueArray() : nullptr;
+	const float gain = tap->mGain.getValue();
+
+	if( ! gainVarying && gain == 0 )
+		return;
+
+	if( ! delayVarying ) {
+		// the whole block is read from one contiguous span, at a constant fraction between frames
+		const float delayFrames = math<float>::clamp( tap->mDelaySeconds.getValue() * mSampleRate, 0, maxDelayFrames );
+		double readPos = double( writeIndex + ringFrames ) - delayFrames;
+		if( readPos >= ringFrames )
+			readPos -= ringFrames;
+
+		const size_t readIndex = (size_t)readPos;
+		const float frac = float( readPos - readIndex );
+
+		for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+			const float *x = mDelayBuffer.getChannel( ch ) + readIndex;
+			float *out = buffer->getChannel( ch );
+
+			if( gainVarying ) {
+				for( size_t i = 0; i < numFrames; i++ )
+					out[i] += gainArray[i] * ( x[i] + frac * ( x[i + 1] - x[i] ) );
+			}
+			else {
+				const float gainA = gain * ( 1 - frac );
+				const float gainB = gain * frac;
+				for( size_t i = 0; i < numFrames; i++ )
+					out[i] += gainA * x[i] + gainB * x[i + 1];
+			}
+		}
+	}
+	else {
+		const float *delaySecondsArray = tap->mDelaySeconds.getValueArray();
+
+		for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+			const float *delayChannel = mDelayBuffer.getChannel( ch );
+			float *out = buffer->getChannel( ch );
+
+			for( size_t i = 0; i < numFrames; i++ ) {
+				const float delayFrames = math<float>::clamp( delaySecondsArray[i] * mSampleRate, 0, maxDelayFrames );
+				double readPos = double( writeIndex + i + ringFrames ) - delayFrames;
+				if( readPos >= ringFrames )
+					readPos -= ringFrames;
+
+				const size_t readIndex = (size_t)readPos;
+				const float frac = float( readPos - readIndex );
+				const float sample = delayChannel[readIndex] + frac * ( delayChannel[readIndex + 1] - delayChannel[readIndex] );
+
+				out[i] += ( gainVarying ? gainArray[i] : gain ) * sample;
+			}
+		}
+	}
+}
+
 } } // namespace cinder::audio
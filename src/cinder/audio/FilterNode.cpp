@@ -27,6 +27,49 @@ using namespace std;
 
 namespace cinder { namespace audio {
 
+namespace {
+
+void setBiquadParams( dsp::Biquad *biquad, FilterBiquadNode::Mode mode, float freq, float q, float gain, size_t niquist )
+{
+	// Convert from Hertz to normalized frequency 0 -> 1.
+	double normalizedFrequency = freq / niquist;
+
+	switch( mode ) {
+		case FilterBiquadNode::Mode::LOWPASS:
+			biquad->setLowpassParams( normalizedFrequency, q );
+			break;
+		case FilterBiquadNode::Mode::HIGHPASS:
+			biquad->setHighpassParams( normalizedFrequency, q );
+			break;
+		case FilterBiquadNode::Mode::BANDPASS:
+			biquad->setBandpassParams( normalizedFrequency, q );
+			break;
+		case FilterBiquadNode::Mode::LOWSHELF:
+			biquad->setLowShelfParams( normalizedFrequency, gain );
+			break;
+		case FilterBiquadNode::Mode::HIGHSHELF:
+			biquad->setHighShelfParams( normalizedFrequency, gain );
+			break;
+		case FilterBiquadNode::Mode::PEAKING:
+			biquad->setPeakingParams( normalizedFrequency, q, gain );
+			break;
+		case FilterBiquadNode::Mode::ALLPASS:
+			biquad->setAllpassParams( normalizedFrequency, q );
+			break;
+		case FilterBiquadNode::Mode::NOTCH:
+			biquad->setNotchParams( normalizedFrequency, q );
+			break;
+		default:
+			break;
+	}
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FilterBiquadNode
+// ----------------------------------------------------------------------------------------------------
+
 FilterBiquadNode::FilterBiquadNode( Mode mode, const Format &format )
 	: Node( format ), mMode( mode ), mCoeffsDirty( true ), mFreq( 200.0f ), mQ( 1.0f ), mGain( 0.0f )
 {
@@ -34,19 +77,18 @@ FilterBiquadNode::FilterBiquadNode( Mode mode, const Format &format )
 
 void FilterBiquadNode::initialize()
 {
-	// Convert from Hertz to normalized frequency 0 -> 1.
 	mNiquist = getSampleRate() / 2;
 
-	mBufferd = BufferT<double>( getFramesPerBlock(), getNumChannels() );
-	mBiquads.resize( getNumChannels() );
+	mBiquadBank.setMaxFrames( getFramesPerBlock() );
+	mBiquadBank.setSize( getNumChannels(), 1 );
 
-	if( mCoeffsDirty )
-		updateBiquadParams();
+	mCoeffsDirty = true;
+	updateBiquadParams();
 }
 
 void FilterBiquadNode::uninitialize()
 {
-	mBiquads.clear();
+	mBiquadBank.setSize( 0, 1 );
 }
 
 void FilterBiquadNode::process( Buffer *buffer )
@@ -54,54 +96,77 @@ void FilterBiquadNode::process( Buffer *buffer )
 	if( mCoeffsDirty )
 		updateBiquadParams();
 
-	size_t numFrames = buffer->getNumFrames();
-
-	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
-		float *channel = buffer->getChannel( ch );
-		mBiquads[ch].process( channel, channel, numFrames );
-	}
+	mBiquadBank.process( buffer );
 }
 
 void FilterBiquadNode::updateBiquadParams()
 {
 	mCoeffsDirty = false;
-	double normalizedFrequency = mFreq / mNiquist;
 
-	switch( mMode ) {
-		case Mode::LOWPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setLowpassParams( normalizedFrequency, mQ );
-			break;
-		case Mode::HIGHPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setHighpassParams( normalizedFrequency, mQ );
-			break;
-		case Mode::BANDPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
-			break;
-		case Mode::LOWSHELF:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setLowShelfParams( mFreq, mGain );;
-			break;
-		case Mode::HIGHSHELF:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setHighShelfParams( mFreq, mGain );;
-			break;
-		case Mode::PEAKING:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setPeakingParams( normalizedFrequency, mQ, mGain );
-			break;
-		case Mode::ALLPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
-			break;
-		case Mode::NOTCH:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setNotchParams( normalizedFrequency, mQ );
-			break;
-		default:
-			break;
+	if( mMode == Mode::CUSTOM )
+		return;
+
+	setBiquadParams( &mBiquad, mMode, mFreq, mQ, mGain, mNiquist );
+	mBiquadBank.setCoefficients( 0, mBiquad );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FilterEqNode
+// ----------------------------------------------------------------------------------------------------
+
+FilterEqNode::FilterEqNode( size_t numBands, const Format &format )
+	: Node( format ), mCoeffsDirty( true )
+{
+	Band band;
+	band.mMode = Mode::PEAKING;
+	band.mFreq = 1000.0f;
+	band.mQ = 1.0f;
+	band.mGain = 0.0f;
+
+	mBands.resize( numBands, band );
+}
+
+void FilterEqNode::setBand( size_t band, Mode mode, float freq, float q, float gain )
+{
+	Band &b = mBands.at( band );
+	b.mMode = mode;
+	b.mFreq = freq;
+	b.mQ = q;
+	b.mGain = gain;
+
+	mCoeffsDirty = true;
+}
+
+void FilterEqNode::initialize()
+{
+	mNiquist = getSampleRate() / 2;
+
+	mBiquadBank.setMaxFrames( getFramesPerBlock() );
+	mBiquadBank.setSize( getNumChannels(), mBands.size() );
+
+	mCoeffsDirty = true;
+	updateBiquadParams();
+}
+
+void FilterEqNode::process( Buffer *buffer )
+{
+	if( mCoeffsDirty )
+		updateBiquadParams();
+
+	mBiquadBank.process( buffer );
+}
+
+void FilterEqNode::updateBiquadParams()
+{
+	mCoeffsDirty = false;
+
+	for( size_t i = 0; i < mBands.size(); i++ ) {
+		const Band &band = mBands[i];
+		if( band.mMode == Mode::CUSTOM )
+			continue;
+
+		setBiquadParams( &mBiquad, band.mMode, band.mFreq, band.mQ, band.mGain, mNiquist );
+		mBiquadBank.setCoefficients( i, mBiquad );
 	}
 }
 
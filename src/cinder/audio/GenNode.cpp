@@ -28,6 +28,8 @@
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
 
+#include <algorithm>
+
 #define DEFAULT_TABLE_SIZE 4096
 #define DEFAULT_BANDLIMITED_TABLES 40
 
@@ -368,4 +370,97 @@ void GenPulseNode::process( Buffer *buffer )
 	dsp::sub( outputData, data2, outputData, numFrames );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - GenOscBankNode
+// ----------------------------------------------------------------------------------------------------
+
+GenOscBankNode::GenOscBankNode( size_t numOscillators, WaveformType waveformType, const Format &format )
+	: InputNode( format ), mWaveformType( waveformType ), mFreqs( numOscillators, 0.0f ), mAmps( numOscillators, 0.0f ),
+		mPhases( numOscillators, 0.0f ), mAmpsCurrent( numOscillators, 0.0f )
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( 1 );
+}
+
+void GenOscBankNode::initialize()
+{
+	size_t sampleRate = getSampleRate();
+	bool needsFill = false;
+	if( ! mWaveTable ) {
+		mWaveTable.reset( new WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
+		needsFill = true;
+	}
+	else if( sampleRate != mWaveTable->getSampleRate() )
+		needsFill = true;
+
+	if( needsFill )
+		mWaveTable->fillBandlimited( mWaveformType );
+}
+
+void GenOscBankNode::setNumOscillators( size_t numOscillators )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mFreqs.resize( numOscillators, 0.0f );
+	mAmps.resize( numOscillators, 0.0f );
+	mPhases.resize( numOscillators, 0.0f );
+	mAmpsCurrent.resize( numOscillators, 0.0f );
+}
+
+void GenOscBankNode::setFreq( size_t index, float freq )
+{
+	CI_ASSERT( index < mFreqs.size() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mFreqs[index] = freq;
+}
+
+void GenOscBankNode::setAmp( size_t index, float amp )
+{
+	CI_ASSERT( index < mAmps.size() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mAmps[index] = amp;
+}
+
+void GenOscBankNode::setFreqs( const float *freqs, size_t count, size_t offset )
+{
+	CI_ASSERT( offset + count <= mFreqs.size() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	copy( freqs, freqs + count, mFreqs.begin() + offset );
+}
+
+void GenOscBankNode::setAmps( const float *amps, size_t count, size_t offset )
+{
+	CI_ASSERT( offset + count <= mAmps.size() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	copy( amps, amps + count, mAmps.begin() + offset );
+}
+
+void GenOscBankNode::setWaveform( WaveformType waveformType )
+{
+	if( mWaveformType == waveformType )
+		return;
+
+	if( ! isInitialized() )
+		getContext()->initializeNode( shared_from_this() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mWaveformType = waveformType;
+	mWaveTable->fillBandlimited( waveformType );
+}
+
+void GenOscBankNode::process( Buffer *buffer )
+{
+	const auto &frameRange = getProcessFramesRange();
+	size_t numFrames = frameRange.second - frameRange.first;
+	size_t numOscillators = mFreqs.size();
+
+	mWaveTable->lookupBandlimitedSum( buffer->getData() + frameRange.first, numFrames, mPhases.data(), mFreqs.data(), mAmpsCurrent.data(), mAmps.data(), numOscillators );
+	copy( mAmps.begin(), mAmps.end(), mAmpsCurrent.begin() );
+}
+
 } } // namespace cinder::audio
@@ -98,7 +98,9 @@ void MonitorNode::fillCopiedBuffer()
 // ----------------------------------------------------------------------------------------------------
 
 MonitorSpectralNode::MonitorSpectralNode( const Format &format )
-	: MonitorNode( format ), mFftSize( format.getFftSize() ), mWindowType( format.getWindowType() ), mSmoothingFactor( 0.5f )
+	: MonitorNode( format ), mFftSize( format.getFftSize() ), mWindowType( format.getWindowType() ), mSmoothingFactor( 0.5f ),
+		mSpectrogramFrames( format.getSpectrogramFrames() ), mHopSize( format.getHopSize() ), mNumNewSpectrogramFrames( 0 ),
+		mAnalysisWriteIndex( 0 ), mSamplesUntilHop( 0 )
 {
 }
 
@@ -127,6 +129,104 @@ void MonitorSpectralNode::initialize()
 
 	mWindowingTable = makeAlignedArray<float>( mWindowSize );
 	generateWindow( mWindowType, mWindowingTable.get(), mWindowSize );
+
+	if( mSpectrogramFrames ) {
+		if( ! mHopSize )
+			mHopSize = mWindowSize;
+
+		const size_t numBins = getNumBins();
+		mSpectrogramFft = unique_ptr<dsp::Fft>( new dsp::Fft( mFftSize ) );
+		mSpectrogramFftBuffer = audio::Buffer( mFftSize );
+		mSpectrogramSpectral = audio::BufferSpectral( mFftSize );
+		mAnalysisBuffer = audio::Buffer( mWindowSize );
+		mSpectrogramFrame.assign( numBins, 0 );
+		mSpectrogramRing.resize( mSpectrogramFrames * numBins );
+		mSpectrogram.assign( mSpectrogramFrames * numBins, 0 );
+		mAnalysisWriteIndex = 0;
+		mSamplesUntilHop = mWindowSize;
+	}
+}
+
+void MonitorSpectralNode::process( Buffer *buffer )
+{
+	MonitorNode::process( buffer );
+
+	if( mSpectrogramFrames )
+		processSpectrogram( buffer );
+}
+
+void MonitorSpectralNode::processSpectrogram( const Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = getNumChannels();
+	const float channelScale = 1.0f / numChannels;
+	float *analysis = mAnalysisBuffer.getData();
+
+	for( size_t i = 0; i < numFrames; i++ ) {
+		// mix down to mono into the circular analysis buffer
+		float sample = 0;
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			sample += buffer->getChannel( ch )[i];
+
+		analysis[mAnalysisWriteIndex] = sample * channelScale;
+		mAnalysisWriteIndex = ( mAnalysisWriteIndex + 1 ) % mWindowSize;
+
+		if( --mSamplesUntilHop != 0 )
+			continue;
+
+		mSamplesUntilHop = mHopSize;
+
+		// unroll the circular buffer so the oldest sample is first, then window it.
+		float *fftData = mSpectrogramFftBuffer.getData();
+		const size_t tailSize = mWindowSize - mAnalysisWriteIndex;
+		memcpy( fftData, analysis + mAnalysisWriteIndex, tailSize * sizeof( float ) );
+		memcpy( fftData + tailSize, analysis, mAnalysisWriteIndex * sizeof( float ) );
+		dsp::mul( fftData, mWindowingTable.get(), fftData, mWindowSize );
+
+		computeMagnitudes( mSpectrogramFft.get(), &mSpectrogramFftBuffer, &mSpectrogramSpectral, mSpectrogramFrame.data(), 0 );
+
+		// if the user thread hasn't made room, the frame is dropped.
+		mSpectrogramRing.write( mSpectrogramFrame.data(), mSpectrogramFrame.size() );
+	}
+}
+
+const std::vector<float>& MonitorSpectralNode::getSpectrogram()
+{
+	mNumNewSpectrogramFrames = 0;
+	if( ! mSpectrogramFrames )
+		return mSpectrogram;
+
+	// shift the history by one frame and read each new frame into the last row
+	const size_t numBins = getNumBins();
+	float *lastFrame = &mSpectrogram[( mSpectrogramFrames - 1 ) * numBins];
+	while( mSpectrogramRing.getAvailableRead() >= numBins ) {
+		memmove( mSpectrogram.data(), mSpectrogram.data() + numBins, ( mSpectrogramFrames - 1 ) * numBins * sizeof( float ) );
+		mSpectrogramRing.read( lastFrame, numBins );
+		mNumNewSpectrogramFrames++;
+	}
+
+	return mSpectrogram;
+}
+
+void MonitorSpectralNode::computeMagnitudes( dsp::Fft *fft, Buffer *fftBuffer, BufferSpectral *bufferSpectral, float *magSpectrum, float smoothingFactor )
+{
+	fft->forward( fftBuffer, bufferSpectral );
+
+	float *real = bufferSpectral->getReal();
+	float *imag = bufferSpectral->getImag();
+
+	// remove nyquist component
+	imag[0] = 0.0f;
+
+	// compute normalized magnitude spectrum
+	// TODO: break this into vector cartisian -> polar and then vector lowpass. skip lowpass if smoothing factor is very small
+	const float magScale = 1.0f / fft->getSize();
+	const size_t numBins = bufferSpectral->getNumFrames();
+	for( size_t i = 0; i < numBins; i++ ) {
+		float re = real[i];
+		float im = imag[i];
+		magSpectrum[i] = magSpectrum[i] * smoothingFactor + sqrt( re * re + im * im ) * magScale * ( 1 - smoothingFactor );
+	}
 }
 
 // TODO: When getNumChannels() > 1, use generic channel converter.
@@ -149,22 +249,7 @@ const std::vector<float>& MonitorSpectralNode::getMagSpectrum()
 	else
 		dsp::mul( mCopiedBuffer.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
 
-	mFft->forward( &mFftBuffer, &mBufferSpectral );
-
-	float *real = mBufferSpectral.getReal();
-	float *imag = mBufferSpectral.getImag();
-
-	// remove nyquist component
-	imag[0] = 0.0f;
-
-	// compute normalized magnitude spectrum
-	// TODO: break this into vector cartisian -> polar and then vector lowpass. skip lowpass if smoothing factor is very small
-	const float magScale = 1.0f / mFft->getSize();
-	for( size_t i = 0; i < mMagSpectrum.size(); i++ ) {
-		float re = real[i];
-		float im = imag[i];
-		mMagSpectrum[i] = mMagSpectrum[i] * mSmoothingFactor + sqrt( re * re + im * im ) * magScale * ( 1 - mSmoothingFactor );
-	}
+	computeMagnitudes( mFft.get(), &mFftBuffer, &mBufferSpectral, mMagSpectrum.data(), mSmoothingFactor );
 
 	return mMagSpectrum;
 }
@@ -23,7 +23,6 @@
 
 
 #include "cinder/audio/Node.h"
-#include "cinder/audio/DelayNode.h"
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/Converter.h"
@@ -31,6 +30,7 @@
 #include "cinder/CinderAssert.h"
 #include "cinder/System.h"
 
+#include <cstring>
 #include <limits>
 
 using namespace std;
@@ -43,7 +43,9 @@ namespace cinder { namespace audio {
 
 Node::Node( const Format &format )
 	: mInitialized( false ), mEnabled( false ),	mChannelMode( format.getChannelMode() ),
-		mNumChannels( 1 ), mAutoEnabled( true ), mProcessInPlace( true ), mLastProcessedFrame( numeric_limits<uint64_t>::max() )
+		mNumChannels( 1 ), mAutoEnabled( true ), mProcessInPlace( true ), mLastProcessedFrame( numeric_limits<uint64_t>::max() ),
+		mProfileProcessSeconds( 0 ), mProfileProcessSecondsPeak( 0 ), mProfileGeneration( 0 ),
+		mInternalBuffer( &mOwnedInternalBuffer ), mSummingBuffer( &mOwnedSummingBuffer ), mSharesBuffers( false ), mIsParamProcessor( false )
 {
 	if( format.getChannels() ) {
 		mNumChannels = format.getChannels();
@@ -318,9 +320,6 @@ bool Node::inputChannelsAreUnequal() const
 	return false;
 }
 
-// TODO: Checking for DelayNode below is a kludge and will not work for other types that want to support feedback.
-//		 With more investigation it might be possible to avoid this, or at least define some interface that
-//       specifies whether this input needs to be summed.
 void Node::configureConnections()
 {
 	CI_ASSERT( getContext() );
@@ -330,7 +329,8 @@ void Node::configureConnections()
 	if( getNumConnectedInputs() > 1 || getNumConnectedOutputs() > 1 )
 		mProcessInPlace = false;
 
-	bool isDelay = ( dynamic_cast<DelayNode *>( this ) != nullptr ); // see note above
+	// Node's that support cycles (such as DelayNode) may have an input that is part of a feedback loop
+	bool isDelay = supportsCycles();
 	bool inputChannelsUnequal = inputChannelsAreUnequal();
 
 	for( auto &input : mInputs ) {
@@ -358,7 +358,7 @@ void Node::configureConnections()
 		if( inputChannelsUnequal )
 			inputProcessInPlace = false;
 
-		// if we're unable to process in-place and we're a DelayNode, its possible that the input may be part of a feedback loop, in which case input must sum.
+		// if we're unable to process in-place and we support cycles, its possible that the input may be part of a feedback loop, in which case input must sum.
 		if( ! mProcessInPlace && isDelay )
 			inputProcessInPlace = false;
 
@@ -398,7 +398,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 			// from InputNode's that aren't filling the entire buffer are zero.
 			inPlaceBuffer->zero();
 			if( mEnabled )
-				process( inPlaceBuffer );
+				processImpl( inPlaceBuffer );
 		}
 		else {
 			// First pull the input (can only be one when in-place), then run process() if input did any processing.
@@ -409,7 +409,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 				dsp::mixBuffers( input->getInternalBuffer(), inPlaceBuffer );
 
 			if( mEnabled )
-				process( inPlaceBuffer );
+				processImpl( inPlaceBuffer );
 		}
 	}
 	else {
@@ -418,7 +418,13 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 		if( mLastProcessedFrame != numProcessedFrames ) {
 			mLastProcessedFrame = numProcessedFrames;
 
-			mSummingBuffer.zero();
+			// shared buffers are left with the channel count of whichever Node used them last
+			if( mSharesBuffers ) {
+				mInternalBuffer->setNumChannels( mNumChannels );
+				mSummingBuffer->setNumChannels( mNumChannels );
+			}
+
+			mSummingBuffer->zero();
 			sumInputs();
 		}
 	}
@@ -426,20 +432,109 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 
 void Node::sumInputs()
 {
-	// Pull all inputs, summing the results from the buffer that input used for processing.
-	// mInternalBuffer is not zero'ed before pulling inputs to allow for feedback.
-	for( auto &input : mInputs ) {
-		input->pullInputs( &mInternalBuffer );
-		const Buffer *processedBuffer = input->getProcessesInPlace() ? &mInternalBuffer : input->getInternalBuffer();
-		dsp::sumBuffers( processedBuffer, &mSummingBuffer );
+	// If the Context has render threads, independent inputs are pulled in parallel into their own buffers first.
+	// They are collected at the front of mParallelInputs, while the rest are pulled serially below.
+	size_t numParallel = 0;
+	size_t numSerial = 0;
+	if( mInputs.size() > 1 && mParallelInputs.size() >= mInputs.size() ) {
+		for( auto &input : mInputs ) {
+			if( input->isIndependentBranch() )
+				mParallelInputs[numParallel++] = input.get();
+			else
+				mParallelInputs[mParallelInputs.size() - ++numSerial] = input.get();
+		}
+
+		if( numParallel < 2 || ! getContext()->renderParallel( this, numParallel ) )
+			numParallel = 0;
+	}
+
+	if( numParallel ) {
+		for( size_t i = 0; i < numParallel; i++ ) {
+			const Node *input = mParallelInputs[i];
+			const Buffer *processedBuffer = input->getProcessesInPlace() ? &mParallelBuffers[i] : input->getInternalBuffer();
+			dsp::sumBuffers( processedBuffer, mSummingBuffer );
+		}
+
+		for( size_t i = mParallelInputs.size() - numSerial; i < mParallelInputs.size(); i++ ) {
+			Node *input = mParallelInputs[i];
+			input->pullInputs( mInternalBuffer );
+			const Buffer *processedBuffer = input->getProcessesInPlace() ? mInternalBuffer : input->getInternalBuffer();
+			dsp::sumBuffers( processedBuffer, mSummingBuffer );
+		}
+	}
+	else {
+		// Pull all inputs, summing the results from the buffer that input used for processing.
+		// mInternalBuffer is not zero'ed before pulling inputs to allow for feedback.
+		for( auto &input : mInputs ) {
+			input->pullInputs( mInternalBuffer );
+			const Buffer *processedBuffer = input->getProcessesInPlace() ? mInternalBuffer : input->getInternalBuffer();
+			dsp::sumBuffers( processedBuffer, mSummingBuffer );
+		}
 	}
 
 	// Process the summed results if enabled.
 	if( mEnabled )
-		process( &mSummingBuffer );
+		processImpl( mSummingBuffer );
 
 	// copy summed buffer back to internal so downstream can get it.
-	dsp::mixBuffers( &mSummingBuffer, &mInternalBuffer );
+	dsp::mixBuffers( mSummingBuffer, mInternalBuffer );
+}
+
+void Node::processImpl( Buffer *buffer )
+{
+	auto ctx = getContext();
+	if( ! ctx || ! ctx->mProfilingBlock ) {
+		processFramesRange( buffer );
+		return;
+	}
+
+	mProfileTimer.start();
+	processFramesRange( buffer );
+	mProfileTimer.stop();
+
+	uint32_t generation = ctx->mProfileGeneration;
+	if( mProfileGeneration != generation ) {
+		mProfileGeneration = generation;
+		mProfileProcessSecondsPeak = 0;
+	}
+
+	double seconds = mProfileTimer.getSeconds();
+	mProfileProcessSeconds = seconds;
+	if( seconds > mProfileProcessSecondsPeak )
+		mProfileProcessSecondsPeak = seconds;
+}
+
+void Node::processFramesRange( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t first = mProcessFramesRange.first;
+	const size_t last = min( mProcessFramesRange.second, numFrames );
+	if( ( first == 0 && last == numFrames ) || supportsProcessFramesRange() ) {
+		process( buffer );
+		return;
+	}
+
+	if( first >= last )
+		return;
+
+	// An event landed within this block, so only the frames in [first, last) are processed. The rest are left as they are,
+	// which is silence for inputs and the unprocessed signal for effects, just as if this Node was disabled.
+	const size_t numChannels = buffer->getNumChannels();
+	const size_t subFrames = last - first;
+	if( mSubBlockBuffer.getAllocatedSize() < subFrames * numChannels ) {
+		// storage wasn't prepared by Context::schedule() (the channel count may have changed since), so process the entire block
+		process( buffer );
+		return;
+	}
+
+	mSubBlockBuffer.setSize( subFrames, numChannels );
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		memcpy( mSubBlockBuffer.getChannel( ch ), buffer->getChannel( ch ) + first, subFrames * sizeof( float ) );
+
+	process( &mSubBlockBuffer );
+
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		memcpy( buffer->getChannel( ch ) + first, mSubBlockBuffer.getChannel( ch ), subFrames * sizeof( float ) );
 }
 
 void Node::setupProcessWithSumming()
@@ -449,8 +544,58 @@ void Node::setupProcessWithSumming()
 	mProcessInPlace = false;
 	size_t framesPerBlock = getFramesPerBlock();
 
-	mInternalBuffer.setSize( framesPerBlock, mNumChannels );
-	mSummingBuffer.setSize( framesPerBlock, mNumChannels );
+	// a Node that was sharing buffers uses its own until the Context compiles the graph again
+	useOwnedBuffers();
+	mInternalBuffer->setSize( framesPerBlock, mNumChannels );
+	mSummingBuffer->setSize( framesPerBlock, mNumChannels );
+
+	if( getContext()->getNumRenderThreads() && mInputs.size() > 1 ) {
+		mParallelInputs.resize( mInputs.size() );
+		mParallelBuffers.resize( mInputs.size() );
+		for( auto &buffer : mParallelBuffers )
+			buffer.setSize( framesPerBlock, mNumChannels );
+	}
+	else {
+		mParallelInputs.clear();
+		mParallelBuffers.clear();
+	}
+}
+
+void Node::useOwnedBuffers()
+{
+	mSharesBuffers = false;
+	mInternalBuffer = &mOwnedInternalBuffer;
+	mSummingBuffer = &mOwnedSummingBuffer;
+}
+
+void Node::useSharedBuffers( BufferDynamic *internalBuffer, BufferDynamic *summingBuffer )
+{
+	mSharesBuffers = true;
+	mInternalBuffer = internalBuffer;
+	mSummingBuffer = summingBuffer;
+
+	mOwnedInternalBuffer.setNumFrames( 0 );
+	mOwnedInternalBuffer.shrinkToFit();
+	mOwnedSummingBuffer.setNumFrames( 0 );
+	mOwnedSummingBuffer.shrinkToFit();
+}
+
+bool Node::isIndependentBranch() const
+{
+	if( getNumConnectedOutputs() > 1 || supportsCycles() )
+		return false;
+
+	for( const auto &input : mInputs ) {
+		if( ! input->isIndependentBranch() )
+			return false;
+	}
+
+	return true;
+}
+
+void Node::pullParallelInput( size_t index )
+{
+	mParallelInputs[index]->pullInputs( &mParallelBuffers[index] );
 }
 
 bool Node::checkCycle( const NodeRef &sourceNode, const NodeRef &destNode ) const
@@ -471,7 +616,9 @@ bool Node::checkCycle( const NodeRef &sourceNode, const NodeRef &destNode ) cons
 
 void Node::notifyConnectionsDidChange()
 {
-	getContext()->connectionsDidChange( shared_from_this() );
+	auto ctx = getContext();
+	ctx->connectionsDidChange( shared_from_this() );
+	ctx->compileGraph();
 }
 
 bool Node::canConnectToInput( const NodeRef &input )
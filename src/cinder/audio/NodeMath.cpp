@@ -22,9 +22,15 @@
  */
 
 #include "cinder/audio/NodeMath.h"
+#include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/Exception.h"
 #include "cinder/CinderMath.h"
 
+#include <cstring>
+#include <limits>
+#include <map>
+
 namespace cinder { namespace audio {
 
 // ----------------------------------------------------------------------------------------------------
@@ -84,4 +90,459 @@ void DivideNode::process( Buffer *buffer )
 		dsp::divide( buffer->getData(), mParam.getValue(), buffer->getData(), buffer->getSize() );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ExpressionNode
+// ----------------------------------------------------------------------------------------------------
+
+struct ExpressionNode::Expr::Term {
+	Term( Op op ) : mOp( op ), mConstant( 0 ), mParamIndex( 0 )	{}
+
+	Op							mOp;
+	float						mConstant;
+	size_t						mParamIndex;
+	std::shared_ptr<const Term>	mLhs, mRhs;
+};
+
+ExpressionNode::Expr::Expr( float constant )
+{
+	auto term = std::make_shared<Term>( Op::CONSTANT );
+	term->mConstant = constant;
+	mTerm = term;
+}
+
+ExpressionNode::Expr::Expr( Op op, size_t paramIndex )
+{
+	auto term = std::make_shared<Term>( op );
+	term->mParamIndex = paramIndex;
+	mTerm = term;
+}
+
+ExpressionNode::Expr::Expr( Op op, const Expr &lhs, const Expr &rhs )
+{
+	auto term = std::make_shared<Term>( op );
+	term->mLhs = lhs.mTerm;
+	term->mRhs = rhs.mTerm;
+	mTerm = term;
+}
+
+// Turns a tree of Term's into a Program. Each arithmetic Term first becomes a Step, numbered in the order it is compiled (so a Step's
+// operands always come before it), then Step's are fused, ordered by phase and assigned registers as they are emitted.
+struct ExpressionNode::Compiler {
+	struct Step {
+		Op		mOp;
+		Operand	mOperands[3];
+		bool	mPerChannel, mFused;
+		size_t	mNumUses, mLastUse, mRegister;
+	};
+
+	Compiler( size_t numParams ) : mNumParams( numParams )	{}
+
+	Program	compile( const Term *root );
+	Operand	compileTerm( const Term *term );
+	void	fuseMultiplyAdds();
+	bool	isPerChannel( const Operand &operand ) const;
+
+	static size_t	getNumOperands( Op op )					{ return op == Op::MULTIPLY_ADD ? 3 : 2; }
+	static bool		isConstant( const Operand &operand, float value )	{ return operand.mSource == Source::CONSTANT && operand.mConstant == value; }
+	static Operand	makeOperand( Source source, float constant = 0, size_t index = 0 );
+	static float	evaluate( Op op, float lhs, float rhs );
+
+	size_t								mNumParams;
+	std::vector<Step>					mSteps;
+	std::map<const Term*, Operand>		mCompiledTerms;
+};
+
+ExpressionNode::Operand ExpressionNode::Compiler::makeOperand( Source source, float constant, size_t index )
+{
+	Operand result;
+	result.mSource = source;
+	result.mConstant = constant;
+	result.mIndex = index;
+	return result;
+}
+
+float ExpressionNode::Compiler::evaluate( Op op, float lhs, float rhs )
+{
+	switch( op ) {
+		case Op::ADD:		return lhs + rhs;
+		case Op::SUBTRACT:	return lhs - rhs;
+		case Op::MULTIPLY:	return lhs * rhs;
+		case Op::DIVIDE:	return lhs / rhs;
+		default:			CI_ASSERT_NOT_REACHABLE(); return 0;
+	}
+}
+
+bool ExpressionNode::Compiler::isPerChannel( const Operand &operand ) const
+{
+	if( operand.mSource == Source::INPUT )
+		return true;
+	if( operand.mSource == Source::REGISTER )
+		return mSteps[operand.mIndex].mPerChannel;
+
+	return false;
+}
+
+ExpressionNode::Operand ExpressionNode::Compiler::compileTerm( const Term *term )
+{
+	// a Term that is shared within the expression is only compiled once
+	auto compiledIt = mCompiledTerms.find( term );
+	if( compiledIt != mCompiledTerms.end() )
+		return compiledIt->second;
+
+	Operand result;
+	switch( term->mOp ) {
+		case Op::CONSTANT:
+			result = makeOperand( Source::CONSTANT, term->mConstant );
+			break;
+		case Op::INPUT:
+			result = makeOperand( Source::INPUT );
+			break;
+		case Op::PARAM:
+			if( term->mParamIndex >= mNumParams )
+				throw AudioExc( "expression refers to param " + std::to_string( term->mParamIndex ) + ", ExpressionNode only has " + std::to_string( mNumParams ) );
+
+			result = makeOperand( Source::PARAM, 0, term->mParamIndex );
+			break;
+		default: {
+			Operand lhs = compileTerm( term->mLhs.get() );
+			Operand rhs = compileTerm( term->mRhs.get() );
+			Op op = term->mOp;
+
+			if( lhs.mSource == Source::CONSTANT && rhs.mSource == Source::CONSTANT )
+				result = makeOperand( Source::CONSTANT, evaluate( op, lhs.mConstant, rhs.mConstant ) );
+			else if( ( op == Op::ADD || op == Op::SUBTRACT ) && isConstant( rhs, 0 ) )
+				result = lhs;
+			else if( op == Op::ADD && isConstant( lhs, 0 ) )
+				result = rhs;
+			else if( ( op == Op::MULTIPLY || op == Op::DIVIDE ) && isConstant( rhs, 1 ) )
+				result = lhs;
+			else if( op == Op::MULTIPLY && isConstant( lhs, 1 ) )
+				result = rhs;
+			else {
+				Step step;
+				step.mOp = op;
+				step.mOperands[0] = lhs;
+				step.mOperands[1] = rhs;
+				step.mOperands[2] = makeOperand( Source::CONSTANT );
+				step.mPerChannel = isPerChannel( lhs ) || isPerChannel( rhs );
+				step.mFused = false;
+				step.mNumUses = 0;
+				step.mLastUse = 0;
+				step.mRegister = 0;
+
+				mSteps.push_back( step );
+				result = makeOperand( Source::REGISTER, 0, mSteps.size() - 1 );
+			}
+		}
+	}
+
+	mCompiledTerms[term] = result;
+	return result;
+}
+
+// An ADD whose operand is a MULTIPLY used nowhere else, and evaluated in the same phase, becomes a single MULTIPLY_ADD.
+void ExpressionNode::Compiler::fuseMultiplyAdds()
+{
+	for( auto &step : mSteps ) {
+		if( step.mOp != Op::ADD )
+			continue;
+
+		for( size_t i = 0; i < 2; i++ ) {
+			const Operand &operand = step.mOperands[i];
+			if( operand.mSource != Source::REGISTER )
+				continue;
+
+			Step &product = mSteps[operand.mIndex];
+			if( product.mOp != Op::MULTIPLY || product.mNumUses != 1 || product.mPerChannel != step.mPerChannel )
+				continue;
+
+			Operand addend = step.mOperands[1 - i];
+			step.mOp = Op::MULTIPLY_ADD;
+			step.mOperands[0] = product.mOperands[0];
+			step.mOperands[1] = product.mOperands[1];
+			step.mOperands[2] = addend;
+			product.mFused = true;
+			break;
+		}
+	}
+}
+
+ExpressionNode::Program ExpressionNode::Compiler::compile( const Term *root )
+{
+	const size_t neverFreed = std::numeric_limits<size_t>::max();
+
+	Operand result = compileTerm( root );
+
+	for( const auto &step : mSteps ) {
+		for( size_t i = 0; i < 2; i++ ) {
+			if( step.mOperands[i].mSource == Source::REGISTER )
+				mSteps[step.mOperands[i].mIndex].mNumUses++;
+		}
+	}
+	if( result.mSource == Source::REGISTER )
+		mSteps[result.mIndex].mNumUses++;
+
+	fuseMultiplyAdds();
+
+	// steps that don't depend on the input only depend on each other, so they can all run before the per-channel steps
+	std::vector<size_t> order;
+	for( size_t i = 0; i < mSteps.size(); i++ ) {
+		if( ! mSteps[i].mFused && ! mSteps[i].mPerChannel )
+			order.push_back( i );
+	}
+	for( size_t i = 0; i < mSteps.size(); i++ ) {
+		if( ! mSteps[i].mFused && mSteps[i].mPerChannel )
+			order.push_back( i );
+	}
+
+	// a register can be reused after the last step that reads it, except when a per-block value is read by per-channel steps,
+	// which are run again for every channel
+	for( size_t pos = 0; pos < order.size(); pos++ ) {
+		const Step &step = mSteps[order[pos]];
+		for( size_t i = 0; i < getNumOperands( step.mOp ); i++ ) {
+			const Operand &operand = step.mOperands[i];
+			if( operand.mSource != Source::REGISTER )
+				continue;
+
+			Step &producer = mSteps[operand.mIndex];
+			if( step.mPerChannel && ! producer.mPerChannel )
+				producer.mLastUse = neverFreed;
+			else if( producer.mLastUse != neverFreed )
+				producer.mLastUse = pos;
+		}
+	}
+	if( result.mSource == Source::REGISTER )
+		mSteps[result.mIndex].mLastUse = neverFreed;
+
+	Program program;
+	program.mNumRegisters = 0;
+	std::vector<size_t> freeRegisters;
+
+	for( size_t pos = 0; pos < order.size(); pos++ ) {
+		Step &step = mSteps[order[pos]];
+		const size_t numOperands = getNumOperands( step.mOp );
+
+		Instruction instruction;
+		instruction.mOp = step.mOp;
+		for( size_t i = 0; i < 3; i++ ) {
+			instruction.mOperands[i] = step.mOperands[i];
+			if( i < numOperands && step.mOperands[i].mSource == Source::REGISTER )
+				instruction.mOperands[i].mIndex = mSteps[step.mOperands[i].mIndex].mRegister;
+		}
+
+		auto releaseOperands = [&] {
+			for( size_t i = 0; i < numOperands; i++ ) {
+				const Operand &operand = step.mOperands[i];
+				if( operand.mSource != Source::REGISTER || mSteps[operand.mIndex].mLastUse != pos )
+					continue;
+
+				bool released = false;
+				for( size_t j = 0; j < i; j++ ) {
+					if( step.mOperands[j].mSource == Source::REGISTER && step.mOperands[j].mIndex == operand.mIndex )
+						released = true;
+				}
+				if( ! released )
+					freeRegisters.push_back( mSteps[operand.mIndex].mRegister );
+			}
+		};
+
+		auto allocateRegister = [&]() -> size_t {
+			if( freeRegisters.empty() )
+				return program.mNumRegisters++;
+
+			size_t reg = freeRegisters.back();
+			freeRegisters.pop_back();
+			return reg;
+		};
+
+		// operations are elementwise so they may write over one of their operands, but MULTIPLY_ADD writes the product
+		// before reading the addend
+		if( step.mOp == Op::MULTIPLY_ADD ) {
+			step.mRegister = allocateRegister();
+			releaseOperands();
+		}
+		else {
+			releaseOperands();
+			step.mRegister = allocateRegister();
+		}
+
+		instruction.mDest = step.mRegister;
+		if( step.mPerChannel )
+			program.mChannelInstructions.push_back( instruction );
+		else
+			program.mBlockInstructions.push_back( instruction );
+	}
+
+	program.mResult = result;
+	if( result.mSource == Source::REGISTER )
+		program.mResult.mIndex = mSteps[result.mIndex].mRegister;
+
+	return program;
+}
+
+ExpressionNode::ExpressionNode( size_t numParams, const Format &format )
+	: Node( format ), mParamsVarying( numParams, 0 )
+{
+	for( size_t i = 0; i < numParams; i++ )
+		mParams.push_back( std::unique_ptr<Param>( new Param( this ) ) );
+
+	setExpression( input() );
+}
+
+ExpressionNode::Expr ExpressionNode::input()
+{
+	return Expr( Op::INPUT, 0 );
+}
+
+ExpressionNode::Expr ExpressionNode::param( size_t index )
+{
+	return Expr( Op::PARAM, index );
+}
+
+void ExpressionNode::setExpression( const Expr &expr )
+{
+	Program program = Compiler( mParams.size() ).compile( expr.mTerm.get() );
+
+	// the Program is swapped in between processing blocks
+	std::unique_lock<std::mutex> lock;
+	auto ctx = getContext();
+	if( ctx )
+		lock = std::unique_lock<std::mutex>( ctx->getMutex() );
+
+	mProgram = std::move( program );
+	if( isInitialized() )
+		allocateRegisters();
+}
+
+void ExpressionNode::initialize()
+{
+	allocateRegisters();
+}
+
+void ExpressionNode::allocateRegisters()
+{
+	mRegisters.setSize( getFramesPerBlock(), mProgram.mNumRegisters );
+	mRegisterValues.resize( mProgram.mNumRegisters );
+}
+
+void ExpressionNode::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+
+	for( size_t i = 0; i < mParams.size(); i++ )
+		mParamsVarying[i] = mParams[i]->eval();
+
+	for( const auto &instruction : mProgram.mBlockInstructions )
+		execute( instruction, nullptr, numFrames );
+
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+		float *channel = buffer->getChannel( ch );
+		for( const auto &instruction : mProgram.mChannelInstructions )
+			execute( instruction, channel, numFrames );
+
+		Value result = resolve( mProgram.mResult, channel );
+		if( ! result.mArray )
+			dsp::fill( result.mScalar, channel, numFrames );
+		else if( result.mArray != channel )
+			memcpy( channel, result.mArray, numFrames * sizeof( float ) );
+	}
+}
+
+ExpressionNode::Value ExpressionNode::resolve( const Operand &operand, const float *inputChannel )
+{
+	Value result = { nullptr, 0 };
+	switch( operand.mSource ) {
+		case Source::CONSTANT:
+			result.mScalar = operand.mConstant;
+			break;
+		case Source::INPUT:
+			result.mArray = inputChannel;
+			break;
+		case Source::PARAM:
+			if( mParamsVarying[operand.mIndex] )
+				result.mArray = mParams[operand.mIndex]->getValueArray();
+			else
+				result.mScalar = mParams[operand.mIndex]->getValue();
+			break;
+		case Source::REGISTER:
+			result = mRegisterValues[operand.mIndex];
+			break;
+	}
+
+	return result;
+}
+
+void ExpressionNode::execute( const Instruction &instruction, const float *inputChannel, size_t numFrames )
+{
+	Value lhs = resolve( instruction.mOperands[0], inputChannel );
+	Value rhs = resolve( instruction.mOperands[1], inputChannel );
+	float *dest = mRegisters.getChannel( instruction.mDest );
+
+	Value result = { dest, 0 };
+	if( instruction.mOp == Op::MULTIPLY_ADD ) {
+		Value addend = resolve( instruction.mOperands[2], inputChannel );
+		if( lhs.mArray && ! rhs.mArray && ! addend.mArray )
+			dsp::mulAdd( lhs.mArray, rhs.mScalar, addend.mScalar, dest, numFrames );
+		else if( ! lhs.mArray && rhs.mArray && ! addend.mArray )
+			dsp::mulAdd( rhs.mArray, lhs.mScalar, addend.mScalar, dest, numFrames );
+		else
+			result = apply( Op::ADD, apply( Op::MULTIPLY, lhs, rhs, dest, numFrames ), addend, dest, numFrames );
+	}
+	else
+		result = apply( instruction.mOp, lhs, rhs, dest, numFrames );
+
+	mRegisterValues[instruction.mDest] = result;
+}
+
+ExpressionNode::Value ExpressionNode::apply( Op op, const Value &lhs, const Value &rhs, float *dest, size_t numFrames )
+{
+	Value result = { dest, 0 };
+	if( ! lhs.mArray && ! rhs.mArray ) {
+		result.mArray = nullptr;
+		result.mScalar = Compiler::evaluate( op, lhs.mScalar, rhs.mScalar );
+		return result;
+	}
+
+	switch( op ) {
+		case Op::ADD:
+			if( ! rhs.mArray )
+				dsp::add( lhs.mArray, rhs.mScalar, dest, numFrames );
+			else if( ! lhs.mArray )
+				dsp::add( rhs.mArray, lhs.mScalar, dest, numFrames );
+			else
+				dsp::add( lhs.mArray, rhs.mArray, dest, numFrames );
+			break;
+		case Op::SUBTRACT:
+			if( ! rhs.mArray )
+				dsp::sub( lhs.mArray, rhs.mScalar, dest, numFrames );
+			else if( ! lhs.mArray )
+				dsp::mulAdd( rhs.mArray, -1, lhs.mScalar, dest, numFrames );
+			else
+				dsp::sub( lhs.mArray, rhs.mArray, dest, numFrames );
+			break;
+		case Op::MULTIPLY:
+			if( ! rhs.mArray )
+				dsp::mul( lhs.mArray, rhs.mScalar, dest, numFrames );
+			else if( ! lhs.mArray )
+				dsp::mul( rhs.mArray, lhs.mScalar, dest, numFrames );
+			else
+				dsp::mul( lhs.mArray, rhs.mArray, dest, numFrames );
+			break;
+		case Op::DIVIDE:
+			if( ! rhs.mArray )
+				dsp::divide( lhs.mArray, rhs.mScalar, dest, numFrames );
+			else if( ! lhs.mArray ) {
+				for( size_t i = 0; i < numFrames; i++ )
+					dest[i] = lhs.mScalar / rhs.mArray[i];
+			}
+			else
+				dsp::divide( lhs.mArray, rhs.mArray, dest, numFrames );
+			break;
+		default:
+			CI_ASSERT_NOT_REACHABLE();
+	}
+
+	return result;
+}
+
 } } // namespace cinder::audio
@@ -34,47 +34,76 @@ namespace cinder { namespace audio {
 
 void rampLinear( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	float range = valueRange.second - valueRange.first;
+	dsp::ramp( valueRange.first + range * t, range * tIncr, array, count );
 }
 
 void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = t * t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	// value = first + range * t^2
+	float range = valueRange.second - valueRange.first;
+	dsp::ramp( t, tIncr, array, count );
+	dsp::mul( array, array, array, count );
+	dsp::mulAdd( array, range, valueRange.first, array, count );
 }
 
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = -t * ( t - 2 );
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	// value = first + range * t * ( 2 - t ), which is evaluated as second - range * ( 1 - t )^2
+	float range = valueRange.second - valueRange.first;
+	dsp::ramp( 1 - t, -tIncr, array, count );
+	dsp::mul( array, array, array, count );
+	dsp::mulAdd( array, -range, valueRange.second, array, count );
 }
 
+namespace {
+
+typedef void (*RampFnPtr)( float *, size_t, float, float, const std::pair<float, float>& );
+
+} // anonymous namespace
+
 Event::Event( float timeBegin, float timeEnd, float valueBegin, float valueEnd, bool copyValueOnBegin, const RampFn &rampFn )
 	: mTimeBegin( timeBegin ), mTimeEnd( timeEnd ), mDuration( timeEnd - timeBegin ), mCopyValueOnBegin( copyValueOnBegin ),
-		mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false )
+		mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false ), mRampType( RampType::CUSTOM )
 {
+	const RampFnPtr *rampFnPtr = mRampFn.target<RampFnPtr>();
+	if( rampFnPtr ) {
+		if( *rampFnPtr == rampLinear )
+			mRampType = RampType::LINEAR;
+		else if( *rampFnPtr == rampInQuad )
+			mRampType = RampType::IN_QUAD;
+		else if( *rampFnPtr == rampOutQuad )
+			mRampType = RampType::OUT_QUAD;
+	}
+}
+
+void Event::rampImpl( float *array, size_t count, float t, float tIncr ) const
+{
+	const pair<float, float> valueRange( mValueBegin, mValueEnd );
+
+	switch( mRampType ) {
+		case RampType::LINEAR:		rampLinear( array, count, t, tIncr, valueRange );	break;
+		case RampType::IN_QUAD:		rampInQuad( array, count, t, tIncr, valueRange );	break;
+		case RampType::OUT_QUAD:	rampOutQuad( array, count, t, tIncr, valueRange );	break;
+		default:					mRampFn( array, count, t, tIncr, valueRange );		break;
+	}
 }
 
 Param::Param( Node *parentNode, float initialValue )
-	: mParentNode( parentNode ), mValue( initialValue ), mIsVaryingThisBlock( false )
+	: mParentNode( parentNode ), mValue( initialValue ), mIsVaryingThisBlock( false ), mIsControlRate( false )
 {
 }
 
 void Param::setValue( float value )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
-	resetImpl();
+	// mValue is stored immediately so that getValue() reflects it, the Event's are discarded on the audio thread
 	mValue = value;
+
+	NodeRef parentNode = mParentNode->shared_from_this();
+	getContext()->postCommand( [this, parentNode, value] {
+		resetImpl();
+		mValue = value;
+	} );
 }
 
 EventRef Param::applyRamp( float valueEnd, float rampSeconds, const Options &options )
@@ -87,13 +116,7 @@ EventRef Param::applyRamp( float valueEnd, float rampSeconds, const Options &opt
 
 	EventRef event( new Event( timeBegin, timeEnd, mValue, valueEnd, true, options.getRampFn() ) );
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-
-	removeEventsAt( timeBegin );
-	if( mProcessor )
-		mProcessor.reset();
-
-	mEvents.push_back( event );
+	postApplyEvent( event );
 	return event;
 }
 
@@ -107,13 +130,7 @@ EventRef Param::applyRamp( float valueBegin, float valueEnd, float rampSeconds,
 
 	EventRef event( new Event( timeBegin, timeEnd, valueBegin, valueEnd, false, options.getRampFn() ) );
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-
-	removeEventsAt( timeBegin );
-	if( mProcessor )
-		mProcessor.reset();
-
-	mEvents.push_back( event );
+	postApplyEvent( event );
 	return event;
 }
 
@@ -156,16 +173,23 @@ void Param::setProcessor( const NodeRef &node )
 
 	initInternalBuffer();
 
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
 
-	resetImpl();
+		resetImpl();
 
-	// force node to be mono and initialize it
-	node->setNumChannels( 1 );
-	node->initializeImpl();
+		// force node to be mono and initialize it
+		node->setNumChannels( 1 );
+		node->initializeImpl();
 
-	mProcessor = node;
-	mIsVaryingThisBlock = true; // stays true until there is no more processor and eval() sets this to false.
+		mProcessor = node;
+		mIsVaryingThisBlock = true; // stays true until there is no more processor and eval() sets this to false.
+
+		// the processor is pulled from the parent Node's process(), so it can't share buffers with the rest of the graph
+		node->mIsParamProcessor = true;
+	}
+
+	getContext()->compileGraph();
 }
 
 void Param::reset()
@@ -226,7 +250,11 @@ bool Param::eval()
 	}
 	else {
 		auto ctx = getContext();
-		mIsVaryingThisBlock = eval( (float)ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+		if( mIsControlRate )
+			mIsVaryingThisBlock = evalControlRate( (float)ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+		else
+			mIsVaryingThisBlock = eval( (float)ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+
 		return mIsVaryingThisBlock;
 	}
 }
@@ -269,7 +297,7 @@ bool Param::eval( float timeBegin, float *array, size_t arrayLength, size_t samp
 			if( event->getCopyValueOnBegin() )
 				event->setValueBegin( mValue ); // this is only copied the first block the Event is processed, as next block getCopyValueOnBegin() is false.
 
-			event->mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, make_pair( event->mValueBegin, event->mValueEnd ) );
+			event->rampImpl( array + startIndex, count, timeBeginNormalized, timeIncr );
 			samplesWritten += count;
 
 			// if this ramp ended with the current processing block, update mValue then remove event
@@ -326,6 +354,52 @@ void Param::removeEventsAt( float time )
 	} );
 }
 
+void Param::postApplyEvent( const EventRef &event )
+{
+	// The list node is allocated here and spliced into mEvents on the audio thread. Replaced Event's are spliced back
+	// into the same list, so that they are deallocated along with the command on a non-audio thread.
+	shared_ptr<list<EventRef> > events( new list<EventRef>( 1, event ) );
+	NodeRef parentNode = mParentNode->shared_from_this();
+
+	getContext()->postCommand( [this, parentNode, events] {
+		const float timeBegin = events->front()->getTimeBegin();
+		for( auto eventIt = mEvents.begin(); eventIt != mEvents.end(); ) {
+			auto current = eventIt++;
+			if( (*current)->getTimeEnd() >= timeBegin ) {
+				(*current)->cancel();
+				events->splice( events->end(), mEvents, current );
+			}
+		}
+
+		mEvents.splice( mEvents.end(), *events, events->begin() );
+		mProcessor.reset();
+	} );
+}
+
+bool Param::evalControlRate( float timeBegin, float *array, size_t arrayLength, size_t sampleRate )
+{
+	if( mEvents.empty() || ! arrayLength )
+		return false;
+
+	// evaluate a single sample at the last frame of this block, then interpolate to it from the value at the end of the previous block
+	const float valueBegin = mValue;
+	const float timeLastFrame = timeBegin + float( arrayLength - 1 ) / (float)sampleRate;
+
+	float valueEnd;
+	if( ! eval( timeLastFrame, &valueEnd, 1, sampleRate ) ) {
+		// Event's may have completed or been removed without being evaluated, in which case mValue holds their end value
+		valueEnd = mValue;
+		if( valueEnd == valueBegin )
+			return false;
+	}
+
+	mValue = valueEnd;
+
+	const float increment = ( valueEnd - valueBegin ) / (float)arrayLength;
+	dsp::ramp( valueBegin + increment, increment, array, arrayLength );
+	return true;
+}
+
 void Param::initInternalBuffer()
 {
 	if( mInternalBuffer.isEmpty() )
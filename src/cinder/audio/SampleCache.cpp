@@ -0,0 +1,627 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/SampleCache.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/Debug.h"
+#include "cinder/TaskPool.h"
+#include "cinder/Utilities.h"
+
+#include <fstream>
+#include <sstream>
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+	#include "cinder/Unicode.h"
+#elif ! defined( CINDER_WINRT )
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const uint32_t CACHE_FILE_VERSION = 1;
+
+// The header occupies the first 64 bytes of a cache file so that the channel data that follows it stays 16-byte aligned.
+// Channels are stored one after another (planar), each as getNumFrames() 32-bit floats.
+struct CacheFileHeader {
+	char		mMagic[4];
+	uint32_t	mVersion;
+	uint32_t	mNumChannels;
+	uint32_t	mSampleRate;
+	uint64_t	mNumFrames;
+	uint8_t		mReserved[40];
+};
+
+static_assert( sizeof( CacheFileHeader ) == 64, "unexpected CacheFileHeader size" );
+
+const char CACHE_FILE_MAGIC[4] = { 'C', 'I', 'S', 'M' };
+
+const fs::path& getBufferCachePath( const DataSourceRef &dataSource )
+{
+	const fs::path &result = dataSource->getFilePath();
+	if( result.empty() )
+		throw AudioFileExc( "BufferCache requires a file-based DataSource" );
+
+	return result;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - MappedSample
+// ----------------------------------------------------------------------------------------------------
+
+MappedSample::MappedSample( const fs::path &cacheFilePath, size_t numChannels, size_t numFrames, size_t sampleRate )
+	: mCacheFilePath( cacheFilePath ), mNumChannels( numChannels ), mNumFrames( numFrames ), mSampleRate( sampleRate ),
+		mReady( false ), mChannelData( nullptr ), mMappedData( nullptr ), mMappedSize( 0 )
+#if defined( CINDER_MSW )
+		, mFileHandle( INVALID_HANDLE_VALUE ), mMappingHandle( NULL )
+#endif
+{
+}
+
+MappedSample::~MappedSample()
+{
+	unmap();
+}
+
+bool MappedSample::map()
+{
+#if defined( CINDER_MSW )
+	std::u16string widePath = toUtf16( mCacheFilePath.string() );
+	HANDLE file = ::CreateFileW( (wchar_t *)widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = NULL;
+	void *data = nullptr;
+	if( ::GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart >= (LONGLONG)sizeof( CacheFileHeader ) )
+		mapping = ::CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mapping )
+		data = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+	if( ! data ) {
+		if( mapping )
+			::CloseHandle( mapping );
+		::CloseHandle( file );
+		return false;
+	}
+
+	mFileHandle = file;
+	mMappingHandle = mapping;
+	mMappedData = data;
+	mMappedSize = (size_t)fileSize.QuadPart;
+#elif defined( CINDER_WINRT )
+	CI_LOG_E( "memory-mapped samples are not supported on WinRT" );
+	return false;
+#else
+	int fd = ::open( mCacheFilePath.string().c_str(), O_RDONLY );
+	if( fd < 0 )
+		return false;
+
+	struct stat fileStat;
+	void *data = MAP_FAILED;
+	if( ::fstat( fd, &fileStat ) == 0 && fileStat.st_size >= (off_t)sizeof( CacheFileHeader ) )
+		data = ::mmap( nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+
+	::close( fd ); // the mapping keeps its own reference to the file
+	if( data == MAP_FAILED )
+		return false;
+
+	mMappedData = data;
+	mMappedSize = (size_t)fileStat.st_size;
+#endif
+
+	// validate that the cache file is complete and matches the expected format
+	const CacheFileHeader *header = static_cast<const CacheFileHeader *>( mMappedData );
+	const uint64_t expectedSize = sizeof( CacheFileHeader ) + uint64_t( mNumChannels ) * mNumFrames * sizeof( float );
+	if( memcmp( header->mMagic, CACHE_FILE_MAGIC, sizeof( CACHE_FILE_MAGIC ) ) != 0 || header->mVersion != CACHE_FILE_VERSION
+			|| header->mNumChannels != mNumChannels || header->mSampleRate != mSampleRate || header->mNumFrames != mNumFrames
+			|| mMappedSize < expectedSize ) {
+		unmap();
+		return false;
+	}
+
+	mChannelData = reinterpret_cast<const float *>( static_cast<const char *>( mMappedData ) + sizeof( CacheFileHeader ) );
+	mReady = true;
+	return true;
+}
+
+void MappedSample::unmap()
+{
+	mReady = false;
+	mChannelData = nullptr;
+
+	if( ! mMappedData )
+		return;
+
+#if defined( CINDER_MSW )
+	::UnmapViewOfFile( mMappedData );
+	::CloseHandle( mMappingHandle );
+	::CloseHandle( mFileHandle );
+	mMappingHandle = NULL;
+	mFileHandle = INVALID_HANDLE_VALUE;
+#elif ! defined( CINDER_WINRT )
+	::munmap( mMappedData, mMappedSize );
+#endif
+
+	mMappedData = nullptr;
+	mMappedSize = 0;
+}
+
+// static
+void MappedSample::writeCacheFile( SourceFile *sourceFile, size_t numFrames, const fs::path &cacheFilePath )
+{
+	// decode into a temporary file that is renamed once complete, so that a partially written file is never mapped.
+	const fs::path tempPath( cacheFilePath.string() + ".partial" );
+	const size_t numChannels = sourceFile->getNumChannels();
+
+	{
+		ofstream stream( tempPath.string().c_str(), ios::binary | ios::trunc );
+		if( ! stream )
+			throw AudioFileExc( "could not open sample cache file for writing: " + tempPath.string() );
+
+		CacheFileHeader header;
+		memset( &header, 0, sizeof( header ) );
+		stream.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+
+		Buffer block( sourceFile->getMaxFramesPerRead(), numChannels );
+		sourceFile->seek( 0 );
+
+		size_t writePos = 0;
+		while( writePos < numFrames ) {
+			size_t readCount = min( sourceFile->read( &block ), numFrames - writePos );
+			if( ! readCount )
+				break;
+
+			for( size_t ch = 0; ch < numChannels; ch++ ) {
+				stream.seekp( sizeof( CacheFileHeader ) + ( uint64_t( ch ) * numFrames + writePos ) * sizeof( float ) );
+				stream.write( reinterpret_cast<const char *>( block.getChannel( ch ) ), readCount * sizeof( float ) );
+			}
+
+			writePos += readCount;
+		}
+
+		// if the decoder delivered fewer frames than reported, extend the file so the missing frames read as silence.
+		if( writePos < numFrames && numChannels ) {
+			const float zero = 0;
+			stream.seekp( sizeof( CacheFileHeader ) + ( uint64_t( numChannels ) * numFrames - 1 ) * sizeof( float ) );
+			stream.write( reinterpret_cast<const char *>( &zero ), sizeof( zero ) );
+		}
+
+		memcpy( header.mMagic, CACHE_FILE_MAGIC, sizeof( CACHE_FILE_MAGIC ) );
+		header.mVersion = CACHE_FILE_VERSION;
+		header.mNumChannels = (uint32_t)numChannels;
+		header.mSampleRate = (uint32_t)sourceFile->getSampleRate();
+		header.mNumFrames = numFrames;
+		stream.seekp( 0 );
+		stream.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+
+		if( ! stream )
+			throw AudioFileExc( "failed writing sample cache file: " + tempPath.string() );
+	}
+
+	if( fs::exists( cacheFilePath ) )
+		fs::remove( cacheFilePath );
+	fs::rename( tempPath, cacheFilePath );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SampleCache
+// ----------------------------------------------------------------------------------------------------
+
+// static
+SampleCacheRef SampleCache::create( const fs::path &cacheDirectory )
+{
+	return SampleCacheRef( new SampleCache( cacheDirectory ) );
+}
+
+SampleCache::SampleCache( const fs::path &cacheDirectory )
+	: mCacheDirectory( cacheDirectory ), mNumDecoding( 0 ), mShouldQuit( false )
+{
+	if( ! fs::exists( mCacheDirectory ) )
+		fs::create_directories( mCacheDirectory );
+
+	mDecodeThread = unique_ptr<thread>( new thread( bind( &SampleCache::decodeThreadLoop, this ) ) );
+}
+
+SampleCache::~SampleCache()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mShouldQuit = true;
+	}
+
+	mDecodeCondition.notify_one();
+	mDecodeThread->join();
+}
+
+MappedSampleRef SampleCache::load( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	const fs::path sourcePath = dataSource->getFilePath();
+	if( sourcePath.empty() )
+		throw AudioFileExc( "SampleCache requires a file-based DataSource" );
+
+	SourceFileRef sourceFile = SourceFile::create( dataSource, sampleRate );
+
+	// the cache file name combines the source's name with a hash of everything that invalidates its decoded samples
+	stringstream key;
+	key << sourcePath.string() << "|" << fs::file_size( sourcePath ) << "|" << (int64_t)fs::last_write_time( sourcePath ) << "|" << sourceFile->getSampleRate();
+
+	stringstream fileName;
+	fileName << getPathFileName( sourcePath.string() ) << "_" << hex << std::hash<string>()( key.str() ) << ".cisamples";
+	const fs::path cacheFilePath = mCacheDirectory / fileName.str();
+
+	lock_guard<mutex> lock( mMutex );
+
+	for( auto sampleIt = mSamples.begin(); sampleIt != mSamples.end(); ) {
+		if( sampleIt->second.expired() )
+			sampleIt = mSamples.erase( sampleIt );
+		else
+			++sampleIt;
+	}
+
+	auto existingIt = mSamples.find( cacheFilePath );
+	if( existingIt != mSamples.end() )
+		return existingIt->second.lock();
+
+	MappedSampleRef sample( new MappedSample( cacheFilePath, sourceFile->getNumChannels(), sourceFile->getNumFrames(), sourceFile->getSampleRate() ) );
+	mSamples[cacheFilePath] = sample;
+
+	if( ! sample->map() ) {
+		DecodeJob job;
+		job.mSourceFile = sourceFile;
+		job.mSample = sample;
+		mDecodeJobs.push_back( job );
+		mDecodeCondition.notify_one();
+	}
+
+	return sample;
+}
+
+size_t SampleCache::getNumPendingDecodes() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mDecodeJobs.size() + mNumDecoding;
+}
+
+void SampleCache::decodeThreadLoop()
+{
+	while( true ) {
+		DecodeJob job;
+		{
+			unique_lock<mutex> lock( mMutex );
+			mDecodeCondition.wait( lock, [this] { return mShouldQuit || ! mDecodeJobs.empty(); } );
+			if( mShouldQuit )
+				return;
+
+			job = mDecodeJobs.front();
+			mDecodeJobs.pop_front();
+			mNumDecoding++;
+		}
+
+		try {
+			MappedSample::writeCacheFile( job.mSourceFile.get(), job.mSample->getNumFrames(), job.mSample->getCacheFilePath() );
+			if( ! job.mSample->map() )
+				CI_LOG_E( "failed to map sample cache file: " << job.mSample->getCacheFilePath() );
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_E( "failed to decode into sample cache, what: " << exc.what() );
+		}
+
+		lock_guard<mutex> lock( mMutex );
+		mNumDecoding--;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - BufferPreload
+// ----------------------------------------------------------------------------------------------------
+
+vector<BufferRef> BufferPreload::getBuffers() const
+{
+	vector<BufferRef> result;
+	result.reserve( mBuffers.size() );
+	for( const auto &buffer : mBuffers )
+		result.push_back( buffer.get() );
+
+	return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - BufferCache
+// ----------------------------------------------------------------------------------------------------
+
+// static
+BufferCacheRef BufferCache::create( size_t memoryBudgetBytes )
+{
+	return BufferCacheRef( new BufferCache( memoryBudgetBytes ) );
+}
+
+// static
+BufferCache* BufferCache::get()
+{
+	// Like TaskPool::get(), the shared cache is never destroyed so that decodes still running on the TaskPool can't outlive it.
+	static mutex sMutex;
+	static BufferCacheRef *sCache = nullptr;
+
+	lock_guard<mutex> lock( sMutex );
+	if( ! sCache )
+		sCache = new BufferCacheRef( create() );
+
+	return sCache->get();
+}
+
+BufferCache::BufferCache( size_t memoryBudgetBytes )
+	: mMemoryBudget( memoryBudgetBytes ), mMemoryUsage( 0 ), mNextId( 0 )
+{
+}
+
+BufferRef BufferCache::load( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	const Key key( getBufferCachePath( dataSource ), sampleRate );
+
+	shared_ptr<PendingDecode> pending;
+	bool isNew;
+	uint64_t id;
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		Entry &entry = acquireEntry( key, &isNew );
+		if( entry.mBuffer )
+			return entry.mBuffer;
+
+		if( isNew )
+			entry.mPending = make_shared<PendingDecode>();
+
+		pending = entry.mPending;
+		id = entry.mId;
+	}
+
+	if( isNew )
+		decode( dataSource, key, id, pending );
+
+	return pending->mFuture.get();
+}
+
+shared_future<BufferRef> BufferCache::loadAsync( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	const Key key( getBufferCachePath( dataSource ), sampleRate );
+
+	lock_guard<mutex> lock( mMutex );
+
+	bool isNew;
+	Entry &entry = acquireEntry( key, &isNew );
+	if( entry.mBuffer ) {
+		promise<BufferRef> ready;
+		ready.set_value( entry.mBuffer );
+		return ready.get_future().share();
+	}
+
+	if( isNew )
+		scheduleDecode( dataSource, key, &entry );
+
+	return entry.mPending->mFuture;
+}
+
+BufferPreloadRef BufferCache::preload( const vector<DataSourceRef> &dataSources, size_t sampleRate, const PreloadProgressFn &progressFn )
+{
+	BufferPreloadRef result( new BufferPreload );
+	result->mBuffers.reserve( dataSources.size() );
+
+	auto completionFn = [result, progressFn] {
+		size_t numCompleted = ++result->mNumCompleted;
+		if( progressFn )
+			progressFn( numCompleted, result->getNumSources() );
+	};
+
+	size_t numCached = 0;
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		for( const auto &dataSource : dataSources ) {
+			const Key key( getBufferCachePath( dataSource ), sampleRate );
+
+			bool isNew;
+			Entry &entry = acquireEntry( key, &isNew );
+			if( entry.mBuffer ) {
+				promise<BufferRef> ready;
+				ready.set_value( entry.mBuffer );
+				result->mBuffers.push_back( ready.get_future().share() );
+				numCached++;
+				continue;
+			}
+
+			if( isNew )
+				scheduleDecode( dataSource, key, &entry );
+
+			// the decode can't finish before this is added, since it takes the completion functions while holding mMutex.
+			entry.mPending->mCompletionFns.push_back( completionFn );
+			result->mBuffers.push_back( entry.mPending->mFuture );
+		}
+	}
+
+	for( size_t i = 0; i < numCached; i++ )
+		completionFn();
+
+	return result;
+}
+
+BufferRef BufferCache::find( const fs::path &filePath, size_t sampleRate )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto entryIt = mEntries.find( Key( filePath, sampleRate ) );
+	if( entryIt == mEntries.end() || ! entryIt->second.mBuffer )
+		return BufferRef();
+
+	mLru.splice( mLru.begin(), mLru, entryIt->second.mLruIt );
+	return entryIt->second.mBuffer;
+}
+
+void BufferCache::remove( const fs::path &filePath )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	// entries are ordered by path first, so all samplerates of filePath are adjacent.
+	auto entryIt = mEntries.lower_bound( Key( filePath, 0 ) );
+	while( entryIt != mEntries.end() && entryIt->first.first == filePath ) {
+		if( entryIt->second.mBuffer )
+			mMemoryUsage -= entryIt->second.mBuffer->getSize() * sizeof( float );
+
+		mLru.erase( entryIt->second.mLruIt );
+		entryIt = mEntries.erase( entryIt );
+	}
+}
+
+void BufferCache::clear()
+{
+	lock_guard<mutex> lock( mMutex );
+
+	mEntries.clear();
+	mLru.clear();
+	mMemoryUsage = 0;
+}
+
+void BufferCache::setMemoryBudget( size_t bytes )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	mMemoryBudget = bytes;
+	evict();
+}
+
+size_t BufferCache::getMemoryBudget() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMemoryBudget;
+}
+
+size_t BufferCache::getMemoryUsage() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMemoryUsage;
+}
+
+void BufferCache::scheduleDecode( const DataSourceRef &dataSource, const Key &key, Entry *entry )
+{
+	auto pending = make_shared<PendingDecode>();
+	entry->mPending = pending;
+
+	// the task holds a reference so that the cache outlives it
+	BufferCacheRef thisRef = shared_from_this();
+	uint64_t id = entry->mId;
+	TaskPool::get()->submit( [thisRef, dataSource, key, id, pending] {
+		thisRef->decode( dataSource, key, id, pending );
+	} );
+}
+
+BufferCache::Entry& BufferCache::acquireEntry( const Key &key, bool *isNew )
+{
+	auto entryIt = mEntries.find( key );
+	*isNew = ( entryIt == mEntries.end() );
+
+	if( *isNew ) {
+		mLru.push_front( key );
+		Entry &entry = mEntries[key];
+		entry.mLruIt = mLru.begin();
+		entry.mId = mNextId++;
+		return entry;
+	}
+
+	// mark as most recently used
+	mLru.splice( mLru.begin(), mLru, entryIt->second.mLruIt );
+	return entryIt->second;
+}
+
+void BufferCache::decode( const DataSourceRef &dataSource, const Key &key, uint64_t id, const shared_ptr<PendingDecode> &pending )
+{
+	BufferRef buffer;
+	exception_ptr error;
+	try {
+		buffer = SourceFile::create( dataSource, key.second )->loadBuffer();
+	}
+	catch( ... ) {
+		error = current_exception();
+	}
+
+	vector<function<void ()> > completionFns;
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		// if the entry was removed while decoding, the Buffer is still delivered but not cached.
+		auto entryIt = mEntries.find( key );
+		if( entryIt != mEntries.end() && entryIt->second.mId == id ) {
+			if( error ) {
+				// forget the failed entry so that a later load tries again.
+				mLru.erase( entryIt->second.mLruIt );
+				mEntries.erase( entryIt );
+			}
+			else {
+				entryIt->second.mBuffer = buffer;
+				entryIt->second.mPending.reset();
+				mMemoryUsage += buffer->getSize() * sizeof( float );
+				evict();
+			}
+		}
+
+		completionFns.swap( pending->mCompletionFns );
+	}
+
+	if( error )
+		pending->mPromise.set_exception( error );
+	else
+		pending->mPromise.set_value( buffer );
+
+	for( const auto &fn : completionFns )
+		fn();
+}
+
+void BufferCache::evict()
+{
+	auto lruIt = mLru.end();
+	while( mMemoryUsage > mMemoryBudget && lruIt != mLru.begin() ) {
+		--lruIt;
+
+		auto entryIt = mEntries.find( *lruIt );
+		const BufferRef &buffer = entryIt->second.mBuffer;
+
+		// pending decodes and Buffers that are still held by players are skipped, since dropping them wouldn't free any memory.
+		if( ! buffer || buffer.use_count() > 1 )
+			continue;
+
+		mMemoryUsage -= buffer->getSize() * sizeof( float );
+		lruIt = mLru.erase( lruIt );
+		mEntries.erase( entryIt );
+	}
+}
+
+} } // namespace cinder::audio
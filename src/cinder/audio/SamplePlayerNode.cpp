@@ -26,6 +26,8 @@
 #include "cinder/audio/Debug.h"
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+
 using namespace ci;
 using namespace std;
 
@@ -168,6 +170,16 @@ void BufferPlayerNode::setBuffer( const BufferRef &buffer )
 		mLoopEnd = mNumFrames;
 }
 
+void BufferPlayerNode::swapBufferImpl( BufferRef &buffer )
+{
+	CI_ASSERT( ! buffer || buffer->getNumChannels() == getNumChannels() );
+
+	mBuffer.swap( buffer );
+	mNumFrames = mBuffer ? mBuffer->getNumFrames() : 0;
+	mLoopBegin = 0;
+	mLoopEnd = mNumFrames;
+}
+
 void BufferPlayerNode::loadBuffer( const SourceFileRef &sourceFile )
 {
 	size_t sampleRate = getSampleRate();
@@ -179,6 +191,15 @@ void BufferPlayerNode::loadBuffer( const SourceFileRef &sourceFile )
 	}
 }
 
+void BufferPlayerNode::loadBuffer( const DataSourceRef &dataSource )
+{
+	size_t sampleRate = getSampleRate();
+	if( dataSource->isFilePath() )
+		setBuffer( BufferCache::get()->load( dataSource, sampleRate ) );
+	else
+		setBuffer( SourceFile::create( dataSource, sampleRate )->loadBuffer() );
+}
+
 void BufferPlayerNode::process( Buffer *buffer )
 {
 	const auto &frameRange = getProcessFramesRange();
@@ -209,18 +230,267 @@ void BufferPlayerNode::process( Buffer *buffer )
 		mReadPos += readCount;
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - MappedPlayerNode
+// ----------------------------------------------------------------------------------------------------
+
+MappedPlayerNode::MappedPlayerNode( const Format &format )
+	: SamplePlayerNode( format )
+{
+}
+
+MappedPlayerNode::MappedPlayerNode( const MappedSampleRef &sample, const Format &format )
+	: SamplePlayerNode( format ), mSample( sample )
+{
+	size_t numFrames = mSample ? mSample->getNumFrames() : 0;
+	mNumFrames = mLoopEnd = numFrames;
+
+	// force channel mode to match sample
+	if( mSample )
+		setNumChannels( mSample->getNumChannels() );
+}
+
+void MappedPlayerNode::enableProcessing()
+{
+	if( ! mSample ) {
+		disable();
+		return;
+	}
+
+	mIsEof = false;
+}
+
+void MappedPlayerNode::seek( size_t readPositionFrames )
+{
+	mIsEof = false;
+	mReadPos = math<size_t>::clamp( readPositionFrames, 0, mNumFrames );
+}
+
+void MappedPlayerNode::setSample( const MappedSampleRef &sample )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	if( sample ) {
+		if( getNumChannels() != sample->getNumChannels() ) {
+			setNumChannels( sample->getNumChannels() );
+			configureConnections();
+		}
+
+		mNumFrames = sample->getNumFrames();
+	}
+	else
+		mNumFrames = 0;
+
+	mSample = sample;
+
+	if( ! mLoopEnd || mLoopEnd > mNumFrames )
+		mLoopEnd = mNumFrames;
+}
+
+void MappedPlayerNode::process( Buffer *buffer )
+{
+	// the sample may still be decoding, in which case this block is silent.
+	if( ! mSample || ! mSample->isReady() )
+		return;
+
+	const auto &frameRange = getProcessFramesRange();
+
+	size_t readPos = mReadPos;
+	size_t numFrames = frameRange.second - frameRange.first;
+	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
+	size_t readCount = readEnd < readPos ? 0 : min( readEnd - readPos, numFrames );
+
+	copyFrames( buffer, frameRange.first, readPos, readCount );
+
+	if( readCount < numFrames  ) {
+		// End of File. If looping copy from beginning, otherwise disable and mark the mIsEof.
+		if( mLoop ) {
+			size_t readBegin = mLoopBegin;
+			size_t readLeft = min( numFrames - readCount, mNumFrames - readBegin );
+
+			copyFrames( buffer, frameRange.first + readCount, readBegin, readLeft );
+			mReadPos.store( readBegin + readLeft );
+		}
+		else {
+			mIsEof = true;
+			mReadPos = mNumFrames;
+			disable();
+		}
+	}
+	else
+		mReadPos += readCount;
+}
+
+void MappedPlayerNode::copyFrames( Buffer *buffer, size_t bufferOffset, size_t readPos, size_t numFrames )
+{
+	const size_t numChannels = min( buffer->getNumChannels(), mSample->getNumChannels() );
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		memcpy( buffer->getChannel( ch ) + bufferOffset, mSample->getChannel( ch ) + readPos, numFrames * sizeof( float ) );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FilePlayerReadPool
+// ----------------------------------------------------------------------------------------------------
+
+//! Services the asynchronous reads of all FilePlayerNode's with a fixed number of threads, neediest ring buffers first.
+class FilePlayerReadPool {
+  public:
+	//! Returns the shared pool, which is created on first use and destroyed along with the last FilePlayerNode that uses it.
+	static shared_ptr<FilePlayerReadPool> get();
+
+	FilePlayerReadPool();
+	~FilePlayerReadPool();
+
+	void add( FilePlayerNode *player );
+	//! Removes \a player, blocking until any read that is in flight for it has completed.
+	void remove( FilePlayerNode *player );
+	//! Called on the audio thread after a player has set its mReadRequested flag.
+	void requestRead();
+
+  private:
+	void			threadLoop();
+	FilePlayerNode*	claimNeediestPlayer(); // must be called with mMutex locked
+
+	vector<FilePlayerNode *>	mPlayers;
+	vector<thread>				mThreads;
+	mutex						mMutex;
+	condition_variable			mRequestCond, mIdleCond;
+	atomic<size_t>				mNumRequests;
+	bool						mShouldQuit;
+};
+
+namespace {
+
+mutex							sReadPoolMutex;
+weak_ptr<FilePlayerReadPool>	sReadPool;
+
+} // anonymous namespace
+
+// static
+shared_ptr<FilePlayerReadPool> FilePlayerReadPool::get()
+{
+	lock_guard<mutex> lock( sReadPoolMutex );
+
+	shared_ptr<FilePlayerReadPool> result = sReadPool.lock();
+	if( ! result ) {
+		result = make_shared<FilePlayerReadPool>();
+		sReadPool = result;
+	}
+
+	return result;
+}
+
+FilePlayerReadPool::FilePlayerReadPool()
+	: mNumRequests( 0 ), mShouldQuit( false )
+{
+	size_t numThreads = max<size_t>( thread::hardware_concurrency(), 1 );
+	for( size_t i = 0; i < numThreads; i++ )
+		mThreads.push_back( thread( bind( &FilePlayerReadPool::threadLoop, this ) ) );
+}
+
+FilePlayerReadPool::~FilePlayerReadPool()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mShouldQuit = true;
+	}
+
+	mRequestCond.notify_all();
+	for( auto &readThread : mThreads )
+		readThread.join();
+}
+
+void FilePlayerReadPool::add( FilePlayerNode *player )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	player->mReadRequested = false;
+	player->mReadInFlight = false;
+	mPlayers.push_back( player );
+}
+
+void FilePlayerReadPool::remove( FilePlayerNode *player )
+{
+	unique_lock<mutex> lock( mMutex );
+
+	mPlayers.erase( std::remove( mPlayers.begin(), mPlayers.end(), player ), mPlayers.end() );
+	mIdleCond.wait( lock, [player] { return ! player->mReadInFlight; } );
+
+	if( player->mReadRequested.exchange( false ) )
+		mNumRequests--;
+}
+
+void FilePlayerReadPool::requestRead()
+{
+	// The mutex isn't taken here, as this is called from the audio thread. If a read thread misses the notification
+	// it still picks up the request when its wait times out.
+	mNumRequests++;
+	mRequestCond.notify_one();
+}
+
+FilePlayerNode* FilePlayerReadPool::claimNeediestPlayer()
+{
+	if( ! mNumRequests )
+		return nullptr;
+
+	FilePlayerNode *result = nullptr;
+	float minFillRatio = 2;
+	for( FilePlayerNode *player : mPlayers ) {
+		if( ! player->mReadRequested || player->mReadInFlight )
+			continue;
+
+		float fillRatio = player->getRingBufferFillRatio();
+		if( fillRatio < minFillRatio ) {
+			minFillRatio = fillRatio;
+			result = player;
+		}
+	}
+
+	if( result )
+		result->mReadInFlight = true;
+
+	return result;
+}
+
+void FilePlayerReadPool::threadLoop()
+{
+	while( true ) {
+		FilePlayerNode *player = nullptr;
+		{
+			unique_lock<mutex> lock( mMutex );
+			while( ! mShouldQuit && ! ( player = claimNeediestPlayer() ) )
+				mRequestCond.wait_for( lock, chrono::milliseconds( 10 ) );
+
+			if( mShouldQuit )
+				return;
+		}
+
+		player->readAsyncImpl();
+
+		{
+			lock_guard<mutex> lock( mMutex );
+			player->mReadRequested = false;
+			player->mReadInFlight = false;
+			mNumRequests--;
+		}
+
+		mIdleCond.notify_all();
+	}
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - FilePlayerNode
 // ----------------------------------------------------------------------------------------------------
 
 FilePlayerNode::FilePlayerNode( const Format &format )
-	: SamplePlayerNode( format ), mRingBufferPaddingFactor( 2 ), mLastUnderrun( 0 ), mLastOverrun( 0 ), mIsReadAsync( true )
+	: SamplePlayerNode( format ), mRingBufferPaddingFactor( 2 ), mLastUnderrun( 0 ), mLastOverrun( 0 ), mIsReadAsync( true ),
+		mReadRequested( false ), mReadInFlight( false )
 {
 }
 
 FilePlayerNode::FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsync, const Format &format )
 	: SamplePlayerNode( format ), mSourceFile( sourceFile ), mIsReadAsync( isReadAsync ), mRingBufferPaddingFactor( 2 ),
-		mLastUnderrun( 0 ), mLastOverrun( 0 )
+		mLastUnderrun( 0 ), mLastOverrun( 0 ), mReadRequested( false ), mReadInFlight( false )
 {
 	if( mSourceFile ) {
 		mNumFrames = mSourceFile->getNumFrames();
@@ -233,7 +503,7 @@ FilePlayerNode::FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsyn
 FilePlayerNode::~FilePlayerNode()
 {
 	if( isInitialized() )
-		destroyReadThreadImpl();
+		removeFromReadPool();
 }
 
 void FilePlayerNode::initialize()
@@ -258,14 +528,14 @@ void FilePlayerNode::initialize()
 	mBufferFramesThreshold = mRingBuffers[0].getSize() / 2;
 
 	if( mIsReadAsync ) {
-		mAsyncReadShouldQuit = false;
-		mReadThread = unique_ptr<thread>( new thread( bind( &FilePlayerNode::readAsyncImpl, this ) ) );
+		mReadPool = FilePlayerReadPool::get();
+		mReadPool->add( this );
 	}
 }
 
 void FilePlayerNode::uninitialize()
 {
-	destroyReadThreadImpl();
+	removeFromReadPool();
 }
 
 void FilePlayerNode::enableProcessing()
@@ -289,15 +559,9 @@ void FilePlayerNode::stop()
 		stopImpl();
 	}
 	else {
-		auto ctx = getContext();
-		if( ! ctx->isAudioThread() ) {
-			lock_guard<mutex> lock( ctx->getMutex() );
-			stopImpl();
-		}
-		else {
-			// called from audio thread, lock is already held for the duration of this block
-			stopImpl();
-		}
+		// the file is read on the audio thread, so the stop is posted there instead of blocking it on the Context's mutex
+		NodeRef thisRef = shared_from_this();
+		getContext()->postCommand( [this, thisRef] { stopImpl(); } );
 	}
 }
 
@@ -308,15 +572,8 @@ void FilePlayerNode::seek( size_t readPositionFrames )
 		seekImpl( readPositionFrames );
 	}
 	else {
-		auto ctx = getContext();
-		if( ! ctx->isAudioThread() ) {
-			lock_guard<mutex> lock( ctx->getMutex() );
-			seekImpl( readPositionFrames );
-		}
-		else {
-			// called from audio thread, lock is already held for the duration of this block
-			seekImpl( readPositionFrames );
-		}
+		NodeRef thisRef = shared_from_this();
+		getContext()->postCommand( [this, thisRef, readPositionFrames] { seekImpl( readPositionFrames ); } );
 	}
 }
 
@@ -369,8 +626,10 @@ void FilePlayerNode::process( Buffer *buffer )
 	size_t numReadAvail = mRingBuffers[0].getAvailableRead();
 
 	if( numReadAvail < mBufferFramesThreshold ) {
-		if( mIsReadAsync )
-			mIssueAsyncReadCond.notify_one();
+		if( mIsReadAsync ) {
+			if( ! mReadRequested.exchange( true ) )
+				mReadPool->requestRead();
+		}
 		else
 			readImpl();
 	}
@@ -398,21 +657,17 @@ void FilePlayerNode::process( Buffer *buffer )
 
 void FilePlayerNode::readAsyncImpl()
 {
-	size_t lastReadPos = mReadPos;
-	while( true ) {
-		unique_lock<mutex> lock( mAsyncReadMutex );
-		mIssueAsyncReadCond.wait( lock );
-
-		if( mAsyncReadShouldQuit )
-			return;
+	// readImpl() seeks the SourceFile if mReadPos was changed by seek() or stop()
+	lock_guard<mutex> lock( mAsyncReadMutex );
+	readImpl();
+}
 
-		size_t readPos = mReadPos;
-		if( readPos != lastReadPos )
-			mSourceFile->seek( readPos );
+float FilePlayerNode::getRingBufferFillRatio() const
+{
+	if( mRingBuffers.empty() )
+		return 1;
 
-		readImpl();
-		lastReadPos = mReadPos;
-	}
+	return (float)mRingBuffers[0].getAvailableRead() / (float)mRingBuffers[0].getSize();
 }
 
 void FilePlayerNode::readImpl()
@@ -467,12 +722,11 @@ void FilePlayerNode::stopImpl()
 	seekImpl( 0 );
 }
 
-void FilePlayerNode::destroyReadThreadImpl()
+void FilePlayerNode::removeFromReadPool()
 {
-	if( mIsReadAsync && mReadThread ) {
-		mAsyncReadShouldQuit = true;
-		mIssueAsyncReadCond.notify_one();
-		mReadThread->join();
+	if( mReadPool ) {
+		mReadPool->remove( this );
+		mReadPool.reset();
 	}
 }
 
@@ -34,6 +34,7 @@ namespace cinder { namespace audio {
 namespace {
 
 const size_t DEFAULT_RECORD_BUFFER_FRAMES = 44100;
+const double DEFAULT_FILE_RECORDER_RING_BUFFER_SECONDS = 2;
 
 void resizeBufferAndShuffleChannels( BufferDynamic *buffer, size_t resultNumFrames )
 {
@@ -195,4 +196,169 @@ void BufferRecorderNode::process( Buffer *buffer )
 	mWritePos += numWriteFrames;
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileRecorderNode
+// ----------------------------------------------------------------------------------------------------
+
+FileRecorderNode::FileRecorderNode( const fs::path &filePath, SampleType sampleType, const Format &format )
+	: SampleRecorderNode( format ), mFilePath( filePath ), mSampleType( sampleType ), mRingBufferSeconds( DEFAULT_FILE_RECORDER_RING_BUFFER_SECONDS ),
+		mLastOverrun( 0 ), mIsRecording( false ), mWriterShouldQuit( false )
+{
+}
+
+FileRecorderNode::~FileRecorderNode()
+{
+	finishRecording();
+}
+
+void FileRecorderNode::initialize()
+{
+	const size_t numFrames = max( getFramesPerBlock() * 2, size_t( mRingBufferSeconds * (double)getSampleRate() ) );
+
+	mRingBuffers.clear();
+	for( size_t ch = 0; ch < getNumChannels(); ch++ )
+		mRingBuffers.emplace_back( numFrames );
+
+	// the writer thread wakes up once a quarter of the ring buffer is filled, and writes in chunks of that size.
+	mWriteBuffer.setSize( max<size_t>( numFrames / 4, 1 ), getNumChannels() );
+}
+
+void FileRecorderNode::uninitialize()
+{
+	// the channel count may be changing, which the open file can't follow, so the recording is finished here.
+	finishRecording();
+}
+
+void FileRecorderNode::setFilePath( const fs::path &filePath, SampleType sampleType )
+{
+	mFilePath = filePath;
+	mSampleType = sampleType;
+}
+
+void FileRecorderNode::start()
+{
+	if( mIsRecording )
+		stop();
+
+	if( ! isInitialized() )
+		initializeImpl();
+
+	mTarget = TargetFile::create( mFilePath, getSampleRate(), getNumChannels(), mSampleType );
+
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		for( auto &ringBuffer : mRingBuffers )
+			ringBuffer.clear();
+	}
+
+	mWritePos = 0;
+	mWriterShouldQuit = false;
+	mWriterThread = thread( &FileRecorderNode::writerThreadLoop, this );
+	mIsRecording = true;
+	enable();
+}
+
+void FileRecorderNode::stop()
+{
+	disable();
+	mIsRecording = false;
+
+	// wait for a block that may currently be processing, so it makes it into the file.
+	if( auto ctx = getContext() ) {
+		lock_guard<mutex> lock( ctx->getMutex() );
+	}
+
+	finishRecording();
+}
+
+void FileRecorderNode::finishRecording()
+{
+	mIsRecording = false;
+
+	if( mWriterThread.joinable() ) {
+		{
+			lock_guard<mutex> lock( mWriterMutex );
+			mWriterShouldQuit = true;
+		}
+		mWriterCond.notify_one();
+		mWriterThread.join();
+	}
+
+	// destroying the TargetFile finalizes and closes the file.
+	mTarget.reset();
+}
+
+uint64_t FileRecorderNode::getLastOverrun()
+{
+	uint64_t result = mLastOverrun;
+	mLastOverrun = 0;
+	return result;
+}
+
+void FileRecorderNode::process( Buffer *buffer )
+{
+	if( ! mIsRecording )
+		return;
+
+	const size_t numFrames = buffer->getNumFrames();
+
+	// The writer thread empties the channels in order, so the last ring buffer is the one with the least space available.
+	// Either the whole block is written to all channels or it is dropped, so that the channels stay aligned.
+	if( mRingBuffers.back().getAvailableWrite() < numFrames ) {
+		mLastOverrun = getContext()->getNumProcessedFrames();
+		return;
+	}
+
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ )
+		mRingBuffers[ch].write( buffer->getChannel( ch ), numFrames );
+
+	mWritePos += numFrames;
+
+	// The mutex isn't taken here, as this is the audio thread. If the writer thread misses the notification
+	// it still picks up the samples when its wait times out.
+	if( mRingBuffers.back().getAvailableRead() >= mWriteBuffer.getNumFrames() )
+		mWriterCond.notify_one();
+}
+
+void FileRecorderNode::writerThreadLoop()
+{
+	while( true ) {
+		bool shouldQuit;
+		{
+			unique_lock<mutex> lock( mWriterMutex );
+			if( ! mWriterShouldQuit && mRingBuffers.back().getAvailableRead() < mWriteBuffer.getNumFrames() )
+				mWriterCond.wait_for( lock, chrono::milliseconds( 100 ) );
+
+			shouldQuit = mWriterShouldQuit;
+		}
+
+		try {
+			writeAvailable();
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_E( "failed to write to file: " << mFilePath << ", what: " << exc.what() );
+			// the audio thread will report overruns from here on, since nothing is draining the ring buffers.
+			return;
+		}
+
+		if( shouldQuit )
+			return;
+	}
+}
+
+void FileRecorderNode::writeAvailable()
+{
+	// the audio thread fills the channels in order, so the last ring buffer is the one with the least samples available.
+	size_t numAvailable = mRingBuffers.back().getAvailableRead();
+
+	while( numAvailable ) {
+		const size_t numFrames = min( numAvailable, mWriteBuffer.getNumFrames() );
+		for( size_t ch = 0; ch < mRingBuffers.size(); ch++ )
+			mRingBuffers[ch].read( mWriteBuffer.getChannel( ch ), numFrames );
+
+		mTarget->write( &mWriteBuffer, numFrames );
+		numAvailable -= numFrames;
+	}
+}
+
 } } // namespace cinder::audio
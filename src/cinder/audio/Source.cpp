@@ -41,7 +41,7 @@ namespace cinder { namespace audio {
 // TODO: these should be replaced with a generic registrar derived from the ImageIo stuff.
 
 // static
-unique_ptr<SourceFile> SourceFile::create( const DataSourceRef &dataSource, size_t sampleRate )
+unique_ptr<SourceFile> SourceFile::create( const DataSourceRef &dataSource, size_t sampleRate, dsp::Converter::Quality converterQuality )
 {
 	unique_ptr<SourceFile> result;
 
@@ -55,8 +55,10 @@ unique_ptr<SourceFile> SourceFile::create( const DataSourceRef &dataSource, size
 #endif
 	}
 
-	if( result )
+	if( result ) {
+		result->mConverterQuality = converterQuality;
 		result->setupSampleRateConversion();
+	}
 
 	return result;
 }
@@ -88,8 +90,20 @@ Source::~Source()
 }
 
 SourceFile::SourceFile( size_t sampleRate )
-	: Source( sampleRate ), mNumFrames( 0 ), mFileNumFrames( 0 ), mReadPos( 0 )
+	: Source( sampleRate ), mNumFrames( 0 ), mFileNumFrames( 0 ), mReadPos( 0 ), mConverterQuality( dsp::Converter::Quality::BEST )
+{
+}
+
+void SourceFile::setConverterQuality( dsp::Converter::Quality quality )
 {
+	if( mConverterQuality == quality )
+		return;
+
+	mConverterQuality = quality;
+	if( mConverter ) {
+		setupSampleRateConversion();
+		seek( mReadPos );
+	}
 }
 
 void SourceFile::setupSampleRateConversion()
@@ -105,7 +119,7 @@ void SourceFile::setupSampleRateConversion()
 
 		if( ! supportsConversion() ) {
 			size_t numChannels = getNumChannels();
-			mConverter = audio::dsp::Converter::create( nativeSampleRate, outputSampleRate, numChannels, numChannels, getMaxFramesPerRead() );
+			mConverter = audio::dsp::Converter::create( nativeSampleRate, outputSampleRate, numChannels, numChannels, getMaxFramesPerRead(), mConverterQuality );
 			mConverterReadBuffer.setSize( getMaxFramesPerRead(), numChannels );
 		}
 	}
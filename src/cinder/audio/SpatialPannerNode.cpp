@@ -0,0 +1,279 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/SpatialPannerNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const float DEFAULT_FOCUS = 8;
+const size_t MAX_AMBISONIC_ORDER = 3;
+
+// Fills \a gains with the real spherical harmonics up to \a order for the unit direction (x, y, z), in ACN order with SN3D normalization.
+// The axes are the ambisonic convention: +x to the front, +y to the left and +z up.
+void computeAmbisonicGains( size_t order, float x, float y, float z, float *gains )
+{
+	gains[0] = 1;
+
+	gains[1] = y;
+	gains[2] = z;
+	gains[3] = x;
+	if( order < 2 )
+		return;
+
+	const float sqrt3 = 1.7320508f;
+	gains[4] = sqrt3 * x * y;
+	gains[5] = sqrt3 * y * z;
+	gains[6] = 0.5f * ( 3 * z * z - 1 );
+	gains[7] = sqrt3 * x * z;
+	gains[8] = 0.5f * sqrt3 * ( x * x - y * y );
+	if( order < 3 )
+		return;
+
+	const float sqrt5_8 = 0.7905694f, sqrt15 = 3.8729833f, sqrt3_8 = 0.6123724f;
+	gains[9] = sqrt5_8 * y * ( 3 * x * x - y * y );
+	gains[10] = sqrt15 * x * y * z;
+	gains[11] = sqrt3_8 * y * ( 5 * z * z - 1 );
+	gains[12] = 0.5f * z * ( 5 * z * z - 3 );
+	gains[13] = sqrt3_8 * x * ( 5 * z * z - 1 );
+	gains[14] = 0.5f * sqrt15 * z * ( x * x - y * y );
+	gains[15] = sqrt5_8 * x * ( x * x - 3 * y * y );
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpatialPannerNode::Source
+// ----------------------------------------------------------------------------------------------------
+
+struct SpatialPannerNode::Source {
+	Source( const NodeRef &input, const Vec3f &direction, float gain, size_t numChannels )
+		: mInput( input ), mDirectionX( direction.x ), mDirectionY( direction.y ), mDirectionZ( direction.z ), mGain( gain ),
+			mGeneration( 1 ), mProcessedGeneration( 0 ), mGains( numChannels, 0.0f ), mTargetGains( numChannels, 0.0f )
+	{}
+
+	NodeRef					mInput;
+	// written by the user thread, read on the audio thread once mGeneration changes.
+	std::atomic<float>		mDirectionX, mDirectionY, mDirectionZ, mGain;
+	std::atomic<uint32_t>	mGeneration;
+	// only used on the audio thread. mGains are the gains at the start of the current block.
+	uint32_t				mProcessedGeneration;
+	std::vector<float>		mGains, mTargetGains;
+};
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpatialPannerNode
+// ----------------------------------------------------------------------------------------------------
+
+SpatialPannerNode::SpatialPannerNode( const vector<Vec3f> &speakerDirections, const Format &format )
+	: Node( format ), mAmbisonicOrder( 0 ), mFocus( DEFAULT_FOCUS )
+{
+	for( const auto &direction : speakerDirections )
+		mSpeakerDirections.push_back( direction.safeNormalized() );
+
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( mSpeakerDirections.size() );
+}
+
+SpatialPannerNode::SpatialPannerNode( size_t ambisonicOrder, const Format &format )
+	: Node( format ), mAmbisonicOrder( ambisonicOrder ), mFocus( DEFAULT_FOCUS )
+{
+	if( ambisonicOrder < 1 || ambisonicOrder > MAX_AMBISONIC_ORDER )
+		throw AudioFormatExc( "ambisonic order must be between 1 and 3" );
+
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( ( ambisonicOrder + 1 ) * ( ambisonicOrder + 1 ) );
+}
+
+SpatialPannerNode::~SpatialPannerNode()
+{
+}
+
+bool SpatialPannerNode::supportsInputNumChannels( size_t numChannels ) const
+{
+	return true;
+}
+
+bool SpatialPannerNode::supportsProcessInPlace() const
+{
+	return false;
+}
+
+void SpatialPannerNode::addSource( const NodeRef &input, const Vec3f &direction, float gain )
+{
+	CI_ASSERT_MSG( input, "bad input" );
+
+	unique_ptr<Source> source( new Source( input, direction, gain, getNumChannels() ) );
+
+	input->connect( shared_from_this() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mSources.push_back( move( source ) );
+}
+
+void SpatialPannerNode::setSourceDirection( const NodeRef &input, const Vec3f &direction )
+{
+	Source *source = findSource( input );
+	CI_ASSERT_MSG( source, "input is not a source of this SpatialPannerNode" );
+
+	source->mDirectionX = direction.x;
+	source->mDirectionY = direction.y;
+	source->mDirectionZ = direction.z;
+	source->mGeneration++;
+}
+
+void SpatialPannerNode::setSourceGain( const NodeRef &input, float gain )
+{
+	Source *source = findSource( input );
+	CI_ASSERT_MSG( source, "input is not a source of this SpatialPannerNode" );
+
+	source->mGain = gain;
+	source->mGeneration++;
+}
+
+SpatialPannerNode::Source* SpatialPannerNode::findSource( const NodeRef &input ) const
+{
+	for( const auto &source : mSources ) {
+		if( source->mInput == input )
+			return source.get();
+	}
+
+	return nullptr;
+}
+
+void SpatialPannerNode::disconnectInput( const NodeRef &input )
+{
+	Node::disconnectInput( input );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	for( auto it = mSources.begin(); it != mSources.end(); ++it ) {
+		if( (*it)->mInput == input ) {
+			mSources.erase( it );
+			return;
+		}
+	}
+}
+
+void SpatialPannerNode::disconnectAllInputs()
+{
+	Node::disconnectAllInputs();
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mSources.clear();
+}
+
+void SpatialPannerNode::computeGains( const Vec3f &direction, float gain, float *gains ) const
+{
+	const size_t numChannels = getNumChannels();
+	const Vec3f dir = direction.lengthSquared() > 0 ? direction.normalized() : Vec3f( 0, 0, -1 );
+
+	if( mAmbisonicOrder ) {
+		computeAmbisonicGains( mAmbisonicOrder, -dir.z, -dir.x, dir.y, gains );
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			gains[ch] *= gain;
+
+		return;
+	}
+
+	const float focus = mFocus;
+	float sumSquares = 0;
+	size_t closest = 0;
+	float closestCos = -2;
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		const float cosAngle = dir.dot( mSpeakerDirections[ch] );
+		if( cosAngle > closestCos ) {
+			closestCos = cosAngle;
+			closest = ch;
+		}
+
+		gains[ch] = cosAngle > 0 ? math<float>::pow( cosAngle, focus ) : 0;
+		sumSquares += gains[ch] * gains[ch];
+	}
+
+	if( sumSquares > 1e-12f ) {
+		const float scale = gain / math<float>::sqrt( sumSquares );
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			gains[ch] *= scale;
+	}
+	else if( numChannels ) {
+		// no speaker is within 90 degrees of the source, so it is sent to the closest one.
+		fill( gains, gains + numChannels, 0.0f );
+		gains[closest] = gain;
+	}
+}
+
+void SpatialPannerNode::sumInputs()
+{
+	BufferDynamic *summingBuffer = getSummingBuffer();
+	Buffer *internalBuffer = getInternalBuffer();
+
+	const size_t numFrames = internalBuffer->getNumFrames();
+	const size_t numChannels = internalBuffer->getNumChannels();
+	const float rampIncrement = 1.0f / (float)numFrames;
+	internalBuffer->zero();
+
+	for( auto &source : mSources ) {
+		const NodeRef &input = source->mInput;
+
+		summingBuffer->setNumChannels( input->getNumChannels() );
+		input->pullInputs( summingBuffer );
+
+		const Buffer *processedBuffer = input->getProcessesInPlace() ? summingBuffer : input->getInternalBuffer();
+		const float *inputChannel = processedBuffer->getChannel( 0 );
+
+		// if the source moved, the gains are recomputed and ramped to over this block.
+		bool ramp = false;
+		const uint32_t generation = source->mGeneration;
+		if( generation != source->mProcessedGeneration ) {
+			source->mProcessedGeneration = generation;
+			computeGains( Vec3f( source->mDirectionX, source->mDirectionY, source->mDirectionZ ), source->mGain, &source->mTargetGains[0] );
+			ramp = true;
+		}
+
+		// mix the source into each output channel with its column of the gain matrix, skipping channels it isn't heard in.
+		const float *gains = &source->mGains[0];
+		const float *targetGains = ramp ? &source->mTargetGains[0] : gains;
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			if( gains[ch] == 0 && targetGains[ch] == 0 )
+				continue;
+
+			dsp::mulRampAdd( inputChannel, gains[ch], ( targetGains[ch] - gains[ch] ) * rampIncrement, internalBuffer->getChannel( ch ), numFrames );
+		}
+
+		if( ramp )
+			source->mGains.swap( source->mTargetGains );
+	}
+}
+
+} } // namespace cinder::audio
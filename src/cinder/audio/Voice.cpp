@@ -28,6 +28,7 @@
 #include "cinder/audio/Debug.h"
 
 #include <map>
+#include <limits>
 
 using namespace std;
 using namespace ci;
@@ -196,6 +197,14 @@ VoiceSamplePlayerNodeRef Voice::create( const SourceFileRef &sourceFile, const O
 	return result;
 }
 
+VoiceSamplePlayerNodeRef Voice::create( const DataSourceRef &dataSource, const Options &options )
+{
+	VoiceSamplePlayerNodeRef result( new VoiceSamplePlayerNode( dataSource, options ) );
+	MixerImpl::get()->addVoice( result, options );
+
+	return result;
+}
+
 Voice::~Voice()
 {
 	MixerImpl::get()->removeVoice( mBusId );
@@ -263,6 +272,30 @@ VoiceSamplePlayerNode::VoiceSamplePlayerNode( const SourceFileRef &sourceFile, c
 		mNode = Context::master()->makeNode( new FilePlayerNode( sf ) );
 }
 
+VoiceSamplePlayerNode::VoiceSamplePlayerNode( const DataSourceRef &dataSource, const Options &options )
+	: Voice()
+{
+	size_t sampleRate = audio::master()->getSampleRate();
+	const bool isCacheable = dataSource->isFilePath();
+
+	// if the file has already been decoded by another Voice, it isn't opened again.
+	BufferRef buffer;
+	if( isCacheable )
+		buffer = BufferCache::get()->find( dataSource->getFilePath(), sampleRate );
+
+	if( ! buffer || buffer->getNumFrames() > options.getMaxFramesForBufferPlayback() ) {
+		SourceFileRef sf = SourceFile::create( dataSource, sampleRate );
+		if( sf->getNumFrames() > options.getMaxFramesForBufferPlayback() ) {
+			mNode = Context::master()->makeNode( new FilePlayerNode( sf ) );
+			return;
+		}
+
+		buffer = isCacheable ? BufferCache::get()->load( dataSource, sampleRate ) : sf->loadBuffer();
+	}
+
+	mNode = Context::master()->makeNode( new BufferPlayerNode( buffer ) );
+}
+
 void VoiceSamplePlayerNode::start()
 {
 	if( mNode->isEof() )
@@ -286,4 +319,135 @@ VoiceCallbackProcessor::VoiceCallbackProcessor( const CallbackProcessorFn &callb
 	mNode = Context::master()->makeNode( new CallbackProcessorNode( callbackFn, Node::Format().channels( options.getChannels() ) ) );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - VoicePool
+// ----------------------------------------------------------------------------------------------------
+
+// static
+VoicePoolRef VoicePool::create( const Options &options )
+{
+	return VoicePoolRef( new VoicePool( options ) );
+}
+
+VoicePool::VoicePool( const Options &options )
+	: mStealPolicy( options.getStealPolicy() ), mNumChannels( max<size_t>( options.getChannels(), 1 ) )
+{
+	Context *ctx = Context::master();
+	ctx->enable();
+
+	mOutput = ctx->makeNode( new GainNode( Node::Format().channels( 2 ) ) );
+
+	mVoices.resize( options.getMaxVoices() );
+	for( auto &voice : mVoices ) {
+		voice.mPlayer = ctx->makeNode( new BufferPlayerNode( Node::Format().channels( mNumChannels ) ) );
+		voice.mGain = ctx->makeNode( new GainNode( Node::Format().channels( mNumChannels ) ) );
+		voice.mPan = ctx->makeNode( new Pan2dNode() );
+		voice.mPan->setStereoInputModeEnabled( mNumChannels == 2 );
+		voice.mTriggerTime = voice.mEndTime = 0;
+		voice.mVolume = 0;
+
+		voice.mPlayer >> voice.mGain >> voice.mPan >> mOutput;
+	}
+
+	if( options.getConnectToMaster() )
+		mOutput >> ctx->getOutput();
+}
+
+VoicePool::~VoicePool()
+{
+	mOutput->disconnectAllOutputs();
+}
+
+int VoicePool::play( const BufferRef &buffer, float volume, float pan )
+{
+	if( ! buffer || buffer->getNumChannels() != mNumChannels ) {
+		CI_LOG_E( "buffer must have " << mNumChannels << " channels." );
+		return -1;
+	}
+
+	Context *ctx = Context::master();
+	const double currentTime = ctx->getNumProcessedSeconds();
+
+	int voiceIndex = findVoice( currentTime );
+	if( voiceIndex < 0 )
+		return -1;
+
+	PooledVoice &voice = mVoices[voiceIndex];
+	voice.mTriggerTime = currentTime;
+	voice.mEndTime = currentTime + (double)buffer->getNumFrames() / (double)ctx->getSampleRate();
+	voice.mVolume = volume;
+
+	// Param changes are posted as commands too, which execute in order before the restart below.
+	voice.mGain->setValue( volume );
+	voice.mPan->setPos( pan );
+
+	// The previous Buffer is swapped into this holder, so that it is released along with the command on a non-audio thread.
+	shared_ptr<BufferRef> bufferHolder( new BufferRef( buffer ) );
+	BufferPlayerNodeRef player = voice.mPlayer;
+	ctx->postCommand( [player, bufferHolder] {
+		player->stop();
+		player->swapBufferImpl( *bufferHolder );
+		player->start();
+	} );
+
+	return voiceIndex;
+}
+
+void VoicePool::stop( size_t voiceIndex )
+{
+	PooledVoice &voice = mVoices.at( voiceIndex );
+	voice.mEndTime = 0;
+
+	BufferPlayerNodeRef player = voice.mPlayer;
+	Context::master()->postCommand( [player] { player->stop(); } );
+}
+
+void VoicePool::stopAll()
+{
+	for( size_t i = 0; i < mVoices.size(); i++ )
+		stop( i );
+}
+
+bool VoicePool::isVoicePlaying( size_t voiceIndex ) const
+{
+	return mVoices.at( voiceIndex ).mEndTime > Context::master()->getNumProcessedSeconds();
+}
+
+size_t VoicePool::getNumActiveVoices() const
+{
+	const double currentTime = Context::master()->getNumProcessedSeconds();
+
+	size_t result = 0;
+	for( const auto &voice : mVoices ) {
+		if( voice.mEndTime > currentTime )
+			result++;
+	}
+
+	return result;
+}
+
+int VoicePool::findVoice( double currentTime ) const
+{
+	int result = -1;
+	double minTriggerTime = numeric_limits<double>::max();
+	float minVolume = numeric_limits<float>::max();
+
+	for( size_t i = 0; i < mVoices.size(); i++ ) {
+		const PooledVoice &voice = mVoices[i];
+		if( voice.mEndTime <= currentTime )
+			return (int)i;
+
+		if( mStealPolicy == StealPolicy::OLDEST && voice.mTriggerTime < minTriggerTime ) {
+			minTriggerTime = voice.mTriggerTime;
+			result = (int)i;
+		}
+		else if( mStealPolicy == StealPolicy::QUIETEST && voice.mVolume < minVolume ) {
+			minVolume = voice.mVolume;
+			result = (int)i;
+		}
+	}
+
+	return result;
+}
+
 } } // namespace cinder::audio
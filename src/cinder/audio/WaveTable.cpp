@@ -29,6 +29,12 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "cinder/Timer.h" // TEMP
 
+// The oscillator sum is vectorized over time, which needs SSE2 for converting phases to table indices.
+#if defined( _M_X64 ) || defined( __x86_64__ ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+	#define CINDER_AUDIO_WAVETABLE_SSE
+	#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace {
@@ -65,12 +71,13 @@ inline float tableLookup( const float *table, size_t tableSize, float phase )
 {
 	float lookup = phase * tableSize;
 	size_t index1 = (size_t)lookup;
-	size_t index2 = ( index1 + 1 ) & ( tableSize - 1 ); // faster mod that only works if tableSize is a power of 2
+	float frac = lookup - (float)index1;
+	index1 &= tableSize - 1; // faster mod that only works if tableSize is a power of 2, also guards against phase rounding up to 1
+	size_t index2 = ( index1 + 1 ) & ( tableSize - 1 );
 	float val1 = table[index1];
 	float val2 = table[index2];
-	float frac = lookup - (float)index1;
 
-	return val2 + frac * ( val2 - val1 );
+	return val1 + frac * ( val2 - val1 );
 }
 
 #endif
@@ -406,6 +413,84 @@ float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, f
 
 #endif
 
+void WaveTable2d::lookupBandlimitedSum( float *outputArray, size_t outputLength, float *phaseArray, const float *f0Array, const float *gainBeginArray, const float *gainEndArray, size_t numOscillators ) const
+{
+	if( ! outputLength )
+		return;
+
+	const size_t tableSize = mTableSize;
+	const float samplePeriod = mSamplePeriod;
+	const float gainIncrScale = 1.0f / (float)outputLength;
+
+	for( size_t osc = 0; osc < numOscillators; osc++ ) {
+		const float f0 = f0Array[osc];
+		const float phaseIncr = f0 * samplePeriod;
+		const float gainBegin = gainBeginArray[osc];
+		const float gainEnd = gainEndArray[osc];
+
+		// silent oscillators only advance their phase.
+		if( gainBegin == 0 && gainEnd == 0 ) {
+			phaseArray[osc] = (float)fract( (double)phaseArray[osc] + (double)phaseIncr * (double)outputLength );
+			continue;
+		}
+
+		const float *table = getBandLimitedTable( f0 );
+		const float gainIncr = ( gainEnd - gainBegin ) * gainIncrScale;
+		float phase = phaseArray[osc];
+		size_t i = 0;
+
+#if defined( CINDER_AUDIO_WAVETABLE_SSE )
+		// Four consecutive samples are computed at once. Each chunk's phases are offset from a base phase, which is re-wrapped
+		// once per chunk so that precision does not degrade over long blocks.
+		const __m128 offsets = _mm_set_ps( 3, 2, 1, 0 );
+		const __m128 phaseOffsets = _mm_mul_ps( offsets, _mm_set1_ps( phaseIncr ) );
+		const __m128 gainOffsets = _mm_mul_ps( offsets, _mm_set1_ps( gainIncr ) );
+		const __m128 tableSizeVec = _mm_set1_ps( (float)tableSize );
+		const __m128 one = _mm_set1_ps( 1 );
+		const __m128i indexMask = _mm_set1_epi32( int( tableSize - 1 ) );
+		const __m128i oneInt = _mm_set1_epi32( 1 );
+		const float phaseIncrChunk = phaseIncr * 4;
+		const float gainIncrChunk = gainIncr * 4;
+		float gain = gainBegin;
+
+		int32_t indices1[4], indices2[4];
+
+		for( ; i + 4 <= outputLength; i += 4 ) {
+			// fract(), with floor() computed from truncation to handle negative frequencies
+			__m128 p = _mm_add_ps( _mm_set1_ps( phase ), phaseOffsets );
+			__m128 truncated = _mm_cvtepi32_ps( _mm_cvttps_epi32( p ) );
+			__m128 floored = _mm_sub_ps( truncated, _mm_and_ps( _mm_cmpgt_ps( truncated, p ), one ) );
+			p = _mm_sub_ps( p, floored );
+
+			__m128 lookup = _mm_mul_ps( p, tableSizeVec );
+			__m128i index1 = _mm_cvttps_epi32( lookup );
+			__m128 frac = _mm_sub_ps( lookup, _mm_cvtepi32_ps( index1 ) );
+			index1 = _mm_and_si128( index1, indexMask );
+			_mm_storeu_si128( (__m128i *)indices1, index1 );
+			_mm_storeu_si128( (__m128i *)indices2, _mm_and_si128( _mm_add_epi32( index1, oneInt ), indexMask ) );
+
+			__m128 val1 = _mm_set_ps( table[indices1[3]], table[indices1[2]], table[indices1[1]], table[indices1[0]] );
+			__m128 val2 = _mm_set_ps( table[indices2[3]], table[indices2[2]], table[indices2[1]], table[indices2[0]] );
+			__m128 val = _mm_add_ps( val1, _mm_mul_ps( frac, _mm_sub_ps( val2, val1 ) ) );
+
+			__m128 g = _mm_add_ps( _mm_set1_ps( gain ), gainOffsets );
+			__m128 out = _mm_loadu_ps( outputArray + i );
+			_mm_storeu_ps( outputArray + i, _mm_add_ps( out, _mm_mul_ps( val, g ) ) );
+
+			phase = fract( phase + phaseIncrChunk );
+			gain += gainIncrChunk;
+		}
+#endif // defined( CINDER_AUDIO_WAVETABLE_SSE )
+
+		for( ; i < outputLength; i++ ) {
+			outputArray[i] += tableLookup( table, tableSize, phase ) * ( gainBegin + gainIncr * (float)i );
+			phase = fract( phase + phaseIncr );
+		}
+
+		phaseArray[osc] = phase;
+	}
+}
+
 void WaveTable2d::copyTo( float *array, size_t tableIndex ) const
 {
 	CI_ASSERT( tableIndex < mNumTables );
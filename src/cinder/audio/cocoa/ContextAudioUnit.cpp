@@ -69,7 +69,7 @@ void NodeAudioUnit::uninitAu()
 // ----------------------------------------------------------------------------------------------------
 
 OutputDeviceNodeAudioUnit::OutputDeviceNodeAudioUnit( const DeviceRef &device, const Format &format )
-	: OutputDeviceNode( device, format ), mSynchronousIO( false )
+	: OutputDeviceNode( device, format ), mSynchronousIO( false ), mNextSampleTime( -1 )
 {
 	findAndCreateAudioComponent( getOutputAudioUnitDesc(), &mAudioUnit );
 }
@@ -112,6 +112,8 @@ void OutputDeviceNodeAudioUnit::uninitialize()
 
 void OutputDeviceNodeAudioUnit::enableProcessing()
 {
+	mNextSampleTime = -1;
+
 	OSStatus status = ::AudioOutputUnitStart( mAudioUnit );
 	CI_VERIFY( status == noErr );
 }
@@ -145,6 +147,14 @@ OSStatus OutputDeviceNodeAudioUnit::renderCallback( void *data, ::AudioUnitRende
 	Buffer *internalBuffer = lineOut->getInternalBuffer();
 	internalBuffer->zero();
 
+	// a gap in the sample time since the last callback means the device skipped frames, which counts as an xrun.
+	if( timeStamp->mFlags & kAudioTimeStampSampleTimeValid ) {
+		if( lineOut->mNextSampleTime >= 0 && timeStamp->mSampleTime > lineOut->mNextSampleTime )
+			ctx->markXrun();
+
+		lineOut->mNextSampleTime = timeStamp->mSampleTime + numFrames;
+	}
+
 	renderData->context->setCurrentTimeStamp( timeStamp );
 	ctx->preProcess();
 	lineOut->pullInputs( internalBuffer );
@@ -165,7 +175,7 @@ OSStatus OutputDeviceNodeAudioUnit::renderCallback( void *data, ::AudioUnitRende
 // ----------------------------------------------------------------------------------------------------
 
 InputDeviceNodeAudioUnit::InputDeviceNodeAudioUnit( const DeviceRef &device, const Format &format )
-	: InputDeviceNode( device, format ), mSynchronousIO( false ), mRingBufferPaddingFactor( 2 )
+	: InputDeviceNode( device, format ), mSynchronousIO( false )
 {
 }
 
@@ -212,6 +222,7 @@ void InputDeviceNodeAudioUnit::initialize()
 		}
 
 		mBufferList = createNonInterleavedBufferList( framesPerBlock, getNumChannels() );
+		mDriftCompensator.reset();
 
 		if( lineOutWasInitialized )
 			lineOutAu->initialize();
@@ -223,7 +234,9 @@ void InputDeviceNodeAudioUnit::initialize()
 		if( device->getSampleRate() != sampleRate || device->getFramesPerBlock() != framesPerBlock )
 			device->updateFormat( Device::Format().sampleRate( sampleRate ).framesPerBlock( framesPerBlock ) );
 
-		mRingBuffer.resize( framesPerBlock * getNumChannels() * mRingBufferPaddingFactor );
+		// the input device runs on its own clock, so its frames are resampled to stay in step with the output device
+		mDriftCompensator.reset( new dsp::DriftCompensator( getNumChannels(), sampleRate, framesPerBlock, framesPerBlock ) );
+		mCaptureBuffer.setSize( framesPerBlock, getNumChannels() );
 		mBufferList = createNonInterleavedBufferList( framesPerBlock, getNumChannels() );
 
 		::AURenderCallbackStruct callbackStruct = { InputDeviceNodeAudioUnit::inputCallback, &mRenderData };
@@ -284,12 +297,17 @@ void InputDeviceNodeAudioUnit::process( Buffer *buffer )
 		copyFromBufferList( buffer, mBufferList.get() );
 	}
 	else {
-		// copy from ringbuffer. If not possible, store the timestamp of the underrun
-		if( ! mRingBuffer.read( buffer->getData(), buffer->getSize() ) )
+		// read from the drift compensator. If not possible, store the timestamp of the underrun
+		if( ! mDriftCompensator->read( buffer ) )
 			markUnderrun();
 	}
 }
 
+double InputDeviceNodeAudioUnit::getDriftCompensationRatio() const
+{
+	return mDriftCompensator ? mDriftCompensator->getRatio() : 1;
+}
+
 // note: Not all AudioUnitRender status errors are fatal here. For instance, if samplerate just changed we may not be able to pull input just yet, but we will next frame.
 OSStatus InputDeviceNodeAudioUnit::inputCallback( void *data, ::AudioUnitRenderActionFlags *flags, const ::AudioTimeStamp *timeStamp, UInt32 bus, UInt32 numFrames, ::AudioBufferList *bufferList )
 {
@@ -305,13 +323,10 @@ OSStatus InputDeviceNodeAudioUnit::inputCallback( void *data, ::AudioUnitRenderA
 	if( status != noErr )
 		return status;
 
-	if( lineIn->mRingBuffer.getAvailableWrite() >= nodeBufferList->mNumberBuffers * numFrames ) {
-		for( size_t ch = 0; ch < nodeBufferList->mNumberBuffers; ch++ ) {
-			float *channel = static_cast<float *>( nodeBufferList->mBuffers[ch].mData );
-			lineIn->mRingBuffer.write( channel, numFrames );
-		}
-	}
-	else
+	lineIn->mCaptureBuffer.setNumFrames( numFrames );
+	copyFromBufferList( &lineIn->mCaptureBuffer, nodeBufferList );
+
+	if( ! lineIn->mDriftCompensator->write( &lineIn->mCaptureBuffer ) )
 		lineIn->markOverrun();
 
 	return noErr;
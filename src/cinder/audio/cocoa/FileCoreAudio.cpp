@@ -53,6 +53,7 @@ SourceFileCoreAudio::SourceFileCoreAudio( const DataSourceRef &dataSource, size_
 SourceFileRef SourceFileCoreAudio::cloneWithSampleRate( size_t sampleRate ) const
 {
 	shared_ptr<SourceFileCoreAudio> result( new SourceFileCoreAudio( mDataSource, sampleRate ) );
+	result->mConverterQuality = mConverterQuality;
 	result->setupSampleRateConversion();
 
 	return result;
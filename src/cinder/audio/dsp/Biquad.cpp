@@ -61,6 +61,20 @@
 	#include <Accelerate/Accelerate.h>
 #endif
 
+// BiquadBank uses the same instruction sets as the routines in Dsp.cpp, including on vDSP platforms, since vDSP has no multichannel biquad.
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+	#define CINDER_AUDIO_BIQUAD_SSE
+	#include <xmmintrin.h>
+	#if defined( _MSC_VER ) && ( _MSC_VER >= 1600 )
+		#define CINDER_AUDIO_BIQUAD_AVX
+		#include <immintrin.h>
+		#include "cinder/System.h"
+	#endif
+#elif defined( __ARM_NEON__ ) || defined( _M_ARM )
+	#define CINDER_AUDIO_BIQUAD_NEON
+	#include <arm_neon.h>
+#endif
+
 #include <complex>
 
 namespace cinder { namespace audio { namespace dsp {
@@ -534,4 +548,225 @@ void Biquad::processSliceVDsp( double *source, double *dest, double *coefficient
 
 #endif // defined( CINDER_AUDIO_VDSP )
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - BiquadBank
+// ----------------------------------------------------------------------------------------------------
+
+BiquadBank::BiquadBank( size_t numChannels, size_t numSections )
+	: mNumChannels( 0 ), mNumSections( 0 ), mNumGroups( 0 ), mLaneWidth( 4 )
+{
+#if defined( CINDER_AUDIO_BIQUAD_AVX )
+	if( System::hasAvx() )
+		mLaneWidth = 8;
+#endif
+
+	setMaxFrames( kBufferSize );
+	setSize( numChannels, numSections );
+}
+
+void BiquadBank::setSize( size_t numChannels, size_t numSections )
+{
+	mNumChannels = numChannels;
+	mNumSections = numSections;
+	mNumGroups = ( numChannels + mLaneWidth - 1 ) / mLaneWidth;
+
+	mSectionData.assign( mNumGroups * mNumSections * SECTION_STRIDE * mLaneWidth, 0.0f );
+
+	// pass-thru: b0 = 1
+	for( size_t group = 0; group < mNumGroups; group++ ) {
+		for( size_t section = 0; section < mNumSections; section++ ) {
+			float *b0 = getSectionData( group, section );
+			for( size_t lane = 0; lane < mLaneWidth; lane++ )
+				b0[lane] = 1;
+		}
+	}
+}
+
+void BiquadBank::setMaxFrames( size_t maxFrames )
+{
+	mInterleaved.resize( maxFrames * mLaneWidth );
+}
+
+void BiquadBank::setCoefficients( size_t section, const Biquad &biquad )
+{
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		setCoefficients( section, ch, biquad );
+}
+
+void BiquadBank::setCoefficients( size_t section, size_t channel, const Biquad &biquad )
+{
+	CI_ASSERT( section < mNumSections && channel < mNumChannels );
+
+	double coeffs[5];
+	biquad.getCoefficients( &coeffs[0], &coeffs[1], &coeffs[2], &coeffs[3], &coeffs[4] );
+
+	float *data = getSectionData( channel / mLaneWidth, section );
+	size_t lane = channel % mLaneWidth;
+	for( size_t i = 0; i < 5; i++ )
+		data[i * mLaneWidth + lane] = (float)coeffs[i];
+}
+
+void BiquadBank::reset()
+{
+	for( size_t group = 0; group < mNumGroups; group++ ) {
+		for( size_t section = 0; section < mNumSections; section++ ) {
+			float *state = getSectionData( group, section ) + 5 * mLaneWidth;
+			std::fill( state, state + 4 * mLaneWidth, 0.0f );
+		}
+	}
+}
+
+void BiquadBank::process( Buffer *buffer )
+{
+	CI_ASSERT( buffer->getNumChannels() == mNumChannels );
+	CI_ASSERT( buffer->getNumFrames() * mLaneWidth <= mInterleaved.size() );
+
+	const size_t numFrames = buffer->getNumFrames();
+	float *interleaved = mInterleaved.data();
+
+#if defined( CINDER_AUDIO_BIQUAD_SSE )
+	// flush denormals to zero while processing, as single precision recursive filters decaying towards silence otherwise produce them
+	const unsigned int prevCsr = _mm_getcsr();
+	_mm_setcsr( prevCsr | 0x8040 ); // FTZ | DAZ
+#endif
+
+	for( size_t group = 0; group < mNumGroups; group++ ) {
+		const size_t firstChannel = group * mLaneWidth;
+		const size_t numLanes = std::min( mLaneWidth, mNumChannels - firstChannel );
+
+		// interleave the group's channels so that each frame is one SIMD vector, unused lanes are zeroed
+		if( numLanes < mLaneWidth )
+			std::fill( interleaved, interleaved + numFrames * mLaneWidth, 0.0f );
+
+		for( size_t lane = 0; lane < numLanes; lane++ ) {
+			const float *channel = buffer->getChannel( firstChannel + lane );
+			for( size_t i = 0; i < numFrames; i++ )
+				interleaved[i * mLaneWidth + lane] = channel[i];
+		}
+
+		for( size_t section = 0; section < mNumSections; section++ )
+			processSection( interleaved, numFrames, getSectionData( group, section ) );
+
+		for( size_t lane = 0; lane < numLanes; lane++ ) {
+			float *channel = buffer->getChannel( firstChannel + lane );
+			for( size_t i = 0; i < numFrames; i++ )
+				channel[i] = interleaved[i * mLaneWidth + lane];
+		}
+	}
+
+#if defined( CINDER_AUDIO_BIQUAD_SSE )
+	_mm_setcsr( prevCsr );
+#endif
+}
+
+void BiquadBank::processSection( float *interleaved, size_t numFrames, float *section )
+{
+	const size_t w = mLaneWidth;
+
+#if defined( CINDER_AUDIO_BIQUAD_AVX )
+	if( w == 8 ) {
+		const __m256 b0 = _mm256_loadu_ps( section ), b1 = _mm256_loadu_ps( section + 8 ), b2 = _mm256_loadu_ps( section + 16 );
+		const __m256 a1 = _mm256_loadu_ps( section + 24 ), a2 = _mm256_loadu_ps( section + 32 );
+		__m256 x1 = _mm256_loadu_ps( section + 40 ), x2 = _mm256_loadu_ps( section + 48 );
+		__m256 y1 = _mm256_loadu_ps( section + 56 ), y2 = _mm256_loadu_ps( section + 64 );
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			float *frame = interleaved + i * 8;
+			__m256 x = _mm256_loadu_ps( frame );
+			__m256 y = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( b0, x ), _mm256_mul_ps( b1, x1 ) ), _mm256_mul_ps( b2, x2 ) );
+			y = _mm256_sub_ps( y, _mm256_add_ps( _mm256_mul_ps( a1, y1 ), _mm256_mul_ps( a2, y2 ) ) );
+			_mm256_storeu_ps( frame, y );
+
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+		}
+
+		_mm256_storeu_ps( section + 40, x1 );
+		_mm256_storeu_ps( section + 48, x2 );
+		_mm256_storeu_ps( section + 56, y1 );
+		_mm256_storeu_ps( section + 64, y2 );
+		_mm256_zeroupper();
+		return;
+	}
+#endif
+#if defined( CINDER_AUDIO_BIQUAD_SSE )
+	if( w == 4 ) {
+		const __m128 b0 = _mm_loadu_ps( section ), b1 = _mm_loadu_ps( section + 4 ), b2 = _mm_loadu_ps( section + 8 );
+		const __m128 a1 = _mm_loadu_ps( section + 12 ), a2 = _mm_loadu_ps( section + 16 );
+		__m128 x1 = _mm_loadu_ps( section + 20 ), x2 = _mm_loadu_ps( section + 24 );
+		__m128 y1 = _mm_loadu_ps( section + 28 ), y2 = _mm_loadu_ps( section + 32 );
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			float *frame = interleaved + i * 4;
+			__m128 x = _mm_loadu_ps( frame );
+			__m128 y = _mm_add_ps( _mm_add_ps( _mm_mul_ps( b0, x ), _mm_mul_ps( b1, x1 ) ), _mm_mul_ps( b2, x2 ) );
+			y = _mm_sub_ps( y, _mm_add_ps( _mm_mul_ps( a1, y1 ), _mm_mul_ps( a2, y2 ) ) );
+			_mm_storeu_ps( frame, y );
+
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+		}
+
+		_mm_storeu_ps( section + 20, x1 );
+		_mm_storeu_ps( section + 24, x2 );
+		_mm_storeu_ps( section + 28, y1 );
+		_mm_storeu_ps( section + 32, y2 );
+		return;
+	}
+#elif defined( CINDER_AUDIO_BIQUAD_NEON )
+	if( w == 4 ) {
+		const float32x4_t b0 = vld1q_f32( section ), b1 = vld1q_f32( section + 4 ), b2 = vld1q_f32( section + 8 );
+		const float32x4_t a1 = vld1q_f32( section + 12 ), a2 = vld1q_f32( section + 16 );
+		float32x4_t x1 = vld1q_f32( section + 20 ), x2 = vld1q_f32( section + 24 );
+		float32x4_t y1 = vld1q_f32( section + 28 ), y2 = vld1q_f32( section + 32 );
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			float *frame = interleaved + i * 4;
+			float32x4_t x = vld1q_f32( frame );
+			float32x4_t y = vmlaq_f32( vmlaq_f32( vmulq_f32( b0, x ), b1, x1 ), b2, x2 );
+			y = vmlsq_f32( vmlsq_f32( y, a1, y1 ), a2, y2 );
+			vst1q_f32( frame, y );
+
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+		}
+
+		vst1q_f32( section + 20, x1 );
+		vst1q_f32( section + 24, x2 );
+		vst1q_f32( section + 28, y1 );
+		vst1q_f32( section + 32, y2 );
+		return;
+	}
+#endif
+
+	// scalar fallback, one lane at a time
+	for( size_t lane = 0; lane < w; lane++ ) {
+		const float b0 = section[lane], b1 = section[w + lane], b2 = section[2 * w + lane], a1 = section[3 * w + lane], a2 = section[4 * w + lane];
+		float x1 = section[5 * w + lane], x2 = section[6 * w + lane], y1 = section[7 * w + lane], y2 = section[8 * w + lane];
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			float &sample = interleaved[i * w + lane];
+			float x = sample;
+			float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+			sample = y;
+
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+		}
+
+		section[5 * w + lane] = x1;
+		section[6 * w + lane] = x2;
+		section[7 * w + lane] = y1;
+		section[8 * w + lane] = y2;
+	}
+}
+
 } } } // namespace cinder::audio::dsp
\ No newline at end of file
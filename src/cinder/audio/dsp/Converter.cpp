@@ -24,6 +24,7 @@
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/ConverterR8brain.h"
+#include "cinder/audio/dsp/ConverterPolyphase.h"
 #include "cinder/CinderAssert.h"
 
 #if defined( CINDER_COCOA )
@@ -37,8 +38,11 @@ using namespace std;
 
 namespace cinder { namespace audio { namespace dsp {
 
-unique_ptr<Converter> Converter::create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock )
+unique_ptr<Converter> Converter::create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality )
 {
+	if( quality != Quality::BEST && ConverterImplPolyphase::supportsSampleRates( sourceSampleRate, destSampleRate ) )
+		return unique_ptr<Converter>( new ConverterImplPolyphase( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock, quality ) );
+
 #if defined( CINDER_COCOA )
 	return unique_ptr<Converter>( new cocoa::ConverterImplCoreAudio( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock ) );
 #else
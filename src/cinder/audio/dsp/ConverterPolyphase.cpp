@@ -0,0 +1,226 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/dsp/ConverterPolyphase.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/CinderMath.h"
+
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+// Limits on the reduced samplerate ratio, beyond which filter tables become too large and the BEST quality Converter is used instead.
+const size_t MAX_UP_FACTOR = 1024;
+const size_t MAX_DOWN_RATIO = 8;
+
+size_t greatestCommonDivisor( size_t a, size_t b )
+{
+	while( b ) {
+		size_t t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+// zeroth order modified Bessel function of the first kind, used by the Kaiser window
+double besselI0( double x )
+{
+	double result = 1;
+	double term = 1;
+	double halfX = x / 2;
+	for( int k = 1; k < 64; k++ ) {
+		term *= halfX / k;
+		double termSquared = term * term;
+		result += termSquared;
+		if( termSquared < result * 1e-12 )
+			break;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+// static
+bool ConverterImplPolyphase::supportsSampleRates( size_t sourceSampleRate, size_t destSampleRate )
+{
+	if( ! sourceSampleRate || ! destSampleRate || sourceSampleRate == destSampleRate )
+		return true;
+
+	size_t divisor = greatestCommonDivisor( sourceSampleRate, destSampleRate );
+	size_t upFactor = destSampleRate / divisor;
+	size_t downFactor = sourceSampleRate / divisor;
+
+	return upFactor <= MAX_UP_FACTOR && downFactor <= upFactor * MAX_DOWN_RATIO;
+}
+
+ConverterImplPolyphase::ConverterImplPolyphase( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality )
+	: Converter( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock ), mUpFactor( 1 ), mDownFactor( 1 ), mNumTapsPerPhase( 1 )
+{
+	CI_ASSERT( quality != Quality::BEST );
+	CI_ASSERT( supportsSampleRates( mSourceSampleRate, mDestSampleRate ) );
+
+	size_t numResampledChannels = min( mSourceNumChannels, mDestNumChannels );
+	if( mSourceNumChannels > mDestNumChannels )
+		mMixingBuffer = Buffer( mSourceMaxFramesPerBlock, mDestNumChannels );	// downmixing, resample dest channels
+	else if( mSourceNumChannels < mDestNumChannels )
+		mMixingBuffer = Buffer( mDestMaxFramesPerBlock, mSourceNumChannels );	// upmixing, resample source channels
+
+	if( mSourceSampleRate == mDestSampleRate )
+		return;
+
+	size_t divisor = greatestCommonDivisor( mSourceSampleRate, mDestSampleRate );
+	mUpFactor = mDestSampleRate / divisor;
+	mDownFactor = mSourceSampleRate / divisor;
+
+	// The number of taps sets the transition bandwidth relative to the source samplerate, so it is scaled up when downsampling
+	// in order to keep the transition band proportional to the lower, destination samplerate.
+	size_t downRatio = ( mDownFactor + mUpFactor - 1 ) / mUpFactor;
+	if( quality == Quality::FAST ) {
+		mNumTapsPerPhase = 24 * downRatio;
+		designFilter( 0.85f, 6.0f );		// ~60dB stopband attenuation
+	}
+	else {
+		mNumTapsPerPhase = 48 * downRatio;
+		designFilter( 0.89f, 8.6f );		// ~86dB stopband attenuation
+	}
+
+	mHistoryBuffer = Buffer( mNumTapsPerPhase - 1 + mSourceMaxFramesPerBlock, numResampledChannels );
+	clear();
+}
+
+void ConverterImplPolyphase::designFilter( float rolloff, float kaiserBeta )
+{
+	// Kaiser windowed sinc lowpass at the upsampled rate, with a cutoff just below the lower of the two nyquist frequencies.
+	// The center is rounded down to a whole tap so that it matches the delay compensated for in clear().
+	const size_t numTaps = mUpFactor * mNumTapsPerPhase;
+	const double center = double( ( numTaps - 1 ) / 2 );
+	const double cutoff = (double)rolloff * 0.5 / (double)max( mUpFactor, mDownFactor );
+	const double windowNormalizer = 1.0 / besselI0( kaiserBeta );
+
+	vector<double> prototype( numTaps );
+	for( size_t i = 0; i < numTaps; i++ ) {
+		double x = (double)i - center;
+		double sinc = ( x == 0 ) ? 2.0 * cutoff : sin( 2.0 * M_PI * cutoff * x ) / ( M_PI * x );
+		double windowPos = x / center;
+		double window = besselI0( kaiserBeta * sqrt( max( 0.0, 1.0 - windowPos * windowPos ) ) ) * windowNormalizer;
+		prototype[i] = sinc * window;
+	}
+
+	// split into phases, each stored in reverse order so that a phase lines up with ascending input samples in dot().
+	// Every phase is normalized to unity gain at DC, which removes the DC ripple that otherwise varies from one output sample to the next.
+	mPhaseCoeffs.resize( numTaps );
+	for( size_t phase = 0; phase < mUpFactor; phase++ ) {
+		float *coeffs = &mPhaseCoeffs[phase * mNumTapsPerPhase];
+		double phaseSum = 0;
+		for( size_t k = 0; k < mNumTapsPerPhase; k++ )
+			phaseSum += prototype[phase + k * mUpFactor];
+
+		double gain = ( phaseSum != 0 ) ? 1.0 / phaseSum : 0.0;
+		for( size_t k = 0; k < mNumTapsPerPhase; k++ )
+			coeffs[mNumTapsPerPhase - 1 - k] = float( prototype[phase + k * mUpFactor] * gain );
+	}
+}
+
+void ConverterImplPolyphase::clear()
+{
+	mHistoryBuffer.zero();
+
+	// start at the filter's center tap, which compensates for its group delay
+	size_t delay = ( mUpFactor * mNumTapsPerPhase - 1 ) / 2;
+	mPhase = delay % mUpFactor;
+	mInputOffset = delay / mUpFactor;
+}
+
+pair<size_t, size_t> ConverterImplPolyphase::convert( const Buffer *sourceBuffer, Buffer *destBuffer )
+{
+	CI_ASSERT( sourceBuffer->getNumChannels() == mSourceNumChannels && destBuffer->getNumChannels() == mDestNumChannels );
+
+	size_t readCount = min( sourceBuffer->getNumFrames(), mSourceMaxFramesPerBlock );
+
+	if( mSourceSampleRate == mDestSampleRate ) {
+		mixBuffers( sourceBuffer, destBuffer, readCount );
+		return make_pair( readCount, readCount );
+	}
+
+	size_t outCount;
+	if( mSourceNumChannels == mDestNumChannels )
+		outCount = convertChannels( sourceBuffer, destBuffer, readCount );
+	else if( mSourceNumChannels > mDestNumChannels ) {
+		mixBuffers( sourceBuffer, &mMixingBuffer, readCount );
+		outCount = convertChannels( &mMixingBuffer, destBuffer, readCount );
+	}
+	else {
+		outCount = convertChannels( sourceBuffer, &mMixingBuffer, readCount );
+		mixBuffers( &mMixingBuffer, destBuffer, outCount );
+	}
+
+	return make_pair( readCount, outCount );
+}
+
+size_t ConverterImplPolyphase::convertChannels( const Buffer *sourceBuffer, Buffer *destBuffer, size_t readCount )
+{
+	const size_t historyLength = mNumTapsPerPhase - 1;
+	const size_t destFrames = destBuffer->getNumFrames();
+
+	size_t outCount = 0;
+	size_t phase = mPhase;
+	size_t inputOffset = mInputOffset;
+
+	for( size_t ch = 0; ch < mHistoryBuffer.getNumChannels(); ch++ ) {
+		float *history = mHistoryBuffer.getChannel( ch );
+		float *dest = destBuffer->getChannel( ch );
+		memcpy( history + historyLength, sourceBuffer->getChannel( ch ), readCount * sizeof( float ) );
+
+		// every channel advances identically, so each one starts from the saved state
+		phase = mPhase;
+		inputOffset = mInputOffset;
+		outCount = 0;
+		while( inputOffset < readCount && outCount < destFrames ) {
+			dest[outCount++] = dot( &mPhaseCoeffs[phase * mNumTapsPerPhase], history + inputOffset, mNumTapsPerPhase );
+
+			phase += mDownFactor;
+			inputOffset += phase / mUpFactor;
+			phase %= mUpFactor;
+		}
+
+		CI_ASSERT_MSG( inputOffset >= readCount, "destBuffer too small for conversion" );
+
+		// keep the most recent samples as history for the next block
+		memmove( history, history + readCount, historyLength * sizeof( float ) );
+	}
+
+	mPhase = phase;
+	mInputOffset = inputOffset - min( inputOffset, readCount );
+
+	return outCount;
+}
+
+} } } // namespace cinder::audio::dsp
@@ -0,0 +1,264 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/dsp/DriftCompensator.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+// the resampler is a windowed sinc interpolator, whose coefficients are tabulated at NUM_PHASES fractional positions and linearly interpolated between them
+const size_t NUM_TAPS		= 32;
+const size_t HALF_TAPS		= NUM_TAPS / 2;
+const size_t NUM_PHASES		= 256;
+
+// the fill level is smoothed over a few write blocks before it drives the controller, which is critically damped with a time constant of a few seconds
+const double FILL_SMOOTHING_SECONDS	= 0.5;
+const double CONTROLLER_SECONDS		= 4.0;
+
+} // anonymous namespace
+
+DriftCompensator::DriftCompensator( size_t numChannels, size_t sampleRate, size_t framesPerBlock, size_t maxWriteFrames, size_t targetLatencyFrames )
+	: mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock ), mMaxWriteFrames( maxWriteFrames ), mTargetLatencyFrames( targetLatencyFrames ),
+		mMaxCorrection( 0.005 ), mRatio( 1 )
+{
+	CI_ASSERT( numChannels && sampleRate && framesPerBlock );
+
+	if( ! mTargetLatencyFrames )
+		mTargetLatencyFrames = framesPerBlock + maxWriteFrames;
+
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		mRingBuffers.emplace_back( mTargetLatencyFrames * 2 + maxWriteFrames );
+
+	// room for one block read at up to twice the nominal rate, plus the filter's history
+	mWorkBuffer.setSize( framesPerBlock * 2 + NUM_TAPS + 2, numChannels );
+	mCoefficients.resize( NUM_TAPS );
+	computeFilterTable();
+
+	reset();
+}
+
+void DriftCompensator::reset()
+{
+	for( auto &ringBuffer : mRingBuffers )
+		ringBuffer.clear();
+
+	// start with the filter's history silent, positioned so the first output frame is the first written frame
+	mWorkBuffer.zero();
+	mNumWorkFrames = HALF_TAPS - 1;
+	mPosition = HALF_TAPS - 1;
+
+	mFilteredFill = (double)mTargetLatencyFrames;
+	mIntegral = 0;
+	mRatio = 1;
+	mPrimed = false;
+}
+
+void DriftCompensator::computeFilterTable()
+{
+	// one extra phase so that interpolation at the last phase doesn't need to wrap
+	mFilterTable.resize( ( NUM_PHASES + 1 ) * NUM_TAPS );
+
+	for( size_t phase = 0; phase <= NUM_PHASES; phase++ ) {
+		float *coefficients = &mFilterTable[phase * NUM_TAPS];
+		double fraction = (double)phase / (double)NUM_PHASES;
+		double sum = 0;
+
+		for( size_t k = 0; k < NUM_TAPS; k++ ) {
+			// distance from the interpolated position to tap k, which lies in [-HALF_TAPS, HALF_TAPS]
+			double x = (double)k - (double)( HALF_TAPS - 1 ) - fraction;
+			double sinc = ( math<double>::abs( x ) < 1e-9 ) ? 1 : sin( M_PI * x ) / ( M_PI * x );
+			double window = 0.42 + 0.5 * cos( M_PI * x / HALF_TAPS ) + 0.08 * cos( 2 * M_PI * x / HALF_TAPS );
+
+			coefficients[k] = float( sinc * window );
+			sum += coefficients[k];
+		}
+
+		// normalize for unity gain at DC, so the tabulated phases don't modulate the level as the position moves across them
+		for( size_t k = 0; k < NUM_TAPS; k++ )
+			coefficients[k] = float( coefficients[k] / sum );
+	}
+}
+
+bool DriftCompensator::write( const Buffer *buffer )
+{
+	CI_ASSERT( buffer->getNumChannels() == mRingBuffers.size() );
+
+	const size_t numFrames = buffer->getNumFrames();
+	for( const auto &ringBuffer : mRingBuffers ) {
+		if( ringBuffer.getAvailableWrite() < numFrames )
+			return false;
+	}
+
+	for( size_t ch = 0; ch < mRingBuffers.size(); ch++ )
+		mRingBuffers[ch].write( buffer->getChannel( ch ), numFrames );
+
+	return true;
+}
+
+bool DriftCompensator::read( Buffer *buffer )
+{
+	CI_ASSERT( buffer->getNumChannels() == mRingBuffers.size() );
+	CI_ASSERT( buffer->getNumFrames() <= mFramesPerBlock );
+
+	const size_t numFrames = buffer->getNumFrames();
+	size_t availableRead = getAvailableRead();
+
+	if( ! mPrimed ) {
+		// wait for the target latency, discarding anything beyond it, so the controller starts out settled
+		double numFramesBuffered = getNumFramesBuffered( availableRead );
+		if( numFramesBuffered < mTargetLatencyFrames ) {
+			buffer->zero();
+			return true;
+		}
+
+		discard( size_t( numFramesBuffered - mTargetLatencyFrames ) );
+		availableRead = getAvailableRead();
+		mFilteredFill = getNumFramesBuffered( availableRead );
+		mPrimed = true;
+	}
+	else if( availableRead + mMaxWriteFrames > mRingBuffers[0].getSize() ) {
+		// the writer is about to overrun, which the controller couldn't prevent within getMaxCorrection(), so jump back to the target latency
+		discard( size_t( getNumFramesBuffered( availableRead ) ) - mTargetLatencyFrames );
+		availableRead = getAvailableRead();
+		mFilteredFill = getNumFramesBuffered( availableRead );
+	}
+
+	updateRatio( getNumFramesBuffered( availableRead ), numFrames );
+	const double ratio = mRatio;
+
+	// de-queue enough input for the filter to reach the last output frame
+	const size_t lastIndex = size_t( mPosition + ( numFrames - 1 ) * ratio ) + HALF_TAPS;
+	const size_t numFramesNeeded = lastIndex + 1 > mNumWorkFrames ? lastIndex + 1 - mNumWorkFrames : 0;
+	if( numFramesNeeded > availableRead ) {
+		buffer->zero();
+		mPrimed = false;
+		return false;
+	}
+
+	CI_ASSERT( mNumWorkFrames + numFramesNeeded <= mWorkBuffer.getNumFrames() );
+	for( size_t ch = 0; ch < mRingBuffers.size(); ch++ ) {
+		bool readSuccess = mRingBuffers[ch].read( mWorkBuffer.getChannel( ch ) + mNumWorkFrames, numFramesNeeded );
+		CI_VERIFY( readSuccess );
+	}
+	mNumWorkFrames += numFramesNeeded;
+
+	float *coefficients = mCoefficients.data();
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const double position = mPosition + i * ratio;
+		const size_t index = size_t( position );
+		const double tablePosition = ( position - index ) * NUM_PHASES;
+		const size_t phase = size_t( tablePosition );
+		const float t = float( tablePosition - phase );
+
+		const float *coefficientsA = &mFilterTable[phase * NUM_TAPS];
+		const float *coefficientsB = coefficientsA + NUM_TAPS;
+		for( size_t k = 0; k < NUM_TAPS; k++ )
+			coefficients[k] = coefficientsA[k] + t * ( coefficientsB[k] - coefficientsA[k] );
+
+		const size_t firstTap = index + 1 - HALF_TAPS;
+		for( size_t ch = 0; ch < mRingBuffers.size(); ch++ ) {
+			const float *input = mWorkBuffer.getChannel( ch ) + firstTap;
+			float sum = 0;
+			for( size_t k = 0; k < NUM_TAPS; k++ )
+				sum += input[k] * coefficients[k];
+
+			buffer->getChannel( ch )[i] = sum;
+		}
+	}
+
+	// drop the input that is no longer within reach of the filter
+	mPosition += numFrames * ratio;
+	const size_t numFramesConsumed = size_t( mPosition ) + 1 - HALF_TAPS;
+	if( numFramesConsumed ) {
+		for( size_t ch = 0; ch < mRingBuffers.size(); ch++ ) {
+			float *channel = mWorkBuffer.getChannel( ch );
+			memmove( channel, channel + numFramesConsumed, ( mNumWorkFrames - numFramesConsumed ) * sizeof( float ) );
+		}
+
+		mNumWorkFrames -= numFramesConsumed;
+		mPosition -= numFramesConsumed;
+	}
+
+	return true;
+}
+
+void DriftCompensator::updateRatio( double numFramesBuffered, size_t numFrames )
+{
+	const double seconds = (double)numFrames / (double)mSampleRate;
+
+	mFilteredFill += ( 1 - exp( - seconds / FILL_SMOOTHING_SECONDS ) ) * ( numFramesBuffered - mFilteredFill );
+
+	// the error is positive when too much is buffered, in which case input needs to be consumed faster
+	const double error = ( mFilteredFill - mTargetLatencyFrames ) / (double)mSampleRate;
+	const double integral = mIntegral + error * seconds;
+	double correction = error / CONTROLLER_SECONDS + integral / ( 4 * CONTROLLER_SECONDS * CONTROLLER_SECONDS );
+
+	// only integrate while within range, otherwise the integral winds up and overshoots once the error is corrected
+	if( math<double>::abs( correction ) < mMaxCorrection )
+		mIntegral = integral;
+	else
+		correction = correction > 0 ? mMaxCorrection : - mMaxCorrection;
+
+	mRatio = 1 + correction;
+}
+
+size_t DriftCompensator::getAvailableRead() const
+{
+	size_t result = mRingBuffers[0].getAvailableRead();
+	for( size_t ch = 1; ch < mRingBuffers.size(); ch++ )
+		result = min( result, mRingBuffers[ch].getAvailableRead() );
+
+	return result;
+}
+
+double DriftCompensator::getNumFramesBuffered( size_t availableRead ) const
+{
+	// includes the de-queued frames ahead of the read position
+	return availableRead + ( mNumWorkFrames - mPosition );
+}
+
+void DriftCompensator::discard( size_t numFrames )
+{
+	numFrames = min( numFrames, getAvailableRead() );
+
+	// the unused end of mWorkBuffer serves as scratch space
+	const size_t scratchFrames = mWorkBuffer.getNumFrames() - mNumWorkFrames;
+	while( numFrames ) {
+		const size_t count = min( numFrames, scratchFrames );
+		for( size_t ch = 0; ch < mRingBuffers.size(); ch++ )
+			mRingBuffers[ch].read( mWorkBuffer.getChannel( ch ) + mNumWorkFrames, count );
+
+		numFrames -= count;
+	}
+}
+
+} } } // namespace cinder::audio::dsp
@@ -27,6 +27,21 @@
 
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
+#else
+	#include "cinder/System.h"
+
+	#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+		#define CINDER_AUDIO_DSP_SSE
+		#include <xmmintrin.h>
+		// MSVC emits AVX intrinsics without /arch:AVX, so they can be selected at runtime
+		#if defined( _MSC_VER ) && ( _MSC_VER >= 1600 )
+			#define CINDER_AUDIO_DSP_AVX
+			#include <immintrin.h>
+		#endif
+	#elif defined( __ARM_NEON__ ) || defined( _M_ARM )
+		#define CINDER_AUDIO_DSP_NEON
+		#include <arm_neon.h>
+	#endif
 #endif
 
 using namespace ci;
@@ -104,6 +119,11 @@ void fill( float value, float *array, size_t length )
 	vDSP_vfill( &value, array, 1, length );
 }
 
+void ramp( float begin, float increment, float *array, size_t length )
+{
+	vDSP_vramp( &begin, &increment, array, 1, length );
+}
+
 float sum( const float *array, size_t length )
 {
 	float result;
@@ -139,6 +159,13 @@ float rms( const float *array, size_t length )
 	return result;
 }
 
+float dot( const float *arrayA, const float *arrayB, size_t length )
+{
+	float result;
+	vDSP_dotpr( arrayA, 1, arrayB, 1, &result, length );
+	return result;
+}
+
 void mul( const float *array, float scalar, float *result, size_t length )
 {
 	vDSP_vsmul( array, 1, &scalar, result, 1, length );
@@ -164,50 +191,246 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 	vDSP_vasm( const_cast<float *>( arrayA ), 1, const_cast<float *>( arrayB ), 1, &scalar, result, 1, length );
 }
 
+void mulAdd( const float *array, float scalarMul, float scalarAdd, float *result, size_t length )
+{
+	vDSP_vsmsa( const_cast<float *>( array ), 1, &scalarMul, &scalarAdd, result, 1, length );
+}
+
+void mulRampAdd( const float *array, float begin, float increment, float *result, size_t length )
+{
+	vDSP_vrampmuladd( const_cast<float *>( array ), 1, &begin, &increment, result, 1, length );
+}
+
 #else // ! defined( CINDER_AUDIO_VDSP )
 
+// The routines below process as much of the array as possible with the widest SIMD instruction set available, chosen
+// at runtime with System's CPU detection, and finish any remaining samples with a scalar loop.
+
+namespace {
+
+#if defined( CINDER_AUDIO_DSP_AVX )
+bool sAvxChecked = false, sUseAvx = false;
+
+inline bool useAvx()
+{
+	if( ! sAvxChecked ) {
+		sUseAvx = System::hasAvx();
+		sAvxChecked = true;
+	}
+
+	return sUseAvx;
+}
+#endif
+
+#if defined( CINDER_AUDIO_DSP_SSE )
+	#if defined( _M_X64 ) || defined( __x86_64__ )
+inline bool useSse()	{ return true; } // always available on x86-64
+	#else
+bool sSseChecked = false, sUseSse = false;
+
+inline bool useSse()
+{
+	if( ! sSseChecked ) {
+		sUseSse = System::hasSse2();
+		sSseChecked = true;
+	}
+
+	return sUseSse;
+}
+	#endif
+
+inline float horizontalSum( __m128 v )
+{
+	__m128 shuffled = _mm_movehl_ps( v, v );
+	v = _mm_add_ps( v, shuffled );
+	shuffled = _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+	return _mm_cvtss_f32( _mm_add_ss( v, shuffled ) );
+}
+#endif
+
+#if defined( CINDER_AUDIO_DSP_NEON )
+inline float horizontalSum( float32x4_t v )
+{
+	float32x2_t pairs = vadd_f32( vget_low_f32( v ), vget_high_f32( v ) );
+	return vget_lane_f32( vpadd_f32( pairs, pairs ), 0 );
+}
+#endif
+
+} // anonymous namespace
+
 void fill( float value, float *array, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 v = _mm_set1_ps( value );
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( array + i, v );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	const float32x4_t v = vdupq_n_f32( value );
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( array + i, v );
+#endif
+	for( ; i < length; i++ )
 		array[i] = value;
 }
 
+void ramp( float begin, float increment, float *array, size_t length )
+{
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 b = _mm_set1_ps( begin );
+		const __m128 incr = _mm_set1_ps( increment );
+		const __m128 four = _mm_set1_ps( 4 );
+		__m128 index = _mm_set_ps( 3, 2, 1, 0 );
+		for( ; i + 4 <= length; i += 4 ) {
+			_mm_storeu_ps( array + i, _mm_add_ps( b, _mm_mul_ps( index, incr ) ) );
+			index = _mm_add_ps( index, four );
+		}
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	const float indexInit[4] = { 0, 1, 2, 3 };
+	const float32x4_t b = vdupq_n_f32( begin );
+	const float32x4_t incr = vdupq_n_f32( increment );
+	const float32x4_t four = vdupq_n_f32( 4 );
+	float32x4_t index = vld1q_f32( indexInit );
+	for( ; i + 4 <= length; i += 4 ) {
+		vst1q_f32( array + i, vmlaq_f32( b, index, incr ) );
+		index = vaddq_f32( index, four );
+	}
+#endif
+	// the index is multiplied rather than accumulating increment, so that error doesn't build up over long arrays
+	for( ; i < length; i++ )
+		array[i] = begin + (float)i * increment;
+}
+
 float sum( const float *array, size_t length )
 {
 	float result( 0.0f );
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() && length >= 8 ) {
+		__m256 acc = _mm256_setzero_ps();
+		for( ; i + 8 <= length; i += 8 )
+			acc = _mm256_add_ps( acc, _mm256_loadu_ps( array + i ) );
+
+		result += horizontalSum( _mm_add_ps( _mm256_castps256_ps128( acc ), _mm256_extractf128_ps( acc, 1 ) ) );
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() && i + 4 <= length ) {
+		__m128 acc = _mm_setzero_ps();
+		for( ; i + 4 <= length; i += 4 )
+			acc = _mm_add_ps( acc, _mm_loadu_ps( array + i ) );
+
+		result += horizontalSum( acc );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	if( i + 4 <= length ) {
+		float32x4_t acc = vdupq_n_f32( 0 );
+		for( ; i + 4 <= length; i += 4 )
+			acc = vaddq_f32( acc, vld1q_f32( array + i ) );
+
+		result += horizontalSum( acc );
+	}
+#endif
+	for( ; i < length; i++ )
 		result += array[i];
 	return result;
 }
 
 void add( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 s = _mm_set1_ps( scalar );
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_add_ps( _mm_loadu_ps( array + i ), s ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	const float32x4_t s = vdupq_n_f32( scalar );
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vaddq_f32( vld1q_f32( array + i ), s ) );
+#endif
+	for( ; i < length; i++ )
 		result[i] = array[i] + scalar;
 }
 
 void add( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() ) {
+		for( ; i + 8 <= length; i += 8 )
+			_mm256_storeu_ps( result + i, _mm256_add_ps( _mm256_loadu_ps( arrayA + i ), _mm256_loadu_ps( arrayB + i ) ) );
+
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_add_ps( _mm_loadu_ps( arrayA + i ), _mm_loadu_ps( arrayB + i ) ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vaddq_f32( vld1q_f32( arrayA + i ), vld1q_f32( arrayB + i ) ) );
+#endif
+	for( ; i < length; i++ )
 		result[i] = arrayA[i] + arrayB[i];
 }
 
 void sub( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = array[i] - scalar;
+	add( array, -scalar, result, length );
 }
 
 void sub( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_sub_ps( _mm_loadu_ps( arrayA + i ), _mm_loadu_ps( arrayB + i ) ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vsubq_f32( vld1q_f32( arrayA + i ), vld1q_f32( arrayB + i ) ) );
+#endif
+	for( ; i < length; i++ )
 		result[i] = arrayA[i] - arrayB[i];
 }
 
 float rms( const float *array, size_t length )
 {
 	float sumSquared( 0.0f );
-	for( size_t i = 0; i < length; i++ ) {
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() && length >= 4 ) {
+		__m128 acc = _mm_setzero_ps();
+		for( ; i + 4 <= length; i += 4 ) {
+			__m128 v = _mm_loadu_ps( array + i );
+			acc = _mm_add_ps( acc, _mm_mul_ps( v, v ) );
+		}
+
+		sumSquared += horizontalSum( acc );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	if( length >= 4 ) {
+		float32x4_t acc = vdupq_n_f32( 0 );
+		for( ; i + 4 <= length; i += 4 ) {
+			float32x4_t v = vld1q_f32( array + i );
+			acc = vmlaq_f32( acc, v, v );
+		}
+
+		sumSquared += horizontalSum( acc );
+	}
+#endif
+	for( ; i < length; i++ ) {
 		float val = array[i];
 		sumSquared += val * val;
 	}
@@ -215,15 +438,89 @@ float rms( const float *array, size_t length )
 	return math<float>::sqrt( sumSquared / (float)length );
 }
 
+float dot( const float *arrayA, const float *arrayB, size_t length )
+{
+	float result( 0.0f );
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() && length >= 8 ) {
+		__m256 acc = _mm256_setzero_ps();
+		for( ; i + 8 <= length; i += 8 )
+			acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_loadu_ps( arrayA + i ), _mm256_loadu_ps( arrayB + i ) ) );
+
+		result += horizontalSum( _mm_add_ps( _mm256_castps256_ps128( acc ), _mm256_extractf128_ps( acc, 1 ) ) );
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() && i + 4 <= length ) {
+		__m128 acc = _mm_setzero_ps();
+		for( ; i + 4 <= length; i += 4 )
+			acc = _mm_add_ps( acc, _mm_mul_ps( _mm_loadu_ps( arrayA + i ), _mm_loadu_ps( arrayB + i ) ) );
+
+		result += horizontalSum( acc );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	if( i + 4 <= length ) {
+		float32x4_t acc = vdupq_n_f32( 0 );
+		for( ; i + 4 <= length; i += 4 )
+			acc = vmlaq_f32( acc, vld1q_f32( arrayA + i ), vld1q_f32( arrayB + i ) );
+
+		result += horizontalSum( acc );
+	}
+#endif
+	for( ; i < length; i++ )
+		result += arrayA[i] * arrayB[i];
+	return result;
+}
+
 void mul( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() ) {
+		const __m256 s = _mm256_set1_ps( scalar );
+		for( ; i + 8 <= length; i += 8 )
+			_mm256_storeu_ps( result + i, _mm256_mul_ps( _mm256_loadu_ps( array + i ), s ) );
+
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 s = _mm_set1_ps( scalar );
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_mul_ps( _mm_loadu_ps( array + i ), s ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vmulq_n_f32( vld1q_f32( array + i ), scalar ) );
+#endif
+	for( ; i < length; i++ )
 		result[i] = array[i] * scalar;
 }
 
 void mul( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() ) {
+		for( ; i + 8 <= length; i += 8 )
+			_mm256_storeu_ps( result + i, _mm256_mul_ps( _mm256_loadu_ps( arrayA + i ), _mm256_loadu_ps( arrayB + i ) ) );
+
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_mul_ps( _mm_loadu_ps( arrayA + i ), _mm_loadu_ps( arrayB + i ) ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vmulq_f32( vld1q_f32( arrayA + i ), vld1q_f32( arrayB + i ) ) );
+#endif
+	for( ; i < length; i++ )
 		result[i] = arrayA[i] * arrayB[i];
 }
 
@@ -234,16 +531,118 @@ void divide( const float *array, float scalar, float *result, size_t length )
 
 void divide( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_div_ps( _mm_loadu_ps( arrayA + i ), _mm_loadu_ps( arrayB + i ) ) );
+	}
+#endif
+	for( ; i < length; i++ )
 		result[i] = arrayA[i] / arrayB[i];
 }
 
 void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() ) {
+		const __m256 s = _mm256_set1_ps( scalar );
+		for( ; i + 8 <= length; i += 8 )
+			_mm256_storeu_ps( result + i, _mm256_mul_ps( _mm256_add_ps( _mm256_loadu_ps( arrayA + i ), _mm256_loadu_ps( arrayB + i ) ), s ) );
+
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 s = _mm_set1_ps( scalar );
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( arrayA + i ), _mm_loadu_ps( arrayB + i ) ), s ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vmulq_n_f32( vaddq_f32( vld1q_f32( arrayA + i ), vld1q_f32( arrayB + i ) ), scalar ) );
+#endif
+	for( ; i < length; i++ )
 		result[i] = ( arrayA[i] + arrayB[i] ) * scalar;
 }
 
+void mulAdd( const float *array, float scalarMul, float scalarAdd, float *result, size_t length )
+{
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() ) {
+		const __m256 m = _mm256_set1_ps( scalarMul );
+		const __m256 a = _mm256_set1_ps( scalarAdd );
+		for( ; i + 8 <= length; i += 8 )
+			_mm256_storeu_ps( result + i, _mm256_add_ps( _mm256_mul_ps( _mm256_loadu_ps( array + i ), m ), a ) );
+
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 m = _mm_set1_ps( scalarMul );
+		const __m128 a = _mm_set1_ps( scalarAdd );
+		for( ; i + 4 <= length; i += 4 )
+			_mm_storeu_ps( result + i, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( array + i ), m ), a ) );
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	const float32x4_t a = vdupq_n_f32( scalarAdd );
+	for( ; i + 4 <= length; i += 4 )
+		vst1q_f32( result + i, vmlaq_n_f32( a, vld1q_f32( array + i ), scalarMul ) );
+#endif
+	for( ; i < length; i++ )
+		result[i] = array[i] * scalarMul + scalarAdd;
+}
+
+void mulRampAdd( const float *array, float begin, float increment, float *result, size_t length )
+{
+	size_t i = 0;
+#if defined( CINDER_AUDIO_DSP_AVX )
+	if( useAvx() ) {
+		const __m256 b = _mm256_set1_ps( begin );
+		const __m256 incr = _mm256_set1_ps( increment );
+		const __m256 eight = _mm256_set1_ps( 8 );
+		__m256 index = _mm256_set_ps( 7, 6, 5, 4, 3, 2, 1, 0 );
+		for( ; i + 8 <= length; i += 8 ) {
+			const __m256 gain = _mm256_add_ps( b, _mm256_mul_ps( index, incr ) );
+			_mm256_storeu_ps( result + i, _mm256_add_ps( _mm256_loadu_ps( result + i ), _mm256_mul_ps( _mm256_loadu_ps( array + i ), gain ) ) );
+			index = _mm256_add_ps( index, eight );
+		}
+
+		_mm256_zeroupper();
+	}
+#endif
+#if defined( CINDER_AUDIO_DSP_SSE )
+	if( useSse() ) {
+		const __m128 b = _mm_set1_ps( begin );
+		const __m128 incr = _mm_set1_ps( increment );
+		const __m128 four = _mm_set1_ps( 4 );
+		__m128 index = _mm_set_ps( (float)i + 3, (float)i + 2, (float)i + 1, (float)i );
+		for( ; i + 4 <= length; i += 4 ) {
+			const __m128 gain = _mm_add_ps( b, _mm_mul_ps( index, incr ) );
+			_mm_storeu_ps( result + i, _mm_add_ps( _mm_loadu_ps( result + i ), _mm_mul_ps( _mm_loadu_ps( array + i ), gain ) ) );
+			index = _mm_add_ps( index, four );
+		}
+	}
+#elif defined( CINDER_AUDIO_DSP_NEON )
+	const float indexInit[4] = { 0, 1, 2, 3 };
+	const float32x4_t b = vdupq_n_f32( begin );
+	const float32x4_t incr = vdupq_n_f32( increment );
+	const float32x4_t four = vdupq_n_f32( 4 );
+	float32x4_t index = vld1q_f32( indexInit );
+	for( ; i + 4 <= length; i += 4 ) {
+		const float32x4_t gain = vmlaq_f32( b, index, incr );
+		vst1q_f32( result + i, vmlaq_f32( vld1q_f32( result + i ), vld1q_f32( array + i ), gain ) );
+		index = vaddq_f32( index, four );
+	}
+#endif
+	for( ; i < length; i++ )
+		result[i] += array[i] * ( begin + (float)i * increment );
+}
+
 #endif // ! defined( CINDER_AUDIO_VDSP )
 
 void normalize( float *array, size_t length, float maxValue )
@@ -21,6 +21,7 @@
  POSSIBILITY OF SUCH DAMAGE.
 */
 
+
 #include "cinder/audio/dsp/Fft.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/audio/Exception.h"
@@ -30,8 +31,17 @@
 	#include "cinder/audio/dsp/ooura/fftsg.h"
 #endif
 
+#include <map>
+#include <mutex>
+
 namespace cinder { namespace audio { namespace dsp {
 
+namespace {
+
+std::mutex sPlanCacheMutex;
+
+} // anonymous namespace
+
 Fft::Fft( size_t fftSize )
 : mSize( fftSize )
 {
@@ -39,40 +49,73 @@ Fft::Fft( size_t fftSize )
 		throw AudioExc( "invalid fft size" );
 
 	mSizeOverTwo = mSize / 2;
+	mPlan = getPlan( mSize );
 
 	init();
 }
 
+void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+
+	forwardImpl( waveform->getData(), spectral->getReal(), spectral->getImag() );
+}
+
+void Fft::forward( const Buffer *waveform, std::vector<BufferSpectral> *spectra )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+
+	if( spectra->size() != waveform->getNumChannels() )
+		spectra->resize( waveform->getNumChannels(), BufferSpectral( mSize ) );
+
+	for( size_t ch = 0; ch < waveform->getNumChannels(); ch++ ) {
+		BufferSpectral &spectral = (*spectra)[ch];
+		CI_ASSERT( spectral.getNumFrames() == mSizeOverTwo );
+
+		forwardImpl( waveform->getChannel( ch ), spectral.getReal(), spectral.getImag() );
+	}
+}
+
 #if defined( CINDER_AUDIO_VDSP )
 
+struct Fft::Plan {
+	Plan( size_t fftSize )
+	{
+		mFftSetup = vDSP_create_fftsetup( (vDSP_Length)log2f( fftSize ), FFT_RADIX2 );
+		CI_ASSERT( mFftSetup );
+	}
+
+	~Plan()
+	{
+		vDSP_destroy_fftsetup( mFftSetup );
+	}
+
+	::FFTSetup	mFftSetup;
+};
+
 void Fft::init()
 {
 	mSplitComplexResult.realp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
 	mSplitComplexResult.imagp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
 
 	mLog2FftSize = log2f( mSize );
-	mFftSetup = vDSP_create_fftsetup( mLog2FftSize, FFT_RADIX2 );
-	CI_ASSERT( mFftSetup );
 }
 
 Fft::~Fft()
 {
 	free( mSplitComplexResult.realp );
 	free( mSplitComplexResult.imagp );
-	vDSP_destroy_fftsetup( mFftSetup );
 }
 
-void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+void Fft::forwardImpl( const float *waveform, float *real, float *imag )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
-
-	mSplitComplexSignal.realp = spectral->getReal();
-	mSplitComplexSignal.imagp = spectral->getImag();
+	mSplitComplexSignal.realp = real;
+	mSplitComplexSignal.imagp = imag;
 
 	// in-place transfrom is okay here because we already first copy the data from waveform -> spectral
-	vDSP_ctoz( (::DSPComplex *)waveform->getData(), 2, &mSplitComplexSignal, 1, mSizeOverTwo );
-	vDSP_fft_zrip( mFftSetup, &mSplitComplexSignal, 1, mLog2FftSize, FFT_FORWARD );
+	vDSP_ctoz( (const ::DSPComplex *)waveform, 2, &mSplitComplexSignal, 1, mSizeOverTwo );
+	vDSP_fft_zrip( mPlan->mFftSetup, &mSplitComplexSignal, 1, mLog2FftSize, FFT_FORWARD );
 }
 
 void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
@@ -85,40 +128,60 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	float *data = waveform->getData();
 
 	// use out-of-place transfrom so as to not overwrite spectral
-	vDSP_fft_zrop( mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mLog2FftSize, FFT_INVERSE );
+	vDSP_fft_zrop( mPlan->mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mLog2FftSize, FFT_INVERSE );
 	vDSP_ztoc( &mSplitComplexResult, 1, (::DSPComplex *)data, 2, mSizeOverTwo );
 
 	float scale = 1.0f / float( 2 * mSize );
 	vDSP_vsmul( data, 1, &scale, data, 1, mSize );
 }
 
+void Fft::computeMagnitudes( const Buffer *waveform, Buffer *magnitudes, float scale )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+	CI_ASSERT( magnitudes->getNumFrames() == mSizeOverTwo && magnitudes->getNumChannels() == waveform->getNumChannels() );
+
+	for( size_t ch = 0; ch < waveform->getNumChannels(); ch++ ) {
+		float *mag = magnitudes->getChannel( ch );
+
+		// the result's split buffers serve as scratch, so nothing is written to a BufferSpectral
+		forwardImpl( waveform->getChannel( ch ), mSplitComplexResult.realp, mSplitComplexResult.imagp );
+		mSplitComplexResult.imagp[0] = 0; // discard nyquist
+
+		vDSP_zvabs( &mSplitComplexResult, 1, mag, 1, mSizeOverTwo );
+		vDSP_vsmul( mag, 1, &scale, mag, 1, mSizeOverTwo );
+	}
+}
+
 #elif defined( CINDER_AUDIO_FFT_OOURA )
 
+struct Fft::Plan {
+	Plan( size_t fftSize )
+		: mOouraIp( 2 + (int)sqrt( fftSize / 2 ), 0 ), mOouraW( fftSize / 2, 0 )
+	{
+		// Ooura builds its tables on the first transform and only reads them afterwards, so do that here to make them safe to share.
+		std::vector<float> a( fftSize, 0 );
+		ooura::rdft( (int)fftSize, 1, a.data(), mOouraIp.data(), mOouraW.data() );
+	}
+
+	std::vector<int>	mOouraIp;
+	std::vector<float>	mOouraW;
+};
+
 void Fft::init()
 {
-	mOouraIp = (int *)calloc( 2 + (int)sqrt( mSizeOverTwo ), sizeof( int ) );
-	mOouraW = (float *)calloc( mSizeOverTwo, sizeof( float ) );
 	mBufferCopy = Buffer( mSize );
 }
 
 Fft::~Fft()
 {
-	free( mOouraIp );
-	free( mOouraW );
 }
 
-void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+void Fft::forwardImpl( const float *waveform, float *real, float *imag )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
-
-	mBufferCopy.copy( *waveform );
-
 	float *a = mBufferCopy.getData();
-	float *real = spectral->getReal();
-	float *imag = spectral->getImag();
+	memcpy( a, waveform, mSize * sizeof( float ) );
 
-	ooura::rdft( (int)mSize, 1, a, mOouraIp, mOouraW );
+	ooura::rdft( (int)mSize, 1, a, mPlan->mOouraIp.data(), mPlan->mOouraW.data() );
 
 	real[0] = a[0];
 	imag[0] = a[1];
@@ -134,7 +197,8 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *spectral );
+	// BufferT::copy() would only copy the real channel, since the channel counts differ. Copy both components instead.
+	memcpy( mBufferCopy.getData(), spectral->getData(), mSize * sizeof( float ) );
 
 	float *real = mBufferCopy.getData();
 	float *imag = &mBufferCopy.getData()[mSizeOverTwo];
@@ -148,10 +212,48 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 		a[k * 2 + 1] = imag[k];
 	}
 
-	ooura::rdft( (int)mSize, -1, a, mOouraIp, mOouraW );
+	ooura::rdft( (int)mSize, -1, a, mPlan->mOouraIp.data(), mPlan->mOouraW.data() );
 	dsp::mul( a, 2.0f / (float)mSize, a, mSize );
 }
 
+void Fft::computeMagnitudes( const Buffer *waveform, Buffer *magnitudes, float scale )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+	CI_ASSERT( magnitudes->getNumFrames() == mSizeOverTwo && magnitudes->getNumChannels() == waveform->getNumChannels() );
+
+	float *a = mBufferCopy.getData();
+	for( size_t ch = 0; ch < waveform->getNumChannels(); ch++ ) {
+		memcpy( a, waveform->getChannel( ch ), mSize * sizeof( float ) );
+		ooura::rdft( (int)mSize, 1, a, mPlan->mOouraIp.data(), mPlan->mOouraW.data() );
+
+		// read the interleaved result directly, a[1] holds the nyquist component which is discarded
+		float *mag = magnitudes->getChannel( ch );
+		mag[0] = math<float>::abs( a[0] ) * scale;
+		for( size_t k = 1; k < mSizeOverTwo; k++ ) {
+			float re = a[k * 2];
+			float im = a[k * 2 + 1];
+			mag[k] = math<float>::sqrt( re * re + im * im ) * scale;
+		}
+	}
+}
+
 #endif // defined( CINDER_AUDIO_FFT_OOURA )
 
+std::shared_ptr<Fft::Plan> Fft::getPlan( size_t fftSize )
+{
+	std::lock_guard<std::mutex> lock( sPlanCacheMutex );
+
+	// plans are only kept alive by the Fft objects using them
+	static std::map<size_t, std::weak_ptr<Plan> > sPlans;
+
+	auto &cached = sPlans[fftSize];
+	auto result = cached.lock();
+	if( ! result ) {
+		result = std::make_shared<Plan>( fftSize );
+		cached = result;
+	}
+
+	return result;
+}
+
 } } } // namespace cinder::audio::dsp
@@ -29,16 +29,18 @@
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/RingBuffer.h"
+#include "cinder/audio/dsp/DriftCompensator.h"
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/audio/Exception.h"
 #include "cinder/audio/Debug.h"
 #include "cinder/msw/CinderMsw.h"
 #include "cinder/CinderAssert.h"
+#include "cinder/CinderMath.h"
+#include "cinder/System.h"
 
+#include <algorithm>
 #include <Audioclient.h>
 #include <mmdeviceapi.h>
-#include <avrt.h>
-#pragma comment(lib, "avrt.lib")
 
 namespace {
 
@@ -51,7 +53,20 @@ const size_t CAPTURE_CONVERSION_PADDING_FACTOR = 2;
 // converts to 100-nanoseconds
 inline ::REFERENCE_TIME samplesToReferenceTime( size_t samples, size_t sampleRate )
 {
-	return (::REFERENCE_TIME)( (double)samples * 10000000.0 / (double)sampleRate );
+	return (::REFERENCE_TIME)( (double)samples * 10000000.0 / (double)sampleRate + 0.5 );
+}
+
+// The IAudioClient share mode can only be changed by re-initializing it, which is done for all Node's in the same way as when Device params change.
+void reinitializeContextWithExclusiveMode( const cinder::audio::ContextRef &context, bool *exclusiveMode, bool exclusive )
+{
+	bool wasEnabled = context->isEnabled();
+	context->disable();
+	context->uninitializeAllNodes();
+
+	*exclusiveMode = exclusive;
+
+	context->initializeAllNodes();
+	context->setEnabled( wasEnabled );
 }
 
 } // anonymous namespace
@@ -63,12 +78,26 @@ namespace cinder { namespace audio { namespace msw {
 struct WasapiAudioClientImpl {
 	WasapiAudioClientImpl();
 
+	//! The sample format of the IAudioClient's buffer. Shared mode always uses FLOAT32, exclusive mode uses the first format the device supports.
+	enum class SampleType { FLOAT32, INT32, INT16 };
+
 	unique_ptr<::IAudioClient, ci::msw::ComDeleter>		mAudioClient;
 
-	size_t	mNumFramesBuffered, mAudioClientNumFrames, mNumChannels;
+	size_t		mNumFramesBuffered, mAudioClientNumFrames, mNumChannels;
+	bool		mExclusiveMode;
+	SampleType	mSampleType;
 
   protected:
 	void initAudioClient( const DeviceRef &device, size_t numChannels, HANDLE eventHandle );
+
+	//! Converts interleaved float samples to the IAudioClient's format.
+	void convertToClientFormat( const float *source, BYTE *dest, size_t numSamples ) const;
+	//! Converts interleaved samples in the IAudioClient's format to float.
+	void convertFromClientFormat( const BYTE *source, float *dest, size_t numSamples ) const;
+
+  private:
+	void activateAudioClient( const DeviceRef &device );
+	shared_ptr<::WAVEFORMATEX> findExclusiveFormat( size_t sampleRate, size_t numChannels );
 };
 
 struct WasapiRenderClientImpl : public WasapiAudioClientImpl {
@@ -89,11 +118,12 @@ private:
 	void initRenderClient();
 	void runRenderThread();
 	void renderAudio();
-	void increaseThreadPriority();
 
 	static DWORD __stdcall renderThreadEntryPoint( LPVOID Context );
 
 	OutputDeviceNodeWasapi*	mOutputDeviceNode; // weak pointer to parent
+	bool					mIsFirstRender;
+	vector<float>			mConversionBuffer;		// used when the IAudioClient's format is not float
 };
 
 struct WasapiCaptureClientImpl : public WasapiAudioClientImpl {
@@ -105,7 +135,7 @@ struct WasapiCaptureClientImpl : public WasapiAudioClientImpl {
 
 	unique_ptr<::IAudioCaptureClient, ci::msw::ComDeleter>	mCaptureClient;
 
-	vector<dsp::RingBuffer>				mRingBuffers;
+	unique_ptr<dsp::DriftCompensator>	mDriftCompensator;
 
   private:
 	void initCapture();
@@ -123,60 +153,102 @@ struct WasapiCaptureClientImpl : public WasapiAudioClientImpl {
 // ----------------------------------------------------------------------------------------------------
 
 WasapiAudioClientImpl::WasapiAudioClientImpl()
-	: mAudioClientNumFrames( DEFAULT_AUDIOCLIENT_FRAMES ), mNumFramesBuffered( 0 ), mNumChannels( 0 )
+	: mAudioClientNumFrames( DEFAULT_AUDIOCLIENT_FRAMES ), mNumFramesBuffered( 0 ), mNumChannels( 0 ), mExclusiveMode( false ), mSampleType( SampleType::FLOAT32 )
 {
 }
 
-void WasapiAudioClientImpl::initAudioClient( const DeviceRef &device, size_t numChannels, HANDLE eventHandle )
+void WasapiAudioClientImpl::activateAudioClient( const DeviceRef &device )
 {
-	CI_ASSERT( ! mAudioClient );
-
 	DeviceManagerWasapi *manager = dynamic_cast<DeviceManagerWasapi *>( Context::deviceManager() );
 	CI_ASSERT( manager );
 
-	//auto device = mInputDeviceNode->getDevice();
 	shared_ptr<::IMMDevice> immDevice = manager->getIMMDevice( device );
 
 	::IAudioClient *audioClient;
 	HRESULT hr = immDevice->Activate( __uuidof(::IAudioClient), CLSCTX_ALL, NULL, (void**)&audioClient );
 	CI_ASSERT( hr == S_OK );
 	mAudioClient = ci::msw::makeComUnique( audioClient );
+}
+
+void WasapiAudioClientImpl::initAudioClient( const DeviceRef &device, size_t numChannels, HANDLE eventHandle )
+{
+	CI_ASSERT( ! mAudioClient );
+
+	activateAudioClient( device );
 
 	size_t sampleRate = device->getSampleRate();
-	auto wfx = interleavedFloatWaveFormat( sampleRate, numChannels );
-	::WAVEFORMATEX *closestMatch;
-	hr = mAudioClient->IsFormatSupported( ::AUDCLNT_SHAREMODE_SHARED, wfx.get(), &closestMatch );
-	// S_FALSE indicates that a closest match was provided. AUDCLNT_E_UNSUPPORTED_FORMAT seems to be unreliable,
-	// so we accept it too and try to Initialize() optimistically.
-	if( hr == S_FALSE ) {
-		CI_ASSERT_MSG( closestMatch, "expected closestMatch" );
-		auto scopedClosestMatch = shared_ptr<::WAVEFORMATEX>( closestMatch, ::CoTaskMemFree );
-
-		// If possible, update wfx to the closestMatch. Currently this can only be done if the channels are different.
-		if( closestMatch->wFormatTag != wfx->wFormatTag )
-			throw AudioFormatExc( "IAudioClient requested WAVEFORMATEX 'closest match' of unexpected format type." );
-		if( closestMatch->cbSize != wfx->cbSize )
-			throw AudioFormatExc( "IAudioClient requested WAVEFORMATEX 'closest match' of unexpected cbSize." );
-		if( closestMatch->nSamplesPerSec != wfx->nSamplesPerSec )
-			throw AudioFormatExc( "IAudioClient requested WAVEFORMATEX 'closest match' of unexpected samplerate." );
-
-		wfx->nChannels = closestMatch->nChannels;
-		wfx->nAvgBytesPerSec = closestMatch->nAvgBytesPerSec;
-		wfx->nBlockAlign = closestMatch->nBlockAlign;
-		wfx->wBitsPerSample = closestMatch->wBitsPerSample;
-	}
-	else if( hr != S_OK && hr != AUDCLNT_E_UNSUPPORTED_FORMAT ) {
-		throw AudioExc( "Format unsupported by IAudioClient", (int32_t)hr );
+	DWORD streamFlags = eventHandle ? AUDCLNT_STREAMFLAGS_EVENTCALLBACK : 0;
+
+	if( mExclusiveMode ) {
+		auto wfx = findExclusiveFormat( sampleRate, numChannels );
+		mNumChannels = numChannels;
+
+		// Request the smallest period the device supports. In event driven mode the buffer duration must equal the period,
+		// otherwise the buffer is made large enough to hold mAudioClientNumFrames (it is polled once per processing block).
+		::REFERENCE_TIME minimumPeriod;
+		HRESULT hr = mAudioClient->GetDevicePeriod( NULL, &minimumPeriod );
+		CI_ASSERT( hr == S_OK );
+
+		::REFERENCE_TIME duration = eventHandle ? minimumPeriod : max( minimumPeriod, samplesToReferenceTime( mAudioClientNumFrames, sampleRate ) );
+		hr = mAudioClient->Initialize( ::AUDCLNT_SHAREMODE_EXCLUSIVE, streamFlags, duration, minimumPeriod, wfx.get(), NULL );
+		if( hr == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED ) {
+			// The device requires a buffer size aligned to its own granularity. GetBufferSize() returns the next aligned size,
+			// from which the duration is recalculated. The IAudioClient must be recreated before calling Initialize() again.
+			UINT32 alignedNumFrames;
+			hr = mAudioClient->GetBufferSize( &alignedNumFrames );
+			CI_ASSERT( hr == S_OK );
+
+			duration = samplesToReferenceTime( alignedNumFrames, sampleRate );
+			::REFERENCE_TIME period = eventHandle ? duration : minimumPeriod;
+
+			mAudioClient.reset();
+			activateAudioClient( device );
+			hr = mAudioClient->Initialize( ::AUDCLNT_SHAREMODE_EXCLUSIVE, streamFlags, duration, period, wfx.get(), NULL );
+		}
+
+		if( hr == AUDCLNT_E_DEVICE_IN_USE )
+			throw AudioDeviceExc( "Could not initialize IAudioClient in exclusive mode, device is in use by another application." );
+		if( hr == AUDCLNT_E_EXCLUSIVE_MODE_NOT_ALLOWED )
+			throw AudioDeviceExc( "Could not initialize IAudioClient in exclusive mode, exclusive mode is disabled for this device." );
+		if( hr != S_OK )
+			throw AudioExc( "Could not initialize IAudioClient in exclusive mode", (int32_t)hr );
 	}
+	else {
+		mSampleType = SampleType::FLOAT32;
+		auto wfx = interleavedFloatWaveFormat( sampleRate, numChannels );
+		::WAVEFORMATEX *closestMatch;
+		HRESULT hr = mAudioClient->IsFormatSupported( ::AUDCLNT_SHAREMODE_SHARED, wfx.get(), &closestMatch );
+		// S_FALSE indicates that a closest match was provided. AUDCLNT_E_UNSUPPORTED_FORMAT seems to be unreliable,
+		// so we accept it too and try to Initialize() optimistically.
+		if( hr == S_FALSE ) {
+			CI_ASSERT_MSG( closestMatch, "expected closestMatch" );
+			auto scopedClosestMatch = shared_ptr<::WAVEFORMATEX>( closestMatch, ::CoTaskMemFree );
+
+			// If possible, update wfx to the closestMatch. Currently this can only be done if the channels are different.
+			if( closestMatch->wFormatTag != wfx->wFormatTag )
+				throw AudioFormatExc( "IAudioClient requested WAVEFORMATEX 'closest match' of unexpected format type." );
+			if( closestMatch->cbSize != wfx->cbSize )
+				throw AudioFormatExc( "IAudioClient requested WAVEFORMATEX 'closest match' of unexpected cbSize." );
+			if( closestMatch->nSamplesPerSec != wfx->nSamplesPerSec )
+				throw AudioFormatExc( "IAudioClient requested WAVEFORMATEX 'closest match' of unexpected samplerate." );
+
+			wfx->nChannels = closestMatch->nChannels;
+			wfx->nAvgBytesPerSec = closestMatch->nAvgBytesPerSec;
+			wfx->nBlockAlign = closestMatch->nBlockAlign;
+			wfx->wBitsPerSample = closestMatch->wBitsPerSample;
+		}
+		else if( hr != S_OK && hr != AUDCLNT_E_UNSUPPORTED_FORMAT ) {
+			throw AudioExc( "Format unsupported by IAudioClient", (int32_t)hr );
+		}
 
-	mNumChannels = wfx->nChannels; // in preparation for using closesMatch
+		mNumChannels = wfx->nChannels; // in preparation for using closesMatch
 
-	::REFERENCE_TIME requestedDuration = samplesToReferenceTime( mAudioClientNumFrames, sampleRate );
-	DWORD streamFlags = eventHandle ? AUDCLNT_STREAMFLAGS_EVENTCALLBACK : 0;
+		::REFERENCE_TIME requestedDuration = samplesToReferenceTime( mAudioClientNumFrames, sampleRate );
 
-	hr = mAudioClient->Initialize( ::AUDCLNT_SHAREMODE_SHARED, streamFlags, requestedDuration, 0, wfx.get(), NULL );
-	if( hr != S_OK )
-		throw AudioExc( "Could not initialize IAudioClient", (int32_t)hr );
+		hr = mAudioClient->Initialize( ::AUDCLNT_SHAREMODE_SHARED, streamFlags, requestedDuration, 0, wfx.get(), NULL );
+		if( hr != S_OK )
+			throw AudioExc( "Could not initialize IAudioClient", (int32_t)hr );
+	}
 
 	if( eventHandle ) {
 		// enable event driven rendering.
@@ -185,18 +257,90 @@ void WasapiAudioClientImpl::initAudioClient( const DeviceRef &device, size_t num
 	}
 
 	UINT32 actualNumFrames;
-	hr = mAudioClient->GetBufferSize( &actualNumFrames );
+	HRESULT hr = mAudioClient->GetBufferSize( &actualNumFrames );
 	CI_ASSERT( hr == S_OK );
 
 	mAudioClientNumFrames = actualNumFrames; // update with the actual size
 }
 
+// Exclusive mode bypasses the system mixer, so the device must natively support the format and no 'closest match' is provided.
+// Float is tried first to avoid conversions, followed by the integer formats commonly supported by hardware.
+shared_ptr<::WAVEFORMATEX> WasapiAudioClientImpl::findExclusiveFormat( size_t sampleRate, size_t numChannels )
+{
+	struct Candidate {
+		SampleType	mSampleType;
+		size_t		mBitsPerSample, mValidBitsPerSample;
+	};
+
+	const Candidate candidates[] = {
+		{ SampleType::FLOAT32, 32, 32 },
+		{ SampleType::INT32, 32, 32 },
+		{ SampleType::INT32, 32, 24 },
+		{ SampleType::INT16, 16, 16 }
+	};
+
+	for( const auto &candidate : candidates ) {
+		auto wfx = candidate.mSampleType == SampleType::FLOAT32 ? interleavedFloatWaveFormat( sampleRate, numChannels ) : interleavedPcmWaveFormat( sampleRate, numChannels, candidate.mBitsPerSample, candidate.mValidBitsPerSample );
+		HRESULT hr = mAudioClient->IsFormatSupported( ::AUDCLNT_SHAREMODE_EXCLUSIVE, wfx.get(), NULL );
+		if( hr == S_OK ) {
+			mSampleType = candidate.mSampleType;
+			return wfx;
+		}
+	}
+
+	throw AudioFormatExc( "Device does not support exclusive mode with " + to_string( numChannels ) + " channels at samplerate " + to_string( sampleRate ) + "." );
+}
+
+void WasapiAudioClientImpl::convertToClientFormat( const float *source, BYTE *dest, size_t numSamples ) const
+{
+	switch( mSampleType ) {
+		case SampleType::FLOAT32:
+			memcpy( dest, source, numSamples * sizeof( float ) );
+			break;
+		case SampleType::INT32: {
+			int32_t *destInt = reinterpret_cast<int32_t *>( dest );
+			for( size_t i = 0; i < numSamples; i++ )
+				destInt[i] = int32_t( (double)math<float>::clamp( source[i], -1, 1 ) * 2147483647.0 );
+			break;
+		}
+		case SampleType::INT16: {
+			int16_t *destInt = reinterpret_cast<int16_t *>( dest );
+			for( size_t i = 0; i < numSamples; i++ )
+				destInt[i] = int16_t( math<float>::clamp( source[i], -1, 1 ) * 32767.0f );
+			break;
+		}
+		default: CI_ASSERT_NOT_REACHABLE();
+	}
+}
+
+void WasapiAudioClientImpl::convertFromClientFormat( const BYTE *source, float *dest, size_t numSamples ) const
+{
+	switch( mSampleType ) {
+		case SampleType::FLOAT32:
+			memcpy( dest, source, numSamples * sizeof( float ) );
+			break;
+		case SampleType::INT32: {
+			const int32_t *sourceInt = reinterpret_cast<const int32_t *>( source );
+			for( size_t i = 0; i < numSamples; i++ )
+				dest[i] = float( (double)sourceInt[i] * ( 1.0 / 2147483648.0 ) );
+			break;
+		}
+		case SampleType::INT16: {
+			const int16_t *sourceInt = reinterpret_cast<const int16_t *>( source );
+			for( size_t i = 0; i < numSamples; i++ )
+				dest[i] = (float)sourceInt[i] * 3.0517578125e-05f;	// 1.0 / 32768.0
+			break;
+		}
+		default: CI_ASSERT_NOT_REACHABLE();
+	}
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - WasapiRenderClientImpl
 // ----------------------------------------------------------------------------------------------------
 
 WasapiRenderClientImpl::WasapiRenderClientImpl( OutputDeviceNodeWasapi *lineOut )
-	: WasapiAudioClientImpl(), mOutputDeviceNode( lineOut )
+	: WasapiAudioClientImpl(), mOutputDeviceNode( lineOut ), mIsFirstRender( true )
 {
 	// create render events
 	mRenderSamplesReadyEvent = ::CreateEvent( NULL, FALSE, FALSE, NULL );
@@ -226,6 +370,10 @@ void WasapiRenderClientImpl::init()
 	success = ::ResetEvent( mRenderSamplesReadyEvent );
 	CI_ASSERT( success );
 
+	// reset state from a previous initialization, which happens when the share mode changes.
+	mAudioClientNumFrames = DEFAULT_AUDIOCLIENT_FRAMES;
+	mNumFramesBuffered = 0;
+
 	initAudioClient( mOutputDeviceNode->getDevice(), mOutputDeviceNode->getNumChannels(), mRenderSamplesReadyEvent );
 	initRenderClient();
 }
@@ -258,6 +406,11 @@ void WasapiRenderClientImpl::initRenderClient()
 	const size_t ringBufferSize = ( mAudioClientNumFrames + mOutputDeviceNode->getFramesPerBlock() ) * mNumChannels;
 	mRingBuffer.reset( new dsp::RingBuffer( ringBufferSize ) );
 
+	if( mSampleType != SampleType::FLOAT32 )
+		mConversionBuffer.resize( mAudioClientNumFrames * mNumChannels );
+	else
+		mConversionBuffer.clear();
+
 	mRenderThread = ::CreateThread( NULL, 0, renderThreadEntryPoint, this, 0, NULL );
 	CI_ASSERT( mRenderThread );
 }
@@ -273,7 +426,13 @@ DWORD WasapiRenderClientImpl::renderThreadEntryPoint( ::LPVOID lpParameter )
 
 void WasapiRenderClientImpl::runRenderThread()
 {
-	increaseThreadPriority();
+	// capture is pulled from within the graph, so InputDeviceNodeWasapi is serviced on this thread as well.
+	// This uses the "Multimedia Class Scheduler Service" (MMCSS) to increase the priority of the thread, at critical priority in exclusive mode.
+	// The priority increase can be seen in the threads debugger, it should have Priority = "Time Critical"
+	const double blockSeconds = (double)mOutputDeviceNode->getOutputFramesPerBlock() / (double)mOutputDeviceNode->getOutputSampleRate();
+	System::setThreadName( "WASAPI render" );
+	if( ! System::setThreadRealtime( blockSeconds, blockSeconds / 2, mExclusiveMode ) )
+		CI_LOG_W( "Unable to raise the priority of the render thread, error: " << GetLastError() );
 
 	HANDLE waitEvents[2] = { mRenderShouldQuitEvent, mRenderSamplesReadyEvent };
 	bool running = true;
@@ -291,45 +450,53 @@ void WasapiRenderClientImpl::runRenderThread()
 				CI_ASSERT_NOT_REACHABLE();
 		}
 	}
+
+	System::setThreadPriority( System::PRIORITY_NORMAL );
 }
 
 void WasapiRenderClientImpl::renderAudio()
 {
 	// the current padding represents the number of frames queued on the audio endpoint, waiting to be sent to hardware.
-	UINT32 numFramesPadding;
-	HRESULT hr = mAudioClient->GetCurrentPadding( &numFramesPadding );
-	CI_ASSERT( hr == S_OK );
+	// In exclusive event driven mode, the entire buffer (one device period) is filled on each event.
+	UINT32 numFramesPadding = 0;
+	HRESULT hr;
+	if( ! mExclusiveMode ) {
+		hr = mAudioClient->GetCurrentPadding( &numFramesPadding );
+		CI_ASSERT( hr == S_OK );
+	}
+
+	// if the endpoint has run out of frames since the last render, the hardware was starved and this counts as an xrun.
+	if( numFramesPadding == 0 && ! mIsFirstRender && ! mExclusiveMode ) {
+		auto ctx = mOutputDeviceNode->getContext();
+		if( ctx )
+			ctx->markXrun();
+	}
+	mIsFirstRender = false;
 
 	size_t numWriteFramesAvailable = mAudioClientNumFrames - numFramesPadding;
 
 	while( mNumFramesBuffered < numWriteFramesAvailable )
 		mOutputDeviceNode->renderInputs();
 
-	float *renderBuffer;
-	hr = mRenderClient->GetBuffer( numWriteFramesAvailable, (BYTE **)&renderBuffer );
+	BYTE *renderBuffer;
+	hr = mRenderClient->GetBuffer( numWriteFramesAvailable, &renderBuffer );
 	CI_ASSERT( hr == S_OK );
 
 	DWORD bufferFlags = 0;
 	size_t numReadSamples = numWriteFramesAvailable * mNumChannels;
-	bool readSuccess = mRingBuffer->read( renderBuffer, numReadSamples );
+	float *readBuffer = mConversionBuffer.empty() ? (float *)renderBuffer : mConversionBuffer.data();
+	bool readSuccess = mRingBuffer->read( readBuffer, numReadSamples );
 	CI_ASSERT( readSuccess ); // since this is sync read / write, the read should always succeed.
 
+	if( ! mConversionBuffer.empty() )
+		convertToClientFormat( readBuffer, renderBuffer, numReadSamples );
+
 	mNumFramesBuffered -= numWriteFramesAvailable;
 
 	hr = mRenderClient->ReleaseBuffer( numWriteFramesAvailable, bufferFlags );
 	CI_ASSERT( hr == S_OK );
 }
 
-// This uses the "Multimedia Class Scheduler Service" (MMCSS) to increase the priority of the current thread.
-// The priority increase can be seen in the threads debugger, it should have Priority = "Time Critical"
-void WasapiRenderClientImpl::increaseThreadPriority()
-{
-	DWORD taskIndex = 0;
-	::HANDLE avrtHandle = ::AvSetMmThreadCharacteristics( L"Pro Audio", &taskIndex );
-	if( ! avrtHandle )
-		CI_LOG_W( "Unable to enable MMCSS for 'Pro Audio', error: " << GetLastError() );
-}
-
 // ----------------------------------------------------------------------------------------------------
 // MARK: - WasapiCaptureClientImpl
 // ----------------------------------------------------------------------------------------------------
@@ -344,6 +511,12 @@ void WasapiCaptureClientImpl::init()
 	auto device = mInputDeviceNode->getDevice();
 	bool needsConverter = device->getSampleRate() != mInputDeviceNode->getSampleRate();
 
+	// reset state from a previous initialization, which happens when the share mode changes.
+	mAudioClientNumFrames = DEFAULT_AUDIOCLIENT_FRAMES;
+	mNumFramesBuffered = 0;
+	mDriftCompensator.reset();
+	mConverter.reset();
+
 	if( needsConverter )
 		mAudioClientNumFrames *= CAPTURE_CONVERSION_PADDING_FACTOR;
 
@@ -352,16 +525,18 @@ void WasapiCaptureClientImpl::init()
 
 	mMaxReadFrames = mAudioClientNumFrames;
 
-	for( size_t ch = 0; ch < mNumChannels; ch++ )
-		mRingBuffers.emplace_back( mMaxReadFrames * mNumChannels );
-
 	mInterleavedBuffer = BufferInterleaved( mMaxReadFrames, mNumChannels );
 	mReadBuffer.setSize( mMaxReadFrames, mNumChannels );
 
+	size_t maxWriteFrames = mMaxReadFrames;
 	if( needsConverter ) {
 		mConverter = audio::dsp::Converter::create( device->getSampleRate(), mInputDeviceNode->getSampleRate(), mNumChannels, mInputDeviceNode->getNumChannels(), mMaxReadFrames );
 		mConvertedReadBuffer.setSize( mConverter->getDestMaxFramesPerBlock(), mNumChannels );
+		maxWriteFrames = mConverter->getDestMaxFramesPerBlock();
 	}
+
+	// the capture device runs on its own clock, so its frames are resampled to stay in step with the render device
+	mDriftCompensator.reset( new dsp::DriftCompensator( mNumChannels, mInputDeviceNode->getSampleRate(), mInputDeviceNode->getFramesPerBlock(), maxWriteFrames ) );
 }
 
 void WasapiCaptureClientImpl::uninit()
@@ -389,11 +564,6 @@ void WasapiCaptureClientImpl::captureAudio()
 	CI_ASSERT( hr == S_OK );
 
 	while( numPacketFrames ) {
-		if( numPacketFrames > ( mMaxReadFrames - mNumFramesBuffered ) ) {
-			mInputDeviceNode->markOverrun();
-			return;
-		}
-	
 		BYTE *audioData;
 		UINT32 numFramesAvailable;
 		DWORD flags;
@@ -407,28 +577,23 @@ void WasapiCaptureClientImpl::captureAudio()
 		mReadBuffer.setNumFrames( numFramesAvailable );
 
 		if( mNumChannels == 1 )
-			memcpy( mReadBuffer.getData(), audioData, numSamples * sizeof( float ) );
+			convertFromClientFormat( audioData, mReadBuffer.getData(), numSamples );
 		else {
-			memcpy( mInterleavedBuffer.getData(), audioData, numSamples * sizeof( float ) );
+			convertFromClientFormat( audioData, mInterleavedBuffer.getData(), numSamples );
 			dsp::deinterleaveBuffer( &mInterleavedBuffer, &mReadBuffer );
 		}
 
+		const Buffer *writeBuffer = &mReadBuffer;
 		if( mConverter ) {
+			mConvertedReadBuffer.setNumFrames( mConverter->getDestMaxFramesPerBlock() );
 			pair<size_t, size_t> count = mConverter->convert( &mReadBuffer, &mConvertedReadBuffer );
-			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-				if( ! mRingBuffers[ch].write( mConvertedReadBuffer.getChannel( ch ), count.second ) )
-					mInputDeviceNode->markOverrun();
-			}
-			mNumFramesBuffered += count.second;
-		}
-		else {
-			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-				if( ! mRingBuffers[ch].write( mReadBuffer.getChannel( ch ), numFramesAvailable ) )
-					mInputDeviceNode->markOverrun();
-			}
-			mNumFramesBuffered += numFramesAvailable;
+			mConvertedReadBuffer.setNumFrames( count.second );
+			writeBuffer = &mConvertedReadBuffer;
 		}
 
+		if( ! mDriftCompensator->write( writeBuffer ) )
+			mInputDeviceNode->markOverrun();
+
 		hr = mCaptureClient->ReleaseBuffer( numFramesAvailable );
 		CI_ASSERT( hr == S_OK );
 
@@ -467,8 +632,37 @@ void OutputDeviceNodeWasapi::uninitialize()
 	mRenderImpl->uninit();
 }
 
+void OutputDeviceNodeWasapi::setExclusiveMode( bool exclusive )
+{
+	if( mRenderImpl->mExclusiveMode == exclusive )
+		return;
+
+	if( ! isInitialized() ) {
+		mRenderImpl->mExclusiveMode = exclusive;
+		return;
+	}
+
+	reinitializeContextWithExclusiveMode( getContext(), &mRenderImpl->mExclusiveMode, exclusive );
+}
+
+bool OutputDeviceNodeWasapi::isExclusiveMode() const
+{
+	return mRenderImpl->mExclusiveMode;
+}
+
 void OutputDeviceNodeWasapi::enableProcessing()
 {
+	mRenderImpl->mIsFirstRender = true;
+
+	if( mRenderImpl->mExclusiveMode ) {
+		// exclusive event driven mode requires the buffer to be filled before starting, otherwise the first period is glitched.
+		BYTE *renderBuffer;
+		HRESULT hr = mRenderImpl->mRenderClient->GetBuffer( mRenderImpl->mAudioClientNumFrames, &renderBuffer );
+		CI_ASSERT( hr == S_OK );
+		hr = mRenderImpl->mRenderClient->ReleaseBuffer( mRenderImpl->mAudioClientNumFrames, AUDCLNT_BUFFERFLAGS_SILENT );
+		CI_ASSERT( hr == S_OK );
+	}
+
 	HRESULT hr = mRenderImpl->mAudioClient->Start();
 	CI_ASSERT( hr == S_OK );
 }
@@ -532,6 +726,24 @@ void InputDeviceNodeWasapi::uninitialize()
 	mCaptureImpl->uninit();
 }
 
+void InputDeviceNodeWasapi::setExclusiveMode( bool exclusive )
+{
+	if( mCaptureImpl->mExclusiveMode == exclusive )
+		return;
+
+	if( ! isInitialized() ) {
+		mCaptureImpl->mExclusiveMode = exclusive;
+		return;
+	}
+
+	reinitializeContextWithExclusiveMode( getContext(), &mCaptureImpl->mExclusiveMode, exclusive );
+}
+
+bool InputDeviceNodeWasapi::isExclusiveMode() const
+{
+	return mCaptureImpl->mExclusiveMode;
+}
+
 void InputDeviceNodeWasapi::enableProcessing()
 {
 	HRESULT hr = mCaptureImpl->mAudioClient->Start();
@@ -548,18 +760,13 @@ void InputDeviceNodeWasapi::process( Buffer *buffer )
 {
 	mCaptureImpl->captureAudio();
 
-	const size_t framesNeeded = buffer->getNumFrames();
-	if( mCaptureImpl->mNumFramesBuffered < framesNeeded ) {
+	if( ! mCaptureImpl->mDriftCompensator->read( buffer ) )
 		markUnderrun();
-		return;
-	}
-
-	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
-		bool readSuccess = mCaptureImpl->mRingBuffers[ch].read( buffer->getChannel( ch ), framesNeeded );
-		CI_ASSERT( readSuccess );
-	}
+}
 
-	mCaptureImpl->mNumFramesBuffered -= framesNeeded;
+double InputDeviceNodeWasapi::getDriftCompensationRatio() const
+{
+	return mCaptureImpl->mDriftCompensator ? mCaptureImpl->mDriftCompensator->getRatio() : 1;
 }
 
 // ----------------------------------------------------------------------------------------------------
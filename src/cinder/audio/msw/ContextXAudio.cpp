@@ -102,7 +102,7 @@ struct EngineCallbackImpl : public IXAudio2EngineCallback {
 // ----------------------------------------------------------------------------------------------------
 
 OutputDeviceNodeXAudio::OutputDeviceNodeXAudio( DeviceRef device, const Format &format )
-: OutputDeviceNode( device, format ), mVoiceCallback( new VoiceCallbackImpl( this ) ), mSourceVoice( nullptr ),  mFilterEnabled( true )
+: OutputDeviceNode( device, format ), mVoiceCallback( new VoiceCallbackImpl( this ) ), mSourceVoice( nullptr ),  mFilterEnabled( true ), mNumGlitches( 0 )
 {
 }
 
@@ -156,6 +156,11 @@ void OutputDeviceNodeXAudio::initSourceVoice()
 
 void OutputDeviceNodeXAudio::enableProcessing()
 {
+	// glitches are counted since the engine started, so take a baseline
+	::XAUDIO2_PERFORMANCE_DATA perfData;
+	dynamic_pointer_cast<ContextXAudio>( getContext() )->getXAudio()->GetPerformanceData( &perfData );
+	mNumGlitches = perfData.GlitchesSinceEngineStarted;
+
 	HRESULT hr = mSourceVoice->Start();
 	CI_ASSERT( hr ==S_OK );
 }
@@ -179,6 +184,13 @@ void OutputDeviceNodeXAudio::submitNextBuffer()
 	if( ! ctx )
 		return;
 
+	// XAudio2 reports audio glitches (the engine failed to deliver a processing pass in time) as xruns.
+	::XAUDIO2_PERFORMANCE_DATA perfData;
+	static_cast<ContextXAudio *>( ctx.get() )->getXAudio()->GetPerformanceData( &perfData );
+	if( perfData.GlitchesSinceEngineStarted > mNumGlitches )
+		ctx->markXrun( perfData.GlitchesSinceEngineStarted - mNumGlitches );
+	mNumGlitches = perfData.GlitchesSinceEngineStarted;
+
 	ctx->preProcess();
 
 	auto internalBuffer = getInternalBuffer();
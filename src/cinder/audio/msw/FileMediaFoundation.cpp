@@ -101,6 +101,7 @@ SourceFileRef SourceFileMediaFoundation::cloneWithSampleRate( size_t sampleRate
 {
 	auto result = make_shared<SourceFileMediaFoundation>( mDataSource, sampleRate );
 	result->initReader();
+	result->mConverterQuality = mConverterQuality;
 	result->setupSampleRateConversion();
 
 	return result;
@@ -27,22 +27,36 @@
 
 namespace cinder { namespace audio { namespace msw {
 
-std::shared_ptr<::WAVEFORMATEX> interleavedFloatWaveFormat( size_t sampleRate, size_t numChannels )
+namespace {
+
+std::shared_ptr<::WAVEFORMATEX> interleavedWaveFormat( size_t sampleRate, size_t numChannels, size_t bitsPerSample, size_t validBitsPerSample, const ::GUID &subFormat )
 {
 	::WAVEFORMATEXTENSIBLE *wfx = (::WAVEFORMATEXTENSIBLE *)calloc( 1, sizeof( ::WAVEFORMATEXTENSIBLE ) );
 
 	wfx->Format.wFormatTag				= WAVE_FORMAT_EXTENSIBLE ;
 	wfx->Format.nSamplesPerSec			= sampleRate;
 	wfx->Format.nChannels				= numChannels;
-	wfx->Format.wBitsPerSample			= 32;
+	wfx->Format.wBitsPerSample			= bitsPerSample;
 	wfx->Format.nBlockAlign				= wfx->Format.nChannels * wfx->Format.wBitsPerSample / 8;
 	wfx->Format.nAvgBytesPerSec			= wfx->Format.nSamplesPerSec * wfx->Format.nBlockAlign;
 	wfx->Format.cbSize					= sizeof( ::WAVEFORMATEXTENSIBLE ) - sizeof( ::WAVEFORMATEX );
-	wfx->Samples.wValidBitsPerSample	= wfx->Format.wBitsPerSample;
-	wfx->SubFormat						= KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+	wfx->Samples.wValidBitsPerSample	= validBitsPerSample;
+	wfx->SubFormat						= subFormat;
 	wfx->dwChannelMask					= 0; // this could be a very complicated bit mask of channel order, but 0 means 'first channel is left, second channel is right, etc'
 
 	return std::shared_ptr<::WAVEFORMATEX>( (::WAVEFORMATEX *)wfx, free );
 }
 
+} // anonymous namespace
+
+std::shared_ptr<::WAVEFORMATEX> interleavedFloatWaveFormat( size_t sampleRate, size_t numChannels )
+{
+	return interleavedWaveFormat( sampleRate, numChannels, 32, 32, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT );
+}
+
+std::shared_ptr<::WAVEFORMATEX> interleavedPcmWaveFormat( size_t sampleRate, size_t numChannels, size_t bitsPerSample, size_t validBitsPerSample )
+{
+	return interleavedWaveFormat( sampleRate, numChannels, bitsPerSample, validBitsPerSample, KSDATAFORMAT_SUBTYPE_PCM );
+}
+
 } } } // namespace cinder::audio::msw
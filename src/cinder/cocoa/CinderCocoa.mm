@@ -24,6 +24,7 @@
 #include "cinder/Url.h"
 #include "cinder/Buffer.h"
 #include "cinder/Font.h"
+#include "cinder/Profiler.h"
 
 #if defined( CINDER_MAC )
 	#import <Cocoa/Cocoa.h>
@@ -407,13 +408,15 @@ ImageSourceCgImageRef ImageSourceCgImage::createRef( ::CGImageRef imageRef, Imag
 	return shared_ptr<ImageSourceCgImage>( new ImageSourceCgImage( imageRef, options ) );
 }
 
-ImageSourceCgImage::ImageSourceCgImage( ::CGImageRef imageRef, ImageSource::Options /*options*/ )
+ImageSourceCgImage::ImageSourceCgImage( ::CGImageRef imageRef, ImageSource::Options options )
 	: ImageSource(), mIsIndexed( false ), mIs16BitPacked( false )
 {
 	::CGImageRetain( imageRef );
 	mImageRef = shared_ptr<CGImage>( imageRef, ::CGImageRelease );
 	
-	setSize( ::CGImageGetWidth( mImageRef.get() ), ::CGImageGetHeight( mImageRef.get() ) );
+	const Area area = calcDecodeArea( options, Vec2i( (int32_t)::CGImageGetWidth( mImageRef.get() ), (int32_t)::CGImageGetHeight( mImageRef.get() ) ) );
+	mDecodeOffset = area.getUL();
+	setSize( area.getWidth(), area.getHeight() );
 	size_t bpc = ::CGImageGetBitsPerComponent( mImageRef.get() );
 	size_t bpp = ::CGImageGetBitsPerPixel( mImageRef.get() );
 
@@ -502,6 +505,8 @@ ImageSourceCgImage::ImageSourceCgImage( ::CGImageRef imageRef, ImageSource::Opti
 
 void ImageSourceCgImage::load( ImageTargetRef target )
 {
+	CI_PROFILE_ZONE_CATEGORY( "ImageIo decode", "ImageIo" );
+
 	int32_t rowBytes = ::CGImageGetBytesPerRow( mImageRef.get() );
 	const std::shared_ptr<__CFData> pixels( (__CFData*)::CGDataProviderCopyData( ::CGImageGetDataProvider( mImageRef.get() ) ), safeCfRelease );
 	
@@ -515,7 +520,8 @@ void ImageSourceCgImage::load( ImageTargetRef target )
 	if( mIsIndexed || mIs16BitPacked )
 		tempRowBuffer = shared_ptr<Color8u>( new Color8u[mWidth], checked_array_deleter<Color8u>() );
 	
-	const uint8_t *data = ::CFDataGetBytePtr( pixels.get() );
+	const size_t pixelBytes = ::CGImageGetBitsPerPixel( mImageRef.get() ) / 8;
+	const uint8_t *data = ::CFDataGetBytePtr( pixels.get() ) + mDecodeOffset.y * rowBytes + mDecodeOffset.x * pixelBytes;
 	for( int32_t row = 0; row < mHeight; ++row ) {
 		// if this is indexed fill in our temporary row buffer with the colors pulled from the palette
 		if( mIsIndexed ) {
@@ -0,0 +1,174 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cinder/dx/dx.h" // must be first
+#include "cinder/dx/DxGpuProfiler.h"
+#include "cinder/app/AppImplMswRendererDx.h"
+#include "cinder/Profiler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace dx {
+
+namespace {
+
+ID3D11Query* createQuery( D3D11_QUERY type )
+{
+	D3D11_QUERY_DESC desc = { type, 0 };
+	ID3D11Query *result = nullptr;
+	getDxRenderer()->md3dDevice->CreateQuery( &desc, &result );
+	return result;
+}
+
+void releaseQuery( ID3D11Query *query )
+{
+	if( query )
+		query->Release();
+}
+
+} // anonymous namespace
+
+GpuProfiler::GpuProfiler( size_t numBufferedFrames )
+	: mFrames( max<size_t>( numBufferedFrames, 2 ) ), mFrameIndex( 0 ), mTrackId( Profiler::get()->getTrack( "GPU" ) ), mNumDroppedFrames( 0 )
+{
+	for( vector<Frame>::iterator frameIt = mFrames.begin(); frameIt != mFrames.end(); ++frameIt )
+		frameIt->mDisjoint = createQuery( D3D11_QUERY_TIMESTAMP_DISJOINT );
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for( vector<Frame>::iterator frameIt = mFrames.begin(); frameIt != mFrames.end(); ++frameIt ) {
+		releaseQuery( frameIt->mDisjoint );
+		for( vector<PendingPass>::iterator passIt = frameIt->mPasses.begin(); passIt != frameIt->mPasses.end(); ++passIt ) {
+			releaseQuery( passIt->mBegin );
+			releaseQuery( passIt->mEnd );
+		}
+	}
+}
+
+void GpuProfiler::beginPass( const char *name )
+{
+	Frame &frame = mFrames[mFrameIndex];
+	if( ! frame.mDisjoint )
+		return;
+
+	auto context = getDxRenderer()->mDeviceContext;
+
+	// the timestamps of a frame are only meaningful within a disjoint query, which spans from the first pass until endFrame()
+	if( frame.mNumPasses == 0 )
+		context->Begin( frame.mDisjoint );
+
+	if( frame.mNumPasses == frame.mPasses.size() ) {
+		PendingPass pass;
+		pass.mBegin = createQuery( D3D11_QUERY_TIMESTAMP );
+		pass.mEnd = createQuery( D3D11_QUERY_TIMESTAMP );
+		frame.mPasses.push_back( pass );
+	}
+
+	mOpenPasses.push_back( frame.mNumPasses );
+	PendingPass &pass = frame.mPasses[frame.mNumPasses++];
+	pass.mName = name;
+	pass.mSubmitSeconds = Profiler::get()->getSeconds();
+	if( pass.mBegin )
+		context->End( pass.mBegin );
+}
+
+void GpuProfiler::endPass()
+{
+	if( mOpenPasses.empty() )
+		return;
+
+	PendingPass &pass = mFrames[mFrameIndex].mPasses[mOpenPasses.back()];
+	mOpenPasses.pop_back();
+	if( pass.mEnd )
+		getDxRenderer()->mDeviceContext->End( pass.mEnd );
+}
+
+void GpuProfiler::endFrame()
+{
+	// passes left open at the end of the frame are closed, so that the frame's queries are complete
+	while( ! mOpenPasses.empty() )
+		endPass();
+
+	Frame &current = mFrames[mFrameIndex];
+	if( current.mNumPasses > 0 )
+		getDxRenderer()->mDeviceContext->End( current.mDisjoint );
+
+	mFrameIndex = ( mFrameIndex + 1 ) % mFrames.size();
+
+	// the frame that is about to be reused was issued getNumBufferedFrames() - 1 frames ago
+	Frame &frame = mFrames[mFrameIndex];
+	if( frame.mNumPasses > 0 )
+		readBack( &frame );
+
+	frame.mNumPasses = 0;
+}
+
+void GpuProfiler::readBack( Frame *frame )
+{
+	auto context = getDxRenderer()->mDeviceContext;
+
+	// S_FALSE is returned while the GPU hasn't finished the queries, in which case the frame is dropped rather than waiting
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	if( context->GetData( frame->mDisjoint, &disjoint, sizeof( disjoint ), D3D11_ASYNC_GETDATA_DONOTFLUSH ) != S_OK || disjoint.Disjoint ) {
+		++mNumDroppedFrames;
+		return;
+	}
+
+	vector<Pass> results( frame->mNumPasses );
+	vector<double> beginSeconds( frame->mNumPasses );
+	for( size_t i = 0; i < frame->mNumPasses; ++i ) {
+		const PendingPass &pending = frame->mPasses[i];
+		UINT64 begin, end;
+		if( ! pending.mBegin || ! pending.mEnd
+			|| context->GetData( pending.mBegin, &begin, sizeof( begin ), D3D11_ASYNC_GETDATA_DONOTFLUSH ) != S_OK
+			|| context->GetData( pending.mEnd, &end, sizeof( end ), D3D11_ASYNC_GETDATA_DONOTFLUSH ) != S_OK ) {
+			++mNumDroppedFrames;
+			return;
+		}
+
+		results[i].mName = pending.mName;
+		results[i].mSeconds = double( end - begin ) / double( disjoint.Frequency );
+	}
+
+	Profiler *profiler = Profiler::get();
+	for( size_t i = 0; i < frame->mNumPasses; ++i ) {
+		const PendingPass &pending = frame->mPasses[i];
+		profiler->recordTrackZone( mTrackId, pending.mName, "gpu", pending.mSubmitSeconds, pending.mSubmitSeconds + results[i].mSeconds );
+	}
+
+	mLastFrame.swap( results );
+}
+
+double GpuProfiler::getPassSeconds( const std::string &name ) const
+{
+	for( vector<Pass>::const_iterator passIt = mLastFrame.begin(); passIt != mLastFrame.end(); ++passIt ) {
+		if( passIt->mName == name )
+			return passIt->mSeconds;
+	}
+
+	return 0;
+}
+
+} } // namespace cinder::dx
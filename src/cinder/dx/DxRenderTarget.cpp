@@ -476,6 +476,7 @@ void RenderTarget::bindTexture( int textureUnit, int attachment )
 	//getDxRenderer()->mDeviceContext->PSSetShaderResources(textureUnit, 1, &mObj->mColorSRVs[attachment]);
 	dx::TextureRef colorTexture = mObj->mColorTextures[attachment];
 	ID3D11ShaderResourceView* srv = colorTexture->getDxShaderResourceView();
+	getDxRenderer()->flushBatch();
 	getDxRenderer()->mDeviceContext->PSSetShaderResources( textureUnit, 1, &srv );
 	updateMipmaps( false, attachment );
 }
@@ -544,6 +545,7 @@ void RenderTarget::bindFramebuffer()
 {
 	//getDxRenderer()->mDeviceContext->OMSetRenderTargets(mObj->mColorSRVs.size(), &mObj->mRenderTargets[0], mObj->mDepthView);
 	UINT numViews = (UINT)mObj->mColorTextures.size();
+	getDxRenderer()->flushBatch();
 	getDxRenderer()->mDeviceContext->OMSetRenderTargets( numViews, &mObj->mRenderTargets[0], mObj->mDepthView );
 
 	//GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
@@ -557,6 +559,7 @@ void RenderTarget::bindFramebuffer()
 
 void RenderTarget::unbindFramebuffer()
 {
+	getDxRenderer()->flushBatch();
 	getDxRenderer()->mDeviceContext->OMSetRenderTargets( 1, &getDxRenderer()->mMainFramebuffer, getDxRenderer()->mDepthStencilView );
 	//GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), 0 );
 }
@@ -34,11 +34,13 @@
 #include <stdio.h>
 #include "cinder/app/AppImplMswRendererDx.h"
 #include "cinder/dx/DDSTextureLoader.h"
+#include "cinder/TaskPool.h"
+#include "cinder/Utilities.h"
+#include <algorithm>
 
 #if defined( CINDER_WINRT )
 	#include <ppltasks.h>
 	#include "cinder/WinRTUtils.h"
-	#include "cinder/Utilities.h"
 	using namespace Windows::Storage;
 	using namespace Concurrency;
 #endif
@@ -48,6 +50,18 @@ using namespace std;
 namespace cinder {
 namespace dx {
 
+namespace {
+
+// Set on TaskPool threads while they run a Texture::createAsync() job. getDxRenderer() goes through the App's current window, which is only safe to query on the main thread.
+__declspec(thread) ID3D11Device *sAsyncDevice = NULL;
+
+ID3D11Device* getTextureDevice()
+{
+	return sAsyncDevice ? sAsyncDevice : getDxRenderer()->md3dDevice;
+}
+
+} // anonymous namespace
+
 const char* kErrorInsufficientNonFloatChannels = "Non-float textures need to have all four color channels (RGBA) defined";
 
 class ImageSourceTexture;
@@ -297,6 +311,12 @@ void Texture::loadImageAsync(const fs::path path, dx::Texture &texture, const Fo
 }
 #endif
 
+Texture::Texture( const ip::BlockCompressedImage &image, Format format )
+{
+	init( image.getWidth(), image.getHeight() );
+	init( image, format );
+}
+
 void Texture::init( int width, int height )
 {
 	mWidth = width;
@@ -331,7 +351,7 @@ void Texture::init( const unsigned char *srcData, DXGI_FORMAT srcDataFormat, con
 	mSamplerDesc.BorderColor[3] = 0;
 	mSamplerDesc.MinLOD = 0;
 	mSamplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	HRESULT hr = getDxRenderer()->md3dDevice->CreateSamplerState(&mSamplerDesc, &mSamplerState);
+	HRESULT hr = getTextureDevice()->CreateSamplerState(&mSamplerDesc, &mSamplerState);
 	if(hr != S_OK) {
 		__debugbreak();
 	}
@@ -362,13 +382,13 @@ void Texture::init( const unsigned char *srcData, DXGI_FORMAT srcDataFormat, con
 		subData.pSysMem = srcData;
 		subData.SysMemPitch = mWidth*sizeof(unsigned char)*numChannels;
 		subData.SysMemSlicePitch = subData.SysMemPitch*mHeight;
-		hr = getDxRenderer()->md3dDevice->CreateTexture2D( &texDesc, &subData, &mDxTexture );
+		hr = getTextureDevice()->CreateTexture2D( &texDesc, &subData, &mDxTexture );
 		if( FAILED( hr ) ) {
 			__debugbreak();
 		}
 	}
 	else {
-		hr = getDxRenderer()->md3dDevice->CreateTexture2D( &texDesc, nullptr, &mDxTexture );
+		hr = getTextureDevice()->CreateTexture2D( &texDesc, nullptr, &mDxTexture );
 		if( FAILED( hr ) ) {
 			__debugbreak();
 		}
@@ -381,13 +401,67 @@ void Texture::init( const unsigned char *srcData, DXGI_FORMAT srcDataFormat, con
 		srvDesc.ViewDimension = ( texDesc.SampleDesc.Count > 1 ? D3D11_SRV_DIMENSION_TEXTURE2DMS : D3D11_SRV_DIMENSION_TEXTURE2D );
 		srvDesc.Texture2D.MostDetailedMip = 0;
 		srvDesc.Texture2D.MipLevels = -1;
-		hr = getDxRenderer()->md3dDevice->CreateShaderResourceView( mDxTexture, &srvDesc, &mSRV );
+		hr = getTextureDevice()->CreateShaderResourceView( mDxTexture, &srvDesc, &mSRV );
 		if( FAILED( hr ) ) {
 			__debugbreak();
 		}
 	}
 }
 
+void Texture::init( const ip::BlockCompressedImage &image, const Format &format )
+{
+	mDoNotDispose = false;
+	mMaxU = mMaxV = 1.0f;
+	mInternalFormat = ( image.getFormat() == ip::BlockCompressedImage::BC1 ) ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+
+	::ZeroMemory( &mSamplerDesc, sizeof(D3D11_SAMPLER_DESC) );
+	mSamplerDesc.Filter = format.mFilter;
+	mSamplerDesc.AddressU = format.mWrapS;
+	mSamplerDesc.AddressV = format.mWrapT;
+	mSamplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	mSamplerDesc.MaxAnisotropy = 1;
+	mSamplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	mSamplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+	HRESULT hr = getTextureDevice()->CreateSamplerState( &mSamplerDesc, &mSamplerState );
+	if( hr != S_OK ) {
+		__debugbreak();
+	}
+
+	D3D11_TEXTURE2D_DESC texDesc;
+	::ZeroMemory( &texDesc, sizeof(D3D11_TEXTURE2D_DESC) );
+	texDesc.Width = mWidth;
+	texDesc.Height = mHeight;
+	texDesc.MipLevels = (UINT)image.getNumLevels();
+	texDesc.ArraySize = 1;
+	texDesc.Format = mInternalFormat;
+	texDesc.SampleDesc.Count = 1;
+	texDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	// one subresource per mip level, each pitched by a row of 4x4 blocks
+	std::vector<D3D11_SUBRESOURCE_DATA> subData( image.getNumLevels() );
+	for( size_t level = 0; level < image.getNumLevels(); ++level ) {
+		subData[level].pSysMem = image.getLevel( level ).getData();
+		subData[level].SysMemPitch = (UINT)image.getLevelRowBytes( level );
+		subData[level].SysMemSlicePitch = (UINT)image.getLevel( level ).getDataSize();
+	}
+	hr = getTextureDevice()->CreateTexture2D( &texDesc, subData.empty() ? nullptr : &subData[0], &mDxTexture );
+	if( FAILED( hr ) ) {
+		__debugbreak();
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+	::ZeroMemory( &srvDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC) );
+	srvDesc.Format = texDesc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = -1;
+	hr = getTextureDevice()->CreateShaderResourceView( mDxTexture, &srvDesc, &mSRV );
+	if( FAILED( hr ) ) {
+		__debugbreak();
+	}
+}
+
 void Texture::init( const float *srcData, DXGI_FORMAT srcDataFormat, const Format &format )
 {
 	mDoNotDispose = false;
@@ -406,7 +480,7 @@ void Texture::init( const float *srcData, DXGI_FORMAT srcDataFormat, const Forma
 	mSamplerDesc.BorderColor[3] = 0;
 	mSamplerDesc.MinLOD = 0;
 	mSamplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	HRESULT hr = getDxRenderer()->md3dDevice->CreateSamplerState(&mSamplerDesc, &mSamplerState);
+	HRESULT hr = getTextureDevice()->CreateSamplerState(&mSamplerDesc, &mSamplerState);
 	if( FAILED( hr ) ) {
 		__debugbreak();
 	}
@@ -432,13 +506,13 @@ void Texture::init( const float *srcData, DXGI_FORMAT srcDataFormat, const Forma
 		subData.pSysMem = srcData;
 		subData.SysMemPitch = mWidth*sizeof(float)*numChannels;
 		subData.SysMemSlicePitch = subData.SysMemPitch*mHeight;
-		hr = getDxRenderer()->md3dDevice->CreateTexture2D( &desc, &subData, &mDxTexture );
+		hr = getTextureDevice()->CreateTexture2D( &desc, &subData, &mDxTexture );
 		if( FAILED( hr ) ) {
 			__debugbreak();
 		}
 	}
 	else {
-		hr = getDxRenderer()->md3dDevice->CreateTexture2D( &desc, nullptr, &mDxTexture );
+		hr = getTextureDevice()->CreateTexture2D( &desc, nullptr, &mDxTexture );
 		if( FAILED( hr ) ) {
 			__debugbreak();
 		}
@@ -450,7 +524,7 @@ void Texture::init( const float *srcData, DXGI_FORMAT srcDataFormat, const Forma
 	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels = -1;
-	hr = getDxRenderer()->md3dDevice->CreateShaderResourceView(mDxTexture, &srvDesc, &mSRV);
+	hr = getTextureDevice()->CreateShaderResourceView(mDxTexture, &srvDesc, &mSRV);
 	if( FAILED( hr ) ) {
 		__debugbreak();
 	}
@@ -598,7 +672,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 	mSamplerDesc.BorderColor[3] = 0;
 	mSamplerDesc.MinLOD = 0;
 	mSamplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	HRESULT hr = getDxRenderer()->md3dDevice->CreateSamplerState(&mSamplerDesc, &mSamplerState);
+	HRESULT hr = getTextureDevice()->CreateSamplerState(&mSamplerDesc, &mSamplerState);
 	if(hr != S_OK) {
 		__debugbreak();
 	}
@@ -630,7 +704,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 		// subData.SysMemSlicePitch = 0;//subData.SysMemPitch * mHeight;
 		//
 		subData.SysMemSlicePitch = subData.SysMemPitch*mHeight;
-		getDxRenderer()->md3dDevice->CreateTexture2D(&texDesc, &subData, &mDxTexture);
+		getTextureDevice()->CreateTexture2D(&texDesc, &subData, &mDxTexture);
 	}
 	else if( ImageIo::UINT16 == imageSource->getDataType() ) {
 		const int numChannels = 4;
@@ -640,7 +714,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 		subData.SysMemPitch = numChannels*sizeof(uint16_t)*mWidth;
 		texDesc.Format = DXGI_FORMAT_R16G16B16A16_UNORM;
 		subData.SysMemSlicePitch = subData.SysMemPitch*mHeight;
-		getDxRenderer()->md3dDevice->CreateTexture2D(&texDesc, &subData, &mDxTexture);
+		getTextureDevice()->CreateTexture2D(&texDesc, &subData, &mDxTexture);
 	}
 	else {
 		const int numChannels = dataFormatNumChannels( dataFormat );
@@ -660,7 +734,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 		//	subData.SysMemPitch = numChannels*sizeof(float)*mWidth;
 		//}
 		subData.SysMemSlicePitch = subData.SysMemPitch*mHeight;
-		getDxRenderer()->md3dDevice->CreateTexture2D(&texDesc, &subData, &mDxTexture);
+		getTextureDevice()->CreateTexture2D(&texDesc, &subData, &mDxTexture);
 	}
 
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
@@ -669,7 +743,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels = -1;
-	getDxRenderer()->md3dDevice->CreateShaderResourceView(mDxTexture, &srvDesc, &mSRV);
+	getTextureDevice()->CreateShaderResourceView(mDxTexture, &srvDesc, &mSRV);
 }
 
 void Texture::update( const Surface &surface )
@@ -694,6 +768,7 @@ void Texture::update( const Surface &surface )
 
 	UINT srcRowPitch = surface.getWidth()*dataFormatNumChannels( dataFormat )*sizeof(uint8_t);
 	UINT srcDepthPitch = 0;
+	getDxRenderer()->flushBatch(); // pending draws may still sample the old contents
 	dx->mDeviceContext->UpdateSubresource( mDxTexture, 0, &box, surface.getData(), srcRowPitch, srcDepthPitch );
 }
 
@@ -719,6 +794,7 @@ void Texture::update( const Surface32f &surface )
 
 	UINT srcRowPitch = surface.getWidth()*dataFormatNumChannels( dataFormat )*sizeof(float);
 	UINT srcDepthPitch = 0;
+	getDxRenderer()->flushBatch();
 	dx->mDeviceContext->UpdateSubresource( mDxTexture, 0, &box, surface.getData(), srcRowPitch, srcDepthPitch );
 }
 
@@ -742,6 +818,7 @@ void Texture::update( const Surface &surface, const Area &area )
 
 	UINT srcRowPitch = surface.getWidth()*dataFormatNumChannels( dataFormat )*sizeof(uint8_t);
 	UINT srcDepthPitch = 0;
+	getDxRenderer()->flushBatch();
 	dx->mDeviceContext->UpdateSubresource( mDxTexture, 0, &box, surface.getData( area.getUL() ), srcRowPitch, srcDepthPitch );
 }
 
@@ -771,6 +848,7 @@ void Texture::update( const Channel32f &channel )
 
 	UINT srcRowPitch = channel.getWidth()*sizeof(float);
 	UINT srcDepthPitch = 0;
+	getDxRenderer()->flushBatch();
 	getDxRenderer()->mDeviceContext->UpdateSubresource( mDxTexture, 0, &box, channel.getData(), srcRowPitch, srcDepthPitch );
 }
 
@@ -796,9 +874,11 @@ void Texture::update( const Channel8u &channel, const Area &area )
 				src += inc;
 			}
 		}
+		getDxRenderer()->flushBatch();
 		getDxRenderer()->mDeviceContext->UpdateSubresource( mDxTexture, 0, &box, data.get(), area.getWidth(), 0 );
 	}
 	else {
+		getDxRenderer()->flushBatch();
 		getDxRenderer()->mDeviceContext->UpdateSubresource( mDxTexture, 0, &box, channel.getData( area.getUL() ), area.getWidth(), 0 );
 	}
 }
@@ -967,13 +1047,12 @@ uint32_t Texture::dataFormatNumChannels( DXGI_FORMAT dataFormat )
 TextureRef Texture::loadDds( IStreamRef ddsStream, Format format )
 {
 	TextureRef texture( new Texture() );
-	app::AppImplMswRendererDx *dxRenderer = reinterpret_cast<app::AppImplMswRendererDx*>(reinterpret_cast<app::RendererDx*>(&*app::App::get()->getRenderer())->mImpl);
 	uint8_t *data = (uint8_t*)malloc(ddsStream->size());
 	if( ! data ) {
 		throw TextureDataExc("Not enough memory to load DDS");
 	}
 	ddsStream->read(data);
-	DirectX::CreateDDSTextureFromMemory(dxRenderer->md3dDevice, data, ddsStream->size(), (ID3D11Resource**)&texture->mDxTexture, &texture->mSRV);
+	DirectX::CreateDDSTextureFromMemory(getTextureDevice(), data, ddsStream->size(), (ID3D11Resource**)&texture->mDxTexture, &texture->mSRV);
 	free(data);
 	texture->mDoNotDispose = false;
 	texture->mWidth = texture->getWidth();
@@ -981,25 +1060,73 @@ TextureRef Texture::loadDds( IStreamRef ddsStream, Format format )
 	return texture;
 }
 
+void Texture::createAsync( DataSourceRef dataSource, const AsyncReadyFn &readyFn, Format format, const AsyncErrorFn &errorFn )
+{
+	// the device is looked up here on the main thread, and kept alive until the job is done with it
+	ID3D11Device *device = getDxRenderer()->md3dDevice;
+	device->AddRef();
+
+	std::string extension = getPathExtension( dataSource->getFilePathHint().string() );
+	std::transform( extension.begin(), extension.end(), extension.begin(), ::tolower );
+	const bool isDds = ( extension == "dds" );
+
+	std::shared_ptr<TextureRef> result( new TextureRef );
+	std::shared_ptr<std::exception_ptr> exc( new std::exception_ptr );
+	TaskRef task = TaskPool::get()->submit( [=] {
+		sAsyncDevice = device;
+		try {
+			if( isDds ) {
+				IStreamRef stream = dataSource->createStream();
+				if( ! stream )
+					throw StreamExc();
+				*result = loadDds( stream, format );
+			}
+			else
+				*result = Texture::create( loadImage( dataSource ), format );
+		}
+		catch( ... ) {
+			*exc = std::current_exception();
+		}
+		sAsyncDevice = NULL;
+		device->Release();
+	} );
+
+	task->thenOnMainThread( [=] {
+		if( *exc ) {
+			if( errorFn )
+				errorFn( *exc );
+			else
+				std::rethrow_exception( *exc );
+		}
+		else if( readyFn )
+			readyFn( *result );
+	} );
+}
+
+void Texture::createAsync( const fs::path &path, const AsyncReadyFn &readyFn, Format format, const AsyncErrorFn &errorFn )
+{
+	createAsync( loadFile( path ), readyFn, format, errorFn );
+}
+
 void Texture::setWrapS( D3D11_TEXTURE_ADDRESS_MODE wrapS )
 {
 	mSamplerState->Release();
 	mSamplerDesc.AddressU = wrapS;
-	getDxRenderer()->md3dDevice->CreateSamplerState(&mSamplerDesc, &mSamplerState);
+	getTextureDevice()->CreateSamplerState(&mSamplerDesc, &mSamplerState);
 }
 
 void Texture::setWrapT( D3D11_TEXTURE_ADDRESS_MODE wrapT )
 {
 	mSamplerState->Release();
 	mSamplerDesc.AddressV = wrapT;
-	getDxRenderer()->md3dDevice->CreateSamplerState(&mSamplerDesc, &mSamplerState);
+	getTextureDevice()->CreateSamplerState(&mSamplerDesc, &mSamplerState);
 }
 
 void Texture::setFilter( D3D11_FILTER filter )
 {
 	mSamplerState->Release();
 	mSamplerDesc.Filter = filter;
-	getDxRenderer()->md3dDevice->CreateSamplerState(&mSamplerDesc, &mSamplerState);
+	getTextureDevice()->CreateSamplerState(&mSamplerDesc, &mSamplerState);
 }
 
 void Texture::setCleanTexCoords( float maxU, float maxV )
@@ -1129,6 +1256,7 @@ float Texture::getMaxV() const
 
 void Texture::bind( UINT textureUnit ) const
 {
+	getDxRenderer()->flushBatch();
 	getDxRenderer()->mDeviceContext->PSSetShaderResources(textureUnit, 1, &mSRV);
 	getDxRenderer()->mDeviceContext->PSSetSamplers(textureUnit, 1, &mSamplerState);
 }
@@ -1136,6 +1264,7 @@ void Texture::bind( UINT textureUnit ) const
 void Texture::unbind( UINT textureUnit ) const
 {
 	ID3D11ShaderResourceView *none = NULL;
+	getDxRenderer()->flushBatch();
 	getDxRenderer()->mDeviceContext->PSSetShaderResources(0, 1, &none);
 }
 
@@ -64,6 +64,7 @@ enum { CUSTOM_ATTR_FLOAT, CUSTOM_ATTR_FLOAT2, CUSTOM_ATTR_FLOAT3, CUSTOM_ATTR_FL
 int		VboMesh::Layout::sCustomAttrSizes[TOTAL_CUSTOM_ATTR_TYPES] = { 4, 8, 12, 16 };
 GLint	VboMesh::Layout::sCustomAttrNumComponents[TOTAL_CUSTOM_ATTR_TYPES] = { 1, 2, 3, 4 };
 GLenum	VboMesh::Layout::sCustomAttrTypes[TOTAL_CUSTOM_ATTR_TYPES] = { GL_FLOAT, GL_FLOAT, GL_FLOAT, GL_FLOAT };
+static const DXGI_FORMAT sCustomAttrFormats[TOTAL_CUSTOM_ATTR_TYPES] = { DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT };
 
 Vbo::Obj::Obj() : mTarget((D3D11_BIND_FLAG)0), mId(NULL)
 {
@@ -88,7 +89,7 @@ Vbo::Vbo(bool createBuffer)
 //{
 //}
 
-void Vbo::bufferData( size_t size, const void *data, D3D11_USAGE usage, D3D11_BIND_FLAG bindFlags, D3D11_CPU_ACCESS_FLAG cpuAccess )
+void Vbo::bufferData( size_t size, const void *data, D3D11_USAGE usage, D3D11_BIND_FLAG bindFlags, D3D11_CPU_ACCESS_FLAG cpuAccess, UINT miscFlags )
 {
 	if(mObj->mId) mObj->mId->Release();
 	D3D11_BUFFER_DESC bufferDesc;
@@ -96,7 +97,7 @@ void Vbo::bufferData( size_t size, const void *data, D3D11_USAGE usage, D3D11_BI
 	bufferDesc.Usage = usage;
 	bufferDesc.BindFlags = bindFlags;
 	bufferDesc.CPUAccessFlags = cpuAccess;
-	bufferDesc.MiscFlags = 0;
+	bufferDesc.MiscFlags = miscFlags;
 	bufferDesc.StructureByteStride = 0;
 	if(data)
 	{
@@ -158,7 +159,7 @@ bool VboMesh::Layout::hasDynamicTexCoords() const
 	return false;
 }
 
-VboMesh::Obj::Obj() : mInputLayout(NULL), mUseQuads(false)
+VboMesh::Obj::Obj() : mInstanceStride(0), mNumInstances(0), mInstanceCapacity(0), mInputLayout(NULL), mUseQuads(false)
 {
 }
 
@@ -674,19 +675,47 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 		mObj->mDynamicStride = 0;
 	}
 
+	// per-instance attributes are interleaved in their own buffer, which is filled by bufferInstanceData()
+	vector<D3D11_INPUT_ELEMENT_DESC> elements( ieDesc, ieDesc + std::max(elementCount, 4) );
+	mObj->mInstanceStride = 0;
+	mObj->mNumInstances = 0;
+	mObj->mInstanceCapacity = 0;
+	if( mObj->mLayout.hasInstanceAttributes() ) {
+		// feature level 9_1 has no per-instance input slots
+		if( ! isInstancingSupported() )
+			throw VboExc();
+		if( ! mObj->mBuffers[INSTANCE_BUFFER] )
+			mObj->mBuffers[INSTANCE_BUFFER] = Vbo(true);
+		for( size_t c = 0; c < mObj->mLayout.mCustomInstance.size(); ++c ) {
+			mObj->mLayout.mCustomInstance[c].second = mObj->mInstanceStride;
+
+			D3D11_INPUT_ELEMENT_DESC element;
+			element.SemanticName = "INSTANCE";
+			element.SemanticIndex = (UINT)c;
+			element.Format = sCustomAttrFormats[mObj->mLayout.mCustomInstance[c].first];
+			element.InputSlot = INSTANCE_INPUT_SLOT;
+			element.AlignedByteOffset = (UINT)mObj->mInstanceStride;
+			element.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+			element.InstanceDataStepRate = mObj->mLayout.mCustomInstanceStepRates[c];
+			elements.push_back( element );
+
+			mObj->mInstanceStride += VboMesh::Layout::sCustomAttrSizes[mObj->mLayout.mCustomInstance[c].first];
+		}
+	}
+
 	//HRESULT hr = getDxRenderer()->md3dDevice->CreateInputLayout(ieDesc, std::max(elementCount, 4), Shaders::StandardVboLayoutVS, sizeof(Shaders::StandardVboLayoutVS), &mObj->mInputLayout);
 	HRESULT hr = E_FAIL;
 	if( D3D_FEATURE_LEVEL_9_1 == getDxRenderer()->mFeatureLevel ) {
-		hr = getDxRenderer()->md3dDevice->CreateInputLayout(ieDesc, std::max(elementCount, 4), Shaders::Dx9_1::StandardVboLayoutVS, sizeof(Shaders::Dx9_1::StandardVboLayoutVS), &mObj->mInputLayout);
+		hr = getDxRenderer()->md3dDevice->CreateInputLayout(&elements[0], (UINT)elements.size(), Shaders::Dx9_1::StandardVboLayoutVS, sizeof(Shaders::Dx9_1::StandardVboLayoutVS), &mObj->mInputLayout);
 	}
 	else if( D3D_FEATURE_LEVEL_9_3 == getDxRenderer()->mFeatureLevel ) {
-		hr = getDxRenderer()->md3dDevice->CreateInputLayout(ieDesc, std::max(elementCount, 4), Shaders::Dx9_3::StandardVboLayoutVS, sizeof(Shaders::Dx9_3::StandardVboLayoutVS), &mObj->mInputLayout);
+		hr = getDxRenderer()->md3dDevice->CreateInputLayout(&elements[0], (UINT)elements.size(), Shaders::Dx9_3::StandardVboLayoutVS, sizeof(Shaders::Dx9_3::StandardVboLayoutVS), &mObj->mInputLayout);
 	}
 	else if( D3D_FEATURE_LEVEL_10_1 == getDxRenderer()->mFeatureLevel ) {
-		hr = getDxRenderer()->md3dDevice->CreateInputLayout(ieDesc, std::max(elementCount, 4), Shaders::Dx10::StandardVboLayoutVS, sizeof(Shaders::Dx10::StandardVboLayoutVS), &mObj->mInputLayout);
+		hr = getDxRenderer()->md3dDevice->CreateInputLayout(&elements[0], (UINT)elements.size(), Shaders::Dx10::StandardVboLayoutVS, sizeof(Shaders::Dx10::StandardVboLayoutVS), &mObj->mInputLayout);
 	}
 	else if( D3D_FEATURE_LEVEL_11_0 == getDxRenderer()->mFeatureLevel || D3D_FEATURE_LEVEL_11_1 == getDxRenderer()->mFeatureLevel ) {
-		hr = getDxRenderer()->md3dDevice->CreateInputLayout(ieDesc, std::max(elementCount, 4), Shaders::Dx11::StandardVboLayoutVS, sizeof(Shaders::Dx11::StandardVboLayoutVS), &mObj->mInputLayout);
+		hr = getDxRenderer()->md3dDevice->CreateInputLayout(&elements[0], (UINT)elements.size(), Shaders::Dx11::StandardVboLayoutVS, sizeof(Shaders::Dx11::StandardVboLayoutVS), &mObj->mInputLayout);
 	}		
 		
 	if(hr != S_OK) {
@@ -831,6 +860,13 @@ void VboMesh::bindAllData() const
 			}
 		}	
 	}
+
+	if( mObj->mLayout.hasInstanceAttributes() && mObj->mBuffers[INSTANCE_BUFFER].getId() ) {
+		ID3D11Buffer *instanceBuffer = mObj->mBuffers[INSTANCE_BUFFER].getId();
+		UINT stride = (UINT)mObj->mInstanceStride;
+		UINT offset = 0;
+		dx->mDeviceContext->IASetVertexBuffers(INSTANCE_INPUT_SLOT, 1, &instanceBuffer, &stride, &offset);
+	}
 	dx->mDeviceContext->IASetInputLayout(mObj->mInputLayout);
 //
 //	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -864,6 +900,32 @@ void VboMesh::bindIndexBuffer() const
 //	glBindBuffer( GL_ARRAY_BUFFER, 0 );
 //}
 
+bool VboMesh::isInstancingSupported()
+{
+	return getDxRenderer()->mFeatureLevel >= D3D_FEATURE_LEVEL_9_3;
+}
+
+bool VboMesh::isIndirectDrawSupported()
+{
+	return getDxRenderer()->mFeatureLevel >= D3D_FEATURE_LEVEL_11_0;
+}
+
+void VboMesh::bufferInstanceData( const void *data, size_t numInstances )
+{
+	mObj->mNumInstances = numInstances;
+	size_t size = mObj->mInstanceStride * numInstances;
+	if( size == 0 )
+		return;
+
+	Vbo &vbo = mObj->mBuffers[INSTANCE_BUFFER];
+	if( size > mObj->mInstanceCapacity ) {
+		vbo.bufferData( size, data, D3D11_USAGE_DYNAMIC, D3D11_BIND_VERTEX_BUFFER, D3D11_CPU_ACCESS_WRITE );
+		mObj->mInstanceCapacity = size;
+	}
+	else
+		vbo.bufferSubData( 0, size, data );
+}
+
 void VboMesh::bufferIndices( const std::vector<uint32_t> &indices )
 {
 	if(mObj->mUseQuads)
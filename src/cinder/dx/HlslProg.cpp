@@ -167,6 +167,7 @@ void HlslProg::initFromSource(
 void HlslProg::bind() const
 {
 	auto dx = getDxRenderer();
+	dx->flushBatch();
 	//bind the shaders
 	if(mObj->mVS)
 		dx->mDeviceContext->VSSetShader(mObj->mVS, NULL, 0);
@@ -192,6 +193,7 @@ void HlslProg::bind() const
 void HlslProg::unbind()
 {
 	auto dx = getDxRenderer();
+	dx->flushBatch();
 	dx->mDeviceContext->VSSetShader(NULL, NULL, 0);
 	dx->mDeviceContext->PSSetShader(NULL, NULL, 0);
 	dx->mDeviceContext->GSSetShader(NULL, NULL, 0);
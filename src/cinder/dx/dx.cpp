@@ -109,78 +109,17 @@ static bool anyShadersActive()
 	return false;
 }
 
-static void drawQuads()
+//! Returns whether 2D primitives can be pre-transformed on the CPU and merged into the pending draw batch. Lighting and custom shaders need the real matrices.
+static bool canBatchPrimitives( app::AppImplMswRendererDx *dx )
 {
-	auto dx = getDxRenderer();
-
-	size_t vertexCount = dx->mImmediateModeVerts.size();
-    if(vertexCount < 4) {
-		return;
-	}
-
-	ID3D11ShaderResourceView *view;
-	dx->mDeviceContext->PSGetShaderResources(0, 1, &view);
-	ID3D11VertexShader *vs = (view) ? TEXTURE_VERTEX : COLOR_VERTEX;
-	ID3D11PixelShader *ps = (view) ? TEXTURE_PIXEL : COLOR_PIXEL;
-
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	dx->mDeviceContext->Map(dx->mCBMatrices, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[0] = dx->mProjection.top();
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[1] = dx->mModelView.top();
-	dx->mDeviceContext->Unmap(dx->mCBMatrices, 0);
-	if(dx->mLightingEnabled)
-		dx->mDeviceContext->VSSetConstantBuffers(1, 1, &dx->mCBLights);
-	dx->mDeviceContext->VSSetShader(vs, NULL, 0);
-	dx->mDeviceContext->VSSetConstantBuffers(0, 1, &dx->mCBMatrices);
-	dx->mDeviceContext->PSSetShader(ps, NULL, 0);
-	dx->mDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-	size_t size =  sizeof(FixedVertex);
-	FixedVertex *vertices = dx->mImmediateModeVerts.data();
-
-	while(vertexCount > 0) 
-	{
-		size_t index = 0;
-		size_t count = 0;
-		dx->mDeviceContext->Map(dx->mVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-		FixedVertex *pData = static_cast<FixedVertex *>(mappedResource.pData);
-		size_t end = (vertexCount >= D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT) ? D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT : vertexCount;
-		while(count < end)
-		{
-			memcpy(pData++, &vertices[index+0], sizeof(FixedVertex));
-			memcpy(pData++, &vertices[index+1], sizeof(FixedVertex));
-			memcpy(pData++, &vertices[index+2], sizeof(FixedVertex));
-			memcpy(pData++, &vertices[index+0], sizeof(FixedVertex));
-			memcpy(pData++, &vertices[index+2], sizeof(FixedVertex));
-			memcpy(pData++, &vertices[index+3], sizeof(FixedVertex));
-			vertexCount -= 4;
-			count += 6;
-			index += 4;
-		}
-		dx->mDeviceContext->Unmap(dx->mVertexBuffer, 0);
-
-		if(count > 0) 
-		{
-			UINT stride = sizeof(FixedVertex);
-			UINT offset = 0;
-			dx->mDeviceContext->IASetVertexBuffers(0, 1, &dx->mVertexBuffer, &stride, &offset);
-			dx->mDeviceContext->IASetInputLayout(dx->mFixedLayout);
-			dx->mDeviceContext->Draw(count, 0);
-		}
-	}
+	return ( ! dx->mLightingEnabled ) && ( ! dx->getRenderFlag( app::AppImplMswRendererDx::CUSTOM_SHADER_ACTIVE ) );
 }
 
-
-
-
 static void applyDxFixedPipeline(const FixedVertex *verts, UINT elements, ID3D11VertexShader *vs, ID3D11PixelShader *ps, D3D_PRIMITIVE_TOPOLOGY topology)
 {
 	auto dx = getDxRenderer();
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	dx->mDeviceContext->Map(dx->mCBMatrices, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[0] = dx->mProjection.top();
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[1] = dx->mModelView.top();
-	dx->mDeviceContext->Unmap(dx->mCBMatrices, 0);
+	dx->flushBatch();
+	dx->updateMatrices( dx->mProjection.top(), dx->mModelView.top() );
 	if(dx->mLightingEnabled) {
 		dx->mDeviceContext->VSSetConstantBuffers(1, 1, &dx->mCBLights);
 	}
@@ -190,6 +129,7 @@ static void applyDxFixedPipeline(const FixedVertex *verts, UINT elements, ID3D11
 	}
 	dx->mDeviceContext->VSSetConstantBuffers(0, 1, &dx->mCBMatrices);
 	dx->mDeviceContext->IASetPrimitiveTopology(topology);
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	dx->mDeviceContext->Map( dx->mVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
 	memcpy( mappedResource.pData, verts, sizeof(FixedVertex) * elements );
 	dx->mDeviceContext->Unmap( dx->mVertexBuffer, 0 );
@@ -214,6 +154,7 @@ void clear( const ColorA &color, bool clearDepthBuffer )
 	//else
 	{
 		auto dx = getDxRenderer();
+		dx->flushBatch();
 		dx->mDeviceContext->ClearRenderTargetView(dx->mMainFramebuffer, &color.r);
 		if(clearDepthBuffer)
 			dx->mDeviceContext->ClearDepthStencilView(dx->mDepthStencilView, D3D11_CLEAR_DEPTH, 1, 0);
@@ -593,6 +534,92 @@ void begin( GLenum mode )
 	getDxRenderer()->mImmediateModePrimitive = mode;
 }
 
+//! Converts the immediate mode vertices \a in recorded for \a mode to an equivalent list topology in \a out, which keeps consecutive begin()/end() blocks batchable
+static D3D_PRIMITIVE_TOPOLOGY convertToListTopology( GLenum mode, const std::vector<FixedVertex> &in, std::vector<FixedVertex> *out )
+{
+	out->clear();
+	const size_t n = in.size();
+	switch( mode ) {
+		case GL_POINTS:
+			out->assign( in.begin(), in.end() );
+		return D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
+
+		case GL_LINES:
+			out->assign( in.begin(), in.begin() + ( n - n % 2 ) );
+		return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+
+		case GL_LINE_STRIP:
+		case GL_LINE_LOOP:
+			if( n < 2 )
+				return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+			out->reserve( n * 2 );
+			for( size_t i = 1; i < n; ++i ) {
+				out->push_back( in[i-1] );
+				out->push_back( in[i] );
+			}
+			if( mode == GL_LINE_LOOP ) {
+				out->push_back( in[n-1] );
+				out->push_back( in[0] );
+			}
+		return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+
+		case GL_TRIANGLES:
+			out->assign( in.begin(), in.begin() + ( n - n % 3 ) );
+		return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+		case GL_TRIANGLE_STRIP:
+			if( n < 3 )
+				return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+			out->reserve( ( n - 2 ) * 3 );
+			for( size_t i = 2; i < n; ++i ) {
+				// every other triangle of a strip has its winding reversed
+				out->push_back( in[( i % 2 ) ? i-1 : i-2] );
+				out->push_back( in[( i % 2 ) ? i-2 : i-1] );
+				out->push_back( in[i] );
+			}
+		return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+		case GL_POLYGON: //have no flipping clue how to do this but it seems to act like triangle fan
+		case GL_TRIANGLE_FAN:
+			if( n < 3 )
+				return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+			out->reserve( ( n - 2 ) * 3 );
+			for( size_t i = 2; i < n; ++i ) {
+				out->push_back( in[0] );
+				out->push_back( in[i-1] );
+				out->push_back( in[i] );
+			}
+		return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+		case GL_QUADS:
+			out->reserve( ( n / 4 ) * 6 );
+			for( size_t i = 0; i + 3 < n; i += 4 ) {
+				out->push_back( in[i+0] );
+				out->push_back( in[i+1] );
+				out->push_back( in[i+2] );
+				out->push_back( in[i+0] );
+				out->push_back( in[i+2] );
+				out->push_back( in[i+3] );
+			}
+		return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+		case GL_QUAD_STRIP:
+			//ignore the odd vertex
+			out->reserve( ( n / 2 ) * 6 );
+			for( size_t i = 2; i + 1 < n; i += 2 ) {
+				out->push_back( in[i-2] );
+				out->push_back( in[i-1] );
+				out->push_back( in[i+1] );
+				out->push_back( in[i-2] );
+				out->push_back( in[i+1] );
+				out->push_back( in[i-0] );
+			}
+		return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	}
+
+	return D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
+}
+
 void end()
 {
 //	if(usingGL())
@@ -601,147 +628,19 @@ void end()
 //	else
 	{
 		auto dx = getDxRenderer();
-		size_t vertexCount = dx->mImmediateModeVerts.size();
-		if(vertexCount == 0)
+		if( dx->mImmediateModeVerts.empty() )
 			return;
 
-		std::vector<FixedVertex> *vertexBuffer = &dx->mImmediateModeVerts;
-		std::vector<FixedVertex> newVerts;
-
-		dx->mProjection.push();
-		dx->mProjection.top() = Matrix44f::identity();
-		dx->mModelView.push();
-		dx->mModelView.top() = Matrix44f::identity();
-		if(dx->mImmediateModePrimitive == GL_QUADS) {
-			// optimized draw routine for GL_QUADS
-			drawQuads();
-		}
-		else
-		{
-			ID3D11ShaderResourceView *view;
-			dx->mDeviceContext->PSGetShaderResources(0, 1, &view);
-			ID3D11VertexShader *vs = (view) ? TEXTURE_VERTEX : COLOR_VERTEX;
-			ID3D11PixelShader *ps = (view) ? TEXTURE_PIXEL : COLOR_PIXEL;
-			D3D_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
-
-			switch(dx->mImmediateModePrimitive)
-			{
-				case GL_POINTS:
-					topology = D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
-					break;
-
-				case GL_LINES:
-					topology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
-					break;
-					
-				case GL_LINE_STRIP:
-					topology = D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
-					break;
-
-				case GL_LINE_LOOP:
-					dx->mImmediateModeVerts.push_back(dx->mImmediateModeVerts[0]);
-					topology = D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
-					break;
-
-				case GL_TRIANGLES:
-					topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-					break;
-
-				case GL_TRIANGLE_STRIP:
-					topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
-					break;
-					
-				//TODO: need to optimize this
-				case GL_POLYGON: //have no flipping clue how to do this but it seems to act like triangle fan
-				case GL_TRIANGLE_FAN:
-				{
-					if(dx->mImmediateModeVerts.size() < 3)
-						break;
-					for(unsigned i = 2; i < dx->mImmediateModeVerts.size(); ++i)
-					{
-						newVerts.push_back(dx->mImmediateModeVerts[0]);
-						newVerts.push_back(dx->mImmediateModeVerts[i-1]);
-						newVerts.push_back(dx->mImmediateModeVerts[i]);
-					}
-					vertexBuffer = &newVerts;
-					topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-					break;
-				}
-
-#if 0
-				case GL_QUADS:
-					{
-						if(dx->mImmediateModeVerts.size() < 4)
-							break;
-
-
-						newVerts.reserve(dx->mImmediateModeVerts.size() * 2);
-						for(unsigned i = 0; i < dx->mImmediateModeVerts.size(); i += 4)
-						{
-							newVerts.push_back(dx->mImmediateModeVerts[i+0]);
-							newVerts.push_back(dx->mImmediateModeVerts[i+1]);
-							newVerts.push_back(dx->mImmediateModeVerts[i+2]);
-							newVerts.push_back(dx->mImmediateModeVerts[i+0]);
-							newVerts.push_back(dx->mImmediateModeVerts[i+2]);
-							newVerts.push_back(dx->mImmediateModeVerts[i+3]);
-						}
-						vertexBuffer = &newVerts;
-						topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-						break;
-					}  
-#endif // 0
-
-				//TODO: need to optimize this
-				case GL_QUAD_STRIP:
-				{
-					if(dx->mImmediateModeVerts.size() < 4)
-						break;
-					newVerts.reserve(dx->mImmediateModeVerts.size() * 2);
-
-					newVerts.push_back(dx->mImmediateModeVerts[0]);
-					newVerts.push_back(dx->mImmediateModeVerts[1]);
-					newVerts.push_back(dx->mImmediateModeVerts[3]);
-					newVerts.push_back(dx->mImmediateModeVerts[0]);
-					newVerts.push_back(dx->mImmediateModeVerts[3]);
-					newVerts.push_back(dx->mImmediateModeVerts[2]);
-					
-					//ignore the odd vertex
-					if(dx->mImmediateModeVerts.size() % 2)
-						dx->mImmediateModeVerts.pop_back();
-					for(unsigned i = 4; i < dx->mImmediateModeVerts.size(); i += 2)
-					{
-						newVerts.push_back(dx->mImmediateModeVerts[i-2]);
-						newVerts.push_back(dx->mImmediateModeVerts[i-1]);
-						newVerts.push_back(dx->mImmediateModeVerts[i+1]);
-						newVerts.push_back(dx->mImmediateModeVerts[i-2]);
-						newVerts.push_back(dx->mImmediateModeVerts[i+1]);
-						newVerts.push_back(dx->mImmediateModeVerts[i-0]);
-					}
-					vertexBuffer = &newVerts;
-					topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-					break;
-				}
-			}
-			vertexCount = vertexBuffer->size();
-			size_t verticesProcessed = 0;
-			FixedVertex* fv = vertexBuffer->data();
-
-			while(vertexCount >= D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT) 
-			{
-				applyDxFixedPipeline(&fv[verticesProcessed], D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT , vs, ps, topology);
-				dx->mDeviceContext->Draw(D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT, 0);
-				verticesProcessed += D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT;
-				vertexCount -= D3D_FL9_1_IA_PRIMITIVE_MAX_COUNT;
-			}
+		ID3D11ShaderResourceView *view;
+		dx->mDeviceContext->PSGetShaderResources(0, 1, &view);
+		ID3D11VertexShader *vs = (view) ? TEXTURE_VERTEX : COLOR_VERTEX;
+		ID3D11PixelShader *ps = (view) ? TEXTURE_PIXEL : COLOR_PIXEL;
+		if( view )
+			view->Release();
 
-			if(vertexCount > 0) 
-			{
-				applyDxFixedPipeline(&fv[verticesProcessed], vertexCount, vs, ps, topology);
-				dx->mDeviceContext->Draw(vertexCount, 0);
-			}
-		}
-		dx->mProjection.pop();
-		dx->mModelView.pop();
+		// the vertices were transformed into clip space as they were recorded, so consecutive blocks can share a single draw
+		D3D_PRIMITIVE_TOPOLOGY topology = convertToListTopology( dx->mImmediateModePrimitive, dx->mImmediateModeVerts, &dx->mImmediateModeListVerts );
+		dx->batchVertices( dx->mImmediateModeListVerts.data(), dx->mImmediateModeListVerts.size(), topology, vs, ps, view );
 	}
 //#endif
 }
@@ -923,7 +822,6 @@ void disableAlphaTest()
 void enableWireframe()
 {
 	auto dx = getDxRenderer();
-	if(dx->mDefaultRenderState) dx->mDefaultRenderState->Release();
 	D3D11_RASTERIZER_DESC rd;
 	rd.FillMode = D3D11_FILL_WIREFRAME;
 	rd.CullMode = D3D11_CULL_NONE;
@@ -935,15 +833,13 @@ void enableWireframe()
 	rd.ScissorEnable = FALSE;
 	rd.MultisampleEnable = FALSE;
 	rd.AntialiasedLineEnable = FALSE;
-	dx->md3dDevice->CreateRasterizerState( &rd, &dx->mDefaultRenderState );
-	dx->mDeviceContext->RSSetState( dx->mDefaultRenderState );
+	dx->setRasterizerState( rd );
 	//glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 }
 
 void disableWireframe()
 {
 	auto dx = getDxRenderer();
-	if(dx->mDefaultRenderState) dx->mDefaultRenderState->Release();
 	D3D11_RASTERIZER_DESC rd;
 	rd.FillMode = D3D11_FILL_SOLID;
 	rd.CullMode = D3D11_CULL_NONE;
@@ -955,8 +851,7 @@ void disableWireframe()
 	rd.ScissorEnable = FALSE;
 	rd.MultisampleEnable = FALSE;
 	rd.AntialiasedLineEnable = FALSE;
-	dx->md3dDevice->CreateRasterizerState( &rd, &dx->mDefaultRenderState );
-	dx->mDeviceContext->RSSetState( dx->mDefaultRenderState );
+	dx->setRasterizerState( rd );
 	//glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
 }
 #endif
@@ -1040,10 +935,7 @@ void setLight(const Light &light)
 	data.quadAtt = light.getQuadraticAtt();
 	data.spotExponent = light.getSpotExponent();
 	data.spotCutoff = toRadians(light.getSpotCutoff());
-	D3D11_MAPPED_SUBRESOURCE subResource;
-	dx->mDeviceContext->Map(dx->mCBLights, 0, D3D11_MAP_WRITE_DISCARD, 0, &subResource);
-	memcpy(subResource.pData, dx->mLights, sizeof(dx->mLights));
-	dx->mDeviceContext->Unmap(dx->mCBLights, 0);
+	dx->updateLights();
 
 }
 
@@ -1063,6 +955,16 @@ void drawLine( const Vec2f &start, const Vec2f &end )
 //	else
 	{
 		auto dx = getDxRenderer();
+		if( canBatchPrimitives( dx ) ) {
+			const Matrix44f mvp = dx->mProjection.top() * dx->mModelView.top();
+			FixedVertex verts[2] = {
+				FixedVertex(mvp * Vec4f(start.x, start.y, 0, 1), dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor),
+				FixedVertex(mvp * Vec4f(end.x, end.y, 0, 1), dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor)
+			};
+			dx->batchVertices( verts, 2, D3D11_PRIMITIVE_TOPOLOGY_LINELIST, COLOR_VERTEX, COLOR_PIXEL, NULL );
+			return;
+		}
+
 		FixedVertex verts[2];
 		verts[0] = FixedVertex(Vec3f(start, 0), dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor);
 		verts[1] = FixedVertex(Vec3f(end, 0), dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor);
@@ -1088,6 +990,16 @@ void drawLine( const Vec3f &start, const Vec3f &end )
 //	else
 	{
 		auto dx = getDxRenderer();
+		if( canBatchPrimitives( dx ) ) {
+			const Matrix44f mvp = dx->mProjection.top() * dx->mModelView.top();
+			FixedVertex verts[2] = {
+				FixedVertex(mvp * Vec4f(start, 1), dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor),
+				FixedVertex(mvp * Vec4f(end, 1), dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor)
+			};
+			dx->batchVertices( verts, 2, D3D11_PRIMITIVE_TOPOLOGY_LINELIST, COLOR_VERTEX, COLOR_PIXEL, NULL );
+			return;
+		}
+
 		dx->mDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
 		FixedVertex verts[2];
 		verts[0] = FixedVertex(start, dx->mCurrentNormal, dx->mCurrentUV, dx->mCurrentColor);
@@ -1557,6 +1469,18 @@ void drawSolidRect( const Rectf &rect, bool textureRectangle )
 //	else
 	{
 		auto dx = getDxRenderer();
+		if( canBatchPrimitives( dx ) ) {
+			const Matrix44f mvp = dx->mProjection.top() * dx->mModelView.top();
+			const FixedVertex v0( mvp * Vec4f(rect.getX2(), rect.getY1(), 0, 1), dx->mCurrentNormal, Vec2f((textureRectangle) ? rect.getX2() : 1, (textureRectangle) ? rect.getY1() : 0), dx->mCurrentColor );
+			const FixedVertex v1( mvp * Vec4f(rect.getX1(), rect.getY1(), 0, 1), dx->mCurrentNormal, Vec2f((textureRectangle) ? rect.getX1() : 0, (textureRectangle) ? rect.getY1() : 0), dx->mCurrentColor );
+			const FixedVertex v2( mvp * Vec4f(rect.getX2(), rect.getY2(), 0, 1), dx->mCurrentNormal, Vec2f((textureRectangle) ? rect.getX2() : 1, (textureRectangle) ? rect.getY2() : 1), dx->mCurrentColor );
+			const FixedVertex v3( mvp * Vec4f(rect.getX1(), rect.getY2(), 0, 1), dx->mCurrentNormal, Vec2f((textureRectangle) ? rect.getX1() : 0, (textureRectangle) ? rect.getY2() : 1), dx->mCurrentColor );
+			// the same two triangles as the strip below, as a list so that consecutive rects merge
+			FixedVertex verts[6] = { v0, v1, v2, v2, v1, v3 };
+			dx->batchVertices( verts, 6, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, COLOR_VERTEX, COLOR_PIXEL, NULL );
+			return;
+		}
+
 		FixedVertex verts[4] = {
 			FixedVertex(Vec3f(rect.getX2(), rect.getY1(), 0), dx->mCurrentNormal, Vec2f((textureRectangle) ? rect.getX2() : 1, (textureRectangle) ? rect.getY1() : 0), dx->mCurrentColor),
 			FixedVertex(Vec3f(rect.getX1(), rect.getY1(), 0), dx->mCurrentNormal, Vec2f((textureRectangle) ? rect.getX1() : 1, (textureRectangle) ? rect.getY1() : 0), dx->mCurrentColor),
@@ -2689,23 +2613,10 @@ void drawRange( const TriMesh &mesh, size_t startTriangle, size_t triangleCount
 //#endif
 }
 
-void draw( const VboMesh &vbo )
-{
-	if( vbo.getNumIndices() > 0 )
-		drawRange( vbo, (size_t)0, vbo.getNumIndices() );
-	else
-		drawArrays( vbo, 0, vbo.getNumVertices() );
-}
-
-void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int vertexStart, int vertexEnd )
+//! Selects the fixed function VBO shaders unless a custom shader is bound, uploads the fixed constant buffers and binds \a vbo's buffers and input layout
+static void prepareVboMeshDraw( app::AppImplMswRendererDx *dx, const VboMesh &vbo )
 {
-	if( vbo.getNumIndices() <= 0 )
-		return;
-
-	if( vertexStart < 0 ) vertexStart = 0;
-	if( vertexEnd < 0 ) vertexEnd = vbo.getNumVertices();
-
-	auto dx = getDxRenderer();
+	dx->flushBatch();
 	if(!dx->getRenderFlag(app::AppImplMswRendererDx::CUSTOM_SHADER_ACTIVE))
 	{
 		ID3D11ShaderResourceView *view;
@@ -2730,26 +2641,40 @@ void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int ve
 			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionTextureLightVS : dx->mVboPositionTextureVS, NULL, 0);
 		else
 			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionLightVS : dx->mVboPositionVS, NULL, 0);
-		if(view)
+		if(view) {
 			dx->mDeviceContext->PSSetShader(TEXTURE_PIXEL, NULL, 0);
+			view->Release();
+		}
 		else
 			dx->mDeviceContext->PSSetShader(COLOR_PIXEL, NULL , 0);
 	}
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	dx->mDeviceContext->Map(dx->mCBMatrices, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[0] = dx->mProjection.top();
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[1] = dx->mModelView.top();
-	dx->mDeviceContext->Unmap(dx->mCBMatrices, 0);
-	dx->mDeviceContext->Map(dx->mCBFixedParameters, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	reinterpret_cast<Vec4f*>(mappedResource.pData)[0] = dx->mCurrentNormal;
-	reinterpret_cast<Vec4f*>(mappedResource.pData)[1] = Vec4f(dx->mCurrentUV.x, dx->mCurrentUV.y, 0, 0);
-	reinterpret_cast<Vec4f*>(mappedResource.pData)[2] = dx->mCurrentColor;
-	dx->mDeviceContext->Unmap(dx->mCBFixedParameters, 0);
+	dx->updateMatrices( dx->mProjection.top(), dx->mModelView.top() );
+	dx->updateFixedParameters();
 	dx->mDeviceContext->VSSetConstantBuffers(0, 1, &dx->mCBMatrices);
 	dx->mDeviceContext->VSSetConstantBuffers(1, 1, &dx->mCBLights);
 	dx->mDeviceContext->VSSetConstantBuffers(2, 1, &dx->mCBFixedParameters);
 	dx->mDeviceContext->IASetPrimitiveTopology(vbo.getPrimitiveType());
 	vbo.bindAllData();
+}
+
+void draw( const VboMesh &vbo )
+{
+	if( vbo.getNumIndices() > 0 )
+		drawRange( vbo, (size_t)0, vbo.getNumIndices() );
+	else
+		drawArrays( vbo, 0, vbo.getNumVertices() );
+}
+
+void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int vertexStart, int vertexEnd )
+{
+	if( vbo.getNumIndices() <= 0 )
+		return;
+
+	if( vertexStart < 0 ) vertexStart = 0;
+	if( vertexEnd < 0 ) vertexEnd = vbo.getNumVertices();
+
+	auto dx = getDxRenderer();
+	prepareVboMeshDraw( dx, vbo );
 	dx->mDeviceContext->DrawIndexed(indexCount, startIndex, vertexStart);
 
 	//vbo.enableClientStates();
@@ -2767,50 +2692,7 @@ void drawArrays( const VboMesh &vbo, GLint first, GLsizei count )
 	if( count < 0 ) count = vbo.getNumVertices();
 
 	auto dx = getDxRenderer();
-	if(!dx->getRenderFlag(app::AppImplMswRendererDx::CUSTOM_SHADER_ACTIVE))
-	{
-		ID3D11ShaderResourceView *view;
-		dx->mDeviceContext->PSGetShaderResources(0, 1, &view);
-		bool hasNormals = vbo.getLayout().hasNormals();
-		bool hasColors = vbo.getLayout().hasColorsRGB() || vbo.getLayout().hasColorsRGBA();
-		bool hasUVs = vbo.getLayout().hasTexCoords(0);
-		bool lightsEnabled = dx->mLightingEnabled;
-		if(hasNormals && hasColors && hasUVs)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionNormalColorTextureLightVS : dx->mVboPositionNormalColorTextureVS, NULL, 0);
-		else if(hasNormals && hasColors)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionNormalColorLightVS : dx->mVboPositionNormalColorVS, NULL, 0);
-		else if(hasNormals && hasUVs)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionNormalTextureLightVS : dx->mVboPositionNormalTextureVS, NULL, 0);
-		else if(hasNormals)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionNormalLightVS : dx->mVboPositionNormalVS, NULL, 0);
-		else if(hasColors && hasUVs)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionColorTextureLightVS : dx->mVboPositionColorTextureVS, NULL, 0);
-		else if(hasColors)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionColorLightVS : dx->mVboPositionColorVS, NULL, 0);
-		else if(hasUVs)
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionTextureLightVS : dx->mVboPositionTextureVS, NULL, 0);
-		else
-			dx->mDeviceContext->VSSetShader((lightsEnabled) ? dx->mVboPositionLightVS : dx->mVboPositionVS, NULL, 0);
-		if(view)
-			dx->mDeviceContext->PSSetShader(TEXTURE_PIXEL, NULL, 0);
-		else
-			dx->mDeviceContext->PSSetShader(COLOR_PIXEL, NULL , 0);
-	}
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	dx->mDeviceContext->Map(dx->mCBMatrices, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[0] = dx->mProjection.top();
-	reinterpret_cast<Matrix44f*>(mappedResource.pData)[1] = dx->mModelView.top();
-	dx->mDeviceContext->Unmap(dx->mCBMatrices, 0);
-	dx->mDeviceContext->Map(dx->mCBFixedParameters, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	reinterpret_cast<Vec4f*>(mappedResource.pData)[0] = dx->mCurrentNormal;
-	reinterpret_cast<Vec4f*>(mappedResource.pData)[1] = Vec4f(dx->mCurrentUV.x, dx->mCurrentUV.y, 0, 0);
-	reinterpret_cast<Vec4f*>(mappedResource.pData)[2] = dx->mCurrentColor;
-	dx->mDeviceContext->Unmap(dx->mCBFixedParameters, 0);
-	dx->mDeviceContext->VSSetConstantBuffers(0, 1, &dx->mCBMatrices);
-	dx->mDeviceContext->VSSetConstantBuffers(1, 1, &dx->mCBLights);
-	dx->mDeviceContext->VSSetConstantBuffers(2, 1, &dx->mCBFixedParameters);
-	dx->mDeviceContext->IASetPrimitiveTopology(vbo.getPrimitiveType());
-	vbo.bindAllData();
+	prepareVboMeshDraw( dx, vbo );
 	dx->mDeviceContext->Draw(count, first);
 	//vbo.enableClientStates();
 	//vbo.bindAllData();
@@ -2820,6 +2702,29 @@ void drawArrays( const VboMesh &vbo, GLint first, GLsizei count )
 	//vbo.disableClientStates();
 }
 
+void drawInstanced( const VboMesh &vbo, size_t instanceCount )
+{
+	if( instanceCount == 0 )
+		return;
+
+	auto dx = getDxRenderer();
+	prepareVboMeshDraw( dx, vbo );
+	if( vbo.getNumIndices() > 0 )
+		dx->mDeviceContext->DrawIndexedInstanced( (UINT)vbo.getNumIndices(), (UINT)instanceCount, 0, 0, 0 );
+	else
+		dx->mDeviceContext->DrawInstanced( (UINT)vbo.getNumVertices(), (UINT)instanceCount, 0, 0 );
+}
+
+void drawIndirect( const VboMesh &vbo, const Vbo &args, UINT alignedByteOffset )
+{
+	auto dx = getDxRenderer();
+	prepareVboMeshDraw( dx, vbo );
+	if( vbo.getNumIndices() > 0 )
+		dx->mDeviceContext->DrawIndexedInstancedIndirect( args.getId(), alignedByteOffset );
+	else
+		dx->mDeviceContext->DrawInstancedIndirect( args.getId(), alignedByteOffset );
+}
+
 
 void drawBillboard( const Vec3f &pos, const Vec2f &scale, float rotationDegrees, const Vec3f &bbRight, const Vec3f &bbUp )
 {
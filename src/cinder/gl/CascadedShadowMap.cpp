@@ -0,0 +1,223 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/CascadedShadowMap.h"
+#include "cinder/CinderMath.h"
+
+#include <limits>
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// The cascade is found by counting the splits the position lies beyond. Unused splits are never reached.
+const char *sGlslFunctions =
+	"uniform sampler2DShadow ciShadowMap;\n"
+	"uniform mat4 ciShadowMatrices[4];\n"
+	"uniform vec4 ciShadowSplits;\n"
+	"uniform float ciShadowNumCascades;\n"
+	"float ciShadow( vec3 eyePosition ) {\n"
+	"	float cascade = dot( vec4( greaterThan( vec4( -eyePosition.z ), ciShadowSplits ) ), vec4( 1.0 ) );\n"
+	"	if( cascade >= ciShadowNumCascades )\n"
+	"		return 1.0;\n"
+	"	vec4 coord = ciShadowMatrices[int( cascade )] * vec4( eyePosition, 1.0 );\n"
+	"	return shadow2D( ciShadowMap, coord.xyz ).r;\n"
+	"}\n";
+
+} // anonymous namespace
+
+CascadedShadowMap::CascadedShadowMap( const Format &format )
+	: mFormat( format )
+{
+	const int resolution = mFormat.getResolution();
+
+	Fbo::Format fboFormat;
+	fboFormat.enableColorBuffer( false );
+	fboFormat.enableDepthBuffer( true, true );
+	mFbo = Fbo( resolution * mFormat.getNumCascades(), resolution, fboFormat );
+	if( mFormat.isStaticCasterCacheEnabled() )
+		mStaticFbo = Fbo( resolution * mFormat.getNumCascades(), resolution, fboFormat );
+
+	// hardware comparison, with bilinear filtering where supported for 2x2 PCF
+	mFbo.bindDepthTexture();
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	mFbo.unbindTexture();
+
+	for( int c = 0; c < MAX_CASCADES; ++c ) {
+		mSplitDistances[c] = 0;
+		mStaticValid[c] = false;
+	}
+}
+
+void CascadedShadowMap::update( const CameraPersp &camera, const Vec3f &lightDirection )
+{
+	const int numCascades = mFormat.getNumCascades();
+	const float nearClip = camera.getNearClip(), farClip = camera.getFarClip();
+	const float lambda = mFormat.getSplitLambda();
+	const float casterDistance = mFormat.getCasterDistance();
+
+	// the squared tangent of the angle between the view direction and the frustum's corner edges
+	const float tanHalfFov = math<float>::tan( toRadians( camera.getFov() ) * 0.5f );
+	const float aspectRatio = camera.getAspectRatio();
+	const float tanCornerSqr = tanHalfFov * tanHalfFov * ( 1 + aspectRatio * aspectRatio );
+
+	const Vec3f eyePoint = camera.getEyePoint();
+	const Vec3f viewDirection = camera.getViewDirection().normalized();
+	const Matrix44f &cameraInverseModelView = camera.getInverseModelViewMatrix();
+
+	// a basis for the light which doesn't depend on the camera, for snapping to texels
+	const Vec3f lightDir = lightDirection.normalized();
+	Vec3f lightUp = ( math<float>::abs( lightDir.y ) < 0.99f ) ? Vec3f::yAxis() : Vec3f::xAxis();
+	const Vec3f lightRight = lightDir.cross( lightUp ).normalized();
+	lightUp = lightRight.cross( lightDir );
+
+	float sliceNear = nearClip;
+	for( int c = 0; c < numCascades; ++c ) {
+		const float t = ( c + 1 ) / (float)numCascades;
+		const float uniformSplit = nearClip + ( farClip - nearClip ) * t;
+		const float logSplit = nearClip * math<float>::pow( farClip / nearClip, t );
+		const float sliceFar = lerp( uniformSplit, logSplit, lambda );
+		mSplitDistances[c] = sliceFar;
+
+		// the smallest sphere through the slice's near and far corners, whose radius doesn't change as the camera moves or turns
+		const float centerDistance = std::min( 0.5f * ( sliceNear + sliceFar ) * ( 1 + tanCornerSqr ), sliceFar );
+		const float radius = math<float>::sqrt( ( sliceFar - centerDistance ) * ( sliceFar - centerDistance ) + sliceFar * sliceFar * tanCornerSqr );
+		const Vec3f center = eyePoint + viewDirection * centerDistance;
+
+		const float texelSize = 2 * radius / mFormat.getResolution();
+		const Vec3f snappedCenter = lightRight * ( math<float>::floor( center.dot( lightRight ) / texelSize ) * texelSize )
+									+ lightUp * ( math<float>::floor( center.dot( lightUp ) / texelSize ) * texelSize )
+									+ lightDir * ( math<float>::floor( center.dot( lightDir ) / texelSize ) * texelSize );
+
+		CameraOrtho &lightCamera = mLightCameras[c];
+		lightCamera.setOrtho( -radius, radius, -radius, radius, 0, 2 * radius + casterDistance );
+		lightCamera.lookAt( snappedCenter - lightDir * ( radius + casterDistance ), snappedCenter, lightUp );
+		const Matrix44f viewProjection = lightCamera.getProjectionMatrix() * lightCamera.getModelViewMatrix();
+
+		// maps clip coordinates to the cascade's tile of the depth texture
+		Matrix44f tile;
+		tile.setToNull();
+		tile.m[0] = 0.5f / numCascades;
+		tile.m[5] = 0.5f;
+		tile.m[10] = 0.5f;
+		tile.m[12] = ( 0.5f + c ) / numCascades;
+		tile.m[13] = 0.5f;
+		tile.m[14] = 0.5f;
+		tile.m[15] = 1;
+		mShadowMatrices[c] = tile * viewProjection * cameraInverseModelView;
+
+		if( mStaticViewProjections[c] != viewProjection ) {
+			mStaticViewProjections[c] = viewProjection;
+			mStaticValid[c] = false;
+		}
+
+		sliceNear = sliceFar;
+	}
+}
+
+void CascadedShadowMap::invalidateStaticCasters()
+{
+	for( int c = 0; c < MAX_CASCADES; ++c )
+		mStaticValid[c] = false;
+}
+
+void CascadedShadowMap::drawCasters( Fbo &fbo, int cascade, const DrawCastersFn &drawCasters, bool clear )
+{
+	const int resolution = mFormat.getResolution();
+	fbo.bindFramebuffer();
+	glViewport( cascade * resolution, 0, resolution, resolution );
+	glScissor( cascade * resolution, 0, resolution, resolution );
+	if( clear )
+		glClear( GL_DEPTH_BUFFER_BIT );
+	if( drawCasters ) {
+		setMatrices( mLightCameras[cascade] );
+		drawCasters( cascade );
+	}
+}
+
+void CascadedShadowMap::render( const DrawCastersFn &drawDynamicCasters, const DrawCastersFn &drawStaticCasters )
+{
+	SaveFramebufferBinding saveFramebufferBinding;
+	glPushAttrib( GL_VIEWPORT_BIT | GL_SCISSOR_BIT | GL_ENABLE_BIT | GL_POLYGON_BIT | GL_DEPTH_BUFFER_BIT );
+	pushMatrices();
+
+	glEnable( GL_DEPTH_TEST );
+	glDepthMask( GL_TRUE );
+	glEnable( GL_SCISSOR_TEST ); // confines each clear to its cascade's tile
+	glPolygonOffset( 1.0f, 1.0f );
+	glEnable( GL_POLYGON_OFFSET_FILL );
+
+	const int resolution = mFormat.getResolution();
+	for( int c = 0; c < mFormat.getNumCascades(); ++c ) {
+		if( mStaticFbo ) {
+			if( ! mStaticValid[c] ) {
+				drawCasters( mStaticFbo, c, drawStaticCasters, true );
+				mStaticValid[c] = true;
+			}
+			const Area tile( c * resolution, 0, ( c + 1 ) * resolution, resolution );
+			glScissor( tile.x1, tile.y1, resolution, resolution );
+			mStaticFbo.blitTo( mFbo, tile, tile, GL_NEAREST, GL_DEPTH_BUFFER_BIT );
+			drawCasters( mFbo, c, drawDynamicCasters, false );
+		}
+		else {
+			drawCasters( mFbo, c, drawStaticCasters, true );
+			drawCasters( mFbo, c, drawDynamicCasters, false );
+		}
+	}
+
+	popMatrices();
+	glPopAttrib();
+}
+
+void CascadedShadowMap::setUniforms( GlslProg &shader, int textureUnit )
+{
+	mFbo.bindDepthTexture( textureUnit );
+
+	Vec4f splits( numeric_limits<float>::max(), numeric_limits<float>::max(), numeric_limits<float>::max(), numeric_limits<float>::max() );
+	for( int c = 0; c < mFormat.getNumCascades(); ++c )
+		splits[c] = mSplitDistances[c];
+
+	shader.uniform( "ciShadowMap", textureUnit );
+	shader.uniform( "ciShadowMatrices", mShadowMatrices, mFormat.getNumCascades() );
+	shader.uniform( "ciShadowSplits", splits );
+	shader.uniform( "ciShadowNumCascades", (float)mFormat.getNumCascades() );
+}
+
+const char* CascadedShadowMap::getGlslFunctions()
+{
+	return sGlslFunctions;
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,393 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/ContextWorker.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/app/App.h"
+#include "cinder/app/Renderer.h"
+
+#if defined( CINDER_COCOA_TOUCH )
+	#import <OpenGLES/EAGL.h>
+#endif
+
+#include <chrono>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+#if defined( CINDER_MSW )
+// GL_ARB_sync is part of OpenGL 3.2, which GLee predates, so its entry points are loaded here
+typedef struct __GLsync *SyncObject;
+typedef SyncObject (APIENTRY *FenceSyncFn)( GLenum condition, GLbitfield flags );
+typedef GLenum (APIENTRY *ClientWaitSyncFn)( SyncObject sync, GLbitfield flags, uint64_t timeout );
+typedef void (APIENTRY *DeleteSyncFn)( SyncObject sync );
+
+const GLenum SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+const GLenum TIMEOUT_EXPIRED = 0x911B;
+
+template<typename FnT>
+FnT getProcAddress( const char *name )
+{
+	// some drivers return small integers rather than NULL for entry points they don't have
+	PROC proc = ::wglGetProcAddress( name );
+	return ( (INT_PTR)proc > 3 ) ? reinterpret_cast<FnT>( proc ) : NULL;
+}
+#endif
+
+// Fences inserted and tested in the calling thread's current context. Where fences aren't supported, insert() waits for the commands to finish instead.
+class Fences {
+  public:
+	Fences()
+	{
+#if defined( CINDER_MSW )
+		mFenceSync = getProcAddress<FenceSyncFn>( "glFenceSync" );
+		mClientWaitSync = getProcAddress<ClientWaitSyncFn>( "glClientWaitSync" );
+		mDeleteSync = getProcAddress<DeleteSyncFn>( "glDeleteSync" );
+		if( ! ( mFenceSync && mClientWaitSync && mDeleteSync ) )
+			mFenceSync = NULL;
+#endif
+	}
+
+	//! Inserts a fence behind the commands issued so far and flushes them. Returns 0 once the commands have finished if fences aren't supported.
+	uintptr_t insert()
+	{
+#if defined( CINDER_MSW )
+		if( mFenceSync ) {
+			SyncObject sync = (*mFenceSync)( SYNC_GPU_COMMANDS_COMPLETE, 0 );
+			glFlush();
+			if( sync )
+				return reinterpret_cast<uintptr_t>( sync );
+		}
+#elif defined( CINDER_MAC )
+		GLuint fence;
+		glGenFencesAPPLE( 1, &fence );
+		glSetFenceAPPLE( fence );
+		glFlush();
+		return fence;
+#endif
+		glFinish();
+		return 0;
+	}
+
+	bool isPassed( uintptr_t fence )
+	{
+		if( ! fence )
+			return true;
+#if defined( CINDER_MSW )
+		return (*mClientWaitSync)( reinterpret_cast<SyncObject>( fence ), 0, 0 ) != TIMEOUT_EXPIRED;
+#elif defined( CINDER_MAC )
+		return glTestFenceAPPLE( (GLuint)fence ) == GL_TRUE;
+#else
+		return true;
+#endif
+	}
+
+	void destroy( uintptr_t fence )
+	{
+		if( ! fence )
+			return;
+#if defined( CINDER_MSW )
+		(*mDeleteSync)( reinterpret_cast<SyncObject>( fence ) );
+#elif defined( CINDER_MAC )
+		GLuint fenceId = (GLuint)fence;
+		glDeleteFencesAPPLE( 1, &fenceId );
+#endif
+	}
+
+  private:
+#if defined( CINDER_MSW )
+	FenceSyncFn			mFenceSync;
+	ClientWaitSyncFn	mClientWaitSync;
+	DeleteSyncFn		mDeleteSync;
+#endif
+};
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SharedContext
+SharedContext::SharedContext()
+{
+#if defined( CINDER_MAC )
+	mCglContext = NULL;
+#elif defined( CINDER_COCOA_TOUCH )
+	mEaglContext = nil;
+#elif defined( CINDER_MSW )
+	mWnd = NULL;
+	mDc = NULL;
+	mRc = NULL;
+#endif
+}
+
+#if defined( CINDER_MAC )
+SharedContextRef SharedContext::create( app::RendererGl *renderer )
+{
+	SharedContextRef result( new SharedContext );
+	CGLError err = ::CGLCreateContext( renderer->getCglPixelFormat(), renderer->getCglContext(), &result->mCglContext );
+	if( err != kCGLNoError )
+		throw SharedContextExc( string( "Failed to create shared context: " ) + ::CGLErrorString( err ) );
+
+	return result;
+}
+
+SharedContext::~SharedContext()
+{
+	if( mCglContext )
+		::CGLReleaseContext( mCglContext );
+}
+
+void SharedContext::makeCurrent()
+{
+	::CGLSetCurrentContext( mCglContext );
+	// bindings are per context; this only affects a StateCache tracking this thread
+	StateCache::invalidate();
+}
+
+void SharedContext::clearCurrent()
+{
+	::CGLSetCurrentContext( NULL );
+	StateCache::invalidate();
+}
+
+#elif defined( CINDER_COCOA_TOUCH )
+SharedContextRef SharedContext::create( app::RendererGl *renderer )
+{
+	SharedContextRef result( new SharedContext );
+	EAGLContext *context = renderer->getEaglContext();
+	result->mEaglContext = [[EAGLContext alloc] initWithAPI:[context API] sharegroup:[context sharegroup]];
+	if( ! result->mEaglContext )
+		throw SharedContextExc( "Failed to create shared context" );
+
+	return result;
+}
+
+SharedContext::~SharedContext()
+{
+	[mEaglContext release];
+}
+
+void SharedContext::makeCurrent()
+{
+	[EAGLContext setCurrentContext:mEaglContext];
+	StateCache::invalidate();
+}
+
+void SharedContext::clearCurrent()
+{
+	[EAGLContext setCurrentContext:nil];
+	StateCache::invalidate();
+}
+
+#elif defined( CINDER_MSW )
+SharedContextRef SharedContext::create( app::RendererGl *renderer )
+{
+	// the context gets a hidden window of its own, with the same pixel format as the Renderer's, so that it doesn't depend on the App's windows
+	static bool sClassRegistered = false;
+	HINSTANCE instance = ::GetModuleHandle( NULL );
+	if( ! sClassRegistered ) {
+		WNDCLASS wc;
+		::ZeroMemory( &wc, sizeof( wc ) );
+		wc.style = CS_OWNDC;
+		wc.lpfnWndProc = DefWindowProc;
+		wc.hInstance = instance;
+		wc.lpszClassName = TEXT("CINDERSHAREDGL");
+		if( ! ::RegisterClass( &wc ) )
+			throw SharedContextExc( "Failed to register the shared context's window class" );
+		sClassRegistered = true;
+	}
+
+	SharedContextRef result( new SharedContext );
+	result->mWnd = ::CreateWindowEx( 0, TEXT("CINDERSHAREDGL"), TEXT(""), WS_POPUP, 0, 0, 1, 1, NULL, NULL, instance, NULL );
+	if( ! result->mWnd )
+		throw SharedContextExc( "Failed to create the shared context's window" );
+	result->mDc = ::GetDC( result->mWnd );
+
+	HDC rendererDc = renderer->getDc();
+	int pixelFormat = ::GetPixelFormat( rendererDc );
+	PIXELFORMATDESCRIPTOR pfd;
+	if( ( pixelFormat == 0 ) || ( ! ::DescribePixelFormat( rendererDc, pixelFormat, sizeof( pfd ), &pfd ) ) || ( ! ::SetPixelFormat( result->mDc, pixelFormat, &pfd ) ) )
+		throw SharedContextExc( "Failed to set the shared context's pixel format" );
+
+	result->mRc = ::wglCreateContext( result->mDc );
+	if( ! result->mRc )
+		throw SharedContextExc( "Failed to create shared context" );
+	if( ! ::wglShareLists( renderer->getHglrc(), result->mRc ) )
+		throw SharedContextExc( "Failed to share resources with the Renderer's context" );
+
+	return result;
+}
+
+SharedContext::~SharedContext()
+{
+	if( mRc )
+		::wglDeleteContext( mRc );
+	if( mDc )
+		::ReleaseDC( mWnd, mDc );
+	if( mWnd )
+		::DestroyWindow( mWnd );
+}
+
+void SharedContext::makeCurrent()
+{
+	::wglMakeCurrent( mDc, mRc );
+	StateCache::invalidate();
+}
+
+void SharedContext::clearCurrent()
+{
+	::wglMakeCurrent( NULL, NULL );
+	StateCache::invalidate();
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ContextWorker
+ContextWorker::ContextWorker()
+	: mShouldQuit( false ), mNumPending( 0 )
+{
+}
+
+ContextWorkerRef ContextWorker::create( app::RendererGl *renderer, size_t numThreads )
+{
+	ContextWorkerRef result( new ContextWorker );
+	for( size_t i = 0; i < std::max<size_t>( numThreads, 1 ); ++i )
+		result->mContexts.push_back( SharedContext::create( renderer ) );
+	for( size_t i = 0; i < result->mContexts.size(); ++i )
+		result->mThreads.push_back( thread( std::bind( &ContextWorker::threadLoop, result.get(), result->mContexts[i].get() ) ) );
+
+	return result;
+}
+
+ContextWorker::~ContextWorker()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mShouldQuit = true;
+	}
+	mJobCond.notify_all();
+	for( vector<thread>::iterator threadIt = mThreads.begin(); threadIt != mThreads.end(); ++threadIt )
+		threadIt->join();
+
+	// the contexts are released here rather than by their threads, as on MSW their windows belong to the main thread
+	mContexts.clear();
+}
+
+void ContextWorker::submit( const Fn &createFn, const Fn &readyFn, const ErrorFn &errorFn )
+{
+	Job job;
+	job.mCreateFn = createFn;
+	job.mReadyFn = readyFn;
+	job.mErrorFn = errorFn;
+
+	++mNumPending;
+	{
+		lock_guard<mutex> lock( mMutex );
+		mJobs.push_back( job );
+	}
+	mJobCond.notify_one();
+}
+
+void ContextWorker::threadLoop( SharedContext *context )
+{
+	ThreadSetup threadSetup;
+	context->makeCurrent();
+
+	Fences fences;
+	deque<pair<Job, uintptr_t> > inFlight; // jobs whose fences haven't been passed, oldest first
+
+	unique_lock<mutex> lock( mMutex );
+	while( ! mShouldQuit ) {
+		// while jobs are in flight their fences are polled, otherwise the thread sleeps until a job is submitted
+		if( mJobs.empty() ) {
+			if( inFlight.empty() )
+				mJobCond.wait( lock );
+			else
+				mJobCond.wait_for( lock, chrono::milliseconds( 1 ) );
+		}
+
+		if( ( ! mShouldQuit ) && ( ! mJobs.empty() ) ) {
+			Job job = mJobs.front();
+			mJobs.pop_front();
+			lock.unlock();
+
+			exception_ptr exc;
+			try {
+				job.mCreateFn();
+			}
+			catch( ... ) {
+				exc = current_exception();
+			}
+			// release anything captured by the function while its context is current
+			job.mCreateFn = Fn();
+
+			if( exc )
+				dispatch( job, exc );
+			else
+				inFlight.push_back( make_pair( job, fences.insert() ) );
+		}
+		else
+			lock.unlock();
+
+		// fences in a context are passed in the order they were inserted
+		while( ( ! inFlight.empty() ) && fences.isPassed( inFlight.front().second ) ) {
+			fences.destroy( inFlight.front().second );
+			dispatch( inFlight.front().first, exception_ptr() );
+			inFlight.pop_front();
+		}
+
+		lock.lock();
+	}
+	lock.unlock();
+
+	for( deque<pair<Job, uintptr_t> >::iterator jobIt = inFlight.begin(); jobIt != inFlight.end(); ++jobIt )
+		fences.destroy( jobIt->second );
+	inFlight.clear();
+	context->clearCurrent();
+}
+
+void ContextWorker::dispatch( const Job &job, exception_ptr exc )
+{
+	app::App *app = app::App::get();
+	if( ! exc ) {
+		if( job.mReadyFn && app )
+			app->dispatchAsync( job.mReadyFn );
+		else if( job.mReadyFn )
+			job.mReadyFn();
+	}
+	else if( job.mErrorFn ) {
+		ErrorFn errorFn = job.mErrorFn;
+		if( app )
+			app->dispatchAsync( [errorFn, exc] { errorFn( exc ); } );
+		else
+			errorFn( exc );
+	}
+	else if( app )
+		app->dispatchAsync( [exc] { rethrow_exception( exc ); } );
+
+	--mNumPending;
+}
+
+} } // namespace cinder::gl
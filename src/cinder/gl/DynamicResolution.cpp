@@ -0,0 +1,236 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/DynamicResolution.h"
+
+#if ! defined( CINDER_GLES )
+
+#include "cinder/app/App.h"
+#include "cinder/CinderMath.h"
+
+#include <string>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+const char *sPassName = "DynamicResolution";
+
+// the vertices of the quad are in clip space, and texel spans [0, renderSize] of the source
+const char *sUpscaleVertexShader =
+	"uniform vec2 renderSize;\n"
+	"varying vec2 texel;\n"
+	"void main() {\n"
+	"	gl_Position = gl_Vertex;\n"
+	"	texel = ( gl_Vertex.xy * 0.5 + 0.5 ) * renderSize;\n"
+	"}\n";
+
+// bilinear upsample followed by an unsharp mask of the 4 neighbouring source texels, clamped to the rendered region so nothing outside it bleeds in
+const char *sUpscaleFragmentShader =
+	"uniform SAMPLER tex0;\n"
+	"uniform vec2 texScale;\n"
+	"uniform vec2 renderSize;\n"
+	"uniform float sharpness;\n"
+	"varying vec2 texel;\n"
+	"vec4 fetch( vec2 p ) {\n"
+	"	return TEXTURE( tex0, clamp( p, vec2( 0.5 ), renderSize - vec2( 0.5 ) ) * texScale );\n"
+	"}\n"
+	"void main() {\n"
+	"	vec4 c = fetch( texel );\n"
+	"	if( sharpness > 0.0 ) {\n"
+	"		vec4 sum = fetch( texel + vec2( 1.0, 0.0 ) ) + fetch( texel - vec2( 1.0, 0.0 ) ) + fetch( texel + vec2( 0.0, 1.0 ) ) + fetch( texel - vec2( 0.0, 1.0 ) );\n"
+	"		c.rgb = clamp( c.rgb + sharpness * ( 4.0 * c.rgb - sum.rgb ), 0.0, 1.0 );\n"
+	"	}\n"
+	"	gl_FragColor = c;\n"
+	"}\n";
+
+} // anonymous namespace
+
+DynamicResolution::DynamicResolution( const Vec2i &outputSize, const Format &format )
+	: mFormat( format ), mOutputSize( outputSize ), mAdjustmentEnabled( true ), mSmoothedCost( 0 ), mFramesSinceChange( 0 ), mSavedFramebuffer( 0 )
+{
+	mFormat.minScale( math<float>::max( mFormat.getMinScale(), 0.01f ) );
+	mFormat.maxScale( math<float>::max( mFormat.getMaxScale(), mFormat.getMinScale() ) );
+	Fbo::Format fboFormat = mFormat.getFboFormat();
+	fboFormat.setMinFilter( GL_LINEAR );
+	fboFormat.setMagFilter( GL_LINEAR );
+	fboFormat.enableMipmapping( false );
+	mFormat.fboFormat( fboFormat );
+	mScale = mFormat.getMaxScale();
+	for( int i = 0; i < 4; ++i )
+		mSavedViewport[i] = 0;
+
+	allocateFbo();
+
+	const bool rect = mFormat.getFboFormat().getTarget() == GL_TEXTURE_RECTANGLE_ARB;
+	const string defines = rect ? "#define SAMPLER sampler2DRect\n#define TEXTURE texture2DRect\n" : "#define SAMPLER sampler2D\n#define TEXTURE texture2D\n";
+	const string fragmentShader = ( rect ? "#extension GL_ARB_texture_rectangle : enable\n" : "" ) + defines + sUpscaleFragmentShader;
+	mUpscaleShader = GlslProg( sUpscaleVertexShader, fragmentShader.c_str() );
+	mUpscaleShader.uniform( "tex0", 0 );
+
+	if( GpuProfiler::isSupported() )
+		mGpuProfiler = GpuProfiler::create();
+}
+
+void DynamicResolution::allocateFbo()
+{
+	const int width = math<int>::max( (int)math<float>::ceil( mOutputSize.x * mFormat.getMaxScale() ), 1 );
+	const int height = math<int>::max( (int)math<float>::ceil( mOutputSize.y * mFormat.getMaxScale() ), 1 );
+	if( mFbo && mFbo.getWidth() >= width && mFbo.getHeight() >= height )
+		return;
+
+	mFbo = Fbo( width, height, mFormat.getFboFormat() );
+}
+
+void DynamicResolution::setOutputSize( const Vec2i &outputSize )
+{
+	mOutputSize = outputSize;
+	allocateFbo();
+}
+
+void DynamicResolution::setScale( float scale )
+{
+	mScale = constrain( scale, mFormat.getMinScale(), mFormat.getMaxScale() );
+	mFramesSinceChange = 0;
+}
+
+Vec2i DynamicResolution::getRenderSize() const
+{
+	// clamped to the Fbo, which may be larger than needed after the output shrinks but never smaller
+	return Vec2i( constrain( (int)( mOutputSize.x * mScale + 0.5f ), 1, mFbo.getWidth() ), constrain( (int)( mOutputSize.y * mScale + 0.5f ), 1, mFbo.getHeight() ) );
+}
+
+void DynamicResolution::begin()
+{
+	Batch2d::flush();
+	glGetIntegerv( GL_FRAMEBUFFER_BINDING_EXT, &mSavedFramebuffer );
+	glGetIntegerv( GL_VIEWPORT, mSavedViewport );
+
+	mBeginRenderSize = getRenderSize();
+	mFbo.bindFramebuffer();
+	glViewport( 0, 0, mBeginRenderSize.x, mBeginRenderSize.y );
+
+	if( mGpuProfiler )
+		mGpuProfiler->beginPass( sPassName );
+}
+
+void DynamicResolution::end( const Area &outputArea )
+{
+	Batch2d::flush();
+	if( mGpuProfiler ) {
+		mGpuProfiler->endPass();
+		mGpuProfiler->endFrame();
+	}
+
+	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mSavedFramebuffer );
+	glViewport( mSavedViewport[0], mSavedViewport[1], mSavedViewport[2], mSavedViewport[3] );
+
+	drawUpscaled( ( outputArea.getWidth() > 0 && outputArea.getHeight() > 0 ) ? outputArea : Area( Vec2i::zero(), mOutputSize ) );
+
+	// the GPU time of the scene when timer queries are available, which lags a few frames and is 0 until the first results are read back
+	double cost = 0;
+	if( mGpuProfiler )
+		cost = mGpuProfiler->getPassSeconds( sPassName );
+	else if( app::App::get() ) {
+		const app::FrameTiming::Frame &frame = app::App::get()->getFrameTiming().getLastFrame();
+		cost = frame.mUpdateDuration + frame.mDrawDuration;
+	}
+
+	if( cost > 0 )
+		adjustScale( cost );
+}
+
+void DynamicResolution::drawUpscaled( const Area &outputArea )
+{
+	Texture &texture = mFbo.getTexture();
+	const bool rect = texture.getTarget() == GL_TEXTURE_RECTANGLE_ARB;
+
+	mUpscaleShader.bind();
+	mUpscaleShader.uniform( "texScale", rect ? Vec2f::one() : Vec2f( 1.0f / mFbo.getWidth(), 1.0f / mFbo.getHeight() ) );
+	mUpscaleShader.uniform( "renderSize", Vec2f( mBeginRenderSize ) );
+	mUpscaleShader.uniform( "sharpness", math<float>::max( mFormat.getSharpness(), 0 ) );
+	texture.bind( 0 );
+
+	glPushAttrib( GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+	glViewport( outputArea.x1, outputArea.y1, outputArea.getWidth(), outputArea.getHeight() );
+	glDisable( GL_BLEND );
+	glDisable( GL_DEPTH_TEST );
+	glDepthMask( GL_FALSE );
+	glDisable( GL_SCISSOR_TEST );
+	glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
+	glBegin( GL_QUADS );
+		glVertex2f( -1, -1 );
+		glVertex2f( 1, -1 );
+		glVertex2f( 1, 1 );
+		glVertex2f( -1, 1 );
+	glEnd();
+	glPopAttrib();
+
+	texture.unbind( 0 );
+	GlslProg::unbind();
+}
+
+void DynamicResolution::adjustScale( double cost )
+{
+	const float smoothing = constrain( mFormat.getSmoothing(), 0.001f, 1.0f );
+	mSmoothedCost = ( mSmoothedCost > 0 ) ? mSmoothedCost + smoothing * ( cost - mSmoothedCost ) : cost;
+	++mFramesSinceChange;
+	if( ! mAdjustmentEnabled || mFramesSinceChange < mFormat.getAdjustInterval() )
+		return;
+
+	float frameRate = mFormat.getTargetFrameRate();
+	if( frameRate <= 0 && app::App::get() )
+		frameRate = app::App::get()->getFrameRate();
+	if( frameRate <= 0 )
+		frameRate = 60;
+
+	const double budget = mFormat.getBudget() / frameRate;
+	const double lower = budget * ( 1 - mFormat.getHysteresis() );
+	if( mSmoothedCost <= budget && mSmoothedCost >= lower )
+		return;
+
+	// cost is assumed proportional to the pixel count, so the scale which lands in the middle of [lower, budget] is scale * sqrt( target / cost )
+	const double target = ( budget + lower ) / 2;
+	float desired = mScale * (float)math<double>::sqrt( target / mSmoothedCost );
+	const float step = mFormat.getStep();
+	if( step > 0 ) {
+		// rounding down in both directions errs on the side of staying within budget
+		desired = math<float>::floor( desired / step + 0.001f ) * step;
+		desired = ( mSmoothedCost > budget ) ? math<float>::min( desired, mScale - step ) : math<float>::max( desired, mScale + step );
+	}
+	desired = constrain( desired, mFormat.getMinScale(), mFormat.getMaxScale() );
+	if( desired == mScale )
+		return;
+
+	// predict the cost at the new scale rather than waiting for the average to converge, which would overshoot
+	mSmoothedCost *= ( desired * desired ) / ( mScale * mScale );
+	mScale = desired;
+	mFramesSinceChange = 0;
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
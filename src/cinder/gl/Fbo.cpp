@@ -22,6 +22,9 @@ Copyright (c) 2010, The Barbarian Group
 
 #include "cinder/gl/gl.h" // must be first
 #include "cinder/gl/Fbo.h"
+#include "cinder/gl/StateCache.h"
+
+#include <algorithm>
 
 using namespace std;
 
@@ -30,6 +33,86 @@ namespace gl {
 
 GLint Fbo::sMaxSamples = -1;
 GLint Fbo::sMaxAttachments = -1;
+GLuint Fbo::sScreenFramebuffer = 0;
+
+/////////////////////////////////////////////////////////////////////////////////
+// FboReadback
+// both RGBA8 and 32-bit float depth are 4 bytes per pixel
+static const size_t sReadbackPixelBytes = 4;
+
+FboReadback::FboReadback( const Area &area, GLenum dataFormat )
+	: mObj( new Obj( area, dataFormat ) )
+{
+}
+
+FboReadback::Obj::~Obj()
+{
+#if ! defined( CINDER_GLES )
+	if( mPbo ) {
+		glDeleteBuffers( 1, &mPbo );
+		StateCache::bufferDeleted( mPbo );
+	}
+#endif
+}
+
+void FboReadback::readPixels( GLenum dataFormat, GLenum type )
+{
+#if ! defined( CINDER_GLES )
+	glGenBuffers( 1, &mObj->mPbo );
+	StateCache::bindBuffer( GL_PIXEL_PACK_BUFFER, mObj->mPbo );
+	glBufferData( GL_PIXEL_PACK_BUFFER, mObj->mArea.calcArea() * sReadbackPixelBytes, 0, GL_STREAM_READ );
+
+	GLint oldPackAlignment;
+	glGetIntegerv( GL_PACK_ALIGNMENT, &oldPackAlignment );
+	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+	// with a buffer bound to GL_PIXEL_PACK_BUFFER this queues the transfer and returns without waiting for the GPU
+	glReadPixels( mObj->mArea.getX1(), mObj->mArea.getY1(), mObj->mArea.getWidth(), mObj->mArea.getHeight(), dataFormat, type, 0 );
+	glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+	StateCache::bindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+#endif
+}
+
+void FboReadback::collect( void *dst, int32_t dstRowBytes, size_t pixelBytes ) const
+{
+#if ! defined( CINDER_GLES )
+	const int32_t height = mObj->mArea.getHeight();
+	const size_t srcRowBytes = mObj->mArea.getWidth() * pixelBytes;
+
+	StateCache::bindBuffer( GL_PIXEL_PACK_BUFFER, mObj->mPbo );
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( glMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY ) );
+	if( src ) {
+		// OpenGL returns the bottom row first
+		for( int32_t y = 0; y < height; ++y )
+			memcpy( reinterpret_cast<uint8_t*>( dst ) + ( height - 1 - y ) * dstRowBytes, src + y * srcRowBytes, srcRowBytes );
+		glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+	}
+	StateCache::bindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+	glDeleteBuffers( 1, &mObj->mPbo );
+	StateCache::bufferDeleted( mObj->mPbo );
+	mObj->mPbo = 0;
+#endif
+}
+
+Surface8u FboReadback::getSurface() const
+{
+	if( ( ! mObj->mSurface ) && ( mObj->mDataFormat == GL_RGBA ) ) {
+		mObj->mSurface = Surface8u( mObj->mArea.getWidth(), mObj->mArea.getHeight(), true, SurfaceChannelOrder::RGBA );
+		collect( mObj->mSurface.getData(), mObj->mSurface.getRowBytes(), sReadbackPixelBytes );
+	}
+
+	return mObj->mSurface;
+}
+
+Channel32f FboReadback::getChannel() const
+{
+	if( ( ! mObj->mChannel ) && ( mObj->mDataFormat == GL_DEPTH_COMPONENT ) ) {
+		mObj->mChannel = Channel32f( mObj->mArea.getWidth(), mObj->mArea.getHeight() );
+		collect( mObj->mChannel.getData(), mObj->mChannel.getRowBytes(), sReadbackPixelBytes );
+	}
+
+	return mObj->mChannel;
+}
 
 // Convenience macro to append either OES or EXT appropriately to a symbol based on OGLES vs. OGL
 #if defined( CINDER_GLES )
@@ -41,6 +124,7 @@ GLint Fbo::sMaxAttachments = -1;
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // RenderBuffer::Obj
 Renderbuffer::Obj::Obj()
+	: mAllocation( "gl::Renderbuffer", true )
 {
 	mWidth = mHeight = -1;
 	mId = 0;
@@ -49,7 +133,7 @@ Renderbuffer::Obj::Obj()
 }
 
 Renderbuffer::Obj::Obj( int aWidth, int aHeight, GLenum internalFormat, int msaaSamples, int coverageSamples )
-	: mWidth( aWidth ), mHeight( aHeight ), mInternalFormat( internalFormat ), mSamples( msaaSamples ), mCoverageSamples( coverageSamples )
+	: mWidth( aWidth ), mHeight( aHeight ), mInternalFormat( internalFormat ), mSamples( msaaSamples ), mCoverageSamples( coverageSamples ), mAllocation( "gl::Renderbuffer", true )
 {
 #if defined( CINDER_MSW )
 	static bool csaaSupported = ( GLEE_NV_framebuffer_multisample_coverage != 0 );
@@ -78,6 +162,8 @@ Renderbuffer::Obj::Obj( int aWidth, int aHeight, GLenum internalFormat, int msaa
 	else
 #endif
 		GL_SUFFIX(glRenderbufferStorage)( GL_SUFFIX(GL_RENDERBUFFER_), mInternalFormat, mWidth, mHeight );
+
+	mAllocation.set( (int64_t)mWidth * mHeight * std::max( mSamples, 1 ) * Texture::getInternalFormatBitsPerTexel( mInternalFormat ) / 8 );
 }
 
 Renderbuffer::Obj::~Obj()
@@ -115,10 +201,14 @@ Fbo::Obj::Obj( int width, int height )
 
 Fbo::Obj::~Obj()
 {
-	if( mId )
+	if( mId ) {
 		GL_SUFFIX(glDeleteFramebuffers)( 1, &mId );
-	if( mResolveFramebufferId )
+		StateCache::framebufferDeleted( mId );
+	}
+	if( mResolveFramebufferId ) {
 		GL_SUFFIX(glDeleteFramebuffers)( 1, &mResolveFramebufferId );
+		StateCache::framebufferDeleted( mResolveFramebufferId );
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -166,6 +256,15 @@ void Fbo::Format::enableDepthBuffer( bool depthBuffer, bool asTexture )
 #endif
 }
 
+bool Fbo::Format::operator==( const Format &rhs ) const
+{
+	return mTarget == rhs.mTarget && mColorInternalFormat == rhs.mColorInternalFormat && mDepthInternalFormat == rhs.mDepthInternalFormat
+		&& mSamples == rhs.mSamples && mCoverageSamples == rhs.mCoverageSamples && mMipmapping == rhs.mMipmapping
+		&& mDepthBuffer == rhs.mDepthBuffer && mDepthBufferAsTexture == rhs.mDepthBufferAsTexture && mStencilBuffer == rhs.mStencilBuffer
+		&& mNumColorBuffers == rhs.mNumColorBuffers && mWrapS == rhs.mWrapS && mWrapT == rhs.mWrapT
+		&& mMinFilter == rhs.mMinFilter && mMagFilter == rhs.mMagFilter;
+}
+
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Fbo
@@ -174,6 +273,8 @@ void Fbo::Format::enableDepthBuffer( bool depthBuffer, bool asTexture )
 void Fbo::init()
 {
 	gl::SaveFramebufferBinding bindingSaver;
+	// attachments are counted as the Fbo's rather than as Textures and Renderbuffers
+	ScopedMemoryCategory memoryCategory( "gl::Fbo" );
 	
 #if defined( CINDER_MSW )
 	static bool csaaSupported = ( GLEE_NV_framebuffer_multisample_coverage != 0 );
@@ -187,7 +288,7 @@ void Fbo::init()
 
 	// allocate the framebuffer itself
 	GL_SUFFIX(glGenFramebuffers)( 1, &mObj->mId );
-	GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );	
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );	
 
 	Texture::Format textureFormat;
 	textureFormat.setTarget( getTarget() );
@@ -227,7 +328,7 @@ void Fbo::init()
 	#if ! defined( CINDER_GLES )			
 				GLuint depthTextureId;
 				glGenTextures( 1, &depthTextureId );
-				glBindTexture( getTarget(), depthTextureId );
+				StateCache::bindTexture( getTarget(), depthTextureId );
 				glTexImage2D( getTarget(), 0, getFormat().getDepthInternalFormat(), mObj->mWidth, mObj->mHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL );
 				glTexParameteri( getTarget(), GL_TEXTURE_MIN_FILTER, mObj->mFormat.mMinFilter );
 				glTexParameteri( getTarget(), GL_TEXTURE_MAG_FILTER, mObj->mFormat.mMagFilter );
@@ -264,7 +365,7 @@ bool Fbo::initMultisample( bool csaa )
 	return false;
 #else
 	glGenFramebuffersEXT( 1, &mObj->mResolveFramebufferId );
-	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId ); 
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId ); 
 	
 	// bind all of the color buffers to the resolve FB's attachment points
 	vector<GLenum> drawBuffers;
@@ -281,7 +382,7 @@ bool Fbo::initMultisample( bool csaa )
 	if( ! checkStatus( &ignoredException ) )
 		return false;
 
-	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mObj->mId );
 
 	if( mObj->mFormat.mSamples > getMaxSamples() ) {
 		mObj->mFormat.mSamples = getMaxSamples();
@@ -346,6 +447,7 @@ Texture& Fbo::getDepthTexture()
 
 void Fbo::bindTexture( int textureUnit, int attachment )
 {
+	Batch2d::flush();
 	resolveTextures();
 	mObj->mColorTextures[attachment].bind( textureUnit );
 	updateMipmaps( false, attachment );
@@ -353,7 +455,8 @@ void Fbo::bindTexture( int textureUnit, int attachment )
 
 void Fbo::unbindTexture()
 {
-	glBindTexture( getTarget(), 0 );
+	Batch2d::flush();
+	StateCache::bindTexture( getTarget(), 0 );
 }
 
 void Fbo::bindDepthTexture( int textureUnit )
@@ -371,8 +474,8 @@ void Fbo::resolveTextures() const
 	if ( mObj->mResolveFramebufferId ) {
 		SaveFramebufferBinding saveFboBinding;
 
-		glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
-		glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId );
+		StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
+		StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId );
 		
 		for( size_t c = 0; c < mObj->mColorTextures.size(); ++c ) {
 			glDrawBuffer( GL_COLOR_ATTACHMENT0_EXT + (GLenum)c );
@@ -387,7 +490,7 @@ void Fbo::resolveTextures() const
 		vector<GLenum> drawBuffers;
 		for( size_t c = 0; c < mObj->mColorTextures.size(); ++c )
 			drawBuffers.push_back( GL_COLOR_ATTACHMENT0_EXT + (GLenum)c );
-		glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mObj->mId );
+		StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mObj->mId );
 		glDrawBuffers( (GLsizei)drawBuffers.size(), &drawBuffers[0] );
 	}
 #endif
@@ -414,7 +517,8 @@ void Fbo::updateMipmaps( bool bindFirst, int attachment ) const
 
 void Fbo::bindFramebuffer()
 {
-	GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
+	Batch2d::flush();
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
 	if( mObj->mResolveFramebufferId ) {
 		mObj->mNeedsResolve = true;
 	}
@@ -425,7 +529,8 @@ void Fbo::bindFramebuffer()
 
 void Fbo::unbindFramebuffer()
 {
-	GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), 0 );
+	Batch2d::flush();
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), sScreenFramebuffer );
 }
 
 bool Fbo::checkStatus( FboExceptionInvalidSpecification *resultExc )
@@ -501,8 +606,8 @@ void Fbo::blitTo( Fbo dst, const Area &srcArea, const Area &dstArea, GLenum filt
 {
 	SaveFramebufferBinding saveFboBinding;
 
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
-	glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, dst.getId() );		
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, dst.getId() );		
 	glBlitFramebufferEXT( srcArea.getX1(), srcArea.getY1(), srcArea.getX2(), srcArea.getY2(), dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), mask, filter );
 }
 
@@ -510,8 +615,8 @@ void Fbo::blitToScreen( const Area &srcArea, const Area &dstArea, GLenum filter,
 {
 	SaveFramebufferBinding saveFboBinding;
 
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
-	glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, 0 );		
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, sScreenFramebuffer );
 	glBlitFramebufferEXT( srcArea.getX1(), srcArea.getY1(), srcArea.getX2(), srcArea.getY2(), dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), mask, filter );
 }
 
@@ -519,10 +624,35 @@ void Fbo::blitFromScreen( const Area &srcArea, const Area &dstArea, GLenum filte
 {
 	SaveFramebufferBinding saveFboBinding;
 
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, GL_NONE );
-	glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, mObj->mId );		
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, sScreenFramebuffer );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mObj->mId );		
 	glBlitFramebufferEXT( srcArea.getX1(), srcArea.getY1(), srcArea.getX2(), srcArea.getY2(), dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), mask, filter );
 }
+
+FboReadback Fbo::readPixelsAsync( const Area &area, int attachment ) const
+{
+	resolveTextures();
+
+	SaveFramebufferBinding saveFboBinding;
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, getResolveId() );
+	glReadBuffer( GL_COLOR_ATTACHMENT0_EXT + attachment );
+
+	FboReadback result( area, GL_RGBA );
+	result.readPixels( GL_RGBA, GL_UNSIGNED_BYTE );
+	return result;
+}
+
+FboReadback Fbo::readDepthAsync( const Area &area ) const
+{
+	resolveTextures();
+
+	SaveFramebufferBinding saveFboBinding;
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, getResolveId() );
+
+	FboReadback result( area, GL_DEPTH_COMPONENT );
+	result.readPixels( GL_DEPTH_COMPONENT, GL_FLOAT );
+	return result;
+}
 #endif
 
 FboExceptionInvalidSpecification::FboExceptionInvalidSpecification( const string &message ) throw()
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/FboPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+Fbo FboPool::acquire( int width, int height, const Fbo::Format &format )
+{
+	for( vector<Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+		if( entryIt->mInUse || entryIt->mFbo.getWidth() != width || entryIt->mFbo.getHeight() != height || entryIt->mFbo.getFormat() != format )
+			continue;
+		entryIt->mInUse = true;
+		entryIt->mLastUsedFrame = mFrame;
+		mPeakInUse = std::max( mPeakInUse, getNumInUse() );
+		return entryIt->mFbo;
+	}
+
+	Entry entry;
+	entry.mFbo = Fbo( width, height, format );
+	entry.mLastUsedFrame = mFrame;
+	entry.mInUse = true;
+	mEntries.push_back( entry );
+	mPeakInUse = std::max( mPeakInUse, getNumInUse() );
+	return entry.mFbo;
+}
+
+void FboPool::release( const Fbo &fbo )
+{
+	if( ! fbo )
+		return;
+
+	for( vector<Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+		if( entryIt->mFbo.getId() == fbo.getId() ) {
+			entryIt->mInUse = false;
+			return;
+		}
+	}
+}
+
+void FboPool::endFrame()
+{
+	++mFrame;
+
+	vector<Entry>::iterator keepEnd = mEntries.begin();
+	for( vector<Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+		entryIt->mInUse = false;
+		if( mFrame - entryIt->mLastUsedFrame <= mMaxIdleFrames ) {
+			if( keepEnd != entryIt )
+				*keepEnd = *entryIt;
+			++keepEnd;
+		}
+	}
+	mEntries.erase( keepEnd, mEntries.end() );
+}
+
+size_t FboPool::getNumInUse() const
+{
+	size_t result = 0;
+	for( vector<Entry>::const_iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt )
+		if( entryIt->mInUse )
+			++result;
+
+	return result;
+}
+
+} } // namespace cinder::gl
@@ -3672,7 +3672,7 @@ int __GLeeGLNumExtensions=322;
 #ifdef __GLEE_GL_ARB_map_buffer_range
 #ifndef GLEE_C_DEFINED_glMapBufferRange
 #define GLEE_C_DEFINED_glMapBufferRange
-  void __stdcall GLee_Lazy_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)  {if (GLeeInit()) glMapBufferRange(target, offset, length, access);}
+  GLvoid* __stdcall GLee_Lazy_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)  {if (GLeeInit()) return glMapBufferRange(target, offset, length, access); return (GLvoid*)0;}
   GLEEPFNGLMAPBUFFERRANGEPROC GLeeFuncPtr_glMapBufferRange=GLee_Lazy_glMapBufferRange;
 #endif
 #ifndef GLEE_C_DEFINED_glFlushMappedBufferRange
@@ -22,6 +22,11 @@
 
 #include "cinder/gl/gl.h"
 #include "cinder/gl/GlslProg.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/Utilities.h"
+
+#include <functional>
+#include <vector>
 
 using namespace std;
 
@@ -29,39 +34,215 @@ namespace cinder { namespace gl {
 
 GlslProg::Obj::~Obj()
 {
-	if( mHandle )
+	if( mHandle ) {
 		glDeleteProgram( (GLuint)mHandle );
+		StateCache::programDeleted( mHandle );
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Program binary cache
+namespace {
+
+#if defined( CINDER_MSW )
+// GLee predates ARB_get_program_binary, so its entry points are resolved here
+#define CI_GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#define CI_GL_PROGRAM_BINARY_LENGTH				0x8741
+#define CI_GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+
+typedef void (APIENTRY *GetProgramBinaryFn)( GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary );
+typedef void (APIENTRY *ProgramBinaryFn)( GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length );
+typedef void (APIENTRY *ProgramParameteriFn)( GLuint program, GLenum pname, GLint value );
+
+GetProgramBinaryFn		sGetProgramBinary = NULL;
+ProgramBinaryFn			sProgramBinary = NULL;
+ProgramParameteriFn		sProgramParameteri = NULL;
+
+// ARB_uniform_buffer_object is likewise missing from GLee
+#define CI_GL_INVALID_INDEX						0xFFFFFFFFu
+
+typedef GLuint (APIENTRY *GetUniformBlockIndexFn)( GLuint program, const GLchar *uniformBlockName );
+typedef void (APIENTRY *UniformBlockBindingFn)( GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding );
+
+GetUniformBlockIndexFn	sGetUniformBlockIndex = NULL;
+UniformBlockBindingFn	sUniformBlockBinding = NULL;
+#endif
+
+fs::path				sBinaryCacheDirectory;
+const uint32_t			BINARY_CACHE_MAGIC = 0x42475343; // "CSGB"
+
+bool binaryCacheEnabled()
+{
+	return ( ! sBinaryCacheDirectory.empty() ) && GlslProg::isBinaryCacheSupported();
+}
+
+void removeCacheEntry( const fs::path &path )
+{
+	try {
+		fs::remove( path );
+	}
+	catch( fs::filesystem_error & ) {
+	}
+}
+
+} // anonymous namespace
+
+void GlslProg::setBinaryCacheDirectory( const fs::path &directory )
+{
+	sBinaryCacheDirectory = directory;
+}
+
+const fs::path& GlslProg::getBinaryCacheDirectory()
+{
+	return sBinaryCacheDirectory;
+}
+
+bool GlslProg::isBinaryCacheSupported()
+{
+#if defined( CINDER_MSW )
+	static bool sResolved = false, sSupported = false;
+	if( ! sResolved ) {
+		sResolved = true;
+		if( isExtensionAvailable( "GL_ARB_get_program_binary" ) ) {
+			sGetProgramBinary = reinterpret_cast<GetProgramBinaryFn>( ::wglGetProcAddress( "glGetProgramBinary" ) );
+			sProgramBinary = reinterpret_cast<ProgramBinaryFn>( ::wglGetProcAddress( "glProgramBinary" ) );
+			sProgramParameteri = reinterpret_cast<ProgramParameteriFn>( ::wglGetProcAddress( "glProgramParameteri" ) );
+			// some drivers expose the extension yet offer no formats to save in
+			GLint numFormats = 0;
+			glGetIntegerv( CI_GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats );
+			sSupported = sGetProgramBinary && sProgramBinary && sProgramParameteri && ( numFormats > 0 );
+		}
+	}
+	return sSupported;
+#else
+	return false;
+#endif
+}
+
+fs::path GlslProg::getBinaryCachePath( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices ) const
+{
+	// the key covers everything that invalidates a binary: the sources, the geometry parameters and the driver
+	stringstream key;
+	key << (const char*)glGetString( GL_VENDOR ) << "|" << (const char*)glGetString( GL_RENDERER ) << "|" << (const char*)glGetString( GL_VERSION );
+	key << "|vs|" << ( vertexShader ? vertexShader : "" );
+	key << "|fs|" << ( fragmentShader ? fragmentShader : "" );
+	if( geometryShader )
+		key << "|gs|" << geometryShader << "|" << geometryInputType << "|" << geometryOutputType << "|" << geometryOutputVertices;
+
+	stringstream fileName;
+	fileName << hex << std::hash<string>()( key.str() ) << ".glslbin";
+	return sBinaryCacheDirectory / fileName.str();
+}
+
+bool GlslProg::loadBinary( const fs::path &path )
+{
+#if defined( CINDER_MSW )
+	ifstream file( path.string().c_str(), ios::binary );
+	if( ! file )
+		return false;
+
+	uint32_t magic = 0, format = 0;
+	file.read( reinterpret_cast<char*>( &magic ), sizeof( magic ) );
+	file.read( reinterpret_cast<char*>( &format ), sizeof( format ) );
+	bool valid = file && ( magic == BINARY_CACHE_MAGIC );
+	vector<char> binary;
+	if( valid )
+		binary.assign( istreambuf_iterator<char>( file ), istreambuf_iterator<char>() );
+	file.close();
+
+	if( binary.empty() ) {
+		removeCacheEntry( path );
+		return false;
+	}
+
+	sProgramBinary( mObj->mHandle, (GLenum)format, &binary[0], (GLsizei)binary.size() );
+	GLint status = GL_FALSE;
+	glGetProgramiv( mObj->mHandle, GL_LINK_STATUS, &status );
+	if( status != GL_TRUE ) {
+		// rejected, typically after a driver update; recompile and replace it
+		removeCacheEntry( path );
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GlslProg::saveBinary( const fs::path &path ) const
+{
+#if defined( CINDER_MSW )
+	GLint status = GL_FALSE, length = 0;
+	glGetProgramiv( mObj->mHandle, GL_LINK_STATUS, &status );
+	glGetProgramiv( mObj->mHandle, CI_GL_PROGRAM_BINARY_LENGTH, &length );
+	if( status != GL_TRUE || length <= 0 )
+		return;
+
+	vector<char> binary( length );
+	GLenum format = 0;
+	sGetProgramBinary( mObj->mHandle, length, &length, &format, &binary[0] );
+
+	try {
+		if( ! fs::exists( sBinaryCacheDirectory ) )
+			fs::create_directories( sBinaryCacheDirectory );
+
+		// write to a temporary file first so a concurrent or interrupted run never sees a partial entry
+		fs::path tempPath = path;
+		tempPath.replace_extension( ".tmp" );
+		{
+			ofstream file( tempPath.string().c_str(), ios::binary | ios::trunc );
+			uint32_t magic = BINARY_CACHE_MAGIC, format32 = format;
+			file.write( reinterpret_cast<const char*>( &magic ), sizeof( magic ) );
+			file.write( reinterpret_cast<const char*>( &format32 ), sizeof( format32 ) );
+			file.write( &binary[0], length );
+			if( ! file )
+				return;
+		}
+		if( fs::exists( path ) )
+			fs::remove( path );
+		fs::rename( tempPath, path );
+	}
+	catch( fs::filesystem_error & ) {
+		// the cache is only an optimization; a read-only or missing directory just means recompiling next time
+	}
+#endif
 }
 
 //////////////////////////////////////////////////////////////////////////
 // GlslProg
-    GlslProg::GlslProg( DataSourceRef vertexShader, DataSourceRef fragmentShader, DataSourceRef geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices)
+GlslProg::GlslProg( DataSourceRef vertexShader, DataSourceRef fragmentShader, DataSourceRef geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices)
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
-	mObj->mHandle = glCreateProgram();
-	
-	if ( vertexShader )
-		loadShader( vertexShader->getBuffer(), GL_VERTEX_SHADER_ARB );
-    
+	// the sources are needed as null-terminated strings both to key the binary cache and to compile
+	string vertexSource, fragmentSource, geometrySource;
+	if( vertexShader )
+		vertexSource = loadString( vertexShader );
 	if( fragmentShader )
-		loadShader( fragmentShader->getBuffer(), GL_FRAGMENT_SHADER_ARB );
-    
-	if( geometryShader ) {
-		loadShader( geometryShader->getBuffer(), GL_GEOMETRY_SHADER_EXT );
-        
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_INPUT_TYPE_EXT, geometryInputType);
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_OUTPUT_TYPE_EXT, geometryOutputType);
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_VERTICES_OUT_EXT, geometryOutputVertices);
-    }
-    
-	link();
+		fragmentSource = loadString( fragmentShader );
+	if( geometryShader )
+		geometrySource = loadString( geometryShader );
+
+	init( vertexShader ? vertexSource.c_str() : 0, fragmentShader ? fragmentSource.c_str() : 0, geometryShader ? geometrySource.c_str() : 0,
+		geometryInputType, geometryOutputType, geometryOutputVertices );
 }
 
 GlslProg::GlslProg( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices)
 	: mObj( shared_ptr<Obj>( new Obj ) )
+{
+	init( vertexShader, fragmentShader, geometryShader, geometryInputType, geometryOutputType, geometryOutputVertices );
+}
+
+void GlslProg::init( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices )
 {
 	mObj->mHandle = glCreateProgram();
-	
+
+	fs::path cachePath;
+	if( binaryCacheEnabled() ) {
+		cachePath = getBinaryCachePath( vertexShader, fragmentShader, geometryShader, geometryInputType, geometryOutputType, geometryOutputVertices );
+		if( loadBinary( cachePath ) )
+			return;
+	}
+
 	if ( vertexShader )
 		loadShader( vertexShader, GL_VERTEX_SHADER_ARB );
     
@@ -75,8 +256,16 @@ GlslProg::GlslProg( const char *vertexShader, const char *fragmentShader, const
         glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_OUTPUT_TYPE_EXT, geometryOutputType);
         glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_VERTICES_OUT_EXT, geometryOutputVertices);
     }
+
+#if defined( CINDER_MSW )
+	if( ! cachePath.empty() )
+		sProgramParameteri( mObj->mHandle, CI_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+#endif
     
 	link();
+
+	if( ! cachePath.empty() )
+		saveBinary( cachePath );
 }
 
 void GlslProg::loadShader( Buffer shaderSourceBuffer, GLint shaderType )
@@ -111,12 +300,14 @@ void GlslProg::link()
 
 void GlslProg::bind() const
 {
-	glUseProgram( mObj->mHandle );
+	Batch2d::flush();
+	StateCache::useProgram( mObj->mHandle );
 }
 
 void GlslProg::unbind()
 {
-	glUseProgram( 0 );
+	Batch2d::flush();
+	StateCache::useProgram( 0 );
 }
 
 std::string GlslProg::getShaderLog( GLuint handle ) const
@@ -139,134 +330,320 @@ std::string GlslProg::getShaderLog( GLuint handle ) const
 
 void GlslProg::uniform( const std::string &name, int data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1i( loc, data );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2i &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2i( loc, data.x, data.y );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const int *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1iv( loc, count, data );
+	uniform( getUniformHandle( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2i *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2iv( loc, count, &data[0].x );
+	uniform( getUniformHandle( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, float data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1f( loc, data );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2f &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2f( loc, data.x, data.y );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec3f &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform3f( loc, data.x, data.y, data.z );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec4f &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform4f( loc, data.x, data.y, data.z, data.w );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Color &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform3f( loc, data.r, data.g, data.b );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const ColorA &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform4f( loc, data.r, data.g, data.b, data.a );
+	uniform( getUniformHandle( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const float *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1fv( loc, count, data );
+	uniform( getUniformHandle( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2f *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2fv( loc, count, &data[0].x );
+	uniform( getUniformHandle( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec3f *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform3fv( loc, count, &data[0].x );
+	uniform( getUniformHandle( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec4f *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform4fv( loc, count, &data[0].x );
+	uniform( getUniformHandle( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix22f &data, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix2fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( getUniformHandle( name ), data, transpose );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix33f &data, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix3fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( getUniformHandle( name ), data, transpose );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix44f &data, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix4fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( getUniformHandle( name ), data, transpose );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix22f *data, int count, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix2fv( loc, count, ( transpose ) ? GL_TRUE : GL_FALSE, data->m );
+	uniform( getUniformHandle( name ), data, count, transpose );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix33f *data, int count, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix3fv( loc, count, ( transpose ) ? GL_TRUE : GL_FALSE, data->m );
+	uniform( getUniformHandle( name ), data, count, transpose );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix44f *data, int count, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix4fv( loc, count, ( transpose ) ? GL_TRUE : GL_FALSE, data->m );
+	uniform( getUniformHandle( name ), data, count, transpose );
 }
 
-GLint GlslProg::getUniformLocation( const std::string &name )
+void GlslProg::uniform( const Uniform &handle, int data )
 {
-	map<string,int>::const_iterator uniformIt = mObj->mUniformLocs.find( name );
-	if( uniformIt == mObj->mUniformLocs.end() ) {
-		GLint loc = glGetUniformLocation( mObj->mHandle, name.c_str() );
-		mObj->mUniformLocs[name] = loc;
-		return loc;
-	}
-	else
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform1i( handle.mLocation, data );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec2i &data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform2i( handle.mLocation, data.x, data.y );
+}
+
+void GlslProg::uniform( const Uniform &handle, const int *data, int count )
+{
+	if( updateUniformValue( handle, data, sizeof( int ) * count ) )
+		glUniform1iv( handle.mLocation, count, data );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec2i *data, int count )
+{
+	if( updateUniformValue( handle, data, sizeof( Vec2i ) * count ) )
+		glUniform2iv( handle.mLocation, count, &data[0].x );
+}
+
+void GlslProg::uniform( const Uniform &handle, float data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform1f( handle.mLocation, data );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec2f &data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform2f( handle.mLocation, data.x, data.y );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec3f &data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform3f( handle.mLocation, data.x, data.y, data.z );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec4f &data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform4f( handle.mLocation, data.x, data.y, data.z, data.w );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Color &data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform3f( handle.mLocation, data.r, data.g, data.b );
+}
+
+void GlslProg::uniform( const Uniform &handle, const ColorA &data )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ) ) )
+		glUniform4f( handle.mLocation, data.r, data.g, data.b, data.a );
+}
+
+void GlslProg::uniform( const Uniform &handle, const float *data, int count )
+{
+	if( updateUniformValue( handle, data, sizeof( float ) * count ) )
+		glUniform1fv( handle.mLocation, count, data );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec2f *data, int count )
+{
+	if( updateUniformValue( handle, data, sizeof( Vec2f ) * count ) )
+		glUniform2fv( handle.mLocation, count, &data[0].x );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec3f *data, int count )
+{
+	if( updateUniformValue( handle, data, sizeof( Vec3f ) * count ) )
+		glUniform3fv( handle.mLocation, count, &data[0].x );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Vec4f *data, int count )
+{
+	if( updateUniformValue( handle, data, sizeof( Vec4f ) * count ) )
+		glUniform4fv( handle.mLocation, count, &data[0].x );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Matrix22f &data, bool transpose )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ), transpose ? 1 : 0 ) )
+		glUniformMatrix2fv( handle.mLocation, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Matrix33f &data, bool transpose )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ), transpose ? 1 : 0 ) )
+		glUniformMatrix3fv( handle.mLocation, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Matrix44f &data, bool transpose )
+{
+	if( updateUniformValue( handle, &data, sizeof( data ), transpose ? 1 : 0 ) )
+		glUniformMatrix4fv( handle.mLocation, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Matrix22f *data, int count, bool transpose )
+{
+	if( updateUniformValue( handle, data, sizeof( Matrix22f ) * count, transpose ? 1 : 0 ) )
+		glUniformMatrix2fv( handle.mLocation, count, ( transpose ) ? GL_TRUE : GL_FALSE, data->m );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Matrix33f *data, int count, bool transpose )
+{
+	if( updateUniformValue( handle, data, sizeof( Matrix33f ) * count, transpose ? 1 : 0 ) )
+		glUniformMatrix3fv( handle.mLocation, count, ( transpose ) ? GL_TRUE : GL_FALSE, data->m );
+}
+
+void GlslProg::uniform( const Uniform &handle, const Matrix44f *data, int count, bool transpose )
+{
+	if( updateUniformValue( handle, data, sizeof( Matrix44f ) * count, transpose ? 1 : 0 ) )
+		glUniformMatrix4fv( handle.mLocation, count, ( transpose ) ? GL_TRUE : GL_FALSE, data->m );
+}
+
+void GlslProg::invalidateUniforms()
+{
+	for( size_t v = 0; v < mObj->mUniformValues.size(); ++v )
+		mObj->mUniformValues[v].clear();
+}
+
+bool GlslProg::updateUniformValue( const Uniform &handle, const void *data, size_t size, uint8_t tag )
+{
+	if( handle.mLocation < 0 )
+		return false;
+
+	vector<uint8_t> &value = mObj->mUniformValues[handle.mSlot];
+	if( value.size() == size + 1 && value[0] == tag && memcmp( &value[1], data, size ) == 0 )
+		return false;
+
+	// batched draws still pending were issued with the previous value
+	Batch2d::flush();
+	value.resize( size + 1 );
+	value[0] = tag;
+	memcpy( &value[1], data, size );
+	return true;
+}
+
+GlslProg::Uniform GlslProg::getUniformHandle( const std::string &name )
+{
+	map<string,Uniform>::const_iterator uniformIt = mObj->mUniforms.find( name );
+	if( uniformIt != mObj->mUniforms.end() )
 		return uniformIt->second;
+
+	// names which alias one location, such as "lights" and "lights[0]", share a slot so their recorded values stay consistent
+	GLint loc = glGetUniformLocation( mObj->mHandle, name.c_str() );
+	size_t slot = 0;
+	if( loc >= 0 ) {
+		map<GLint,size_t>::const_iterator slotIt = mObj->mUniformSlots.find( loc );
+		if( slotIt == mObj->mUniformSlots.end() ) {
+			slot = mObj->mUniformValues.size();
+			mObj->mUniformValues.push_back( vector<uint8_t>() );
+			mObj->mUniformSlots[loc] = slot;
+		}
+		else
+			slot = slotIt->second;
+	}
+
+	Uniform handle( loc, slot );
+	mObj->mUniforms[name] = handle;
+	return handle;
+}
+
+bool GlslProg::isUniformBlockSupported()
+{
+#if defined( CINDER_MSW )
+	static bool sResolved = false, sSupported = false;
+	if( ! sResolved ) {
+		sResolved = true;
+		if( isExtensionAvailable( "GL_ARB_uniform_buffer_object" ) ) {
+			sGetUniformBlockIndex = reinterpret_cast<GetUniformBlockIndexFn>( ::wglGetProcAddress( "glGetUniformBlockIndex" ) );
+			sUniformBlockBinding = reinterpret_cast<UniformBlockBindingFn>( ::wglGetProcAddress( "glUniformBlockBinding" ) );
+			sSupported = sGetUniformBlockIndex && sUniformBlockBinding && glBindBufferBase;
+		}
+	}
+	return sSupported;
+#else
+	return false;
+#endif
+}
+
+bool GlslProg::uniformBlock( const std::string &blockName, GLuint bindingPoint )
+{
+#if defined( CINDER_MSW )
+	if( ! isUniformBlockSupported() )
+		return false;
+
+	GLuint blockIndex = sGetUniformBlockIndex( mObj->mHandle, blockName.c_str() );
+	if( blockIndex == CI_GL_INVALID_INDEX )
+		return false;
+
+	sUniformBlockBinding( mObj->mHandle, blockIndex, bindingPoint );
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GlslProg::bindUniformBuffer( GLuint bindingPoint, const Vbo &buffer )
+{
+#if defined( CINDER_MSW )
+	if( isUniformBlockSupported() ) {
+		Batch2d::flush();
+		glBindBufferBase( GL_UNIFORM_BUFFER, bindingPoint, buffer.getId() );
+	}
+#endif
+}
+
+GLint GlslProg::getUniformLocation( const std::string &name )
+{
+	return getUniformHandle( name ).getLocation();
 }
 
 GLint GlslProg::getAttribLocation( const std::string &name )
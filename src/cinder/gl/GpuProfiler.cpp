@@ -0,0 +1,146 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/GpuProfiler.h"
+#include "cinder/Profiler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+GpuProfiler::GpuProfiler( size_t numBufferedFrames )
+	: mFrames( max<size_t>( numBufferedFrames, 2 ) ), mFrameIndex( 0 ), mSupported( isSupported() ), mPassDepth( 0 ),
+	mTrackId( Profiler::get()->getTrack( "GPU" ) ), mNumDroppedFrames( 0 )
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	if( ! mSupported )
+		return;
+
+	for( vector<Frame>::iterator frameIt = mFrames.begin(); frameIt != mFrames.end(); ++frameIt ) {
+		for( vector<PendingPass>::iterator passIt = frameIt->mPasses.begin(); passIt != frameIt->mPasses.end(); ++passIt )
+			glDeleteQueries( 1, &passIt->mQuery );
+	}
+}
+
+bool GpuProfiler::isSupported()
+{
+#if defined( CINDER_GLES )
+	return false;
+#else
+	return isExtensionAvailable( "GL_EXT_timer_query" );
+#endif
+}
+
+void GpuProfiler::beginPass( const char *name )
+{
+	if( mPassDepth++ > 0 || ! mSupported )
+		return;
+
+#if ! defined( CINDER_GLES )
+	Frame &frame = mFrames[mFrameIndex];
+	if( frame.mNumPasses == frame.mPasses.size() ) {
+		PendingPass pass;
+		glGenQueries( 1, &pass.mQuery );
+		frame.mPasses.push_back( pass );
+	}
+
+	PendingPass &pass = frame.mPasses[frame.mNumPasses++];
+	pass.mName = name;
+	pass.mSubmitSeconds = Profiler::get()->getSeconds();
+	glBeginQuery( GL_TIME_ELAPSED_EXT, pass.mQuery );
+#endif
+}
+
+void GpuProfiler::endPass()
+{
+	if( mPassDepth == 0 || --mPassDepth > 0 || ! mSupported )
+		return;
+
+#if ! defined( CINDER_GLES )
+	glEndQuery( GL_TIME_ELAPSED_EXT );
+#endif
+}
+
+void GpuProfiler::endFrame()
+{
+	mFrameIndex = ( mFrameIndex + 1 ) % mFrames.size();
+
+	// the frame that is about to be reused was issued getNumBufferedFrames() - 1 frames ago
+	Frame &frame = mFrames[mFrameIndex];
+	if( frame.mNumPasses > 0 )
+		readBack( &frame );
+
+	frame.mNumPasses = 0;
+}
+
+void GpuProfiler::readBack( Frame *frame )
+{
+#if ! defined( CINDER_GLES )
+	// queries complete in order, so if the last one is available the others are as well
+	GLint available = 0;
+	glGetQueryObjectiv( frame->mPasses[frame->mNumPasses - 1].mQuery, GL_QUERY_RESULT_AVAILABLE, &available );
+	if( ! available ) {
+		++mNumDroppedFrames;
+		return;
+	}
+
+	Profiler *profiler = Profiler::get();
+	mLastFrame.resize( frame->mNumPasses );
+	for( size_t i = 0; i < frame->mNumPasses; ++i ) {
+		const PendingPass &pending = frame->mPasses[i];
+		GLuint64EXT nanoseconds = 0;
+		glGetQueryObjectui64vEXT( pending.mQuery, GL_QUERY_RESULT, &nanoseconds );
+
+		Pass &pass = mLastFrame[i];
+		pass.mName = pending.mName;
+		pass.mSeconds = (double)nanoseconds * 1e-9;
+		profiler->recordTrackZone( mTrackId, pending.mName, "gpu", pending.mSubmitSeconds, pending.mSubmitSeconds + pass.mSeconds );
+	}
+#endif
+}
+
+double GpuProfiler::getPassSeconds( const std::string &name ) const
+{
+	for( vector<Pass>::const_iterator passIt = mLastFrame.begin(); passIt != mLastFrame.end(); ++passIt ) {
+		if( passIt->mName == name )
+			return passIt->mSeconds;
+	}
+
+	return 0;
+}
+
+double GpuProfiler::getLastFrameSeconds() const
+{
+	double result = 0;
+	for( vector<Pass>::const_iterator passIt = mLastFrame.begin(); passIt != mLastFrame.end(); ++passIt )
+		result += passIt->mSeconds;
+
+	return result;
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,581 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/ImageProcessing.h"
+
+#if ! defined( CINDER_GLES )
+
+#include "cinder/gl/FboPool.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/CinderMath.h"
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+namespace cinder { namespace gl { namespace ip {
+
+namespace {
+
+enum Op { OP_COPY, OP_RESIZE, OP_BLEND, OP_THRESHOLD, OP_SOBEL, OP_BLUR, OP_GRAYSCALE, OP_PREMULTIPLY, OP_UNPREMULTIPLY, OP_JFA_SEED, OP_JFA_STEP, OP_JFA_DISTANCE, OP_JFA_VORONOI };
+
+// the vertices of the pass quad are already in clip space
+const char *sVertexShader =
+	"void main() {\n"
+	"	gl_Position = gl_Vertex;\n"
+	"}\n";
+
+// Texture unit @ of each program is sampled through fetch@(), which takes texel coordinates and repeats the edges of [tex@Min, tex@Max]
+const char *sFetchFunction =
+	"uniform SAMPLER tex@;\n"
+	"uniform vec2 tex@Scale;\n"
+	"uniform vec2 tex@Min;\n"
+	"uniform vec2 tex@Max;\n"
+	"vec4 fetch@( vec2 texel ) {\n"
+	"	return TEXTURE( tex@, ( clamp( texel, tex@Min, tex@Max ) + 0.5 ) * tex@Scale );\n"
+	"}\n";
+
+const char* getOpSource( Op op )
+{
+	switch( op ) {
+		case OP_COPY:
+			return
+				"void main() {\n"
+				"	gl_FragColor = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"}\n";
+		// one axis of a triangle filter \a support texels wide on each side, mapping dst texels from dstStart to src texels from srcStart
+		case OP_RESIZE:
+			return
+				"uniform vec2 direction;\n"
+				"uniform vec2 offset;\n"
+				"uniform float dstStart;\n"
+				"uniform float srcStart;\n"
+				"uniform float scale;\n"
+				"uniform float support;\n"
+				"void main() {\n"
+				"	vec2 p = floor( gl_FragCoord.xy );\n"
+				"	float center = ( dot( p, direction ) - dstStart + 0.5 ) * scale - 0.5 + srcStart;\n"
+				"	vec2 across = ( p + offset ) * ( vec2( 1.0 ) - direction );\n"
+				"	float first = floor( center - support ) + 1.0;\n"
+				"	vec4 sum = vec4( 0.0 );\n"
+				"	float total = 0.0;\n"
+				"	for( int i = 0; i < 128; ++i ) {\n"
+				"		float t = first + float( i );\n"
+				"		if( t >= center + support )\n"
+				"			break;\n"
+				"		float w = 1.0 - abs( t - center ) / support;\n"
+				"		sum += w * fetch0( across + t * direction );\n"
+				"		total += w;\n"
+				"	}\n"
+				"	gl_FragColor = sum / total;\n"
+				"}\n";
+		// the float equations of ci::ip::blend(), which reduce to these once the foreground is premultiplied
+		case OP_BLEND:
+			return
+				"uniform bool srcPremultiplied;\n"
+				"uniform bool dstPremultiplied;\n"
+				"uniform vec2 srcSize;\n"
+				"void main() {\n"
+				"	vec2 p = floor( gl_FragCoord.xy );\n"
+				"	vec4 d = fetch0( p );\n"
+				"	if( any( greaterThanEqual( p, srcSize ) ) ) {\n"
+				"		gl_FragColor = d;\n"
+				"		return;\n"
+				"	}\n"
+				"	vec4 s = fetch1( p );\n"
+				"	vec3 src = srcPremultiplied ? s.rgb : s.rgb * s.a;\n"
+				"	float alpha = 1.0 - ( 1.0 - s.a ) * ( 1.0 - d.a );\n"
+				"	vec3 result;\n"
+				"	if( dstPremultiplied )\n"
+				"		result = ( 1.0 - s.a ) * d.rgb + src;\n"
+				"	else\n"
+				"		result = ( alpha > 0.0 ) ? ( ( 1.0 - s.a ) * d.a * d.rgb + src ) / alpha : d.rgb;\n"
+				"	gl_FragColor = vec4( result, alpha );\n"
+				"}\n";
+		case OP_THRESHOLD:
+			return
+				"uniform float value;\n"
+				"void main() {\n"
+				"	vec4 c = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"	gl_FragColor = vec4( vec3( greaterThan( c.rgb, vec3( value ) ) ), c.a );\n"
+				"}\n";
+		case OP_SOBEL:
+			return
+				"void main() {\n"
+				"	vec2 p = floor( gl_FragCoord.xy );\n"
+				"	vec3 n = fetch0( p + vec2( 0.0, -1.0 ) ).rgb, s = fetch0( p + vec2( 0.0, 1.0 ) ).rgb;\n"
+				"	vec3 w = fetch0( p + vec2( -1.0, 0.0 ) ).rgb, e = fetch0( p + vec2( 1.0, 0.0 ) ).rgb;\n"
+				"	vec3 nw = fetch0( p + vec2( -1.0, -1.0 ) ).rgb, ne = fetch0( p + vec2( 1.0, -1.0 ) ).rgb;\n"
+				"	vec3 sw = fetch0( p + vec2( -1.0, 1.0 ) ).rgb, se = fetch0( p + vec2( 1.0, 1.0 ) ).rgb;\n"
+				"	vec3 gx = ( ne + 2.0 * e + se ) - ( nw + 2.0 * w + sw );\n"
+				"	vec3 gy = ( nw + 2.0 * n + ne ) - ( sw + 2.0 * s + se );\n"
+				"	gl_FragColor = vec4( min( sqrt( gx * gx + gy * gy ), vec3( 1.0 ) ), fetch0( p ).a );\n"
+				"}\n";
+		// one axis of a box filter, or of a Gaussian when invTwoSigmaSq is positive
+		case OP_BLUR:
+			return
+				"uniform vec2 direction;\n"
+				"uniform int radius;\n"
+				"uniform float invTwoSigmaSq;\n"
+				"void main() {\n"
+				"	vec2 p = floor( gl_FragCoord.xy );\n"
+				"	vec4 sum = vec4( 0.0 );\n"
+				"	float total = 0.0;\n"
+				"	for( int i = 0; i < 512; ++i ) {\n"
+				"		if( i > 2 * radius )\n"
+				"			break;\n"
+				"		float x = float( i - radius );\n"
+				"		float w = ( invTwoSigmaSq > 0.0 ) ? exp( -x * x * invTwoSigmaSq ) : 1.0;\n"
+				"		sum += w * fetch0( p + x * direction );\n"
+				"		total += w;\n"
+				"	}\n"
+				"	gl_FragColor = sum / total;\n"
+				"}\n";
+		case OP_GRAYSCALE:
+			return
+				"void main() {\n"
+				"	vec4 c = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"	gl_FragColor = vec4( vec3( dot( c.rgb, vec3( 0.2126, 0.7152, 0.0722 ) ) ), c.a );\n"
+				"}\n";
+		case OP_PREMULTIPLY:
+			return
+				"void main() {\n"
+				"	vec4 c = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"	gl_FragColor = vec4( c.rgb * c.a, c.a );\n"
+				"}\n";
+		// jump flooding stores the nearest seed's texel in rg, the distance to it in b and whether there is one in a
+		case OP_JFA_SEED:
+			return
+				"uniform float threshold;\n"
+				"void main() {\n"
+				"	vec2 p = floor( gl_FragCoord.xy );\n"
+				"	gl_FragColor = ( fetch0( p ).r > threshold ) ? vec4( p, 0.0, 1.0 ) : vec4( -1.0, -1.0, 0.0, 0.0 );\n"
+				"}\n";
+		case OP_JFA_STEP:
+			return
+				"uniform float stepSize;\n"
+				"void main() {\n"
+				"	vec2 p = floor( gl_FragCoord.xy );\n"
+				"	vec4 best = vec4( -1.0, -1.0, 0.0, 0.0 );\n"
+				"	float bestDistance = 0.0;\n"
+				"	for( int j = -1; j <= 1; ++j ) {\n"
+				"		for( int i = -1; i <= 1; ++i ) {\n"
+				"			vec4 candidate = fetch0( p + vec2( float( i ), float( j ) ) * stepSize );\n"
+				"			float d = distance( p, candidate.xy );\n"
+				"			if( candidate.a > 0.0 && ( best.a == 0.0 || d < bestDistance ) ) {\n"
+				"				best = candidate;\n"
+				"				bestDistance = d;\n"
+				"			}\n"
+				"		}\n"
+				"	}\n"
+				"	gl_FragColor = vec4( best.xy, bestDistance, best.a );\n"
+				"}\n";
+		case OP_JFA_DISTANCE:
+			return
+				"uniform float scale;\n"
+				"void main() {\n"
+				"	vec4 nearest = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"	gl_FragColor = vec4( vec3( nearest.b * scale ), 1.0 );\n"
+				"}\n";
+		case OP_JFA_VORONOI:
+			return
+				"void main() {\n"
+				"	vec4 nearest = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"	gl_FragColor = ( nearest.a > 0.0 ) ? fetch1( nearest.xy ) : vec4( 0.0 );\n"
+				"}\n";
+		case OP_UNPREMULTIPLY:
+		default:
+			return
+				"void main() {\n"
+				"	vec4 c = fetch0( floor( gl_FragCoord.xy ) );\n"
+				"	gl_FragColor = ( c.a > 0.0 ) ? vec4( c.rgb / c.a, c.a ) : c;\n"
+				"}\n";
+	}
+}
+
+string replaceAll( string str, const string &from, const string &to )
+{
+	for( size_t pos = str.find( from ); pos != string::npos; pos = str.find( from, pos + to.size() ) )
+		str.replace( pos, from.size(), to );
+	return str;
+}
+
+// Returns the program for \a op sampling textures of \a targets, compiling it on first use
+GlslProg& getProgram( Op op, GLenum target0, GLenum target1 = GL_TEXTURE_2D )
+{
+	static map<pair<int,pair<GLenum,GLenum> >,GlslProg> sPrograms;
+
+	GlslProg &result = sPrograms[make_pair( (int)op, make_pair( target0, target1 ) )];
+	if( ! result ) {
+		const size_t numTextures = ( op == OP_BLEND || op == OP_JFA_VORONOI ) ? 2 : 1;
+		string fragmentShader;
+		if( target0 == GL_TEXTURE_RECTANGLE_ARB || ( numTextures > 1 && target1 == GL_TEXTURE_RECTANGLE_ARB ) )
+			fragmentShader += "#extension GL_ARB_texture_rectangle : enable\n";
+		for( size_t unit = 0; unit < numTextures; ++unit ) {
+			const bool rect = ( unit == 0 ? target0 : target1 ) == GL_TEXTURE_RECTANGLE_ARB;
+			string fetch = replaceAll( sFetchFunction, "SAMPLER", rect ? "sampler2DRect" : "sampler2D" );
+			fetch = replaceAll( fetch, "TEXTURE", rect ? "texture2DRect" : "texture2D" );
+			fragmentShader += replaceAll( fetch, "@", unit == 0 ? "0" : "1" );
+		}
+		fragmentShader += getOpSource( op );
+
+		result = GlslProg( sVertexShader, fragmentShader.c_str() );
+		result.bind();
+		result.uniform( "tex0", 0 );
+		if( numTextures > 1 )
+			result.uniform( "tex1", 1 );
+		GlslProg::unbind();
+	}
+
+	return result;
+}
+
+// Intermediate Fbo's are released as soon as each function returns, so ending a "frame" per call keeps those of recently used sizes
+FboPool& getFboPool()
+{
+	static FboPoolRef sPool = FboPool::create( 8 );
+	return *sPool;
+}
+
+Fbo::Format getIntermediateFormat( const Fbo &dstFbo )
+{
+	Fbo::Format result;
+	result.setColorInternalFormat( dstFbo.getFormat().getColorInternalFormat() );
+	result.enableDepthBuffer( false );
+	return result;
+}
+
+// Binds \a texture to \a unit and sets the uniforms fetchN() needs to clamp to \a area
+void bindTexture( GlslProg &prog, const Texture &texture, GLuint unit, const Area &area )
+{
+	const string prefix = ( unit == 0 ) ? "tex0" : "tex1";
+	texture.bind( unit );
+	if( texture.getTarget() == GL_TEXTURE_RECTANGLE_ARB )
+		prog.uniform( prefix + "Scale", Vec2f::one() );
+	else
+		prog.uniform( prefix + "Scale", Vec2f( 1.0f / texture.getWidth(), 1.0f / texture.getHeight() ) );
+	prog.uniform( prefix + "Min", Vec2f( (float)area.x1, (float)area.y1 ) );
+	prog.uniform( prefix + "Max", Vec2f( (float)area.x2 - 1, (float)area.y2 - 1 ) );
+}
+
+void bindTexture( GlslProg &prog, const Texture &texture, GLuint unit )
+{
+	bindTexture( prog, texture, unit, texture.getCleanBounds() );
+}
+
+// Renders the bound program over \a area of \a dstFbo, leaving the framebuffer binding, viewport and enables as they were
+void drawPass( Fbo *dstFbo, const Area &area )
+{
+	SaveFramebufferBinding saveFramebuffer;
+	dstFbo->bindFramebuffer();
+
+	glPushAttrib( GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT );
+	glViewport( area.x1, area.y1, area.getWidth(), area.getHeight() );
+	glDisable( GL_BLEND );
+	glDisable( GL_DEPTH_TEST );
+	glDisable( GL_SCISSOR_TEST );
+	glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
+	glBegin( GL_QUADS );
+		glVertex2f( -1, -1 );
+		glVertex2f( 1, -1 );
+		glVertex2f( 1, 1 );
+		glVertex2f( -1, 1 );
+	glEnd();
+	glPopAttrib();
+}
+
+// Runs the single texture \a op from \a srcTexture into \a dstFbo; \a setUniforms is called with the program bound
+template<typename FN>
+void applyPointOp( Op op, const Texture &srcTexture, Fbo *dstFbo, const FN &setUniforms )
+{
+	const Area area = srcTexture.getCleanBounds().getClipBy( dstFbo->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	Batch2d::flush();
+	GlslProg &prog = getProgram( op, srcTexture.getTarget() );
+	prog.bind();
+	bindTexture( prog, srcTexture, 0 );
+	setUniforms( prog );
+	drawPass( dstFbo, area );
+	srcTexture.unbind( 0 );
+	GlslProg::unbind();
+
+	dstFbo->getTexture().setFlipped( srcTexture.isFlipped() );
+}
+
+void applyPointOp( Op op, const Texture &srcTexture, Fbo *dstFbo )
+{
+	applyPointOp( op, srcTexture, dstFbo, []( GlslProg & ) {} );
+}
+
+// Runs OP_BLUR horizontally into a pooled Fbo and then vertically into \a dstFbo
+void separableBlur( const Texture &srcTexture, Fbo *dstFbo, int32_t radius, float invTwoSigmaSq )
+{
+	const Area area = srcTexture.getCleanBounds().getClipBy( dstFbo->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	Batch2d::flush();
+	FboPool &pool = getFboPool();
+	Fbo horizontal = pool.acquire( area.getWidth(), area.getHeight(), getIntermediateFormat( *dstFbo ) );
+
+	GlslProg &prog = getProgram( OP_BLUR, srcTexture.getTarget() );
+	prog.bind();
+	prog.uniform( "radius", radius );
+	prog.uniform( "invTwoSigmaSq", invTwoSigmaSq );
+	bindTexture( prog, srcTexture, 0, area );
+	prog.uniform( "direction", Vec2f( 1, 0 ) );
+	drawPass( &horizontal, horizontal.getBounds() );
+	srcTexture.unbind( 0 );
+	GlslProg::unbind();
+
+	GlslProg &verticalProg = getProgram( OP_BLUR, horizontal.getTarget() );
+	verticalProg.bind();
+	verticalProg.uniform( "radius", radius );
+	verticalProg.uniform( "invTwoSigmaSq", invTwoSigmaSq );
+	bindTexture( verticalProg, horizontal.getTexture(), 0 );
+	verticalProg.uniform( "direction", Vec2f( 0, 1 ) );
+	drawPass( dstFbo, area );
+	horizontal.getTexture().unbind( 0 );
+	GlslProg::unbind();
+
+	pool.release( horizontal );
+	pool.endFrame();
+	dstFbo->getTexture().setFlipped( srcTexture.isFlipped() );
+}
+
+// Runs the jump flooding passes over \a area of \a nearestFbo, without ending the pool's frame so that \a nearestFbo may itself be pooled
+void jumpFloodPasses( const Texture &seedTexture, Fbo *nearestFbo, float threshold, const Area &area )
+{
+	// steps halve from half the larger dimension down to 1, followed by another step of 1
+	vector<int32_t> steps;
+	for( int32_t step = (int32_t)nextPowerOf2( (uint32_t)std::max( area.getWidth(), area.getHeight() ) ) / 2; step >= 1; step /= 2 )
+		steps.push_back( step );
+	steps.push_back( 1 );
+
+	Batch2d::flush();
+	FboPool &pool = getFboPool();
+	Fbo pooled = pool.acquire( nearestFbo->getSize(), getIntermediateFormat( *nearestFbo ) );
+	// the passes ping-pong between the two Fbo's, starting with the one that makes the last pass land in nearestFbo
+	Fbo *targets[2] = { nearestFbo, &pooled };
+	const size_t first = steps.size() % 2;
+
+	GlslProg &seedProg = getProgram( OP_JFA_SEED, seedTexture.getTarget() );
+	seedProg.bind();
+	bindTexture( seedProg, seedTexture, 0, area );
+	seedProg.uniform( "threshold", threshold );
+	drawPass( targets[first], area );
+	seedTexture.unbind( 0 );
+
+	for( size_t s = 0; s < steps.size(); ++s ) {
+		Fbo *src = targets[( first + s ) % 2], *dst = targets[( first + s + 1 ) % 2];
+		GlslProg &prog = getProgram( OP_JFA_STEP, src->getTarget() );
+		prog.bind();
+		bindTexture( prog, src->getTexture(), 0, area );
+		prog.uniform( "stepSize", (float)steps[s] );
+		drawPass( dst, area );
+		src->getTexture().unbind( 0 );
+	}
+	GlslProg::unbind();
+
+	pool.release( pooled );
+	nearestFbo->getTexture().setFlipped( seedTexture.isFlipped() );
+}
+
+// Acquires a pooled floating point Fbo covering the part of \a dstFbo which \a seedTexture's results are written to, and jump floods \a seedTexture into it
+Fbo jumpFloodPooled( const Texture &seedTexture, const Fbo &dstFbo, float threshold )
+{
+	Fbo::Format format;
+	format.setColorInternalFormat( GL_RGBA32F_ARB );
+	format.enableDepthBuffer( false );
+	const Area area = seedTexture.getCleanBounds().getClipBy( dstFbo.getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return Fbo();
+
+	Fbo result = getFboPool().acquire( area.getWidth(), area.getHeight(), format );
+	jumpFloodPasses( seedTexture, &result, threshold, area );
+	return result;
+}
+
+} // anonymous namespace
+
+void resize( const Texture &srcTexture, const Area &srcArea, Fbo *dstFbo, const Area &dstArea )
+{
+	const Area src = srcArea.getClipBy( srcTexture.getCleanBounds() );
+	const Area dst = dstArea.getClipBy( dstFbo->getBounds() );
+	if( src.getWidth() <= 0 || src.getHeight() <= 0 || dst.getWidth() <= 0 || dst.getHeight() <= 0 )
+		return;
+
+	Batch2d::flush();
+	FboPool &pool = getFboPool();
+	// the horizontal pass resizes each row of srcArea, so the pooled Fbo is as wide as dstArea and as tall as srcArea
+	Fbo horizontal = pool.acquire( dst.getWidth(), src.getHeight(), getIntermediateFormat( *dstFbo ) );
+
+	const Vec2f scale( src.getWidth() / (float)dst.getWidth(), src.getHeight() / (float)dst.getHeight() );
+	GlslProg &prog = getProgram( OP_RESIZE, srcTexture.getTarget() );
+	prog.bind();
+	bindTexture( prog, srcTexture, 0, src );
+	prog.uniform( "direction", Vec2f( 1, 0 ) );
+	prog.uniform( "offset", Vec2f( 0, (float)src.y1 ) );
+	prog.uniform( "dstStart", 0.0f );
+	prog.uniform( "srcStart", (float)src.x1 );
+	prog.uniform( "scale", scale.x );
+	prog.uniform( "support", constrain( scale.x, 1.0f, 63.0f ) );
+	drawPass( &horizontal, horizontal.getBounds() );
+	srcTexture.unbind( 0 );
+	GlslProg::unbind();
+
+	GlslProg &verticalProg = getProgram( OP_RESIZE, horizontal.getTarget() );
+	verticalProg.bind();
+	bindTexture( verticalProg, horizontal.getTexture(), 0 );
+	verticalProg.uniform( "direction", Vec2f( 0, 1 ) );
+	verticalProg.uniform( "offset", Vec2f( (float)-dst.x1, 0 ) );
+	verticalProg.uniform( "dstStart", (float)dst.y1 );
+	verticalProg.uniform( "srcStart", 0.0f );
+	verticalProg.uniform( "scale", scale.y );
+	verticalProg.uniform( "support", constrain( scale.y, 1.0f, 63.0f ) );
+	drawPass( dstFbo, dst );
+	horizontal.getTexture().unbind( 0 );
+	GlslProg::unbind();
+
+	pool.release( horizontal );
+	pool.endFrame();
+	dstFbo->getTexture().setFlipped( srcTexture.isFlipped() );
+}
+
+void blend( const Texture &background, const Texture &foreground, Fbo *dstFbo, bool foregroundPremultiplied, bool backgroundPremultiplied )
+{
+	const Area area = background.getCleanBounds().getClipBy( dstFbo->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	Batch2d::flush();
+	GlslProg &prog = getProgram( OP_BLEND, background.getTarget(), foreground.getTarget() );
+	prog.bind();
+	bindTexture( prog, background, 0 );
+	bindTexture( prog, foreground, 1 );
+	prog.uniform( "srcPremultiplied", foregroundPremultiplied );
+	prog.uniform( "dstPremultiplied", backgroundPremultiplied );
+	prog.uniform( "srcSize", Vec2f( (float)foreground.getCleanWidth(), (float)foreground.getCleanHeight() ) );
+	drawPass( dstFbo, area );
+	foreground.unbind( 1 );
+	background.unbind( 0 );
+	GlslProg::unbind();
+
+	dstFbo->getTexture().setFlipped( background.isFlipped() );
+}
+
+void blend( Fbo *backgroundFbo, const Texture &foreground, bool foregroundPremultiplied, bool backgroundPremultiplied )
+{
+	FboPool &pool = getFboPool();
+	Fbo result = pool.acquire( backgroundFbo->getSize(), getIntermediateFormat( *backgroundFbo ) );
+	blend( backgroundFbo->getTexture(), foreground, &result, foregroundPremultiplied, backgroundPremultiplied );
+	applyPointOp( OP_COPY, result.getTexture(), backgroundFbo );
+	pool.release( result );
+	pool.endFrame();
+}
+
+void threshold( const Texture &srcTexture, float value, Fbo *dstFbo )
+{
+	applyPointOp( OP_THRESHOLD, srcTexture, dstFbo, [value]( GlslProg &prog ) { prog.uniform( "value", value ); } );
+}
+
+void edgeDetectSobel( const Texture &srcTexture, Fbo *dstFbo )
+{
+	applyPointOp( OP_SOBEL, srcTexture, dstFbo );
+}
+
+void boxBlur( const Texture &srcTexture, Fbo *dstFbo, int32_t radius )
+{
+	separableBlur( srcTexture, dstFbo, constrain<int32_t>( radius, 0, 255 ), 0.0f );
+}
+
+void gaussianBlur( const Texture &srcTexture, Fbo *dstFbo, float sigma )
+{
+	sigma = constrain( sigma, 0.0f, 85.0f );
+	const int32_t radius = (int32_t)math<float>::ceil( 3 * sigma );
+	separableBlur( srcTexture, dstFbo, radius, ( radius > 0 ) ? 1.0f / ( 2 * sigma * sigma ) : 0.0f );
+}
+
+void grayscale( const Texture &srcTexture, Fbo *dstFbo )
+{
+	applyPointOp( OP_GRAYSCALE, srcTexture, dstFbo );
+}
+
+void premultiply( const Texture &srcTexture, Fbo *dstFbo )
+{
+	applyPointOp( OP_PREMULTIPLY, srcTexture, dstFbo );
+}
+
+void unpremultiply( const Texture &srcTexture, Fbo *dstFbo )
+{
+	applyPointOp( OP_UNPREMULTIPLY, srcTexture, dstFbo );
+}
+
+void jumpFlood( const Texture &seedTexture, Fbo *nearestFbo, float threshold )
+{
+	const Area area = seedTexture.getCleanBounds().getClipBy( nearestFbo->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	jumpFloodPasses( seedTexture, nearestFbo, threshold, area );
+	getFboPool().endFrame();
+}
+
+void distanceTransform( const Texture &seedTexture, Fbo *dstFbo, float threshold, float scale )
+{
+	Fbo nearest = jumpFloodPooled( seedTexture, *dstFbo, threshold );
+	if( nearest ) {
+		applyPointOp( OP_JFA_DISTANCE, nearest.getTexture(), dstFbo, [scale]( GlslProg &prog ) { prog.uniform( "scale", scale ); } );
+		getFboPool().release( nearest );
+		getFboPool().endFrame();
+	}
+	dstFbo->getTexture().setFlipped( seedTexture.isFlipped() );
+}
+
+void voronoi( const Texture &seedTexture, Fbo *dstFbo, float threshold )
+{
+	Fbo nearest = jumpFloodPooled( seedTexture, *dstFbo, threshold );
+	if( ! nearest )
+		return;
+
+	GlslProg &prog = getProgram( OP_JFA_VORONOI, nearest.getTarget(), seedTexture.getTarget() );
+	prog.bind();
+	bindTexture( prog, nearest.getTexture(), 0 );
+	bindTexture( prog, seedTexture, 1 );
+	drawPass( dstFbo, nearest.getBounds() );
+	seedTexture.unbind( 1 );
+	nearest.getTexture().unbind( 0 );
+	GlslProg::unbind();
+
+	getFboPool().release( nearest );
+	getFboPool().endFrame();
+	dstFbo->getTexture().setFlipped( seedTexture.isFlipped() );
+}
+
+} } } // namespace cinder::gl::ip
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,243 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/LightGrid.h"
+#include "cinder/CinderMath.h"
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+const int INDEX_TEXTURE_WIDTH = 1024;
+
+// Lists are read with texture2D() at texel centers, so that no integer support is needed. ciLightGrid is the number of tiles in x and y, the number
+// of slices and the tile size in pixels, and ciLightSlices the scale and bias mapping the log of a fragment's depth to its slice.
+const char *sGlslFunctions =
+	"uniform sampler2D ciLightClusters;\n"
+	"uniform sampler2D ciLightIndices;\n"
+	"uniform sampler2D ciLightData;\n"
+	"uniform vec4 ciLightGrid;\n"
+	"uniform vec2 ciLightSlices;\n"
+	"uniform vec2 ciLightIndicesSize;\n"
+	"uniform float ciLightDataWidth;\n"
+	"vec3 ciPointLights( vec3 eyePosition, vec3 eyeNormal ) {\n"
+	"	vec2 tile = min( floor( gl_FragCoord.xy / ciLightGrid.w ), ciLightGrid.xy - 1.0 );\n"
+	"	float slice = clamp( floor( log( -eyePosition.z ) * ciLightSlices.x + ciLightSlices.y ), 0.0, ciLightGrid.z - 1.0 );\n"
+	"	vec4 cluster = texture2D( ciLightClusters, ( vec2( tile.x, slice * ciLightGrid.y + tile.y ) + 0.5 ) / vec2( ciLightGrid.x, ciLightGrid.y * ciLightGrid.z ) );\n"
+	"	vec3 result = vec3( 0.0 );\n"
+	"	for( float i = 0.0; i < cluster.a; i += 1.0 ) {\n"
+	"		float index = cluster.r + i;\n"
+	"		float light = texture2D( ciLightIndices, ( vec2( mod( index, ciLightIndicesSize.x ), floor( index / ciLightIndicesSize.x ) ) + 0.5 ) / ciLightIndicesSize ).r;\n"
+	"		float u = ( light + 0.5 ) / ciLightDataWidth;\n"
+	"		vec4 positionRadius = texture2D( ciLightData, vec2( u, 0.25 ) );\n"
+	"		vec3 color = texture2D( ciLightData, vec2( u, 0.75 ) ).rgb;\n"
+	"		vec3 toLight = positionRadius.xyz - eyePosition;\n"
+	"		float dist = length( toLight );\n"
+	"		float falloff = clamp( 1.0 - dist / positionRadius.w, 0.0, 1.0 );\n"
+	"		result += color * ( falloff * falloff * max( dot( eyeNormal, toLight / max( dist, 0.0001 ) ), 0.0 ) );\n"
+	"	}\n"
+	"	return result;\n"
+	"}\n";
+
+/* Returns the range of normalized device coordinates along one axis covered by a sphere at lateral coordinate \a a and depth \a depth,
+	from the angles of the tangents to it through the eye. \a scale is the reciprocal of the tangent of the half field of view. The sphere
+	must lie entirely in front of the eye. */
+void calcNdcBounds( float a, float depth, float radius, float scale, float *minNdc, float *maxNdc )
+{
+	const float angle = math<float>::atan2( a, depth );
+	const float halfAngle = math<float>::asin( radius / math<float>::sqrt( a * a + depth * depth ) );
+	*minNdc = math<float>::tan( angle - halfAngle ) * scale;
+	*maxNdc = math<float>::tan( angle + halfAngle ) * scale;
+}
+
+// Maps a range of normalized device coordinates to the tiles it covers, returning false when it's entirely outside
+bool calcTileRange( float minNdc, float maxNdc, int viewportSize, int tileSize, int numTiles, int *first, int *last )
+{
+	if( maxNdc < -1 || minNdc > 1 )
+		return false;
+	*first = std::max( (int)math<float>::floor( ( minNdc * 0.5f + 0.5f ) * viewportSize / tileSize ), 0 );
+	*last = std::min( (int)math<float>::floor( ( std::min( maxNdc, 1.0f ) * 0.5f + 0.5f ) * viewportSize / tileSize ), numTiles - 1 );
+	return *first <= *last;
+}
+
+Texture createFloatTexture( int width, int height, GLint internalFormat )
+{
+	Texture::Format format;
+	format.setInternalFormat( internalFormat );
+	format.setMinFilter( GL_NEAREST );
+	format.setMagFilter( GL_NEAREST );
+	format.setWrap( GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE );
+	return Texture( width, height, format );
+}
+
+void updateFloatTexture( Texture &texture, int width, int height, GLenum dataFormat, const vector<float> &data )
+{
+	texture.bind();
+	glTexSubImage2D( texture.getTarget(), 0, 0, 0, width, height, dataFormat, GL_FLOAT, &data[0] );
+	texture.unbind();
+}
+
+} // anonymous namespace
+
+LightGrid::LightGrid( const Format &format )
+	: mFormat( format ), mNumTilesX( 0 ), mNumTilesY( 0 ), mSliceScale( 0 ), mSliceBias( 0 )
+{
+	// a row of eye space positions and radii over a row of colors
+	mLightTexture = createFloatTexture( mFormat.getMaxLights(), 2, GL_RGBA32F_ARB );
+	mLightData.resize( mFormat.getMaxLights() * 2 * 4, 0 );
+}
+
+void LightGrid::update( const CameraPersp &camera, const Vec2i &viewportSize, const vector<PointLight> &lights )
+{
+	const int tileSize = mFormat.getTileSize();
+	const int numSlices = mFormat.getNumSlices();
+	const int numTilesX = std::max( ( viewportSize.x + tileSize - 1 ) / tileSize, 1 );
+	const int numTilesY = std::max( ( viewportSize.y + tileSize - 1 ) / tileSize, 1 );
+	const size_t numClusters = numTilesX * numTilesY * numSlices;
+	if( numTilesX != mNumTilesX || numTilesY != mNumTilesY || ! mClusterTexture ) {
+		mNumTilesX = numTilesX;
+		mNumTilesY = numTilesY;
+		mClusterTexture = createFloatTexture( mNumTilesX, mNumTilesY * numSlices, GL_LUMINANCE_ALPHA32F_ARB );
+	}
+
+	const float nearClip = camera.getNearClip(), farClip = camera.getFarClip();
+	mSliceScale = numSlices / math<float>::log( farClip / nearClip );
+	mSliceBias = -math<float>::log( nearClip ) * mSliceScale;
+
+	const float tanHalfFov = math<float>::tan( toRadians( camera.getFov() ) * 0.5f );
+	const float scaleY = 1 / tanHalfFov, scaleX = 1 / ( tanHalfFov * camera.getAspectRatio() );
+	const Matrix44f &modelView = camera.getModelViewMatrix();
+
+	// first the range of clusters of each light, counting the lights of each cluster
+	const size_t numLights = std::min<size_t>( lights.size(), mFormat.getMaxLights() );
+	mLightRanges.resize( numLights );
+	mClusterCounts.assign( numClusters, 0 );
+	for( size_t l = 0; l < numLights; ++l ) {
+		const PointLight &light = lights[l];
+		const Vec3f eyePosition = modelView.transformPointAffine( light.mPosition );
+		const float depth = -eyePosition.z, radius = light.mRadius;
+		float *lightData = &mLightData[l * 4];
+		lightData[0] = eyePosition.x; lightData[1] = eyePosition.y; lightData[2] = eyePosition.z; lightData[3] = radius;
+		float *colorData = &mLightData[( mFormat.getMaxLights() + l ) * 4];
+		colorData[0] = light.mColor.r; colorData[1] = light.mColor.g; colorData[2] = light.mColor.b; colorData[3] = 1;
+
+		ClusterRange &range = mLightRanges[l];
+		range.mX0 = 0; range.mX1 = -1; // empty
+		const float minDepth = std::max( depth - radius, nearClip ), maxDepth = std::min( depth + radius, farClip );
+		if( minDepth > maxDepth )
+			continue;
+
+		float minX = -1, maxX = 1, minY = -1, maxY = 1;
+		if( depth > radius ) { // otherwise the sphere reaches behind the eye, and covers every tile conservatively
+			calcNdcBounds( eyePosition.x, depth, radius, scaleX, &minX, &maxX );
+			calcNdcBounds( eyePosition.y, depth, radius, scaleY, &minY, &maxY );
+		}
+		if( ! calcTileRange( minX, maxX, viewportSize.x, tileSize, mNumTilesX, &range.mX0, &range.mX1 )
+			|| ! calcTileRange( minY, maxY, viewportSize.y, tileSize, mNumTilesY, &range.mY0, &range.mY1 ) ) {
+			range.mX0 = 0; range.mX1 = -1;
+			continue;
+		}
+		range.mSlice0 = std::min( std::max( (int)math<float>::floor( math<float>::log( minDepth ) * mSliceScale + mSliceBias ), 0 ), numSlices - 1 );
+		range.mSlice1 = std::min( std::max( (int)math<float>::floor( math<float>::log( maxDepth ) * mSliceScale + mSliceBias ), 0 ), numSlices - 1 );
+
+		for( int s = range.mSlice0; s <= range.mSlice1; ++s )
+			for( int y = range.mY0; y <= range.mY1; ++y )
+				for( int x = range.mX0; x <= range.mX1; ++x )
+					++mClusterCounts[calcClusterIndex( x, y, s )];
+	}
+
+	// then the lists, laid out consecutively in cluster order
+	mClusterOffsets.resize( numClusters );
+	uint32_t numIndices = 0;
+	for( size_t c = 0; c < numClusters; ++c ) {
+		mClusterOffsets[c] = numIndices;
+		numIndices += mClusterCounts[c];
+	}
+	mLightIndices.resize( numIndices );
+	vector<uint32_t> fill( mClusterOffsets );
+	for( size_t l = 0; l < numLights; ++l ) {
+		const ClusterRange &range = mLightRanges[l];
+		if( range.mX1 < range.mX0 )
+			continue;
+		for( int s = range.mSlice0; s <= range.mSlice1; ++s )
+			for( int y = range.mY0; y <= range.mY1; ++y )
+				for( int x = range.mX0; x <= range.mX1; ++x )
+					mLightIndices[fill[calcClusterIndex( x, y, s )]++] = (uint32_t)l;
+	}
+
+	// upload
+	mClusterData.resize( numClusters * 2 );
+	for( size_t c = 0; c < numClusters; ++c ) {
+		mClusterData[c * 2] = (float)mClusterOffsets[c];
+		mClusterData[c * 2 + 1] = (float)mClusterCounts[c];
+	}
+	updateFloatTexture( mClusterTexture, mNumTilesX, mNumTilesY * numSlices, GL_LUMINANCE_ALPHA, mClusterData );
+
+	const int indexRows = std::max<int>( ( numIndices + INDEX_TEXTURE_WIDTH - 1 ) / INDEX_TEXTURE_WIDTH, 1 );
+	if( ! mIndexTexture || mIndexTexture.getHeight() < indexRows ) {
+		int capacityRows = 1;
+		while( capacityRows < indexRows )
+			capacityRows *= 2;
+		mIndexTexture = createFloatTexture( INDEX_TEXTURE_WIDTH, capacityRows, GL_LUMINANCE32F_ARB );
+	}
+	mIndexData.assign( indexRows * INDEX_TEXTURE_WIDTH, 0 );
+	for( uint32_t i = 0; i < numIndices; ++i )
+		mIndexData[i] = (float)mLightIndices[i];
+	updateFloatTexture( mIndexTexture, INDEX_TEXTURE_WIDTH, indexRows, GL_LUMINANCE, mIndexData );
+
+	if( numLights > 0 ) {
+		mLightTexture.bind();
+		glTexSubImage2D( mLightTexture.getTarget(), 0, 0, 0, (GLsizei)numLights, 1, GL_RGBA, GL_FLOAT, &mLightData[0] );
+		glTexSubImage2D( mLightTexture.getTarget(), 0, 0, 1, (GLsizei)numLights, 1, GL_RGBA, GL_FLOAT, &mLightData[mFormat.getMaxLights() * 4] );
+		mLightTexture.unbind();
+	}
+}
+
+void LightGrid::setUniforms( GlslProg &shader, int firstTextureUnit )
+{
+	mClusterTexture.bind( firstTextureUnit );
+	mIndexTexture.bind( firstTextureUnit + 1 );
+	mLightTexture.bind( firstTextureUnit + 2 );
+
+	shader.uniform( "ciLightClusters", firstTextureUnit );
+	shader.uniform( "ciLightIndices", firstTextureUnit + 1 );
+	shader.uniform( "ciLightData", firstTextureUnit + 2 );
+	shader.uniform( "ciLightGrid", Vec4f( (float)mNumTilesX, (float)mNumTilesY, (float)mFormat.getNumSlices(), (float)mFormat.getTileSize() ) );
+	shader.uniform( "ciLightSlices", Vec2f( mSliceScale, mSliceBias ) );
+	shader.uniform( "ciLightIndicesSize", Vec2f( (float)mIndexTexture.getWidth(), (float)mIndexTexture.getHeight() ) );
+	shader.uniform( "ciLightDataWidth", (float)mLightTexture.getWidth() );
+}
+
+const char* LightGrid::getGlslFunctions()
+{
+	return sGlslFunctions;
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
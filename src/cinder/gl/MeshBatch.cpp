@@ -0,0 +1,287 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/MeshBatch.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/CinderAssert.h"
+
+#include <cstddef>
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+#define CI_GL_DRAW_INDIRECT_BUFFER		0x8F3F
+
+#if defined( CINDER_MSW )
+// GLee predates ARB_multi_draw_indirect, so its entry point is resolved here
+typedef void (APIENTRY *MultiDrawElementsIndirectFn)( GLenum mode, GLenum type, const GLvoid *indirect, GLsizei drawCount, GLsizei stride );
+
+MultiDrawElementsIndirectFn		sMultiDrawElementsIndirect = NULL;
+#endif
+
+const char *sVertexShader =
+	"#version 120\n"
+	"attribute mat4 ciModelMatrix;\n"
+	"attribute vec4 ciColor;\n"
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	vec4 eyePosition = gl_ModelViewMatrix * ( ciModelMatrix * gl_Vertex );\n"
+	"	vec3 eyeNormal = gl_NormalMatrix * ( mat3( ciModelMatrix ) * gl_Normal );\n"
+	"	float normalLength = length( eyeNormal );\n"
+	"	float diffuse = ( normalLength > 0.0 ) ? abs( dot( eyeNormal / normalLength, normalize( -eyePosition.xyz ) ) ) : 1.0;\n"
+	"	vColor = vec4( ciColor.rgb * ( 0.25 + 0.75 * diffuse ), ciColor.a );\n"
+	"	gl_Position = gl_ProjectionMatrix * eyePosition;\n"
+	"}\n";
+
+const char *sFragmentShader =
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	gl_FragColor = vColor;\n"
+	"}\n";
+
+GlslProg& getDefaultShader()
+{
+	static GlslProg sShader;
+	if( ! sShader )
+		sShader = GlslProg( sVertexShader, sFragmentShader );
+	return sShader;
+}
+
+// GLee exposes ARB_instanced_arrays under its core name
+inline void vertexAttribDivisor( GLuint index, GLuint divisor )
+{
+#if defined( CINDER_MSW )
+	glVertexAttribDivisor( index, divisor );
+#else
+	glVertexAttribDivisorARB( index, divisor );
+#endif
+}
+
+} // anonymous namespace
+
+MeshBatch::MeshBatch( const GlslProg &shader )
+	: mShader( shader ), mGeometryDirty( false ), mDrawsDirty( false )
+{
+	if( ! mShader )
+		mShader = getDefaultShader();
+	mModelMatrixLocation = mShader.getAttribLocation( "ciModelMatrix" );
+	mColorLocation = mShader.getAttribLocation( "ciColor" );
+}
+
+uint32_t MeshBatch::addMesh( const TriMesh &triMesh )
+{
+	const size_t numVertices = triMesh.getNumVertices();
+	const uint32_t baseVertex = (uint32_t)mGeometry.getNumVertices();
+
+	// every vertex carries a normal and texture coordinate so that the meshes share one layout
+	mGeometry.appendVertices( triMesh.getVertices().empty() ? NULL : &triMesh.getVertices()[0], numVertices );
+	if( triMesh.hasNormals() )
+		mGeometry.appendNormals( &triMesh.getNormals()[0], numVertices );
+	else
+		mGeometry.getNormals().resize( mGeometry.getNumVertices(), Vec3f::zero() );
+	if( triMesh.hasTexCoords() )
+		mGeometry.appendTexCoords( &triMesh.getTexCoords()[0], numVertices );
+	else
+		mGeometry.getTexCoords().resize( mGeometry.getNumVertices(), Vec2f::zero() );
+
+	// indices are rebased as they're appended, so that no draw needs a base vertex
+	Mesh mesh;
+	mesh.mFirstIndex = (uint32_t)mGeometry.getNumIndices();
+	mesh.mNumIndices = (uint32_t)triMesh.getNumIndices();
+	vector<uint32_t> &indices = mGeometry.getIndices();
+	const vector<uint32_t> &meshIndices = triMesh.getIndices();
+	indices.reserve( indices.size() + meshIndices.size() );
+	for( vector<uint32_t>::const_iterator indexIt = meshIndices.begin(); indexIt != meshIndices.end(); ++indexIt )
+		indices.push_back( *indexIt + baseVertex );
+
+	mMeshes.push_back( mesh );
+	mGeometryDirty = true;
+	return (uint32_t)( mMeshes.size() - 1 );
+}
+
+void MeshBatch::clear()
+{
+	mGeometry.clear();
+	mMeshes.clear();
+	mVboMesh.reset();
+	mGeometryDirty = false;
+	clearDraws();
+}
+
+void MeshBatch::addDraw( uint32_t meshId, const Matrix44f &modelMatrix, const ColorA &color )
+{
+	CI_ASSERT( meshId < mMeshes.size() );
+
+	mDrawMeshIds.push_back( meshId );
+	mDraws.push_back( Instance( modelMatrix, color ) );
+	mDrawsDirty = true;
+}
+
+void MeshBatch::clearDraws()
+{
+	mDrawMeshIds.clear();
+	mDraws.clear();
+	mDrawsDirty = true;
+}
+
+bool MeshBatch::isMultiDrawIndirectSupported()
+{
+#if defined( CINDER_MSW )
+	static bool sResolved = false, sSupported = false;
+	if( ! sResolved ) {
+		sResolved = true;
+		// the per-draw attributes are selected by each command's base instance
+		if( isExtensionAvailable( "GL_ARB_multi_draw_indirect" ) && isExtensionAvailable( "GL_ARB_base_instance" ) && VboMesh::isInstancingSupported() ) {
+			sMultiDrawElementsIndirect = reinterpret_cast<MultiDrawElementsIndirectFn>( ::wglGetProcAddress( "glMultiDrawElementsIndirect" ) );
+			sSupported = sMultiDrawElementsIndirect != NULL;
+		}
+	}
+	return sSupported;
+#else
+	return false;
+#endif
+}
+
+void MeshBatch::buildDraws()
+{
+	// a counting sort groups the draws by mesh, so that each mesh drawn becomes one command of several instances
+	vector<uint32_t> firstDraw( mMeshes.size() + 1, 0 );
+	for( vector<uint32_t>::const_iterator idIt = mDrawMeshIds.begin(); idIt != mDrawMeshIds.end(); ++idIt )
+		++firstDraw[*idIt + 1];
+	for( size_t m = 1; m < firstDraw.size(); ++m )
+		firstDraw[m] += firstDraw[m - 1];
+
+	mCommands.clear();
+	for( size_t m = 0; m < mMeshes.size(); ++m ) {
+		const uint32_t numInstances = firstDraw[m + 1] - firstDraw[m];
+		if( numInstances == 0 || mMeshes[m].mNumIndices == 0 )
+			continue;
+		DrawElementsIndirectCommand command = { mMeshes[m].mNumIndices, numInstances, mMeshes[m].mFirstIndex, 0, firstDraw[m] };
+		mCommands.push_back( command );
+	}
+
+	mSortedDraws.resize( mDraws.size(), Instance( Matrix44f::identity(), ColorA() ) );
+	for( size_t d = 0; d < mDraws.size(); ++d )
+		mSortedDraws[firstDraw[mDrawMeshIds[d]]++] = mDraws[d];
+}
+
+void MeshBatch::draw()
+{
+	if( mGeometryDirty ) {
+		mVboMesh.reset();
+		if( mGeometry.getNumIndices() > 0 ) {
+			VboMesh::Layout layout;
+			layout.setStaticIndices();
+			layout.setStaticPositions();
+			layout.setStaticNormals();
+			layout.setStaticTexCoords2d();
+			mVboMesh = VboMesh::create( mGeometry, layout );
+		}
+		mGeometryDirty = false;
+		mDrawsDirty = true;
+	}
+
+	if( ! mVboMesh || mDraws.empty() )
+		return;
+
+	const bool multiDrawIndirect = isMultiDrawIndirectSupported();
+	if( mDrawsDirty ) {
+		buildDraws();
+		if( multiDrawIndirect ) {
+			if( ! mInstanceVbo ) {
+				mInstanceVbo = Vbo( GL_ARRAY_BUFFER );
+				mCommandVbo = Vbo( CI_GL_DRAW_INDIRECT_BUFFER );
+			}
+			mInstanceVbo.bufferData( sizeof(Instance) * mSortedDraws.size(), &mSortedDraws[0], GL_STREAM_DRAW );
+			if( ! mCommands.empty() )
+				mCommandVbo.bufferData( sizeof(DrawElementsIndirectCommand) * mCommands.size(), &mCommands[0], GL_STREAM_DRAW );
+		}
+		mDrawsDirty = false;
+	}
+
+	if( mCommands.empty() )
+		return;
+
+	Batch2d::flush();
+	mShader.bind();
+	mVboMesh->enableClientStates();
+	mVboMesh->bindAllData();
+
+#if defined( CINDER_MSW )
+	if( multiDrawIndirect ) {
+		// a mat4 attribute occupies four consecutive locations, one per column
+		mInstanceVbo.bind();
+		for( GLint c = 0; c < 4 && mModelMatrixLocation >= 0; ++c ) {
+			glEnableVertexAttribArray( mModelMatrixLocation + c );
+			glVertexAttribPointer( mModelMatrixLocation + c, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid*)( offsetof( Instance, mModelMatrix ) + sizeof(Vec4f) * c ) );
+			vertexAttribDivisor( mModelMatrixLocation + c, 1 );
+		}
+		if( mColorLocation >= 0 ) {
+			glEnableVertexAttribArray( mColorLocation );
+			glVertexAttribPointer( mColorLocation, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid*)offsetof( Instance, mColor ) );
+			vertexAttribDivisor( mColorLocation, 1 );
+		}
+
+		mCommandVbo.bind();
+		sMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, 0, (GLsizei)mCommands.size(), 0 );
+		mCommandVbo.unbind();
+
+		// the divisor is attribute state, so reset it for whoever uses the location next
+		for( GLint c = 0; c < 4 && mModelMatrixLocation >= 0; ++c ) {
+			vertexAttribDivisor( mModelMatrixLocation + c, 0 );
+			glDisableVertexAttribArray( mModelMatrixLocation + c );
+		}
+		if( mColorLocation >= 0 ) {
+			vertexAttribDivisor( mColorLocation, 0 );
+			glDisableVertexAttribArray( mColorLocation );
+		}
+	}
+	else
+#endif
+	{
+		for( vector<DrawElementsIndirectCommand>::const_iterator commandIt = mCommands.begin(); commandIt != mCommands.end(); ++commandIt ) {
+			const Instance *instance = &mSortedDraws[commandIt->mBaseInstance];
+			for( GLuint i = 0; i < commandIt->mInstanceCount; ++i, ++instance ) {
+				for( GLint c = 0; c < 4 && mModelMatrixLocation >= 0; ++c )
+					glVertexAttrib4fv( mModelMatrixLocation + c, &instance->mModelMatrix.m[c * 4] );
+				if( mColorLocation >= 0 )
+					glVertexAttrib4fv( mColorLocation, &instance->mColor.r );
+				glDrawElements( GL_TRIANGLES, (GLsizei)commandIt->mCount, GL_UNSIGNED_INT, (const GLvoid*)( sizeof(uint32_t) * commandIt->mFirstIndex ) );
+			}
+		}
+	}
+
+	VboMesh::unbindBuffers();
+	mVboMesh->disableClientStates();
+	GlslProg::unbind();
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,145 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/OcclusionCuller.h"
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+const char *sReduceVertexShader =
+	"void main() {\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+	"}\n";
+
+// Writes the farthest of the 2x2 source texels under each destination texel, the last row and column also taking the one left over by an odd size
+const char *sReduceFragmentShader =
+	"uniform sampler2D depthTexture;\n"
+	"uniform vec2 srcSize;\n"
+	"uniform vec2 dstSize;\n"
+	"float fetch( vec2 texel ) {\n"
+	"	return texture2D( depthTexture, ( min( texel, srcSize - 1.0 ) + 0.5 ) / srcSize ).r;\n"
+	"}\n"
+	"void main() {\n"
+	"	vec2 dst = floor( gl_FragCoord.xy );\n"
+	"	vec2 src = dst * 2.0;\n"
+	"	float depth = max( max( fetch( src ), fetch( src + vec2( 1.0, 0.0 ) ) ), max( fetch( src + vec2( 0.0, 1.0 ) ), fetch( src + vec2( 1.0, 1.0 ) ) ) );\n"
+	"	bool extraX = ( dst.x == dstSize.x - 1.0 ) && ( srcSize.x > dstSize.x * 2.0 );\n"
+	"	bool extraY = ( dst.y == dstSize.y - 1.0 ) && ( srcSize.y > dstSize.y * 2.0 );\n"
+	"	if( extraX )\n"
+	"		depth = max( depth, max( fetch( src + vec2( 2.0, 0.0 ) ), fetch( src + vec2( 2.0, 1.0 ) ) ) );\n"
+	"	if( extraY )\n"
+	"		depth = max( depth, max( fetch( src + vec2( 0.0, 2.0 ) ), fetch( src + vec2( 1.0, 2.0 ) ) ) );\n"
+	"	if( extraX && extraY )\n"
+	"		depth = max( depth, fetch( src + vec2( 2.0, 2.0 ) ) );\n"
+	"	gl_FragDepth = depth;\n"
+	"}\n";
+
+} // anonymous namespace
+
+OcclusionCuller::OcclusionCuller( const Format &format )
+	: mFormat( format ), mSourceSize( 0, 0 )
+{
+	mReduceShader = GlslProg( sReduceVertexShader, sReduceFragmentShader );
+}
+
+void OcclusionCuller::update( Fbo &depthFbo, const Camera &camera )
+{
+	// the chain of depth-only levels, halving until the readback size is reached
+	if( depthFbo.getSize() != mSourceSize ) {
+		mSourceSize = depthFbo.getSize();
+		mLevels.clear();
+		mPendingReadbacks.clear();
+
+		Fbo::Format format;
+		format.enableColorBuffer( false );
+		format.enableDepthBuffer( true, true );
+		format.setDepthInternalFormat( GL_DEPTH_COMPONENT32 );
+		Vec2i size = mSourceSize;
+		while( size.x > mFormat.getReadbackSize() || size.y > mFormat.getReadbackSize() ) {
+			size = Vec2i( std::max( size.x / 2, 1 ), std::max( size.y / 2, 1 ) );
+			mLevels.push_back( Fbo( size.x, size.y, format ) );
+		}
+	}
+
+	if( ! mLevels.empty() ) {
+		SaveFramebufferBinding saveFramebufferBinding;
+		glPushAttrib( GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT );
+		pushMatrices();
+
+		glEnable( GL_DEPTH_TEST );
+		glDepthFunc( GL_ALWAYS );
+		glDepthMask( GL_TRUE );
+		glColorMask( GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE );
+		glDisable( GL_BLEND );
+
+		mReduceShader.bind();
+		mReduceShader.uniform( "depthTexture", 0 );
+		Texture *source = &depthFbo.getDepthTexture();
+		Vec2i sourceSize = mSourceSize;
+		for( vector<Fbo>::iterator levelIt = mLevels.begin(); levelIt != mLevels.end(); ++levelIt ) {
+			const Vec2i size = levelIt->getSize();
+			levelIt->bindFramebuffer();
+			glViewport( 0, 0, size.x, size.y );
+			setMatricesWindow( size, false );
+			source->bind( 0 );
+			mReduceShader.uniform( "srcSize", Vec2f( sourceSize ) );
+			mReduceShader.uniform( "dstSize", Vec2f( size ) );
+
+			const GLfloat verts[8] = { 0, 0, (GLfloat)size.x, 0, (GLfloat)size.x, (GLfloat)size.y, 0, (GLfloat)size.y };
+			glEnableClientState( GL_VERTEX_ARRAY );
+			glVertexPointer( 2, GL_FLOAT, 0, verts );
+			glDrawArrays( GL_TRIANGLE_FAN, 0, 4 );
+			glDisableClientState( GL_VERTEX_ARRAY );
+
+			source->unbind( 0 );
+			source = &levelIt->getDepthTexture();
+			sourceSize = size;
+		}
+		GlslProg::unbind();
+
+		popMatrices();
+		glPopAttrib();
+	}
+
+	PendingReadback pending;
+	const Fbo &readFbo = mLevels.empty() ? depthFbo : mLevels.back();
+	pending.mReadback = readFbo.readDepthAsync( readFbo.getBounds() );
+	pending.mViewProjection = camera.getProjectionMatrix() * camera.getModelViewMatrix();
+	mPendingReadbacks.push_back( pending );
+
+	while( mPendingReadbacks.size() > (size_t)mFormat.getLatency() ) {
+		const PendingReadback &oldest = mPendingReadbacks.front();
+		mDepthPyramid.set( oldest.mReadback.getChannel(), oldest.mViewProjection );
+		mPendingReadbacks.pop_front();
+	}
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
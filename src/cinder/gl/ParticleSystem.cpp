@@ -0,0 +1,366 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/ParticleSystem.h"
+#include "cinder/gl/StateCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// Run over every particle with rasterization discarded, writing the next state of each through transform feedback. Particles whose offset from
+// emitStart falls below an emitter's cumulative count are respawned by that emitter; the rest are integrated if alive and left as they are if not.
+const char *sUpdateVertexShader =
+	"#version 120\n"
+	"#extension GL_EXT_gpu_shader4 : require\n"
+	"#define MAX_EMITTERS 8\n"
+	"#define MAX_ATTRACTORS 8\n"
+	"attribute vec4 positionAge;\n"
+	"attribute vec4 velocityLife;\n"
+	"varying vec4 outPositionAge;\n"
+	"varying vec4 outVelocityLife;\n"
+	"uniform float deltaSeconds;\n"
+	"uniform float seed;\n"
+	"uniform int numParticles;\n"
+	"uniform int emitStart;\n"
+	"uniform int numEmitters;\n"
+	"uniform int emitEnd[MAX_EMITTERS];\n"
+	"uniform vec4 emitPositionRadius[MAX_EMITTERS];\n"
+	"uniform vec4 emitVelocitySpread[MAX_EMITTERS];\n"
+	"uniform vec2 emitLifetime[MAX_EMITTERS];\n"
+	"uniform int numAttractors;\n"
+	"uniform vec4 attractors[MAX_ATTRACTORS];\n"
+	"uniform vec3 gravity;\n"
+	"uniform float drag;\n"
+	"uniform bool collide;\n"
+	"uniform sampler2D heightfield;\n"
+	"uniform vec4 heightfieldBounds;\n"
+	"uniform vec2 heightfieldTexelSize;\n"
+	"uniform vec2 heightScaleOffset;\n"
+	"uniform vec2 restitutionFriction;\n"
+	"float random( float n ) {\n"
+	"	vec3 p = vec3( float( gl_VertexID / 4096 ), float( gl_VertexID - ( gl_VertexID / 4096 ) * 4096 ), seed + n );\n"
+	"	return fract( sin( dot( p, vec3( 12.9898, 78.233, 37.719 ) ) ) * 43758.5453 );\n"
+	"}\n"
+	"vec3 randomInSphere( float n ) {\n"
+	"	float z = random( n ) * 2.0 - 1.0;\n"
+	"	float a = random( n + 1.0 ) * 6.2831853;\n"
+	"	float r = pow( random( n + 2.0 ), 1.0 / 3.0 );\n"
+	"	return r * vec3( sqrt( 1.0 - z * z ) * vec2( cos( a ), sin( a ) ), z );\n"
+	"}\n"
+	"float heightAt( vec2 uv ) {\n"
+	"	return texture2DLod( heightfield, uv, 0.0 ).r * heightScaleOffset.x + heightScaleOffset.y;\n"
+	"}\n"
+	"void main() {\n"
+	"	vec3 position = positionAge.xyz;\n"
+	"	float age = positionAge.w;\n"
+	"	vec3 velocity = velocityLife.xyz;\n"
+	"	float lifetime = velocityLife.w;\n"
+	"	int offset = gl_VertexID - emitStart;\n"
+	"	if( offset < 0 )\n"
+	"		offset += numParticles;\n"
+	"	int emitter = -1;\n"
+	"	for( int e = 0; e < MAX_EMITTERS; ++e ) {\n"
+	"		if( e < numEmitters && offset < emitEnd[e] ) {\n"
+	"			emitter = e;\n"
+	"			break;\n"
+	"		}\n"
+	"	}\n"
+	"	if( emitter >= 0 ) {\n"
+	"		position = emitPositionRadius[emitter].xyz + randomInSphere( 0.0 ) * emitPositionRadius[emitter].w;\n"
+	"		velocity = emitVelocitySpread[emitter].xyz + randomInSphere( 3.0 ) * emitVelocitySpread[emitter].w;\n"
+	"		lifetime = mix( emitLifetime[emitter].x, emitLifetime[emitter].y, random( 6.0 ) );\n"
+	"		age = 0.0;\n"
+	"	}\n"
+	"	else if( age < lifetime ) {\n"
+	"		vec3 acceleration = gravity;\n"
+	"		for( int a = 0; a < MAX_ATTRACTORS; ++a ) {\n"
+	"			if( a < numAttractors ) {\n"
+	"				vec3 delta = attractors[a].xyz - position;\n"
+	"				float distSq = dot( delta, delta ) + 0.01;\n"
+	"				acceleration += delta * ( inversesqrt( distSq ) * attractors[a].w / distSq );\n"
+	"			}\n"
+	"		}\n"
+	"		velocity = ( velocity + acceleration * deltaSeconds ) * max( 1.0 - drag * deltaSeconds, 0.0 );\n"
+	"		position += velocity * deltaSeconds;\n"
+	"		age += deltaSeconds;\n"
+	"		if( collide ) {\n"
+	"			vec2 uv = ( position.xz - heightfieldBounds.xy ) / ( heightfieldBounds.zw - heightfieldBounds.xy );\n"
+	"			if( all( greaterThanEqual( uv, vec2( 0.0 ) ) ) && all( lessThanEqual( uv, vec2( 1.0 ) ) ) ) {\n"
+	"				float height = heightAt( uv );\n"
+	"				if( position.y < height ) {\n"
+	"					vec2 texelWorld = heightfieldTexelSize * ( heightfieldBounds.zw - heightfieldBounds.xy );\n"
+	"					float dx = heightAt( uv + vec2( heightfieldTexelSize.x, 0.0 ) ) - heightAt( uv - vec2( heightfieldTexelSize.x, 0.0 ) );\n"
+	"					float dz = heightAt( uv + vec2( 0.0, heightfieldTexelSize.y ) ) - heightAt( uv - vec2( 0.0, heightfieldTexelSize.y ) );\n"
+	"					vec3 normal = normalize( vec3( -dx / ( 2.0 * texelWorld.x ), 1.0, -dz / ( 2.0 * texelWorld.y ) ) );\n"
+	"					position.y = height;\n"
+	"					float normalSpeed = dot( velocity, normal );\n"
+	"					if( normalSpeed < 0.0 ) {\n"
+	"						vec3 tangential = velocity - normalSpeed * normal;\n"
+	"						velocity = tangential * ( 1.0 - restitutionFriction.y ) - normalSpeed * restitutionFriction.x * normal;\n"
+	"					}\n"
+	"				}\n"
+	"			}\n"
+	"		}\n"
+	"	}\n"
+	"	outPositionAge = vec4( position, age );\n"
+	"	outVelocityLife = vec4( velocity, lifetime );\n"
+	"}\n";
+
+// gl_Vertex holds a corner of a unit quad, which is offset from the particle in eye space so it faces the camera. Dead particles collapse to a point.
+const char *sDrawVertexShader =
+	"attribute vec4 positionAge;\n"
+	"attribute vec4 velocityLife;\n"
+	"uniform float particleSize;\n"
+	"uniform vec4 startColor;\n"
+	"uniform vec4 endColor;\n"
+	"varying vec4 vColor;\n"
+	"varying vec2 vLocal;\n"
+	"void main() {\n"
+	"	float t = ( velocityLife.w > 0.0 ) ? positionAge.w / velocityLife.w : 1.0;\n"
+	"	float alive = ( t < 1.0 ) ? 1.0 : 0.0;\n"
+	"	vec4 eyePosition = gl_ModelViewMatrix * vec4( positionAge.xyz, 1.0 );\n"
+	"	eyePosition.xy += gl_Vertex.xy * ( particleSize * alive );\n"
+	"	gl_Position = gl_ProjectionMatrix * eyePosition;\n"
+	"	vColor = mix( startColor, endColor, clamp( t, 0.0, 1.0 ) );\n"
+	"	vLocal = gl_Vertex.xy * 2.0;\n"
+	"}\n";
+
+// A round sprite, fading towards its edge
+const char *sDrawFragmentShader =
+	"varying vec4 vColor;\n"
+	"varying vec2 vLocal;\n"
+	"void main() {\n"
+	"	float distSq = dot( vLocal, vLocal );\n"
+	"	if( distSq > 1.0 )\n"
+	"		discard;\n"
+	"	gl_FragColor = vec4( vColor.rgb, vColor.a * ( 1.0 - distSq ) );\n"
+	"}\n";
+
+// A GlslProg whose vertex shader output is captured with transform feedback, which needs the varyings named before the program is linked
+class TransformFeedbackProg : public GlslProg {
+  public:
+	TransformFeedbackProg( const char *vertexShader, const char **varyings, GLsizei numVaryings )
+	{
+		mObj = shared_ptr<Obj>( new Obj );
+		mObj->mHandle = glCreateProgram();
+		loadShader( vertexShader, GL_VERTEX_SHADER_ARB );
+		glTransformFeedbackVaryingsEXT( mObj->mHandle, numVaryings, varyings, GL_INTERLEAVED_ATTRIBS_EXT );
+		link();
+	}
+};
+
+GlslProg& getUpdateShader()
+{
+	static GlslProg sShader;
+	if( ! sShader ) {
+		const char *varyings[2] = { "outPositionAge", "outVelocityLife" };
+		sShader = TransformFeedbackProg( sUpdateVertexShader, varyings, 2 );
+	}
+	return sShader;
+}
+
+GlslProg& getDrawShader()
+{
+	static GlslProg sShader;
+	if( ! sShader )
+		sShader = GlslProg( sDrawVertexShader, sDrawFragmentShader );
+	return sShader;
+}
+
+} // anonymous namespace
+
+ParticleSystem::ParticleSystem( size_t maxParticles )
+	: mMaxParticles( std::max<size_t>( maxParticles, 1 ) ), mCurrent( 0 ), mEmitStart( 0 ), mSeed( 0 ), mGravity( Vec3f::zero() ), mDrag( 0 ),
+	mHeightScale( 1 ), mHeightOffset( 0 ), mRestitution( 0.5f ), mFriction( 0.1f ), mParticleSize( 1 ), mStartColor( 1, 1, 1, 1 ), mEndColor( 1, 1, 1, 0 )
+{
+	if( ! isSupported() )
+		throw ParticleSystemExc();
+
+	mUpdateShader = getUpdateShader();
+	mDrawShader = getDrawShader();
+	mPositionAgeLocation = mUpdateShader.getAttribLocation( "positionAge" );
+	mVelocityLifeLocation = mUpdateShader.getAttribLocation( "velocityLife" );
+
+	TriMesh2d quad;
+	quad.appendVertex( Vec2f( -0.5f, -0.5f ) );
+	quad.appendVertex( Vec2f( 0.5f, -0.5f ) );
+	quad.appendVertex( Vec2f( 0.5f, 0.5f ) );
+	quad.appendVertex( Vec2f( -0.5f, 0.5f ) );
+	quad.appendTriangle( 0, 1, 2 );
+	quad.appendTriangle( 0, 2, 3 );
+
+	// the instance attributes are positionAge and velocityLife, interleaved; zeroed particles have a lifetime of 0 and so start out dead
+	VboMesh::Layout layout;
+	layout.setStaticIndices();
+	layout.setStaticPositions();
+	layout.addInstanceCustomVec4f();
+	layout.addInstanceCustomVec4f();
+	const vector<Vec4f> dead( mMaxParticles * 2, Vec4f::zero() );
+	for( int m = 0; m < 2; ++m ) {
+		mMeshes[m] = VboMesh::create( quad, layout );
+		mMeshes[m]->bufferInstanceData( &dead[0], mMaxParticles );
+		bindInstanceLocations( *mMeshes[m], mDrawShader );
+	}
+}
+
+bool ParticleSystem::isSupported()
+{
+#if defined( CINDER_MSW )
+	return ( GLEE_EXT_transform_feedback != 0 ) && ( GLEE_EXT_gpu_shader4 != 0 ) && VboMesh::isInstancingSupported();
+#else
+	return gl::isExtensionAvailable( "GL_EXT_transform_feedback" ) && gl::isExtensionAvailable( "GL_EXT_gpu_shader4" ) && VboMesh::isInstancingSupported();
+#endif
+}
+
+void ParticleSystem::setHeightfield( const Texture &heightfield, const Rectf &boundsXZ, float heightScale, float heightOffset )
+{
+	mHeightfield = heightfield;
+	mHeightfieldBounds = boundsXZ;
+	mHeightScale = heightScale;
+	mHeightOffset = heightOffset;
+}
+
+void ParticleSystem::bindInstanceLocations( VboMesh &mesh, GlslProg &shader )
+{
+	mesh.setCustomInstanceLocation( 0, shader.getAttribLocation( "positionAge" ) );
+	mesh.setCustomInstanceLocation( 1, shader.getAttribLocation( "velocityLife" ) );
+}
+
+void ParticleSystem::update( float deltaSeconds )
+{
+	// hand out this frame's spawns as consecutive ranges of the ring, in emitter order
+	const int numEmitters = (int)std::min<size_t>( mEmitters.size(), MAX_EMITTERS );
+	int emitEnd[MAX_EMITTERS];
+	Vec4f emitPositionRadius[MAX_EMITTERS], emitVelocitySpread[MAX_EMITTERS];
+	Vec2f emitLifetime[MAX_EMITTERS];
+	size_t numSpawned = 0;
+	for( int e = 0; e < numEmitters; ++e ) {
+		const Emitter &emitter = mEmitters[e];
+		float spawn = emitter.mRate * deltaSeconds + mEmitterRemainders[e];
+		const size_t count = std::min<size_t>( (size_t)std::max( spawn, 0.0f ), mMaxParticles - numSpawned );
+		mEmitterRemainders[e] = std::max( spawn - (float)count, 0.0f );
+		numSpawned += count;
+		emitEnd[e] = (int)numSpawned;
+		emitPositionRadius[e] = Vec4f( emitter.mPosition, emitter.mRadius );
+		emitVelocitySpread[e] = Vec4f( emitter.mVelocity, emitter.mVelocitySpread );
+		emitLifetime[e] = Vec2f( emitter.mLifetimeMin, emitter.mLifetimeMax );
+	}
+
+	const int numAttractors = (int)std::min<size_t>( mAttractors.size(), MAX_ATTRACTORS );
+	Vec4f attractors[MAX_ATTRACTORS];
+	for( int a = 0; a < numAttractors; ++a )
+		attractors[a] = Vec4f( mAttractors[a].mPosition, mAttractors[a].mStrength );
+
+	mUpdateShader.bind();
+	mUpdateShader.uniform( "deltaSeconds", deltaSeconds );
+	mUpdateShader.uniform( "seed", mSeed );
+	mUpdateShader.uniform( "numParticles", (int)mMaxParticles );
+	mUpdateShader.uniform( "emitStart", (int)mEmitStart );
+	mUpdateShader.uniform( "numEmitters", numEmitters );
+	if( numEmitters > 0 ) {
+		mUpdateShader.uniform( "emitEnd", emitEnd, numEmitters );
+		mUpdateShader.uniform( "emitPositionRadius", emitPositionRadius, numEmitters );
+		mUpdateShader.uniform( "emitVelocitySpread", emitVelocitySpread, numEmitters );
+		mUpdateShader.uniform( "emitLifetime", emitLifetime, numEmitters );
+	}
+	mUpdateShader.uniform( "numAttractors", numAttractors );
+	if( numAttractors > 0 )
+		mUpdateShader.uniform( "attractors", attractors, numAttractors );
+	mUpdateShader.uniform( "gravity", mGravity );
+	mUpdateShader.uniform( "drag", mDrag );
+	mUpdateShader.uniform( "collide", mHeightfield ? 1 : 0 );
+	if( mHeightfield ) {
+		mHeightfield.bind( 0 );
+		mUpdateShader.uniform( "heightfield", 0 );
+		mUpdateShader.uniform( "heightfieldBounds", Vec4f( mHeightfieldBounds.x1, mHeightfieldBounds.y1, mHeightfieldBounds.x2, mHeightfieldBounds.y2 ) );
+		mUpdateShader.uniform( "heightfieldTexelSize", Vec2f( 1.0f / mHeightfield.getWidth(), 1.0f / mHeightfield.getHeight() ) );
+		mUpdateShader.uniform( "heightScaleOffset", Vec2f( mHeightScale, mHeightOffset ) );
+		mUpdateShader.uniform( "restitutionFriction", Vec2f( mRestitution, mFriction ) );
+	}
+
+	const Vbo &source = mMeshes[mCurrent]->getInstanceVbo();
+	const Vbo &destination = mMeshes[1 - mCurrent]->getInstanceVbo();
+	const GLsizei stride = sizeof(Vec4f) * 2;
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, source.getId() );
+	glEnableVertexAttribArray( mPositionAgeLocation );
+	glVertexAttribPointer( mPositionAgeLocation, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)0 );
+	glEnableVertexAttribArray( mVelocityLifeLocation );
+	glVertexAttribPointer( mVelocityLifeLocation, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)sizeof(Vec4f) );
+
+	glEnable( GL_RASTERIZER_DISCARD_EXT );
+	glBindBufferBaseEXT( GL_TRANSFORM_FEEDBACK_BUFFER_EXT, 0, destination.getId() );
+	glBeginTransformFeedbackEXT( GL_POINTS );
+	glDrawArrays( GL_POINTS, 0, (GLsizei)mMaxParticles );
+	glEndTransformFeedbackEXT();
+	glBindBufferBaseEXT( GL_TRANSFORM_FEEDBACK_BUFFER_EXT, 0, 0 );
+	glDisable( GL_RASTERIZER_DISCARD_EXT );
+
+	glDisableVertexAttribArray( mPositionAgeLocation );
+	glDisableVertexAttribArray( mVelocityLifeLocation );
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, 0 );
+	if( mHeightfield )
+		mHeightfield.unbind( 0 );
+	GlslProg::unbind();
+
+	mCurrent = 1 - mCurrent;
+	mEmitStart = ( mEmitStart + numSpawned ) % mMaxParticles;
+	mSeed = fmod( mSeed + 1.618034f, 1000.0f );
+}
+
+void ParticleSystem::reset()
+{
+	const vector<Vec4f> dead( mMaxParticles * 2, Vec4f::zero() );
+	mMeshes[mCurrent]->getInstanceVbo().bufferSubData( 0, sizeof(Vec4f) * dead.size(), &dead[0] );
+	mEmitStart = 0;
+	std::fill( mEmitterRemainders.begin(), mEmitterRemainders.end(), 0.0f );
+}
+
+void ParticleSystem::draw()
+{
+	mDrawShader.bind();
+	mDrawShader.uniform( "particleSize", mParticleSize );
+	mDrawShader.uniform( "startColor", mStartColor );
+	mDrawShader.uniform( "endColor", mEndColor );
+	drawInstanced( mMeshes[mCurrent], mMaxParticles );
+	GlslProg::unbind();
+}
+
+void ParticleSystem::draw( GlslProg &shader )
+{
+	bindInstanceLocations( *mMeshes[mCurrent], shader );
+	drawInstanced( mMeshes[mCurrent], mMaxParticles );
+	bindInstanceLocations( *mMeshes[mCurrent], mDrawShader );
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
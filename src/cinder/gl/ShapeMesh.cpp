@@ -0,0 +1,271 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/ShapeMesh.h"
+
+#if ! defined( CINDER_GLES )
+
+#include <list>
+#include <unordered_map>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+inline uint64_t hashBytes( uint64_t hash, const void *data, size_t size )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( data );
+	for( size_t b = 0; b < size; ++b )
+		hash = ( hash ^ bytes[b] ) * FNV_PRIME;
+	return hash;
+}
+
+// Hashes the contours as TriangulatorCache::calcHash() hashes a Shape2d's
+uint64_t hashContours( const Path2d *contours, size_t numContours, float approximationScale, Triangulator::Winding winding )
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	int32_t windingValue = (int32_t)winding;
+	hash = hashBytes( hash, &windingValue, sizeof(windingValue) );
+	hash = hashBytes( hash, &approximationScale, sizeof(approximationScale) );
+
+	for( size_t c = 0; c < numContours; ++c ) {
+		// the segment count separates contours, so that points can't shift between them without changing the hash
+		uint32_t numSegments = (uint32_t)contours[c].getNumSegments();
+		hash = hashBytes( hash, &numSegments, sizeof(numSegments) );
+		for( size_t s = 0; s < numSegments; ++s ) {
+			uint8_t segmentType = (uint8_t)contours[c].getSegmentType( s );
+			hash = hashBytes( hash, &segmentType, sizeof(segmentType) );
+		}
+		const vector<Vec2f> &points = contours[c].getPoints();
+		if( ! points.empty() )
+			hash = hashBytes( hash, &points[0], points.size() * sizeof(Vec2f) );
+	}
+
+	return hash;
+}
+
+bool contoursEqual( const vector<Path2d> &a, const Path2d *b, size_t numContoursB )
+{
+	if( a.size() != numContoursB )
+		return false;
+
+	for( size_t c = 0; c < numContoursB; ++c ) {
+		if( a[c].getSegments() != b[c].getSegments() || a[c].getPoints() != b[c].getPoints() )
+			return false;
+	}
+
+	return true;
+}
+
+// A path the cache has seen. Until it is seen a second time only its contours are kept, after which they move into its ShapeMesh.
+struct CacheEntry {
+	const vector<Path2d>&	getContours() const { return mShapeMesh ? mShapeMesh->getContours() : mContours; }
+
+	uint64_t				mHash;
+	vector<Path2d>			mContours;
+	float					mApproximationScale;
+	Triangulator::Winding	mWinding;
+	ShapeMeshRef			mShapeMesh;
+};
+
+typedef list<CacheEntry>	CacheEntryList;
+
+struct Cache {
+	Cache() : mCapacity( 1024 ) {}
+
+	void evict()
+	{
+		while( mEntries.size() > mCapacity ) {
+			mIndex.erase( mEntries.back().mHash );
+			mEntries.pop_back();
+		}
+	}
+
+	CacheEntryList										mEntries; // most recently used first
+	unordered_map<uint64_t,CacheEntryList::iterator>	mIndex;
+	size_t												mCapacity;
+};
+
+Cache& getCache()
+{
+	static Cache sCache;
+	return sCache;
+}
+
+} // anonymous namespace
+
+ShapeMesh::ShapeMesh( const Path2d *contours, size_t numContours, float approximationScale, Triangulator::Winding winding )
+	: mContours( contours, contours + numContours ), mApproximationScale( approximationScale ), mWinding( winding ), mSolidBuilt( false ), mOutlineBuilt( false )
+{
+}
+
+ShapeMeshRef ShapeMesh::create( const Shape2d &shape, float approximationScale, Triangulator::Winding winding )
+{
+	const vector<Path2d> &contours = shape.getContours();
+	return ShapeMeshRef( new ShapeMesh( contours.empty() ? NULL : &contours[0], contours.size(), approximationScale, winding ) );
+}
+
+ShapeMeshRef ShapeMesh::create( const Path2d &path, float approximationScale, Triangulator::Winding winding )
+{
+	return ShapeMeshRef( new ShapeMesh( &path, 1, approximationScale, winding ) );
+}
+
+const VboMeshRef& ShapeMesh::getSolidVboMesh() const
+{
+	if( ! mSolidBuilt ) {
+		Triangulator triangulator;
+		for( vector<Path2d>::const_iterator contourIt = mContours.begin(); contourIt != mContours.end(); ++contourIt )
+			triangulator.addPath( *contourIt, mApproximationScale );
+		TriMesh2d mesh = triangulator.calcMesh( mWinding );
+		if( mesh.getNumIndices() > 0 )
+			mSolidVboMesh = VboMesh::create( mesh );
+		mSolidBuilt = true;
+	}
+
+	return mSolidVboMesh;
+}
+
+const VboMeshRef& ShapeMesh::getOutlineVboMesh() const
+{
+	if( ! mOutlineBuilt ) {
+		// each contour's subdivision is a line strip, stored as GL_LINES so that all of them draw at once
+		vector<Vec3f> positions;
+		vector<uint32_t> indices;
+		for( vector<Path2d>::const_iterator contourIt = mContours.begin(); contourIt != mContours.end(); ++contourIt ) {
+			if( contourIt->getNumSegments() == 0 )
+				continue;
+			const vector<Vec2f> points = contourIt->subdivide( mApproximationScale );
+			const uint32_t first = (uint32_t)positions.size();
+			for( size_t p = 0; p < points.size(); ++p ) {
+				positions.push_back( Vec3f( points[p].x, points[p].y, 0 ) );
+				if( p > 0 ) {
+					indices.push_back( first + (uint32_t)p - 1 );
+					indices.push_back( first + (uint32_t)p );
+				}
+			}
+		}
+
+		if( ! indices.empty() ) {
+			VboMesh::Layout layout;
+			layout.setStaticIndices();
+			layout.setStaticPositions();
+			mOutlineVboMesh = VboMesh::create( positions.size(), indices.size(), layout, GL_LINES );
+			mOutlineVboMesh->bufferIndices( indices );
+			mOutlineVboMesh->bufferPositions( positions );
+		}
+		mOutlineBuilt = true;
+	}
+
+	return mOutlineVboMesh;
+}
+
+void ShapeMesh::drawSolid() const
+{
+	if( getSolidVboMesh() )
+		gl::draw( mSolidVboMesh );
+}
+
+void ShapeMesh::draw() const
+{
+	if( getOutlineVboMesh() )
+		gl::draw( mOutlineVboMesh );
+}
+
+ShapeMeshRef ShapeMesh::findCached( const Path2d *contours, size_t numContours, float approximationScale, Triangulator::Winding winding )
+{
+	Cache &cache = getCache();
+	const uint64_t hash = hashContours( contours, numContours, approximationScale, winding );
+
+	unordered_map<uint64_t,CacheEntryList::iterator>::iterator indexIt = cache.mIndex.find( hash );
+	if( indexIt != cache.mIndex.end() ) {
+		CacheEntry &entry = *indexIt->second;
+		if( entry.mApproximationScale == approximationScale && entry.mWinding == winding && contoursEqual( entry.getContours(), contours, numContours ) ) {
+			cache.mEntries.splice( cache.mEntries.begin(), cache.mEntries, indexIt->second );
+			if( ! entry.mShapeMesh ) { // seen for the second time
+				entry.mShapeMesh = ShapeMeshRef( new ShapeMesh( contours, numContours, approximationScale, winding ) );
+				vector<Path2d>().swap( entry.mContours );
+			}
+			return entry.mShapeMesh;
+		}
+
+		// a different path with the same hash is replaced
+		cache.mEntries.erase( indexIt->second );
+		cache.mIndex.erase( indexIt );
+	}
+
+	CacheEntry entry;
+	entry.mHash = hash;
+	entry.mContours.assign( contours, contours + numContours );
+	entry.mApproximationScale = approximationScale;
+	entry.mWinding = winding;
+	cache.mEntries.push_front( entry );
+	cache.mIndex[hash] = cache.mEntries.begin();
+	cache.evict();
+
+	return ShapeMeshRef();
+}
+
+ShapeMeshRef ShapeMesh::findCached( const Shape2d &shape, float approximationScale, Triangulator::Winding winding )
+{
+	const vector<Path2d> &contours = shape.getContours();
+	return findCached( contours.empty() ? NULL : &contours[0], contours.size(), approximationScale, winding );
+}
+
+ShapeMeshRef ShapeMesh::findCached( const Path2d &path, float approximationScale, Triangulator::Winding winding )
+{
+	return findCached( &path, 1, approximationScale, winding );
+}
+
+size_t ShapeMesh::getCacheSize()
+{
+	return getCache().mEntries.size();
+}
+
+size_t ShapeMesh::getCacheCapacity()
+{
+	return getCache().mCapacity;
+}
+
+void ShapeMesh::setCacheCapacity( size_t capacity )
+{
+	Cache &cache = getCache();
+	cache.mCapacity = capacity;
+	cache.evict();
+}
+
+void ShapeMesh::clearCache()
+{
+	Cache &cache = getCache();
+	cache.mEntries.clear();
+	cache.mIndex.clear();
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
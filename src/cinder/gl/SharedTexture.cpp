@@ -0,0 +1,680 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/SharedTexture.h"
+#include "cinder/gl/StateCache.h"
+
+#include <atomic>
+#include <cstdio>
+
+#if defined( CINDER_MAC )
+	#include <IOSurface/IOSurface.h>
+	#include <OpenGL/OpenGL.h>
+	#include <OpenGL/CGLIOSurface.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#elif defined( CINDER_MSW )
+	#include "cinder/msw/CinderMsw.h"
+	#include "cinder/msw/DxInterop.h"
+	#include <d3d11.h>
+	#pragma comment( lib, "d3d11.lib" )
+#endif
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+#if defined( CINDER_MAC ) || defined( CINDER_MSW )
+
+namespace {
+
+const uint32_t SHARED_TEXTURE_MAGIC = 0x43695354; // 'CiST'
+
+// The block of shared memory that a sender advertises its texture in. mGeneration is odd while the sender is replacing the texture.
+struct SharedTextureInfo {
+	uint32_t				mMagic;
+	std::atomic<uint32_t>	mSending;
+	std::atomic<uint32_t>	mGeneration;
+	std::atomic<uint32_t>	mFrameNumber;
+	uint32_t				mWidth, mHeight;
+	uint64_t				mHandle;		// the IOSurfaceID on OS X, the shared HANDLE on Windows
+};
+
+// names are hashed, since OS X limits POSIX shared memory names to 31 characters
+string getSharedMemoryName( const string &name )
+{
+	uint64_t hash = 14695981039346656037ULL; // FNV-1a
+	for( string::const_iterator it = name.begin(); it != name.end(); ++it ) {
+		hash ^= (uint8_t)*it;
+		hash *= 1099511628211ULL;
+	}
+
+	char result[64];
+#if defined( CINDER_MAC )
+	snprintf( result, sizeof( result ), "/cinder.st.%016llx", (unsigned long long)hash );
+#else
+	_snprintf_s( result, sizeof( result ), _TRUNCATE, "Local\\cinder.st.%016llx", (unsigned long long)hash );
+#endif
+	return result;
+}
+
+// Maps the SharedTextureInfo of a sender, read-write for the sender which creates it and read-only for receivers
+class SharedInfoMapping {
+  public:
+	SharedInfoMapping() : mInfo( NULL ), mCreated( false )
+#if defined( CINDER_MSW )
+		, mMapping( NULL )
+#endif
+	{}
+	~SharedInfoMapping()		{ close(); }
+
+	bool	open( const string &name, bool create );
+	void	close();
+
+	SharedTextureInfo*	get() const		{ return mInfo; }
+
+  private:
+	SharedTextureInfo	*mInfo;
+	string				mName;
+	bool				mCreated;
+#if defined( CINDER_MSW )
+	::HANDLE			mMapping;
+#endif
+};
+
+bool SharedInfoMapping::open( const string &name, bool create )
+{
+	close();
+
+	mName = getSharedMemoryName( name );
+	mCreated = create;
+#if defined( CINDER_MAC )
+	int fd = ::shm_open( mName.c_str(), create ? ( O_CREAT | O_RDWR ) : O_RDONLY, 0666 );
+	if( fd == -1 )
+		return false;
+
+	// a sender that exited without closing leaves the memory sized, which ftruncate() refuses to change
+	struct stat status;
+	if( create && ( ::fstat( fd, &status ) == 0 ) && ( status.st_size < (off_t)sizeof( SharedTextureInfo ) ) )
+		::ftruncate( fd, sizeof( SharedTextureInfo ) );
+	if( ( ::fstat( fd, &status ) != 0 ) || ( status.st_size < (off_t)sizeof( SharedTextureInfo ) ) ) {
+		::close( fd );
+		return false;
+	}
+
+	void *data = ::mmap( NULL, sizeof( SharedTextureInfo ), create ? ( PROT_READ | PROT_WRITE ) : PROT_READ, MAP_SHARED, fd, 0 );
+	::close( fd );
+	if( data == MAP_FAILED )
+		return false;
+#else
+	if( create )
+		mMapping = ::CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof( SharedTextureInfo ), mName.c_str() );
+	else
+		mMapping = ::OpenFileMappingA( FILE_MAP_READ, FALSE, mName.c_str() );
+	if( ! mMapping )
+		return false;
+
+	void *data = ::MapViewOfFile( mMapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, sizeof( SharedTextureInfo ) );
+	if( ! data ) {
+		::CloseHandle( mMapping );
+		mMapping = NULL;
+		return false;
+	}
+#endif
+
+	mInfo = reinterpret_cast<SharedTextureInfo*>( data );
+	return true;
+}
+
+void SharedInfoMapping::close()
+{
+	if( ! mInfo )
+		return;
+
+	if( mCreated )
+		mInfo->mSending = 0;
+
+#if defined( CINDER_MAC )
+	::munmap( mInfo, sizeof( SharedTextureInfo ) );
+	// receivers keep their mapping, see mSending go to 0 and look up the name again
+	if( mCreated )
+		::shm_unlink( mName.c_str() );
+#else
+	::UnmapViewOfFile( mInfo );
+	::CloseHandle( mMapping );
+	mMapping = NULL;
+#endif
+	mInfo = NULL;
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SharedTextureSender::Impl
+
+struct SharedTextureSender::Impl {
+	Impl();
+	~Impl();
+
+	//! Replaces the shared texture and returns the handle receivers open it with
+	uint64_t	createSurface( int width, int height );
+	void		destroySurface();
+	//! Brackets the rendering into mTexture
+	void		beginWrite();
+	void		endWrite();
+
+	SharedInfoMapping	mMapping;
+	GLuint				mFramebuffer, mReadFramebuffer;
+	Texture				mTexture;		// aliases the shared surface
+	uint32_t			mFrameNumber;
+
+#if defined( CINDER_MAC )
+	IOSurfaceRef		mSurface;
+#else
+	std::unique_ptr<ID3D11Device, msw::ComDeleter>		mDevice;
+	std::unique_ptr<ID3D11Texture2D, msw::ComDeleter>	mSurface;
+	::HANDLE			mInteropDevice, mInteropTexture;
+#endif
+};
+
+SharedTextureSender::Impl::Impl()
+	: mFramebuffer( 0 ), mReadFramebuffer( 0 ), mFrameNumber( 0 )
+{
+#if defined( CINDER_MAC )
+	mSurface = NULL;
+#else
+	mInteropDevice = mInteropTexture = NULL;
+
+	const msw::DxInterop *interop = msw::getDxInterop();
+	if( ! interop )
+		throw SharedTextureExc( "SharedTextureSender requires WGL_NV_DX_interop" );
+
+	const D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0, D3D_FEATURE_LEVEL_9_3 };
+	ID3D11Device *device = NULL;
+	if( FAILED( ::D3D11CreateDevice( NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+			featureLevels, sizeof( featureLevels ) / sizeof( featureLevels[0] ), D3D11_SDK_VERSION, &device, NULL, NULL ) ) )
+		throw SharedTextureExc( "Failed to create Direct3D 11 device" );
+	mDevice = msw::makeComUnique( device );
+
+	mInteropDevice = interop->openDevice( device );
+	if( ! mInteropDevice )
+		throw SharedTextureExc( "Failed to open Direct3D 11 device for OpenGL interop" );
+#endif
+
+	glGenFramebuffersEXT( 1, &mFramebuffer );
+	glGenFramebuffersEXT( 1, &mReadFramebuffer );
+}
+
+SharedTextureSender::Impl::~Impl()
+{
+	mMapping.close();
+	destroySurface();
+
+	if( mFramebuffer ) {
+		glDeleteFramebuffersEXT( 1, &mFramebuffer );
+		StateCache::framebufferDeleted( mFramebuffer );
+	}
+	if( mReadFramebuffer ) {
+		glDeleteFramebuffersEXT( 1, &mReadFramebuffer );
+		StateCache::framebufferDeleted( mReadFramebuffer );
+	}
+
+#if defined( CINDER_MSW )
+	if( mInteropDevice )
+		msw::getDxInterop()->closeDevice( mInteropDevice );
+#endif
+}
+
+uint64_t SharedTextureSender::Impl::createSurface( int width, int height )
+{
+	GLuint textureId;
+	glGenTextures( 1, &textureId );
+
+#if defined( CINDER_MAC )
+	CFMutableDictionaryRef properties = ::CFDictionaryCreateMutable( kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+	const int32_t bytesPerElement = 4, pixelFormat = 'BGRA';
+	CFNumberRef widthNumber = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &width );
+	CFNumberRef heightNumber = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &height );
+	CFNumberRef bytesPerElementNumber = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &bytesPerElement );
+	CFNumberRef pixelFormatNumber = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &pixelFormat );
+	::CFDictionarySetValue( properties, kIOSurfaceWidth, widthNumber );
+	::CFDictionarySetValue( properties, kIOSurfaceHeight, heightNumber );
+	::CFDictionarySetValue( properties, kIOSurfaceBytesPerElement, bytesPerElementNumber );
+	::CFDictionarySetValue( properties, kIOSurfacePixelFormat, pixelFormatNumber );
+	// global surfaces can be looked up by ID from any process
+	::CFDictionarySetValue( properties, kIOSurfaceIsGlobal, kCFBooleanTrue );
+	mSurface = ::IOSurfaceCreate( properties );
+	::CFRelease( widthNumber );
+	::CFRelease( heightNumber );
+	::CFRelease( bytesPerElementNumber );
+	::CFRelease( pixelFormatNumber );
+	::CFRelease( properties );
+	if( ! mSurface ) {
+		glDeleteTextures( 1, &textureId );
+		throw SharedTextureExc( "Failed to create IOSurface" );
+	}
+
+	StateCache::bindTexture( GL_TEXTURE_RECTANGLE_ARB, textureId );
+	CGLError error = ::CGLTexImageIOSurface2D( ::CGLGetCurrentContext(), GL_TEXTURE_RECTANGLE_ARB, GL_RGBA8, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, mSurface, 0 );
+	StateCache::bindTexture( GL_TEXTURE_RECTANGLE_ARB, 0 );
+	if( error != kCGLNoError ) {
+		glDeleteTextures( 1, &textureId );
+		throw SharedTextureExc( "Failed to bind IOSurface to a texture" );
+	}
+	mTexture = Texture( GL_TEXTURE_RECTANGLE_ARB, textureId, width, height, false );
+	const uint64_t handle = ::IOSurfaceGetID( mSurface );
+#else
+	D3D11_TEXTURE2D_DESC desc;
+	::ZeroMemory( &desc, sizeof( desc ) );
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
+
+	ID3D11Texture2D *surface = NULL;
+	if( FAILED( mDevice->CreateTexture2D( &desc, NULL, &surface ) ) ) {
+		glDeleteTextures( 1, &textureId );
+		throw SharedTextureExc( "Failed to create shared Direct3D 11 texture" );
+	}
+	mSurface = msw::makeComUnique( surface );
+
+	::HANDLE sharedHandle = NULL;
+	IDXGIResource *resource = NULL;
+	if( SUCCEEDED( surface->QueryInterface( __uuidof( IDXGIResource ), (void**)&resource ) ) ) {
+		resource->GetSharedHandle( &sharedHandle );
+		resource->Release();
+	}
+
+	mInteropTexture = msw::getDxInterop()->registerObject( mInteropDevice, surface, textureId, GL_TEXTURE_2D, WGL_ACCESS_WRITE_DISCARD_NV );
+	if( ( ! sharedHandle ) || ( ! mInteropTexture ) ) {
+		glDeleteTextures( 1, &textureId );
+		mSurface.reset();
+		throw SharedTextureExc( "Failed to share Direct3D 11 texture with OpenGL" );
+	}
+	mTexture = Texture( GL_TEXTURE_2D, textureId, width, height, false );
+	const uint64_t handle = (uint64_t)(uintptr_t)sharedHandle;
+#endif
+
+	SaveFramebufferBinding saveFboBinding;
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mFramebuffer );
+	glFramebufferTexture2DEXT( GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, mTexture.getTarget(), mTexture.getId(), 0 );
+
+	return handle;
+}
+
+void SharedTextureSender::Impl::destroySurface()
+{
+#if defined( CINDER_MAC )
+	mTexture.reset();
+	if( mSurface ) {
+		::CFRelease( mSurface );
+		mSurface = NULL;
+	}
+#else
+	// the interop has to let go of the texture before it is deleted
+	if( mInteropTexture ) {
+		msw::getDxInterop()->unregisterObject( mInteropDevice, mInteropTexture );
+		mInteropTexture = NULL;
+	}
+	mTexture.reset();
+	mSurface.reset();
+#endif
+}
+
+void SharedTextureSender::Impl::beginWrite()
+{
+#if defined( CINDER_MSW )
+	msw::getDxInterop()->lockObjects( mInteropDevice, 1, &mInteropTexture );
+#endif
+}
+
+void SharedTextureSender::Impl::endWrite()
+{
+#if defined( CINDER_MAC )
+	// submits the blit, so that it lands in the surface before receivers in other processes sample it
+	glFlush();
+#else
+	msw::getDxInterop()->unlockObjects( mInteropDevice, 1, &mInteropTexture );
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SharedTextureSender
+
+SharedTextureSender::SharedTextureSender( const string &name, int width, int height )
+	: mImpl( new Impl ), mName( name )
+{
+	if( ! mImpl->mMapping.open( name, true ) )
+		throw SharedTextureExc( "Failed to create shared memory for SharedTextureSender \"" + name + "\"" );
+
+	SharedTextureInfo *info = mImpl->mMapping.get();
+	info->mMagic = SHARED_TEXTURE_MAGIC;
+	info->mGeneration = info->mGeneration | 1;
+	info->mFrameNumber = 0;
+	setSize( width, height );
+	info->mSending = 1;
+}
+
+SharedTextureSender::~SharedTextureSender()
+{
+}
+
+void SharedTextureSender::setSize( int width, int height )
+{
+	SharedTextureInfo *info = mImpl->mMapping.get();
+
+	// receivers ignore the info while the generation is odd
+	if( ( info->mGeneration & 1 ) == 0 )
+		info->mGeneration++;
+
+	mImpl->destroySurface();
+	const uint64_t handle = mImpl->createSurface( width, height );
+	info->mWidth = width;
+	info->mHeight = height;
+	info->mHandle = handle;
+
+	info->mGeneration++;
+}
+
+int SharedTextureSender::getWidth() const
+{
+	return mImpl->mTexture.getWidth();
+}
+
+int SharedTextureSender::getHeight() const
+{
+	return mImpl->mTexture.getHeight();
+}
+
+uint32_t SharedTextureSender::getFrameNumber() const
+{
+	return mImpl->mFrameNumber;
+}
+
+void SharedTextureSender::publish( const Texture &texture )
+{
+	SaveFramebufferBinding saveFboBinding;
+	mImpl->beginWrite();
+
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mImpl->mReadFramebuffer );
+	glFramebufferTexture2DEXT( GL_READ_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, texture.getTarget(), texture.getId(), 0 );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mImpl->mFramebuffer );
+
+	// the shared texture stores rows top first, so a texture gl::draw() would flip is flipped here as well
+	const int width = getWidth(), height = getHeight();
+	const bool flip = texture.isFlipped();
+	glBlitFramebufferEXT( 0, 0, texture.getWidth(), texture.getHeight(), 0, flip ? height : 0, width, flip ? 0 : height, GL_COLOR_BUFFER_BIT, GL_LINEAR );
+	glFramebufferTexture2DEXT( GL_READ_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, texture.getTarget(), 0, 0 );
+
+	mImpl->endWrite();
+	mImpl->mMapping.get()->mFrameNumber = ++mImpl->mFrameNumber;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SharedTextureReceiver::Impl
+
+struct SharedTextureReceiver::Impl {
+	Impl();
+	~Impl();
+
+	bool	openSurface( uint64_t handle, int width, int height );
+	void	closeSurface();
+	//! Makes the sender's latest frame visible to this context
+	void	acquireFrame();
+
+	SharedInfoMapping	mMapping;
+	uint32_t			mGeneration, mFrameNumber;
+	Texture				mTexture;
+
+#if defined( CINDER_MAC )
+	IOSurfaceRef		mSurface;
+#else
+	std::unique_ptr<ID3D11Device, msw::ComDeleter>		mDevice;
+	std::unique_ptr<ID3D11Texture2D, msw::ComDeleter>	mSurface;
+	::HANDLE			mInteropDevice, mInteropTexture;
+	bool				mInteropLocked;
+#endif
+};
+
+SharedTextureReceiver::Impl::Impl()
+	: mGeneration( 0 ), mFrameNumber( 0 )
+{
+#if defined( CINDER_MAC )
+	mSurface = NULL;
+#else
+	mInteropDevice = mInteropTexture = NULL;
+	mInteropLocked = false;
+
+	const msw::DxInterop *interop = msw::getDxInterop();
+	if( ! interop )
+		throw SharedTextureExc( "SharedTextureReceiver requires WGL_NV_DX_interop" );
+
+	const D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0, D3D_FEATURE_LEVEL_9_3 };
+	ID3D11Device *device = NULL;
+	if( FAILED( ::D3D11CreateDevice( NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+			featureLevels, sizeof( featureLevels ) / sizeof( featureLevels[0] ), D3D11_SDK_VERSION, &device, NULL, NULL ) ) )
+		throw SharedTextureExc( "Failed to create Direct3D 11 device" );
+	mDevice = msw::makeComUnique( device );
+
+	mInteropDevice = interop->openDevice( device );
+	if( ! mInteropDevice )
+		throw SharedTextureExc( "Failed to open Direct3D 11 device for OpenGL interop" );
+#endif
+}
+
+SharedTextureReceiver::Impl::~Impl()
+{
+	closeSurface();
+
+#if defined( CINDER_MSW )
+	if( mInteropDevice )
+		msw::getDxInterop()->closeDevice( mInteropDevice );
+#endif
+}
+
+bool SharedTextureReceiver::Impl::openSurface( uint64_t handle, int width, int height )
+{
+	closeSurface();
+
+	GLuint textureId;
+	glGenTextures( 1, &textureId );
+
+#if defined( CINDER_MAC )
+	mSurface = ::IOSurfaceLookup( (IOSurfaceID)handle );
+	if( ! mSurface ) {
+		glDeleteTextures( 1, &textureId );
+		return false;
+	}
+
+	StateCache::bindTexture( GL_TEXTURE_RECTANGLE_ARB, textureId );
+	CGLError error = ::CGLTexImageIOSurface2D( ::CGLGetCurrentContext(), GL_TEXTURE_RECTANGLE_ARB, GL_RGBA8, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, mSurface, 0 );
+	StateCache::bindTexture( GL_TEXTURE_RECTANGLE_ARB, 0 );
+	if( error != kCGLNoError ) {
+		glDeleteTextures( 1, &textureId );
+		closeSurface();
+		return false;
+	}
+	mTexture = Texture( GL_TEXTURE_RECTANGLE_ARB, textureId, width, height, false );
+#else
+	ID3D11Texture2D *surface = NULL;
+	if( FAILED( mDevice->OpenSharedResource( (::HANDLE)(uintptr_t)handle, __uuidof( ID3D11Texture2D ), (void**)&surface ) ) ) {
+		glDeleteTextures( 1, &textureId );
+		return false;
+	}
+	mSurface = msw::makeComUnique( surface );
+
+	mInteropTexture = msw::getDxInterop()->registerObject( mInteropDevice, surface, textureId, GL_TEXTURE_2D, WGL_ACCESS_READ_ONLY_NV );
+	if( ! mInteropTexture ) {
+		glDeleteTextures( 1, &textureId );
+		closeSurface();
+		return false;
+	}
+	mTexture = Texture( GL_TEXTURE_2D, textureId, width, height, false );
+#endif
+
+	mTexture.setMinFilter( GL_LINEAR );
+	mTexture.setMagFilter( GL_LINEAR );
+	return true;
+}
+
+void SharedTextureReceiver::Impl::closeSurface()
+{
+#if defined( CINDER_MAC )
+	mTexture.reset();
+	if( mSurface ) {
+		::CFRelease( mSurface );
+		mSurface = NULL;
+	}
+#else
+	if( mInteropTexture ) {
+		if( mInteropLocked )
+			msw::getDxInterop()->unlockObjects( mInteropDevice, 1, &mInteropTexture );
+		msw::getDxInterop()->unregisterObject( mInteropDevice, mInteropTexture );
+		mInteropTexture = NULL;
+		mInteropLocked = false;
+	}
+	mTexture.reset();
+	mSurface.reset();
+#endif
+}
+
+void SharedTextureReceiver::Impl::acquireFrame()
+{
+#if defined( CINDER_MSW )
+	// relocking is what synchronizes OpenGL with writes made to the resource elsewhere
+	if( mInteropLocked )
+		msw::getDxInterop()->unlockObjects( mInteropDevice, 1, &mInteropTexture );
+	mInteropLocked = msw::getDxInterop()->lockObjects( mInteropDevice, 1, &mInteropTexture ) != FALSE;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SharedTextureReceiver
+
+SharedTextureReceiver::SharedTextureReceiver( const string &name )
+	: mImpl( new Impl ), mName( name )
+{
+}
+
+SharedTextureReceiver::~SharedTextureReceiver()
+{
+}
+
+bool SharedTextureReceiver::checkNewFrame()
+{
+	SharedTextureInfo *info = mImpl->mMapping.get();
+
+	// a sender that stops leaves its memory behind, a new one under the same name may already be publishing elsewhere
+	if( info && ( ! info->mSending ) ) {
+		mImpl->closeSurface();
+		mImpl->mMapping.close();
+		info = NULL;
+	}
+
+	if( ! info ) {
+		if( ! mImpl->mMapping.open( mName, false ) )
+			return false;
+		info = mImpl->mMapping.get();
+		if( ( info->mMagic != SHARED_TEXTURE_MAGIC ) || ( ! info->mSending ) ) {
+			mImpl->mMapping.close();
+			return false;
+		}
+	}
+
+	const uint32_t generation = info->mGeneration;
+	if( ( generation != mImpl->mGeneration ) || ( ! mImpl->mTexture ) ) {
+		if( generation & 1 )
+			return false; // the sender is replacing its texture
+
+		const uint64_t handle = info->mHandle;
+		const int width = info->mWidth, height = info->mHeight;
+		if( info->mGeneration != generation )
+			return false;
+
+		if( ! mImpl->openSurface( handle, width, height ) )
+			return false;
+		mImpl->mGeneration = generation;
+		mImpl->mFrameNumber = info->mFrameNumber;
+		mImpl->acquireFrame();
+		return true;
+	}
+
+	const uint32_t frameNumber = info->mFrameNumber;
+	if( frameNumber == mImpl->mFrameNumber )
+		return false;
+
+	mImpl->mFrameNumber = frameNumber;
+	mImpl->acquireFrame();
+	return true;
+}
+
+bool SharedTextureReceiver::isConnected() const
+{
+	const SharedTextureInfo *info = mImpl->mMapping.get();
+	return info && info->mSending && mImpl->mTexture;
+}
+
+Texture SharedTextureReceiver::getTexture() const
+{
+	return isConnected() ? mImpl->mTexture : Texture();
+}
+
+#else
+
+struct SharedTextureSender::Impl {};
+struct SharedTextureReceiver::Impl {};
+
+SharedTextureSender::SharedTextureSender( const string &name, int width, int height )
+	: mName( name )
+{
+	throw SharedTextureExc( "SharedTextureSender is not supported on this platform" );
+}
+
+SharedTextureSender::~SharedTextureSender()		{}
+void SharedTextureSender::publish( const Texture &texture )		{}
+void SharedTextureSender::setSize( int width, int height )		{}
+int SharedTextureSender::getWidth() const						{ return 0; }
+int SharedTextureSender::getHeight() const						{ return 0; }
+uint32_t SharedTextureSender::getFrameNumber() const			{ return 0; }
+
+SharedTextureReceiver::SharedTextureReceiver( const string &name )
+	: mName( name )
+{
+	throw SharedTextureExc( "SharedTextureReceiver is not supported on this platform" );
+}
+
+SharedTextureReceiver::~SharedTextureReceiver()	{}
+bool SharedTextureReceiver::checkNewFrame()						{ return false; }
+bool SharedTextureReceiver::isConnected() const					{ return false; }
+Texture SharedTextureReceiver::getTexture() const				{ return Texture(); }
+
+#endif
+
+} } // namespace cinder::gl
@@ -0,0 +1,107 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/SinglePassStereo.h"
+#include "cinder/Camera.h"
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// ciStereoPosition() halves the coordinate along ciStereoAxis and shifts it by half the viewport towards the eye's side. The seam is clipped by plane 0,
+// which begin() specifies as (1, 0, 0, 0) under an identity modelview, so gl_ClipVertex.x is the signed distance inside the eye's own clip volume.
+const char *sGlslFunctions =
+	"#extension GL_ARB_draw_instanced : enable\n"
+	"uniform mat4 ciStereoView[2];\n"
+	"uniform mat4 ciStereoProjection[2];\n"
+	"uniform vec2 ciStereoAxis;\n"
+	"int ciStereoEye() {\n"
+	"	return ( gl_InstanceIDARB - ( gl_InstanceIDARB / 2 ) * 2 );\n"
+	"}\n"
+	"int ciStereoInstance() {\n"
+	"	return gl_InstanceIDARB / 2;\n"
+	"}\n"
+	"mat4 ciStereoModelView() {\n"
+	"	return ciStereoView[ciStereoEye()] * gl_ModelViewMatrix;\n"
+	"}\n"
+	"vec4 ciStereoPosition( vec4 eyePosition ) {\n"
+	"	int eye = ciStereoEye();\n"
+	"	vec4 clip = ciStereoProjection[eye] * eyePosition;\n"
+	"	float side = ( eye == 0 ) ? -1.0 : 1.0;\n"
+	"	float along = dot( clip.xy, ciStereoAxis );\n"
+	"	gl_ClipVertex = vec4( clip.w + side * along, 0.0, 0.0, 1.0 );\n"
+	"	clip.xy += ciStereoAxis * ( 0.5 * ( side * clip.w - along ) );\n"
+	"	return clip;\n"
+	"}\n";
+
+} // anonymous namespace
+
+void SinglePassStereo::begin( const CameraStereo &camera, const Area &viewport )
+{
+	CameraStereo eye( camera );
+	eye.enableStereoLeft();
+	mView[0] = eye.getModelViewMatrix();
+	mProjection[0] = eye.getProjectionMatrix();
+	eye.enableStereoRight();
+	mView[1] = eye.getModelViewMatrix();
+	mProjection[1] = eye.getProjectionMatrix();
+
+	glPushAttrib( GL_VIEWPORT_BIT | GL_TRANSFORM_BIT );
+	setViewport( viewport );
+	pushMatrices();
+	glMatrixMode( GL_PROJECTION );
+	glLoadIdentity();
+	glMatrixMode( GL_MODELVIEW );
+	glLoadIdentity();
+
+	const GLdouble seam[4] = { 1, 0, 0, 0 };
+	glClipPlane( GL_CLIP_PLANE0, seam );
+	glEnable( GL_CLIP_PLANE0 );
+}
+
+void SinglePassStereo::end()
+{
+	popMatrices();
+	glPopAttrib();
+}
+
+void SinglePassStereo::setUniforms( GlslProg &shader ) const
+{
+	shader.uniform( "ciStereoView", mView, 2 );
+	shader.uniform( "ciStereoProjection", mProjection, 2 );
+	shader.uniform( "ciStereoAxis", ( mLayout == SIDE_BY_SIDE ) ? Vec2f( 1, 0 ) : Vec2f( 0, 1 ) );
+}
+
+std::string SinglePassStereo::getGlslFunctions()
+{
+	return sGlslFunctions;
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,291 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/SkinnedMesh.h"
+#include "cinder/gl/StateCache.h"
+
+#include <sstream>
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// Each bone is an affine matrix stored as three rows, fetched with skinRow(). Instance i of an instanced draw uses the i-th palette after firstBone.
+const char *sTextureBufferPalette =
+	"#version 120\n"
+	"#extension GL_EXT_gpu_shader4 : require\n"
+	"#ifdef GL_ARB_draw_instanced\n"
+	"#extension GL_ARB_draw_instanced : enable\n"
+	"#endif\n"
+	"uniform samplerBuffer bonePalette;\n"
+	"uniform int firstBone;\n"
+	"uniform int numBones;\n"
+	"vec4 skinRow( float bone, int row ) {\n"
+	"#ifdef GL_ARB_draw_instanced\n"
+	"	int base = firstBone + gl_InstanceIDARB * numBones;\n"
+	"#else\n"
+	"	int base = firstBone;\n"
+	"#endif\n"
+	"	return texelFetchBuffer( bonePalette, ( base + int( bone ) ) * 3 + row );\n"
+	"}\n";
+
+const char *sUniformPalette =
+	"#version 120\n"
+	"uniform vec4 bonePalette[MAX_BONE_ROWS];\n"
+	"vec4 skinRow( float bone, int row ) {\n"
+	"	return bonePalette[int( bone ) * 3 + row];\n"
+	"}\n";
+
+const char *sSkinningFunctions =
+	"attribute vec4 boneIndices;\n"
+	"attribute vec4 boneWeights;\n"
+	"void skinAddBone( float bone, float weight, inout vec4 row0, inout vec4 row1, inout vec4 row2 ) {\n"
+	"	row0 += skinRow( bone, 0 ) * weight;\n"
+	"	row1 += skinRow( bone, 1 ) * weight;\n"
+	"	row2 += skinRow( bone, 2 ) * weight;\n"
+	"}\n"
+	"void skinMatrix( out vec4 row0, out vec4 row1, out vec4 row2 ) {\n"
+	"	row0 = vec4( 0.0 );\n"
+	"	row1 = vec4( 0.0 );\n"
+	"	row2 = vec4( 0.0 );\n"
+	"	skinAddBone( boneIndices.x, boneWeights.x, row0, row1, row2 );\n"
+	"	skinAddBone( boneIndices.y, boneWeights.y, row0, row1, row2 );\n"
+	"	skinAddBone( boneIndices.z, boneWeights.z, row0, row1, row2 );\n"
+	"	skinAddBone( boneIndices.w, boneWeights.w, row0, row1, row2 );\n"
+	"}\n"
+	"vec4 skinPosition( vec4 position ) {\n"
+	"	vec4 row0, row1, row2;\n"
+	"	skinMatrix( row0, row1, row2 );\n"
+	"	return vec4( dot( row0, position ), dot( row1, position ), dot( row2, position ), position.w );\n"
+	"}\n"
+	"vec3 skinNormal( vec3 normal ) {\n"
+	"	vec4 row0, row1, row2;\n"
+	"	skinMatrix( row0, row1, row2 );\n"
+	"	return normalize( vec3( dot( row0.xyz, normal ), dot( row1.xyz, normal ), dot( row2.xyz, normal ) ) );\n"
+	"}\n";
+
+const char *sDrawVertexShader =
+	"varying vec3 vNormal;\n"
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * skinPosition( gl_Vertex );\n"
+	"	vNormal = gl_NormalMatrix * skinNormal( gl_Normal );\n"
+	"	vColor = gl_Color;\n"
+	"}\n";
+
+// A light at the eye, so the mesh reads without any lighting setup
+const char *sDrawFragmentShader =
+	"varying vec3 vNormal;\n"
+	"varying vec4 vColor;\n"
+	"void main() {\n"
+	"	float diffuse = abs( normalize( vNormal ).z );\n"
+	"	gl_FragColor = vec4( vColor.rgb * ( 0.25 + 0.75 * diffuse ), vColor.a );\n"
+	"}\n";
+
+string buildSkinningGlsl( bool textureBuffer )
+{
+	stringstream ss;
+	if( textureBuffer )
+		ss << sTextureBufferPalette;
+	else
+		ss << "#define MAX_BONE_ROWS " << SkinnedMesh::MAX_UNIFORM_BONES * 3 << "\n" << sUniformPalette;
+	ss << sSkinningFunctions;
+	return ss.str();
+}
+
+GlslProg& getDrawShader( bool textureBuffer )
+{
+	static GlslProg sShaders[2];
+	GlslProg &shader = sShaders[textureBuffer ? 1 : 0];
+	if( ! shader )
+		shader = GlslProg( ( buildSkinningGlsl( textureBuffer ) + sDrawVertexShader ).c_str(), sDrawFragmentShader );
+	return shader;
+}
+
+} // anonymous namespace
+
+SkinnedMesh::SkinnedMesh( const TriMesh &mesh, const std::vector<Vec4f> &boneIndices, const std::vector<Vec4f> &boneWeights, size_t numBones )
+	: mNumBones( numBones ), mNumPalettes( 0 ), mPaletteTexture( 0 ), mPaletteUnit( 8 )
+{
+	const size_t numVertices = mesh.getNumVertices();
+	if( boneIndices.size() != numVertices || boneWeights.size() != numVertices )
+		throw SkinnedMeshExc( "SkinnedMesh: there must be one set of bone indices and weights per vertex" );
+	if( numBones == 0 )
+		throw SkinnedMeshExc( "SkinnedMesh: the palette must hold at least one bone" );
+
+	const bool textureBuffer = isTextureBufferSupported();
+	if( ! textureBuffer && numBones > MAX_UNIFORM_BONES )
+		throw SkinnedMeshExc( "SkinnedMesh: palettes of more than MAX_UNIFORM_BONES bones require texture buffers" );
+
+	// static data is planar, which lets the custom attributes be uploaded whole
+	VboMesh::Layout layout;
+	layout.setStaticIndices();
+	layout.setStaticPositions();
+	if( mesh.hasNormals() )
+		layout.setStaticNormals();
+	if( mesh.hasTexCoords() )
+		layout.setStaticTexCoords2d();
+	if( mesh.hasColorsRGB() )
+		layout.setStaticColorsRGB();
+	else if( mesh.hasColorsRGBA() )
+		layout.setStaticColorsRGBA();
+	layout.addStaticCustomVec4f();
+	layout.addStaticCustomVec4f();
+
+	mVboMesh = VboMesh::create( numVertices, mesh.getNumIndices(), layout, GL_TRIANGLES );
+	mVboMesh->bufferIndices( mesh.getIndices() );
+	mVboMesh->bufferPositions( mesh.getVertices() );
+	if( mesh.hasNormals() )
+		mVboMesh->bufferNormals( mesh.getNormals() );
+	if( mesh.hasTexCoords() )
+		mVboMesh->bufferTexCoords2d( 0, mesh.getTexCoords() );
+	if( mesh.hasColorsRGB() )
+		mVboMesh->bufferColorsRGB( mesh.getColorsRGB() );
+	else if( mesh.hasColorsRGBA() )
+		mVboMesh->bufferColorsRGBA( mesh.getColorsRGBA() );
+	mVboMesh->bufferCustomStatic( 0, &boneIndices[0] );
+	mVboMesh->bufferCustomStatic( 1, &boneWeights[0] );
+	VboMesh::unbindBuffers();
+
+	if( textureBuffer ) {
+		mPaletteBuffer = Vbo( GL_TEXTURE_BUFFER_ARB );
+		glGenTextures( 1, &mPaletteTexture );
+	}
+
+	// start out in the bind pose
+	const vector<Matrix44f> identity( mNumBones, Matrix44f::identity() );
+	setPalettes( &identity[0], 1 );
+	if( textureBuffer ) {
+		StateCache::bindTexture( GL_TEXTURE_BUFFER_ARB, mPaletteTexture );
+		glTexBufferARB( GL_TEXTURE_BUFFER_ARB, GL_RGBA32F_ARB, mPaletteBuffer.getId() );
+		StateCache::bindTexture( GL_TEXTURE_BUFFER_ARB, 0 );
+	}
+
+	mDrawShader = getDrawShader( textureBuffer );
+}
+
+SkinnedMesh::~SkinnedMesh()
+{
+	if( mPaletteTexture ) {
+		glDeleteTextures( 1, &mPaletteTexture );
+		StateCache::textureDeleted( mPaletteTexture );
+	}
+}
+
+bool SkinnedMesh::isTextureBufferSupported()
+{
+#if defined( CINDER_MSW )
+	return ( GLEE_ARB_texture_buffer_object != 0 ) && ( GLEE_EXT_gpu_shader4 != 0 );
+#else
+	return gl::isExtensionAvailable( "GL_ARB_texture_buffer_object" ) && gl::isExtensionAvailable( "GL_EXT_gpu_shader4" );
+#endif
+}
+
+void SkinnedMesh::setPalettes( const Matrix44f *matrices, size_t numPalettes )
+{
+	if( ! usesTextureBuffer() )
+		numPalettes = std::min<size_t>( numPalettes, 1 );
+
+	const size_t numMatrices = mNumBones * numPalettes;
+	mPaletteRows.resize( numMatrices * 3 );
+	for( size_t m = 0; m < numMatrices; ++m ) {
+		const float *c = matrices[m].m; // column-major
+		for( int row = 0; row < 3; ++row )
+			mPaletteRows[m * 3 + row] = Vec4f( c[row], c[4 + row], c[8 + row], c[12 + row] );
+	}
+	mNumPalettes = numPalettes;
+
+	// orphans last frame's storage, which instanced draws may still be reading
+	if( usesTextureBuffer() && numMatrices > 0 ) {
+		mPaletteBuffer.bufferData( sizeof(Vec4f) * mPaletteRows.size(), &mPaletteRows[0], GL_STREAM_DRAW );
+		mPaletteBuffer.unbind();
+	}
+}
+
+void SkinnedMesh::bindPalette( GlslProg &shader, size_t palette )
+{
+	if( palette >= mNumPalettes )
+		throw SkinnedMeshExc( "SkinnedMesh: drawing a palette which hasn't been set" );
+
+	mVboMesh->setCustomStaticLocation( 0, shader.getAttribLocation( "boneIndices" ) );
+	mVboMesh->setCustomStaticLocation( 1, shader.getAttribLocation( "boneWeights" ) );
+	if( usesTextureBuffer() ) {
+		StateCache::bindTexture( GL_TEXTURE_BUFFER_ARB, mPaletteTexture, mPaletteUnit );
+		shader.uniform( "bonePalette", mPaletteUnit );
+		shader.uniform( "firstBone", (int)( palette * mNumBones ) );
+		shader.uniform( "numBones", (int)mNumBones );
+	}
+	else
+		shader.uniform( "bonePalette", &mPaletteRows[0], (int)( mNumBones * 3 ) );
+}
+
+void SkinnedMesh::unbindPalette()
+{
+	if( usesTextureBuffer() )
+		StateCache::bindTexture( GL_TEXTURE_BUFFER_ARB, 0, mPaletteUnit );
+}
+
+void SkinnedMesh::draw( size_t palette )
+{
+	mDrawShader.bind();
+	draw( mDrawShader, palette );
+	GlslProg::unbind();
+}
+
+void SkinnedMesh::draw( GlslProg &shader, size_t palette )
+{
+	bindPalette( shader, palette );
+	gl::draw( mVboMesh );
+	unbindPalette();
+}
+
+void SkinnedMesh::drawInstanced()
+{
+	mDrawShader.bind();
+	drawInstanced( mDrawShader );
+	GlslProg::unbind();
+}
+
+void SkinnedMesh::drawInstanced( GlslProg &shader )
+{
+	if( ! usesTextureBuffer() )
+		throw SkinnedMeshExc( "SkinnedMesh::drawInstanced() requires texture buffers" );
+
+	bindPalette( shader, 0 );
+	gl::drawInstanced( mVboMesh, mNumPalettes );
+	unbindPalette();
+}
+
+string SkinnedMesh::getSkinningGlsl() const
+{
+	return buildSkinningGlsl( usesTextureBuffer() );
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
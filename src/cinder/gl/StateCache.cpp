@@ -0,0 +1,352 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/StateCache.h"
+#include "cinder/Thread.h"
+
+#include <atomic>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+const GLuint	UNKNOWN = 0xFFFFFFFF;
+const GLuint	NUM_TRACKED_UNITS = 8;
+
+enum { TEXTURE_TARGET_2D, TEXTURE_TARGET_RECTANGLE, NUM_TEXTURE_TARGETS };
+enum { BUFFER_TARGET_ARRAY, BUFFER_TARGET_ELEMENT_ARRAY, BUFFER_TARGET_PIXEL_PACK, BUFFER_TARGET_PIXEL_UNPACK, NUM_BUFFER_TARGETS };
+enum { CAP_BLEND, CAP_DEPTH_TEST, CAP_CULL_FACE, CAP_ALPHA_TEST, NUM_CAPS };
+
+struct State {
+	bool			mEnabled;
+	thread::id		mOwner;
+
+	// every value is UNKNOWN until it has been set through the cache
+	GLuint			mActiveUnit; // relative to GL_TEXTURE0
+	GLuint			mTextures[NUM_TRACKED_UNITS][NUM_TEXTURE_TARGETS];
+	GLuint			mBuffers[NUM_BUFFER_TARGETS];
+	GLuint			mReadFramebuffer, mDrawFramebuffer;
+	GLuint			mProgram;
+	GLuint			mCaps[NUM_CAPS];
+	GLuint			mBlendSrc, mBlendDst;
+	GLuint			mDepthMask;
+
+	uint32_t		mNumIssued, mNumSkipped;
+};
+
+State				sState;
+// set when another thread deletes an object, whose name the tracked context may still have bound
+atomic<bool>		sInvalidatePending( false );
+
+void forgetAll()
+{
+	sState.mActiveUnit = UNKNOWN;
+	for( GLuint u = 0; u < NUM_TRACKED_UNITS; ++u )
+		for( int t = 0; t < NUM_TEXTURE_TARGETS; ++t )
+			sState.mTextures[u][t] = UNKNOWN;
+	for( int b = 0; b < NUM_BUFFER_TARGETS; ++b )
+		sState.mBuffers[b] = UNKNOWN;
+	sState.mReadFramebuffer = sState.mDrawFramebuffer = UNKNOWN;
+	sState.mProgram = UNKNOWN;
+	for( int c = 0; c < NUM_CAPS; ++c )
+		sState.mCaps[c] = UNKNOWN;
+	sState.mBlendSrc = sState.mBlendDst = UNKNOWN;
+	sState.mDepthMask = UNKNOWN;
+}
+
+bool isOwnerThread()
+{
+	return sState.mEnabled && ( this_thread::get_id() == sState.mOwner );
+}
+
+//! Returns whether calls made on this thread consult the cache
+bool isTracking()
+{
+	if( ! isOwnerThread() )
+		return false;
+	if( sInvalidatePending.load( memory_order_relaxed ) && sInvalidatePending.exchange( false ) )
+		forgetAll();
+	return true;
+}
+
+//! Called with an object's name when it is deleted; clears the tracked bindings which GL reverts to 0
+void objectDeleted( GLuint *begin, GLuint *end, GLuint name )
+{
+	if( ! sState.mEnabled )
+		return;
+	if( ! isOwnerThread() ) {
+		sInvalidatePending = true;
+		return;
+	}
+	for( GLuint *binding = begin; binding != end; ++binding ) {
+		if( *binding == name )
+			*binding = 0;
+	}
+}
+
+//! Records \a value in \a tracked and returns whether GL needs to be called
+bool update( GLuint &tracked, GLuint value )
+{
+	if( tracked == value ) {
+		++sState.mNumSkipped;
+		return false;
+	}
+	tracked = value;
+	++sState.mNumIssued;
+	return true;
+}
+
+int textureTargetIndex( GLenum target )
+{
+	switch( target ) {
+		case GL_TEXTURE_2D: return TEXTURE_TARGET_2D;
+#if ! defined( CINDER_GLES )
+		case GL_TEXTURE_RECTANGLE_ARB: return TEXTURE_TARGET_RECTANGLE;
+#endif
+		default: return -1;
+	}
+}
+
+int bufferTargetIndex( GLenum target )
+{
+	switch( target ) {
+		case GL_ARRAY_BUFFER: return BUFFER_TARGET_ARRAY;
+		case GL_ELEMENT_ARRAY_BUFFER: return BUFFER_TARGET_ELEMENT_ARRAY;
+#if ! defined( CINDER_GLES )
+		case GL_PIXEL_PACK_BUFFER: return BUFFER_TARGET_PIXEL_PACK;
+		case GL_PIXEL_UNPACK_BUFFER: return BUFFER_TARGET_PIXEL_UNPACK;
+#endif
+		default: return -1;
+	}
+}
+
+int capIndex( GLenum cap )
+{
+	switch( cap ) {
+		case GL_BLEND: return CAP_BLEND;
+		case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+		case GL_CULL_FACE: return CAP_CULL_FACE;
+		case GL_ALPHA_TEST: return CAP_ALPHA_TEST;
+		default: return -1;
+	}
+}
+
+inline void bindFramebufferImpl( GLenum target, GLuint framebuffer )
+{
+#if defined( CINDER_GLES )
+	glBindFramebufferOES( target, framebuffer );
+#else
+	glBindFramebufferEXT( target, framebuffer );
+#endif
+}
+
+} // anonymous namespace
+
+void StateCache::enable()
+{
+	sState.mOwner = this_thread::get_id();
+	sState.mEnabled = true;
+	sInvalidatePending = false;
+	forgetAll();
+}
+
+void StateCache::disable()
+{
+	sState.mEnabled = false;
+}
+
+bool StateCache::isEnabled()
+{
+	return sState.mEnabled;
+}
+
+void StateCache::invalidate()
+{
+	if( isOwnerThread() )
+		forgetAll();
+}
+
+void StateCache::activeTexture( GLenum unit )
+{
+	if( ! isTracking() || update( sState.mActiveUnit, unit - GL_TEXTURE0 ) )
+		glActiveTexture( unit );
+}
+
+void StateCache::bindTexture( GLenum target, GLuint texture )
+{
+	if( isTracking() ) {
+		int t = textureTargetIndex( target );
+		GLuint unit = sState.mActiveUnit;
+		if( t >= 0 && unit < NUM_TRACKED_UNITS ) {
+			if( update( sState.mTextures[unit][t], texture ) )
+				glBindTexture( target, texture );
+			return;
+		}
+	}
+	glBindTexture( target, texture );
+}
+
+void StateCache::bindTexture( GLenum target, GLuint texture, GLuint unit )
+{
+	if( isTracking() ) {
+		int t = textureTargetIndex( target );
+		if( t >= 0 && unit < NUM_TRACKED_UNITS && sState.mTextures[unit][t] == texture ) {
+			++sState.mNumSkipped;
+			return;
+		}
+	}
+	activeTexture( GL_TEXTURE0 + unit );
+	bindTexture( target, texture );
+	activeTexture( GL_TEXTURE0 );
+}
+
+void StateCache::bindBuffer( GLenum target, GLuint buffer )
+{
+	if( isTracking() ) {
+		int b = bufferTargetIndex( target );
+		if( b >= 0 ) {
+			if( update( sState.mBuffers[b], buffer ) )
+				glBindBuffer( target, buffer );
+			return;
+		}
+	}
+	glBindBuffer( target, buffer );
+}
+
+void StateCache::bindFramebuffer( GLenum target, GLuint framebuffer )
+{
+	if( isTracking() ) {
+#if defined( CINDER_GLES )
+		if( target == GL_FRAMEBUFFER_OES ) {
+			if( update( sState.mDrawFramebuffer, framebuffer ) )
+				bindFramebufferImpl( target, framebuffer );
+			return;
+		}
+#else
+		if( target == GL_FRAMEBUFFER_EXT ) {
+			if( sState.mReadFramebuffer == framebuffer && sState.mDrawFramebuffer == framebuffer ) {
+				++sState.mNumSkipped;
+				return;
+			}
+			sState.mReadFramebuffer = sState.mDrawFramebuffer = framebuffer;
+			++sState.mNumIssued;
+			bindFramebufferImpl( target, framebuffer );
+			return;
+		}
+		else if( target == GL_READ_FRAMEBUFFER_EXT ) {
+			if( update( sState.mReadFramebuffer, framebuffer ) )
+				bindFramebufferImpl( target, framebuffer );
+			return;
+		}
+		else if( target == GL_DRAW_FRAMEBUFFER_EXT ) {
+			if( update( sState.mDrawFramebuffer, framebuffer ) )
+				bindFramebufferImpl( target, framebuffer );
+			return;
+		}
+#endif
+	}
+	bindFramebufferImpl( target, framebuffer );
+}
+
+#if ! defined( CINDER_GLES )
+void StateCache::useProgram( GLuint program )
+{
+	if( ! isTracking() || update( sState.mProgram, program ) )
+		glUseProgram( program );
+}
+#endif
+
+void StateCache::setCapability( GLenum cap, bool enabled )
+{
+	if( isTracking() ) {
+		int c = capIndex( cap );
+		if( c >= 0 && ! update( sState.mCaps[c], enabled ? 1 : 0 ) )
+			return;
+	}
+	if( enabled )
+		glEnable( cap );
+	else
+		glDisable( cap );
+}
+
+void StateCache::blendFunc( GLenum srcFactor, GLenum dstFactor )
+{
+	if( isTracking() ) {
+		if( sState.mBlendSrc == srcFactor && sState.mBlendDst == dstFactor ) {
+			++sState.mNumSkipped;
+			return;
+		}
+		sState.mBlendSrc = srcFactor;
+		sState.mBlendDst = dstFactor;
+		++sState.mNumIssued;
+	}
+	glBlendFunc( srcFactor, dstFactor );
+}
+
+void StateCache::depthMask( GLboolean flag )
+{
+	if( ! isTracking() || update( sState.mDepthMask, flag ? 1 : 0 ) )
+		glDepthMask( flag );
+}
+
+void StateCache::textureDeleted( GLuint texture )
+{
+	objectDeleted( &sState.mTextures[0][0], &sState.mTextures[0][0] + NUM_TRACKED_UNITS * NUM_TEXTURE_TARGETS, texture );
+}
+
+void StateCache::bufferDeleted( GLuint buffer )
+{
+	objectDeleted( sState.mBuffers, sState.mBuffers + NUM_BUFFER_TARGETS, buffer );
+}
+
+void StateCache::framebufferDeleted( GLuint framebuffer )
+{
+	objectDeleted( &sState.mReadFramebuffer, &sState.mReadFramebuffer + 1, framebuffer );
+	objectDeleted( &sState.mDrawFramebuffer, &sState.mDrawFramebuffer + 1, framebuffer );
+}
+
+void StateCache::programDeleted( GLuint program )
+{
+	// a deleted program stays in use until another is bound, so its binding is simply forgotten
+	if( isOwnerThread() && sState.mProgram == program )
+		sState.mProgram = UNKNOWN;
+}
+
+uint32_t StateCache::getNumCallsIssued()
+{
+	return sState.mNumIssued;
+}
+
+uint32_t StateCache::getNumCallsSkipped()
+{
+	return sState.mNumSkipped;
+}
+
+void StateCache::resetCounters()
+{
+	sState.mNumIssued = sState.mNumSkipped = 0;
+}
+
+} } // namespace cinder::gl
@@ -25,6 +25,7 @@
 
 #include "cinder/Camera.h"
 #include "cinder/gl/StereoAutoFocuser.h"
+#include "cinder/gl/StateCache.h"
 
 namespace cinder { namespace gl {
 
@@ -43,8 +44,8 @@ void StereoAutoFocuser::autoFocus( CameraStereo *cam, const Area &area, GLuint b
 
 		Area dstArea = mFboLarge.getBounds();
 
-		glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, buffer );
-		glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, mFboLarge.getId() );	
+		StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, buffer );
+		StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mFboLarge.getId() );	
 		glBlitFramebufferEXT( area.getX1(), area.getY1(), area.getX2(), area.getY2(), 
 			dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), GL_DEPTH_BUFFER_BIT, GL_NEAREST );
 	}
@@ -53,17 +54,22 @@ void StereoAutoFocuser::autoFocus( CameraStereo *cam, const Area &area, GLuint b
 	mFboLarge.blitTo( mFboSmall, mFboLarge.getBounds(), mFboSmall.getBounds(),
 		GL_NEAREST, GL_DEPTH_BUFFER_BIT );
 
-	// load depth samples into buffer
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mFboSmall.getId() );
-	glReadPixels(0, 0, AF_WIDTH, AF_HEIGHT, GL_DEPTH_COMPONENT, GL_FLOAT, &mBuffer.front());
-	mFboSmall.unbindFramebuffer();
+	// queue this frame's depth samples and consume the previous frame's, so that the readback never stalls the pipeline
+	FboReadback readback = mFboSmall.readDepthAsync( mFboSmall.getBounds() );
+	std::swap( readback, mPendingReadback );
+	if( ! readback )
+		return;
+
+	Channel32f depthSamples = readback.getChannel();
+	mBuffer.assign( depthSamples.getData(), depthSamples.getData() + AF_WIDTH * AF_HEIGHT );
 
 	// find minimum value 
 	std::vector<GLfloat>::const_iterator itr = std::min_element(mBuffer.begin(), mBuffer.end());
 
+	// the readback's rows are top first, but mNearest is measured from the bottom of mArea
 	size_t p = itr - mBuffer.begin();
 	mNearest.x = 0.5f + (int) ( (p % AF_WIDTH) / (float) AF_WIDTH * mArea.getWidth() );
-	mNearest.y = 0.5f + (int) ( (p / AF_WIDTH) / (float) AF_HEIGHT * mArea.getHeight() );
+	mNearest.y = 0.5f + (int) ( ( AF_HEIGHT - 1 - p / AF_WIDTH ) / (float) AF_HEIGHT * mArea.getHeight() );
 	
 	// convert to actual distance from camera
 	float nearClip = cam->getNearClip();
@@ -107,6 +113,7 @@ void StereoAutoFocuser::createBuffers( const Area &area )
 
 		mFboLarge = gl::Fbo( width, height, fmt );
 		mFboSmall = gl::Fbo( AF_WIDTH, AF_HEIGHT, fmt );
+		mPendingReadback.reset();
 	}
 
 	int size = AF_WIDTH * AF_HEIGHT;
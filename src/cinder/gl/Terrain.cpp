@@ -0,0 +1,518 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/Terrain.h"
+#include "cinder/gl/gl.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+#include <cfloat>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+enum { STITCH_WEST = 1, STITCH_EAST = 2, STITCH_NORTH = 4, STITCH_SOUTH = 8 };
+
+void decodeKey( uint64_t key, int32_t *level, int32_t *x, int32_t *y )
+{
+	*level = (int32_t)( key >> 56 );
+	*y = (int32_t)( ( key >> 28 ) & 0xFFFFFFF );
+	*x = (int32_t)( key & 0xFFFFFFF );
+}
+
+// Returns the index of vertex (i, j) of an n x n quad grid. Odd vertices on an edge in \a stitchMask are moved onto their even predecessor,
+// which drops them from the edge so that it matches a neighbor with half the resolution; the triangles that collapse are skipped by the caller.
+uint32_t stitchedVertex( int32_t i, int32_t j, int32_t n, int stitchMask )
+{
+	if( ( i == 0 && ( stitchMask & STITCH_WEST ) ) || ( i == n && ( stitchMask & STITCH_EAST ) ) )
+		j &= ~1;
+	if( ( j == 0 && ( stitchMask & STITCH_NORTH ) ) || ( j == n && ( stitchMask & STITCH_SOUTH ) ) )
+		i &= ~1;
+	return (uint32_t)( j * ( n + 1 ) + i );
+}
+
+void addTriangle( vector<uint32_t> *indices, uint32_t a, uint32_t b, uint32_t c )
+{
+	if( a == b || b == c || c == a )
+		return;
+	indices->push_back( a );
+	indices->push_back( b );
+	indices->push_back( c );
+}
+
+} // anonymous namespace
+
+TerrainRef Terrain::create( const Channel16u &heights, const Format &format )
+{
+	Channel32f converted( heights.getWidth(), heights.getHeight() );
+	Channel16u::ConstIter srcIt = heights.getIter();
+	Channel32f::Iter dstIt = converted.getIter();
+	while( srcIt.line() && dstIt.line() ) {
+		while( srcIt.pixel() && dstIt.pixel() )
+			dstIt.v() = srcIt.v() / 65535.0f;
+	}
+
+	return TerrainRef( new Terrain( converted, format ) );
+}
+
+Terrain::Terrain( const Channel32f &heights, const Format &format )
+	: mFormat( format ), mTaskPool( format.getTaskPool() ? format.getTaskPool() : TaskPool::get() ), mFrame( 0 ), mNumIndices( 0 )
+{
+	if( format.getChunkSize() <= 0 || ! isPowerOf2( (size_t)format.getChunkSize() ) )
+		throw TerrainExc( "Terrain chunk size must be a power of two." );
+	if( heights.getWidth() < 2 || heights.getHeight() < 2 )
+		throw TerrainExc( "Terrain heightfield must have at least 2 x 2 samples." );
+
+	shared_ptr<Source> source( new Source );
+	source->mHeights = heights;
+	source->mChunkSize = format.getChunkSize();
+	source->mSpacing = format.getSpacing();
+	source->mHeightScale = format.getHeightScale();
+	mSource = source;
+
+	initLevels();
+	initIndices();
+	mBounds = getNodeBounds( (int32_t)mLevels.size() - 1, 0, 0 );
+}
+
+Terrain::~Terrain()
+{
+	for( unordered_map<uint64_t, Chunk>::iterator chunkIt = mChunks.begin(); chunkIt != mChunks.end(); ++chunkIt ) {
+		if( chunkIt->second.mData )
+			chunkIt->second.mData->mCanceled = true;
+	}
+}
+
+void Terrain::initLevels()
+{
+	const Channel32f &heights = mSource->mHeights;
+	const int32_t n = mSource->mChunkSize;
+	const int32_t cellsX = heights.getWidth() - 1, cellsY = heights.getHeight() - 1;
+
+	int32_t numNodesX = ( cellsX + n - 1 ) / n, numNodesY = ( cellsY + n - 1 ) / n;
+	while( true ) {
+		Level level;
+		level.mNumNodesX = numNodesX;
+		level.mNumNodesY = numNodesY;
+		level.mNodes.resize( numNodesX * numNodesY );
+		mLevels.push_back( level );
+		if( numNodesX == 1 && numNodesY == 1 )
+			break;
+		numNodesX = ( numNodesX + 1 ) / 2;
+		numNodesY = ( numNodesY + 1 ) / 2;
+	}
+
+	// level 0 chunks sample every height, so they have no error
+	Level &finest = mLevels[0];
+	mTaskPool->parallelFor( 0, finest.mNumNodesY, [&]( size_t begin, size_t end ) {
+		for( int32_t y = (int32_t)begin; y < (int32_t)end; ++y ) {
+			for( int32_t x = 0; x < finest.mNumNodesX; ++x ) {
+				NodeBounds &node = finest.mNodes[y * finest.mNumNodesX + x];
+				node.mError = 0;
+				node.mMinHeight = FLT_MAX;
+				node.mMaxHeight = -FLT_MAX;
+				for( int32_t j = 0; j <= n; ++j ) {
+					for( int32_t i = 0; i <= n; ++i ) {
+						const float h = heights.getValue( Vec2i( x * n + i, y * n + j ) );
+						node.mMinHeight = std::min( node.mMinHeight, h );
+						node.mMaxHeight = std::max( node.mMaxHeight, h );
+					}
+				}
+			}
+		}
+	} );
+
+	// each coarser level inherits its children's bounds and adds the error of the vertices it drops from the previous level's grid,
+	// measured against its own triangles. Only those vertices are visited, so all levels together cost about 4/3 of a pass over the heights.
+	for( size_t l = 1; l < mLevels.size(); ++l ) {
+		const Level &children = mLevels[l - 1];
+		Level &level = mLevels[l];
+		const int32_t half = 1 << ( l - 1 );
+		mTaskPool->parallelFor( 0, level.mNumNodesY, [&]( size_t begin, size_t end ) {
+			for( int32_t y = (int32_t)begin; y < (int32_t)end; ++y ) {
+				for( int32_t x = 0; x < level.mNumNodesX; ++x ) {
+					NodeBounds &node = level.mNodes[y * level.mNumNodesX + x];
+					node.mError = 0;
+					node.mMinHeight = FLT_MAX;
+					node.mMaxHeight = -FLT_MAX;
+					for( int32_t cy = y * 2; cy < std::min( y * 2 + 2, children.mNumNodesY ); ++cy ) {
+						for( int32_t cx = x * 2; cx < std::min( x * 2 + 2, children.mNumNodesX ); ++cx ) {
+							const NodeBounds &child = children.mNodes[cy * children.mNumNodesX + cx];
+							node.mError = std::max( node.mError, child.mError );
+							node.mMinHeight = std::min( node.mMinHeight, child.mMinHeight );
+							node.mMaxHeight = std::max( node.mMaxHeight, child.mMaxHeight );
+						}
+					}
+
+					// (i, j) steps through the previous level's grid; this level keeps its even vertices
+					const int32_t x0 = x * n * half * 2, y0 = y * n * half * 2;
+					for( int32_t j = 0; j <= n * 2; ++j ) {
+						for( int32_t i = ( j & 1 ) ? 0 : 1; i <= n * 2; i += ( j & 1 ) ? 1 : 2 ) {
+							const float h = heights.getValue( Vec2i( x0 + i * half, y0 + j * half ) );
+							float interpolated;
+							if( ! ( j & 1 ) )
+								interpolated = ( heights.getValue( Vec2i( x0 + ( i - 1 ) * half, y0 + j * half ) ) + heights.getValue( Vec2i( x0 + ( i + 1 ) * half, y0 + j * half ) ) ) * 0.5f;
+							else if( ! ( i & 1 ) )
+								interpolated = ( heights.getValue( Vec2i( x0 + i * half, y0 + ( j - 1 ) * half ) ) + heights.getValue( Vec2i( x0 + i * half, y0 + ( j + 1 ) * half ) ) ) * 0.5f;
+							else // on the diagonal of the quad, see initIndices()
+								interpolated = ( heights.getValue( Vec2i( x0 + ( i - 1 ) * half, y0 + ( j - 1 ) * half ) ) + heights.getValue( Vec2i( x0 + ( i + 1 ) * half, y0 + ( j + 1 ) * half ) ) ) * 0.5f;
+							node.mError = std::max( node.mError, math<float>::abs( h - interpolated ) );
+						}
+					}
+				}
+			}
+		} );
+	}
+}
+
+void Terrain::initIndices()
+{
+	// every chunk is the same (n + 1) x (n + 1) grid, so one index buffer holds all 16 combinations of stitched edges
+	const int32_t n = mSource->mChunkSize;
+	vector<uint32_t> indices;
+	for( int stitchMask = 0; stitchMask < 16; ++stitchMask ) {
+		mIndexStart[stitchMask] = indices.size();
+		for( int32_t j = 0; j < n; ++j ) {
+			for( int32_t i = 0; i < n; ++i ) {
+				const uint32_t v00 = stitchedVertex( i, j, n, stitchMask ), v10 = stitchedVertex( i + 1, j, n, stitchMask );
+				const uint32_t v01 = stitchedVertex( i, j + 1, n, stitchMask ), v11 = stitchedVertex( i + 1, j + 1, n, stitchMask );
+				// counterclockwise seen from +y, split along the v00-v11 diagonal
+				addTriangle( &indices, v00, v01, v11 );
+				addTriangle( &indices, v00, v11, v10 );
+			}
+		}
+		mIndexCount[stitchMask] = indices.size() - mIndexStart[stitchMask];
+	}
+
+	mNumIndices = indices.size();
+	mIndexBuffer = Vbo( GL_ELEMENT_ARRAY_BUFFER );
+	mIndexBuffer.bufferData( indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW );
+	mIndexBuffer.unbind();
+}
+
+AxisAlignedBox3f Terrain::getNodeBounds( int32_t level, int32_t x, int32_t y ) const
+{
+	const Level &lev = mLevels[level];
+	const NodeBounds &node = lev.mNodes[y * lev.mNumNodesX + x];
+	const int32_t size = mSource->mChunkSize << level;
+	const int32_t maxX = mSource->mHeights.getWidth() - 1, maxY = mSource->mHeights.getHeight() - 1;
+	const Vec2f &spacing = mSource->mSpacing;
+	const float h0 = node.mMinHeight * mSource->mHeightScale, h1 = node.mMaxHeight * mSource->mHeightScale;
+
+	return AxisAlignedBox3f( Vec3f( std::min( x * size, maxX ) * spacing.x, std::min( h0, h1 ), std::min( y * size, maxY ) * spacing.y ),
+							Vec3f( std::min( ( x + 1 ) * size, maxX ) * spacing.x, std::max( h0, h1 ), std::min( ( y + 1 ) * size, maxY ) * spacing.y ) );
+}
+
+float Terrain::getProjectedError( int32_t level, int32_t x, int32_t y, const Camera &cam, const Vec2i &viewportSize ) const
+{
+	const Level &lev = mLevels[level];
+	const float error = lev.mNodes[y * lev.mNumNodesX + x].mError * math<float>::abs( mSource->mHeightScale );
+	if( error <= 0 )
+		return 0;
+
+	// the point of the node nearest to the eye bounds the projection of its error, whatever the view direction
+	const AxisAlignedBox3f box = getNodeBounds( level, x, y );
+	const Vec3f eye = cam.getEyePoint();
+	const Vec3f nearest( constrain( eye.x, box.getMin().x, box.getMax().x ), constrain( eye.y, box.getMin().y, box.getMax().y ), constrain( eye.z, box.getMin().z, box.getMax().z ) );
+	const float distance = nearest.distance( eye );
+	if( distance <= error )
+		return FLT_MAX;
+
+	const float pixelsPerUnit = viewportSize.y / ( 2.0f * math<float>::tan( toRadians( cam.getFov() ) * 0.5f ) * distance );
+	return error * pixelsPerUnit;
+}
+
+VboMeshRef Terrain::useChunk( int32_t level, int32_t x, int32_t y )
+{
+	Chunk &chunk = mChunks[makeKey( level, x, y )];
+	chunk.mLastUsedFrame = mFrame;
+	if( ! chunk.mMesh && ! chunk.mData ) {
+		shared_ptr<ChunkData> data( new ChunkData );
+		chunk.mData = data;
+		shared_ptr<const Source> source = mSource;
+		mTaskPool->submit( [source, level, x, y, data] {
+			if( ! data->mCanceled )
+				generateChunk( *source, level, x, y, data.get() );
+		} );
+	}
+
+	return chunk.mMesh;
+}
+
+bool Terrain::useChildren( int32_t level, int32_t x, int32_t y )
+{
+	// request every missing child, not just the first
+	const Level &children = mLevels[level - 1];
+	bool resident = true;
+	for( int32_t cy = y * 2; cy < std::min( y * 2 + 2, children.mNumNodesY ); ++cy ) {
+		for( int32_t cx = x * 2; cx < std::min( x * 2 + 2, children.mNumNodesX ); ++cx ) {
+			if( ! useChunk( level - 1, cx, cy ) )
+				resident = false;
+		}
+	}
+
+	return resident;
+}
+
+void Terrain::generateChunk( const Source &source, int32_t level, int32_t x, int32_t y, ChunkData *data )
+{
+	const Channel32f &heights = source.mHeights;
+	const int32_t n = source.mChunkSize, step = 1 << level;
+	const int32_t maxX = heights.getWidth() - 1, maxY = heights.getHeight() - 1;
+	const Vec2f &spacing = source.mSpacing;
+
+	data->mPositions.reserve( ( n + 1 ) * ( n + 1 ) );
+	data->mNormals.reserve( ( n + 1 ) * ( n + 1 ) );
+	data->mTexCoords.reserve( ( n + 1 ) * ( n + 1 ) );
+	for( int32_t j = 0; j <= n; ++j ) {
+		// past the far edges of the heightfield, vertices collapse onto the last row or column
+		const int32_t sy = std::min( ( y * n + j ) * step, maxY );
+		for( int32_t i = 0; i <= n; ++i ) {
+			const int32_t sx = std::min( ( x * n + i ) * step, maxX );
+			data->mPositions.push_back( Vec3f( sx * spacing.x, heights.getValue( Vec2i( sx, sy ) ) * source.mHeightScale, sy * spacing.y ) );
+			data->mTexCoords.push_back( Vec2f( sx / (float)maxX, sy / (float)maxY ) );
+
+			// differences across the chunk's own stride, so coarse chunks aren't shaded with detail their geometry lacks
+			const int32_t left = std::max( sx - step, 0 ), right = std::min( sx + step, maxX );
+			const int32_t top = std::max( sy - step, 0 ), bottom = std::min( sy + step, maxY );
+			const float dx = ( heights.getValue( Vec2i( right, sy ) ) - heights.getValue( Vec2i( left, sy ) ) ) * source.mHeightScale / ( ( right - left ) * spacing.x );
+			const float dz = ( heights.getValue( Vec2i( sx, bottom ) ) - heights.getValue( Vec2i( sx, top ) ) ) * source.mHeightScale / ( ( bottom - top ) * spacing.y );
+			data->mNormals.push_back( Vec3f( -dx, 1, -dz ).normalized() );
+		}
+	}
+
+	data->mGenerated = true;
+}
+
+void Terrain::update( const Camera &cam, const Vec2i &viewportSize )
+{
+	++mFrame;
+	uploadChunks();
+
+	LeafSet leaves;
+	const int32_t root = (int32_t)mLevels.size() - 1;
+	if( useChunk( root, 0, 0 ) )
+		selectNode( root, 0, 0, cam, viewportSize, &leaves );
+	restrictSelection( &leaves );
+
+	// stitch the edges shared with a coarser neighbor, then cull against the frustum
+	Frustumf frustum( cam );
+	mSelected.clear();
+	mVisible.clear();
+	for( LeafSet::const_iterator leafIt = leaves.begin(); leafIt != leaves.end(); ++leafIt ) {
+		Selection selection;
+		decodeKey( *leafIt, &selection.mLevel, &selection.mX, &selection.mY );
+		const int32_t x0 = selection.mX << selection.mLevel, y0 = selection.mY << selection.mLevel, size = 1 << selection.mLevel;
+		selection.mStitchMask = 0;
+		if( findLeafLevel( leaves, x0 - 1, y0 ) == selection.mLevel + 1 )
+			selection.mStitchMask |= STITCH_WEST;
+		if( findLeafLevel( leaves, x0 + size, y0 ) == selection.mLevel + 1 )
+			selection.mStitchMask |= STITCH_EAST;
+		if( findLeafLevel( leaves, x0, y0 - 1 ) == selection.mLevel + 1 )
+			selection.mStitchMask |= STITCH_NORTH;
+		if( findLeafLevel( leaves, x0, y0 + size ) == selection.mLevel + 1 )
+			selection.mStitchMask |= STITCH_SOUTH;
+		selection.mMesh = mChunks[*leafIt].mMesh;
+		if( ! selection.mMesh )
+			continue;
+
+		mSelected.push_back( selection );
+		if( frustum.intersects( getNodeBounds( selection.mLevel, selection.mX, selection.mY ) ) )
+			mVisible.push_back( selection );
+	}
+
+	releaseChunks();
+}
+
+void Terrain::selectNode( int32_t level, int32_t x, int32_t y, const Camera &cam, const Vec2i &viewportSize, LeafSet *leaves )
+{
+	// a node is refined only once all of its children can be drawn, so there is never a hole
+	if( level > 0 && getProjectedError( level, x, y, cam, viewportSize ) > mFormat.getPixelError() && useChildren( level, x, y ) ) {
+		const Level &children = mLevels[level - 1];
+		for( int32_t cy = y * 2; cy < std::min( y * 2 + 2, children.mNumNodesY ); ++cy ) {
+			for( int32_t cx = x * 2; cx < std::min( x * 2 + 2, children.mNumNodesX ); ++cx )
+				selectNode( level - 1, cx, cy, cam, viewportSize, leaves );
+		}
+	}
+	else
+		leaves->insert( makeKey( level, x, y ) );
+}
+
+int32_t Terrain::findLeafLevel( const LeafSet &leaves, int32_t x, int32_t y ) const
+{
+	if( x < 0 || y < 0 || x >= mLevels[0].mNumNodesX || y >= mLevels[0].mNumNodesY )
+		return -1;
+
+	for( int32_t level = 0; level < (int32_t)mLevels.size(); ++level ) {
+		if( leaves.count( makeKey( level, x >> level, y >> level ) ) )
+			return level;
+	}
+
+	return -1;
+}
+
+void Terrain::restrictSelection( LeafSet *leaves )
+{
+	// Stitching only bridges one level, so wherever a leaf's neighbor is two or more levels coarser, the neighbor is split if its children
+	// are resident. Otherwise the leaf's region is merged back up to one level below the neighbor; that node's parent was split earlier,
+	// so it is resident. Each leaf only checks its coarser neighbors, which cover its whole edge and are found from a single point.
+	// The pass limit is a safeguard; every change removes one violation but may introduce others further away.
+	const size_t maxPasses = leaves->size() * 4 + 64;
+	for( size_t pass = 0; pass < maxPasses; ++pass ) {
+		bool changed = false;
+		for( LeafSet::const_iterator leafIt = leaves->begin(); leafIt != leaves->end() && ! changed; ++leafIt ) {
+			int32_t level, x, y;
+			decodeKey( *leafIt, &level, &x, &y );
+			const int32_t x0 = x << level, y0 = y << level, size = 1 << level;
+			const Vec2i neighbors[4] = { Vec2i( x0 - 1, y0 ), Vec2i( x0 + size, y0 ), Vec2i( x0, y0 - 1 ), Vec2i( x0, y0 + size ) };
+			for( int side = 0; side < 4; ++side ) {
+				const int32_t neighborLevel = findLeafLevel( *leaves, neighbors[side].x, neighbors[side].y );
+				if( neighborLevel < level + 2 )
+					continue;
+
+				const int32_t nx = neighbors[side].x >> neighborLevel, ny = neighbors[side].y >> neighborLevel;
+				if( useChildren( neighborLevel, nx, ny ) ) {
+					leaves->erase( makeKey( neighborLevel, nx, ny ) );
+					const Level &children = mLevels[neighborLevel - 1];
+					for( int32_t cy = ny * 2; cy < std::min( ny * 2 + 2, children.mNumNodesY ); ++cy ) {
+						for( int32_t cx = nx * 2; cx < std::min( nx * 2 + 2, children.mNumNodesX ); ++cx )
+							leaves->insert( makeKey( neighborLevel - 1, cx, cy ) );
+					}
+				}
+				else {
+					const int32_t mergedLevel = neighborLevel - 1, mx = x >> ( mergedLevel - level ), my = y >> ( mergedLevel - level );
+					for( LeafSet::iterator otherIt = leaves->begin(); otherIt != leaves->end(); ) {
+						int32_t otherLevel, ox, oy;
+						decodeKey( *otherIt, &otherLevel, &ox, &oy );
+						if( otherLevel < mergedLevel && ( ox >> ( mergedLevel - otherLevel ) ) == mx && ( oy >> ( mergedLevel - otherLevel ) ) == my )
+							otherIt = leaves->erase( otherIt );
+						else
+							++otherIt;
+					}
+					leaves->insert( makeKey( mergedLevel, mx, my ) );
+					useChunk( mergedLevel, mx, my );
+				}
+				changed = true;
+				break;
+			}
+		}
+
+		if( ! changed )
+			break;
+	}
+}
+
+void Terrain::uploadChunks()
+{
+	VboMesh::Layout layout;
+	layout.setStaticIndices();
+	layout.setStaticPositions();
+	layout.setStaticNormals();
+	layout.setStaticTexCoords2d();
+
+	size_t numUploads = 0;
+	for( unordered_map<uint64_t, Chunk>::iterator chunkIt = mChunks.begin(); chunkIt != mChunks.end() && numUploads < mFormat.getMaxUploadsPerFrame(); ++chunkIt ) {
+		Chunk &chunk = chunkIt->second;
+		if( ! chunk.mData || ! chunk.mData->mGenerated )
+			continue;
+
+		// the chunks share the index buffer
+		const ChunkData &data = *chunk.mData;
+		chunk.mMesh = VboMesh::create( data.mPositions.size(), mNumIndices, layout, GL_TRIANGLES, &mIndexBuffer, 0, 0 );
+		chunk.mMesh->bufferPositions( data.mPositions );
+		chunk.mMesh->bufferNormals( data.mNormals );
+		chunk.mMesh->bufferTexCoords2d( 0, data.mTexCoords );
+		chunk.mData.reset();
+		++numUploads;
+	}
+}
+
+void Terrain::releaseChunks()
+{
+	if( mChunks.size() <= mFormat.getMaxChunks() )
+		return;
+
+	// chunks used this frame include every ancestor of the selection, which restrictSelection() may need to merge back to
+	vector<pair<uint32_t, uint64_t> > unused;
+	for( unordered_map<uint64_t, Chunk>::const_iterator chunkIt = mChunks.begin(); chunkIt != mChunks.end(); ++chunkIt ) {
+		if( chunkIt->second.mLastUsedFrame != mFrame )
+			unused.push_back( make_pair( chunkIt->second.mLastUsedFrame, chunkIt->first ) );
+	}
+	sort( unused.begin(), unused.end() );
+
+	const size_t excess = std::min( mChunks.size() - mFormat.getMaxChunks(), unused.size() );
+	for( size_t c = 0; c < excess; ++c ) {
+		unordered_map<uint64_t, Chunk>::iterator chunkIt = mChunks.find( unused[c].second );
+		if( chunkIt->second.mData )
+			chunkIt->second.mData->mCanceled = true;
+		mChunks.erase( chunkIt );
+	}
+}
+
+void Terrain::draw() const
+{
+	for( vector<Selection>::const_iterator selIt = mVisible.begin(); selIt != mVisible.end(); ++selIt )
+		gl::drawRange( *selIt->mMesh, mIndexStart[selIt->mStitchMask], mIndexCount[selIt->mStitchMask] );
+}
+
+float Terrain::getHeightAt( const Vec2f &xz ) const
+{
+	const Channel32f &heights = mSource->mHeights;
+	const float fx = constrain( xz.x / mSource->mSpacing.x, 0.0f, (float)( heights.getWidth() - 1 ) );
+	const float fy = constrain( xz.y / mSource->mSpacing.y, 0.0f, (float)( heights.getHeight() - 1 ) );
+	const int32_t x = std::min( (int32_t)fx, heights.getWidth() - 2 ), y = std::min( (int32_t)fy, heights.getHeight() - 2 );
+	const float u = fx - x, v = fy - y;
+
+	// interpolate on the same triangles as the finest chunks, split along the diagonal from (x, y) to (x + 1, y + 1)
+	const float h00 = heights.getValue( Vec2i( x, y ) ), h10 = heights.getValue( Vec2i( x + 1, y ) );
+	const float h01 = heights.getValue( Vec2i( x, y + 1 ) ), h11 = heights.getValue( Vec2i( x + 1, y + 1 ) );
+	const float h = ( v >= u ) ? h00 + v * ( h01 - h00 ) + u * ( h11 - h01 ) : h00 + u * ( h10 - h00 ) + v * ( h11 - h10 );
+	return h * mSource->mHeightScale;
+}
+
+size_t Terrain::getNumResidentChunks() const
+{
+	size_t result = 0;
+	for( unordered_map<uint64_t, Chunk>::const_iterator chunkIt = mChunks.begin(); chunkIt != mChunks.end(); ++chunkIt ) {
+		if( chunkIt->second.mMesh )
+			++result;
+	}
+
+	return result;
+}
+
+size_t Terrain::getNumPendingChunks() const
+{
+	size_t result = 0;
+	for( unordered_map<uint64_t, Chunk>::const_iterator chunkIt = mChunks.begin(); chunkIt != mChunks.end(); ++chunkIt ) {
+		if( chunkIt->second.mData )
+			++result;
+	}
+
+	return result;
+}
+
+} } // namespace cinder::gl
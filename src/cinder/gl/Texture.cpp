@@ -23,8 +23,47 @@
 #include "cinder/gl/gl.h" // has to be first
 #include "cinder/ImageIo.h"
 #include "cinder/gl/Texture.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/Profiler.h"
 #include <stdio.h>
 
+// block compressed formats missing from older system headers
+#if ! defined( CINDER_GLES )
+	#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+		#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT		0x8C4D
+		#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT		0x8C4E
+		#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT		0x8C4F
+	#endif
+	#ifndef GL_COMPRESSED_RED_RGTC1
+		#define GL_COMPRESSED_RED_RGTC1						0x8DBB
+		#define GL_COMPRESSED_SIGNED_RED_RGTC1				0x8DBC
+		#define GL_COMPRESSED_RG_RGTC2						0x8DBD
+		#define GL_COMPRESSED_SIGNED_RG_RGTC2				0x8DBE
+	#endif
+	#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM_ARB
+		#define GL_COMPRESSED_RGBA_BPTC_UNORM_ARB			0x8E8C
+		#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB		0x8E8D
+		#define GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB		0x8E8E
+		#define GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB	0x8E8F
+	#endif
+	// 16-bit single channel and integer formats, likewise
+	#ifndef GL_R16
+		#define GL_R16										0x822A
+		#define GL_R16UI									0x8234
+	#endif
+	#ifndef GL_RGBA16UI_EXT
+		#define GL_RGBA16UI_EXT								0x8D76
+		#define GL_RGB16UI_EXT								0x8D77
+		#define GL_LUMINANCE16UI_EXT						0x8D7A
+		#define GL_RED_INTEGER_EXT							0x8D94
+		#define GL_RGB_INTEGER_EXT							0x8D98
+		#define GL_RGBA_INTEGER_EXT							0x8D99
+		#define GL_BGR_INTEGER_EXT							0x8D9A
+		#define GL_BGRA_INTEGER_EXT							0x8D9B
+		#define GL_LUMINANCE_INTEGER_EXT					0x8D9C
+	#endif
+#endif
+
 using namespace std;
 
 namespace cinder {
@@ -36,29 +75,6 @@ class ImageTargetTexture;
 TextureDataExc::TextureDataExc( const std::string &log ) throw()
 { strncpy( mMessage, log.c_str(), 16000 ); }
 
-/////////////////////////////////////////////////////////////////////////////////
-// ImageTargetGLTexture
-template<typename T>
-class ImageTargetGLTexture : public ImageTarget {
- public:
-	static shared_ptr<ImageTargetGLTexture> createRef( const Texture *aTexture, ImageIo::ChannelOrder &aChannelOrder, bool aIsGray, bool aHasAlpha );
-	~ImageTargetGLTexture();
-
-	virtual bool	hasAlpha() const { return mHasAlpha; }
-	virtual void*	getRowPointer( int32_t row ) { return mData + row * mRowInc; }
-
-	const void*		getData() const { return mData; }
-	
- private:
-	ImageTargetGLTexture( const Texture *aTexture, ImageIo::ChannelOrder &aChannelOrder, bool aIsGray, bool aHasAlpha );
-	const Texture		*mTexture;
-	bool				mIsGray;
-	bool				mHasAlpha;
-	uint8_t				mPixelInc;
-	T					*mData;
-	int					mRowInc;
-};
-
 /////////////////////////////////////////////////////////////////////////////////
 // Texture::Format
 Texture::Format::Format()
@@ -70,6 +86,7 @@ Texture::Format::Format()
 	mMagFilter = GL_LINEAR;
 	mMipmapping = false;
 	mInternalFormat = -1;
+	mNumStreamBuffers = 0;
 }
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -81,9 +98,98 @@ Texture::Obj::~Obj()
 
 	if( ( mTextureID > 0 ) && ( ! mDoNotDispose ) ) {
 		glDeleteTextures( 1, &mTextureID );
+		StateCache::textureDeleted( mTextureID );
+	}
+
+#if ! defined( CINDER_GLES )
+	if( ! mStreamBuffers.empty() ) {
+		glDeleteBuffers( (GLsizei)mStreamBuffers.size(), &mStreamBuffers[0] );
+		for( size_t b = 0; b < mStreamBuffers.size(); ++b )
+			StateCache::bufferDeleted( mStreamBuffers[b] );
+	}
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// 16-bit uploads
+namespace {
+
+#if ! defined( CINDER_GLES )
+bool isIntegerInternalFormat( GLint internalFormat )
+{
+	switch( internalFormat ) {
+		case GL_R16UI:
+		case GL_LUMINANCE16UI_EXT:
+		case GL_RGB16UI_EXT:
+		case GL_RGBA16UI_EXT:
+			return true;
+		default:
+			return false;
+	}
+}
+#endif
+
+// Integer textures are incomplete unless they're sampled without filtering
+void prepare16uFormat( Texture::Format *format )
+{
+#if ! defined( CINDER_GLES )
+	if( isIntegerInternalFormat( format->getInternalFormat() ) ) {
+		format->setMinFilter( GL_NEAREST );
+		format->setMagFilter( GL_NEAREST );
+		format->enableMipmapping( false );
+	}
+#endif
+}
+
+// Integer internal formats have to be fed the _INTEGER variants of the data formats
+GLenum channel16uDataFormat( GLint internalFormat )
+{
+#if ! defined( CINDER_GLES )
+	if( internalFormat == GL_R16UI )
+		return GL_RED_INTEGER_EXT;
+	else if( isIntegerInternalFormat( internalFormat ) )
+		return GL_LUMINANCE_INTEGER_EXT;
+#endif
+	return GL_LUMINANCE;
+}
+
+GLenum surface16uDataFormat( const SurfaceChannelOrder &sco, GLint internalFormat )
+{
+	GLint dataFormat;
+	GLenum type;
+	Texture::SurfaceChannelOrderToDataFormatAndType( sco, &dataFormat, &type );
+	// packed orders such as ARGB have no 16-bit equivalent
+	if( type != GL_UNSIGNED_BYTE )
+		throw TextureDataExc( "Invalid channel order for a 16-bit Surface" );
+
+#if ! defined( CINDER_GLES )
+	if( isIntegerInternalFormat( internalFormat ) ) {
+		switch( dataFormat ) {
+			case GL_RGB: return GL_RGB_INTEGER_EXT;
+			case GL_BGR: return GL_BGR_INTEGER_EXT;
+			case GL_RGBA: return GL_RGBA_INTEGER_EXT;
+			case GL_BGRA: return GL_BGRA_INTEGER_EXT;
+		}
+	}
+#endif
+	return dataFormat;
+}
+
+// Copies \a area of \a channel into \a dst as tightly packed rows
+template<typename T>
+void copyPacked( const ChannelT<T> &channel, const Area &area, T *dst )
+{
+	const int8_t inc = channel.getIncrement();
+	const int32_t width = area.getWidth();
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		const T *src = channel.getData( area.getX1(), y );
+		for( int32_t x = 0; x < width; ++x, src += inc )
+			*dst++ = *src;
 	}
 }
 
+} // anonymous namespace
 
 /////////////////////////////////////////////////////////////////////////////////
 // Texture
@@ -147,6 +253,24 @@ Texture::Texture( const Surface32f &surface, Format format )
 	init( surface.getData(), surface.hasAlpha()?GL_RGBA:GL_RGB, format );	
 }
 
+Texture::Texture( const Surface16u &surface, Format format )
+	: mObj( shared_ptr<Obj>( new Obj( surface.getWidth(), surface.getHeight() ) ) )
+{
+	if( format.mInternalFormat < 0 ) {
+#if ! defined( CINDER_GLES )
+		format.mInternalFormat = surface.hasAlpha() ? GL_RGBA16 : GL_RGB16;
+#else
+		format.mInternalFormat = surface.hasAlpha() ? GL_RGBA : GL_RGB;
+#endif
+	}
+	prepare16uFormat( &format );
+	mObj->mInternalFormat = format.mInternalFormat;
+	mObj->mTarget = format.mTarget;
+
+	const GLenum dataFormat = surface16uDataFormat( surface.getChannelOrder(), format.mInternalFormat );
+	init( reinterpret_cast<const unsigned char*>( surface.getData() ), surface.getRowBytes() / ( surface.getPixelInc() * sizeof(uint16_t) ), dataFormat, GL_UNSIGNED_SHORT, format );
+}
+
 Texture::Texture( const Channel8u &channel, Format format )
 	: mObj( shared_ptr<Obj>( new Obj( channel.getWidth(), channel.getHeight() ) ) )
 {
@@ -219,12 +343,50 @@ Texture::Texture( const Channel32f &channel, Format format )
 		init( channel.getData(), GL_LUMINANCE, format );
 }
 
+Texture::Texture( const Channel16u &channel, Format format )
+	: mObj( shared_ptr<Obj>( new Obj( channel.getWidth(), channel.getHeight() ) ) )
+{
+	if( format.mInternalFormat < 0 ) {
+#if ! defined( CINDER_GLES )
+		format.mInternalFormat = GL_LUMINANCE16;
+#else
+		format.mInternalFormat = GL_LUMINANCE;
+#endif
+	}
+	prepare16uFormat( &format );
+	mObj->mInternalFormat = format.mInternalFormat;
+	mObj->mTarget = format.mTarget;
+
+	const GLenum dataFormat = channel16uDataFormat( format.mInternalFormat );
+	if( ! channel.isPlanar() ) {
+		vector<uint16_t> packed( channel.getWidth() * channel.getHeight() );
+		copyPacked( channel, channel.getBounds(), &packed[0] );
+		init( reinterpret_cast<const unsigned char*>( &packed[0] ), channel.getWidth(), dataFormat, GL_UNSIGNED_SHORT, format );
+	}
+	else
+		init( reinterpret_cast<const unsigned char*>( channel.getData() ), channel.getRowBytes() / sizeof(uint16_t), dataFormat, GL_UNSIGNED_SHORT, format );
+}
+
 Texture::Texture( ImageSourceRef imageSource, Format format )
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
 	init( imageSource, format );
 }
 
+#if ! defined( CINDER_GLES )
+Texture::Texture( const ip::BlockCompressedImage &image, Format format )
+	: mObj( shared_ptr<Obj>( new Obj( image.getWidth(), image.getHeight() ) ) )
+{
+	mObj->mInternalFormat = ( image.getFormat() == ip::BlockCompressedImage::BC1 ) ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	mObj->mTarget = format.mTarget;
+
+	vector<pair<const uint8_t*,size_t> > levels;
+	for( size_t level = 0; level < image.getNumLevels(); ++level )
+		levels.push_back( make_pair( reinterpret_cast<const uint8_t*>( image.getLevel( level ).getData() ), image.getLevel( level ).getDataSize() ) );
+	initMipLevels( levels, 0, 0, format );
+}
+#endif
+
 Texture::Texture( GLenum aTarget, GLuint aTextureID, int aWidth, int aHeight, bool aDoNotDispose )
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
@@ -245,11 +407,13 @@ Texture::Texture( GLenum aTarget, GLuint aTextureID, int aWidth, int aHeight, bo
 
 void Texture::init( const unsigned char *data, int unpackRowLength, GLenum dataFormat, GLenum type, const Format &format )
 {
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
 	mObj->mDoNotDispose = false;
+	initStreaming( format );
 
 	glGenTextures( 1, &mObj->mTextureID );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_MIN_FILTER, format.mMinFilter );	
@@ -272,15 +436,18 @@ void Texture::init( const unsigned char *data, int unpackRowLength, GLenum dataF
 #if ! defined( CINDER_GLES )
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
 #endif	
+	countMemory( 1, format.mMipmapping );
 }
 
 void Texture::init( const float *data, GLint dataFormat, const Format &format )
 {
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
 	mObj->mDoNotDispose = false;
+	initStreaming( format );
 
 	glGenTextures( 1, &mObj->mTextureID );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_MIN_FILTER, format.mMinFilter );	
@@ -301,128 +468,117 @@ void Texture::init( const float *data, GLint dataFormat, const Format &format )
 	}
 	else
 		glTexImage2D( mObj->mTarget, 0, mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, 0, GL_LUMINANCE, GL_FLOAT, 0 );  // init to black...
+	countMemory( 1, format.mMipmapping );
 }
 
 void Texture::init( ImageSourceRef imageSource, const Format &format )
 {
-	mObj->mDoNotDispose = false;
-	mObj->mTarget = format.mTarget;
-	mObj->mWidth = mObj->mCleanWidth = imageSource->getWidth();
-	mObj->mHeight = mObj->mCleanHeight = imageSource->getHeight();
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	TextureImageTargetRef target = TextureImageTarget::create( imageSource, format );
+	imageSource->load( target );
+	mObj = target->finish().mObj;
+}
+
+namespace {
 
+bool supportsPixelBufferObjects()
+{
 #if defined( CINDER_MAC )
-	bool supportsTextureFloat = gl::isExtensionAvailable( "GL_ARB_texture_float" );
+	return gl::isExtensionAvailable( "GL_ARB_pixel_buffer_object" );
 #elif defined( CINDER_MSW )
-	bool supportsTextureFloat = GLEE_ARB_texture_float != 0;
-#endif
-	
-	// Set the internal format based on the image's color space
-	if( format.isAutoInternalFormat() ) {
-		switch( imageSource->getColorModel() ) {
-#if ! defined( CINDER_GLES )
-			case ImageIo::CM_RGB:
-				if( imageSource->getDataType() == ImageIo::UINT8 )
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_RGBA8 : GL_RGB8;
-				else if( imageSource->getDataType() == ImageIo::UINT16 )
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_RGBA16 : GL_RGB16;
-				else if( imageSource->getDataType() == ImageIo::FLOAT32 && supportsTextureFloat )
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_RGBA32F_ARB : GL_RGB32F_ARB;
-				else
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_RGBA : GL_RGB;
-			break;
-			case ImageIo::CM_GRAY:
-				if( imageSource->getDataType() == ImageIo::UINT8 )
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_LUMINANCE8_ALPHA8 : GL_LUMINANCE8;
-				else if( imageSource->getDataType() == ImageIo::UINT16 )
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_LUMINANCE16_ALPHA16 : GL_LUMINANCE16;
-				else if( imageSource->getDataType() == ImageIo::FLOAT32 && supportsTextureFloat )
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_LUMINANCE_ALPHA32F_ARB : GL_LUMINANCE32F_ARB;
-				else
-					mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
-			break;
+	return GLEE_ARB_pixel_buffer_object != 0;
 #else
-			case ImageIo::CM_RGB:
-				mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_RGBA : GL_RGB;
-			break;
-			case ImageIo::CM_GRAY:
-				mObj->mInternalFormat = ( imageSource->hasAlpha() ) ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
-			break;
-			
+	return false;
 #endif
-			default:
-				throw ImageIoExceptionIllegalColorModel( "Illegal color model." );
-			break;
-		}
-	}
-	else {
-		mObj->mInternalFormat = format.mInternalFormat;
-	}
+}
 
-	// setup an appropriate dataFormat/ImageTargetTexture based on the image's color space
-	GLint dataFormat;
-	ImageIo::ChannelOrder channelOrder;
-	bool isGray = false;
-	switch( imageSource->getColorModel() ) {
-		case ImageSource::CM_RGB:
-			dataFormat = ( imageSource->hasAlpha() ) ? GL_RGBA : GL_RGB;
-			channelOrder = ( imageSource->hasAlpha() ) ? ImageIo::RGBA : ImageIo::RGB;
-		break;
-		case ImageSource::CM_GRAY:
-			dataFormat = ( imageSource->hasAlpha() ) ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
-			channelOrder = ( imageSource->hasAlpha() ) ? ImageIo::YA : ImageIo::Y;
-			isGray = true;
-		break;
-		default: // if this is some other color space, we'll have to punt and go w/ RGB
-			dataFormat = ( imageSource->hasAlpha() ) ? GL_RGBA : GL_RGB;
-			channelOrder = ( imageSource->hasAlpha() ) ? ImageIo::RGBA : ImageIo::RGB;
-		break;
-	}
+} // anonymous namespace
 
-	glGenTextures( 1, &mObj->mTextureID );
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+void Texture::initStreaming( const Format &format )
+{
+	mObj->mNumStreamBuffers = ( supportsPixelBufferObjects() ) ? std::max( format.mNumStreamBuffers, 0 ) : 0;
+}
 
-	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
-	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
-	glTexParameteri( mObj->mTarget, GL_TEXTURE_MIN_FILTER, format.mMinFilter );	
-	glTexParameteri( mObj->mTarget, GL_TEXTURE_MAG_FILTER, format.mMagFilter );
-	if( format.mMipmapping )
-		glTexParameteri( mObj->mTarget, GL_GENERATE_MIPMAP, GL_TRUE );
-	if( mObj->mTarget == GL_TEXTURE_2D ) {
-		mObj->mMaxU = mObj->mMaxV = 1.0f;
+bool Texture::isStreaming() const
+{
+	return mObj->mNumStreamBuffers > 0;
+}
+
+void* Texture::mapStreamBuffer( size_t numBytes )
+{
+#if ! defined( CINDER_GLES )
+	if( ! isStreaming() )
+		return 0;
+
+	if( mObj->mStreamBuffers.empty() ) {
+		mObj->mStreamBuffers.resize( mObj->mNumStreamBuffers );
+		glGenBuffers( mObj->mNumStreamBuffers, &mObj->mStreamBuffers[0] );
 	}
-	else {
-		mObj->mMaxU = (float)mObj->mWidth;
-		mObj->mMaxV = (float)mObj->mHeight;
-	}	
+	mObj->mStreamBufferIndex = ( mObj->mStreamBufferIndex + 1 ) % mObj->mStreamBuffers.size();
 
+	StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, mObj->mStreamBuffers[mObj->mStreamBufferIndex] );
+	// orphan the buffer's previous storage so mapping never waits on an upload that is still in flight
+	glBufferData( GL_PIXEL_UNPACK_BUFFER, numBytes, 0, GL_STREAM_DRAW );
+	void *result = glMapBuffer( GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY );
+	StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+	return result;
+#else
+	return 0;
+#endif
+}
+
+void Texture::unmapStreamBuffer( const Area &area, GLenum dataFormat, GLenum type, GLint rowLength )
+{
+	Batch2d::flush();
+#if ! defined( CINDER_GLES )
+	if( mObj->mStreamBuffers.empty() )
+		return;
+
+	StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, mObj->mStreamBuffers[mObj->mStreamBufferIndex] );
+	glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
-	if( imageSource->getDataType() == ImageIo::UINT8 ) {
-		shared_ptr<ImageTargetGLTexture<uint8_t> > target = ImageTargetGLTexture<uint8_t>::createRef( this, channelOrder, isGray, imageSource->hasAlpha() );
-		imageSource->load( target );
-		glTexImage2D( mObj->mTarget, 0, mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, 0, dataFormat, GL_UNSIGNED_BYTE, target->getData() );
-	}
-	else if( imageSource->getDataType() == ImageIo::UINT16 ) {
-		shared_ptr<ImageTargetGLTexture<uint16_t> > target = ImageTargetGLTexture<uint16_t>::createRef( this, channelOrder, isGray, imageSource->hasAlpha() );
-		imageSource->load( target );		
-		glTexImage2D( mObj->mTarget, 0, mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, 0, dataFormat, GL_UNSIGNED_SHORT, target->getData() );
-	
-	}
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, rowLength );
+	// with a buffer bound to GL_PIXEL_UNPACK_BUFFER the data pointer is an offset into it, and the call returns without waiting for the transfer
+	glTexSubImage2D( mObj->mTarget, 0, area.getX1(), area.getY1(), area.getWidth(), area.getHeight(), dataFormat, type, 0 );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+	StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+#endif
+}
+
+bool Texture::updateStreamed( const void *data, int32_t rowBytes, size_t pixelBytes, const Area &area, GLenum dataFormat, GLenum type )
+{
+	const size_t dstRowBytes = area.getWidth() * pixelBytes;
+	uint8_t *dst = reinterpret_cast<uint8_t*>( mapStreamBuffer( dstRowBytes * area.getHeight() ) );
+	if( ! dst )
+		return false;
+
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( data );
+	if( rowBytes == (int32_t)dstRowBytes )
+		memcpy( dst, src, dstRowBytes * area.getHeight() );
 	else {
-		shared_ptr<ImageTargetGLTexture<float> > target = ImageTargetGLTexture<float>::createRef( this, channelOrder, isGray, imageSource->hasAlpha() );
-		imageSource->load( target );		
-		glTexImage2D( mObj->mTarget, 0, mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, 0, dataFormat, GL_FLOAT, target->getData() );
+		for( int32_t y = 0; y < area.getHeight(); ++y, src += rowBytes, dst += dstRowBytes )
+			memcpy( dst, src, dstRowBytes );
 	}
+
+	unmapStreamBuffer( area, dataFormat, type );
+	return true;
 }
 
 void Texture::update( const Surface &surface )
 {
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
 	GLint dataFormat;
 	GLenum type;
 	SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &type );
 	if( ( surface.getWidth() != getWidth() ) || ( surface.getHeight() != getHeight() ) )
 		throw TextureDataExc( "Invalid Texture::update() surface dimensions" );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	if( updateStreamed( surface.getData(), surface.getRowBytes(), surface.getPixelInc(), getBounds(), dataFormat, type ) )
+		return;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
 #if ! defined( CINDER_GLES )
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / surface.getPixelInc() );
@@ -435,13 +591,18 @@ void Texture::update( const Surface &surface )
 
 void Texture::update( const Surface32f &surface )
 {
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
 	GLint dataFormat;
 	GLenum type;
 	SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &type );
 	if( ( surface.getWidth() != getWidth() ) || ( surface.getHeight() != getHeight() ) )
 		throw TextureDataExc( "Invalid Texture::update() surface dimensions" );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	if( updateStreamed( surface.getData(), surface.getRowBytes(), surface.getPixelInc() * sizeof(float), getBounds(), dataFormat, GL_FLOAT ) )
+		return;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
 #if ! defined( CINDER_GLES )
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / ( surface.getPixelInc() * sizeof(float)) );
@@ -453,28 +614,65 @@ void Texture::update( const Surface32f &surface )
 #endif
 }
 
+void Texture::update( const Surface16u &surface )
+{
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
+	const GLenum dataFormat = surface16uDataFormat( surface.getChannelOrder(), getInternalFormat() );
+	if( ( surface.getWidth() != getWidth() ) || ( surface.getHeight() != getHeight() ) )
+		throw TextureDataExc( "Invalid Texture::update() surface dimensions" );
+
+	if( updateStreamed( surface.getData(), surface.getRowBytes(), surface.getPixelInc() * sizeof(uint16_t), getBounds(), dataFormat, GL_UNSIGNED_SHORT ) )
+		return;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / ( surface.getPixelInc() * sizeof(uint16_t) ) );
+#endif
+	glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), dataFormat, GL_UNSIGNED_SHORT, surface.getData() );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+}
+
 void Texture::update( const Surface &surface, const Area &area )
 {
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
 	GLint dataFormat;
 	GLenum type;
 	SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &type );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );	
+	if( updateStreamed( surface.getData( area.getUL() ), surface.getRowBytes(), surface.getPixelInc(), area, dataFormat, type ) )
+		return;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );	
 	glTexSubImage2D( mObj->mTarget, 0, area.getX1(), area.getY1(), area.getWidth(), area.getHeight(), dataFormat, type, surface.getData( area.getUL() ) );
 }
 
 void Texture::update( const Channel32f &channel )
 {
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
 	if( ( channel.getWidth() != getWidth() ) || ( channel.getHeight() != getHeight() ) )
 		throw TextureDataExc( "Invalid Texture::update() channel dimensions" );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	if( channel.isPlanar() && updateStreamed( channel.getData(), channel.getRowBytes(), sizeof(float), getBounds(), GL_LUMINANCE, GL_FLOAT ) )
+		return;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), GL_LUMINANCE, GL_FLOAT, channel.getData() );
 }
 
 void Texture::update( const Channel8u &channel, const Area &area )
 {
-	glBindTexture( mObj->mTarget, mObj->mTextureID );	
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
+	if( channel.isPlanar() && updateStreamed( channel.getData( area.getUL() ), channel.getRowBytes(), sizeof(uint8_t), area, GL_LUMINANCE, GL_UNSIGNED_BYTE ) )
+		return;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );	
 	// if the data is not already contiguous, we'll need to create a block of memory that is
 	if( ( channel.getIncrement() != 1 ) || ( channel.getRowBytes() != channel.getWidth() * sizeof(uint8_t) ) ) {
 		shared_ptr<uint8_t> data( new uint8_t[area.getWidth() * area.getHeight()], checked_array_deleter<uint8_t>() );
@@ -495,6 +693,46 @@ void Texture::update( const Channel8u &channel, const Area &area )
 		glTexSubImage2D( mObj->mTarget, 0, area.getX1(), area.getY1(), area.getWidth(), area.getHeight(), GL_LUMINANCE, GL_UNSIGNED_BYTE, channel.getData( area.getUL() ) );
 }
 
+void Texture::update( const Channel16u &channel )
+{
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	Batch2d::flush();
+	if( ( channel.getWidth() != getWidth() ) || ( channel.getHeight() != getHeight() ) )
+		throw TextureDataExc( "Invalid Texture::update() channel dimensions" );
+
+	const GLenum dataFormat = channel16uDataFormat( getInternalFormat() );
+	if( channel.isPlanar() ) {
+		if( updateStreamed( channel.getData(), channel.getRowBytes(), sizeof(uint16_t), getBounds(), dataFormat, GL_UNSIGNED_SHORT ) )
+			return;
+	}
+	else if( isStreaming() ) {
+		// an interleaved channel is packed straight into the streaming buffer
+		uint16_t *dst = reinterpret_cast<uint16_t*>( mapStreamBuffer( getWidth() * getHeight() * sizeof(uint16_t) ) );
+		if( dst ) {
+			copyPacked( channel, getBounds(), dst );
+			unmapStreamBuffer( getBounds(), dataFormat, GL_UNSIGNED_SHORT );
+			return;
+		}
+	}
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	if( channel.isPlanar() ) {
+#if ! defined( CINDER_GLES )
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, channel.getRowBytes() / sizeof(uint16_t) );
+#endif
+		glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), dataFormat, GL_UNSIGNED_SHORT, channel.getData() );
+#if ! defined( CINDER_GLES )
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+	}
+	else {
+		vector<uint16_t> packed( getWidth() * getHeight() );
+		copyPacked( channel, getBounds(), &packed[0] );
+		glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), dataFormat, GL_UNSIGNED_SHORT, &packed[0] );
+	}
+}
+
 void Texture::SurfaceChannelOrderToDataFormatAndType( const SurfaceChannelOrder &sco, GLint *dataFormat, GLenum *type )
 {
 	switch( sco.getCode() ) {
@@ -557,194 +795,316 @@ bool Texture::dataFormatHasColor( GLint dataFormat )
 	return true;
 }
 
+int Texture::getInternalFormatBitsPerTexel( GLint internalFormat )
+{
+	switch( internalFormat ) {
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+			return 8;
+		case GL_LUMINANCE_ALPHA:
+			return 16;
+		// drivers pad 3 channels to 4
+		case GL_RGB:
+		case GL_RGBA:
+			return 32;
 #if ! defined( CINDER_GLES )
-Texture Texture::loadDds( IStreamRef ddsStream, Format format )
+		case GL_ALPHA8:
+		case GL_LUMINANCE8:
+			return 8;
+		case GL_LUMINANCE8_ALPHA8:
+		case GL_LUMINANCE16:
+		case GL_LUMINANCE16UI_EXT:
+		case GL_R16:
+		case GL_R16UI:
+		case GL_DEPTH_COMPONENT16:
+			return 16;
+		case GL_LUMINANCE16_ALPHA16:
+		case GL_LUMINANCE32F_ARB:
+		case GL_DEPTH_COMPONENT24:
+		case GL_DEPTH_COMPONENT32:
+		case GL_DEPTH24_STENCIL8_EXT:
+			return 32;
+		case GL_RGB16:
+		case GL_RGBA16:
+		case GL_RGB16UI_EXT:
+		case GL_RGBA16UI_EXT:
+		case GL_RGB16F_ARB:
+		case GL_RGBA16F_ARB:
+		case GL_LUMINANCE_ALPHA32F_ARB:
+			return 64;
+		case GL_RGB32F_ARB:
+		case GL_RGBA32F_ARB:
+			return 128;
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+			return 4;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+			return 8;
+#endif
+		default:
+			return 32;
+	}
+}
+
+void Texture::initMipLevels( const vector<pair<const uint8_t*,size_t> > &levels, GLenum dataFormat, GLenum type, const Format &format )
 {
-	typedef struct { // DDCOLORKEY
-		uint32_t dw1;
-		uint32_t dw2;
-	} ddColorKey;
-
-	typedef struct  { // DDSCAPS2
-		uint32_t dwCaps1;
-		uint32_t dwCaps2;
-		uint32_t Reserved[2];
-	} ddCaps2;
-
-	typedef struct _DDPIXELFORMAT { // DDPIXELFORMAT
-		uint32_t  dwSize;
-		uint32_t  dwFlags;
-		uint32_t  dwFourCC;
-		union {
-			uint32_t  dwRGBBitCount;
-			uint32_t  dwYUVBitCount;
-			uint32_t  dwZBufferBitDepth;
-			uint32_t  dwAlphaBitDepth;
-			uint32_t  dwLuminanceBitCount;
-			uint32_t  dwBumpBitCount;
-			uint32_t  dwPrivateFormatBitCount;
-		} ;
-		union {
-			uint32_t  dwRBitMask;
-			uint32_t  dwYBitMask;
-			uint32_t  dwStencilBitDepth;
-			uint32_t  dwLuminanceBitMask;
-			uint32_t  dwBumpDuBitMask;
-			uint32_t  dwOperations;
-		} ;
-		union {
-			uint32_t  dwGBitMask;
-			uint32_t  dwUBitMask;
-			uint32_t  dwZBitMask;
-			uint32_t  dwBumpDvBitMask;
-			struct {
-				int32_t wFlipMSTypes;
-				int32_t wBltMSTypes;
-			} MultiSampleCaps;
-		};
-		union {
-			uint32_t  dwBBitMask;
-			uint32_t  dwVBitMask;
-			uint32_t  dwStencilBitMask;
-			uint32_t  dwBumpLuminanceBitMask;
-		};
-		union {
-			uint32_t  dwRGBAlphaBitMask;
-			uint32_t  dwYUVAlphaBitMask;
-			uint32_t  dwLuminanceAlphaBitMask;
-			uint32_t  dwRGBZBitMask;
-			uint32_t  dwYUVZBitMask;
-		} ;
-	} ddPixelFormat;
-
-	typedef struct ddSurface // this is lifted and adapted from DDSURFACEDESC2
-	{
-		uint32_t               dwSize;                 // size of the DDSURFACEDESC structure
-		uint32_t               dwFlags;                // determines what fields are valid
-		uint32_t               dwHeight;               // height of surface to be created
-		uint32_t               dwWidth;                // width of input surface
-		union
-		{
-			int32_t            lPitch;                 // distance to start of next line (return value only)
-			uint32_t           dwLinearSize;           // Formless late-allocated optimized surface size
-		};
-		union
-		{
-			uint32_t           dwBackBufferCount;      // number of back buffers requested
-			uint32_t           dwDepth;                // the depth if this is a volume texture 
-		};
-		union
-		{
-			uint32_t			dwMipMapCount;          // number of mip-map levels requestde
-													// dwZBufferBitDepth removed, use ddpfPixelFormat one instead
-			uint32_t			dwRefreshRate;          // refresh rate (used when display mode is described)
-			uint32_t			dwSrcVBHandle;          // The source used in VB::Optimize
-		};
-		uint32_t				dwAlphaBitDepth;        // depth of alpha buffer requested
-		uint32_t				dwReserved;             // reserved
-		uint32_t				lpSurface;              // pointer to the associated surface memory
-		union
-		{
-			ddColorKey			ddckCKDestOverlay;      // color key for destination overlay use
-			uint32_t			dwEmptyFaceColor;       // Physical color for empty cubemap faces
-		};
-		ddColorKey          ddckCKDestBlt;          // color key for destination blt use
-		ddColorKey          ddckCKSrcOverlay;       // color key for source overlay use
-		ddColorKey          ddckCKSrcBlt;           // color key for source blt use
-		union
-		{
-			ddPixelFormat		ddpfPixelFormat;        // pixel format description of the surface
-			uint32_t			dwFVF;                  // vertex format description of vertex buffers
-		};
-		ddCaps2			ddsCaps;                // direct draw surface capabilities
-		uint32_t		dwTextureStage;         // stage in multitexture cascade
-	} ddSurface;
-	
-	enum { FOURCC_DXT1 = 0x31545844, FOURCC_DXT3 = 0x33545844, FOURCC_DXT5 = 0x35545844 };
+	CI_PROFILE_ZONE_CATEGORY( "gl::Texture upload", "gl" );
+	mObj->mDoNotDispose = false;
+	glGenTextures( 1, &mObj->mTextureID );
 
-	try {
-		ddSurface ddsd;
-		char filecode[4];
-		ddsStream->readData( filecode, 4 );
-		if( strncmp( filecode, "DDS ", 4 ) != 0 ) { 
-			return Texture();
-		}
+	// the file's own mip chain replaces hardware generated mipmaps
+	GLenum minFilter = format.mMinFilter;
+	if( levels.size() > 1 && ( minFilter == GL_LINEAR || minFilter == GL_NEAREST ) )
+		minFilter = ( minFilter == GL_LINEAR ) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
+	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
+	glTexParameteri( mObj->mTarget, GL_TEXTURE_MIN_FILTER, minFilter );
+	glTexParameteri( mObj->mTarget, GL_TEXTURE_MAG_FILTER, format.mMagFilter );
+#if ! defined( CINDER_GLES )
+	glTexParameteri( mObj->mTarget, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1 );
+#endif
+	if( format.mMipmapping && levels.size() == 1 && type != 0 )
+		glTexParameteri( mObj->mTarget, GL_GENERATE_MIPMAP, GL_TRUE );
 
-		ddsStream->readData( &ddsd, 124/*sizeof(ddsd)*/ );
-
-		// how big is it going to be including all mipmaps?
-		uint32_t bufSize = ( ddsd.dwMipMapCount > 1 ) ? ( ddsd.dwLinearSize * 2 ) : ( ddsd.dwLinearSize ); 
-		shared_ptr<uint8_t> pixels( new uint8_t[bufSize+1], checked_array_deleter<uint8_t>() );
-		ddsStream->readData( pixels.get(), bufSize ); 
-
-		uint32_t width = ddsd.dwWidth; 
-		uint32_t height = ddsd.dwHeight; 
-		//int numComponents  = (ddsd.ddpfPixelFormat.dwFourCC == FOURCC_DXT1) ? 3 : 4; 
-		int numMipMaps = ddsd.dwMipMapCount;
-		int dataFormat;
-		switch( ddsd.ddpfPixelFormat.dwFourCC ) { 
-			case FOURCC_DXT1: 
-				dataFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; 
-			break; 
-			case FOURCC_DXT3: 
-				dataFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; 
-			break; 
-			case FOURCC_DXT5: 
-				dataFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; 
-			break; 
-			default: 
-				return Texture();
+	if( mObj->mTarget == GL_TEXTURE_2D ) {
+		mObj->mMaxU = mObj->mMaxV = 1.0f;
+	}
+	else {
+		mObj->mMaxU = (float)mObj->mWidth;
+		mObj->mMaxV = (float)mObj->mHeight;
+	}
+
+	glPixelStorei( GL_UNPACK_ALIGNMENT, ( type == 0 ) ? 1 : 4 );
+	for( size_t level = 0; level < levels.size(); ++level ) {
+		GLsizei width = std::max<GLsizei>( 1, mObj->mWidth >> level );
+		GLsizei height = std::max<GLsizei>( 1, mObj->mHeight >> level );
+		// a type of 0 marks compressed data, which goes to the driver as-is
+		if( type == 0 )
+			glCompressedTexImage2D( mObj->mTarget, (GLint)level, mObj->mInternalFormat, width, height, 0, (GLsizei)levels[level].second, levels[level].first );
+		else
+			glTexImage2D( mObj->mTarget, (GLint)level, mObj->mInternalFormat, width, height, 0, dataFormat, type, levels[level].first );
+	}
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	countMemory( levels.size(), format.mMipmapping && levels.size() == 1 && type != 0 );
+}
+
+void Texture::countMemory( size_t numLevels, bool fullMipChain )
+{
+	const int bitsPerTexel = getInternalFormatBitsPerTexel( mObj->mInternalFormat );
+	int64_t bits = 0;
+	for( size_t level = 0; level < numLevels || fullMipChain; ++level ) {
+		const int64_t width = std::max<GLint>( 1, mObj->mWidth >> level ), height = std::max<GLint>( 1, mObj->mHeight >> level );
+		bits += width * height * bitsPerTexel;
+		if( width == 1 && height == 1 )
 			break;
-		} 
+	}
+	mObj->mAllocation.set( bits / 8 );
+}
 
-		off_t offset   = 0; 
-		uint32_t blockSize = ( dataFormat == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16; 
+namespace {
 
-		// Create the texture
-		GLenum target = format.mTarget;
-		GLuint texID;
-		glGenTextures( 1, &texID );
-		
-		Texture result( target, texID, width, height, false );
-		result.mObj->mWidth = width;
-		result.mObj->mHeight = height;
-		result.mObj->mInternalFormat = dataFormat;
+uint32_t readUint32( const uint8_t *data, bool swap = false )
+{
+	uint32_t result;
+	memcpy( &result, data, sizeof(result) );
+	if( swap )
+		result = ( result >> 24 ) | ( ( result >> 8 ) & 0xFF00 ) | ( ( result << 8 ) & 0xFF0000 ) | ( result << 24 );
+	return result;
+}
 
-		glBindTexture( result.mObj->mTarget, result.mObj->mTextureID );
-		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+} // anonymous namespace
 
-		// load the mipmaps
-		for( int i = 0; i <= numMipMaps && (width || height); ++i ) { 
-			if( width == 0 ) 
-				width = 1;
-			if( height == 0 ) 
-				height = 1; 
-
-			int size = ( (width+3) / 4 ) * ( (height+3) / 4 ) * blockSize; 
-			glCompressedTexImage2D( result.mObj->mTarget, i, dataFormat, width, height, 0, size, pixels.get() + offset );
-			 
-			offset += size; 
-			width  >>= 1; 
-			height >>= 1; 
-		}
+#if ! defined( CINDER_GLES )
 
-		if( numMipMaps > 1 ) {
-			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );	
-			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR );			
-		}
-		else {
-			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR );	
-			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR );	
-		}
-		
-		return result;
+namespace {
+
+// Returns the byte size of a (width x height) level stored in the block compressed \a internalFormat, or 0 if the format isn't known
+size_t calcDdsLevelSize( GLint internalFormat, uint32_t width, uint32_t height )
+{
+	size_t blockSize;
+	switch( internalFormat ) {
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+			blockSize = 8;
+		break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB:
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB:
+			blockSize = 16;
+		break;
+		default:
+			return 0;
+	}
+
+	return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * blockSize;
+}
+
+GLint ddsDxgiFormatToInternalFormat( uint32_t dxgiFormat )
+{
+	switch( dxgiFormat ) {
+		case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;			// DXGI_FORMAT_BC1_UNORM
+		case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;		// DXGI_FORMAT_BC1_UNORM_SRGB
+		case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;			// DXGI_FORMAT_BC2_UNORM
+		case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;		// DXGI_FORMAT_BC2_UNORM_SRGB
+		case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;			// DXGI_FORMAT_BC3_UNORM
+		case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;		// DXGI_FORMAT_BC3_UNORM_SRGB
+		case 80: return GL_COMPRESSED_RED_RGTC1;					// DXGI_FORMAT_BC4_UNORM
+		case 81: return GL_COMPRESSED_SIGNED_RED_RGTC1;				// DXGI_FORMAT_BC4_SNORM
+		case 83: return GL_COMPRESSED_RG_RGTC2;						// DXGI_FORMAT_BC5_UNORM
+		case 84: return GL_COMPRESSED_SIGNED_RG_RGTC2;				// DXGI_FORMAT_BC5_SNORM
+		case 95: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;	// DXGI_FORMAT_BC6H_UF16
+		case 96: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;	// DXGI_FORMAT_BC6H_SF16
+		case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;			// DXGI_FORMAT_BC7_UNORM
+		case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB;	// DXGI_FORMAT_BC7_UNORM_SRGB
+		default: return 0;
+	}
+}
+
+} // anonymous namespace
+
+Texture Texture::loadDds( IStreamRef ddsStream, Format format )
+{
+	try {
+		return loadDds( loadStreamBuffer( ddsStream ), format );
 	}
 	catch( ... ) {
 		return Texture();
 	}
 }
+
+Texture Texture::loadDds( DataSourceRef dataSource, Format format )
+{
+	return loadDds( dataSource->getBuffer(), format );
+}
+
+Texture Texture::loadDds( const Buffer &buffer, Format format )
+{
+	// offsets into DDS_HEADER, which follows the 4 byte magic number
+	enum { HEADER_SIZE = 124, HEIGHT = 8, WIDTH = 12, MIP_MAP_COUNT = 24, PF_FLAGS = 76, PF_FOURCC = 80, CAPS2 = 108 };
+	enum { DDPF_FOURCC = 0x4, DDSCAPS2_CUBEMAP = 0x200, DDSCAPS2_VOLUME = 0x200000 };
+	enum { DX10_HEADER_SIZE = 20, DX10_ARRAY_SIZE = 12 };
+
+	const uint8_t *data = reinterpret_cast<const uint8_t*>( buffer.getData() );
+	const size_t dataSize = buffer.getDataSize();
+	if( dataSize < 4 + HEADER_SIZE || memcmp( data, "DDS ", 4 ) != 0 )
+		throw TextureDataExc( "Not a DDS file" );
+
+	const uint8_t *header = data + 4;
+	const uint32_t width = readUint32( header + WIDTH );
+	const uint32_t height = readUint32( header + HEIGHT );
+	const uint32_t numLevels = std::max<uint32_t>( 1, readUint32( header + MIP_MAP_COUNT ) );
+	if( readUint32( header + CAPS2 ) & ( DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME ) )
+		throw TextureDataExc( "DDS cube maps and volume textures are not supported" );
+	if( ! ( readUint32( header + PF_FLAGS ) & DDPF_FOURCC ) )
+		throw TextureDataExc( "Only block compressed DDS files are supported" );
+
+	size_t offset = 4 + HEADER_SIZE;
+	GLint internalFormat = 0;
+	const uint32_t fourCC = readUint32( header + PF_FOURCC );
+	if( fourCC == 0x30315844 ) { // "DX10"
+		if( dataSize < offset + DX10_HEADER_SIZE )
+			throw TextureDataExc( "Truncated DDS file" );
+		if( readUint32( data + offset + DX10_ARRAY_SIZE ) > 1 )
+			throw TextureDataExc( "DDS texture arrays are not supported" );
+		internalFormat = ddsDxgiFormatToInternalFormat( readUint32( data + offset ) );
+		offset += DX10_HEADER_SIZE;
+	}
+	else {
+		switch( fourCC ) {
+			case 0x31545844: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;		// "DXT1"
+			case 0x33545844: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;		// "DXT3"
+			case 0x35545844: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;		// "DXT5"
+			case 0x31495441: case 0x55344342: internalFormat = GL_COMPRESSED_RED_RGTC1; break;	// "ATI1", "BC4U"
+			case 0x32495441: case 0x55354342: internalFormat = GL_COMPRESSED_RG_RGTC2; break;	// "ATI2", "BC5U"
+		}
+	}
+	if( internalFormat == 0 )
+		throw TextureDataExc( "Unsupported DDS pixel format" );
+
+	vector<pair<const uint8_t*,size_t> > levels;
+	for( uint32_t level = 0; level < numLevels && ( ( width >> level ) || ( height >> level ) ); ++level ) {
+		size_t levelSize = calcDdsLevelSize( internalFormat, std::max<uint32_t>( 1, width >> level ), std::max<uint32_t>( 1, height >> level ) );
+		if( offset + levelSize > dataSize )
+			throw TextureDataExc( "Truncated DDS file" );
+		levels.push_back( make_pair( data + offset, levelSize ) );
+		offset += levelSize;
+	}
+
+	Texture result;
+	result.mObj = shared_ptr<Obj>( new Obj( width, height ) );
+	result.mObj->mTarget = format.mTarget;
+	result.mObj->mInternalFormat = internalFormat;
+	result.initMipLevels( levels, 0, 0, format );
+	return result;
+}
+
 #endif // ! defined( CINDER_GLES )
 
+Texture Texture::loadKtx( DataSourceRef dataSource, Format format )
+{
+	return loadKtx( dataSource->getBuffer(), format );
+}
+
+Texture Texture::loadKtx( const Buffer &buffer, Format format )
+{
+	static const uint8_t sIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+	// indices of the uint32 header fields that follow the identifier
+	enum { ENDIANNESS, TYPE, TYPE_SIZE, FORMAT, INTERNAL_FORMAT, BASE_INTERNAL_FORMAT, PIXEL_WIDTH, PIXEL_HEIGHT, PIXEL_DEPTH,
+			NUM_ARRAY_ELEMENTS, NUM_FACES, NUM_MIPMAP_LEVELS, BYTES_OF_KEY_VALUE_DATA, NUM_HEADER_FIELDS };
+
+	const uint8_t *data = reinterpret_cast<const uint8_t*>( buffer.getData() );
+	const size_t dataSize = buffer.getDataSize();
+	if( dataSize < sizeof(sIdentifier) + NUM_HEADER_FIELDS * 4 || memcmp( data, sIdentifier, sizeof(sIdentifier) ) != 0 )
+		throw TextureDataExc( "Not a KTX file" );
+
+	const uint8_t *header = data + sizeof(sIdentifier);
+	const bool swap = readUint32( header ) == 0x01020304;
+	uint32_t fields[NUM_HEADER_FIELDS];
+	for( int f = 0; f < NUM_HEADER_FIELDS; ++f )
+		fields[f] = readUint32( header + f * 4, swap );
+
+	if( fields[NUM_FACES] != 1 || fields[NUM_ARRAY_ELEMENTS] > 1 || fields[PIXEL_DEPTH] > 1 )
+		throw TextureDataExc( "Only 2D KTX textures are supported" );
+	// compressed data is a byte stream, but uncompressed texels wider than a byte would need swapping
+	if( swap && fields[TYPE] != 0 && fields[TYPE_SIZE] > 1 )
+		throw TextureDataExc( "Unsupported KTX endianness" );
+
+	size_t offset = sizeof(sIdentifier) + NUM_HEADER_FIELDS * 4 + fields[BYTES_OF_KEY_VALUE_DATA];
+	const uint32_t numLevels = std::max<uint32_t>( 1, fields[NUM_MIPMAP_LEVELS] );
+	vector<pair<const uint8_t*,size_t> > levels;
+	for( uint32_t level = 0; level < numLevels; ++level ) {
+		if( offset + 4 > dataSize )
+			throw TextureDataExc( "Truncated KTX file" );
+		size_t imageSize = readUint32( data + offset, swap );
+		offset += 4;
+		if( offset + imageSize > dataSize )
+			throw TextureDataExc( "Truncated KTX file" );
+		levels.push_back( make_pair( data + offset, imageSize ) );
+		offset += ( imageSize + 3 ) & ~3; // mipPadding
+	}
+
+	Texture result;
+	result.mObj = shared_ptr<Obj>( new Obj( fields[PIXEL_WIDTH], std::max<uint32_t>( 1, fields[PIXEL_HEIGHT] ) ) );
+	result.mObj->mTarget = format.mTarget;
+	result.mObj->mInternalFormat = fields[INTERNAL_FORMAT];
+	result.initMipLevels( levels, fields[FORMAT], fields[TYPE], format );
+	return result;
+}
+
 Texture	Texture::weakClone() const
 {
 	gl::Texture result = Texture( mObj->mTarget, mObj->mTextureID, mObj->mWidth, mObj->mHeight, true );
@@ -941,26 +1301,26 @@ float Texture::getMaxV() const
 
 void Texture::bind( GLuint textureUnit ) const
 {
-	glActiveTexture( GL_TEXTURE0 + textureUnit );
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
-	glActiveTexture( GL_TEXTURE0 );
+	Batch2d::flush();
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID, textureUnit );
 }
 
 void Texture::unbind( GLuint textureUnit ) const
 {
-	glActiveTexture( GL_TEXTURE0 + textureUnit );
-	glBindTexture( mObj->mTarget, 0 );
-	glActiveTexture( GL_TEXTURE0 );
+	Batch2d::flush();
+	StateCache::bindTexture( mObj->mTarget, 0, textureUnit );
 }
 
 void Texture::enableAndBind() const
 {
+	Batch2d::flush();
 	glEnable( mObj->mTarget );
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 }
 
 void Texture::disable() const
 {
+	Batch2d::flush();
 	glDisable( mObj->mTarget );
 }
 
@@ -1024,40 +1384,182 @@ void TextureCache::Obj::TextureCacheDeallocator( void *aDeallocatorRefcon )
 }
 
 /////////////////////////////////////////////////////////////////////////////////
-// ImageTargetGLTexture
-template<typename T>
-shared_ptr<ImageTargetGLTexture<T> > ImageTargetGLTexture<T>::createRef( const Texture *aTexture, ImageIo::ChannelOrder &aChannelOrder, bool aIsGray, bool aHasAlpha )
+// TextureImageTarget
+TextureImageTargetRef TextureImageTarget::create( const ImageSourceRef &imageSource, const Texture::Format &format )
 {
-	return shared_ptr<ImageTargetGLTexture<T> >( new ImageTargetGLTexture<T>( aTexture, aChannelOrder, aIsGray, aHasAlpha ) );
+	return TextureImageTargetRef( new TextureImageTarget( imageSource, format ) );
 }
 
-template<typename T>
-ImageTargetGLTexture<T>::ImageTargetGLTexture( const Texture *aTexture, ImageIo::ChannelOrder &aChannelOrder, bool aIsGray, bool aHasAlpha )
-	: ImageTarget(), mTexture( aTexture ), mIsGray( aIsGray ), mHasAlpha( aHasAlpha )
+TextureImageTarget::TextureImageTarget( const ImageSourceRef &imageSource, const Texture::Format &format )
+	: ImageTarget(), mFormat( format ), mHasAlpha( imageSource->hasAlpha() ), mData( 0 ), mBuffer( 0 ), mFinished( false )
 {
-	if( mIsGray )
-		mPixelInc = ( mHasAlpha ) ? 2 : 1;
-	else
-		mPixelInc = ( mHasAlpha ) ? 4 : 3;
-	mRowInc = mTexture->getWidth() * mPixelInc;
-	// allocate enough room to hold all these pixels
-	mData = new T[mTexture->getHeight() * mRowInc];
+	mTexture.mObj = shared_ptr<Texture::Obj>( new Texture::Obj( imageSource->getWidth(), imageSource->getHeight() ) );
+	Texture::Obj *obj = mTexture.mObj.get();
+	obj->mDoNotDispose = false;
+	obj->mTarget = format.getTarget();
+	mTexture.initStreaming( format );
+
+#if defined( CINDER_MAC )
+	bool supportsTextureFloat = gl::isExtensionAvailable( "GL_ARB_texture_float" );
+#elif defined( CINDER_MSW )
+	bool supportsTextureFloat = GLEE_ARB_texture_float != 0;
+#endif
 	
-	if( boost::is_same<T,uint8_t>::value )
-		setDataType( ImageIo::UINT8 );
-	else if( boost::is_same<T,uint16_t>::value )
-		setDataType( ImageIo::UINT16 );
-	else if( boost::is_same<T,float>::value )
-		setDataType( ImageIo::FLOAT32 );		
+	// Set the internal format based on the image's color space
+	if( format.isAutoInternalFormat() ) {
+		switch( imageSource->getColorModel() ) {
+#if ! defined( CINDER_GLES )
+			case ImageIo::CM_RGB:
+				if( imageSource->getDataType() == ImageIo::UINT8 )
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_RGBA8 : GL_RGB8;
+				else if( imageSource->getDataType() == ImageIo::UINT16 )
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_RGBA16 : GL_RGB16;
+				else if( imageSource->getDataType() == ImageIo::FLOAT32 && supportsTextureFloat )
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_RGBA32F_ARB : GL_RGB32F_ARB;
+				else
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_RGBA : GL_RGB;
+			break;
+			case ImageIo::CM_GRAY:
+				if( imageSource->getDataType() == ImageIo::UINT8 )
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_LUMINANCE8_ALPHA8 : GL_LUMINANCE8;
+				else if( imageSource->getDataType() == ImageIo::UINT16 )
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_LUMINANCE16_ALPHA16 : GL_LUMINANCE16;
+				else if( imageSource->getDataType() == ImageIo::FLOAT32 && supportsTextureFloat )
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_LUMINANCE_ALPHA32F_ARB : GL_LUMINANCE32F_ARB;
+				else
+					obj->mInternalFormat = ( mHasAlpha ) ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+			break;
+#else
+			case ImageIo::CM_RGB:
+				obj->mInternalFormat = ( mHasAlpha ) ? GL_RGBA : GL_RGB;
+			break;
+			case ImageIo::CM_GRAY:
+				obj->mInternalFormat = ( mHasAlpha ) ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+			break;
+			
+#endif
+			default:
+				throw ImageIoExceptionIllegalColorModel( "Illegal color model." );
+			break;
+		}
+	}
+	else {
+		obj->mInternalFormat = format.getInternalFormat();
+	}
+
+	// setup an appropriate dataFormat and channel order based on the image's color space
+	if( imageSource->getColorModel() == ImageIo::CM_GRAY ) {
+		mDataFormat = ( mHasAlpha ) ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+		setChannelOrder( ( mHasAlpha ) ? ImageIo::YA : ImageIo::Y );
+		setColorModel( ImageIo::CM_GRAY );
+	}
+	else { // if this is some other color space, we'll have to punt and go w/ RGB
+		mDataFormat = ( mHasAlpha ) ? GL_RGBA : GL_RGB;
+		setChannelOrder( ( mHasAlpha ) ? ImageIo::RGBA : ImageIo::RGB );
+		setColorModel( ImageIo::CM_RGB );
+	}
+
+	switch( imageSource->getDataType() ) {
+		case ImageIo::UINT8:
+			setDataType( ImageIo::UINT8 );
+			mType = GL_UNSIGNED_BYTE;
+		break;
+		case ImageIo::UINT16:
+			setDataType( ImageIo::UINT16 );
+			mType = GL_UNSIGNED_SHORT;
+		break;
+		default:
+			setDataType( ImageIo::FLOAT32 );
+			mType = GL_FLOAT;
+		break;
+	}
+	setSize( obj->mWidth, obj->mHeight );
+	mRowBytes = obj->mWidth * channelOrderNumChannels( getChannelOrder() ) * dataTypeBytes( getDataType() );
+	const size_t numBytes = mRowBytes * obj->mHeight;
+
+	glGenTextures( 1, &obj->mTextureID );
+	StateCache::bindTexture( obj->mTarget, obj->mTextureID );
+
+	glTexParameteri( obj->mTarget, GL_TEXTURE_WRAP_S, format.getWrapS() );
+	glTexParameteri( obj->mTarget, GL_TEXTURE_WRAP_T, format.getWrapT() );
+	glTexParameteri( obj->mTarget, GL_TEXTURE_MIN_FILTER, format.getMinFilter() );	
+	glTexParameteri( obj->mTarget, GL_TEXTURE_MAG_FILTER, format.getMagFilter() );
+	if( format.hasMipmapping() )
+		glTexParameteri( obj->mTarget, GL_GENERATE_MIPMAP, GL_TRUE );
+	if( obj->mTarget == GL_TEXTURE_2D ) {
+		obj->mMaxU = obj->mMaxV = 1.0f;
+	}
+	else {
+		obj->mMaxU = (float)obj->mWidth;
+		obj->mMaxV = (float)obj->mHeight;
+	}
+
+#if ! defined( CINDER_GLES )
+	// decode straight into a mapped pixel buffer object, which finish() then hands to glTexImage2D() as an offset
+	if( supportsPixelBufferObjects() ) {
+		glGenBuffers( 1, &mBuffer );
+		StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, mBuffer );
+		glBufferData( GL_PIXEL_UNPACK_BUFFER, numBytes, 0, GL_STREAM_DRAW );
+		mData = reinterpret_cast<uint8_t*>( glMapBuffer( GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY ) );
+		StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+		if( ! mData ) {
+			glDeleteBuffers( 1, &mBuffer );
+			StateCache::bufferDeleted( mBuffer );
+			mBuffer = 0;
+		}
+	}
+#endif
 
-	setChannelOrder( aChannelOrder );
-	setColorModel( mIsGray ? ImageIo::CM_GRAY : ImageIo::CM_RGB );
+	// otherwise stage the pixels in system memory
+	if( ! mData ) {
+		mStaging.resize( numBytes );
+		mData = &mStaging[0];
+	}
 }
 
-template<typename T>
-ImageTargetGLTexture<T>::~ImageTargetGLTexture()
+TextureImageTarget::~TextureImageTarget()
 {
-	delete [] mData;
+#if ! defined( CINDER_GLES )
+	if( mBuffer ) {
+		StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, mBuffer );
+		glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+		StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+		glDeleteBuffers( 1, &mBuffer );
+		StateCache::bufferDeleted( mBuffer );
+	}
+#endif
+}
+
+Texture TextureImageTarget::finish()
+{
+	if( mFinished )
+		return mTexture;
+	mFinished = true;
+
+	Texture::Obj *obj = mTexture.mObj.get();
+	StateCache::bindTexture( obj->mTarget, obj->mTextureID );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	if( mBuffer ) {
+		StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, mBuffer );
+		glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+		// the data pointer is an offset into the bound buffer; deleting the buffer right away is safe, the driver releases it once the transfer completes
+		glTexImage2D( obj->mTarget, 0, obj->mInternalFormat, obj->mWidth, obj->mHeight, 0, mDataFormat, mType, 0 );
+		StateCache::bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+		glDeleteBuffers( 1, &mBuffer );
+		StateCache::bufferDeleted( mBuffer );
+		mBuffer = 0;
+	}
+	else
+#endif
+	{
+		glTexImage2D( obj->mTarget, 0, obj->mInternalFormat, obj->mWidth, obj->mHeight, 0, mDataFormat, mType, mData );
+		std::vector<uint8_t>().swap( mStaging );
+	}
+	mData = 0;
+
+	mTexture.countMemory( 1, mFormat.hasMipmapping() );
+	return mTexture;
 }
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,214 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/TextureAtlas.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/ip/Fill.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+TextureAtlasRef TextureAtlas::create( int width, int height, const Texture::Format &format, int padding )
+{
+	return TextureAtlasRef( new TextureAtlas( width, height, format, padding ) );
+}
+
+TextureAtlas::TextureAtlas( int width, int height, const Texture::Format &format, int padding )
+	: mSurface( width, height, true, SurfaceChannelOrder::RGBA ), mPadding( padding )
+{
+	ip::fill( &mSurface, ColorA8u( 0, 0, 0, 0 ) );
+	mTexture = Texture( mSurface, format );
+
+	SkylineNode node = { 0, 0, width };
+	mSkyline.push_back( node );
+}
+
+TextureAtlas::Region TextureAtlas::insert( const Surface8u &surface )
+{
+	Vec2i pos;
+	if( ! pack( &mSkyline, surface.getWidth() + mPadding, surface.getHeight() + mPadding, &pos ) ) {
+		if( ( ! repack() ) || ( ! pack( &mSkyline, surface.getWidth() + mPadding, surface.getHeight() + mPadding, &pos ) ) )
+			return Region();
+	}
+
+	mSurface.copyFrom( surface, surface.getBounds(), pos );
+	RegionObjRef obj( new Region::Obj );
+	setRegionArea( obj.get(), Area( pos, pos + surface.getSize() ) );
+	mRegions.push_back( obj );
+	upload( obj->mArea );
+
+	return Region( obj );
+}
+
+void TextureAtlas::remove( const Region &region )
+{
+	vector<RegionObjRef>::iterator regionIt = std::find( mRegions.begin(), mRegions.end(), region.mObj );
+	if( regionIt != mRegions.end() )
+		mRegions.erase( regionIt );
+}
+
+bool TextureAtlas::repack()
+{
+	// Regions referenced only by the atlas itself have been abandoned
+	vector<RegionObjRef> live;
+	for( vector<RegionObjRef>::const_iterator regionIt = mRegions.begin(); regionIt != mRegions.end(); ++regionIt )
+		if( ! regionIt->unique() )
+			live.push_back( *regionIt );
+	// tallest first, which keeps the skyline flat
+	std::stable_sort( live.begin(), live.end(), [] ( const RegionObjRef &lhs, const RegionObjRef &rhs ) {
+		if( lhs->mArea.getHeight() != rhs->mArea.getHeight() )
+			return lhs->mArea.getHeight() > rhs->mArea.getHeight();
+		return lhs->mArea.getWidth() > rhs->mArea.getWidth();
+	} );
+
+	vector<SkylineNode> skyline;
+	SkylineNode node = { 0, 0, mSurface.getWidth() };
+	skyline.push_back( node );
+	vector<Vec2i> positions;
+	for( vector<RegionObjRef>::const_iterator regionIt = live.begin(); regionIt != live.end(); ++regionIt ) {
+		Vec2i pos;
+		if( ! pack( &skyline, (*regionIt)->mArea.getWidth() + mPadding, (*regionIt)->mArea.getHeight() + mPadding, &pos ) )
+			return false;
+		positions.push_back( pos );
+	}
+
+	Surface8u surface( mSurface.getWidth(), mSurface.getHeight(), true, SurfaceChannelOrder::RGBA );
+	ip::fill( &surface, ColorA8u( 0, 0, 0, 0 ) );
+	for( size_t r = 0; r < live.size(); ++r ) {
+		surface.copyFrom( mSurface, live[r]->mArea, positions[r] - live[r]->mArea.getUL() );
+		setRegionArea( live[r].get(), Area( positions[r], positions[r] + live[r]->mArea.getSize() ) );
+	}
+
+	mSurface = surface;
+	mSkyline.swap( skyline );
+	mRegions.swap( live );
+	upload( mSurface.getBounds() );
+
+	return true;
+}
+
+size_t TextureAtlas::getNumRegions() const
+{
+	return mRegions.size();
+}
+
+float TextureAtlas::getOccupancy() const
+{
+	int64_t covered = 0;
+	for( vector<RegionObjRef>::const_iterator regionIt = mRegions.begin(); regionIt != mRegions.end(); ++regionIt )
+		if( ! regionIt->unique() )
+			covered += (*regionIt)->mArea.calcArea();
+
+	return covered / (float)( mSurface.getWidth() * mSurface.getHeight() );
+}
+
+// Bottom-left skyline packing: among all the skyline nodes the rectangle can start at, picks the one leaving its top edge lowest
+bool TextureAtlas::pack( vector<SkylineNode> *skyline, int width, int height, Vec2i *result ) const
+{
+	int bestY = -1, bestWidth = 0;
+	size_t bestIndex = 0;
+	for( size_t n = 0; n < skyline->size(); ++n ) {
+		int y = fitSkylineNode( *skyline, n, width, height );
+		if( y < 0 )
+			continue;
+		if( ( bestY < 0 ) || ( y < bestY ) || ( ( y == bestY ) && ( (*skyline)[n].mWidth < bestWidth ) ) ) {
+			bestY = y;
+			bestWidth = (*skyline)[n].mWidth;
+			bestIndex = n;
+		}
+	}
+	if( bestY < 0 )
+		return false;
+
+	*result = Vec2i( (*skyline)[bestIndex].mX, bestY );
+
+	// raise the skyline under the new rectangle, trimming or removing the nodes it covers
+	SkylineNode node = { result->x, bestY + height, width };
+	skyline->insert( skyline->begin() + bestIndex, node );
+	for( size_t n = bestIndex + 1; n < skyline->size(); ) {
+		const SkylineNode &prev = (*skyline)[n - 1];
+		SkylineNode &cur = (*skyline)[n];
+		if( cur.mX >= prev.mX + prev.mWidth )
+			break;
+		int shrink = prev.mX + prev.mWidth - cur.mX;
+		cur.mX += shrink;
+		cur.mWidth -= shrink;
+		if( cur.mWidth > 0 )
+			break;
+		skyline->erase( skyline->begin() + n );
+	}
+
+	// merge neighbouring nodes at the same height
+	for( size_t n = 0; n + 1 < skyline->size(); ) {
+		if( (*skyline)[n].mY == (*skyline)[n + 1].mY ) {
+			(*skyline)[n].mWidth += (*skyline)[n + 1].mWidth;
+			skyline->erase( skyline->begin() + n + 1 );
+		}
+		else
+			++n;
+	}
+
+	return true;
+}
+
+// Returns the lowest y at which a rectangle starting at node \a index fits, or -1 if it doesn't fit there
+int TextureAtlas::fitSkylineNode( const vector<SkylineNode> &skyline, size_t index, int width, int height ) const
+{
+	// the padding trailing the rectangle may hang over the atlas edges
+	const int atlasWidth = mSurface.getWidth() + mPadding, atlasHeight = mSurface.getHeight() + mPadding;
+	if( skyline[index].mX + width > atlasWidth )
+		return -1;
+
+	int y = 0;
+	for( int widthLeft = width; ( widthLeft > 0 ) && ( index < skyline.size() ); ++index ) {
+		y = std::max( y, skyline[index].mY );
+		if( y + height > atlasHeight )
+			return -1;
+		widthLeft -= skyline[index].mWidth;
+	}
+
+	return y;
+}
+
+void TextureAtlas::setRegionArea( Region::Obj *region, const Area &area ) const
+{
+	region->mArea = area;
+	region->mTexCoords = mTexture.getAreaTexCoords( area );
+}
+
+void TextureAtlas::upload( const Area &area )
+{
+	// the batch may still hold draws referring to the previous contents
+	Batch2d::flush();
+
+	Surface8u packed( area.getWidth(), area.getHeight(), true, SurfaceChannelOrder::RGBA );
+	packed.copyFrom( mSurface, area, -area.getUL() );
+
+	StateCache::bindTexture( mTexture.getTarget(), mTexture.getId() );
+	glTexSubImage2D( mTexture.getTarget(), 0, area.getX1(), area.getY1(), area.getWidth(), area.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, packed.getData() );
+}
+
+} } // namespace cinder::gl
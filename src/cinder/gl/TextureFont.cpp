@@ -21,6 +21,7 @@
 */
 
 #include "cinder/gl/TextureFont.h"
+#include "cinder/gl/StateCache.h"
 
 #include "cinder/Text.h"
 #include "cinder/ip/Fill.h"
@@ -35,6 +36,8 @@
 	#endif
 #endif
 #include "cinder/Unicode.h"
+#include "cinder/TaskPool.h"
+#include "cinder/MemoryStats.h"
 
 #include <set>
 
@@ -48,13 +51,175 @@ using namespace std;
 
 namespace cinder { namespace gl {
 
+namespace {
+
+#if ! defined( CINDER_GLES )
+const char *sDistanceFieldVertexShader =
+	"void main() {\n"
+	"	gl_Position = ftransform();\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_FrontColor = gl_Color;\n"
+	"}\n";
+
+// the distance field is in the alpha channel, with the glyph edge at 0.5; fwidth() keeps the edge about a pixel wide at any scale
+const char *sDistanceFieldFragmentShader =
+	"uniform sampler2D tex;\n"
+	"uniform bool premultiplied;\n"
+	"void main() {\n"
+	"	float dist = texture2D( tex, gl_TexCoord[0].st ).a;\n"
+	"	float width = fwidth( dist );\n"
+	"	float alpha = gl_Color.a * smoothstep( 0.5 - width, 0.5 + width, dist );\n"
+	"	gl_FragColor = vec4( premultiplied ? gl_Color.rgb * alpha : gl_Color.rgb, alpha );\n"
+	"}\n";
+#endif
+
+// One-dimensional squared Euclidean distance transform of the sampled function \a f, from Felzenszwalb & Huttenlocher, "Distance Transforms of Sampled Functions"
+void distanceTransform1d( const float *f, float *d, int n, int *v, float *z )
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -numeric_limits<float>::max();
+	z[1] = numeric_limits<float>::max();
+	for( int q = 1; q < n; ++q ) {
+		float s = ( ( f[q] + q * q ) - ( f[v[k]] + v[k] * v[k] ) ) / ( 2 * q - 2 * v[k] );
+		while( s <= z[k] ) {
+			--k;
+			s = ( ( f[q] + q * q ) - ( f[v[k]] + v[k] * v[k] ) ) / ( 2 * q - 2 * v[k] );
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k+1] = numeric_limits<float>::max();
+	}
+
+	k = 0;
+	for( int q = 0; q < n; ++q ) {
+		while( z[k+1] < q )
+			++k;
+		d[q] = ( q - v[k] ) * ( q - v[k] ) + f[v[k]];
+	}
+}
+
+// Replaces each element of \a grid, which is 0 at feature texels and "infinity" elsewhere, with its squared distance to the nearest feature texel
+void distanceTransform2d( vector<float> *grid, int width, int height )
+{
+	const int n = std::max( width, height );
+	vector<float> f( n ), d( n ), z( n + 1 );
+	vector<int> v( n );
+	for( int x = 0; x < width; ++x ) {
+		for( int y = 0; y < height; ++y )
+			f[y] = (*grid)[y * width + x];
+		distanceTransform1d( &f[0], &d[0], height, &v[0], &z[0] );
+		for( int y = 0; y < height; ++y )
+			(*grid)[y * width + x] = d[y];
+	}
+	for( int y = 0; y < height; ++y ) {
+		distanceTransform1d( &(*grid)[y * width], &d[0], width, &v[0], &z[0] );
+		std::copy( d.begin(), d.begin() + width, grid->begin() + y * width );
+	}
+}
+
+// Returns \a coverage as GL_LUMINANCE_ALPHA texels, white unless \a premultiply
+vector<uint8_t> toLuminanceAlpha( const Channel8u &coverage, bool premultiply )
+{
+	vector<uint8_t> result( coverage.getWidth() * coverage.getHeight() * 2 );
+	Channel8u::ConstIter iter = coverage.getIter();
+	size_t offset = 0;
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			result[offset+0] = ( premultiply ) ? iter.v() : 255;
+			result[offset+1] = iter.v();
+			offset += 2;
+		}
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+void TextureFont::convertToDistanceField( Channel8u *channel, int32_t spread )
+{
+	const int width = channel->getWidth(), height = channel->getHeight();
+	const float inf = 1e20f;
+	vector<float> inside( width * height ), outside( width * height );
+
+	Channel8u::Iter iter = channel->getIter();
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			const size_t index = iter.y() * width + iter.x();
+			const bool in = iter.v() >= 128;
+			outside[index] = ( in ) ? 0 : inf; // distance to the glyph, for texels outside of it
+			inside[index] = ( in ) ? inf : 0; // distance to the background, for texels inside the glyph
+		}
+	}
+
+	distanceTransform2d( &outside, width, height );
+	distanceTransform2d( &inside, width, height );
+
+	// map signed distance in [-spread,spread] to [0,255], with the edge at 128
+	iter = channel->getIter();
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			const size_t index = iter.y() * width + iter.x();
+			const float dist = math<float>::sqrt( outside[index] ) - math<float>::sqrt( inside[index] );
+			const float v = 0.5f - dist / ( 2.0f * spread );
+			iter.v() = (uint8_t)( constrain( v, 0.0f, 1.0f ) * 255 + 0.5f );
+		}
+	}
+}
+
+TextureFont::ScopedDistanceField::ScopedDistanceField( const TextureFont &font )
+	: mEnabled( font.isSignedDistanceField() )
+{
+	if( ! mEnabled )
+		return;
+#if defined( CINDER_GLES )
+	mOldAlphaTest = glIsEnabled( GL_ALPHA_TEST );
+	glGetIntegerv( GL_ALPHA_TEST_FUNC, &mOldAlphaFunc );
+	glGetFloatv( GL_ALPHA_TEST_REF, &mOldAlphaRef );
+	StateCache::setCapability( GL_ALPHA_TEST, true );
+	glAlphaFunc( GL_GEQUAL, 0.5f );
+#else
+	glGetIntegerv( GL_CURRENT_PROGRAM, &mOldProgram );
+	GlslProg shader = font.mDistanceFieldShader;
+	shader.bind();
+	shader.uniform( "tex", 0 );
+	shader.uniform( "premultiplied", (int)font.isPremultiplied() );
+#endif
+}
+
+TextureFont::ScopedDistanceField::~ScopedDistanceField()
+{
+	if( ! mEnabled )
+		return;
+#if defined( CINDER_GLES )
+	glAlphaFunc( mOldAlphaFunc, mOldAlphaRef );
+	if( ! mOldAlphaTest )
+		StateCache::setCapability( GL_ALPHA_TEST, false );
+#else
+	StateCache::useProgram( mOldProgram );
+#endif
+}
+
 #if defined( CINDER_COCOA )
 TextureFont::TextureFont( const Font &font, const string &supportedChars, const TextureFont::Format &format )
 	: mFont( font ), mFormat( format )
 {
+	// glyph atlases are reported under their own category rather than as plain gl::Textures
+	ScopedMemoryCategory memoryCategory( "gl::TextureFont" );
+
 	// get the glyph indices we'll need
 	vector<Font::Glyph>	tempGlyphs = font.getGlyphs( supportedChars );
 	set<Font::Glyph> glyphs( tempGlyphs.begin(), tempGlyphs.end() );
+	if( mFormat.isFreeType() ) {
+		initFreeType( glyphs );
+		return;
+	}
+	if( mFormat.hasDynamicGlyphs() ) {
+		initDynamicGlyphs( glyphs );
+		return;
+	}
 	// determine the max glyph extents
 	Vec2f glyphExtents = Vec2f::zero();
 	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt ) {
@@ -66,8 +231,9 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 	glyphExtents.x = ceil( glyphExtents.x );
 	glyphExtents.y = ceil( glyphExtents.y );
 
-	int glyphsWide = floor( mFormat.getTextureWidth() / (glyphExtents.x+3) );
-	int glyphsTall = floor( mFormat.getTextureHeight() / (glyphExtents.y+5) );	
+	const int32_t pad = getGlyphPadding();
+	int glyphsWide = floor( mFormat.getTextureWidth() / (glyphExtents.x+3+2*pad) );
+	int glyphsTall = floor( mFormat.getTextureHeight() / (glyphExtents.y+5+2*pad) );	
 	uint8_t curGlyphIndex = 0, curTextureIndex = 0;
 	Vec2i curOffset = Vec2i::zero();
 	CGGlyph renderGlyphs[glyphsWide*glyphsTall];
@@ -89,22 +255,29 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 		GlyphInfo newInfo;
 		newInfo.mTextureIndex = curTextureIndex;
 		Rectf bb = font.getGlyphBoundingBox( *glyphIt );
-		Vec2f ul = curOffset + Vec2f( 0, glyphExtents.y - bb.getHeight() );
-		Vec2f lr = curOffset + Vec2f( glyphExtents.x, glyphExtents.y );
-		newInfo.mTexCoords = Area( floor( ul.x ), floor( ul.y ), ceil( lr.x ) + 3, ceil( lr.y ) + 2 );
-		newInfo.mOriginOffset.x = floor(bb.x1) - 1;
-		newInfo.mOriginOffset.y = -(bb.getHeight()-1)-ceil( bb.y1+0.5f );
+		Vec2i glyphOffset = curOffset + Vec2i( pad, pad );
+		Vec2f ul = glyphOffset + Vec2f( 0, glyphExtents.y - bb.getHeight() );
+		Vec2f lr = glyphOffset + Vec2f( glyphExtents.x, glyphExtents.y );
+		newInfo.mTexCoords = Area( floor( ul.x ) - pad, floor( ul.y ) - pad, ceil( lr.x ) + 3 + pad, ceil( lr.y ) + 2 + pad );
+		newInfo.mOriginOffset.x = floor(bb.x1) - 1 - pad;
+		newInfo.mOriginOffset.y = -(bb.getHeight()-1)-ceil( bb.y1+0.5f ) - pad;
 		mGlyphMap[*glyphIt] = newInfo;
 		renderGlyphs[curGlyphIndex] = *glyphIt;
-		renderPositions[curGlyphIndex].x = curOffset.x - floor(bb.x1) + 1;
-		renderPositions[curGlyphIndex].y = surface.getHeight() - (curOffset.y + glyphExtents.y) - ceil(bb.y1+0.5f);
-		curOffset += Vec2i( glyphExtents.x + 3, 0 );
+		renderPositions[curGlyphIndex].x = glyphOffset.x - floor(bb.x1) + 1;
+		renderPositions[curGlyphIndex].y = surface.getHeight() - (glyphOffset.y + glyphExtents.y) - ceil(bb.y1+0.5f);
+		curOffset += Vec2i( glyphExtents.x + 3 + 2 * pad, 0 );
 		++glyphIt;
 		if( ( ++curGlyphIndex == glyphsWide * glyphsTall ) || ( glyphIt == glyphs.end() ) ) {
 			::CGContextShowGlyphsAtPositions( cgContext, renderGlyphs, renderPositions, curGlyphIndex );
 			
+			if( mFormat.isSignedDistanceField() ) {
+				Channel8u distanceField = surface.getChannelAlpha().clone();
+				convertToDistanceField( &distanceField, pad );
+				ip::fill( &surface, ColorA8u( 255, 255, 255, 255 ) );
+				surface.getChannelAlpha().copyFrom( distanceField, distanceField.getBounds() );
+			}
 			// pass premultiply and mipmapping preferences to Texture::Format
-			if( ! mFormat.getPremultiply() )
+			else if( ! mFormat.getPremultiply() )
 				ip::unpremultiply( &surface );
 
 			gl::Texture::Format textureFormat = gl::Texture::Format();
@@ -134,11 +307,49 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 		}
 		else if( ( curGlyphIndex ) % glyphsWide == 0 ) { // wrap around
 			curOffset.x = 0;
-			curOffset.y += glyphExtents.y + 2;
+			curOffset.y += glyphExtents.y + 2 + 2 * pad;
 		}
 	}
 
 	::CGContextRelease( cgContext );
+
+#if ! defined( CINDER_GLES )
+	if( mFormat.isSignedDistanceField() )
+		mDistanceFieldShader = GlslProg( sDistanceFieldVertexShader, sDistanceFieldFragmentShader );
+#endif
+}
+
+bool TextureFont::rasterizeGlyph( Font::Glyph glyph, int32_t pad, Channel8u *coverage, GlyphInfo *info ) const
+{
+	if( mFreeTypeFont )
+		return rasterizeFreeTypeGlyph( glyph, pad, coverage, info );
+
+	// same placement as the constructor, but relative to a cell sized for this glyph alone
+	Rectf bb = mFont.getGlyphBoundingBox( glyph );
+	Vec2f glyphExtents( ceil( bb.getWidth() ), ceil( bb.getHeight() ) );
+	Vec2i glyphOffset( pad, pad );
+
+	Surface surface( coverage->getWidth(), coverage->getHeight(), true );
+	ip::fill( &surface, ColorA8u( 0, 0, 0, 0 ) );
+	::CGContextRef cgContext = cocoa::createCgBitmapContext( surface );
+	::CGContextSetRGBFillColor( cgContext, 1, 1, 1, 1 );
+	::CGContextSetFont( cgContext, mFont.getCgFontRef() );
+	::CGContextSetFontSize( cgContext, mFont.getSize() );
+	::CGContextSetTextMatrix( cgContext, CGAffineTransformIdentity );
+	CGGlyph renderGlyph = glyph;
+	CGPoint renderPosition;
+	renderPosition.x = glyphOffset.x - floor(bb.x1) + 1;
+	renderPosition.y = surface.getHeight() - (glyphOffset.y + glyphExtents.y) - ceil(bb.y1+0.5f);
+	::CGContextShowGlyphsAtPositions( cgContext, &renderGlyph, &renderPosition, 1 );
+	::CGContextRelease( cgContext );
+
+	Vec2f ul = glyphOffset + Vec2f( 0, glyphExtents.y - bb.getHeight() );
+	Vec2f lr = glyphOffset + glyphExtents;
+	info->mTexCoords = Area( floor( ul.x ) - pad, floor( ul.y ) - pad, std::min<int32_t>( ceil( lr.x ) + 3 + pad, surface.getWidth() ), std::min<int32_t>( ceil( lr.y ) + 2 + pad, surface.getHeight() ) );
+	info->mOriginOffset.x = floor(bb.x1) - 1 - pad;
+	info->mOriginOffset.y = -(bb.getHeight()-1)-ceil( bb.y1+0.5f ) - pad;
+	coverage->copyFrom( surface.getChannelAlpha(), surface.getBounds() );
+	return true;
 }
 
 #elif defined( CINDER_MSW )
@@ -199,8 +410,19 @@ set<Font::Glyph> getNecessaryGlyphs( const Font &font, const string &supportedCh
 TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Format &format )
 	: mFont( font ), mFormat( format )
 {
+	// glyph atlases are reported under their own category rather than as plain gl::Textures
+	ScopedMemoryCategory memoryCategory( "gl::TextureFont" );
+
 	// get the glyph indices we'll need
 	set<Font::Glyph> glyphs = getNecessaryGlyphs( font, utf8Chars );
+	if( mFormat.isFreeType() ) {
+		initFreeType( glyphs );
+		return;
+	}
+	if( mFormat.hasDynamicGlyphs() ) {
+		initDynamicGlyphs( glyphs );
+		return;
+	}
 	// determine the max glyph extents
 	Vec2i glyphExtents = Vec2f::zero();
 	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt ) {
@@ -218,8 +440,9 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 	if( ( glyphExtents.x == 0 ) || ( glyphExtents.y == 0 ) )
 		return;
 
-	int glyphsWide = mFormat.getTextureWidth() / glyphExtents.x;
-	int glyphsTall = mFormat.getTextureHeight() / glyphExtents.y;	
+	const int32_t pad = getGlyphPadding();
+	int glyphsWide = mFormat.getTextureWidth() / ( glyphExtents.x + 2 * pad );
+	int glyphsTall = mFormat.getTextureHeight() / ( glyphExtents.y + 2 * pad );	
 	uint8_t curGlyphIndex = 0, curTextureIndex = 0;
 	Vec2i curOffset = Vec2i::zero();
 
@@ -256,17 +479,19 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 
 		int32_t alignedRowBytes = ( gm.gmBlackBoxX & 3 ) ? ( gm.gmBlackBoxX + 4 - ( gm.gmBlackBoxX & 3 ) ) : gm.gmBlackBoxX;
 		Channel glyphChannel( gm.gmBlackBoxX, gm.gmBlackBoxY, alignedRowBytes, 1, pBuff );
-		channel.copyFrom( glyphChannel, glyphChannel.getBounds(), curOffset );
+		channel.copyFrom( glyphChannel, glyphChannel.getBounds(), curOffset + Vec2i( pad, pad ) );
 
 		GlyphInfo newInfo;
-		newInfo.mOriginOffset = Vec2f( gm.gmptGlyphOrigin.x, glyphExtents.y - gm.gmptGlyphOrigin.y );
-		newInfo.mTexCoords = Area( curOffset, curOffset + Vec2i( gm.gmBlackBoxX, gm.gmBlackBoxY ) );
+		newInfo.mOriginOffset = Vec2f( gm.gmptGlyphOrigin.x - pad, glyphExtents.y - gm.gmptGlyphOrigin.y - pad );
+		newInfo.mTexCoords = Area( curOffset, curOffset + Vec2i( gm.gmBlackBoxX + 2 * pad, gm.gmBlackBoxY + 2 * pad ) );
 		newInfo.mTextureIndex = curTextureIndex;
 		mGlyphMap[*glyphIt] = newInfo;
 
-		curOffset += Vec2i( glyphExtents.x, 0 );
+		curOffset += Vec2i( glyphExtents.x + 2 * pad, 0 );
 		++glyphIt;
 		if( ( ++curGlyphIndex == glyphsWide * glyphsTall ) || ( glyphIt == glyphs.end() ) ) {
+			if( mFormat.isSignedDistanceField() )
+				convertToDistanceField( &channel, pad );
 			Surface tempSurface( channel, SurfaceConstraintsDefault(), true );
 			tempSurface.getChannelAlpha().copyFrom( channel, channel.getBounds() );
 			if( ! format.getPremultiply() )
@@ -283,16 +508,258 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 		}
 		else if( ( curGlyphIndex ) % glyphsWide == 0 ) { // wrap around
 			curOffset.x = 0;
-			curOffset.y += glyphExtents.y;
+			curOffset.y += glyphExtents.y + 2 * pad;
 		}
 	}
 
 	delete [] pBuff;
+
+	if( mFormat.isSignedDistanceField() )
+		mDistanceFieldShader = GlslProg( sDistanceFieldVertexShader, sDistanceFieldFragmentShader );
+}
+
+bool TextureFont::rasterizeGlyph( Font::Glyph glyph, int32_t pad, Channel8u *coverage, GlyphInfo *info ) const
+{
+	if( mFreeTypeFont )
+		return rasterizeFreeTypeGlyph( glyph, pad, coverage, info );
+
+	::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+
+	GLYPHMETRICS gm = { 0, };
+	MAT2 identityMatrix = { {0,1},{0,0},{0,0},{0,1} };
+	DWORD dwBuffSize = ::GetGlyphOutline( Font::getGlobalDc(), glyph, GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX, &gm, 0, NULL, &identityMatrix );
+	if( ( dwBuffSize == 0 ) || ( dwBuffSize == GDI_ERROR ) )
+		return false;
+
+	vector<BYTE> buffer( dwBuffSize );
+	if( ::GetGlyphOutline( Font::getGlobalDc(), glyph, GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX, &gm, dwBuffSize, &buffer[0], &identityMatrix ) == GDI_ERROR )
+		return false;
+
+	// convert 6bit to 8bit gray
+	for( DWORD p = 0; p < dwBuffSize; ++p )
+		buffer[p] = ((uint32_t)buffer[p]) * 255 / 64;
+
+	int32_t alignedRowBytes = ( gm.gmBlackBoxX & 3 ) ? ( gm.gmBlackBoxX + 4 - ( gm.gmBlackBoxX & 3 ) ) : gm.gmBlackBoxX;
+	Channel glyphChannel( gm.gmBlackBoxX, gm.gmBlackBoxY, alignedRowBytes, 1, &buffer[0] );
+	coverage->copyFrom( glyphChannel, glyphChannel.getBounds(), Vec2i( pad, pad ) );
+
+	// the ascent stands in for the constructor's maximum glyph height, since not every glyph is known up front
+	info->mOriginOffset = Vec2f( gm.gmptGlyphOrigin.x - pad, ceil( mFont.getAscent() ) - gm.gmptGlyphOrigin.y - pad );
+	info->mTexCoords = Area( 0, 0, std::min<int32_t>( gm.gmBlackBoxX + 2 * pad, coverage->getWidth() ), std::min<int32_t>( gm.gmBlackBoxY + 2 * pad, coverage->getHeight() ) );
+	return true;
+}
+#endif
+
+void TextureFont::initFreeType( const set<Font::Glyph> &glyphSet )
+{
+	mFreeTypeFont = FreeTypeFont( mFont );
+	if( mFormat.hasDynamicGlyphs() ) {
+		initDynamicGlyphs( glyphSet );
+		return;
+	}
+
+	// rasterize the glyphs and convert them to distance fields in parallel, each thread with a FreeType face of its own
+	const vector<Font::Glyph> glyphs( glyphSet.begin(), glyphSet.end() );
+	const int32_t pad = getGlyphPadding();
+	const bool distanceField = mFormat.isSignedDistanceField();
+	vector<Channel8u> coverages( glyphs.size() );
+	vector<Vec2i> bearings( glyphs.size() );
+	TaskPool::get()->parallelFor( 0, glyphs.size(), [&]( size_t first, size_t last ) {
+		for( size_t i = first; i < last; ++i ) {
+			Channel8u glyphCoverage;
+			if( ! mFreeTypeFont.renderGlyph( glyphs[i], &glyphCoverage, &bearings[i] ) )
+				continue;
+			coverages[i] = Channel8u( glyphCoverage.getWidth() + 2 * pad, glyphCoverage.getHeight() + 2 * pad );
+			ip::fill<uint8_t>( &coverages[i], 0 );
+			coverages[i].copyFrom( glyphCoverage, glyphCoverage.getBounds(), Vec2i( pad, pad ) );
+			if( distanceField )
+				convertToDistanceField( &coverages[i], pad );
+		}
+	} );
+
+	// pack them into rows, starting a new texture whenever one fills up
+	gl::Texture::Format textureFormat = gl::Texture::Format();
+	textureFormat.enableMipmapping( mFormat.hasMipmapping() );
+	textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
+	const bool premultiply = mFormat.getPremultiply() && ( ! distanceField );
+	Channel8u atlas( mFormat.getTextureWidth(), mFormat.getTextureHeight() );
+	ip::fill<uint8_t>( &atlas, 0 );
+	Vec2i curOffset = Vec2i::zero();
+	int32_t rowHeight = 0;
+	bool atlasEmpty = true;
+	for( size_t i = 0; i < glyphs.size(); ++i ) {
+		// glyphs without a bitmap, like spaces, are left out as the platform constructors leave them out
+		if( ! coverages[i] )
+			continue;
+		const Vec2i glyphSize = coverages[i].getSize();
+		if( ( glyphSize.x > atlas.getWidth() ) || ( glyphSize.y > atlas.getHeight() ) )
+			continue;
+		if( curOffset.x + glyphSize.x > atlas.getWidth() ) {
+			curOffset = Vec2i( 0, curOffset.y + rowHeight + 1 );
+			rowHeight = 0;
+		}
+		if( curOffset.y + glyphSize.y > atlas.getHeight() ) {
+			const vector<uint8_t> lumAlpha = toLuminanceAlpha( atlas, premultiply );
+			mTextures.push_back( gl::Texture( &lumAlpha[0], GL_LUMINANCE_ALPHA, atlas.getWidth(), atlas.getHeight(), textureFormat ) );
+			ip::fill<uint8_t>( &atlas, 0 );
+			curOffset = Vec2i::zero();
+			rowHeight = 0;
+		}
+
+		atlas.copyFrom( coverages[i], coverages[i].getBounds(), curOffset );
+		atlasEmpty = false;
+		GlyphInfo newInfo;
+		newInfo.mTextureIndex = (uint8_t)mTextures.size();
+		newInfo.mTexCoords = Area( curOffset, curOffset + glyphSize );
+		newInfo.mOriginOffset = Vec2f( (float)( bearings[i].x - pad ), mFont.getAscent() + bearings[i].y - pad );
+		mGlyphMap[glyphs[i]] = newInfo;
+
+		curOffset.x += glyphSize.x + 1;
+		rowHeight = std::max( rowHeight, glyphSize.y );
+	}
+	if( ! atlasEmpty ) {
+		const vector<uint8_t> lumAlpha = toLuminanceAlpha( atlas, premultiply );
+		mTextures.push_back( gl::Texture( &lumAlpha[0], GL_LUMINANCE_ALPHA, atlas.getWidth(), atlas.getHeight(), textureFormat ) );
+	}
+#if ! defined( CINDER_GLES )
+	if( mFormat.hasMipmapping() ) {
+		for( vector<gl::Texture>::iterator textureIt = mTextures.begin(); textureIt != mTextures.end(); ++textureIt )
+			textureIt->setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
+	}
+
+	if( distanceField )
+		mDistanceFieldShader = GlslProg( sDistanceFieldVertexShader, sDistanceFieldFragmentShader );
+#endif
+}
+
+bool TextureFont::rasterizeFreeTypeGlyph( Font::Glyph glyph, int32_t pad, Channel8u *coverage, GlyphInfo *info ) const
+{
+	Channel8u glyphCoverage;
+	Vec2i bearing;
+	if( ! mFreeTypeFont.renderGlyph( glyph, &glyphCoverage, &bearing ) )
+		return false;
+
+	coverage->copyFrom( glyphCoverage, glyphCoverage.getBounds(), Vec2i( pad, pad ) );
+	info->mOriginOffset = Vec2f( (float)( bearing.x - pad ), mFont.getAscent() + bearing.y - pad );
+	info->mTexCoords = Area( 0, 0, std::min<int32_t>( glyphCoverage.getWidth() + 2 * pad, coverage->getWidth() ), std::min<int32_t>( glyphCoverage.getHeight() + 2 * pad, coverage->getHeight() ) );
+	return true;
 }
+
+void TextureFont::initDynamicGlyphs( const set<Font::Glyph> &glyphs )
+{
+	// every cell is sized for a glyph of roughly an em square; larger glyphs are clipped
+	const int32_t pad = getGlyphPadding();
+	const int32_t lineHeight = (int32_t)ceil( mFont.getAscent() + mFont.getDescent() );
+	mCellSize = Vec2i( std::max<int32_t>( lineHeight, (int32_t)ceil( mFont.getSize() ) ) + 4 + 2 * pad, lineHeight + 3 + 2 * pad );
+	mCellsWide = mFormat.getTextureWidth() / mCellSize.x;
+	mCellsTall = mFormat.getTextureHeight() / mCellSize.y;
+	mNextCell = 0;
+	mUseCount = 0;
+
+#if ! defined( CINDER_GLES )
+	if( mFormat.isSignedDistanceField() )
+		mDistanceFieldShader = GlslProg( sDistanceFieldVertexShader, sDistanceFieldFragmentShader );
 #endif
 
+	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt )
+		cacheGlyph( *glyphIt );
+}
+
+void TextureFont::cacheGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures )
+{
+	if( ! mFormat.hasDynamicGlyphs() )
+		return;
+
+	++mUseCount;
+	for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		unordered_map<Font::Glyph, GlyphInfo>::iterator glyphInfoIt = mGlyphMap.find( glyphIt->first );
+		if( glyphInfoIt == mGlyphMap.end() )
+			cacheGlyph( glyphIt->first );
+		else if( glyphInfoIt->second.mCell >= 0 ) {
+			mLru.splice( mLru.begin(), mLru, glyphInfoIt->second.mLruPosition );
+			glyphInfoIt->second.mLastUsed = mUseCount;
+		}
+	}
+}
+
+void TextureFont::cacheGlyph( Font::Glyph glyph )
+{
+	ScopedMemoryCategory memoryCategory( "gl::TextureFont" );
+
+	const int32_t cellsPerTexture = mCellsWide * mCellsTall;
+	if( cellsPerTexture == 0 )
+		return;
+
+	// pending batched geometry may reference the cell we're about to overwrite
+	Batch2d::flush();
+
+	GlyphInfo info;
+	const int32_t pad = getGlyphPadding();
+	Channel8u coverage( mCellSize.x, mCellSize.y );
+	ip::fill<uint8_t>( &coverage, 0 );
+	if( ! rasterizeGlyph( glyph, pad, &coverage, &info ) ) {
+		// remember glyphs without a bitmap, like spaces, so they aren't retried
+		info.mTexCoords = Area( 0, 0, 0, 0 );
+		mGlyphMap[glyph] = info;
+		return;
+	}
+
+	// find a cell: a freed one, then a new one, and finally the least recently used glyph's, unless it's needed by the current draw
+	int32_t cell;
+	if( ! mFreeCells.empty() ) {
+		cell = mFreeCells.back();
+		mFreeCells.pop_back();
+	}
+	else if( ( mNextCell < cellsPerTexture * (int32_t)mTextures.size() ) || ( mFormat.getMaxTextures() <= 0 ) || ( (int32_t)mTextures.size() < mFormat.getMaxTextures() ) ) {
+		cell = mNextCell++;
+	}
+	else {
+		if( mLru.empty() )
+			return;
+		unordered_map<Font::Glyph, GlyphInfo>::iterator victimIt = mGlyphMap.find( mLru.back() );
+		if( victimIt->second.mLastUsed == mUseCount )
+			return;
+		cell = victimIt->second.mCell;
+		mLru.pop_back();
+		mGlyphMap.erase( victimIt );
+	}
+
+	const size_t textureIndex = cell / cellsPerTexture;
+	if( textureIndex >= mTextures.size() ) {
+		gl::Texture::Format textureFormat = gl::Texture::Format();
+		textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
+		vector<uint8_t> blank( mFormat.getTextureWidth() * mFormat.getTextureHeight() * 2, 0 );
+		mTextures.push_back( gl::Texture( &blank[0], GL_LUMINANCE_ALPHA, mFormat.getTextureWidth(), mFormat.getTextureHeight(), textureFormat ) );
+	}
+	const Vec2i cellOffset( ( cell % cellsPerTexture ) % mCellsWide * mCellSize.x, ( cell % cellsPerTexture ) / mCellsWide * mCellSize.y );
+
+	if( mFormat.isSignedDistanceField() )
+		convertToDistanceField( &coverage, pad );
+
+	// white luminance unless premultiplied, matching the constructors' atlases
+	const vector<uint8_t> lumAlpha = toLuminanceAlpha( coverage, mFormat.getPremultiply() && ( ! mFormat.isSignedDistanceField() ) );
+
+	const gl::Texture &texture = mTextures[textureIndex];
+	SaveTextureBindState saveBindState( texture.getTarget() );
+	GLint oldAlignment;
+	glGetIntegerv( GL_UNPACK_ALIGNMENT, &oldAlignment );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	StateCache::bindTexture( texture.getTarget(), texture.getId() );
+	glTexSubImage2D( texture.getTarget(), 0, cellOffset.x, cellOffset.y, mCellSize.x, mCellSize.y, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, &lumAlpha[0] );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, oldAlignment );
+
+	info.mTexCoords += cellOffset;
+	info.mTextureIndex = (uint8_t)textureIndex;
+	info.mCell = cell;
+	info.mLastUsed = mUseCount;
+	mLru.push_front( glyph );
+	info.mLruPosition = mLru.begin();
+	mGlyphMap[glyph] = info;
+}
+
 void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baselineIn, const DrawOptions &options, const std::vector<ColorA8u> &colors )
 {
+	cacheGlyphs( glyphMeasures );
 	if( mTextures.empty() )
 		return;
 
@@ -305,6 +772,7 @@ void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures
 	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
 	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
 	gl::enable( mTextures[0].getTarget() );
+	ScopedDistanceField distanceFieldState( *this );
 
 	Vec2f baseline = baselineIn;
 
@@ -382,6 +850,7 @@ void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures
 
 void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
 {
+	cacheGlyphs( glyphMeasures );
 	if( mTextures.empty() )
 		return;
 
@@ -394,6 +863,7 @@ void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &gly
 	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
 	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
 	gl::enable( mTextures[0].getTarget() );
+	ScopedDistanceField distanceFieldState( *this );
 	const float scale = options.getScale();
 	glEnableClientState( GL_VERTEX_ARRAY );
 	if ( colors.empty() )
@@ -518,7 +988,7 @@ Vec2f TextureFont::measureString( const std::string &str, const DrawOptions &opt
 		Vec2f result = glyphMeasures.back().second;
 		unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyphMeasures.back().first );
 		if( glyphInfoIt != mGlyphMap.end() )
-			result += glyphInfoIt->second.mOriginOffset + glyphInfoIt->second.mTexCoords.getSize();
+			result += glyphInfoIt->second.mOriginOffset + glyphInfoIt->second.mTexCoords.getSize() - Vec2f( (float)getGlyphPadding(), (float)getGlyphPadding() );
 		return result;
 	}
 	else {
@@ -553,4 +1023,204 @@ vector<pair<uint16_t,Vec2f> > TextureFont::getGlyphPlacementsWrapped( const std:
 	return tbox.measureGlyphs();
 }
 
+
+#if ! defined( CINDER_GLES )
+///////////////////////////////////////////////////////////////////////////////
+// TextureFont::Batch
+TextureFont::Batch::Batch( const TextureFontRef &font )
+	: mObj( new Obj( font ) )
+{
+}
+
+size_t TextureFont::Batch::addString( const std::string &str, const Vec2f &baseline, const DrawOptions &options )
+{
+	return addGlyphs( mObj->mFont->getGlyphPlacements( str, options ), baseline, options );
+}
+
+size_t TextureFont::Batch::addGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baseline, const DrawOptions &options, const vector<ColorA8u> &colors )
+{
+	mObj->mEntries.push_back( Entry() );
+	layoutGlyphs( &mObj->mEntries.back(), glyphMeasures, baseline, options, colors );
+	mObj->mLayoutDirty = true;
+	return mObj->mEntries.size() - 1;
+}
+
+void TextureFont::Batch::setString( size_t index, const std::string &str, const Vec2f &baseline, const DrawOptions &options )
+{
+	setGlyphs( index, mObj->mFont->getGlyphPlacements( str, options ), baseline, options );
+}
+
+void TextureFont::Batch::setGlyphs( size_t index, const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baseline, const DrawOptions &options, const vector<ColorA8u> &colors )
+{
+	Entry &entry = mObj->mEntries[index];
+	Entry updated;
+	layoutGlyphs( &updated, glyphMeasures, baseline, options, colors );
+
+	// if the glyph counts per texture match, the new vertices fit in the old entry's slots
+	bool sameLayout = updated.mVertices.size() == entry.mVertices.size();
+	for( size_t t = 0; sameLayout && ( t < updated.mVertices.size() ); ++t )
+		sameLayout = sameLayout && ( updated.mVertices[t].size() == entry.mVertices[t].size() );
+	if( sameLayout )
+		updated.mFirstVertex = entry.mFirstVertex;
+	else
+		mObj->mLayoutDirty = true;
+
+	entry = updated;
+}
+
+void TextureFont::Batch::clear()
+{
+	mObj->mEntries.clear();
+	mObj->mLayoutDirty = true;
+	mObj->mHasColors = false;
+}
+
+void TextureFont::Batch::layoutGlyphs( Entry *entry, const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baselineIn, const DrawOptions &options, const vector<ColorA8u> &colors )
+{
+	mObj->mFont->cacheGlyphs( glyphMeasures );
+	const TextureFont &font = *mObj->mFont;
+	entry->mVertices.resize( font.mTextures.size() );
+	entry->mFirstVertex.resize( font.mTextures.size(), 0 );
+	if( ! colors.empty() ) {
+		assert( glyphMeasures.size() == colors.size() );
+		mObj->mHasColors = true;
+	}
+
+	const float scale = options.getScale();
+	Vec2f baseline = baselineIn;
+	if( options.getPixelSnap() )
+		baseline = Vec2f( floor( baseline.x ), floor( baseline.y ) );
+
+	for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = font.mGlyphMap.find( glyphIt->first );
+		if( glyphInfoIt == font.mGlyphMap.end() )
+			continue;
+
+		const GlyphInfo &glyphInfo = glyphInfoIt->second;
+		const gl::Texture &curTex = font.mTextures[glyphInfo.mTextureIndex];
+
+		Rectf destRect( glyphInfo.mTexCoords );
+		Rectf srcCoords = curTex.getAreaTexCoords( glyphInfo.mTexCoords );
+		destRect -= destRect.getUpperLeft();
+		destRect.scale( scale );
+		destRect += glyphIt->second * scale;
+		destRect += Vec2f( floor( glyphInfo.mOriginOffset.x + 0.5f ), floor( glyphInfo.mOriginOffset.y ) ) * scale;
+		destRect += Vec2f( baseline.x, baseline.y - font.mFont.getAscent() * scale );
+		if( options.getPixelSnap() )
+			destRect -= Vec2f( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );
+
+		const ColorA8u color = ( colors.empty() ) ? ColorA8u( 255, 255, 255, 255 ) : colors[glyphIt - glyphMeasures.begin()];
+		Vertex quad[4];
+		quad[0].mPosition = Vec2f( destRect.getX2(), destRect.getY1() ); quad[0].mTexCoord = Vec2f( srcCoords.getX2(), srcCoords.getY1() );
+		quad[1].mPosition = Vec2f( destRect.getX1(), destRect.getY1() ); quad[1].mTexCoord = Vec2f( srcCoords.getX1(), srcCoords.getY1() );
+		quad[2].mPosition = Vec2f( destRect.getX2(), destRect.getY2() ); quad[2].mTexCoord = Vec2f( srcCoords.getX2(), srcCoords.getY2() );
+		quad[3].mPosition = Vec2f( destRect.getX1(), destRect.getY2() ); quad[3].mTexCoord = Vec2f( srcCoords.getX1(), srcCoords.getY2() );
+		for( int v = 0; v < 4; ++v ) {
+			quad[v].mColor = color;
+			entry->mVertices[glyphInfo.mTextureIndex].push_back( quad[v] );
+		}
+	}
+}
+
+void TextureFont::Batch::upload()
+{
+	// a font with dynamic glyphs may have gained textures since entries were laid out
+	const size_t numTextures = mObj->mFont->mTextures.size();
+	if( ! mObj->mIndexVbo )
+		mObj->mIndexVbo = Vbo( GL_ELEMENT_ARRAY_BUFFER );
+	if( mObj->mVertexVbos.size() < numTextures ) {
+		while( mObj->mVertexVbos.size() < numTextures )
+			mObj->mVertexVbos.push_back( Vbo( GL_ARRAY_BUFFER ) );
+		mObj->mNumVertices.resize( numTextures, 0 );
+		mObj->mLayoutDirty = true;
+	}
+	for( vector<Entry>::iterator entryIt = mObj->mEntries.begin(); entryIt != mObj->mEntries.end(); ++entryIt ) {
+		entryIt->mVertices.resize( numTextures );
+		entryIt->mFirstVertex.resize( numTextures, 0 );
+	}
+
+	if( mObj->mLayoutDirty ) {
+		size_t maxQuads = 0;
+		for( size_t t = 0; t < numTextures; ++t ) {
+			vector<Vertex> vertices;
+			for( vector<Entry>::iterator entryIt = mObj->mEntries.begin(); entryIt != mObj->mEntries.end(); ++entryIt ) {
+				entryIt->mFirstVertex[t] = vertices.size();
+				vertices.insert( vertices.end(), entryIt->mVertices[t].begin(), entryIt->mVertices[t].end() );
+			}
+			mObj->mNumVertices[t] = vertices.size();
+			if( ! vertices.empty() )
+				mObj->mVertexVbos[t].bufferData( sizeof(Vertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW );
+			maxQuads = std::max( maxQuads, vertices.size() / 4 );
+		}
+
+		// every texture's quads share one index buffer, grown as needed
+		if( maxQuads > mObj->mNumIndexedQuads ) {
+			vector<uint32_t> indices;
+			indices.reserve( maxQuads * 6 );
+			for( uint32_t q = 0; q < (uint32_t)maxQuads; ++q ) {
+				indices.push_back( q * 4 + 0 ); indices.push_back( q * 4 + 1 ); indices.push_back( q * 4 + 2 );
+				indices.push_back( q * 4 + 2 ); indices.push_back( q * 4 + 1 ); indices.push_back( q * 4 + 3 );
+			}
+			mObj->mIndexVbo.bufferData( sizeof(uint32_t) * indices.size(), &indices[0], GL_STATIC_DRAW );
+			mObj->mNumIndexedQuads = maxQuads;
+		}
+	}
+	else {
+		for( vector<Entry>::const_iterator entryIt = mObj->mEntries.begin(); entryIt != mObj->mEntries.end(); ++entryIt ) {
+			if( ! entryIt->mDirty )
+				continue;
+			for( size_t t = 0; t < numTextures; ++t ) {
+				if( ! entryIt->mVertices[t].empty() )
+					mObj->mVertexVbos[t].bufferSubData( sizeof(Vertex) * entryIt->mFirstVertex[t], sizeof(Vertex) * entryIt->mVertices[t].size(), &entryIt->mVertices[t][0] );
+			}
+		}
+	}
+
+	for( vector<Entry>::iterator entryIt = mObj->mEntries.begin(); entryIt != mObj->mEntries.end(); ++entryIt )
+		entryIt->mDirty = false;
+	mObj->mLayoutDirty = false;
+	VboMesh::unbindBuffers();
+}
+
+void TextureFont::Batch::draw()
+{
+	const vector<gl::Texture> &textures( mObj->mFont->mTextures );
+	if( textures.empty() || mObj->mEntries.empty() )
+		return;
+
+	upload();
+
+	SaveTextureBindState saveBindState( textures[0].getTarget() );
+	BoolState saveEnabledState( textures[0].getTarget() );
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );
+	gl::enable( textures[0].getTarget() );
+	ScopedDistanceField distanceFieldState( *mObj->mFont );
+
+	glEnableClientState( GL_VERTEX_ARRAY );
+	if( mObj->mHasColors )
+		glEnableClientState( GL_COLOR_ARRAY );
+	else
+		glDisableClientState( GL_COLOR_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+
+	mObj->mIndexVbo.bind();
+	for( size_t t = 0; t < textures.size(); ++t ) {
+		if( mObj->mNumVertices[t] == 0 )
+			continue;
+
+		textures[t].bind();
+		mObj->mVertexVbos[t].bind();
+		glVertexPointer( 2, GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof( Vertex, mPosition ) );
+		glTexCoordPointer( 2, GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof( Vertex, mTexCoord ) );
+		if( mObj->mHasColors )
+			glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const GLvoid*)offsetof( Vertex, mColor ) );
+		glDrawElements( GL_TRIANGLES, (GLsizei)( mObj->mNumVertices[t] / 4 * 6 ), GL_UNSIGNED_INT, 0 );
+	}
+
+	VboMesh::unbindBuffers();
+}
+#endif // ! defined( CINDER_GLES )
+
 } } // namespace cinder::gl
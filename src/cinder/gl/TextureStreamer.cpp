@@ -0,0 +1,302 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cinder/gl/TextureStreamer.h"
+#include "cinder/ip/Resize.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// thumbnails are requested ahead of any detail
+const int32_t THUMBNAIL_PRIORITY = 1 << 30;
+
+// written on the loader's thread, and read once the request is delivered
+struct LoadedLevel {
+	Vec2i	mFullSize;
+	int		mLevel;
+};
+
+Vec2i calcLevelSize( const Vec2i &fullSize, int level )
+{
+	return Vec2i( std::max( 1, fullSize.x >> level ), std::max( 1, fullSize.y >> level ) );
+}
+
+// Runs on the loader's thread. A \a level of -1 picks the coarsest level whose larger side is at most \a thumbnailSize.
+Surface downsampleToLevel( const Surface &surface, int level, int thumbnailSize, const shared_ptr<LoadedLevel> &result )
+{
+	result->mFullSize = surface.getSize();
+	if( level < 0 ) {
+		level = 0;
+		while( std::max( surface.getWidth() >> level, surface.getHeight() >> level ) > thumbnailSize )
+			++level;
+	}
+	result->mLevel = level;
+
+	if( level == 0 )
+		return surface;
+	return ip::resizeCopy( surface, surface.getBounds(), calcLevelSize( surface.getSize(), level ) );
+}
+
+} // anonymous namespace
+
+void StreamedTexture::demand( const Vec2f &screenSize )
+{
+	mDemanded = true;
+	mDemandedSize.x = std::max( mDemandedSize.x, math<float>::abs( screenSize.x ) );
+	mDemandedSize.y = std::max( mDemandedSize.y, math<float>::abs( screenSize.y ) );
+}
+
+TextureStreamerRef TextureStreamer::create( size_t budgetBytes, const AsyncImageLoaderRef &loader, const Texture::Format &format )
+{
+	return TextureStreamerRef( new TextureStreamer( budgetBytes, loader ? loader : AsyncImageLoader::create(), format ) );
+}
+
+TextureStreamer::TextureStreamer( size_t budgetBytes, const AsyncImageLoaderRef &loader, const Texture::Format &format )
+	: mLoader( loader ), mFormat( format ), mBudget( budgetBytes ), mResidentBytes( 0 ), mThumbnailBytes( 0 ), mThumbnailSize( 64 ),
+	mGracePeriod( 30 ), mFrame( 0 )
+{
+	mFormat.enableMipmapping( true );
+	mFormat.setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for( vector<StreamedTextureRef>::iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt )
+		cancelPending( texIt->get() );
+}
+
+StreamedTextureRef TextureStreamer::add( const DataSourceRef &dataSource )
+{
+	StreamedTextureRef result( new StreamedTexture( dataSource ) );
+	mTextures.push_back( result );
+	requestLevel( result, -1, THUMBNAIL_PRIORITY );
+
+	return result;
+}
+
+void TextureStreamer::remove( const StreamedTextureRef &texture )
+{
+	vector<StreamedTextureRef>::iterator texIt = std::find( mTextures.begin(), mTextures.end(), texture );
+	if( texIt == mTextures.end() )
+		return;
+
+	cancelPending( texture.get() );
+	if( texture->mDetail )
+		mResidentBytes -= calcTextureBytes( texture->mDetail.getSize() );
+	if( texture->mThumbnail )
+		mThumbnailBytes -= calcTextureBytes( texture->mThumbnail.getSize() );
+	mTextures.erase( texIt );
+}
+
+void TextureStreamer::update()
+{
+	++mFrame;
+
+	// work out each texture's level, evicting detail which has gone undemanded for the grace period
+	for( vector<StreamedTextureRef>::iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt ) {
+		StreamedTexture *tex = texIt->get();
+		if( tex->mDemanded ) {
+			tex->mLastDemandedFrame = mFrame;
+			tex->mDesiredLevel = calcDesiredLevel( *tex );
+		}
+		else if( mFrame - tex->mLastDemandedFrame > mGracePeriod ) {
+			tex->mDesiredLevel = tex->mThumbnailLevel;
+			evictDetail( tex );
+		}
+
+		// a pending level which no longer improves on what is resident is canceled
+		if( tex->isLoaded() && tex->mPendingLevel >= 0 && tex->mDesiredLevel >= tex->getResidentLevel() )
+			cancelPending( tex );
+	}
+
+	makeRoom( 0, 0 );
+
+	// request the detail demanded this frame, largest on screen first
+	vector<StreamedTextureRef> wanted;
+	for( vector<StreamedTextureRef>::iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt ) {
+		StreamedTexture *tex = texIt->get();
+		if( tex->mDemanded && tex->isLoaded() && tex->mDesiredLevel < tex->getResidentLevel() && tex->mPendingLevel != tex->mDesiredLevel )
+			wanted.push_back( *texIt );
+	}
+	std::stable_sort( wanted.begin(), wanted.end(), [] ( const StreamedTextureRef &lhs, const StreamedTextureRef &rhs ) {
+		return lhs->mDemandedSize.x * lhs->mDemandedSize.y > rhs->mDemandedSize.x * rhs->mDemandedSize.y;
+	} );
+
+	for( vector<StreamedTextureRef>::iterator texIt = wanted.begin(); texIt != wanted.end(); ++texIt ) {
+		StreamedTexture *tex = texIt->get();
+		const size_t bytes = calcTextureBytes( calcLevelSize( tex->mFullSize, tex->mDesiredLevel ) );
+		if( makeRoom( bytes, tex ) ) {
+			cancelPending( tex );
+			const float area = tex->mDemandedSize.x * tex->mDemandedSize.y;
+			requestLevel( *texIt, tex->mDesiredLevel, (int32_t)std::min<float>( area, THUMBNAIL_PRIORITY - 1 ) );
+		}
+	}
+
+	for( vector<StreamedTextureRef>::iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt ) {
+		(*texIt)->mDemanded = false;
+		(*texIt)->mDemandedSize = Vec2f::zero();
+	}
+}
+
+size_t TextureStreamer::getNumPending() const
+{
+	size_t result = 0;
+	for( vector<StreamedTextureRef>::const_iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt )
+		if( (*texIt)->mPendingRequest )
+			++result;
+
+	return result;
+}
+
+int TextureStreamer::calcDesiredLevel( const StreamedTexture &texture ) const
+{
+	if( texture.mDemandedSize.x <= 0 || texture.mDemandedSize.y <= 0 )
+		return texture.mThumbnailLevel;
+
+	// the finer of the two axes decides, so that neither is drawn magnified
+	const float ratio = std::min( texture.mFullSize.x / texture.mDemandedSize.x, texture.mFullSize.y / texture.mDemandedSize.y );
+	int level = 0;
+	while( ( level < texture.mThumbnailLevel ) && ( ratio >= (float)( 2 << level ) ) )
+		++level;
+
+	return level;
+}
+
+size_t TextureStreamer::calcPendingBytes() const
+{
+	size_t result = 0;
+	for( vector<StreamedTextureRef>::const_iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt )
+		if( (*texIt)->mPendingLevel >= 0 && (*texIt)->isLoaded() )
+			result += calcTextureBytes( calcLevelSize( (*texIt)->mFullSize, (*texIt)->mPendingLevel ) );
+
+	return result;
+}
+
+// Evicts detail, least recently demanded first, until \a bytes more fit within the budget. Detail demanded this frame, or belonging to \a exclude, is only evicted
+// to bring the resident detail itself back within the budget. Returns whether \a bytes fit.
+bool TextureStreamer::makeRoom( size_t bytes, const StreamedTexture *exclude )
+{
+	// the texture's own detail and pending level are replaced by the new level
+	size_t replaced = 0;
+	if( exclude && exclude->mDetail )
+		replaced += calcTextureBytes( exclude->mDetail.getSize() );
+	if( exclude && exclude->mPendingLevel >= 0 )
+		replaced += calcTextureBytes( calcLevelSize( exclude->mFullSize, exclude->mPendingLevel ) );
+	if( mResidentBytes + calcPendingBytes() + bytes - replaced <= mBudget )
+		return true;
+
+	vector<StreamedTexture*> candidates;
+	for( vector<StreamedTextureRef>::iterator texIt = mTextures.begin(); texIt != mTextures.end(); ++texIt )
+		if( (*texIt)->mDetail && texIt->get() != exclude )
+			candidates.push_back( texIt->get() );
+	std::stable_sort( candidates.begin(), candidates.end(), [] ( const StreamedTexture *lhs, const StreamedTexture *rhs ) {
+		return lhs->mLastDemandedFrame < rhs->mLastDemandedFrame;
+	} );
+
+	for( vector<StreamedTexture*>::iterator texIt = candidates.begin(); texIt != candidates.end(); ++texIt ) {
+		if( mResidentBytes + calcPendingBytes() + bytes - replaced <= mBudget )
+			break;
+		if( (*texIt)->mLastDemandedFrame == mFrame && mResidentBytes <= mBudget )
+			break;
+		evictDetail( *texIt );
+	}
+
+	return mResidentBytes + calcPendingBytes() + bytes - replaced <= mBudget;
+}
+
+void TextureStreamer::requestLevel( const StreamedTextureRef &texture, int level, int32_t priority )
+{
+	std::weak_ptr<TextureStreamer> weakSelf = shared_from_this();
+	shared_ptr<LoadedLevel> loaded( new LoadedLevel );
+	const int thumbnailSize = mThumbnailSize;
+
+	texture->mPendingLevel = ( level < 0 ) ? INT_MAX : level;
+	texture->mPendingRequest = mLoader->loadAndProcess( texture->mDataSource,
+		[=] ( const Surface &surface ) { return downsampleToLevel( surface, level, thumbnailSize, loaded ); },
+		[=] ( const AsyncImageRequestRef &request ) {
+			TextureStreamerRef self = weakSelf.lock();
+			if( self )
+				self->levelLoaded( texture, level < 0, loaded->mLevel, loaded->mFullSize, request );
+		},
+		priority );
+}
+
+void TextureStreamer::levelLoaded( const StreamedTextureRef &texture, bool thumbnail, int level, const Vec2i &fullSize, const AsyncImageRequestRef &request )
+{
+	if( texture->mPendingRequest != request )
+		return;
+	texture->mPendingRequest.reset();
+	texture->mPendingLevel = -1;
+
+	if( request->getState() != AsyncImageRequest::COMPLETE )
+		return;
+
+	Texture result;
+	try {
+		result = Texture( request->getSurface(), mFormat );
+	}
+	catch( std::exception & ) {
+		return;
+	}
+
+	if( thumbnail ) {
+		texture->mFullSize = fullSize;
+		texture->mThumbnailLevel = level;
+		texture->mDesiredLevel = level;
+		texture->mThumbnail = result;
+		mThumbnailBytes += calcTextureBytes( result.getSize() );
+	}
+	else if( level < texture->getResidentLevel() ) {
+		evictDetail( texture.get() );
+		texture->mDetail = result;
+		texture->mDetailLevel = level;
+		mResidentBytes += calcTextureBytes( result.getSize() );
+	}
+}
+
+void TextureStreamer::evictDetail( StreamedTexture *texture )
+{
+	if( ! texture->mDetail )
+		return;
+
+	mResidentBytes -= calcTextureBytes( texture->mDetail.getSize() );
+	texture->mDetail.reset();
+}
+
+void TextureStreamer::cancelPending( StreamedTexture *texture )
+{
+	if( ! texture->mPendingRequest )
+		return;
+
+	texture->mPendingRequest->cancel();
+	texture->mPendingRequest.reset();
+	texture->mPendingLevel = -1;
+}
+
+} } // namespace cinder::gl
@@ -29,12 +29,24 @@
 
 namespace cinder { namespace gl {
 
-TileRender::TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWidth, int32_t tileHeight )
-	: mImageWidth( imageWidth ), mImageHeight( imageHeight )
+TileRender::TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWidth, int32_t tileHeight, const Format &format )
+	: mImageWidth( imageWidth ), mImageHeight( imageHeight ), mFormat( format )
 {
-	// if we are using the screen, we can't make tiles bigger than the app's window
-	mTileWidth = std::min( tileWidth, (int32_t)app::getWindowWidth() );
-	mTileHeight = std::min( tileHeight, (int32_t)app::getWindowHeight() ); 
+#if ! defined( CINDER_GLES )
+	if( mFormat.getNumFbos() > 0 ) {
+		// Fbos aren't limited by the window's size
+		mTileWidth = std::min( tileWidth, mImageWidth );
+		mTileHeight = std::min( tileHeight, mImageHeight );
+		for( int i = 0; i < mFormat.getNumFbos(); ++i )
+			mFbos.push_back( Fbo( mTileWidth, mTileHeight, mFormat.getFboFormat() ) );
+	}
+	else
+#endif
+	{
+		// if we are using the screen, we can't make tiles bigger than the app's window
+		mTileWidth = std::min( tileWidth, (int32_t)app::getWindowWidth() );
+		mTileHeight = std::min( tileHeight, (int32_t)app::getWindowHeight() ); 
+	}
 
 	mNumTilesX = (int32_t)math<float>::ceil( mImageWidth / (float)mTileWidth );
 	mNumTilesY = (int32_t)math<float>::ceil( mImageHeight / (float)mTileHeight );
@@ -44,6 +56,9 @@ TileRender::TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWid
 
 bool TileRender::nextTile()
 {
+	if( isPipelined() )
+		return nextTilePipelined();
+
 	if( mCurrentTile >= mNumTilesX * mNumTilesY ) {
 		// suck the pixels out of the final tile
 		mSurface.copyFrom( app::copyWindowSurface( Area( 0, app::getWindowHeight() - mCurrentArea.getHeight(), mCurrentArea.getWidth(), app::getWindowHeight() ) ), 
@@ -65,6 +80,17 @@ bool TileRender::nextTile()
 			Area( 0, 0, mCurrentArea.getWidth(), mCurrentArea.getHeight() ), mCurrentArea.getUL() );
 	}
 	
+	calcCurrentArea();
+
+	gl::setViewport( Area( 0, 0, mCurrentArea.getWidth(), mCurrentArea.getHeight() ) );
+	updateFrustum();
+
+	mCurrentTile++;
+	return true;
+}
+
+void TileRender::calcCurrentArea()
+{
 	int tileX = mCurrentTile % mNumTilesX;
 	int tileY = mCurrentTile / mNumTilesX;
 	int currentTileWidth = ( ( tileX == mNumTilesX - 1 ) && ( mImageWidth != mTileWidth * mNumTilesX ) ) ? ( mImageWidth % mTileWidth ) : mTileWidth;
@@ -73,12 +99,139 @@ bool TileRender::nextTile()
 	mCurrentArea.x2 = mCurrentArea.x1 + currentTileWidth;
 	mCurrentArea.y1 = tileY * mTileHeight;
 	mCurrentArea.y2 = mCurrentArea.y1 + currentTileHeight;
+}
+
+// Tiles are drawn into mFbos in turn. When a tile is finished its readback is queued into a pixel buffer object, and it is collected once
+// getNumFbos() - 1 more tiles have been drawn, by which time the transfer has usually completed. The collected pixels are composited on the TaskPool.
+bool TileRender::nextTilePipelined()
+{
+#if ! defined( CINDER_GLES )
+	Batch2d::flush();
+
+	if( mCurrentTile == -1 ) { // first tile of this frame
+		mSavedViewport = gl::getViewport();
+		mSavedFramebuffer.reset( new SaveFramebufferBinding );
+		mCurrentTile = 0;
+		if( isStreaming() ) {
+			mSurface.reset();
+			for( int i = 0; i < 2; ++i )
+				mRows[i] = Surface( mImageWidth, mTileHeight, false, SurfaceChannelOrder::RGB );
+			if( ! mFormat.getPpmPath().empty() ) {
+				mPpmStream = writeFileStream( mFormat.getPpmPath() );
+				std::ostringstream header;
+				header << "P6\n" << mImageWidth << " " << mImageHeight << "\n255\n";
+				mPpmStream->writeData( header.str().c_str(), header.str().size() );
+			}
+		}
+		else
+			mSurface = Surface( mImageWidth, mImageHeight, false );
+	}
+	else {
+		// queue the readback of the previous tile, which is collected while the following tiles are drawn
+		PendingTile tile;
+		tile.mReadback = mFbos[( mCurrentTile - 1 ) % mFbos.size()].readPixelsAsync( Area( 0, 0, mCurrentArea.getWidth(), mCurrentArea.getHeight() ) );
+		tile.mArea = mCurrentArea;
+		mPendingTiles.push_back( tile );
+
+		while( mPendingTiles.size() >= mFbos.size() )
+			collectTile();
+	}
 
+	if( mCurrentTile >= mNumTilesX * mNumTilesY ) {
+		finishPipelined();
+		return false;
+	}
+
+	calcCurrentArea();
+
+	mFbos[mCurrentTile % mFbos.size()].bindFramebuffer();
 	gl::setViewport( Area( 0, 0, mCurrentArea.getWidth(), mCurrentArea.getHeight() ) );
 	updateFrustum();
 
 	mCurrentTile++;
 	return true;
+#else
+	return false;
+#endif
+}
+
+void TileRender::collectTile()
+{
+	PendingTile tile = mPendingTiles.front();
+	mPendingTiles.pop_front();
+
+	// maps the pixel buffer object, which has to happen on this thread, and flips the pixels so the top row is first
+	Surface8u pixels = tile.mReadback.getSurface();
+
+	Surface dst;
+	Vec2i offset;
+	std::vector<TaskRef> *tasks;
+	const int32_t tileRow = tile.mArea.y1 / mTileHeight;
+	if( isStreaming() ) {
+		dst = mRows[tileRow % 2];
+		offset = Vec2i( tile.mArea.x1, 0 );
+		tasks = &mRowsTasks[tileRow % 2];
+	}
+	else {
+		dst = mSurface;
+		offset = tile.mArea.getUL();
+		tasks = &mCompositeTasks;
+	}
+
+	// tiles cover disjoint areas, so they can be composited concurrently
+	tasks->push_back( TaskPool::get()->submit( [dst, pixels, offset]() mutable {
+		dst.copyFrom( pixels, pixels.getBounds(), offset );
+	} ) );
+
+	if( isStreaming() && tile.mArea.x2 == mImageWidth )
+		flushRows( tileRow );
+}
+
+void TileRender::flushRows( int32_t tileRow )
+{
+	std::vector<TaskRef> &tasks = mRowsTasks[tileRow % 2];
+	for( std::vector<TaskRef>::iterator taskIt = tasks.begin(); taskIt != tasks.end(); ++taskIt )
+		(*taskIt)->wait();
+	tasks.clear();
+
+	// the previous row of tiles was written from the other buffer, which the next row of tiles is composited into
+	if( mWriteTask )
+		mWriteTask->wait();
+
+	const int32_t top = tileRow * mTileHeight;
+	Surface rows = mRows[tileRow % 2];
+	Surface rowsView( rows.getData(), rows.getWidth(), std::min( mTileHeight, mImageHeight - top ), rows.getRowBytes(), rows.getChannelOrder() );
+	RowsFn rowsFn = mFormat.getRowsFn();
+	OStreamFileRef ppmStream = mPpmStream;
+	mWriteTask = TaskPool::get()->submit( [rowsView, top, rowsFn, ppmStream] {
+		if( rowsFn )
+			rowsFn( rowsView, top );
+		if( ppmStream ) {
+			for( int32_t y = 0; y < rowsView.getHeight(); ++y )
+				ppmStream->writeData( rowsView.getData( Vec2i( 0, y ) ), rowsView.getWidth() * 3 );
+		}
+	} );
+}
+
+void TileRender::finishPipelined()
+{
+	while( ! mPendingTiles.empty() )
+		collectTile();
+
+	gl::setViewport( mSavedViewport );
+	mSavedFramebuffer.reset();
+	mCurrentTile = -1;
+
+	for( std::vector<TaskRef>::iterator taskIt = mCompositeTasks.begin(); taskIt != mCompositeTasks.end(); ++taskIt )
+		(*taskIt)->wait();
+	mCompositeTasks.clear();
+
+	if( mWriteTask ) {
+		TaskRef writeTask = mWriteTask;
+		mWriteTask.reset();
+		writeTask->wait();
+	}
+	mPpmStream.reset();
 }
 
 void TileRender::setMatricesWindowPersp( int screenWidth, int screenHeight, float fovDegrees, float nearPlane, float farPlane )
@@ -21,19 +21,109 @@
 */
 
 #include "cinder/gl/Vbo.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/CinderMath.h"
 #include <sstream>
+#include <cstring>
 
 using namespace std;
 
 namespace cinder { namespace gl {
 
+namespace {
+// GLee exposes ARB_instanced_arrays under its core name
+inline void vertexAttribDivisor( GLuint index, GLuint divisor )
+{
+#if defined( CINDER_MSW )
+	glVertexAttribDivisor( index, divisor );
+#else
+	glVertexAttribDivisorARB( index, divisor );
+#endif
+}
+
+bool isHalfFloatVertexSupported()
+{
+#if defined( CINDER_MSW )
+	return GLEE_ARB_half_float_vertex != 0;
+#else
+	return gl::isExtensionAvailable( "GL_ARB_half_float_vertex" );
+#endif
+}
+
+// Rounds to nearest, flushing values below half's denormal range to zero
+uint16_t floatToHalf( float f )
+{
+	uint32_t bits;
+	memcpy( &bits, &f, sizeof(bits) );
+	uint32_t sign = ( bits >> 16 ) & 0x8000;
+	int32_t exponent = (int32_t)( ( bits >> 23 ) & 0xff ) - 127 + 15;
+	uint32_t mantissa = bits & 0x007fffff;
+
+	if( exponent >= 31 ) // overflow, infinity or NaN
+		return (uint16_t)( sign | 0x7c00 | ( ( ( bits & 0x7fffffff ) > 0x7f800000 ) ? 0x0200 : 0 ) );
+	if( exponent <= 0 ) { // denormal
+		if( exponent < -10 )
+			return (uint16_t)sign;
+		mantissa |= 0x00800000;
+		uint32_t shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		if( ( mantissa >> ( shift - 1 ) ) & 1 )
+			++half;
+		return (uint16_t)( sign | half );
+	}
+
+	uint32_t half = sign | ( exponent << 10 ) | ( mantissa >> 13 );
+	if( mantissa & 0x1000 ) // a carry out of the mantissa correctly bumps the exponent
+		++half;
+	return (uint16_t)half;
+}
+
+// The quantized formats of Layout::setQuantized(), each padded to 4 bytes to keep attributes aligned
+void writeQuantizedPosition( uint8_t *&ptr, const Vec3f &p )
+{
+	GLshort *dst = reinterpret_cast<GLshort*>( ptr );
+	dst[0] = (GLshort)math<float>::clamp( math<float>::floor( p.x + 0.5f ), -32767, 32767 );
+	dst[1] = (GLshort)math<float>::clamp( math<float>::floor( p.y + 0.5f ), -32767, 32767 );
+	dst[2] = (GLshort)math<float>::clamp( math<float>::floor( p.z + 0.5f ), -32767, 32767 );
+	dst[3] = 0;
+	ptr += sizeof(GLshort) * 4;
+}
+
+void writeQuantizedNormal( uint8_t *&ptr, const Vec3f &n )
+{
+	GLbyte *dst = reinterpret_cast<GLbyte*>( ptr );
+	dst[0] = (GLbyte)math<float>::clamp( math<float>::floor( n.x * 127 + 0.5f ), -127, 127 );
+	dst[1] = (GLbyte)math<float>::clamp( math<float>::floor( n.y * 127 + 0.5f ), -127, 127 );
+	dst[2] = (GLbyte)math<float>::clamp( math<float>::floor( n.z * 127 + 0.5f ), -127, 127 );
+	dst[3] = 0;
+	ptr += sizeof(GLbyte) * 4;
+}
+
+void writeQuantizedColor( uint8_t *&ptr, const ColorA &c )
+{
+	ptr[0] = (GLubyte)math<float>::clamp( c.r * 255 + 0.5f, 0, 255 );
+	ptr[1] = (GLubyte)math<float>::clamp( c.g * 255 + 0.5f, 0, 255 );
+	ptr[2] = (GLubyte)math<float>::clamp( c.b * 255 + 0.5f, 0, 255 );
+	ptr[3] = (GLubyte)math<float>::clamp( c.a * 255 + 0.5f, 0, 255 );
+	ptr += sizeof(GLubyte) * 4;
+}
+
+void writeHalfTexCoord( uint8_t *&ptr, const Vec2f &t )
+{
+	uint16_t *dst = reinterpret_cast<uint16_t*>( ptr );
+	dst[0] = floatToHalf( t.x );
+	dst[1] = floatToHalf( t.y );
+	ptr += sizeof(uint16_t) * 2;
+}
+} // anonymous namespace
+
 //enum { CUSTOM_ATTR_FLOAT, CUSTOM_ATTR_FLOAT2, CUSTOM_ATTR_FLOAT3, CUSTOM_ATTR_FLOAT4, TOTAL_CUSTOM_ATTR_TYPES };
 int		VboMesh::Layout::sCustomAttrSizes[TOTAL_CUSTOM_ATTR_TYPES] = { 4, 8, 12, 16 };
 GLint	VboMesh::Layout::sCustomAttrNumComponents[TOTAL_CUSTOM_ATTR_TYPES] = { 1, 2, 3, 4 };
 GLenum	VboMesh::Layout::sCustomAttrTypes[TOTAL_CUSTOM_ATTR_TYPES] = { GL_FLOAT, GL_FLOAT, GL_FLOAT, GL_FLOAT };
 
 Vbo::Obj::Obj( GLenum aTarget )
-	: mTarget( aTarget )
+	: mTarget( aTarget ), mAllocation( "gl::Vbo", true )
 {
 	glGenBuffers( 1, &mId );
 }
@@ -41,6 +131,7 @@ Vbo::Obj::Obj( GLenum aTarget )
 Vbo::Obj::~Obj()
 {
 	glDeleteBuffers( 1, &mId );
+	StateCache::bufferDeleted( mId );
 }
 
 Vbo::Vbo( GLenum aTarget )
@@ -50,18 +141,19 @@ Vbo::Vbo( GLenum aTarget )
 
 void Vbo::bind()
 {
-	glBindBuffer( mObj->mTarget, mObj->mId );
+	StateCache::bindBuffer( mObj->mTarget, mObj->mId );
 }
 
 void Vbo::unbind()
 {
-	glBindBuffer( mObj->mTarget, 0 );
+	StateCache::bindBuffer( mObj->mTarget, 0 );
 }
 
 void Vbo::bufferData( size_t size, const void *data, GLenum usage )
 {
 	bind();
 	glBufferDataARB( mObj->mTarget, size, data, usage );
+	mObj->mAllocation.set( size );
 }
 
 void Vbo::bufferSubData( ptrdiff_t offset, size_t size, const void *data )
@@ -118,6 +210,7 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 			mObj->mLayout.setStaticTexCoords2d();
 		mObj->mLayout.setStaticIndices();
 		mObj->mLayout.setStaticPositions();
+		mObj->mLayout.setQuantized( layout.isQuantized() );
 	}
 	else
 		mObj->mLayout = layout;
@@ -128,8 +221,13 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 
 	initializeBuffers( false );
 			
+	if( mObj->mQuantizedStatic ) {
+		AxisAlignedBox3f bounds = triMesh.calcBoundingBox();
+		calcPositionQuantization( bounds.getMin(), bounds.getMax() );
+	}
+
 	// upload the indices
-	getIndexVbo().bufferData( sizeof(uint32_t) * triMesh.getNumIndices(), &(triMesh.getIndices()[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	bufferIndexData( &(triMesh.getIndices()[0]), triMesh.getNumIndices() );
 	
 	// upload the verts
 	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -138,6 +236,8 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 		
 		uint8_t *ptr = mObj->mBuffers[buffer].map( GL_WRITE_ONLY );
 		
+		bool quantized = ( buffer == STATIC_BUFFER ) && mObj->mQuantizedStatic;
+		bool halfTexCoords = ( buffer == STATIC_BUFFER ) && ( mObj->mStaticTexCoordType == GL_HALF_FLOAT_ARB );
 		bool copyPosition = ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticPositions() : mObj->mLayout.hasDynamicPositions();
 		bool copyNormal = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticNormals() : mObj->mLayout.hasDynamicNormals() ) && triMesh.hasNormals();
 		bool copyColorRGB = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) && triMesh.hasColorsRGB();
@@ -145,23 +245,38 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 		bool copyTexCoord2D = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords2d() : mObj->mLayout.hasDynamicTexCoords2d() ) && triMesh.hasTexCoords();
 		
 		for( size_t v = 0; v < mObj->mNumVertices; ++v ) {
-			if( copyPosition ) {
+			if( copyPosition && quantized ) {
+				writeQuantizedPosition( ptr, ( triMesh.getVertices()[v] - mObj->mPositionTranslate ) / mObj->mPositionScale );
+			}
+			else if( copyPosition ) {
 				*(reinterpret_cast<Vec3f*>(ptr)) = triMesh.getVertices()[v];
 				ptr += sizeof( Vec3f );
 			}
-			if( copyNormal ) {
+			if( copyNormal && quantized ) {
+				writeQuantizedNormal( ptr, triMesh.getNormals()[v] );
+			}
+			else if( copyNormal ) {
 				*(reinterpret_cast<Vec3f*>(ptr)) = triMesh.getNormals()[v];
 				ptr += sizeof( Vec3f );
 			}
-			if( copyColorRGB ) {
+			if( copyColorRGB && quantized ) {
+				writeQuantizedColor( ptr, ColorA( triMesh.getColorsRGB()[v], 1 ) );
+			}
+			else if( copyColorRGB ) {
 				*(reinterpret_cast<Color*>(ptr)) = triMesh.getColorsRGB()[v];
 				ptr += sizeof( Color );
 			}
-			if( copyColorRGBA ) {
+			if( copyColorRGBA && quantized ) {
+				writeQuantizedColor( ptr, triMesh.getColorsRGBA()[v] );
+			}
+			else if( copyColorRGBA ) {
 				*(reinterpret_cast<ColorA*>(ptr)) = triMesh.getColorsRGBA()[v];
 				ptr += sizeof( ColorA );
 			}
-			if( copyTexCoord2D ) {
+			if( copyTexCoord2D && halfTexCoords ) {
+				writeHalfTexCoord( ptr, triMesh.getTexCoords()[v] );
+			}
+			else if( copyTexCoord2D ) {
 				*(reinterpret_cast<Vec2f*>(ptr)) = triMesh.getTexCoords()[v];
 				ptr += sizeof( Vec2f );
 			}
@@ -185,6 +300,7 @@ VboMesh::VboMesh( const TriMesh2d &triMesh, Layout layout )
 			mObj->mLayout.setStaticTexCoords2d();
 		mObj->mLayout.setStaticIndices();
 		mObj->mLayout.setStaticPositions();
+		mObj->mLayout.setQuantized( layout.isQuantized() );
 	}
 	else
 		mObj->mLayout = layout;
@@ -195,8 +311,13 @@ VboMesh::VboMesh( const TriMesh2d &triMesh, Layout layout )
 
 	initializeBuffers( false );
 			
+	if( mObj->mQuantizedStatic ) {
+		Rectf bounds = triMesh.calcBoundingBox();
+		calcPositionQuantization( Vec3f( bounds.x1, bounds.y1, 0 ), Vec3f( bounds.x2, bounds.y2, 0 ) );
+	}
+
 	// upload the indices
-	getIndexVbo().bufferData( sizeof(uint32_t) * triMesh.getNumIndices(), &(triMesh.getIndices()[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	bufferIndexData( &(triMesh.getIndices()[0]), triMesh.getNumIndices() );
 	
 	// upload the verts
 	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -205,26 +326,41 @@ VboMesh::VboMesh( const TriMesh2d &triMesh, Layout layout )
 		
 		uint8_t *ptr = mObj->mBuffers[buffer].map( GL_WRITE_ONLY );
 		
+		bool quantized = ( buffer == STATIC_BUFFER ) && mObj->mQuantizedStatic;
+		bool halfTexCoords = ( buffer == STATIC_BUFFER ) && ( mObj->mStaticTexCoordType == GL_HALF_FLOAT_ARB );
 		bool copyPosition = ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticPositions() : mObj->mLayout.hasDynamicPositions();
 		bool copyColorRGB = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) && triMesh.hasColorsRgb();
 		bool copyColorRGBA = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGBA() : mObj->mLayout.hasDynamicColorsRGBA() ) && triMesh.hasColorsRgba();
 		bool copyTexCoord2D = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords2d() : mObj->mLayout.hasDynamicTexCoords2d() ) && triMesh.hasTexCoords();
 		
 		for( size_t v = 0; v < mObj->mNumVertices; ++v ) {
-			if( copyPosition ) {
+			if( copyPosition && quantized ) {
+				const Vec2f &p = triMesh.getVertices()[v];
+				writeQuantizedPosition( ptr, ( Vec3f( p.x, p.y, 0 ) - mObj->mPositionTranslate ) / mObj->mPositionScale );
+			}
+			else if( copyPosition ) {
 				const Vec2f &p = triMesh.getVertices()[v];
 				*(reinterpret_cast<Vec3f*>(ptr)) = Vec3f( p.x, p.y, 0 );
 				ptr += sizeof( Vec3f );
 			}
-			if( copyColorRGB ) {
+			if( copyColorRGB && quantized ) {
+				writeQuantizedColor( ptr, ColorA( triMesh.getColorsRGB()[v], 1 ) );
+			}
+			else if( copyColorRGB ) {
 				*(reinterpret_cast<Color*>(ptr)) = triMesh.getColorsRGB()[v];
 				ptr += sizeof( Color );
 			}
-			if( copyColorRGBA ) {
+			if( copyColorRGBA && quantized ) {
+				writeQuantizedColor( ptr, triMesh.getColorsRGBA()[v] );
+			}
+			else if( copyColorRGBA ) {
 				*(reinterpret_cast<ColorA*>(ptr)) = triMesh.getColorsRGBA()[v];
 				ptr += sizeof( ColorA );
 			}
-			if( copyTexCoord2D ) {
+			if( copyTexCoord2D && halfTexCoords ) {
+				writeHalfTexCoord( ptr, triMesh.getTexCoords()[v] );
+			}
+			else if( copyTexCoord2D ) {
 				*(reinterpret_cast<Vec2f*>(ptr)) = triMesh.getTexCoords()[v];
 				ptr += sizeof( Vec2f );
 			}
@@ -248,7 +384,7 @@ VboMesh::VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum p
 	
 	// allocate buffer for indices
 	if( mObj->mLayout.hasIndices() )
-		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * mObj->mNumIndices, NULL, (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+		mObj->mBuffers[INDEX_BUFFER].bufferData( getIndexSize() * mObj->mNumIndices, NULL, (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
 	
 	unbindBuffers();	
 }
@@ -284,11 +420,24 @@ VboMesh::VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum p
 // If any buffers are not NULL they will be ignored
 void VboMesh::initializeBuffers( bool staticDataPlanar )
 {
+	// the buffers are counted as the VboMesh's rather than as Vbos
+	ScopedMemoryCategory memoryCategory( "gl::VboMesh" );
 	bool hasStaticBuffer = mObj->mLayout.hasStaticPositions() || mObj->mLayout.hasStaticNormals() || mObj->mLayout.hasStaticColorsRGB() || mObj->mLayout.hasStaticColorsRGBA() || mObj->mLayout.hasStaticTexCoords() || ( ! mObj->mLayout.mCustomStatic.empty() );
 	bool hasDynamicBuffer = mObj->mLayout.hasDynamicPositions() || mObj->mLayout.hasDynamicNormals() || mObj->mLayout.hasDynamicColorsRGB() || mObj->mLayout.hasDynamicColorsRGBA() || mObj->mLayout.hasDynamicTexCoords() || ( ! mObj->mLayout.mCustomDynamic.empty() );
 
-	if( ( mObj->mLayout.hasStaticIndices() || mObj->mLayout.hasDynamicIndices() ) && ( ! mObj->mBuffers[INDEX_BUFFER] ) )
+	// 16-bit indices only for a buffer we create; one passed in is presumed to hold 32-bit indices
+	mObj->mIndexType = GL_UNSIGNED_INT;
+	if( ( mObj->mLayout.hasStaticIndices() || mObj->mLayout.hasDynamicIndices() ) && ( ! mObj->mBuffers[INDEX_BUFFER] ) ) {
 		mObj->mBuffers[INDEX_BUFFER] = Vbo( GL_ELEMENT_ARRAY_BUFFER );
+		if( mObj->mLayout.isQuantized() && ( mObj->mNumVertices <= 65536 ) )
+			mObj->mIndexType = GL_UNSIGNED_SHORT;
+	}
+
+	// planar static data is written by the buffer*() methods as floats, so only interleaved static data is quantized
+	mObj->mQuantizedStatic = mObj->mLayout.isQuantized() && hasStaticBuffer && ( ! staticDataPlanar );
+	mObj->mStaticTexCoordType = ( mObj->mQuantizedStatic && isHalfFloatVertexSupported() ) ? GL_HALF_FLOAT_ARB : GL_FLOAT;
+	mObj->mPositionTranslate = Vec3f::zero();
+	mObj->mPositionScale = 1;
 
 	if( hasStaticBuffer && staticDataPlanar ) { // Planar static buffer
 		size_t offset = 0;
@@ -347,29 +496,30 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 		if( ! mObj->mBuffers[STATIC_BUFFER] )
 			mObj->mBuffers[STATIC_BUFFER] = Vbo( GL_ARRAY_BUFFER );
 
+		const bool quantized = mObj->mQuantizedStatic;
 		if( mObj->mLayout.hasStaticPositions() ) {
 			mObj->mPositionOffset = offset;
-			offset += sizeof(GLfloat) * 3;
+			offset += quantized ? sizeof(GLshort) * 4 : sizeof(GLfloat) * 3;
 		}
 		
 		if( mObj->mLayout.hasStaticNormals() ) {
 			mObj->mNormalOffset = offset;
-			offset += sizeof(GLfloat) * 3;
+			offset += quantized ? sizeof(GLbyte) * 4 : sizeof(GLfloat) * 3;
 		}
 
 		if( mObj->mLayout.hasStaticColorsRGB() ) {
 			mObj->mColorRGBOffset = offset;
-			offset += sizeof(GLfloat) * 3;
+			offset += quantized ? sizeof(GLubyte) * 4 : sizeof(GLfloat) * 3;
 		}
 		else if( mObj->mLayout.hasStaticColorsRGBA() ) {
 			mObj->mColorRGBAOffset = offset;
-			offset += sizeof(GLfloat) * 4;
+			offset += quantized ? sizeof(GLubyte) * 4 : sizeof(GLfloat) * 4;
 		}
 		
 		for( size_t t = 0; t <= ATTR_MAX_TEXTURE_UNIT; ++t ) {
 			if( mObj->mLayout.hasStaticTexCoords2d( t ) ) {
 				mObj->mTexCoordOffset[t] = offset;
-				offset += sizeof(GLfloat) * 2;
+				offset += ( mObj->mStaticTexCoordType == GL_HALF_FLOAT_ARB ) ? sizeof(uint16_t) * 2 : sizeof(GLfloat) * 2;
 			}
 			else if( mObj->mLayout.hasStaticTexCoords3d( t ) ) {
 				mObj->mTexCoordOffset[t] = offset;
@@ -436,6 +586,17 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 
 		// setup the buffer to be the summed size
 		mObj->mBuffers[DYNAMIC_BUFFER].bufferData( mObj->mDynamicStride * mObj->mNumVertices, NULL, GL_STREAM_DRAW );
+
+		// additional buffers for round-robin writes from mapVertexBuffer()
+		mObj->mDynamicBuffers.clear();
+		mObj->mDynamicBufferIndex = 0;
+		if( mObj->mLayout.getNumDynamicBuffers() > 1 ) {
+			mObj->mDynamicBuffers.push_back( mObj->mBuffers[DYNAMIC_BUFFER] );
+			for( int b = 1; b < mObj->mLayout.getNumDynamicBuffers(); ++b ) {
+				mObj->mDynamicBuffers.push_back( Vbo( GL_ARRAY_BUFFER ) );
+				mObj->mDynamicBuffers.back().bufferData( mObj->mDynamicStride * mObj->mNumVertices, NULL, GL_STREAM_DRAW );
+			}
+		}
 	}
 	else {
 		mObj->mDynamicStride = 0;
@@ -446,6 +607,28 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 		mObj->mCustomStaticLocations = vector<GLint>( mObj->mLayout.mCustomStatic.size(), -1 );
 	if( ! mObj->mLayout.mCustomDynamic.empty() )
 		mObj->mCustomDynamicLocations = vector<GLint>( mObj->mLayout.mCustomDynamic.size(), -1 );
+
+	// per-instance attributes are interleaved in their own buffer, which is filled by bufferInstanceData()
+	mObj->mInstanceStride = 0;
+	mObj->mNumInstances = 0;
+	if( ! mObj->mLayout.mCustomInstance.empty() ) {
+		if( ! mObj->mBuffers[INSTANCE_BUFFER] )
+			mObj->mBuffers[INSTANCE_BUFFER] = Vbo( GL_ARRAY_BUFFER );
+		for( size_t c = 0; c < mObj->mLayout.mCustomInstance.size(); ++c ) {
+			mObj->mLayout.mCustomInstance[c].second = mObj->mInstanceStride;
+			mObj->mInstanceStride += VboMesh::Layout::sCustomAttrSizes[mObj->mLayout.mCustomInstance[c].first];
+		}
+		mObj->mCustomInstanceLocations = vector<GLint>( mObj->mLayout.mCustomInstance.size(), -1 );
+	}
+}
+
+bool VboMesh::isInstancingSupported()
+{
+#if defined( CINDER_MSW )
+	return ( GLEE_ARB_draw_instanced != 0 ) && ( GLEE_ARB_instanced_arrays != 0 );
+#else
+	return gl::isExtensionAvailable( "GL_ARB_draw_instanced" ) && gl::isExtensionAvailable( "GL_ARB_instanced_arrays" );
+#endif
 }
 
 void VboMesh::enableClientStates() const
@@ -481,6 +664,12 @@ void VboMesh::enableClientStates() const
 			throw;
 		glEnableVertexAttribArray( mObj->mCustomDynamicLocations[a] );
 	}
+
+	for( size_t a = 0; a < mObj->mCustomInstanceLocations.size(); ++a ) {
+		if( mObj->mCustomInstanceLocations[a] < 0 )
+			throw;
+		glEnableVertexAttribArray( mObj->mCustomInstanceLocations[a] );
+	}
 }
 
 void VboMesh::disableClientStates() const
@@ -506,6 +695,14 @@ void VboMesh::disableClientStates() const
 			throw;
 		glDisableVertexAttribArray( mObj->mCustomDynamicLocations[a] );
 	}
+
+	// the divisor is attribute state, so reset it for whoever uses the location next
+	for( size_t a = 0; a < mObj->mCustomInstanceLocations.size(); ++a ) {
+		if( mObj->mCustomInstanceLocations[a] < 0 )
+			throw;
+		vertexAttribDivisor( mObj->mCustomInstanceLocations[a], 0 );
+		glDisableVertexAttribArray( mObj->mCustomInstanceLocations[a] );
+	}
 }
 
 void VboMesh::bindAllData() const
@@ -519,20 +716,25 @@ void VboMesh::bindAllData() const
 		
 		mObj->mBuffers[buffer].bind();
 		uint8_t stride = ( buffer == STATIC_BUFFER ) ? mObj->mStaticStride : mObj->mDynamicStride;
+		bool quantized = ( buffer == STATIC_BUFFER ) && mObj->mQuantizedStatic;
 		
 		if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticNormals() : mObj->mLayout.hasDynamicNormals() ) )
-			glNormalPointer( GL_FLOAT, stride, ( const GLvoid *)mObj->mNormalOffset );
+			glNormalPointer( quantized ? GL_BYTE : GL_FLOAT, stride, ( const GLvoid *)mObj->mNormalOffset );
 
-		if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) )
-			glColorPointer( 3, GL_FLOAT, stride, ( const GLvoid *)mObj->mColorRGBOffset );
+		if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) ) {
+			if( quantized )
+				glColorPointer( 4, GL_UNSIGNED_BYTE, stride, ( const GLvoid *)mObj->mColorRGBOffset );
+			else
+				glColorPointer( 3, GL_FLOAT, stride, ( const GLvoid *)mObj->mColorRGBOffset );
+		}
 		else if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGBA() : mObj->mLayout.hasDynamicColorsRGBA() ) )
-			glColorPointer( 4, GL_FLOAT, stride, ( const GLvoid *)mObj->mColorRGBAOffset );
+			glColorPointer( 4, quantized ? GL_UNSIGNED_BYTE : GL_FLOAT, stride, ( const GLvoid *)mObj->mColorRGBAOffset );
 
 
 		for( size_t t = 0; t <= ATTR_MAX_TEXTURE_UNIT; ++t ) {
 			if( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords2d( t ) : mObj->mLayout.hasDynamicTexCoords2d( t ) ) {
 				glClientActiveTexture( GL_TEXTURE0 + (GLenum)t );
-				glTexCoordPointer( 2, GL_FLOAT, stride, (const GLvoid *)mObj->mTexCoordOffset[t] );
+				glTexCoordPointer( 2, ( buffer == STATIC_BUFFER ) ? mObj->mStaticTexCoordType : GL_FLOAT, stride, (const GLvoid *)mObj->mTexCoordOffset[t] );
 			}
 			else if( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords3d( t ) : mObj->mLayout.hasDynamicTexCoords3d( t ) ) {
 				glClientActiveTexture( GL_TEXTURE0 + (GLenum)t );
@@ -541,7 +743,7 @@ void VboMesh::bindAllData() const
 		}	
 
 		if( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticPositions() : mObj->mLayout.hasDynamicPositions() )
-			glVertexPointer( 3, GL_FLOAT, stride, (const GLvoid*)mObj->mPositionOffset );
+			glVertexPointer( 3, quantized ? GL_SHORT : GL_FLOAT, stride, (const GLvoid*)mObj->mPositionOffset );
 	}
 
 	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -561,6 +763,16 @@ void VboMesh::bindAllData() const
 			glVertexAttribPointer( locations[a], Layout::sCustomAttrNumComponents[attributes[a].first], Layout::sCustomAttrTypes[attributes[a].first], GL_FALSE, (GLsizei)stride, offset );
 		}	
 	}
+
+	if( ! mObj->mLayout.mCustomInstance.empty() ) {
+		const vector<pair<VboMesh::Layout::CustomAttr,size_t> > &attributes( mObj->mLayout.mCustomInstance );
+		mObj->mBuffers[INSTANCE_BUFFER].bind();
+		for( size_t a = 0; a < attributes.size(); ++a ) {
+			const GLvoid *offset = reinterpret_cast<const GLvoid*>( attributes[a].second );
+			glVertexAttribPointer( mObj->mCustomInstanceLocations[a], Layout::sCustomAttrNumComponents[attributes[a].first], Layout::sCustomAttrTypes[attributes[a].first], GL_FALSE, (GLsizei)mObj->mInstanceStride, offset );
+			vertexAttribDivisor( mObj->mCustomInstanceLocations[a], mObj->mLayout.mCustomInstanceDivisors[a] );
+		}
+	}
 }
 
 void VboMesh::bindIndexBuffer() const
@@ -570,13 +782,39 @@ void VboMesh::bindIndexBuffer() const
 
 void VboMesh::unbindBuffers()
 {
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	StateCache::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+void VboMesh::bufferInstanceData( const void *data, size_t numInstances )
+{
+	mObj->mNumInstances = numInstances;
+	mObj->mBuffers[INSTANCE_BUFFER].bufferData( mObj->mInstanceStride * numInstances, data, GL_STREAM_DRAW );
 }
 
 void VboMesh::bufferIndices( const std::vector<uint32_t> &indices )
 {
-	mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * indices.size(), &(indices[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	bufferIndexData( &(indices[0]), indices.size() );
+}
+
+void VboMesh::bufferIndexData( const uint32_t *indices, size_t count )
+{
+	GLenum usage = ( mObj->mLayout.hasStaticIndices() ) ? GL_STATIC_DRAW : GL_STREAM_DRAW;
+	if( mObj->mIndexType == GL_UNSIGNED_SHORT ) {
+		vector<uint16_t> shortIndices( indices, indices + count );
+		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint16_t) * count, count ? &shortIndices[0] : NULL, usage );
+	}
+	else
+		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * count, indices, usage );
+}
+
+// Positions are centered and scaled uniformly, so that the dequantizing transform leaves normals undistorted
+void VboMesh::calcPositionQuantization( const Vec3f &boundsMin, const Vec3f &boundsMax )
+{
+	Vec3f size = boundsMax - boundsMin;
+	float extent = std::max( size.x, std::max( size.y, size.z ) );
+	mObj->mPositionTranslate = ( boundsMin + boundsMax ) * 0.5f;
+	mObj->mPositionScale = ( extent > 0 ) ? extent / 65534.0f : 1.0f;
 }
 
 void VboMesh::bufferPositions( const std::vector<Vec3f> &positions )
@@ -698,8 +936,21 @@ void VboMesh::bufferColorsRGBA( const std::vector<ColorA> &colors )
 		throw;
 }
 
+void VboMesh::bufferCustomStatic( size_t index, const void *data )
+{
+	if( ( index >= mObj->mLayout.mCustomStatic.size() ) || ( mObj->mStaticStride != 0 ) )
+		throw VboExc();
+
+	const pair<VboMesh::Layout::CustomAttr,size_t> &attribute = mObj->mLayout.mCustomStatic[index];
+	getStaticVbo().bufferSubData( attribute.second, Layout::sCustomAttrSizes[attribute.first] * mObj->mNumVertices, data );
+}
+
 VboMesh::VertexIter	VboMesh::mapVertexBuffer()
 {
+	if( mObj->mDynamicBuffers.size() > 1 ) {
+		mObj->mDynamicBufferIndex = ( mObj->mDynamicBufferIndex + 1 ) % mObj->mDynamicBuffers.size();
+		mObj->mBuffers[DYNAMIC_BUFFER] = mObj->mDynamicBuffers[mObj->mDynamicBufferIndex];
+	}
 	return VertexIter( *this );
 }
 
@@ -739,12 +990,26 @@ VboMesh::VertexIter::VertexIter( const VboMesh &mesh )
 VboMesh::VertexIter::Obj::Obj( const VboMesh &mesh )
 	: mVbo( mesh.getDynamicVbo() )
 { 	
-	// Buffer NULL data to tell the driver we don't care about what's in there (See NVIDIA's "Using Vertex Buffer Objects" whitepaper)
+	const size_t size = mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices;
 	mVbo.bind();
-	//mVbo.bufferData( mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices, NULL, GL_STREAM_DRAW );
-	glBufferDataARB( GL_ARRAY_BUFFER, mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices, NULL, GL_STREAM_DRAW );
-	//mData = mVbo.map( GL_WRITE_ONLY );
-	mData = reinterpret_cast<uint8_t*>( glMapBuffer( GL_ARRAY_BUFFER, GL_WRITE_ONLY ) );
+	mData = 0;
+#if defined( CINDER_MSW )
+	// Invalidating the whole range lets the driver hand back fresh storage without waiting. When mapping one of several round-robin buffers,
+	// the GPU finished with it frames ago, so the map needn't be synchronized at all.
+	if( GLEE_ARB_map_buffer_range ) {
+		GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+		if( mesh.mObj->mDynamicBuffers.size() > 1 )
+			access |= GL_MAP_UNSYNCHRONIZED_BIT;
+		mData = reinterpret_cast<uint8_t*>( glMapBufferRange( GL_ARRAY_BUFFER, 0, size, access ) );
+	}
+#endif
+	if( ! mData ) {
+		// Buffer NULL data to tell the driver we don't care about what's in there (See NVIDIA's "Using Vertex Buffer Objects" whitepaper)
+		glBufferDataARB( GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW );
+		mData = reinterpret_cast<uint8_t*>( glMapBuffer( GL_ARRAY_BUFFER, GL_WRITE_ONLY ) );
+	}
+	if( ! mData )
+		throw VboFailedMapExc();
 	mDataEnd = mData + mesh.mObj->mDynamicStride * mesh.getNumVertices();
 }
 
@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2013, The Cinder Project (http://libcinder.org)
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/gl/VboMeshLod.h"
+#include "cinder/TriMeshSimplifier.h"
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+VboMeshLod::VboMeshLod( const vector<TriMesh> &levels, const vector<float> &errors, VboMesh::Layout layout )
+	: mBoundingSphere( Vec3f::zero(), 0 ), mPixelError( 1.0f )
+{
+	for( size_t l = 0; l < levels.size(); ++l ) {
+		mLevels.push_back( VboMesh::create( levels[l], layout ) );
+		mErrors.push_back( l < errors.size() ? errors[l] : 0 );
+	}
+
+	if( ! levels.empty() && ! levels[0].getVertices().empty() )
+		mBoundingSphere = Sphere::calculateBoundingSphere( levels[0].getVertices() );
+}
+
+VboMeshLodRef VboMeshLod::create( const TriMesh &mesh, size_t maxLevels, float reduction, VboMesh::Layout layout )
+{
+	vector<float> errors;
+	vector<TriMesh> levels = TriMeshSimplifier::createLodChain( mesh, maxLevels, reduction, TriMeshSimplifier::Format(), &errors );
+	return VboMeshLodRef( new VboMeshLod( levels, errors, layout ) );
+}
+
+size_t VboMeshLod::selectLevel( const Camera &cam, const Vec2i &viewportSize, const Matrix44f &modelMatrix ) const
+{
+	if( mLevels.size() <= 1 || mBoundingSphere.getRadius() <= 0 )
+		return 0;
+
+	// the model matrix's largest axis scale bounds the world space radius
+	float scale = math<float>::sqrt( std::max( modelMatrix.getColumn( 0 ).xyz().lengthSquared(), std::max( modelMatrix.getColumn( 1 ).xyz().lengthSquared(), modelMatrix.getColumn( 2 ).xyz().lengthSquared() ) ) );
+	Sphere worldSphere( modelMatrix.transformPointAffine( mBoundingSphere.getCenter() ), mBoundingSphere.getRadius() * scale );
+	if( worldSphere.getRadius() <= 0 )
+		return mLevels.size() - 1;
+
+	// with the eye inside the sphere, or the sphere straddling the eye plane, the projection is unbounded
+	Vec3f toCenter = worldSphere.getCenter() - cam.getEyePoint();
+	float depth = toCenter.dot( cam.getViewDirection().normalized() );
+	if( toCenter.lengthSquared() <= worldSphere.getRadius() * worldSphere.getRadius() || math<float>::abs( depth ) <= worldSphere.getRadius() )
+		return 0;
+	// entirely behind the camera
+	if( depth < 0 )
+		return mLevels.size() - 1;
+
+	// errors are in mesh units, as is the radius; their ratio is invariant to the model's scale
+	float screenRadius = cam.getScreenRadius( worldSphere, (float)viewportSize.x, (float)viewportSize.y );
+	float pixelsPerUnit = screenRadius / mBoundingSphere.getRadius();
+	for( size_t l = mLevels.size() - 1; l > 0; --l ) {
+		if( mErrors[l] * pixelsPerUnit <= mPixelError )
+			return l;
+	}
+
+	return 0;
+}
+
+void VboMeshLod::draw( const Camera &cam, const Vec2i &viewportSize, const Matrix44f &modelMatrix ) const
+{
+	if( ! mLevels.empty() )
+		gl::draw( *mLevels[selectLevel( cam, viewportSize, modelMatrix )] );
+}
+
+} } // namespace cinder::gl
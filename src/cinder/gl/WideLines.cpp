@@ -0,0 +1,164 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/gl.h" // must be first
+#include "cinder/gl/WideLines.h"
+
+#if ! defined( CINDER_GLES )
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// gl_Vertex.x runs from 0 at the start of the segment to 1 at its end and gl_Vertex.y from -1 to 1 across it. The quad is lengthened by the radius
+// at either end to make room for the round caps, and the position relative to the segment's start is passed on for the fragment shader to trim.
+const char *sVertexShader =
+	"attribute vec4 segment;\n"
+	"attribute vec4 color;\n"
+	"attribute float width;\n"
+	"varying vec4 vColor;\n"
+	"varying vec2 vLocal;\n"
+	"varying float vLength;\n"
+	"varying float vRadius;\n"
+	"void main() {\n"
+	"	vec2 delta = segment.zw - segment.xy;\n"
+	"	float len = length( delta );\n"
+	"	vec2 dir = ( len > 0.0 ) ? delta / len : vec2( 1.0, 0.0 );\n"
+	"	float radius = 0.5 * width;\n"
+	"	vLocal = vec2( mix( -radius, len + radius, gl_Vertex.x ), gl_Vertex.y * radius );\n"
+	"	vColor = color;\n"
+	"	vLength = len;\n"
+	"	vRadius = radius;\n"
+	"	vec2 position = segment.xy + dir * vLocal.x + vec2( -dir.y, dir.x ) * vLocal.y;\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4( position, 0.0, 1.0 );\n"
+	"}\n";
+
+// Discards everything farther than the radius from the segment, fading alpha over the last pixel
+const char *sFragmentShader =
+	"varying vec4 vColor;\n"
+	"varying vec2 vLocal;\n"
+	"varying float vLength;\n"
+	"varying float vRadius;\n"
+	"void main() {\n"
+	"	float beyond = max( max( -vLocal.x, vLocal.x - vLength ), 0.0 );\n"
+	"	float dist = length( vec2( beyond, vLocal.y ) );\n"
+	"	float coverage = clamp( ( vRadius - dist ) / max( fwidth( dist ), 0.0001 ), 0.0, 1.0 );\n"
+	"	if( coverage <= 0.0 )\n"
+	"		discard;\n"
+	"	gl_FragColor = vec4( vColor.rgb, vColor.a * coverage );\n"
+	"}\n";
+
+GlslProg& getWideLinesShader()
+{
+	static GlslProg sShader;
+	if( ! sShader )
+		sShader = GlslProg( sVertexShader, sFragmentShader );
+	return sShader;
+}
+
+} // anonymous namespace
+
+size_t generateStroke( const Stroke &stroke, const PolyLine2f &polyLine, VboMesh::VertexIter *vertexIter, int texCoordUnit )
+{
+	Vec2f *texCoords = ( texCoordUnit >= 0 ) ? vertexIter->getTexCoord2dPointer( texCoordUnit ) : NULL;
+	const size_t numVertices = stroke.generate( polyLine, vertexIter->getPositionPointer(), vertexIter->getStride(), texCoords, vertexIter->getStride() );
+	vertexIter->advance( numVertices );
+	return numVertices;
+}
+
+VboMeshRef createStrokeMesh( const Stroke &stroke, const PolyLine2f &polyLine )
+{
+	VboMesh::Layout layout;
+	layout.setDynamicPositions();
+	layout.setDynamicTexCoords2d();
+
+	const size_t numVertices = stroke.calcNumVertices( polyLine );
+	VboMeshRef result = VboMesh::create( numVertices, 0, layout, GL_TRIANGLES );
+	if( numVertices > 0 ) {
+		VboMesh::VertexIter iter = result->mapVertexBuffer();
+		generateStroke( stroke, polyLine, &iter );
+	}
+
+	return result;
+}
+
+WideLines::WideLines( size_t reserveSegments )
+	: mDirty( true ), mShader( getWideLinesShader() )
+{
+	mSegments.reserve( reserveSegments );
+
+	TriMesh2d quad;
+	quad.appendVertex( Vec2f( 0, -1 ) );
+	quad.appendVertex( Vec2f( 1, -1 ) );
+	quad.appendVertex( Vec2f( 1, 1 ) );
+	quad.appendVertex( Vec2f( 0, 1 ) );
+	quad.appendTriangle( 0, 1, 2 );
+	quad.appendTriangle( 0, 2, 3 );
+
+	// the instance attributes are added in the order of Segment's members
+	VboMesh::Layout layout;
+	layout.setStaticIndices();
+	layout.setStaticPositions();
+	layout.addInstanceCustomVec4f();
+	layout.addInstanceCustomVec4f();
+	layout.addInstanceCustomFloat();
+	mQuad = VboMesh::create( quad, layout );
+	mQuad->setCustomInstanceLocation( 0, mShader.getAttribLocation( "segment" ) );
+	mQuad->setCustomInstanceLocation( 1, mShader.getAttribLocation( "color" ) );
+	mQuad->setCustomInstanceLocation( 2, mShader.getAttribLocation( "width" ) );
+}
+
+void WideLines::addPolyLine( const PolyLine2f &polyLine, float width, const ColorA &color )
+{
+	const vector<Vec2f> &points = polyLine.getPoints();
+	if( points.size() < 2 )
+		return;
+
+	mSegments.reserve( mSegments.size() + points.size() );
+	for( size_t p = 1; p < points.size(); ++p )
+		mSegments.push_back( Segment( points[p - 1], points[p], width, color ) );
+	if( polyLine.isClosed() && points.back() != points.front() )
+		mSegments.push_back( Segment( points.back(), points.front(), width, color ) );
+	mDirty = true;
+}
+
+void WideLines::draw()
+{
+	if( mSegments.empty() )
+		return;
+
+	if( mDirty ) {
+		mQuad->bufferInstanceData( &mSegments[0], mSegments.size() );
+		mDirty = false;
+	}
+
+	mShader.bind();
+	drawInstanced( mQuad, mSegments.size() );
+	GlslProg::unbind();
+}
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
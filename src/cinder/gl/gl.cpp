@@ -25,18 +25,22 @@
 
 #include "cinder/gl/gl.h"
 #include "cinder/gl/Vbo.h"
+#include "cinder/gl/StateCache.h"
 #include "cinder/CinderMath.h"
 #include "cinder/Vector.h"
 #include "cinder/Camera.h"
 #include "cinder/TriMesh.h"
 #include "cinder/Sphere.h"
 #include "cinder/gl/Texture.h"
+#include "cinder/gl/Material.h"
+#include "cinder/gl/ShapeMesh.h"
 #include "cinder/Text.h"
 #include "cinder/PolyLine.h"
 #include "cinder/Path2d.h"
 #include "cinder/Shape2d.h"
 #include "cinder/Triangulate.h"
 #include <cmath>
+#include <cstddef>
 #include <map>
 
 #if defined( CINDER_MAC ) && ( ! defined( CINDER_COCOA_TOUCH ) )
@@ -46,6 +50,554 @@
 
 namespace cinder { namespace gl {
 
+///////////////////////////////////////////////////////////////////////////////
+// Batch2d
+namespace {
+
+struct BatchVertex {
+	BatchVertex( const Vec3f &pos, const Vec2f &texCoord, const ColorA &color ) : mPos( pos ), mTexCoord( texCoord ), mColor( color ) {}
+
+	Vec3f		mPos;
+	Vec2f		mTexCoord;
+	ColorA		mColor;
+};
+
+// a run of consecutive primitives sharing a mode and texture, submitted with a single glDrawArrays()
+struct BatchRun {
+	BatchRun( GLenum mode, const Texture &texture, GLint first ) : mMode( mode ), mTexture( texture ), mFirst( first ), mCount( 0 ) {}
+
+	GLenum		mMode;
+	Texture		mTexture; // keeps textures drawn by the batch alive until it is flushed
+	GLint		mFirst;
+	GLsizei		mCount;
+};
+
+struct BatchState {
+	BatchState() : mDepth( 0 ) {}
+
+	int							mDepth;
+	std::vector<BatchVertex>	mVertices;
+	std::vector<BatchRun>		mRuns;
+	Matrix44f					mModelView;
+	ColorA						mColor;
+};
+
+BatchState sBatch;
+
+struct RecordedVertex {
+	RecordedVertex() {}
+	RecordedVertex( const Vec3f &pos, const Vec3f &normal, const Vec2f &texCoord, const ColorA &color ) : mPos( pos ), mNormal( normal ), mTexCoord( texCoord ), mColor( color ) {}
+
+	Vec3f		mPos, mNormal;
+	Vec2f		mTexCoord;
+	ColorA		mColor;
+};
+
+// a run of consecutive recorded primitives sharing a mode, texture and line width or point size, replayed with a single glDrawArrays()
+struct RecordedRun {
+	RecordedRun( GLenum mode, const Texture &texture, GLfloat width, GLint first ) : mMode( mode ), mTexture( texture ), mWidth( width ), mFirst( first ), mCount( 0 ) {}
+
+	GLenum		mMode;
+	Texture		mTexture; // keeps textures drawn by draw( const Texture& ... ) alive as long as the recording
+	GLfloat		mWidth;
+	GLint		mFirst;
+	GLsizei		mCount;
+};
+
+// The RecordedDraw between newList() and endList() captures the batched primitives and gl::begin() / gl::end() here, taking precedence over any Batch2d
+struct RecordingState {
+	RecordingState() : mActive( false ), mInPrimitive( false ), mHasNormals( false ), mPrimitiveMode( GL_POINTS ) {}
+
+	bool						mActive, mInPrimitive, mHasNormals;
+	std::vector<RecordedVertex>	mVertices, mPrimitive;
+	std::vector<RecordedRun>	mRuns;
+	Matrix44f					mInverseBase, mTransform, mNormalTransform;
+	RecordedVertex				mCurrent; // the attributes set by gl::color(), gl::normal() and gl::texCoord()
+	GLenum						mPrimitiveMode;
+};
+
+RecordingState sRecording;
+
+// Captures the MODELVIEW matrix, relative to the one at newList(), for the primitive which follows
+void captureRecordedTransform()
+{
+	Matrix44f modelView;
+	glGetFloatv( GL_MODELVIEW_MATRIX, modelView.m );
+	sRecording.mTransform = sRecording.mInverseBase * modelView;
+	sRecording.mNormalTransform = sRecording.mTransform.inverted().transposed();
+}
+
+// Starts a new run unless the last one shares \a mode, \a texture and the current line width or point size
+void beginRecordedRun( GLenum mode, const Texture &texture )
+{
+	GLfloat width = 0;
+	if( mode == GL_LINES )
+		glGetFloatv( GL_LINE_WIDTH, &width );
+	else if( mode == GL_POINTS )
+		glGetFloatv( GL_POINT_SIZE, &width );
+
+	if( sRecording.mRuns.empty() || ( sRecording.mRuns.back().mMode != mode ) || ( sRecording.mRuns.back().mTexture.getId() != texture.getId() ) || ( sRecording.mRuns.back().mWidth != width ) )
+		sRecording.mRuns.push_back( RecordedRun( mode, texture, width, (GLint)sRecording.mVertices.size() ) );
+}
+
+inline void recordVertex( const Vec3f &pos, const Vec3f &normal, const Vec2f &texCoord, const ColorA &color )
+{
+	sRecording.mVertices.push_back( RecordedVertex( sRecording.mTransform.transformPoint( pos ), sRecording.mNormalTransform.transformVec( normal ), texCoord, color ) );
+	++sRecording.mRuns.back().mCount;
+}
+
+// Returns false when no Batch2d is active and nothing is recording. Otherwise captures the current color and MODELVIEW matrix for the primitive which follows, and starts a new run if needed
+bool beginBatchedPrimitive( GLenum mode, const Texture &texture = Texture() )
+{
+	if( sRecording.mActive ) {
+		glGetFloatv( GL_CURRENT_COLOR, sRecording.mCurrent.mColor.ptr() );
+		captureRecordedTransform();
+		beginRecordedRun( mode, texture );
+		return true;
+	}
+
+	if( ! sBatch.mDepth )
+		return false;
+
+	glGetFloatv( GL_CURRENT_COLOR, sBatch.mColor.ptr() );
+	glGetFloatv( GL_MODELVIEW_MATRIX, sBatch.mModelView.m );
+	if( sBatch.mRuns.empty() || ( sBatch.mRuns.back().mMode != mode ) || ( sBatch.mRuns.back().mTexture.getId() != texture.getId() ) )
+		sBatch.mRuns.push_back( BatchRun( mode, texture, (GLint)sBatch.mVertices.size() ) );
+	return true;
+}
+
+inline void batchVertex( const Vec3f &pos, const Vec2f &texCoord = Vec2f::zero() )
+{
+	if( sRecording.mActive ) {
+		recordVertex( pos, sRecording.mCurrent.mNormal, texCoord, sRecording.mCurrent.mColor );
+		return;
+	}
+
+	sBatch.mVertices.push_back( BatchVertex( sBatch.mModelView.transformPoint( pos ), texCoord, sBatch.mColor ) );
+	++sBatch.mRuns.back().mCount;
+}
+
+inline void batchVertex( const Vec2f &pos, const Vec2f &texCoord = Vec2f::zero() )
+{
+	batchVertex( Vec3f( pos.x, pos.y, 0 ), texCoord );
+}
+
+// appends the quad ( x2,y1 ), ( x1,y1 ), ( x2,y2 ), ( x1,y2 ), ordered as the triangle strips used by drawSolidRect() and draw( Texture )
+void batchQuad( const Rectf &rect, const Rectf &texCoords )
+{
+	batchVertex( Vec2f( rect.x2, rect.y1 ), Vec2f( texCoords.x2, texCoords.y1 ) );
+	batchVertex( Vec2f( rect.x1, rect.y1 ), Vec2f( texCoords.x1, texCoords.y1 ) );
+	batchVertex( Vec2f( rect.x2, rect.y2 ), Vec2f( texCoords.x2, texCoords.y2 ) );
+	batchVertex( Vec2f( rect.x1, rect.y1 ), Vec2f( texCoords.x1, texCoords.y1 ) );
+	batchVertex( Vec2f( rect.x2, rect.y2 ), Vec2f( texCoords.x2, texCoords.y2 ) );
+	batchVertex( Vec2f( rect.x1, rect.y2 ), Vec2f( texCoords.x1, texCoords.y2 ) );
+}
+
+// appends a closed outline through \a points as line segments
+void batchLineLoop( const Vec2f *points, size_t numPoints )
+{
+	for( size_t p = 0; p < numPoints; ++p ) {
+		batchVertex( points[p] );
+		batchVertex( points[( p + 1 ) % numPoints] );
+	}
+}
+
+} // anonymous namespace
+
+Batch2d::Batch2d()
+{
+	++sBatch.mDepth;
+}
+
+Batch2d::~Batch2d()
+{
+	if( sBatch.mDepth == 1 )
+		flush();
+	--sBatch.mDepth;
+}
+
+bool Batch2d::isActive()
+{
+	return sBatch.mDepth > 0;
+}
+
+void Batch2d::flush()
+{
+	if( sBatch.mRuns.empty() )
+		return;
+
+	// the vertices are already in eye space
+	GLint oldMatrixMode;
+	glGetIntegerv( GL_MATRIX_MODE, &oldMatrixMode );
+	glMatrixMode( GL_MODELVIEW );
+	glPushMatrix();
+	glLoadIdentity();
+
+	SaveColorState colorState;
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );
+	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glVertexPointer( 3, GL_FLOAT, sizeof(BatchVertex), &sBatch.mVertices[0].mPos.x );
+	glTexCoordPointer( 2, GL_FLOAT, sizeof(BatchVertex), &sBatch.mVertices[0].mTexCoord.x );
+	glColorPointer( 4, GL_FLOAT, sizeof(BatchVertex), &sBatch.mVertices[0].mColor.r );
+
+	for( std::vector<BatchRun>::const_iterator runIt = sBatch.mRuns.begin(); runIt != sBatch.mRuns.end(); ++runIt ) {
+		if( runIt->mTexture ) {
+			SaveTextureBindState saveBindState( runIt->mTexture.getTarget() );
+			BoolState saveEnabledState( runIt->mTexture.getTarget() );
+			glEnable( runIt->mTexture.getTarget() );
+			StateCache::bindTexture( runIt->mTexture.getTarget(), runIt->mTexture.getId() );
+			glDrawArrays( runIt->mMode, runIt->mFirst, runIt->mCount );
+		}
+		else
+			glDrawArrays( runIt->mMode, runIt->mFirst, runIt->mCount );
+	}
+
+	glPopMatrix();
+	glMatrixMode( oldMatrixMode );
+
+	sBatch.mVertices.clear();
+	sBatch.mRuns.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RecordedDraw
+namespace {
+
+#if ! defined( CINDER_GLES )
+// Returns the texture fixed function texturing samples, if any, without taking ownership of it
+Texture getEnabledTexture()
+{
+	if( glIsEnabled( GL_TEXTURE_RECTANGLE_ARB ) ) {
+		GLint id = 0;
+		glGetIntegerv( GL_TEXTURE_BINDING_RECTANGLE_ARB, &id );
+		if( id )
+			return Texture( GL_TEXTURE_RECTANGLE_ARB, (GLuint)id, 0, 0, true );
+	}
+	if( glIsEnabled( GL_TEXTURE_2D ) ) {
+		GLint id = 0;
+		glGetIntegerv( GL_TEXTURE_BINDING_2D, &id );
+		if( id )
+			return Texture( GL_TEXTURE_2D, (GLuint)id, 0, 0, true );
+	}
+	return Texture();
+}
+
+inline void recordPrimitiveVertex( size_t index )
+{
+	const RecordedVertex &v = sRecording.mPrimitive[index];
+	recordVertex( v.mPos, v.mNormal, v.mTexCoord, v.mColor );
+}
+
+// Appends the primitive between gl::begin() and gl::end() as points, lines or triangles
+void recordPrimitive()
+{
+	const size_t n = sRecording.mPrimitive.size();
+	GLenum mode;
+	switch( sRecording.mPrimitiveMode ) {
+		case GL_POINTS: mode = GL_POINTS; break;
+		case GL_LINES: case GL_LINE_STRIP: case GL_LINE_LOOP: mode = GL_LINES; if( n < 2 ) return; break;
+		default: mode = GL_TRIANGLES; if( n < 3 ) return; break;
+	}
+	if( n == 0 )
+		return;
+
+	beginRecordedRun( mode, getEnabledTexture() );
+	switch( sRecording.mPrimitiveMode ) {
+		case GL_POINTS:
+			for( size_t i = 0; i < n; ++i )
+				recordPrimitiveVertex( i );
+		break;
+		case GL_LINES:
+			for( size_t i = 0; i + 1 < n; i += 2 ) {
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 1 );
+			}
+		break;
+		case GL_LINE_STRIP:
+		case GL_LINE_LOOP:
+			for( size_t i = 0; i + 1 < n; ++i ) {
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 1 );
+			}
+			if( sRecording.mPrimitiveMode == GL_LINE_LOOP ) {
+				recordPrimitiveVertex( n - 1 ); recordPrimitiveVertex( 0 );
+			}
+		break;
+		case GL_TRIANGLES:
+			for( size_t i = 0; i + 2 < n; i += 3 ) {
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 1 ); recordPrimitiveVertex( i + 2 );
+			}
+		break;
+		case GL_TRIANGLE_STRIP: // every other triangle is flipped to keep the strip's winding
+			for( size_t i = 0; i + 2 < n; ++i ) {
+				recordPrimitiveVertex( ( i & 1 ) ? i + 1 : i ); recordPrimitiveVertex( ( i & 1 ) ? i : i + 1 ); recordPrimitiveVertex( i + 2 );
+			}
+		break;
+		case GL_QUADS:
+			for( size_t i = 0; i + 3 < n; i += 4 ) {
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 1 ); recordPrimitiveVertex( i + 2 );
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 2 ); recordPrimitiveVertex( i + 3 );
+			}
+		break;
+		case GL_QUAD_STRIP: // quad k is 2k, 2k+1, 2k+3, 2k+2
+			for( size_t i = 0; i + 3 < n; i += 2 ) {
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 1 ); recordPrimitiveVertex( i + 3 );
+				recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 3 ); recordPrimitiveVertex( i + 2 );
+			}
+		break;
+		default: // GL_TRIANGLE_FAN and GL_POLYGON
+			for( size_t i = 1; i + 1 < n; ++i ) {
+				recordPrimitiveVertex( 0 ); recordPrimitiveVertex( i ); recordPrimitiveVertex( i + 1 );
+			}
+		break;
+	}
+}
+#endif // ! defined( CINDER_GLES )
+
+} // anonymous namespace
+
+#if ! defined( CINDER_GLES )
+void begin( GLenum mode )
+{
+	if( ! sRecording.mActive ) {
+		Batch2d::flush();
+		glBegin( mode );
+		return;
+	}
+
+	glGetFloatv( GL_CURRENT_COLOR, sRecording.mCurrent.mColor.ptr() );
+	captureRecordedTransform();
+	sRecording.mPrimitiveMode = mode;
+	sRecording.mPrimitive.clear();
+	sRecording.mInPrimitive = true;
+}
+
+void end()
+{
+	if( ! sRecording.mInPrimitive ) {
+		glEnd();
+		return;
+	}
+
+	sRecording.mInPrimitive = false;
+	recordPrimitive();
+}
+
+void vertex( float x, float y, float z )
+{
+	if( sRecording.mInPrimitive ) {
+		sRecording.mCurrent.mPos = Vec3f( x, y, z );
+		sRecording.mPrimitive.push_back( sRecording.mCurrent );
+	}
+	else
+		glVertex3f( x, y, z );
+}
+
+void texCoord( float x, float y )
+{
+	if( sRecording.mActive )
+		sRecording.mCurrent.mTexCoord = Vec2f( x, y );
+	else
+		glTexCoord2f( x, y );
+}
+
+void texCoord( float x, float y, float z )
+{
+	if( sRecording.mActive )
+		sRecording.mCurrent.mTexCoord = Vec2f( x, y );
+	else
+		glTexCoord3f( x, y, z );
+}
+
+void normal( float x, float y, float z )
+{
+	if( sRecording.mActive ) {
+		sRecording.mCurrent.mNormal = Vec3f( x, y, z );
+		sRecording.mHasNormals = true;
+	}
+	else
+		glNormal3f( x, y, z );
+}
+#endif // ! defined( CINDER_GLES )
+
+void color( float r, float g, float b, float a )
+{
+	glColor4f( r, g, b, a );
+	if( sRecording.mActive )
+		sRecording.mCurrent.mColor = ColorA( r, g, b, a );
+}
+
+struct RecordedDraw::Obj {
+	Obj( GLenum usage ) : mUsage( usage ), mBuffer( 0 ), mNumVertices( 0 ), mHasNormals( false ) { mModelMatrix.setToIdentity(); }
+	~Obj()
+	{
+		if( mBuffer )
+			glDeleteBuffers( 1, &mBuffer );
+	}
+
+	GLenum						mUsage;
+	GLuint						mBuffer;
+	size_t						mNumVertices;
+	bool						mHasNormals;
+	std::vector<RecordedRun>	mRuns;
+	Matrix44f					mModelMatrix;
+	std::shared_ptr<Material>	mMaterial;
+};
+
+RecordedDraw::RecordedDraw( GLenum usage )
+	: mObj( std::shared_ptr<Obj>( new Obj( usage ) ) )
+{
+}
+
+void RecordedDraw::newList()
+{
+	Batch2d::flush();
+
+	Matrix44f base;
+	glGetFloatv( GL_MODELVIEW_MATRIX, base.m );
+	sRecording.mInverseBase = base.inverted();
+	sRecording.mVertices.clear();
+	sRecording.mRuns.clear();
+	sRecording.mHasNormals = false;
+	sRecording.mInPrimitive = false;
+
+	GLfloat texCoord[4];
+	glGetFloatv( GL_CURRENT_NORMAL, &sRecording.mCurrent.mNormal.x );
+	glGetFloatv( GL_CURRENT_TEXTURE_COORDS, texCoord );
+	glGetFloatv( GL_CURRENT_COLOR, sRecording.mCurrent.mColor.ptr() );
+	sRecording.mCurrent.mTexCoord = Vec2f( texCoord[0], texCoord[1] );
+	sRecording.mActive = true;
+}
+
+void RecordedDraw::endList()
+{
+	sRecording.mActive = false;
+	sRecording.mInPrimitive = false;
+
+	mObj->mRuns.swap( sRecording.mRuns );
+	sRecording.mRuns.clear();
+	mObj->mNumVertices = sRecording.mVertices.size();
+	mObj->mHasNormals = sRecording.mHasNormals;
+
+	if( ! mObj->mBuffer )
+		glGenBuffers( 1, &mObj->mBuffer );
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, mObj->mBuffer );
+	glBufferData( GL_ARRAY_BUFFER, sizeof(RecordedVertex) * mObj->mNumVertices, sRecording.mVertices.empty() ? NULL : &sRecording.mVertices[0], mObj->mUsage );
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, 0 );
+
+	// static recordings are made once, so their memory is released, while dynamic ones keep it for the next recording
+	if( mObj->mUsage == GL_STATIC_DRAW )
+		std::vector<RecordedVertex>().swap( sRecording.mVertices );
+	else
+		sRecording.mVertices.clear();
+}
+
+bool RecordedDraw::isRecording()
+{
+	return sRecording.mActive;
+}
+
+void RecordedDraw::draw() const
+{
+	Batch2d::flush();
+	if( mObj->mRuns.empty() )
+		return;
+
+	if( mObj->mMaterial )
+		mObj->mMaterial->apply();
+
+	GLint oldMatrixMode;
+	glGetIntegerv( GL_MATRIX_MODE, &oldMatrixMode );
+	glMatrixMode( GL_MODELVIEW );
+	glPushMatrix();
+	multModelView( mObj->mModelMatrix );
+
+	SaveColorState colorState;
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState normalArrayState( GL_NORMAL_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );
+	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	if( mObj->mHasNormals )
+		glEnableClientState( GL_NORMAL_ARRAY );
+	else
+		glDisableClientState( GL_NORMAL_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, mObj->mBuffer );
+	glVertexPointer( 3, GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof( RecordedVertex, mPos ) );
+	glNormalPointer( GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof( RecordedVertex, mNormal ) );
+	glTexCoordPointer( 2, GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof( RecordedVertex, mTexCoord ) );
+	glColorPointer( 4, GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof( RecordedVertex, mColor ) );
+
+	// line width and point size are only queried, and later restored, if the recording has lines or points
+	GLfloat oldLineWidth = -1, oldPointSize = -1;
+	for( std::vector<RecordedRun>::const_iterator runIt = mObj->mRuns.begin(); runIt != mObj->mRuns.end(); ++runIt ) {
+		if( runIt->mMode == GL_LINES ) {
+			if( oldLineWidth < 0 )
+				glGetFloatv( GL_LINE_WIDTH, &oldLineWidth );
+			glLineWidth( runIt->mWidth );
+		}
+		else if( runIt->mMode == GL_POINTS ) {
+			if( oldPointSize < 0 )
+				glGetFloatv( GL_POINT_SIZE, &oldPointSize );
+			glPointSize( runIt->mWidth );
+		}
+
+		if( runIt->mTexture ) {
+			SaveTextureBindState saveBindState( runIt->mTexture.getTarget() );
+			BoolState saveEnabledState( runIt->mTexture.getTarget() );
+			glEnable( runIt->mTexture.getTarget() );
+			StateCache::bindTexture( runIt->mTexture.getTarget(), runIt->mTexture.getId() );
+			glDrawArrays( runIt->mMode, runIt->mFirst, runIt->mCount );
+		}
+		else
+			glDrawArrays( runIt->mMode, runIt->mFirst, runIt->mCount );
+	}
+
+	if( oldLineWidth >= 0 )
+		glLineWidth( oldLineWidth );
+	if( oldPointSize >= 0 )
+		glPointSize( oldPointSize );
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, 0 );
+
+	glPopMatrix();
+	glMatrixMode( oldMatrixMode );
+}
+
+size_t RecordedDraw::getNumVertices() const
+{
+	return mObj->mNumVertices;
+}
+
+size_t RecordedDraw::getNumDrawCalls() const
+{
+	return mObj->mRuns.size();
+}
+
+Matrix44f& RecordedDraw::getModelMatrix()
+{
+	return mObj->mModelMatrix;
+}
+
+const Matrix44f& RecordedDraw::getModelMatrix() const
+{
+	return mObj->mModelMatrix;
+}
+
+void RecordedDraw::setMaterial( const Material &material )
+{
+	mObj->mMaterial = std::shared_ptr<Material>( new Material( material ) );
+}
+
+Material& RecordedDraw::getMaterial()
+{
+	return *mObj->mMaterial;
+}
+
 #if defined( CINDER_MSW )
 void initializeGlee() {
 /*#if defined( CINDER_MAC )
@@ -217,9 +769,10 @@ bool isExtensionAvailable( const std::string &extName )
 
 void clear( const ColorA &color, bool clearDepthBuffer )
 {
+	Batch2d::flush();
 	glClearColor( color.r, color.g, color.b, color.a );
 	if( clearDepthBuffer ) {
-		glDepthMask( GL_TRUE );
+		StateCache::depthMask( GL_TRUE );
 		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 	}
 	else
@@ -262,6 +815,7 @@ void setModelView( const Camera &cam )
 
 void setProjection( const Camera &cam )
 {
+	Batch2d::flush();
 	glMatrixMode( GL_PROJECTION );
 	glLoadMatrixf( cam.getProjectionMatrix().m );
 }
@@ -293,6 +847,7 @@ void pushModelView( const Camera &cam )
 
 void pushProjection( const Camera &cam )
 {
+	Batch2d::flush();
 	glMatrixMode( GL_PROJECTION );
 	glPushMatrix();
 	glLoadMatrixf( cam.getProjectionMatrix().m );
@@ -308,6 +863,7 @@ void pushMatrices()
 
 void popMatrices()
 {
+	Batch2d::flush();
 	glMatrixMode( GL_PROJECTION );
 	glPopMatrix();
 	glMatrixMode( GL_MODELVIEW );
@@ -322,6 +878,7 @@ void multModelView( const Matrix44f &mtx )
 
 void multProjection( const Matrix44f &mtx )
 {
+	Batch2d::flush();
 	glMatrixMode( GL_PROJECTION );
 	glMultMatrixf( mtx );
 }
@@ -342,6 +899,7 @@ Matrix44f getProjection()
 
 void setMatricesWindowPersp( int screenWidth, int screenHeight, float fovDegrees, float nearPlane, float farPlane, bool originUpperLeft )
 {
+	Batch2d::flush();
 	CameraPersp cam( screenWidth, screenHeight, fovDegrees, nearPlane, farPlane );
 
 	glMatrixMode( GL_PROJECTION );
@@ -357,6 +915,7 @@ void setMatricesWindowPersp( int screenWidth, int screenHeight, float fovDegrees
 
 void setMatricesWindow( int screenWidth, int screenHeight, bool originUpperLeft )
 {
+	Batch2d::flush();
 	glMatrixMode( GL_PROJECTION );
 	glLoadIdentity();
 #if defined( CINDER_GLES )
@@ -384,6 +943,7 @@ Area getViewport()
 
 void setViewport( const Area &area )
 {
+	Batch2d::flush();
 	glViewport( area.x1, area.y1, ( area.x2 - area.x1 ), ( area.y2 - area.y1 ) );
 }
 
@@ -420,72 +980,86 @@ void rotate( const Quatf &quat )
 
 void enableAlphaBlending( bool premultiplied )
 {
-	glEnable( GL_BLEND );
+	Batch2d::flush();
+	StateCache::setCapability( GL_BLEND, true );
 	if( ! premultiplied )
-		glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+		StateCache::blendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 	else
-		glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+		StateCache::blendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
 }
 
 void disableAlphaBlending()
 {
-	glDisable( GL_BLEND );
+	Batch2d::flush();
+	StateCache::setCapability( GL_BLEND, false );
 }
 
 void enableAdditiveBlending()
 {
-	glEnable( GL_BLEND );
-	glBlendFunc( GL_SRC_ALPHA, GL_ONE );	
+	Batch2d::flush();
+	StateCache::setCapability( GL_BLEND, true );
+	StateCache::blendFunc( GL_SRC_ALPHA, GL_ONE );
 }
 
 void enableAlphaTest( float value, int func )
 {
-	glEnable( GL_ALPHA_TEST );
+	Batch2d::flush();
+	StateCache::setCapability( GL_ALPHA_TEST, true );
 	glAlphaFunc( func, value );
 }
 
 void disableAlphaTest()
 {
-	glDisable( GL_ALPHA_TEST );
+	Batch2d::flush();
+	StateCache::setCapability( GL_ALPHA_TEST, false );
 }
 
 #if ! defined( CINDER_GLES )
 void enableWireframe()
 {
+	Batch2d::flush();
 	glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 }
 
 void disableWireframe()
 {
+	Batch2d::flush();
 	glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
 }
 #endif
 
 void disableDepthRead()
 {
-	glDisable( GL_DEPTH_TEST );
+	Batch2d::flush();
+	StateCache::setCapability( GL_DEPTH_TEST, false );
 }
 
 void enableDepthRead( bool enable )
 {
-	if( enable )
-		glEnable( GL_DEPTH_TEST );
-	else
-		glDisable( GL_DEPTH_TEST );
+	Batch2d::flush();
+	StateCache::setCapability( GL_DEPTH_TEST, enable );
 }
 
 void enableDepthWrite( bool enable )
 {
-	glDepthMask( (enable) ? GL_TRUE : GL_FALSE );
+	Batch2d::flush();
+	StateCache::depthMask( (enable) ? GL_TRUE : GL_FALSE );
 }
 
 void disableDepthWrite()
 {
-	glDepthMask( GL_FALSE );
+	Batch2d::flush();
+	StateCache::depthMask( GL_FALSE );
 }
 
 void drawLine( const Vec2f &start, const Vec2f &end )
 {
+	if( beginBatchedPrimitive( GL_LINES ) ) {
+		batchVertex( start );
+		batchVertex( end );
+		return;
+	}
+
 	float lineVerts[2*2];
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, lineVerts );
@@ -497,6 +1071,12 @@ void drawLine( const Vec2f &start, const Vec2f &end )
 
 void drawLine( const Vec3f &start, const Vec3f &end )
 {
+	if( beginBatchedPrimitive( GL_LINES ) ) {
+		batchVertex( start );
+		batchVertex( end );
+		return;
+	}
+
 	float lineVerts[3*2];
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 3, GL_FLOAT, 0, lineVerts );
@@ -509,6 +1089,7 @@ void drawLine( const Vec3f &start, const Vec3f &end )
 namespace {
 void drawCubeImpl( const Vec3f &c, const Vec3f &size, bool drawColors )
 {
+	Batch2d::flush();
 	GLfloat sx = size.x * 0.5f;
 	GLfloat sy = size.y * 0.5f;
 	GLfloat sz = size.z * 0.5f;
@@ -585,6 +1166,7 @@ void drawColorCube( const Vec3f &center, const Vec3f &size )
 
 void drawStrokedCube( const Vec3f &center, const Vec3f &size )
 {
+	Batch2d::flush();
 	Vec3f min = center - size * 0.5f;
 	Vec3f max = center + size * 0.5f;
 
@@ -608,6 +1190,7 @@ void drawStrokedCube( const Vec3f &center, const Vec3f &size )
 // We should weigh an alternative that reduces the batch count by using GL_TRIANGLES instead
 void drawSphere( const Vec3f &center, float radius, int segments )
 {
+	Batch2d::flush();
 	if( segments < 0 )
 		return;
 
@@ -679,6 +1262,16 @@ void drawSolidCircle( const Vec2f &center, float radius, int numSegments )
 		verts[(s+1)*2+0] = center.x + math<float>::cos( t ) * radius;
 		verts[(s+1)*2+1] = center.y + math<float>::sin( t ) * radius;
 	}
+	if( beginBatchedPrimitive( GL_TRIANGLES ) ) {
+		const Vec2f *fan = reinterpret_cast<const Vec2f*>( verts );
+		for( int s = 1; s <= numSegments; ++s ) {
+			batchVertex( fan[0] );
+			batchVertex( fan[s] );
+			batchVertex( fan[s+1] );
+		}
+		delete [] verts;
+		return;
+	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
 	glDrawArrays( GL_TRIANGLE_FAN, 0, numSegments + 2 );
@@ -700,6 +1293,11 @@ void drawStrokedCircle( const Vec2f &center, float radius, int numSegments )
 		verts[s*2+0] = center.x + math<float>::cos( t ) * radius;
 		verts[s*2+1] = center.y + math<float>::sin( t ) * radius;
 	}
+	if( beginBatchedPrimitive( GL_LINES ) ) {
+		batchLineLoop( reinterpret_cast<const Vec2f*>( verts ), numSegments );
+		delete [] verts;
+		return;
+	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
 	glDrawArrays( GL_LINE_LOOP, 0, numSegments );
@@ -723,6 +1321,16 @@ void drawSolidEllipse( const Vec2f &center, float radiusX, float radiusY, int nu
 		verts[(s+1)*2+0] = center.x + math<float>::cos( t ) * radiusX;
 		verts[(s+1)*2+1] = center.y + math<float>::sin( t ) * radiusY;
 	}
+	if( beginBatchedPrimitive( GL_TRIANGLES ) ) {
+		const Vec2f *fan = reinterpret_cast<const Vec2f*>( verts );
+		for( int s = 1; s <= numSegments; ++s ) {
+			batchVertex( fan[0] );
+			batchVertex( fan[s] );
+			batchVertex( fan[s+1] );
+		}
+		delete [] verts;
+		return;
+	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
 	glDrawArrays( GL_TRIANGLE_FAN, 0, numSegments + 2 );
@@ -744,6 +1352,11 @@ void drawStrokedEllipse( const Vec2f &center, float radiusX, float radiusY, int
 		verts[s*2+0] = center.x + math<float>::cos( t ) * radiusX;
 		verts[s*2+1] = center.y + math<float>::sin( t ) * radiusY;
 	}
+	if( beginBatchedPrimitive( GL_LINES ) ) {
+		batchLineLoop( reinterpret_cast<const Vec2f*>( verts ), numSegments );
+		delete [] verts;
+		return;
+	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
 	glDrawArrays( GL_LINE_LOOP, 0, numSegments );
@@ -753,6 +1366,11 @@ void drawStrokedEllipse( const Vec2f &center, float radiusX, float radiusY, int
 
 void drawSolidRect( const Rectf &rect, bool textureRectangle )
 {
+	if( beginBatchedPrimitive( GL_TRIANGLES ) ) {
+		batchQuad( rect, ( textureRectangle ) ? rect : Rectf( 0, 0, 1, 1 ) );
+		return;
+	}
+
 	glEnableClientState( GL_VERTEX_ARRAY );
 	GLfloat verts[8];
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
@@ -781,6 +1399,10 @@ void drawStrokedRect( const Rectf &rect )
 	verts[2] = rect.getX2();	verts[3] = rect.getY1();
 	verts[4] = rect.getX2();	verts[5] = rect.getY2();
 	verts[6] = rect.getX1();	verts[7] = rect.getY2();
+	if( beginBatchedPrimitive( GL_LINES ) ) {
+		batchLineLoop( reinterpret_cast<const Vec2f*>( verts ), 4 );
+		return;
+	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
 	glDrawArrays( GL_LINE_LOOP, 0, 4 );
@@ -789,6 +1411,7 @@ void drawStrokedRect( const Rectf &rect )
 
 void drawSolidRoundedRect( const Rectf &r, float cornerRadius, int numSegmentsPerCorner )
 {
+	Batch2d::flush();
 	// automatically determine the number of segments from the circumference
 	if( numSegmentsPerCorner <= 0 ) {
 		numSegmentsPerCorner = (int)math<double>::floor( cornerRadius * M_PI * 2 / 4 );
@@ -827,6 +1450,7 @@ void drawSolidRoundedRect( const Rectf &r, float cornerRadius, int numSegmentsPe
 
 void drawStrokedRoundedRect( const Rectf &r, float cornerRadius, int numSegmentsPerCorner )
 {
+	Batch2d::flush();
 	// automatically determine the number of segments from the circumference
 	if( numSegmentsPerCorner <= 0 ) {
 		numSegmentsPerCorner = (int)math<double>::floor( cornerRadius * M_PI * 2 / 4 );
@@ -864,6 +1488,12 @@ void drawSolidTriangle( const Vec2f &pt1, const Vec2f &pt2, const Vec2f &pt3 )
 
 void drawSolidTriangle( const Vec2f pts[3] )
 {
+	if( beginBatchedPrimitive( GL_TRIANGLES ) ) {
+		for( int p = 0; p < 3; ++p )
+			batchVertex( pts[p] );
+		return;
+	}
+
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &pts[0].x );
 	glDrawArrays( GL_TRIANGLES, 0, 3 );
@@ -879,6 +1509,12 @@ void drawSolidTriangle( const Vec2f &pt1, const Vec2f &pt2, const Vec2f &pt3, co
 	
 void drawSolidTriangle( const Vec2f pts[3], const Vec2f texCoord[3] )
 {
+	if( beginBatchedPrimitive( GL_TRIANGLES ) ) {
+		for( int p = 0; p < 3; ++p )
+			batchVertex( pts[p], texCoord[p] );
+		return;
+	}
+
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &pts[0].x );
@@ -896,6 +1532,11 @@ void drawStrokedTriangle( const Vec2f &pt1, const Vec2f &pt2, const Vec2f &pt3 )
 
 void drawStrokedTriangle( const Vec2f pts[3] )
 {
+	if( beginBatchedPrimitive( GL_LINES ) ) {
+		batchLineLoop( pts, 3 );
+		return;
+	}
+
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &pts[0].x );
 	glDrawArrays( GL_LINE_LOOP, 0, 3 );
@@ -914,6 +1555,7 @@ void drawCoordinateFrame( float axisLength, float headLength, float headRadius )
 
 void drawVector( const Vec3f &start, const Vec3f &end, float headLength, float headRadius )
 {
+	Batch2d::flush();
 	const int NUM_SEGMENTS = 32;
 	float lineVerts[3*2];
 	Vec3f coneVerts[NUM_SEGMENTS+2];
@@ -953,6 +1595,7 @@ void drawVector( const Vec3f &start, const Vec3f &end, float headLength, float h
 
 void drawFrustum( const Camera &cam )
 {
+	Batch2d::flush();
 	Vec3f vertex[8];
 	Vec3f nearTopLeft, nearTopRight, nearBottomLeft, nearBottomRight;
 	cam.getNearClipCoordinates( &nearTopLeft, &nearTopRight, &nearBottomLeft, &nearBottomRight );
@@ -1018,6 +1661,7 @@ void drawFrustum( const Camera &cam )
 
 void drawTorus( float outterRadius, float innerRadius, int longitudeSegments, int latitudeSegments )
 {
+	Batch2d::flush();
 	longitudeSegments = std::min( std::max( 7, longitudeSegments ) + 1, 255 );
 	latitudeSegments = std::min( std::max( 7, latitudeSegments ) + 1, 255 );
 
@@ -1076,6 +1720,7 @@ void drawTorus( float outterRadius, float innerRadius, int longitudeSegments, in
 
 void drawCylinder( float base, float top, float height, int slices, int stacks )
 {
+	Batch2d::flush();
 	stacks = math<int>::max(2, stacks + 1);	// minimum of 1 stack
 	slices = math<int>::max(4, slices + 1);	// minimum of 3 slices
 
@@ -1136,6 +1781,7 @@ void drawCylinder( float base, float top, float height, int slices, int stacks )
 
 void draw( const PolyLine<Vec2f> &polyLine )
 {
+	Batch2d::flush();
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &(polyLine.getPoints()[0]) );
 	glDrawArrays( ( polyLine.isClosed() ) ? GL_LINE_LOOP : GL_LINE_STRIP, 0, (GLsizei)polyLine.size() );
@@ -1144,16 +1790,42 @@ void draw( const PolyLine<Vec2f> &polyLine )
 
 void draw( const PolyLine<Vec3f> &polyLine )
 {
+	Batch2d::flush();
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 3, GL_FLOAT, 0, &(polyLine.getPoints()[0]) );
 	glDrawArrays( ( polyLine.isClosed() ) ? GL_LINE_LOOP : GL_LINE_STRIP, 0, (GLsizei)polyLine.size() );
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
 
+void draw( const PolyLine2f &polyLine, const Stroke &stroke )
+{
+	Batch2d::flush();
+	std::vector<Vec3f> positions;
+	std::vector<Vec2f> texCoords;
+	stroke.generate( polyLine, &positions, &texCoords );
+	if( positions.empty() )
+		return;
+
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glVertexPointer( 3, GL_FLOAT, 0, &positions[0] );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glTexCoordPointer( 2, GL_FLOAT, 0, &texCoords[0] );
+	glDrawArrays( GL_TRIANGLES, 0, (GLsizei)positions.size() );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+}
+
 void draw( const Path2d &path2d, float approximationScale )
 {
+	Batch2d::flush();
 	if( path2d.getNumSegments() == 0 )
 		return;
+#if ! defined( CINDER_GLES )
+	if( ShapeMeshRef shapeMesh = ShapeMesh::findCached( path2d, approximationScale ) ) {
+		shapeMesh->draw();
+		return;
+	}
+#endif
 	std::vector<Vec2f> points = path2d.subdivide( approximationScale );
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &(points[0]) );
@@ -1163,6 +1835,13 @@ void draw( const Path2d &path2d, float approximationScale )
 
 void draw( const Shape2d &shape2d, float approximationScale )
 {
+	Batch2d::flush();
+#if ! defined( CINDER_GLES )
+	if( ShapeMeshRef shapeMesh = ShapeMesh::findCached( shape2d, approximationScale ) ) {
+		shapeMesh->draw();
+		return;
+	}
+#endif
 	glEnableClientState( GL_VERTEX_ARRAY );
 	for( std::vector<Path2d>::const_iterator contourIt = shape2d.getContours().begin(); contourIt != shape2d.getContours().end(); ++contourIt ) {
 		if( contourIt->getNumSegments() == 0 )
@@ -1177,12 +1856,26 @@ void draw( const Shape2d &shape2d, float approximationScale )
 
 void drawSolid( const Path2d &path2d, float approximationScale )
 {
-	draw( Triangulator( path2d ).calcMesh() );
+#if ! defined( CINDER_GLES )
+	if( ShapeMeshRef shapeMesh = ShapeMesh::findCached( path2d, approximationScale ) ) {
+		Batch2d::flush();
+		shapeMesh->drawSolid();
+		return;
+	}
+#endif
+	draw( Triangulator( path2d, approximationScale ).calcMesh() );
 }
 
 void drawSolid( const Shape2d &shape2d, float approximationScale )
 {
-	draw( Triangulator( shape2d ).calcMesh() );
+#if ! defined( CINDER_GLES )
+	if( ShapeMeshRef shapeMesh = ShapeMesh::findCached( shape2d, approximationScale ) ) {
+		Batch2d::flush();
+		shapeMesh->drawSolid();
+		return;
+	}
+#endif
+	draw( Triangulator( shape2d, approximationScale ).calcMesh() );
 }
 
 void drawSolid( const PolyLine2f &polyLine )
@@ -1193,6 +1886,7 @@ void drawSolid( const PolyLine2f &polyLine )
 // TriMesh2d
 void draw( const TriMesh2d &mesh )
 {
+	Batch2d::flush();
 	if( mesh.getNumVertices() <= 0 )
 		return;
 
@@ -1238,6 +1932,7 @@ void draw( const TriMesh2d &mesh )
 // TriMesh2d
 void drawRange( const TriMesh2d &mesh, size_t startTriangle, size_t triangleCount )
 {
+	Batch2d::flush();
 	glVertexPointer( 2, GL_FLOAT, 0, &(mesh.getVertices()[0]) );
 	glEnableClientState( GL_VERTEX_ARRAY );
 
@@ -1284,6 +1979,7 @@ void drawRange( const TriMesh2d &mesh, size_t startTriangle, size_t triangleCoun
 // TriMesh
 void draw( const TriMesh &mesh )
 {
+	Batch2d::flush();
 	glVertexPointer( 3, GL_FLOAT, 0, &(mesh.getVertices()[0]) );
 	glEnableClientState( GL_VERTEX_ARRAY );
 
@@ -1331,6 +2027,7 @@ void draw( const TriMesh &mesh )
 // TriMesh2d
 void drawRange( const TriMesh &mesh, size_t startTriangle, size_t triangleCount )
 {
+	Batch2d::flush();
 	glVertexPointer( 3, GL_FLOAT, 0, &(mesh.getVertices()[0]) );
 	glEnableClientState( GL_VERTEX_ARRAY );
 
@@ -1380,8 +2077,32 @@ void drawRange( const TriMesh &mesh, size_t startTriangle, size_t triangleCount
 }
 
 #if ! defined ( CINDER_GLES )
+namespace {
+// Quantized positions are mapped back into object space on the modelview matrix. The scale is uniform, so normals only need rescaling to unit length.
+void pushPositionDequantization( const VboMesh &vbo )
+{
+	if( ! vbo.hasQuantizedPositions() )
+		return;
+	gl::pushModelView();
+	gl::translate( vbo.getPositionTranslate() );
+	gl::scale( Vec3f( vbo.getPositionScale(), vbo.getPositionScale(), vbo.getPositionScale() ) );
+	glPushAttrib( GL_ENABLE_BIT );
+	if( ! glIsEnabled( GL_NORMALIZE ) )
+		glEnable( GL_RESCALE_NORMAL );
+}
+
+void popPositionDequantization( const VboMesh &vbo )
+{
+	if( ! vbo.hasQuantizedPositions() )
+		return;
+	glPopAttrib();
+	gl::popModelView();
+}
+} // anonymous namespace
+
 void draw( const VboMesh &vbo )
 {
+	Batch2d::flush();
 	if( vbo.getNumIndices() > 0 )
 		drawRange( vbo, (size_t)0, vbo.getNumIndices() );
 	else
@@ -1390,6 +2111,7 @@ void draw( const VboMesh &vbo )
 
 void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int vertexStart, int vertexEnd )
 {
+	Batch2d::flush();
 	if( vbo.getNumIndices() <= 0 )
 		return;
 
@@ -1398,19 +2120,41 @@ void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int ve
 
 	vbo.enableClientStates();
 	vbo.bindAllData();
+	pushPositionDequantization( vbo );
 	
-	glDrawRangeElements( vbo.getPrimitiveType(), vertexStart, vertexEnd, (GLsizei)indexCount, GL_UNSIGNED_INT, (GLvoid*)( sizeof(uint32_t) * startIndex ) );
+	glDrawRangeElements( vbo.getPrimitiveType(), vertexStart, vertexEnd, (GLsizei)indexCount, vbo.getIndexType(), (GLvoid*)( vbo.getIndexSize() * startIndex ) );
 	
+	popPositionDequantization( vbo );
 	gl::VboMesh::unbindBuffers();
 	vbo.disableClientStates();
 }
 
 void drawArrays( const VboMesh &vbo, GLint first, GLsizei count )
 {
+	Batch2d::flush();
 	vbo.enableClientStates();
 	vbo.bindAllData();
+	pushPositionDequantization( vbo );
 	glDrawArrays( vbo.getPrimitiveType(), first, count );
 
+	popPositionDequantization( vbo );
+	gl::VboMesh::unbindBuffers();
+	vbo.disableClientStates();
+}
+
+void drawInstanced( const VboMesh &vbo, size_t instanceCount )
+{
+	Batch2d::flush();
+	vbo.enableClientStates();
+	vbo.bindAllData();
+	pushPositionDequantization( vbo );
+
+	if( vbo.getNumIndices() > 0 )
+		glDrawElementsInstancedARB( vbo.getPrimitiveType(), (GLsizei)vbo.getNumIndices(), vbo.getIndexType(), (GLvoid*)0, (GLsizei)instanceCount );
+	else
+		glDrawArraysInstancedARB( vbo.getPrimitiveType(), 0, (GLsizei)vbo.getNumVertices(), (GLsizei)instanceCount );
+
+	popPositionDequantization( vbo );
 	gl::VboMesh::unbindBuffers();
 	vbo.disableClientStates();
 }
@@ -1419,6 +2163,7 @@ void drawArrays( const VboMesh &vbo, GLint first, GLsizei count )
 
 void drawBillboard( const Vec3f &pos, const Vec2f &scale, float rotationDegrees, const Vec3f &bbRight, const Vec3f &bbUp )
 {
+	Batch2d::flush();
 	glEnableClientState( GL_VERTEX_ARRAY );
 	Vec3f verts[4];
 	glVertexPointer( 3, GL_FLOAT, 0, &verts[0].x );
@@ -1457,6 +2202,11 @@ void draw( const Texture &texture, const Rectf &rect )
 
 void draw( const Texture &texture, const Area &srcArea, const Rectf &destRect )
 {
+	if( beginBatchedPrimitive( GL_TRIANGLES, texture ) ) {
+		batchQuad( destRect, texture.getAreaTexCoords( srcArea ) );
+		return;
+	}
+
 	SaveTextureBindState saveBindState( texture.getTarget() );
 	BoolState saveEnabledState( texture.getTarget() );
 	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
@@ -1553,7 +2303,7 @@ SaveTextureBindState::SaveTextureBindState( GLint target )
 
 SaveTextureBindState::~SaveTextureBindState()
 {
-	glBindTexture( mTarget, mOldID );
+	StateCache::bindTexture( mTarget, mOldID );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1566,10 +2316,7 @@ BoolState::BoolState( GLint target )
 
 BoolState::~BoolState()
 {
-	if( mOldValue )
-		glEnable( mTarget );
-	else
-		glDisable( mTarget );
+	StateCache::setCapability( mTarget, mOldValue != GL_FALSE );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1619,9 +2366,9 @@ SaveFramebufferBinding::SaveFramebufferBinding()
 SaveFramebufferBinding::~SaveFramebufferBinding()
 {
 #if defined( CINDER_GLES )
-	glBindFramebufferOES( GL_FRAMEBUFFER_OES, mOldValue );
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_OES, mOldValue );
 #else
-	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mOldValue );
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mOldValue );
 #endif
 }
 
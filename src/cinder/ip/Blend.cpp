@@ -23,11 +23,205 @@
 
 #include "cinder/ip/Blend.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 
 using namespace std;
 
 namespace cinder { namespace ip {
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+// exact floor( x / 255 ) for 16-bit lanes in [0, 255 * 255]
+inline __m128i div255_epu16( __m128i x )
+{
+	return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( x, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( x, 8 ) ), 8 );
+}
+
+template<int ALPHA>
+inline __m128i broadcastAlpha_epi16( __m128i px )
+{
+	return _mm_shufflehi_epi16( _mm_shufflelo_epi16( px, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+}
+
+inline __m128i select_si128( __m128i mask, __m128i a, __m128i b )
+{
+	return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+}
+
+/*	Two pixels unpacked to 16-bit lanes. The 8 bit blend equations above simplify exactly since αd + (1–αd) = 255:
+		premult * premult:		Cr = Cs + αd' × Cd / 255		(truncated to 8 bits, as in blendImpl_u8())
+		premult * unpremult:	Cr = [αd' × Cd + αs × Cs] / 255
+	where αd' = 255 – αs. The no dst alpha cases are the same equations with αd = 255. */
+template<int ALPHA, bool DSTALPHA, bool SRCPREMULT>
+inline __m128i blend2_epu16( __m128i src, __m128i dst )
+{
+	const __m128i alphaLanes = _mm_set_epi16( ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0,
+											ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0 );
+	const __m128i max = _mm_set1_epi16( 255 );
+	const __m128i alphaS = broadcastAlpha_epi16<ALPHA>( src );
+	const __m128i invAlphaS = _mm_sub_epi16( max, alphaS );
+
+	__m128i result;
+	if( SRCPREMULT )
+		result = _mm_and_si128( _mm_add_epi16( src, div255_epu16( _mm_mullo_epi16( invAlphaS, dst ) ) ), max );
+	else
+		result = div255_epu16( _mm_add_epi16( _mm_mullo_epi16( invAlphaS, dst ), _mm_mullo_epi16( alphaS, src ) ) );
+
+	if( DSTALPHA ) {
+		const __m128i invAlphaD = _mm_sub_epi16( max, broadcastAlpha_epi16<ALPHA>( dst ) );
+		const __m128i alphaR = _mm_sub_epi16( max, div255_epu16( _mm_mullo_epi16( invAlphaS, invAlphaD ) ) );
+		// fully transparent results leave the color untouched
+		result = select_si128( _mm_cmpeq_epi16( alphaR, _mm_setzero_si128() ), dst, result );
+		return select_si128( alphaLanes, alphaR, result );
+	}
+	else // the padding channel is preserved
+		return select_si128( alphaLanes, dst, result );
+}
+
+template<int ALPHA, bool DSTALPHA, bool SRCPREMULT>
+int32_t blendRowSse2( const uint8_t *src, uint8_t *dst, int32_t width )
+{
+	const __m128i zero = _mm_setzero_si128();
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, src += 16, dst += 16 ) {
+		__m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+		__m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst ) );
+		__m128i lo = blend2_epu16<ALPHA,DSTALPHA,SRCPREMULT>( _mm_unpacklo_epi8( s, zero ), _mm_unpacklo_epi8( d, zero ) );
+		__m128i hi = blend2_epu16<ALPHA,DSTALPHA,SRCPREMULT>( _mm_unpackhi_epi8( s, zero ), _mm_unpackhi_epi8( d, zero ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), _mm_packus_epi16( lo, hi ) );
+	}
+	return x;
+}
+
+// One pixel per iteration, evaluating the same expressions in the same order as blendImpl_float() so results are identical
+template<int ALPHA, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+int32_t blendRowSse2( const float *src, float *dst, int32_t width )
+{
+	const __m128 alphaLane = _mm_castsi128_ps( _mm_set_epi32( ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0 ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	for( int32_t x = 0; x < width; ++x, src += 4, dst += 4 ) {
+		const __m128 s = _mm_loadu_ps( src );
+		const __m128 d = _mm_loadu_ps( dst );
+		const __m128 alphaS = _mm_shuffle_ps( s, s, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		const __m128 invAlphaS = _mm_sub_ps( one, alphaS );
+		const __m128 alphaD = DSTALPHA ? _mm_shuffle_ps( d, d, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ) : one;
+		const __m128 invAlphaD = DSTALPHA ? _mm_sub_ps( one, alphaD ) : _mm_setzero_ps();
+		const __m128 alphaR = _mm_sub_ps( one, _mm_mul_ps( invAlphaS, invAlphaD ) );
+
+		__m128 result;
+		if( ! DSTALPHA && ! SRCPREMULT )
+			result = _mm_add_ps( _mm_mul_ps( invAlphaS, d ), _mm_mul_ps( alphaS, s ) );
+		else if( ! DSTALPHA && SRCPREMULT )
+			result = _mm_add_ps( _mm_mul_ps( invAlphaS, d ), s );
+		else if( ! DSTPREMULT && ! SRCPREMULT )
+			result = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_mul_ps( invAlphaS, alphaD ), d ), _mm_mul_ps( _mm_mul_ps( invAlphaD, alphaS ), s ) ), _mm_mul_ps( _mm_mul_ps( alphaD, alphaS ), s ) ), _mm_div_ps( one, alphaR ) );
+		else if( ! DSTPREMULT && SRCPREMULT )
+			result = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_mul_ps( invAlphaS, alphaD ), d ), _mm_mul_ps( invAlphaD, s ) ), _mm_mul_ps( alphaD, s ) ), _mm_div_ps( one, alphaR ) );
+		else if( DSTPREMULT && SRCPREMULT )
+			result = _mm_add_ps( _mm_add_ps( _mm_mul_ps( invAlphaS, d ), _mm_mul_ps( invAlphaD, s ) ), _mm_mul_ps( alphaD, s ) );
+		else
+			result = _mm_add_ps( _mm_add_ps( _mm_mul_ps( invAlphaS, d ), _mm_mul_ps( _mm_mul_ps( invAlphaD, alphaS ), s ) ), _mm_mul_ps( _mm_mul_ps( alphaD, alphaS ), s ) );
+
+		if( DSTALPHA ) {
+			const __m128 visible = _mm_cmpneq_ps( alphaR, _mm_setzero_ps() );
+			result = _mm_or_ps( _mm_and_ps( visible, result ), _mm_andnot_ps( visible, d ) );
+			result = _mm_or_ps( _mm_and_ps( alphaLane, alphaR ), _mm_andnot_ps( alphaLane, result ) );
+		}
+		else
+			result = _mm_or_ps( _mm_and_ps( alphaLane, d ), _mm_andnot_ps( alphaLane, result ) );
+		_mm_storeu_ps( dst, result );
+	}
+	return width;
+}
+#endif // defined( CINDER_SSE2 )
+
+#if defined( CINDER_NEON )
+// exact floor( x / 255 ) for 16-bit lanes in [0, 255 * 255], narrowed to 8 bits
+inline uint8x8_t div255_u16( uint16x8_t x )
+{
+	return vshrn_n_u16( vaddq_u16( vsraq_n_u16( x, x, 8 ), vdupq_n_u16( 1 ) ), 8 );
+}
+
+// See blend2_epu16() for the simplified equations
+template<int ALPHA, bool DSTALPHA, bool SRCPREMULT>
+int32_t blendRowNeon( const uint8_t *src, uint8_t *dst, int32_t width )
+{
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8, src += 32, dst += 32 ) {
+		const uint8x8x4_t s = vld4_u8( src );
+		uint8x8x4_t d = vld4_u8( dst );
+		const uint8x8_t invAlphaS = vmvn_u8( s.val[ALPHA] );
+		uint8x8_t alphaR, visible;
+		if( DSTALPHA ) {
+			alphaR = vmvn_u8( div255_u16( vmull_u8( invAlphaS, vmvn_u8( d.val[ALPHA] ) ) ) );
+			visible = vtst_u8( alphaR, alphaR );
+		}
+		for( int c = 0; c < 4; ++c ) {
+			if( c == ALPHA )
+				continue;
+			uint8x8_t result;
+			if( SRCPREMULT )
+				result = vadd_u8( s.val[c], div255_u16( vmull_u8( invAlphaS, d.val[c] ) ) );
+			else
+				result = div255_u16( vmlal_u8( vmull_u8( invAlphaS, d.val[c] ), s.val[ALPHA], s.val[c] ) );
+			d.val[c] = DSTALPHA ? vbsl_u8( visible, result, d.val[c] ) : result;
+		}
+		if( DSTALPHA )
+			d.val[ALPHA] = alphaR;
+		vst4_u8( dst, d );
+	}
+	return x;
+}
+#endif // defined( CINDER_NEON )
+
+// Blends as much of a row as the SIMD paths support, returning the number of pixels handled. Both rows hold 4-channel pixels in the same order.
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+int32_t blendRowSimd( const uint8_t *src, uint8_t *dst, int32_t width, uint8_t alphaOffset )
+{
+	// unpremultiplied destinations require a per-pixel divide by the result alpha
+	if( DSTALPHA && ! DSTPREMULT )
+		return 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return ( alphaOffset == 0 ) ? blendRowSse2<0,DSTALPHA,SRCPREMULT>( src, dst, width ) : blendRowSse2<3,DSTALPHA,SRCPREMULT>( src, dst, width );
+#elif defined( CINDER_NEON )
+	return ( alphaOffset == 0 ) ? blendRowNeon<0,DSTALPHA,SRCPREMULT>( src, dst, width ) : blendRowNeon<3,DSTALPHA,SRCPREMULT>( src, dst, width );
+#endif
+	return 0;
+}
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+int32_t blendRowSimd( const float *src, float *dst, int32_t width, uint8_t alphaOffset )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return ( alphaOffset == 0 ) ? blendRowSse2<0,DSTALPHA,DSTPREMULT,SRCPREMULT>( src, dst, width ) : blendRowSse2<3,DSTALPHA,DSTPREMULT,SRCPREMULT>( src, dst, width );
+#endif
+	return 0;
+}
+
+// the SIMD paths require matching 4-channel layouts with alpha first or last
+template<typename T>
+bool canBlendSimd( const SurfaceT<T> &background, const SurfaceT<T> &foreground )
+{
+	const SurfaceChannelOrder &dstOrder = background.getChannelOrder(), &srcOrder = foreground.getChannelOrder();
+	if( dstOrder.getPixelInc() != 4 || srcOrder.getPixelInc() != 4 )
+		return false;
+	if( dstOrder.getRedOffset() != srcOrder.getRedOffset() || dstOrder.getGreenOffset() != srcOrder.getGreenOffset() || dstOrder.getBlueOffset() != srcOrder.getBlueOffset() )
+		return false;
+	return srcOrder.getAlphaOffset() == 0 || srcOrder.getAlphaOffset() == 3;
+}
+
+} // anonymous namespace
+
 /*	
 	   αr = 1 – [(1–αd)×(1–αs)] = αd+αs–(αd×αs)
 	αr×Cr =  [(1–αs)×αd×Cd]+[(1–αd)×αs×Cs]+[αd×αs×B(Cd,Cs)]			Unpremult * Unpremult
@@ -61,10 +255,17 @@ void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Are
 		return;
 	}
 	
+	const bool simd = canBlendSimd( *background, foreground );
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const uint8_t *src = reinterpret_cast<const uint8_t*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
 		uint8_t *dst = reinterpret_cast<uint8_t*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
+		int32_t x = 0;
+		if( simd ) {
+			x = blendRowSimd<DSTALPHA,DSTPREMULT,SRCPREMULT>( src, dst, width, sA );
+			src += x * srcInc;
+			dst += x * dstInc;
+		}
+		for( ; x < width; ++x ) {
 			const uint8_t alphaS = (SRCALPHA) ? src[sA] : 255;
 			const uint8_t invAlphaS = (SRCALPHA) ? CHANTRAIT<uint8_t>::inverse(src[sA]) : 0;
 			const uint8_t alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<uint8_t>::max();
@@ -135,10 +336,17 @@ void blendImpl_float( Surface32f *background, const Surface32f &foreground, cons
 		return;
 	}
 	
+	const bool simd = canBlendSimd( *background, foreground );
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const float *src = reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
 		float *dst = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
+		int32_t x = 0;
+		if( simd ) {
+			x = blendRowSimd<DSTALPHA,DSTPREMULT,SRCPREMULT>( src, dst, width, sA );
+			src += x * srcInc;
+			dst += x * dstInc;
+		}
+		for( ; x < width; ++x ) {
 			const float alphaS = (SRCALPHA) ? src[sA] : 1;
 			const float invAlphaS = (SRCALPHA) ? CHANTRAIT<float>::inverse(src[sA]) : 0;
 			const float alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<float>::max();
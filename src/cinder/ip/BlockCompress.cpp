@@ -0,0 +1,402 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/BlockCompress.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+#endif
+
+// Where the channels of a Surface8u's pixels live, so blocks can be gathered without per-pixel virtual dispatch
+struct SourceLayout {
+	SourceLayout( const Surface8u &surface )
+		: mData( surface.getData() ), mWidth( surface.getWidth() ), mHeight( surface.getHeight() ), mRowBytes( surface.getRowBytes() ), mPixelInc( surface.getPixelInc() ),
+		mRed( surface.getRedOffset() ), mGreen( surface.getGreenOffset() ), mBlue( surface.getBlueOffset() ), mAlpha( surface.getAlphaOffset() ), mHasAlpha( surface.hasAlpha() )
+	{}
+
+	const uint8_t	*mData;
+	int32_t			mWidth, mHeight, mRowBytes;
+	uint8_t			mPixelInc, mRed, mGreen, mBlue, mAlpha;
+	bool			mHasAlpha;
+};
+
+// Copies the 4x4 block at block coordinates (bx, by) into \a rgba as RGBA pixels, repeating the last row and column past the edges of the image
+void gatherBlock( const SourceLayout &src, int32_t bx, int32_t by, uint8_t *rgba )
+{
+	for( int32_t y = 0; y < 4; ++y ) {
+		const uint8_t *row = src.mData + std::min( by * 4 + y, src.mHeight - 1 ) * src.mRowBytes;
+		for( int32_t x = 0; x < 4; ++x, rgba += 4 ) {
+			const uint8_t *p = row + std::min( bx * 4 + x, src.mWidth - 1 ) * src.mPixelInc;
+			rgba[0] = p[src.mRed];
+			rgba[1] = p[src.mGreen];
+			rgba[2] = p[src.mBlue];
+			rgba[3] = src.mHasAlpha ? p[src.mAlpha] : 255;
+		}
+	}
+}
+
+// Per channel minimum and maximum of a block's 16 pixels
+void calcBounds( const uint8_t *rgba, uint8_t *minColor, uint8_t *maxColor )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128i r0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgba ) );
+		const __m128i r1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgba + 16 ) );
+		const __m128i r2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgba + 32 ) );
+		const __m128i r3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgba + 48 ) );
+		__m128i mn = _mm_min_epu8( _mm_min_epu8( r0, r1 ), _mm_min_epu8( r2, r3 ) );
+		__m128i mx = _mm_max_epu8( _mm_max_epu8( r0, r1 ), _mm_max_epu8( r2, r3 ) );
+		mn = _mm_min_epu8( mn, _mm_srli_si128( mn, 8 ) );
+		mn = _mm_min_epu8( mn, _mm_srli_si128( mn, 4 ) );
+		mx = _mm_max_epu8( mx, _mm_srli_si128( mx, 8 ) );
+		mx = _mm_max_epu8( mx, _mm_srli_si128( mx, 4 ) );
+		const int32_t mnPixel = _mm_cvtsi128_si32( mn ), mxPixel = _mm_cvtsi128_si32( mx );
+		memcpy( minColor, &mnPixel, 4 );
+		memcpy( maxColor, &mxPixel, 4 );
+		return;
+	}
+#elif defined( CINDER_NEON )
+	const uint8x16_t r0 = vld1q_u8( rgba ), r1 = vld1q_u8( rgba + 16 ), r2 = vld1q_u8( rgba + 32 ), r3 = vld1q_u8( rgba + 48 );
+	const uint8x16_t mn = vminq_u8( vminq_u8( r0, r1 ), vminq_u8( r2, r3 ) );
+	const uint8x16_t mx = vmaxq_u8( vmaxq_u8( r0, r1 ), vmaxq_u8( r2, r3 ) );
+	uint8_t mn2[8], mx2[8];
+	vst1_u8( mn2, vmin_u8( vget_low_u8( mn ), vget_high_u8( mn ) ) );
+	vst1_u8( mx2, vmax_u8( vget_low_u8( mx ), vget_high_u8( mx ) ) );
+	for( int c = 0; c < 4; ++c ) {
+		minColor[c] = std::min( mn2[c], mn2[c + 4] );
+		maxColor[c] = std::max( mx2[c], mx2[c + 4] );
+	}
+	return;
+#endif
+
+	for( int c = 0; c < 4; ++c ) {
+		minColor[c] = maxColor[c] = rgba[c];
+		for( int i = 1; i < 16; ++i ) {
+			minColor[c] = std::min( minColor[c], rgba[i * 4 + c] );
+			maxColor[c] = std::max( maxColor[c], rgba[i * 4 + c] );
+		}
+	}
+}
+
+inline uint16_t toRgb565( const int *rgb )
+{
+	return (uint16_t)( ( ( rgb[0] * 31 + 127 ) / 255 ) << 11 | ( ( rgb[1] * 63 + 127 ) / 255 ) << 5 | ( ( rgb[2] * 31 + 127 ) / 255 ) );
+}
+
+inline void fromRgb565( uint16_t color, int *rgb )
+{
+	const int r = color >> 11, g = ( color >> 5 ) & 63, b = color & 31;
+	rgb[0] = ( r << 3 ) | ( r >> 2 );
+	rgb[1] = ( g << 2 ) | ( g >> 4 );
+	rgb[2] = ( b << 3 ) | ( b >> 2 );
+}
+
+inline int colorDistance( const uint8_t *pixel, const int *color )
+{
+	const int dr = pixel[0] - color[0], dg = pixel[1] - color[1], db = pixel[2] - color[2];
+	return dr * dr + dg * dg + db * db;
+}
+
+// Returns the 2-bit indices of the closest of the 4 \a palette colors to each pixel, ties going to the lower index
+uint32_t calcColorIndices( const uint8_t *rgba, const int palette[4][3] )
+{
+	uint32_t indices = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() ) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rgbMask = _mm_set1_epi32( 0x00FFFFFF );
+		__m128i colors[4];
+		for( int c = 0; c < 4; ++c )
+			colors[c] = _mm_set_epi16( 0, (short)palette[c][2], (short)palette[c][1], (short)palette[c][0], 0, (short)palette[c][2], (short)palette[c][1], (short)palette[c][0] );
+
+		for( int row = 0; row < 4; ++row ) {
+			const __m128i px = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgba + row * 16 ) ), rgbMask );
+			const __m128i lo = _mm_unpacklo_epi8( px, zero ), hi = _mm_unpackhi_epi8( px, zero );
+			__m128i best = _mm_setzero_si128(), bestIndex = _mm_setzero_si128();
+			for( int c = 0; c < 4; ++c ) {
+				const __m128i dlo = _mm_sub_epi16( lo, colors[c] ), dhi = _mm_sub_epi16( hi, colors[c] );
+				// madd leaves (r^2 + g^2, b^2) per pixel, which are summed across the pair of lanes
+				const __m128 slo = _mm_castsi128_ps( _mm_madd_epi16( dlo, dlo ) ), shi = _mm_castsi128_ps( _mm_madd_epi16( dhi, dhi ) );
+				const __m128i dist = _mm_add_epi32( _mm_castps_si128( _mm_shuffle_ps( slo, shi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ), _mm_castps_si128( _mm_shuffle_ps( slo, shi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+				if( c == 0 ) {
+					best = dist;
+					continue;
+				}
+				const __m128i closer = _mm_cmplt_epi32( dist, best );
+				best = _mm_or_si128( _mm_and_si128( closer, dist ), _mm_andnot_si128( closer, best ) );
+				bestIndex = _mm_or_si128( _mm_and_si128( closer, _mm_set1_epi32( c ) ), _mm_andnot_si128( closer, bestIndex ) );
+			}
+			// pack the four 32-bit indices into 2-bit fields
+			const __m128i packed = _mm_or_si128( bestIndex, _mm_srli_epi64( bestIndex, 30 ) );
+			const uint32_t rowIndices = (uint32_t)_mm_cvtsi128_si32( packed ) | ( (uint32_t)_mm_cvtsi128_si32( _mm_srli_si128( packed, 8 ) ) << 4 );
+			indices |= ( rowIndices & 0xFF ) << ( row * 8 );
+		}
+		return indices;
+	}
+#endif
+
+	for( int i = 0; i < 16; ++i ) {
+		int bestIndex = 0, best = colorDistance( rgba + i * 4, palette[0] );
+		for( int c = 1; c < 4; ++c ) {
+			const int dist = colorDistance( rgba + i * 4, palette[c] );
+			if( dist < best ) {
+				best = dist;
+				bestIndex = c;
+			}
+		}
+		indices |= (uint32_t)bestIndex << ( i * 2 );
+	}
+	return indices;
+}
+
+void writeColorBlock( uint16_t c0, uint16_t c1, uint32_t indices, uint8_t *dest )
+{
+	dest[0] = (uint8_t)c0; dest[1] = (uint8_t)( c0 >> 8 );
+	dest[2] = (uint8_t)c1; dest[3] = (uint8_t)( c1 >> 8 );
+	for( int i = 0; i < 4; ++i )
+		dest[4 + i] = (uint8_t)( indices >> ( i * 8 ) );
+}
+
+// Encodes the color half of a block. When \a allowTransparent is set (BC1), pixels with alpha below 128 select the 3-color mode's transparent index.
+void encodeColorBlock( const uint8_t *rgba, bool allowTransparent, uint8_t *dest )
+{
+	uint8_t minColor[4], maxColor[4];
+	calcBounds( rgba, minColor, maxColor );
+
+	const bool transparent = allowTransparent && minColor[3] < 128;
+	if( transparent ) {
+		// only the opaque pixels contribute to the endpoints
+		bool anyOpaque = false;
+		for( int i = 0; i < 16; ++i ) {
+			const uint8_t *p = rgba + i * 4;
+			if( p[3] < 128 )
+				continue;
+			for( int c = 0; c < 3; ++c ) {
+				minColor[c] = anyOpaque ? std::min( minColor[c], p[c] ) : p[c];
+				maxColor[c] = anyOpaque ? std::max( maxColor[c], p[c] ) : p[c];
+			}
+			anyOpaque = true;
+		}
+		if( ! anyOpaque ) {
+			writeColorBlock( 0, 0, 0xFFFFFFFF, dest );
+			return;
+		}
+	}
+
+	// the bounding box spans from min to max along one of its 4 diagonals; pick the one the red and green covariance with blue follow
+	int center[3], covRB = 0, covGB = 0;
+	for( int c = 0; c < 3; ++c )
+		center[c] = ( minColor[c] + maxColor[c] ) / 2;
+	for( int i = 0; i < 16; ++i ) {
+		const uint8_t *p = rgba + i * 4;
+		const int db = p[2] - center[2];
+		covRB += ( p[0] - center[0] ) * db;
+		covGB += ( p[1] - center[1] ) * db;
+	}
+	int start[3] = { maxColor[0], maxColor[1], maxColor[2] }, end[3] = { minColor[0], minColor[1], minColor[2] };
+	if( covRB < 0 )
+		std::swap( start[0], end[0] );
+	if( covGB < 0 )
+		std::swap( start[1], end[1] );
+
+	// inset the endpoints slightly, since the extremes are rarely the best fit for the interpolated colors
+	for( int c = 0; c < 3; ++c ) {
+		const int inset = ( start[c] - end[c] ) / 16;
+		start[c] -= inset;
+		end[c] += inset;
+	}
+
+	uint16_t c0 = toRgb565( start ), c1 = toRgb565( end );
+	int palette[4][3];
+	uint32_t indices = 0;
+	if( ! transparent ) {
+		// 4-color mode requires c0 > c1
+		if( c0 < c1 )
+			std::swap( c0, c1 );
+		else if( c0 == c1 ) {
+			writeColorBlock( c0, c1, 0, dest );
+			return;
+		}
+		fromRgb565( c0, palette[0] );
+		fromRgb565( c1, palette[1] );
+		for( int c = 0; c < 3; ++c ) {
+			palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+			palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+		}
+		indices = calcColorIndices( rgba, palette );
+	}
+	else {
+		// 3-color mode requires c0 <= c1, and index 3 is transparent black
+		if( c0 > c1 )
+			std::swap( c0, c1 );
+		fromRgb565( c0, palette[0] );
+		fromRgb565( c1, palette[1] );
+		for( int c = 0; c < 3; ++c )
+			palette[2][c] = ( palette[0][c] + palette[1][c] ) / 2;
+		for( int i = 0; i < 16; ++i ) {
+			const uint8_t *p = rgba + i * 4;
+			int bestIndex = 3;
+			if( p[3] >= 128 ) {
+				int best = colorDistance( p, palette[0] );
+				bestIndex = 0;
+				for( int c = 1; c < 3; ++c ) {
+					const int dist = colorDistance( p, palette[c] );
+					if( dist < best ) {
+						best = dist;
+						bestIndex = c;
+					}
+				}
+			}
+			indices |= (uint32_t)bestIndex << ( i * 2 );
+		}
+	}
+
+	writeColorBlock( c0, c1, indices, dest );
+}
+
+// Encodes a BC3 alpha block in its 8 alpha mode
+void encodeAlphaBlock( const uint8_t *rgba, uint8_t *dest )
+{
+	int a0 = rgba[3], a1 = rgba[3];
+	for( int i = 1; i < 16; ++i ) {
+		a0 = std::max<int>( a0, rgba[i * 4 + 3] );
+		a1 = std::min<int>( a1, rgba[i * 4 + 3] );
+	}
+
+	dest[0] = (uint8_t)a0;
+	dest[1] = (uint8_t)a1;
+	if( a0 == a1 ) {
+		memset( dest + 2, 0, 6 );
+		return;
+	}
+
+	int palette[8] = { a0, a1 };
+	for( int i = 1; i < 7; ++i )
+		palette[i + 1] = ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7;
+
+	uint64_t indices = 0;
+	for( int i = 0; i < 16; ++i ) {
+		const int alpha = rgba[i * 4 + 3];
+		int bestIndex = 0, best = abs( alpha - palette[0] );
+		for( int p = 1; p < 8; ++p ) {
+			const int dist = abs( alpha - palette[p] );
+			if( dist < best ) {
+				best = dist;
+				bestIndex = p;
+			}
+		}
+		indices |= (uint64_t)bestIndex << ( i * 3 );
+	}
+	for( int i = 0; i < 6; ++i )
+		dest[2 + i] = (uint8_t)( indices >> ( i * 8 ) );
+}
+
+// Box filters \a src to half its size, rounding odd sizes down, into an RGBA Surface
+Surface8u downsample( const Surface8u &src )
+{
+	const SourceLayout layout( src );
+	Surface8u result( std::max( 1, src.getWidth() / 2 ), std::max( 1, src.getHeight() / 2 ), true, SurfaceChannelOrder::RGBA );
+	const int32_t width = result.getWidth();
+	TaskPool::get()->parallelFor( 0, result.getHeight(), [&] ( size_t first, size_t last ) {
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const uint8_t *rows[2] = { layout.mData + std::min( y * 2, layout.mHeight - 1 ) * layout.mRowBytes, layout.mData + std::min( y * 2 + 1, layout.mHeight - 1 ) * layout.mRowBytes };
+			uint8_t *dst = result.getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, dst += 4 ) {
+				const int32_t x0 = std::min( x * 2, layout.mWidth - 1 ) * layout.mPixelInc, x1 = std::min( x * 2 + 1, layout.mWidth - 1 ) * layout.mPixelInc;
+				const uint8_t *p[4] = { rows[0] + x0, rows[0] + x1, rows[1] + x0, rows[1] + x1 };
+				dst[0] = (uint8_t)( ( p[0][layout.mRed] + p[1][layout.mRed] + p[2][layout.mRed] + p[3][layout.mRed] + 2 ) / 4 );
+				dst[1] = (uint8_t)( ( p[0][layout.mGreen] + p[1][layout.mGreen] + p[2][layout.mGreen] + p[3][layout.mGreen] + 2 ) / 4 );
+				dst[2] = (uint8_t)( ( p[0][layout.mBlue] + p[1][layout.mBlue] + p[2][layout.mBlue] + p[3][layout.mBlue] + 2 ) / 4 );
+				dst[3] = layout.mHasAlpha ? (uint8_t)( ( p[0][layout.mAlpha] + p[1][layout.mAlpha] + p[2][layout.mAlpha] + p[3][layout.mAlpha] + 2 ) / 4 ) : 255;
+			}
+		}
+	} );
+
+	return result;
+}
+
+} // anonymous namespace
+
+size_t BlockCompressedImage::calcLevelBytes( int32_t width, int32_t height, Format format )
+{
+	return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * ( ( format == BC1 ) ? 8 : 16 );
+}
+
+void blockCompress( const Surface8u &surface, BlockCompressedImage::Format format, uint8_t *dest )
+{
+	const SourceLayout layout( surface );
+	const int32_t blocksWide = ( surface.getWidth() + 3 ) / 4;
+	const int32_t blocksHigh = ( surface.getHeight() + 3 ) / 4;
+	const size_t blockBytes = ( format == BlockCompressedImage::BC1 ) ? 8 : 16;
+
+	TaskPool::get()->parallelFor( 0, blocksHigh, [&] ( size_t first, size_t last ) {
+		uint8_t rgba[64];
+		for( int32_t by = (int32_t)first; by < (int32_t)last; ++by ) {
+			uint8_t *block = dest + by * blocksWide * blockBytes;
+			for( int32_t bx = 0; bx < blocksWide; ++bx, block += blockBytes ) {
+				gatherBlock( layout, bx, by, rgba );
+				if( format == BlockCompressedImage::BC3 ) {
+					encodeAlphaBlock( rgba, block );
+					encodeColorBlock( rgba, false, block + 8 );
+				}
+				else
+					encodeColorBlock( rgba, true, block );
+			}
+		}
+	} );
+}
+
+BlockCompressedImage blockCompress( const Surface8u &surface, BlockCompressedImage::Format format, bool mipmaps )
+{
+	BlockCompressedImage result( surface.getWidth(), surface.getHeight(), format );
+	if( surface.getWidth() <= 0 || surface.getHeight() <= 0 )
+		return result;
+
+	Surface8u level = surface;
+	while( true ) {
+		Buffer buffer( BlockCompressedImage::calcLevelBytes( level.getWidth(), level.getHeight(), format ) );
+		blockCompress( level, format, reinterpret_cast<uint8_t*>( buffer.getData() ) );
+		result.appendLevel( buffer );
+
+		if( ! mipmaps || ( level.getWidth() == 1 && level.getHeight() == 1 ) )
+			break;
+		level = downsample( level );
+	}
+
+	return result;
+}
+
+} } // namespace cinder::ip
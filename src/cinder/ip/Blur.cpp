@@ -0,0 +1,329 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Blur.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderMath.h"
+#include "cinder/System.h"
+#include "cinder/Thread.h"
+
+#include <vector>
+#include <algorithm>
+#include <boost/preprocessor/seq.hpp>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// rows are blurred in blocks so that the transposed writes touch contiguous memory
+const int32_t BLOCK_ROWS = 16;
+
+// radii of the successive box filters applied along each axis
+typedef vector<int32_t> BoxRadii;
+
+// radii of three box filters whose convolution approximates a Gaussian of \a sigma (Kovesi, "Fast Almost-Gaussian Filtering")
+BoxRadii gaussianBoxRadii( float sigma )
+{
+	const int n = 3;
+	const float ideal = math<float>::sqrt( 12 * sigma * sigma / n + 1 );
+	int32_t lower = (int32_t)math<float>::floor( ideal );
+	if( lower % 2 == 0 )
+		--lower;
+	const int32_t upper = lower + 2;
+	const float mIdeal = ( 12 * sigma * sigma - n * lower * lower - 4 * n * lower - 3 * n ) / ( -4.0f * lower - 4 );
+	const int m = (int)math<float>::floor( mIdeal + 0.5f );
+
+	BoxRadii result;
+	for( int i = 0; i < n; ++i )
+		result.push_back( ( ( i < m ) ? lower : upper ) / 2 );
+	return result;
+}
+
+// running-sum box filter of one row, repeating the edge samples
+void boxBlurRow( const float *src, float *dst, int32_t length, int32_t radius )
+{
+	if( radius <= 0 ) {
+		copy( src, src + length, dst );
+		return;
+	}
+
+	const int32_t last = length - 1;
+	const double scale = 1.0 / ( 2 * radius + 1 );
+	double sum = src[0] * (double)( radius + 1 );
+	for( int32_t i = 1; i <= radius; ++i )
+		sum += src[min( i, last )];
+
+	for( int32_t i = 0; i < length; ++i ) {
+		dst[i] = (float)( sum * scale );
+		sum += src[min( i + radius + 1, last )] - src[max( i - radius, 0 )];
+	}
+}
+
+// applies every box filter in \a radii to \a row in place, using \a scratch of the same length
+void blurRow( float *row, float *scratch, int32_t length, const BoxRadii &radii )
+{
+	for( size_t i = 0; i < radii.size(); ++i ) {
+		boxBlurRow( row, scratch, length, radii[i] );
+		copy( scratch, scratch + length, row );
+	}
+}
+
+template<typename T>
+T fromBlurred( float v )
+{
+	return static_cast<T>( v );
+}
+
+template<>
+uint8_t fromBlurred<uint8_t>( float v )
+{
+	return static_cast<uint8_t>( constrain<int>( (int)( v + 0.5f ), 0, 255 ) );
+}
+
+template<>
+uint16_t fromBlurred<uint16_t>( float v )
+{
+	return static_cast<uint16_t>( constrain<int>( (int)( v + 0.5f ), 0, 65535 ) );
+}
+
+template<typename T>
+struct BlurJob {
+	const ChannelT<T>	*mSrc;
+	ChannelT<T>			*mDst;
+	Area				mArea;
+	Vec2i				mDstLT;
+	BoxRadii			mRadii;
+	// the horizontally blurred area, stored column-major
+	vector<float>		mTransposed;
+};
+
+// horizontal pass over the source rows [rowBegin, rowEnd) of the area, written transposed
+template<typename T>
+void blurRowsTransposed( BlurJob<T> *job, int32_t rowBegin, int32_t rowEnd )
+{
+	const int32_t width = job->mArea.getWidth(), height = job->mArea.getHeight();
+	const int8_t srcInc = job->mSrc->getIncrement();
+	vector<float> block( BLOCK_ROWS * width ), scratch( width );
+
+	for( int32_t blockBegin = rowBegin; blockBegin < rowEnd; blockBegin += BLOCK_ROWS ) {
+		const int32_t blockRows = min( BLOCK_ROWS, rowEnd - blockBegin );
+		for( int32_t r = 0; r < blockRows; ++r ) {
+			const T *src = job->mSrc->getData( job->mArea.getX1(), job->mArea.getY1() + blockBegin + r );
+			float *row = &block[r * width];
+			for( int32_t x = 0; x < width; ++x, src += srcInc )
+				row[x] = static_cast<float>( *src );
+			blurRow( row, &scratch[0], width, job->mRadii );
+		}
+		for( int32_t x = 0; x < width; ++x ) {
+			float *dst = &job->mTransposed[x * height + blockBegin];
+			for( int32_t r = 0; r < blockRows; ++r )
+				dst[r] = block[r * width + x];
+		}
+	}
+}
+
+// vertical pass over the area columns [colBegin, colEnd), written to the destination
+template<typename T>
+void blurColumnsToDst( BlurJob<T> *job, int32_t colBegin, int32_t colEnd )
+{
+	const int32_t height = job->mArea.getHeight();
+	const int8_t dstInc = job->mDst->getIncrement();
+	vector<float> scratch( height );
+
+	for( int32_t blockBegin = colBegin; blockBegin < colEnd; blockBegin += BLOCK_ROWS ) {
+		const int32_t blockCols = min( BLOCK_ROWS, colEnd - blockBegin );
+		for( int32_t c = 0; c < blockCols; ++c )
+			blurRow( &job->mTransposed[( blockBegin + c ) * height], &scratch[0], height, job->mRadii );
+		for( int32_t y = 0; y < height; ++y ) {
+			T *dst = job->mDst->getData( job->mDstLT.x + blockBegin, job->mDstLT.y + y );
+			for( int32_t c = 0; c < blockCols; ++c, dst += dstInc )
+				*dst = fromBlurred<T>( job->mTransposed[( blockBegin + c ) * height + y] );
+		}
+	}
+}
+
+// splits [0, count) into contiguous ranges, one per core, and runs \a fn on each
+void parallelRanges( int32_t count, int32_t minPerThread, const function<void(int32_t,int32_t)> &fn )
+{
+	int32_t numThreads = min<int32_t>( System::getNumCores(), max<int32_t>( 1, count / minPerThread ) );
+	if( numThreads <= 1 ) {
+		fn( 0, count );
+		return;
+	}
+
+	vector<shared_ptr<thread> > threads;
+	for( int32_t t = 1; t < numThreads; ++t )
+		threads.push_back( shared_ptr<thread>( new thread( bind( fn, (int32_t)( (int64_t)count * t / numThreads ), (int32_t)( (int64_t)count * ( t + 1 ) / numThreads ) ) ) ) );
+	fn( 0, count / numThreads );
+	for( size_t t = 0; t < threads.size(); ++t )
+		threads[t]->join();
+}
+
+template<typename T>
+void separableBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, const BoxRadii &radii )
+{
+	pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
+	if( srcDst.first.getWidth() <= 0 || srcDst.first.getHeight() <= 0 )
+		return;
+
+	BlurJob<T> job;
+	job.mSrc = &srcChannel;
+	job.mDst = dstChannel;
+	job.mArea = srcDst.first;
+	job.mDstLT = srcDst.second;
+	job.mRadii = radii;
+	job.mTransposed.resize( job.mArea.getWidth() * job.mArea.getHeight() );
+
+	// the horizontal pass completes before the vertical one starts, so the source and destination may alias
+	parallelRanges( job.mArea.getHeight(), BLOCK_ROWS * 4, bind( &blurRowsTransposed<T>, &job, placeholders::_1, placeholders::_2 ) );
+	parallelRanges( job.mArea.getWidth(), BLOCK_ROWS * 4, bind( &blurColumnsToDst<T>, &job, placeholders::_1, placeholders::_2 ) );
+}
+
+template<typename T>
+void separableBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, const BoxRadii &radii )
+{
+	separableBlur( srcSurface.getChannelRed(), srcArea, dstLT, &dstSurface->getChannelRed(), radii );
+	separableBlur( srcSurface.getChannelGreen(), srcArea, dstLT, &dstSurface->getChannelGreen(), radii );
+	separableBlur( srcSurface.getChannelBlue(), srcArea, dstLT, &dstSurface->getChannelBlue(), radii );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() )
+		separableBlur( srcSurface.getChannelAlpha(), srcArea, dstLT, &dstSurface->getChannelAlpha(), radii );
+}
+
+template<typename T, typename SUMT>
+void integralBoxBlurRows( const IntegralImageT<T,SUMT> *integralImage, uint8_t table, ChannelT<T> *dstChannel, int32_t radius, int32_t rowBegin, int32_t rowEnd )
+{
+	const int32_t width = min( integralImage->getWidth(), dstChannel->getWidth() ), height = integralImage->getHeight();
+	const int32_t stride = integralImage->getWidth() + 1;
+	const int8_t dstInc = dstChannel->getIncrement();
+	const SUMT *data = integralImage->getData( table );
+
+	for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+		const int32_t y1 = max( y - radius, 0 ), y2 = min( y + radius + 1, height );
+		const SUMT *top = data + y1 * stride, *bottom = data + y2 * stride;
+		T *dst = dstChannel->getData( 0, y );
+		for( int32_t x = 0; x < width; ++x, dst += dstInc ) {
+			const int32_t x1 = max( x - radius, 0 ), x2 = min( x + radius + 1, integralImage->getWidth() );
+			const SUMT sum = bottom[x2] - top[x2] - bottom[x1] + top[x1];
+			*dst = fromBlurred<T>( (float)( (double)sum / ( ( x2 - x1 ) * ( y2 - y1 ) ) ) );
+		}
+	}
+}
+
+template<typename T, typename SUMT>
+void integralBoxBlur( const IntegralImageT<T,SUMT> &integralImage, uint8_t table, ChannelT<T> *dstChannel, int32_t radius )
+{
+	const int32_t height = min( integralImage.getHeight(), dstChannel->getHeight() );
+	parallelRanges( height, BLOCK_ROWS * 4, bind( &integralBoxBlurRows<T,SUMT>, &integralImage, table, dstChannel, max<int32_t>( radius, 0 ), placeholders::_1, placeholders::_2 ) );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, int32_t radius )
+{
+	separableBlur( srcChannel, srcArea, dstLT, dstChannel, BoxRadii( 1, radius ) );
+}
+
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius )
+{
+	separableBlur( srcChannel, srcChannel.getBounds(), Vec2i::zero(), dstChannel, BoxRadii( 1, radius ) );
+}
+
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, int32_t radius )
+{
+	separableBlur( srcSurface, srcArea, dstLT, dstSurface, BoxRadii( 1, radius ) );
+}
+
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius )
+{
+	separableBlur( srcSurface, srcSurface.getBounds(), Vec2i::zero(), dstSurface, BoxRadii( 1, radius ) );
+}
+
+template<typename T, typename SUMT>
+void boxBlur( const IntegralImageT<T,SUMT> &integralImage, ChannelT<T> *dstChannel, int32_t radius )
+{
+	integralBoxBlur( integralImage, 0, dstChannel, radius );
+}
+
+template<typename T, typename SUMT>
+void boxBlur( const IntegralImageT<T,SUMT> &integralImage, SurfaceT<T> *dstSurface, int32_t radius )
+{
+	integralBoxBlur( integralImage, 0, &dstSurface->getChannelRed(), radius );
+	integralBoxBlur( integralImage, 1, &dstSurface->getChannelGreen(), radius );
+	integralBoxBlur( integralImage, 2, &dstSurface->getChannelBlue(), radius );
+	if( integralImage.getNumChannels() > 3 && dstSurface->hasAlpha() )
+		integralBoxBlur( integralImage, 3, &dstSurface->getChannelAlpha(), radius );
+}
+
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, float sigma )
+{
+	separableBlur( srcChannel, srcArea, dstLT, dstChannel, gaussianBoxRadii( sigma ) );
+}
+
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma )
+{
+	separableBlur( srcChannel, srcChannel.getBounds(), Vec2i::zero(), dstChannel, gaussianBoxRadii( sigma ) );
+}
+
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, float sigma )
+{
+	separableBlur( srcSurface, srcArea, dstLT, dstSurface, gaussianBoxRadii( sigma ) );
+}
+
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma )
+{
+	separableBlur( srcSurface, srcSurface.getBounds(), Vec2i::zero(), dstSurface, gaussianBoxRadii( sigma ) );
+}
+
+#define blur_PROTOTYPES(r,data,T)\
+	template void boxBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, int32_t radius ); \
+	template void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius ); \
+	template void boxBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, int32_t radius ); \
+	template void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius ); \
+	template void gaussianBlur( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, float sigma ); \
+	template void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma ); \
+	template void gaussianBlur( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, float sigma ); \
+	template void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma );
+
+#define integralBlur_PROTOTYPES(r,data,T)\
+	template void boxBlur( const IntegralImageT<T> &integralImage, ChannelT<T> *dstChannel, int32_t radius ); \
+	template void boxBlur( const IntegralImageT<T> &integralImage, SurfaceT<T> *dstSurface, int32_t radius );
+
+BOOST_PP_SEQ_FOR_EACH( blur_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+BOOST_PP_SEQ_FOR_EACH( integralBlur_PROTOTYPES, ~, CHANNEL_TYPES )
+
+template void boxBlur( const IntegralImageT<uint8_t,uint64_t> &integralImage, ChannelT<uint8_t> *dstChannel, int32_t radius );
+template void boxBlur( const IntegralImageT<uint8_t,uint64_t> &integralImage, SurfaceT<uint8_t> *dstSurface, int32_t radius );
+template void boxBlur( const IntegralImageT<float,double> &integralImage, ChannelT<float> *dstChannel, int32_t radius );
+template void boxBlur( const IntegralImageT<float,double> &integralImage, SurfaceT<float> *dstSurface, int32_t radius );
+
+} } // namespace cinder::ip
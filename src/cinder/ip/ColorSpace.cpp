@@ -0,0 +1,592 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/ColorSpace.h"
+#include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/Matrix.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <boost/preprocessor/seq.hpp>
+#include <boost/preprocessor/tuple/elem.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+#endif
+
+// Lanes of floats the conversions below are written against, so that each is instantiated once for SIMD registers and once for the
+// single floats that remain at the end of a row. Comparisons return a Mask for select().
+struct Float1 {
+	typedef bool Mask;
+	static const size_t SIZE = 1;
+
+	Float1( float value ) : v( value ) {}
+	static Float1	load( const float *p ) { return Float1( *p ); }
+	void			store( float *p ) const { *p = v; }
+
+	float v;
+};
+
+inline Float1 operator+( Float1 a, Float1 b ) { return a.v + b.v; }
+inline Float1 operator-( Float1 a, Float1 b ) { return a.v - b.v; }
+inline Float1 operator*( Float1 a, Float1 b ) { return a.v * b.v; }
+inline Float1 operator/( Float1 a, Float1 b ) { return a.v / b.v; }
+inline bool operator==( Float1 a, Float1 b ) { return a.v == b.v; }
+inline bool operator<( Float1 a, Float1 b ) { return a.v < b.v; }
+inline bool operator>( Float1 a, Float1 b ) { return a.v > b.v; }
+inline bool operator>=( Float1 a, Float1 b ) { return a.v >= b.v; }
+inline Float1 vmin( Float1 a, Float1 b ) { return std::min( a.v, b.v ); }
+inline Float1 vmax( Float1 a, Float1 b ) { return std::max( a.v, b.v ); }
+inline Float1 vfloor( Float1 a ) { return floorf( a.v ); }
+inline Float1 select( bool mask, Float1 a, Float1 b ) { return mask ? a : b; }
+
+#if defined( CINDER_SSE2 )
+struct Float4 {
+	struct Mask {
+		Mask( __m128 value ) : m( value ) {}
+		__m128 m;
+	};
+	static const size_t SIZE = 4;
+
+	Float4( __m128 value ) : v( value ) {}
+	Float4( float value ) : v( _mm_set1_ps( value ) ) {}
+	static Float4	load( const float *p ) { return _mm_loadu_ps( p ); }
+	void			store( float *p ) const { _mm_storeu_ps( p, v ); }
+
+	__m128 v;
+};
+
+inline Float4 operator+( Float4 a, Float4 b ) { return _mm_add_ps( a.v, b.v ); }
+inline Float4 operator-( Float4 a, Float4 b ) { return _mm_sub_ps( a.v, b.v ); }
+inline Float4 operator*( Float4 a, Float4 b ) { return _mm_mul_ps( a.v, b.v ); }
+inline Float4 operator/( Float4 a, Float4 b ) { return _mm_div_ps( a.v, b.v ); }
+inline Float4::Mask operator==( Float4 a, Float4 b ) { return _mm_cmpeq_ps( a.v, b.v ); }
+inline Float4::Mask operator<( Float4 a, Float4 b ) { return _mm_cmplt_ps( a.v, b.v ); }
+inline Float4::Mask operator>( Float4 a, Float4 b ) { return _mm_cmpgt_ps( a.v, b.v ); }
+inline Float4::Mask operator>=( Float4 a, Float4 b ) { return _mm_cmpge_ps( a.v, b.v ); }
+inline Float4 vmin( Float4 a, Float4 b ) { return _mm_min_ps( a.v, b.v ); }
+inline Float4 vmax( Float4 a, Float4 b ) { return _mm_max_ps( a.v, b.v ); }
+inline Float4 select( Float4::Mask mask, Float4 a, Float4 b ) { return _mm_or_ps( _mm_and_ps( mask.m, a.v ), _mm_andnot_ps( mask.m, b.v ) ); }
+inline Float4 vfloor( Float4 a )
+{
+	// truncation rounds negative values up, which the comparison corrects
+	const __m128 truncated = _mm_cvtepi32_ps( _mm_cvttps_epi32( a.v ) );
+	return _mm_sub_ps( truncated, _mm_and_ps( _mm_cmpgt_ps( truncated, a.v ), _mm_set1_ps( 1.0f ) ) );
+}
+#elif defined( CINDER_NEON )
+struct Float4 {
+	struct Mask {
+		Mask( uint32x4_t value ) : m( value ) {}
+		uint32x4_t m;
+	};
+	static const size_t SIZE = 4;
+
+	Float4( float32x4_t value ) : v( value ) {}
+	Float4( float value ) : v( vdupq_n_f32( value ) ) {}
+	static Float4	load( const float *p ) { return vld1q_f32( p ); }
+	void			store( float *p ) const { vst1q_f32( p, v ); }
+
+	float32x4_t v;
+};
+
+inline Float4 operator+( Float4 a, Float4 b ) { return vaddq_f32( a.v, b.v ); }
+inline Float4 operator-( Float4 a, Float4 b ) { return vsubq_f32( a.v, b.v ); }
+inline Float4 operator*( Float4 a, Float4 b ) { return vmulq_f32( a.v, b.v ); }
+inline Float4 operator/( Float4 a, Float4 b )
+{
+	// NEON has no divide, so refine the reciprocal estimate with two Newton-Raphson steps
+	float32x4_t recip = vrecpeq_f32( b.v );
+	recip = vmulq_f32( vrecpsq_f32( b.v, recip ), recip );
+	recip = vmulq_f32( vrecpsq_f32( b.v, recip ), recip );
+	return vmulq_f32( a.v, recip );
+}
+inline Float4::Mask operator==( Float4 a, Float4 b ) { return vceqq_f32( a.v, b.v ); }
+inline Float4::Mask operator<( Float4 a, Float4 b ) { return vcltq_f32( a.v, b.v ); }
+inline Float4::Mask operator>( Float4 a, Float4 b ) { return vcgtq_f32( a.v, b.v ); }
+inline Float4::Mask operator>=( Float4 a, Float4 b ) { return vcgeq_f32( a.v, b.v ); }
+inline Float4 vmin( Float4 a, Float4 b ) { return vminq_f32( a.v, b.v ); }
+inline Float4 vmax( Float4 a, Float4 b ) { return vmaxq_f32( a.v, b.v ); }
+inline Float4 select( Float4::Mask mask, Float4 a, Float4 b ) { return vbslq_f32( mask.m, a.v, b.v ); }
+inline Float4 vfloor( Float4 a )
+{
+	const float32x4_t truncated = vcvtq_f32_s32( vcvtq_s32_f32( a.v ) );
+	return vsubq_f32( truncated, vreinterpretq_f32_u32( vandq_u32( vcgtq_f32( truncated, a.v ), vreinterpretq_u32_f32( vdupq_n_f32( 1.0f ) ) ) ) );
+}
+#endif
+
+// Hue in [0,1) for the maximum component \a maxC and the range between the maximum and minimum components, or 0 for grays
+template<typename F>
+F hue( F r, F g, F b, F maxC, F range )
+{
+	const F zero( 0.0f ), one( 1.0f );
+	const F invRange = select( range > zero, one / select( range > zero, range, one ), zero );
+	const F h = select( r == maxC, ( g - b ) * invRange, select( g == maxC, F( 2.0f ) + ( b - r ) * invRange, F( 4.0f ) + ( r - g ) * invRange ) ) * F( 1.0f / 6.0f );
+	return select( h < zero, h + one, h );
+}
+
+// The conversions of one lane of colors, held in separate arrays of their first, second and third components, in place
+
+template<typename F>
+void rgbToHsv( float *c0, float *c1, float *c2 )
+{
+	const F r = F::load( c0 ), g = F::load( c1 ), b = F::load( c2 );
+	const F zero( 0.0f ), one( 1.0f );
+	const F maxC = vmax( r, vmax( g, b ) ), range = maxC - vmin( r, vmin( g, b ) );
+	hue( r, g, b, maxC, range ).store( c0 );
+	select( maxC > zero, range / select( maxC > zero, maxC, one ), zero ).store( c1 );
+	maxC.store( c2 );
+}
+
+// The component of the color that is offset by \a n sixths of the hue circle from red, which is 5 for red, 3 for green and 1 for blue
+template<typename F>
+F hsvComponent( F hue6, F sat, F val, float n )
+{
+	const F six( 6.0f );
+	F k = F( n ) + hue6;
+	k = select( k >= six, k - six, k );
+	return val - val * sat * vmax( F( 0.0f ), vmin( vmin( k, F( 4.0f ) - k ), F( 1.0f ) ) );
+}
+
+template<typename F>
+void hsvToRgb( float *c0, float *c1, float *c2 )
+{
+	const F h = F::load( c0 ), s = F::load( c1 ), v = F::load( c2 );
+	const F hue6 = ( h - vfloor( h ) ) * F( 6.0f );
+	hsvComponent( hue6, s, v, 5 ).store( c0 );
+	hsvComponent( hue6, s, v, 3 ).store( c1 );
+	hsvComponent( hue6, s, v, 1 ).store( c2 );
+}
+
+template<typename F>
+void rgbToHsl( float *c0, float *c1, float *c2 )
+{
+	const F r = F::load( c0 ), g = F::load( c1 ), b = F::load( c2 );
+	const F zero( 0.0f ), one( 1.0f );
+	const F maxC = vmax( r, vmax( g, b ) ), minC = vmin( r, vmin( g, b ) ), range = maxC - minC;
+	const F sum = maxC + minC;
+	// 1 - | 2L - 1 |
+	const F chromaScale = one - vmax( sum - one, one - sum );
+	hue( r, g, b, maxC, range ).store( c0 );
+	select( chromaScale > zero, range / select( chromaScale > zero, chromaScale, one ), zero ).store( c1 );
+	( sum * F( 0.5f ) ).store( c2 );
+}
+
+// The component of the color that is offset by \a n twelfths of the hue circle from red, which is 0 for red, 8 for green and 4 for blue
+template<typename F>
+F hslComponent( F hue12, F a, F light, float n )
+{
+	const F twelve( 12.0f );
+	F k = F( n ) + hue12;
+	k = select( k >= twelve, k - twelve, k );
+	return light - a * vmax( F( -1.0f ), vmin( vmin( k - F( 3.0f ), F( 9.0f ) - k ), F( 1.0f ) ) );
+}
+
+template<typename F>
+void hslToRgb( float *c0, float *c1, float *c2 )
+{
+	const F h = F::load( c0 ), s = F::load( c1 ), l = F::load( c2 );
+	const F hue12 = ( h - vfloor( h ) ) * F( 12.0f );
+	const F a = s * vmin( l, F( 1.0f ) - l );
+	hslComponent( hue12, a, l, 0 ).store( c0 );
+	hslComponent( hue12, a, l, 8 ).store( c1 );
+	hslComponent( hue12, a, l, 4 ).store( c2 );
+}
+
+template<typename F>
+void affine( const float *m, const float *offset, float *c0, float *c1, float *c2 )
+{
+	const F x = F::load( c0 ), y = F::load( c1 ), z = F::load( c2 );
+	( F( m[0] ) * x + F( m[1] ) * y + F( m[2] ) * z + F( offset[0] ) ).store( c0 );
+	( F( m[3] ) * x + F( m[4] ) * y + F( m[5] ) * z + F( offset[1] ) ).store( c1 );
+	( F( m[6] ) * x + F( m[7] ) * y + F( m[8] ) * z + F( offset[2] ) ).store( c2 );
+}
+
+// The sRGB transfer curve is tabulated; linearToSrgb() indexes its table by sqrt( v ), which spreads the entries where the curve is steepest
+const int32_t TRANSFER_TABLE_SIZE = 4096;
+float sSrgbToLinearTable[TRANSFER_TABLE_SIZE + 1], sLinearToSrgbTable[TRANSFER_TABLE_SIZE + 1], sSrgb8ToLinearTable[256];
+uint8_t sSrgb8ToLinear8Table[256], sLinear8ToSrgb8Table[256];
+std::once_flag sTransferTablesFlag;
+
+void initTransferTables()
+{
+	std::call_once( sTransferTablesFlag, [] {
+		for( int32_t i = 0; i < TRANSFER_TABLE_SIZE; ++i ) {
+			const float v = i / (float)( TRANSFER_TABLE_SIZE - 1 );
+			sSrgbToLinearTable[i] = cinder::srgbToLinear( v );
+			sLinearToSrgbTable[i] = cinder::linearToSrgb( v * v );
+		}
+		// repeated so that interpolating at 1 stays in bounds
+		sSrgbToLinearTable[TRANSFER_TABLE_SIZE] = sSrgbToLinearTable[TRANSFER_TABLE_SIZE - 1];
+		sLinearToSrgbTable[TRANSFER_TABLE_SIZE] = sLinearToSrgbTable[TRANSFER_TABLE_SIZE - 1];
+		for( int32_t i = 0; i < 256; ++i ) {
+			sSrgb8ToLinearTable[i] = cinder::srgbToLinear( i / 255.0f );
+			sSrgb8ToLinear8Table[i] = static_cast<uint8_t>( sSrgb8ToLinearTable[i] * 255 + 0.5f );
+			sLinear8ToSrgb8Table[i] = static_cast<uint8_t>( cinder::linearToSrgb( i / 255.0f ) * 255 + 0.5f );
+		}
+	} );
+}
+
+inline float lookup( const float *table, float pos )
+{
+	const int32_t idx = (int32_t)pos;
+	return table[idx] + ( table[idx + 1] - table[idx] ) * ( pos - idx );
+}
+
+// values outside of [0,1] are rare enough to be evaluated exactly
+inline float srgbToLinearFast( float v )
+{
+	return ( v >= 0 && v <= 1 ) ? lookup( sSrgbToLinearTable, v * ( TRANSFER_TABLE_SIZE - 1 ) ) : cinder::srgbToLinear( v );
+}
+
+inline float linearToSrgbFast( float v )
+{
+	return ( v >= 0 && v <= 1 ) ? lookup( sLinearToSrgbTable, math<float>::sqrt( v ) * ( TRANSFER_TABLE_SIZE - 1 ) ) : cinder::linearToSrgb( v );
+}
+
+bool isTransfer( ColorSpaceConversion conversion )
+{
+	return conversion == SRGB_TO_LINEAR || conversion == LINEAR_TO_SRGB;
+}
+
+// Applies a ColorSpaceConversion to colors held in separate arrays of their first, second and third components
+class Converter {
+  public:
+	Converter( ColorSpaceConversion conversion )
+		: mConversion( conversion )
+	{
+		if( isTransfer( conversion ) )
+			initTransferTables();
+		else if( conversion >= RGB_TO_YCBCR_601 )
+			initYCbCr();
+	}
+
+	ColorSpaceConversion getConversion() const { return mConversion; }
+
+	void convert( float *c0, float *c1, float *c2, size_t count ) const
+	{
+		if( isTransfer( mConversion ) ) {
+			float *planes[3] = { c0, c1, c2 };
+			for( int p = 0; p < 3; ++p ) {
+				if( mConversion == SRGB_TO_LINEAR )
+					for( size_t i = 0; i < count; ++i )
+						planes[p][i] = srgbToLinearFast( planes[p][i] );
+				else
+					for( size_t i = 0; i < count; ++i )
+						planes[p][i] = linearToSrgbFast( planes[p][i] );
+			}
+			return;
+		}
+
+		size_t i = 0;
+#if defined( CINDER_SSE2 )
+		if( useSse2() )
+			i = convertLanes<Float4>( c0, c1, c2, count );
+#elif defined( CINDER_NEON )
+		i = convertLanes<Float4>( c0, c1, c2, count );
+#endif
+		convertLanes<Float1>( c0 + i, c1 + i, c2 + i, count - i );
+	}
+
+  private:
+	// Converts the lanes that fit in \a count, returning how many colors were converted
+	template<typename F>
+	size_t convertLanes( float *c0, float *c1, float *c2, size_t count ) const
+	{
+		size_t i = 0;
+		switch( mConversion ) {
+			case RGB_TO_HSV:
+				for( ; i + F::SIZE <= count; i += F::SIZE )
+					rgbToHsv<F>( c0 + i, c1 + i, c2 + i );
+			break;
+			case HSV_TO_RGB:
+				for( ; i + F::SIZE <= count; i += F::SIZE )
+					hsvToRgb<F>( c0 + i, c1 + i, c2 + i );
+			break;
+			case RGB_TO_HSL:
+				for( ; i + F::SIZE <= count; i += F::SIZE )
+					rgbToHsl<F>( c0 + i, c1 + i, c2 + i );
+			break;
+			case HSL_TO_RGB:
+				for( ; i + F::SIZE <= count; i += F::SIZE )
+					hslToRgb<F>( c0 + i, c1 + i, c2 + i );
+			break;
+			default:
+				for( ; i + F::SIZE <= count; i += F::SIZE )
+					affine<F>( mMatrix, mOffset, c0 + i, c1 + i, c2 + i );
+			break;
+		}
+		return i;
+	}
+
+	void initYCbCr()
+	{
+		const bool bt709 = ( mConversion >= RGB_TO_YCBCR_709 && mConversion <= YCBCR_709_TO_RGB ) || mConversion >= RGB_TO_YCBCR_709_VIDEO;
+		const bool video = mConversion >= RGB_TO_YCBCR_601_VIDEO;
+		const bool toRgb = ( mConversion == YCBCR_601_TO_RGB || mConversion == YCBCR_709_TO_RGB || mConversion == YCBCR_601_VIDEO_TO_RGB || mConversion == YCBCR_709_VIDEO_TO_RGB );
+		const float kr = bt709 ? 0.2126f : 0.299f, kb = bt709 ? 0.0722f : 0.114f, kg = 1 - kr - kb;
+		const float yScale = video ? 219 / 255.0f : 1.0f, cScale = video ? 224 / 255.0f : 1.0f, yOffset = video ? 16 / 255.0f : 0.0f;
+
+		// RGB to YCbCr, whose inverse is YCbCr to RGB
+		const Matrix33f m( yScale * kr, yScale * kg, yScale * kb,
+							cScale * -0.5f * kr / ( 1 - kb ), cScale * -0.5f * kg / ( 1 - kb ), cScale * 0.5f,
+							cScale * 0.5f, cScale * -0.5f * kg / ( 1 - kr ), cScale * -0.5f * kb / ( 1 - kr ), true );
+		const Vec3f offset( yOffset, video ? 128 / 255.0f : 0.5f, video ? 128 / 255.0f : 0.5f );
+		if( toRgb ) {
+			const Matrix33f inv = m.inverted();
+			const Vec3f invOffset = -( inv * offset );
+			setMatrix( inv, invOffset );
+		}
+		else
+			setMatrix( m, offset );
+	}
+
+	void setMatrix( const Matrix33f &m, const Vec3f &offset )
+	{
+		for( int row = 0; row < 3; ++row ) {
+			for( int col = 0; col < 3; ++col )
+				mMatrix[row * 3 + col] = m.at( row, col );
+			mOffset[row] = offset[row];
+		}
+	}
+
+	ColorSpaceConversion	mConversion;
+	float					mMatrix[9], mOffset[3];	// row-major, for the YCbCr conversions
+};
+
+inline float toFloat( uint8_t v ) { return v * ( 1 / 255.0f ); }
+inline float toFloat( float v ) { return v; }
+
+template<typename T>
+inline T fromFloat( float v );
+
+template<>
+inline uint8_t fromFloat<uint8_t>( float v ) { return static_cast<uint8_t>( constrain( v, 0.0f, 1.0f ) * 255 + 0.5f ); }
+
+template<>
+inline float fromFloat<float>( float v ) { return v; }
+
+// Below this many pixels the conversion isn't worth spreading across the TaskPool
+const size_t PARALLEL_MIN_PIXELS = 16384;
+
+// Calls fn( first, last ) over [0,count), split into ranges of at most CHUNK_SIZE colors which are converted in parallel when there are enough of them
+const size_t CHUNK_SIZE = 1024;
+
+template<typename FN>
+void forEachChunk( size_t count, size_t pixelsPerItem, const FN &fn )
+{
+	if( count * pixelsPerItem >= PARALLEL_MIN_PIXELS && count > 1 )
+		TaskPool::get()->parallelFor( 0, count, fn );
+	else
+		fn( 0, count );
+}
+
+// Converts 8-bit sRGB and linear values in place of a Surface8u exactly through tables
+void convertTransfer8u( const Surface8u &srcSurface, Surface8u *dstSurface, const Area &area, ColorSpaceConversion conversion )
+{
+	const uint8_t *table = ( conversion == SRGB_TO_LINEAR ) ? sSrgb8ToLinear8Table : sLinear8ToSrgb8Table;
+	const uint8_t srcInc = srcSurface.getPixelInc(), dstInc = dstSurface->getPixelInc();
+	const int8_t srcR = srcSurface.getRedOffset(), srcG = srcSurface.getGreenOffset(), srcB = srcSurface.getBlueOffset();
+	const int8_t dstR = dstSurface->getRedOffset(), dstG = dstSurface->getGreenOffset(), dstB = dstSurface->getBlueOffset();
+	const bool srcAlpha = srcSurface.hasAlpha(), dstAlpha = dstSurface->hasAlpha();
+	const int8_t srcA = srcAlpha ? srcSurface.getAlphaOffset() : 0, dstA = dstAlpha ? dstSurface->getAlphaOffset() : 0;
+	forEachChunk( area.getHeight(), area.getWidth(), [&]( size_t first, size_t last ) {
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const uint8_t *src = srcSurface.getData( area.getUL() + Vec2i( 0, y ) );
+			uint8_t *dst = dstSurface->getData( area.getUL() + Vec2i( 0, y ) );
+			for( int32_t x = 0; x < area.getWidth(); ++x, src += srcInc, dst += dstInc ) {
+				const uint8_t r = table[src[srcR]], g = table[src[srcG]], b = table[src[srcB]], a = srcAlpha ? src[srcA] : 255;
+				dst[dstR] = r;
+				dst[dstG] = g;
+				dst[dstB] = b;
+				if( dstAlpha )
+					dst[dstA] = a;
+			}
+		}
+	} );
+}
+
+} // anonymous namespace
+
+void convertColorSpace( const Colorf *src, Colorf *dst, size_t count, ColorSpaceConversion conversion )
+{
+	const Converter converter( conversion );
+	forEachChunk( ( count + CHUNK_SIZE - 1 ) / CHUNK_SIZE, CHUNK_SIZE, [&]( size_t firstChunk, size_t lastChunk ) {
+		float planes[3][CHUNK_SIZE];
+		for( size_t chunk = firstChunk; chunk < lastChunk; ++chunk ) {
+			const size_t first = chunk * CHUNK_SIZE, size = std::min( count - first, CHUNK_SIZE );
+			for( size_t i = 0; i < size; ++i ) {
+				planes[0][i] = src[first + i].r;
+				planes[1][i] = src[first + i].g;
+				planes[2][i] = src[first + i].b;
+			}
+			converter.convert( planes[0], planes[1], planes[2], size );
+			for( size_t i = 0; i < size; ++i )
+				dst[first + i] = Colorf( planes[0][i], planes[1][i], planes[2][i] );
+		}
+	} );
+}
+
+template<typename T, typename Y>
+void convertColorSpace( const SurfaceT<T> &srcSurface, SurfaceT<Y> *dstSurface, ColorSpaceConversion conversion )
+{
+	const Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	const Converter converter( conversion );
+	if( boost::is_same<T,uint8_t>::value && boost::is_same<Y,uint8_t>::value && isTransfer( conversion ) ) {
+		convertTransfer8u( reinterpret_cast<const Surface8u&>( srcSurface ), reinterpret_cast<Surface8u*>( dstSurface ), area, conversion );
+		return;
+	}
+
+	const int32_t width = area.getWidth();
+	const uint8_t srcInc = srcSurface.getPixelInc(), dstInc = dstSurface->getPixelInc();
+	const int8_t srcR = srcSurface.getRedOffset(), srcG = srcSurface.getGreenOffset(), srcB = srcSurface.getBlueOffset();
+	const int8_t dstR = dstSurface->getRedOffset(), dstG = dstSurface->getGreenOffset(), dstB = dstSurface->getBlueOffset();
+	const bool srcAlpha = srcSurface.hasAlpha(), dstAlpha = dstSurface->hasAlpha();
+	const int8_t srcA = srcAlpha ? srcSurface.getAlphaOffset() : 0, dstA = dstAlpha ? dstSurface->getAlphaOffset() : 0;
+	const Y opaque = CHANTRAIT<Y>::max();
+	forEachChunk( area.getHeight(), width, [&]( size_t first, size_t last ) {
+		std::vector<float> planes( width * 3 );
+		float *c0 = &planes[0], *c1 = c0 + width, *c2 = c1 + width;
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const T *src = srcSurface.getData( area.getUL() + Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, src += srcInc ) {
+				c0[x] = toFloat( src[srcR] );
+				c1[x] = toFloat( src[srcG] );
+				c2[x] = toFloat( src[srcB] );
+			}
+			converter.convert( c0, c1, c2, width );
+
+			// in place, the colors have been gathered by now and alpha is read before it is written
+			src = srcSurface.getData( area.getUL() + Vec2i( 0, y ) );
+			Y *dst = dstSurface->getData( area.getUL() + Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, src += srcInc, dst += dstInc ) {
+				const Y alpha = srcAlpha ? fromFloat<Y>( toFloat( src[srcA] ) ) : opaque;
+				dst[dstR] = fromFloat<Y>( c0[x] );
+				dst[dstG] = fromFloat<Y>( c1[x] );
+				dst[dstB] = fromFloat<Y>( c2[x] );
+				if( dstAlpha )
+					dst[dstA] = alpha;
+			}
+		}
+	} );
+}
+
+template<typename T>
+void ycbcrPlanesToRgb( const ChannelT<T> &yChannel, const ChannelT<T> &cbChannel, const ChannelT<T> &crChannel, SurfaceT<T> *dstSurface, ColorSpaceConversion conversion )
+{
+	const Area area = yChannel.getBounds().getClipBy( dstSurface->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 || cbChannel.getWidth() <= 0 || crChannel.getWidth() <= 0 )
+		return;
+
+	const Converter converter( conversion );
+	const int32_t width = area.getWidth();
+	const uint8_t yInc = yChannel.getIncrement(), cbInc = cbChannel.getIncrement(), crInc = crChannel.getIncrement(), dstInc = dstSurface->getPixelInc();
+	const int8_t dstR = dstSurface->getRedOffset(), dstG = dstSurface->getGreenOffset(), dstB = dstSurface->getBlueOffset();
+	const bool dstAlpha = dstSurface->hasAlpha();
+	const int8_t dstA = dstAlpha ? dstSurface->getAlphaOffset() : 0;
+	// the chroma planes cover the image, so a pixel's chroma sample is found by scaling its coordinates
+	std::vector<int32_t> cbColumns( width ), crColumns( width );
+	for( int32_t x = 0; x < width; ++x ) {
+		cbColumns[x] = (int32_t)( (int64_t)x * cbChannel.getWidth() / yChannel.getWidth() ) * cbInc;
+		crColumns[x] = (int32_t)( (int64_t)x * crChannel.getWidth() / yChannel.getWidth() ) * crInc;
+	}
+
+	forEachChunk( area.getHeight(), width, [&]( size_t first, size_t last ) {
+		std::vector<float> planes( width * 3 );
+		float *c0 = &planes[0], *c1 = c0 + width, *c2 = c1 + width;
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const T *yRow = yChannel.getData( Vec2i( 0, y ) );
+			const T *cbRow = cbChannel.getData( Vec2i( 0, (int32_t)( (int64_t)y * cbChannel.getHeight() / yChannel.getHeight() ) ) );
+			const T *crRow = crChannel.getData( Vec2i( 0, (int32_t)( (int64_t)y * crChannel.getHeight() / yChannel.getHeight() ) ) );
+			for( int32_t x = 0; x < width; ++x ) {
+				c0[x] = toFloat( yRow[x * yInc] );
+				c1[x] = toFloat( cbRow[cbColumns[x]] );
+				c2[x] = toFloat( crRow[crColumns[x]] );
+			}
+			converter.convert( c0, c1, c2, width );
+
+			T *dst = dstSurface->getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, dst += dstInc ) {
+				dst[dstR] = fromFloat<T>( c0[x] );
+				dst[dstG] = fromFloat<T>( c1[x] );
+				dst[dstB] = fromFloat<T>( c2[x] );
+				if( dstAlpha )
+					dst[dstA] = CHANTRAIT<T>::max();
+			}
+		}
+	} );
+}
+
+void srgbToLinear( const float *src, float *dst, size_t count )
+{
+	initTransferTables();
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = srgbToLinearFast( src[i] );
+}
+
+void srgbToLinear( const uint8_t *src, float *dst, size_t count )
+{
+	initTransferTables();
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = sSrgb8ToLinearTable[src[i]];
+}
+
+void linearToSrgb( const float *src, float *dst, size_t count )
+{
+	initTransferTables();
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = linearToSrgbFast( src[i] );
+}
+
+void linearToSrgb( const float *src, uint8_t *dst, size_t count )
+{
+	initTransferTables();
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = static_cast<uint8_t>( linearToSrgbFast( constrain( src[i], 0.0f, 1.0f ) ) * 255 + 0.5f );
+}
+
+#define convertColorSpace_PROTOTYPES(r,data,TY)\
+	template void convertColorSpace( const SurfaceT<BOOST_PP_TUPLE_ELEM(2,0,TY)> &srcSurface, SurfaceT<BOOST_PP_TUPLE_ELEM(2,1,TY)> *dstSurface, ColorSpaceConversion conversion );
+
+#define ycbcrPlanesToRgb_PROTOTYPES(r,data,T)\
+	template void ycbcrPlanesToRgb( const ChannelT<T> &y, const ChannelT<T> &cb, const ChannelT<T> &cr, SurfaceT<T> *dstSurface, ColorSpaceConversion conversion );
+
+BOOST_PP_SEQ_FOR_EACH( convertColorSpace_PROTOTYPES, ~, ((uint8_t,uint8_t))((uint8_t,float))((float,uint8_t))((float,float)) )
+BOOST_PP_SEQ_FOR_EACH( ycbcrPlanesToRgb_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
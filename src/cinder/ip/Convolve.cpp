@@ -0,0 +1,522 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Convolve.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
+
+#include <vector>
+#include <algorithm>
+#include <boost/preprocessor/seq.hpp>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+bool isValidKernelSize( int32_t size )
+{
+	return size == 1 || size == 3 || size == 5;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ConvolutionKernel
+ConvolutionKernel::ConvolutionKernel( int32_t width, int32_t height, const float *weights, float scale, float bias )
+	: mWidth( width ), mHeight( height ), mScale( scale ), mBias( bias )
+{
+	if( ! isValidKernelSize( width ) || ! isValidKernelSize( height ) )
+		throw ConvolutionKernelExc( "Convolution kernel dimensions must be 1, 3 or 5." );
+
+	mWeights.assign( weights, weights + width * height );
+	findSeparable();
+}
+
+ConvolutionKernel::ConvolutionKernel( const vector<float> &row, const vector<float> &column, float scale, float bias )
+	: mWidth( (int32_t)row.size() ), mHeight( (int32_t)column.size() ), mRow( row ), mColumn( column ), mScale( scale ), mBias( bias )
+{
+	if( ! isValidKernelSize( mWidth ) || ! isValidKernelSize( mHeight ) )
+		throw ConvolutionKernelExc( "Convolution kernel dimensions must be 1, 3 or 5." );
+
+	mWeights.resize( mWidth * mHeight );
+	for( int32_t y = 0; y < mHeight; ++y )
+		for( int32_t x = 0; x < mWidth; ++x )
+			mWeights[y * mWidth + x] = mColumn[y] * mRow[x];
+}
+
+// A kernel is separable when it has rank one, in which case it is the outer product of the row holding its largest weight
+// and that weight's column divided by it.
+void ConvolutionKernel::findSeparable()
+{
+	int32_t pivotIdx = 0;
+	for( int32_t i = 1; i < mWidth * mHeight; ++i )
+		if( math<float>::abs( mWeights[i] ) > math<float>::abs( mWeights[pivotIdx] ) )
+			pivotIdx = i;
+	const float pivot = mWeights[pivotIdx];
+	if( pivot == 0 )
+		return;
+
+	vector<float> row( mWidth ), column( mHeight );
+	for( int32_t x = 0; x < mWidth; ++x )
+		row[x] = getWeight( x, pivotIdx / mWidth );
+	for( int32_t y = 0; y < mHeight; ++y )
+		column[y] = getWeight( pivotIdx % mWidth, y ) / pivot;
+
+	const float tolerance = 1e-6f * math<float>::abs( pivot );
+	for( int32_t y = 0; y < mHeight; ++y )
+		for( int32_t x = 0; x < mWidth; ++x )
+			if( math<float>::abs( column[y] * row[x] - getWeight( x, y ) ) > tolerance )
+				return;
+
+	mRow.swap( row );
+	mColumn.swap( column );
+}
+
+ConvolutionKernel ConvolutionKernel::box( int32_t size )
+{
+	if( size != 3 && size != 5 )
+		throw ConvolutionKernelExc( "Box kernel size must be 3 or 5." );
+
+	return ConvolutionKernel( vector<float>( size, 1.0f ), vector<float>( size, 1.0f ), 1.0f / ( size * size ) );
+}
+
+ConvolutionKernel ConvolutionKernel::gaussian( int32_t size )
+{
+	static const float binomial3[] = { 1, 2, 1 };
+	static const float binomial5[] = { 1, 4, 6, 4, 1 };
+	if( size == 3 )
+		return ConvolutionKernel( vector<float>( binomial3, binomial3 + 3 ), vector<float>( binomial3, binomial3 + 3 ), 1.0f / 16 );
+	else if( size == 5 )
+		return ConvolutionKernel( vector<float>( binomial5, binomial5 + 5 ), vector<float>( binomial5, binomial5 + 5 ), 1.0f / 256 );
+	else
+		throw ConvolutionKernelExc( "Gaussian kernel size must be 3 or 5." );
+}
+
+ConvolutionKernel ConvolutionKernel::sharpen( float amount )
+{
+	const float weights[] = {	0,			-amount,				0,
+								-amount,	1 + 4 * amount,		-amount,
+								0,			-amount,				0 };
+	return ConvolutionKernel( 3, 3, weights );
+}
+
+ConvolutionKernel ConvolutionKernel::laplacian()
+{
+	const float weights[] = {	0,	1,	0,
+								1,	-4,	1,
+								0,	1,	0 };
+	return ConvolutionKernel( 3, 3, weights );
+}
+
+ConvolutionKernel ConvolutionKernel::sobelX()
+{
+	static const float row[] = { -1, 0, 1 };
+	static const float column[] = { 1, 2, 1 };
+	return ConvolutionKernel( vector<float>( row, row + 3 ), vector<float>( column, column + 3 ) );
+}
+
+ConvolutionKernel ConvolutionKernel::sobelY()
+{
+	static const float row[] = { 1, 2, 1 };
+	static const float column[] = { 1, 0, -1 };
+	return ConvolutionKernel( vector<float>( row, row + 3 ), vector<float>( column, column + 3 ) );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// convolve
+namespace {
+
+// the rows of an Area are split into bands of at least this many rows across the TaskPool; each band reloads the rows its kernels overlap
+const int32_t MIN_BAND_ROWS = 16;
+const int32_t MAX_TAPS = 5;
+
+// maps \a i into [0, size) according to \a border, or returns -1 for a zero sample
+int32_t borderIndex( int32_t i, int32_t size, BorderMode border )
+{
+	if( i >= 0 && i < size )
+		return i;
+
+	switch( border ) {
+		case BORDER_CLAMP:
+			return constrain<int32_t>( i, 0, size - 1 );
+		case BORDER_MIRROR: {
+			if( size == 1 )
+				return 0;
+			const int32_t period = 2 * ( size - 1 );
+			i = abs( i ) % period;
+			return ( i < size ) ? i : period - i;
+		}
+		case BORDER_WRAP:
+			return ( ( i % size ) + size ) % size;
+		default:
+			return -1;
+	}
+}
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+template<int TAPS>
+int32_t filterRowSse2( const float *src, const float *weights, float *dst, int32_t count, float bias, bool accumulate )
+{
+	__m128 w[TAPS];
+	for( int t = 0; t < TAPS; ++t )
+		w[t] = _mm_set1_ps( weights[t] );
+
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		__m128 acc = accumulate ? _mm_loadu_ps( dst + x ) : _mm_set1_ps( bias );
+		for( int t = 0; t < TAPS; ++t )
+			acc = _mm_add_ps( acc, _mm_mul_ps( w[t], _mm_loadu_ps( src + x + t ) ) );
+		_mm_storeu_ps( dst + x, acc );
+	}
+	return x;
+}
+
+template<int TAPS>
+int32_t sumRowsSse2( const float * const *rows, const float *weights, float *dst, int32_t count, float bias )
+{
+	__m128 w[TAPS];
+	for( int t = 0; t < TAPS; ++t )
+		w[t] = _mm_set1_ps( weights[t] );
+
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		__m128 acc = _mm_set1_ps( bias );
+		for( int t = 0; t < TAPS; ++t )
+			acc = _mm_add_ps( acc, _mm_mul_ps( w[t], _mm_loadu_ps( rows[t] + x ) ) );
+		_mm_storeu_ps( dst + x, acc );
+	}
+	return x;
+}
+
+#elif defined( CINDER_NEON )
+
+template<int TAPS>
+int32_t filterRowNeon( const float *src, const float *weights, float *dst, int32_t count, float bias, bool accumulate )
+{
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		float32x4_t acc = accumulate ? vld1q_f32( dst + x ) : vdupq_n_f32( bias );
+		for( int t = 0; t < TAPS; ++t )
+			acc = vmlaq_n_f32( acc, vld1q_f32( src + x + t ), weights[t] );
+		vst1q_f32( dst + x, acc );
+	}
+	return x;
+}
+
+template<int TAPS>
+int32_t sumRowsNeon( const float * const *rows, const float *weights, float *dst, int32_t count, float bias )
+{
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		float32x4_t acc = vdupq_n_f32( bias );
+		for( int t = 0; t < TAPS; ++t )
+			acc = vmlaq_n_f32( acc, vld1q_f32( rows[t] + x ), weights[t] );
+		vst1q_f32( dst + x, acc );
+	}
+	return x;
+}
+#endif
+
+// dst[x] = ( accumulate ? dst[x] : bias ) + the sum of weights[t] * src[x + t]
+template<int TAPS>
+void filterRow( const float *src, const float *weights, float *dst, int32_t count, float bias, bool accumulate )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		x = filterRowSse2<TAPS>( src, weights, dst, count, bias, accumulate );
+#elif defined( CINDER_NEON )
+	x = filterRowNeon<TAPS>( src, weights, dst, count, bias, accumulate );
+#endif
+	for( ; x < count; ++x ) {
+		float acc = accumulate ? dst[x] : bias;
+		for( int t = 0; t < TAPS; ++t )
+			acc += weights[t] * src[x + t];
+		dst[x] = acc;
+	}
+}
+
+// dst[x] = bias + the sum of weights[t] * rows[t][x]
+template<int TAPS>
+void sumRows( const float * const *rows, const float *weights, float *dst, int32_t count, float bias )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		x = sumRowsSse2<TAPS>( rows, weights, dst, count, bias );
+#elif defined( CINDER_NEON )
+	x = sumRowsNeon<TAPS>( rows, weights, dst, count, bias );
+#endif
+	for( ; x < count; ++x ) {
+		float acc = bias;
+		for( int t = 0; t < TAPS; ++t )
+			acc += weights[t] * rows[t][x];
+		dst[x] = acc;
+	}
+}
+
+void filterRow( int32_t taps, const float *src, const float *weights, float *dst, int32_t count, float bias, bool accumulate )
+{
+	switch( taps ) {
+		case 1: filterRow<1>( src, weights, dst, count, bias, accumulate ); break;
+		case 3: filterRow<3>( src, weights, dst, count, bias, accumulate ); break;
+		default: filterRow<5>( src, weights, dst, count, bias, accumulate ); break;
+	}
+}
+
+void sumRows( int32_t taps, const float * const *rows, const float *weights, float *dst, int32_t count, float bias )
+{
+	switch( taps ) {
+		case 1: sumRows<1>( rows, weights, dst, count, bias ); break;
+		case 3: sumRows<3>( rows, weights, dst, count, bias ); break;
+		default: sumRows<5>( rows, weights, dst, count, bias ); break;
+	}
+}
+
+// a ConvolutionKernel with its scale folded into the weights
+struct PreparedKernel {
+	PreparedKernel( const ConvolutionKernel &kernel )
+		: mWidth( kernel.getWidth() ), mHeight( kernel.getHeight() ), mSeparable( kernel.isSeparable() ), mBias( kernel.getBias() )
+	{
+		if( mSeparable ) {
+			mRow = kernel.getRow();
+			mColumn = kernel.getColumn();
+			for( size_t y = 0; y < mColumn.size(); ++y )
+				mColumn[y] *= kernel.getScale();
+		}
+		else {
+			for( int32_t y = 0; y < mHeight; ++y )
+				for( int32_t x = 0; x < mWidth; ++x )
+					mWeights.push_back( kernel.getWeight( x, y ) * kernel.getScale() );
+		}
+	}
+
+	int32_t			mWidth, mHeight;
+	bool			mSeparable;
+	vector<float>	mWeights, mRow, mColumn;
+	float			mBias;
+};
+
+// Convolves bands of rows with one or more kernels. Each band keeps a ring of the source rows its kernels overlap, converted
+// to float and padded horizontally per the BorderMode, along with each separable kernel's horizontal pass over those rows.
+template<typename T>
+class ConvolveJob {
+  public:
+	ConvolveJob( const ChannelT<T> &srcChannel, const Area &area, const vector<ConvolutionKernel> &kernels, BorderMode border, const ConvolveRowFn &rowFn )
+		: mSrc( srcChannel ), mArea( area ), mBorder( border ), mRowFn( rowFn ), mRadiusX( 0 ), mRadiusY( 0 )
+	{
+		for( size_t k = 0; k < kernels.size(); ++k ) {
+			mKernels.push_back( PreparedKernel( kernels[k] ) );
+			mRadiusX = max( mRadiusX, kernels[k].getWidth() / 2 );
+			mRadiusY = max( mRadiusY, kernels[k].getHeight() / 2 );
+		}
+	}
+
+	void run()
+	{
+		const int32_t height = mArea.getHeight();
+		const size_t grainSize = max<size_t>( MIN_BAND_ROWS, height / ( System::getNumCores() * 4 ) );
+		TaskPool::get()->parallelFor( 0, height, [this]( size_t first, size_t last ) { processRows( (int32_t)first, (int32_t)last ); }, grainSize );
+	}
+
+  private:
+	// converts row \a y of the area, relative to its top, to float with mRadiusX samples of border on either side
+	void loadRow( int32_t y, float *padded ) const
+	{
+		const int32_t width = mArea.getWidth();
+		const int32_t paddedWidth = width + 2 * mRadiusX;
+		const int32_t srcY = borderIndex( y, mArea.getHeight(), mBorder );
+		if( srcY < 0 ) {
+			fill( padded, padded + paddedWidth, 0.0f );
+			return;
+		}
+
+		const T *src = mSrc.getData( mArea.getX1(), mArea.getY1() + srcY );
+		const int8_t inc = mSrc.getIncrement();
+		float *center = padded + mRadiusX;
+		for( int32_t x = 0; x < width; ++x )
+			center[x] = static_cast<float>( src[x * inc] );
+		for( int32_t i = 1; i <= mRadiusX; ++i ) {
+			const int32_t left = borderIndex( -i, width, mBorder ), right = borderIndex( width - 1 + i, width, mBorder );
+			center[-i] = ( left < 0 ) ? 0.0f : static_cast<float>( src[left * inc] );
+			center[width - 1 + i] = ( right < 0 ) ? 0.0f : static_cast<float>( src[right * inc] );
+		}
+	}
+
+	void processRows( int32_t rowBegin, int32_t rowEnd )
+	{
+		const int32_t width = mArea.getWidth();
+		const int32_t paddedWidth = width + 2 * mRadiusX;
+		const int32_t ringSize = 2 * mRadiusY + 1;
+		const size_t numKernels = mKernels.size();
+
+		vector<float> padded( ringSize * paddedWidth ), filtered( numKernels * ringSize * width ), results( numKernels * width );
+		vector<const float*> resultPtrs( numKernels ), rowPtrs( MAX_TAPS );
+		for( size_t k = 0; k < numKernels; ++k )
+			resultPtrs[k] = &results[k * width];
+
+		// rows are relative to the area's top and may be negative, so they are offset by ringSize before wrapping
+		for( int32_t y = rowBegin - mRadiusY; y < rowEnd + mRadiusY; ++y ) {
+			const int32_t slot = ( y + ringSize ) % ringSize;
+			float *paddedRow = &padded[slot * paddedWidth];
+			loadRow( y, paddedRow );
+			for( size_t k = 0; k < numKernels; ++k ) {
+				const PreparedKernel &kernel = mKernels[k];
+				if( kernel.mSeparable )
+					filterRow( kernel.mWidth, paddedRow + mRadiusX - kernel.mWidth / 2, &kernel.mRow[0], &filtered[( k * ringSize + slot ) * width], width, 0, false );
+			}
+
+			const int32_t outY = y - mRadiusY;
+			if( outY < rowBegin )
+				continue;
+
+			for( size_t k = 0; k < numKernels; ++k ) {
+				const PreparedKernel &kernel = mKernels[k];
+				const int32_t radiusX = kernel.mWidth / 2, radiusY = kernel.mHeight / 2;
+				float *result = &results[k * width];
+				if( kernel.mSeparable ) {
+					for( int32_t t = 0; t < kernel.mHeight; ++t )
+						rowPtrs[t] = &filtered[( k * ringSize + ( outY - radiusY + t + ringSize ) % ringSize ) * width];
+					sumRows( kernel.mHeight, &rowPtrs[0], &kernel.mColumn[0], result, width, kernel.mBias );
+				}
+				else {
+					for( int32_t t = 0; t < kernel.mHeight; ++t ) {
+						const float *src = &padded[( ( outY - radiusY + t + ringSize ) % ringSize ) * paddedWidth] + mRadiusX - radiusX;
+						filterRow( kernel.mWidth, src, &kernel.mWeights[t * kernel.mWidth], result, width, kernel.mBias, t > 0 );
+					}
+				}
+			}
+			mRowFn( outY, &resultPtrs[0] );
+		}
+	}
+
+	const ChannelT<T>		&mSrc;
+	Area					mArea;
+	BorderMode				mBorder;
+	const ConvolveRowFn		&mRowFn;
+	vector<PreparedKernel>	mKernels;
+	int32_t					mRadiusX, mRadiusY;
+};
+
+template<typename T>
+T fromConvolved( float v )
+{
+	return static_cast<T>( v );
+}
+
+template<>
+uint8_t fromConvolved<uint8_t>( float v )
+{
+	return static_cast<uint8_t>( constrain<int>( (int)( v + 0.5f ), 0, 255 ) );
+}
+
+template<>
+uint16_t fromConvolved<uint16_t>( float v )
+{
+	return static_cast<uint16_t>( constrain<int>( (int)( v + 0.5f ), 0, 65535 ) );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void convolveRows( const ChannelT<T> &srcChannel, const Area &srcArea, const vector<ConvolutionKernel> &kernels, const ConvolveRowFn &rowFn, BorderMode border )
+{
+	const Area area = srcArea.getClipBy( srcChannel.getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 || kernels.empty() )
+		return;
+
+	ConvolveJob<T>( srcChannel, area, kernels, border, rowFn ).run();
+}
+
+template<typename T>
+void convolve( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border )
+{
+	pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
+	const Area &area = srcDst.first;
+	const Vec2i &dstOffset = srcDst.second;
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	// bands are written while neighboring bands still read the rows around them, so a source which is also the destination is copied first
+	ChannelT<T> srcCopy;
+	const ChannelT<T> *src = &srcChannel;
+	Area convolveArea = area;
+	if( srcChannel.getData() == dstChannel->getData() ) {
+		srcCopy = srcChannel.clone( area );
+		src = &srcCopy;
+		convolveArea = srcCopy.getBounds();
+	}
+
+	const int32_t width = area.getWidth();
+	const int8_t dstInc = dstChannel->getIncrement();
+	convolveRows<T>( *src, convolveArea, vector<ConvolutionKernel>( 1, kernel ), [&]( int32_t row, const float * const *results ) {
+		const float *result = results[0];
+		T *dst = dstChannel->getData( dstOffset.x, dstOffset.y + row );
+		for( int32_t x = 0; x < width; ++x, dst += dstInc )
+			*dst = fromConvolved<T>( result[x] );
+	}, border );
+}
+
+template<typename T>
+void convolve( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border )
+{
+	convolve( srcChannel, srcChannel.getBounds(), Vec2i::zero(), dstChannel, kernel, border );
+}
+
+template<typename T>
+void convolve( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border )
+{
+	convolve( srcSurface.getChannelRed(), srcArea, dstLT, &dstSurface->getChannelRed(), kernel, border );
+	convolve( srcSurface.getChannelGreen(), srcArea, dstLT, &dstSurface->getChannelGreen(), kernel, border );
+	convolve( srcSurface.getChannelBlue(), srcArea, dstLT, &dstSurface->getChannelBlue(), kernel, border );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() )
+		convolve( srcSurface.getChannelAlpha(), srcArea, dstLT, &dstSurface->getChannelAlpha(), kernel, border );
+}
+
+template<typename T>
+void convolve( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border )
+{
+	convolve( srcSurface, srcSurface.getBounds(), Vec2i::zero(), dstSurface, kernel, border );
+}
+
+#define convolve_PROTOTYPES(r,data,T)\
+	template void convolve( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border ); \
+	template void convolve( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border ); \
+	template void convolve( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border ); \
+	template void convolve( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border ); \
+	template void convolveRows( const ChannelT<T> &srcChannel, const Area &srcArea, const vector<ConvolutionKernel> &kernels, const ConvolveRowFn &rowFn, BorderMode border );
+
+BOOST_PP_SEQ_FOR_EACH( convolve_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
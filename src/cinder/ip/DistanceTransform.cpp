@@ -0,0 +1,171 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/DistanceTransform.h"
+#include "cinder/CinderMath.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Calls fn( x, y, squaredDistance, nearestSeed ) for each pixel of the top left \a width x \a height of \a channel, where seeds are the pixels above \a threshold
+// if \a seedsAbove and the others otherwise. Pixels without any seed get a squared distance of infinity and a nearest seed of (-1, -1). Rows are visited in parallel.
+template<typename FN>
+void transform( const Channel8u &channel, int32_t width, int32_t height, uint8_t threshold, bool seedsAbove, const FN &fn )
+{
+	const uint8_t inc = channel.getIncrement();
+	// the nearest seed in each pixel's column, -1 for none
+	vector<int32_t> nearestRows( width * height );
+
+	// columns are independent; each task walks a band of them down and back up, reading rows contiguously
+	TaskPool::get()->parallelFor( 0, width, [&]( size_t first, size_t last ) {
+		const int32_t x0 = (int32_t)first, numColumns = (int32_t)( last - first );
+		vector<int32_t> seedRows( numColumns, -1 );
+		for( int32_t y = 0; y < height; ++y ) {
+			const uint8_t *src = channel.getData( x0, y );
+			int32_t *nearest = &nearestRows[y * width + x0];
+			for( int32_t c = 0; c < numColumns; ++c, src += inc ) {
+				if( ( *src > threshold ) == seedsAbove )
+					seedRows[c] = y;
+				nearest[c] = seedRows[c];
+			}
+		}
+
+		std::fill( seedRows.begin(), seedRows.end(), -1 );
+		for( int32_t y = height - 1; y >= 0; --y ) {
+			int32_t *nearest = &nearestRows[y * width + x0];
+			for( int32_t c = 0; c < numColumns; ++c ) {
+				if( nearest[c] == y )
+					seedRows[c] = y;
+				else if( seedRows[c] >= 0 && ( nearest[c] < 0 || seedRows[c] - y < y - nearest[c] ) )
+					nearest[c] = seedRows[c];
+			}
+		}
+	}, 64 );
+
+	// along each row, the squared distance to a seed through column q is the parabola (x - q)^2 + f(q), where f(q) is the squared distance to the column's
+	// nearest seed. The lower envelope of the finite parabolas is built in v (their columns) and z (the boundaries between them), then sampled.
+	const double infinity = numeric_limits<double>::infinity();
+	TaskPool::get()->parallelFor( 0, height, [&]( size_t first, size_t last ) {
+		vector<double> f( width ), z( width + 1 );
+		vector<int32_t> v( width );
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const int32_t *nearest = &nearestRows[y * width];
+			int32_t k = -1;
+			for( int32_t q = 0; q < width; ++q ) {
+				if( nearest[q] < 0 )
+					continue;
+				f[q] = (double)( y - nearest[q] ) * ( y - nearest[q] );
+				if( k < 0 ) {
+					k = 0;
+					v[0] = q;
+					z[0] = -infinity;
+					z[1] = infinity;
+					continue;
+				}
+
+				double s = ( ( f[q] + (double)q * q ) - ( f[v[k]] + (double)v[k] * v[k] ) ) / ( 2.0 * ( q - v[k] ) );
+				while( s <= z[k] ) {
+					--k;
+					s = ( ( f[q] + (double)q * q ) - ( f[v[k]] + (double)v[k] * v[k] ) ) / ( 2.0 * ( q - v[k] ) );
+				}
+				++k;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = infinity;
+			}
+
+			if( k < 0 ) {
+				for( int32_t x = 0; x < width; ++x )
+					fn( x, y, infinity, Vec2i( -1, -1 ) );
+				continue;
+			}
+
+			k = 0;
+			for( int32_t x = 0; x < width; ++x ) {
+				while( z[k + 1] < x )
+					++k;
+				const double dx = x - v[k];
+				fn( x, y, dx * dx + f[v[k]], Vec2i( v[k], nearest[v[k]] ) );
+			}
+		}
+	} );
+}
+
+} // anonymous namespace
+
+void distanceTransform( const Channel8u &srcChannel, Channel32f *dstChannel, uint8_t threshold, vector<Vec2i> *nearestSeeds )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( width <= 0 || height <= 0 )
+		return;
+
+	if( nearestSeeds )
+		nearestSeeds->resize( width * height );
+	Vec2i *seeds = nearestSeeds ? &(*nearestSeeds)[0] : 0;
+	transform( srcChannel, width, height, threshold, true, [=]( int32_t x, int32_t y, double squaredDistance, const Vec2i &nearest ) {
+		*dstChannel->getData( x, y ) = ( squaredDistance < FLT_MAX ) ? (float)math<double>::sqrt( squaredDistance ) : FLT_MAX;
+		if( seeds )
+			seeds[y * width + x] = nearest;
+	} );
+}
+
+Channel32f distanceTransform( const Channel8u &srcChannel, uint8_t threshold )
+{
+	Channel32f result( srcChannel.getWidth(), srcChannel.getHeight() );
+	distanceTransform( srcChannel, &result, threshold );
+	return result;
+}
+
+void signedDistanceTransform( const Channel8u &srcChannel, Channel32f *dstChannel, uint8_t threshold )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( width <= 0 || height <= 0 )
+		return;
+
+	// outside pixels measure to the nearest inside pixel and inside pixels to the nearest outside one; each pass writes only the pixels it measures
+	transform( srcChannel, width, height, threshold, true, [=]( int32_t x, int32_t y, double squaredDistance, const Vec2i & ) {
+		if( squaredDistance > 0 )
+			*dstChannel->getData( x, y ) = ( squaredDistance < FLT_MAX ) ? (float)math<double>::sqrt( squaredDistance ) - 0.5f : FLT_MAX;
+	} );
+	transform( srcChannel, width, height, threshold, false, [=]( int32_t x, int32_t y, double squaredDistance, const Vec2i & ) {
+		if( squaredDistance > 0 )
+			*dstChannel->getData( x, y ) = ( squaredDistance < FLT_MAX ) ? 0.5f - (float)math<double>::sqrt( squaredDistance ) : -FLT_MAX;
+	} );
+}
+
+Channel32f signedDistanceTransform( const Channel8u &srcChannel, uint8_t threshold )
+{
+	Channel32f result( srcChannel.getWidth(), srcChannel.getHeight() );
+	signedDistanceTransform( srcChannel, &result, threshold );
+	return result;
+}
+
+} } // namespace cinder::ip
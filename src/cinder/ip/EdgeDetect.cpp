@@ -21,9 +21,11 @@
 */
 
 #include "cinder/ip/EdgeDetect.h"
+#include "cinder/ip/Convolve.h"
 #include "cinder/Surface.h"
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
 #include <boost/preprocessor/seq.hpp>
 
 namespace cinder { namespace ip {
@@ -32,7 +34,7 @@ namespace cinder { namespace ip {
 // -1  0  1     1  2  1
 // -2  0  2     0  0  0
 // -1  0  1    -1 -2 -1
-// NOTE: this leaves garbage in the top and bottom rows, as well as the left and right columns
+// Both gradients are computed in a single pass of convolveRows(), repeating the edge pixels of srcArea
 
 template<typename T>
 void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel )
@@ -40,27 +42,20 @@ void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const
 	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
 	const Area &area( srcDst.first );
 	const Vec2i &dstOffset( srcDst.second );
-	typename CHANTRAIT<T>::Sum sumX, sumY;
-
-	int32_t srcRowBytes = srcChannel.getRowBytes();
-	int8_t srcPixelBytes = srcChannel.getIncrement() * sizeof(T);
-	int8_t dstPixelBytes = dstChannel->getIncrement() * sizeof(T);
-	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 1; y < area.getHeight() - 1; ++y ) {
-		const uint8_t *srcLine = reinterpret_cast<const uint8_t*>( srcChannel.getData( area.getX1() + 1, area.getY1() + y ) );
-		uint8_t *dstLine = reinterpret_cast<uint8_t*>( dstChannel->getData( dstOffset.x + area.getX1() + 1, dstOffset.y + y ) );
-		for( int32_t x = area.getX1() + 1; x < area.getX2() - 1; ++x ) {
-//			sumX = -srcLine[-srcRowPixels-srcPixelStride] + srcLine[-srcRowPixels+srcPixelStride] - 2 * srcLine[-srcPixelStride] + 2 * srcLine[srcPixelStride] - srcLine[srcRowPixels-srcPixelStride] + srcLine[srcRowPixels+srcPixelStride];
-			sumX = -*(T*)(srcLine-srcRowBytes-srcPixelBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - 2 * *(T*)(srcLine-srcPixelBytes) + 2 * *(T*)(srcLine+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) + *(T*)(srcLine+srcRowBytes+srcPixelBytes);
-//			sumY = srcLine[-srcRowPixels-srcPixelStride] + 2 * srcLine[-srcRowPixels] + srcLine[-srcRowPixels + srcPixelStride]				- srcLine[srcRowPixels-srcPixelStride] - 2 * srcLine[srcRowPixels] - srcLine[srcRowPixels+srcPixelStride];
-			sumY = *(T*)(srcLine-srcRowBytes-srcPixelBytes) + 2 * *(T*)(srcLine-srcRowBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) - 2 * *(T*)(srcLine+srcPixelBytes) - *(T*)(srcLine+srcRowBytes+srcPixelBytes);
-			sumX = static_cast<typename CHANTRAIT<T>::Sum>( math<float>::sqrt( float( sumX * sumX + sumY * sumY ) ) );
-			if( sumX > maxValue ) sumX = maxValue;
-			*dstLine = static_cast<uint8_t>( sumX );
-			dstLine += dstPixelBytes;
-			srcLine += srcPixelBytes;
-		}
-	}
+
+	std::vector<ConvolutionKernel> kernels;
+	kernels.push_back( ConvolutionKernel::sobelX() );
+	kernels.push_back( ConvolutionKernel::sobelY() );
+
+	const int32_t width = area.getWidth();
+	const int8_t dstInc = dstChannel->getIncrement();
+	const float maxValue = static_cast<float>( CHANTRAIT<T>::max() );
+	convolveRows<T>( srcChannel, area, kernels, [&]( int32_t row, const float * const *gradients ) {
+		const float *sumX = gradients[0], *sumY = gradients[1];
+		T *dst = dstChannel->getData( dstOffset.x, dstOffset.y + row );
+		for( int32_t x = 0; x < width; ++x, dst += dstInc )
+			*dst = static_cast<T>( std::min( math<float>::sqrt( sumX[x] * sumX[x] + sumY[x] * sumY[x] ), maxValue ) );
+	} );
 }
 
 template<typename T>
@@ -92,7 +87,7 @@ void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface )
 	template void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );	\
 	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );	
 
-BOOST_PP_SEQ_FOR_EACH( edgeDetect_PROTOTYPES, ~, CHANNEL_TYPES )
+BOOST_PP_SEQ_FOR_EACH( edgeDetect_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
 
 } } // namespace cinder::ip
@@ -47,6 +47,6 @@ void flipVertical( SurfaceT<T> *surface )
 #define flip_PROTOTYPES(r,data,T)\
 	template void flipVertical<T>( SurfaceT<T> *surface );
 
-BOOST_PP_SEQ_FOR_EACH( flip_PROTOTYPES, ~, CHANNEL_TYPES )
+BOOST_PP_SEQ_FOR_EACH( flip_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
 } } // namespace cinder::ip
@@ -22,12 +22,161 @@
 
 #include "cinder/ip/Grayscale.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 
 #include <boost/preprocessor/seq.hpp>
 
 
 namespace cinder { namespace ip {
 
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+// extracts the 8 bit channel at byte \a offset of each of four 32-bit pixels into 32-bit lanes
+inline __m128i channel_epi32( __m128i px, uint8_t offset )
+{
+	return _mm_and_si128( _mm_srl_epi32( px, _mm_cvtsi32_si128( offset * 8 ) ), _mm_set1_epi32( 0xFF ) );
+}
+
+// weighted sum of the red, green and blue channels of eight 4-channel pixels, as 16-bit lanes (sum >> 8)
+inline __m128i grayscale8_epu16( const uint8_t *srcPtr, uint8_t r, uint8_t g, uint8_t b, uint16_t rw, uint16_t gw, uint16_t bw )
+{
+	__m128i px0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPtr ) );
+	__m128i px1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPtr + 16 ) );
+	__m128i red = _mm_packs_epi32( channel_epi32( px0, r ), channel_epi32( px1, r ) );
+	__m128i green = _mm_packs_epi32( channel_epi32( px0, g ), channel_epi32( px1, g ) );
+	__m128i blue = _mm_packs_epi32( channel_epi32( px0, b ), channel_epi32( px1, b ) );
+	// the weights sum to 256, so the total never exceeds 16 bits
+	__m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( red, _mm_set1_epi16( rw ) ), _mm_mullo_epi16( green, _mm_set1_epi16( gw ) ) ), _mm_mullo_epi16( blue, _mm_set1_epi16( bw ) ) );
+	return _mm_srli_epi16( sum, 8 );
+}
+#endif // defined( CINDER_SSE2 )
+
+// Fills as much of a row of grayscale values as the SIMD paths can, returning the number of pixels handled. Requires 4-channel source pixels.
+int32_t grayscaleToChannelRowSimd( const uint8_t *srcPtr, uint8_t *dstPtr, int32_t width, uint8_t r, uint8_t g, uint8_t b )
+{
+	const uint8_t redWeight = 74, greenWeight = 147, blueWeight = 35;
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	for( ; x + 8 <= width; x += 8, srcPtr += 32, dstPtr += 8 ) {
+		__m128i gray = grayscale8_epu16( srcPtr, r, g, b, redWeight, greenWeight, blueWeight );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( dstPtr ), _mm_packus_epi16( gray, gray ) );
+	}
+#elif defined( CINDER_NEON )
+	for( ; x + 8 <= width; x += 8, srcPtr += 32, dstPtr += 8 ) {
+		uint8x8x4_t px = vld4_u8( srcPtr );
+		uint16x8_t sum = vmull_u8( px.val[r], vdup_n_u8( redWeight ) );
+		sum = vmlal_u8( sum, px.val[g], vdup_n_u8( greenWeight ) );
+		sum = vmlal_u8( sum, px.val[b], vdup_n_u8( blueWeight ) );
+		vst1_u8( dstPtr, vshrn_n_u16( sum, 8 ) );
+	}
+#endif
+	return x;
+}
+
+// Writes the luma of each 4-channel source pixel into the red, green and blue channels of 4-channel destination pixels, returning the number of pixels handled
+int32_t grayscaleToSurfaceRowSimd( const uint8_t *srcPtr, uint8_t *dstPtr, int32_t width, uint8_t sr, uint8_t sg, uint8_t sb, uint8_t dr, uint8_t dg, uint8_t db )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	// bytes of the destination pixel which aren't red, green or blue are preserved
+	const __m128i keepMask = _mm_set1_epi32( ~( ( 0xFF << ( dr * 8 ) ) | ( 0xFF << ( dg * 8 ) ) | ( 0xFF << ( db * 8 ) ) ) );
+	const __m128i zero = _mm_setzero_si128();
+	for( ; x + 8 <= width; x += 8, srcPtr += 32, dstPtr += 32 ) {
+		// CHANTRAIT<uint8_t>::grayscale() coefficients
+		__m128i gray = grayscale8_epu16( srcPtr, sr, sg, sb, 54, 183, 19 );
+		for( int half = 0; half < 2; ++half ) {
+			__m128i gray32 = half ? _mm_unpackhi_epi16( gray, zero ) : _mm_unpacklo_epi16( gray, zero );
+			gray32 = _mm_or_si128( gray32, _mm_slli_epi32( gray32, 8 ) );
+			gray32 = _mm_or_si128( gray32, _mm_slli_epi32( gray32, 16 ) );
+			__m128i *dst = reinterpret_cast<__m128i*>( dstPtr + half * 16 );
+			__m128i old = _mm_loadu_si128( dst );
+			_mm_storeu_si128( dst, _mm_or_si128( _mm_and_si128( keepMask, old ), _mm_andnot_si128( keepMask, gray32 ) ) );
+		}
+	}
+#elif defined( CINDER_NEON )
+	for( ; x + 8 <= width; x += 8, srcPtr += 32, dstPtr += 32 ) {
+		uint8x8x4_t px = vld4_u8( srcPtr );
+		uint16x8_t sum = vmull_u8( px.val[sr], vdup_n_u8( 54 ) );
+		sum = vmlal_u8( sum, px.val[sg], vdup_n_u8( 183 ) );
+		sum = vmlal_u8( sum, px.val[sb], vdup_n_u8( 19 ) );
+		uint8x8_t gray = vshrn_n_u16( sum, 8 );
+		uint8x8x4_t dst = vld4_u8( dstPtr );
+		dst.val[dr] = gray;
+		dst.val[dg] = gray;
+		dst.val[db] = gray;
+		vst4_u8( dstPtr, dst );
+	}
+#endif
+	return x;
+}
+
+#if defined( CINDER_SSE2 )
+// luma of four 4-channel float pixels, evaluated in the same order as CHANTRAIT<float>::grayscale()
+inline __m128 grayscale4_ps( const float *srcPtr, uint8_t r, uint8_t g, uint8_t b )
+{
+	__m128 c[4] = { _mm_loadu_ps( srcPtr ), _mm_loadu_ps( srcPtr + 4 ), _mm_loadu_ps( srcPtr + 8 ), _mm_loadu_ps( srcPtr + 12 ) };
+	_MM_TRANSPOSE4_PS( c[0], c[1], c[2], c[3] );
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( c[r], _mm_set1_ps( 0.2126f ) ), _mm_mul_ps( c[g], _mm_set1_ps( 0.7152f ) ) ), _mm_mul_ps( c[b], _mm_set1_ps( 0.0722f ) ) );
+}
+#endif
+
+int32_t grayscaleToChannelRowSimd( const float *srcPtr, float *dstPtr, int32_t width, uint8_t r, uint8_t g, uint8_t b )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	for( ; x + 4 <= width; x += 4, srcPtr += 16, dstPtr += 4 )
+		_mm_storeu_ps( dstPtr, grayscale4_ps( srcPtr, r, g, b ) );
+#endif
+	return x;
+}
+
+int32_t grayscaleToSurfaceRowSimd( const float *srcPtr, float *dstPtr, int32_t width, uint8_t sr, uint8_t sg, uint8_t sb, uint8_t dr, uint8_t dg, uint8_t db )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( ! useSse2() )
+		return 0;
+	for( ; x + 4 <= width; x += 4, srcPtr += 16, dstPtr += 16 ) {
+		__m128 gray = grayscale4_ps( srcPtr, sr, sg, sb );
+		__m128 c[4] = { _mm_loadu_ps( dstPtr ), _mm_loadu_ps( dstPtr + 4 ), _mm_loadu_ps( dstPtr + 8 ), _mm_loadu_ps( dstPtr + 12 ) };
+		_MM_TRANSPOSE4_PS( c[0], c[1], c[2], c[3] );
+		c[dr] = c[dg] = c[db] = gray;
+		_MM_TRANSPOSE4_PS( c[0], c[1], c[2], c[3] );
+		for( int i = 0; i < 4; ++i )
+			_mm_storeu_ps( dstPtr + i * 4, c[i] );
+	}
+#endif
+	return x;
+}
+
+template<typename T>
+int32_t grayscaleToChannelRowSimd( const T *srcPtr, T *dstPtr, int32_t width, uint8_t r, uint8_t g, uint8_t b )
+{
+	return 0;
+}
+
+template<typename T>
+int32_t grayscaleToSurfaceRowSimd( const T *srcPtr, T *dstPtr, int32_t width, uint8_t sr, uint8_t sg, uint8_t sb, uint8_t dr, uint8_t dg, uint8_t db )
+{
+	return 0;
+}
+
+} // anonymous namespace
+
 template<typename T>
 void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
 {
@@ -40,7 +189,14 @@ void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
 	for( int32_t y = 0; y < area.getHeight(); ++y ) {
 		T *dstPtr = dstSurface->getData( Vec2i( area.getX1(), y ) );
 		const T *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
-		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
+		int32_t x = area.getX1();
+		if( srcPixelInc == 4 && dstPixelInc == 4 ) {
+			int32_t handled = grayscaleToSurfaceRowSimd( srcPtr, dstPtr, area.getWidth(), srcRedOffset, srcGreenOffset, srcBlueOffset, dstRedOffset, dstGreenOffset, dstBlueOffset );
+			x += handled;
+			srcPtr += handled * 4;
+			dstPtr += handled * 4;
+		}
+		for( ; x < area.getX2(); ++x ) {
 			T gray = CHANTRAIT<T>::grayscale( srcPtr[srcRedOffset], srcPtr[srcGreenOffset], srcPtr[srcBlueOffset] );
 			dstPtr[dstRedOffset] = gray;
 			dstPtr[dstGreenOffset] = gray;
@@ -62,7 +218,14 @@ void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
 	for( int32_t y = 0; y < area.getHeight(); ++y ) {
 		T *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
 		const T *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
-		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
+		int32_t x = area.getX1();
+		if( srcPixelInc == 4 && dstPixelInc == 1 ) {
+			int32_t handled = grayscaleToChannelRowSimd( srcPtr, dstPtr, area.getWidth(), srcRedOffset, srcGreenOffset, srcBlueOffset );
+			x += handled;
+			srcPtr += handled * 4;
+			dstPtr += handled;
+		}
+		for( ; x < area.getX2(); ++x ) {
 			*dstPtr = CHANTRAIT<T>::grayscale( srcPtr[srcRedOffset], srcPtr[srcGreenOffset], srcPtr[srcBlueOffset] );
 			dstPtr += dstPixelInc;
 			srcPtr += srcPixelInc;
@@ -82,7 +245,14 @@ void grayscale( const Surface8u &srcSurface, Channel8u *dstChannel )
 	for( int32_t y = 0; y < area.getHeight(); ++y ) {
 		uint8_t *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
 		const uint8_t *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
-		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
+		int32_t x = area.getX1();
+		if( srcPixelInc == 4 && dstPixelInc == 1 ) {
+			int32_t handled = grayscaleToChannelRowSimd( srcPtr, dstPtr, area.getWidth(), srcRedOffset, srcGreenOffset, srcBlueOffset );
+			x += handled;
+			srcPtr += handled * 4;
+			dstPtr += handled;
+		}
+		for( ; x < area.getX2(); ++x ) {
 			uint32_t sum = srcPtr[srcRedOffset] * redWeight + srcPtr[srcGreenOffset] * greenWeight + srcPtr[srcBlueOffset] * blueWeight;
 			*dstPtr = static_cast<uint8_t>( sum >> 8 );
 			dstPtr += dstPixelInc;
@@ -96,7 +266,7 @@ void grayscale( const Surface8u &srcSurface, Channel8u *dstChannel )
 	
 template void grayscale( const SurfaceT<float> &srcSurface, ChannelT<float> *dstChannel );
 
-BOOST_PP_SEQ_FOR_EACH( grayscale_PROTOTYPES, ~, CHANNEL_TYPES )
+BOOST_PP_SEQ_FOR_EACH( grayscale_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
 
 } } // namespace cinder::ip
@@ -24,54 +24,249 @@
 #include "cinder/ip/Grayscale.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/ip/Statistics.h"
+#include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
 #include <algorithm>
+#include <mutex>
+#include <vector>
 
 namespace cinder { namespace ip {
 
-void hdrNormalize( Surface32f *surface )
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+#elif defined( CINDER_NEON )
+// NEON has no divide, so refine the reciprocal estimate with two Newton-Raphson steps
+inline float32x4_t div_f32( float32x4_t a, float32x4_t b )
 {
-	// first take histogram to find the minimum and maximum values present
-	float minVal = *(surface->getDataRed( Vec2i::zero() )), maxVal = *(surface->getDataRed( Vec2i::zero() ));
+	float32x4_t recip = vrecpeq_f32( b );
+	recip = vmulq_f32( vrecpsq_f32( b, recip ), recip );
+	recip = vmulq_f32( vrecpsq_f32( b, recip ), recip );
+	return vmulq_f32( a, recip );
+}
+#endif
 
-	const int8_t pixelInc = surface->getPixelInc();
-	const uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
-	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
-		const float *srcPtr = surface->getData( Vec2i( 0, y ) );
-		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
-			minVal = std::min( minVal, srcPtr[redOffset] );
-			maxVal = std::max( maxVal, srcPtr[redOffset] );
-			minVal = std::min( minVal, srcPtr[greenOffset] );
-			maxVal = std::max( maxVal, srcPtr[greenOffset] );
-			minVal = std::min( minVal, srcPtr[blueOffset] );
-			maxVal = std::max( maxVal, srcPtr[blueOffset] );
-
-			srcPtr += pixelInc;
+// Applies a ToneMap's exposure and operator to colors held in separate red, green and blue arrays, and encodes them with its gamma
+class ToneMapper {
+  public:
+	ToneMapper( const ToneMap &params, float exposureScale )
+		: mOperator( params.getOperator() ), mScale( exposureScale ), mLinearGamma( params.getGamma() == 1 )
+	{
+		mInvWhiteSq = 1.0f / std::max( params.getWhitePoint() * params.getWhitePoint(), 1e-6f );
+		if( ! mLinearGamma ) {
+			// indexed by sqrt( v ), which concentrates the entries near 0 where the curve is steepest; the last entry is repeated for interpolation
+			mGammaTable.resize( GAMMA_TABLE_SIZE + 1 );
+			const float exponent = 2.0f / params.getGamma();
+			for( int32_t i = 0; i < GAMMA_TABLE_SIZE; ++i )
+				mGammaTable[i] = math<float>::pow( i / (float)( GAMMA_TABLE_SIZE - 1 ), exponent );
+			mGammaTable[GAMMA_TABLE_SIZE] = mGammaTable[GAMMA_TABLE_SIZE - 1];
 		}
 	}
-	
+
+	// Maps \a count colors in place to [0,1], before gamma encoding
+	void mapColors( float *r, float *g, float *b, int32_t count ) const
+	{
+		for( int32_t i = mapColorsSimd( r, g, b, count ); i < count; ++i ) {
+			r[i] *= mScale;
+			g[i] *= mScale;
+			b[i] *= mScale;
+			if( mOperator == ToneMap::REINHARD || mOperator == ToneMap::REINHARD_EXTENDED ) {
+				const float lum = std::max( 0.0f, 0.2126f * r[i] + 0.7152f * g[i] + 0.0722f * b[i] );
+				const float scale = ( ( mOperator == ToneMap::REINHARD ) ? 1.0f : ( 1.0f + lum * mInvWhiteSq ) ) / ( 1.0f + lum );
+				r[i] *= scale;
+				g[i] *= scale;
+				b[i] *= scale;
+			}
+			else if( mOperator == ToneMap::FILMIC ) {
+				r[i] = filmic( r[i] );
+				g[i] = filmic( g[i] );
+				b[i] = filmic( b[i] );
+			}
+			r[i] = constrain( r[i], 0.0f, 1.0f );
+			g[i] = constrain( g[i], 0.0f, 1.0f );
+			b[i] = constrain( b[i], 0.0f, 1.0f );
+		}
+	}
+
+	// Gamma encodes \a v, which must be in [0,1]
+	float encode( float v ) const
+	{
+		if( mLinearGamma )
+			return v;
+		const float pos = math<float>::sqrt( v ) * ( GAMMA_TABLE_SIZE - 1 );
+		const int32_t idx = (int32_t)pos;
+		return mGammaTable[idx] + ( mGammaTable[idx + 1] - mGammaTable[idx] ) * ( pos - idx );
+	}
+
+  private:
+	static const int32_t GAMMA_TABLE_SIZE = 4096;
+
+	static float filmic( float x )
+	{
+		x = std::max( x, 0.0f );
+		return ( x * ( 2.51f * x + 0.03f ) ) / ( x * ( 2.43f * x + 0.59f ) + 0.14f );
+	}
+
+	// Maps a prefix of the colors 4 at a time, returning how many it handled
+	int32_t mapColorsSimd( float *r, float *g, float *b, int32_t count ) const
+	{
+		int32_t i = 0;
+#if defined( CINDER_SSE2 )
+		if( ! useSse2() )
+			return 0;
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), scale = _mm_set1_ps( mScale );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 vr = _mm_mul_ps( _mm_loadu_ps( r + i ), scale );
+			__m128 vg = _mm_mul_ps( _mm_loadu_ps( g + i ), scale );
+			__m128 vb = _mm_mul_ps( _mm_loadu_ps( b + i ), scale );
+			if( mOperator == ToneMap::REINHARD || mOperator == ToneMap::REINHARD_EXTENDED ) {
+				const __m128 lum = _mm_max_ps( zero, _mm_add_ps( _mm_add_ps( _mm_mul_ps( vr, _mm_set1_ps( 0.2126f ) ), _mm_mul_ps( vg, _mm_set1_ps( 0.7152f ) ) ), _mm_mul_ps( vb, _mm_set1_ps( 0.0722f ) ) ) );
+				const __m128 numerator = ( mOperator == ToneMap::REINHARD ) ? one : _mm_add_ps( one, _mm_mul_ps( lum, _mm_set1_ps( mInvWhiteSq ) ) );
+				const __m128 lumScale = _mm_div_ps( numerator, _mm_add_ps( one, lum ) );
+				vr = _mm_mul_ps( vr, lumScale );
+				vg = _mm_mul_ps( vg, lumScale );
+				vb = _mm_mul_ps( vb, lumScale );
+			}
+			else if( mOperator == ToneMap::FILMIC ) {
+				vr = filmicSse2( vr );
+				vg = filmicSse2( vg );
+				vb = filmicSse2( vb );
+			}
+			_mm_storeu_ps( r + i, _mm_min_ps( _mm_max_ps( vr, zero ), one ) );
+			_mm_storeu_ps( g + i, _mm_min_ps( _mm_max_ps( vg, zero ), one ) );
+			_mm_storeu_ps( b + i, _mm_min_ps( _mm_max_ps( vb, zero ), one ) );
+		}
+#elif defined( CINDER_NEON )
+		const float32x4_t zero = vdupq_n_f32( 0 ), one = vdupq_n_f32( 1.0f );
+		for( ; i + 4 <= count; i += 4 ) {
+			float32x4_t vr = vmulq_n_f32( vld1q_f32( r + i ), mScale );
+			float32x4_t vg = vmulq_n_f32( vld1q_f32( g + i ), mScale );
+			float32x4_t vb = vmulq_n_f32( vld1q_f32( b + i ), mScale );
+			if( mOperator == ToneMap::REINHARD || mOperator == ToneMap::REINHARD_EXTENDED ) {
+				const float32x4_t lum = vmaxq_f32( zero, vmlaq_n_f32( vmlaq_n_f32( vmulq_n_f32( vr, 0.2126f ), vg, 0.7152f ), vb, 0.0722f ) );
+				const float32x4_t numerator = ( mOperator == ToneMap::REINHARD ) ? one : vmlaq_n_f32( one, lum, mInvWhiteSq );
+				const float32x4_t lumScale = div_f32( numerator, vaddq_f32( one, lum ) );
+				vr = vmulq_f32( vr, lumScale );
+				vg = vmulq_f32( vg, lumScale );
+				vb = vmulq_f32( vb, lumScale );
+			}
+			else if( mOperator == ToneMap::FILMIC ) {
+				vr = filmicNeon( vr );
+				vg = filmicNeon( vg );
+				vb = filmicNeon( vb );
+			}
+			vst1q_f32( r + i, vminq_f32( vmaxq_f32( vr, zero ), one ) );
+			vst1q_f32( g + i, vminq_f32( vmaxq_f32( vg, zero ), one ) );
+			vst1q_f32( b + i, vminq_f32( vmaxq_f32( vb, zero ), one ) );
+		}
+#endif
+		return i;
+	}
+
+#if defined( CINDER_SSE2 )
+	static __m128 filmicSse2( __m128 x )
+	{
+		x = _mm_max_ps( x, _mm_setzero_ps() );
+		const __m128 numerator = _mm_mul_ps( x, _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( 2.51f ) ), _mm_set1_ps( 0.03f ) ) );
+		const __m128 denominator = _mm_add_ps( _mm_mul_ps( x, _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( 2.43f ) ), _mm_set1_ps( 0.59f ) ) ), _mm_set1_ps( 0.14f ) );
+		return _mm_div_ps( numerator, denominator );
+	}
+#elif defined( CINDER_NEON )
+	static float32x4_t filmicNeon( float32x4_t x )
+	{
+		x = vmaxq_f32( x, vdupq_n_f32( 0 ) );
+		const float32x4_t numerator = vmulq_f32( x, vmlaq_n_f32( vdupq_n_f32( 0.03f ), x, 2.51f ) );
+		const float32x4_t denominator = vmlaq_f32( vdupq_n_f32( 0.14f ), x, vmlaq_n_f32( vdupq_n_f32( 0.59f ), x, 2.43f ) );
+		return div_f32( numerator, denominator );
+	}
+#endif
+
+	ToneMap::Operator	mOperator;
+	float				mScale, mInvWhiteSq;
+	bool				mLinearGamma;
+	std::vector<float>	mGammaTable;
+};
+
+float getExposureScale( const Surface32f &surface, const ToneMap &params )
+{
+	float result = math<float>::pow( 2.0f, params.getExposure() );
+	if( params.getAutoExposureKey() > 0 )
+		result *= params.getAutoExposureKey() / getLogAverageLuminance( surface );
+	return result;
+}
+
+// Calls fn( srcRow, dstRow, r, g, b, width ) for each row of the intersection of the Surfaces, in parallel, once \a mapper has mapped the row's colors into r, g and b
+template<typename T, typename FN>
+void toneMapRows( const Surface32f &srcSurface, SurfaceT<T> *dstSurface, const ToneMapper &mapper, const FN &fn )
+{
+	const Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	const int32_t width = area.getWidth();
+	if( width <= 0 || area.getHeight() <= 0 )
+		return;
+
+	const uint8_t srcInc = srcSurface.getPixelInc();
+	const uint8_t srcR = srcSurface.getRedOffset(), srcG = srcSurface.getGreenOffset(), srcB = srcSurface.getBlueOffset();
+	TaskPool::get()->parallelFor( 0, area.getHeight(), [&]( size_t first, size_t last ) {
+		std::vector<float> colors( width * 3 );
+		float *r = &colors[0], *g = r + width, *b = g + width;
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const float *src = srcSurface.getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, src += srcInc ) {
+				r[x] = src[srcR];
+				g[x] = src[srcG];
+				b[x] = src[srcB];
+			}
+			mapper.mapColors( r, g, b, width );
+			fn( srcSurface.getData( Vec2i( 0, y ) ), dstSurface->getData( Vec2i( 0, y ) ), r, g, b, width );
+		}
+	} );
+}
+
+} // anonymous namespace
+
+void hdrNormalize( Surface32f *surface )
+{
+	// first find the minimum and maximum values present across the color channels
+	ChannelStatistics red, green, blue;
+	getStatistics( *surface, surface->getBounds(), &red, &green, &blue );
+	const float minVal = std::min( red.getMin(), std::min( green.getMin(), blue.getMin() ) );
+	const float maxVal = std::max( red.getMax(), std::max( green.getMax(), blue.getMax() ) );
+
 	// if min==max then we should just fill with black
 	if( minVal == maxVal ) {
 		fill( surface, Color( 0, 0, 0 ) );
 		return;
 	}
 	
-	float scale = 1.0f / ( maxVal - minVal );
-	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
-		float *dstPtr = surface->getData( Vec2i( 0, y ) );
-		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
-			dstPtr[redOffset] = ( dstPtr[redOffset] - minVal ) * scale;
-			dstPtr[greenOffset] = ( dstPtr[greenOffset] - minVal ) * scale;
-			dstPtr[blueOffset] = ( dstPtr[blueOffset] - minVal ) * scale;
-
-			dstPtr += pixelInc;
+	const float scale = 1.0f / ( maxVal - minVal );
+	const int8_t pixelInc = surface->getPixelInc();
+	const uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
+	TaskPool::get()->parallelFor( 0, surface->getHeight(), [&]( size_t first, size_t last ) {
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			float *dstPtr = surface->getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < surface->getWidth(); ++x ) {
+				dstPtr[redOffset] = ( dstPtr[redOffset] - minVal ) * scale;
+				dstPtr[greenOffset] = ( dstPtr[greenOffset] - minVal ) * scale;
+				dstPtr[blueOffset] = ( dstPtr[blueOffset] - minVal ) * scale;
+
+				dstPtr += pixelInc;
+			}
 		}
-	}	
+	} );
 }
 
 void hdrNormalize( Channel32f *channel )
 {
-	// first take histogram to find the minimum and maximum values present
-	float minVal, maxVal;
+	// first find the minimum and maximum values present
+	float minVal = 0, maxVal = 0;
 	getMinMax( *channel, &minVal, &maxVal );
 
 	// if min==max then we should just fill with black
@@ -80,27 +275,83 @@ void hdrNormalize( Channel32f *channel )
 		return;
 	}
 	
-	float scale = 1.0f / ( maxVal - minVal );
-	Channel32f::Iter iter = channel->getIter();
-	while( iter.line() ) {
-		while( iter.pixel() ) {
-			iter.v() = ( iter.v() - minVal ) * scale;
+	const float scale = 1.0f / ( maxVal - minVal );
+	const int8_t inc = channel->getIncrement();
+	TaskPool::get()->parallelFor( 0, channel->getHeight(), [&]( size_t first, size_t last ) {
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			float *dstPtr = channel->getData( 0, y );
+			for( int32_t x = 0; x < channel->getWidth(); ++x, dstPtr += inc )
+				*dstPtr = ( *dstPtr - minVal ) * scale;
 		}
-	}
+	} );
 }
 
 void getMinMax( const Channel32f &channel, float *resultMin, float *resultMax )
 {
-	float minVal = *(channel.getData( Vec2i::zero() )), maxVal = *(channel.getData( Vec2i::zero() ));
-	Channel32f::ConstIter iter = channel.getIter();
-	while( iter.line() ) {
-		while( iter.pixel() ) {
-			minVal = std::min( minVal, iter.v() );
-			maxVal = std::max( maxVal, iter.v() );
+	getMinMax( channel, channel.getBounds(), resultMin, resultMax );
+}
+
+float getLogAverageLuminance( const Surface32f &surface )
+{
+	if( surface.getWidth() <= 0 || surface.getHeight() <= 0 )
+		return 0;
+
+	const uint8_t pixelInc = surface.getPixelInc();
+	const uint8_t redOffset = surface.getRedOffset(), greenOffset = surface.getGreenOffset(), blueOffset = surface.getBlueOffset();
+	double sum = 0;
+	std::mutex sumMutex;
+	TaskPool::get()->parallelFor( 0, surface.getHeight(), [&]( size_t first, size_t last ) {
+		double bandSum = 0;
+		for( int32_t y = (int32_t)first; y < (int32_t)last; ++y ) {
+			const float *src = surface.getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < surface.getWidth(); ++x, src += pixelInc ) {
+				const float lum = std::max( 0.0f, 0.2126f * src[redOffset] + 0.7152f * src[greenOffset] + 0.0722f * src[blueOffset] );
+				bandSum += math<float>::log( 0.0001f + lum );
+			}
 		}
-	}
-	*resultMin = minVal;
-	*resultMax = maxVal;
+		std::lock_guard<std::mutex> lock( sumMutex );
+		sum += bandSum;
+	} );
+
+	return math<float>::exp( (float)( sum / ( (double)surface.getWidth() * surface.getHeight() ) ) );
+}
+
+void toneMap( const Surface32f &srcSurface, Surface8u *dstSurface, const ToneMap &params )
+{
+	const ToneMapper mapper( params, getExposureScale( srcSurface, params ) );
+	const uint8_t srcInc = srcSurface.getPixelInc(), dstInc = dstSurface->getPixelInc();
+	const bool srcAlpha = srcSurface.hasAlpha(), dstAlpha = dstSurface->hasAlpha();
+	const uint8_t srcA = srcAlpha ? srcSurface.getAlphaOffset() : 0, dstA = dstAlpha ? dstSurface->getAlphaOffset() : 0;
+	const uint8_t dstR = dstSurface->getRedOffset(), dstG = dstSurface->getGreenOffset(), dstB = dstSurface->getBlueOffset();
+	toneMapRows( srcSurface, dstSurface, mapper, [&]( const float *src, uint8_t *dst, const float *r, const float *g, const float *b, int32_t width ) {
+		for( int32_t x = 0; x < width; ++x, src += srcInc, dst += dstInc ) {
+			dst[dstR] = static_cast<uint8_t>( mapper.encode( r[x] ) * 255 + 0.5f );
+			dst[dstG] = static_cast<uint8_t>( mapper.encode( g[x] ) * 255 + 0.5f );
+			dst[dstB] = static_cast<uint8_t>( mapper.encode( b[x] ) * 255 + 0.5f );
+			if( dstAlpha )
+				dst[dstA] = srcAlpha ? static_cast<uint8_t>( constrain( src[srcA], 0.0f, 1.0f ) * 255 + 0.5f ) : 255;
+		}
+	} );
+}
+
+void toneMap( const Surface32f &srcSurface, Surface32f *dstSurface, const ToneMap &params )
+{
+	const ToneMapper mapper( params, getExposureScale( srcSurface, params ) );
+	const uint8_t srcInc = srcSurface.getPixelInc(), dstInc = dstSurface->getPixelInc();
+	const bool srcAlpha = srcSurface.hasAlpha(), dstAlpha = dstSurface->hasAlpha();
+	const uint8_t srcA = srcAlpha ? srcSurface.getAlphaOffset() : 0, dstA = dstAlpha ? dstSurface->getAlphaOffset() : 0;
+	const uint8_t dstR = dstSurface->getRedOffset(), dstG = dstSurface->getGreenOffset(), dstB = dstSurface->getBlueOffset();
+	// in place each row's colors have been gathered by the time it is written, and alpha is read before it is written
+	toneMapRows( srcSurface, dstSurface, mapper, [&]( const float *src, float *dst, const float *r, const float *g, const float *b, int32_t width ) {
+		for( int32_t x = 0; x < width; ++x, src += srcInc, dst += dstInc ) {
+			const float alpha = srcAlpha ? src[srcA] : 1.0f;
+			dst[dstR] = mapper.encode( r[x] );
+			dst[dstG] = mapper.encode( g[x] );
+			dst[dstB] = mapper.encode( b[x] );
+			if( dstAlpha )
+				dst[dstA] = alpha;
+		}
+	} );
 }
 
 } } // namespace cinder::ip
@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/IntegralImage.h"
+
+namespace cinder { namespace ip {
+
+template<typename T, typename SUMT>
+IntegralImageT<T,SUMT>::IntegralImageT( const ChannelT<T> &channel )
+{
+	update( channel );
+}
+
+template<typename T, typename SUMT>
+IntegralImageT<T,SUMT>::IntegralImageT( const SurfaceT<T> &surface )
+{
+	update( surface );
+}
+
+template<typename T, typename SUMT>
+void IntegralImageT<T,SUMT>::allocate( int32_t width, int32_t height, uint8_t numChannels )
+{
+	if( mObj && mObj->mWidth == width && mObj->mHeight == height && mObj->mNumChannels == numChannels )
+		return;
+
+	mObj = std::shared_ptr<Obj>( new Obj );
+	mObj->mWidth = width;
+	mObj->mHeight = height;
+	mObj->mNumChannels = numChannels;
+	mObj->mData.resize( numChannels );
+	for( uint8_t c = 0; c < numChannels; ++c )
+		mObj->mData[c].resize( ( width + 1 ) * ( height + 1 ) );
+}
+
+template<typename T, typename SUMT>
+void IntegralImageT<T,SUMT>::update( const ChannelT<T> &channel )
+{
+	allocate( channel.getWidth(), channel.getHeight(), 1 );
+	calculate( channel, 0 );
+}
+
+template<typename T, typename SUMT>
+void IntegralImageT<T,SUMT>::update( const SurfaceT<T> &surface )
+{
+	allocate( surface.getWidth(), surface.getHeight(), surface.hasAlpha() ? 4 : 3 );
+	calculate( surface.getChannelRed(), 0 );
+	calculate( surface.getChannelGreen(), 1 );
+	calculate( surface.getChannelBlue(), 2 );
+	if( surface.hasAlpha() )
+		calculate( surface.getChannelAlpha(), 3 );
+}
+
+template<typename T, typename SUMT>
+void IntegralImageT<T,SUMT>::calculate( const ChannelT<T> &channel, uint8_t table )
+{
+	const int32_t width = mObj->mWidth, height = mObj->mHeight, stride = width + 1;
+	const int8_t inc = channel.getIncrement();
+	SUMT *data = &mObj->mData[table][0];
+
+	// the first row and column stay zero so that every rectangle sum is four lookups without bounds checks
+	std::fill( data, data + stride, SUMT( 0 ) );
+	for( int32_t y = 0; y < height; ++y ) {
+		const T *src = channel.getData( 0, y );
+		const SUMT *above = data + y * stride;
+		SUMT *row = data + ( y + 1 ) * stride;
+		SUMT rowSum = 0;
+		row[0] = 0;
+		for( int32_t x = 0; x < width; ++x, src += inc ) {
+			rowSum += *src;
+			row[x + 1] = above[x + 1] + rowSum;
+		}
+	}
+}
+
+template<typename T, typename SUMT>
+SUMT IntegralImageT<T,SUMT>::getSum( const Area &area, uint8_t channel ) const
+{
+	const Area clipped = area.getClipBy( getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return 0;
+
+	const SUMT *data = &mObj->mData[channel][0];
+	const int32_t stride = mObj->mWidth + 1;
+	return data[clipped.y2 * stride + clipped.x2] - data[clipped.y1 * stride + clipped.x2] - data[clipped.y2 * stride + clipped.x1] + data[clipped.y1 * stride + clipped.x1];
+}
+
+template class IntegralImageT<uint8_t>;
+template class IntegralImageT<uint8_t,uint64_t>;
+template class IntegralImageT<float>;
+template class IntegralImageT<float,double>;
+
+} } // namespace cinder::ip
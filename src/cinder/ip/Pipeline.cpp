@@ -0,0 +1,217 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Pipeline.h"
+#include "cinder/ip/Fill.h"
+#include "cinder/ip/Flip.h"
+#include "cinder/ip/Grayscale.h"
+#include "cinder/ip/Premultiply.h"
+#include "cinder/ip/Threshold.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+#include <boost/preprocessor/seq.hpp>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+template<typename T>
+PipelineT<T>::PipelineT()
+	: mFlip( false ), mPremultiplied( boost::logic::indeterminate ), mTileBytes( 256 * 1024 )
+{
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::grayscale()
+{
+	mOps.push_back( []( SurfaceT<T> *tile, const Area & ) { ip::grayscale( *tile, tile ); } );
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::threshold( T value )
+{
+	mOps.push_back( [value]( SurfaceT<T> *tile, const Area & ) { ip::threshold( tile, value ); } );
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::premultiply()
+{
+	mOps.push_back( []( SurfaceT<T> *tile, const Area & ) { ip::premultiply( tile ); } );
+	mPremultiplied = true;
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::unpremultiply()
+{
+	mOps.push_back( []( SurfaceT<T> *tile, const Area & ) { ip::unpremultiply( tile ); } );
+	mPremultiplied = false;
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::fill( const ColorAT<T> &color, const Area &area )
+{
+	mOps.push_back( [color, area]( SurfaceT<T> *tile, const Area &tileArea ) {
+		Area tileFill = area.getClipBy( tileArea );
+		if( tileFill.getWidth() > 0 && tileFill.getHeight() > 0 )
+			ip::fill( tile, color, tileFill - tileArea.getUL() );
+	} );
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::fill( const ColorAT<T> &color )
+{
+	mOps.push_back( [color]( SurfaceT<T> *tile, const Area & ) { ip::fill( tile, color ); } );
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::flipVertical()
+{
+	mFlip = ! mFlip;
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::custom( const TileFn &fn )
+{
+	mOps.push_back( fn );
+	return *this;
+}
+
+template<typename T>
+PipelineT<T>& PipelineT<T>::tileBytes( size_t bytes )
+{
+	mTileBytes = bytes;
+	return *this;
+}
+
+template<typename T>
+void PipelineT<T>::forEachTile( int32_t height, size_t rowBytes, const function<void ( int32_t, int32_t )> &tileFn ) const
+{
+	const int32_t tileRows = (int32_t)max<size_t>( 1, mTileBytes / max<size_t>( 1, rowBytes ) );
+	const int32_t numTiles = ( height + tileRows - 1 ) / tileRows;
+	TaskPool::get()->parallelFor( 0, numTiles, [&]( size_t firstTile, size_t lastTile ) {
+		for( size_t t = firstTile; t < lastTile; ++t )
+			tileFn( (int32_t)t * tileRows, min<int32_t>( height, ( (int32_t)t + 1 ) * tileRows ) );
+	}, 1 );
+}
+
+template<typename T>
+void PipelineT<T>::runOps( SurfaceT<T> *tile, const Area &tileArea ) const
+{
+	for( size_t i = 0; i < mOps.size(); ++i )
+		mOps[i]( tile, tileArea );
+}
+
+template<typename T>
+void PipelineT<T>::apply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ) const
+{
+	// flipped rows are read from other tiles, which may already have been written when applying in place
+	if( srcSurface.getData() == dstSurface->getData() ) {
+		apply( dstSurface );
+		return;
+	}
+
+	const Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	const int32_t width = area.getWidth(), height = area.getHeight();
+	if( width <= 0 || height <= 0 )
+		return;
+
+	dstSurface->setPremultiplied( srcSurface.isPremultiplied() );
+	// each tile is copied into the destination, converting the channel order if needed, and then processed in place while it is in cache
+	forEachTile( height, width * dstSurface->getPixelInc() * sizeof(T), [&]( int32_t first, int32_t last ) {
+		for( int32_t y = first; y < last; ++y ) {
+			const int32_t srcY = mFlip ? ( height - 1 - y ) : y;
+			dstSurface->copyFrom( srcSurface, Area( 0, srcY, width, srcY + 1 ), Vec2i( 0, y - srcY ) );
+		}
+		const Area tileArea( 0, first, width, last );
+		SurfaceViewT<T> tile( *dstSurface, tileArea );
+		runOps( &tile, tileArea );
+	} );
+
+	if( dstSurface->hasAlpha() && ! boost::logic::indeterminate( mPremultiplied ) )
+		dstSurface->setPremultiplied( (bool)mPremultiplied );
+}
+
+template<typename T>
+void PipelineT<T>::apply( SurfaceT<T> *surface ) const
+{
+	const int32_t width = surface->getWidth(), height = surface->getHeight();
+	if( width <= 0 || height <= 0 )
+		return;
+
+	// tiles can't read rows which another tile writes, so in place the flip is a separate pass
+	if( mFlip )
+		ip::flipVertical( surface );
+
+	forEachTile( height, width * surface->getPixelInc() * sizeof(T), [&]( int32_t first, int32_t last ) {
+		const Area tileArea( 0, first, width, last );
+		SurfaceViewT<T> tile( *surface, tileArea );
+		runOps( &tile, tileArea );
+	} );
+
+	if( surface->hasAlpha() && ! boost::logic::indeterminate( mPremultiplied ) )
+		surface->setPremultiplied( (bool)mPremultiplied );
+}
+
+template<typename T>
+void PipelineT<T>::apply( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel ) const
+{
+	const Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
+	const int32_t width = area.getWidth(), height = area.getHeight();
+	if( width <= 0 || height <= 0 )
+		return;
+
+	// the operations need every color channel, so each tile is gathered into a Surface in the source's layout before its red channel is stored
+	forEachTile( height, width * srcSurface.getPixelInc() * sizeof(T), [&]( int32_t first, int32_t last ) {
+		SurfaceT<T> tile( width, last - first, srcSurface.hasAlpha(), srcSurface.getChannelOrder() );
+		tile.setPremultiplied( srcSurface.isPremultiplied() );
+		for( int32_t y = first; y < last; ++y ) {
+			const int32_t srcY = mFlip ? ( height - 1 - y ) : y;
+			tile.copyFrom( srcSurface, Area( 0, srcY, width, srcY + 1 ), Vec2i( 0, y - first - srcY ) );
+		}
+		runOps( &tile, Area( 0, first, width, last ) );
+
+		const uint8_t tileInc = tile.getPixelInc();
+		const int8_t dstInc = dstChannel->getIncrement();
+		for( int32_t y = first; y < last; ++y ) {
+			const T *src = tile.getDataRed( Vec2i( 0, y - first ) );
+			T *dst = dstChannel->getData( 0, y );
+			for( int32_t x = 0; x < width; ++x, src += tileInc, dst += dstInc )
+				*dst = *src;
+		}
+	} );
+}
+
+#define pipeline_PROTOTYPES(r,data,T)\
+	template class PipelineT<T>;
+
+BOOST_PP_SEQ_FOR_EACH( pipeline_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -22,13 +22,169 @@
 
 #include "cinder/ip/Premultiply.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 
 #include <boost/preprocessor/seq.hpp>
 #include <algorithm>
 
 namespace cinder { namespace ip {
 
-// this is a candidate for sse2
+namespace {
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+// exact floor( x / 255 ) for 16-bit lanes in [0, 255 * 255]
+inline __m128i div255_epu16( __m128i x )
+{
+	return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( x, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( x, 8 ) ), 8 );
+}
+
+// 16-bit lanes of 4-channel pixels which hold channel ALPHA
+template<int ALPHA>
+inline __m128i alphaLanes_epi16()
+{
+	return _mm_set_epi16( ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0,
+						ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0 );
+}
+
+// multiplies two pixels unpacked to 16-bit lanes by their own alpha; the alpha lane is scaled by 255 so it is unchanged
+template<int ALPHA>
+inline __m128i premultiply2_epu16( __m128i px )
+{
+	const __m128i alphaLanes = alphaLanes_epi16<ALPHA>();
+	__m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( px, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+	alpha = _mm_or_si128( _mm_andnot_si128( alphaLanes, alpha ), _mm_and_si128( alphaLanes, _mm_set1_epi16( 255 ) ) );
+	return div255_epu16( _mm_mullo_epi16( px, alpha ) );
+}
+
+template<int ALPHA>
+int32_t premultiplyRowSse2( uint8_t *dstPtr, int32_t width )
+{
+	const __m128i zero = _mm_setzero_si128();
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, dstPtr += 16 ) {
+		__m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dstPtr ) );
+		__m128i lo = premultiply2_epu16<ALPHA>( _mm_unpacklo_epi8( px, zero ) );
+		__m128i hi = premultiply2_epu16<ALPHA>( _mm_unpackhi_epi8( px, zero ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dstPtr ), _mm_packus_epi16( lo, hi ) );
+	}
+	return x;
+}
+
+template<int ALPHA>
+int32_t premultiplyRowSse2( float *dstPtr, int32_t width )
+{
+	const __m128 alphaLane = _mm_castsi128_ps( _mm_set_epi32( ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0 ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	for( int32_t x = 0; x < width; ++x, dstPtr += 4 ) {
+		__m128 px = _mm_loadu_ps( dstPtr );
+		__m128 alpha = _mm_shuffle_ps( px, px, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		alpha = _mm_or_ps( _mm_andnot_ps( alphaLane, alpha ), _mm_and_ps( alphaLane, one ) );
+		_mm_storeu_ps( dstPtr, _mm_mul_ps( px, alpha ) );
+	}
+	return width;
+}
+
+template<int ALPHA>
+int32_t unpremultiplyRowSse2( float *dstPtr, int32_t width )
+{
+	const __m128 alphaLane = _mm_castsi128_ps( _mm_set_epi32( ALPHA == 3 ? -1 : 0, ALPHA == 2 ? -1 : 0, ALPHA == 1 ? -1 : 0, ALPHA == 0 ? -1 : 0 ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+	for( int32_t x = 0; x < width; ++x, dstPtr += 4 ) {
+		__m128 px = _mm_loadu_ps( dstPtr );
+		__m128 alpha = _mm_shuffle_ps( px, px, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		__m128 invAlpha = _mm_div_ps( one, alpha );
+		invAlpha = _mm_or_ps( _mm_andnot_ps( alphaLane, invAlpha ), _mm_and_ps( alphaLane, one ) );
+		// pixels with zero alpha are left untouched
+		__m128 nonZero = _mm_cmpneq_ps( alpha, zero );
+		px = _mm_or_ps( _mm_and_ps( nonZero, _mm_mul_ps( px, invAlpha ) ), _mm_andnot_ps( nonZero, px ) );
+		_mm_storeu_ps( dstPtr, px );
+	}
+	return width;
+}
+#endif // defined( CINDER_SSE2 )
+
+#if defined( CINDER_NEON )
+// exact floor( x / 255 ) for 16-bit lanes in [0, 255 * 255], narrowed to 8 bits
+inline uint8x8_t div255_u16( uint16x8_t x )
+{
+	return vshrn_n_u16( vaddq_u16( vsraq_n_u16( x, x, 8 ), vdupq_n_u16( 1 ) ), 8 );
+}
+
+template<int ALPHA>
+int32_t premultiplyRowNeon( uint8_t *dstPtr, int32_t width )
+{
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8, dstPtr += 32 ) {
+		uint8x8x4_t px = vld4_u8( dstPtr );
+		const uint8x8_t alpha = px.val[ALPHA];
+		for( int c = 0; c < 4; ++c ) {
+			if( c != ALPHA )
+				px.val[c] = div255_u16( vmull_u8( px.val[c], alpha ) );
+		}
+		vst4_u8( dstPtr, px );
+	}
+	return x;
+}
+#endif // defined( CINDER_NEON )
+
+// Processes as much of a row of 4-channel pixels as the SIMD paths can, returning the number of pixels handled
+int32_t premultiplyRowSimd( uint8_t *dstPtr, int32_t width, uint8_t alphaOffset )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return ( alphaOffset == 0 ) ? premultiplyRowSse2<0>( dstPtr, width ) : premultiplyRowSse2<3>( dstPtr, width );
+#elif defined( CINDER_NEON )
+	return ( alphaOffset == 0 ) ? premultiplyRowNeon<0>( dstPtr, width ) : premultiplyRowNeon<3>( dstPtr, width );
+#endif
+	return 0;
+}
+
+int32_t premultiplyRowSimd( float *dstPtr, int32_t width, uint8_t alphaOffset )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return ( alphaOffset == 0 ) ? premultiplyRowSse2<0>( dstPtr, width ) : premultiplyRowSse2<3>( dstPtr, width );
+#endif
+	return 0;
+}
+
+int32_t unpremultiplyRowSimd( float *dstPtr, int32_t width, uint8_t alphaOffset )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return ( alphaOffset == 0 ) ? unpremultiplyRowSse2<0>( dstPtr, width ) : unpremultiplyRowSse2<3>( dstPtr, width );
+#endif
+	return 0;
+}
+
+// Replaces the per-pixel integer divide of 8 bit unpremultiplication with a lookup of min( c * 255 / alpha, 255 )
+struct UnpremultiplyTable {
+	UnpremultiplyTable()
+	{
+		for( int a = 0; a < 256; ++a )
+			for( int c = 0; c < 256; ++c )
+				mTable[a][c] = ( a == 0 ) ? c : static_cast<uint8_t>( std::min<int>( c * 255 / a, 255 ) );
+	}
+
+	uint8_t	mTable[256][256];
+};
+
+const UnpremultiplyTable& getUnpremultiplyTable()
+{
+	static UnpremultiplyTable sTable;
+	return sTable;
+}
+
+} // anonymous namespace
+
 template<typename T>
 void premultiply( SurfaceT<T> *surface )
 {
@@ -44,7 +200,12 @@ void premultiply( SurfaceT<T> *surface )
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
 		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
+		int32_t x = 0;
+		if( pixelInc == 4 ) {
+			x = premultiplyRowSimd( dstPtr, clippedArea.getWidth(), alphaOffset );
+			dstPtr += x * pixelInc;
+		}
+		for( ; x < clippedArea.getWidth(); ++x ) {
 			// The basic formula for unpremultiplication is to divide by the alpha
 			T alpha = dstPtr[alphaOffset];
 			
@@ -56,7 +217,6 @@ void premultiply( SurfaceT<T> *surface )
 	}
 }
 
-// this is a candidate for sse2
 template<>
 void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
 {
@@ -70,17 +230,16 @@ void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
 	int32_t rowBytes = surface->getRowBytes();
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
+	const UnpremultiplyTable &table = getUnpremultiplyTable();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
 		uint8_t *dstPtr = reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes;
 		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
 			// The basic formula for unpremultiplication is to divide by the alpha
 			// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
-			uint8_t alpha = dstPtr[alphaOffset];
-			if( alpha ) {
-				dstPtr[redOffset] = std::min<int>( dstPtr[redOffset] * 255 / alpha, 255 );
-				dstPtr[greenOffset] = std::min<int>( dstPtr[greenOffset] * 255 / alpha, 255 );
-				dstPtr[blueOffset] = std::min<int>( dstPtr[blueOffset] * 255 / alpha, 255 );
-			}
+			const uint8_t *row = table.mTable[dstPtr[alphaOffset]];
+			dstPtr[redOffset] = row[dstPtr[redOffset]];
+			dstPtr[greenOffset] = row[dstPtr[greenOffset]];
+			dstPtr[blueOffset] = row[dstPtr[blueOffset]];
 			dstPtr += pixelInc;
 		}
 	}	
@@ -101,7 +260,12 @@ void unpremultiply<float>( SurfaceT<float> *surface )
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
 		float *dstPtr = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
+		int32_t x = 0;
+		if( pixelInc == 4 ) {
+			x = unpremultiplyRowSimd( dstPtr, clippedArea.getWidth(), alphaOffset );
+			dstPtr += x * pixelInc;
+		}
+		for( ; x < clippedArea.getWidth(); ++x ) {
 			// The basic formula for unpremultiplication is to divide by the alpha
 			if( dstPtr[alphaOffset] != 0 ) {
 				float invAlpha = 1.0f / dstPtr[alphaOffset];
@@ -25,6 +25,10 @@
 #include "cinder/Filter.h"
 #include "cinder/Rect.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
+#include "cinder/Thread.h"
+#include "cinder/TiledSurface.h"
 
 #include <math.h>
 #include <vector>
@@ -70,6 +74,17 @@ struct SCALETRAIT<float> {
 
 const float SCALETRAIT<float>::WEIGHTONE = 1.0f;
 
+// 16-bit samples would overflow the fixed point weights of the 8-bit path, so they are filtered in float and rounded back
+template<>
+struct SCALETRAIT<uint16_t> {
+	typedef float SUMT;
+	static const float WEIGHTONE;		// filter weight of one
+	static uint16_t ACCUMTOCHANNEL( const float in ) { return static_cast<uint16_t>( constrain( in + 0.5f, 0.0f, 65535.0f ) ); }
+	static float CHANNELTOBUFFER( const float in ) { return in; }
+};
+
+const float SCALETRAIT<uint16_t>::WEIGHTONE = 1.0f;
+
 // the mapping from discrete dest coordinates b to continuous source coordinates:
 #define MAP(b, scale, offset)  (((b)+(offset))/(scale))
 
@@ -140,82 +155,151 @@ void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t
 	}	
 }
 
-// assumes channels are of same dimensions
+// Filter state shared by every band of a resample; the per-column weights are computed once and only read afterwards
+template<typename T>
+struct ResampleContext {
+	typedef typename SCALETRAIT<T>::SUMT	SUMT;
+
+	const vector<const ChannelT<T>*>	*srcChannels;
+	const vector<ChannelT<T>*>			*dstChannels;
+	const FilterBase					*filter;
+	FilterParams						filterParamsX, filterParamsY;
+	Mapping								m;
+	Area								clippedDstArea;
+	int32_t								dstWidth, dstHeight, srcWidth, srcHeight, srcOffsetX, srcOffsetY;
+	vector<WeightTable<SUMT> >			xWeights;
+	vector<SUMT>						xWeightBuffer;
+};
+
+// resamples the destination scanlines [dstYBegin, dstYEnd) of every channel; each band owns its own line cache and accumulator
+template<typename T>
+void resampleBand( const ResampleContext<T> &ctx, int32_t dstYBegin, int32_t dstYEnd )
+{
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+
+	const int32_t dstWidth = ctx.dstWidth;
+	vector<pair<int32_t,std::shared_ptr<SUMT> > > linesBuffer;
+	for( int32_t i = 0; i < ctx.filterParamsY.width; i++ )
+		linesBuffer.push_back( std::make_pair( -1, std::shared_ptr<SUMT>( new SUMT[dstWidth], checked_array_deleter<SUMT>() ) ) );
+
+	WeightTable<SUMT> yWeights;
+	vector<SUMT> yWeightBuffer( ctx.filterParamsY.width );
+	yWeights.weight = &yWeightBuffer[0];
+	vector<SUMT> accum( dstWidth );
+	// the weight tables are read-only from here on, but scanlineFilterChannelToBuffer() takes them by non-const pointer
+	WeightTable<SUMT> *xWeights = const_cast<WeightTable<SUMT>*>( &ctx.xWeights[0] );
+
+	for( size_t chan = 0; chan < ctx.srcChannels->size(); ++chan ) {
+		for( size_t l = 0; l < linesBuffer.size(); ++l )
+			linesBuffer[l].first = -1;
+
+		for ( int32_t dstY = dstYBegin; dstY < dstYEnd; ++dstY ) {     // loop over dest scanlines
+			// prepare a weight table for dest y position by
+			makeWeightTable<T,SUMT>( dstY, MAP(dstY, ctx.m.sy, ctx.m.uy), *ctx.filter, &ctx.filterParamsY, ctx.srcHeight, false, &yWeights );
+
+			memset( &accum[0], 0, sizeof(SUMT) * dstWidth );
+
+			// loop over source scanlines that influence this dest scanline
+			for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
+				SUMT *line = linesBuffer[ayf % ctx.filterParamsY.width].second.get();
+				if( linesBuffer[ayf % ctx.filterParamsY.width].first != ayf ) {
+					scanlineFilterChannelToBuffer( xWeights, ctx.srcOffsetX, ctx.srcOffsetY + ayf, *((*ctx.srcChannels)[chan]), line, dstWidth );
+					linesBuffer[ayf % ctx.filterParamsY.width].first = ayf;
+				}
+				scanlineAccumulate<SUMT,SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, &accum[0] );
+			}
+
+			scanlineShiftAccumToChannel( &accum[0], ctx.clippedDstArea.getX1(), ctx.clippedDstArea.getY1() + dstY, dstWidth, (*ctx.dstChannels)[chan] );
+		}
+	}
+}
+
+// assumes channels are of same dimensions. A \a numThreads of 1 resamples on the calling thread, 0 uses one thread per core.
+// The filter reads only the pixels of \a srcRect, rounded to whole pixels, unless \a sampleWholeSource, where it reads any pixel of the source channels and \a srcRect keeps its fractional position.
 template<typename T>
-void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Area &srcArea, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels )
+void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Rectf &srcRect, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels, int numThreads = 1, bool sampleWholeSource = false )
 {
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+
 	Rectf clippedSrcRect;
-	Area clippedDstArea;
-	getClippedScaledRects( srcChannels[0]->getBounds(), Rectf( srcArea ), dstChannels[0]->getBounds(), dstArea, &clippedSrcRect, &clippedDstArea );
+	ResampleContext<T> ctx;
+	getClippedScaledRects( srcChannels[0]->getBounds(), srcRect, dstChannels[0]->getBounds(), dstArea, &clippedSrcRect, &ctx.clippedDstArea );
+	const Area &clippedDstArea = ctx.clippedDstArea;
 	
 	if ( ( clippedSrcRect.getWidth() <= 0 ) || ( clippedDstArea.getWidth() <= 0 ) 
 		|| ( clippedSrcRect.getHeight() <= 0 ) || ( clippedDstArea.getHeight() <= 0 ) )
 		return;
-	
-	FilterParams filterParamsX, filterParamsY;
-	Mapping m;
-	std::shared_ptr<typename SCALETRAIT<T>::SUMT> accum;
-	int32_t dstWidth = (int32_t)clippedDstArea.getWidth(), dstHeight = (int32_t)clippedDstArea.getHeight();
-	int32_t srcWidth = (int32_t)clippedSrcRect.getWidth(), srcHeight = (int32_t)clippedSrcRect.getHeight();
-	int32_t srcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
-	int32_t srcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
-	vector<pair<int32_t,std::shared_ptr<typename SCALETRAIT<T>::SUMT> > > linesBuffer;
-
-	m.sx = dstWidth / (float)srcWidth;
-	m.sy = dstHeight / (float)srcHeight;
+
+	ctx.srcChannels = &srcChannels;
+	ctx.dstChannels = &dstChannels;
+	ctx.filter = &filter;
+	ctx.dstWidth = (int32_t)clippedDstArea.getWidth();
+	ctx.dstHeight = (int32_t)clippedDstArea.getHeight();
+	Mapping &m = ctx.m;
+	if( sampleWholeSource ) {
+		ctx.srcWidth = srcChannels[0]->getWidth();
+		ctx.srcHeight = srcChannels[0]->getHeight();
+		ctx.srcOffsetX = ctx.srcOffsetY = 0;
+		m.sx = ctx.dstWidth / clippedSrcRect.getWidth();
+		m.sy = ctx.dstHeight / clippedSrcRect.getHeight();
+	}
+	else {
+		ctx.srcWidth = (int32_t)clippedSrcRect.getWidth();
+		ctx.srcHeight = (int32_t)clippedSrcRect.getHeight();
+		ctx.srcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
+		ctx.srcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
+		m.sx = ctx.dstWidth / (float)ctx.srcWidth;
+		m.sy = ctx.dstHeight / (float)ctx.srcHeight;
+	}
+
 	m.tx = clippedDstArea.getX1() - 0.5f - m.sx * ( clippedSrcRect.getX1() - 0.5f );
 	m.ty = clippedDstArea.getY1() - 0.5f - m.sy * ( clippedSrcRect.getY1() - 0.5f );
 	m.ux = clippedDstArea.getX1() - m.sx * ( clippedSrcRect.getX1()- 0.5f ) - m.tx;
 	m.uy = clippedDstArea.getY1() - m.sy * ( clippedSrcRect.getY1()- 0.5f ) - m.ty;
-
-	filterParamsX.scale = std::max( 1.0f, 1.0f / m.sx );
-	filterParamsX.supp = std::max( 0.5f, filterParamsX.scale * filter.getSupport() );
-	filterParamsX.width = (int32_t)ceil( 2.0f * filterParamsX.supp );
-
-	filterParamsY.scale = std::max( 1.0f, 1.0f / m.sy );
-	filterParamsY.supp = std::max( 0.5f, filterParamsY.scale * filter.getSupport() );
-	filterParamsY.width = (int32_t)ceil( 2.0f * filterParamsY.supp );
-
-	for( int32_t i = 0; i < filterParamsY.width; i++ )
-		linesBuffer.push_back( std::make_pair( -1, std::shared_ptr<typename SCALETRAIT<T>::SUMT>( new typename SCALETRAIT<T>::SUMT[dstWidth], checked_array_deleter<typename SCALETRAIT<T>::SUMT>() ) ) );
-
-	WeightTable<typename SCALETRAIT<T>::SUMT> *xWeights, yWeights;
-	typename SCALETRAIT<T>::SUMT *xWeightBuffer, *xWeightPtr;
-	xWeights = (WeightTable<typename SCALETRAIT<T>::SUMT>*)malloc( sizeof(WeightTable<int32_t>) * dstWidth );
-	xWeightBuffer = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * dstWidth * filterParamsX.width );
-	yWeights.weight = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * filterParamsY.width );
-	accum = std::shared_ptr<typename SCALETRAIT<T>::SUMT>( new typename SCALETRAIT<T>::SUMT[dstWidth], checked_array_deleter<typename SCALETRAIT<T>::SUMT>() );
-
-	xWeightPtr = xWeightBuffer;
-	for ( int32_t bx = 0; bx < dstWidth; bx++, xWeightPtr += filterParamsX.width ) {
-		xWeights[bx].weight = xWeightPtr;
-		makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &filterParamsX, srcWidth, true, &xWeights[bx] );
+	if( sampleWholeSource ) {
+		// MAP() is relative to the first sampled pixel, which is now the source's rather than srcRect's
+		m.ux += m.sx * clippedSrcRect.getX1();
+		m.uy += m.sy * clippedSrcRect.getY1();
 	}
 
-	for( size_t chan = 0; chan < srcChannels.size(); ++chan ) {
-		for ( int32_t dstY = 0; dstY < dstHeight; ++dstY ) {     // loop over dest scanlines
-			// prepare a weight table for dest y position by
-			makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( dstY, MAP(dstY, m.sy, m.uy), filter, &filterParamsY, srcHeight, false, &yWeights );
+	ctx.filterParamsX.scale = std::max( 1.0f, 1.0f / m.sx );
+	ctx.filterParamsX.supp = std::max( 0.5f, ctx.filterParamsX.scale * filter.getSupport() );
+	ctx.filterParamsX.width = (int32_t)ceil( 2.0f * ctx.filterParamsX.supp );
+
+	ctx.filterParamsY.scale = std::max( 1.0f, 1.0f / m.sy );
+	ctx.filterParamsY.supp = std::max( 0.5f, ctx.filterParamsY.scale * filter.getSupport() );
+	ctx.filterParamsY.width = (int32_t)ceil( 2.0f * ctx.filterParamsY.supp );
+
+	// the horizontal weights only depend on the dest column, so they are built once and shared by every band
+	ctx.xWeights.resize( ctx.dstWidth );
+	ctx.xWeightBuffer.resize( ctx.dstWidth * ctx.filterParamsX.width );
+	SUMT *xWeightPtr = &ctx.xWeightBuffer[0];
+	for ( int32_t bx = 0; bx < ctx.dstWidth; bx++, xWeightPtr += ctx.filterParamsX.width ) {
+		ctx.xWeights[bx].weight = xWeightPtr;
+		makeWeightTable<T,SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &ctx.filterParamsX, ctx.srcWidth, true, &ctx.xWeights[bx] );
+	}
 
-			memset( accum.get(), 0, sizeof(int32_t) * dstWidth );
+	if( numThreads <= 0 )
+		numThreads = System::getNumCores();
+	// bands narrower than the vertical filter would spend most of their time refilling the line cache
+	numThreads = std::min( numThreads, std::max( 1, ctx.dstHeight / std::max<int32_t>( 1, ctx.filterParamsY.width * 2 ) ) );
 
-			// loop over source scanlines that influence this dest scanline
-			for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
-				typename SCALETRAIT<T>::SUMT *line = linesBuffer[ayf % filterParamsY.width].second.get();
-				if( linesBuffer[ayf % filterParamsY.width].first != ayf ) {
-					scanlineFilterChannelToBuffer( xWeights, srcOffsetX, srcOffsetY + ayf, *(srcChannels[chan]), line, dstWidth );
-					linesBuffer[ayf % filterParamsY.width].first = ayf;
-				}
-				scanlineAccumulate<typename SCALETRAIT<T>::SUMT,typename SCALETRAIT<T>::SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, accum.get() );
-			}
+	if( numThreads <= 1 ) {
+		resampleBand( ctx, 0, ctx.dstHeight );
+		return;
+	}
 
-			scanlineShiftAccumToChannel( accum.get(), clippedDstArea.getX1(), clippedDstArea.getY1() + dstY, dstWidth, dstChannels[chan] );
-		}
+	vector<std::shared_ptr<std::thread> > threads;
+	for( int band = 1; band < numThreads; ++band ) {
+		int32_t bandBegin = (int32_t)( (int64_t)ctx.dstHeight * band / numThreads );
+		int32_t bandEnd = (int32_t)( (int64_t)ctx.dstHeight * ( band + 1 ) / numThreads );
+		threads.push_back( std::shared_ptr<std::thread>( new std::thread( std::bind( &resampleBand<T>, std::cref( ctx ), bandBegin, bandEnd ) ) ) );
 	}
+	// the calling thread takes the first band itself
+	resampleBand( ctx, 0, (int32_t)( ctx.dstHeight / numThreads ) );
 
-	free( xWeights );
-	free( xWeightBuffer );
-	free( yWeights.weight );
+	for( size_t t = 0; t < threads.size(); ++t )
+		threads[t]->join();
 }
 
 template<typename LT, typename AT>
@@ -308,8 +392,10 @@ void makeWeightTable( int32_t b, float cen, const FilterBase &filter, const Filt
 	}   
 }
 
+namespace {
+
 template<typename T>
-void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+void resizeImpl( const SurfaceT<T> &srcSurface, const Rectf &srcRect, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, int numThreads, bool sampleWholeSource = false )
 {
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
@@ -325,11 +411,11 @@ void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *ds
 		dstChannels.push_back( &dstSurface->getChannelAlpha() );	
 	}
 
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	resample( srcChannels, filter, srcRect, dstArea, dstChannels, numThreads, sampleWholeSource );
 }
 
 template<typename T>
-void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter )
+void resizeImpl( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, int numThreads )
 {
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
@@ -337,7 +423,61 @@ void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *ds
 	srcChannels.push_back( &srcChannel );
 	dstChannels.push_back( dstChannel );
 	
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	resample( srcChannels, filter, Rectf( srcArea ), dstArea, dstChannels, numThreads );
+}
+
+// Resizes \a srcArea of an image with bounds \a srcBounds into \a dstArea of one with bounds \a dstBounds, a destination tile at a time and in parallel,
+// so that neither image is resampled, or has to be in memory, as a whole. Each tile is split into pieces whose source window stays around MAX_WINDOW_SIZE
+// pixels on a side. readFn( area ) returns a Surface holding the source pixels of area, and tileFn( tileArea ) returns the Surface holding the destination
+// pixels of tileArea along with the position of its upper left corner in the destination.
+template<typename T, typename READFN, typename TILEFN>
+void resizeTiled( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, int32_t tileSize, const FilterBase &filter, const READFN &readFn, const TILEFN &tileFn )
+{
+	const int32_t MAX_WINDOW_SIZE = 2048;
+
+	Rectf srcRect;
+	Area clippedDstArea;
+	getClippedScaledRects( srcBounds, Rectf( srcArea ), dstBounds, dstArea, &srcRect, &clippedDstArea );
+	if( ( srcRect.getWidth() <= 0 ) || ( srcRect.getHeight() <= 0 ) || ( clippedDstArea.getWidth() <= 0 ) || ( clippedDstArea.getHeight() <= 0 ) )
+		return;
+
+	// like resize(), the filter doesn't read beyond srcArea
+	const Area sampleArea = srcArea.getClipBy( srcBounds );
+	const float scaleX = srcRect.getWidth() / clippedDstArea.getWidth(), scaleY = srcRect.getHeight() / clippedDstArea.getHeight();
+	const int32_t marginX = (int32_t)ceil( filter.getSupport() * std::max( 1.0f, scaleX ) ) + 1;
+	const int32_t marginY = (int32_t)ceil( filter.getSupport() * std::max( 1.0f, scaleY ) ) + 1;
+	const int32_t pieceWidth = constrain<int32_t>( (int32_t)( MAX_WINDOW_SIZE / scaleX ), 1, tileSize );
+	const int32_t pieceHeight = constrain<int32_t>( (int32_t)( MAX_WINDOW_SIZE / scaleY ), 1, tileSize );
+
+	const Area tiles( clippedDstArea.x1 / tileSize * tileSize, clippedDstArea.y1 / tileSize * tileSize, clippedDstArea.x2, clippedDstArea.y2 );
+	TaskPool::get()->parallelFor( tiles, Vec2i( tileSize, tileSize ), [&]( const Area &tileArea ) {
+		const Area tileDstArea = tileArea.getClipBy( clippedDstArea );
+		std::pair<SurfaceT<T>,Vec2i> tile = tileFn( tileArea );
+		for( int32_t y = tileDstArea.y1; y < tileDstArea.y2; y += pieceHeight ) {
+			for( int32_t x = tileDstArea.x1; x < tileDstArea.x2; x += pieceWidth ) {
+				const Area piece( x, y, std::min( x + pieceWidth, tileDstArea.x2 ), std::min( y + pieceHeight, tileDstArea.y2 ) );
+				const Rectf pieceSrcRect( srcRect.x1 + ( piece.x1 - clippedDstArea.x1 ) * scaleX, srcRect.y1 + ( piece.y1 - clippedDstArea.y1 ) * scaleY,
+										srcRect.x1 + ( piece.x2 - clippedDstArea.x1 ) * scaleX, srcRect.y1 + ( piece.y2 - clippedDstArea.y1 ) * scaleY );
+				const Area window = Area( (int32_t)floor( pieceSrcRect.x1 ) - marginX, (int32_t)floor( pieceSrcRect.y1 ) - marginY,
+										(int32_t)ceil( pieceSrcRect.x2 ) + marginX, (int32_t)ceil( pieceSrcRect.y2 ) + marginY ).getClipBy( sampleArea );
+				resizeImpl( readFn( window ), pieceSrcRect - Vec2f( window.getUL() ), &tile.first, piece - tile.second, filter, 1, true );
+			}
+		}
+	} );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	resizeImpl( srcSurface, Rectf( srcArea ), dstSurface, dstArea, filter, 1 );
+}
+
+template<typename T>
+void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter )
+{
+	resizeImpl( srcChannel, srcArea, dstChannel, dstArea, filter, 1 );
 }
 
 template<typename T>
@@ -360,13 +500,84 @@ void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Filte
 	resize( srcChannel, srcChannel.getBounds(), dstChannel, dstChannel->getBounds(), filter );
 }
 
+template<typename T>
+void resizeParallel( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, int numThreads )
+{
+	resizeImpl( srcSurface, Rectf( srcArea ), dstSurface, dstArea, filter, numThreads );
+}
+
+template<typename T>
+void resizeParallel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter, int numThreads )
+{
+	resizeImpl( srcSurface, Rectf( srcSurface.getBounds() ), dstSurface, dstSurface->getBounds(), filter, numThreads );
+}
+
+template<typename T>
+void resizeParallel( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, int numThreads )
+{
+	resizeImpl( srcChannel, srcArea, dstChannel, dstArea, filter, numThreads );
+}
+
+template<typename T>
+void resizeParallel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter, int numThreads )
+{
+	resizeImpl( srcChannel, srcChannel.getBounds(), dstChannel, dstChannel->getBounds(), filter, numThreads );
+}
+
+template<typename T>
+SurfaceT<T> resizeCopyParallel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter, int numThreads )
+{
+	SurfaceT<T> result( dstSize.x, dstSize.y, srcSurface.hasAlpha(), srcSurface.getChannelOrder() );
+	resizeImpl( srcSurface, Rectf( srcArea ), &result, result.getBounds(), filter, numThreads );
+	return result;
+}
+
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Rectf &srcRect, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	resizeImpl( srcSurface, srcRect, dstSurface, dstArea, filter, 1, true );
+}
+
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, TiledSurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	resizeTiled<T>( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstArea, dstSurface->getTileSize(), filter,
+		[&]( const Area &area ) { return SurfaceViewT<T>( srcSurface, area ); },
+		[&]( const Area &tileArea ) { return std::make_pair( dstSurface->getTile( tileArea.x1 / dstSurface->getTileSize(), tileArea.y1 / dstSurface->getTileSize() ), tileArea.getUL() ); } );
+}
+
+template<typename T>
+void resize( const TiledSurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	resizeTiled<T>( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstArea, srcSurface.getTileSize(), filter,
+		[&]( const Area &area ) { return srcSurface.getSurface( area ); },
+		[&]( const Area &tileArea ) { return std::make_pair( *dstSurface, Vec2i::zero() ); } );
+}
+
+template<typename T>
+void resize( const TiledSurfaceT<T> &srcSurface, const Area &srcArea, TiledSurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	resizeTiled<T>( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstArea, dstSurface->getTileSize(), filter,
+		[&]( const Area &area ) { return srcSurface.getSurface( area ); },
+		[&]( const Area &tileArea ) { return std::make_pair( dstSurface->getTile( tileArea.x1 / dstSurface->getTileSize(), tileArea.y1 / dstSurface->getTileSize() ), tileArea.getUL() ); } );
+}
+
 #define resize_PROTOTYPES(r,data,T)\
 	template void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter ); \
 	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
 	template void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter ); \
 	template SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter ); \
-	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter );
-
-BOOST_PP_SEQ_FOR_EACH( resize_PROTOTYPES, ~, CHANNEL_TYPES )
+	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter ); \
+	template void resizeParallel( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, int numThreads ); \
+	template void resizeParallel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter, int numThreads ); \
+	template void resizeParallel( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, int numThreads ); \
+	template void resizeParallel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter, int numThreads ); \
+	template SurfaceT<T> resizeCopyParallel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter, int numThreads ); \
+	template void resize( const SurfaceT<T> &srcSurface, const Rectf &srcRect, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
+	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, TiledSurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
+	template void resize( const TiledSurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
+	template void resize( const TiledSurfaceT<T> &srcSurface, const Area &srcArea, TiledSurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter );
+
+BOOST_PP_SEQ_FOR_EACH( resize_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
 } } // namespace cinder::ip
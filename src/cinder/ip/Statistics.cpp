@@ -0,0 +1,587 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Statistics.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/TaskPool.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <boost/preprocessor/seq.hpp>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// below this many pixels the cost of dispatching to the TaskPool outweighs the work
+const int32_t PARALLEL_MIN_PIXELS = 1 << 16;
+
+// Calls fn( first, last ) over sub-ranges of [0, height) rows, in parallel when the Area is large enough
+template<typename FN>
+void forEachRowBand( int32_t width, int32_t height, const FN &fn )
+{
+	if( ( height > 1 ) && ( width * height >= PARALLEL_MIN_PIXELS ) )
+		TaskPool::get()->parallelFor( 0, height, [&]( size_t first, size_t last ) { fn( (int32_t)first, (int32_t)last ); } );
+	else
+		fn( 0, height );
+}
+
+// The rows of the samples of one channel, starting at the upper-left of an Area
+template<typename T>
+struct Samples {
+	Samples( const T *data, int32_t rowBytes, uint8_t inc )
+		: mData( data ), mRowBytes( rowBytes ), mInc( inc )
+	{}
+
+	const T*	getRow( int32_t y ) const { return reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( mData ) + y * mRowBytes ); }
+
+	const T		*mData;
+	int32_t		mRowBytes;
+	uint8_t		mInc;
+};
+
+// Running minimum, maximum, sum and sum of squares of up to four interleaved channels. Element i of a row is accumulated in lane i % numLanes.
+struct Moments {
+	Moments()
+	{
+		for( int i = 0; i < 4; ++i ) {
+			mMin[i] = numeric_limits<float>::max();
+			mMax[i] = -numeric_limits<float>::max();
+			mSum[i] = mSumSq[i] = 0;
+		}
+	}
+
+	void merge( int lane, float minVal, float maxVal, double sum, double sumSq )
+	{
+		mMin[lane] = std::min( mMin[lane], minVal );
+		mMax[lane] = std::max( mMax[lane], maxVal );
+		mSum[lane] += sum;
+		mSumSq[lane] += sumSq;
+	}
+
+	void merge( const Moments &rhs )
+	{
+		for( int i = 0; i < 4; ++i )
+			merge( i, rhs.mMin[i], rhs.mMax[i], rhs.mSum[i], rhs.mSumSq[i] );
+	}
+
+	ChannelStatistics getStatistics( int lane, uint64_t count ) const
+	{
+		if( count == 0 )
+			return ChannelStatistics();
+
+		const double mean = mSum[lane] / count;
+		const double variance = std::max( 0.0, mSumSq[lane] / count - mean * mean );
+		return ChannelStatistics( mMin[lane], mMax[lane], (float)mean, (float)math<double>::sqrt( variance ), count );
+	}
+
+	float	mMin[4], mMax[4];
+	double	mSum[4], mSumSq[4];
+};
+
+// Each of the SIMD kernels below accumulates a prefix of a row 16 bytes at a time, with element i in lane i % 4, and returns the number of elements it consumed.
+
+#if defined( CINDER_SSE2 )
+bool useSse2()
+{
+	static bool sUseSse2 = System::hasSse2();
+	return sUseSse2;
+}
+
+int32_t accumulateRowSse2( const uint8_t *src, int32_t count, Moments *moments )
+{
+	const int32_t simdCount = count & ~15;
+	if( simdCount == 0 )
+		return 0;
+
+	const __m128i zero = _mm_setzero_si128();
+	__m128i minV = _mm_set1_epi8( (char)0xFF ), maxV = zero;
+	uint64_t sum[4] = { 0, 0, 0, 0 }, sumSq[4] = { 0, 0, 0, 0 };
+	for( int32_t i = 0; i < simdCount; ) {
+		// each 32-bit lane gains up to 4 * 255^2 per iteration, so flush to 64 bits before they can overflow
+		const int32_t blockEnd = std::min( simdCount, i + 16 * 4096 );
+		__m128i sumV = zero, sumSqV = zero;
+		for( ; i < blockEnd; i += 16 ) {
+			const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			minV = _mm_min_epu8( minV, v );
+			maxV = _mm_max_epu8( maxV, v );
+			const __m128i lo = _mm_unpacklo_epi8( v, zero ), hi = _mm_unpackhi_epi8( v, zero );
+			const __m128i loSq = _mm_mullo_epi16( lo, lo ), hiSq = _mm_mullo_epi16( hi, hi );
+			sumV = _mm_add_epi32( sumV, _mm_add_epi32( _mm_add_epi32( _mm_unpacklo_epi16( lo, zero ), _mm_unpackhi_epi16( lo, zero ) ),
+														_mm_add_epi32( _mm_unpacklo_epi16( hi, zero ), _mm_unpackhi_epi16( hi, zero ) ) ) );
+			sumSqV = _mm_add_epi32( sumSqV, _mm_add_epi32( _mm_add_epi32( _mm_unpacklo_epi16( loSq, zero ), _mm_unpackhi_epi16( loSq, zero ) ),
+															_mm_add_epi32( _mm_unpacklo_epi16( hiSq, zero ), _mm_unpackhi_epi16( hiSq, zero ) ) ) );
+		}
+		uint32_t blockSum[4], blockSumSq[4];
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( blockSum ), sumV );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( blockSumSq ), sumSqV );
+		for( int lane = 0; lane < 4; ++lane ) {
+			sum[lane] += blockSum[lane];
+			sumSq[lane] += blockSumSq[lane];
+		}
+	}
+
+	uint8_t mins[16], maxs[16];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( mins ), minV );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( maxs ), maxV );
+	for( int lane = 0; lane < 4; ++lane ) {
+		const uint8_t laneMin = std::min( std::min( mins[lane], mins[lane + 4] ), std::min( mins[lane + 8], mins[lane + 12] ) );
+		const uint8_t laneMax = std::max( std::max( maxs[lane], maxs[lane + 4] ), std::max( maxs[lane + 8], maxs[lane + 12] ) );
+		moments->merge( lane, laneMin, laneMax, (double)sum[lane], (double)sumSq[lane] );
+	}
+
+	return simdCount;
+}
+
+int32_t accumulateRowSse2( const float *src, int32_t count, Moments *moments )
+{
+	const int32_t simdCount = count & ~3;
+	if( simdCount == 0 )
+		return 0;
+
+	__m128 minV = _mm_set1_ps( numeric_limits<float>::max() ), maxV = _mm_set1_ps( -numeric_limits<float>::max() );
+	double sum[4] = { 0, 0, 0, 0 }, sumSq[4] = { 0, 0, 0, 0 };
+	for( int32_t i = 0; i < simdCount; ) {
+		// float sums lose precision as they grow, so flush to doubles regularly
+		const int32_t blockEnd = std::min( simdCount, i + 4 * 256 );
+		__m128 sumV = _mm_setzero_ps(), sumSqV = _mm_setzero_ps();
+		for( ; i < blockEnd; i += 4 ) {
+			const __m128 v = _mm_loadu_ps( src + i );
+			minV = _mm_min_ps( minV, v );
+			maxV = _mm_max_ps( maxV, v );
+			sumV = _mm_add_ps( sumV, v );
+			sumSqV = _mm_add_ps( sumSqV, _mm_mul_ps( v, v ) );
+		}
+		float blockSum[4], blockSumSq[4];
+		_mm_storeu_ps( blockSum, sumV );
+		_mm_storeu_ps( blockSumSq, sumSqV );
+		for( int lane = 0; lane < 4; ++lane ) {
+			sum[lane] += blockSum[lane];
+			sumSq[lane] += blockSumSq[lane];
+		}
+	}
+
+	float mins[4], maxs[4];
+	_mm_storeu_ps( mins, minV );
+	_mm_storeu_ps( maxs, maxV );
+	for( int lane = 0; lane < 4; ++lane )
+		moments->merge( lane, mins[lane], maxs[lane], sum[lane], sumSq[lane] );
+
+	return simdCount;
+}
+#elif defined( CINDER_NEON )
+int32_t accumulateRowNeon( const uint8_t *src, int32_t count, Moments *moments )
+{
+	const int32_t simdCount = count & ~15;
+	if( simdCount == 0 )
+		return 0;
+
+	uint8x16_t minV = vdupq_n_u8( 0xFF ), maxV = vdupq_n_u8( 0 );
+	uint64_t sum[4] = { 0, 0, 0, 0 }, sumSq[4] = { 0, 0, 0, 0 };
+	for( int32_t i = 0; i < simdCount; ) {
+		// each 32-bit lane gains up to 4 * 255^2 per iteration, so flush to 64 bits before they can overflow
+		const int32_t blockEnd = std::min( simdCount, i + 16 * 4096 );
+		uint32x4_t sumV = vdupq_n_u32( 0 ), sumSqV = vdupq_n_u32( 0 );
+		for( ; i < blockEnd; i += 16 ) {
+			const uint8x16_t v = vld1q_u8( src + i );
+			minV = vminq_u8( minV, v );
+			maxV = vmaxq_u8( maxV, v );
+			const uint16x8_t lo = vmovl_u8( vget_low_u8( v ) ), hi = vmovl_u8( vget_high_u8( v ) );
+			const uint16x8_t loSq = vmull_u8( vget_low_u8( v ), vget_low_u8( v ) ), hiSq = vmull_u8( vget_high_u8( v ), vget_high_u8( v ) );
+			sumV = vaddw_u16( vaddw_u16( vaddw_u16( vaddw_u16( sumV, vget_low_u16( lo ) ), vget_high_u16( lo ) ), vget_low_u16( hi ) ), vget_high_u16( hi ) );
+			sumSqV = vaddw_u16( vaddw_u16( vaddw_u16( vaddw_u16( sumSqV, vget_low_u16( loSq ) ), vget_high_u16( loSq ) ), vget_low_u16( hiSq ) ), vget_high_u16( hiSq ) );
+		}
+		uint32_t blockSum[4], blockSumSq[4];
+		vst1q_u32( blockSum, sumV );
+		vst1q_u32( blockSumSq, sumSqV );
+		for( int lane = 0; lane < 4; ++lane ) {
+			sum[lane] += blockSum[lane];
+			sumSq[lane] += blockSumSq[lane];
+		}
+	}
+
+	uint8_t mins[16], maxs[16];
+	vst1q_u8( mins, minV );
+	vst1q_u8( maxs, maxV );
+	for( int lane = 0; lane < 4; ++lane ) {
+		const uint8_t laneMin = std::min( std::min( mins[lane], mins[lane + 4] ), std::min( mins[lane + 8], mins[lane + 12] ) );
+		const uint8_t laneMax = std::max( std::max( maxs[lane], maxs[lane + 4] ), std::max( maxs[lane + 8], maxs[lane + 12] ) );
+		moments->merge( lane, laneMin, laneMax, (double)sum[lane], (double)sumSq[lane] );
+	}
+
+	return simdCount;
+}
+
+int32_t accumulateRowNeon( const float *src, int32_t count, Moments *moments )
+{
+	const int32_t simdCount = count & ~3;
+	if( simdCount == 0 )
+		return 0;
+
+	float32x4_t minV = vdupq_n_f32( numeric_limits<float>::max() ), maxV = vdupq_n_f32( -numeric_limits<float>::max() );
+	double sum[4] = { 0, 0, 0, 0 }, sumSq[4] = { 0, 0, 0, 0 };
+	for( int32_t i = 0; i < simdCount; ) {
+		// float sums lose precision as they grow, so flush to doubles regularly
+		const int32_t blockEnd = std::min( simdCount, i + 4 * 256 );
+		float32x4_t sumV = vdupq_n_f32( 0 ), sumSqV = vdupq_n_f32( 0 );
+		for( ; i < blockEnd; i += 4 ) {
+			const float32x4_t v = vld1q_f32( src + i );
+			minV = vminq_f32( minV, v );
+			maxV = vmaxq_f32( maxV, v );
+			sumV = vaddq_f32( sumV, v );
+			sumSqV = vmlaq_f32( sumSqV, v, v );
+		}
+		float blockSum[4], blockSumSq[4];
+		vst1q_f32( blockSum, sumV );
+		vst1q_f32( blockSumSq, sumSqV );
+		for( int lane = 0; lane < 4; ++lane ) {
+			sum[lane] += blockSum[lane];
+			sumSq[lane] += blockSumSq[lane];
+		}
+	}
+
+	float mins[4], maxs[4];
+	vst1q_f32( mins, minV );
+	vst1q_f32( maxs, maxV );
+	for( int lane = 0; lane < 4; ++lane )
+		moments->merge( lane, mins[lane], maxs[lane], sum[lane], sumSq[lane] );
+
+	return simdCount;
+}
+#endif
+
+template<typename T>
+int32_t accumulateRowSimd( const T *src, int32_t count, Moments *moments )
+{
+#if defined( CINDER_SSE2 )
+	if( useSse2() )
+		return accumulateRowSse2( src, count, moments );
+#elif defined( CINDER_NEON )
+	return accumulateRowNeon( src, count, moments );
+#endif
+	return 0;
+}
+
+// 16-bit rows take the scalar path
+int32_t accumulateRowSimd( const uint16_t *src, int32_t count, Moments *moments )
+{
+	return 0;
+}
+
+// Accumulates \a count interleaved elements of a row, where \a numLanes is the pixel increment
+template<typename T>
+void accumulateRow( const T *src, int32_t count, uint8_t numLanes, Moments *moments )
+{
+	// the SIMD lanes are i % 4, which matches when there are 4 channels, and which are merged afterwards when there is 1
+	int32_t i = ( numLanes == 1 || numLanes == 4 ) ? accumulateRowSimd( src, count, moments ) : 0;
+	for( ; i < count; ++i ) {
+		const int lane = i % numLanes;
+		const float v = src[i];
+		moments->merge( lane, v, v, v, (double)v * v );
+	}
+}
+
+// Accumulates the \a rowElements elements of each of \a height rows starting at \a samples, in parallel over bands of rows
+template<typename T>
+Moments calcMoments( const Samples<T> &samples, int32_t width, int32_t height, int32_t rowElements )
+{
+	Moments result;
+	mutex resultMutex;
+	forEachRowBand( width, height, [&]( int32_t first, int32_t last ) {
+		Moments band;
+		for( int32_t y = first; y < last; ++y )
+			accumulateRow( samples.getRow( y ), rowElements, samples.mInc, &band );
+		lock_guard<mutex> lock( resultMutex );
+		result.merge( band );
+	} );
+
+	// contiguous samples were accumulated across all four lanes
+	if( samples.mInc == 1 )
+		for( int lane = 1; lane < 4; ++lane )
+			result.merge( 0, result.mMin[lane], result.mMax[lane], result.mSum[lane], result.mSumSq[lane] );
+
+	return result;
+}
+
+template<typename T>
+Moments calcMoments( const ChannelT<T> &channel, const Area &area )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return Moments();
+
+	// spanning only to this channel's sample in the last pixel avoids reading beyond the end of a Surface's channel
+	Samples<T> samples( channel.getData( clipped.getUL() ), channel.getRowBytes(), channel.getIncrement() );
+	return calcMoments( samples, clipped.getWidth(), clipped.getHeight(), ( clipped.getWidth() - 1 ) * channel.getIncrement() + 1 );
+}
+
+// Maps samples to the bins of a Histogram
+template<typename T>
+class Binner {
+  public:
+	Binner( const Histogram &histogram )
+		: mHistogram( histogram )
+	{}
+
+	size_t operator()( T value ) const { return mHistogram.getBin( value ); }
+
+  private:
+	const Histogram		&mHistogram;
+};
+
+// 8-bit samples are mapped through a table, since there are only 256 of them
+template<>
+class Binner<uint8_t> {
+  public:
+	Binner( const Histogram &histogram )
+	{
+		for( int v = 0; v < 256; ++v )
+			mBins[v] = (uint32_t)histogram.getBin( (float)v );
+	}
+
+	size_t operator()( uint8_t value ) const { return mBins[value]; }
+
+  private:
+	uint32_t	mBins[256];
+};
+
+// Counts \a width samples into \a counts, which holds four interleaved sub-histograms so that runs of equal samples don't serialize on incrementing a single bin
+template<typename T>
+void countRow( const T *src, int32_t width, uint8_t inc, const Binner<T> &binner, uint32_t *counts )
+{
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, src += 4 * inc ) {
+		++counts[binner( src[0] ) * 4];
+		++counts[binner( src[inc] ) * 4 + 1];
+		++counts[binner( src[2 * inc] ) * 4 + 2];
+		++counts[binner( src[3 * inc] ) * 4 + 3];
+	}
+	for( ; x < width; ++x, src += inc )
+		++counts[binner( *src ) * 4];
+}
+
+// Replaces the counts of each of \a results with those of the corresponding \a samples, visiting each row of all channels once
+template<typename T>
+void calcHistograms( const vector<Samples<T> > &samples, const vector<Histogram*> &results, int32_t width, int32_t height )
+{
+	vector<Binner<T> > binners;
+	for( size_t c = 0; c < results.size(); ++c ) {
+		results[c]->clear();
+		binners.push_back( Binner<T>( *results[c] ) );
+	}
+	if( width <= 0 || height <= 0 )
+		return;
+
+	mutex resultsMutex;
+	forEachRowBand( width, height, [&]( int32_t first, int32_t last ) {
+		vector<vector<uint32_t> > counts( results.size() );
+		for( size_t c = 0; c < results.size(); ++c )
+			counts[c].assign( results[c]->getNumBins() * 4, 0 );
+
+		for( int32_t y = first; y < last; ++y )
+			for( size_t c = 0; c < results.size(); ++c )
+				countRow( samples[c].getRow( y ), width, samples[c].mInc, binners[c], &counts[c][0] );
+
+		lock_guard<mutex> lock( resultsMutex );
+		for( size_t c = 0; c < results.size(); ++c )
+			for( size_t bin = 0; bin < results[c]->getNumBins(); ++bin )
+				results[c]->add( bin, counts[c][bin * 4] + counts[c][bin * 4 + 1] + counts[c][bin * 4 + 2] + counts[c][bin * 4 + 3] );
+	} );
+}
+
+template<typename T>
+float naturalRangeMax()
+{
+	return CHANTRAIT<T>::max() + 1.0f;
+}
+
+template<>
+float naturalRangeMax<float>()
+{
+	return 1.0f;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Histogram
+Histogram::Histogram()
+	: mCounts( 256, 0 ), mRangeMin( 0 ), mRangeMax( 256 ), mTotal( 0 )
+{
+}
+
+Histogram::Histogram( size_t numBins, float rangeMin, float rangeMax )
+	: mCounts( std::max<size_t>( 1, numBins ), 0 ), mRangeMin( rangeMin ), mRangeMax( rangeMax ), mTotal( 0 )
+{
+}
+
+size_t Histogram::getBin( float value ) const
+{
+	const float bin = ( value - mRangeMin ) * mCounts.size() / ( mRangeMax - mRangeMin );
+	// written so that NaN lands in the first bin
+	if( ! ( bin >= 1 ) )
+		return 0;
+	else if( bin >= mCounts.size() - 1 )
+		return mCounts.size() - 1;
+	else
+		return (size_t)bin;
+}
+
+float Histogram::getPercentile( float fraction ) const
+{
+	const double target = constrain( fraction, 0.0f, 1.0f ) * (double)mTotal;
+	uint64_t below = 0;
+	for( size_t bin = 0; bin < mCounts.size(); ++bin ) {
+		if( mCounts[bin] > 0 && below + mCounts[bin] >= target )
+			return getBinMin( bin ) + (float)( ( target - below ) / mCounts[bin] ) * getBinWidth();
+		below += mCounts[bin];
+	}
+
+	return mRangeMin;
+}
+
+Histogram& Histogram::operator+=( const Histogram &rhs )
+{
+	const size_t numBins = std::min( mCounts.size(), rhs.mCounts.size() );
+	for( size_t bin = 0; bin < numBins; ++bin )
+		add( bin, rhs.mCounts[bin] );
+
+	return *this;
+}
+
+void Histogram::clear()
+{
+	std::fill( mCounts.begin(), mCounts.end(), 0 );
+	mTotal = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+template<typename T>
+ChannelStatistics getStatistics( const ChannelT<T> &channel, const Area &area )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	const uint64_t count = ( clipped.getWidth() > 0 && clipped.getHeight() > 0 ) ? (uint64_t)clipped.getWidth() * clipped.getHeight() : 0;
+	return calcMoments( channel, clipped ).getStatistics( 0, count );
+}
+
+template<typename T>
+void getStatistics( const SurfaceT<T> &surface, const Area &area, ChannelStatistics *red, ChannelStatistics *green, ChannelStatistics *blue, ChannelStatistics *alpha )
+{
+	const Area clipped = area.getClipBy( surface.getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 ) {
+		*red = *green = *blue = ChannelStatistics();
+		if( alpha )
+			*alpha = ChannelStatistics();
+		return;
+	}
+
+	const uint8_t pixelInc = surface.getPixelInc();
+	Samples<T> samples( surface.getData( clipped.getUL() ), surface.getRowBytes(), pixelInc );
+	const Moments moments = calcMoments( samples, clipped.getWidth(), clipped.getHeight(), clipped.getWidth() * pixelInc );
+
+	const uint64_t count = (uint64_t)clipped.getWidth() * clipped.getHeight();
+	*red = moments.getStatistics( surface.getRedOffset(), count );
+	*green = moments.getStatistics( surface.getGreenOffset(), count );
+	*blue = moments.getStatistics( surface.getBlueOffset(), count );
+	if( alpha && surface.hasAlpha() )
+		*alpha = moments.getStatistics( surface.getAlphaOffset(), count );
+}
+
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, const Area &area, T *resultMin, T *resultMax )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return;
+
+	const Moments moments = calcMoments( channel, clipped );
+	*resultMin = (T)moments.mMin[0];
+	*resultMax = (T)moments.mMax[0];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Histograms
+template<typename T>
+Histogram getHistogram( const ChannelT<T> &channel, const Area &area, size_t numBins )
+{
+	Histogram result( numBins, 0, naturalRangeMax<T>() );
+	getHistogram( channel, area, &result );
+	return result;
+}
+
+template<typename T>
+void getHistogram( const ChannelT<T> &channel, const Area &area, Histogram *result )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	vector<Samples<T> > samples( 1, Samples<T>( channel.getData( clipped.getUL() ), channel.getRowBytes(), channel.getIncrement() ) );
+	calcHistograms( samples, vector<Histogram*>( 1, result ), clipped.getWidth(), clipped.getHeight() );
+}
+
+template<typename T>
+void getHistograms( const SurfaceT<T> &surface, const Area &area, Histogram *red, Histogram *green, Histogram *blue, Histogram *alpha )
+{
+	const Area clipped = area.getClipBy( surface.getBounds() );
+	const T *data = surface.getData( clipped.getUL() );
+	const int32_t rowBytes = surface.getRowBytes();
+	const uint8_t pixelInc = surface.getPixelInc();
+
+	vector<Samples<T> > samples;
+	vector<Histogram*> results;
+	if( red ) {
+		samples.push_back( Samples<T>( data + surface.getRedOffset(), rowBytes, pixelInc ) );
+		results.push_back( red );
+	}
+	if( green ) {
+		samples.push_back( Samples<T>( data + surface.getGreenOffset(), rowBytes, pixelInc ) );
+		results.push_back( green );
+	}
+	if( blue ) {
+		samples.push_back( Samples<T>( data + surface.getBlueOffset(), rowBytes, pixelInc ) );
+		results.push_back( blue );
+	}
+	if( alpha && surface.hasAlpha() ) {
+		samples.push_back( Samples<T>( data + surface.getAlphaOffset(), rowBytes, pixelInc ) );
+		results.push_back( alpha );
+	}
+
+	calcHistograms( samples, results, clipped.getWidth(), clipped.getHeight() );
+}
+
+#define statistics_PROTOTYPES(r,data,T)\
+	template ChannelStatistics getStatistics( const ChannelT<T> &channel, const Area &area ); \
+	template void getStatistics( const SurfaceT<T> &surface, const Area &area, ChannelStatistics *red, ChannelStatistics *green, ChannelStatistics *blue, ChannelStatistics *alpha ); \
+	template void getMinMax( const ChannelT<T> &channel, const Area &area, T *resultMin, T *resultMax ); \
+	template Histogram getHistogram( const ChannelT<T> &channel, const Area &area, size_t numBins ); \
+	template void getHistogram( const ChannelT<T> &channel, const Area &area, Histogram *result ); \
+	template void getHistograms( const SurfaceT<T> &surface, const Area &area, Histogram *red, Histogram *green, Histogram *blue, Histogram *alpha );
+
+BOOST_PP_SEQ_FOR_EACH( statistics_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
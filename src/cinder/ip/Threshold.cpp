@@ -23,7 +23,6 @@
 #include "cinder/ip/Threshold.h"
 #include "cinder/ChanTraits.h"
 
-#include <stdlib.h>
 #include <boost/preprocessor/seq.hpp>
 
 
@@ -120,11 +119,9 @@ void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel
 	thresholdImpl( srcChannel, value, srcChannel.getBounds(), Vec2i::zero(), dstChannel );
 }
 
-template<typename T>
-void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
+template<typename T, typename SUMT>
+void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, const IntegralImageT<T,SUMT> &integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
 	int32_t imageWidth = srcChannel->getWidth();
 	int32_t imageHeight = srcChannel->getHeight();
 
@@ -134,6 +131,9 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 
 	SUMT comparisonMult = static_cast<SUMT>( ( 1.0f - percentageDelta ) * 256 );
 	const T maxValue = CHANTRAIT<T>::max();
+	// the table has a leading row and column of zeros, so the inclusive sum through (x,y) is at (x+1,y+1)
+	const SUMT *table = integralImage.getData() + imageWidth + 2;
+	const int32_t tableStride = imageWidth + 1;
 
 	// perform thresholding
 	for( int32_t j = 0; j < imageHeight; j++ ) {
@@ -156,10 +156,10 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 			int32_t count = ( x2 - x1 ) * ( y2 - y1 );
 
 			// I(x,y)=s(x2,y2)-s(x1,y2)-s(x2,y1)+s(x1,x1)
-			SUMT sum =	integralImage[y2 * imageWidth + x2] -
-						integralImage[y1 * imageWidth + x2] -
-						integralImage[y2 * imageWidth + x1] +
-						integralImage[y1 * imageWidth + x1];
+			SUMT sum =	table[y2 * tableStride + x2] -
+						table[y1 * tableStride + x2] -
+						table[y2 * tableStride + x1] +
+						table[y1 * tableStride + x1];
 
 			*dst = ( (SUMT)(*src * count) < (sum * comparisonMult / 256) ) ? 0 : maxValue;
 			dst += dstInc;
@@ -168,16 +168,16 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 	}
 }
 
-template<typename T>
-void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, ChannelT<T> *dstChannel )
+template<typename T, typename SUMT>
+void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, const IntegralImageT<T,SUMT> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
 	int32_t imageWidth = srcChannel->getWidth();
 	int32_t imageHeight = srcChannel->getHeight();
 	int s2 = windowSize / 2;
 	uint8_t srcInc = srcChannel->getIncrement();
 	uint8_t dstInc = dstChannel->getIncrement();
+	const SUMT *table = integralImage.getData() + imageWidth + 2;
+	const int32_t tableStride = imageWidth + 1;
 
 	// perform thresholding
 	for( int32_t j = 0; j < imageHeight; j++ ) {
@@ -200,10 +200,10 @@ void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHA
 			int32_t count = ( x2 - x1 ) * ( y2 - y1 );
 
 			// I(x,y)=s(x2,y2)-s(x1,y2)-s(x2,y1)+s(x1,x1)
-			SUMT sum =	integralImage[y2 * imageWidth + x2] -
-						integralImage[y1 * imageWidth + x2] -
-						integralImage[y2 * imageWidth + x1] +
-						integralImage[y1 * imageWidth + x1];
+			SUMT sum =	table[y2 * tableStride + x2] -
+						table[y1 * tableStride + x2] -
+						table[y2 * tableStride + x1] +
+						table[y1 * tableStride + x1];
 
 			//*dst = ( (*dst * count) < sum ) ? 0 : maxValue;
 			int32_t diffSignExtended = (int32_t)( sum - *src * count );
@@ -216,129 +216,49 @@ void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHA
 
 }
 
-template<typename T>
-void calculateIntegralImage( const ChannelT<T> &channel, typename CHANTRAIT<T>::Accum *integralImage )
-{
-	int32_t imageWidth = channel.getWidth(), imageHeight = channel.getHeight();
-	int32_t srcRowBytes = channel.getRowBytes();
-	uint8_t srcInc = channel.getIncrement();
-	const T *src = channel.getData();
-	/*for( int32_t i = 0; i < imageWidth; i++ ) {
-		// reset this column sum
-		typename CHANTRAIT<T>::Accum sum = 0;
-
-		for( int32_t j = 0; j < imageHeight; j++ ) {
-			uint32_t index = j * imageWidth + i;
-
-			sum += src[j*srcRowBytes+i*srcInc];
-			if( i == 0 )
-				integralImage[index] = sum;
-			else
-				integralImage[index] = integralImage[index-1] + sum;
-		}
-	}*/
-	for( int32_t j = 0; j < imageHeight; j++ ) {
-		// reset this column sum
-		typename CHANTRAIT<T>::Accum sum = 0;
-
-		for( int32_t i = 0; i < imageWidth; i++ ) {		
-			uint32_t index = j * imageWidth + i;
-
-			sum += src[j*srcRowBytes+i*srcInc];
-			if( j == 0 )
-				integralImage[index] = sum;
-			else
-				integralImage[index] = integralImage[index-imageWidth] + sum;
-		}
-	}
-}
-
 template<typename T>
 void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = srcChannel.getWidth();
-	int32_t imageHeight = srcChannel.getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( srcChannel, integralImage );
-	
-	calculateAdaptiveThreshold( &srcChannel, integralImage, windowSize, percentageDelta, dstChannel );
-
-	free( integralImage );	
+	calculateAdaptiveThreshold( &srcChannel, IntegralImageT<T>( srcChannel ), windowSize, percentageDelta, dstChannel );
 }
 
 template<typename T>
 void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = channel->getWidth();
-	int32_t imageHeight = channel->getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( *channel, integralImage );
-
-	calculateAdaptiveThreshold( channel, integralImage, windowSize, percentageDelta, channel );
+	calculateAdaptiveThreshold( channel, IntegralImageT<T>( *channel ), windowSize, percentageDelta, channel );
+}
 
-	free( integralImage );	
+template<typename T, typename SUMT>
+void adaptiveThreshold( const ChannelT<T> &srcChannel, const IntegralImageT<T,SUMT> &integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
+{
+	calculateAdaptiveThreshold( &srcChannel, integralImage, windowSize, percentageDelta, dstChannel );
 }
 
 template<typename T>
 void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = channel->getWidth();
-	int32_t imageHeight = channel->getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( *channel, integralImage );
-	
-	calculateAdaptiveThresholdZero( channel, integralImage, windowSize, channel );
-
-	free( integralImage );	
+	calculateAdaptiveThresholdZero( channel, IntegralImageT<T>( *channel ), windowSize, channel );
 }
 
 template<typename T>
 void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = srcChannel.getWidth();
-	int32_t imageHeight = srcChannel.getHeight();
-	SUMT *integralImage;
+	calculateAdaptiveThresholdZero( &srcChannel, IntegralImageT<T>( srcChannel ), windowSize, dstChannel );
+}
 
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( srcChannel, integralImage );
-	
+template<typename T, typename SUMT>
+void adaptiveThresholdZero( const ChannelT<T> &srcChannel, const IntegralImageT<T,SUMT> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel )
+{
 	calculateAdaptiveThresholdZero( &srcChannel, integralImage, windowSize, dstChannel );
-
-	free( integralImage );	
 }
 
 template<typename T>
-AdaptiveThresholdT<T>::Obj::Obj( ChannelT<T> *channel ) : mChannel( channel ) {
+AdaptiveThresholdT<T>::Obj::Obj( ChannelT<T> *channel )
+	: mChannel( channel ), mIntegralImage( *channel )
+{
 	mImageWidth = mChannel->getWidth();
 	mImageHeight = mChannel->getHeight();
 	mIncrement = mChannel->getIncrement();
-
-	// create the integral image
-	mIntegralImage = (SUMT*)malloc( mImageWidth * mImageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( *channel, mIntegralImage );
-}
-
-template<typename T>
-AdaptiveThresholdT<T>::Obj::~Obj() {
-	free( mIntegralImage );
 }
 
 template<typename T>
@@ -364,13 +284,20 @@ template class AdaptiveThresholdT<float>;
 	template void threshold( SurfaceT<T> *surface, T value ); \
 	template void threshold( SurfaceT<T> *surface, T value, const Area &area ); \
 	template void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface );\
-	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );\
+	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );
+
+#define adaptiveThreshold_PROTOTYPES(r,data,T)\
 	template void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
 	template void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta ); \
 	template void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize ); \
-	template void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel );
-
-BOOST_PP_SEQ_FOR_EACH( threshold_PROTOTYPES, ~, (uint8_t) )
+	template void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel ); \
+	template void adaptiveThreshold( const ChannelT<T> &srcChannel, const IntegralImageT<T> &integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
+	template void adaptiveThreshold( const ChannelT<T> &srcChannel, const IntegralImageT<T,uint64_t> &integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
+	template void adaptiveThresholdZero( const ChannelT<T> &srcChannel, const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel ); \
+	template void adaptiveThresholdZero( const ChannelT<T> &srcChannel, const IntegralImageT<T,uint64_t> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel );
+
+BOOST_PP_SEQ_FOR_EACH( threshold_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+BOOST_PP_SEQ_FOR_EACH( adaptiveThreshold_PROTOTYPES, ~, (uint8_t) )
 
 
 } } // namespace cinder::ip
@@ -95,6 +95,6 @@ Area findNonTransparentArea( const SurfaceT<T> &surface, const Area &unclippedBo
 #define TRIM_PROTOTYPES(r,data,T)\
 	template Area findNonTransparentArea( const SurfaceT<T> &surface, const Area &unclippedBounds );
 
-BOOST_PP_SEQ_FOR_EACH( TRIM_PROTOTYPES, ~, CHANNEL_TYPES )
+BOOST_PP_SEQ_FOR_EACH( TRIM_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
 } } // namespace cinder::ip
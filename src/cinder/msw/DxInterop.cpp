@@ -0,0 +1,61 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/msw/DxInterop.h"
+
+namespace cinder { namespace msw {
+
+namespace {
+
+template<typename FnT>
+FnT getWglProc( const char *name )
+{
+	// some drivers return small integers rather than NULL for unsupported functions
+	PROC proc = ::wglGetProcAddress( name );
+	return ( (INT_PTR)proc > 3 ) ? reinterpret_cast<FnT>( proc ) : NULL;
+}
+
+} // anonymous namespace
+
+const DxInterop* getDxInterop()
+{
+	static bool sLoaded = false;
+	static bool sSupported = false;
+	static DxInterop sInterop;
+
+	if( ! sLoaded ) {
+		sLoaded = true;
+		sInterop.openDevice = getWglProc<DxInterop::OpenDeviceFn>( "wglDXOpenDeviceNV" );
+		sInterop.closeDevice = getWglProc<DxInterop::CloseDeviceFn>( "wglDXCloseDeviceNV" );
+		sInterop.registerObject = getWglProc<DxInterop::RegisterObjectFn>( "wglDXRegisterObjectNV" );
+		sInterop.unregisterObject = getWglProc<DxInterop::UnregisterObjectFn>( "wglDXUnregisterObjectNV" );
+		sInterop.lockObjects = getWglProc<DxInterop::LockObjectsFn>( "wglDXLockObjectsNV" );
+		sInterop.unlockObjects = getWglProc<DxInterop::UnlockObjectsFn>( "wglDXUnlockObjectsNV" );
+		sSupported = sInterop.openDevice && sInterop.closeDevice && sInterop.registerObject && sInterop.unregisterObject
+						&& sInterop.lockObjects && sInterop.unlockObjects;
+	}
+
+	return sSupported ? &sInterop : NULL;
+}
+
+} } // namespace cinder::msw
@@ -0,0 +1,503 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// the Media Engine and the DXGI device manager are only declared for Windows 8 and later
+#if ! defined( _WIN32_WINNT ) || ( _WIN32_WINNT < 0x0602 )
+	#undef _WIN32_WINNT
+	#define _WIN32_WINNT 0x0602
+#endif
+
+#include "cinder/msw/MovieGl.h"
+#include "cinder/msw/CinderMsw.h"
+#include "cinder/msw/DxInterop.h"
+#include "cinder/gl/gl.h"
+#include "cinder/Surface.h"
+
+#include <d3d11.h>
+#include <d3d10.h>
+#include <mfapi.h>
+#include <mfmediaengine.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#pragma comment( lib, "d3d11.lib" )
+#pragma comment( lib, "mfplat.lib" )
+#pragma comment( lib, "mfuuid.lib" )
+
+using namespace std;
+
+namespace cinder { namespace msw {
+
+namespace {
+
+void initMediaFoundation()
+{
+	static bool sInitialized = false;
+	if( ! sInitialized ) {
+		sInitialized = true;
+		::MFStartup( MF_VERSION );
+	}
+}
+
+class MediaEngineNotify;
+
+} // anonymous namespace
+
+struct MovieGl::Obj {
+	Obj( const fs::path &path );
+	~Obj();
+
+	// called by MediaEngineNotify on a Media Foundation thread
+	void	handleEvent( DWORD event, DWORD_PTR param1, DWORD param2 );
+
+	void	createDevice();
+	void	createTextures();
+	bool	checkNewFrame();
+	void	transferFrame();
+
+	int32_t							mWidth, mHeight;
+	float							mDuration;
+	bool							mHasVideo, mHasAudio;
+
+	std::unique_ptr<ID3D11Device, ComDeleter>				mDevice;
+	std::unique_ptr<ID3D11DeviceContext, ComDeleter>		mDeviceContext;
+	std::unique_ptr<IMFDXGIDeviceManager, ComDeleter>		mDeviceManager;
+	std::unique_ptr<IMFMediaEngine, ComDeleter>				mEngine;
+	std::unique_ptr<IMFMediaEngineEx, ComDeleter>			mEngineEx;
+	MediaEngineNotify										*mNotify;
+
+	// TransferVideoFrame() renders into mFrameTexture, which is either shared with mTexture through the interop or copied to mStagingTexture and uploaded
+	std::unique_ptr<ID3D11Texture2D, ComDeleter>			mFrameTexture;
+	std::unique_ptr<ID3D11Texture2D, ComDeleter>			mStagingTexture;
+	HANDLE							mInteropDevice, mInteropTexture;
+	bool							mInteropLocked;
+	gl::Texture						mTexture;
+	bool							mNewFrame;
+
+	mutable std::mutex				mMutex;
+	std::condition_variable			mMetadataCond;
+	bool							mMetadataLoaded, mPlayable, mFailed;
+	HRESULT							mError;
+};
+
+namespace {
+
+// Forwards Media Engine events to a handler until it is detached. The engine holds a reference, so this may outlive the movie.
+class MediaEngineNotify : public IMFMediaEngineNotify {
+  public:
+	typedef std::function<void( DWORD, DWORD_PTR, DWORD )>	EventFn;
+
+	MediaEngineNotify( const EventFn &eventFn ) : mRefCount( 1 ), mEventFn( eventFn ) {}
+
+	void detach()
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mEventFn = EventFn();
+	}
+
+	STDMETHODIMP QueryInterface( REFIID riid, void **ppv )
+	{
+		if( ( riid == __uuidof( IMFMediaEngineNotify ) ) || ( riid == __uuidof( IUnknown ) ) ) {
+			*ppv = static_cast<IMFMediaEngineNotify*>( this );
+			AddRef();
+			return S_OK;
+		}
+		*ppv = NULL;
+		return E_NOINTERFACE;
+	}
+
+	STDMETHODIMP_(ULONG) AddRef()
+	{
+		return ::InterlockedIncrement( &mRefCount );
+	}
+
+	STDMETHODIMP_(ULONG) Release()
+	{
+		ULONG refCount = ::InterlockedDecrement( &mRefCount );
+		if( refCount == 0 )
+			delete this;
+		return refCount;
+	}
+
+	STDMETHODIMP EventNotify( DWORD event, DWORD_PTR param1, DWORD param2 )
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( mEventFn )
+			mEventFn( event, param1, param2 );
+		return S_OK;
+	}
+
+  private:
+	volatile ULONG	mRefCount;
+	EventFn			mEventFn;
+	std::mutex		mMutex;
+};
+
+} // anonymous namespace
+
+MovieGl::Obj::Obj( const fs::path &path )
+	: mWidth( 0 ), mHeight( 0 ), mDuration( 0 ), mHasVideo( false ), mHasAudio( false ), mNotify( NULL ),
+	mInteropDevice( NULL ), mInteropTexture( NULL ), mInteropLocked( false ), mNewFrame( false ),
+	mMetadataLoaded( false ), mPlayable( false ), mFailed( false ), mError( S_OK )
+{
+	msw::initializeCom();
+	initMediaFoundation();
+	createDevice();
+
+	IMFMediaEngineClassFactory *factory = NULL;
+	if( FAILED( ::CoCreateInstance( CLSID_MFMediaEngineClassFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS( &factory ) ) ) )
+		throw MovieGlExc( "Media Foundation Media Engine unavailable, which requires Windows 8 or later" );
+	auto factoryPtr = makeComUnique( factory );
+
+	IMFAttributes *attributes = NULL;
+	if( FAILED( ::MFCreateAttributes( &attributes, 3 ) ) )
+		throw MovieGlExc( "Failed to create Media Engine attributes" );
+	auto attributesPtr = makeComUnique( attributes );
+
+	mNotify = new MediaEngineNotify( std::bind( &Obj::handleEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3 ) );
+	attributes->SetUnknown( MF_MEDIA_ENGINE_CALLBACK, mNotify );
+	attributes->SetUnknown( MF_MEDIA_ENGINE_DXGI_MANAGER, mDeviceManager.get() );
+	attributes->SetUINT32( MF_MEDIA_ENGINE_VIDEO_OUTPUT_FORMAT, DXGI_FORMAT_B8G8R8A8_UNORM );
+
+	IMFMediaEngine *engine = NULL;
+	if( FAILED( factory->CreateInstance( 0, attributes, &engine ) ) )
+		throw MovieGlExc( "Failed to create Media Engine" );
+	mEngine = makeComUnique( engine );
+
+	IMFMediaEngineEx *engineEx = NULL;
+	if( SUCCEEDED( engine->QueryInterface( IID_PPV_ARGS( &engineEx ) ) ) )
+		mEngineEx = makeComUnique( engineEx );
+
+	BSTR url = ::SysAllocString( path.wstring().c_str() );
+	HRESULT hr = mEngine->SetSource( url );
+	::SysFreeString( url );
+	if( FAILED( hr ) )
+		throw MovieGlExc( "Failed to open movie: " + path.string() );
+
+	// loading is asynchronous; the dimensions and duration are known once the metadata has loaded
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( ! mMetadataLoaded && ! mFailed )
+			mMetadataCond.wait( lock );
+		if( mFailed )
+			throw MovieGlExc( "Failed to load movie: " + path.string() );
+	}
+
+	DWORD width = 0, height = 0;
+	mEngine->GetNativeVideoSize( &width, &height );
+	mWidth = (int32_t)width;
+	mHeight = (int32_t)height;
+	mDuration = (float)mEngine->GetDuration();
+	mHasVideo = mEngine->HasVideo() != FALSE;
+	mHasAudio = mEngine->HasAudio() != FALSE;
+
+	if( mHasVideo && ( mWidth > 0 ) && ( mHeight > 0 ) )
+		createTextures();
+}
+
+MovieGl::Obj::~Obj()
+{
+	if( mNotify ) {
+		mNotify->detach();
+		mNotify->Release();
+	}
+	if( mEngine )
+		mEngine->Shutdown();
+
+	if( mInteropTexture ) {
+		if( mInteropLocked )
+			getDxInterop()->unlockObjects( mInteropDevice, 1, &mInteropTexture );
+		getDxInterop()->unregisterObject( mInteropDevice, mInteropTexture );
+	}
+	if( mInteropDevice )
+		getDxInterop()->closeDevice( mInteropDevice );
+}
+
+void MovieGl::Obj::handleEvent( DWORD event, DWORD_PTR param1, DWORD param2 )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	switch( event ) {
+		case MF_MEDIA_ENGINE_EVENT_LOADEDMETADATA:
+			mMetadataLoaded = true;
+			mMetadataCond.notify_all();
+		break;
+		case MF_MEDIA_ENGINE_EVENT_CANPLAYTHROUGH:
+			mPlayable = true;
+		break;
+		case MF_MEDIA_ENGINE_EVENT_ERROR:
+			mFailed = true;
+			mError = (HRESULT)param2;
+			mMetadataCond.notify_all();
+		break;
+		default:
+		break;
+	}
+}
+
+void MovieGl::Obj::createDevice()
+{
+	// the Media Engine decodes with DXVA through the device manager, using this device from its own threads
+	const D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0, D3D_FEATURE_LEVEL_9_3 };
+	ID3D11Device *device = NULL;
+	ID3D11DeviceContext *deviceContext = NULL;
+	if( FAILED( ::D3D11CreateDevice( NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, D3D11_CREATE_DEVICE_VIDEO_SUPPORT | D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+			featureLevels, sizeof( featureLevels ) / sizeof( featureLevels[0] ), D3D11_SDK_VERSION, &device, NULL, &deviceContext ) ) )
+		throw MovieGlExc( "Failed to create Direct3D 11 device with video support" );
+	mDevice = makeComUnique( device );
+	mDeviceContext = makeComUnique( deviceContext );
+
+	ID3D10Multithread *multithread = NULL;
+	if( SUCCEEDED( device->QueryInterface( IID_PPV_ARGS( &multithread ) ) ) ) {
+		multithread->SetMultithreadProtected( TRUE );
+		multithread->Release();
+	}
+
+	UINT resetToken = 0;
+	IMFDXGIDeviceManager *deviceManager = NULL;
+	if( FAILED( ::MFCreateDXGIDeviceManager( &resetToken, &deviceManager ) ) )
+		throw MovieGlExc( "Failed to create DXGI device manager" );
+	mDeviceManager = makeComUnique( deviceManager );
+	deviceManager->ResetDevice( device, resetToken );
+}
+
+void MovieGl::Obj::createTextures()
+{
+	D3D11_TEXTURE2D_DESC desc;
+	::ZeroMemory( &desc, sizeof( desc ) );
+	desc.Width = mWidth;
+	desc.Height = mHeight;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+	ID3D11Texture2D *frameTexture = NULL;
+	if( FAILED( mDevice->CreateTexture2D( &desc, NULL, &frameTexture ) ) )
+		throw MovieGlExc( "Failed to create Direct3D 11 frame texture" );
+	mFrameTexture = makeComUnique( frameTexture );
+
+	if( getDxInterop() )
+		mInteropDevice = getDxInterop()->openDevice( mDevice.get() );
+	if( mInteropDevice ) {
+		GLuint textureId;
+		glGenTextures( 1, &textureId );
+		mInteropTexture = getDxInterop()->registerObject( mInteropDevice, frameTexture, textureId, GL_TEXTURE_2D, WGL_ACCESS_READ_ONLY_NV );
+		if( mInteropTexture ) {
+			mTexture = gl::Texture( GL_TEXTURE_2D, textureId, mWidth, mHeight, false );
+			mTexture.setMinFilter( GL_LINEAR );
+			mTexture.setMagFilter( GL_LINEAR );
+			return;
+		}
+
+		glDeleteTextures( 1, &textureId );
+		getDxInterop()->closeDevice( mInteropDevice );
+		mInteropDevice = NULL;
+	}
+
+	// without the interop, frames are read back through a staging texture and streamed into a regular Texture
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	ID3D11Texture2D *stagingTexture = NULL;
+	if( FAILED( mDevice->CreateTexture2D( &desc, NULL, &stagingTexture ) ) )
+		throw MovieGlExc( "Failed to create Direct3D 11 staging texture" );
+	mStagingTexture = makeComUnique( stagingTexture );
+
+	gl::Texture::Format format;
+	format.enableStreaming();
+	mTexture = gl::Texture( mWidth, mHeight, format );
+}
+
+bool MovieGl::Obj::checkNewFrame()
+{
+	LONGLONG presentationTime;
+	if( mFrameTexture && ( ! mNewFrame ) && ( mEngine->OnVideoStreamTick( &presentationTime ) == S_OK ) )
+		mNewFrame = true;
+
+	return mNewFrame;
+}
+
+void MovieGl::Obj::transferFrame()
+{
+	mNewFrame = false;
+
+	// Direct3D can only render into the texture while OpenGL doesn't have it locked
+	if( mInteropLocked ) {
+		getDxInterop()->unlockObjects( mInteropDevice, 1, &mInteropTexture );
+		mInteropLocked = false;
+	}
+
+	RECT dstRect = { 0, 0, mWidth, mHeight };
+	MFARGB borderColor = { 0, 0, 0, 255 };
+	HRESULT hr = mEngine->TransferVideoFrame( mFrameTexture.get(), NULL, &dstRect, &borderColor );
+
+	if( mInteropTexture ) {
+		mInteropLocked = getDxInterop()->lockObjects( mInteropDevice, 1, &mInteropTexture ) != FALSE;
+		return;
+	}
+
+	if( FAILED( hr ) )
+		return;
+
+	mDeviceContext->CopyResource( mStagingTexture.get(), mFrameTexture.get() );
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	if( SUCCEEDED( mDeviceContext->Map( mStagingTexture.get(), 0, D3D11_MAP_READ, 0, &mapped ) ) ) {
+		mTexture.update( Surface8u( reinterpret_cast<uint8_t*>( mapped.pData ), mWidth, mHeight, mapped.RowPitch, SurfaceChannelOrder::BGRA ) );
+		mDeviceContext->Unmap( mStagingTexture.get(), 0 );
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MovieGl
+MovieGl::MovieGl( const fs::path &path )
+	: mObj( new Obj( path ) )
+{
+}
+
+bool MovieGl::checkPlayable() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mPlayable;
+}
+
+int32_t MovieGl::getWidth() const
+{
+	return mObj->mWidth;
+}
+
+int32_t MovieGl::getHeight() const
+{
+	return mObj->mHeight;
+}
+
+float MovieGl::getDuration() const
+{
+	return mObj->mDuration;
+}
+
+bool MovieGl::hasVisuals() const
+{
+	return mObj->mHasVideo;
+}
+
+bool MovieGl::hasAudio() const
+{
+	return mObj->mHasAudio;
+}
+
+bool MovieGl::checkNewFrame()
+{
+	return mObj->checkNewFrame();
+}
+
+float MovieGl::getCurrentTime() const
+{
+	return (float)mObj->mEngine->GetCurrentTime();
+}
+
+void MovieGl::seekToTime( float seconds )
+{
+	mObj->mEngine->SetCurrentTime( seconds );
+}
+
+void MovieGl::seekToStart()
+{
+	seekToTime( 0 );
+}
+
+void MovieGl::seekToEnd()
+{
+	seekToTime( getDuration() );
+}
+
+void MovieGl::setLoop( bool loop )
+{
+	mObj->mEngine->SetLoop( loop ? TRUE : FALSE );
+}
+
+void MovieGl::stepForward()
+{
+	if( mObj->mEngineEx )
+		mObj->mEngineEx->FrameStep( TRUE );
+}
+
+void MovieGl::stepBackward()
+{
+	if( mObj->mEngineEx )
+		mObj->mEngineEx->FrameStep( FALSE );
+}
+
+void MovieGl::setRate( float rate )
+{
+	if( rate == 0 ) {
+		stop();
+		return;
+	}
+
+	mObj->mEngine->SetPlaybackRate( rate );
+	play();
+}
+
+void MovieGl::setVolume( float volume )
+{
+	mObj->mEngine->SetVolume( volume );
+}
+
+float MovieGl::getVolume() const
+{
+	return (float)mObj->mEngine->GetVolume();
+}
+
+bool MovieGl::isPlaying() const
+{
+	return ( ! mObj->mEngine->IsPaused() ) && ( ! mObj->mEngine->IsEnded() );
+}
+
+bool MovieGl::isDone() const
+{
+	return mObj->mEngine->IsEnded() != FALSE;
+}
+
+void MovieGl::play()
+{
+	mObj->mEngine->Play();
+}
+
+void MovieGl::stop()
+{
+	mObj->mEngine->Pause();
+}
+
+const gl::Texture MovieGl::getTexture()
+{
+	if( mObj->checkNewFrame() )
+		mObj->transferFrame();
+
+	return mObj->mTexture;
+}
+
+} } // namespace cinder::msw
@@ -31,6 +31,10 @@
 #if defined( USE_DIRECTX )
 #include "cinder/dx/dx.h"
 #include "cinder/app/AppImplMswRendererDx.h"
+#else
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/StateCache.h"
 #endif
 
 using namespace std;
@@ -72,7 +76,24 @@ namespace {
 #undef SYNONYM
 #undef HOMONYM
 
-void mouseDown( int twWindowId, app::MouseEvent &event )
+// records whether window events have changed what AntTweakBar would draw, for InterfaceGl's cached drawing
+struct EventTracker {
+	EventTracker() : mDirty( true ), mHovered( false ) {}
+
+	// a pointer event that AntTweakBar handled may have changed its highlighting, as may the first one after it stops handling them
+	void noteMouseEvent( bool handled )
+	{
+		if( handled || mHovered )
+			mDirty = true;
+		mHovered = handled;
+	}
+
+	bool	mDirty, mHovered;
+};
+
+typedef std::shared_ptr<EventTracker>	EventTrackerRef;
+
+void mouseDown( int twWindowId, const EventTrackerRef &tracker, app::MouseEvent &event )
 {
 	TwSetCurrentWindow( twWindowId );
 
@@ -84,9 +105,10 @@ void mouseDown( int twWindowId, app::MouseEvent &event )
 	else
 		button = TW_MOUSE_MIDDLE;
 	event.setHandled( TwMouseButton( TW_MOUSE_PRESSED, button ) != 0 );
+	tracker->noteMouseEvent( event.isHandled() );
 }
 
-void mouseUp( int twWindowId, app::MouseEvent &event )
+void mouseUp( int twWindowId, const EventTrackerRef &tracker, app::MouseEvent &event )
 {
 	TwSetCurrentWindow( twWindowId );
 
@@ -98,28 +120,31 @@ void mouseUp( int twWindowId, app::MouseEvent &event )
 	else
 		button = TW_MOUSE_MIDDLE;
 	event.setHandled( TwMouseButton( TW_MOUSE_RELEASED, button ) != 0 );
+	tracker->noteMouseEvent( event.isHandled() );
 }
 
-void mouseWheel( int twWindowId, app::MouseEvent &event )
+void mouseWheel( int twWindowId, const EventTrackerRef &tracker, app::MouseEvent &event )
 {
 	TwSetCurrentWindow( twWindowId );
 
 	static float sWheelPos = 0;
 	sWheelPos += event.getWheelIncrement();
 	event.setHandled( TwMouseWheel( (int)(sWheelPos) ) != 0 );
+	tracker->noteMouseEvent( event.isHandled() );
 }
 
-void mouseMove( weak_ptr<app::Window> winWeak, int twWindowId, app::MouseEvent &event )
+void mouseMove( weak_ptr<app::Window> winWeak, int twWindowId, const EventTrackerRef &tracker, app::MouseEvent &event )
 {
 	TwSetCurrentWindow( twWindowId );
 
 	auto win = winWeak.lock();
 	if( win ) {
 		event.setHandled( TwMouseMotion( win->toPixels( event.getX() ), win->toPixels( event.getY() ) ) != 0 );
+		tracker->noteMouseEvent( event.isHandled() );
 	}
 }
 
-void keyDown( int twWindowId, app::KeyEvent &event )
+void keyDown( int twWindowId, const EventTrackerRef &tracker, app::KeyEvent &event )
 {
 	TwSetCurrentWindow( twWindowId );
 
@@ -135,15 +160,45 @@ void keyDown( int twWindowId, app::KeyEvent &event )
                 ? specialKeys[event.getCode()]
                 : event.getChar(),
             kmod ) != 0 );
+	if( event.isHandled() )
+		tracker->mDirty = true;
 }
 
-void resize( weak_ptr<app::Window> winWeak, int twWindowId )
+void resize( weak_ptr<app::Window> winWeak, int twWindowId, const EventTrackerRef &tracker )
 {
 	TwSetCurrentWindow( twWindowId );
 
 	auto win = winWeak.lock();
 	if( win )
 		TwWindowSize( win->toPixels( win->getWidth() ), win->toPixels( win->getHeight() ) );
+	tracker->mDirty = true;
+}
+
+// returns a function that reports whether *target has changed since it was last called
+template <typename T>
+std::function<bool ()> makeValueWatcher( const T *target )
+{
+	auto lastValue = std::make_shared<T>( *target );
+	return [target, lastValue]() -> bool {
+		if( *target == *lastValue )
+			return false;
+		*lastValue = *target;
+		return true;
+	};
+}
+
+// returns a function that reports whether the value returned by getter has changed since it was last called
+template <typename T>
+std::function<bool ()> makeValueWatcher( const std::function<T ()> &getter )
+{
+	auto lastValue = std::make_shared<T>( getter() );
+	return [getter, lastValue]() -> bool {
+		T value = getter();
+		if( value == *lastValue )
+			return false;
+		*lastValue = value;
+		return true;
+	};
 }
 
 void TW_CALL implStdStringToClient( std::string& destinationClientString, const std::string& sourceLibraryString )
@@ -224,6 +279,20 @@ void TW_CALL getterCallback<string>( void *value, void *clientData )
 
 } // anonymous namespace
 
+struct InterfaceGl::Cache {
+	Cache()
+		: mEnabled( false ), mEvents( new EventTracker ), mRefreshInterval( 0.1 ), mLastPollTime( -1.0 )
+	{}
+
+	bool										mEnabled;
+	EventTrackerRef								mEvents;
+	double										mRefreshInterval, mLastPollTime;
+	std::map<std::string, std::function<bool ()> >	mValueWatchers; // key = param name
+#if ! defined( USE_DIRECTX )
+	gl::Fbo										mFbo;
+#endif
+};
+
 int initAntGl( weak_ptr<app::Window> winWeak )
 {
 	static std::shared_ptr<AntMgr> sMgr;
@@ -265,6 +334,7 @@ void InterfaceGl::init( app::WindowRef window, const std::string &title, const V
 	TwSetCurrentWindow( mTwWindowId );
 		
 	mWindow = window;
+	mCache = std::make_shared<Cache>();
 
 	mBar = std::shared_ptr<TwBar>( TwNewBar( title.c_str() ), std::bind( tweakBarDeleter, mTwWindowId, std::placeholders::_1 ) );
 	TwWindowSize( window->toPixels( window->getWidth() ), window->toPixels( window->getHeight() ) );
@@ -274,20 +344,128 @@ void InterfaceGl::init( app::WindowRef window, const std::string &title, const V
 	
 	TwCopyStdStringToClientFunc( implStdStringToClient );	
 
-	window->getSignalMouseDown().connect( std::bind( mouseDown, mTwWindowId, std::placeholders::_1 ) );
-	window->getSignalMouseUp().connect( std::bind( mouseUp, mTwWindowId, std::placeholders::_1 ) );
-	window->getSignalMouseWheel().connect( std::bind( mouseWheel, mTwWindowId, std::placeholders::_1 ) );
-	window->getSignalMouseMove().connect( std::bind( mouseMove, mWindow, mTwWindowId, std::placeholders::_1 ) );
-	window->getSignalMouseDrag().connect( std::bind( mouseMove, mWindow, mTwWindowId, std::placeholders::_1 ) );
-	window->getSignalKeyDown().connect( std::bind( keyDown, mTwWindowId, std::placeholders::_1 ) );
-	window->getSignalResize().connect( std::bind( resize, mWindow, mTwWindowId ) );
+	EventTrackerRef tracker = mCache->mEvents;
+	window->getSignalMouseDown().connect( std::bind( mouseDown, mTwWindowId, tracker, std::placeholders::_1 ) );
+	window->getSignalMouseUp().connect( std::bind( mouseUp, mTwWindowId, tracker, std::placeholders::_1 ) );
+	window->getSignalMouseWheel().connect( std::bind( mouseWheel, mTwWindowId, tracker, std::placeholders::_1 ) );
+	window->getSignalMouseMove().connect( std::bind( mouseMove, mWindow, mTwWindowId, tracker, std::placeholders::_1 ) );
+	window->getSignalMouseDrag().connect( std::bind( mouseMove, mWindow, mTwWindowId, tracker, std::placeholders::_1 ) );
+	window->getSignalKeyDown().connect( std::bind( keyDown, mTwWindowId, tracker, std::placeholders::_1 ) );
+	window->getSignalResize().connect( std::bind( resize, mWindow, mTwWindowId, tracker ) );
 }
 
 void InterfaceGl::draw()
 {
+#if ! defined( USE_DIRECTX )
+	if( mCache && mCache->mEnabled ) {
+		drawCached();
+		return;
+	}
+#endif
+
 	TwSetCurrentWindow( mTwWindowId );
 	
 	TwDraw();
+#if ! defined( USE_DIRECTX )
+	// AntTweakBar changes GL state directly
+	gl::StateCache::invalidate();
+#endif
+}
+
+void InterfaceGl::drawCached()
+{
+#if ! defined( USE_DIRECTX )
+	auto window = mWindow.lock();
+	if( ! window )
+		return;
+
+	TwSetCurrentWindow( mTwWindowId );
+
+	// AntTweakBar only reads bound values when it draws, so poll them ourselves at the refresh rate
+	double now = app::getElapsedSeconds();
+	bool valuesChanged = false;
+	if( mCache->mLastPollTime < 0 || now - mCache->mLastPollTime >= mCache->mRefreshInterval ) {
+		mCache->mLastPollTime = now;
+		for( auto watcherIt = mCache->mValueWatchers.begin(); watcherIt != mCache->mValueWatchers.end(); ++watcherIt ) {
+			// every watcher is called so that each records its current value
+			if( watcherIt->second() )
+				valuesChanged = true;
+		}
+		// AntTweakBar otherwise re-reads values on its own timer, which may not have elapsed yet
+		if( valuesChanged )
+			TwRefreshBar( mBar.get() );
+	}
+
+	Vec2i fboSize( window->toPixels( window->getWidth() ), window->toPixels( window->getHeight() ) );
+	if( ! mCache->mFbo || mCache->mFbo.getSize() != fboSize ) {
+		gl::Fbo::Format format;
+		format.enableDepthBuffer( false );
+		mCache->mFbo = gl::Fbo( fboSize.x, fboSize.y, format );
+		mCache->mEvents->mDirty = true;
+	}
+
+	if( mCache->mEvents->mDirty || valuesChanged ) {
+		gl::SaveFramebufferBinding saveFramebuffer;
+		mCache->mFbo.bindFramebuffer();
+		glPushAttrib( GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT );
+		glViewport( 0, 0, fboSize.x, fboSize.y );
+		glClearColor( 0, 0, 0, 0 );
+		glClear( GL_COLOR_BUFFER_BIT );
+		TwDraw();
+		glPopAttrib();
+		mCache->mEvents->mDirty = false;
+	}
+
+	// AntTweakBar leaves premultiplied color in the Fbo
+	glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT );
+	gl::StateCache::invalidate();
+	gl::pushMatrices();
+	gl::setMatricesWindow( window->getSize() );
+	gl::disableDepthRead();
+	gl::enableAlphaBlending( true );
+	gl::color( ColorA::white() );
+	gl::draw( mCache->mFbo.getTexture(), Rectf( window->getBounds() ) );
+	gl::popMatrices();
+	glPopAttrib();
+	gl::StateCache::invalidate();
+#endif
+}
+
+void InterfaceGl::enableCaching( bool enable )
+{
+	mCache->mEnabled = enable;
+	invalidate();
+#if ! defined( USE_DIRECTX )
+	if( ! enable )
+		mCache->mFbo = gl::Fbo();
+#endif
+}
+
+bool InterfaceGl::isCachingEnabled() const
+{
+	return mCache->mEnabled;
+}
+
+void InterfaceGl::setRefreshRate( float hz )
+{
+	mCache->mRefreshInterval = ( hz > 0 ) ? 1.0 / hz : 0;
+}
+
+float InterfaceGl::getRefreshRate() const
+{
+	return ( mCache->mRefreshInterval > 0 ) ? (float)( 1.0 / mCache->mRefreshInterval ) : 0;
+}
+
+void InterfaceGl::invalidate()
+{
+	if( mCache )
+		mCache->mEvents->mDirty = true;
+}
+
+void InterfaceGl::addValueWatcher( const std::string &name, const std::function<bool ()> &changedFn )
+{
+	mCache->mValueWatchers[name] = changedFn;
+	invalidate();
 }
 
 void InterfaceGl::show( bool visible )
@@ -296,6 +474,7 @@ void InterfaceGl::show( bool visible )
 	
 	int32_t visibleInt = ( visible ) ? 1 : 0;
 	TwSetParam( mBar.get(), NULL, "visible", TW_PARAM_INT32, 1, &visibleInt );
+	invalidate();
 }
 
 void InterfaceGl::hide()
@@ -318,6 +497,7 @@ void InterfaceGl::maximize( bool maximized )
 	
 	int32_t maximizedInt = ( maximized ) ? 0 : 1;
 	TwSetParam( mBar.get(), NULL, "iconified", TW_PARAM_INT32, 1, &maximizedInt );
+	invalidate();
 }
 
 void InterfaceGl::minimize()
@@ -465,51 +645,61 @@ void InterfaceGl::implAddParamDeprecated( const std::string &name, void *param,
 		TwAddVarRO( mBar.get(), name.c_str(), (TwType)type, param, optionsStr.c_str() );
 	else
 		TwAddVarRW( mBar.get(), name.c_str(), (TwType)type, param, optionsStr.c_str() );
+	invalidate();
 }
 
 void InterfaceGl::addParam( const std::string &name, bool *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_BOOLCPP, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, float *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_FLOAT, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, double *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_DOUBLE, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, int32_t *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_INT32, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, Vec3f *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_DIR3F, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, Quatf *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_QUAT4F, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, Color *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_COLOR3F, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, ColorA *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_COLOR4F, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 } 
 
 void InterfaceGl::addParam( const std::string &name, std::string *param, const std::string &optionsStr, bool readOnly )
 {
 	implAddParamDeprecated( name, param, TW_TYPE_STDSTRING, optionsStr, readOnly );
+	addValueWatcher( name, makeValueWatcher( param ) );
 }
 
 void InterfaceGl::addParam( const std::string &name, const std::vector<std::string> &enumNames, int *param, const std::string &optionsStr, bool readOnly )
@@ -530,6 +720,7 @@ void InterfaceGl::addParam( const std::string &name, const std::vector<std::stri
 		TwAddVarRW( mBar.get(), name.c_str(), evType, param, optionsStr.c_str() );
 		
 	delete [] ev;
+	addValueWatcher( name, makeValueWatcher( param ) );
 }
 
 void InterfaceGl::addSeparator( const std::string &name, const std::string &optionsStr )
@@ -537,6 +728,7 @@ void InterfaceGl::addSeparator( const std::string &name, const std::string &opti
 	TwSetCurrentWindow( mTwWindowId );
 	
 	TwAddSeparator( mBar.get(), name.c_str(), optionsStr.c_str() );
+	invalidate();
 }
 
 void InterfaceGl::addText( const std::string &name, const std::string &optionsStr )
@@ -544,6 +736,7 @@ void InterfaceGl::addText( const std::string &name, const std::string &optionsSt
 	TwSetCurrentWindow( mTwWindowId );
 	
 	TwAddButton( mBar.get(), name.c_str(), NULL, NULL, optionsStr.c_str() );
+	invalidate();
 }
 
 void InterfaceGl::addButton( const std::string &name, const std::function<void ()> &callback, const std::string &optionsStr )
@@ -554,6 +747,7 @@ void InterfaceGl::addButton( const std::string &name, const std::function<void (
 	mStoredCallbacks.insert( make_pair( name, callbackPtr ) );
 
 	TwAddButton( mBar.get(), name.c_str(), buttonCallback, (void*)callbackPtr.get(), optionsStr.c_str() );
+	invalidate();
 }
 
 void InterfaceGl::removeParam( const std::string &name )
@@ -562,6 +756,8 @@ void InterfaceGl::removeParam( const std::string &name )
 	TwRemoveVar( mBar.get(), name.c_str() );
 
 	mStoredCallbacks.erase( name );
+	mCache->mValueWatchers.erase( name );
+	invalidate();
 }
 
 void InterfaceGl::clear()
@@ -570,6 +766,8 @@ void InterfaceGl::clear()
 	TwRemoveAllVars( mBar.get() );
 
 	mStoredCallbacks.clear();
+	mCache->mValueWatchers.clear();
+	invalidate();
 }
 
 void InterfaceGl::setOptions( const std::string &name, const std::string &optionsStr )
@@ -581,6 +779,7 @@ void InterfaceGl::setOptions( const std::string &name, const std::string &option
 		target += "/`" + name + "`";
 
 	TwDefine( ( target + " " + optionsStr ).c_str() );
+	invalidate();
 }
 
 template <typename T>
@@ -595,6 +794,8 @@ InterfaceGl::Options<T> InterfaceGl::addParamImpl( const std::string &name, T *t
 			TwAddVarRO( mBar.get(), name.c_str(), (TwType)type, target, NULL );
 		else
 			TwAddVarRW( mBar.get(), name.c_str(), (TwType)type, target, NULL );
+
+		addValueWatcher( name, makeValueWatcher( target ) );
 	}
 
 	return options;
@@ -612,6 +813,7 @@ void InterfaceGl::addParamCallbackImpl( const function<void (T)> &setter, const
 	mStoredCallbacks.insert( make_pair( name, callbackPtr ) );
 
 	TwAddVarCB( mBar.get(), name.c_str(), (TwType) type, setterCallback<T>, getterCallback<T>, (void *)callbackPtr.get(), NULL );
+	addValueWatcher( name, makeValueWatcher( getter ) );
 }
 
 template <> InterfaceGl::Options<bool>		InterfaceGl::addParam( const std::string &name, bool *param, bool readOnly )		{ return addParamImpl( name, param, TW_TYPE_BOOLCPP, readOnly ); }
@@ -0,0 +1,345 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if defined( CINDER_COCOA ) && ( ! defined( __OBJC__ ) )
+	#error "This file must be compiled as Objective-C++ on the Mac"
+#endif
+
+#include "cinder/qtime/HardwareEncoder.h"
+#include "cinder/CinderMath.h"
+
+#if defined( CINDER_COCOA )
+	#import <AVFoundation/AVFoundation.h>
+	#include <CoreMedia/CoreMedia.h>
+	#include <CoreVideo/CoreVideo.h>
+	#include <thread>
+#elif defined( CINDER_MSW )
+	#include "cinder/msw/CinderMsw.h"
+	#include <mfapi.h>
+	#include <mfidl.h>
+	#include <mfreadwrite.h>
+	#include <codecapi.h>
+	#include <strmif.h>
+
+	#pragma comment( lib, "mfplat.lib" )
+	#pragma comment( lib, "mfreadwrite.lib" )
+	#pragma comment( lib, "mfuuid.lib" )
+#endif
+
+namespace cinder { namespace qtime {
+
+int32_t HardwareEncoder::getBitRateForQuality( float quality, int32_t width, int32_t height, double frameRate )
+{
+	const double bitsPerPixel = lerp<double>( 0.02, 0.4, constrain<float>( quality, 0, 1 ) );
+	return (int32_t)std::min<double>( bitsPerPixel * width * height * frameRate, 2000000000.0 );
+}
+
+#if defined( CINDER_COCOA )
+
+struct HardwareEncoder::Impl {
+	Impl() : mWriter( nil ), mInput( nil ), mAdaptor( nil ), mEndTime( kCMTimeZero ) {}
+	~Impl()
+	{
+		[mAdaptor release];
+		[mInput release];
+		[mWriter release];
+	}
+
+	AVAssetWriter							*mWriter;
+	AVAssetWriterInput						*mInput;
+	AVAssetWriterInputPixelBufferAdaptor	*mAdaptor;
+	int32_t									mWidth, mHeight;
+	CMTime									mEndTime;
+};
+
+std::unique_ptr<HardwareEncoder> HardwareEncoder::create( const fs::path &path, const Options &options )
+{
+	std::unique_ptr<HardwareEncoder> result( new HardwareEncoder );
+	Impl *impl = result->mImpl.get();
+	impl->mWidth = options.mWidth;
+	impl->mHeight = options.mHeight;
+
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+	// AVAssetWriter refuses to replace an existing file
+	NSURL *url = [NSURL fileURLWithPath:[NSString stringWithUTF8String:path.string().c_str()]];
+	[[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+
+	const std::string extension = path.extension().string();
+	NSString *fileType = ( ( extension == ".mp4" ) || ( extension == ".m4v" ) ) ? AVFileTypeMPEG4 : AVFileTypeQuickTimeMovie;
+	NSError *error = nil;
+	impl->mWriter = [[AVAssetWriter alloc] initWithURL:url fileType:fileType error:&error];
+
+	bool started = false;
+	if( impl->mWriter ) {
+		const int32_t bitRate = options.mAverageBitRate ? options.mAverageBitRate : getBitRateForQuality( options.mQuality, options.mWidth, options.mHeight, options.mFrameRate );
+		NSMutableDictionary *compression = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+			[NSNumber numberWithInt:bitRate], AVVideoAverageBitRateKey,
+			AVVideoProfileLevelH264HighAutoLevel, AVVideoProfileLevelKey,
+			nil];
+		if( options.mMaxKeyFrameInterval > 0 )
+			[compression setObject:[NSNumber numberWithInt:options.mMaxKeyFrameInterval] forKey:AVVideoMaxKeyFrameIntervalKey];
+
+		NSDictionary *settings = [NSDictionary dictionaryWithObjectsAndKeys:
+			AVVideoCodecH264, AVVideoCodecKey,
+			[NSNumber numberWithInt:options.mWidth], AVVideoWidthKey,
+			[NSNumber numberWithInt:options.mHeight], AVVideoHeightKey,
+			compression, AVVideoCompressionPropertiesKey,
+			nil];
+		impl->mInput = [[AVAssetWriterInput alloc] initWithMediaType:AVMediaTypeVideo outputSettings:settings];
+		impl->mInput.expectsMediaDataInRealTime = YES;
+
+		// IOSurface backed buffers reach the encoder without another copy
+		NSDictionary *bufferAttributes = [NSDictionary dictionaryWithObjectsAndKeys:
+			[NSNumber numberWithInt:kCVPixelFormatType_32BGRA], (id)kCVPixelBufferPixelFormatTypeKey,
+			[NSNumber numberWithInt:options.mWidth], (id)kCVPixelBufferWidthKey,
+			[NSNumber numberWithInt:options.mHeight], (id)kCVPixelBufferHeightKey,
+			[NSDictionary dictionary], (id)kCVPixelBufferIOSurfacePropertiesKey,
+			nil];
+		impl->mAdaptor = [[AVAssetWriterInputPixelBufferAdaptor alloc] initWithAssetWriterInput:impl->mInput sourcePixelBufferAttributes:bufferAttributes];
+
+		if( [impl->mWriter canAddInput:impl->mInput] ) {
+			[impl->mWriter addInput:impl->mInput];
+			started = [impl->mWriter startWriting];
+			if( started )
+				[impl->mWriter startSessionAtSourceTime:kCMTimeZero];
+		}
+	}
+
+	[pool drain];
+
+	if( ! started )
+		result.reset();
+	return result;
+}
+
+bool HardwareEncoder::encodeFrame( const Surface8u &surface, double time, double duration )
+{
+	Impl *impl = mImpl.get();
+	if( impl->mWriter.status != AVAssetWriterStatusWriting )
+		return false;
+
+	// the input only turns away frames while the encoder's queue is full, which clears as it works through it
+	while( ! impl->mInput.readyForMoreMediaData ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		if( impl->mWriter.status != AVAssetWriterStatusWriting )
+			return false;
+	}
+
+	CVPixelBufferRef pixelBuffer = NULL;
+	if( ( ! impl->mAdaptor.pixelBufferPool ) || ( ::CVPixelBufferPoolCreatePixelBuffer( kCFAllocatorDefault, impl->mAdaptor.pixelBufferPool, &pixelBuffer ) != kCVReturnSuccess ) )
+		return false;
+
+	::CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	Surface8u frame( reinterpret_cast<uint8_t*>( ::CVPixelBufferGetBaseAddress( pixelBuffer ) ), impl->mWidth, impl->mHeight, (int32_t)::CVPixelBufferGetBytesPerRow( pixelBuffer ), SurfaceChannelOrder::BGRA );
+	frame.copyFrom( surface, surface.getBounds() );
+	::CVPixelBufferUnlockBaseAddress( pixelBuffer, 0 );
+
+	const int32_t timeScale = 60000;
+	BOOL appended = [impl->mAdaptor appendPixelBuffer:pixelBuffer withPresentationTime:::CMTimeMakeWithSeconds( time, timeScale )];
+	::CVPixelBufferRelease( pixelBuffer );
+
+	impl->mEndTime = ::CMTimeMakeWithSeconds( time + duration, timeScale );
+	return appended == YES;
+}
+
+bool HardwareEncoder::finish()
+{
+	Impl *impl = mImpl.get();
+	if( impl->mWriter.status != AVAssetWriterStatusWriting )
+		return false;
+
+	// without an explicit end, the last frame would have no duration
+	[impl->mInput markAsFinished];
+	[impl->mWriter endSessionAtSourceTime:impl->mEndTime];
+	return [impl->mWriter finishWriting] == YES;
+}
+
+#elif defined( CINDER_MSW )
+
+struct HardwareEncoder::Impl {
+	Impl() : mStreamIndex( 0 ) {}
+
+	std::unique_ptr<IMFSinkWriter, msw::ComDeleter>		mWriter;
+	DWORD												mStreamIndex;
+	int32_t												mWidth, mHeight;
+};
+
+namespace {
+
+bool setVideoType( IMFMediaType *type, const GUID &subtype, const HardwareEncoder::Options &options )
+{
+	// frame rates are expressed as a ratio, 1000 / 1001 multiples included
+	const UINT32 frameRateDenominator = 1001;
+	const UINT32 frameRateNumerator = (UINT32)( options.mFrameRate * frameRateDenominator + 0.5 );
+
+	return SUCCEEDED( type->SetGUID( MF_MT_MAJOR_TYPE, MFMediaType_Video ) )
+		&& SUCCEEDED( type->SetGUID( MF_MT_SUBTYPE, subtype ) )
+		&& SUCCEEDED( type->SetUINT32( MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive ) )
+		&& SUCCEEDED( ::MFSetAttributeSize( type, MF_MT_FRAME_SIZE, options.mWidth, options.mHeight ) )
+		&& SUCCEEDED( ::MFSetAttributeRatio( type, MF_MT_FRAME_RATE, frameRateNumerator, frameRateDenominator ) )
+		&& SUCCEEDED( ::MFSetAttributeRatio( type, MF_MT_PIXEL_ASPECT_RATIO, 1, 1 ) );
+}
+
+void setCodecValue( ICodecAPI *codecApi, const GUID &property, UINT32 value )
+{
+	VARIANT variant;
+	::VariantInit( &variant );
+	variant.vt = VT_UI4;
+	variant.ulVal = value;
+	codecApi->SetValue( &property, &variant );
+}
+
+} // anonymous namespace
+
+std::unique_ptr<HardwareEncoder> HardwareEncoder::create( const fs::path &path, const Options &options )
+{
+	static bool sStarted = false;
+	if( ! sStarted ) {
+		sStarted = true;
+		::MFStartup( MF_VERSION );
+	}
+
+	std::unique_ptr<HardwareEncoder> result( new HardwareEncoder );
+	Impl *impl = result->mImpl.get();
+	impl->mWidth = options.mWidth;
+	impl->mHeight = options.mHeight;
+
+	IMFAttributes *attributes = NULL;
+	if( FAILED( ::MFCreateAttributes( &attributes, 1 ) ) )
+		return std::unique_ptr<HardwareEncoder>();
+	auto attributesPtr = msw::makeComUnique( attributes );
+	attributes->SetUINT32( MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE );
+
+	IMFSinkWriter *writer = NULL;
+	if( FAILED( ::MFCreateSinkWriterFromURL( path.wstring().c_str(), NULL, attributes, &writer ) ) )
+		return std::unique_ptr<HardwareEncoder>();
+	impl->mWriter = msw::makeComUnique( writer );
+
+	IMFMediaType *outputType = NULL, *inputType = NULL;
+	if( FAILED( ::MFCreateMediaType( &outputType ) ) )
+		return std::unique_ptr<HardwareEncoder>();
+	auto outputTypePtr = msw::makeComUnique( outputType );
+	if( FAILED( ::MFCreateMediaType( &inputType ) ) )
+		return std::unique_ptr<HardwareEncoder>();
+	auto inputTypePtr = msw::makeComUnique( inputType );
+
+	const int32_t bitRate = options.mAverageBitRate ? options.mAverageBitRate : getBitRateForQuality( options.mQuality, options.mWidth, options.mHeight, options.mFrameRate );
+	if( ( ! setVideoType( outputType, MFVideoFormat_H264, options ) )
+			|| FAILED( outputType->SetUINT32( MF_MT_AVG_BITRATE, bitRate ) )
+			|| FAILED( outputType->SetUINT32( MF_MT_MPEG2_PROFILE, eAVEncH264VProfile_High ) )
+			|| FAILED( writer->AddStream( outputType, &impl->mStreamIndex ) ) )
+		return std::unique_ptr<HardwareEncoder>();
+
+	// RGB32 is stored bottom-up unless the stride says otherwise; the Sink Writer converts it to NV12 for the encoder
+	if( ( ! setVideoType( inputType, MFVideoFormat_RGB32, options ) )
+			|| FAILED( inputType->SetUINT32( MF_MT_DEFAULT_STRIDE, options.mWidth * 4 ) )
+			|| FAILED( writer->SetInputMediaType( impl->mStreamIndex, inputType, NULL ) ) )
+		return std::unique_ptr<HardwareEncoder>();
+
+	// optional settings, which not every vendor's encoder supports
+	ICodecAPI *codecApi = NULL;
+	if( SUCCEEDED( writer->GetServiceForStream( impl->mStreamIndex, GUID_NULL, IID_PPV_ARGS( &codecApi ) ) ) ) {
+		if( options.mAverageBitRate == 0 ) {
+			setCodecValue( codecApi, CODECAPI_AVEncCommonRateControlMode, eAVEncCommonRateControlMode_Quality );
+			setCodecValue( codecApi, CODECAPI_AVEncCommonQuality, (UINT32)( constrain<float>( options.mQuality, 0, 1 ) * 100 ) );
+		}
+		if( options.mMaxKeyFrameInterval > 0 )
+			setCodecValue( codecApi, CODECAPI_AVEncMPVGOPSize, options.mMaxKeyFrameInterval );
+		setCodecValue( codecApi, CODECAPI_AVLowLatencyMode, TRUE );
+		codecApi->Release();
+	}
+
+	if( FAILED( writer->BeginWriting() ) )
+		return std::unique_ptr<HardwareEncoder>();
+
+	return result;
+}
+
+bool HardwareEncoder::encodeFrame( const Surface8u &surface, double time, double duration )
+{
+	Impl *impl = mImpl.get();
+	const DWORD rowBytes = impl->mWidth * 4, dataSize = rowBytes * impl->mHeight;
+
+	IMFMediaBuffer *buffer = NULL;
+	if( FAILED( ::MFCreateMemoryBuffer( dataSize, &buffer ) ) )
+		return false;
+	auto bufferPtr = msw::makeComUnique( buffer );
+
+	BYTE *data = NULL;
+	if( FAILED( buffer->Lock( &data, NULL, NULL ) ) )
+		return false;
+	Surface8u frame( data, impl->mWidth, impl->mHeight, rowBytes, SurfaceChannelOrder::BGRX );
+	frame.copyFrom( surface, surface.getBounds() );
+	buffer->Unlock();
+	buffer->SetCurrentLength( dataSize );
+
+	IMFSample *sample = NULL;
+	if( FAILED( ::MFCreateSample( &sample ) ) )
+		return false;
+	auto samplePtr = msw::makeComUnique( sample );
+
+	// Media Foundation measures time in 100 nanosecond units
+	sample->AddBuffer( buffer );
+	sample->SetSampleTime( (LONGLONG)( time * 10000000.0 + 0.5 ) );
+	sample->SetSampleDuration( (LONGLONG)( duration * 10000000.0 + 0.5 ) );
+
+	return SUCCEEDED( impl->mWriter->WriteSample( impl->mStreamIndex, sample ) );
+}
+
+bool HardwareEncoder::finish()
+{
+	return SUCCEEDED( mImpl->mWriter->Finalize() );
+}
+
+#else
+
+struct HardwareEncoder::Impl {};
+
+std::unique_ptr<HardwareEncoder> HardwareEncoder::create( const fs::path &path, const Options &options )
+{
+	return std::unique_ptr<HardwareEncoder>();
+}
+
+bool HardwareEncoder::encodeFrame( const Surface8u &surface, double time, double duration )
+{
+	return false;
+}
+
+bool HardwareEncoder::finish()
+{
+	return false;
+}
+
+#endif
+
+HardwareEncoder::HardwareEncoder()
+	: mImpl( new Impl )
+{
+}
+
+HardwareEncoder::~HardwareEncoder()
+{
+}
+
+} } // namespace cinder::qtime
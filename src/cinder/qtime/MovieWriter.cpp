@@ -80,7 +80,7 @@ MovieWriter::Format::Format( uint32_t codec, float quality )
 }
 
 MovieWriter::Format::Format( const ICMCompressionSessionOptionsRef options, uint32_t codec, float quality, float frameRate, bool enableMultiPass )
-	: mCodec( codec ), mEnableMultiPass( enableMultiPass )
+	: mCodec( codec ), mEnableMultiPass( enableMultiPass ), mAsync( false ), mMaxFramesInFlight( 4 ), mReadbackLatency( 2 ), mHardwareEncoding( false ), mAverageBitRate( 0 )
 {
 	::ICMCompressionSessionOptionsCreateCopy( NULL, options, &mOptions );
 	setQuality( quality );
@@ -90,7 +90,9 @@ MovieWriter::Format::Format( const ICMCompressionSessionOptionsRef options, uint
 }
 
 MovieWriter::Format::Format( const Format &format )
-	: mCodec( format.mCodec ), mTimeBase( format.mTimeBase ), mDefaultTime( format.mDefaultTime ), mGamma( format.mGamma ), mEnableMultiPass( format.mEnableMultiPass ), mQualityFloat( format.mQualityFloat )
+	: mCodec( format.mCodec ), mTimeBase( format.mTimeBase ), mDefaultTime( format.mDefaultTime ), mGamma( format.mGamma ), mEnableMultiPass( format.mEnableMultiPass ), mQualityFloat( format.mQualityFloat ),
+		mAsync( format.mAsync ), mMaxFramesInFlight( format.mMaxFramesInFlight ), mReadbackLatency( format.mReadbackLatency ),
+		mHardwareEncoding( format.mHardwareEncoding ), mAverageBitRate( format.mAverageBitRate )
 {
 	::ICMCompressionSessionOptionsCreateCopy( NULL, format.mOptions, &mOptions );
 }
@@ -109,6 +111,11 @@ void MovieWriter::Format::initDefaults()
 	mDefaultTime = 1 / 30.0f;
 	mGamma = PLATFORM_DEFAULT_GAMMA;
 	mEnableMultiPass = false;
+	mAsync = false;
+	mMaxFramesInFlight = 4;
+	mReadbackLatency = 2;
+	mHardwareEncoding = false;
+	mAverageBitRate = 0;
 
 	enableTemporal( true );
 	enableReordering( true );
@@ -190,6 +197,11 @@ const MovieWriter::Format& MovieWriter::Format::operator=( const Format &format
 	mDefaultTime = format.mDefaultTime;
 	mGamma = format.mGamma;
 	mEnableMultiPass = format.mEnableMultiPass;
+	mAsync = format.mAsync;
+	mMaxFramesInFlight = format.mMaxFramesInFlight;
+	mReadbackLatency = format.mReadbackLatency;
+	mHardwareEncoding = format.mHardwareEncoding;
+	mAverageBitRate = format.mAverageBitRate;
 
 	return *this;
 }
@@ -203,13 +215,53 @@ MovieWriter::MovieWriter( const fs::path &path, int32_t width, int32_t height, c
 
 MovieWriter::Obj::~Obj()
 {
-	if( ! mFinished )
-		finish();
+	if( ! mFinished ) {
+		try {
+			finish();
+		}
+		catch( ... ) {
+		}
+	}
 }
 
 MovieWriter::Obj::Obj( const fs::path &path, int32_t width, int32_t height, const Format &format )
-	: mPath( path ), mWidth( width ), mHeight( height ), mFormat( format ), mFinished( false )
-{	
+	: mPath( path ), mWidth( width ), mHeight( height ), mFormat( format ), mFinished( false ), mNumCompressing( 0 ), mStopCompressionThread( false ),
+		mMovie( NULL ), mDataHandler( NULL ), mTrack( NULL ), mMedia( NULL ), mCompressionSession( NULL )
+{
+	mRequestedMultiPass = false;
+	mDoingMultiPass = false;
+
+	if( mFormat.mHardwareEncoding && mFormat.mCodec == CODEC_H264 ) {
+		HardwareEncoder::Options options;
+		options.mWidth = width;
+		options.mHeight = height;
+		options.mFrameRate = 1.0 / mFormat.mDefaultTime;
+		options.mQuality = mFormat.mQualityFloat;
+		options.mAverageBitRate = mFormat.mAverageBitRate;
+		options.mMaxKeyFrameInterval = mFormat.getMaxKeyFrameRate();
+		mHardwareEncoder = HardwareEncoder::create( path, options );
+	}
+
+	// without a hardware encoder the movie is compressed by QuickTime as usual
+	if( ! mHardwareEncoder ) {
+		createMovie();
+		createCompressionSession();
+	}
+
+	mCurrentTimeValue = 0;
+	mNumFrames = 0;
+	mNumStalls = 0;
+
+	if( mFormat.mAsync ) {
+		// a Movie may only be used by one thread at a time; the compression thread attaches it for as long as it runs
+		if( mMovie )
+			::DetachMovieFromCurrentThread( mMovie );
+		mCompressionThread = std::thread( std::bind( &MovieWriter::Obj::compressionThreadFn, this ) );
+	}
+}
+
+void MovieWriter::Obj::createMovie()
+{
     OSErr       err = noErr;
     Handle      dataRef;
     OSType      dataRefType;
@@ -217,7 +269,7 @@ MovieWriter::Obj::Obj( const fs::path &path, int32_t width, int32_t height, cons
 	startQuickTime();
 
     //Create movie file
-	CFStringRef strDestMoviePath = ::CFStringCreateWithCString( kCFAllocatorDefault, path.string().c_str(), kCFStringEncodingUTF8 );
+	CFStringRef strDestMoviePath = ::CFStringCreateWithCString( kCFAllocatorDefault, mPath.string().c_str(), kCFStringEncodingUTF8 );
 	err = ::QTNewDataReferenceFromFullPathCFString( strDestMoviePath, kQTNativeDefaultPathStyle, 0, &dataRef, &dataRefType );
 	::CFRelease( strDestMoviePath );
 	if( err )
@@ -229,7 +281,7 @@ MovieWriter::Obj::Obj( const fs::path &path, int32_t width, int32_t height, cons
     if( err )
         throw MovieWriterExc();
 
-	mTrack = ::NewMovieTrack( mMovie, width << 16, height << 16, 0 );
+	mTrack = ::NewMovieTrack( mMovie, mWidth << 16, mHeight << 16, 0 );
 	err = ::GetMoviesError();
 	if( err )
 		throw MovieWriterExc();
@@ -242,23 +294,70 @@ MovieWriter::Obj::Obj( const fs::path &path, int32_t width, int32_t height, cons
 
 	//Prepare media for editing
 	err = ::BeginMediaEdits( mMedia );
+}
 
-	mRequestedMultiPass = false;
-	mDoingMultiPass = false;
-
-	createCompressionSession();
+int64_t MovieWriter::Obj::getDurationValue( float duration ) const
+{
+	if( duration <= 0 )
+		duration = mFormat.mDefaultTime;
 
-	mCurrentTimeValue = 0;
-	mNumFrames = 0;
+	return static_cast<int64_t>( duration * mFormat.mTimeBase );
 }
-	
+
 void MovieWriter::Obj::addFrame( const ImageSourceRef &imageSource, float duration )
 {
 	if( mFinished )
 		throw MovieWriterExcAlreadyFinished();
 
-	if( duration <= 0 )
-		duration = mFormat.mDefaultTime;
+	if( mFormat.mAsync ) {
+		// the ImageSource may not be safe to read from another thread, so it is copied here
+		prepareFrame();
+		queueFrame( Surface8u( imageSource ), getDurationValue( duration ) );
+	}
+	else
+		encodeFrame( imageSource, getDurationValue( duration ) );
+}
+
+void MovieWriter::Obj::addFrame( const Surface8u &surface, float duration )
+{
+	if( mFinished )
+		throw MovieWriterExcAlreadyFinished();
+
+	if( mFormat.mAsync ) {
+		prepareFrame();
+		queueFrame( surface, getDurationValue( duration ) );
+	}
+	else
+		encodeFrame( surface, getDurationValue( duration ) );
+}
+
+void MovieWriter::Obj::addFrame( const gl::FboReadback &readback, float duration )
+{
+	if( mFinished )
+		throw MovieWriterExcAlreadyFinished();
+
+	if( mFormat.mAsync ) {
+		prepareFrame();
+
+		PendingReadback pending;
+		pending.mReadback = readback;
+		pending.mDurationVal = getDurationValue( duration );
+		pending.mAge = 0;
+		mReadbacks.push_back( pending );
+	}
+	else {
+		Surface8u surface = readback.getSurface();
+		if( surface )
+			encodeFrame( surface, getDurationValue( duration ) );
+	}
+}
+
+void MovieWriter::Obj::encodeFrame( const ImageSourceRef &imageSource, int64_t durationVal )
+{
+	if( mHardwareEncoder ) {
+		encodeFrame( Surface8u( imageSource ), durationVal );
+		return;
+	}
 
 	::CVPixelBufferRef pixelBuffer = createCvPixelBuffer( imageSource, false );
 	::CFNumberRef gammaLevel = CFNumberCreate( kCFAllocatorDefault, kCFNumberFloatType, &mFormat.mGamma );
@@ -267,7 +366,6 @@ void MovieWriter::Obj::addFrame( const ImageSourceRef &imageSource, float durati
 
 	::ICMValidTimeFlags validTimeFlags = kICMValidTime_DisplayTimeStampIsValid | kICMValidTime_DisplayDurationIsValid;
 	::ICMCompressionFrameOptionsRef frameOptions = NULL;
-	int64_t durationVal = static_cast<int64_t>( duration * mFormat.mTimeBase );
 	OSStatus err = ::ICMCompressionSessionEncodeFrame( mCompressionSession, pixelBuffer,
 				mCurrentTimeValue, durationVal, validTimeFlags,
                 frameOptions, NULL, NULL );
@@ -294,6 +392,143 @@ void MovieWriter::Obj::addFrame( const ImageSourceRef &imageSource, float durati
 		throw MovieWriterExcFrameEncode();
 }
 
+void MovieWriter::Obj::encodeFrame( const Surface8u &surface, int64_t durationVal )
+{
+	if( ! mHardwareEncoder ) {
+		encodeFrame( (ImageSourceRef)surface, durationVal );
+		return;
+	}
+
+	const bool encoded = mHardwareEncoder->encodeFrame( surface, mCurrentTimeValue / (double)mFormat.mTimeBase, durationVal / (double)mFormat.mTimeBase );
+
+	mCurrentTimeValue += durationVal;
+	++mNumFrames;
+
+	if( ! encoded )
+		throw MovieWriterExcFrameEncode();
+}
+
+void MovieWriter::Obj::prepareFrame()
+{
+	rethrowError();
+
+	for( std::deque<PendingReadback>::iterator readbackIt = mReadbacks.begin(); readbackIt != mReadbacks.end(); ++readbackIt )
+		++readbackIt->mAge;
+	while( ! mReadbacks.empty() && mReadbacks.front().mAge >= mFormat.mReadbackLatency )
+		collectReadback();
+
+	// the oldest readback is collected early rather than waiting on the compressor, which may be all that's left once it's collected
+	while( getNumFramesInFlight() >= mFormat.mMaxFramesInFlight && ! mReadbacks.empty() )
+		collectReadback();
+	if( getNumFramesInFlight() >= mFormat.mMaxFramesInFlight )
+		++mNumStalls;
+	waitForFrames( mFormat.mMaxFramesInFlight );
+}
+
+void MovieWriter::Obj::queueFrame( const Surface8u &surface, int64_t durationVal )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mFrameQueue.push_back( std::make_pair( surface, durationVal ) );
+	++mNumCompressing;
+	mFrameQueuedCond.notify_one();
+}
+
+void MovieWriter::Obj::collectReadback()
+{
+	PendingReadback pending = mReadbacks.front();
+	mReadbacks.pop_front();
+
+	// blocks on the GPU if the transfer is still in flight
+	Surface8u surface = pending.mReadback.getSurface();
+	if( surface )
+		queueFrame( surface, pending.mDurationVal );
+}
+
+void MovieWriter::Obj::waitForFrames( size_t maxFrames )
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( mNumCompressing + mReadbacks.size() >= maxFrames && mNumCompressing > 0 )
+		mFrameFinishedCond.wait( lock );
+}
+
+size_t MovieWriter::Obj::getNumFramesInFlight() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mNumCompressing + mReadbacks.size();
+}
+
+void MovieWriter::Obj::compressionThreadFn()
+{
+	if( mMovie ) {
+		::EnterMoviesOnThread( 0 );
+		::AttachMovieToCurrentThread( mMovie );
+	}
+
+	while( true ) {
+		std::pair<Surface8u,int64_t> frame;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			while( mFrameQueue.empty() && ! mStopCompressionThread )
+				mFrameQueuedCond.wait( lock );
+			if( mFrameQueue.empty() )
+				break;
+			frame = mFrameQueue.front();
+			mFrameQueue.pop_front();
+		}
+
+		std::exception_ptr error;
+		try {
+			encodeFrame( frame.first, frame.second );
+		}
+		catch( ... ) {
+			error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( error && ! mError )
+			mError = error;
+		--mNumCompressing;
+		mFrameFinishedCond.notify_all();
+	}
+
+	if( mMovie ) {
+		::DetachMovieFromCurrentThread( mMovie );
+		::ExitMoviesOnThread();
+	}
+}
+
+// completes the queued frames and hands the Movie back to the calling thread
+void MovieWriter::Obj::stopCompressionThread()
+{
+	if( ! mCompressionThread.joinable() )
+		return;
+
+	while( ! mReadbacks.empty() )
+		collectReadback();
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mStopCompressionThread = true;
+		mFrameQueuedCond.notify_one();
+	}
+	mCompressionThread.join();
+
+	if( mMovie )
+		::AttachMovieToCurrentThread( mMovie );
+}
+
+void MovieWriter::Obj::rethrowError()
+{
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		std::swap( error, mError );
+	}
+
+	if( error )
+		std::rethrow_exception( error );
+}
+
 extern "C" {
 OSStatus MovieWriter::Obj::encodedFrameOutputCallback( void *refCon, 
                    ICMCompressionSessionRef session, 
@@ -436,6 +671,21 @@ void MovieWriter::Obj::finish()
 	if( mFinished )
 		return;
 
+	// the movie is still completed when the compression thread failed; its error is rethrown at the end
+	stopCompressionThread();
+	std::exception_ptr compressionError;
+	std::swap( compressionError, mError );
+
+	if( mHardwareEncoder ) {
+		mFinished = true;
+		const bool completed = mHardwareEncoder->finish();
+		if( compressionError )
+			std::rethrow_exception( compressionError );
+		if( ! completed )
+			throw MovieWriterExc();
+		return;
+	}
+
 	::ICMCompressionSessionCompleteFrames( mCompressionSession, true, 0, 0 );
 
 	mFinished = true; // set this in case of throw, otherwise we could loop forever
@@ -533,6 +783,9 @@ void MovieWriter::Obj::finish()
 
 	if( mMovie )
 		::DisposeMovie( mMovie );
+
+	if( compressionError )
+		std::rethrow_exception( compressionError );
 }
 
 bool MovieWriter::getUserCompressionSettings( Format *result, ImageSourceRef imageSource )
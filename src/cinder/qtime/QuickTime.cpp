@@ -29,6 +29,7 @@
 #include "cinder/app/App.h"
 
 #include <sstream>
+#include <algorithm>
 
 // this has a conflict with Boost 1.53, so instead just declare the symbol extern
 // #include "cinder/Utilities.h"
@@ -174,6 +175,10 @@ void MovieBase::init()
 	getObj()->mLoaded = false;
 	getObj()->mPlayable = false;
 	getObj()->mFrameCount = -1;
+	getObj()->mFrameIndexBuilt = false;
+	getObj()->mFrameCacheSize = 0;
+	getObj()->mScrubPending = false;
+	getObj()->mScrubSettleTime = 0.15f;
 	getObj()->mPlayingForward = true;
 	getObj()->mLoop = false;
 	getObj()->mPalindrome = false;
@@ -198,6 +203,10 @@ MovieBase::Obj::Obj()
 	mNewFrameCallback = 0;
 	mVisualContext = 0;
 	mMovie = 0;
+	mFrameIndexBuilt = false;
+	mFrameCacheSize = 0;
+	mScrubPending = false;
+	mScrubSettleTime = 0.15f;
 }
 
 MovieBase::Obj::~Obj()
@@ -306,32 +315,145 @@ float MovieBase::getCurrentTime() const
 
 void MovieBase::seekToTime( float seconds )
 {
+	getObj()->mScrubPending = false;
 	::SetMovieTimeValue( getObj()->mMovie, ::TimeValue( seconds * ::GetMovieTimeScale( getObj()->mMovie ) ) );
 }
 
 void MovieBase::seekToFrame( int frame )
 {
-	long        frameCount = 0;
-	TimeValue   curMovieTime = 0, lastGoodTime = 0;
-	
+	buildFrameIndex();
+	const std::vector<TimeValue> &frameTimes = getObj()->mFrameTimes;
+	if( frameTimes.empty() )
+		return;
+
+	getObj()->mScrubPending = false;
+	frame = std::max<int>( 0, std::min<int>( frame, (int)frameTimes.size() - 1 ) );
+	::SetMovieTimeValue( getObj()->mMovie, frameTimes[frame] );
+	::MoviesTask( getObj()->mMovie, 0 );
+}
+
+void MovieBase::seekToKeyframe( float seconds )
+{
+	buildFrameIndex();
+	if( getObj()->mFrameTimes.empty() )
+		return;
+
+	getObj()->mScrubPending = false;
+	int32_t keyframe = findKeyframe( findFrame( ::TimeValue( seconds * ::GetMovieTimeScale( getObj()->mMovie ) ) ) );
+	::SetMovieTimeValue( getObj()->mMovie, getObj()->mFrameTimes[keyframe] );
+	::MoviesTask( getObj()->mMovie, 0 );
+}
+
+void MovieBase::scrubToTime( float seconds )
+{
+	buildFrameIndex();
+	if( getObj()->mFrameTimes.empty() ) {
+		seekToTime( seconds );
+		return;
+	}
+
+	TimeValue time = ::TimeValue( seconds * ::GetMovieTimeScale( getObj()->mMovie ) );
+	int32_t frame = findFrame( time );
+
+	getObj()->lock();
+		// a cached frame can be shown as-is; otherwise show the keyframe now, which decodes without reference to any other frame
+		if( ! getObj()->showCachedFrame( frame ) ) {
+			int32_t keyframe = findKeyframe( frame );
+			::SetMovieTimeValue( getObj()->mMovie, getObj()->mFrameTimes[keyframe] );
+		}
+		// the exact seek is issued from updateFrame() once the scrubbing settles
+		getObj()->mScrubPending = true;
+		getObj()->mScrubTime = time;
+		getObj()->mScrubTimer.start();
+	getObj()->unlock();
+}
+
+void MovieBase::setFrameCacheSize( size_t numFrames )
+{
+	if( numFrames > 0 )
+		buildFrameIndex();
+
+	getObj()->lock();
+		getObj()->mFrameCacheSize = numFrames;
+		if( numFrames == 0 )
+			getObj()->clearFrameCache();
+	getObj()->unlock();
+}
+
+void MovieBase::buildFrameIndex()
+{
+	if( getObj()->mFrameIndexBuilt )
+		return;
+
+	std::vector<TimeValue> &frameTimes = getObj()->mFrameTimes;
+	std::vector<int32_t> &keyframes = getObj()->mKeyframes;
+	frameTimes.clear();
+	keyframes.clear();
+
 	OSType types[] = { VisualMediaCharacteristic };
-	while( ( frameCount < frame ) && ( curMovieTime >= 0 ) ) {
+	TimeValue curMovieTime = getStartTimeOfFirstSample();
+	while( curMovieTime >= 0 ) {
+		frameTimes.push_back( curMovieTime );
 		::GetMovieNextInterestingTime( getObj()->mMovie, nextTimeStep, 1, types, curMovieTime, fixed1, &curMovieTime, NULL );
-		frameCount++;
-		if( curMovieTime >= 0 )
-			lastGoodTime = curMovieTime;
 	}
-	::SetMovieTimeValue( getObj()->mMovie, lastGoodTime );
-	::MoviesTask( getObj()->mMovie, 0 );
+
+	// sync samples are always sample start times, so each one maps onto an entry of frameTimes
+	curMovieTime = 0;
+	::GetMovieNextInterestingTime( getObj()->mMovie, nextTimeSyncSample | nextTimeEdgeOK, 1, types, curMovieTime, fixed1, &curMovieTime, NULL );
+	while( curMovieTime >= 0 ) {
+		int32_t frame = findFrame( curMovieTime );
+		if( keyframes.empty() || keyframes.back() != frame )
+			keyframes.push_back( frame );
+		::GetMovieNextInterestingTime( getObj()->mMovie, nextTimeSyncSample, 1, types, curMovieTime, fixed1, &curMovieTime, NULL );
+	}
+	// media without sync sample tables (uncompressed, most intra-only codecs) treat every sample as a sync sample
+	if( keyframes.empty() || keyframes.front() != 0 )
+		keyframes.insert( keyframes.begin(), 0 );
+
+	getObj()->mFrameIndexBuilt = true;
+}
+
+int32_t MovieBase::getFrameAtTime( float seconds )
+{
+	buildFrameIndex();
+	return findFrame( ::TimeValue( seconds * ::GetMovieTimeScale( getObj()->mMovie ) ) );
+}
+
+float MovieBase::getKeyframeTime( float seconds )
+{
+	buildFrameIndex();
+	if( getObj()->mFrameTimes.empty() )
+		return 0;
+
+	int32_t keyframe = findKeyframe( getFrameAtTime( seconds ) );
+	return getObj()->mFrameTimes[keyframe] / (float)::GetMovieTimeScale( getObj()->mMovie );
+}
+
+// returns the index of the last frame starting at or before \a time; requires the frame index
+int32_t MovieBase::findFrame( TimeValue time )
+{
+	const std::vector<TimeValue> &frameTimes = getObj()->mFrameTimes;
+	std::vector<TimeValue>::const_iterator it = std::upper_bound( frameTimes.begin(), frameTimes.end(), time );
+	return ( it == frameTimes.begin() ) ? 0 : (int32_t)( it - frameTimes.begin() ) - 1;
+}
+
+// returns the index of the last keyframe at or before \a frame; requires the frame index
+int32_t MovieBase::findKeyframe( int32_t frame )
+{
+	const std::vector<int32_t> &keyframes = getObj()->mKeyframes;
+	std::vector<int32_t>::const_iterator it = std::upper_bound( keyframes.begin(), keyframes.end(), frame );
+	return ( it == keyframes.begin() ) ? 0 : *( it - 1 );
 }
 
 void MovieBase::seekToStart()
 {
+	getObj()->mScrubPending = false;
 	::GoToBeginningOfMovie( getObj()->mMovie );
 }
 
 void MovieBase::seekToEnd()
 {
+	getObj()->mScrubPending = false;
 	::GoToEndOfMovie( getObj()->mMovie );
 }
 
@@ -475,6 +597,11 @@ void MovieBase::updateFrame()
 {
 	getObj()->lock();
 
+	if( getObj()->mScrubPending && getObj()->mScrubTimer.getSeconds() >= getObj()->mScrubSettleTime ) {
+		getObj()->mScrubPending = false;
+		::SetMovieTimeValue( getObj()->mMovie, getObj()->mScrubTime );
+	}
+
 	::MoviesTask( getObj()->mMovie, 0 );
 	if( (QTVisualContextRef)getObj()->mVisualContext ) {
 		::QTVisualContextTask( (QTVisualContextRef)getObj()->mVisualContext );
@@ -484,8 +611,11 @@ void MovieBase::updateFrame()
 			CVImageBufferRef newImageRef = NULL;
 			long tv = ::GetMovieTime( getObj()->mMovie, NULL );
 			OSStatus err = ::QTVisualContextCopyImageForTime( (QTVisualContextRef)getObj()->mVisualContext, kCFAllocatorDefault, NULL, &newImageRef );
-			if( ( err == noErr ) && newImageRef )
+			if( ( err == noErr ) && newImageRef ) {
 				getObj()->newFrame( newImageRef );
+				if( getObj()->mFrameCacheSize > 0 )
+					getObj()->cacheFrame( findFrame( tv ) );
+			}
 
 			if( getObj()->mNewFrameCallback && newImageRef ) {
 				
@@ -714,6 +844,38 @@ void MovieSurface::Obj::releaseFrame()
 	mSurface.reset();
 }
 
+void MovieSurface::Obj::cacheFrame( int32_t frame )
+{
+	if( ! mSurface )
+		return;
+
+	for( std::deque<std::pair<int32_t,Surface> >::iterator cacheIt = mFrameCache.begin(); cacheIt != mFrameCache.end(); ++cacheIt ) {
+		if( cacheIt->first == frame ) {
+			mFrameCache.erase( cacheIt );
+			break;
+		}
+	}
+	mFrameCache.push_back( std::make_pair( frame, mSurface ) );
+	while( mFrameCache.size() > mFrameCacheSize )
+		mFrameCache.pop_front();
+}
+
+bool MovieSurface::Obj::showCachedFrame( int32_t frame )
+{
+	for( std::deque<std::pair<int32_t,Surface> >::iterator cacheIt = mFrameCache.begin(); cacheIt != mFrameCache.end(); ++cacheIt ) {
+		if( cacheIt->first == frame ) {
+			// move it to the most recently used end
+			std::pair<int32_t,Surface> entry = *cacheIt;
+			mFrameCache.erase( cacheIt );
+			mFrameCache.push_back( entry );
+			mSurface = entry.second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 Surface MovieSurface::getSurface()
 {
 	updateFrame();
@@ -802,6 +964,39 @@ void MovieGl::Obj::releaseFrame()
 	mTexture.reset();
 }
 
+void MovieGl::Obj::cacheFrame( int32_t frame )
+{
+	if( ! mTexture )
+		return;
+
+	for( std::deque<std::pair<int32_t,gl::Texture> >::iterator cacheIt = mFrameCache.begin(); cacheIt != mFrameCache.end(); ++cacheIt ) {
+		if( cacheIt->first == frame ) {
+			mFrameCache.erase( cacheIt );
+			break;
+		}
+	}
+	// holding a reference keeps the CVOpenGLTexture or TextureCache slot from being recycled
+	mFrameCache.push_back( std::make_pair( frame, mTexture ) );
+	while( mFrameCache.size() > mFrameCacheSize )
+		mFrameCache.pop_front();
+}
+
+bool MovieGl::Obj::showCachedFrame( int32_t frame )
+{
+	for( std::deque<std::pair<int32_t,gl::Texture> >::iterator cacheIt = mFrameCache.begin(); cacheIt != mFrameCache.end(); ++cacheIt ) {
+		if( cacheIt->first == frame ) {
+			// move it to the most recently used end
+			std::pair<int32_t,gl::Texture> entry = *cacheIt;
+			mFrameCache.erase( cacheIt );
+			mFrameCache.push_back( entry );
+			mTexture = entry.second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void MovieGl::Obj::newFrame( CVImageBufferRef cvImage )
 {
 #if defined( CINDER_MAC )
@@ -856,6 +1051,160 @@ const gl::Texture MovieGl::getTexture()
 	return result;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MovieClock
+namespace {
+// the time scale the clock's own values are kept in; divisible by the common frame rates 24, 25, 30 and 60
+const ::TimeScale CLOCK_TIME_SCALE = 600;
+} // anonymous namespace
+
+MovieClock::MovieClock()
+	: mLoop( false )
+{
+	startQuickTime();
+
+	ComponentDescription clockDesc;
+	clockDesc.componentType = clockComponentType;
+	clockDesc.componentSubType = systemMicrosecondClock;
+	clockDesc.componentManufacturer = 0;
+	clockDesc.componentFlags = 0;
+	clockDesc.componentFlagsMask = 0;
+	mClockComponent = ::FindNextComponent( 0, &clockDesc );
+
+	mTimeBase = ::NewTimeBase();
+	if( ! mTimeBase )
+		throw QuickTimeExc();
+	::SetTimeBaseMasterClock( mTimeBase, mClockComponent, NULL );
+	::SetTimeBaseRate( mTimeBase, 0 );
+	::SetTimeBaseValue( mTimeBase, 0, CLOCK_TIME_SCALE );
+}
+
+MovieClock::~MovieClock()
+{
+	// the movies may outlive the clock through other references, so they must stop following the time base before it is disposed
+	while( ! mMovies.empty() )
+		removeMovie( *mMovies.back() );
+
+	::DisposeTimeBase( mTimeBase );
+}
+
+void MovieClock::attachMovie( const std::shared_ptr<MovieBase> &movie )
+{
+	::Movie handle = movie->getMovieHandle();
+	::StopMovie( handle );
+	// a slave's time equals the master's time, and its rate of 1 is relative to the master's rate
+	::SetMovieMasterTimeBase( handle, mTimeBase, NULL );
+	::SetMovieRate( handle, fixed1 );
+	mMovies.push_back( movie );
+
+	updateStopTime();
+}
+
+void MovieClock::removeMovie( const MovieBase &movie )
+{
+	for( std::vector<std::shared_ptr<MovieBase> >::iterator movieIt = mMovies.begin(); movieIt != mMovies.end(); ++movieIt ) {
+		if( (*movieIt)->getMovieHandle() == movie.getMovieHandle() ) {
+			::Movie handle = movie.getMovieHandle();
+			TimeValue time = ::GetMovieTime( handle, NULL );
+			::SetMovieMasterClock( handle, mClockComponent, NULL );
+			::SetMovieRate( handle, 0 );
+			::SetMovieTimeValue( handle, time );
+			mMovies.erase( movieIt );
+			updateStopTime();
+			return;
+		}
+	}
+}
+
+void MovieClock::play()
+{
+	float rate = getRate();
+	if( rate == 0 )
+		rate = 1;
+
+	// prerolling loads and decodes ahead from the clock's time, so no movie starts late
+	for( std::vector<std::shared_ptr<MovieBase> >::const_iterator movieIt = mMovies.begin(); movieIt != mMovies.end(); ++movieIt ) {
+		::Movie handle = (*movieIt)->getMovieHandle();
+		::PrerollMovie( handle, ::GetMovieTime( handle, NULL ), floatToFixed( rate ) );
+	}
+
+	setRate( rate );
+}
+
+void MovieClock::stop()
+{
+	setRate( 0 );
+}
+
+bool MovieClock::isPlaying() const
+{
+	return ::GetTimeBaseRate( mTimeBase ) != 0;
+}
+
+void MovieClock::setRate( float rate )
+{
+	::SetTimeBaseRate( mTimeBase, floatToFixed( rate ) );
+}
+
+float MovieClock::getRate() const
+{
+	return ::GetTimeBaseRate( mTimeBase ) / (float)fixed1;
+}
+
+void MovieClock::seekToTime( float seconds )
+{
+	::SetTimeBaseValue( mTimeBase, ::TimeValue( seconds * CLOCK_TIME_SCALE ), CLOCK_TIME_SCALE );
+	for( std::vector<std::shared_ptr<MovieBase> >::const_iterator movieIt = mMovies.begin(); movieIt != mMovies.end(); ++movieIt )
+		::MoviesTask( (*movieIt)->getMovieHandle(), 0 );
+}
+
+float MovieClock::getCurrentTime() const
+{
+	return ::GetTimeBaseTime( mTimeBase, CLOCK_TIME_SCALE, NULL ) / (float)CLOCK_TIME_SCALE;
+}
+
+float MovieClock::getDuration() const
+{
+	float result = 0;
+	for( std::vector<std::shared_ptr<MovieBase> >::const_iterator movieIt = mMovies.begin(); movieIt != mMovies.end(); ++movieIt )
+		result = std::max( result, (*movieIt)->getDuration() );
+
+	return result;
+}
+
+void MovieClock::setLoop( bool loop )
+{
+	mLoop = loop;
+	updateStopTime();
+}
+
+// the clock runs from 0 to the end of the longest movie, looping there if mLoop
+void MovieClock::updateStopTime()
+{
+	::TimeRecord startTime, stopTime;
+	startTime.value.hi = startTime.value.lo = 0;
+	startTime.scale = CLOCK_TIME_SCALE;
+	startTime.base = NULL;
+	stopTime = startTime;
+	stopTime.value.lo = (UInt32)( getDuration() * CLOCK_TIME_SCALE );
+
+	::SetTimeBaseStartTime( mTimeBase, &startTime );
+	::SetTimeBaseStopTime( mTimeBase, &stopTime );
+
+	long flags = ::GetTimeBaseFlags( mTimeBase );
+	if( mLoop )
+		flags |= loopTimeBase;
+	else
+		flags &= ~loopTimeBase;
+	::SetTimeBaseFlags( mTimeBase, flags );
+}
+
+void MovieClock::update()
+{
+	for( std::vector<std::shared_ptr<MovieBase> >::const_iterator movieIt = mMovies.begin(); movieIt != mMovies.end(); ++movieIt )
+		(*movieIt)->updateFrame();
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // MovieLoader
 MovieLoader::MovieLoader( const Url &url )
@@ -29,6 +29,7 @@
 #include "cinder/ImageIo.h"
 #include "cinder/Base64.h"
 #include "cinder/Text.h"
+#include "cinder/TaskPool.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
@@ -1479,7 +1480,11 @@ Path::Path( const Node *parent, const XmlTree &xml )
 {
 	std::string p = xml.getAttributeValue<string>( "d", "" );
 	if( ! p.empty() ) {
-		mPath = parsePath( p );
+		Doc *doc = getDoc();
+		if( doc && doc->mDeferPathParsing )
+			doc->mDeferredPaths.push_back( make_pair( this, std::move( p ) ) );
+		else
+			mPath = parsePath( p );
 	}
 }
 
@@ -1772,6 +1777,150 @@ Node* Group::nodeUnderPoint( const Vec2f &absolutePoint, const MatrixAffine2f &p
 	return NULL;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+// NodeIndex
+namespace {
+
+const size_t NODE_INDEX_NODE_SIZE = 8;
+
+template<typename T>
+bool boundsCenterXLess( const T &a, const T &b ) { return a.mBounds.x1 + a.mBounds.x2 < b.mBounds.x1 + b.mBounds.x2; }
+template<typename T>
+bool boundsCenterYLess( const T &a, const T &b ) { return a.mBounds.y1 + a.mBounds.y2 < b.mBounds.y1 + b.mBounds.y2; }
+
+// Orders \a items for packing consecutive runs of NODE_INDEX_NODE_SIZE into nodes: sorted by center x into vertical slices, each of which is sorted by center y
+template<typename T>
+void sortTileRecursive( vector<T> *items )
+{
+	const size_t numNodes = ( items->size() + NODE_INDEX_NODE_SIZE - 1 ) / NODE_INDEX_NODE_SIZE;
+	const size_t sliceSize = (size_t)math<double>::ceil( math<double>::sqrt( (double)numNodes ) ) * NODE_INDEX_NODE_SIZE;
+	std::sort( items->begin(), items->end(), &boundsCenterXLess<T> );
+	for( size_t first = 0; first < items->size(); first += sliceSize )
+		std::sort( items->begin() + first, items->begin() + std::min( first + sliceSize, items->size() ), &boundsCenterYLess<T> );
+}
+
+template<typename T, typename TreeNodeT>
+TreeNodeT makeTreeNode( const vector<T> &children, size_t first, uint32_t firstIndex, bool leaf )
+{
+	TreeNodeT result;
+	result.mFirst = firstIndex;
+	result.mCount = (uint32_t)std::min( NODE_INDEX_NODE_SIZE, children.size() - first );
+	result.mLeaf = leaf;
+	result.mBounds = children[first].mBounds;
+	for( size_t c = first + 1; c < first + result.mCount; ++c )
+		result.mBounds.include( children[c].mBounds );
+	return result;
+}
+
+} // anonymous namespace
+
+NodeIndex::NodeIndex( const Group &root )
+{
+	addNodes( root, MatrixAffine2f::identity() );
+
+	// Uses compute their boxes from a shared referenced Node, whose cached box mustn't be written by several threads at once
+	TaskPool::get()->parallelFor( 0, mEntries.size(), [this]( size_t first, size_t last ) {
+		for( size_t e = first; e < last; ++e ) {
+			if( typeid(*mEntries[e].mNode) != typeid(Use) )
+				mEntries[e].mBounds = mEntries[e].mNode->getBoundingBox().transformCopy( mEntries[e].mInverse.invertCopy() );
+		}
+	} );
+	for( vector<Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+		if( typeid(*entryIt->mNode) == typeid(Use) )
+			entryIt->mBounds = entryIt->mNode->getBoundingBox().transformCopy( entryIt->mInverse.invertCopy() );
+	}
+
+	if( mEntries.empty() )
+		return;
+
+	// the entries are packed into leaves, and each level of the tree into the one above it, until a single root remains
+	sortTileRecursive( &mEntries );
+	vector<TreeNode> level;
+	for( size_t e = 0; e < mEntries.size(); e += NODE_INDEX_NODE_SIZE )
+		level.push_back( makeTreeNode<Entry,TreeNode>( mEntries, e, (uint32_t)e, true ) );
+
+	while( true ) {
+		if( level.size() > 1 )
+			sortTileRecursive( &level );
+		const size_t levelFirst = mTreeNodes.size();
+		mTreeNodes.insert( mTreeNodes.end(), level.begin(), level.end() );
+		if( level.size() == 1 )
+			break;
+
+		vector<TreeNode> parents;
+		for( size_t n = 0; n < level.size(); n += NODE_INDEX_NODE_SIZE )
+			parents.push_back( makeTreeNode<TreeNode,TreeNode>( level, n, (uint32_t)( levelFirst + n ), false ) );
+		level.swap( parents );
+	}
+}
+
+// Mirrors Group::nodeUnderPoint(), which descends into child Groups and tests every other child in the coordinates of its own transform
+void NodeIndex::addNodes( const Group &group, const MatrixAffine2f &parentInverse )
+{
+	const MatrixAffine2f inverse = group.specifiesTransform() ? group.getTransformInverse() * parentInverse : parentInverse;
+	for( list<Node*>::const_iterator childIt = group.getChildren().begin(); childIt != group.getChildren().end(); ++childIt ) {
+		if( typeid(**childIt) == typeid(svg::Group) )
+			addNodes( *static_cast<const svg::Group*>( *childIt ), inverse );
+		else {
+			Entry entry;
+			entry.mNode = *childIt;
+			entry.mOrder = (uint32_t)mEntries.size();
+			entry.mInverse = (*childIt)->specifiesTransform() ? (*childIt)->getTransformInverse() * inverse : inverse;
+			mEntries.push_back( entry );
+		}
+	}
+}
+
+template<typename Fn>
+void NodeIndex::traverse( const Rectf &rect, const Fn &fn ) const
+{
+	if( mTreeNodes.empty() )
+		return;
+
+	vector<uint32_t> stack( 1, (uint32_t)mTreeNodes.size() - 1 );
+	while( ! stack.empty() ) {
+		const TreeNode &node = mTreeNodes[stack.back()];
+		stack.pop_back();
+		if( ! node.mBounds.intersects( rect ) )
+			continue;
+
+		for( uint32_t c = node.mFirst; c < node.mFirst + node.mCount; ++c ) {
+			if( ! node.mLeaf )
+				stack.push_back( c );
+			else if( mEntries[c].mBounds.intersects( rect ) )
+				fn( mEntries[c] );
+		}
+	}
+}
+
+namespace {
+
+struct EntryOrderGreater {
+	template<typename EntryT>
+	bool operator()( const EntryT *a, const EntryT *b ) const { return a->mOrder > b->mOrder; }
+};
+
+} // anonymous namespace
+
+Node* NodeIndex::nodeUnderPoint( const Vec2f &pt ) const
+{
+	// the Nodes whose boxes contain the point are tested topmost first, so the first to contain it is the result
+	vector<const Entry*> candidates;
+	traverse( Rectf( pt, pt ), [&]( const Entry &entry ) { candidates.push_back( &entry ); } );
+	std::sort( candidates.begin(), candidates.end(), EntryOrderGreater() );
+	for( vector<const Entry*>::const_iterator entryIt = candidates.begin(); entryIt != candidates.end(); ++entryIt ) {
+		if( (*entryIt)->mNode->containsPoint( (*entryIt)->mInverse * pt ) )
+			return (*entryIt)->mNode;
+	}
+
+	return NULL;
+}
+
+void NodeIndex::queryBoundingBoxes( const Rectf &rect, std::vector<Node*> *result ) const
+{
+	traverse( rect.canonicalized(), [result]( const Entry &entry ) { result->push_back( entry.mNode ); } );
+}
+
 const Node* Group::findInAncestors( const std::string &elementId ) const
 {
 	const Node *result;
@@ -2152,13 +2301,13 @@ void TextSpan::Attributes::finishRender( Renderer &renderer ) const
 ////////////////////////////////////////////////////////////////////////////////////
 // Doc
 Doc::Doc( const fs::path &filePath )
-	: Group( 0 )
+	: Group( 0 ), mDeferPathParsing( false )
 {
 	loadDoc( loadFile( filePath ), filePath );
 }
 
 Doc::Doc( DataSourceRef dataSource, const fs::path &filePath )
-	: Group( 0 )
+	: Group( 0 ), mDeferPathParsing( false )
 {
 	fs::path relativePath = filePath;
 	if( filePath.empty() )
@@ -2166,6 +2315,12 @@ Doc::Doc( DataSourceRef dataSource, const fs::path &filePath )
 	loadDoc( dataSource, relativePath );
 }
 
+Doc::Doc( const shared_ptr<XmlTree> &xmlTree, const fs::path &filePath )
+	: Group( 0 ), mDeferPathParsing( false )
+{
+	loadXml( xmlTree, filePath );
+}
+
 DocRef Doc::create( const fs::path &filePath )
 {
 	return DocRef( new svg::Doc( filePath ) );
@@ -2176,6 +2331,11 @@ DocRef Doc::create( DataSourceRef dataSource, const fs::path &filePath )
 	return DocRef( new svg::Doc( dataSource, filePath ) );
 }
 
+DocRef Doc::create( const shared_ptr<XmlTree> &xmlTree, const fs::path &filePath )
+{
+	return DocRef( new svg::Doc( xmlTree, filePath ) );
+}
+
 DocRef Doc::createFromSvgz( DataSourceRef dataSource, const fs::path &filePath )
 {
 	fs::path relativePath = filePath;
@@ -2186,10 +2346,15 @@ DocRef Doc::createFromSvgz( DataSourceRef dataSource, const fs::path &filePath )
 }
 
 void Doc::loadDoc( DataSourceRef source, fs::path filePath )
+{
+	loadXml( shared_ptr<XmlTree>( new XmlTree( source, getParseOptions() ) ), filePath );
+}
+
+void Doc::loadXml( const shared_ptr<XmlTree> &xmlTree, const fs::path &filePath )
 {
 	if( ! filePath.empty() )
 		mFilePath = filePath.parent_path();
-	mXmlTree = shared_ptr<XmlTree>( new XmlTree( source, XmlTree::ParseOptions().ignoreDataChildren( false ) ) );
+	mXmlTree = xmlTree;
 
 	const XmlTree &xml( mXmlTree->getChild( "svg" ) );
 
@@ -2235,10 +2400,24 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 		mTransform.setToIdentity();
 
 	// we can't parse the group w/o having parsed the viewBox, dimensions, etc, so we have to do this manually:
+	mDeferPathParsing = true;
 	if( xml.hasChild( "switch" ) )		// when saved with "preserve Illustrator editing capabilities", svg data is inside a "switch"
 		Group::parse( xml.getChild( "switch" ) );
 	else
 		Group::parse( xml );
+	mDeferPathParsing = false;
+	parseDeferredPaths();
+}
+
+// Each path's data is parsed into its own Shape2d, so they're independent of one another
+void Doc::parseDeferredPaths()
+{
+	vector<pair<Path*,string> > paths;
+	paths.swap( mDeferredPaths );
+	TaskPool::get()->parallelFor( 0, paths.size(), [&paths]( size_t first, size_t last ) {
+		for( size_t p = first; p < last; ++p )
+			paths[p].first->mPath = parsePath( paths[p].second );
+	} );
 }
 
 shared_ptr<Surface8u> Doc::loadImage( fs::path relativePath )
@@ -2266,7 +2445,14 @@ shared_ptr<Surface8u> Doc::loadImage( fs::path relativePath )
 
 Node* Doc::nodeUnderPoint( const Vec2f &pt )
 {
-	return Group::nodeUnderPoint( pt, MatrixAffine2f::identity() );
+	return getNodeIndex().nodeUnderPoint( pt );
+}
+
+const NodeIndex& Doc::getNodeIndex()
+{
+	if( ! mNodeIndex )
+		mNodeIndex = NodeIndex::create( *this );
+	return *mNodeIndex;
 }
 
 void Doc::renderSelf( Renderer &renderer ) const
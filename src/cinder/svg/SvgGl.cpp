@@ -0,0 +1,346 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/svg/SvgGl.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+Vec2f perpendicular( const Vec2f &dir, float halfWidth )
+{
+	float length = dir.length();
+	if( length <= 0 )
+		return Vec2f::zero();
+	return Vec2f( -dir.y, dir.x ) * ( halfWidth / length );
+}
+
+// expands the polyline \a points into triangles covering a stroke of \a width, with butt caps and bevel joins
+void appendStrokeTriangles( const vector<Vec2f> &points, bool closed, float width, vector<Vec2f> *result )
+{
+	const size_t numPoints = points.size();
+	if( numPoints < 2 )
+		return;
+
+	const float halfWidth = width / 2;
+	const size_t numSegments = closed ? numPoints : numPoints - 1;
+	for( size_t s = 0; s < numSegments; ++s ) {
+		const Vec2f &p0 = points[s];
+		const Vec2f &p1 = points[(s + 1) % numPoints];
+		Vec2f n = perpendicular( p1 - p0, halfWidth );
+		if( n == Vec2f::zero() )
+			continue;
+		result->push_back( p0 + n ); result->push_back( p0 - n ); result->push_back( p1 + n );
+		result->push_back( p1 + n ); result->push_back( p0 - n ); result->push_back( p1 - n );
+	}
+
+	// fill the wedge left open on the outside of each turn
+	const size_t firstJoin = closed ? 0 : 1;
+	const size_t lastJoin = closed ? numPoints : numPoints - 1;
+	for( size_t j = firstJoin; j < lastJoin; ++j ) {
+		const Vec2f &prev = points[(j + numPoints - 1) % numPoints];
+		const Vec2f &cur = points[j];
+		const Vec2f &next = points[(j + 1) % numPoints];
+		Vec2f n0 = perpendicular( cur - prev, halfWidth );
+		Vec2f n1 = perpendicular( next - cur, halfWidth );
+		if( n0 == Vec2f::zero() || n1 == Vec2f::zero() )
+			continue;
+		float turn = ( cur - prev ).x * ( next - cur ).y - ( cur - prev ).y * ( next - cur ).x;
+		if( turn > 0 ) { // turning left, so the gap is on the right
+			result->push_back( cur ); result->push_back( cur - n0 ); result->push_back( cur - n1 );
+		}
+		else if( turn < 0 ) {
+			result->push_back( cur ); result->push_back( cur + n0 ); result->push_back( cur + n1 );
+		}
+	}
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SvgBatchGl::Recorder
+// Captures the shapes and resolved styles the document renders. With a \a cursor it overwrites the existing Items starting at *cursor instead of appending.
+class SvgBatchGl::Recorder : public svg::Renderer {
+  public:
+	Recorder( SvgBatchGl *batch, size_t *cursor )
+		: mBatch( batch ), mCursor( cursor ), mMismatch( false )
+	{
+		mFillStack.push_back( svg::Paint( Color::black() ) );
+		mStrokeStack.push_back( svg::Paint() );
+		mFillOpacityStack.push_back( 1.0f );
+		mStrokeOpacityStack.push_back( 1.0f );
+		mStrokeWidthStack.push_back( 1.0f );
+		mFillRuleStack.push_back( svg::FILL_RULE_NONZERO );
+		mMatrixStack.push_back( MatrixAffine2f::identity() );
+	}
+
+	bool	hasMismatch() const { return mMismatch; }
+
+	void	pushGroup( const svg::Group &group, float opacity )
+	{
+		if( ! mCursor )
+			mBatch->mFirstItems.insert( make_pair( static_cast<const svg::Node*>( &group ), mBatch->mItems.size() ) );
+	}
+
+	void	drawPath( const svg::Path &path )				{ record( path, path.getShape(), true ); }
+	void	drawPolyline( const svg::Polyline &polyline )	{ record( polyline, polyline.getShape(), true ); }
+	void	drawPolygon( const svg::Polygon &polygon )		{ record( polygon, polygon.getShape(), true ); }
+	void	drawLine( const svg::Line &line )				{ record( line, line.getShape(), false ); }
+	void	drawRect( const svg::Rect &rect )				{ record( rect, rect.getShape(), true ); }
+	void	drawCircle( const svg::Circle &circle )			{ record( circle, circle.getShape(), true ); }
+	void	drawEllipse( const svg::Ellipse &ellipse )		{ record( ellipse, ellipse.getShape(), true ); }
+
+	void	pushMatrix( const MatrixAffine2f &m )	{ mMatrixStack.push_back( mMatrixStack.back() * m ); }
+	void	popMatrix()								{ mMatrixStack.pop_back(); }
+
+	void	pushFill( const svg::Paint &paint )		{ mFillStack.push_back( paint ); }
+	void	popFill()								{ mFillStack.pop_back(); }
+	void	pushStroke( const svg::Paint &paint )	{ mStrokeStack.push_back( paint ); }
+	void	popStroke()								{ mStrokeStack.pop_back(); }
+	void	pushFillOpacity( float opacity )		{ mFillOpacityStack.push_back( opacity ); }
+	void	popFillOpacity()						{ mFillOpacityStack.pop_back(); }
+	void	pushStrokeOpacity( float opacity )		{ mStrokeOpacityStack.push_back( opacity ); }
+	void	popStrokeOpacity()						{ mStrokeOpacityStack.pop_back(); }
+	void	pushStrokeWidth( float width )			{ mStrokeWidthStack.push_back( width ); }
+	void	popStrokeWidth()						{ mStrokeWidthStack.pop_back(); }
+	void	pushFillRule( svg::FillRule rule )		{ mFillRuleStack.push_back( rule ); }
+	void	popFillRule()							{ mFillRuleStack.pop_back(); }
+
+  protected:
+	void	record( const svg::Node &node, const Shape2d &shape, bool fillable );
+
+	SvgBatchGl					*mBatch;
+	size_t						*mCursor;
+	bool						mMismatch;
+
+	vector<svg::Paint>			mFillStack, mStrokeStack;
+	vector<float>				mFillOpacityStack, mStrokeOpacityStack;
+	vector<float>				mStrokeWidthStack;
+	vector<svg::FillRule>		mFillRuleStack;
+	vector<MatrixAffine2f>		mMatrixStack;
+};
+
+void SvgBatchGl::Recorder::record( const svg::Node &node, const Shape2d &shape, bool fillable )
+{
+	vector<Item> &items = mBatch->mItems;
+	Item *item;
+	if( mCursor ) {
+		if( mMismatch || *mCursor >= items.size() || items[*mCursor].mNode != &node ) {
+			mMismatch = true;
+			return;
+		}
+		item = &items[(*mCursor)++];
+	}
+	else {
+		mBatch->mFirstItems.insert( make_pair( &node, items.size() ) );
+		items.push_back( Item() );
+		item = &items.back();
+		item->mNode = &node;
+	}
+
+	const float approximationScale = mBatch->mApproximationScale;
+
+	// the local-space tessellation survives transform and color changes
+	bool fill = fillable && ! mFillStack.back().isNone();
+	svg::FillRule fillRule = mFillRuleStack.back();
+	if( ! fill )
+		item->mFillTriangles.clear();
+	else if( ! item->mHasFill || item->mFillRule != fillRule ) {
+		Triangulator::Winding winding = ( fillRule == svg::FILL_RULE_NONZERO ) ? Triangulator::WINDING_NONZERO : Triangulator::WINDING_ODD;
+		TriMesh2d mesh = Triangulator( shape, approximationScale ).calcMesh( winding );
+		const vector<Vec2f> &vertices = mesh.getVertices();
+		const vector<uint32_t> &indices = mesh.getIndices();
+		item->mFillTriangles.resize( indices.size() );
+		for( size_t i = 0; i < indices.size(); ++i )
+			item->mFillTriangles[i] = vertices[indices[i]];
+	}
+	item->mHasFill = fill;
+	item->mFillRule = fillRule;
+
+	bool stroke = ! mStrokeStack.back().isNone();
+	float strokeWidth = mStrokeWidthStack.back();
+	if( ! stroke )
+		item->mStrokeTriangles.clear();
+	else if( ! item->mHasStroke || item->mStrokeWidth != strokeWidth ) {
+		item->mStrokeTriangles.clear();
+		const vector<Path2d> &contours = shape.getContours();
+		for( vector<Path2d>::const_iterator contourIt = contours.begin(); contourIt != contours.end(); ++contourIt ) {
+			vector<Vec2f> points = contourIt->subdivide( approximationScale );
+			// subdivide() repeats the first point of each segment, which would leave no direction to join along
+			points.erase( std::unique( points.begin(), points.end() ), points.end() );
+			bool closed = contourIt->isClosed();
+			if( closed && points.size() > 1 && points.front() == points.back() )
+				points.pop_back();
+			appendStrokeTriangles( points, closed, strokeWidth, &item->mStrokeTriangles );
+		}
+	}
+	item->mHasStroke = stroke;
+	item->mStrokeWidth = strokeWidth;
+
+	ColorA fillColor( mFillStack.back().getColor() );
+	fillColor.a = mFillOpacityStack.back();
+	item->mFillColor = fillColor;
+	ColorA strokeColor( mStrokeStack.back().getColor() );
+	strokeColor.a = mStrokeOpacityStack.back();
+	item->mStrokeColor = strokeColor;
+	item->mTransform = mMatrixStack.back();
+	item->mDirty = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SvgBatchGl
+SvgBatchGl::SvgBatchGl( const svg::DocRef &doc, float approximationScale )
+	: mDoc( doc ), mApproximationScale( approximationScale ), mAllDirty( true )
+{
+}
+
+void SvgBatchGl::draw()
+{
+	update();
+	if( mVertices.empty() )
+		return;
+
+	mVbo.bind();
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glVertexPointer( 2, GL_FLOAT, sizeof(Vertex), 0 );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const GLvoid*)sizeof(Vec2f) );
+
+	glDrawArrays( GL_TRIANGLES, 0, (GLsizei)mVertices.size() );
+
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+	mVbo.unbind();
+}
+
+void SvgBatchGl::update()
+{
+	if( ! mAllDirty && ! mDirtyNodes.empty() ) {
+		if( updateDirtyNodes() ) {
+			mDirtyNodes.clear();
+
+			// when every dirty Item kept its vertex count, only the span they occupy is uploaded
+			bool layoutChanged = false;
+			size_t firstDirty = mVertices.size(), endDirty = 0;
+			for( vector<Item>::iterator itemIt = mItems.begin(); itemIt != mItems.end(); ++itemIt ) {
+				if( ! itemIt->mDirty )
+					continue;
+				if( itemIt->mFillTriangles.size() + itemIt->mStrokeTriangles.size() != itemIt->mNumVertices ) {
+					layoutChanged = true;
+					break;
+				}
+				if( itemIt->mNumVertices > 0 ) {
+					writeVertices( *itemIt, &mVertices[itemIt->mFirstVertex] );
+					firstDirty = std::min( firstDirty, itemIt->mFirstVertex );
+					endDirty = std::max( endDirty, itemIt->mFirstVertex + itemIt->mNumVertices );
+				}
+				itemIt->mDirty = false;
+			}
+
+			if( layoutChanged )
+				rebuildVertexBuffer();
+			else if( firstDirty < endDirty ) {
+				mVbo.bind();
+				mVbo.bufferSubData( firstDirty * sizeof(Vertex), ( endDirty - firstDirty ) * sizeof(Vertex), &mVertices[firstDirty] );
+				mVbo.unbind();
+			}
+		}
+		else
+			mAllDirty = true;
+	}
+
+	if( mAllDirty ) {
+		mItems.clear();
+		mFirstItems.clear();
+		Recorder recorder( this, NULL );
+		mDoc->render( recorder );
+
+		mAllDirty = false;
+		mDirtyNodes.clear();
+		rebuildVertexBuffer();
+	}
+}
+
+bool SvgBatchGl::updateDirtyNodes()
+{
+	for( vector<const svg::Node*>::const_iterator nodeIt = mDirtyNodes.begin(); nodeIt != mDirtyNodes.end(); ++nodeIt ) {
+		// a node that recorded nothing last time, such as one that was hidden, can't be updated in place
+		map<const svg::Node*,size_t>::const_iterator firstIt = mFirstItems.find( *nodeIt );
+		if( firstIt == mFirstItems.end() )
+			return false;
+
+		size_t cursor = firstIt->second;
+		Recorder recorder( this, &cursor );
+		(*nodeIt)->render( recorder );
+		if( recorder.hasMismatch() )
+			return false;
+	}
+
+	return true;
+}
+
+void SvgBatchGl::rebuildVertexBuffer()
+{
+	size_t numVertices = 0;
+	for( vector<Item>::iterator itemIt = mItems.begin(); itemIt != mItems.end(); ++itemIt ) {
+		itemIt->mFirstVertex = numVertices;
+		itemIt->mNumVertices = itemIt->mFillTriangles.size() + itemIt->mStrokeTriangles.size();
+		numVertices += itemIt->mNumVertices;
+	}
+
+	mVertices.resize( numVertices );
+	for( vector<Item>::iterator itemIt = mItems.begin(); itemIt != mItems.end(); ++itemIt ) {
+		if( itemIt->mNumVertices > 0 )
+			writeVertices( *itemIt, &mVertices[itemIt->mFirstVertex] );
+		itemIt->mDirty = false;
+	}
+
+	if( mVertices.empty() )
+		return;
+
+	if( ! mVbo )
+		mVbo = gl::Vbo( GL_ARRAY_BUFFER );
+	mVbo.bind();
+	mVbo.bufferData( mVertices.size() * sizeof(Vertex), &mVertices[0], GL_DYNAMIC_DRAW );
+	mVbo.unbind();
+}
+
+// each Item's fill is drawn before its stroke, matching SvgRendererGl
+void SvgBatchGl::writeVertices( const Item &item, Vertex *result ) const
+{
+	for( vector<Vec2f>::const_iterator vertIt = item.mFillTriangles.begin(); vertIt != item.mFillTriangles.end(); ++vertIt, ++result ) {
+		result->mPosition = item.mTransform.transformPoint( *vertIt );
+		result->mColor = item.mFillColor;
+	}
+	for( vector<Vec2f>::const_iterator vertIt = item.mStrokeTriangles.begin(); vertIt != item.mStrokeTriangles.end(); ++vertIt, ++result ) {
+		result->mPosition = item.mTransform.transformPoint( *vertIt );
+		result->mColor = item.mStrokeColor;
+	}
+}
+
+} // namespace cinder
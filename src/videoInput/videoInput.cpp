@@ -20,6 +20,7 @@
 #define __IDxtJpeg_INTERFACE_DEFINED__
 #define __IDxtKey_INTERFACE_DEFINED__
 #include <uuids.h>
+#include <dvdmedia.h>
 #include <vector>
 #include <Aviriff.h>
 #include <Windows.h>
@@ -250,6 +251,7 @@ videoDevice::videoDevice(){
 		 specificFormat		= false;
 		 autoReconnect		= false;
 		 requestedFrameTime = -1;
+		 requestedMediaSubtype = -1;
 		 
 		 memset(wDeviceName, 0, sizeof(WCHAR) * 255);
 		 memset(nDeviceName, 0, sizeof(char) * 255);
@@ -534,6 +536,7 @@ videoInput::videoInput(){
 	makeGUID( &MEDIASUBTYPE_Y800, 0x30303859, 0x0000, 0x0010, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 );
 	makeGUID( &MEDIASUBTYPE_Y8, 0x20203859, 0x0000, 0x0010, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 );
 	makeGUID( &MEDIASUBTYPE_GREY, 0x59455247, 0x0000, 0x0010, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 );
+	makeGUID( &MEDIASUBTYPE_H264_FOURCC, 0x34363248, 0x0000, 0x0010, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 );
 
 	//The video types we support
 	//in order of preference
@@ -558,6 +561,10 @@ videoInput::videoInput(){
 	mediaSubtypes[15]	= MEDIASUBTYPE_Y800;
     mediaSubtypes[16]	= MEDIASUBTYPE_Y8;
 	mediaSubtypes[17]	= MEDIASUBTYPE_GREY;	
+
+	//compressed - only used when requested with setRequestedMediaSubtype
+	mediaSubtypes[VI_MEDIASUBTYPE_MJPG]	= MEDIASUBTYPE_MJPG;
+	mediaSubtypes[VI_MEDIASUBTYPE_H264]	= MEDIASUBTYPE_H264_FOURCC;
 	
 	//The video formats we support
 	formatTypes[VI_NTSC_M]		= AnalogVideo_NTSC_M;
@@ -641,6 +648,20 @@ void videoInput::setIdealFramerate(int deviceNumber, int idealFramerate){
 }
 
 
+// ---------------------------------------------------------------------- 
+// Set the requested media subtype - no guarantee you will get this
+//                                            
+// ---------------------------------------------------------------------- 
+
+void videoInput::setRequestedMediaSubtype(int deviceNumber, int mediaSubtype){
+	if(deviceNumber >= VI_MAX_CAMERAS || VDList[deviceNumber]->readyToCapture) return;
+
+	if( mediaSubtype >= -1 && mediaSubtype < VI_NUM_TYPES ){
+		VDList[deviceNumber]->requestedMediaSubtype = mediaSubtype;
+	}
+}
+
+
 // ---------------------------------------------------------------------- 
 // Set the requested framerate - no guarantee you will get this
 //                                            
@@ -873,6 +894,25 @@ int videoInput::listDevices(bool silent){
 }
 
 
+// ---------------------------------------------------------------------- 
+// 
+//                                           
+// ---------------------------------------------------------------------- 
+
+int videoInput::getMediaSubtype(int id){
+
+	if(isDeviceSetup(id))
+	{
+		for(int i = 0; i < VI_NUM_TYPES; i++){
+			if( VDList[id]->videoType == mediaSubtypes[i] ) return i;
+		}
+	}
+
+	return -1;
+
+}
+
+
 // ---------------------------------------------------------------------- 
 // 
 //                                           
@@ -1375,6 +1415,7 @@ bool videoInput::restartDevice(int id){
 		bool bReconnect = VDList[id]->autoReconnect;
 
 		unsigned long avgFrameTime = VDList[id]->requestedFrameTime;
+		int mediaSubtype = VDList[id]->requestedMediaSubtype;
 	
 		stopDevice(id);
 
@@ -1382,6 +1423,7 @@ bool videoInput::restartDevice(int id){
 		if( avgFrameTime != -1){
 			VDList[id]->requestedFrameTime = avgFrameTime;
 		}
+		VDList[id]->requestedMediaSubtype = mediaSubtype;
 
 		if( setupDevice(id, tmpW, tmpH, conn) ){
 			//reapply the format - ntsc / pal etc
@@ -1644,6 +1686,8 @@ void videoInput::getMediaSubtypeAsString(GUID type, char * typeAsString){
 	else if(type == MEDIASUBTYPE_Y800) 	strncpy(tmpStr, "Y800", maxStr);  
 	else if(type == MEDIASUBTYPE_Y8)   	strncpy(tmpStr, "Y8", maxStr);  
 	else if(type == MEDIASUBTYPE_GREY) 	strncpy(tmpStr, "GREY", maxStr);  
+	else if(type == MEDIASUBTYPE_MJPG) 	strncpy(tmpStr, "MJPG", maxStr);  
+	else if(type == MEDIASUBTYPE_H264_FOURCC) strncpy(tmpStr, "H264", maxStr);  
 	else strncpy(tmpStr, "OTHER", maxStr);
 
 	memcpy(typeAsString, tmpStr, sizeof(char)*8);
@@ -1790,6 +1834,43 @@ static bool setSizeAndSubtype(videoDevice * VD, int attemptWidth, int attemptHei
 	return false;
 }
 
+//---------------------------------------------------------------------------------------------------
+//compressed formats need the device's own header for the size, so unlike setSizeAndSubtype this picks one of the device's capabilities
+static bool setSizeAndSubtypeFromCaps(videoDevice * VD, int attemptWidth, int attemptHeight, GUID mediatype){
+	int iCount = 0; 
+	int iSize = 0;
+	HRESULT hr = VD->streamConf->GetNumberOfCapabilities(&iCount, &iSize);
+	if(FAILED(hr) || iSize != sizeof(VIDEO_STREAM_CONFIG_CAPS)) return false;
+
+	bool found = false;
+	for(int iFormat = 0; iFormat < iCount && !found; iFormat++){
+		VIDEO_STREAM_CONFIG_CAPS scc;
+		AM_MEDIA_TYPE *pmtConfig;
+		hr = VD->streamConf->GetStreamCaps(iFormat, &pmtConfig, (BYTE*)&scc);
+		if(FAILED(hr)) continue;
+
+		BITMAPINFOHEADER * bmi = NULL;
+		if(pmtConfig->formattype == FORMAT_VideoInfo && pmtConfig->cbFormat >= sizeof(VIDEOINFOHEADER)){
+			bmi = &reinterpret_cast<VIDEOINFOHEADER*>(pmtConfig->pbFormat)->bmiHeader;
+		}else if(pmtConfig->formattype == FORMAT_VideoInfo2 && pmtConfig->cbFormat >= sizeof(VIDEOINFOHEADER2)){
+			bmi = &reinterpret_cast<VIDEOINFOHEADER2*>(pmtConfig->pbFormat)->bmiHeader;
+		}
+
+		if(pmtConfig->subtype == mediatype && bmi != NULL && bmi->biWidth == attemptWidth && abs(bmi->biHeight) == attemptHeight){
+			//both headers begin with the same fields up to AvgTimePerFrame
+			//the fps is only set when the format supports it, otherwise the format's own fps is kept
+			if( VD->requestedFrameTime != -1 && VD->requestedFrameTime >= scc.MinFrameInterval && VD->requestedFrameTime <= scc.MaxFrameInterval ){
+				reinterpret_cast<VIDEOINFOHEADER*>(pmtConfig->pbFormat)->AvgTimePerFrame = VD->requestedFrameTime;
+			}
+			found = ( VD->streamConf->SetFormat(pmtConfig) == S_OK );
+		}
+
+		MyDeleteMediaType(pmtConfig);
+	}
+
+	return found;
+}
+
 // ---------------------------------------------------------------------- 
 // Where all the work happens!
 // Attempts to build a graph for the specified device                                   
@@ -1906,13 +1987,25 @@ int videoInput::start(int deviceID, videoDevice *VD){
 		if(verbose)	printf("SETUP: Default Format is set to %i by %i \n", currentWidth, currentHeight);
 		
 		char guidStr[8];
-		for(int i = 0; i < VI_NUM_TYPES; i++){
+		if( VD->requestedMediaSubtype != -1 ){
+			getMediaSubtypeAsString(mediaSubtypes[VD->requestedMediaSubtype], guidStr);
+
+			if(verbose)printf("SETUP: trying requested format %s @ %i by %i\n", guidStr, VD->tryWidth, VD->tryHeight);
+			if( setSizeAndSubtypeFromCaps(VD, VD->tryWidth, VD->tryHeight, mediaSubtypes[VD->requestedMediaSubtype]) ){
+				VD->setSize(VD->tryWidth, VD->tryHeight);
+				VD->videoType = mediaSubtypes[VD->requestedMediaSubtype];
+				foundSize = true;
+			}
+		}
+
+		for(int i = 0; !foundSize && i < VI_NUM_UNCOMPRESSED_TYPES; i++){
 			
 			getMediaSubtypeAsString(mediaSubtypes[i], guidStr);
 
 			if(verbose)printf("SETUP: trying format %s @ %i by %i\n", guidStr, VD->tryWidth, VD->tryHeight);
 			if( setSizeAndSubtype(VD, VD->tryWidth, VD->tryHeight, mediaSubtypes[i]) ){
 				VD->setSize(VD->tryWidth, VD->tryHeight);
+				VD->videoType = mediaSubtypes[i];
 				foundSize = true;
 				break;
 			}
@@ -1934,6 +2027,7 @@ int videoInput::start(int deviceID, videoDevice *VD){
 				if(verbose)printf("SETUP: closest supported size is %s @ %i %i\n", guidStr, closestWidth, closestHeight);
 				if( setSizeAndSubtype(VD, closestWidth, closestHeight, newMediaSubtype) ){
 					VD->setSize(closestWidth, closestHeight);
+					VD->videoType = newMediaSubtype;
 					foundSize = true;
 				}
 			}
@@ -1947,6 +2041,7 @@ int videoInput::start(int deviceID, videoDevice *VD){
 			hr = VD->streamConf->SetFormat(VD->pAmMediaType);		 
 		} 
 		VD->setSize(currentWidth, currentHeight);
+		VD->videoType = VD->pAmMediaType->subtype;
 	}
 
 	//SAMPLE GRABBER (ALLOWS US TO GRAB THE BUFFER)//
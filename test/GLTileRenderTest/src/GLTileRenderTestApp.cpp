@@ -2,6 +2,7 @@
 #include "cinder/Camera.h"
 #include "cinder/Utilities.h"
 #include "cinder/gl/TileRender.h"
+#include "cinder/TiledSurface.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -56,6 +57,21 @@ void GLTileRenderTestApp::keyDown( KeyEvent event )
 		}
 		writeImage( getHomeDirectory() + "tileRenderOutput.png", tr.getSurface() );
 	}
+	else if( event.getChar() == 'f' ) { // pipelined through Fbos, should match the output of ' '
+		gl::TileRender tr( getWindowWidth() * 3, getWindowHeight() * 3, 11, 131, gl::TileRender::Format().fbos( 3 ) );
+		tr.setMatrices( mCam );
+		while( tr.nextTile() ) {
+			drawFrame();
+		}
+		writeImage( getHomeDirectory() + "tileRenderOutputFbo.png", tr.getSurface() );
+	}
+	else if( event.getChar() == 's' ) { // streamed to disk a row of tiles at a time
+		gl::TileRender tr( getWindowWidth() * 3, getWindowHeight() * 3, 256, 131, gl::TileRender::Format().fbos( 3 ).streamToPpm( getHomeDirectory() + "tileRenderOutput.ppm" ) );
+		tr.setMatrices( mCam );
+		while( tr.nextTile() ) {
+			drawFrame();
+		}
+	}
 }
 
 void GLTileRenderTestApp::update()
@@ -4,7 +4,9 @@
 #include "cinder/audio/GenNode.h"
 #include "cinder/audio/GainNode.h"
 #include "cinder/audio/ChannelRouterNode.h"
+#include "cinder/audio/SpatialPannerNode.h"
 #include "cinder/audio/MonitorNode.h"
+#include "cinder/audio/FilterNode.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/audio/Debug.h"
@@ -35,6 +37,8 @@ public:
 	void setupMerge4();
 	void setupSplitStereo();
 	void setupSplitMerge();
+	void setupSpatialPanner();
+	void setupScheduled();
 
 	void printDefaultOutput();
 	void setupUI();
@@ -251,6 +255,59 @@ void NodeTestApp::setupSplitMerge()
 	mEnableSineButton.setEnabled( true );
 }
 
+// pans the sine and noise onto a stereo speaker layout, so that it can be heard without a multichannel device.
+void NodeTestApp::setupSpatialPanner()
+{
+	auto ctx = audio::master();
+	ctx->disconnectAllNodes();
+
+	vector<Vec3f> speakers;
+	speakers.push_back( Vec3f( -1, 0, -1 ) );
+	speakers.push_back( Vec3f( 1, 0, -1 ) );
+
+	auto panner = ctx->makeNode( new audio::SpatialPannerNode( speakers ) );
+	panner->addSource( mGen, Vec3f( -1, 0, -1 ) );
+	panner->addSource( mNoise, Vec3f( 1, 0, -1 ), 0.5f );
+
+	panner >> mGain >> mMonitor >> ctx->getOutput();
+
+	mGen->enable();
+	mNoise->enable();
+	mEnableNoiseButton.setEnabled( true );
+	mEnableSineButton.setEnabled( true );
+}
+
+// Schedules short sine bursts and toggles a lowpass on the noise at 16th notes (120 bpm) for a few seconds. The timing should stay
+// exact at any frames per block, as the GenNode handles the process range itself and the FilterLowPassNode is processed on sub-blocks.
+void NodeTestApp::setupScheduled()
+{
+	auto ctx = audio::master();
+	ctx->disconnectAllNodes();
+
+	auto lowpass = ctx->makeNode( new audio::FilterLowPassNode );
+	lowpass->setCutoffFreq( 400 );
+
+	mGen >> mGain;
+	mNoise >> lowpass >> mGain;
+	mGain >> mMonitor >> ctx->getOutput();
+
+	mGen->disable();
+	mNoise->enable();
+	lowpass->disable();
+
+	const double beginTime = ctx->getNumProcessedSeconds() + 0.5;
+	const double stepSeconds = 0.125;
+	for( size_t i = 0; i < 32; i++ ) {
+		double stepTime = beginTime + i * stepSeconds;
+		mGen->enable( stepTime );
+		mGen->disable( stepTime + 0.01 );
+		lowpass->setEnabled( i % 2 == 0, stepTime );
+	}
+
+	mEnableNoiseButton.setEnabled( true );
+	mEnableSineButton.setEnabled( false );
+}
+
 void NodeTestApp::printDefaultOutput()
 {
 	audio::DeviceRef device = audio::Device::getDefaultOutput();
@@ -278,6 +335,8 @@ void NodeTestApp::setupUI()
 	mTestSelector.mSegments.push_back( "merge4" );
 	mTestSelector.mSegments.push_back( "split stereo" );
 	mTestSelector.mSegments.push_back( "split-merge" );
+	mTestSelector.mSegments.push_back( "spatial panner" );
+	mTestSelector.mSegments.push_back( "scheduled" );
 	mWidgets.push_back( &mTestSelector );
 
 	mGainSlider.mTitle = "GainNode";
@@ -361,6 +420,10 @@ void NodeTestApp::processTap( Vec2i pos )
 			setupSplitStereo();
 		else if( currentTest == "split-merge" )
 			setupSplitMerge();
+		else if( currentTest == "spatial panner" )
+			setupSpatialPanner();
+		else if( currentTest == "scheduled" )
+			setupScheduled();
 
 		PRINT_GRAPH( ctx );
 	}
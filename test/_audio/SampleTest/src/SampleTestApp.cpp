@@ -45,6 +45,7 @@ class SamplePlayerNodeTestApp : public AppNative {
 	void setupBufferPlayerNode();
 	void setupFilePlayerNode();
 	void setupBufferRecorderNode();
+	void setupFileRecorderNode();
 	void setSourceFile( const DataSourceRef &dataSource );
 	void writeRecordedToFile();
 	void triggerStartStop( bool start );
@@ -59,6 +60,7 @@ class SamplePlayerNodeTestApp : public AppNative {
 
 	void testConverter();
 	void testWrite();
+	void testPreload();
 
 	audio::SamplePlayerNodeRef		mSamplePlayerNode;
 	audio::SourceFileRef			mSourceFile;
@@ -66,6 +68,7 @@ class SamplePlayerNodeTestApp : public AppNative {
 	audio::GainNodeRef				mGain;
 	audio::Pan2dNodeRef				mPan;
 	audio::BufferRecorderNodeRef	mRecorder;
+	audio::FileRecorderNodeRef		mFileRecorder;
 
 	WaveformPlot				mWaveformPlot;
 	vector<TestWidget *>		mWidgets;
@@ -197,6 +200,20 @@ void SamplePlayerNodeTestApp::setupBufferRecorderNode()
 	PRINT_GRAPH( audio::master() );
 }
 
+void SamplePlayerNodeTestApp::setupFileRecorderNode()
+{
+	const string fileName = "file_recorder_out.wav";
+	CI_LOG_V( "recording to: " << fileName );
+
+	mFileRecorder = audio::master()->makeNode( new audio::FileRecorderNode( fileName ) );
+
+	CI_ASSERT( mSamplePlayerNode );
+
+	mSamplePlayerNode >> mFileRecorder;
+
+	PRINT_GRAPH( audio::master() );
+}
+
 void SamplePlayerNodeTestApp::setSourceFile( const DataSourceRef &dataSource )
 {
 	mSourceFile = audio::load( dataSource, audio::master()->getSampleRate() );
@@ -306,6 +323,7 @@ void SamplePlayerNodeTestApp::setupUI()
 	mTestSelector.mSegments.push_back( "BufferPlayerNode" );
 	mTestSelector.mSegments.push_back( "FilePlayerNode" );
 	mTestSelector.mSegments.push_back( "recorder" );
+	mTestSelector.mSegments.push_back( "file recorder" );
 	mTestSelector.mBounds = selectorRect;
 	mWidgets.push_back( &mTestSelector );
 
@@ -391,7 +409,13 @@ void SamplePlayerNodeTestApp::processTap( Vec2i pos )
 	else if( mLoopButton.hitTest( pos ) )
 		mSamplePlayerNode->setLoopEnabled( ! mSamplePlayerNode->isLoopEnabled() );
 	else if( mRecordButton.hitTest( pos ) ) {
-		if( mRecordButton.mEnabled )
+		if( mTestSelector.currentSection() == "file recorder" ) {
+			if( mRecordButton.mEnabled )
+				mFileRecorder->start();
+			else
+				mFileRecorder->stop();
+		}
+		else if( mRecordButton.mEnabled )
 			mRecorder->start();
 		else
 			mRecorder->disable();
@@ -416,6 +440,8 @@ void SamplePlayerNodeTestApp::processTap( Vec2i pos )
 			setupFilePlayerNode();
 		if( currentTest == "recorder" )
 			setupBufferRecorderNode();
+		if( currentTest == "file recorder" )
+			setupFileRecorderNode();
 	}
 }
 
@@ -463,6 +489,8 @@ void SamplePlayerNodeTestApp::keyDown( KeyEvent event )
 		testConverter();
 	if( event.getCode() == KeyEvent::KEY_w )
 		testWrite();
+	if( event.getCode() == KeyEvent::KEY_p )
+		testPreload();
 	if( event.getCode() == KeyEvent::KEY_s )
 		mSamplePlayerNode->seekToTime( 1.0 );
 }
@@ -516,7 +544,12 @@ void SamplePlayerNodeTestApp::update()
 	}
 
 	bool testIsRecorder = ( mTestSelector.currentSection() == "recorder" );
-	mRecordButton.mHidden = mWriteButton.mHidden = mAutoResizeButton.mHidden = ! testIsRecorder;
+	bool testIsFileRecorder = ( mTestSelector.currentSection() == "file recorder" );
+	mWriteButton.mHidden = mAutoResizeButton.mHidden = ! testIsRecorder;
+	mRecordButton.mHidden = ! ( testIsRecorder || testIsFileRecorder );
+
+	if( testIsFileRecorder && mFileRecorder->getLastOverrun() )
+		timeline().apply( &mRecorderOverrunFade, 1.0f, 0.0f, xrunFadeTime );
 
 	// test auto resizing the Recorder's buffer depending on how full it is
 	if( testIsRecorder && mAutoResizeButton.mEnabled ) {
@@ -645,4 +678,31 @@ void SamplePlayerNodeTestApp::testWrite()
 	}
 }
 
+void SamplePlayerNodeTestApp::testPreload()
+{
+	vector<DataSourceRef> dataSources;
+	dataSources.push_back( loadResource( RES_TONE440_WAV ) );
+	dataSources.push_back( loadResource( RES_TONE440L220R_WAV ) );
+	dataSources.push_back( loadResource( RES_TONE440_MP3 ) );
+	dataSources.push_back( loadResource( RES_TONE440_OGG ) );
+	dataSources.push_back( loadResource( RES_TONE440L220R_OGG ) );
+
+	try {
+		Timer timer( true );
+		auto preload = audio::BufferCache::get()->preload( dataSources, audio::master()->getSampleRate(), [] ( size_t numCompleted, size_t numSources ) {
+			CI_LOG_V( "preloaded " << numCompleted << " of " << numSources );
+		} );
+
+		auto buffers = preload->getBuffers();
+		CI_LOG_V( "preloaded " << buffers.size() << " buffers in " << timer.getSeconds() << " seconds, cache memory usage: " << audio::BufferCache::get()->getMemoryUsage() << " bytes" );
+
+		auto bufferPlayer = dynamic_pointer_cast<audio::BufferPlayerNode>( mSamplePlayerNode );
+		if( bufferPlayer )
+			bufferPlayer->setBuffer( buffers.back() );
+	}
+	catch( audio::AudioFileExc &exc ) {
+		CI_LOG_E( "AudioFileExc, what: " << exc.what() );
+	}
+}
+
 CINDER_APP_NATIVE( SamplePlayerNodeTestApp, RendererGl )
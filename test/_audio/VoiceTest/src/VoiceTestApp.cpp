@@ -29,6 +29,7 @@ public:
 	void setupBasicStereo();
 	void setupDifferentFile();
 	void setupScope();
+	void setupCached();
 
 	void setupUI();
 	void processDrag( Vec2i pos );
@@ -95,6 +96,21 @@ void VoiceTestApp::setupScope()
 	mVoice->getOutputNode() >> mMonitor >> ctx->getOutput();
 }
 
+void VoiceTestApp::setupCached()
+{
+	// the second Voice finds the decoded samples in the BufferCache, so the file isn't opened again.
+	auto first = audio::Voice::create( loadResource( RES_TONE_440L220R ) );
+	mVoice = audio::Voice::create( loadResource( RES_TONE_440L220R ) );
+	mVoice->setVolume( mVolumeSlider.mValueScaled );
+
+	auto firstPlayer = dynamic_pointer_cast<audio::BufferPlayerNode>( first->getSamplePlayerNode() );
+	auto player = dynamic_pointer_cast<audio::BufferPlayerNode>( dynamic_pointer_cast<audio::VoiceSamplePlayerNode>( mVoice )->getSamplePlayerNode() );
+	if( firstPlayer && player )
+		CI_ASSERT( firstPlayer->getBuffer() == player->getBuffer() );
+
+	CI_LOG_I( "BufferCache memory usage: " << audio::BufferCache::get()->getMemoryUsage() << " bytes" );
+}
+
 void VoiceTestApp::setupUI()
 {
 	mPlayButton = Button( false, "start" );
@@ -105,6 +121,7 @@ void VoiceTestApp::setupUI()
 	mTestSelector.mSegments.push_back( "basic stereo" );
 	mTestSelector.mSegments.push_back( "file 2" );
 	mTestSelector.mSegments.push_back( "scope" );
+	mTestSelector.mSegments.push_back( "cached" );
 	mWidgets.push_back( &mTestSelector );
 
 	mVolumeSlider.mTitle = "Volume";
@@ -154,6 +171,8 @@ void VoiceTestApp::processTap( Vec2i pos )
 			setupScope();
 		else if( currentTest == "file 2" )
 			setupDifferentFile();
+		else if( currentTest == "cached" )
+			setupCached();
 
 		PRINT_GRAPH( audio::master() );
 	}
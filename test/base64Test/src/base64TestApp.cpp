@@ -42,6 +42,15 @@ void base64TestApp::setup()
 			Buffer b = fromBase64(base64);
 			assert( toString( b ) == test );
 		}
+
+		// the streaming variants must match the in-memory ones
+		OStreamMemRef encoded = OStreamMem::create();
+		toBase64( IStreamMem::create( test.c_str(), test.size() ), encoded, 76 );
+		std::string encodedStr( static_cast<const char*>( encoded->getBuffer() ), (size_t)encoded->tell() );
+		assert( encodedStr == toBase64( test, 76 ) );
+		OStreamMemRef decoded = OStreamMem::create();
+		fromBase64( IStreamMem::create( encodedStr.c_str(), encodedStr.size() ), decoded );
+		assert( std::string( static_cast<const char*>( decoded->getBuffer() ), (size_t)decoded->tell() ) == test );
 	}
 	app::console() << "Tests passed" << std::endl;
 }
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include "cinder/Rand.h"
+#include "cinder/Utilities.h"
+#include "cinder/audio/Buffer.h"
+#include "cinder/audio/dsp/Biquad.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/dsp/Fft.h"
+
+inline void fillRandom( ci::audio::Buffer *buffer )
+{
+	ci::Rand rand( 1 );
+	for( size_t i = 0; i < buffer->getSize(); i++ )
+		buffer->getData()[i] = rand.nextFloat( -1.0f, 1.0f );
+}
+
+inline void runAudioDspBenchmarks( bench::Runner &runner )
+{
+	using namespace ci::audio;
+
+	const size_t fftSizes[] = { 512, 2048, 8192 };
+	for( size_t i = 0; i < sizeof( fftSizes ) / sizeof( fftSizes[0] ); ++i ) {
+		const size_t fftSize = fftSizes[i];
+		dsp::Fft fft( fftSize );
+		Buffer waveform( fftSize );
+		BufferSpectral spectral( fftSize );
+		fillRandom( &waveform );
+
+		runner.run( "audio/Fft forward " + ci::toString( fftSize ), [&] {
+			fft.forward( &waveform, &spectral );
+		}, (double)fftSize );
+
+		runner.run( "audio/Fft inverse " + ci::toString( fftSize ), [&] {
+			fft.inverse( &spectral, &waveform );
+		}, (double)fftSize );
+	}
+
+	const size_t length = 4096;
+	Buffer a( length ), b( length ), result( length );
+	fillRandom( &a );
+	fillRandom( &b );
+
+	runner.run( "audio/dsp mul", [&] {
+		dsp::mul( a.getData(), b.getData(), result.getData(), length );
+	}, length );
+
+	runner.run( "audio/dsp addMul", [&] {
+		dsp::addMul( a.getData(), b.getData(), 0.5f, result.getData(), length );
+	}, length );
+
+	runner.run( "audio/dsp sum", [&] {
+		bench::doNotOptimize( dsp::sum( a.getData(), length ) );
+	}, length );
+
+	runner.run( "audio/dsp rms", [&] {
+		bench::doNotOptimize( dsp::rms( a.getData(), length ) );
+	}, length );
+
+	dsp::Biquad biquad;
+	biquad.setLowpassParams( 0.1, 0.5 );
+	runner.run( "audio/dsp Biquad lowpass", [&] {
+		biquad.process( a.getData(), result.getData(), length );
+	}, length );
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+
+#include "cinder/Json.h"
+#include "cinder/System.h"
+#include "cinder/Timer.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace ci;
+using namespace std;
+
+namespace bench {
+
+Runner::Runner()
+	: mNumSamples( 15 ), mNumWarmupSamples( 3 ), mMinSampleSeconds( 0.02 )
+{
+}
+
+double Runner::timeSample( const std::function<void ()> &fn, size_t iterations ) const
+{
+	Timer timer( true );
+	for( size_t i = 0; i < iterations; ++i )
+		fn();
+	return timer.getSeconds();
+}
+
+void Runner::run( const std::string &name, const std::function<void ()> &fn, double itemsPerIteration )
+{
+	if( ! mFilter.empty() && name.find( mFilter ) == string::npos )
+		return;
+
+	// calibrate the number of iterations so that a sample isn't dominated by the timer's resolution
+	size_t iterations = 1;
+	while( timeSample( fn, iterations ) < mMinSampleSeconds && iterations < ( size_t( 1 ) << 30 ) )
+		iterations *= 2;
+
+	for( size_t i = 0; i < mNumWarmupSamples; ++i )
+		timeSample( fn, iterations );
+
+	vector<double> samples( max<size_t>( mNumSamples, 1 ) );
+	for( size_t i = 0; i < samples.size(); ++i )
+		samples[i] = timeSample( fn, iterations ) / iterations;
+
+	sort( samples.begin(), samples.end() );
+
+	Result result;
+	result.mName = name;
+	result.mIterations = iterations;
+	result.mSamples = samples.size();
+	result.mMin = samples.front();
+	result.mMax = samples.back();
+	size_t mid = samples.size() / 2;
+	result.mMedian = ( samples.size() % 2 ) ? samples[mid] : ( samples[mid - 1] + samples[mid] ) / 2;
+
+	double sum = 0;
+	for( size_t i = 0; i < samples.size(); ++i )
+		sum += samples[i];
+	result.mMean = sum / samples.size();
+
+	double variance = 0;
+	for( size_t i = 0; i < samples.size(); ++i )
+		variance += ( samples[i] - result.mMean ) * ( samples[i] - result.mMean );
+	result.mStdDev = samples.size() > 1 ? sqrt( variance / ( samples.size() - 1 ) ) : 0;
+	result.mItemsPerIteration = itemsPerIteration;
+
+	mResults.push_back( result );
+	cout << result << endl;
+}
+
+void Runner::writeJson( const DataTargetRef &target ) const
+{
+	JsonTree settings = JsonTree::makeObject( "settings" );
+	settings.pushBack( JsonTree( "samples", uint64_t( mNumSamples ) ) );
+	settings.pushBack( JsonTree( "warmupSamples", uint64_t( mNumWarmupSamples ) ) );
+	settings.pushBack( JsonTree( "minSampleSeconds", mMinSampleSeconds ) );
+	settings.pushBack( JsonTree( "filter", mFilter ) );
+#if defined( NDEBUG )
+	settings.pushBack( JsonTree( "build", "release" ) );
+#else
+	settings.pushBack( JsonTree( "build", "debug" ) );
+#endif
+
+	JsonTree platform = JsonTree::makeObject( "platform" );
+#if defined( CINDER_MAC )
+	platform.pushBack( JsonTree( "os", "mac" ) );
+#elif defined( CINDER_MSW )
+	platform.pushBack( JsonTree( "os", "msw" ) );
+#else
+	platform.pushBack( JsonTree( "os", "other" ) );
+#endif
+	platform.pushBack( JsonTree( "osVersion", toString( System::getOsMajorVersion() ) + "." + toString( System::getOsMinorVersion() ) ) );
+	platform.pushBack( JsonTree( "physicalCores", System::getNumCores() ) );
+	platform.pushBack( JsonTree( "pointerBits", int( sizeof( void* ) * 8 ) ) );
+
+	JsonTree results = JsonTree::makeArray( "results" );
+	for( vector<Result>::const_iterator resultIt = mResults.begin(); resultIt != mResults.end(); ++resultIt ) {
+		JsonTree result = JsonTree::makeObject();
+		result.pushBack( JsonTree( "name", resultIt->mName ) );
+		result.pushBack( JsonTree( "iterations", uint64_t( resultIt->mIterations ) ) );
+		result.pushBack( JsonTree( "samples", uint64_t( resultIt->mSamples ) ) );
+		result.pushBack( JsonTree( "minSeconds", resultIt->mMin ) );
+		result.pushBack( JsonTree( "medianSeconds", resultIt->mMedian ) );
+		result.pushBack( JsonTree( "meanSeconds", resultIt->mMean ) );
+		result.pushBack( JsonTree( "stdDevSeconds", resultIt->mStdDev ) );
+		result.pushBack( JsonTree( "maxSeconds", resultIt->mMax ) );
+		if( resultIt->mItemsPerIteration > 0 )
+			result.pushBack( JsonTree( "itemsPerSecond", resultIt->mItemsPerIteration / resultIt->mMedian ) );
+		results.pushBack( result );
+	}
+
+	JsonTree root = JsonTree::makeObject();
+	root.pushBack( settings );
+	root.pushBack( platform );
+	root.pushBack( results );
+	root.write( target );
+}
+
+std::ostream& operator<<( std::ostream &os, const Result &result )
+{
+	ios::fmtflags flags = os.flags();
+	os << left << setw( 40 ) << result.mName << right << fixed << setprecision( 3 )
+		<< " median: " << setw( 12 ) << result.mMedian * 1e6 << " us"
+		<< "  min: " << setw( 12 ) << result.mMin * 1e6 << " us"
+		<< "  stddev: " << setw( 6 ) << setprecision( 1 ) << ( result.mMean > 0 ? 100 * result.mStdDev / result.mMean : 0 ) << "%";
+	if( result.mItemsPerIteration > 0 )
+		os << "  " << setprecision( 2 ) << result.mItemsPerIteration / result.mMedian / 1e6 << " M/s";
+	os.flags( flags );
+	return os;
+}
+
+} // namespace bench
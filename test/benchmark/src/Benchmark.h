@@ -0,0 +1,67 @@
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataTarget.h"
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+//! Timing statistics of one benchmark case, in seconds per iteration.
+struct Result {
+	std::string		mName;
+	size_t			mIterations;	// iterations per sample
+	size_t			mSamples;
+	double			mMin, mMedian, mMean, mStdDev, mMax;
+	double			mItemsPerIteration;	// 0 if the case didn't report a throughput
+};
+
+//! Runs benchmark cases and collects their Results.
+//!
+//! Each case is first calibrated, doubling its iteration count until one sample takes at least the minimum sample time.
+//! It is then run for a number of untimed warmup samples, so that caches, branch predictors and lazily allocated state
+//! settle, followed by the timed samples that the statistics are computed from. The median is the most robust figure to compare across runs.
+class Runner {
+  public:
+	Runner();
+
+	//! Sets the number of timed samples per case. Default is 15.
+	void	setNumSamples( size_t numSamples )			{ mNumSamples = numSamples; }
+	//! Sets the number of untimed warmup samples per case. Default is 3.
+	void	setNumWarmupSamples( size_t numSamples )	{ mNumWarmupSamples = numSamples; }
+	//! Sets the minimum duration of a sample in seconds, which determines the number of iterations per sample. Default is 0.02.
+	void	setMinSampleSeconds( double seconds )		{ mMinSampleSeconds = seconds; }
+	//! Only cases whose name contains \a filter are run. An empty filter runs all cases.
+	void	setFilter( const std::string &filter )		{ mFilter = filter; }
+
+	//! Runs \a fn as the case \a name and prints its Result to std::cout. \a itemsPerIteration, if non-zero, is used to report throughput (e.g. pixels or samples per second).
+	void	run( const std::string &name, const std::function<void ()> &fn, double itemsPerIteration = 0 );
+
+	const std::vector<Result>&	getResults() const	{ return mResults; }
+
+	//! Writes the Results as JSON, along with the settings and platform they were measured with.
+	void	writeJson( const ci::DataTargetRef &target ) const;
+
+  private:
+	double	timeSample( const std::function<void ()> &fn, size_t iterations ) const;
+
+	size_t				mNumSamples, mNumWarmupSamples;
+	double				mMinSampleSeconds;
+	std::string			mFilter;
+	std::vector<Result>	mResults;
+};
+
+std::ostream& operator<<( std::ostream &os, const Result &result );
+
+//! Prevents the compiler from optimizing away the computation of \a value.
+template<typename T>
+inline void doNotOptimize( const T &value )
+{
+	static volatile char sink;
+	sink = *reinterpret_cast<const volatile char*>( &value );
+}
+
+} // namespace bench
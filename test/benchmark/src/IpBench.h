@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include "cinder/Rand.h"
+#include "cinder/Surface.h"
+#include "cinder/ip/Blur.h"
+#include "cinder/ip/ColorSpace.h"
+#include "cinder/ip/Convolve.h"
+#include "cinder/ip/EdgeDetect.h"
+#include "cinder/ip/Flip.h"
+#include "cinder/ip/Grayscale.h"
+#include "cinder/ip/Hdr.h"
+#include "cinder/ip/Pipeline.h"
+#include "cinder/ip/Premultiply.h"
+#include "cinder/ip/Resize.h"
+#include "cinder/ip/Statistics.h"
+#include "cinder/ip/Threshold.h"
+
+inline ci::Surface8u makeNoiseSurface( int width, int height )
+{
+	ci::Surface8u result( width, height, true );
+	ci::Rand rand( 1 );
+	for( int y = 0; y < height; ++y ) {
+		uint8_t *p = result.getData( ci::Vec2i( 0, y ) );
+		for( int x = 0; x < width * 4; ++x )
+			p[x] = (uint8_t)rand.nextInt( 256 );
+	}
+
+	return result;
+}
+
+inline void runIpBenchmarks( bench::Runner &runner )
+{
+	using namespace ci;
+
+	const int size = 1024;
+	const double pixels = size * size;
+
+	Surface8u source = makeNoiseSurface( size, size );
+	Surface8u half( size / 2, size / 2, true ), dest( size, size, true ), scratch( size, size, true );
+	Channel8u gray( size, size );
+
+	runner.run( "ip/resize 1024->512 triangle", [&] {
+		ip::resize( source, &half );
+	}, pixels );
+
+	runner.run( "ip/resize 1024->512 gaussian", [&] {
+		ip::resize( source, &half, FilterGaussian() );
+	}, pixels );
+
+	runner.run( "ip/resize 512->1024 triangle", [&] {
+		ip::resize( half, &dest );
+	}, pixels );
+
+	runner.run( "ip/resizeParallel 1024->512 triangle", [&] {
+		ip::resizeParallel( source, &half );
+	}, pixels );
+
+	runner.run( "ip/gaussianBlur sigma 4", [&] {
+		ip::gaussianBlur( source, &dest, 4.0f );
+	}, pixels );
+
+	runner.run( "ip/grayscale", [&] {
+		ip::grayscale( source, &gray );
+	}, pixels );
+
+	Channel8u edges( size, size );
+	runner.run( "ip/edgeDetectSobel channel", [&] {
+		ip::edgeDetectSobel( gray, &edges );
+	}, pixels );
+
+	runner.run( "ip/convolve gaussian 5x5", [&] {
+		ip::convolve( source, &dest, ip::ConvolutionKernel::gaussian( 5 ) );
+	}, pixels );
+
+	runner.run( "ip/convolve sharpen 3x3", [&] {
+		ip::convolve( source, &dest, ip::ConvolutionKernel::sharpen() );
+	}, pixels );
+
+	runner.run( "ip/getStatistics surface", [&] {
+		ip::ChannelStatistics red, green, blue, alpha;
+		ip::getStatistics( source, source.getBounds(), &red, &green, &blue, &alpha );
+		bench::doNotOptimize( red );
+	}, pixels );
+
+	runner.run( "ip/getHistograms surface", [&] {
+		ip::Histogram red, green, blue;
+		ip::getHistograms( source, source.getBounds(), &red, &green, &blue );
+		bench::doNotOptimize( red.getTotal() );
+	}, pixels );
+
+	runner.run( "ip/premultiply", [&] {
+		scratch.copyFrom( source, source.getBounds() );
+		ip::premultiply( &scratch );
+	}, pixels );
+
+	runner.run( "ip/flipVertical", [&] {
+		ip::flipVertical( &scratch );
+	}, pixels );
+
+	runner.run( "ip flip+premultiply+grayscale+threshold separate", [&] {
+		scratch.copyFrom( source, source.getBounds() );
+		ip::flipVertical( &scratch );
+		ip::premultiply( &scratch );
+		ip::grayscale( scratch, &scratch );
+		ip::threshold( &scratch, (uint8_t)128 );
+	}, pixels );
+
+	ip::Pipeline pipeline;
+	pipeline.flipVertical().premultiply().grayscale().threshold( 128 );
+	runner.run( "ip flip+premultiply+grayscale+threshold Pipeline", [&] {
+		pipeline.apply( source, &scratch );
+	}, pixels );
+
+	runner.run( "Surface8u copyFrom", [&] {
+		dest.copyFrom( source, source.getBounds() );
+	}, pixels );
+
+	runner.run( "Surface8u copyFrom offset", [&] {
+		dest.copyFrom( source, Area( 0, 0, size - 3, size - 1 ), Vec2i( 3, 1 ) );
+	}, ( size - 3 ) * ( size - 1 ) );
+
+	Surface8u rgb( size, size, false );
+	runner.run( "Surface8u copyFrom RGBA->RGB", [&] {
+		rgb.copyFrom( source, source.getBounds() );
+	}, pixels );
+
+	Surface8u bgra( size, size, true, SurfaceChannelOrder::BGRA );
+	runner.run( "Surface8u copyFrom RGBA->BGRA", [&] {
+		bgra.copyFrom( source, source.getBounds() );
+	}, pixels );
+
+	Surface8u argb( size, size, true, SurfaceChannelOrder::ARGB );
+	runner.run( "Surface8u copyFrom BGRA->ARGB", [&] {
+		argb.copyFrom( bgra, bgra.getBounds() );
+	}, pixels );
+
+	runner.run( "Surface8u copyFrom RGB->RGBA", [&] {
+		dest.copyFrom( rgb, rgb.getBounds() );
+	}, pixels );
+
+	runner.run( "Surface32f from Surface8u", [&] {
+		Surface32f converted( source );
+		bench::doNotOptimize( converted.getData()[0] );
+	}, pixels );
+
+	Surface32f floatSource( source );
+	runner.run( "Surface8u from Surface32f", [&] {
+		Surface8u converted( floatSource );
+		bench::doNotOptimize( converted.getData()[0] );
+	}, pixels );
+
+	Surface8u toneMapped( floatSource.getWidth(), floatSource.getHeight(), true );
+	runner.run( "ip/toneMap 32f->8u reinhard", [&] {
+		ip::toneMap( floatSource, &toneMapped );
+		bench::doNotOptimize( toneMapped.getData()[0] );
+	}, pixels );
+
+	runner.run( "ip/toneMap 32f->8u filmic auto exposure", [&] {
+		ip::toneMap( floatSource, &toneMapped, ip::ToneMap().op( ip::ToneMap::FILMIC ).autoExposure() );
+		bench::doNotOptimize( toneMapped.getData()[0] );
+	}, pixels );
+
+	Surface8u hsv( source.getWidth(), source.getHeight(), source.hasAlpha() );
+	runner.run( "ip/convertColorSpace RGB->HSV 8u", [&] {
+		ip::convertColorSpace( source, &hsv, ip::RGB_TO_HSV );
+		bench::doNotOptimize( hsv.getData()[0] );
+	}, pixels );
+
+	Surface32f linear( source.getWidth(), source.getHeight(), source.hasAlpha() );
+	runner.run( "ip/convertColorSpace sRGB->linear 8u->32f", [&] {
+		ip::convertColorSpace( source, &linear, ip::SRGB_TO_LINEAR );
+		bench::doNotOptimize( linear.getData()[0] );
+	}, pixels );
+
+	runner.run( "ip/convertColorSpace RGB->YCbCr 709 32f", [&] {
+		ip::convertColorSpace( floatSource, &linear, ip::RGB_TO_YCBCR_709 );
+		bench::doNotOptimize( linear.getData()[0] );
+	}, pixels );
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include "cinder/BSplineFit.h"
+#include "cinder/ConvexHull.h"
+#include "cinder/DepthPyramid.h"
+#include "cinder/Matrix.h"
+#include "cinder/Perlin.h"
+#include "cinder/Quaternion.h"
+#include "cinder/Rand.h"
+#include "cinder/Stroke.h"
+#include "cinder/Utilities.h"
+
+#include <vector>
+
+inline void runMathBenchmarks( bench::Runner &runner )
+{
+	using namespace ci;
+
+	const size_t count = 1024;
+	Rand rand( 1 );
+
+	std::vector<Matrix44f> matrices( count );
+	for( size_t i = 0; i < count; ++i ) {
+		matrices[i] = Matrix44f::createRotation( rand.nextVec3f(), rand.nextFloat( 6.28f ) );
+		matrices[i].translate( rand.nextVec3f() * 10 );
+	}
+
+	std::vector<Vec3f> points( count * 16 ), transformed( points.size() );
+	for( size_t i = 0; i < points.size(); ++i )
+		points[i] = rand.nextVec3f() * rand.nextFloat( 100 );
+
+	runner.run( "math/Matrix44f multiply", [&] {
+		Matrix44f result = Matrix44f::identity();
+		for( size_t i = 0; i < count; ++i )
+			result = result * matrices[i];
+		bench::doNotOptimize( result );
+	}, count );
+
+	runner.run( "math/Matrix44f invert", [&] {
+		Matrix44f result;
+		for( size_t i = 0; i < count; ++i )
+			result += matrices[i].inverted();
+		bench::doNotOptimize( result );
+	}, count );
+
+	runner.run( "math/Matrix44f transformPoint", [&] {
+		const Matrix44f &m = matrices[0];
+		for( size_t i = 0; i < points.size(); ++i )
+			transformed[i] = m.transformPoint( points[i] );
+		bench::doNotOptimize( transformed[0] );
+	}, (double)points.size() );
+
+	runner.run( "math/Matrix44f transformPoints", [&] {
+		matrices[0].transformPoints( &points[0], &transformed[0], points.size() );
+		bench::doNotOptimize( transformed[0] );
+	}, (double)points.size() );
+
+	std::vector<Quatf> quats( count );
+	for( size_t i = 0; i < count; ++i )
+		quats[i] = Quatf( rand.nextVec3f(), rand.nextFloat( 6.28f ) );
+
+	runner.run( "math/Quatf slerp", [&] {
+		Quatf result;
+		for( size_t i = 1; i < count; ++i )
+			result += quats[i - 1].slerp( 0.3f, quats[i] );
+		bench::doNotOptimize( result );
+	}, count - 1 );
+
+	Perlin perlin( 4, 1 );
+	runner.run( "math/Perlin fBm 3d", [&] {
+		float sum = 0;
+		for( size_t i = 0; i < count; ++i )
+			sum += perlin.fBm( points[i] * 0.01f );
+		bench::doNotOptimize( sum );
+	}, count );
+
+	std::vector<Vec2f> cloud( 1 << 20 );
+	for( size_t i = 0; i < cloud.size(); ++i )
+		cloud[i] = rand.nextVec2f() * rand.nextFloat( 1000 );
+
+	std::vector<Vec2f> stroke( 5000 );
+	for( size_t i = 0; i < stroke.size(); ++i )
+		stroke[i] = Vec2f( (float)i, math<float>::sin( i * 0.01f ) * 100 ) + rand.nextVec2f();
+
+	runner.run( "math/fitBSpline 5k samples", [&] {
+		BSpline2f spline = fitBSpline( stroke, 3, 200 );
+		bench::doNotOptimize( spline.getPosition( 0.5f ) );
+	}, (double)stroke.size() );
+
+	std::vector<Vec3f> splinePoints( 64 );
+	for( size_t i = 0; i < splinePoints.size(); ++i )
+		splinePoints[i] = rand.nextVec3f() * 100;
+	BSpline3f spline3( splinePoints, 3, false, true );
+	std::vector<Vec3f> splineSamples( 4096 ), splineTangents( splineSamples.size() );
+
+	runner.run( "math/BSpline3f get 4096 positions and derivatives", [&] {
+		for( size_t i = 0; i < splineSamples.size(); ++i )
+			spline3.get( i / (float)( splineSamples.size() - 1 ), &splineSamples[i], &splineTangents[i] );
+		bench::doNotOptimize( splineSamples[0] );
+	}, (double)splineSamples.size() );
+
+	runner.run( "math/BSpline3f sampleUniform 4096 positions and derivatives", [&] {
+		spline3.sampleUniform( 0, 1, splineSamples.size(), &splineSamples[0], &splineTangents[0] );
+		bench::doNotOptimize( splineSamples[0] );
+	}, (double)splineSamples.size() );
+
+	BSplineFitter<Vec2f> fitter( (int)stroke.size(), 3, 200 );
+	runner.run( "math/BSplineFitter fit 5k samples", [&] {
+		BSpline2f spline = fitter.fit( stroke );
+		bench::doNotOptimize( spline.getPosition( 0.5f ) );
+	}, (double)stroke.size() );
+
+	runner.run( "math/calcConvexHull 1M points", [&] {
+		PolyLine2f hull = calcConvexHull( cloud );
+		bench::doNotOptimize( hull.size() );
+	}, (double)cloud.size() );
+
+	std::vector<std::vector<PolyLine2f> > regions( count );
+	for( size_t i = 0; i < count; ++i ) {
+		const Vec2f center = rand.nextVec2f() * 200, size( rand.nextFloat( 5, 20 ), rand.nextFloat( 5, 20 ) );
+		PolyLine2f quad;
+		quad.push_back( center - size );
+		quad.push_back( center + Vec2f( size.x, -size.y ) );
+		quad.push_back( center + size );
+		quad.push_back( center + Vec2f( -size.x, size.y ) );
+		regions[i].push_back( quad );
+	}
+
+	runner.run( "math/PolyLine2f calcUnion 1024 regions", [&] {
+		std::vector<PolyLine2f> merged = PolyLine2f::calcUnion( regions );
+		bench::doNotOptimize( merged.size() );
+	}, count );
+
+	PolyLine2f walk;
+	walk.push_back( Vec2f::zero() );
+	for( size_t i = 1; i < count * 16; ++i )
+		walk.push_back( walk.getPoints().back() + rand.nextVec2f() * rand.nextFloat( 1, 10 ) );
+	const Stroke roundStroke( 4, Stroke::JOIN_ROUND, Stroke::CAP_ROUND );
+	std::vector<Vec3f> strokePositions( roundStroke.calcNumVertices( walk ) );
+	std::vector<Vec2f> strokeTexCoords( strokePositions.size() );
+	runner.run( "math/Stroke generate 16k points round joins", [&] {
+		size_t numVertices = roundStroke.generate( walk, &strokePositions[0], 0, &strokeTexCoords[0], 0 );
+		bench::doNotOptimize( numVertices );
+	}, (double)walk.size() );
+
+	// a wall covering the middle of the screen at depth 0.5, with boxes scattered in front of and behind it
+	Channel32f depth( 512, 512 );
+	for( int32_t y = 0; y < depth.getHeight(); ++y )
+		for( int32_t x = 0; x < depth.getWidth(); ++x )
+			*depth.getData( x, y ) = ( x > 64 && x < 448 && y > 64 && y < 448 ) ? 0.5f : 1.0f;
+	Matrix44f viewProjection = Matrix44f::createScale( Vec3f( 0.1f, 0.1f, 0.01f ) );
+	DepthPyramid pyramid( depth, viewProjection );
+	std::vector<AxisAlignedBox3f> boxes( count * 100 );
+	for( size_t i = 0; i < boxes.size(); ++i ) {
+		const Vec3f center( rand.nextFloat( -10, 10 ), rand.nextFloat( -10, 10 ), rand.nextFloat( -100, 100 ) );
+		boxes[i] = AxisAlignedBox3f( center - Vec3f::one() * 0.25f, center + Vec3f::one() * 0.25f );
+	}
+	std::vector<uint32_t> visibleMask( ( boxes.size() + 31 ) / 32 );
+	runner.run( "math/DepthPyramid testBoxes 100k boxes", [&] {
+		size_t numVisible = pyramid.testBoxes( &boxes[0], boxes.size(), &visibleMask[0] );
+		bench::doNotOptimize( numVisible );
+	}, (double)boxes.size() );
+
+	// the kind of values XmlTree, JsonTree and CSV loading convert
+	std::vector<double> numbers( count * 10 );
+	std::vector<std::string> numberStrings( numbers.size() );
+	for( size_t i = 0; i < numbers.size(); ++i ) {
+		numbers[i] = rand.nextFloat( -1000, 1000 );
+		numberStrings[i] = toString( numbers[i] );
+	}
+	runner.run( "math/toString<double> 10k values", [&] {
+		size_t length = 0;
+		for( size_t i = 0; i < numbers.size(); ++i )
+			length += toString( numbers[i] ).size();
+		bench::doNotOptimize( length );
+	}, (double)numbers.size() );
+	runner.run( "math/fromString<double> 10k values", [&] {
+		double sum = 0;
+		for( size_t i = 0; i < numberStrings.size(); ++i )
+			sum += fromString<double>( numberStrings[i] );
+		bench::doNotOptimize( sum );
+	}, (double)numberStrings.size() );
+}
@@ -0,0 +1,56 @@
+// Micro-benchmarks for hot paths in core math, ip and audio dsp.
+//
+// usage: CinderBenchmark [--filter <substring>] [--json <path>] [--samples <count>] [--warmup <count>] [--min-time <seconds>]
+//
+// Results are printed as they complete. With --json, they are also written to <path>, so that runs can be
+// compared against a baseline. Always compare release builds on an otherwise idle machine.
+
+#include "Benchmark.h"
+#include "MathBench.h"
+#include "IpBench.h"
+#include "AudioDspBench.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+int main( int argc, char *argv[] )
+{
+	bench::Runner runner;
+	string jsonPath;
+
+	for( int i = 1; i < argc; ++i ) {
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if( arg == "--filter" && hasValue )
+			runner.setFilter( argv[++i] );
+		else if( arg == "--json" && hasValue )
+			jsonPath = argv[++i];
+		else if( arg == "--samples" && hasValue )
+			runner.setNumSamples( (size_t)atoi( argv[++i] ) );
+		else if( arg == "--warmup" && hasValue )
+			runner.setNumWarmupSamples( (size_t)atoi( argv[++i] ) );
+		else if( arg == "--min-time" && hasValue )
+			runner.setMinSampleSeconds( atof( argv[++i] ) );
+		else {
+			cerr << "usage: " << argv[0] << " [--filter <substring>] [--json <path>] [--samples <count>] [--warmup <count>] [--min-time <seconds>]" << endl;
+			return 1;
+		}
+	}
+
+#if ! defined( NDEBUG )
+	cout << "warning: this is a debug build, timings are not representative" << endl;
+#endif
+
+	runMathBenchmarks( runner );
+	runIpBenchmarks( runner );
+	runAudioDspBenchmarks( runner );
+
+	if( ! jsonPath.empty() ) {
+		runner.writeJson( ci::writeFile( jsonPath ) );
+		cout << "wrote " << runner.getResults().size() << " results to " << jsonPath << endl;
+	}
+
+	return 0;
+}